@@ -0,0 +1,39 @@
+# Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay LwM2M SDK
+# All rights reserved.
+#
+# Licensed under the AVSystem-5-clause License.
+# See the attached LICENSE file for details.
+
+# Applies the configuration profile selected with the WITH_PROFILE_* options.
+
+macro(anjay_profile_default NAME VALUE)
+    if(NOT DEFINED ${NAME})
+        set(${NAME} ${VALUE} CACHE BOOL "Set by configuration profile")
+    endif()
+endmacro()
+
+if(WITH_PROFILE_SINGLE_SERVER_SENSOR)
+    # no Bootstrap Server, no Access Control object
+    anjay_profile_default(WITH_BOOTSTRAP OFF)
+    anjay_profile_default(WITH_ACCESS_CONTROL OFF)
+    # SenML CBOR as the only hierarchical format, used for both Read and Send
+    anjay_profile_default(WITHOUT_TLV ON)
+    anjay_profile_default(WITHOUT_PLAINTEXT ON)
+    anjay_profile_default(WITH_LWM2M_JSON OFF)
+    anjay_profile_default(WITH_SENML_JSON OFF)
+    anjay_profile_default(WITH_LWM2M_CBOR OFF)
+    anjay_profile_default(WITHOUT_COMPOSITE_OPERATIONS ON)
+    # UDP as the only transport, no downloads
+    anjay_profile_default(WITH_AVS_COAP_TCP OFF)
+    anjay_profile_default(WITH_DOWNLOADER OFF)
+    # fixed set of objects
+    anjay_profile_default(WITH_MODULE_fw_update OFF)
+    anjay_profile_default(WITH_MODULE_ipso_objects_v2 OFF)
+    anjay_profile_default(WITH_OBSERVATION_STATUS OFF)
+    anjay_profile_default(WITH_CONN_STATUS_API OFF)
+    anjay_profile_default(WITH_ANJAY_TRACE_LOGS OFF)
+    # the demo application and examples require the full feature set
+    anjay_profile_default(WITH_DEMO OFF)
+    anjay_profile_default(WITH_EXAMPLES OFF)
+endif()
@@ -194,6 +194,30 @@ avs_error_t avs_coap_client_send_async_request(
         avs_coap_client_async_response_handler_t *response_handler,
         void *response_handler_arg);
 
+/**
+ * Variant of @ref avs_coap_client_send_async_request that uses
+ * @ref avs_coap_payload_provider_t to access request payload, avoiding copying
+ * it if it is already present in memory.
+ *
+ * All arguments and the return value have the same semantics as for
+ * @ref avs_coap_client_send_async_request , except for:
+ *
+ * @param request_provider     Function to call when the library is ready to
+ *                             send a chunk of payload data. See
+ *                             @ref avs_coap_payload_provider_t for details.
+ *
+ * @param request_provider_arg An opaque argument passed to
+ *                             @p request_provider .
+ */
+avs_error_t avs_coap_client_send_async_request_with_provider(
+        avs_coap_ctx_t *ctx,
+        avs_coap_exchange_id_t *out_exchange_id,
+        const avs_coap_request_header_t *req,
+        avs_coap_payload_provider_t *request_provider,
+        void *request_provider_arg,
+        avs_coap_client_async_response_handler_t *response_handler,
+        void *response_handler_arg);
+
 /**
  * Changes the offset of the remote resource that the user wants to receive the
  * next response data chunk from.
@@ -13,6 +13,7 @@
 #include <avsystem/coap/avs_coap_config.h>
 
 #include <avsystem/commons/avs_sched.h>
+#include <avsystem/commons/avs_shared_buffer.h>
 #include <avsystem/commons/avs_socket.h>
 
 #include <avsystem/coap/option.h>
@@ -22,6 +23,20 @@
 extern "C" {
 #endif
 
+/**
+ * Number of buckets of @ref avs_coap_stats_t::rtt_histogram. Bucket 0 counts
+ * round-trip times shorter than
+ * @ref AVS_COAP_STATS_RTT_HISTOGRAM_FIRST_BOUND_MS and the upper bound of each
+ * next one is twice as large, except for the last bucket, which is unbounded.
+ */
+#define AVS_COAP_STATS_RTT_HISTOGRAM_BUCKETS 8
+
+/**
+ * Upper bound (exclusive), in milliseconds, of the first
+ * @ref avs_coap_stats_t::rtt_histogram bucket.
+ */
+#define AVS_COAP_STATS_RTT_HISTOGRAM_FIRST_BOUND_MS 125
+
 typedef struct {
     /**
      * Number of retransmitted messages. For CoAP/TCP it's always 0.
@@ -29,9 +44,101 @@ typedef struct {
     uint32_t outgoing_retransmissions_count;
 
     /**
-     * Number of incoming retransmissions. For CoAP/TCP it's always 0.
+     * Number of incoming retransmissions, i.e. duplicate requests to which a
+     * cached response was found in the response cache. For CoAP/TCP it's
+     * always 0.
      */
     uint32_t incoming_retransmissions_count;
+
+    /**
+     * Base timeout used for the first transmission of new confirmable
+     * messages, before applying the random factor. For CoAP/UDP it's
+     * ACK_TIMEOUT, unless adaptive retransmission timeouts are enabled using
+     * @ref avs_coap_udp_ctx_set_adaptive_rto. For CoAP/TCP it's always zero.
+     */
+    avs_time_duration_t current_rto;
+
+    /**
+     * Number of confirmable messages whose serialized copy for retransmission
+     * was stored in a reused buffer (see
+     * <c>AVS_COAP_UDP_UNCONFIRMED_POOL_SIZE</c>). For CoAP/TCP it's always 0.
+     */
+    uint32_t unconfirmed_pool_hits;
+
+    /**
+     * Number of confirmable messages whose serialized copy for retransmission
+     * had to be stored in a newly allocated buffer. For CoAP/TCP it's always 0.
+     */
+    uint32_t unconfirmed_pool_misses;
+
+    /**
+     * Histogram of round-trip times of confirmable messages that were
+     * acknowledged without being retransmitted (retransmitted ones are
+     * ambiguous, as the ACK may refer to any of the transmissions). See
+     * @ref AVS_COAP_STATS_RTT_HISTOGRAM_BUCKETS for bucket bounds. For CoAP/TCP
+     * all buckets are always 0.
+     */
+    uint32_t rtt_histogram[AVS_COAP_STATS_RTT_HISTOGRAM_BUCKETS];
+
+    /**
+     * Number of confirmable messages that were acknowledged, either with an
+     * empty ACK or a piggybacked response. For CoAP/TCP it's always 0.
+     */
+    uint32_t acknowledged_count;
+
+    /**
+     * Total time between the first transmission and acknowledgement of all
+     * messages counted in @ref avs_coap_stats_t::acknowledged_count, including
+     * any retransmissions. For CoAP/TCP it's always zero.
+     */
+    avs_time_duration_t total_ack_wait_time;
+
+    /**
+     * Number of confirmable messages that are currently sent, but not yet
+     * acknowledged or responded to, i.e. ones counted against NSTART. Unlike
+     * the other fields, it reflects the state at the time of the call, not an
+     * accumulated value. For CoAP/TCP it's always 0.
+     */
+    uint32_t messages_in_flight;
+
+    /**
+     * Number of messages successfully sent, including retransmissions, empty
+     * messages and cached responses. For CoAP/TCP it's always 0.
+     */
+    uint32_t sent_messages_count;
+
+    /**
+     * Number of messages received, including duplicates and ones that were
+     * subsequently ignored. Packets that could not be parsed as CoAP messages
+     * are not counted. For CoAP/TCP it's always 0.
+     */
+    uint32_t received_messages_count;
+
+    /**
+     * Total size, in bytes, of all messages counted in
+     * @ref avs_coap_stats_t::sent_messages_count and
+     * @ref avs_coap_stats_t::received_messages_count, as passed to or from the
+     * socket (i.e. excluding IP, UDP and DTLS overhead). For CoAP/TCP it's
+     * always 0.
+     */
+    uint64_t total_messages_size;
+
+    /**
+     * Size of the largest message counted in
+     * @ref avs_coap_stats_t::total_messages_size. For CoAP/TCP it's always 0.
+     */
+    uint32_t max_message_size;
+
+    /**
+     * Total number of bytes saved by the compression layer set using
+     * @ref avs_coap_udp_ctx_set_compression, i.e. the difference between sizes
+     * of messages before compression (or after decompression) and the sizes
+     * of datagrams actually sent or received. It may be negative if messages
+     * were enlarged. Sizes counted in
+     * @ref avs_coap_stats_t::total_messages_size are the ones after
+     * compression. For CoAP/TCP it's always 0.
+     */
+    int64_t compression_bytes_saved;
 } avs_coap_stats_t;
 
 typedef struct avs_coap_request_header {
@@ -112,6 +219,66 @@ avs_error_t avs_coap_ctx_set_socket(avs_coap_ctx_t *ctx,
  */
 bool avs_coap_ctx_has_socket(avs_coap_ctx_t *ctx);
 
+/**
+ * Checks whether the buffers used by @p ctx can currently be replaced with
+ * @ref avs_coap_ctx_set_buffers by ones of given capacities. That is not the
+ * case if the input buffer is in use (i.e. a streaming operation is in
+ * progress), or if any of the buffers would shrink while any exchange is in
+ * progress, as block sizes negotiated for it may depend on buffer capacity.
+ *
+ * @param ctx             CoAP context object to check.
+ * @param in_capacity     Capacity of the new buffer for incoming messages.
+ * @param out_capacity    Capacity of the new buffer for outgoing messages.
+ */
+bool avs_coap_ctx_buffers_replaceable(avs_coap_ctx_t *ctx,
+                                      size_t in_capacity,
+                                      size_t out_capacity);
+
+/**
+ * Replaces the input and output buffers used by @p ctx , e.g. to resize buffers
+ * shared by multiple contexts. The context does not take ownership of the
+ * buffers; the previously used ones may be freed after a successful call.
+ *
+ * The new buffers MUST meet the same requirements as the ones passed to the
+ * function that created @p ctx .
+ *
+ * @param ctx        CoAP context object to modify.
+ * @param in_buffer  New buffer for incoming messages.
+ * @param out_buffer New buffer for outgoing messages.
+ *
+ * @returns <c>AVS_OK</c> for success, or
+ *          @ref AVS_COAP_ERR_SHARED_BUFFER_IN_USE if the buffers cannot be
+ *          replaced at the moment, see
+ *          @ref avs_coap_ctx_buffers_replaceable . The buffers are not
+ *          replaced in case of error.
+ */
+avs_error_t avs_coap_ctx_set_buffers(avs_coap_ctx_t *ctx,
+                                     avs_shared_buffer_t *in_buffer,
+                                     avs_shared_buffer_t *out_buffer);
+
+/**
+ * Retrieves buffer sizes that would have been useful for the traffic handled
+ * by @p ctx since the previous call, and resets them. This is intended for
+ * users that start with small buffers and grow them with
+ * @ref avs_coap_ctx_set_buffers only when necessary.
+ *
+ * @param ctx                   CoAP context object to query.
+ *
+ * @param out_in_buffer_demand  Set to the input buffer capacity that would have
+ *                              been necessary to receive the messages that
+ *                              were truncated, or 0 if there were none. Only
+ *                              CoAP/UDP contexts report it.
+ *
+ * @param out_out_buffer_demand Set to the output buffer capacity that would
+ *                              have allowed sending larger blocks of payloads
+ *                              that had to be split, as allowed by the MTU or
+ *                              the peer's Max-Message-Size, or 0 if the output
+ *                              buffer has not been a limiting factor.
+ */
+void avs_coap_ctx_take_buffer_demand(avs_coap_ctx_t *ctx,
+                                     size_t *out_in_buffer_demand,
+                                     size_t *out_out_buffer_demand);
+
 /**
  * Frees all resources associated with @p ctx .
  *
@@ -325,6 +325,27 @@ avs_coap_notify_async(avs_coap_ctx_t *ctx,
                       avs_coap_delivery_status_handler_t *delivery_handler,
                       void *delivery_handler_arg);
 
+/**
+ * Variant of @ref avs_coap_notify_async that uses
+ * @ref avs_coap_payload_provider_t to access notification payload, avoiding
+ * copying it if it is already present in memory.
+ *
+ * All arguments and the return value have the same semantics as for
+ * @ref avs_coap_notify_async , except for @p provide_payload and
+ * @p provide_payload_arg that replace <c>write_payload</c> and
+ * <c>write_payload_arg</c>, respectively.
+ */
+avs_error_t avs_coap_notify_async_with_provider(
+        avs_coap_ctx_t *ctx,
+        avs_coap_exchange_id_t *out_exchange_id,
+        avs_coap_observe_id_t observe_id,
+        const avs_coap_response_header_t *response_header,
+        avs_coap_notify_reliability_hint_t reliability_hint,
+        avs_coap_payload_provider_t *provide_payload,
+        void *provide_payload_arg,
+        avs_coap_delivery_status_handler_t *delivery_handler,
+        void *delivery_handler_arg);
+
 #    ifdef WITH_AVS_COAP_STREAMING_API
 
 /**
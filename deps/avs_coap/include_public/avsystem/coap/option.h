@@ -71,7 +71,7 @@ extern "C" {
 /** @} */
 
 /**
- * CoAP option numbers, as defined in RFC7252/RFC7641/RFC7959.
+ * CoAP option numbers, as defined in RFC7252/RFC7641/RFC7959/RFC9177.
  * @{
  */
 #define AVS_COAP_OPTION_IF_MATCH 1
@@ -87,9 +87,11 @@ extern "C" {
 #define AVS_COAP_OPTION_MAX_AGE 14
 #define AVS_COAP_OPTION_URI_QUERY 15
 #define AVS_COAP_OPTION_ACCEPT 17
+#define AVS_COAP_OPTION_Q_BLOCK1 19
 #define AVS_COAP_OPTION_LOCATION_QUERY 20
 #define AVS_COAP_OPTION_BLOCK2 23
 #define AVS_COAP_OPTION_BLOCK1 27
+#define AVS_COAP_OPTION_Q_BLOCK2 31
 #define AVS_COAP_OPTION_PROXY_URI 35
 #define AVS_COAP_OPTION_PROXY_SCHEME 39
 #define AVS_COAP_OPTION_SIZE1 60
@@ -147,6 +149,35 @@ typedef struct avs_coap_option_block {
 
 /** @} */
 
+/**
+ * Maximum number of distinct option numbers that can be tracked by
+ * @ref avs_coap_options_index_t .
+ */
+#define AVS_COAP_OPTIONS_INDEX_SIZE 8
+
+typedef struct {
+    uint16_t number;
+    /** Offset of the first option with this number from the beginning. */
+    uint16_t offset;
+} avs_coap_options_index_entry_t;
+
+/**
+ * Positions of the distinct option numbers present in an options object,
+ * built while parsing received options, so that looking them up does not
+ * require walking the whole encoded buffer. Managed internally by avs_coap.
+ */
+typedef struct {
+    /**
+     * True if <c>entries</c> describe all options. The index is invalidated
+     * whenever options are modified, or if there are more than
+     * @ref AVS_COAP_OPTIONS_INDEX_SIZE distinct option numbers, in which case
+     * lookups fall back to a linear search.
+     */
+    bool valid;
+    uint8_t size;
+    avs_coap_options_index_entry_t entries[AVS_COAP_OPTIONS_INDEX_SIZE];
+} avs_coap_options_index_t;
+
 /**
  * Note: this struct MUST be initialized with either
  * @ref avs_coap_options_create_empty or @ref avs_coap_options_dynamic_init
@@ -165,6 +196,8 @@ typedef struct avs_coap_options {
      * memory.
      */
     bool allocated;
+
+    avs_coap_options_index_t lookup_index;
 } avs_coap_options_t;
 
 /**
@@ -215,6 +248,7 @@ avs_coap_options_create_empty(void *buffer, size_t capacity) {
     opts.size = 0;
     opts.capacity = capacity;
     opts.allocated = false;
+    opts.lookup_index.valid = false;
     return opts;
 }
 
@@ -260,6 +294,7 @@ avs_coap_options_dynamic_init_with_size(avs_coap_options_t *opts,
     opts->size = 0;
     opts->capacity = initial_capacity;
     opts->allocated = true;
+    opts->lookup_index.valid = false;
 
     if (initial_capacity && !opts->begin) {
         avs_coap_options_cleanup(opts);
@@ -520,6 +555,10 @@ int avs_coap_options_get_content_format(const avs_coap_options_t *opts,
  *              present,
  *          @li -1 in case of error, including cases where the option is
  *              malformed or duplicated.
+ *
+ * NOTE: If <c>WITH_AVS_COAP_Q_BLOCK</c> is enabled and @p type is
+ * @ref AVS_COAP_BLOCK2 , the Q-Block2 option is retrieved in the same way if
+ * there is no BLOCK2 option.
  */
 int avs_coap_options_get_block(const avs_coap_options_t *opts,
                                avs_coap_option_block_type_t type,
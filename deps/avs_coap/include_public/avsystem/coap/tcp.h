@@ -69,6 +69,126 @@ avs_coap_ctx_t *avs_coap_tcp_ctx_create(avs_sched_t *sched,
                                         avs_time_duration_t request_timeout,
                                         avs_crypto_prng_ctx_t *prng_ctx);
 
+/**
+ * Enables or disables coalescing of outgoing messages on a CoAP/TCP context.
+ *
+ * When enabled, serialized messages are not written to the socket immediately,
+ * but accumulated in an internal buffer of @p buffer_size bytes instead. The
+ * buffer is written to the socket as a whole:
+ *
+ * - when the next message does not fit in it,
+ * - before any blocking receive operation on the context,
+ * - when the retry job of the context is executed by the scheduler - it is
+ *   scheduled to run immediately whenever the first message is buffered, so
+ *   all messages generated during a single scheduler run are sent together,
+ * - when @ref avs_coap_tcp_ctx_flush is called or the context is destroyed.
+ *
+ * Messages larger than @p buffer_size are sent directly, after flushing any
+ * previously buffered data. If writing buffered data fails, an Abort message
+ * is sent and the context becomes unusable, as if the send failed
+ * synchronously.
+ *
+ * @param ctx         CoAP/TCP context to operate on.
+ * @param buffer_size Size of the coalescing buffer, or 0 to disable coalescing.
+ *                    Any data already buffered is flushed before the change.
+ *
+ * @returns 0 on success, or -1 if @p ctx is not a CoAP/TCP context created
+ *          by @ref avs_coap_tcp_ctx_create, buffered data could not be
+ *          flushed, or there is not enough memory.
+ */
+int avs_coap_tcp_ctx_set_write_coalescing(avs_coap_ctx_t *ctx,
+                                          size_t buffer_size);
+
+/**
+ * Sets the maximum number of messages handled by a single call to
+ * @ref avs_coap_async_handle_incoming_packet , even if the socket does not
+ * report any buffered data.
+ *
+ * Plain TCP sockets never report buffered data, so by default only a single
+ * message is handled per call, and each further message pipelined by the peer
+ * requires another poll() wakeup. With a budget greater than 1, the context
+ * attempts to receive up to that many messages in a non-blocking way, stopping
+ * early when no more data is available.
+ *
+ * @param ctx          CoAP/TCP context to operate on.
+ * @param max_messages Maximum number of messages to receive per call. Values
+ *                     of 0 and 1 both restore the default behaviour.
+ *
+ * @returns 0 on success, or -1 if @p ctx is not a CoAP/TCP context created
+ *          by @ref avs_coap_tcp_ctx_create.
+ */
+int avs_coap_tcp_ctx_set_receive_budget(avs_coap_ctx_t *ctx,
+                                        size_t max_messages);
+
+/**
+ * Writes all messages buffered because of write coalescing (see
+ * @ref avs_coap_tcp_ctx_set_write_coalescing) to the socket. Does nothing if
+ * coalescing is disabled or there is no buffered data.
+ *
+ * @param ctx CoAP/TCP context to operate on.
+ *
+ * @returns AVS_OK for success, or an error condition for which the operation
+ *          failed.
+ */
+avs_error_t avs_coap_tcp_ctx_flush(avs_coap_ctx_t *ctx);
+
+/**
+ * Handler called when the Ping message sent with
+ * @ref avs_coap_tcp_ctx_send_ping is finished.
+ *
+ * @param ctx CoAP/TCP context the Ping was sent on.
+ *
+ * @param err Result of the keepalive check:
+ *            - AVS_OK if a matching Pong message was received,
+ *            - @ref AVS_COAP_ERR_TIMEOUT if no Pong arrived within the request
+ *              timeout configured with @ref avs_coap_tcp_ctx_create,
+ *            - @ref AVS_COAP_ERR_EXCHANGE_CANCELED if the context is being
+ *              destroyed.
+ *
+ * @param arg Opaque user-defined data, as passed to
+ *            @ref avs_coap_tcp_ctx_send_ping .
+ */
+typedef void
+avs_coap_tcp_pong_handler_t(avs_coap_ctx_t *ctx, avs_error_t err, void *arg);
+
+/**
+ * Sends a CoAP Signaling Ping message (RFC 8323, section 5.4) and waits for the
+ * matching Pong, e.g. to check whether the connection is still alive after a
+ * period of inactivity, or to refresh NAT bindings.
+ *
+ * Only one Ping may be in progress at a time.
+ *
+ * @param ctx          CoAP/TCP context to operate on.
+ *
+ * @param pong_handler Handler to call when the Pong is received or the Ping
+ *                     times out. MUST NOT be NULL.
+ *
+ * @param arg          Opaque argument to pass to @p pong_handler .
+ *
+ * @returns AVS_OK for success, or an error condition for which the operation
+ *          failed. In particular, <c>avs_errno(AVS_EBUSY)</c> is returned if
+ *          another Ping is already in progress. @p pong_handler is not called
+ *          if this function fails.
+ */
+avs_error_t
+avs_coap_tcp_ctx_send_ping(avs_coap_ctx_t *ctx,
+                           avs_coap_tcp_pong_handler_t *pong_handler,
+                           void *arg);
+
+/**
+ * Returns the time of the last successful write to or read from the socket of
+ * a CoAP/TCP context, i.e. the last time the connection was known to carry
+ * traffic. Messages buffered because of write coalescing are considered only
+ * after they are actually written.
+ *
+ * @param ctx CoAP/TCP context to operate on.
+ *
+ * @returns Time of the last activity, time of assigning the socket if there was
+ *          no traffic yet, or @c AVS_TIME_MONOTONIC_INVALID if @p ctx is not
+ *          a CoAP/TCP context or has no socket.
+ */
+avs_time_monotonic_t avs_coap_tcp_ctx_get_last_activity(avs_coap_ctx_t *ctx);
+
 #endif // WITH_AVS_COAP_TCP
 
 #ifdef __cplusplus
@@ -99,6 +99,24 @@ avs_coap_udp_exchange_lifetime(const avs_coap_udp_tx_params_t *tx_params);
 avs_coap_udp_response_cache_t *
 avs_coap_udp_response_cache_create(size_t capacity);
 
+/**
+ * Creates a response cache object that initially allocates only
+ * @p min_capacity bytes. The cache grows, up to @p max_capacity bytes, when
+ * storing a new response would otherwise require dropping ones that have not
+ * expired yet, and shrinks back to @p min_capacity once all stored responses
+ * expire.
+ *
+ * @param min_capacity Number of bytes allocated initially. Values larger than
+ *                     @p max_capacity are treated as equal to it.
+ * @param max_capacity Maximum number of bytes the cache may hold.
+ *
+ * @return Created response cache object, or NULL if there is not enough memory
+ *         or @p max_capacity is 0.
+ */
+avs_coap_udp_response_cache_t *
+avs_coap_udp_response_cache_create_growable(size_t min_capacity,
+                                            size_t max_capacity);
+
 /**
  * Frees any resources used by given @p cache_ptr and sets <c>*cache_ptr</c>
  * to NULL.
@@ -209,6 +227,227 @@ int avs_coap_udp_ctx_set_tx_params(avs_coap_ctx_t *ctx,
 const avs_coap_udp_tx_params_t *
 avs_coap_udp_ctx_get_tx_params(avs_coap_ctx_t *ctx);
 
+/**
+ * Enables or disables adaptive retransmission timeouts on a CoAP/UDP context.
+ *
+ * When enabled, ACK_TIMEOUT from the transmission params is only used as the
+ * initial estimate of the retransmission timeout (RTO). The estimate is then
+ * refined using round-trip times of exchanges with the remote endpoint, as
+ * measured from their ACKs, following the "strong" and "weak" estimators of
+ * CoCoA (draft-ietf-core-cocoa). The factor by which the timeout is increased
+ * on each retransmission also depends on the current estimate, instead of
+ * being fixed at 2.
+ *
+ * The current estimate can be read using @ref avs_coap_get_stats.
+ *
+ * @param ctx     CoAP/UDP context to operate on.
+ * @param enabled True to enable adaptive RTO, false to use ACK_TIMEOUT as
+ *                specified in RFC 7252. In both cases, any previously measured
+ *                round-trip times are discarded.
+ *
+ * @returns 0 on success, or -1 if @p ctx is not a CoAP/UDP context created
+ *          by @ref avs_coap_udp_ctx_create.
+ */
+int avs_coap_udp_ctx_set_adaptive_rto(avs_coap_ctx_t *ctx, bool enabled);
+
+/**
+ * Enables or disables path MTU discovery on a CoAP/UDP context.
+ *
+ * When enabled, a large message that had to be retransmitted twice is assumed
+ * to be lost due to IP fragmentation, if a smaller message sent afterwards is
+ * acknowledged without retransmissions. The limit of outgoing message size is
+ * then lowered below the size of the lost message, which makes BLOCK transfers
+ * initiated afterwards use smaller blocks.
+ *
+ * The limit is never lowered below 256 bytes, and never raised again for the
+ * lifetime of the context. To carry it over to a new context used to talk to
+ * the same remote endpoint (e.g. after reconnecting), use
+ * @ref avs_coap_udp_ctx_get_path_mtu and pass the result as @p initial_mtu .
+ *
+ * @param ctx         CoAP/UDP context to operate on.
+ * @param enabled     True to enable path MTU discovery, false to always use the
+ *                    MTU reported by the socket.
+ * @param initial_mtu Initial limit of outgoing message size, or 0 to only limit
+ *                    it by the MTU reported by the socket until a loss is
+ *                    detected. Ignored if @p enabled is false.
+ *
+ * @returns 0 on success, or -1 if @p ctx is not a CoAP/UDP context created
+ *          by @ref avs_coap_udp_ctx_create.
+ */
+int avs_coap_udp_ctx_set_path_mtu_discovery(avs_coap_ctx_t *ctx,
+                                            bool enabled,
+                                            size_t initial_mtu);
+
+/**
+ * @param ctx CoAP/UDP context to operate on.
+ *
+ * @returns Current limit of outgoing message size determined by path MTU
+ *          discovery (see @ref avs_coap_udp_ctx_set_path_mtu_discovery), or 0
+ *          if it is disabled, no limit has been determined yet, or @p ctx is
+ *          not a CoAP/UDP context.
+ */
+size_t avs_coap_udp_ctx_get_path_mtu(avs_coap_ctx_t *ctx);
+
+/**
+ * Transforms a single datagram, as used by @ref avs_coap_udp_compression_t.
+ *
+ * @param arg          Opaque argument passed to
+ *                     @ref avs_coap_udp_ctx_set_compression.
+ * @param in           Datagram to transform.
+ * @param in_size      Size of @p in , in bytes.
+ * @param out          Buffer to write the transformed datagram to.
+ * @param out_capacity Size of @p out , in bytes.
+ * @param out_size     Size of the transformed datagram, in bytes.
+ *
+ * @returns AVS_OK for success, or an error condition for which the datagram
+ *          shall be dropped.
+ */
+typedef avs_error_t avs_coap_udp_transform_t(void *arg,
+                                             const void *in,
+                                             size_t in_size,
+                                             void *out,
+                                             size_t out_capacity,
+                                             size_t *out_size);
+
+/**
+ * Datagram compression layer of a CoAP/UDP context, e.g. an implementation of
+ * SCHC (RFC 8724) rules for the CoAP header (RFC 8824).
+ */
+typedef struct {
+    /**
+     * Called on each serialized CoAP message just before sending it. The
+     * result is passed to the socket instead of the message.
+     */
+    avs_coap_udp_transform_t *compress;
+
+    /**
+     * Called on each datagram received from the socket, to restore the CoAP
+     * message to be parsed. MUST reverse @ref compress as used by the remote
+     * endpoint.
+     */
+    avs_coap_udp_transform_t *decompress;
+
+    /**
+     * Maximum number of bytes by which @ref compress may enlarge a message,
+     * e.g. if none of the rules match it. Outgoing message size limits
+     * derived from the MTU are lowered by this value.
+     */
+    size_t max_overhead;
+} avs_coap_udp_compression_t;
+
+/**
+ * Reference compression layer using static SCHC-style rules for the messages
+ * most commonly exchanged by LwM2M clients over CoAP/UDP, e.g. Register and
+ * Update requests or piggybacked read responses.
+ *
+ * Each compressed datagram starts with a byte containing the rule ID in its
+ * upper four bits, and the token length in the lower four. Rule 0 means that
+ * the original CoAP message follows unchanged. Other rules elide the version,
+ * type and code of the message, as well as a fixed leading part of its options
+ * (e.g. Uri-Path "rd"). The message ID, token and the rest of the message
+ * follow unchanged.
+ *
+ * Does not use its argument, so NULL may be passed as the @c arg of
+ * @ref avs_coap_udp_ctx_set_compression.
+ */
+extern const avs_coap_udp_compression_t AVS_COAP_UDP_STATIC_LWM2M_COMPRESSION;
+
+/**
+ * Sets a compression layer of a CoAP/UDP context, applied to all datagrams
+ * sent and received afterwards.
+ *
+ * Both endpoints need to use matching compression; it is up to the user to
+ * ensure that, e.g. through out-of-band configuration. The number of bytes
+ * saved is available as @ref avs_coap_stats_t::compression_bytes_saved .
+ *
+ * @param ctx         CoAP/UDP context to operate on.
+ * @param compression Compression layer to use, or NULL to disable compression.
+ *                    MUST outlive @p ctx or the next call to this function.
+ * @param arg         Opaque argument passed to the callbacks of
+ *                    @p compression .
+ *
+ * @returns 0 on success, or -1 if @p ctx is not a CoAP/UDP context created
+ *          by @ref avs_coap_udp_ctx_create.
+ */
+int avs_coap_udp_ctx_set_compression(
+        avs_coap_ctx_t *ctx,
+        const avs_coap_udp_compression_t *compression,
+        void *arg);
+
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+/**
+ * Maximum number of request payload blocks that may be sent using the Q-Block1
+ * option without waiting for the previous ones to be acknowledged.
+ */
+#        define AVS_COAP_UDP_Q_BLOCK1_MAX_PAYLOADS 10
+
+/**
+ * Enables or disables sending BLOCK-wise requests using the Q-Block1 option
+ * (RFC 9177) instead of BLOCK1.
+ *
+ * When enabled, each request payload block is still sent as a separate
+ * Confirmable message, but up to @p max_payloads of them may be awaiting
+ * acknowledgement at once, instead of waiting for a response to each block
+ * before sending the next one. The actual number of messages in flight is
+ * additionally limited by NSTART (see @ref avs_coap_udp_tx_params_t).
+ *
+ * Until the remote endpoint acknowledges the first Q-Block1 payload, blocks are
+ * sent one at a time. If it responds to the first one with 4.02 Bad Option,
+ * the request is transparently retried using BLOCK1, and Q-Block1 is not used
+ * on this context anymore - see @ref avs_coap_udp_ctx_q_block1_rejected . For
+ * requests created with a payload writer, this requires a copy of the first
+ * payload block to be held until the remote endpoint is known to support
+ * Q-Block1; if it cannot be allocated, the request is sent using BLOCK1.
+ *
+ * @param ctx          CoAP/UDP context to operate on.
+ * @param max_payloads Maximum number of payload blocks awaiting
+ *                     acknowledgement, or 0 to disable Q-Block1. Values larger
+ *                     than @ref AVS_COAP_UDP_Q_BLOCK1_MAX_PAYLOADS are clamped.
+ *
+ * @returns 0 on success, or -1 if @p ctx is not a CoAP/UDP context created
+ *          by @ref avs_coap_udp_ctx_create.
+ */
+int avs_coap_udp_ctx_set_q_block1(avs_coap_ctx_t *ctx, size_t max_payloads);
+
+/**
+ * @param ctx CoAP/UDP context to operate on.
+ *
+ * @returns True if the remote endpoint has been detected not to support the
+ *          Q-Block1 option, false otherwise or if @p ctx is not a CoAP/UDP
+ *          context.
+ */
+bool avs_coap_udp_ctx_q_block1_rejected(avs_coap_ctx_t *ctx);
+
+/**
+ * Enables or disables requesting BLOCK-wise responses to GET requests using the
+ * Q-Block2 option (RFC 9177) instead of BLOCK2.
+ *
+ * Response payload blocks are still requested one at a time. If the remote
+ * endpoint responds to a Q-Block2 request with 4.02 Bad Option, the request is
+ * transparently retried using BLOCK2, and Q-Block2 is not used on this context
+ * anymore - see @ref avs_coap_udp_ctx_q_block2_rejected .
+ *
+ * Regardless of this setting, responses to incoming requests that use Q-Block2
+ * are sent using Q-Block2 as well.
+ *
+ * @param ctx     CoAP/UDP context to operate on.
+ * @param enabled True to use Q-Block2, false to use BLOCK2.
+ *
+ * @returns 0 on success, or -1 if @p ctx is not a CoAP/UDP context created
+ *          by @ref avs_coap_udp_ctx_create.
+ */
+int avs_coap_udp_ctx_set_q_block2(avs_coap_ctx_t *ctx, bool enabled);
+
+/**
+ * @param ctx CoAP/UDP context to operate on.
+ *
+ * @returns True if the remote endpoint has been detected not to support the
+ *          Q-Block2 option, false otherwise or if @p ctx is not a CoAP/UDP
+ *          context.
+ */
+bool avs_coap_udp_ctx_q_block2_rejected(avs_coap_ctx_t *ctx);
+#    endif // WITH_AVS_COAP_Q_BLOCK
+
 #endif // WITH_AVS_COAP_UDP
 
 #ifdef __cplusplus
@@ -90,6 +90,70 @@ typedef int avs_coap_payload_writer_t(size_t payload_offset,
                                       size_t *out_payload_chunk_size,
                                       void *arg);
 
+/**
+ * Alternative to @ref avs_coap_payload_writer_t for payload data that is
+ * already present in memory. Instead of copying the data into a buffer owned
+ * by the library, the function hands out a reference to it.
+ *
+ * If a whole payload chunk is available as a single contiguous memory region,
+ * it is sent directly from that memory. Otherwise, the library gathers the
+ * chunk from subsequent regions, calling this function multiple times.
+ *
+ * @param[in]  payload_offset Offset (in bytes) within the payload that the
+ *                            memory referenced by @p out_data shall start at.
+ *
+ * @param[out] out_data       Pointer to a variable that SHOULD be set to the
+ *                            pointer to payload data starting at
+ *                            @p payload_offset .
+ *
+ * @param[out] out_data_size  Pointer to a variable that SHOULD be set to the
+ *                            number of bytes available at @p out_data . On
+ *                            entry, that variable is guaranteed to be zero. The
+ *                            size may be arbitrary; zero is treated as end
+ *                            of payload.
+ *
+ * @param[in]  arg            Opaque user-defined data.
+ *
+ * @returns 0 on success, or a non-zero value in case of error, with the same
+ *          semantics as for @ref avs_coap_payload_writer_t .
+ *
+ * NOTE: The referenced memory MUST remain valid and unchanged until the
+ * exchange is finished (i.e. until the response or delivery handler is called,
+ * or the exchange is canceled).
+ */
+typedef int avs_coap_payload_provider_t(size_t payload_offset,
+                                        const void **out_data,
+                                        size_t *out_data_size,
+                                        void *arg);
+
+/**
+ * Single contiguous region of payload data.
+ */
+typedef struct {
+    const void *data;
+    size_t size;
+} avs_coap_payload_iovec_t;
+
+/**
+ * Payload data scattered across multiple memory regions, to be used as an
+ * argument for @ref avs_coap_payload_iovec_provider .
+ */
+typedef struct {
+    const avs_coap_payload_iovec_t *iov;
+    size_t iovcnt;
+} avs_coap_payload_iovec_list_t;
+
+/**
+ * Implementation of @ref avs_coap_payload_provider_t that hands out references
+ * to subsequent regions described by a @ref avs_coap_payload_iovec_list_t
+ * passed as @p iovec_list . The list itself, as well as all memory it refers
+ * to, MUST remain valid until the exchange is finished.
+ */
+int avs_coap_payload_iovec_provider(size_t payload_offset,
+                                    const void **out_data,
+                                    size_t *out_data_size,
+                                    void *iovec_list);
+
 #ifdef __cplusplus
 }
 #endif
@@ -53,6 +53,25 @@ static inline state_with_error_t failure_state(avs_error_t error) {
     };
 }
 
+#ifdef WITH_AVS_COAP_Q_BLOCK
+static void q_block1_track_sent_payload(avs_coap_exchange_t *exchange) {
+    avs_coap_client_exchange_data_t *data = &exchange->by_type.client;
+    avs_coap_option_block_t request_block1;
+    if (data->q_block1
+            && avs_coap_options_get_block(&exchange->options, AVS_COAP_BLOCK1,
+                                          &request_block1)
+                           == 0
+            && request_block1.has_more) {
+        assert(data->q_block1_tokens_count
+               < AVS_ARRAY_SIZE(data->q_block1_tokens));
+        data->q_block1_tokens[data->q_block1_tokens_count++] = exchange->token;
+    }
+}
+
+static avs_error_t q_block1_send_next_payloads(
+        avs_coap_ctx_t *ctx, AVS_LIST(avs_coap_exchange_t) **exchange_ptr_ptr);
+#endif // WITH_AVS_COAP_Q_BLOCK
+
 static avs_error_t client_exchange_send_next_chunk(
         avs_coap_ctx_t *ctx, AVS_LIST(avs_coap_exchange_t) **exchange_ptr_ptr) {
     assert(exchange_ptr_ptr && *exchange_ptr_ptr && **exchange_ptr_ptr);
@@ -79,6 +98,11 @@ static avs_error_t client_exchange_send_next_chunk(
     if (*exchange_ptr_ptr && avs_is_err(err)) {
         (**exchange_ptr_ptr)->token = old_token;
     }
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    if (*exchange_ptr_ptr && avs_is_ok(err)) {
+        q_block1_track_sent_payload(**exchange_ptr_ptr);
+    }
+#endif // WITH_AVS_COAP_Q_BLOCK
     return err;
 }
 
@@ -86,7 +110,12 @@ static avs_error_t client_exchange_send_next_chunk(
 static inline size_t
 initial_block2_option_size(avs_coap_ctx_t *ctx,
                            const avs_coap_exchange_t *exchange) {
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+    assert(exchange->by_type.client.next_response_payload_offset > 0
+           || exchange->by_type.client.q_block2);
+#    else  // WITH_AVS_COAP_Q_BLOCK
     assert(exchange->by_type.client.next_response_payload_offset > 0);
+#    endif // WITH_AVS_COAP_Q_BLOCK
     (void) exchange;
 
     char buffer[64];
@@ -119,13 +148,20 @@ avs_error_t _avs_coap_client_exchange_send_first_chunk(
     assert(exchange_ptr_ptr && *exchange_ptr_ptr && **exchange_ptr_ptr);
     avs_error_t err = AVS_OK;
 #ifdef WITH_AVS_COAP_BLOCK
-    if ((**exchange_ptr_ptr)->by_type.client.next_response_payload_offset > 0
+    // Q-Block2 needs to be requested explicitly, even for the first block
+    bool force_block2 = false;
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+    force_block2 = (**exchange_ptr_ptr)->by_type.client.q_block2;
+#    endif // WITH_AVS_COAP_Q_BLOCK
+    if (((**exchange_ptr_ptr)->by_type.client.next_response_payload_offset > 0
+         || force_block2)
             && !_avs_coap_options_find_first_opt(&(**exchange_ptr_ptr)->options,
                                                  AVS_COAP_OPTION_BLOCK2)) {
         const size_t block_size =
                 initial_block2_option_size(ctx, **exchange_ptr_ptr);
         if ((**exchange_ptr_ptr)->by_type.client.next_response_payload_offset
-                >= block_size) {
+                        >= block_size
+                || force_block2) {
             err = avs_coap_options_add_block(
                     &(**exchange_ptr_ptr)->options,
                     &(avs_coap_option_block_t) {
@@ -135,7 +171,9 @@ avs_error_t _avs_coap_client_exchange_send_first_chunk(
                                                     ->by_type.client
                                                     .next_response_payload_offset
                                             / block_size),
-                        .size = (uint16_t) block_size
+                        .size = (uint16_t) block_size,
+                        .is_bert = (block_size == AVS_COAP_BLOCK_MAX_SIZE
+                                    && _avs_coap_bert_supported(ctx))
                     });
         }
     }
@@ -143,6 +181,11 @@ avs_error_t _avs_coap_client_exchange_send_first_chunk(
     if (avs_is_ok(err)) {
         err = client_exchange_send_next_chunk(ctx, exchange_ptr_ptr);
     }
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    if (avs_is_ok(err) && *exchange_ptr_ptr) {
+        err = q_block1_send_next_payloads(ctx, exchange_ptr_ptr);
+    }
+#endif // WITH_AVS_COAP_Q_BLOCK
     return err;
 }
 
@@ -302,6 +345,21 @@ static void cleanup_exchange(avs_coap_ctx_t *ctx,
     AVS_ASSERT(request_state.state != AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT,
                "cleanup_exchange must not be used for intermediate responses");
 
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    // Q-Block1 payloads sent before the one that finished the exchange may
+    // still be awaiting acknowledgement
+    while (exchange->by_type.client.q_block1_tokens_count > 0) {
+        avs_coap_token_t token =
+                exchange->by_type.client.q_block1_tokens
+                        [--exchange->by_type.client.q_block1_tokens_count];
+        ctx->vtable->abort_delivery(ctx, AVS_COAP_EXCHANGE_CLIENT_REQUEST,
+                                    &token, AVS_COAP_SEND_RESULT_CANCEL,
+                                    AVS_OK);
+    }
+    _avs_coap_client_exchange_forget_q_block1_first_payload(
+            &exchange->by_type.client);
+#endif // WITH_AVS_COAP_Q_BLOCK
+
     size_t response_payload_offset =
             final_msg ? get_response_payload_offset(final_msg) : 0;
     call_exchange_response_handler(ctx, exchange, final_msg,
@@ -326,6 +384,10 @@ static avs_error_t handle_request_block_size_renegotiation(
     assert(request_block);
     assert(response_block);
 
+    // The peer may ask for regular blocks instead of BERT ones by responding
+    // with SZX other than 7, even if the block size does not change.
+    request_block->is_bert = request_block->is_bert && response_block->is_bert;
+
     if (request_block->size == response_block->size) {
         return AVS_OK;
     } else if (request_block->size > response_block->size) {
@@ -533,6 +595,7 @@ static avs_error_t update_request_for_next_response_block(
 
     // do not include payload any more
     exchange->write_payload = NULL;
+    exchange->provide_payload = NULL;
     exchange->write_payload_arg = NULL;
     return AVS_OK;
 }
@@ -569,6 +632,7 @@ handle_final_response(avs_coap_ctx_t *ctx,
 
     // do not include any more payload in further requests
     (**exchange_ptr_ptr)->write_payload = NULL;
+    (**exchange_ptr_ptr)->provide_payload = NULL;
     (**exchange_ptr_ptr)->write_payload_arg = NULL;
     (**exchange_ptr_ptr)->eof_cache.empty = true;
 
@@ -669,6 +733,170 @@ handle_final_response(avs_coap_ctx_t *ctx,
         return failure_state(_avs_coap_err(AVS_COAP_ERR_MALFORMED_OPTIONS));
     }
 }
+
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+static size_t q_block1_window(avs_coap_ctx_t *ctx) {
+    const avs_coap_base_t *base = _avs_coap_get_base(ctx);
+    // until the remote endpoint is known to support Q-Block1, payloads are
+    // sent one by one, so that a 4.02 Bad Option response can be handled
+    // before anything else is sent
+    if (base->q_block1_support != AVS_COAP_Q_BLOCK_SUPPORTED) {
+        return 1;
+    }
+    return AVS_MAX(base->q_block1_max_payloads, 1);
+}
+
+static avs_error_t q_block1_send_next_payloads(
+        avs_coap_ctx_t *ctx, AVS_LIST(avs_coap_exchange_t) **exchange_ptr_ptr) {
+    assert(exchange_ptr_ptr && *exchange_ptr_ptr && **exchange_ptr_ptr);
+    avs_error_t err = AVS_OK;
+    while (avs_is_ok(err) && *exchange_ptr_ptr
+           && (**exchange_ptr_ptr)->by_type.client.q_block1
+           && exchange_expects_continue_response(**exchange_ptr_ptr)
+           && (**exchange_ptr_ptr)->by_type.client.q_block1_tokens_count
+                      < q_block1_window(ctx)) {
+        (void) (avs_is_err((err = update_exchange_for_next_request_block(
+                                    **exchange_ptr_ptr, NULL)))
+                || avs_is_err((err = client_exchange_send_next_chunk(
+                                       ctx, exchange_ptr_ptr))));
+    }
+    return err;
+}
+
+static void q_block1_untrack_payload(avs_coap_exchange_t *exchange,
+                                     const avs_coap_token_t *token) {
+    avs_coap_client_exchange_data_t *data = &exchange->by_type.client;
+    for (size_t i = 0; i < data->q_block1_tokens_count; ++i) {
+        if (avs_coap_token_equal(&data->q_block1_tokens[i], token)) {
+            data->q_block1_tokens[i] =
+                    data->q_block1_tokens[--data->q_block1_tokens_count];
+            return;
+        }
+    }
+}
+
+/**
+ * Retries a request whose first payload block has been rejected with 4.02 Bad
+ * Option, using the BLOCK1 option instead of Q-Block1.
+ *
+ * @returns false if that is not possible, i.e. the first payload block cannot
+ *          be retrieved again.
+ */
+static bool
+q_block1_retry_with_block1(avs_coap_ctx_t *ctx,
+                           AVS_LIST(avs_coap_exchange_t) **exchange_ptr_ptr,
+                           state_with_error_t *out_state) {
+    avs_coap_exchange_t *exchange = **exchange_ptr_ptr;
+    avs_coap_option_block_t request_block1;
+    // until Q-Block1 support is known, payloads are sent one by one, so the
+    // first one is the only one that has been sent
+    if (exchange->by_type.client.q_block1_tokens_count > 0
+            || avs_coap_options_get_block(&exchange->options, AVS_COAP_BLOCK1,
+                                          &request_block1)
+            || request_block1.seq_num != 0
+            || (!exchange->provide_payload
+                && !exchange->by_type.client.q_block1_first_payload)) {
+        return false;
+    }
+    exchange->by_type.client.q_block1 = false;
+    // the payload is read again from offset 0, see
+    // send_next_chunk_with_buffer()
+    exchange->eof_cache.empty = true;
+    avs_error_t err = client_exchange_send_next_chunk(ctx, exchange_ptr_ptr);
+    if (avs_is_err(err)) {
+        *out_state = failure_state(err);
+    } else {
+        *out_state = success_state(AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT);
+    }
+    return true;
+}
+
+/**
+ * Handles a response to a request payload sent using the Q-Block1 option.
+ *
+ * @returns true if @p response has been fully handled and its result stored in
+ *          @p out_state, false if it shall be handled as any other response.
+ */
+static bool
+handle_q_block1_response(avs_coap_ctx_t *ctx,
+                         AVS_LIST(avs_coap_exchange_t) **exchange_ptr_ptr,
+                         const avs_coap_borrowed_msg_t *response,
+                         state_with_error_t *out_state) {
+    avs_coap_base_t *base = _avs_coap_get_base(ctx);
+    q_block1_untrack_payload(**exchange_ptr_ptr, &response->token);
+
+    switch (response->code) {
+    case AVS_COAP_CODE_EMPTY:
+    case AVS_COAP_CODE_CONTINUE: {
+        // payload acknowledged - block size renegotiation is not supported,
+        // as further payloads might have been already sent
+        base->q_block1_support = AVS_COAP_Q_BLOCK_SUPPORTED;
+        _avs_coap_client_exchange_forget_q_block1_first_payload(
+                &(**exchange_ptr_ptr)->by_type.client);
+        avs_error_t err = q_block1_send_next_payloads(ctx, exchange_ptr_ptr);
+        if (avs_is_err(err)) {
+            *out_state = failure_state(err);
+        } else {
+            *out_state = success_state(AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT);
+        }
+        return true;
+    }
+
+    case AVS_COAP_CODE_BAD_OPTION:
+        if (base->q_block1_support == AVS_COAP_Q_BLOCK_SUPPORTED) {
+            return false;
+        }
+        if (base->q_block1_support == AVS_COAP_Q_BLOCK_SUPPORT_UNKNOWN) {
+            LOG(INFO, _("Q-Block1 option rejected, using BLOCK1 for further "
+                        "requests"));
+            base->q_block1_support = AVS_COAP_Q_BLOCK_UNSUPPORTED;
+        }
+        return q_block1_retry_with_block1(ctx, exchange_ptr_ptr, out_state);
+
+    default:
+        return false;
+    }
+}
+
+/**
+ * Handles a response to a request for response payload blocks sent using the
+ * Q-Block2 option.
+ *
+ * @returns true if @p response has been fully handled and its result stored in
+ *          @p out_state, false if it shall be handled as any other response.
+ */
+static bool
+handle_q_block2_response(avs_coap_ctx_t *ctx,
+                         AVS_LIST(avs_coap_exchange_t) **exchange_ptr_ptr,
+                         const avs_coap_borrowed_msg_t *response,
+                         state_with_error_t *out_state) {
+    avs_coap_base_t *base = _avs_coap_get_base(ctx);
+    if (_avs_coap_option_exists(&response->options,
+                                AVS_COAP_OPTION_Q_BLOCK2)) {
+        base->q_block2_support = AVS_COAP_Q_BLOCK_SUPPORTED;
+        return false;
+    }
+    if (response->code != AVS_COAP_CODE_BAD_OPTION
+            || base->q_block2_support == AVS_COAP_Q_BLOCK_SUPPORTED) {
+        return false;
+    }
+    if (base->q_block2_support == AVS_COAP_Q_BLOCK_SUPPORT_UNKNOWN) {
+        LOG(INFO, _("Q-Block2 option rejected, using BLOCK2 for further "
+                    "requests"));
+        base->q_block2_support = AVS_COAP_Q_BLOCK_UNSUPPORTED;
+    }
+    // Q-Block2 is only used for GET requests, so there is no request payload
+    // that would need to be sent again
+    (**exchange_ptr_ptr)->by_type.client.q_block2 = false;
+    avs_error_t err = client_exchange_send_next_chunk(ctx, exchange_ptr_ptr);
+    if (avs_is_err(err)) {
+        *out_state = failure_state(err);
+    } else {
+        *out_state = success_state(AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT);
+    }
+    return true;
+}
+#    endif // WITH_AVS_COAP_Q_BLOCK
 #else  // WITH_AVS_COAP_BLOCK
 static avs_error_t update_exchange_for_next_request_block(
         avs_coap_exchange_t *exchange,
@@ -691,6 +919,7 @@ handle_final_response(avs_coap_ctx_t *ctx,
     assert(response);
 
     (**exchange_ptr_ptr)->write_payload = NULL;
+    (**exchange_ptr_ptr)->provide_payload = NULL;
     (**exchange_ptr_ptr)->write_payload_arg = NULL;
     (**exchange_ptr_ptr)->eof_cache.empty = true;
 
@@ -715,8 +944,10 @@ client_exchange_send_all(avs_coap_ctx_t *ctx,
 
     if (*exchange_ptr_ptr) {
         if (avs_is_err(err)) {
-            cleanup_exchange(ctx, AVS_LIST_DETACH(*exchange_ptr_ptr), NULL,
-                             failure_state(err));
+            cleanup_exchange(ctx,
+                             _avs_coap_exchange_list_detach(ctx,
+                                                            *exchange_ptr_ptr),
+                             NULL, failure_state(err));
         } else {
             avs_coap_exchange_cancel(ctx, (**exchange_ptr_ptr)->id);
         }
@@ -749,11 +980,27 @@ client_exchange_start(avs_coap_ctx_t *ctx,
            && !_avs_coap_client_exchange_request_sent(*insert_ptr)) {
         AVS_LIST_ADVANCE_PTR(&insert_ptr);
     }
-    AVS_LIST_INSERT(insert_ptr, *exchange_ptr);
-    assert(*insert_ptr == *exchange_ptr);
     (*exchange_ptr)->id = _avs_coap_generate_exchange_id(ctx);
+    _avs_coap_exchange_list_insert(ctx, insert_ptr, *exchange_ptr, false);
+    assert(*insert_ptr == *exchange_ptr);
 
     avs_error_t err = AVS_OK;
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    // Q-Block1 payloads need to be confirmable, and only requests with
+    // a response handler are sent as such
+    const avs_coap_base_t *base = _avs_coap_get_base(ctx);
+    (*exchange_ptr)->by_type.client.q_block1 =
+            (*exchange_ptr)->by_type.client.handle_response
+            && base->q_block1_max_payloads > 0
+            && base->q_block1_support != AVS_COAP_Q_BLOCK_UNSUPPORTED;
+    // only downloads are done using Q-Block2; other methods may need to
+    // combine it with BLOCK1 or Q-Block1, which is not supported
+    (*exchange_ptr)->by_type.client.q_block2 =
+            (*exchange_ptr)->by_type.client.handle_response
+            && (*exchange_ptr)->code == AVS_COAP_CODE_GET
+            && base->q_block2_enabled
+            && base->q_block2_support != AVS_COAP_Q_BLOCK_UNSUPPORTED;
+#endif // WITH_AVS_COAP_Q_BLOCK
     if ((*exchange_ptr)->by_type.client.handle_response) {
         *out_id = (*exchange_ptr)->id;
         _avs_coap_reschedule_retry_or_request_expired_job(
@@ -774,6 +1021,18 @@ handle_response(avs_coap_ctx_t *ctx,
     assert(response);
     assert(exchange_ptr_ptr && *exchange_ptr_ptr && **exchange_ptr_ptr);
 
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    state_with_error_t q_block_state;
+    if (((**exchange_ptr_ptr)->by_type.client.q_block1
+         && handle_q_block1_response(ctx, exchange_ptr_ptr, response,
+                                     &q_block_state))
+            || ((**exchange_ptr_ptr)->by_type.client.q_block2
+                && handle_q_block2_response(ctx, exchange_ptr_ptr, response,
+                                            &q_block_state))) {
+        return q_block_state;
+    }
+#endif // WITH_AVS_COAP_Q_BLOCK
+
     switch (response->code) {
     case AVS_COAP_CODE_CONTINUE:
 #ifdef WITH_AVS_COAP_BLOCK
@@ -883,7 +1142,9 @@ on_request_delivery_finished(avs_coap_ctx_t *ctx,
                              avs_error_t fail_err,
                              const avs_coap_borrowed_msg_t *response,
                              void *exchange) {
-    assert(!response || avs_coap_code_is_response(response->code));
+    // Empty response means an acknowledged Q-Block1 payload
+    assert(!response || avs_coap_code_is_response(response->code)
+           || response->code == AVS_COAP_CODE_EMPTY);
 
     avs_coap_exchange_id_t exchange_id = ((avs_coap_exchange_t *) exchange)->id;
     AVS_LIST(avs_coap_exchange_t) *exchange_ptr =
@@ -929,8 +1190,8 @@ on_request_delivery_finished(avs_coap_ctx_t *ctx,
 
     assert(!exchange_ptr || *exchange_ptr);
     if (exchange_ptr) {
-        cleanup_exchange(ctx, AVS_LIST_DETACH(exchange_ptr), response,
-                         request_state);
+        cleanup_exchange(ctx, _avs_coap_exchange_list_detach(ctx, exchange_ptr),
+                         response, request_state);
     }
 
     return AVS_COAP_RESPONSE_ACCEPTED;
@@ -940,10 +1201,12 @@ static AVS_LIST(avs_coap_exchange_t) client_exchange_create(
         uint8_t code,
         const avs_coap_options_t *options,
         avs_coap_payload_writer_t *payload_writer,
+        avs_coap_payload_provider_t *payload_provider,
         void *payload_writer_arg,
         avs_coap_client_async_response_handler_t *response_handler,
         void *response_handler_arg) {
     assert(avs_coap_code_is_request(code));
+    assert(!payload_writer || !payload_provider);
 
     // Add a few extra bytes for BLOCK1 option in case the request turns out
     // to be large
@@ -967,6 +1230,7 @@ static AVS_LIST(avs_coap_exchange_t) client_exchange_create(
     *exchange = (avs_coap_exchange_t) {
         .id = AVS_COAP_EXCHANGE_ID_INVALID,
         .write_payload = payload_writer,
+        .provide_payload = payload_provider,
         .write_payload_arg = payload_writer_arg,
         .code = code,
         .eof_cache = {
@@ -1025,14 +1289,15 @@ static AVS_LIST(avs_coap_exchange_t) client_exchange_create(
     return exchange;
 }
 
-avs_error_t avs_coap_client_send_async_request(
-        avs_coap_ctx_t *ctx,
-        avs_coap_exchange_id_t *out_exchange_id,
-        const avs_coap_request_header_t *req,
-        avs_coap_payload_writer_t *request_writer,
-        void *request_writer_arg,
-        avs_coap_client_async_response_handler_t *response_handler,
-        void *response_handler_arg) {
+static avs_error_t
+send_async_request(avs_coap_ctx_t *ctx,
+                   avs_coap_exchange_id_t *out_exchange_id,
+                   const avs_coap_request_header_t *req,
+                   avs_coap_payload_writer_t *request_writer,
+                   avs_coap_payload_provider_t *request_provider,
+                   void *request_writer_arg,
+                   avs_coap_client_async_response_handler_t *response_handler,
+                   void *response_handler_arg) {
     assert(ctx);
     assert(ctx->vtable);
     assert(req);
@@ -1043,8 +1308,8 @@ avs_error_t avs_coap_client_send_async_request(
 
     AVS_LIST(avs_coap_exchange_t) exchange =
             client_exchange_create(req->code, &req->options, request_writer,
-                                   request_writer_arg, response_handler,
-                                   response_handler_arg);
+                                   request_provider, request_writer_arg,
+                                   response_handler, response_handler_arg);
     if (!exchange) {
         return avs_errno(AVS_ENOMEM);
     }
@@ -1061,7 +1326,8 @@ avs_error_t avs_coap_client_send_async_request(
                 // Not using _avs_coap_client_exchange_cleanup() or
                 // cleanup_exchange(), because this function's docs say that
                 // response_handler is not called on error.
-                AVS_LIST_DELETE(exchange_ptr);
+                exchange = _avs_coap_exchange_list_detach(ctx, exchange_ptr);
+                AVS_LIST_DELETE(&exchange);
             }
         }
         return err;
@@ -1073,6 +1339,32 @@ avs_error_t avs_coap_client_send_async_request(
     return AVS_OK;
 }
 
+avs_error_t avs_coap_client_send_async_request(
+        avs_coap_ctx_t *ctx,
+        avs_coap_exchange_id_t *out_exchange_id,
+        const avs_coap_request_header_t *req,
+        avs_coap_payload_writer_t *request_writer,
+        void *request_writer_arg,
+        avs_coap_client_async_response_handler_t *response_handler,
+        void *response_handler_arg) {
+    return send_async_request(ctx, out_exchange_id, req, request_writer, NULL,
+                              request_writer_arg, response_handler,
+                              response_handler_arg);
+}
+
+avs_error_t avs_coap_client_send_async_request_with_provider(
+        avs_coap_ctx_t *ctx,
+        avs_coap_exchange_id_t *out_exchange_id,
+        const avs_coap_request_header_t *req,
+        avs_coap_payload_provider_t *request_provider,
+        void *request_provider_arg,
+        avs_coap_client_async_response_handler_t *response_handler,
+        void *response_handler_arg) {
+    return send_async_request(ctx, out_exchange_id, req, NULL,
+                              request_provider, request_provider_arg,
+                              response_handler, response_handler_arg);
+}
+
 void _avs_coap_client_exchange_cleanup(avs_coap_ctx_t *ctx,
                                        avs_coap_exchange_t *exchange,
                                        avs_error_t err) {
@@ -10,7 +10,10 @@
 #ifndef AVS_COAP_SRC_ASYNC_CLIENT_H
 #define AVS_COAP_SRC_ASYNC_CLIENT_H
 
+#include <avsystem/commons/avs_memory.h>
+
 #include <avsystem/coap/async_client.h>
+#include <avsystem/coap/udp.h>
 
 #include "avs_coap_ctx_vtable.h"
 
@@ -49,10 +52,44 @@ typedef struct avs_coap_client_exchange_data {
     avs_coap_etag_t etag;
     /** Indicating that ETag from the first response was stored. */
     bool etag_stored;
+
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    /** True if request payload blocks are sent using the Q-Block1 option. */
+    bool q_block1;
+
+    /**
+     * Tokens of non-final Q-Block1 payloads that have been sent, but not yet
+     * acknowledged.
+     */
+    avs_coap_token_t q_block1_tokens[AVS_COAP_UDP_Q_BLOCK1_MAX_PAYLOADS];
+    size_t q_block1_tokens_count;
+
+    /**
+     * Copy of the first request payload block (including the byte that follows
+     * it), kept until the remote endpoint is known to support Q-Block1, so that
+     * the request can be retried using BLOCK1 if it responds with 4.02 Bad
+     * Option. Payload writers cannot be asked for the same data twice.
+     */
+    uint8_t *q_block1_first_payload;
+    size_t q_block1_first_payload_size;
+
+    /** True if response payload blocks are requested using Q-Block2. */
+    bool q_block2;
+#endif // WITH_AVS_COAP_Q_BLOCK
 } avs_coap_client_exchange_data_t;
 
 struct avs_coap_exchange;
 
+#ifdef WITH_AVS_COAP_Q_BLOCK
+static inline void
+_avs_coap_client_exchange_forget_q_block1_first_payload(
+        avs_coap_client_exchange_data_t *data) {
+    avs_free(data->q_block1_first_payload);
+    data->q_block1_first_payload = NULL;
+    data->q_block1_first_payload_size = 0;
+}
+#endif // WITH_AVS_COAP_Q_BLOCK
+
 avs_error_t _avs_coap_client_exchange_send_first_chunk(
         avs_coap_ctx_t *ctx,
         AVS_LIST(struct avs_coap_exchange) **exchange_ptr_ptr);
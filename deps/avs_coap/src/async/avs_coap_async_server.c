@@ -104,6 +104,7 @@ typedef struct {
     const avs_coap_options_t *response_options;
 
     avs_coap_payload_writer_t *response_writer;
+    avs_coap_payload_provider_t *response_provider;
     void *response_writer_arg;
 
     avs_coap_server_async_request_handler_t *request_handler;
@@ -147,6 +148,7 @@ server_exchange_create(avs_coap_ctx_t *ctx,
     *exchange = (avs_coap_exchange_t) {
         .id = args->exchange_id,
         .write_payload = args->response_writer,
+        .provide_payload = args->response_provider,
         .write_payload_arg = args->response_writer_arg,
         .code = args->response_code,
         .token = args->request->token,
@@ -335,8 +337,8 @@ send_result_handler(avs_coap_ctx_t *ctx,
 
     // make sure we won't call the handler again during exchange cleanup
     (*exchange_ptr)->by_type.server.delivery_handler = NULL;
-    _avs_coap_server_exchange_cleanup(ctx, AVS_LIST_DETACH(exchange_ptr),
-                                      fail_err);
+    _avs_coap_server_exchange_cleanup(
+            ctx, _avs_coap_exchange_list_detach(ctx, exchange_ptr), fail_err);
 
     return AVS_COAP_RESPONSE_ACCEPTED;
 }
@@ -397,8 +399,8 @@ static avs_error_t server_exchange_send_next_chunk(
     exchange_ptr = _avs_coap_find_server_exchange_ptr_by_id(ctx, id);
 
     if (exchange_ptr && is_exchange_done(*exchange_ptr)) {
-        _avs_coap_server_exchange_cleanup(ctx, AVS_LIST_DETACH(exchange_ptr),
-                                          AVS_OK);
+        _avs_coap_server_exchange_cleanup(
+                ctx, _avs_coap_exchange_list_detach(ctx, exchange_ptr), AVS_OK);
     }
     return err;
 }
@@ -416,7 +418,9 @@ _avs_coap_async_server_abort_timedout_exchanges(avs_coap_ctx_t *ctx) {
             AVS_UINT64_AS_STRING(coap_base->server_exchanges->id.value));
 
         _avs_coap_server_exchange_cleanup(
-                ctx, AVS_LIST_DETACH(&coap_base->server_exchanges),
+                ctx,
+                _avs_coap_exchange_list_detach(ctx,
+                                               &coap_base->server_exchanges),
                 _avs_coap_err(AVS_COAP_ERR_TIMEOUT));
     }
 
@@ -439,7 +443,7 @@ insert_server_exchange(avs_coap_ctx_t *ctx, avs_coap_exchange_t *new_exchange) {
         }
     }
 
-    AVS_LIST_INSERT(insert_ptr, new_exchange);
+    _avs_coap_exchange_list_insert(ctx, insert_ptr, new_exchange, true);
     _avs_coap_reschedule_retry_or_request_expired_job(
             ctx, coap_base->server_exchanges->by_type.server.exchange_deadline);
 
@@ -451,7 +455,8 @@ refresh_exchange(avs_coap_ctx_t *ctx,
                  AVS_LIST(avs_coap_exchange_t) *exchange_ptr) {
     (*exchange_ptr)->by_type.server.exchange_deadline =
             get_exchange_deadline(ctx);
-    return insert_server_exchange(ctx, AVS_LIST_DETACH(exchange_ptr));
+    return insert_server_exchange(
+            ctx, _avs_coap_exchange_list_detach(ctx, exchange_ptr));
 }
 
 avs_coap_exchange_id_t avs_coap_server_accept_async_request(
@@ -597,7 +602,9 @@ avs_coap_server_setup_async_response(avs_coap_request_ctx_t *ctx,
     //
     // Deleting the old exchange only if we're sure we have a new copy seems
     // the most robust solution.
-    AVS_LIST_DELETE(response_exchange_ptr);
+    AVS_LIST(avs_coap_exchange_t) old_exchange =
+            _avs_coap_exchange_list_detach(coap_ctx, response_exchange_ptr);
+    AVS_LIST_DELETE(&old_exchange);
     insert_server_exchange(coap_ctx, new_exchange);
 
     ctx->response_setup = true;
@@ -874,6 +881,13 @@ update_exchange_block2_option(avs_coap_exchange_t *exchange,
                                             &block2);
     avs_coap_options_remove_by_number(&exchange->options,
                                       AVS_COAP_OPTION_BLOCK2);
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+    // Q-Block2 is converted back to BLOCK2 above; the response blocks are sent
+    // using Q-Block2, as required by RFC 9177, 4.4
+    exchange->by_type.server.q_block2 =
+            _avs_coap_option_exists(&request->options,
+                                    AVS_COAP_OPTION_Q_BLOCK2);
+#    endif // WITH_AVS_COAP_Q_BLOCK
 
     if (result == AVS_COAP_OPTION_MISSING) {
         return;
@@ -947,8 +961,8 @@ static void cleanup_exchange_by_id(avs_coap_ctx_t *ctx,
     AVS_LIST(avs_coap_exchange_t) *exchange_ptr =
             _avs_coap_find_server_exchange_ptr_by_id(ctx, exchange_id);
     if (exchange_ptr) {
-        _avs_coap_server_exchange_cleanup(ctx, AVS_LIST_DETACH(exchange_ptr),
-                                          err);
+        _avs_coap_server_exchange_cleanup(
+                ctx, _avs_coap_exchange_list_detach(ctx, exchange_ptr), err);
     }
 }
 
@@ -1203,11 +1217,18 @@ avs_error_t _avs_coap_async_incoming_packet_handle_and_exhaust_socket(
                                    })))) {
         return err;
     }
+    const size_t budget =
+            ctx->vtable->receive_budget ? ctx->vtable->receive_budget(ctx) : 1;
+    size_t handled = 0;
     while (avs_is_ok(err)) {
         err = _avs_coap_async_incoming_packet_simple_handle_single(
                 ctx, in_buffer, in_buffer_size, on_new_request,
                 on_new_request_arg);
-        if (avs_is_ok(err) && _avs_coap_socket_definitely_exhausted(ctx)) {
+        // Within the budget, the socket is not asked about buffered data:
+        // there might be more messages waiting in the system socket buffer,
+        // which is only checked by trying to receive them.
+        if (avs_is_ok(err) && ++handled >= budget
+                && _avs_coap_socket_definitely_exhausted(ctx)) {
             // We can conclusively say that the socket is already exhausted,
             // so no need to try receiving more packets.
             break;
@@ -1311,16 +1332,17 @@ avs_coap_observe_async_start(avs_coap_request_ctx_t *ctx,
     return err;
 }
 
-avs_error_t
-avs_coap_notify_async(avs_coap_ctx_t *ctx,
-                      avs_coap_exchange_id_t *out_exchange_id,
-                      avs_coap_observe_id_t observe_id,
-                      const avs_coap_response_header_t *response_header,
-                      avs_coap_notify_reliability_hint_t reliability_hint,
-                      avs_coap_payload_writer_t *write_payload,
-                      void *write_payload_arg,
-                      avs_coap_delivery_status_handler_t *delivery_handler,
-                      void *delivery_handler_arg) {
+static avs_error_t
+notify_async(avs_coap_ctx_t *ctx,
+             avs_coap_exchange_id_t *out_exchange_id,
+             avs_coap_observe_id_t observe_id,
+             const avs_coap_response_header_t *response_header,
+             avs_coap_notify_reliability_hint_t reliability_hint,
+             avs_coap_payload_writer_t *write_payload,
+             avs_coap_payload_provider_t *provide_payload,
+             void *write_payload_arg,
+             avs_coap_delivery_status_handler_t *delivery_handler,
+             void *delivery_handler_arg) {
     if (!avs_coap_code_is_response(response_header->code)) {
         LOG(ERROR, "%s" _(" is not a valid response code"),
             AVS_COAP_CODE_STRING(response_header->code));
@@ -1354,6 +1376,7 @@ avs_coap_notify_async(avs_coap_ctx_t *ctx,
         .response_code = response_header->code,
         .response_options = &response_header->options,
         .response_writer = write_payload,
+        .response_provider = provide_payload,
         .response_writer_arg = write_payload_arg,
         .reliability_hint = reliability_hint,
         .delivery_handler = delivery_handler,
@@ -1372,7 +1395,8 @@ avs_coap_notify_async(avs_coap_ctx_t *ctx,
 
     avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
 
-    AVS_LIST_INSERT(&coap_base->server_exchanges, exchange);
+    _avs_coap_exchange_list_insert(ctx, &coap_base->server_exchanges, exchange,
+                                   true);
 
     if (reliability_hint == AVS_COAP_NOTIFY_PREFER_NON_CONFIRMABLE) {
         cancel_notification_on_error(ctx, observe_id, response_header->code);
@@ -1391,7 +1415,8 @@ avs_coap_notify_async(avs_coap_ctx_t *ctx,
         if (exchange_ptr) {
             // Not using _avs_coap_server_exchange_cleanup(), because this
             // function's docs say that delivery_handler is not called on error.
-            AVS_LIST_DELETE(exchange_ptr);
+            exchange = _avs_coap_exchange_list_detach(ctx, exchange_ptr);
+            AVS_LIST_DELETE(&exchange);
         }
         return err;
     }
@@ -1402,4 +1427,36 @@ avs_coap_notify_async(avs_coap_ctx_t *ctx,
     }
     return AVS_OK;
 }
+
+avs_error_t
+avs_coap_notify_async(avs_coap_ctx_t *ctx,
+                      avs_coap_exchange_id_t *out_exchange_id,
+                      avs_coap_observe_id_t observe_id,
+                      const avs_coap_response_header_t *response_header,
+                      avs_coap_notify_reliability_hint_t reliability_hint,
+                      avs_coap_payload_writer_t *write_payload,
+                      void *write_payload_arg,
+                      avs_coap_delivery_status_handler_t *delivery_handler,
+                      void *delivery_handler_arg) {
+    return notify_async(ctx, out_exchange_id, observe_id, response_header,
+                        reliability_hint, write_payload, NULL,
+                        write_payload_arg, delivery_handler,
+                        delivery_handler_arg);
+}
+
+avs_error_t avs_coap_notify_async_with_provider(
+        avs_coap_ctx_t *ctx,
+        avs_coap_exchange_id_t *out_exchange_id,
+        avs_coap_observe_id_t observe_id,
+        const avs_coap_response_header_t *response_header,
+        avs_coap_notify_reliability_hint_t reliability_hint,
+        avs_coap_payload_provider_t *provide_payload,
+        void *provide_payload_arg,
+        avs_coap_delivery_status_handler_t *delivery_handler,
+        void *delivery_handler_arg) {
+    return notify_async(ctx, out_exchange_id, observe_id, response_header,
+                        reliability_hint, NULL, provide_payload,
+                        provide_payload_arg, delivery_handler,
+                        delivery_handler_arg);
+}
 #endif // WITH_AVS_COAP_OBSERVE
@@ -71,6 +71,14 @@ typedef struct avs_coap_server_exchange_data {
      * block size.
      */
     size_t expected_request_payload_offset;
+
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    /**
+     * True if the remote client requested the response using the Q-Block2
+     * option. Response payload blocks are then sent using Q-Block2 as well.
+     */
+    bool q_block2;
+#endif // WITH_AVS_COAP_Q_BLOCK
 } avs_coap_server_exchange_data_t;
 
 struct avs_coap_server_ctx {
@@ -246,6 +254,10 @@ avs_error_t _avs_coap_async_incoming_packet_simple_handle_single(
  * returns true) or by waiting for the socket receive operation to time out
  * (while the receive timeout is set to zero).
  *
+ * If the context implements the <c>receive_budget</c> virtual method, the
+ * former check is skipped until that many messages have been handled, so that
+ * messages pipelined by the peer are all handled during a single call.
+ *
  * @ref _avs_coap_async_incoming_packet_simple_handle_single is called at least
  * once.
  */
@@ -14,7 +14,10 @@
 
 #include <avs_coap_init.h>
 
+#include <string.h>
+
 #include <avsystem/commons/avs_errno.h>
+#include <avsystem/commons/avs_memory.h>
 
 #include <avsystem/coap/async_client.h>
 
@@ -162,6 +165,130 @@ fetch_payload_with_cache(avs_coap_ctx_t *ctx,
     return AVS_OK;
 }
 
+static avs_error_t
+call_payload_provider(avs_coap_payload_provider_t *provide_payload,
+                      void *provide_payload_arg,
+                      size_t payload_offset,
+                      const uint8_t **out_data,
+                      size_t *out_data_size) {
+    const void *data = NULL;
+    *out_data_size = 0;
+    int result = provide_payload(payload_offset, &data, out_data_size,
+                                 provide_payload_arg);
+    LOG(TRACE,
+        _("provide_payload(offset = ") "%u" _(") = ") "%d" _("; got ") "%u" _(
+                " B"),
+        (unsigned) payload_offset, result, (unsigned) *out_data_size);
+
+    if (result) {
+        LOG(DEBUG, _("unable to get request payload (result = ") "%d" _(")"),
+            result);
+        return _avs_coap_err(AVS_COAP_ERR_PAYLOAD_WRITER_FAILED);
+    }
+    if (!data) {
+        *out_data_size = 0;
+    }
+    *out_data = (const uint8_t *) data;
+    return AVS_OK;
+}
+
+/*
+ * Counterpart of fetch_payload_with_cache() for payload accessed through
+ * avs_coap_payload_provider_t. Reads at most (buffer_size - 1) bytes starting
+ * at @p payload_offset, using up to one more byte to detect EOF; only the
+ * "empty" flag of @p cache is used.
+ *
+ * If the whole chunk is available as a single memory region,
+ * @p out_payload is set to point directly into it and @p buffer is left
+ * untouched. Otherwise the chunk is gathered into @p buffer .
+ */
+static avs_error_t
+fetch_payload_by_reference(avs_coap_payload_provider_t *provide_payload,
+                           void *provide_payload_arg,
+                           size_t payload_offset,
+                           uint8_t *buffer,
+                           size_t buffer_size,
+                           const uint8_t **out_payload,
+                           size_t *out_bytes_read,
+                           eof_cache_t *cache) {
+    assert(buffer_size > 0);
+    const size_t chunk_size = buffer_size - 1;
+
+    *out_payload = buffer;
+    *out_bytes_read = 0;
+    cache->empty = true;
+    if (!provide_payload) {
+        return AVS_OK;
+    }
+
+    const uint8_t *data;
+    size_t data_size;
+    avs_error_t err =
+            call_payload_provider(provide_payload, provide_payload_arg,
+                                  payload_offset, &data, &data_size);
+    if (avs_is_err(err)) {
+        return err;
+    }
+
+    if (data_size >= chunk_size) {
+        if (data_size == chunk_size) {
+            const uint8_t *next_data;
+            size_t next_data_size;
+            if (avs_is_err((err = call_payload_provider(
+                                    provide_payload, provide_payload_arg,
+                                    payload_offset + chunk_size, &next_data,
+                                    &next_data_size)))) {
+                return err;
+            }
+            cache->empty = (next_data_size == 0);
+        } else {
+            cache->empty = false;
+        }
+        *out_payload = data;
+        *out_bytes_read = chunk_size;
+        return AVS_OK;
+    }
+
+    size_t bytes_gathered = 0;
+    while (data_size > 0) {
+        size_t bytes_to_copy = AVS_MIN(data_size, buffer_size - bytes_gathered);
+        memcpy(&buffer[bytes_gathered], data, bytes_to_copy);
+        bytes_gathered += bytes_to_copy;
+        if (bytes_gathered == buffer_size) {
+            break;
+        }
+        if (avs_is_err((err = call_payload_provider(
+                                provide_payload, provide_payload_arg,
+                                payload_offset + bytes_gathered, &data,
+                                &data_size)))) {
+            return err;
+        }
+    }
+
+    cache->empty = (bytes_gathered <= chunk_size);
+    *out_bytes_read = AVS_MIN(bytes_gathered, chunk_size);
+    return AVS_OK;
+}
+
+int avs_coap_payload_iovec_provider(size_t payload_offset,
+                                    const void **out_data,
+                                    size_t *out_data_size,
+                                    void *iovec_list_) {
+    const avs_coap_payload_iovec_list_t *iovec_list =
+            (const avs_coap_payload_iovec_list_t *) iovec_list_;
+    for (size_t i = 0; i < iovec_list->iovcnt; ++i) {
+        const avs_coap_payload_iovec_t *iov = &iovec_list->iov[i];
+        if (payload_offset < iov->size) {
+            *out_data = (const uint8_t *) iov->data + payload_offset;
+            *out_data_size = iov->size - payload_offset;
+            return 0;
+        }
+        payload_offset -= iov->size;
+    }
+    // end of payload
+    return 0;
+}
+
 #ifdef WITH_AVS_COAP_BLOCK
 static avs_error_t lower_block_size(avs_coap_exchange_t *exchange,
                                     size_t max_payload_size) {
@@ -312,7 +439,14 @@ exchange_add_initial_block_option(avs_coap_exchange_t *exchange,
                                   size_t payload_offset,
                                   size_t payload_size) {
     assert(!exchange->eof_cache.empty);
-    assert(payload_size <= UINT16_MAX);
+
+    // Payload chunks larger than a single block are only ever calculated if
+    // the peer supports BERT, see _avs_coap_get_max_block_size()
+    const bool is_bert = (payload_size > AVS_COAP_BLOCK_MAX_SIZE);
+    if (is_bert) {
+        assert(payload_size % AVS_COAP_BLOCK_MAX_SIZE == 0);
+        payload_size = AVS_COAP_BLOCK_MAX_SIZE;
+    }
     assert(_avs_coap_is_valid_block_size((uint16_t) payload_size));
     assert(payload_offset % payload_size == 0);
     assert(payload_offset / payload_size <= UINT_MAX);
@@ -322,7 +456,8 @@ exchange_add_initial_block_option(avs_coap_exchange_t *exchange,
                                                          : AVS_COAP_BLOCK2,
         .seq_num = (unsigned) (payload_offset / payload_size),
         .has_more = true,
-        .size = (uint16_t) payload_size
+        .size = (uint16_t) payload_size,
+        .is_bert = is_bert
     };
 
     if (avs_is_err(avs_coap_options_add_block(&exchange->options, &block))) {
@@ -361,27 +496,106 @@ static avs_error_t exchange_update_block_option(avs_coap_exchange_t *exchange,
     }
     return AVS_OK;
 }
+
+/**
+ * Existing logic determining the block that follows the last one sent (and
+ * matching requests for it) assumes one block per message. After sending
+ * a BERT message with more than one block of payload, the BLOCK option is
+ * updated to refer to the last of them, so that the same logic holds.
+ */
+static void exchange_skip_sent_bert_blocks(avs_coap_exchange_t *exchange,
+                                           size_t payload_size) {
+    avs_coap_option_block_t block;
+    bool has_block;
+    if (avs_is_err(_avs_coap_options_get_block_by_code(
+                &exchange->options, exchange->code, &block, &has_block))
+            || !has_block || !block.is_bert || !block.has_more
+            || payload_size <= block.size) {
+        return;
+    }
+
+    block.seq_num += (uint32_t) (payload_size / block.size - 1);
+    avs_coap_options_remove_by_number(&exchange->options,
+                                      _avs_coap_option_num_from_block_type(
+                                              block.type));
+    if (avs_is_err(avs_coap_options_add_block(&exchange->options, &block))) {
+        AVS_UNREACHABLE("cannot rewrite BLOCK option even though its size did "
+                        "not change");
+    }
+}
 #endif // WITH_AVS_COAP_BLOCK
 
-avs_error_t _avs_coap_exchange_send_next_chunk(
-        avs_coap_ctx_t *ctx,
-        avs_coap_exchange_t *exchange,
-        avs_coap_send_result_handler_t *send_result_handler,
-        void *send_result_handler_arg) {
-    avs_coap_exchange_id_t id = exchange->id;
+#ifdef WITH_AVS_COAP_Q_BLOCK
+/**
+ * Payload writer that replays the copy of the first request payload block
+ * stored by q_block1_remember_first_payload().
+ */
+static int q_block1_first_payload_writer(size_t payload_offset,
+                                         void *payload_buf,
+                                         size_t payload_buf_size,
+                                         size_t *out_payload_chunk_size,
+                                         void *data_) {
+    const avs_coap_client_exchange_data_t *data =
+            (const avs_coap_client_exchange_data_t *) data_;
+    // the block size may only change if the retried block is smaller, which
+    // would make the original writer called with a wrong offset later
+    if (payload_offset != 0
+            || payload_buf_size != data->q_block1_first_payload_size) {
+        LOG(DEBUG, _("cannot retry the first request block using BLOCK1"));
+        return -1;
+    }
+    memcpy(payload_buf, data->q_block1_first_payload, payload_buf_size);
+    *out_payload_chunk_size = payload_buf_size;
+    return 0;
+}
 
-    // 1 byte extra to handle eof_cache
-    uint8_t payload_buf[AVS_COAP_EXCHANGE_OUTGOING_CHUNK_PAYLOAD_MAX_SIZE];
-    size_t bytes_to_read;
-    avs_error_t err =
-            exchange_get_next_outgoing_chunk_payload_size(ctx, exchange,
-                                                          &bytes_to_read);
-    if (avs_is_err(err)) {
-        return err;
+/**
+ * Stores a copy of the first block of a request payload sent using Q-Block1,
+ * until the remote endpoint is known to support the option. Such a copy is only
+ * necessary for payload writers and a payload that spans multiple blocks.
+ */
+static void q_block1_remember_first_payload(avs_coap_ctx_t *ctx,
+                                            avs_coap_exchange_t *exchange,
+                                            const uint8_t *payload,
+                                            size_t payload_size) {
+    avs_coap_client_exchange_data_t *data = &exchange->by_type.client;
+    if (!data->q_block1 || exchange->provide_payload
+            || exchange->eof_cache.empty || data->q_block1_first_payload) {
+        return;
+    }
+    switch (_avs_coap_get_base(ctx)->q_block1_support) {
+    case AVS_COAP_Q_BLOCK_SUPPORTED:
+        return;
+    case AVS_COAP_Q_BLOCK_UNSUPPORTED:
+        // rejected in another exchange since this one has been started
+        data->q_block1 = false;
+        return;
+    case AVS_COAP_Q_BLOCK_SUPPORT_UNKNOWN:
+        break;
     }
-    assert(bytes_to_read < sizeof(payload_buf));
+    if (!(data->q_block1_first_payload =
+                  (uint8_t *) avs_malloc(payload_size + 1))) {
+        LOG(WARNING, _("out of memory, sending request using BLOCK1"));
+        data->q_block1 = false;
+        return;
+    }
+    memcpy(data->q_block1_first_payload, payload, payload_size);
+    data->q_block1_first_payload[payload_size] = exchange->eof_cache.value;
+    data->q_block1_first_payload_size = payload_size + 1;
+}
+#endif // WITH_AVS_COAP_Q_BLOCK
+
+static avs_error_t
+send_next_chunk_with_buffer(avs_coap_ctx_t *ctx,
+                            avs_coap_exchange_t *exchange,
+                            uint8_t *payload_buf,
+                            size_t bytes_to_read,
+                            avs_coap_send_result_handler_t *send_result_handler,
+                            void *send_result_handler_arg) {
+    avs_coap_exchange_id_t id = exchange->id;
 
     size_t payload_offset = 0;
+    avs_error_t err;
 #ifdef WITH_AVS_COAP_BLOCK
     err = get_payload_offset(exchange, &payload_offset);
     if (avs_is_err(err)) {
@@ -389,12 +603,36 @@ avs_error_t _avs_coap_exchange_send_next_chunk(
     }
 #endif // WITH_AVS_COAP_BLOCK
 
+    avs_coap_payload_writer_t *write_payload = exchange->write_payload;
+    void *write_payload_arg = exchange->write_payload_arg;
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    bool q_block1_retry = false;
+    if (payload_offset == 0 && avs_coap_code_is_request(exchange->code)
+            && !exchange->by_type.client.q_block1
+            && exchange->by_type.client.q_block1_first_payload) {
+        // the first block is being resent using BLOCK1 after the Q-Block1
+        // option has been rejected
+        write_payload = q_block1_first_payload_writer;
+        write_payload_arg = &exchange->by_type.client;
+        q_block1_retry = true;
+    }
+#endif // WITH_AVS_COAP_Q_BLOCK
+
+    const uint8_t *payload = payload_buf;
     size_t payload_size;
     eof_cache_t eof_cache = exchange->eof_cache;
-    err = fetch_payload_with_cache(ctx, exchange->write_payload,
-                                   exchange->write_payload_arg, payload_offset,
-                                   payload_buf, bytes_to_read + 1,
-                                   &payload_size, &eof_cache);
+    if (exchange->provide_payload) {
+        err = fetch_payload_by_reference(exchange->provide_payload,
+                                         exchange->write_payload_arg,
+                                         payload_offset, payload_buf,
+                                         bytes_to_read + 1, &payload,
+                                         &payload_size, &eof_cache);
+    } else {
+        err = fetch_payload_with_cache(ctx, write_payload, write_payload_arg,
+                                       payload_offset, payload_buf,
+                                       bytes_to_read + 1, &payload_size,
+                                       &eof_cache);
+    }
 
     if (!_avs_coap_find_exchange_by_id(ctx, id)) {
         // exchange canceled by user handler
@@ -407,7 +645,21 @@ avs_error_t _avs_coap_exchange_send_next_chunk(
 
     exchange->eof_cache = eof_cache;
 
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    if (q_block1_retry) {
+        _avs_coap_client_exchange_forget_q_block1_first_payload(
+                &exchange->by_type.client);
+    } else if (payload_offset == 0
+               && avs_coap_code_is_request(exchange->code)) {
+        q_block1_remember_first_payload(ctx, exchange, payload, payload_size);
+    }
+#endif // WITH_AVS_COAP_Q_BLOCK
+
 #ifdef WITH_AVS_COAP_BLOCK
+    if (payload_offset == 0 && !exchange->eof_cache.empty) {
+        // first block of a payload that does not fit in a single message
+        _avs_coap_update_out_buffer_demand(ctx);
+    }
     err = exchange_update_block_option(exchange, payload_offset, payload_size);
 #else  // WITH_AVS_COAP_BLOCK
     if (!exchange->eof_cache.empty) {
@@ -423,11 +675,90 @@ avs_error_t _avs_coap_exchange_send_next_chunk(
         .code = exchange->code,
         .token = exchange->token,
         .options = exchange->options,
-        .payload = payload_buf,
+        .payload = payload,
         .payload_size = payload_size,
         .total_payload_size = payload_size
     };
 
-    return ctx->vtable->send_message(ctx, &msg, send_result_handler,
-                                     send_result_handler_arg);
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    // exchange->options always contain BLOCK1/BLOCK2 so that the rest of the
+    // BLOCK logic does not need to care; they are replaced with Q-Block1 or
+    // Q-Block2 only in the message actually sent
+    bool q_block1 = false;
+    bool q_block2;
+    if (avs_coap_code_is_request(exchange->code)) {
+        q_block1 = exchange->by_type.client.q_block1;
+        q_block2 = exchange->by_type.client.q_block2;
+    } else {
+        q_block2 = exchange->by_type.server.q_block2;
+    }
+    q_block1 = q_block1
+               && _avs_coap_options_find_first_opt(&exchange->options,
+                                                   AVS_COAP_OPTION_BLOCK1);
+    q_block2 = q_block2
+               && _avs_coap_options_find_first_opt(&exchange->options,
+                                                   AVS_COAP_OPTION_BLOCK2);
+    if (q_block1 || q_block2) {
+        avs_coap_options_t opts = { 0 };
+        err = _avs_coap_options_copy_as_dynamic(&opts, &exchange->options);
+        if (avs_is_ok(err) && q_block1) {
+            err = _avs_coap_options_convert_to_q_block(&opts, AVS_COAP_BLOCK1);
+        }
+        if (avs_is_ok(err) && q_block2) {
+            err = _avs_coap_options_convert_to_q_block(&opts, AVS_COAP_BLOCK2);
+        }
+        if (avs_is_ok(err)) {
+            msg.options = opts;
+            err = ctx->vtable->send_message(ctx, &msg, send_result_handler,
+                                            send_result_handler_arg);
+        }
+        avs_coap_options_cleanup(&opts);
+        return err;
+    }
+#endif // WITH_AVS_COAP_Q_BLOCK
+
+    err = ctx->vtable->send_message(ctx, &msg, send_result_handler,
+                                    send_result_handler_arg);
+#ifdef WITH_AVS_COAP_BLOCK
+    // send_result_handler might have been called already, and it might have
+    // deleted the exchange
+    if (avs_is_ok(err) && (exchange = _avs_coap_find_exchange_by_id(ctx, id))) {
+        exchange_skip_sent_bert_blocks(exchange, payload_size);
+    }
+#endif // WITH_AVS_COAP_BLOCK
+    return err;
+}
+
+avs_error_t _avs_coap_exchange_send_next_chunk(
+        avs_coap_ctx_t *ctx,
+        avs_coap_exchange_t *exchange,
+        avs_coap_send_result_handler_t *send_result_handler,
+        void *send_result_handler_arg) {
+    // 1 byte extra to handle eof_cache
+    uint8_t payload_buf[AVS_COAP_EXCHANGE_OUTGOING_CHUNK_PAYLOAD_MAX_SIZE];
+    size_t bytes_to_read;
+    avs_error_t err =
+            exchange_get_next_outgoing_chunk_payload_size(ctx, exchange,
+                                                          &bytes_to_read);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    if (bytes_to_read < sizeof(payload_buf)) {
+        return send_next_chunk_with_buffer(ctx, exchange, payload_buf,
+                                           bytes_to_read, send_result_handler,
+                                           send_result_handler_arg);
+    }
+
+    // BERT chunks are too large to be reasonably kept on stack
+    assert(bytes_to_read <= AVS_COAP_BERT_MAX_PAYLOAD_SIZE);
+    uint8_t *bert_payload_buf = (uint8_t *) avs_malloc(bytes_to_read + 1);
+    if (!bert_payload_buf) {
+        LOG(ERROR, _("out of memory"));
+        return avs_errno(AVS_ENOMEM);
+    }
+    err = send_next_chunk_with_buffer(ctx, exchange, bert_payload_buf,
+                                      bytes_to_read, send_result_handler,
+                                      send_result_handler_arg);
+    avs_free(bert_payload_buf);
+    return err;
 }
@@ -34,8 +34,12 @@ typedef struct avs_coap_exchange {
     /** Unique ID used to identify an exchange in user code. */
     avs_coap_exchange_id_t id;
 
-    /** User-defined handler used to provide payload for sent message. */
+    /**
+     * User-defined handlers used to provide payload for sent message. At most
+     * one of them is non-NULL; both use the same <c>write_payload_arg</c>.
+     */
     avs_coap_payload_writer_t *write_payload;
+    avs_coap_payload_provider_t *provide_payload;
     void *write_payload_arg;
 
     /**
@@ -98,7 +102,8 @@ typedef struct avs_coap_exchange {
  * @param out_payload_chunk_size
  * Pointer to a variable which will be filled with the calculated payload chunk
  * size. The size is guaranteed to be no larger than
- * @ref AVS_COAP_EXCHANGE_OUTGOING_CHUNK_PAYLOAD_MAX_SIZE . The actual size
+ * @ref AVS_COAP_EXCHANGE_OUTGOING_CHUNK_PAYLOAD_MAX_SIZE , or
+ * @ref AVS_COAP_BERT_MAX_PAYLOAD_SIZE if BERT is in use. The actual size
  * passed to the next call to @ref avs_coap_payload_writer_t is guaranteed to be
  * no larger than the size returned from this function beforehand.
  *
@@ -36,6 +36,18 @@ avs_error_t _avs_coap_parse_token(avs_coap_token_t *out_token,
                                   uint8_t token_size,
                                   bytes_dispenser_t *dispenser);
 
+/**
+ * Calculates a hash of @p token , suitable for indexing hash tables.
+ */
+static inline uint32_t _avs_coap_token_hash(const avs_coap_token_t *token) {
+    // FNV-1a
+    uint32_t hash = UINT32_C(2166136261);
+    for (size_t i = 0; i < token->size; ++i) {
+        hash = (hash ^ (uint8_t) token->bytes[i]) * UINT32_C(16777619);
+    }
+    return hash;
+}
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif // AVS_COAP_SRC_COMMON_UTILS_H
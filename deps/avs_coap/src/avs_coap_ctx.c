@@ -58,8 +58,10 @@ void avs_coap_ctx_cleanup(avs_coap_ctx_t **ctx) {
             avs_coap_exchange_cancel(*ctx, coap_base->server_exchanges->id);
         }
 #ifdef WITH_AVS_COAP_OBSERVE
-        while (coap_base->observes) {
-            avs_coap_observe_cancel(*ctx, coap_base->observes->id);
+        for (size_t i = 0; i < AVS_ARRAY_SIZE(coap_base->observes); ++i) {
+            while (coap_base->observes[i]) {
+                avs_coap_observe_cancel(*ctx, coap_base->observes[i]->id);
+            }
         }
 #endif // WITH_AVS_COAP_OBSERVE
 #ifdef WITH_AVS_COAP_STREAMING_API
@@ -67,6 +69,8 @@ void avs_coap_ctx_cleanup(avs_coap_ctx_t **ctx) {
 #endif // WITH_AVS_COAP_STREAMING_API
 
         avs_sched_del(&coap_base->retry_or_request_expired_job);
+        assert(!coap_base->exchange_index.size);
+        _avs_coap_exchange_index_cleanup(&coap_base->exchange_index);
 
         (*ctx)->vtable->cleanup(*ctx);
         *ctx = NULL;
@@ -107,6 +111,53 @@ _avs_coap_find_exchange_ptr_by_id(AVS_LIST(avs_coap_exchange_t) *list_ptr,
     return NULL;
 }
 
+AVS_LIST(avs_coap_exchange_t) *
+_avs_coap_find_indexed_exchange_ptr_by_id(avs_coap_ctx_t *ctx,
+                                          avs_coap_exchange_id_t id,
+                                          bool server) {
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
+    AVS_LIST(avs_coap_exchange_t) *list_ptr =
+            server ? &coap_base->server_exchanges
+                   : &coap_base->client_exchanges;
+    if (coap_base->exchange_index.disabled) {
+        return _avs_coap_find_exchange_ptr_by_id(list_ptr, id);
+    }
+
+    const avs_coap_exchange_index_entry_t *entry =
+            _avs_coap_exchange_index_find(&coap_base->exchange_index, id,
+                                          server);
+    return entry ? entry->ptr : NULL;
+}
+
+void _avs_coap_exchange_list_insert(avs_coap_ctx_t *ctx,
+                                    AVS_LIST(avs_coap_exchange_t) *insert_ptr,
+                                    avs_coap_exchange_t *exchange,
+                                    bool server) {
+    assert(avs_coap_exchange_id_valid(exchange->id));
+    avs_coap_exchange_index_t *index = &_avs_coap_get_base(ctx)->exchange_index;
+    AVS_LIST_INSERT(insert_ptr, exchange);
+    _avs_coap_exchange_index_put(index, exchange, insert_ptr, server);
+    // the element that used to be at insert_ptr is now preceded by exchange
+    if (AVS_LIST_NEXT(exchange)) {
+        _avs_coap_exchange_index_move(index, AVS_LIST_NEXT(exchange)->id,
+                                      AVS_LIST_NEXT_PTR(&exchange));
+    }
+}
+
+AVS_LIST(avs_coap_exchange_t)
+_avs_coap_exchange_list_detach(avs_coap_ctx_t *ctx,
+                               AVS_LIST(avs_coap_exchange_t) *exchange_ptr) {
+    avs_coap_exchange_index_t *index = &_avs_coap_get_base(ctx)->exchange_index;
+    AVS_LIST(avs_coap_exchange_t) exchange = AVS_LIST_DETACH(exchange_ptr);
+    _avs_coap_exchange_index_remove(index, exchange->id);
+    // the element that used to follow exchange now takes its place
+    if (*exchange_ptr) {
+        _avs_coap_exchange_index_move(index, (*exchange_ptr)->id,
+                                      exchange_ptr);
+    }
+    return exchange;
+}
+
 void avs_coap_exchange_cancel(avs_coap_ctx_t *ctx, avs_coap_exchange_id_t id) {
     if (!avs_coap_exchange_id_valid(id)) {
         return;
@@ -116,15 +167,15 @@ void avs_coap_exchange_cancel(avs_coap_ctx_t *ctx, avs_coap_exchange_id_t id) {
 
     exchange_ptr = _avs_coap_find_client_exchange_ptr_by_id(ctx, id);
     if (exchange_ptr) {
-        _avs_coap_client_exchange_cleanup(ctx, AVS_LIST_DETACH(exchange_ptr),
-                                          AVS_OK);
+        _avs_coap_client_exchange_cleanup(
+                ctx, _avs_coap_exchange_list_detach(ctx, exchange_ptr), AVS_OK);
         return;
     }
 
     exchange_ptr = _avs_coap_find_server_exchange_ptr_by_id(ctx, id);
     if (exchange_ptr) {
         _avs_coap_server_exchange_cleanup(
-                ctx, AVS_LIST_DETACH(exchange_ptr),
+                ctx, _avs_coap_exchange_list_detach(ctx, exchange_ptr),
                 _avs_coap_err(AVS_COAP_ERR_EXCHANGE_CANCELED));
     }
 }
@@ -256,7 +307,8 @@ _avs_coap_retry_or_request_expired_job(avs_coap_ctx_t *ctx) {
                                                            &exchange_ptr_copy);
         if (avs_is_err(err) && exchange_ptr_copy) {
             _avs_coap_client_exchange_cleanup(
-                    ctx, AVS_LIST_DETACH(exchange_ptr_copy), err);
+                    ctx, _avs_coap_exchange_list_detach(ctx, exchange_ptr_copy),
+                    err);
             exchange_ptr_copy = NULL;
         }
         if (exchange_ptr_copy) {
@@ -305,6 +357,44 @@ bool avs_coap_ctx_has_socket(avs_coap_ctx_t *ctx) {
     return _avs_coap_get_base(ctx)->socket != NULL;
 }
 
+bool avs_coap_ctx_buffers_replaceable(avs_coap_ctx_t *ctx,
+                                      size_t in_capacity,
+                                      size_t out_capacity) {
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
+    if (coap_base->in_buffer_in_use) {
+        return false;
+    }
+    return (in_capacity >= coap_base->in_buffer->capacity
+            && out_capacity >= coap_base->out_buffer->capacity)
+           || (!coap_base->client_exchanges && !coap_base->server_exchanges);
+}
+
+avs_error_t avs_coap_ctx_set_buffers(avs_coap_ctx_t *ctx,
+                                     avs_shared_buffer_t *in_buffer,
+                                     avs_shared_buffer_t *out_buffer) {
+    assert(in_buffer);
+    assert(out_buffer);
+    if (!avs_coap_ctx_buffers_replaceable(ctx, in_buffer->capacity,
+                                          out_buffer->capacity)) {
+        LOG(DEBUG, _("buffers cannot be replaced at the moment"));
+        return _avs_coap_err(AVS_COAP_ERR_SHARED_BUFFER_IN_USE);
+    }
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
+    coap_base->in_buffer = in_buffer;
+    coap_base->out_buffer = out_buffer;
+    return AVS_OK;
+}
+
+void avs_coap_ctx_take_buffer_demand(avs_coap_ctx_t *ctx,
+                                     size_t *out_in_buffer_demand,
+                                     size_t *out_out_buffer_demand) {
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
+    *out_in_buffer_demand = coap_base->in_buffer_demand;
+    *out_out_buffer_demand = coap_base->out_buffer_demand;
+    coap_base->in_buffer_demand = 0;
+    coap_base->out_buffer_demand = 0;
+}
+
 size_t avs_coap_max_incoming_message_payload(avs_coap_ctx_t *ctx,
                                              const avs_coap_options_t *options,
                                              uint8_t code) {
@@ -329,6 +419,25 @@ void avs_coap_set_exchange_max_time(avs_coap_ctx_t *ctx,
 }
 
 #ifdef WITH_AVS_COAP_BLOCK
+/**
+ * Returns the largest multiple of the BLOCK size that may be sent as a single
+ * BERT payload chunk, or 0 if BERT cannot be used.
+ *
+ * Space for a BLOCK option is always reserved, even if @p max_payload_size is
+ * already calculated with one, so that chunk sizes calculated for subsequent
+ * blocks never exceed the one calculated for the first block.
+ */
+static size_t bert_payload_chunk_size(avs_coap_ctx_t *ctx,
+                                      size_t max_payload_size) {
+    if (!_avs_coap_bert_supported(ctx)
+            || max_payload_size <= AVS_COAP_OPT_BLOCK_MAX_SIZE) {
+        return 0;
+    }
+    size_t chunk_size = AVS_MIN(max_payload_size - AVS_COAP_OPT_BLOCK_MAX_SIZE,
+                                AVS_COAP_BERT_MAX_PAYLOAD_SIZE);
+    return chunk_size - chunk_size % AVS_COAP_BLOCK_MAX_SIZE;
+}
+
 static avs_error_t get_payload_chunk_size(avs_coap_ctx_t *ctx,
                                           uint8_t code,
                                           const avs_coap_option_block_t *block,
@@ -340,6 +449,14 @@ static avs_error_t get_payload_chunk_size(avs_coap_ctx_t *ctx,
         const size_t max_payload_size = ctx->vtable->max_outgoing_payload_size(
                 ctx, AVS_COAP_MAX_TOKEN_LENGTH, options, code);
 
+        if (block->is_bert) {
+            size_t bert_size = bert_payload_chunk_size(ctx, max_payload_size);
+            if (bert_size >= AVS_COAP_BLOCK_MAX_SIZE) {
+                *out_payload_chunk_size = bert_size;
+                return AVS_OK;
+            }
+        }
+
         *out_payload_chunk_size = avs_max_power_of_2_not_greater_than(
                 AVS_MIN(AVS_COAP_BLOCK_MAX_SIZE,
                         AVS_MIN(max_payload_size, block->size)));
@@ -358,7 +475,16 @@ static avs_error_t get_payload_chunk_size(avs_coap_ctx_t *ctx,
          *
          * When calculating max_payload_size, take into account that we may
          * need to add a BLOCK option if the payload turns out to be large.
+         *
+         * If the peer supports BERT and more than a single 1024-byte block
+         * fits in a message, a BERT option will be added instead.
          */
+        size_t bert_size = bert_payload_chunk_size(ctx, max_payload_size);
+        if (bert_size > AVS_COAP_BLOCK_MAX_SIZE) {
+            *out_payload_chunk_size = bert_size;
+            return AVS_OK;
+        }
+
         if (max_payload_size > AVS_COAP_OPT_BLOCK_MAX_SIZE) {
             max_payload_size -= AVS_COAP_OPT_BLOCK_MAX_SIZE;
         } else {
@@ -438,6 +564,9 @@ is_critical_opt_valid(uint8_t msg_code,
                || msg_code == AVS_COAP_CODE_FETCH
                || msg_code == AVS_COAP_CODE_IPATCH;
     case AVS_COAP_OPTION_BLOCK2:
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    case AVS_COAP_OPTION_Q_BLOCK2:
+#endif // WITH_AVS_COAP_Q_BLOCK
         return msg_code == AVS_COAP_CODE_GET || msg_code == AVS_COAP_CODE_PUT
                || msg_code == AVS_COAP_CODE_POST
                || msg_code == AVS_COAP_CODE_FETCH
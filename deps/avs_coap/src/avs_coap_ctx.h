@@ -10,6 +10,7 @@
 #ifndef AVS_COAP_SRC_CTX_H
 #define AVS_COAP_SRC_CTX_H
 
+#include <avsystem/commons/avs_defs.h>
 #include <avsystem/commons/avs_errno.h>
 #include <avsystem/commons/avs_list.h>
 #include <avsystem/commons/avs_prng.h>
@@ -27,6 +28,7 @@
 #endif // WITH_COAP_STREAMING_API
 
 #include "async/avs_coap_async_server.h"
+#include "avs_coap_exchange_index.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
@@ -40,6 +42,14 @@ static inline avs_error_t _avs_coap_err(avs_coap_error_t error) {
 
 struct avs_coap_ctx_vtable;
 
+#ifdef WITH_AVS_COAP_Q_BLOCK
+typedef enum {
+    AVS_COAP_Q_BLOCK_SUPPORT_UNKNOWN,
+    AVS_COAP_Q_BLOCK_SUPPORTED,
+    AVS_COAP_Q_BLOCK_UNSUPPORTED
+} avs_coap_q_block_support_t;
+#endif // WITH_AVS_COAP_Q_BLOCK
+
 /**
  * Abstract CoAP context.
  */
@@ -70,9 +80,16 @@ struct avs_coap_base {
      */
     AVS_LIST(struct avs_coap_exchange) server_exchanges;
 
+    /** Index of all exchanges from the two lists above, keyed by ID. */
+    avs_coap_exchange_index_t exchange_index;
+
 #ifdef WITH_AVS_COAP_OBSERVE
-    /** Active observations. */
-    AVS_LIST(avs_coap_observe_t) observes;
+    /**
+     * Active observations, indexed by token hash, so that looking up the
+     * observation when sending a notification or canceling it does not
+     * require comparing against all of them.
+     */
+    AVS_LIST(avs_coap_observe_t) observes[AVS_COAP_OBSERVE_INDEX_SIZE];
 #endif // WITH_AVS_COAP_OBSERVE
 
     /** PRNG context. */
@@ -87,6 +104,17 @@ struct avs_coap_base {
     avs_shared_buffer_t *in_buffer;
     avs_shared_buffer_t *out_buffer;
 
+    /**
+     * Largest outgoing message size allowed by the transport (MTU or peer's
+     * Max-Message-Size), regardless of out_buffer capacity, as of the last
+     * outgoing payload size calculation.
+     */
+    size_t transport_max_out_msg_size;
+
+    /** See @ref avs_coap_ctx_take_buffer_demand . */
+    size_t in_buffer_demand;
+    size_t out_buffer_demand;
+
     avs_sched_t *sched;
 
     /* Maximum allowed time between the CoAP exchange updates */
@@ -105,6 +133,30 @@ struct avs_coap_base {
 
     /* State necessary for handling incoming requests. */
     avs_coap_request_ctx_t request_ctx;
+
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    /**
+     * Maximum number of non-final request payload blocks sent using the
+     * Q-Block1 option that may be awaiting acknowledgement at once. 0 if
+     * Q-Block1 is not used.
+     */
+    size_t q_block1_max_payloads;
+
+    /**
+     * Set to SUPPORTED once the remote endpoint acknowledges a Q-Block1
+     * payload, or to UNSUPPORTED if it responds to one with 4.02 Bad Option.
+     */
+    avs_coap_q_block_support_t q_block1_support;
+
+    /** True if response payload blocks are requested using Q-Block2. */
+    bool q_block2_enabled;
+
+    /**
+     * Set to SUPPORTED once the remote endpoint responds using the Q-Block2
+     * option, or to UNSUPPORTED if it responds to it with 4.02 Bad Option.
+     */
+    avs_coap_q_block_support_t q_block2_support;
+#endif // WITH_AVS_COAP_Q_BLOCK
 };
 
 static inline avs_coap_base_t *_avs_coap_get_base(avs_coap_ctx_t *ctx) {
@@ -115,6 +167,20 @@ avs_error_t _avs_coap_in_buffer_acquire(avs_coap_ctx_t *ctx,
                                         uint8_t **out_in_buffer,
                                         size_t *out_in_buffer_size);
 
+/**
+ * Records that a payload has been split into blocks whose size might have been
+ * limited by the output buffer capacity.
+ */
+static inline void _avs_coap_update_out_buffer_demand(avs_coap_ctx_t *ctx) {
+    avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
+    if (coap_base->transport_max_out_msg_size
+            > coap_base->out_buffer->capacity) {
+        coap_base->out_buffer_demand =
+                AVS_MAX(coap_base->out_buffer_demand,
+                        coap_base->transport_max_out_msg_size);
+    }
+}
+
 static inline void _avs_coap_in_buffer_release(avs_coap_ctx_t *ctx) {
     avs_coap_base_t *coap_base = _avs_coap_get_base(ctx);
     assert(coap_base->in_buffer_in_use);
@@ -143,6 +209,9 @@ static inline void _avs_coap_base_init(avs_coap_base_t *base,
     base->last_exchange_id = AVS_COAP_EXCHANGE_ID_INVALID;
     base->client_exchanges = NULL;
     base->server_exchanges = NULL;
+    base->exchange_index = (avs_coap_exchange_index_t) {
+        .entries = NULL
+    };
     base->prng_ctx = prng_ctx;
     base->socket = NULL;
     base->in_buffer = in_buffer;
@@ -189,47 +258,85 @@ AVS_LIST(struct avs_coap_exchange) *_avs_coap_find_exchange_ptr_by_token(
         AVS_LIST(struct avs_coap_exchange) *list_ptr,
         const avs_coap_token_t *token);
 
+/**
+ * Finds the exchange with a given @p id in the list at @p list_ptr , using the
+ * exchange index if possible. @p server determines which of the lists it is.
+ */
+AVS_LIST(struct avs_coap_exchange) *
+_avs_coap_find_indexed_exchange_ptr_by_id(avs_coap_ctx_t *ctx,
+                                          avs_coap_exchange_id_t id,
+                                          bool server);
+
 static inline AVS_LIST(struct avs_coap_exchange) *
 _avs_coap_find_client_exchange_ptr_by_id(avs_coap_ctx_t *ctx,
                                          avs_coap_exchange_id_t id) {
-    return _avs_coap_find_exchange_ptr_by_id(
-            &_avs_coap_get_base(ctx)->client_exchanges, id);
+    return _avs_coap_find_indexed_exchange_ptr_by_id(ctx, id, false);
 }
 
 static inline AVS_LIST(struct avs_coap_exchange) *
 _avs_coap_find_server_exchange_ptr_by_id(avs_coap_ctx_t *ctx,
                                          avs_coap_exchange_id_t id) {
-    return _avs_coap_find_exchange_ptr_by_id(
-            &_avs_coap_get_base(ctx)->server_exchanges, id);
+    return _avs_coap_find_indexed_exchange_ptr_by_id(ctx, id, true);
 }
 
 static inline AVS_LIST(struct avs_coap_exchange)
-_avs_coap_find_client_exchange_by_id(avs_coap_ctx_t *ctx,
-                                     avs_coap_exchange_id_t id) {
+_avs_coap_find_indexed_exchange_by_id(avs_coap_ctx_t *ctx,
+                                      avs_coap_exchange_id_t id,
+                                      bool server) {
+    const avs_coap_exchange_index_t *index =
+            &_avs_coap_get_base(ctx)->exchange_index;
+    if (!index->disabled) {
+        const avs_coap_exchange_index_entry_t *entry =
+                _avs_coap_exchange_index_find(index, id, server);
+        return entry ? entry->exchange : NULL;
+    }
     AVS_LIST(struct avs_coap_exchange) *ptr =
-            _avs_coap_find_client_exchange_ptr_by_id(ctx, id);
+            _avs_coap_find_indexed_exchange_ptr_by_id(ctx, id, server);
     if (ptr) {
         return *ptr;
     }
     return NULL;
 }
 
+static inline AVS_LIST(struct avs_coap_exchange)
+_avs_coap_find_client_exchange_by_id(avs_coap_ctx_t *ctx,
+                                     avs_coap_exchange_id_t id) {
+    return _avs_coap_find_indexed_exchange_by_id(ctx, id, false);
+}
+
 static inline AVS_LIST(struct avs_coap_exchange)
 _avs_coap_find_server_exchange_by_id(avs_coap_ctx_t *ctx,
                                      avs_coap_exchange_id_t id) {
-    AVS_LIST(struct avs_coap_exchange) *ptr =
-            _avs_coap_find_server_exchange_ptr_by_id(ctx, id);
-    if (ptr) {
-        return *ptr;
-    }
-    return NULL;
+    return _avs_coap_find_indexed_exchange_by_id(ctx, id, true);
 }
 
+/**
+ * Inserts @p exchange , which MUST already have its ID assigned, at
+ * @p insert_ptr in <c>client_exchanges</c> or <c>server_exchanges</c>
+ * (depending on @p server ), and adds it to the exchange index.
+ *
+ * These lists MUST NOT be modified in any other way than using this function
+ * and @ref _avs_coap_exchange_list_detach .
+ */
+void _avs_coap_exchange_list_insert(
+        avs_coap_ctx_t *ctx,
+        AVS_LIST(struct avs_coap_exchange) *insert_ptr,
+        struct avs_coap_exchange *exchange,
+        bool server);
+
+/**
+ * Detaches the exchange at @p exchange_ptr from its list and removes it from
+ * the exchange index, so that it is not found by lookups made from any user
+ * handlers called during its cleanup.
+ */
+AVS_LIST(struct avs_coap_exchange) _avs_coap_exchange_list_detach(
+        avs_coap_ctx_t *ctx, AVS_LIST(struct avs_coap_exchange) *exchange_ptr);
+
 #ifdef WITH_AVS_COAP_OBSERVE
 static inline bool _avs_coap_is_observe(avs_coap_ctx_t *ctx,
                                         const avs_coap_token_t *token) {
     AVS_LIST(avs_coap_observe_t) it;
-    AVS_LIST_FOREACH(it, _avs_coap_get_base(ctx)->observes) {
+    AVS_LIST_FOREACH(it, *_avs_coap_observe_bucket(ctx, token)) {
         if (avs_coap_token_equal(&it->id.token, token)) {
             return true;
         }
@@ -315,6 +422,14 @@ avs_error_t _avs_coap_get_max_block_size(avs_coap_ctx_t *ctx,
                                          const avs_coap_options_t *options,
                                          size_t *out_payload_chunk_size);
 
+/**
+ * @returns True if payload chunks sent using @p ctx may be split into BERT
+ *          blocks, see @ref avs_coap_ctx_vtable_t#bert_supported .
+ */
+static inline bool _avs_coap_bert_supported(avs_coap_ctx_t *ctx) {
+    return ctx->vtable->bert_supported && ctx->vtable->bert_supported(ctx);
+}
+
 /*
  * Queries the expected size of the chunk that will be requested during the
  * first call to @ref avs_coap_payload_writer_t for an newly created exchange
@@ -89,6 +89,11 @@ typedef enum {
  *       consecutive chunks of data (i.e. no data will be passed to the handler
  *       twice).
  *
+ *     - AVS_COAP_SEND_RESULT_OK with @p response code set to
+ *       @ref AVS_COAP_CODE_EMPTY, if the request was a non-final Q-Block1
+ *       payload (RFC 9177) that has been acknowledged. No actual response is
+ *       expected in that case.
+ *
  * - the message was not delivered (AVS_COAP_SEND_RESULT_FAIL), in which case
  *   @p fail_errno is set to a specific error code.
  *
@@ -309,6 +314,26 @@ typedef avs_error_t avs_coap_setsock_t(avs_coap_ctx_t *ctx,
 typedef uint32_t avs_coap_next_observe_option_value_t(avs_coap_ctx_t *ctx,
                                                       uint32_t last_value);
 
+/**
+ * Checks whether the remote endpoint is known to accept BERT options (RFC 8323,
+ * Section 6), i.e. whether upper layers may send BLOCK-wise payload chunks
+ * spanning multiple 1024-byte blocks. May be not implemented if the transport
+ * does not support BERT at all.
+ */
+typedef bool avs_coap_bert_supported_t(avs_coap_ctx_t *ctx);
+
+/**
+ * Returns the maximum number of messages that upper layers shall attempt to
+ * receive in a non-blocking way when handling a single incoming packet event,
+ * even if the socket does not report any buffered data. This allows draining
+ * multiple messages pipelined by the remote endpoint on stream transports,
+ * where the system socket buffer may hold more than a single message.
+ *
+ * May be not implemented, in which case only a single message is received
+ * unless the socket reports more buffered data.
+ */
+typedef size_t avs_coap_receive_budget_t(avs_coap_ctx_t *ctx);
+
 /** @} */
 
 typedef struct avs_coap_ctx_vtable {
@@ -325,6 +350,8 @@ typedef struct avs_coap_ctx_vtable {
     avs_coap_on_timeout_t *on_timeout;
     avs_coap_get_stats_t *get_stats;
     avs_coap_next_observe_option_value_t *next_observe_option_value;
+    avs_coap_bert_supported_t *bert_supported;
+    avs_coap_receive_budget_t *receive_budget;
 } avs_coap_ctx_vtable_t;
 
 /**
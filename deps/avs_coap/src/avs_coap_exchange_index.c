@@ -0,0 +1,169 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem CoAP library
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avs_coap_init.h>
+
+#include <assert.h>
+#include <inttypes.h>
+
+#include <avsystem/commons/avs_memory.h>
+
+#include "async/avs_coap_exchange.h"
+#include "avs_coap_exchange_index.h"
+
+#define MODULE_NAME coap
+#include <avs_coap_x_log_config.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+#define INITIAL_CAPACITY 8
+
+void _avs_coap_exchange_index_cleanup(avs_coap_exchange_index_t *index) {
+    avs_free(index->entries);
+    index->entries = NULL;
+    index->capacity = 0;
+    index->size = 0;
+}
+
+static size_t home_slot(size_t capacity, avs_coap_exchange_id_t id) {
+    // Exchange IDs are sequential, so spread them using Fibonacci hashing
+    uint64_t hash = id.value * UINT64_C(0x9E3779B97F4A7C15);
+    return (size_t) (hash ^ (hash >> 32)) & (capacity - 1);
+}
+
+/**
+ * Returns the slot that contains @p id , or the empty slot at which it shall
+ * be inserted.
+ */
+static size_t find_slot(const avs_coap_exchange_index_entry_t *entries,
+                        size_t capacity,
+                        avs_coap_exchange_id_t id) {
+    size_t slot = home_slot(capacity, id);
+    while (entries[slot].exchange
+           && !avs_coap_exchange_id_equal(entries[slot].id, id)) {
+        slot = (slot + 1) & (capacity - 1);
+    }
+    return slot;
+}
+
+static int grow(avs_coap_exchange_index_t *index) {
+    size_t new_capacity =
+            index->capacity ? 2 * index->capacity : INITIAL_CAPACITY;
+    if (new_capacity < index->capacity) {
+        return -1;
+    }
+    avs_coap_exchange_index_entry_t *new_entries =
+            (avs_coap_exchange_index_entry_t *) avs_calloc(
+                    new_capacity, sizeof(*new_entries));
+    if (!new_entries) {
+        return -1;
+    }
+    for (size_t i = 0; i < index->capacity; ++i) {
+        if (index->entries[i].exchange) {
+            new_entries[find_slot(new_entries, new_capacity,
+                                  index->entries[i].id)] = index->entries[i];
+        }
+    }
+    avs_free(index->entries);
+    index->entries = new_entries;
+    index->capacity = new_capacity;
+    return 0;
+}
+
+void _avs_coap_exchange_index_put(avs_coap_exchange_index_t *index,
+                                  avs_coap_exchange_t *exchange,
+                                  AVS_LIST(avs_coap_exchange_t) *ptr,
+                                  bool server) {
+    assert(exchange);
+    assert(ptr && *ptr == exchange);
+    if (index->disabled) {
+        return;
+    }
+
+    // keep the load factor below 3/4, so that probe sequences stay short
+    if (4 * (index->size + 1) > 3 * index->capacity && grow(index)
+            && index->size + 1 >= index->capacity) {
+        LOG(WARNING, _("out of memory, exchange lookups will be slower"));
+        _avs_coap_exchange_index_cleanup(index);
+        index->disabled = true;
+        return;
+    }
+
+    size_t slot = find_slot(index->entries, index->capacity, exchange->id);
+    if (!index->entries[slot].exchange) {
+        ++index->size;
+    }
+    index->entries[slot] = (avs_coap_exchange_index_entry_t) {
+        .id = exchange->id,
+        .exchange = exchange,
+        .ptr = ptr,
+        .server = server
+    };
+}
+
+void _avs_coap_exchange_index_move(avs_coap_exchange_index_t *index,
+                                   avs_coap_exchange_id_t id,
+                                   AVS_LIST(avs_coap_exchange_t) *ptr) {
+    if (!index->size) {
+        return;
+    }
+    avs_coap_exchange_index_entry_t *entry =
+            &index->entries[find_slot(index->entries, index->capacity, id)];
+    if (entry->exchange) {
+        assert(*ptr == entry->exchange);
+        entry->ptr = ptr;
+    }
+}
+
+void _avs_coap_exchange_index_remove(avs_coap_exchange_index_t *index,
+                                     avs_coap_exchange_id_t id) {
+    if (!index->size) {
+        return;
+    }
+    const size_t mask = index->capacity - 1;
+    size_t hole = find_slot(index->entries, index->capacity, id);
+    if (!index->entries[hole].exchange) {
+        return;
+    }
+
+    // Backward shift deletion: move subsequent entries of the probe sequence
+    // into the hole, unless that would place them before their home slot.
+    size_t slot = hole;
+    while (index->entries[slot = (slot + 1) & mask].exchange) {
+        size_t home = home_slot(index->capacity, index->entries[slot].id);
+        bool stays = (hole <= slot) ? (hole < home && home <= slot)
+                                    : (hole < home || home <= slot);
+        if (!stays) {
+            index->entries[hole] = index->entries[slot];
+            hole = slot;
+        }
+    }
+    index->entries[hole] = (avs_coap_exchange_index_entry_t) {
+        .exchange = NULL
+    };
+    --index->size;
+}
+
+const avs_coap_exchange_index_entry_t *
+_avs_coap_exchange_index_find(const avs_coap_exchange_index_t *index,
+                              avs_coap_exchange_id_t id,
+                              bool server) {
+    assert(!index->disabled);
+    if (!index->size) {
+        return NULL;
+    }
+    const avs_coap_exchange_index_entry_t *entry =
+            &index->entries[find_slot(index->entries, index->capacity, id)];
+    if (!entry->exchange || entry->server != server) {
+        return NULL;
+    }
+    assert(avs_coap_exchange_id_equal(entry->exchange->id, id));
+    assert(*entry->ptr == entry->exchange);
+    return entry;
+}
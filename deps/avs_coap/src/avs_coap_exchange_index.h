@@ -0,0 +1,100 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem CoAP library
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef AVS_COAP_SRC_EXCHANGE_INDEX_H
+#define AVS_COAP_SRC_EXCHANGE_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <avsystem/commons/avs_list.h>
+
+#include <avsystem/coap/async_exchange.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+struct avs_coap_exchange;
+
+typedef struct {
+    avs_coap_exchange_id_t id;
+    /** NULL if the slot is empty. */
+    struct avs_coap_exchange *exchange;
+    /**
+     * Location of the pointer to @ref exchange in its list - i.e. either the
+     * list head, or the "next" pointer of the preceding element. Always
+     * satisfies <c>*ptr == exchange</c>.
+     */
+    AVS_LIST(struct avs_coap_exchange) *ptr;
+    /** True for exchanges kept in avs_coap_base_t#server_exchanges . */
+    bool server;
+} avs_coap_exchange_index_entry_t;
+
+/**
+ * Open-addressing hash table (with linear probing) that maps exchange IDs to
+ * exchanges, so that looking them up does not require traversing the lists of
+ * all exchanges.
+ *
+ * It contains exactly the exchanges that are currently present in
+ * avs_coap_base_t#client_exchanges or avs_coap_base_t#server_exchanges ,
+ * together with their positions in these lists, so that the exchanges can be
+ * detached without traversing the lists either. For this to hold, these lists
+ * MUST only be modified using @ref _avs_coap_exchange_list_insert and
+ * @ref _avs_coap_exchange_list_detach .
+ */
+typedef struct {
+    /** Array of @ref capacity entries; capacity is always a power of two. */
+    avs_coap_exchange_index_entry_t *entries;
+    size_t capacity;
+    size_t size;
+    /**
+     * Set if the index could not be grown because of an out-of-memory
+     * condition. The index is then empty and no longer maintained, and lookups
+     * fall back to traversing the lists.
+     */
+    bool disabled;
+} avs_coap_exchange_index_t;
+
+void _avs_coap_exchange_index_cleanup(avs_coap_exchange_index_t *index);
+
+/**
+ * Adds @p exchange , located at @p ptr in one of the lists, to the index, or
+ * updates the entry with the same ID if it already exists.
+ */
+void _avs_coap_exchange_index_put(avs_coap_exchange_index_t *index,
+                                  struct avs_coap_exchange *exchange,
+                                  AVS_LIST(struct avs_coap_exchange) *ptr,
+                                  bool server);
+
+/**
+ * Updates the list location of the exchange with a given @p id , if it is
+ * present in the index. Needs to be called for the element that follows an
+ * exchange that is inserted or detached.
+ */
+void _avs_coap_exchange_index_move(avs_coap_exchange_index_t *index,
+                                   avs_coap_exchange_id_t id,
+                                   AVS_LIST(struct avs_coap_exchange) *ptr);
+
+/** Removes the entry for @p id , if present. */
+void _avs_coap_exchange_index_remove(avs_coap_exchange_index_t *index,
+                                     avs_coap_exchange_id_t id);
+
+/**
+ * @returns Index entry of the exchange with a given @p id , or NULL if there
+ *          is no such exchange of the requested kind (client or server,
+ *          depending on @p server ). MUST NOT be called if the index is
+ *          disabled.
+ */
+const avs_coap_exchange_index_entry_t *
+_avs_coap_exchange_index_find(const avs_coap_exchange_index_t *index,
+                              avs_coap_exchange_id_t id,
+                              bool server);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif // AVS_COAP_SRC_EXCHANGE_INDEX_H
@@ -34,6 +34,11 @@
 #    error "WITH_AVS_COAP_OBSERVE_PERSISTENCE requires avs_persistence to be enabled"
 #endif
 
+#if defined(WITH_AVS_COAP_Q_BLOCK) \
+        && (!defined(WITH_AVS_COAP_BLOCK) || !defined(WITH_AVS_COAP_UDP))
+#    error "WITH_AVS_COAP_Q_BLOCK requires WITH_AVS_COAP_BLOCK and WITH_AVS_COAP_UDP to be enabled"
+#endif
+
 #ifdef AVS_COMMONS_HAVE_VISIBILITY
 /* set default visibility for external symbols */
 #    pragma GCC visibility push(default)
@@ -17,6 +17,7 @@
 #    include <avsystem/coap/observe.h>
 
 #    include "avs_coap_code_utils.h"
+#    include "avs_coap_common_utils.h"
 
 #    define MODULE_NAME coap
 #    include <avs_coap_x_log_config.h>
@@ -59,10 +60,19 @@ create_observe(avs_coap_observe_id_t id,
     return observe;
 }
 
+AVS_LIST(avs_coap_observe_t) *
+_avs_coap_observe_bucket(avs_coap_ctx_t *ctx, const avs_coap_token_t *token) {
+    return &_avs_coap_get_base(ctx)->observes[_avs_coap_token_hash(token)
+                                              & (AVS_COAP_OBSERVE_INDEX_SIZE
+                                                 - 1)];
+}
+
 static AVS_LIST(avs_coap_observe_t) *
 find_observe_ptr_by_id(avs_coap_ctx_t *ctx, const avs_coap_observe_id_t *id) {
+    AVS_LIST(avs_coap_observe_t) *bucket =
+            _avs_coap_observe_bucket(ctx, &id->token);
     AVS_LIST(avs_coap_observe_t) *observe_ptr;
-    AVS_LIST_FOREACH_PTR(observe_ptr, &_avs_coap_get_base(ctx)->observes) {
+    AVS_LIST_FOREACH_PTR(observe_ptr, bucket) {
         if (avs_coap_token_equal(&(*observe_ptr)->id.token, &id->token)) {
             return observe_ptr;
         }
@@ -101,7 +111,7 @@ avs_coap_observe_start(avs_coap_ctx_t *ctx,
 
     LOG(DEBUG, _("Observe start: ") "%s", AVS_COAP_TOKEN_HEX(&id.token));
 
-    AVS_LIST_INSERT(&_avs_coap_get_base(ctx)->observes, observe);
+    AVS_LIST_INSERT(_avs_coap_observe_bucket(ctx, &id.token), observe);
     return AVS_OK;
 }
 
@@ -272,7 +282,7 @@ avs_error_t avs_coap_observe_restore_with_id(
     }
     LOG(DEBUG, _("Observe (restored) start: ") "%s",
         AVS_COAP_TOKEN_HEX(&id.token));
-    AVS_LIST_INSERT(&coap_base->observes, observe);
+    AVS_LIST_INSERT(_avs_coap_observe_bucket(ctx, &id.token), observe);
     if (out_id) {
         *out_id = id;
     }
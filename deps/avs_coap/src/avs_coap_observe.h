@@ -14,6 +14,12 @@
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
+/**
+ * Number of buckets in the index of active observations. Must be a power of
+ * two.
+ */
+#define AVS_COAP_OBSERVE_INDEX_SIZE 16
+
 typedef struct {
     /** An ID (CoAP token) that uniquely identifies an observation. */
     avs_coap_observe_id_t id;
@@ -37,6 +43,13 @@ typedef struct {
     uint8_t options_storage[];
 } avs_coap_observe_t;
 
+/**
+ * Returns the bucket of the observation index of @p ctx that an observation
+ * identified by @p token belongs to.
+ */
+AVS_LIST(avs_coap_observe_t) *
+_avs_coap_observe_bucket(avs_coap_ctx_t *ctx, const avs_coap_token_t *token);
+
 static inline uint32_t _avs_coap_observe_initial_option_value(void) {
     // Response to the original Observe request always set the option to 0.
     // Further notifications use larger values.
@@ -174,6 +174,8 @@ _avs_coap_optit_erase(avs_coap_option_iterator_t *optit) {
     const size_t erased_sizeof = _avs_coap_option_sizeof(erased_opt);
     const size_t erased_offset = optit_offset(optit);
 
+    optit->opts->lookup_index.valid = false;
+
     avs_coap_option_iterator_t next_optit = *optit;
     _avs_coap_optit_next(&next_optit);
     if (_avs_coap_optit_end(&next_optit)) {
@@ -31,6 +31,12 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
  */
 #define AVS_COAP_OPT_BERT_SZX 7
 
+/**
+ * Upper limit of payload size of a single outgoing BERT message. Actual size is
+ * additionally limited by the output buffer and peer's Max-Message-Size.
+ */
+#define AVS_COAP_BERT_MAX_PAYLOAD_SIZE (63 * AVS_COAP_BLOCK_MAX_SIZE)
+
 #define AVS_COAP_OPT_BLOCK_MAX_SZX 6
 
 /**
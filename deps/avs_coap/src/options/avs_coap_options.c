@@ -34,9 +34,14 @@ static int fill_block_data(const avs_coap_option_t *block_opt,
                            uint32_t opt_number,
                            avs_coap_option_block_t *out_info) {
     assert(opt_number == AVS_COAP_OPTION_BLOCK1
-           || opt_number == AVS_COAP_OPTION_BLOCK2);
-    out_info->type = (opt_number == AVS_COAP_OPTION_BLOCK1) ? AVS_COAP_BLOCK1
-                                                            : AVS_COAP_BLOCK2;
+           || opt_number == AVS_COAP_OPTION_BLOCK2
+           || opt_number == AVS_COAP_OPTION_Q_BLOCK1
+           || opt_number == AVS_COAP_OPTION_Q_BLOCK2);
+    // Q-Block options use the same format as the BLOCK ones (RFC 9177, 2.3)
+    out_info->type = (opt_number == AVS_COAP_OPTION_BLOCK1
+                      || opt_number == AVS_COAP_OPTION_Q_BLOCK1)
+                             ? AVS_COAP_BLOCK1
+                             : AVS_COAP_BLOCK2;
 
     // RFC 7959, Table 1 defines BLOCK1/2 option length as 0-3 bytes
     static const uint32_t MAX_BLOCK_DATA_SIZE = 3;
@@ -47,7 +52,7 @@ static int fill_block_data(const avs_coap_option_t *block_opt,
             || _avs_coap_option_block_size(block_opt, &out_info->size,
                                            &out_info->is_bert)) {
         LOG(DEBUG, _("malformed BLOCK") "%d" _(" option"),
-            opt_number == AVS_COAP_OPTION_BLOCK1 ? 1 : 2);
+            out_info->type == AVS_COAP_BLOCK1 ? 1 : 2);
         return -1;
     }
     return 0;
@@ -103,11 +108,46 @@ _avs_coap_options_get_block_by_code(const avs_coap_options_t *options,
 
 #endif // WITH_AVS_COAP_BLOCK
 
-bool _avs_coap_options_valid_until_payload_marker(
-        const avs_coap_options_t *opts,
-        size_t *out_actual_size,
-        bool *out_truncated,
-        bool *out_payload_marker_reached) {
+/**
+ * Appends @p opt_number found at @p opt_offset to @p index , unless it is the
+ * same as the previous one. Options are sorted by number, so each distinct
+ * number is only added once.
+ */
+static void index_option(avs_coap_options_index_t *index,
+                         uint32_t opt_number,
+                         size_t opt_offset) {
+    if (!index->valid
+            || (index->size > 0
+                && index->entries[index->size - 1].number == opt_number)) {
+        return;
+    }
+    if (index->size >= AVS_ARRAY_SIZE(index->entries)
+            || opt_offset > UINT16_MAX) {
+        index->valid = false;
+        return;
+    }
+    assert(opt_number <= UINT16_MAX);
+    index->entries[index->size++] = (avs_coap_options_index_entry_t) {
+        .number = (uint16_t) opt_number,
+        .offset = (uint16_t) opt_offset
+    };
+}
+
+/**
+ * Common implementation of @ref _avs_coap_options_valid_until_payload_marker
+ * and @ref _avs_coap_options_parse. If @p out_index is not NULL, the index
+ * of option numbers is built along the way.
+ */
+static bool validate_options(const avs_coap_options_t *opts,
+                             size_t *out_actual_size,
+                             bool *out_truncated,
+                             bool *out_payload_marker_reached,
+                             avs_coap_options_index_t *out_index) {
+    if (out_index) {
+        *out_index = (avs_coap_options_index_t) {
+            .valid = true
+        };
+    }
     if (out_truncated) {
         *out_truncated = false;
     }
@@ -133,8 +173,10 @@ bool _avs_coap_options_valid_until_payload_marker(
         { AVS_COAP_OPTION_URI_PORT,       false },
         { AVS_COAP_OPTION_OSCORE,         false },
         { AVS_COAP_OPTION_ACCEPT,         false },
+        { AVS_COAP_OPTION_Q_BLOCK1,       false },
         { AVS_COAP_OPTION_BLOCK2,         false },
         { AVS_COAP_OPTION_BLOCK1,         false },
+        { AVS_COAP_OPTION_Q_BLOCK2,       false },
         { AVS_COAP_OPTION_PROXY_URI,      false },
         { AVS_COAP_OPTION_PROXY_SCHEME,   false }
         // clang-format on
@@ -171,6 +213,10 @@ bool _avs_coap_options_valid_until_payload_marker(
             return false;
         }
 
+        if (out_index) {
+            index_option(out_index, opt_number, opt_offset);
+        }
+
         for (size_t i = 0; i < AVS_ARRAY_SIZE(non_repeatable_critical_options);
              ++i) {
             AVS_ASSERT(_avs_coap_option_is_critical(
@@ -200,6 +246,14 @@ bool _avs_coap_options_valid_until_payload_marker(
             LOG(DEBUG, _("BLOCK option received, but BLOCKs are disabled"));
             return false;
 #endif // WITH_AVS_COAP_BLOCK
+#ifdef WITH_AVS_COAP_Q_BLOCK
+        case AVS_COAP_OPTION_Q_BLOCK1:
+        case AVS_COAP_OPTION_Q_BLOCK2:
+            if (!is_block_option_content_valid(opt, opt_number)) {
+                return false;
+            }
+            break;
+#endif // WITH_AVS_COAP_Q_BLOCK
         default:
             break;
         }
@@ -223,6 +277,15 @@ bool _avs_coap_options_valid_until_payload_marker(
     return true;
 }
 
+bool _avs_coap_options_valid_until_payload_marker(
+        const avs_coap_options_t *opts,
+        size_t *out_actual_size,
+        bool *out_truncated,
+        bool *out_payload_marker_reached) {
+    return validate_options(opts, out_actual_size, out_truncated,
+                            out_payload_marker_reached, NULL);
+}
+
 bool _avs_coap_options_valid(const avs_coap_options_t *opts) {
     size_t actual_size;
 
@@ -363,6 +426,38 @@ avs_error_t avs_coap_options_add_block(avs_coap_options_t *opts,
                          block->is_bert);
 }
 
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+int _avs_coap_options_get_q_block1(const avs_coap_options_t *opts,
+                                   avs_coap_option_block_t *out_info) {
+    memset(out_info, 0, sizeof(*out_info));
+    const avs_coap_option_t *opt =
+            _avs_coap_options_find_first_opt(opts, AVS_COAP_OPTION_Q_BLOCK1);
+    if (!opt) {
+        return AVS_COAP_OPTION_MISSING;
+    }
+    return fill_block_data(opt, AVS_COAP_OPTION_Q_BLOCK1, out_info);
+}
+
+avs_error_t
+_avs_coap_options_convert_to_q_block(avs_coap_options_t *opts,
+                                     avs_coap_option_block_type_t type) {
+    const uint16_t opt_number = _avs_coap_option_num_from_block_type(type);
+    if (!_avs_coap_options_find_first_opt(opts, opt_number)) {
+        return AVS_OK;
+    }
+    avs_coap_option_block_t block;
+    if (avs_coap_options_get_block(opts, type, &block)) {
+        return _avs_coap_err(AVS_COAP_ERR_MALFORMED_OPTIONS);
+    }
+    avs_coap_options_remove_by_number(opts, opt_number);
+    return add_block_opt(opts,
+                         type == AVS_COAP_BLOCK1 ? AVS_COAP_OPTION_Q_BLOCK1
+                                                 : AVS_COAP_OPTION_Q_BLOCK2,
+                         block.seq_num, block.has_more, block.size,
+                         block.is_bert);
+}
+#    endif // WITH_AVS_COAP_Q_BLOCK
+
 #endif // WITH_AVS_COAP_BLOCK
 
 #ifdef WITH_AVS_COAP_OBSERVE
@@ -500,6 +595,7 @@ avs_error_t avs_coap_options_add_opaque(avs_coap_options_t *opts,
     if (avs_is_err(err)) {
         return err;
     }
+    opts->lookup_index.valid = false;
 
     avs_coap_option_iterator_t insert_it = _avs_coap_optit_begin(opts);
     while (!_avs_coap_optit_end(&insert_it)
@@ -672,9 +768,50 @@ avs_error_t avs_coap_options_add_uint(avs_coap_options_t *opts,
                                        (uint16_t) (value_size - start));
 }
 
+/**
+ * Looks up the first option with @p opt_number using the index of @p opts .
+ *
+ * @returns false if the index is not valid. Otherwise, returns true and
+ *          positions @p out_it at the first option with @p opt_number , or at
+ *          the end of options if there is none.
+ */
+static bool index_lookup(const avs_coap_options_t *opts,
+                         uint16_t opt_number,
+                         avs_coap_option_iterator_t *out_it) {
+    const avs_coap_options_index_t *index = &opts->lookup_index;
+    if (!index->valid) {
+        return false;
+    }
+    // TODO: const_cast; maybe const_iterator could be nice?
+    *out_it = _avs_coap_optit_begin((avs_coap_options_t *) (intptr_t) opts);
+    for (size_t i = 0; i < index->size && index->entries[i].number <= opt_number;
+         ++i) {
+        if (index->entries[i].number == opt_number) {
+            out_it->curr_opt =
+                    (uint8_t *) opts->begin + index->entries[i].offset;
+            out_it->prev_opt_number =
+                    opt_number
+                    - _avs_coap_option_delta(_avs_coap_optit_current(out_it));
+            return true;
+        }
+    }
+    if (index->size > 0) {
+        // otherwise, there are no options and out_it is already at the end
+        out_it->curr_opt = (uint8_t *) opts->begin + opts->size;
+    }
+    return true;
+}
+
 const avs_coap_option_t *
 _avs_coap_options_find_first_opt(const avs_coap_options_t *opts,
                                  uint16_t opt_number) {
+    avs_coap_option_iterator_t index_it;
+    if (index_lookup(opts, opt_number, &index_it)) {
+        return _avs_coap_optit_end(&index_it)
+                       ? NULL
+                       : _avs_coap_optit_current(&index_it);
+    }
+
     // TODO: const_cast; maybe const_iterator could be nice?
     for (avs_coap_option_iterator_t it =
                  _avs_coap_optit_begin((avs_coap_options_t *) (intptr_t) opts);
@@ -717,6 +854,13 @@ int avs_coap_options_get_block(const avs_coap_options_t *opts,
     memset(out_info, 0, sizeof(*out_info));
     const avs_coap_option_t *opt =
             _avs_coap_options_find_first_opt(opts, opt_number);
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+    if (!opt && type == AVS_COAP_BLOCK2) {
+        // Q-Block2 is used the same way as BLOCK2, see RFC 9177, 4.4
+        opt_number = AVS_COAP_OPTION_Q_BLOCK2;
+        opt = _avs_coap_options_find_first_opt(opts, opt_number);
+    }
+#    endif // WITH_AVS_COAP_Q_BLOCK
     if (!opt) {
         return AVS_COAP_OPTION_MISSING;
     }
@@ -761,18 +905,25 @@ static int get_option_it(const avs_coap_options_t *opts,
                                             void *buffer,
                                             size_t buffer_size)) {
     if (!it->opts) {
-        // TODO: const_cast; maybe const_iterator could be nice?
-        *it = _avs_coap_optit_begin((avs_coap_options_t *) (intptr_t) opts);
+        if (!index_lookup(opts, option_number, it)) {
+            // TODO: const_cast; maybe const_iterator could be nice?
+            *it = _avs_coap_optit_begin(
+                    (avs_coap_options_t *) (intptr_t) opts);
+        }
     } else {
         assert(it->opts == opts);
     }
 
     int retval = AVS_COAP_OPTION_MISSING;
     for (; !_avs_coap_optit_end(it); _avs_coap_optit_next(it)) {
-        if (_avs_coap_optit_number(it) == option_number) {
+        uint32_t curr_opt_number = _avs_coap_optit_number(it);
+        if (curr_opt_number == option_number) {
             retval = fetch_value(_avs_coap_optit_current(it), out_opt_size,
                                  buffer, buffer_size);
             break;
+        } else if (curr_opt_number > option_number) {
+            // options are sorted by number, there will be no more matches
+            break;
         }
     }
 
@@ -938,7 +1089,8 @@ static bool option_must_not_change_during_transfer(uint16_t opt_num) {
             // BLOCK options *do* change during block transfer, even though
             // they are "critical"
             && opt_num != AVS_COAP_OPTION_BLOCK1
-            && opt_num != AVS_COAP_OPTION_BLOCK2)
+            && opt_num != AVS_COAP_OPTION_BLOCK2
+            && opt_num != AVS_COAP_OPTION_Q_BLOCK2)
            // Content-Format is not critical, but if it changes, that's a pretty
            // big WTF.
            || opt_num == AVS_COAP_OPTION_CONTENT_FORMAT;
@@ -961,6 +1113,14 @@ static size_t get_block_offset(const avs_coap_options_t *opts,
     return (block.seq_num + seq_num_offset) * block.size;
 }
 
+static bool has_block2(const avs_coap_options_t *opts) {
+    return _avs_coap_option_exists(opts, AVS_COAP_OPTION_BLOCK2)
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+           || _avs_coap_option_exists(opts, AVS_COAP_OPTION_Q_BLOCK2)
+#    endif // WITH_AVS_COAP_Q_BLOCK
+            ;
+}
+
 static inline size_t next_block1_offset(const avs_coap_options_t *prev) {
     return get_block_offset(prev, AVS_COAP_BLOCK1, 1);
 }
@@ -1063,12 +1223,10 @@ bool _avs_coap_options_is_sequential_block_request(
 
     const bool prev_response_has_block1 =
             _avs_coap_option_exists(prev_response, AVS_COAP_OPTION_BLOCK1);
-    const bool prev_response_has_block2 =
-            _avs_coap_option_exists(prev_response, AVS_COAP_OPTION_BLOCK2);
+    const bool prev_response_has_block2 = has_block2(prev_response);
     const bool curr_request_has_block1 =
             _avs_coap_option_exists(curr, AVS_COAP_OPTION_BLOCK1);
-    const bool curr_request_has_block2 =
-            _avs_coap_option_exists(curr, AVS_COAP_OPTION_BLOCK2);
+    const bool curr_request_has_block2 = has_block2(curr);
 
     /* First case from the table above. */
     if (prev_response_has_block1 && !prev_response_has_block2) {
@@ -1107,7 +1265,7 @@ validate_block2_in_block1_request(const avs_coap_options_t *opts) {
 
     int result = avs_coap_options_get_block(opts, AVS_COAP_BLOCK1, &block1);
     if (result == AVS_COAP_OPTION_MISSING
-            || !_avs_coap_option_exists(opts, AVS_COAP_OPTION_BLOCK2)) {
+            || !has_block2(opts)) {
         return AVS_OK;
     }
     AVS_ASSERT(!result, "BUG: malformed option passed option validation");
@@ -1152,7 +1310,8 @@ bool _avs_coap_options_block_payload_valid(const avs_coap_options_t *opts,
 static bool is_request_key_option(uint16_t opt_num) {
     return option_must_not_change_during_transfer(opt_num)
            || opt_num == AVS_COAP_OPTION_BLOCK1
-           || opt_num == AVS_COAP_OPTION_BLOCK2;
+           || opt_num == AVS_COAP_OPTION_BLOCK2
+           || opt_num == AVS_COAP_OPTION_Q_BLOCK2;
 }
 
 avs_error_t _avs_coap_options_parse(avs_coap_options_t *out_opts,
@@ -1171,11 +1330,9 @@ avs_error_t _avs_coap_options_parse(avs_coap_options_t *out_opts,
         .capacity = dispenser->bytes_left
     };
 
-    if (!_avs_coap_options_valid_until_payload_marker(
-                out_opts,
-                &out_opts->size,
-                out_truncated_options,
-                out_payload_marker_reached)) {
+    if (!validate_options(out_opts, &out_opts->size, out_truncated_options,
+                          out_payload_marker_reached,
+                          &out_opts->lookup_index)) {
         return _avs_coap_err(AVS_COAP_ERR_MALFORMED_OPTIONS);
     }
 
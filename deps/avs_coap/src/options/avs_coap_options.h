@@ -32,6 +32,7 @@ _avs_coap_options_copy_into(avs_coap_options_t *out_dest,
         memcpy(out_dest->begin, src->begin, src->size);
     }
     out_dest->size = src->size;
+    out_dest->lookup_index = src->lookup_index;
     return AVS_OK;
 }
 
@@ -169,6 +170,27 @@ _avs_coap_options_get_block_by_code(const avs_coap_options_t *options,
                                     avs_coap_option_block_t *out_block,
                                     bool *out_has_block);
 
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+/**
+ * Retrieves the Q-Block1 option (RFC 9177) from @p opts . Its contents are
+ * reported as if it was a BLOCK1 option.
+ *
+ * @returns 0 on success, @ref AVS_COAP_OPTION_MISSING if there is no Q-Block1
+ *          option, or a negative value if it is malformed.
+ */
+int _avs_coap_options_get_q_block1(const avs_coap_options_t *opts,
+                                   avs_coap_option_block_t *out_info);
+
+/**
+ * Replaces the BLOCK1 or BLOCK2 option (depending on @p type ) in @p opts with
+ * a Q-Block1 or Q-Block2 option, respectively, with the same value. Does
+ * nothing if there is no such option.
+ */
+avs_error_t
+_avs_coap_options_convert_to_q_block(avs_coap_options_t *opts,
+                                     avs_coap_option_block_type_t type);
+#    endif // WITH_AVS_COAP_Q_BLOCK
+
 #endif // WITH_AVS_COAP_BLOCK
 
 avs_error_t _avs_coap_options_parse(avs_coap_options_t *out_opts,
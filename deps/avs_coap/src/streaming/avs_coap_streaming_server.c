@@ -137,13 +137,13 @@ try_enter_sending_state(avs_coap_streaming_request_ctx_t *ctx) {
             &_avs_coap_get_base(ctx->server_ctx.coap_ctx)->request_ctx,
             &ctx->response_header, feed_payload_chunk, &ctx->server_ctx);
     if (avs_is_ok(err)) {
-        if (avs_buffer_data_size(ctx->server_ctx.chunk_buffer) > 0) {
+        if (ctx->server_ctx.request_chunk_size > 0) {
             LOG(WARNING,
                 _("Ignoring ") "%s" _(" unread bytes of request"),
-                AVS_UINT64_AS_STRING(
-                        avs_buffer_data_size(ctx->server_ctx.chunk_buffer)));
-            avs_buffer_reset(ctx->server_ctx.chunk_buffer);
+                AVS_UINT64_AS_STRING(ctx->server_ctx.request_chunk_size));
         }
+        ctx->server_ctx.request_chunk = NULL;
+        ctx->server_ctx.request_chunk_size = 0;
         ctx->server_ctx.state =
                 AVS_COAP_STREAMING_SERVER_SENDING_FIRST_RESPONSE_CHUNK;
     }
@@ -153,44 +153,20 @@ try_enter_sending_state(avs_coap_streaming_request_ctx_t *ctx) {
 static avs_error_t
 init_chunk_buffer(avs_coap_ctx_t *ctx,
                   avs_buffer_t **out_buffer,
-                  const avs_coap_server_async_request_t *request,
                   const avs_coap_response_header_t *response) {
     /**
-     * In case of incoming requests, the buffer must be able to hold either
-     * request or response payload, so we need to take maximum of:
-     * - maximum estimated request chunk size - for BLOCK transfers, this will
-     *   be the BLOCK1 size of a first request chunk (it can never grow during
-     *   the transfer); for non-BLOCK transfers, we need to take in_buffer_size
-     *   instead,
-     * - maximum estimated response chunk size - here we use @ref
-     *   _avs_coap_get_next_outgoing_chunk_payload_size , assuming an arbitrary
-     *   response code and empty options list (effectively calculating the
-     *   biggest possible response payload chunk size).
+     * The buffer only needs to hold response payload, as request payload is
+     * read directly from the buffer it has been received into. Its size is the
+     * maximum estimated response chunk size, calculated using @ref
+     * _avs_coap_get_first_outgoing_chunk_payload_size .
+     *
+     * In case of incoming requests, we assume an arbitrary response code and
+     * empty options list (effectively calculating the biggest possible response
+     * payload chunk size), so @p response is NULL.
      *
      * In case of notifications, we know the response headers in advance, so
-     * we use this information instead of dummy values. In this case, we will
-     * never receive any request payload, so @p request is NULL.
+     * we use this information instead of dummy values.
      */
-    size_t max_request_chunk_size = 0;
-    if (request) {
-        max_request_chunk_size = _avs_coap_get_base(ctx)->in_buffer->capacity;
-#    ifdef WITH_AVS_COAP_BLOCK
-        avs_coap_option_block_t req_block1;
-        switch (avs_coap_options_get_block(&request->header.options,
-                                           AVS_COAP_BLOCK1, &req_block1)) {
-        case 0:
-            max_request_chunk_size =
-                    AVS_MIN(req_block1.size, max_request_chunk_size);
-            break;
-        case AVS_COAP_OPTION_MISSING:
-            break;
-        default:
-            AVS_UNREACHABLE("malformed options got through packet validation");
-            return _avs_coap_err(AVS_COAP_ERR_MALFORMED_OPTIONS);
-        }
-#    endif // WITH_AVS_COAP_BLOCK
-    }
-
     size_t max_response_chunk_size;
     avs_coap_options_t empty_opts = avs_coap_options_create_empty(NULL, 0);
     avs_error_t err = _avs_coap_get_first_outgoing_chunk_payload_size(
@@ -205,8 +181,7 @@ init_chunk_buffer(avs_coap_ctx_t *ctx,
     }
 
     avs_buffer_free(out_buffer);
-    if (avs_buffer_create(out_buffer, AVS_MAX(max_request_chunk_size,
-                                              max_response_chunk_size))) {
+    if (avs_buffer_create(out_buffer, max_response_chunk_size)) {
         return avs_errno(AVS_ENOMEM);
     }
 
@@ -256,8 +231,7 @@ static int request_handler(avs_coap_request_ctx_t *request_ctx,
 
         if (avs_is_err(init_chunk_buffer(
                     streaming_req_ctx->server_ctx.coap_ctx,
-                    &streaming_req_ctx->server_ctx.chunk_buffer, request,
-                    NULL))) {
+                    &streaming_req_ctx->server_ctx.chunk_buffer, NULL))) {
             return AVS_COAP_CODE_INTERNAL_SERVER_ERROR;
         }
 
@@ -275,11 +249,10 @@ static int request_handler(avs_coap_request_ctx_t *request_ctx,
         // request with payload_offset == 0.
         return AVS_COAP_CODE_REQUEST_ENTITY_INCOMPLETE;
     }
-    assert(request->payload_size
-           <= avs_buffer_space_left(
-                      streaming_req_ctx->server_ctx.chunk_buffer));
-    avs_buffer_append_bytes(streaming_req_ctx->server_ctx.chunk_buffer,
-                            request->payload, request->payload_size);
+    assert(!streaming_req_ctx->server_ctx.request_chunk_size);
+    streaming_req_ctx->server_ctx.request_chunk =
+            (const uint8_t *) request->payload;
+    streaming_req_ctx->server_ctx.request_chunk_size = request->payload_size;
     assert(request_ctx
            == &_avs_coap_get_base(streaming_req_ctx->server_ctx.coap_ctx)
                        ->request_ctx);
@@ -575,8 +548,7 @@ static avs_error_t ensure_data_is_available_to_read(
     // supposed to be another chunk of request.
     if (streaming_req_ctx->server_ctx.state
                     == AVS_COAP_STREAMING_SERVER_RECEIVED_REQUEST_CHUNK
-            && avs_buffer_data_size(streaming_req_ctx->server_ctx.chunk_buffer)
-                           == 0) {
+            && streaming_req_ctx->server_ctx.request_chunk_size == 0) {
         // All data from the previously received chunk has been consumed by the
         // user. We now can send the response, concluding the replication of
         // _avs_coap_async_incoming_packet_simple_handle() logic. We could do it
@@ -646,22 +618,22 @@ static avs_error_t coap_read(avs_stream_t *stream_,
         return err;
     }
 
-    size_t bytes_to_read = AVS_MIN(
-            buffer_length,
-            avs_buffer_data_size(streaming_req_ctx->server_ctx.chunk_buffer));
-    memcpy(buffer, avs_buffer_data(streaming_req_ctx->server_ctx.chunk_buffer),
-           bytes_to_read);
-    avs_buffer_consume_bytes(streaming_req_ctx->server_ctx.chunk_buffer,
-                             bytes_to_read);
+    avs_coap_streaming_server_ctx_t *server_ctx =
+            &streaming_req_ctx->server_ctx;
+    size_t bytes_to_read =
+            AVS_MIN(buffer_length, server_ctx->request_chunk_size);
+    if (bytes_to_read) {
+        memcpy(buffer, server_ctx->request_chunk, bytes_to_read);
+        server_ctx->request_chunk += bytes_to_read;
+        server_ctx->request_chunk_size -= bytes_to_read;
+    }
     if (out_bytes_read) {
         *out_bytes_read = bytes_to_read;
     }
     if (out_message_finished) {
         *out_message_finished =
-                (avs_buffer_data_size(
-                         streaming_req_ctx->server_ctx.chunk_buffer)
-                         == 0
-                 && streaming_req_ctx->server_ctx.state
+                (server_ctx->request_chunk_size == 0
+                 && server_ctx->state
                             == AVS_COAP_STREAMING_SERVER_RECEIVED_LAST_REQUEST_CHUNK);
     }
     return AVS_OK;
@@ -676,12 +648,11 @@ coap_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
         return err;
     }
 
-    if (offset >= avs_buffer_data_size(
-                          streaming_req_ctx->server_ctx.chunk_buffer)) {
+    if (offset >= streaming_req_ctx->server_ctx.request_chunk_size) {
         return AVS_EOF;
     }
     *out_value =
-            avs_buffer_data(streaming_req_ctx->server_ctx.chunk_buffer)[offset];
+            (char) streaming_req_ctx->server_ctx.request_chunk[offset];
     return AVS_OK;
 }
 
@@ -938,7 +909,6 @@ avs_coap_notify_streaming(avs_coap_ctx_t *ctx,
     if (avs_is_err((notify_streaming_ctx.err = init_chunk_buffer(
                             ctx,
                             &notify_streaming_ctx.server_ctx.chunk_buffer,
-                            NULL,
                             response_header)))) {
         goto finish;
     }
@@ -41,13 +41,23 @@ typedef struct {
     size_t expected_next_outgoing_chunk_offset;
 
     /**
-     * Depending on stream state, this buffer may be used either for *request*
-     * payload (RECEIVING_REQUEST, RECEIVING_REQUEST_CHUNK,
-     * RECEIVED_LAST_REQUEST_CHUNK) or *response* payload
-     * (SENDING_FIRST_RESPONSE_CHUNK, SENDING_RESPONSE_CHUNK,
-     * SENT_LAST_RESPONSE_CHUNK)
+     * Buffer for *response* payload (SENDING_FIRST_RESPONSE_CHUNK,
+     * SENDING_RESPONSE_CHUNK, SENT_LAST_RESPONSE_CHUNK). For incoming requests,
+     * it is allocated when the first request chunk is received, so its
+     * presence also indicates that a request is being handled.
      */
     avs_buffer_t *chunk_buffer;
+
+    /**
+     * Unread part of the most recently received *request* payload chunk
+     * (RECEIVED_REQUEST_CHUNK, RECEIVED_LAST_REQUEST_CHUNK). It is not copied,
+     * but points directly into the buffer the message has been received into
+     * (the acquired in_buffer or, for CoAP/TCP, the options buffer of the
+     * context). It remains valid because no other packet is received before
+     * it is fully consumed.
+     */
+    const uint8_t *request_chunk;
+    size_t request_chunk_size;
 } avs_coap_streaming_server_ctx_t;
 
 struct avs_coap_streaming_request_ctx {
@@ -93,6 +93,59 @@ static void log_tcp_msg_summary(const char *info,
 #    endif // WITH_AVS_COAP_BLOCK
 }
 
+static avs_error_t send_data(avs_coap_tcp_ctx_t *ctx,
+                             const void *data,
+                             size_t data_size) {
+    avs_error_t err = avs_net_socket_send(ctx->base.socket, data, data_size);
+    if (avs_is_err(err)) {
+        LOG(DEBUG, _("send failed: ") "%s", AVS_COAP_STRERROR(err));
+        SET_DIAGNOSTIC_MESSAGE(ctx, "send failed");
+    } else {
+        ctx->last_activity = avs_time_monotonic_now();
+    }
+    return err;
+}
+
+static avs_error_t flush_cork_buffer(avs_coap_tcp_ctx_t *ctx) {
+    if (!ctx->cork_buffer || !avs_buffer_data_size(ctx->cork_buffer)) {
+        return AVS_OK;
+    }
+    LOG(TRACE, _("flushing ") "%u" _(" B of coalesced messages"),
+        (unsigned) avs_buffer_data_size(ctx->cork_buffer));
+    avs_error_t err = send_data(ctx, avs_buffer_data(ctx->cork_buffer),
+                                avs_buffer_data_size(ctx->cork_buffer));
+    // On failure, the context is aborted anyway, so there is no point in
+    // keeping the data around.
+    avs_buffer_reset(ctx->cork_buffer);
+    return err;
+}
+
+static avs_error_t send_or_cork(avs_coap_tcp_ctx_t *ctx,
+                                const void *data,
+                                size_t data_size) {
+    if (!ctx->cork_buffer || !ctx->base.socket
+            || data_size > avs_buffer_capacity(ctx->cork_buffer)) {
+        avs_error_t err = flush_cork_buffer(ctx);
+        return avs_is_ok(err) ? send_data(ctx, data, data_size) : err;
+    }
+
+    if (data_size > avs_buffer_space_left(ctx->cork_buffer)) {
+        avs_error_t err = flush_cork_buffer(ctx);
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+
+    if (!avs_buffer_data_size(ctx->cork_buffer)) {
+        // Make sure that the data gets flushed at the end of the current
+        // scheduler run, see coap_tcp_on_timeout().
+        _avs_coap_reschedule_retry_or_request_expired_job(
+                (avs_coap_ctx_t *) ctx, avs_time_monotonic_now());
+    }
+    avs_buffer_append_bytes(ctx->cork_buffer, data, data_size);
+    return AVS_OK;
+}
+
 avs_error_t _avs_coap_tcp_send_msg(avs_coap_tcp_ctx_t *ctx,
                                    const avs_coap_borrowed_msg_t *msg) {
     void *out_buf = avs_shared_buffer_acquire(ctx->base.out_buffer);
@@ -103,11 +156,7 @@ avs_error_t _avs_coap_tcp_send_msg(avs_coap_tcp_ctx_t *ctx,
 
     if (avs_is_ok(err)) {
         log_tcp_msg_summary("send", msg);
-        if (avs_is_err((err = avs_net_socket_send(ctx->base.socket, out_buf,
-                                                  msg_size)))) {
-            LOG(DEBUG, _("send failed: ") "%s", AVS_COAP_STRERROR(err));
-            SET_DIAGNOSTIC_MESSAGE(ctx, "send failed");
-        }
+        err = send_or_cork(ctx, out_buf, msg_size);
     }
 
     avs_shared_buffer_release(ctx->base.out_buffer);
@@ -243,6 +292,7 @@ static avs_error_t coap_tcp_recv_data(avs_coap_tcp_ctx_t *ctx,
         return _avs_coap_err(AVS_COAP_ERR_TCP_CONN_CLOSED);
     }
 
+    ctx->last_activity = avs_time_monotonic_now();
     return AVS_OK;
 }
 
@@ -262,7 +312,41 @@ static inline void send_abort(avs_coap_tcp_ctx_t *ctx) {
         (void) send_simple_msg(ctx, AVS_COAP_CODE_ABORT,
                                &ctx->cached_msg.content.token,
                                GET_DIAGNOSTIC_MESSAGE(ctx));
+        (void) flush_cork_buffer(ctx);
+    }
+}
+
+static avs_error_t flush_or_abort(avs_coap_tcp_ctx_t *ctx) {
+    avs_error_t err = flush_cork_buffer(ctx);
+    if (avs_is_err(err)) {
+        LOG(ERROR, _("failed to send coalesced messages, aborting"));
+        send_abort(ctx);
+    }
+    return err;
+}
+
+static void finish_ping(avs_coap_tcp_ctx_t *ctx, avs_error_t err) {
+    avs_coap_tcp_pong_handler_t *pong_handler = ctx->ping.pong_handler;
+    void *pong_handler_arg = ctx->ping.pong_handler_arg;
+
+    // Reset the state first, so that the handler may send another Ping.
+    ctx->ping.pong_handler = NULL;
+    ctx->ping.pong_handler_arg = NULL;
+    ctx->ping.deadline = AVS_TIME_MONOTONIC_INVALID;
+    if (pong_handler) {
+        pong_handler((avs_coap_ctx_t *) ctx, err, pong_handler_arg);
+    }
+}
+
+void _avs_coap_tcp_handle_pong(avs_coap_tcp_ctx_t *ctx,
+                               const avs_coap_token_t *token) {
+    if (!ctx->ping.pong_handler
+            || !avs_coap_token_equal(&ctx->ping.token, token)) {
+        LOG(DEBUG, _("unexpected Pong message arrived, ignoring"));
+        return;
     }
+    LOG(TRACE, _("Pong received"));
+    finish_ping(ctx, AVS_OK);
 }
 
 static void coap_tcp_cleanup(avs_coap_ctx_t *ctx_) {
@@ -273,7 +357,12 @@ static void coap_tcp_cleanup(avs_coap_ctx_t *ctx_) {
     // "The peer responding to the Release message SHOULD delay the closing of
     //  the connection until it has responded to all requests received by it
     //  before the Release message."
+    if (ctx->base.socket) {
+        (void) flush_cork_buffer(ctx);
+    }
     _avs_coap_tcp_cancel_all_pending_requests(ctx);
+    finish_ping(ctx, _avs_coap_err(AVS_COAP_ERR_EXCHANGE_CANCELED));
+    avs_buffer_free(&ctx->cork_buffer);
     avs_buffer_free(&ctx->opt_cache.buffer);
     avs_free(ctx);
 }
@@ -302,6 +391,7 @@ coap_tcp_max_outgoing_payload_size(avs_coap_ctx_t *ctx_,
                                    uint8_t code) {
     (void) code;
     avs_coap_tcp_ctx_t *ctx = (avs_coap_tcp_ctx_t *) ctx_;
+    ctx->base.transport_max_out_msg_size = ctx->peer_csm.max_message_size;
     return max_payload_size(ctx->base.out_buffer->capacity,
                             ctx->peer_csm.max_message_size, token_size,
                             options ? options->size : 0);
@@ -347,7 +437,7 @@ coap_tcp_send_message(avs_coap_ctx_t *ctx_,
     }
     SET_DIAGNOSTIC_MESSAGE(ctx, NULL);
 
-    AVS_LIST(avs_coap_tcp_pending_request_t) *req = NULL;
+    avs_coap_tcp_pending_request_t *req = NULL;
     if (send_result_handler && avs_coap_code_is_request(msg->code)) {
         avs_error_t err =
                 _avs_coap_tcp_create_pending_request(ctx, &req, &msg->token,
@@ -371,7 +461,7 @@ coap_tcp_send_message(avs_coap_ctx_t *ctx_,
         }
     } else {
         if (req) {
-            _avs_coap_tcp_remove_pending_request(req);
+            _avs_coap_tcp_remove_pending_request(ctx, req);
         }
         send_abort(ctx);
     }
@@ -788,6 +878,13 @@ coap_tcp_receive_message(avs_coap_ctx_t *ctx_,
         return err;
     }
 
+    // The caller might be waiting for a response to a message that is still
+    // buffered, so flush it before blocking.
+    if (!avs_time_duration_equal(timeout, AVS_TIME_DURATION_ZERO)
+            && avs_is_err((err = flush_or_abort(ctx)))) {
+        return err;
+    }
+
     if (ctx->cached_msg.remaining_bytes == 0
             && ctx->cached_msg.remaining_header_bytes == 0) {
         finish_message_handling(ctx);
@@ -813,6 +910,9 @@ static void update_timeout(avs_time_monotonic_t *result_ptr,
 static avs_time_monotonic_t coap_tcp_on_timeout(avs_coap_ctx_t *ctx_) {
     avs_coap_tcp_ctx_t *ctx = (avs_coap_tcp_ctx_t *) ctx_;
     avs_time_monotonic_t result = AVS_TIME_MONOTONIC_INVALID;
+    if (avs_coap_ctx_has_socket(ctx_) && !ctx->aborted) {
+        (void) flush_or_abort(ctx);
+    }
     if (avs_coap_ctx_has_socket(ctx_)
             && avs_time_monotonic_valid(ctx->peer_csm.recv_deadline)) {
         if (avs_time_monotonic_before(avs_time_monotonic_now(),
@@ -824,6 +924,15 @@ static avs_time_monotonic_t coap_tcp_on_timeout(avs_coap_ctx_t *ctx_) {
             send_abort(ctx);
         }
     }
+    if (avs_time_monotonic_valid(ctx->ping.deadline)
+            && !avs_time_monotonic_before(avs_time_monotonic_now(),
+                                          ctx->ping.deadline)) {
+        LOG(DEBUG, _("Pong not received within timeout"));
+        finish_ping(ctx, _avs_coap_err(AVS_COAP_ERR_TIMEOUT));
+    }
+    if (avs_time_monotonic_valid(ctx->ping.deadline)) {
+        update_timeout(&result, ctx->ping.deadline);
+    }
     update_timeout(&result, _avs_coap_tcp_fail_expired_pending_requests(ctx));
     return result;
 }
@@ -867,6 +976,7 @@ static avs_error_t coap_tcp_setsock(avs_coap_ctx_t *ctx_,
         return err;
     }
 
+    ctx->last_activity = avs_time_monotonic_now();
     ctx->peer_csm.recv_deadline = AVS_TIME_MONOTONIC_INVALID;
     err = avs_errno(AVS_EOVERFLOW);
     if (_avs_coap_tcp_update_recv_deadline(ctx, &ctx->peer_csm.recv_deadline)
@@ -893,6 +1003,22 @@ static uint32_t coap_tcp_next_observe_option_value(avs_coap_ctx_t *ctx,
     return 0;
 }
 
+#    ifdef WITH_AVS_COAP_BLOCK
+static bool coap_tcp_bert_supported(avs_coap_ctx_t *ctx_) {
+    avs_coap_tcp_ctx_t *ctx = (avs_coap_tcp_ctx_t *) ctx_;
+    // "If a Max-Message-Size Option is indicated with a value that is greater
+    //  than 1152 (in the same CSM or a different CSM), the Block-Wise-Transfer
+    //  Option also indicates support for BERT"
+    return !avs_time_monotonic_valid(ctx->peer_csm.recv_deadline)
+           && ctx->peer_csm.block_wise_transfer_capable
+           && ctx->peer_csm.max_message_size > CSM_MAX_MESSAGE_SIZE_BASE_VALUE;
+}
+#    endif // WITH_AVS_COAP_BLOCK
+
+static size_t coap_tcp_receive_budget(avs_coap_ctx_t *ctx) {
+    return ((avs_coap_tcp_ctx_t *) ctx)->receive_budget;
+}
+
 static const avs_coap_ctx_vtable_t COAP_TCP_VTABLE = {
     .cleanup = coap_tcp_cleanup,
     .get_base = coap_tcp_get_base,
@@ -905,7 +1031,11 @@ static const avs_coap_ctx_vtable_t COAP_TCP_VTABLE = {
     .ignore_current_request = coap_tcp_ignore_current_request,
     .receive_message = coap_tcp_receive_message,
     .on_timeout = coap_tcp_on_timeout,
-    .next_observe_option_value = coap_tcp_next_observe_option_value
+    .next_observe_option_value = coap_tcp_next_observe_option_value,
+#    ifdef WITH_AVS_COAP_BLOCK
+    .bert_supported = coap_tcp_bert_supported,
+#    endif // WITH_AVS_COAP_BLOCK
+    .receive_budget = coap_tcp_receive_budget
 };
 
 avs_coap_ctx_t *avs_coap_tcp_ctx_create(avs_sched_t *sched,
@@ -954,8 +1084,98 @@ avs_coap_ctx_t *avs_coap_tcp_ctx_create(avs_sched_t *sched,
     ctx->peer_csm.recv_deadline = avs_time_monotonic_now();
     ctx->peer_csm.max_message_size = CSM_MAX_MESSAGE_SIZE_BASE_VALUE;
     ctx->request_timeout = request_timeout;
+    ctx->last_activity = AVS_TIME_MONOTONIC_INVALID;
+    ctx->ping.deadline = AVS_TIME_MONOTONIC_INVALID;
+    ctx->receive_budget = 1;
 
     return (avs_coap_ctx_t *) ctx;
 }
 
+int avs_coap_tcp_ctx_set_receive_budget(avs_coap_ctx_t *ctx_,
+                                        size_t max_messages) {
+    if (!ctx_ || ctx_->vtable != &COAP_TCP_VTABLE) {
+        LOG(ERROR, _("avs_coap_tcp_ctx_set_receive_budget() called on a NULL "
+                     "or non-TCP context"));
+        return -1;
+    }
+    ((avs_coap_tcp_ctx_t *) ctx_)->receive_budget = AVS_MAX(max_messages, 1);
+    return 0;
+}
+
+int avs_coap_tcp_ctx_set_write_coalescing(avs_coap_ctx_t *ctx_,
+                                          size_t buffer_size) {
+    if (!ctx_ || ctx_->vtable != &COAP_TCP_VTABLE) {
+        LOG(ERROR, _("avs_coap_tcp_ctx_set_write_coalescing() called on a "
+                     "NULL or non-TCP context"));
+        return -1;
+    }
+
+    avs_coap_tcp_ctx_t *ctx = (avs_coap_tcp_ctx_t *) ctx_;
+    if (avs_is_err(flush_or_abort(ctx))) {
+        return -1;
+    }
+    avs_buffer_free(&ctx->cork_buffer);
+    if (buffer_size && avs_buffer_create(&ctx->cork_buffer, buffer_size)) {
+        LOG(ERROR, _("out of memory"));
+        return -1;
+    }
+    return 0;
+}
+
+avs_error_t avs_coap_tcp_ctx_flush(avs_coap_ctx_t *ctx) {
+    if (!ctx || ctx->vtable != &COAP_TCP_VTABLE) {
+        LOG(ERROR, _("avs_coap_tcp_ctx_flush() called on a NULL or non-TCP "
+                     "context"));
+        return avs_errno(AVS_EINVAL);
+    }
+    return flush_or_abort((avs_coap_tcp_ctx_t *) ctx);
+}
+
+avs_error_t
+avs_coap_tcp_ctx_send_ping(avs_coap_ctx_t *ctx_,
+                           avs_coap_tcp_pong_handler_t *pong_handler,
+                           void *arg) {
+    if (!ctx_ || ctx_->vtable != &COAP_TCP_VTABLE) {
+        LOG(ERROR, _("avs_coap_tcp_ctx_send_ping() called on a NULL or "
+                     "non-TCP context"));
+        return avs_errno(AVS_EINVAL);
+    }
+    assert(pong_handler);
+
+    avs_coap_tcp_ctx_t *ctx = (avs_coap_tcp_ctx_t *) ctx_;
+    if (!avs_coap_ctx_has_socket(ctx_)) {
+        LOG(ERROR, _("cannot send Ping without a socket"));
+        return avs_errno(AVS_EBADF);
+    }
+    if (ctx->ping.pong_handler) {
+        LOG(DEBUG, _("Ping already in progress"));
+        return avs_errno(AVS_EBUSY);
+    }
+
+    avs_coap_token_t token;
+    avs_error_t err = _avs_coap_ctx_generate_token(ctx->base.prng_ctx, &token);
+    if (avs_is_err(err)
+            || avs_is_err((err = send_simple_msg(ctx, AVS_COAP_CODE_PING,
+                                                 &token, NULL)))) {
+        return err;
+    }
+
+    ctx->ping.token = token;
+    ctx->ping.deadline = avs_time_monotonic_add(avs_time_monotonic_now(),
+                                                ctx->request_timeout);
+    ctx->ping.pong_handler = pong_handler;
+    ctx->ping.pong_handler_arg = arg;
+    _avs_coap_reschedule_retry_or_request_expired_job(ctx_,
+                                                      ctx->ping.deadline);
+    return AVS_OK;
+}
+
+avs_time_monotonic_t avs_coap_tcp_ctx_get_last_activity(avs_coap_ctx_t *ctx) {
+    if (!ctx || ctx->vtable != &COAP_TCP_VTABLE
+            || !avs_coap_ctx_has_socket(ctx)) {
+        return AVS_TIME_MONOTONIC_INVALID;
+    }
+    return ((avs_coap_tcp_ctx_t *) ctx)->last_activity;
+}
+
 #endif // WITH_AVS_COAP_TCP
@@ -7,6 +7,8 @@
  * See the attached LICENSE file for details.
  */
 
+#include <avsystem/coap/tcp.h>
+
 #include "avs_coap_ctx.h"
 
 #include "tcp/avs_coap_tcp_msg.h"
@@ -38,10 +40,26 @@ typedef struct avs_coap_tcp_ctx_struct {
     avs_coap_tcp_opt_cache_t opt_cache;
     avs_coap_tcp_cached_msg_t cached_msg;
     avs_coap_tcp_csm_t peer_csm;
-    // Sorted by @ref avs_coap_tcp_pending_request_t#expire_time
-    AVS_LIST(avs_coap_tcp_pending_request_t) pending_requests;
+    avs_coap_tcp_pending_requests_t pending_requests;
+    // Outgoing messages buffered for a single write, NULL if write coalescing
+    // is disabled. See avs_coap_tcp_ctx_set_write_coalescing().
+    avs_buffer_t *cork_buffer;
+    // Number of messages to try receiving per incoming packet event. See
+    // avs_coap_tcp_ctx_set_receive_budget().
+    size_t receive_budget;
     // Timeout defined during creation of CoAP TCP context.
     avs_time_duration_t request_timeout;
+    // Time of the last successful write to or read from the socket.
+    avs_time_monotonic_t last_activity;
+
+    // State of the Ping sent with avs_coap_tcp_ctx_send_ping(). pong_handler
+    // is NULL if there is no Ping waiting for a Pong.
+    struct {
+        avs_coap_token_t token;
+        avs_time_monotonic_t deadline;
+        avs_coap_tcp_pong_handler_t *pong_handler;
+        void *pong_handler_arg;
+    } ping;
 
 #    ifdef WITH_AVS_COAP_DIAGNOSTIC_MESSAGES
     const char *err_details;
@@ -61,6 +79,13 @@ typedef struct avs_coap_tcp_ctx_struct {
 avs_error_t _avs_coap_tcp_send_msg(avs_coap_tcp_ctx_t *ctx,
                                    const avs_coap_borrowed_msg_t *msg);
 
+/**
+ * Finishes the Ping sent with avs_coap_tcp_ctx_send_ping(), if @p token matches
+ * its token. Called when a Pong message is received.
+ */
+void _avs_coap_tcp_handle_pong(avs_coap_tcp_ctx_t *ctx,
+                               const avs_coap_token_t *token);
+
 static inline int
 _avs_coap_tcp_update_recv_deadline(avs_coap_tcp_ctx_t *ctx,
                                    avs_time_monotonic_t *inout_deadline) {
@@ -13,12 +13,13 @@
 
 #    include <avsystem/coap/token.h>
 #    include <avsystem/commons/avs_errno.h>
-#    include <avsystem/commons/avs_list.h>
+#    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_sched.h>
 
 #    define MODULE_NAME coap_tcp
 #    include <avs_coap_x_log_config.h>
 
+#    include "avs_coap_common_utils.h"
 #    include "tcp/avs_coap_tcp_ctx.h"
 
 VISIBILITY_SOURCE_BEGIN
@@ -27,6 +28,13 @@ struct avs_coap_tcp_pending_request_struct {
     avs_coap_tcp_response_handler_t handler;
     avs_coap_token_t token;
     avs_time_monotonic_t expire_time;
+
+    /** Creation order, used to order requests with equal expire_time. */
+    uint64_t seq;
+    /** Position in @ref avs_coap_tcp_pending_requests_t#heap . */
+    size_t heap_index;
+    /** Next request in the same bucket of the token index. */
+    avs_coap_tcp_pending_request_t *next_by_token;
 };
 
 static avs_coap_send_result_handler_result_t
@@ -46,47 +54,155 @@ call_pending_request_response_handler(
             pending_request->handler.handle_result_arg);
 }
 
-static inline bool
-is_list_ordered_by_expire_time(AVS_LIST(avs_coap_tcp_pending_request_t) list) {
-    AVS_LIST_ITERATE(list) {
-        AVS_LIST(avs_coap_tcp_pending_request_t) next = list;
-        AVS_LIST_ADVANCE(&next);
-        if (next
-                && !avs_time_monotonic_before(list->expire_time,
-                                              next->expire_time)) {
+static bool expires_before(const avs_coap_tcp_pending_request_t *a,
+                           const avs_coap_tcp_pending_request_t *b) {
+    const bool a_valid = avs_time_monotonic_valid(a->expire_time);
+    const bool b_valid = avs_time_monotonic_valid(b->expire_time);
+    if (a_valid != b_valid) {
+        // requests with invalid expire_time never expire
+        return a_valid;
+    }
+    if (a_valid) {
+        if (avs_time_monotonic_before(a->expire_time, b->expire_time)) {
+            return true;
+        }
+        if (avs_time_monotonic_before(b->expire_time, a->expire_time)) {
             return false;
         }
     }
-    return true;
+    return a->seq < b->seq;
 }
 
-static AVS_LIST(avs_coap_tcp_pending_request_t) *
-insert_pending_request(AVS_LIST(avs_coap_tcp_pending_request_t) *list_ptr,
-                       AVS_LIST(avs_coap_tcp_pending_request_t) req) {
-    AVS_LIST_ITERATE_PTR(list_ptr) {
-        if (avs_time_monotonic_before(req->expire_time,
-                                      (*list_ptr)->expire_time)) {
+static void heap_swap(avs_coap_tcp_pending_requests_t *reqs,
+                      size_t first,
+                      size_t second) {
+    avs_coap_tcp_pending_request_t *tmp = reqs->heap[first];
+    reqs->heap[first] = reqs->heap[second];
+    reqs->heap[second] = tmp;
+    reqs->heap[first]->heap_index = first;
+    reqs->heap[second]->heap_index = second;
+}
+
+static void heap_sift_up(avs_coap_tcp_pending_requests_t *reqs, size_t index) {
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!expires_before(reqs->heap[index], reqs->heap[parent])) {
+            break;
+        }
+        heap_swap(reqs, index, parent);
+        index = parent;
+    }
+}
+
+static void heap_sift_down(avs_coap_tcp_pending_requests_t *reqs,
+                           size_t index) {
+    while (true) {
+        size_t earliest = index;
+        for (size_t child = 2 * index + 1;
+             child <= 2 * index + 2 && child < reqs->count;
+             ++child) {
+            if (expires_before(reqs->heap[child], reqs->heap[earliest])) {
+                earliest = child;
+            }
+        }
+        if (earliest == index) {
             break;
         }
+        heap_swap(reqs, index, earliest);
+        index = earliest;
+    }
+}
+
+static avs_coap_tcp_pending_request_t **
+token_bucket(avs_coap_tcp_pending_requests_t *reqs,
+             const avs_coap_token_t *token) {
+    return &reqs->by_token[_avs_coap_token_hash(token)
+                           & (AVS_COAP_TCP_PENDING_REQUESTS_INDEX_SIZE - 1)];
+}
+
+/**
+ * Makes sure that the heap has room for one more request that will not be
+ * taken by any other insertion, so that @ref insert_reserved_pending_request
+ * cannot fail.
+ */
+static avs_error_t
+reserve_pending_request_slot(avs_coap_tcp_pending_requests_t *reqs) {
+    if (reqs->count + reqs->reserved >= reqs->capacity) {
+        size_t new_capacity = reqs->capacity ? 2 * reqs->capacity : 8;
+        avs_coap_tcp_pending_request_t **new_heap =
+                (avs_coap_tcp_pending_request_t **) avs_realloc(
+                        reqs->heap, new_capacity * sizeof(*reqs->heap));
+        if (!new_heap) {
+            LOG_OOM();
+            return avs_errno(AVS_ENOMEM);
+        }
+        reqs->heap = new_heap;
+        reqs->capacity = new_capacity;
+    }
+    ++reqs->reserved;
+    return AVS_OK;
+}
+
+static void
+insert_reserved_pending_request(avs_coap_tcp_pending_requests_t *reqs,
+                                avs_coap_tcp_pending_request_t *req) {
+    assert(reqs->reserved > 0);
+    assert(reqs->count < reqs->capacity);
+    --reqs->reserved;
+
+    req->seq = reqs->next_seq++;
+    req->heap_index = reqs->count++;
+    reqs->heap[req->heap_index] = req;
+    heap_sift_up(reqs, req->heap_index);
+
+    avs_coap_tcp_pending_request_t **bucket = token_bucket(reqs, &req->token);
+    req->next_by_token = *bucket;
+    *bucket = req;
+}
+
+static avs_error_t insert_pending_request(avs_coap_tcp_pending_requests_t *reqs,
+                                          avs_coap_tcp_pending_request_t *req) {
+    avs_error_t err = reserve_pending_request_slot(reqs);
+    if (avs_is_ok(err)) {
+        insert_reserved_pending_request(reqs, req);
     }
-    AVS_LIST_INSERT(list_ptr, req);
+    return err;
+}
 
-    assert(*list_ptr == req);
-    AVS_ASSERT(is_list_ordered_by_expire_time(*list_ptr),
-               "pending request list must be ordered by expire_time");
-    return list_ptr;
+/**
+ * Removes @p req from both the heap and the token index. Never shrinks the
+ * heap, so re-inserting a detached request never needs to allocate memory,
+ * unless other requests were inserted in the meantime.
+ */
+static void detach_pending_request(avs_coap_tcp_pending_requests_t *reqs,
+                                   avs_coap_tcp_pending_request_t *req) {
+    assert(req->heap_index < reqs->count);
+    assert(reqs->heap[req->heap_index] == req);
+
+    const size_t index = req->heap_index;
+    if (index != --reqs->count) {
+        heap_swap(reqs, index, reqs->count);
+        heap_sift_down(reqs, index);
+        heap_sift_up(reqs, index);
+    }
+
+    avs_coap_tcp_pending_request_t **ptr = token_bucket(reqs, &req->token);
+    while (*ptr != req) {
+        assert(*ptr);
+        ptr = &(*ptr)->next_by_token;
+    }
+    *ptr = req->next_by_token;
+    req->next_by_token = NULL;
 }
 
-static avs_coap_tcp_pending_request_t *detach_pending_request(
-        AVS_LIST(avs_coap_tcp_pending_request_t) *pending_request_ptr) {
-    assert(pending_request_ptr);
-    assert(*pending_request_ptr);
-    return AVS_LIST_DETACH(pending_request_ptr);
+static avs_coap_tcp_pending_request_t *
+earliest_pending_request(const avs_coap_tcp_pending_requests_t *reqs) {
+    return reqs->count ? reqs->heap[0] : NULL;
 }
 
 static void finish_pending_request_with_error(
         avs_coap_tcp_ctx_t *ctx,
-        AVS_LIST(avs_coap_tcp_pending_request_t) *pending_request_ptr,
+        avs_coap_tcp_pending_request_t *pending_request,
         avs_coap_send_result_t result,
         avs_error_t err) {
     AVS_ASSERT(result == AVS_COAP_SEND_RESULT_CANCEL
@@ -94,45 +210,58 @@ static void finish_pending_request_with_error(
                "use try_finish_pending_request instead");
     // Element must be detached to avoid finishing the timed-out request twice
     // when sched_run() is called in response handler.
-    avs_coap_tcp_pending_request_t *detached_request =
-            detach_pending_request(pending_request_ptr);
+    detach_pending_request(&ctx->pending_requests, pending_request);
     LOG(TRACE, _("finishing pending request, token ") "%s",
-        AVS_COAP_TOKEN_HEX(&detached_request->token));
-    (void) call_pending_request_response_handler(ctx, detached_request, NULL,
+        AVS_COAP_TOKEN_HEX(&pending_request->token));
+    (void) call_pending_request_response_handler(ctx, pending_request, NULL,
                                                  result, err);
-    AVS_LIST_DELETE(&detached_request);
+    avs_free(pending_request);
 }
 
-static void try_finish_pending_request(
-        avs_coap_tcp_ctx_t *ctx,
-        AVS_LIST(avs_coap_tcp_pending_request_t) *pending_request_ptr,
-        const avs_coap_borrowed_msg_t *msg,
-        avs_coap_send_result_t result,
-        avs_error_t err) {
+static void
+try_finish_pending_request(avs_coap_tcp_ctx_t *ctx,
+                           avs_coap_tcp_pending_request_t *pending_request,
+                           const avs_coap_borrowed_msg_t *msg,
+                           avs_coap_send_result_t result,
+                           avs_error_t err) {
     // Element must be detached to avoid finishing the timed-out request twice
     // when sched_run() is called in response handler.
-    avs_coap_tcp_pending_request_t *detached_request =
-            detach_pending_request(pending_request_ptr);
+    detach_pending_request(&ctx->pending_requests, pending_request);
     LOG(TRACE, _("finishing pending request, token ") "%s",
-        AVS_COAP_TOKEN_HEX(&detached_request->token));
+        AVS_COAP_TOKEN_HEX(&pending_request->token));
+    if (msg && result == AVS_COAP_SEND_RESULT_OK) {
+        // The handler may ask for more responses, in which case the request
+        // needs to be re-inserted. Reserve room for it before calling the
+        // handler, so that it is always called exactly once.
+        avs_error_t reserve_err =
+                reserve_pending_request_slot(&ctx->pending_requests);
+        if (avs_is_err(reserve_err)) {
+            msg = NULL;
+            result = AVS_COAP_SEND_RESULT_FAIL;
+            err = reserve_err;
+        }
+    }
     avs_coap_send_result_handler_result_t handler_result =
-            call_pending_request_response_handler(ctx, detached_request, msg,
+            call_pending_request_response_handler(ctx, pending_request, msg,
                                                   result, err);
-    if (msg && result == AVS_COAP_SEND_RESULT_OK
-            && handler_result != AVS_COAP_RESPONSE_ACCEPTED) {
-        insert_pending_request(&ctx->pending_requests, detached_request);
-    } else {
-        AVS_LIST_DELETE(&detached_request);
+    if (msg && result == AVS_COAP_SEND_RESULT_OK) {
+        if (handler_result != AVS_COAP_RESPONSE_ACCEPTED) {
+            insert_reserved_pending_request(&ctx->pending_requests,
+                                            pending_request);
+            return;
+        }
+        --ctx->pending_requests.reserved;
     }
+    avs_free(pending_request);
 }
 
-static AVS_LIST(avs_coap_tcp_pending_request_t) *
-find_pending_request_ptr_by_token(
-        AVS_LIST(avs_coap_tcp_pending_request_t) *pending_requests,
-        const avs_coap_token_t *token) {
-    AVS_LIST_ITERATE_PTR(pending_requests) {
-        if (avs_coap_token_equal(&(*pending_requests)->token, token)) {
-            return pending_requests;
+static avs_coap_tcp_pending_request_t *
+find_pending_request_by_token(avs_coap_tcp_pending_requests_t *reqs,
+                              const avs_coap_token_t *token) {
+    for (avs_coap_tcp_pending_request_t *req = *token_bucket(reqs, token); req;
+         req = req->next_by_token) {
+        if (avs_coap_token_equal(&req->token, token)) {
+            return req;
         }
     }
     return NULL;
@@ -140,39 +269,38 @@ find_pending_request_ptr_by_token(
 
 avs_time_monotonic_t
 _avs_coap_tcp_fail_expired_pending_requests(avs_coap_tcp_ctx_t *ctx) {
-    while (ctx->pending_requests
-           && avs_time_monotonic_valid(ctx->pending_requests->expire_time)
+    avs_coap_tcp_pending_request_t *req;
+    while ((req = earliest_pending_request(&ctx->pending_requests))
+           && avs_time_monotonic_valid(req->expire_time)
            && !avs_time_monotonic_before(avs_time_monotonic_now(),
-                                         ctx->pending_requests->expire_time)) {
-        finish_pending_request_with_error(ctx, &ctx->pending_requests,
-                                          AVS_COAP_SEND_RESULT_FAIL,
+                                         req->expire_time)) {
+        finish_pending_request_with_error(ctx, req, AVS_COAP_SEND_RESULT_FAIL,
                                           _avs_coap_err(AVS_COAP_ERR_TIMEOUT));
     }
 
-    if (ctx->pending_requests) {
-        return ctx->pending_requests->expire_time;
+    if (req) {
+        return req->expire_time;
     } else {
         return AVS_TIME_MONOTONIC_INVALID;
     }
 }
 
-static inline void
-refresh_timeout(avs_coap_tcp_ctx_t *ctx,
-                AVS_LIST(avs_coap_tcp_pending_request_t) *req_ptr) {
+static inline void refresh_timeout(avs_coap_tcp_ctx_t *ctx,
+                                   avs_coap_tcp_pending_request_t *req) {
     assert(ctx);
-    assert(req_ptr);
-    assert(*req_ptr);
-    assert(avs_time_monotonic_valid((*req_ptr)->expire_time));
+    assert(req);
+    assert(avs_time_monotonic_valid(req->expire_time));
 
-    if (_avs_coap_tcp_update_recv_deadline(ctx, &(*req_ptr)->expire_time)) {
-        finish_pending_request_with_error(ctx, req_ptr,
-                                          AVS_COAP_SEND_RESULT_FAIL,
+    if (_avs_coap_tcp_update_recv_deadline(ctx, &req->expire_time)) {
+        finish_pending_request_with_error(ctx, req, AVS_COAP_SEND_RESULT_FAIL,
                                           avs_errno(AVS_UNKNOWN_ERROR));
     } else {
-        insert_pending_request(&ctx->pending_requests,
-                               AVS_LIST_DETACH(req_ptr));
+        // move the request after all others with the same expire_time
+        req->seq = ctx->pending_requests.next_seq++;
+        heap_sift_down(&ctx->pending_requests, req->heap_index);
+        heap_sift_up(&ctx->pending_requests, req->heap_index);
         _avs_coap_reschedule_retry_or_request_expired_job(
-                (avs_coap_ctx_t *) ctx, (*req_ptr)->expire_time);
+                (avs_coap_ctx_t *) ctx, req->expire_time);
     }
 }
 
@@ -181,10 +309,9 @@ void _avs_coap_tcp_handle_pending_request(
         const avs_coap_borrowed_msg_t *msg,
         avs_coap_tcp_pending_request_status_t status,
         avs_error_t err) {
-    AVS_LIST(avs_coap_tcp_pending_request_t) *pending_req_ptr =
-            find_pending_request_ptr_by_token(&ctx->pending_requests,
-                                              &msg->token);
-    if (!pending_req_ptr) {
+    avs_coap_tcp_pending_request_t *pending_req =
+            find_pending_request_by_token(&ctx->pending_requests, &msg->token);
+    if (!pending_req) {
         LOG(DEBUG,
             _("received response does not match any known request, ignoring"));
         return;
@@ -192,30 +319,29 @@ void _avs_coap_tcp_handle_pending_request(
 
     switch (status) {
     case PENDING_REQUEST_STATUS_COMPLETED:
-        try_finish_pending_request(ctx, pending_req_ptr, msg,
+        try_finish_pending_request(ctx, pending_req, msg,
                                    AVS_COAP_SEND_RESULT_OK, AVS_OK);
         return;
 
     case PENDING_REQUEST_STATUS_PARTIAL_CONTENT:
         call_pending_request_response_handler(
-                ctx, *pending_req_ptr, msg,
-                AVS_COAP_SEND_RESULT_PARTIAL_CONTENT, AVS_OK);
+                ctx, pending_req, msg, AVS_COAP_SEND_RESULT_PARTIAL_CONTENT,
+                AVS_OK);
         // Request may be canceled in call above - not directly, but by
         // calling avs_sched_run() in user's handler for example.
-        pending_req_ptr =
-                find_pending_request_ptr_by_token(&ctx->pending_requests,
-                                                  &msg->token);
-        if (pending_req_ptr) {
-            refresh_timeout(ctx, pending_req_ptr);
+        pending_req = find_pending_request_by_token(&ctx->pending_requests,
+                                                    &msg->token);
+        if (pending_req) {
+            refresh_timeout(ctx, pending_req);
         }
         return;
 
     case PENDING_REQUEST_STATUS_IGNORE:
-        refresh_timeout(ctx, pending_req_ptr);
+        refresh_timeout(ctx, pending_req);
         return;
 
     case PENDING_REQUEST_STATUS_FINISH_IGNORE:
-        finish_pending_request_with_error(ctx, pending_req_ptr,
+        finish_pending_request_with_error(ctx, pending_req,
                                           AVS_COAP_SEND_RESULT_FAIL, err);
         // error already reported; do not propagate it further
         return;
@@ -226,13 +352,14 @@ void _avs_coap_tcp_handle_pending_request(
 
 avs_error_t _avs_coap_tcp_create_pending_request(
         avs_coap_tcp_ctx_t *ctx,
-        AVS_LIST(avs_coap_tcp_pending_request_t) **out_request,
+        avs_coap_tcp_pending_request_t **out_request,
         const avs_coap_token_t *token,
         avs_coap_send_result_handler_t *handler,
         void *handler_arg) {
     assert(out_request && !*out_request);
-    AVS_LIST(avs_coap_tcp_pending_request_t) req =
-            AVS_LIST_NEW_ELEMENT(avs_coap_tcp_pending_request_t);
+    avs_coap_tcp_pending_request_t *req =
+            (avs_coap_tcp_pending_request_t *) avs_calloc(
+                    1, sizeof(avs_coap_tcp_pending_request_t));
     if (!req) {
         LOG_OOM();
         return avs_errno(AVS_ENOMEM);
@@ -247,13 +374,18 @@ avs_error_t _avs_coap_tcp_create_pending_request(
         .expire_time = AVS_TIME_MONOTONIC_INVALID
     };
     if (_avs_coap_tcp_update_recv_deadline(ctx, &req->expire_time)) {
-        AVS_LIST_DELETE(&req);
+        avs_free(req);
         LOG(DEBUG, _("failed to create pending request - cannot calculate "
                      "receive deadline"));
         return avs_errno(AVS_UNKNOWN_ERROR);
     }
 
-    *out_request = insert_pending_request(&ctx->pending_requests, req);
+    avs_error_t err = insert_pending_request(&ctx->pending_requests, req);
+    if (avs_is_err(err)) {
+        avs_free(req);
+        return err;
+    }
+    *out_request = req;
     _avs_coap_reschedule_retry_or_request_expired_job((avs_coap_ctx_t *) ctx,
                                                       req->expire_time);
 
@@ -261,12 +393,13 @@ avs_error_t _avs_coap_tcp_create_pending_request(
 }
 
 void _avs_coap_tcp_remove_pending_request(
-        AVS_LIST(avs_coap_tcp_pending_request_t) *pending_request_ptr) {
-    assert(pending_request_ptr);
-    assert(*pending_request_ptr);
+        avs_coap_tcp_ctx_t *ctx,
+        avs_coap_tcp_pending_request_t *pending_request) {
+    assert(pending_request);
     LOG(TRACE, _("removing request with token ") "%s",
-        AVS_COAP_TOKEN_HEX(&(*pending_request_ptr)->token));
-    AVS_LIST_DELETE(pending_request_ptr);
+        AVS_COAP_TOKEN_HEX(&pending_request->token));
+    detach_pending_request(&ctx->pending_requests, pending_request);
+    avs_free(pending_request);
 }
 
 void _avs_coap_tcp_abort_pending_request_by_token(avs_coap_tcp_ctx_t *ctx,
@@ -276,22 +409,27 @@ void _avs_coap_tcp_abort_pending_request_by_token(avs_coap_tcp_ctx_t *ctx,
     AVS_ASSERT(result == AVS_COAP_SEND_RESULT_CANCEL
                        || result == AVS_COAP_SEND_RESULT_FAIL,
                "abort called with success result");
-    AVS_LIST(avs_coap_tcp_pending_request_t) *pending_request_ptr =
-            find_pending_request_ptr_by_token(&ctx->pending_requests, token);
-    if (pending_request_ptr) {
+    avs_coap_tcp_pending_request_t *pending_request =
+            find_pending_request_by_token(&ctx->pending_requests, token);
+    if (pending_request) {
         LOG(TRACE, _("aborting request with token ") "%s",
-            AVS_COAP_TOKEN_HEX(&(*pending_request_ptr)->token));
-        finish_pending_request_with_error(ctx, pending_request_ptr, result,
+            AVS_COAP_TOKEN_HEX(&pending_request->token));
+        finish_pending_request_with_error(ctx, pending_request, result,
                                           fail_err);
     }
 }
 
 void _avs_coap_tcp_cancel_all_pending_requests(avs_coap_tcp_ctx_t *ctx) {
-    while (ctx->pending_requests) {
+    avs_coap_tcp_pending_request_t *req;
+    while ((req = earliest_pending_request(&ctx->pending_requests))) {
         finish_pending_request_with_error(
-                ctx, &ctx->pending_requests, AVS_COAP_SEND_RESULT_CANCEL,
+                ctx, req, AVS_COAP_SEND_RESULT_CANCEL,
                 _avs_coap_err(AVS_COAP_ERR_EXCHANGE_CANCELED));
     }
+    avs_free(ctx->pending_requests.heap);
+    ctx->pending_requests.heap = NULL;
+    ctx->pending_requests.capacity = 0;
+    ctx->pending_requests.reserved = 0;
 }
 
 #endif // WITH_AVS_COAP_TCP
@@ -10,8 +10,6 @@
 #ifndef AVS_COAP_SRC_TCP_PENDING_REQUESTS_H
 #define AVS_COAP_SRC_TCP_PENDING_REQUESTS_H
 
-#include <avsystem/commons/avs_list.h>
-
 #include "avs_coap_ctx.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
@@ -33,9 +31,46 @@ typedef struct {
     void *handle_result_arg;
 } avs_coap_tcp_response_handler_t;
 
+/**
+ * Number of buckets of the token index of pending requests. MUST be a power of
+ * two.
+ */
+#define AVS_COAP_TCP_PENDING_REQUESTS_INDEX_SIZE 64
+
+/**
+ * Set of pending requests, i.e. requests sent by us that are still waiting for
+ * a response.
+ */
+typedef struct {
+    /**
+     * Binary min-heap of all pending requests, ordered by expire_time (and
+     * creation order if these are equal). Makes it possible to fail expired
+     * requests without keeping a sorted list.
+     */
+    avs_coap_tcp_pending_request_t **heap;
+    size_t count;
+    size_t capacity;
+    /**
+     * Number of heap slots above @ref count that are reserved for re-inserting
+     * requests whose response handlers are currently being called.
+     */
+    size_t reserved;
+
+    /** Creation sequence number to assign to the next inserted request. */
+    uint64_t next_seq;
+
+    /**
+     * Hash index of all pending requests, keyed by token. Allows matching
+     * incoming responses without comparing each of them against every
+     * pending request.
+     */
+    avs_coap_tcp_pending_request_t
+            *by_token[AVS_COAP_TCP_PENDING_REQUESTS_INDEX_SIZE];
+} avs_coap_tcp_pending_requests_t;
+
 avs_error_t _avs_coap_tcp_create_pending_request(
         struct avs_coap_tcp_ctx_struct *ctx,
-        AVS_LIST(avs_coap_tcp_pending_request_t) **out_request,
+        avs_coap_tcp_pending_request_t **out_request,
         const avs_coap_token_t *token,
         avs_coap_send_result_handler_t *handler,
         void *handler_arg);
@@ -50,7 +85,8 @@ void _avs_coap_tcp_handle_pending_request(
  * Cancels pending request without calling user's handler.
  */
 void _avs_coap_tcp_remove_pending_request(
-        AVS_LIST(avs_coap_tcp_pending_request_t) *pending_request_ptr);
+        struct avs_coap_tcp_ctx_struct *ctx,
+        avs_coap_tcp_pending_request_t *pending_request);
 
 void _avs_coap_tcp_abort_pending_request_by_token(
         struct avs_coap_tcp_ctx_struct *ctx,
@@ -58,6 +94,10 @@ void _avs_coap_tcp_abort_pending_request_by_token(
         avs_coap_send_result_t result,
         avs_error_t fail_err);
 
+/**
+ * Cancels all pending requests, calling user's handlers, and releases memory
+ * used to keep track of them.
+ */
 void _avs_coap_tcp_cancel_all_pending_requests(
         struct avs_coap_tcp_ctx_struct *ctx);
 
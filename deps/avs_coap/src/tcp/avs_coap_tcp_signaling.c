@@ -136,7 +136,7 @@ _avs_coap_tcp_handle_signaling_message(avs_coap_tcp_ctx_t *ctx,
     case AVS_COAP_CODE_PING:
         return send_pong(ctx, msg);
     case AVS_COAP_CODE_PONG:
-        LOG(DEBUG, _("unexpected Pong message arrived, ignoring"));
+        _avs_coap_tcp_handle_pong(ctx, &msg->token);
         break;
     case AVS_COAP_CODE_RELEASE:
         // All responses to incoming requests were sent already. If there is
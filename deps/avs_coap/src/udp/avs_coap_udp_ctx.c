@@ -154,10 +154,28 @@ coap_udp_max_outgoing_payload_size(avs_coap_ctx_t *ctx_,
     (void) code;
     avs_coap_udp_ctx_t *ctx = (avs_coap_udp_ctx_t *) ctx_;
     update_last_mtu_from_socket(ctx);
-    return udp_max_payload_size(ctx->base.out_buffer->capacity, ctx->last_mtu,
+    size_t mtu = ctx->last_mtu;
+    if (ctx->path_mtu.enabled) {
+        mtu = AVS_MIN(mtu, ctx->path_mtu.mtu);
+    }
+    if (ctx->compression.layer && mtu != SIZE_MAX) {
+        mtu = mtu > ctx->compression.layer->max_overhead
+                      ? mtu - ctx->compression.layer->max_overhead
+                      : 0;
+    }
+    ctx->base.transport_max_out_msg_size = mtu;
+    return udp_max_payload_size(ctx->base.out_buffer->capacity, mtu,
                                 token_size, options ? options->size : 0);
 }
 
+static size_t get_incoming_mtu(avs_coap_udp_ctx_t *ctx) {
+    if (ctx->forced_incoming_mtu > 0) {
+        return ctx->forced_incoming_mtu;
+    }
+    update_last_mtu_from_socket(ctx);
+    return ctx->last_mtu;
+}
+
 static size_t
 coap_udp_max_incoming_payload_size(avs_coap_ctx_t *ctx_,
                                    size_t token_size,
@@ -165,11 +183,7 @@ coap_udp_max_incoming_payload_size(avs_coap_ctx_t *ctx_,
                                    uint8_t code) {
     (void) code;
     avs_coap_udp_ctx_t *ctx = (avs_coap_udp_ctx_t *) ctx_;
-    size_t incoming_mtu = ctx->forced_incoming_mtu;
-    if (incoming_mtu <= 0) {
-        update_last_mtu_from_socket(ctx);
-        incoming_mtu = ctx->last_mtu;
-    }
+    size_t incoming_mtu = get_incoming_mtu(ctx);
     return udp_max_payload_size(ctx->base.in_buffer->capacity, incoming_mtu,
                                 token_size, options ? options->size : 0);
 }
@@ -178,6 +192,150 @@ static uint16_t generate_id(avs_coap_udp_ctx_t *ctx) {
     return ctx->last_msg_id++;
 }
 
+static avs_coap_udp_unconfirmed_msg_t **
+unconfirmed_id_bucket(avs_coap_udp_ctx_t *ctx, uint16_t msg_id) {
+    // message IDs are generated sequentially, so the lowest bits are
+    // distributed evenly
+    return &ctx->unconfirmed_by_id[msg_id
+                                   & (AVS_COAP_UDP_UNCONFIRMED_INDEX_SIZE - 1)];
+}
+
+static avs_coap_udp_unconfirmed_msg_t **
+unconfirmed_token_bucket(avs_coap_udp_ctx_t *ctx,
+                         const avs_coap_token_t *token) {
+    return &ctx->unconfirmed_by_token[_avs_coap_token_hash(token)
+                                      & (AVS_COAP_UDP_UNCONFIRMED_INDEX_SIZE
+                                         - 1)];
+}
+
+static void index_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                              avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
+    avs_coap_udp_unconfirmed_msg_t **id_bucket = unconfirmed_id_bucket(
+            ctx, _avs_coap_udp_header_get_id(&unconfirmed->msg.header));
+    unconfirmed->next_by_id = *id_bucket;
+    *id_bucket = unconfirmed;
+
+    avs_coap_udp_unconfirmed_msg_t **token_bucket =
+            unconfirmed_token_bucket(ctx, &unconfirmed->msg.token);
+    unconfirmed->next_by_token = *token_bucket;
+    *token_bucket = unconfirmed;
+}
+
+static void unindex_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                                avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
+    avs_coap_udp_unconfirmed_msg_t **ptr = unconfirmed_id_bucket(
+            ctx, _avs_coap_udp_header_get_id(&unconfirmed->msg.header));
+    while (*ptr != unconfirmed) {
+        assert(*ptr);
+        ptr = &(*ptr)->next_by_id;
+    }
+    *ptr = unconfirmed->next_by_id;
+    unconfirmed->next_by_id = NULL;
+
+    ptr = unconfirmed_token_bucket(ctx, &unconfirmed->msg.token);
+    while (*ptr != unconfirmed) {
+        assert(*ptr);
+        ptr = &(*ptr)->next_by_token;
+    }
+    *ptr = unconfirmed->next_by_token;
+    unconfirmed->next_by_token = NULL;
+}
+
+/**
+ * Inserts @p unconfirmed into the unconfirmed_messages list at @p slot, and
+ * into the indices.
+ */
+static void
+link_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                 AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *slot,
+                 AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed) {
+    assert(!unconfirmed->list_slot);
+    AVS_LIST_INSERT(slot, unconfirmed);
+    unconfirmed->list_slot = slot;
+    if (AVS_LIST_NEXT(unconfirmed)) {
+        AVS_LIST_NEXT(unconfirmed)->list_slot =
+                AVS_LIST_NEXT_PTR(&unconfirmed);
+    }
+    unconfirmed->list_seq = ctx->next_unconfirmed_seq++;
+    index_unconfirmed(ctx, unconfirmed);
+}
+
+/**
+ * Removes the message pointed to by @p slot from the unconfirmed_messages list
+ * and from the indices.
+ */
+static AVS_LIST(avs_coap_udp_unconfirmed_msg_t)
+unlink_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                   AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *slot) {
+    assert(slot && *slot);
+    assert((*slot)->list_slot == slot);
+    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed =
+            AVS_LIST_DETACH(slot);
+    if (*slot) {
+        (*slot)->list_slot = slot;
+    }
+    unconfirmed->list_slot = NULL;
+    unindex_unconfirmed(ctx, unconfirmed);
+    return unconfirmed;
+}
+
+/**
+ * Allocates an unconfirmed message entry with room for @p packet_size bytes of
+ * serialized packet, reusing a pooled one if possible.
+ */
+static AVS_LIST(avs_coap_udp_unconfirmed_msg_t)
+alloc_unconfirmed(avs_coap_udp_ctx_t *ctx, size_t packet_size) {
+    bool pooled = (packet_size <= AVS_COAP_UDP_UNCONFIRMED_POOL_MSG_SIZE);
+    if (pooled && ctx->unconfirmed_pool) {
+        ++ctx->stats.unconfirmed_pool_hits;
+        return AVS_LIST_DETACH(&ctx->unconfirmed_pool);
+    }
+
+    ++ctx->stats.unconfirmed_pool_misses;
+    pooled = pooled
+             && ctx->unconfirmed_pool_allocated
+                        < AVS_COAP_UDP_UNCONFIRMED_POOL_SIZE;
+    if (pooled) {
+        packet_size = AVS_COAP_UDP_UNCONFIRMED_POOL_MSG_SIZE;
+    }
+    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed =
+            (AVS_LIST(avs_coap_udp_unconfirmed_msg_t)) AVS_LIST_NEW_BUFFER(
+                    sizeof(avs_coap_udp_unconfirmed_msg_t) + packet_size);
+    if (unconfirmed && pooled) {
+        unconfirmed->pooled = true;
+        ++ctx->unconfirmed_pool_allocated;
+    }
+    return unconfirmed;
+}
+
+/**
+ * Releases an unconfirmed message entry that is neither in the
+ * unconfirmed_messages list nor in the indices, returning it to the pool if it
+ * was allocated from there.
+ */
+static void
+free_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                 AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr) {
+    assert(unconfirmed_ptr && *unconfirmed_ptr);
+    if ((*unconfirmed_ptr)->pooled) {
+        AVS_LIST_INSERT(&ctx->unconfirmed_pool,
+                        AVS_LIST_DETACH(unconfirmed_ptr));
+    } else {
+        AVS_LIST_DELETE(unconfirmed_ptr);
+    }
+}
+
+/**
+ * Deletes an unconfirmed message that is no longer in the unconfirmed_messages
+ * list.
+ */
+static void
+delete_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                   AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr) {
+    assert(unconfirmed_ptr && *unconfirmed_ptr);
+    free_unconfirmed(ctx, unconfirmed_ptr);
+}
+
 static size_t current_nstart(const avs_coap_udp_ctx_t *ctx) {
     size_t started = 0;
 
@@ -290,8 +448,58 @@ static void try_cache_response(avs_coap_udp_ctx_t *ctx,
         return;
     }
 
+    const avs_coap_udp_tx_params_t tx_params =
+            _avs_coap_udp_effective_tx_params(ctx);
     (void) _avs_coap_udp_response_cache_add(ctx->response_cache, addr, port,
-                                            res, &ctx->tx_params);
+                                            res, &tx_params);
+}
+
+static void update_message_stats(avs_coap_udp_ctx_t *ctx, size_t msg_size) {
+    ctx->stats.total_messages_size += msg_size;
+    if (msg_size > ctx->stats.max_message_size) {
+        ctx->stats.max_message_size = (uint32_t) AVS_MIN(msg_size, UINT32_MAX);
+    }
+}
+
+static avs_error_t ensure_compression_buffer(avs_coap_udp_ctx_t *ctx) {
+    const size_t size = AVS_MAX(ctx->base.in_buffer->capacity,
+                                ctx->base.out_buffer->capacity)
+                        + ctx->compression.layer->max_overhead;
+    if (ctx->compression.buffer_size < size) {
+        uint8_t *buffer = (uint8_t *) avs_realloc(ctx->compression.buffer,
+                                                  size);
+        if (!buffer) {
+            LOG(ERROR, _("out of memory"));
+            return avs_errno(AVS_ENOMEM);
+        }
+        ctx->compression.buffer = buffer;
+        ctx->compression.buffer_size = size;
+    }
+    return AVS_OK;
+}
+
+static avs_error_t compress_msg(avs_coap_udp_ctx_t *ctx,
+                                const void **inout_msg_buf,
+                                size_t *inout_msg_size) {
+    if (!ctx->compression.layer) {
+        return AVS_OK;
+    }
+    size_t compressed_size;
+    avs_error_t err = ensure_compression_buffer(ctx);
+    if (avs_is_ok(err)) {
+        err = ctx->compression.layer->compress(
+                ctx->compression.arg, *inout_msg_buf, *inout_msg_size,
+                ctx->compression.buffer, ctx->compression.buffer_size,
+                &compressed_size);
+    }
+    if (avs_is_err(err)) {
+        LOG(DEBUG, _("could not compress message: ") "%s",
+            AVS_COAP_STRERROR(err));
+        return err;
+    }
+    *inout_msg_buf = ctx->compression.buffer;
+    *inout_msg_size = compressed_size;
+    return AVS_OK;
 }
 
 static avs_error_t coap_udp_send_serialized_msg(avs_coap_udp_ctx_t *ctx,
@@ -302,9 +510,18 @@ static avs_error_t coap_udp_send_serialized_msg(avs_coap_udp_ctx_t *ctx,
 
     try_cache_response(ctx, msg);
 
-    avs_error_t err = avs_net_socket_send(ctx->base.socket, msg_buf, msg_size);
+    const size_t uncompressed_size = msg_size;
+    avs_error_t err = compress_msg(ctx, &msg_buf, &msg_size);
+    if (avs_is_ok(err)) {
+        err = avs_net_socket_send(ctx->base.socket, msg_buf, msg_size);
+    }
     if (avs_is_err(err)) {
         LOG(DEBUG, _("send failed: ") "%s", AVS_COAP_STRERROR(err));
+    } else {
+        ++ctx->stats.sent_messages_count;
+        update_message_stats(ctx, msg_size);
+        ctx->stats.compression_bytes_saved +=
+                (int64_t) uncompressed_size - (int64_t) msg_size;
     }
     return err;
 }
@@ -330,6 +547,13 @@ find_unconfirmed_insert_ptr(avs_coap_udp_ctx_t *ctx,
     return list_ptr;
 }
 
+static void
+insert_unconfirmed(avs_coap_udp_ctx_t *ctx,
+                   AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed) {
+    link_unconfirmed(ctx, find_unconfirmed_insert_ptr(ctx, unconfirmed),
+                     unconfirmed);
+}
+
 static AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *
 find_first_held_unconfirmed_ptr(avs_coap_udp_ctx_t *ctx) {
     AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *unconfirmed_ptr;
@@ -437,9 +661,14 @@ static void resume_next_unconfirmed(avs_coap_udp_ctx_t *ctx) {
 
         // Detach held messages so that they can't get unheld in the send result
         // handler
-        AVS_LIST(avs_coap_udp_unconfirmed_msg_t) held_messages =
-                *unconfirmed_ptr;
-        *unconfirmed_ptr = NULL;
+        AVS_LIST(avs_coap_udp_unconfirmed_msg_t) held_messages = NULL;
+        AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *held_append_ptr =
+                &held_messages;
+        while (*unconfirmed_ptr) {
+            AVS_LIST_INSERT(held_append_ptr,
+                            unlink_unconfirmed(ctx, unconfirmed_ptr));
+            held_append_ptr = AVS_LIST_NEXT_PTR(held_append_ptr);
+        }
 
         while (held_messages) {
             // Do not use fail_unconfirmed - it indirectly calls this function
@@ -455,14 +684,14 @@ static void resume_next_unconfirmed(avs_coap_udp_ctx_t *ctx) {
             (void) call_send_result_handler(
                     ctx, unconfirmed, NULL, AVS_COAP_SEND_RESULT_FAIL,
                     _avs_coap_err(AVS_COAP_ERR_TIME_INVALID));
-            AVS_LIST_DELETE(&unconfirmed);
+            delete_unconfirmed(ctx, &unconfirmed);
         }
 
         return;
     }
 
     AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed =
-            AVS_LIST_DETACH(unconfirmed_ptr);
+            unlink_unconfirmed(ctx, unconfirmed_ptr);
     unconfirmed->hold = false;
     unconfirmed->next_retransmit = next_retransmit;
 
@@ -476,11 +705,11 @@ static void resume_next_unconfirmed(avs_coap_udp_ctx_t *ctx) {
     if (avs_is_err(send_err)) {
         (void) call_send_result_handler(ctx, unconfirmed, NULL,
                                         AVS_COAP_SEND_RESULT_FAIL, send_err);
-        AVS_LIST_DELETE(&unconfirmed);
+        delete_unconfirmed(ctx, &unconfirmed);
     } else {
+        unconfirmed->first_sent = avs_time_monotonic_now();
         // the msg may need to be retransmitted before other started ones
-        AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed),
-                        unconfirmed);
+        insert_unconfirmed(ctx, unconfirmed);
     }
 }
 
@@ -526,8 +755,7 @@ static void try_cleanup_unconfirmed(avs_coap_udp_ctx_t *ctx,
                                     avs_error_t fail_err) {
     assert(ctx);
     assert(unconfirmed);
-    AVS_ASSERT(!AVS_LIST_FIND_PTR(&ctx->unconfirmed_messages, unconfirmed),
-               "unconfirmed must be detached");
+    AVS_ASSERT(!unconfirmed->list_slot, "unconfirmed must be detached");
     LOG(DEBUG, _("msg ") "%s" _(": ") "%s",
         AVS_COAP_TOKEN_HEX(&unconfirmed->msg.token),
         send_result_string(result));
@@ -538,11 +766,10 @@ static void try_cleanup_unconfirmed(avs_coap_udp_ctx_t *ctx,
 
     if (response && result == AVS_COAP_SEND_RESULT_OK
             && handler_result != AVS_COAP_RESPONSE_ACCEPTED) {
-        AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed),
-                        unconfirmed);
+        insert_unconfirmed(ctx, unconfirmed);
     } else {
         reschedule_retransmission_job(ctx);
-        AVS_LIST_DELETE(&unconfirmed);
+        delete_unconfirmed(ctx, &unconfirmed);
     }
 }
 
@@ -558,25 +785,74 @@ static avs_coap_udp_exchange_direction_t direction_from_code(uint8_t code) {
                    : AVS_COAP_UDP_EXCHANGE_SERVER_NOTIFICATION;
 }
 
+static bool
+unconfirmed_matches(const avs_coap_udp_unconfirmed_msg_t *unconfirmed,
+                    avs_coap_udp_exchange_direction_t direction,
+                    const avs_coap_token_t *token,
+                    const uint16_t *id) {
+    const avs_coap_udp_msg_t *msg = &unconfirmed->msg;
+    return (direction == AVS_COAP_UDP_EXCHANGE_ANY
+            || direction == direction_from_code(msg->header.code))
+           && (!token || avs_coap_token_equal(&msg->token, token))
+           && (!id || _avs_coap_udp_header_get_id(&msg->header) == *id);
+}
+
+/**
+ * Checks whether @p a is placed before @p b in the unconfirmed_messages list,
+ * which is ordered by (hold, next_retransmit, list_seq).
+ */
+static bool
+unconfirmed_precedes(const avs_coap_udp_unconfirmed_msg_t *a,
+                     const avs_coap_udp_unconfirmed_msg_t *b) {
+    if (a->hold != b->hold) {
+        return !a->hold;
+    }
+    if (avs_time_monotonic_before(a->next_retransmit, b->next_retransmit)) {
+        return true;
+    }
+    if (avs_time_monotonic_before(b->next_retransmit, a->next_retransmit)) {
+        return false;
+    }
+    return a->list_seq < b->list_seq;
+}
+
+/**
+ * Finds the first message (in the order of the unconfirmed_messages list)
+ * matching the criteria. Uses the message ID index if @p id is given, or the
+ * token index otherwise.
+ *
+ * @returns Pointer to the list slot pointing to the found message, or NULL if
+ *          there is none.
+ */
 static AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *
 find_unconfirmed_ptr(avs_coap_udp_ctx_t *ctx,
                      avs_coap_udp_exchange_direction_t direction,
                      const avs_coap_token_t *token,
                      const uint16_t *id) {
-    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *list_ptr =
-            &ctx->unconfirmed_messages;
-
-    AVS_LIST_ITERATE_PTR(list_ptr) {
-        const avs_coap_udp_msg_t *msg = &(*list_ptr)->msg;
-        if ((direction == AVS_COAP_UDP_EXCHANGE_ANY
-             || direction == direction_from_code(msg->header.code))
-                && (!token || avs_coap_token_equal(&msg->token, token))
-                && (!id || _avs_coap_udp_header_get_id(&msg->header) == *id)) {
-            return list_ptr;
+    avs_coap_udp_unconfirmed_msg_t *result = NULL;
+    if (id) {
+        for (avs_coap_udp_unconfirmed_msg_t *msg =
+                     *unconfirmed_id_bucket(ctx, *id);
+             msg;
+             msg = msg->next_by_id) {
+            if (unconfirmed_matches(msg, direction, token, id)
+                    && (!result || unconfirmed_precedes(msg, result))) {
+                result = msg;
+            }
+        }
+    } else {
+        assert(token);
+        for (avs_coap_udp_unconfirmed_msg_t *msg =
+                     *unconfirmed_token_bucket(ctx, token);
+             msg;
+             msg = msg->next_by_token) {
+            if (unconfirmed_matches(msg, direction, token, id)
+                    && (!result || unconfirmed_precedes(msg, result))) {
+                result = msg;
+            }
         }
     }
-
-    return NULL;
+    return result ? result->list_slot : NULL;
 }
 
 static inline AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *
@@ -622,11 +898,107 @@ detach_unconfirmed_by_token(avs_coap_udp_ctx_t *ctx,
             find_unconfirmed_ptr_by_token(ctx, direction, token);
 
     if (msg_ptr) {
-        return AVS_LIST_DETACH(msg_ptr);
+        return unlink_unconfirmed(ctx, msg_ptr);
     }
     return NULL;
 }
 
+static unsigned
+unconfirmed_retransmissions(const avs_coap_udp_ctx_t *ctx,
+                            const avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
+    if (unconfirmed->retry_state.retries_left < ctx->tx_params.max_retransmit) {
+        return ctx->tx_params.max_retransmit
+               - unconfirmed->retry_state.retries_left;
+    }
+    return 0;
+}
+
+// Messages not larger than this are never considered to be fragmented, so
+// that the path MTU estimate still allows reasonably sized BLOCK transfers.
+#    define MIN_PATH_MTU 256
+
+// Number of retransmissions after which a loss is attributed to message size.
+#    define PATH_MTU_LOSS_RETRANSMISSIONS 2
+
+static void path_mtu_on_loss(avs_coap_udp_ctx_t *ctx, size_t packet_size) {
+    if (!ctx->path_mtu.enabled || packet_size <= MIN_PATH_MTU
+            || packet_size > ctx->path_mtu.mtu
+            || packet_size > ctx->path_mtu.candidate_mtu) {
+        return;
+    }
+    LOG(DEBUG, "%u" _("-byte message repeatedly lost, suspecting lower path "
+                      "MTU"),
+        (unsigned) packet_size);
+    ctx->path_mtu.candidate_mtu = packet_size - 1;
+}
+
+static void path_mtu_on_ack(avs_coap_udp_ctx_t *ctx,
+                            size_t packet_size,
+                            unsigned retransmissions) {
+    if (!ctx->path_mtu.enabled || retransmissions > 0
+            || ctx->path_mtu.candidate_mtu == SIZE_MAX) {
+        return;
+    }
+    if (packet_size > ctx->path_mtu.candidate_mtu) {
+        // a large message got through after all; the loss was not size-related
+        ctx->path_mtu.candidate_mtu = SIZE_MAX;
+    } else {
+        // the remote endpoint is reachable with smaller messages
+        LOG(INFO, _("path MTU lowered to ") "%u",
+            (unsigned) ctx->path_mtu.candidate_mtu);
+        ctx->path_mtu.mtu = ctx->path_mtu.candidate_mtu;
+        ctx->path_mtu.candidate_mtu = SIZE_MAX;
+    }
+}
+
+/**
+ * Handles the first acknowledgement of @p unconfirmed: feeds the time elapsed
+ * since its first transmission into the adaptive RTO estimators and updates
+ * the path MTU estimate, if either is enabled. Each message is handled at most
+ * once, so that e.g. duplicate ACKs do not skew the estimates.
+ */
+static void update_ack_stats(avs_coap_stats_t *stats,
+                             avs_time_duration_t ack_wait_time,
+                             unsigned retransmissions) {
+    ++stats->acknowledged_count;
+    stats->total_ack_wait_time =
+            avs_time_duration_add(stats->total_ack_wait_time, ack_wait_time);
+    if (retransmissions > 0) {
+        return;
+    }
+    int64_t rtt_ms;
+    if (avs_time_duration_to_scalar(&rtt_ms, AVS_TIME_MS, ack_wait_time)) {
+        return;
+    }
+    size_t bucket = 0;
+    int64_t bound_ms = AVS_COAP_STATS_RTT_HISTOGRAM_FIRST_BOUND_MS;
+    while (bucket < AVS_COAP_STATS_RTT_HISTOGRAM_BUCKETS - 1
+           && rtt_ms >= bound_ms) {
+        ++bucket;
+        bound_ms *= 2;
+    }
+    ++stats->rtt_histogram[bucket];
+}
+
+static void
+handle_first_ack(avs_coap_udp_ctx_t *ctx,
+                 avs_coap_udp_unconfirmed_msg_t *unconfirmed) {
+    if (!avs_time_monotonic_valid(unconfirmed->first_sent)) {
+        return;
+    }
+    unsigned retransmissions = unconfirmed_retransmissions(ctx, unconfirmed);
+    avs_time_duration_t ack_wait_time =
+            avs_time_monotonic_diff(avs_time_monotonic_now(),
+                                    unconfirmed->first_sent);
+    update_ack_stats(&ctx->stats, ack_wait_time, retransmissions);
+    if (ctx->adaptive_rto.enabled) {
+        _avs_coap_udp_adaptive_rto_update(&ctx->adaptive_rto, ack_wait_time,
+                                          retransmissions);
+    }
+    path_mtu_on_ack(ctx, unconfirmed->packet_size, retransmissions);
+    unconfirmed->first_sent = AVS_TIME_MONOTONIC_INVALID;
+}
+
 static void
 confirm_unconfirmed(avs_coap_udp_ctx_t *ctx,
                     AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *msg_ptr,
@@ -634,10 +1006,10 @@ confirm_unconfirmed(avs_coap_udp_ctx_t *ctx,
     assert(ctx);
     assert(msg_ptr);
     assert(*msg_ptr);
-    AVS_ASSERT(AVS_LIST_FIND_PTR(&ctx->unconfirmed_messages, *msg_ptr),
+    AVS_ASSERT((*msg_ptr)->list_slot == msg_ptr,
                "unconfirmed_msg must be enqueued");
 
-    avs_coap_udp_unconfirmed_msg_t *msg = AVS_LIST_DETACH(msg_ptr);
+    avs_coap_udp_unconfirmed_msg_t *msg = unlink_unconfirmed(ctx, msg_ptr);
     try_cleanup_unconfirmed(ctx, msg, response, AVS_COAP_SEND_RESULT_OK,
                             AVS_OK);
 }
@@ -649,10 +1021,10 @@ static void fail_unconfirmed(avs_coap_udp_ctx_t *ctx,
     assert(ctx);
     assert(msg_ptr);
     assert(*msg_ptr);
-    AVS_ASSERT(AVS_LIST_FIND_PTR(&ctx->unconfirmed_messages, *msg_ptr),
+    AVS_ASSERT((*msg_ptr)->list_slot == msg_ptr,
                "unconfirmed_msg must be enqueued");
 
-    avs_coap_udp_unconfirmed_msg_t *msg = AVS_LIST_DETACH(msg_ptr);
+    avs_coap_udp_unconfirmed_msg_t *msg = unlink_unconfirmed(ctx, msg_ptr);
     try_cleanup_unconfirmed(ctx, msg, truncated_msg, AVS_COAP_SEND_RESULT_FAIL,
                             err);
 }
@@ -693,13 +1065,20 @@ static void coap_udp_ignore_current_request(avs_coap_ctx_t *ctx_,
     }
 }
 
-static void
+/**
+ * Retransmits the first unconfirmed message, or fails it if all retries have
+ * been used up, if it is already due.
+ *
+ * @returns true if the first message was due and has been handled, false
+ *          otherwise.
+ */
+static bool
 retransmit_next_message_without_reschedule(avs_coap_udp_ctx_t *ctx) {
     avs_coap_udp_unconfirmed_msg_t *unconfirmed = ctx->unconfirmed_messages;
     if (!unconfirmed
             || avs_time_monotonic_before(avs_time_monotonic_now(),
                                          unconfirmed->next_retransmit)) {
-        return;
+        return false;
     }
 
     if (_avs_coap_udp_all_retries_sent(&unconfirmed->retry_state)) {
@@ -711,13 +1090,13 @@ retransmit_next_message_without_reschedule(avs_coap_udp_ctx_t *ctx) {
         // retransmission_job is rescheduled by fail_unconfirmed()
         fail_unconfirmed(ctx, &ctx->unconfirmed_messages, NULL,
                          _avs_coap_err(AVS_COAP_ERR_TIMEOUT));
-        return;
+        return true;
     }
 
     if (_avs_coap_udp_update_retry_state(ctx, &unconfirmed->retry_state)) {
         fail_unconfirmed(ctx, &ctx->unconfirmed_messages, NULL,
                          _avs_coap_err(AVS_COAP_ERR_TIME_INVALID));
-        return;
+        return true;
     }
 
     LOG(DEBUG, _("msg ") "%s" _(": retry ") "%u/%u",
@@ -730,9 +1109,13 @@ retransmit_next_message_without_reschedule(avs_coap_udp_ctx_t *ctx) {
                                                    unconfirmed->packet_size);
     if (avs_is_err(err)) {
         fail_unconfirmed(ctx, &ctx->unconfirmed_messages, NULL, err);
-        return;
+        return true;
     }
     ++ctx->stats.outgoing_retransmissions_count;
+    if (unconfirmed_retransmissions(ctx, unconfirmed)
+            == PATH_MTU_LOSS_RETRANSMISSIONS) {
+        path_mtu_on_loss(ctx, unconfirmed->packet_size);
+    }
 
     avs_time_monotonic_t next_retransmit =
             avs_time_monotonic_add(unconfirmed->next_retransmit,
@@ -744,18 +1127,31 @@ retransmit_next_message_without_reschedule(avs_coap_udp_ctx_t *ctx) {
               "params are too large to handle"));
         fail_unconfirmed(ctx, &ctx->unconfirmed_messages, NULL,
                          _avs_coap_err(AVS_COAP_ERR_TIME_INVALID));
-        return;
+        return true;
     }
 
     unconfirmed->next_retransmit = next_retransmit;
-    unconfirmed = AVS_LIST_DETACH(&ctx->unconfirmed_messages);
-    AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed), unconfirmed);
+    unconfirmed = unlink_unconfirmed(ctx, &ctx->unconfirmed_messages);
+    insert_unconfirmed(ctx, unconfirmed);
+    return true;
+}
+
+static void retransmit_due_messages(avs_coap_udp_ctx_t *ctx) {
+    // Handle all the messages that are already due in a single pass, so that
+    // a burst of exchanges started at the same time is retransmitted
+    // back-to-back rather than one message per retransmission job run. Each
+    // message is handled at most once, as its next retransmission time is
+    // moved to the future.
+    size_t max_messages = AVS_LIST_SIZE(ctx->unconfirmed_messages);
+    while (max_messages-- > 0
+           && retransmit_next_message_without_reschedule(ctx)) {
+    }
 }
 
 static avs_time_monotonic_t coap_udp_on_timeout(avs_coap_ctx_t *ctx_) {
     avs_coap_udp_ctx_t *ctx = (avs_coap_udp_ctx_t *) ctx_;
     resume_unconfirmed_messages(ctx);
-    retransmit_next_message_without_reschedule(ctx);
+    retransmit_due_messages(ctx);
 
     if (ctx->unconfirmed_messages) {
         avs_coap_udp_unconfirmed_msg_t *unconfirmed = ctx->unconfirmed_messages;
@@ -812,9 +1208,10 @@ enqueue_unconfirmed(avs_coap_udp_ctx_t *ctx,
         if (avs_is_err(err)) {
             return err;
         }
+        unconfirmed->first_sent = avs_time_monotonic_now();
     }
 
-    AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed), unconfirmed);
+    insert_unconfirmed(ctx, unconfirmed);
     reschedule_retransmission_job(ctx);
     return AVS_OK;
 }
@@ -828,15 +1225,17 @@ static avs_error_t create_unconfirmed(
     const size_t msg_size = _avs_coap_udp_msg_size(msg);
 
     AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed_msg =
-            (AVS_LIST(avs_coap_udp_unconfirmed_msg_t)) AVS_LIST_NEW_BUFFER(
-                    sizeof(avs_coap_udp_unconfirmed_msg_t) + msg_size);
+            alloc_unconfirmed(ctx, msg_size);
     if (!unconfirmed_msg) {
         return avs_errno(AVS_ENOMEM);
     }
 
+    const bool pooled = unconfirmed_msg->pooled;
     *unconfirmed_msg = (avs_coap_udp_unconfirmed_msg_t) {
+        .pooled = pooled,
         .send_result_handler = send_result_handler,
         .send_result_handler_arg = send_result_handler_arg,
+        .first_sent = AVS_TIME_MONOTONIC_INVALID,
         .packet_size = msg_size
     };
 
@@ -845,7 +1244,7 @@ static avs_error_t create_unconfirmed(
     if (avs_is_err((err = _avs_coap_udp_initial_retry_state(
                             ctx, &unconfirmed_msg->retry_state)))) {
         LOG(ERROR, _("PRNG failed"));
-        AVS_LIST_CLEAR(&unconfirmed_msg);
+        free_unconfirmed(ctx, &unconfirmed_msg);
         return err;
     }
 
@@ -854,7 +1253,7 @@ static avs_error_t create_unconfirmed(
                                                  msg_size)))) {
         LOG(ERROR,
             _("Could not serialize the message as a valid CoAP/UDP packet"));
-        AVS_LIST_CLEAR(&unconfirmed_msg);
+        free_unconfirmed(ctx, &unconfirmed_msg);
         return err;
     }
 
@@ -982,7 +1381,7 @@ coap_udp_send_message(avs_coap_ctx_t *ctx_,
         if (avs_is_err(err)) {
             // don't call try_cleanup_unconfirmed to avoid calling user-defined
             // handler
-            AVS_LIST_DELETE(&unconfirmed);
+            delete_unconfirmed(ctx, &unconfirmed);
         }
     } else {
         assert(type != AVS_COAP_UDP_TYPE_CONFIRMABLE);
@@ -1002,20 +1401,44 @@ static avs_error_t coap_udp_recv_msg(avs_coap_udp_ctx_t *ctx,
                                      avs_coap_udp_msg_t *out_msg,
                                      uint8_t *buf,
                                      size_t buf_size) {
+    uint8_t *recv_buf = buf;
+    size_t recv_buf_size = buf_size;
+    if (ctx->compression.layer) {
+        avs_error_t err = ensure_compression_buffer(ctx);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        recv_buf = ctx->compression.buffer;
+        recv_buf_size = ctx->compression.buffer_size;
+    }
+
     size_t packet_size;
     avs_error_t err = avs_net_socket_receive(ctx->base.socket, &packet_size,
-                                             buf, buf_size);
+                                             recv_buf, recv_buf_size);
     if (avs_is_err(err)) {
         LOG(TRACE, _("recv failed"));
         return err;
     }
 
-    err = _avs_coap_udp_msg_parse(out_msg, buf, packet_size);
+    size_t msg_size = packet_size;
+    if (ctx->compression.layer
+            && avs_is_err(ctx->compression.layer->decompress(
+                       ctx->compression.arg, recv_buf, packet_size, buf,
+                       buf_size, &msg_size))) {
+        LOG(DEBUG, _("recv: could not decompress packet"));
+        return _avs_coap_err(AVS_COAP_ERR_MALFORMED_MESSAGE);
+    }
+
+    err = _avs_coap_udp_msg_parse(out_msg, buf, msg_size);
     if (avs_is_err(err)) {
         LOG(DEBUG, _("recv: malformed packet"));
         return err;
     }
 
+    ++ctx->stats.received_messages_count;
+    update_message_stats(ctx, packet_size);
+    ctx->stats.compression_bytes_saved +=
+            (int64_t) msg_size - (int64_t) packet_size;
     log_udp_msg_summary("recv", out_msg);
     return AVS_OK;
 }
@@ -1150,6 +1573,7 @@ static avs_error_t handle_response(avs_coap_udp_ctx_t *ctx,
 
     case AVS_COAP_UDP_TYPE_ACKNOWLEDGEMENT:
         // Piggybacked Response
+        handle_first_ack(ctx, *unconfirmed_ptr);
         break;
 
     case AVS_COAP_UDP_TYPE_RESET:
@@ -1169,10 +1593,14 @@ ack_request(avs_coap_udp_ctx_t *ctx,
     assert(unconfirmed_ptr);
     assert(*unconfirmed_ptr);
 
+    handle_first_ack(ctx, *unconfirmed_ptr);
+
     // Wait EXCHANGE_LIFETIME for the actual response
-    avs_time_monotonic_t next_retransmit = avs_time_monotonic_add(
-            avs_time_monotonic_now(),
-            avs_coap_udp_exchange_lifetime(&ctx->tx_params));
+    const avs_coap_udp_tx_params_t tx_params =
+            _avs_coap_udp_effective_tx_params(ctx);
+    avs_time_monotonic_t next_retransmit =
+            avs_time_monotonic_add(avs_time_monotonic_now(),
+                                   avs_coap_udp_exchange_lifetime(&tx_params));
 
     if (!avs_time_monotonic_valid((*unconfirmed_ptr)->next_retransmit)) {
         LOG(ERROR,
@@ -1185,15 +1613,53 @@ ack_request(avs_coap_udp_ctx_t *ctx,
     }
 
     avs_coap_udp_unconfirmed_msg_t *unconfirmed =
-            AVS_LIST_DETACH(unconfirmed_ptr);
+            unlink_unconfirmed(ctx, unconfirmed_ptr);
     // disable further retransmissions
     unconfirmed->retry_state.retries_left = 0;
     unconfirmed->next_retransmit = next_retransmit;
 
-    AVS_LIST_INSERT(find_unconfirmed_insert_ptr(ctx, unconfirmed), unconfirmed);
+    insert_unconfirmed(ctx, unconfirmed);
     reschedule_retransmission_job(ctx);
 }
 
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+/**
+ * RFC 9177, 3.3:
+ * > The server MUST acknowledge each Confirmable Q-Block1 payload [...] with an
+ * > Empty ACK, unless it is the final payload
+ *
+ * Non-final Q-Block1 payloads are thus delivered once they are acknowledged.
+ * Such delivery is reported to the send result handler as an Empty (0.00)
+ * response with the token of the request.
+ *
+ * @returns true if @p unconfirmed has been handled that way, false if it is
+ *          not a non-final Q-Block1 payload and a response shall be awaited.
+ */
+static bool
+try_confirm_q_block1_payload(avs_coap_udp_ctx_t *ctx,
+                             AVS_LIST(avs_coap_udp_unconfirmed_msg_t)
+                                     *unconfirmed_ptr) {
+    const avs_coap_udp_msg_t *request = &(*unconfirmed_ptr)->msg;
+    avs_coap_option_block_t q_block1;
+    if (_avs_coap_options_get_q_block1(&request->options, &q_block1)
+            || !q_block1.has_more) {
+        return false;
+    }
+
+    handle_first_ack(ctx, *unconfirmed_ptr);
+    const avs_coap_udp_msg_t empty_response = {
+        .header = _avs_coap_udp_header_init(
+                AVS_COAP_UDP_TYPE_ACKNOWLEDGEMENT, request->token.size,
+                AVS_COAP_CODE_EMPTY,
+                _avs_coap_udp_header_get_id(&request->header)),
+        .token = request->token,
+        .options = avs_coap_options_create_empty(NULL, 0)
+    };
+    confirm_unconfirmed(ctx, unconfirmed_ptr, &empty_response);
+    return true;
+}
+#    endif // WITH_AVS_COAP_Q_BLOCK
+
 static avs_error_t handle_empty(avs_coap_udp_ctx_t *ctx,
                                 const avs_coap_udp_msg_t *msg) {
     uint16_t msg_id = _avs_coap_udp_header_get_id(&msg->header);
@@ -1211,10 +1677,16 @@ static avs_error_t handle_empty(avs_coap_udp_ctx_t *ctx,
         // Separate ACK
         if (unconfirmed_ptr) {
             if (avs_coap_code_is_request((*unconfirmed_ptr)->msg.header.code)) {
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+                if (try_confirm_q_block1_payload(ctx, unconfirmed_ptr)) {
+                    return AVS_OK;
+                }
+#    endif // WITH_AVS_COAP_Q_BLOCK
                 // we still need to wait for a response
                 ack_request(ctx, unconfirmed_ptr);
             } else {
                 // Separate ACK to Separate Response sent by us
+                handle_first_ack(ctx, *unconfirmed_ptr);
                 confirm_unconfirmed(ctx, unconfirmed_ptr, NULL);
             }
             return AVS_OK;
@@ -1409,6 +1881,10 @@ coap_udp_receive_message(avs_coap_ctx_t *ctx_,
         }
     } else if (err.category == AVS_ERRNO_CATEGORY) {
         if (err.code == AVS_EMSGSIZE) {
+            ctx->base.in_buffer_demand =
+                    AVS_MAX(ctx->base.in_buffer_demand,
+                            AVS_MAX(get_incoming_mtu(ctx),
+                                    in_buffer_capacity + 1));
             return handle_truncated_msg(ctx, in_buffer, in_buffer_capacity,
                                         &msg);
         } else if (err.code == AVS_ETIMEDOUT) {
@@ -1442,10 +1918,12 @@ static void coap_udp_cleanup(avs_coap_ctx_t *ctx_) {
 
     while (ctx->unconfirmed_messages) {
         avs_coap_udp_unconfirmed_msg_t *unconfirmed =
-                AVS_LIST_DETACH(&ctx->unconfirmed_messages);
+                unlink_unconfirmed(ctx, &ctx->unconfirmed_messages);
         try_cleanup_unconfirmed(ctx, unconfirmed, NULL,
                                 AVS_COAP_SEND_RESULT_CANCEL, AVS_OK);
     }
+    AVS_LIST_CLEAR(&ctx->unconfirmed_pool);
+    avs_free(ctx->compression.buffer);
     avs_free(ctx);
 }
 
@@ -1456,7 +1934,10 @@ static avs_coap_base_t *coap_udp_get_base(avs_coap_ctx_t *ctx_) {
 
 static avs_coap_stats_t coap_udp_get_stats(avs_coap_ctx_t *ctx_) {
     avs_coap_udp_ctx_t *ctx = (avs_coap_udp_ctx_t *) ctx_;
-    return ctx->stats;
+    avs_coap_stats_t stats = ctx->stats;
+    stats.current_rto = _avs_coap_udp_current_rto(ctx);
+    stats.messages_in_flight = (uint32_t) current_nstart(ctx);
+    return stats;
 }
 
 static avs_error_t coap_udp_setsock(avs_coap_ctx_t *ctx,
@@ -1537,6 +2018,8 @@ avs_coap_udp_ctx_create(avs_sched_t *sched,
 
     ctx->vtable = &COAP_UDP_VTABLE;
     ctx->last_mtu = SIZE_MAX;
+    ctx->path_mtu.mtu = SIZE_MAX;
+    ctx->path_mtu.candidate_mtu = SIZE_MAX;
     ctx->tx_params =
             udp_tx_params ? *udp_tx_params : AVS_COAP_DEFAULT_UDP_TX_PARAMS;
     ctx->response_cache = cache;
@@ -1580,10 +2063,122 @@ int avs_coap_udp_ctx_set_tx_params(avs_coap_ctx_t *ctx,
 
     avs_coap_udp_ctx_t *udp_ctx = (avs_coap_udp_ctx_t *) ctx;
     udp_ctx->tx_params = *tx_params;
+    // estimates based on the previous ACK_TIMEOUT are no longer relevant
+    _avs_coap_udp_adaptive_rto_reset(&udp_ctx->adaptive_rto,
+                                     &udp_ctx->tx_params);
 
     return 0;
 }
 
+int avs_coap_udp_ctx_set_adaptive_rto(avs_coap_ctx_t *ctx, bool enabled) {
+    if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
+        LOG(ERROR, _("avs_coap_udp_ctx_set_adaptive_rto() called on a NULL or "
+                     "non-UDP context"));
+        return -1;
+    }
+
+    avs_coap_udp_ctx_t *udp_ctx = (avs_coap_udp_ctx_t *) ctx;
+    udp_ctx->adaptive_rto.enabled = enabled;
+    _avs_coap_udp_adaptive_rto_reset(&udp_ctx->adaptive_rto,
+                                     &udp_ctx->tx_params);
+    return 0;
+}
+
+int avs_coap_udp_ctx_set_path_mtu_discovery(avs_coap_ctx_t *ctx,
+                                            bool enabled,
+                                            size_t initial_mtu) {
+    if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
+        LOG(ERROR, _("avs_coap_udp_ctx_set_path_mtu_discovery() called on a "
+                     "NULL or non-UDP context"));
+        return -1;
+    }
+
+    avs_coap_udp_ctx_t *udp_ctx = (avs_coap_udp_ctx_t *) ctx;
+    udp_ctx->path_mtu = (avs_coap_udp_path_mtu_t) {
+        .enabled = enabled,
+        .mtu = (enabled && initial_mtu) ? AVS_MAX(initial_mtu, MIN_PATH_MTU)
+                                        : SIZE_MAX,
+        .candidate_mtu = SIZE_MAX
+    };
+    return 0;
+}
+
+size_t avs_coap_udp_ctx_get_path_mtu(avs_coap_ctx_t *ctx) {
+    if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
+        LOG(ERROR, _("avs_coap_udp_ctx_get_path_mtu() called on a NULL or "
+                     "non-UDP context"));
+        return 0;
+    }
+
+    const avs_coap_udp_path_mtu_t *path_mtu =
+            &((avs_coap_udp_ctx_t *) ctx)->path_mtu;
+    return (path_mtu->enabled && path_mtu->mtu != SIZE_MAX) ? path_mtu->mtu
+                                                            : 0;
+}
+
+int avs_coap_udp_ctx_set_compression(
+        avs_coap_ctx_t *ctx,
+        const avs_coap_udp_compression_t *compression,
+        void *arg) {
+    if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
+        LOG(ERROR, _("avs_coap_udp_ctx_set_compression() called on a NULL or "
+                     "non-UDP context"));
+        return -1;
+    }
+
+    avs_coap_udp_ctx_t *udp_ctx = (avs_coap_udp_ctx_t *) ctx;
+    udp_ctx->compression.layer = compression;
+    udp_ctx->compression.arg = arg;
+    return 0;
+}
+
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+int avs_coap_udp_ctx_set_q_block1(avs_coap_ctx_t *ctx, size_t max_payloads) {
+    if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
+        LOG(ERROR, _("avs_coap_udp_ctx_set_q_block1() called on a NULL or "
+                     "non-UDP context"));
+        return -1;
+    }
+
+    _avs_coap_get_base(ctx)->q_block1_max_payloads =
+            AVS_MIN(max_payloads, AVS_COAP_UDP_Q_BLOCK1_MAX_PAYLOADS);
+    return 0;
+}
+
+bool avs_coap_udp_ctx_q_block1_rejected(avs_coap_ctx_t *ctx) {
+    if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
+        LOG(ERROR, _("avs_coap_udp_ctx_q_block1_rejected() called on a NULL or "
+                     "non-UDP context"));
+        return false;
+    }
+
+    return _avs_coap_get_base(ctx)->q_block1_support
+           == AVS_COAP_Q_BLOCK_UNSUPPORTED;
+}
+
+int avs_coap_udp_ctx_set_q_block2(avs_coap_ctx_t *ctx, bool enabled) {
+    if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
+        LOG(ERROR, _("avs_coap_udp_ctx_set_q_block2() called on a NULL or "
+                     "non-UDP context"));
+        return -1;
+    }
+
+    _avs_coap_get_base(ctx)->q_block2_enabled = enabled;
+    return 0;
+}
+
+bool avs_coap_udp_ctx_q_block2_rejected(avs_coap_ctx_t *ctx) {
+    if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
+        LOG(ERROR, _("avs_coap_udp_ctx_q_block2_rejected() called on a NULL or "
+                     "non-UDP context"));
+        return false;
+    }
+
+    return _avs_coap_get_base(ctx)->q_block2_support
+           == AVS_COAP_Q_BLOCK_UNSUPPORTED;
+}
+#    endif // WITH_AVS_COAP_Q_BLOCK
+
 const avs_coap_udp_tx_params_t *
 avs_coap_udp_ctx_get_tx_params(avs_coap_ctx_t *ctx) {
     if (!ctx || ctx->vtable != &COAP_UDP_VTABLE) {
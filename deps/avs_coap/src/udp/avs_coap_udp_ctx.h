@@ -31,6 +31,57 @@ typedef struct {
     avs_time_duration_t recv_timeout;
 } avs_coap_retry_state_t;
 
+/** State of a single round-trip time estimator, as defined in RFC 6298. */
+typedef struct {
+    /** False until the first RTT measurement is fed to the estimator. */
+    bool initialized;
+    /** Smoothed round-trip time. */
+    avs_time_duration_t srtt;
+    /** Round-trip time variation. */
+    avs_time_duration_t rttvar;
+} avs_coap_udp_rtt_estimator_t;
+
+/**
+ * Adaptive retransmission timeout state, enabled using
+ * @ref avs_coap_udp_ctx_set_adaptive_rto.
+ *
+ * The overall RTO is calculated as in CoCoA (draft-ietf-core-cocoa): the
+ * "strong" estimator is fed with round-trip times of exchanges acknowledged
+ * without any retransmissions, and the "weak" one - with times measured since
+ * the first transmission of exchanges that needed one or two retransmissions.
+ */
+typedef struct {
+    bool enabled;
+    avs_coap_udp_rtt_estimator_t strong;
+    avs_coap_udp_rtt_estimator_t weak;
+    /** Overall RTO, used instead of ACK_TIMEOUT for new exchanges. */
+    avs_time_duration_t rto;
+} avs_coap_udp_adaptive_rto_t;
+
+/**
+ * Path MTU discovery state, enabled using
+ * @ref avs_coap_udp_ctx_set_path_mtu_discovery.
+ *
+ * Fragmented datagrams are much more likely to get lost, so a large message
+ * that needs repeated retransmissions suggests that it exceeds the path MTU.
+ * Such loss is only acted upon once a smaller message is acknowledged without
+ * retransmissions, which rules out the remote endpoint being unreachable
+ * altogether.
+ */
+typedef struct {
+    bool enabled;
+    /**
+     * Upper limit of outgoing message size, on top of the socket MTU. SIZE_MAX
+     * if no size-related losses have been detected.
+     */
+    size_t mtu;
+    /**
+     * Limit that will become the new <c>mtu</c> once a message not larger than
+     * it gets acknowledged without retransmissions. SIZE_MAX if there is none.
+     */
+    size_t candidate_mtu;
+} avs_coap_udp_path_mtu_t;
+
 /**
  * Owning wrapper around an unconfirmed outgoing CoAP/UDP message.
  *
@@ -45,8 +96,12 @@ typedef struct {
  * Whenever an exchange is retransmitted, next_retransmit is updated to the
  * time of a next retransmission, and the exchange entry moved to appropriate
  * place in the exchange list to keep described ordering.
+ *
+ * Each message that is in the list is also reachable through the msg_id and
+ * token indices in @ref avs_coap_udp_ctx_t, and knows the list slot that
+ * points to it, so that it can be detached without walking the list.
  */
-typedef struct {
+typedef struct avs_coap_udp_unconfirmed_msg {
     /** Handler to call when context is done with the message */
     avs_coap_send_result_handler_t *send_result_handler;
     /** Opaque argument to pass to send_result_handler */
@@ -61,12 +116,42 @@ typedef struct {
     /** Time at which this packet has to be retransmitted next time. */
     avs_time_monotonic_t next_retransmit;
 
+    /**
+     * Time at which this packet was first transmitted. Invalid if it was not
+     * sent yet, or if its first acknowledgement was already handled.
+     */
+    avs_time_monotonic_t first_sent;
+
     /** CoAP message view. Points to @ref avs_coap_udp_exchange_t#packet . */
     avs_coap_udp_msg_t msg;
 
     /** Number of initialized bytes in @ref avs_coap_udp_exchange_t#packet . */
     size_t packet_size;
 
+    /**
+     * Slot of the unconfirmed_messages list that points to this message, i.e.
+     * either the head of the list or the next pointer of the preceding
+     * message. NULL if the message is not in the list.
+     */
+    AVS_LIST(struct avs_coap_udp_unconfirmed_msg) *list_slot;
+    /**
+     * Number assigned when inserting the message into the list. Messages with
+     * equal (hold, next_retransmit) are ordered by it.
+     */
+    uint64_t list_seq;
+    /** Next message in the same bucket of the message ID index. */
+    struct avs_coap_udp_unconfirmed_msg *next_by_id;
+    /** Next message in the same bucket of the token index. */
+    struct avs_coap_udp_unconfirmed_msg *next_by_token;
+
+    /**
+     * True if @ref avs_coap_udp_unconfirmed_msg_t#packet has room for
+     * AVS_COAP_UDP_UNCONFIRMED_POOL_MSG_SIZE bytes and the entry shall be
+     * returned to @ref avs_coap_udp_ctx_t#unconfirmed_pool once no longer
+     * needed.
+     */
+    bool pooled;
+
     /** Serialized packet data. */
     uint8_t packet[];
 } avs_coap_udp_unconfirmed_msg_t;
@@ -101,17 +186,62 @@ typedef struct {
 } avs_coap_udp_notify_cache_t;
 #endif // WITH_AVS_COAP_OBSERVE
 
+/**
+ * Number of buckets in each of the indices of unconfirmed messages. Must be a
+ * power of two.
+ */
+#define AVS_COAP_UDP_UNCONFIRMED_INDEX_SIZE 16
+
 typedef struct {
     const struct avs_coap_ctx_vtable *vtable;
 
     avs_coap_base_t base;
 
     AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed_messages;
+    /** Value of list_seq to assign to the next inserted unconfirmed message. */
+    uint64_t next_unconfirmed_seq;
+
+    /**
+     * Hash indices of all messages in unconfirmed_messages, keyed by message ID
+     * and by token, respectively. They allow matching incoming ACK, Reset and
+     * response messages without comparing each of them against every element
+     * of unconfirmed_messages, which still determines the retransmission
+     * order.
+     */
+    avs_coap_udp_unconfirmed_msg_t
+            *unconfirmed_by_id[AVS_COAP_UDP_UNCONFIRMED_INDEX_SIZE];
+    avs_coap_udp_unconfirmed_msg_t
+            *unconfirmed_by_token[AVS_COAP_UDP_UNCONFIRMED_INDEX_SIZE];
+
+    /**
+     * Pooled unconfirmed message entries that are currently unused, kept to be
+     * reused for subsequent messages instead of reallocating them.
+     */
+    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) unconfirmed_pool;
+    /**
+     * Number of pooled entries allocated so far, either free or in use. Never
+     * exceeds AVS_COAP_UDP_UNCONFIRMED_POOL_SIZE.
+     */
+    size_t unconfirmed_pool_allocated;
 
     avs_net_socket_t *socket;
     size_t last_mtu;
     size_t forced_incoming_mtu;
     avs_coap_udp_tx_params_t tx_params;
+    avs_coap_udp_adaptive_rto_t adaptive_rto;
+    avs_coap_udp_path_mtu_t path_mtu;
+
+    /**
+     * Compression layer set using @ref avs_coap_udp_ctx_set_compression. The
+     * buffer holds compressed datagrams being sent or received, and is
+     * (re)allocated whenever it is too small for the context buffers.
+     */
+    struct {
+        const avs_coap_udp_compression_t *layer;
+        void *arg;
+        uint8_t *buffer;
+        size_t buffer_size;
+    } compression;
 
     avs_coap_stats_t stats;
 
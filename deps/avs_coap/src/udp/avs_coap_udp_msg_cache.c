@@ -38,16 +38,51 @@ typedef struct endpoint {
     char port[sizeof("65535")];
 } endpoint_t;
 
+/**
+ * Entries are identified by their position in the stream of all bytes ever
+ * written to the buffer, so that the identifiers are not affected by
+ * defragmentation of the buffer. As entries are only ever appended at the end
+ * and dropped from the beginning, the entry at position @c pos is still in the
+ * cache if and only if <c>pos >= consumed_bytes</c>.
+ *
+ * Index links store such positions incremented by one, so that zero can be
+ * used to mean "no entry".
+ */
+typedef uint64_t entry_link_t;
+
 struct avs_coap_udp_response_cache {
     AVS_LIST(endpoint_t) endpoints; // sorted by id
 
     // priority queue of cache_entry_t, sorted by expiration_time
     avs_buffer_t *buffer;
+    // number of bytes consumed from the beginning of buffer since its creation
+    uint64_t consumed_bytes;
+
+    /**
+     * Hash index of the entries, keyed by (endpoint, message ID). Each bucket
+     * links to the newest entry that hashes to it; older ones are chained
+     * through cache_entry_t::older_in_bucket. Since entries are dropped
+     * oldest-first, traversing a chain may stop at the first link to an entry
+     * that is no longer in the cache, so no index maintenance is necessary
+     * when dropping entries.
+     */
+    entry_link_t *index;
+    // always a power of two
+    size_t index_size;
+
+    /**
+     * Bounds of the buffer capacity. The buffer is grown when a response would
+     * otherwise evict entries that have not expired yet, and shrunk back to
+     * min_capacity once all entries expire.
+     */
+    size_t min_capacity;
+    size_t max_capacity;
 };
 
 typedef struct cache_entry {
     endpoint_t *endpoint;
     avs_time_monotonic_t expiration_time;
+    entry_link_t older_in_bucket;
     uint16_t msg_size;
     const uint8_t
             data[1]; // actually a FAM: serialized avs_coap_udp_msg_t + padding
@@ -55,9 +90,16 @@ typedef struct cache_entry {
 
 avs_coap_udp_response_cache_t *
 avs_coap_udp_response_cache_create(size_t capacity) {
-    if (capacity == 0) {
+    return avs_coap_udp_response_cache_create_growable(capacity, capacity);
+}
+
+avs_coap_udp_response_cache_t *
+avs_coap_udp_response_cache_create_growable(size_t min_capacity,
+                                            size_t max_capacity) {
+    if (max_capacity == 0) {
         return NULL;
     }
+    size_t capacity = AVS_MIN(AVS_MAX(min_capacity, 1), max_capacity);
 
     avs_coap_udp_response_cache_t *cache =
             (avs_coap_udp_response_cache_t *) avs_calloc(
@@ -66,7 +108,19 @@ avs_coap_udp_response_cache_create(size_t capacity) {
         return NULL;
     }
 
-    if (avs_buffer_create(&cache->buffer, capacity)) {
+    // assume about 128 bytes per entry, which yields a reasonable load factor
+    // for typical responses without making the index excessively large; the
+    // index is not resized when the buffer grows, only the chains get longer
+    cache->min_capacity = capacity;
+    cache->max_capacity = max_capacity;
+    cache->index_size = 16;
+    while (cache->index_size < capacity / 128) {
+        cache->index_size *= 2;
+    }
+    if (!(cache->index = (entry_link_t *) avs_calloc(cache->index_size,
+                                                     sizeof(entry_link_t)))
+            || avs_buffer_create(&cache->buffer, capacity)) {
+        avs_free(cache->index);
         avs_free(cache);
         return NULL;
     }
@@ -81,26 +135,38 @@ void avs_coap_udp_response_cache_release(
         avs_coap_udp_response_cache_t **cache_ptr) {
     if (cache_ptr && *cache_ptr) {
         avs_buffer_free(&(*cache_ptr)->buffer);
+        avs_free((*cache_ptr)->index);
         AVS_LIST_CLEAR(&(*cache_ptr)->endpoints);
         avs_free(*cache_ptr);
         *cache_ptr = NULL;
     }
 }
 
-static endpoint_t *cache_endpoint_add_ref(avs_coap_udp_response_cache_t *cache,
-                                          const char *remote_addr,
-                                          const char *remote_port) {
+static endpoint_t *
+cache_endpoint_find(const avs_coap_udp_response_cache_t *cache,
+                    const char *remote_addr,
+                    const char *remote_port) {
     assert(remote_addr);
     assert(remote_port);
 
-    AVS_LIST(endpoint_t) *ep_ptr;
-    AVS_LIST_FOREACH_PTR(ep_ptr, &cache->endpoints) {
-        if (!strcmp(remote_addr, (*ep_ptr)->addr)
-                && !strcmp(remote_port, (*ep_ptr)->port)) {
-            ++(*ep_ptr)->refcount;
-            return *ep_ptr;
+    AVS_LIST(endpoint_t) ep;
+    AVS_LIST_FOREACH(ep, cache->endpoints) {
+        if (!strcmp(remote_addr, ep->addr) && !strcmp(remote_port, ep->port)) {
+            return ep;
         }
     }
+    return NULL;
+}
+
+static endpoint_t *cache_endpoint_add_ref(avs_coap_udp_response_cache_t *cache,
+                                          const char *remote_addr,
+                                          const char *remote_port) {
+    endpoint_t *existing_ep =
+            cache_endpoint_find(cache, remote_addr, remote_port);
+    if (existing_ep) {
+        ++existing_ep->refcount;
+        return existing_ep;
+    }
 
     AVS_LIST(endpoint_t) new_ep = AVS_LIST_NEW_ELEMENT(endpoint_t);
     if (!new_ep) {
@@ -152,6 +218,16 @@ static size_t padding_bytes_after_msg(size_t msg_size) {
     }
 }
 
+static entry_link_t *index_bucket(const avs_coap_udp_response_cache_t *cache,
+                                  const endpoint_t *endpoint,
+                                  uint16_t msg_id) {
+    // Fibonacci hashing of the message ID, mixed with the endpoint address so
+    // that identical IDs used by different peers do not share one chain
+    uint32_t hash = (uint32_t) msg_id * UINT32_C(2654435761)
+                    ^ (uint32_t) ((uintptr_t) endpoint / sizeof(endpoint_t));
+    return &cache->index[hash & (cache->index_size - 1)];
+}
+
 static void cache_put_entry(avs_coap_udp_response_cache_t *cache,
                             const avs_time_monotonic_t *expiration_time,
                             endpoint_t *endpoint,
@@ -161,11 +237,15 @@ static void cache_put_entry(avs_coap_udp_response_cache_t *cache,
                "messages larger than 2^16-1 are not supposed to be used with "
                "UDP");
 
+    entry_link_t *bucket = index_bucket(
+            cache, endpoint, _avs_coap_udp_header_get_id(&msg->header));
     cache_entry_t entry = {
         .endpoint = endpoint,
         .expiration_time = *expiration_time,
+        .older_in_bucket = *bucket,
         .msg_size = (uint16_t) msg_size
     };
+    *bucket = cache->consumed_bytes + avs_buffer_data_size(cache->buffer) + 1;
 
     assert(avs_buffer_data_size(cache->buffer) % AVS_ALIGNOF(cache_entry_t)
            == 0);
@@ -262,6 +342,43 @@ static void cache_free_bytes(avs_coap_udp_response_cache_t *cache,
     int res = avs_buffer_consume_bytes(cache->buffer, expired_bytes);
     assert(!res);
     (void) res;
+    cache->consumed_bytes += expired_bytes;
+}
+
+static int cache_resize(avs_coap_udp_response_cache_t *cache,
+                        size_t new_capacity) {
+    const size_t data_size = avs_buffer_data_size(cache->buffer);
+    assert(new_capacity >= data_size);
+    avs_buffer_t *new_buffer;
+    if (avs_buffer_create(&new_buffer, new_capacity)) {
+        return -1;
+    }
+    // offsets of entries relative to the beginning of data do not change, so
+    // index links remain valid
+    int res = avs_buffer_append_bytes(new_buffer,
+                                      avs_buffer_data(cache->buffer), data_size);
+    assert(!res);
+    (void) res;
+    avs_buffer_free(&cache->buffer);
+    cache->buffer = new_buffer;
+    LOG(TRACE, _("msg_cache: resized to ") "%lu" _(" B"),
+        (unsigned long) new_capacity);
+    return 0;
+}
+
+/* grows the buffer so that a message of size @p bytes_required fits without
+ * evicting other entries, if allowed by max_capacity */
+static void cache_grow(avs_coap_udp_response_cache_t *cache,
+                       size_t bytes_required) {
+    const size_t capacity = avs_buffer_capacity(cache->buffer);
+    if (avs_buffer_space_left(cache->buffer) >= bytes_required
+            || capacity >= cache->max_capacity) {
+        return;
+    }
+    size_t new_capacity =
+            AVS_MAX(capacity * 2,
+                    avs_buffer_data_size(cache->buffer) + bytes_required);
+    (void) cache_resize(cache, AVS_MIN(new_capacity, cache->max_capacity));
 }
 
 static void cache_drop_expired(avs_coap_udp_response_cache_t *cache,
@@ -282,6 +399,29 @@ static void cache_drop_expired(avs_coap_udp_response_cache_t *cache,
     int res = avs_buffer_consume_bytes(cache->buffer, expired_bytes);
     assert(!res);
     (void) res;
+    cache->consumed_bytes += expired_bytes;
+
+    if (avs_buffer_data_size(cache->buffer) == 0
+            && avs_buffer_capacity(cache->buffer) > cache->min_capacity) {
+        // all entries expired, so the memory is no longer needed
+        (void) cache_resize(cache, cache->min_capacity);
+    }
+}
+
+/* returns the entry referred to by @p link, or NULL if it has already been
+ * dropped from the cache */
+static const cache_entry_t *
+entry_from_link(const avs_coap_udp_response_cache_t *cache, entry_link_t link) {
+    if (!link || link - 1 < cache->consumed_bytes) {
+        return NULL;
+    }
+    size_t offset = (size_t) (link - 1 - cache->consumed_bytes);
+    assert(offset < avs_buffer_data_size(cache->buffer));
+    const cache_entry_t *entry =
+            (const cache_entry_t *) ((const char *) entry_first(cache)
+                                     + offset);
+    assert(entry_valid(cache, entry));
+    return entry;
 }
 
 static const cache_entry_t *
@@ -289,12 +429,18 @@ find_entry(const avs_coap_udp_response_cache_t *cache,
            const char *remote_addr,
            const char *remote_port,
            uint16_t msg_id) {
-    for (const cache_entry_t *entry = entry_first(cache);
-         entry_valid(cache, entry);
-         entry = entry_next(entry)) {
-        if (entry_id(entry) == msg_id
-                && !strcmp(entry->endpoint->addr, remote_addr)
-                && !strcmp(entry->endpoint->port, remote_port)) {
+    const endpoint_t *endpoint =
+            cache_endpoint_find(cache, remote_addr, remote_port);
+    if (!endpoint) {
+        // no entries for this endpoint at all
+        return NULL;
+    }
+
+    for (const cache_entry_t *entry =
+                 entry_from_link(cache, *index_bucket(cache, endpoint, msg_id));
+         entry;
+         entry = entry_from_link(cache, entry->older_in_bucket)) {
+        if (entry->endpoint == endpoint && entry_id(entry) == msg_id) {
             return entry;
         }
     }
@@ -314,7 +460,7 @@ int _avs_coap_udp_response_cache_add(
 
     size_t cap_req = (_avs_coap_udp_response_cache_overhead(msg)
                       + _avs_coap_udp_msg_size(msg));
-    if (avs_buffer_capacity(cache->buffer) < cap_req) {
+    if (cache->max_capacity < cap_req) {
         LOG(DEBUG,
             _("msg_cache: not enough space for ") "%" PRIu32 _(" B message"),
             (uint32_t) _avs_coap_udp_msg_size(msg));
@@ -331,6 +477,14 @@ int _avs_coap_udp_response_cache_add(
         return AVS_COAP_MSG_CACHE_DUPLICATE;
     }
 
+    cache_grow(cache, cap_req);
+    if (avs_buffer_capacity(cache->buffer) < cap_req) {
+        LOG(DEBUG, _("msg_cache: could not grow to fit ") "%" PRIu32 _(
+                           " B message"),
+            (uint32_t) _avs_coap_udp_msg_size(msg));
+        return -1;
+    }
+
     endpoint_t *ep = cache_endpoint_add_ref(cache, remote_addr, remote_port);
     if (!ep) {
         return -1;
@@ -0,0 +1,214 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem CoAP library
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avs_coap_init.h>
+
+#ifdef WITH_AVS_COAP_UDP
+
+#    include <string.h>
+
+#    include <avsystem/commons/avs_errno.h>
+#    include <avsystem/commons/avs_utils.h>
+
+#    include <avsystem/coap/code.h>
+#    include <avsystem/coap/udp.h>
+
+#    include "udp/avs_coap_udp_header.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+// Rule ID used for messages that did not match any static rule
+#    define RULE_ID_UNCOMPRESSED 0
+
+#    define COAP_VERSION 1
+
+// Rule ID and token length byte + Message ID
+#    define COMPRESSED_HEADER_SIZE 3
+
+typedef struct {
+    avs_coap_udp_type_t type;
+    uint8_t code;
+    /**
+     * Exact encoding of the leading options, including their deltas and
+     * lengths.
+     */
+    const char *options_prefix;
+    size_t options_prefix_size;
+} static_rule_t;
+
+#    define RULE(Type, Code, OptionsPrefix)                   \
+        {                                                     \
+            .type = AVS_COAP_UDP_TYPE_##Type,                 \
+            .code = AVS_COAP_CODE_##Code,                     \
+            .options_prefix = (OptionsPrefix),                \
+            .options_prefix_size = sizeof(OptionsPrefix) - 1 \
+        }
+
+// Uri-Path option (11) with a two-character value, as the first option
+#    define URI_PATH_2(Segment) "\xB2" Segment
+
+/**
+ * Rules are matched in order, so the ones with option prefixes precede generic
+ * ones with the same type and code. Rule ID is the index in this array plus 1.
+ */
+static const static_rule_t STATIC_RULES[] = {
+    // Register, Update
+    RULE(CONFIRMABLE, POST, URI_PATH_2("rd")),
+    // De-register
+    RULE(CONFIRMABLE, DELETE, URI_PATH_2("rd")),
+    // Bootstrap-Request
+    RULE(CONFIRMABLE, POST, URI_PATH_2("bs")),
+    // Send
+    RULE(CONFIRMABLE, POST, URI_PATH_2("dp")),
+    // Read, Discover, Observe
+    RULE(CONFIRMABLE, GET, ""),
+    // Write
+    RULE(CONFIRMABLE, PUT, ""),
+    // Write, Execute, Create, Bootstrap-Finish
+    RULE(CONFIRMABLE, POST, ""),
+    // Delete
+    RULE(CONFIRMABLE, DELETE, ""),
+    // Register response
+    RULE(ACKNOWLEDGEMENT, CREATED, ""),
+    RULE(ACKNOWLEDGEMENT, DELETED, ""),
+    RULE(ACKNOWLEDGEMENT, CHANGED, ""),
+    RULE(ACKNOWLEDGEMENT, CONTENT, ""),
+    // Empty ACK
+    RULE(ACKNOWLEDGEMENT, EMPTY, ""),
+    // Notify
+    RULE(NON_CONFIRMABLE, CONTENT, ""),
+    RULE(CONFIRMABLE, CONTENT, "")
+};
+
+AVS_STATIC_ASSERT(AVS_ARRAY_SIZE(STATIC_RULES) <= 15, rule_id_fits_in_nibble);
+
+static const static_rule_t *find_rule(const uint8_t *msg, size_t msg_size) {
+    if (msg_size < sizeof(avs_coap_udp_header_t)) {
+        return NULL;
+    }
+    const uint8_t version = (uint8_t) (msg[0] >> 6);
+    const avs_coap_udp_type_t type = (avs_coap_udp_type_t) ((msg[0] >> 4) & 3);
+    const size_t token_length = msg[0] & 0x0F;
+    const size_t options_offset =
+            sizeof(avs_coap_udp_header_t) + token_length;
+    if (version != COAP_VERSION || token_length > AVS_COAP_MAX_TOKEN_LENGTH
+            || options_offset > msg_size) {
+        return NULL;
+    }
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(STATIC_RULES); ++i) {
+        const static_rule_t *rule = &STATIC_RULES[i];
+        if (rule->type == type && rule->code == msg[1]
+                && rule->options_prefix_size <= msg_size - options_offset
+                && !memcmp(&msg[options_offset], rule->options_prefix,
+                           rule->options_prefix_size)) {
+            return rule;
+        }
+    }
+    return NULL;
+}
+
+static avs_error_t static_compress(void *arg,
+                                   const void *in,
+                                   size_t in_size,
+                                   void *out,
+                                   size_t out_capacity,
+                                   size_t *out_size) {
+    (void) arg;
+    const uint8_t *msg = (const uint8_t *) in;
+    uint8_t *compressed = (uint8_t *) out;
+    const static_rule_t *rule = find_rule(msg, in_size);
+    if (!rule) {
+        if (in_size >= out_capacity) {
+            return avs_errno(AVS_ENOBUFS);
+        }
+        compressed[0] = RULE_ID_UNCOMPRESSED << 4;
+        memcpy(&compressed[1], msg, in_size);
+        *out_size = in_size + 1;
+        return AVS_OK;
+    }
+
+    const size_t rule_id = (size_t) (rule - STATIC_RULES) + 1;
+    const size_t token_length = msg[0] & 0x0F;
+    const size_t elided_size =
+            sizeof(avs_coap_udp_header_t) + token_length
+            + rule->options_prefix_size;
+    const size_t rest_size = in_size - elided_size;
+    if (COMPRESSED_HEADER_SIZE + token_length + rest_size > out_capacity) {
+        return avs_errno(AVS_ENOBUFS);
+    }
+    compressed[0] = (uint8_t) ((rule_id << 4) | token_length);
+    // Message ID
+    memcpy(&compressed[1], &msg[2], 2);
+    memcpy(&compressed[COMPRESSED_HEADER_SIZE],
+           &msg[sizeof(avs_coap_udp_header_t)], token_length);
+    memcpy(&compressed[COMPRESSED_HEADER_SIZE + token_length],
+           &msg[elided_size], rest_size);
+    *out_size = COMPRESSED_HEADER_SIZE + token_length + rest_size;
+    return AVS_OK;
+}
+
+static avs_error_t static_decompress(void *arg,
+                                     const void *in,
+                                     size_t in_size,
+                                     void *out,
+                                     size_t out_capacity,
+                                     size_t *out_size) {
+    (void) arg;
+    const uint8_t *compressed = (const uint8_t *) in;
+    uint8_t *msg = (uint8_t *) out;
+    if (in_size < 1) {
+        return avs_errno(AVS_EBADMSG);
+    }
+    const size_t rule_id = compressed[0] >> 4;
+    if (rule_id == RULE_ID_UNCOMPRESSED) {
+        if (in_size - 1 > out_capacity) {
+            return avs_errno(AVS_ENOBUFS);
+        }
+        memcpy(msg, &compressed[1], in_size - 1);
+        *out_size = in_size - 1;
+        return AVS_OK;
+    }
+
+    const size_t token_length = compressed[0] & 0x0F;
+    if (rule_id > AVS_ARRAY_SIZE(STATIC_RULES)
+            || token_length > AVS_COAP_MAX_TOKEN_LENGTH
+            || in_size < COMPRESSED_HEADER_SIZE + token_length) {
+        return avs_errno(AVS_EBADMSG);
+    }
+    const static_rule_t *rule = &STATIC_RULES[rule_id - 1];
+    const size_t rest_offset = COMPRESSED_HEADER_SIZE + token_length;
+    const size_t rest_size = in_size - rest_offset;
+    const size_t options_offset = sizeof(avs_coap_udp_header_t) + token_length;
+    const size_t msg_size =
+            options_offset + rule->options_prefix_size + rest_size;
+    if (msg_size > out_capacity) {
+        return avs_errno(AVS_ENOBUFS);
+    }
+    msg[0] = (uint8_t) ((COAP_VERSION << 6) | (rule->type << 4)
+                        | token_length);
+    msg[1] = rule->code;
+    // Message ID
+    memcpy(&msg[2], &compressed[1], 2);
+    memcpy(&msg[sizeof(avs_coap_udp_header_t)],
+           &compressed[COMPRESSED_HEADER_SIZE], token_length);
+    memcpy(&msg[options_offset], rule->options_prefix,
+           rule->options_prefix_size);
+    memcpy(&msg[options_offset + rule->options_prefix_size],
+           &compressed[rest_offset], rest_size);
+    *out_size = msg_size;
+    return AVS_OK;
+}
+
+const avs_coap_udp_compression_t AVS_COAP_UDP_STATIC_LWM2M_COMPRESSION = {
+    .compress = static_compress,
+    .decompress = static_decompress,
+    .max_overhead = 1
+};
+
+#endif // WITH_AVS_COAP_UDP
@@ -19,6 +19,8 @@
 #    define MODULE_NAME coap_udp
 #    include <avs_coap_x_log_config.h>
 
+#    include "udp/avs_coap_udp_tx_params.h"
+
 VISIBILITY_SOURCE_BEGIN
 
 const avs_coap_udp_tx_params_t AVS_COAP_DEFAULT_UDP_TX_PARAMS = {
@@ -90,4 +92,102 @@ avs_coap_udp_exchange_lifetime(const avs_coap_udp_tx_params_t *tx_params) {
             tx_params->ack_timeout);
 }
 
+// Bounds of the adaptive RTO estimate. The upper one follows RFC 6298, 2.5;
+// the lower one keeps the retransmissions from turning into a busy loop if
+// the remote endpoint is on a very fast link.
+static const avs_time_duration_t MIN_ADAPTIVE_RTO = { 0, 100000000 };
+static const avs_time_duration_t MAX_ADAPTIVE_RTO = { 60, 0 };
+
+void _avs_coap_udp_adaptive_rto_reset(
+        avs_coap_udp_adaptive_rto_t *state,
+        const avs_coap_udp_tx_params_t *tx_params) {
+    *state = (avs_coap_udp_adaptive_rto_t) {
+        .enabled = state->enabled,
+        .rto = tx_params->ack_timeout
+    };
+}
+
+avs_coap_udp_tx_params_t
+_avs_coap_udp_effective_tx_params(const avs_coap_udp_ctx_t *ctx) {
+    avs_coap_udp_tx_params_t tx_params = ctx->tx_params;
+    // the initial timeout may grow up to MAX_ADAPTIVE_RTO, and the backoff
+    // factor for such large timeouts is lower than 2, so the RFC 7252 formulas
+    // still give the upper bounds if ACK_TIMEOUT is replaced with it
+    if (ctx->adaptive_rto.enabled
+            && avs_time_duration_less(tx_params.ack_timeout,
+                                      MAX_ADAPTIVE_RTO)) {
+        tx_params.ack_timeout = MAX_ADAPTIVE_RTO;
+    }
+    return tx_params;
+}
+
+/**
+ * Updates @p estimator with a new measurement according to RFC 6298, 2.2-2.3,
+ * and returns its RTO estimate, SRTT + K * RTTVAR.
+ */
+static avs_time_duration_t
+update_rtt_estimator(avs_coap_udp_rtt_estimator_t *estimator,
+                     avs_time_duration_t rtt,
+                     double k) {
+    if (!estimator->initialized) {
+        estimator->srtt = rtt;
+        estimator->rttvar = avs_time_duration_div(rtt, 2);
+        estimator->initialized = true;
+    } else {
+        avs_time_duration_t delta =
+                avs_time_duration_less(estimator->srtt, rtt)
+                        ? avs_time_duration_diff(rtt, estimator->srtt)
+                        : avs_time_duration_diff(estimator->srtt, rtt);
+        // RTTVAR <- (1 - beta) * RTTVAR + beta * |SRTT - R'|, beta = 1/4
+        estimator->rttvar =
+                avs_time_duration_add(avs_time_duration_fmul(estimator->rttvar,
+                                                             0.75),
+                                      avs_time_duration_fmul(delta, 0.25));
+        // SRTT <- (1 - alpha) * SRTT + alpha * R', alpha = 1/8
+        estimator->srtt =
+                avs_time_duration_add(avs_time_duration_fmul(estimator->srtt,
+                                                             0.875),
+                                      avs_time_duration_fmul(rtt, 0.125));
+    }
+    return avs_time_duration_add(estimator->srtt,
+                                 avs_time_duration_fmul(estimator->rttvar, k));
+}
+
+void _avs_coap_udp_adaptive_rto_update(avs_coap_udp_adaptive_rto_t *state,
+                                       avs_time_duration_t rtt,
+                                       unsigned retransmissions) {
+    if (!avs_time_duration_valid(rtt)
+            || avs_time_duration_less(rtt, AVS_TIME_DURATION_ZERO)) {
+        return;
+    }
+
+    avs_time_duration_t estimator_rto;
+    double weight;
+    if (retransmissions == 0) {
+        estimator_rto = update_rtt_estimator(&state->strong, rtt, 4.0);
+        weight = 0.5;
+    } else if (retransmissions <= 2) {
+        estimator_rto = update_rtt_estimator(&state->weak, rtt, 1.0);
+        weight = 0.25;
+    } else {
+        return;
+    }
+
+    // RTO <- weight * RTO_x + (1 - weight) * RTO
+    avs_time_duration_t rto = avs_time_duration_add(
+            avs_time_duration_fmul(estimator_rto, weight),
+            avs_time_duration_fmul(state->rto, 1.0 - weight));
+    if (avs_time_duration_less(rto, MIN_ADAPTIVE_RTO)) {
+        rto = MIN_ADAPTIVE_RTO;
+    } else if (!avs_time_duration_valid(rto)
+               || avs_time_duration_less(MAX_ADAPTIVE_RTO, rto)) {
+        rto = MAX_ADAPTIVE_RTO;
+    }
+    LOG(DEBUG,
+        _("RTT ") "%s" _(" (") "%u" _(" retransmissions), new RTO: ") "%s",
+        AVS_TIME_DURATION_AS_STRING(rtt), retransmissions,
+        AVS_TIME_DURATION_AS_STRING(rto));
+    state->rto = rto;
+}
+
 #endif // WITH_AVS_COAP_UDP
@@ -32,6 +32,43 @@ _avs_coap_udp_max_transmit_span(const avs_coap_udp_tx_params_t *tx_params) {
                                           * tx_params->ack_random_factor);
 }
 
+/**
+ * @returns Base timeout for the first transmission of new confirmable
+ *          messages: either the adaptive RTO estimate or ACK_TIMEOUT.
+ */
+static inline avs_time_duration_t
+_avs_coap_udp_current_rto(const avs_coap_udp_ctx_t *ctx) {
+    return ctx->adaptive_rto.enabled ? ctx->adaptive_rto.rto
+                                     : ctx->tx_params.ack_timeout;
+}
+
+/**
+ * Resets the adaptive RTO state, discarding all RTT measurements and setting
+ * the estimate back to ACK_TIMEOUT.
+ */
+void _avs_coap_udp_adaptive_rto_reset(avs_coap_udp_adaptive_rto_t *state,
+                                      const avs_coap_udp_tx_params_t *tx_params);
+
+/**
+ * @returns Transmission parameters to derive MAX_TRANSMIT_SPAN,
+ *          EXCHANGE_LIFETIME etc. from. These are the configured ones, unless
+ *          adaptive RTO is enabled, in which case ACK_TIMEOUT is replaced with
+ *          the upper bound of the RTO estimate, as the actual retransmissions
+ *          may span a much longer time than the configured parameters imply.
+ */
+avs_coap_udp_tx_params_t
+_avs_coap_udp_effective_tx_params(const avs_coap_udp_ctx_t *ctx);
+
+/**
+ * Feeds a round-trip time measurement of an exchange that has been
+ * retransmitted @p retransmissions times into the adaptive RTO estimators.
+ * Measurements of exchanges retransmitted more than twice are ignored, as they
+ * can't be reliably attributed to any of the transmissions.
+ */
+void _avs_coap_udp_adaptive_rto_update(avs_coap_udp_adaptive_rto_t *state,
+                                       avs_time_duration_t rtt,
+                                       unsigned retransmissions);
+
 static inline avs_error_t
 _avs_coap_udp_initial_retry_state(avs_coap_udp_ctx_t *ctx,
                                   avs_coap_retry_state_t *out_retry_state) {
@@ -47,7 +84,7 @@ _avs_coap_udp_initial_retry_state(avs_coap_udp_ctx_t *ctx,
 
     *out_retry_state = (avs_coap_retry_state_t) {
         .retries_left = ctx->tx_params.max_retransmit,
-        .recv_timeout = avs_time_duration_fmul(ctx->tx_params.ack_timeout,
+        .recv_timeout = avs_time_duration_fmul(_avs_coap_udp_current_rto(ctx),
                                                1.0 + random_factor)
     };
     return AVS_OK;
@@ -57,16 +94,38 @@ _avs_coap_udp_initial_retry_state(avs_coap_udp_ctx_t *ctx,
 #    include "../tests/udp/tx_params_mock.h"
 #endif // AVS_UNIT_TESTING
 
+/**
+ * @returns Factor by which the timeout is multiplied on each retransmission.
+ *          It is 2 as specified in RFC 7252, unless adaptive RTO is enabled, in
+ *          which case the variable backoff factor from CoCoA is used, so that
+ *          small estimates grow faster and large ones slower.
+ */
+static inline double
+_avs_coap_udp_backoff_factor(const avs_coap_udp_ctx_t *ctx) {
+    if (ctx->adaptive_rto.enabled) {
+        if (avs_time_duration_less(ctx->adaptive_rto.rto,
+                                   avs_time_duration_from_scalar(1,
+                                                                 AVS_TIME_S))) {
+            return 3.0;
+        } else if (avs_time_duration_less(
+                           avs_time_duration_from_scalar(3, AVS_TIME_S),
+                           ctx->adaptive_rto.rto)) {
+            return 1.5;
+        }
+    }
+    return 2.0;
+}
+
 static inline int
 _avs_coap_udp_update_retry_state(avs_coap_udp_ctx_t *ctx,
                                  avs_coap_retry_state_t *retry_state) {
     retry_state->recv_timeout =
-            avs_time_duration_mul(retry_state->recv_timeout, 2);
+            avs_time_duration_fmul(retry_state->recv_timeout,
+                                   _avs_coap_udp_backoff_factor(ctx));
     --retry_state->retries_left;
     if (!avs_time_duration_valid(retry_state->recv_timeout)) {
         return -1;
     }
-    (void) ctx;
     return 0;
 }
 
@@ -0,0 +1,437 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem CoAP library
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+/*
+ * Microbenchmarks of avs_coap hot paths.
+ *
+ * Usage: avs_coap_benchmark [ITERATIONS]
+ *
+ * Each benchmark is run REPEATS times and the fastest run is reported, which
+ * makes the results reasonably stable across runs on the same machine. Results
+ * are printed to stdout as JSON, one benchmark per line, in a fixed order, so
+ * that outputs of two builds can be compared with a plain diff.
+ */
+
+#define AVS_COAP_POISON_H // disable libc poisoning
+#include <avs_coap_init.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_crypto_prng.h>
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_sched.h>
+#include <avsystem/commons/avs_shared_buffer.h>
+#include <avsystem/commons/avs_socket.h>
+#include <avsystem/commons/avs_time.h>
+
+#include <avsystem/coap/coap.h>
+
+#include "options/avs_coap_options.h"
+#include "udp/avs_coap_udp_msg.h"
+#include "udp/avs_coap_udp_msg_cache.h"
+
+#ifdef WITH_AVS_COAP_TCP
+#    include "tcp/avs_coap_tcp_msg.h"
+#endif // WITH_AVS_COAP_TCP
+
+#define DEFAULT_ITERATIONS 100000
+#define REPEATS 5
+
+#define REQUESTS_IN_FLIGHT 32
+
+/* Prevents the compiler from optimizing away the benchmarked calls. */
+static volatile size_t g_sink;
+
+static void die(const char *what) {
+    fprintf(stderr, "benchmark setup failed: %s\n", what);
+    exit(1);
+}
+
+/*
+ * Fixture resembling a typical LwM2M request: a Confirmable POST with
+ * an 8-byte token, a few Uri-Path and Uri-Query options, Content-Format,
+ * BLOCK1 and a short payload.
+ */
+typedef struct {
+    uint8_t options_buf[256];
+    avs_coap_options_t options;
+    avs_coap_token_t token;
+    uint8_t payload[64];
+    avs_coap_udp_msg_t udp_msg;
+    uint8_t packet[512];
+    size_t packet_size;
+} fixture_t;
+
+static fixture_t g_fixture;
+
+static const char *const URI_PATH[] = { "rd", "5a3f" };
+static const char *const URI_QUERY[] = { "lwm2m=1.1", "ep=urn:dev:os:0001",
+                                         "lt=86400", "b=U" };
+
+static avs_error_t build_options(avs_coap_options_t *opts) {
+    avs_error_t err = AVS_OK;
+    for (size_t i = 0; avs_is_ok(err) && i < AVS_ARRAY_SIZE(URI_PATH); ++i) {
+        err = avs_coap_options_add_string(opts, AVS_COAP_OPTION_URI_PATH,
+                                          URI_PATH[i]);
+    }
+    if (avs_is_ok(err)) {
+        err = avs_coap_options_set_content_format(opts,
+                                                  AVS_COAP_FORMAT_LINK_FORMAT);
+    }
+    for (size_t i = 0; avs_is_ok(err) && i < AVS_ARRAY_SIZE(URI_QUERY); ++i) {
+        err = avs_coap_options_add_string(opts, AVS_COAP_OPTION_URI_QUERY,
+                                          URI_QUERY[i]);
+    }
+#ifdef WITH_AVS_COAP_BLOCK
+    if (avs_is_ok(err)) {
+        err = avs_coap_options_add_block(opts,
+                                         &(const avs_coap_option_block_t) {
+                                             .type = AVS_COAP_BLOCK1,
+                                             .seq_num = 3,
+                                             .has_more = true,
+                                             .size = 512
+                                         });
+    }
+#endif // WITH_AVS_COAP_BLOCK
+    return err;
+}
+
+static void fixture_init(fixture_t *fixture) {
+    memset(fixture, 0, sizeof(*fixture));
+    fixture->options = avs_coap_options_create_empty(
+            fixture->options_buf, sizeof(fixture->options_buf));
+    if (avs_is_err(build_options(&fixture->options))) {
+        die("options");
+    }
+
+    fixture->token.size = 8;
+    for (size_t i = 0; i < fixture->token.size; ++i) {
+        fixture->token.bytes[i] = (char) (0xA0 + i);
+    }
+    for (size_t i = 0; i < sizeof(fixture->payload); ++i) {
+        fixture->payload[i] = (uint8_t) i;
+    }
+
+    fixture->udp_msg = (avs_coap_udp_msg_t) {
+        .header = _avs_coap_udp_header_init(AVS_COAP_UDP_TYPE_CONFIRMABLE,
+                                            fixture->token.size,
+                                            AVS_COAP_CODE_POST, 0x1234),
+        .token = fixture->token,
+        .options = fixture->options,
+        .payload = fixture->payload,
+        .payload_size = sizeof(fixture->payload)
+    };
+    if (avs_is_err(_avs_coap_udp_msg_serialize(
+                &fixture->udp_msg, fixture->packet, sizeof(fixture->packet),
+                &fixture->packet_size))) {
+        die("serialize");
+    }
+}
+
+static void bench_udp_msg_parse(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+        avs_coap_udp_msg_t msg;
+        if (avs_is_err(_avs_coap_udp_msg_parse(&msg, g_fixture.packet,
+                                               g_fixture.packet_size))) {
+            die("udp_msg_parse");
+        }
+        g_sink += msg.payload_size;
+    }
+}
+
+static void bench_udp_msg_serialize(size_t iterations) {
+    uint8_t packet[512];
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t size;
+        if (avs_is_err(_avs_coap_udp_msg_serialize(
+                    &g_fixture.udp_msg, packet, sizeof(packet), &size))) {
+            die("udp_msg_serialize");
+        }
+        g_sink += size;
+    }
+}
+
+#ifdef WITH_AVS_COAP_TCP
+static void bench_tcp_msg_serialize(size_t iterations) {
+    const avs_coap_borrowed_msg_t msg = {
+        .code = AVS_COAP_CODE_POST,
+        .token = g_fixture.token,
+        .options = g_fixture.options,
+        .payload = g_fixture.payload,
+        .payload_size = sizeof(g_fixture.payload),
+        .total_payload_size = sizeof(g_fixture.payload)
+    };
+    uint8_t packet[512];
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t size;
+        if (avs_is_err(_avs_coap_tcp_serialize_msg(&msg, packet, sizeof(packet),
+                                                   &size))) {
+            die("tcp_msg_serialize");
+        }
+        g_sink += size;
+    }
+}
+#endif // WITH_AVS_COAP_TCP
+
+static void bench_options_build(size_t iterations) {
+    uint8_t buf[256];
+    for (size_t i = 0; i < iterations; ++i) {
+        avs_coap_options_t opts = avs_coap_options_create_empty(buf,
+                                                                sizeof(buf));
+        if (avs_is_err(build_options(&opts))) {
+            die("options_build");
+        }
+        g_sink += opts.size;
+    }
+}
+
+static size_t iterate_strings(const avs_coap_options_t *opts,
+                              uint16_t option_number) {
+    char value[64];
+    size_t total_size = 0;
+    avs_coap_option_iterator_t it = AVS_COAP_OPTION_ITERATOR_EMPTY;
+    for (;;) {
+        size_t value_size;
+        int result = avs_coap_options_get_string_it(
+                opts, option_number, &it, &value_size, value, sizeof(value));
+        if (result == AVS_COAP_OPTION_MISSING) {
+            return total_size;
+        } else if (result) {
+            die("options_iterate");
+        }
+        total_size += value_size;
+    }
+}
+
+static void bench_options_iterate(size_t iterations) {
+    // a parsed message, as seen by request handlers
+    avs_coap_udp_msg_t msg;
+    if (avs_is_err(_avs_coap_udp_msg_parse(&msg, g_fixture.packet,
+                                           g_fixture.packet_size))) {
+        die("udp_msg_parse");
+    }
+    for (size_t i = 0; i < iterations; ++i) {
+        uint16_t format;
+        if (avs_coap_options_get_content_format(&msg.options, &format)) {
+            die("options_iterate");
+        }
+        g_sink += format
+                  + iterate_strings(&msg.options, AVS_COAP_OPTION_URI_PATH)
+                  + iterate_strings(&msg.options, AVS_COAP_OPTION_URI_QUERY);
+#ifdef WITH_AVS_COAP_BLOCK
+        avs_coap_option_block_t block1;
+        if (avs_coap_options_get_block(&msg.options, AVS_COAP_BLOCK1,
+                                       &block1)) {
+            die("options_iterate");
+        }
+        g_sink += block1.seq_num;
+#endif // WITH_AVS_COAP_BLOCK
+    }
+}
+
+static void bench_response_cache_add_get(size_t iterations) {
+    // room for a few hundred responses, so that older ones get evicted
+    avs_coap_udp_response_cache_t *cache =
+            avs_coap_udp_response_cache_create(32 * 1024);
+    if (!cache) {
+        die("response_cache_create");
+    }
+    const avs_coap_udp_tx_params_t tx_params = AVS_COAP_DEFAULT_UDP_TX_PARAMS;
+    avs_coap_udp_msg_t response = g_fixture.udp_msg;
+    response.header.code = AVS_COAP_CODE_CONTENT;
+
+    for (size_t i = 0; i < iterations; ++i) {
+        const uint16_t msg_id = (uint16_t) i;
+        _avs_coap_udp_header_set_id(&response.header, msg_id);
+        avs_coap_udp_cached_response_t cached;
+        if (_avs_coap_udp_response_cache_add(cache, "192.0.2.1", "5683",
+                                             &response, &tx_params)
+                || avs_is_err(_avs_coap_udp_response_cache_get(
+                           cache, "192.0.2.1", "5683", msg_id, &cached))) {
+            die("response_cache_add_get");
+        }
+        g_sink += cached.msg.payload_size;
+    }
+    avs_coap_udp_response_cache_release(&cache);
+}
+
+typedef struct {
+    avs_sched_t *sched;
+    avs_shared_buffer_t *in_buffer;
+    avs_shared_buffer_t *out_buffer;
+    avs_crypto_prng_ctx_t *prng_ctx;
+    avs_net_socket_t *server_socket;
+    avs_net_socket_t *client_socket;
+    avs_coap_udp_tx_params_t tx_params;
+    avs_coap_ctx_t *coap_ctx;
+} udp_env_t;
+
+static void udp_env_cleanup(udp_env_t *env) {
+    avs_coap_ctx_cleanup(&env->coap_ctx);
+    avs_sched_cleanup(&env->sched);
+    avs_net_socket_cleanup(&env->client_socket);
+    avs_net_socket_cleanup(&env->server_socket);
+    avs_free(env->in_buffer);
+    avs_free(env->out_buffer);
+    avs_crypto_prng_free(&env->prng_ctx);
+}
+
+/*
+ * Sets up a CoAP/UDP context talking to a socket bound on loopback, which
+ * never responds. Datagrams that do not fit in its receive buffer are
+ * silently dropped by the OS.
+ */
+static void udp_env_init(udp_env_t *env) {
+    char port[16];
+    *env = (udp_env_t) {
+        .sched = avs_sched_new("benchmark", NULL),
+        .in_buffer = avs_shared_buffer_new(4096),
+        .out_buffer = avs_shared_buffer_new(4096),
+        .prng_ctx = avs_crypto_prng_new(NULL, NULL),
+        .tx_params = AVS_COAP_DEFAULT_UDP_TX_PARAMS
+    };
+    // don't hold any request back
+    env->tx_params.nstart = REQUESTS_IN_FLIGHT + 1;
+    if (!env->sched || !env->in_buffer || !env->out_buffer || !env->prng_ctx
+            || avs_is_err(avs_net_udp_socket_create(&env->server_socket, NULL))
+            || avs_is_err(avs_net_socket_bind(env->server_socket, "127.0.0.1",
+                                              "0"))
+            || avs_is_err(avs_net_socket_get_local_port(env->server_socket,
+                                                        port, sizeof(port)))
+            || avs_is_err(avs_net_udp_socket_create(&env->client_socket, NULL))
+            || avs_is_err(avs_net_socket_connect(env->client_socket,
+                                                 "127.0.0.1", port))
+            || !(env->coap_ctx = avs_coap_udp_ctx_create(
+                         env->sched, &env->tx_params, env->in_buffer,
+                         env->out_buffer, NULL, env->prng_ctx))
+            || avs_is_err(avs_coap_ctx_set_socket(env->coap_ctx,
+                                                  env->client_socket))) {
+        die("udp_env");
+    }
+}
+
+static void ignore_response(avs_coap_ctx_t *ctx,
+                            avs_coap_exchange_id_t exchange_id,
+                            avs_coap_client_request_state_t result,
+                            const avs_coap_client_async_response_t *response,
+                            avs_error_t err,
+                            void *arg) {
+    (void) ctx;
+    (void) exchange_id;
+    (void) result;
+    (void) response;
+    (void) err;
+    (void) arg;
+}
+
+static avs_coap_exchange_id_t send_request(udp_env_t *env) {
+    const avs_coap_request_header_t request = {
+        .code = AVS_COAP_CODE_POST,
+        .options = g_fixture.options
+    };
+    avs_coap_exchange_id_t id;
+    if (avs_is_err(avs_coap_client_send_async_request(
+                env->coap_ctx, &id, &request, NULL, NULL, ignore_response,
+                NULL))) {
+        die("send_async_request");
+    }
+    // actually sends the request and schedules its retransmission
+    avs_sched_run(env->sched);
+    return id;
+}
+
+/*
+ * Sends a Confirmable request and cancels it, with REQUESTS_IN_FLIGHT other
+ * requests awaiting retransmission. This exercises insertion into the sorted
+ * list of unconfirmed messages and rescheduling of the retransmission job.
+ */
+static void bench_udp_request_with_retransmissions(size_t iterations) {
+    udp_env_t env;
+    udp_env_init(&env);
+    for (size_t i = 0; i < REQUESTS_IN_FLIGHT; ++i) {
+        send_request(&env);
+    }
+    for (size_t i = 0; i < iterations; ++i) {
+        avs_coap_exchange_cancel(env.coap_ctx, send_request(&env));
+    }
+    udp_env_cleanup(&env);
+}
+
+typedef void benchmark_fn_t(size_t iterations);
+
+typedef struct {
+    const char *name;
+    benchmark_fn_t *fn;
+    /* Divisor of the iteration count, for benchmarks that are much slower. */
+    size_t slowdown;
+} benchmark_t;
+
+static const benchmark_t BENCHMARKS[] = {
+    { "udp_msg_parse", bench_udp_msg_parse, 1 },
+    { "udp_msg_serialize", bench_udp_msg_serialize, 1 },
+#ifdef WITH_AVS_COAP_TCP
+    { "tcp_msg_serialize", bench_tcp_msg_serialize, 1 },
+#endif // WITH_AVS_COAP_TCP
+    { "options_build", bench_options_build, 1 },
+    { "options_iterate", bench_options_iterate, 1 },
+    { "udp_response_cache_add_get", bench_response_cache_add_get, 1 },
+    { "udp_request_with_retransmissions",
+      bench_udp_request_with_retransmissions, 10 }
+};
+
+static double measure_ns_per_op(const benchmark_t *benchmark,
+                                size_t iterations) {
+    double best = -1.0;
+    for (int i = 0; i < REPEATS; ++i) {
+        avs_time_monotonic_t start = avs_time_monotonic_now();
+        benchmark->fn(iterations);
+        double elapsed_ns;
+        if (avs_time_duration_to_fscalar(
+                    &elapsed_ns, AVS_TIME_NS,
+                    avs_time_monotonic_diff(avs_time_monotonic_now(), start))) {
+            die("clock");
+        }
+        if (best < 0.0 || elapsed_ns < best) {
+            best = elapsed_ns;
+        }
+    }
+    return best / (double) iterations;
+}
+
+int main(int argc, char *argv[]) {
+    size_t iterations = DEFAULT_ITERATIONS;
+    if (argc > 1) {
+        char *endptr;
+        unsigned long long value = strtoull(argv[1], &endptr, 10);
+        if (!*argv[1] || *endptr || value == 0) {
+            fprintf(stderr, "usage: %s [ITERATIONS]\n", argv[0]);
+            return 2;
+        }
+        iterations = (size_t) value;
+    }
+
+    fixture_init(&g_fixture);
+
+    printf("{\n  \"iterations\": %llu,\n  \"benchmarks\": [\n",
+           (unsigned long long) iterations);
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(BENCHMARKS); ++i) {
+        const size_t benchmark_iterations =
+                AVS_MAX(iterations / BENCHMARKS[i].slowdown, 1);
+        printf("    { \"name\": \"%s\", \"iterations\": %llu, "
+               "\"ns_per_op\": %.1f }%s\n",
+               BENCHMARKS[i].name, (unsigned long long) benchmark_iterations,
+               measure_ns_per_op(&BENCHMARKS[i], benchmark_iterations),
+               i + 1 < AVS_ARRAY_SIZE(BENCHMARKS) ? "," : "");
+    }
+    printf("  ]\n}\n");
+    return 0;
+}
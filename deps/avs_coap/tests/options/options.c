@@ -479,6 +479,73 @@ AVS_UNIT_TEST(coap_options, iterate) {
     ASSERT_TRUE(_avs_coap_optit_end(&it));
 }
 
+static void assert_next_string(const avs_coap_options_t *opts,
+                               uint16_t number,
+                               avs_coap_option_iterator_t *it,
+                               const char *expected) {
+    char buf[16];
+    size_t size;
+    ASSERT_OK(avs_coap_options_get_string_it(opts, number, it, &size, buf,
+                                             sizeof(buf)));
+    ASSERT_EQ_STR(buf, expected);
+}
+
+static void assert_lookups(const avs_coap_options_t *opts) {
+    avs_coap_option_iterator_t it = AVS_COAP_OPTION_ITERATOR_EMPTY;
+    assert_next_string(opts, AVS_COAP_OPTION_URI_PATH, &it, "1");
+    assert_next_string(opts, AVS_COAP_OPTION_URI_PATH, &it, "22");
+    ASSERT_EQ(avs_coap_options_get_string_it(opts, AVS_COAP_OPTION_URI_PATH,
+                                             &it, &(size_t) { 0 },
+                                             &(char[16]){ 0 }[0], 16),
+              AVS_COAP_OPTION_MISSING);
+
+    it = AVS_COAP_OPTION_ITERATOR_EMPTY;
+    assert_next_string(opts, AVS_COAP_OPTION_URI_QUERY, &it, "pmin=5");
+    assert_next_string(opts, AVS_COAP_OPTION_URI_QUERY, &it, "pmax=9");
+
+    uint16_t format;
+    ASSERT_OK(avs_coap_options_get_content_format(opts, &format));
+    ASSERT_EQ(format, AVS_COAP_FORMAT_SENML_CBOR);
+    ASSERT_EQ(avs_coap_options_get_u16(opts, AVS_COAP_OPTION_ACCEPT, &format),
+              AVS_COAP_OPTION_MISSING);
+    ASSERT_FALSE(_avs_coap_option_exists(opts, AVS_COAP_OPTION_ETAG));
+}
+
+AVS_UNIT_TEST(coap_options, lookup_index) {
+    uint8_t buf[64];
+    avs_coap_options_t built = avs_coap_options_create_empty(buf, sizeof(buf));
+    ASSERT_OK(avs_coap_options_add_string(&built, AVS_COAP_OPTION_URI_PATH,
+                                          "1"));
+    ASSERT_OK(avs_coap_options_add_string(&built, AVS_COAP_OPTION_URI_PATH,
+                                          "22"));
+    ASSERT_OK(avs_coap_options_set_content_format(&built,
+                                                  AVS_COAP_FORMAT_SENML_CBOR));
+    ASSERT_OK(avs_coap_options_add_string(&built, AVS_COAP_OPTION_URI_QUERY,
+                                          "pmin=5"));
+    ASSERT_OK(avs_coap_options_add_string(&built, AVS_COAP_OPTION_URI_QUERY,
+                                          "pmax=9"));
+    ASSERT_FALSE(built.lookup_index.valid);
+    assert_lookups(&built);
+
+    bytes_dispenser_t dispenser = {
+        .read_ptr = buf,
+        .bytes_left = built.size
+    };
+    avs_coap_options_t parsed;
+    ASSERT_OK(_avs_coap_options_parse(&parsed, &dispenser, NULL, NULL));
+    ASSERT_TRUE(parsed.lookup_index.valid);
+    ASSERT_EQ(parsed.lookup_index.size, 3);
+    assert_lookups(&parsed);
+
+    // modifying the options invalidates the index
+    avs_coap_options_remove_by_number(&parsed, AVS_COAP_OPTION_URI_QUERY);
+    ASSERT_FALSE(parsed.lookup_index.valid);
+    uint16_t format;
+    ASSERT_OK(avs_coap_options_get_content_format(&parsed, &format));
+    ASSERT_EQ(format, AVS_COAP_FORMAT_SENML_CBOR);
+    ASSERT_FALSE(_avs_coap_option_exists(&parsed, AVS_COAP_OPTION_URI_QUERY));
+}
+
 AVS_UNIT_TEST(coap_options, block_too_long) {
     const uint8_t CONTENT[] = "\xd4\x0a"          // num: 23 (13 + 10), size: 4
                               "\x00\x00\x00\x00"; // BLOCK2 option
@@ -517,6 +517,27 @@ AVS_UNIT_TEST(tcp_async_server, too_long_option_and_then_valid_message) {
     ASSERT_OK(handle_incoming_packet(env.coap_ctx, handle_new_request, &args));
 }
 
+AVS_UNIT_TEST(tcp_async_server, pipelined_requests_within_receive_budget) {
+    test_env_t env __attribute__((cleanup(test_teardown))) = test_setup();
+    ASSERT_OK(avs_coap_tcp_ctx_set_receive_budget(env.coap_ctx, 4));
+
+    const test_msg_t *requests[] = { COAP_MSG(GET, TOKEN(nth_token(0))),
+                                     COAP_MSG(GET, TOKEN(nth_token(1))) };
+    const test_msg_t *responses[] = {
+        COAP_MSG(INTERNAL_SERVER_ERROR, TOKEN(nth_token(0))),
+        COAP_MSG(INTERNAL_SERVER_ERROR, TOKEN(nth_token(1)))
+    };
+
+    // both requests are handled during a single call, without asking the
+    // socket for buffered data, until there is nothing more to receive
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(requests); ++i) {
+        expect_recv(&env, requests[i]);
+        expect_send(&env, responses[i]);
+    }
+    avs_unit_mocksock_input_fail(env.mocksock, avs_errno(AVS_ETIMEDOUT));
+    ASSERT_OK(handle_incoming_packet(env.coap_ctx, NULL, NULL));
+}
+
 AVS_UNIT_TEST(tcp_async_server, malformed_options) {
     test_env_t env __attribute__((cleanup(test_teardown))) = test_setup();
 
@@ -824,6 +845,61 @@ AVS_UNIT_TEST(tcp_async_server, incoming_request_for_big_payload) {
 #        undef RESPONSE_PAYLOAD
 }
 
+AVS_UNIT_TEST(tcp_async_server, bert_response_if_peer_supports_it) {
+#        define RESPONSE_PAYLOAD DATA_2KB DATA_1KB "?"
+
+    _avs_mock_clock_start(avs_time_monotonic_from_scalar(0, AVS_TIME_S));
+    avs_shared_buffer_t *inbuf = avs_shared_buffer_new(4096);
+    ASSERT_NOT_NULL(inbuf);
+    avs_shared_buffer_t *outbuf = avs_shared_buffer_new(4096);
+    ASSERT_NOT_NULL(outbuf);
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_with_external_buffers_without_mock_clock_and_peer_csm(
+                    inbuf, outbuf);
+    request_handler_args_t args
+            __attribute__((cleanup(cleanup_request_handler_args))) =
+                    setup_request_handler_args(env.coap_ctx, EXCHANGE_ID(1));
+
+    const test_msg_t *peer_csm = COAP_MSG(CSM, BLOCK_WISE_TRANSFER_CAPABLE,
+                                          MAX_MESSAGE_SIZE(8192));
+    expect_recv(&env, peer_csm);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(GET, TOKEN(nth_token(0))),
+        COAP_MSG(GET, TOKEN(nth_token(1)), BERT2_REQ(3))
+    };
+
+    // 3 blocks fit in the output buffer, so they are sent in a single message
+    const test_msg_t *responses[] = {
+        COAP_MSG(CONTENT, TOKEN(nth_token(0)),
+                 BERT2_RES(0, 3072, RESPONSE_PAYLOAD)),
+        COAP_MSG(CONTENT, TOKEN(nth_token(1)),
+                 BERT2_RES(3, 3072, RESPONSE_PAYLOAD))
+    };
+
+    expect_recv(&env, requests[0]);
+    expect_send(&env, responses[0]);
+    expect_last_chunk(&args, NULL, 0, false,
+                      &(payload_buf_t) {
+                          .data = RESPONSE_PAYLOAD,
+                          .size = sizeof(RESPONSE_PAYLOAD) - 1
+                      });
+    expect_cleanup(&args);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(handle_incoming_packet(env.coap_ctx, handle_new_request, &args));
+
+    // the request for the next block needs to be matched to the exchange,
+    // even though its number is larger by 3 than the last one sent
+    expect_recv(&env, requests[1]);
+    expect_send(&env, responses[1]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+#        undef RESPONSE_PAYLOAD
+}
+
 AVS_UNIT_TEST(tcp_async_server, incoming_request_block_response) {
     test_env_t env __attribute__((cleanup(test_teardown))) =
             test_setup_with_custom_sized_buffers(2048, 2048);
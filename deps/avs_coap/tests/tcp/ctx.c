@@ -47,4 +47,80 @@ AVS_UNIT_TEST(coap_tcp_ctx, unexpected_response_with_too_big_options) {
     ASSERT_OK(receive_nonrequest_message(env.coap_ctx, &request));
 }
 
+typedef struct {
+    int calls;
+    avs_error_t err;
+} pong_handler_args_t;
+
+static void
+test_pong_handler(avs_coap_ctx_t *ctx, avs_error_t err, void *args_) {
+    (void) ctx;
+    pong_handler_args_t *args = (pong_handler_args_t *) args_;
+    ++args->calls;
+    args->err = err;
+}
+
+AVS_UNIT_TEST(coap_tcp_ctx, ping_pong) {
+    test_env_t env __attribute__((cleanup(test_teardown))) = test_setup();
+    pong_handler_args_t args = { 0 };
+
+    _avs_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    expect_send(&env, COAP_MSG(PING, TOKEN(nth_token(1))));
+    ASSERT_OK(avs_coap_tcp_ctx_send_ping(env.coap_ctx, test_pong_handler,
+                                         &args));
+    ASSERT_TRUE(avs_time_monotonic_equal(
+            avs_coap_tcp_ctx_get_last_activity(env.coap_ctx),
+            avs_time_monotonic_now()));
+
+    avs_error_t err =
+            avs_coap_tcp_ctx_send_ping(env.coap_ctx, test_pong_handler, &args);
+    ASSERT_EQ(err.category, AVS_ERRNO_CATEGORY);
+    ASSERT_EQ(err.code, AVS_EBUSY);
+
+    // Pong with a different token is ignored
+    expect_recv(&env, COAP_MSG(PONG, MAKE_TOKEN("foo")));
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(handle_incoming_packet(env.coap_ctx, NULL, NULL));
+    ASSERT_EQ(args.calls, 0);
+
+    expect_recv(&env, COAP_MSG(PONG, TOKEN(nth_token(1)), CUSTODY));
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(handle_incoming_packet(env.coap_ctx, NULL, NULL));
+    ASSERT_EQ(args.calls, 1);
+    ASSERT_OK(args.err);
+
+    // the Ping is finished, so another one may be sent
+    expect_send(&env, COAP_MSG(PING, TOKEN(nth_token(2))));
+    ASSERT_OK(avs_coap_tcp_ctx_send_ping(env.coap_ctx, test_pong_handler,
+                                         &args));
+    expect_recv(&env, COAP_MSG(PONG, TOKEN(nth_token(2))));
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(handle_incoming_packet(env.coap_ctx, NULL, NULL));
+    ASSERT_EQ(args.calls, 2);
+}
+
+AVS_UNIT_TEST(coap_tcp_ctx, ping_timeout) {
+    test_env_t env __attribute__((cleanup(test_teardown))) = test_setup();
+    pong_handler_args_t args = { 0 };
+
+    expect_send(&env, COAP_MSG(PING, TOKEN(nth_token(1))));
+    ASSERT_OK(avs_coap_tcp_ctx_send_ping(env.coap_ctx, test_pong_handler,
+                                         &args));
+
+    avs_time_duration_t time_to_expiry = avs_sched_time_to_next(env.sched);
+    ASSERT_TRUE(avs_time_duration_valid(time_to_expiry));
+    _avs_mock_clock_advance(time_to_expiry);
+    avs_sched_run(env.sched);
+
+    ASSERT_EQ(args.calls, 1);
+    ASSERT_EQ(args.err.category, AVS_COAP_ERR_CATEGORY);
+    ASSERT_EQ(args.err.code, AVS_COAP_ERR_TIMEOUT);
+
+    // late Pong is ignored
+    expect_recv(&env, COAP_MSG(PONG, TOKEN(nth_token(1))));
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(handle_incoming_packet(env.coap_ctx, NULL, NULL));
+    ASSERT_EQ(args.calls, 1);
+}
+
 #endif // defined(AVS_UNIT_TESTING) && defined(WITH_AVS_COAP_TCP)
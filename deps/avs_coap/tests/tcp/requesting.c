@@ -759,6 +759,80 @@ AVS_UNIT_TEST(coap_tcp_requesting, fail_on_timeout) {
     ASSERT_FALSE(has_scheduled_job(env.sched));
 }
 
+AVS_UNIT_TEST(coap_tcp_requesting, many_requests_responded_out_of_order) {
+    test_env_t env __attribute__((cleanup(test_teardown))) = test_setup();
+    response_handler_args_t args
+            __attribute__((cleanup(cleanup_response_handler_args))) =
+                    setup_response_handler_args();
+
+    enum { REQUEST_COUNT = 20 };
+    for (uint64_t i = 0; i < REQUEST_COUNT; ++i) {
+        const test_msg_t *request = COAP_MSG(GET, TOKEN(nth_token(i)));
+        expect_send(&env, request);
+        ASSERT_OK(send_request(env.coap_ctx, request, test_response_handler,
+                               &args));
+    }
+
+    // respond to every odd request, starting from the newest one
+    for (uint64_t j = 0; j < REQUEST_COUNT / 2; ++j) {
+        const test_msg_t *response = COAP_MSG(
+                CONTENT, TOKEN(nth_token(REQUEST_COUNT - 1 - 2 * j)));
+        expect_recv(&env, response);
+        expect_response_handler_call(&args, AVS_COAP_SEND_RESULT_OK, AVS_OK,
+                                     response);
+        avs_coap_borrowed_msg_t request;
+        ASSERT_OK(receive_nonrequest_message(env.coap_ctx, &request));
+    }
+
+    // the remaining ones shall expire in the order they were sent
+    for (uint64_t i = 0; i < REQUEST_COUNT; i += 2) {
+        expect_response_handler_call(&args, AVS_COAP_SEND_RESULT_FAIL,
+                                     _avs_coap_err(AVS_COAP_ERR_TIMEOUT),
+                                     NULL);
+    }
+    _avs_mock_clock_advance(env.timeout);
+    avs_sched_run(env.sched);
+    ASSERT_FALSE(has_scheduled_job(env.sched));
+}
+
+AVS_UNIT_TEST(coap_tcp_requesting, coalesced_requests) {
+    test_env_t env __attribute__((cleanup(test_teardown))) = test_setup();
+    response_handler_args_t args
+            __attribute__((cleanup(cleanup_response_handler_args))) =
+                    setup_response_handler_args();
+
+    ASSERT_OK(avs_coap_tcp_ctx_set_write_coalescing(env.coap_ctx, 1024));
+
+    const test_msg_t *first = COAP_MSG(GET, MAKE_TOKEN("1"));
+    const test_msg_t *second = COAP_MSG(GET, MAKE_TOKEN("2"), PAYLOAD("2"));
+    uint8_t expected[1024];
+    ASSERT_TRUE(first->size + second->size <= sizeof(expected));
+    memcpy(expected, first->data, first->size);
+    memcpy(expected + first->size, second->data, second->size);
+
+    // nothing is written to the socket until the scheduler runs
+    ASSERT_OK(send_request(env.coap_ctx, first, test_response_handler, &args));
+    ASSERT_OK(
+            send_request(env.coap_ctx, second, test_response_handler, &args));
+    ASSERT_TRUE(avs_time_duration_equal(avs_sched_time_to_next(env.sched),
+                                        AVS_TIME_DURATION_ZERO));
+
+    avs_unit_mocksock_expect_output(env.mocksock, expected,
+                                    first->size + second->size);
+    avs_sched_run(env.sched);
+    avs_unit_mocksock_assert_expects_met(env.mocksock);
+
+    const test_msg_t *responses[] = { COAP_MSG(CONTENT, MAKE_TOKEN("1")),
+                                      COAP_MSG(CONTENT, MAKE_TOKEN("2")) };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(responses); ++i) {
+        expect_recv(&env, responses[i]);
+        expect_response_handler_call(&args, AVS_COAP_SEND_RESULT_OK, AVS_OK,
+                                     responses[i]);
+        avs_coap_borrowed_msg_t request;
+        ASSERT_OK(receive_nonrequest_message(env.coap_ctx, &request));
+    }
+}
+
 AVS_UNIT_TEST(coap_tcp_requesting,
               send_request_then_close_context_and_run_scheduler) {
     test_env_t env = test_setup();
@@ -18,6 +18,10 @@
 #    define MODULE_NAME test
 #    include <avs_coap_x_log_config.h>
 
+#    include "avs_coap_common_utils.h"
+#    include "avs_coap_ctx.h"
+#    include "udp/avs_coap_udp_ctx.h"
+
 #    include "./utils.h"
 
 AVS_UNIT_TEST(udp_async_client, send_request_empty_get) {
@@ -45,6 +49,71 @@ AVS_UNIT_TEST(udp_async_client, send_request_empty_get) {
     ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
 }
 
+AVS_UNIT_TEST(udp_async_client, unconfirmed_buffers_reused) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+
+    for (uint16_t i = 0; i < 2; ++i) {
+        const test_msg_t *request =
+                COAP_MSG(CON, GET, ID(i), TOKEN(nth_token(i)));
+        const test_msg_t *response =
+                COAP_MSG(ACK, CONTENT, ID(i), TOKEN(nth_token(i)));
+        avs_coap_exchange_id_t id;
+
+        ASSERT_OK(avs_coap_client_send_async_request(
+                env.coap_ctx, &id, &request->request_header, NULL, NULL,
+                test_response_handler, &env.expects_list));
+        ASSERT_TRUE(avs_coap_exchange_id_valid(id));
+
+        expect_send(&env, request);
+        avs_sched_run(env.sched);
+
+        expect_recv(&env, response);
+        expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, response);
+        expect_has_buffered_data_check(&env, false);
+        ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL,
+                                                        NULL));
+    }
+
+    // the buffer of the first request should be reused for the second one
+    avs_coap_stats_t stats = avs_coap_get_stats(env.coap_ctx);
+#    if AVS_COAP_UDP_UNCONFIRMED_POOL_SIZE > 0
+    ASSERT_EQ(stats.unconfirmed_pool_misses, 1);
+    ASSERT_EQ(stats.unconfirmed_pool_hits, 1);
+#    else  // AVS_COAP_UDP_UNCONFIRMED_POOL_SIZE > 0
+    ASSERT_EQ(stats.unconfirmed_pool_misses, 2);
+    ASSERT_EQ(stats.unconfirmed_pool_hits, 0);
+#    endif // AVS_COAP_UDP_UNCONFIRMED_POOL_SIZE > 0
+}
+
+AVS_UNIT_TEST(udp_async_client, message_stats) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+
+    const test_msg_t *request = COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0)));
+    const test_msg_t *response = COAP_MSG(ACK, CONTENT, ID(0),
+                                          TOKEN(nth_token(0)), PAYLOAD("test"));
+    avs_coap_exchange_id_t id;
+
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id, &request->request_header, NULL, NULL,
+            test_response_handler, &env.expects_list));
+
+    expect_send(&env, request);
+    avs_sched_run(env.sched);
+
+    expect_recv(&env, response);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, response);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    avs_coap_stats_t stats = avs_coap_get_stats(env.coap_ctx);
+    ASSERT_EQ(stats.sent_messages_count, 1);
+    ASSERT_EQ(stats.received_messages_count, 1);
+    ASSERT_EQ(stats.total_messages_size, request->size + response->size);
+    ASSERT_EQ(stats.max_message_size, response->size);
+}
+
 AVS_UNIT_TEST(udp_async_client, send_non_request) {
     test_env_t env __attribute__((cleanup(test_teardown))) =
             test_setup_default();
@@ -370,6 +439,267 @@ AVS_UNIT_TEST(udp_async_client, send_request_with_retransmissions) {
     ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
 }
 
+AVS_UNIT_TEST(udp_async_client, due_retransmissions_sent_in_single_pass) {
+    avs_coap_udp_tx_params_t tx_params = AVS_COAP_DEFAULT_UDP_TX_PARAMS;
+    tx_params.ack_random_factor = 1.0;
+    tx_params.nstart = 3;
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup(&tx_params, 4096, 4096, NULL);
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(CON, PUT, ID(1), TOKEN(nth_token(1))),
+        COAP_MSG(CON, POST, ID(2), TOKEN(nth_token(2)))
+    };
+    avs_coap_exchange_id_t ids[AVS_ARRAY_SIZE(requests)];
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(requests); ++i) {
+        ASSERT_OK(avs_coap_client_send_async_request(
+                env.coap_ctx, &ids[i], &requests[i]->request_header, NULL, NULL,
+                test_response_handler, &env.expects_list));
+        ASSERT_TRUE(avs_coap_exchange_id_valid(ids[i]));
+        expect_send(&env, requests[i]);
+    }
+    avs_sched_run(env.sched);
+
+    // all requests were sent at the same time, so they are all due at once;
+    // a single run of the retransmission job shall handle every one of them
+    _avs_mock_clock_advance(avs_sched_time_to_next(env.sched));
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(requests); ++i) {
+        expect_send(&env, requests[i]);
+    }
+    avs_time_monotonic_t next_timeout =
+            _avs_coap_retry_or_request_expired_job(env.coap_ctx);
+    avs_coap_stats_t stats = avs_coap_get_stats(env.coap_ctx);
+    ASSERT_EQ(stats.outgoing_retransmissions_count, AVS_ARRAY_SIZE(requests));
+    // each message is retransmitted at most once per pass
+    ASSERT_TRUE(avs_time_monotonic_before(avs_time_monotonic_now(),
+                                          next_timeout));
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(requests); ++i) {
+        const test_msg_t *response =
+                COAP_MSG(ACK, CONTENT, ID((uint16_t) i), TOKEN(nth_token(i)));
+        expect_recv(&env, response);
+        expect_handler_call(&env, &ids[i], AVS_COAP_CLIENT_REQUEST_OK,
+                            response);
+        expect_has_buffered_data_check(&env, false);
+        ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL,
+                                                        NULL));
+    }
+}
+
+static bool unconfirmed_in_bucket(avs_coap_udp_unconfirmed_msg_t *bucket,
+                                  const avs_coap_udp_unconfirmed_msg_t *msg,
+                                  bool by_id) {
+    while (bucket) {
+        if (bucket == msg) {
+            return true;
+        }
+        bucket = by_id ? bucket->next_by_id : bucket->next_by_token;
+    }
+    return false;
+}
+
+/**
+ * Checks that the indices of unconfirmed messages contain exactly the messages
+ * in the unconfirmed_messages list, and that each of them knows its list slot.
+ */
+static void assert_unconfirmed_indexed(avs_coap_ctx_t *ctx_,
+                                       size_t expected_count) {
+    avs_coap_udp_ctx_t *ctx = (avs_coap_udp_ctx_t *) ctx_;
+    size_t count = 0;
+    AVS_LIST(avs_coap_udp_unconfirmed_msg_t) *slot;
+    AVS_LIST_FOREACH_PTR(slot, &ctx->unconfirmed_messages) {
+        ASSERT_TRUE((*slot)->list_slot == slot);
+        ASSERT_TRUE(unconfirmed_in_bucket(
+                ctx->unconfirmed_by_id
+                        [_avs_coap_udp_header_get_id(&(*slot)->msg.header)
+                         & (AVS_COAP_UDP_UNCONFIRMED_INDEX_SIZE - 1)],
+                *slot, true));
+        ASSERT_TRUE(unconfirmed_in_bucket(
+                ctx->unconfirmed_by_token
+                        [_avs_coap_token_hash(&(*slot)->msg.token)
+                         & (AVS_COAP_UDP_UNCONFIRMED_INDEX_SIZE - 1)],
+                *slot, false));
+        ++count;
+    }
+    ASSERT_EQ(count, expected_count);
+
+    size_t id_indexed = 0;
+    size_t token_indexed = 0;
+    for (size_t i = 0; i < AVS_COAP_UDP_UNCONFIRMED_INDEX_SIZE; ++i) {
+        for (avs_coap_udp_unconfirmed_msg_t *msg = ctx->unconfirmed_by_id[i];
+             msg;
+             msg = msg->next_by_id) {
+            ++id_indexed;
+        }
+        for (avs_coap_udp_unconfirmed_msg_t *msg = ctx->unconfirmed_by_token[i];
+             msg;
+             msg = msg->next_by_token) {
+            ++token_indexed;
+        }
+    }
+    ASSERT_EQ(id_indexed, expected_count);
+    ASSERT_EQ(token_indexed, expected_count);
+}
+
+AVS_UNIT_TEST(udp_async_client, unconfirmed_index_retransmit_and_cancel) {
+    avs_coap_udp_tx_params_t tx_params = AVS_COAP_DEFAULT_UDP_TX_PARAMS;
+    tx_params.ack_random_factor = 1.0;
+    tx_params.nstart = 2;
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup(&tx_params, 4096, 4096, NULL);
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(CON, PUT, ID(1), TOKEN(nth_token(1))),
+        COAP_MSG(CON, POST, ID(2), TOKEN(nth_token(2)))
+    };
+    avs_coap_exchange_id_t ids[AVS_ARRAY_SIZE(requests)];
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(requests); ++i) {
+        ASSERT_OK(avs_coap_client_send_async_request(
+                env.coap_ctx, &ids[i], &requests[i]->request_header, NULL, NULL,
+                test_response_handler, &env.expects_list));
+        ASSERT_TRUE(avs_coap_exchange_id_valid(ids[i]));
+    }
+    // the third request is held because of NSTART
+    expect_send(&env, requests[0]);
+    expect_send(&env, requests[1]);
+    avs_sched_run(env.sched);
+    assert_unconfirmed_indexed(env.coap_ctx, 3);
+
+    // retransmissions move the messages within the list
+    _avs_mock_clock_advance(avs_sched_time_to_next(env.sched));
+    expect_send(&env, requests[0]);
+    expect_send(&env, requests[1]);
+    avs_sched_run(env.sched);
+    assert_unconfirmed_indexed(env.coap_ctx, 3);
+
+    // canceling the first request lets the held one be sent
+    expect_handler_call(&env, &ids[0], AVS_COAP_CLIENT_REQUEST_CANCEL, NULL);
+    avs_coap_exchange_cancel(env.coap_ctx, ids[0]);
+    expect_send(&env, requests[2]);
+    avs_sched_run(env.sched);
+    assert_unconfirmed_indexed(env.coap_ctx, 2);
+
+    // a late response to the canceled request does not match anything
+    const test_msg_t *canceled_response =
+            COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0)));
+    expect_recv(&env, canceled_response);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    // the remaining ones are matched in any order
+    for (size_t i = AVS_ARRAY_SIZE(requests) - 1; i > 0; --i) {
+        const test_msg_t *response =
+                COAP_MSG(ACK, CONTENT, ID((uint16_t) i), TOKEN(nth_token(i)));
+        expect_recv(&env, response);
+        expect_handler_call(&env, &ids[i], AVS_COAP_CLIENT_REQUEST_OK,
+                            response);
+        expect_has_buffered_data_check(&env, false);
+        ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL,
+                                                        NULL));
+    }
+    assert_unconfirmed_indexed(env.coap_ctx, 0);
+}
+
+AVS_UNIT_TEST(udp_async_client, delivery_stats) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+
+    const test_msg_t *request = COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0)));
+    const test_msg_t *response =
+            COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0)));
+    avs_coap_exchange_id_t id;
+
+    expect_send(&env, request);
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id, &request->request_header, NULL, NULL,
+            test_response_handler, &env.expects_list));
+    ASSERT_TRUE(avs_coap_exchange_id_valid(id));
+
+    avs_coap_stats_t stats = avs_coap_get_stats(env.coap_ctx);
+    ASSERT_EQ(stats.messages_in_flight, 1);
+    ASSERT_EQ(stats.acknowledged_count, 0);
+
+    _avs_mock_clock_advance(avs_time_duration_from_scalar(300, AVS_TIME_MS));
+    expect_recv(&env, response);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, response);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    // 300 ms falls into the [250 ms, 500 ms) bucket
+    stats = avs_coap_get_stats(env.coap_ctx);
+    ASSERT_EQ(stats.messages_in_flight, 0);
+    ASSERT_EQ(stats.acknowledged_count, 1);
+    ASSERT_TRUE(avs_time_duration_equal(
+            stats.total_ack_wait_time,
+            avs_time_duration_from_scalar(300, AVS_TIME_MS)));
+    for (size_t i = 0; i < AVS_COAP_STATS_RTT_HISTOGRAM_BUCKETS; ++i) {
+        ASSERT_EQ(stats.rtt_histogram[i], i == 2 ? 1 : 0);
+    }
+}
+
+AVS_UNIT_TEST(udp_async_client, path_mtu_lowered_after_large_message_loss) {
+#    define CONTENT DATA_256B
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+    ASSERT_OK(avs_coap_udp_ctx_set_path_mtu_discovery(env.coap_ctx, true, 0));
+    ASSERT_EQ(avs_coap_udp_ctx_get_path_mtu(env.coap_ctx), 0);
+
+    test_payload_writer_args_t test_payload = {
+        .payload = CONTENT,
+        .payload_size = sizeof(CONTENT) - 1
+    };
+
+    const test_msg_t *large_request =
+            COAP_MSG(CON, PUT, ID(0), TOKEN(nth_token(0)), PAYLOAD(CONTENT));
+    const test_msg_t *large_response =
+            COAP_MSG(ACK, CHANGED, ID(0), TOKEN(nth_token(0)));
+    const test_msg_t *small_request =
+            COAP_MSG(CON, GET, ID(1), TOKEN(nth_token(1)));
+    const test_msg_t *small_response =
+            COAP_MSG(ACK, CONTENT, ID(1), TOKEN(nth_token(1)));
+    avs_coap_exchange_id_t id;
+
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id, &large_request->request_header,
+            test_payload_writer, &test_payload, test_response_handler,
+            &env.expects_list));
+    expect_send(&env, large_request);
+    avs_sched_run(env.sched);
+
+    // the large message is lost twice
+    for (size_t i = 0; i < 2; ++i) {
+        _avs_mock_clock_advance(avs_sched_time_to_next(env.sched));
+        expect_send(&env, large_request);
+        avs_sched_run(env.sched);
+    }
+
+    expect_recv(&env, large_response);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, large_response);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    // the estimate is not changed until a smaller message gets through
+    ASSERT_EQ(avs_coap_udp_ctx_get_path_mtu(env.coap_ctx), 0);
+
+    expect_send(&env, small_request);
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id, &small_request->request_header, NULL, NULL,
+            test_response_handler, &env.expects_list));
+
+    expect_recv(&env, small_response);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, small_response);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    ASSERT_EQ(avs_coap_udp_ctx_get_path_mtu(env.coap_ctx),
+              large_request->size - 1);
+#    undef CONTENT
+}
+
 AVS_UNIT_TEST(udp_async_client, fail_if_no_response_after_retransmissions) {
     test_env_t env __attribute__((cleanup(test_teardown))) =
             test_setup_default();
@@ -428,6 +758,98 @@ AVS_UNIT_TEST(udp_async_client, cancel_single) {
     avs_coap_exchange_cancel(env.coap_ctx, id);
 }
 
+AVS_UNIT_TEST(udp_async_client, cancel_many_in_mixed_order) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_with_nstart(1);
+
+    const test_msg_t *request = COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0)));
+    const test_msg_t *response =
+            COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0)));
+    // more than the initial capacity of the exchange index, to force growth
+    avs_coap_exchange_id_t ids[20];
+
+    // only the first one should be sent; others are suspended because of
+    // NSTART = 1
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(ids); ++i) {
+        ASSERT_OK(avs_coap_client_send_async_request(
+                env.coap_ctx, &ids[i], &request->request_header, NULL, NULL,
+                test_response_handler, &env.expects_list));
+        ASSERT_TRUE(avs_coap_exchange_id_valid(ids[i]));
+    }
+
+    expect_send(&env, request);
+    avs_sched_run(env.sched);
+
+    // cancel odd exchanges from the back, then even ones from the front
+    for (size_t i = AVS_ARRAY_SIZE(ids); i > 1; i -= 2) {
+        expect_handler_call(&env, &ids[i - 1], AVS_COAP_CLIENT_REQUEST_CANCEL,
+                            NULL);
+        avs_coap_exchange_cancel(env.coap_ctx, ids[i - 1]);
+    }
+    for (size_t i = 2; i < AVS_ARRAY_SIZE(ids); i += 2) {
+        expect_handler_call(&env, &ids[i], AVS_COAP_CLIENT_REQUEST_CANCEL,
+                            NULL);
+        avs_coap_exchange_cancel(env.coap_ctx, ids[i]);
+    }
+
+    // canceling already finished exchanges is a no-op
+    avs_coap_exchange_cancel(env.coap_ctx, ids[1]);
+    avs_coap_exchange_cancel(env.coap_ctx, ids[2]);
+
+    // the remaining exchange can still be matched with its response
+    expect_recv(&env, response);
+    expect_handler_call(&env, &ids[0], AVS_COAP_CLIENT_REQUEST_OK, response);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+}
+
+AVS_UNIT_TEST(udp_async_client, finish_after_requests_inserted_before) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_with_nstart(1);
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(CON, PUT, ID(1), TOKEN(nth_token(1))),
+        COAP_MSG(CON, POST, ID(2), TOKEN(nth_token(2)))
+    };
+    const test_msg_t *responses[] = {
+        COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0))),
+        COAP_MSG(ACK, CHANGED, ID(1), TOKEN(nth_token(1))),
+        COAP_MSG(ACK, CHANGED, ID(2), TOKEN(nth_token(2)))
+    };
+    AVS_STATIC_ASSERT(AVS_ARRAY_SIZE(requests) == AVS_ARRAY_SIZE(responses),
+                      mismatched_requests_responses_lists);
+
+    avs_coap_exchange_id_t ids[AVS_ARRAY_SIZE(requests)];
+
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &ids[0], &requests[0]->request_header, NULL, NULL,
+            test_response_handler, &env.expects_list));
+    expect_send(&env, requests[0]);
+    avs_sched_run(env.sched);
+
+    // exchanges that are not sent yet are kept before the ones already sent,
+    // so the list position of the first exchange changes
+    for (size_t i = 1; i < AVS_ARRAY_SIZE(requests); ++i) {
+        ASSERT_OK(avs_coap_client_send_async_request(
+                env.coap_ctx, &ids[i], &requests[i]->request_header, NULL, NULL,
+                test_response_handler, &env.expects_list));
+    }
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(requests); ++i) {
+        if (i > 0) {
+            expect_send(&env, requests[i]);
+            avs_sched_run(env.sched);
+        }
+        expect_recv(&env, responses[i]);
+        expect_handler_call(&env, &ids[i], AVS_COAP_CLIENT_REQUEST_OK,
+                            responses[i]);
+        expect_has_buffered_data_check(&env, false);
+        ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL,
+                                                        NULL));
+    }
+}
+
 AVS_UNIT_TEST(udp_async_client, invalid_cancel) {
     test_env_t env __attribute__((cleanup(test_teardown))) =
             test_setup_default();
@@ -888,6 +1310,68 @@ AVS_UNIT_TEST(udp_async_client, block_request_with_explicit_block1) {
 #        undef REQUEST_PAYLOAD
 }
 
+AVS_UNIT_TEST(udp_async_client, block_request_with_iovec_provider) {
+    static const char REQUEST_PAYLOAD[] = DATA_1KB DATA_1KB "?";
+
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_with_max_retransmit(0);
+
+    // first block is sent directly from the first region, second one needs to
+    // be gathered from the remaining two
+    const avs_coap_payload_iovec_t iov[] = {
+        { REQUEST_PAYLOAD, 1024 },
+        { REQUEST_PAYLOAD + 1024, 500 },
+        { REQUEST_PAYLOAD + 1524, sizeof(REQUEST_PAYLOAD) - 1 - 1524 }
+    };
+    avs_coap_payload_iovec_list_t iovec_list = {
+        .iov = iov,
+        .iovcnt = AVS_ARRAY_SIZE(iov)
+    };
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, PUT, ID(0), TOKEN(nth_token(0)),
+                 BLOCK1_REQ(0, 1024, REQUEST_PAYLOAD)),
+        COAP_MSG(CON, PUT, ID(1), TOKEN(nth_token(1)),
+                 BLOCK1_REQ(1, 1024, REQUEST_PAYLOAD)),
+        COAP_MSG(CON, PUT, ID(2), TOKEN(nth_token(2)),
+                 BLOCK1_REQ(2, 1024, REQUEST_PAYLOAD)),
+    };
+    const test_msg_t *responses[] = {
+        COAP_MSG(ACK, CONTINUE, ID(0), TOKEN(nth_token(0)),
+                 BLOCK1_RES(0, 1024, true)),
+        COAP_MSG(ACK, CONTINUE, ID(1), TOKEN(nth_token(1)),
+                 BLOCK1_RES(1, 1024, true)),
+        COAP_MSG(ACK, CHANGED, ID(2), TOKEN(nth_token(2)),
+                 BLOCK1_RES(2, 1024, false)),
+    };
+    AVS_STATIC_ASSERT(AVS_ARRAY_SIZE(requests) == AVS_ARRAY_SIZE(responses),
+                      mismatched_requests_responses_lists);
+
+    avs_coap_exchange_id_t id;
+
+    ASSERT_OK(avs_coap_client_send_async_request_with_provider(
+            env.coap_ctx, &id, &requests[0]->request_header,
+            avs_coap_payload_iovec_provider, &iovec_list, test_response_handler,
+            &env.expects_list));
+    ASSERT_TRUE(avs_coap_exchange_id_valid(id));
+
+    expect_send(&env, requests[0]);
+    avs_sched_run(env.sched);
+
+    for (size_t i = 1; i < AVS_ARRAY_SIZE(requests); ++i) {
+        expect_recv(&env, responses[i - 1]);
+        expect_send(&env, requests[i]);
+        expect_has_buffered_data_check(&env, false);
+        ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL,
+                                                        NULL));
+    }
+
+    expect_recv(&env, responses[2]);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, responses[2]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+}
+
 AVS_UNIT_TEST(udp_async_client, block_request_with_broken_block1) {
 #        define REQUEST_PAYLOAD DATA_1KB DATA_1KB "?"
 
@@ -1842,6 +2326,254 @@ AVS_UNIT_TEST(udp_async_client_no_block, block2_response) {
 #        undef RESPONSE_PAYLOAD
 }
 
+#        ifdef WITH_AVS_COAP_Q_BLOCK
+AVS_UNIT_TEST(udp_async_client, q_block1_request) {
+#            define REQUEST_PAYLOAD DATA_1KB DATA_1KB DATA_1KB "?"
+
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+    ASSERT_OK(avs_coap_udp_ctx_set_q_block1(env.coap_ctx, 2));
+
+    test_payload_writer_args_t test_payload = {
+        .payload = REQUEST_PAYLOAD,
+        .payload_size = sizeof(REQUEST_PAYLOAD) - 1
+    };
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, PUT, ID(0), TOKEN(nth_token(0)),
+                 Q_BLOCK1_REQ(0, 1024, REQUEST_PAYLOAD)),
+        COAP_MSG(CON, PUT, ID(1), TOKEN(nth_token(1)),
+                 Q_BLOCK1_REQ(1, 1024, REQUEST_PAYLOAD)),
+        COAP_MSG(CON, PUT, ID(2), TOKEN(nth_token(2)),
+                 Q_BLOCK1_REQ(2, 1024, REQUEST_PAYLOAD)),
+        COAP_MSG(CON, PUT, ID(3), TOKEN(nth_token(3)),
+                 Q_BLOCK1_REQ(3, 1024, REQUEST_PAYLOAD)),
+    };
+    const test_msg_t *response = COAP_MSG(ACK, CHANGED, ID(3),
+                                          TOKEN(nth_token(3)),
+                                          BLOCK1_RES(3, 1024, false));
+
+    avs_coap_exchange_id_t id;
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id,
+            &COAP_MSG(CON, PUT, NO_PAYLOAD)->request_header,
+            test_payload_writer, &test_payload, test_response_handler,
+            &env.expects_list));
+    ASSERT_TRUE(avs_coap_exchange_id_valid(id));
+
+    // support for Q-Block1 is not known yet, so only one block is sent
+    expect_send(&env, requests[0]);
+    avs_sched_run(env.sched);
+
+    // once it is acknowledged, up to 2 blocks may be in flight
+    expect_recv(&env, COAP_MSG(ACK, EMPTY, ID(0), NO_PAYLOAD));
+    expect_send(&env, requests[1]);
+    expect_send(&env, requests[2]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    expect_recv(&env, COAP_MSG(ACK, EMPTY, ID(1), NO_PAYLOAD));
+    expect_send(&env, requests[3]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    // nothing more to send
+    expect_recv(&env, COAP_MSG(ACK, EMPTY, ID(2), NO_PAYLOAD));
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    expect_recv(&env, response);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, response);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    ASSERT_FALSE(avs_coap_udp_ctx_q_block1_rejected(env.coap_ctx));
+#            undef REQUEST_PAYLOAD
+}
+
+AVS_UNIT_TEST(udp_async_client, q_block1_rejected) {
+#            define REQUEST_PAYLOAD DATA_1KB DATA_1KB "?"
+
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+    ASSERT_OK(avs_coap_udp_ctx_set_q_block1(env.coap_ctx, 2));
+
+    test_payload_writer_args_t test_payload = {
+        .payload = REQUEST_PAYLOAD,
+        .payload_size = sizeof(REQUEST_PAYLOAD) - 1
+    };
+
+    const test_msg_t *q_block_request =
+            COAP_MSG(CON, PUT, ID(0), TOKEN(nth_token(0)),
+                     Q_BLOCK1_REQ(0, 1024, REQUEST_PAYLOAD));
+    const test_msg_t *bad_option = COAP_MSG(ACK, BAD_OPTION, ID(0),
+                                            TOKEN(nth_token(0)), NO_PAYLOAD);
+    const test_msg_t *block_requests[] = {
+        COAP_MSG(CON, PUT, ID(1), TOKEN(nth_token(1)),
+                 BLOCK1_REQ(0, 1024, REQUEST_PAYLOAD)),
+        COAP_MSG(CON, PUT, ID(2), TOKEN(nth_token(2)),
+                 BLOCK1_REQ(1, 1024, REQUEST_PAYLOAD)),
+        COAP_MSG(CON, PUT, ID(3), TOKEN(nth_token(3)),
+                 BLOCK1_REQ(2, 1024, REQUEST_PAYLOAD)),
+    };
+    const test_msg_t *responses[] = {
+        COAP_MSG(ACK, CONTINUE, ID(1), TOKEN(nth_token(1)),
+                 BLOCK1_RES(0, 1024, true)),
+        COAP_MSG(ACK, CONTINUE, ID(2), TOKEN(nth_token(2)),
+                 BLOCK1_RES(1, 1024, true)),
+        COAP_MSG(ACK, CHANGED, ID(3), TOKEN(nth_token(3)),
+                 BLOCK1_RES(2, 1024, false)),
+    };
+    const test_msg_t *next_block_request =
+            COAP_MSG(CON, PUT, ID(4), TOKEN(nth_token(4)),
+                     BLOCK1_REQ(0, 1024, REQUEST_PAYLOAD));
+
+    avs_coap_exchange_id_t id;
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id,
+            &COAP_MSG(CON, PUT, NO_PAYLOAD)->request_header,
+            test_payload_writer, &test_payload, test_response_handler,
+            &env.expects_list));
+    ASSERT_TRUE(avs_coap_exchange_id_valid(id));
+
+    expect_send(&env, q_block_request);
+    avs_sched_run(env.sched);
+
+    // 4.02 Bad Option is not passed to the user - the first block is sent
+    // again using BLOCK1 instead
+    expect_recv(&env, bad_option);
+    expect_send(&env, block_requests[0]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+    ASSERT_TRUE(avs_coap_udp_ctx_q_block1_rejected(env.coap_ctx));
+
+    expect_recv(&env, responses[0]);
+    expect_send(&env, block_requests[1]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    expect_recv(&env, responses[1]);
+    expect_send(&env, block_requests[2]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    expect_recv(&env, responses[2]);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, responses[2]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    // further requests use BLOCK1
+    test_payload.expected_payload_offset = 0;
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id,
+            &COAP_MSG(CON, PUT, NO_PAYLOAD)->request_header,
+            test_payload_writer, &test_payload, test_response_handler,
+            &env.expects_list));
+
+    expect_send(&env, next_block_request);
+    avs_sched_run(env.sched);
+
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_CANCEL, NULL);
+    avs_coap_exchange_cancel(env.coap_ctx, id);
+#            undef REQUEST_PAYLOAD
+}
+
+AVS_UNIT_TEST(udp_async_client, q_block2_request) {
+#            define RESPONSE_PAYLOAD DATA_1KB "?"
+
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+    ASSERT_OK(avs_coap_udp_ctx_set_q_block2(env.coap_ctx, true));
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0)), Q_BLOCK2_REQ(0, 1024)),
+        COAP_MSG(CON, GET, ID(1), TOKEN(nth_token(1)), Q_BLOCK2_REQ(1, 1024)),
+    };
+    const test_msg_t *responses[] = {
+        COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0)),
+                 Q_BLOCK2_RES(0, 1024, RESPONSE_PAYLOAD)),
+        COAP_MSG(ACK, CONTENT, ID(1), TOKEN(nth_token(1)),
+                 Q_BLOCK2_RES(1, 1024, RESPONSE_PAYLOAD)),
+    };
+
+    avs_coap_exchange_id_t id;
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id, &COAP_MSG(CON, GET, NO_PAYLOAD)->request_header,
+            NULL, NULL, test_response_handler, &env.expects_list));
+    ASSERT_TRUE(avs_coap_exchange_id_valid(id));
+
+    // the first block is requested explicitly
+    expect_send(&env, requests[0]);
+    avs_sched_run(env.sched);
+
+    expect_recv(&env, responses[0]);
+    expect_send(&env, requests[1]);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT,
+                        responses[0]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    expect_recv(&env, responses[1]);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, responses[1]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    ASSERT_FALSE(avs_coap_udp_ctx_q_block2_rejected(env.coap_ctx));
+#            undef RESPONSE_PAYLOAD
+}
+
+AVS_UNIT_TEST(udp_async_client, q_block2_rejected) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+    ASSERT_OK(avs_coap_udp_ctx_set_q_block2(env.coap_ctx, true));
+
+    const test_msg_t *q_block_request =
+            COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0)),
+                     Q_BLOCK2_REQ(0, 1024));
+    const test_msg_t *bad_option = COAP_MSG(ACK, BAD_OPTION, ID(0),
+                                            TOKEN(nth_token(0)), NO_PAYLOAD);
+    const test_msg_t *block_request =
+            COAP_MSG(CON, GET, ID(1), TOKEN(nth_token(1)), BLOCK2_REQ(0, 1024));
+    const test_msg_t *response = COAP_MSG(ACK, CONTENT, ID(1),
+                                          TOKEN(nth_token(1)), PAYLOAD("ok"));
+    const test_msg_t *next_request =
+            COAP_MSG(CON, GET, ID(2), TOKEN(nth_token(2)), NO_PAYLOAD);
+
+    avs_coap_exchange_id_t id;
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id, &COAP_MSG(CON, GET, NO_PAYLOAD)->request_header,
+            NULL, NULL, test_response_handler, &env.expects_list));
+    ASSERT_TRUE(avs_coap_exchange_id_valid(id));
+
+    expect_send(&env, q_block_request);
+    avs_sched_run(env.sched);
+
+    // 4.02 Bad Option is not passed to the user - the request is sent again
+    // using BLOCK2 instead
+    expect_recv(&env, bad_option);
+    expect_send(&env, block_request);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+    ASSERT_TRUE(avs_coap_udp_ctx_q_block2_rejected(env.coap_ctx));
+
+    expect_recv(&env, response);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, response);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    // further requests do not use Q-Block2
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id, &COAP_MSG(CON, GET, NO_PAYLOAD)->request_header,
+            NULL, NULL, test_response_handler, &env.expects_list));
+
+    expect_send(&env, next_request);
+    avs_sched_run(env.sched);
+
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_CANCEL, NULL);
+    avs_coap_exchange_cancel(env.coap_ctx, id);
+}
+#        endif // WITH_AVS_COAP_Q_BLOCK
+
 #    endif // WITH_AVS_COAP_BLOCK
 
 #endif // defined(AVS_UNIT_TESTING) && defined(WITH_AVS_COAP_UDP)
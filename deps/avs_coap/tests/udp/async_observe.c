@@ -88,6 +88,51 @@ AVS_UNIT_TEST(udp_observe, start_twice) {
     }
 }
 
+AVS_UNIT_TEST(udp_observe, many_observations) {
+    test_env_t env __attribute__((cleanup(test_teardown_late_expects_check))) =
+            test_setup_default();
+
+    // more observations than buckets in the observation index
+    enum { NUM_OBSERVES = 40 };
+
+    for (size_t i = 0; i < NUM_OBSERVES; ++i) {
+        const test_msg_t *request =
+                COAP_MSG(CON, GET, ID((uint16_t) i), TOKEN(nth_token(i)),
+                         OBSERVE(0), NO_PAYLOAD);
+        const test_msg_t *response =
+                COAP_MSG(ACK, CONTENT, ID((uint16_t) i), TOKEN(nth_token(i)),
+                         OBSERVE(0), NO_PAYLOAD);
+
+        expect_recv(&env, request);
+        expect_request_handler_call(
+                &env, AVS_COAP_SERVER_REQUEST_RECEIVED, request,
+                &(avs_coap_response_header_t) {
+                    .code = response->response_header.code
+                },
+                NULL);
+        expect_observe_start(&env, nth_token(i));
+        expect_send(&env, response);
+        expect_request_handler_call(&env, AVS_COAP_SERVER_REQUEST_CLEANUP, NULL,
+                                    NULL, NULL);
+        expect_has_buffered_data_check(&env, false);
+        ASSERT_OK(avs_coap_async_handle_incoming_packet(
+                env.coap_ctx, test_accept_new_request, &env));
+    }
+
+    // cancel every other observation first, so that entries are removed from
+    // the middle of index buckets
+    for (size_t start = 0; start < 2; ++start) {
+        for (size_t i = start; i < NUM_OBSERVES; i += 2) {
+            avs_coap_observe_id_t observe_id = {
+                .token = nth_token(i)
+            };
+            expect_observe_cancel(&env, nth_token(i));
+            ASSERT_OK(avs_coap_observe_cancel(env.coap_ctx, observe_id));
+            ASSERT_FAIL(avs_coap_observe_cancel(env.coap_ctx, observe_id));
+        }
+    }
+}
+
 AVS_UNIT_TEST(udp_observe, cancel_with_observe_option) {
     test_env_t env __attribute__((cleanup(test_teardown))) =
             test_setup_default();
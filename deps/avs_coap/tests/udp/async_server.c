@@ -681,6 +681,52 @@ AVS_UNIT_TEST(udp_async_server, block2_request_from_the_middle) {
 #        undef RESPONSE_PAYLOAD
 }
 
+#        ifdef WITH_AVS_COAP_Q_BLOCK
+AVS_UNIT_TEST(udp_async_server, q_block2_request) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+
+#            define RESPONSE_PAYLOAD DATA_1KB "!"
+
+    const test_msg_t *requests[] = {
+        COAP_MSG(CON, GET, ID(0), TOKEN(nth_token(0)), Q_BLOCK2_REQ(0, 1024)),
+        COAP_MSG(CON, GET, ID(1), TOKEN(nth_token(1)), Q_BLOCK2_REQ(1, 1024))
+    };
+    // responses to Q-Block2 requests use Q-Block2 as well
+    const test_msg_t *responses[] = {
+        COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0)),
+                 Q_BLOCK2_RES(0, 1024, RESPONSE_PAYLOAD)),
+        COAP_MSG(ACK, CONTENT, ID(1), TOKEN(nth_token(1)),
+                 Q_BLOCK2_RES(1, 1024, RESPONSE_PAYLOAD))
+    };
+
+    test_payload_writer_args_t response_payload = {
+        .payload = RESPONSE_PAYLOAD,
+        .payload_size = sizeof(RESPONSE_PAYLOAD) - 1
+    };
+
+    expect_recv(&env, requests[0]);
+    expect_request_handler_call(&env, AVS_COAP_SERVER_REQUEST_RECEIVED,
+                                requests[0],
+                                &(avs_coap_response_header_t) {
+                                    .code = responses[0]->response_header.code
+                                },
+                                &response_payload);
+    expect_request_handler_call(&env, AVS_COAP_SERVER_REQUEST_CLEANUP, NULL,
+                                NULL, NULL);
+    expect_send(&env, responses[0]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(
+            env.coap_ctx, test_accept_new_request, &env));
+
+    expect_recv(&env, requests[1]);
+    expect_send(&env, responses[1]);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+#            undef RESPONSE_PAYLOAD
+}
+#        endif // WITH_AVS_COAP_Q_BLOCK
+
 AVS_UNIT_TEST(udp_async_server, block2_request_not_in_order) {
     test_env_t env __attribute__((cleanup(test_teardown_late_expects_check))) =
             test_setup_default();
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem CoAP library
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avs_coap_init.h>
+
+#if defined(AVS_UNIT_TESTING) && defined(WITH_AVS_COAP_UDP)
+
+#    include <avsystem/coap/coap.h>
+
+#    define MODULE_NAME test
+#    include <avs_coap_x_log_config.h>
+
+#    include "./utils.h"
+
+static const avs_coap_udp_compression_t *const COMPRESSION =
+        &AVS_COAP_UDP_STATIC_LWM2M_COMPRESSION;
+
+static void assert_round_trip(const test_msg_t *msg, int expected_saved) {
+    uint8_t compressed[256];
+    size_t compressed_size;
+    ASSERT_OK(COMPRESSION->compress(NULL, msg->data, msg->size, compressed,
+                                    sizeof(compressed), &compressed_size));
+    ASSERT_EQ((int) msg->size - (int) compressed_size, expected_saved);
+
+    uint8_t decompressed[256];
+    size_t decompressed_size;
+    ASSERT_OK(COMPRESSION->decompress(NULL, compressed, compressed_size,
+                                      decompressed, sizeof(decompressed),
+                                      &decompressed_size));
+    ASSERT_EQ(decompressed_size, msg->size);
+    ASSERT_EQ_BYTES_SIZED(decompressed, msg->data, msg->size);
+}
+
+AVS_UNIT_TEST(udp_compression, static_rules_round_trip) {
+    // Register: version, type and code in one byte, Uri-Path "rd" elided
+    assert_round_trip(COAP_MSG(CON, POST, ID(0x1234), TOKEN(nth_token(0)),
+                               PATH("rd"), QUERY("ep=test")),
+                      4);
+    // Update: only the leading "rd" segment is elided
+    assert_round_trip(COAP_MSG(CON, POST, ID(1), TOKEN(nth_token(1)),
+                               PATH("rd", "5a3f")),
+                      4);
+    // Execute: no options elided
+    assert_round_trip(COAP_MSG(CON, POST, ID(2), TOKEN(nth_token(2)),
+                               PATH("3", "0", "4")),
+                      1);
+    // Empty ACK
+    assert_round_trip(COAP_MSG(ACK, EMPTY, ID(3)), 1);
+    // No matching rule: sent as is, with a rule ID byte prepended
+    assert_round_trip(COAP_MSG(ACK, BAD_REQUEST, ID(4), TOKEN(nth_token(4))),
+                      -1);
+}
+
+AVS_UNIT_TEST(udp_compression, invalid_rule_rejected) {
+    // rule 15 is not defined
+    const uint8_t compressed[] = { 0xF0, 0x00, 0x00 };
+    uint8_t decompressed[256];
+    size_t decompressed_size;
+    ASSERT_FAIL(COMPRESSION->decompress(NULL, compressed, sizeof(compressed),
+                                        decompressed, sizeof(decompressed),
+                                        &decompressed_size));
+}
+
+AVS_UNIT_TEST(udp_compression, request_and_response) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_default();
+    ASSERT_OK(avs_coap_udp_ctx_set_compression(env.coap_ctx, COMPRESSION,
+                                               NULL));
+
+    const test_msg_t *request =
+            COAP_MSG(CON, POST, ID(0), TOKEN(nth_token(0)), PATH("rd"));
+    const test_msg_t *response =
+            COAP_MSG(ACK, CREATED, ID(0), TOKEN(nth_token(0)));
+    uint8_t compressed_request[64];
+    size_t compressed_request_size;
+    ASSERT_OK(COMPRESSION->compress(NULL, request->data, request->size,
+                                    compressed_request,
+                                    sizeof(compressed_request),
+                                    &compressed_request_size));
+    uint8_t compressed_response[64];
+    size_t compressed_response_size;
+    ASSERT_OK(COMPRESSION->compress(NULL, response->data, response->size,
+                                    compressed_response,
+                                    sizeof(compressed_response),
+                                    &compressed_response_size));
+    avs_coap_exchange_id_t id;
+
+    ASSERT_OK(avs_coap_client_send_async_request(
+            env.coap_ctx, &id, &request->request_header, NULL, NULL,
+            test_response_handler, &env.expects_list));
+
+    // the compressed request should be passed to the socket
+    avs_unit_mocksock_expect_output(env.mocksock, compressed_request,
+                                    compressed_request_size);
+    avs_sched_run(env.sched);
+
+    // and the compressed response decompressed before handling
+    avs_unit_mocksock_input(env.mocksock, compressed_response,
+                            compressed_response_size);
+    expect_handler_call(&env, &id, AVS_COAP_CLIENT_REQUEST_OK, response);
+    expect_has_buffered_data_check(&env, false);
+    ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
+
+    avs_coap_stats_t stats = avs_coap_get_stats(env.coap_ctx);
+    ASSERT_EQ(stats.compression_bytes_saved, 5);
+    ASSERT_EQ(stats.total_messages_size,
+              compressed_request_size + compressed_response_size);
+}
+
+#endif // defined(AVS_UNIT_TESTING) && defined(WITH_AVS_COAP_UDP)
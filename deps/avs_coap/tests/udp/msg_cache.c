@@ -424,4 +424,96 @@ AVS_UNIT_TEST(coap_msg_cache, multiple_hosts_same_ids) {
     avs_coap_udp_response_cache_release(&cache);
 }
 
+AVS_UNIT_TEST(coap_msg_cache, hit_after_many_evictions) {
+    static const uint16_t id = 123;
+    static const size_t MSG_COUNT = 1000;
+    test_udp_msg_t msg __attribute__((cleanup(free_msg))) =
+            setup_msg_with_id(id, "");
+    const size_t entry_size =
+            _avs_coap_udp_response_cache_overhead(&msg.udp_msg)
+            + _avs_coap_udp_msg_size(&msg.udp_msg);
+
+    // room for exactly 8 entries, for a total of 16 used by two hosts
+    avs_coap_udp_response_cache_t *cache =
+            avs_coap_udp_response_cache_create(entry_size * 16);
+
+    for (size_t i = 0; i < MSG_COUNT; ++i) {
+        _avs_coap_udp_header_set_id(&msg.udp_msg.header, (uint16_t) (id + i));
+        ASSERT_OK(_avs_coap_udp_response_cache_add(
+                cache, i % 2 ? "h1" : "h2", "port", &msg.udp_msg, &tx_params));
+    }
+
+    // only the newest entries are still present
+    for (size_t i = 0; i < MSG_COUNT; ++i) {
+        avs_coap_udp_cached_response_t cached_msg;
+        avs_error_t err = _avs_coap_udp_response_cache_get(
+                cache, i % 2 ? "h1" : "h2", "port", (uint16_t) (id + i),
+                &cached_msg);
+        if (i >= MSG_COUNT - 16) {
+            ASSERT_OK(err);
+            ASSERT_EQ(_avs_coap_udp_header_get_id(&cached_msg.msg.header),
+                      (uint16_t) (id + i));
+        } else {
+            ASSERT_FAIL(err);
+        }
+        // entries of one host are not visible to the other
+        ASSERT_FAIL(_avs_coap_udp_response_cache_get(
+                cache, i % 2 ? "h2" : "h1", "port", (uint16_t) (id + i),
+                &(avs_coap_udp_cached_response_t) { 0 }));
+    }
+
+    avs_coap_udp_response_cache_release(&cache);
+}
+
+AVS_UNIT_TEST(coap_msg_cache, growable) {
+    static const uint16_t id = 123;
+    test_udp_msg_t msg __attribute__((cleanup(free_msg))) =
+            setup_msg_with_id(id, "");
+    const size_t entry_size =
+            _avs_coap_udp_response_cache_overhead(&msg.udp_msg)
+            + _avs_coap_udp_msg_size(&msg.udp_msg);
+
+    // starts with room for 2 entries, may grow to 8
+    avs_coap_udp_response_cache_t *cache =
+            avs_coap_udp_response_cache_create_growable(entry_size * 2,
+                                                        entry_size * 8);
+
+    _avs_mock_clock_start((avs_time_monotonic_t) { AVS_TIME_DURATION_ZERO });
+
+    for (uint16_t i = 0; i < 16; ++i) {
+        _avs_coap_udp_header_set_id(&msg.udp_msg.header, (uint16_t) (id + i));
+        ASSERT_OK(_avs_coap_udp_response_cache_add(cache, "host", "port",
+                                                   &msg.udp_msg, &tx_params));
+    }
+
+    // the cache grew to its maximum size, so 8 newest entries are present
+    for (uint16_t i = 0; i < 16; ++i) {
+        avs_error_t err = _avs_coap_udp_response_cache_get(
+                cache, "host", "port", (uint16_t) (id + i),
+                &(avs_coap_udp_cached_response_t) { 0 });
+        if (i >= 8) {
+            ASSERT_OK(err);
+        } else {
+            ASSERT_FAIL(err);
+        }
+    }
+
+    // after all entries expire, the cache still works after shrinking
+    _avs_mock_clock_advance(avs_time_duration_from_scalar(247, AVS_TIME_S));
+    ASSERT_FAIL(_avs_coap_udp_response_cache_get(
+            cache, "host", "port", (uint16_t) (id + 15),
+            &(avs_coap_udp_cached_response_t) { 0 }));
+    _avs_coap_udp_header_set_id(&msg.udp_msg.header, id);
+    ASSERT_OK(_avs_coap_udp_response_cache_add(cache, "host", "port",
+                                               &msg.udp_msg, &tx_params));
+    avs_coap_udp_cached_response_t cached_msg;
+    ASSERT_OK(_avs_coap_udp_response_cache_get(cache, "host", "port", id,
+                                               &cached_msg));
+    assert_udp_msg_equal(msg.udp_msg, cached_msg.msg);
+
+    avs_coap_udp_response_cache_release(&cache);
+
+    _avs_mock_clock_finish();
+}
+
 #endif // defined(AVS_UNIT_TESTING) && defined(WITH_AVS_COAP_UDP)
@@ -26,6 +26,8 @@ typedef struct {
     bool ignore_overlong_request;
     bool expect_failure;
     bool use_peek;
+    // if nonzero, the payload is read in pieces of at most that size
+    size_t read_chunk_size;
 
     avs_coap_response_header_t response_header;
     const char *response_data;
@@ -66,6 +68,9 @@ static int streaming_handle_request(avs_coap_streaming_request_ctx_t *ctx,
                 break;
             }
         }
+        if (args->read_chunk_size) {
+            buf_size = AVS_MIN(buf_size, args->read_chunk_size);
+        }
 
         char ch;
         avs_error_t peek_err;
@@ -176,6 +181,46 @@ AVS_UNIT_TEST(udp_streaming_server, small_payload) {
 #    undef RESPONSE_PAYLOAD
 }
 
+AVS_UNIT_TEST(udp_streaming_server, payload_larger_than_response_buffer) {
+#    define REQUEST_PAYLOAD DATA_1KB "?"
+#    define RESPONSE_PAYLOAD "fish"
+    // request payload is read from the input buffer directly, so it does not
+    // need to fit in the buffer for response payload
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup(&AVS_COAP_DEFAULT_UDP_TX_PARAMS, 4096, 128, NULL);
+
+    const test_msg_t *request = COAP_MSG(CON, PUT, ID(0), TOKEN(nth_token(0)),
+                                         PAYLOAD(REQUEST_PAYLOAD));
+    const test_msg_t *response =
+            COAP_MSG(ACK, CONTENT, ID(0), TOKEN(nth_token(0)),
+                     PAYLOAD(RESPONSE_PAYLOAD));
+
+    streaming_handle_request_args_t args = {
+        .expected_request_header = request->request_header,
+        .expected_request_data = REQUEST_PAYLOAD,
+        .expected_request_data_size = sizeof(REQUEST_PAYLOAD) - 1,
+        .use_peek = true,
+        .read_chunk_size = 100,
+        .response_header = {
+            .code = response->response_header.code
+        },
+        .response_data = RESPONSE_PAYLOAD,
+        .response_data_size = sizeof(RESPONSE_PAYLOAD) - 1
+    };
+
+    avs_unit_mocksock_enable_recv_timeout_getsetopt(
+            env.mocksock, avs_time_duration_from_scalar(1, AVS_TIME_S));
+
+    expect_recv(&env, request);
+    expect_send(&env, response);
+    expect_has_buffered_data_check(&env, false);
+
+    ASSERT_OK(avs_coap_streaming_handle_incoming_packet(
+            env.coap_ctx, streaming_handle_request, &args));
+#    undef REQUEST_PAYLOAD
+#    undef RESPONSE_PAYLOAD
+}
+
 #    ifdef WITH_AVS_COAP_BLOCK
 
 AVS_UNIT_TEST(udp_streaming_server, large_payload) {
@@ -52,6 +52,90 @@ AVS_UNIT_TEST(udp_tx_params, correct_backoff) {
     avs_crypto_prng_free(&ctx.base.prng_ctx);
 }
 
+static void assert_duration_ms(avs_time_duration_t actual,
+                               int64_t expected_ms) {
+    int64_t actual_ms;
+    ASSERT_OK(avs_time_duration_to_scalar(&actual_ms, AVS_TIME_MS, actual));
+    // allow for rounding errors of floating-point multiplication
+    ASSERT_TRUE(actual_ms >= expected_ms - 1 && actual_ms <= expected_ms + 1);
+}
+
+AVS_UNIT_TEST(udp_tx_params, adaptive_rto) {
+    avs_coap_udp_ctx_t ctx = {
+        .base.prng_ctx = avs_crypto_prng_new(NULL, NULL),
+        .tx_params = DETERMINISTIC_TX_PARAMS,
+        .adaptive_rto.enabled = true
+    };
+    _avs_coap_udp_adaptive_rto_reset(&ctx.adaptive_rto, &ctx.tx_params);
+    assert_duration_ms(_avs_coap_udp_current_rto(&ctx), 2000);
+    ASSERT_EQ(_avs_coap_udp_backoff_factor(&ctx), 2.0);
+
+    // strong estimator: SRTT = 100ms, RTTVAR = 50ms, RTO_strong = 300ms;
+    // RTO = 0.5 * 300ms + 0.5 * 2000ms
+    _avs_coap_udp_adaptive_rto_update(
+            &ctx.adaptive_rto, avs_time_duration_from_scalar(100, AVS_TIME_MS),
+            0);
+    assert_duration_ms(ctx.adaptive_rto.rto, 1150);
+
+    avs_coap_retry_state_t state;
+    ASSERT_OK(_avs_coap_udp_initial_retry_state(&ctx, &state));
+    assert_duration_ms(state.recv_timeout, 1150);
+
+    // SRTT = 100ms, RTTVAR = 37.5ms, RTO_strong = 250ms;
+    // RTO = 0.5 * 250ms + 0.5 * 1150ms
+    _avs_coap_udp_adaptive_rto_update(
+            &ctx.adaptive_rto, avs_time_duration_from_scalar(100, AVS_TIME_MS),
+            0);
+    assert_duration_ms(ctx.adaptive_rto.rto, 700);
+    // backoff grows faster for small RTOs
+    ASSERT_EQ(_avs_coap_udp_backoff_factor(&ctx), 3.0);
+
+    // weak estimator: SRTT = 4s, RTTVAR = 2s, RTO_weak = 6s;
+    // RTO = 0.25 * 6000ms + 0.75 * 700ms
+    _avs_coap_udp_adaptive_rto_update(
+            &ctx.adaptive_rto, avs_time_duration_from_scalar(4, AVS_TIME_S), 2);
+    assert_duration_ms(ctx.adaptive_rto.rto, 2025);
+
+    // exchanges retransmitted more than twice are ignored
+    _avs_coap_udp_adaptive_rto_update(
+            &ctx.adaptive_rto, avs_time_duration_from_scalar(30, AVS_TIME_S),
+            3);
+    assert_duration_ms(ctx.adaptive_rto.rto, 2025);
+
+    ctx.adaptive_rto.enabled = false;
+    assert_duration_ms(_avs_coap_udp_current_rto(&ctx), 2000);
+    ASSERT_EQ(_avs_coap_udp_backoff_factor(&ctx), 2.0);
+    avs_crypto_prng_free(&ctx.base.prng_ctx);
+}
+
+AVS_UNIT_TEST(udp_tx_params, adaptive_rto_exchange_lifetime) {
+    avs_coap_udp_ctx_t ctx = {
+        .tx_params = DETERMINISTIC_TX_PARAMS
+    };
+    avs_coap_udp_tx_params_t tx_params =
+            _avs_coap_udp_effective_tx_params(&ctx);
+    // MAX_TRANSMIT_SPAN = 2s * 15; EXCHANGE_LIFETIME = 30s + 200s + 2s
+    assert_duration_ms(avs_coap_udp_max_transmit_span(&tx_params), 30000);
+    assert_duration_ms(avs_coap_udp_exchange_lifetime(&tx_params), 232000);
+
+    // with adaptive RTO, the estimate may grow up to 60 seconds, so the
+    // derived values need to be based on that
+    ctx.adaptive_rto.enabled = true;
+    _avs_coap_udp_adaptive_rto_reset(&ctx.adaptive_rto, &ctx.tx_params);
+    tx_params = _avs_coap_udp_effective_tx_params(&ctx);
+    assert_duration_ms(tx_params.ack_timeout, 60000);
+    AVS_UNIT_ASSERT_EQUAL(tx_params.max_retransmit,
+                          DETERMINISTIC_TX_PARAMS.max_retransmit);
+    // MAX_TRANSMIT_SPAN = 60s * 15; EXCHANGE_LIFETIME = 900s + 200s + 60s
+    assert_duration_ms(avs_coap_udp_max_transmit_span(&tx_params), 900000);
+    assert_duration_ms(avs_coap_udp_exchange_lifetime(&tx_params), 1160000);
+
+    // larger ACK_TIMEOUT is never lowered
+    ctx.tx_params.ack_timeout = avs_time_duration_from_scalar(90, AVS_TIME_S);
+    tx_params = _avs_coap_udp_effective_tx_params(&ctx);
+    assert_duration_ms(tx_params.ack_timeout, 90000);
+}
+
 static void assert_tx_params_equal(const avs_coap_udp_tx_params_t *actual,
                                    const avs_coap_udp_tx_params_t *expected) {
     AVS_UNIT_ASSERT_EQUAL(actual->ack_timeout.seconds,
@@ -460,4 +544,26 @@ AVS_UNIT_TEST(udp_tx_params, nstart_decrease) {
     ASSERT_OK(avs_coap_async_handle_incoming_packet(env.coap_ctx, NULL, NULL));
 }
 
+AVS_UNIT_TEST(udp_tx_params, setting_tx_params_resets_adaptive_rto) {
+    test_env_t env __attribute__((cleanup(test_teardown))) =
+            test_setup_with_nstart(1);
+    avs_coap_udp_ctx_t *udp_ctx = (avs_coap_udp_ctx_t *) env.coap_ctx;
+    ASSERT_OK(avs_coap_udp_ctx_set_adaptive_rto(env.coap_ctx, true));
+
+    _avs_coap_udp_adaptive_rto_update(
+            &udp_ctx->adaptive_rto,
+            avs_time_duration_from_scalar(100, AVS_TIME_MS), 0);
+    ASSERT_TRUE(udp_ctx->adaptive_rto.strong.initialized);
+
+    avs_coap_udp_tx_params_t tx_params = AVS_COAP_DEFAULT_UDP_TX_PARAMS;
+    tx_params.ack_timeout = avs_time_duration_from_scalar(5, AVS_TIME_S);
+    ASSERT_OK(avs_coap_udp_ctx_set_tx_params(env.coap_ctx, &tx_params));
+
+    // measurements made with the previous parameters are discarded
+    ASSERT_TRUE(udp_ctx->adaptive_rto.enabled);
+    ASSERT_FALSE(udp_ctx->adaptive_rto.strong.initialized);
+    ASSERT_FALSE(udp_ctx->adaptive_rto.weak.initialized);
+    assert_duration_ms(_avs_coap_udp_current_rto(udp_ctx), 5000);
+}
+
 #endif // defined(AVS_UNIT_TESTING) && defined(WITH_AVS_COAP_UDP)
@@ -47,6 +47,10 @@ struct coap_msg_args {
     const avs_coap_option_block_t block1;
     const avs_coap_option_block_t block2;
 #    endif // WITH_AVS_COAP_BLOCK
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+    bool q_block1;
+    bool q_block2;
+#    endif // WITH_AVS_COAP_Q_BLOCK
 
     const void *payload;
     size_t payload_size;
@@ -98,6 +102,14 @@ coap_msg__(uint8_t *buf, size_t buf_size, const struct coap_msg_args *args) {
         ASSERT_OK(avs_coap_options_add_block(&opts, &args->block2));
     }
 #    endif // WITH_AVS_COAP_BLOCK
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+    if (args->q_block1) {
+        ASSERT_OK(_avs_coap_options_convert_to_q_block(&opts, AVS_COAP_BLOCK1));
+    }
+    if (args->q_block2) {
+        ASSERT_OK(_avs_coap_options_convert_to_q_block(&opts, AVS_COAP_BLOCK2));
+    }
+#    endif // WITH_AVS_COAP_Q_BLOCK
 
     if (args->content_format) {
         ASSERT_OK(avs_coap_options_set_content_format(&opts,
@@ -193,6 +205,20 @@ coap_msg__(uint8_t *buf, size_t buf_size, const struct coap_msg_args *args) {
 /* Used in COAP_MSG() to define message ID. */
 #    define ID(MsgId) .id = (MsgId)
 
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+/* Same as BLOCK1_REQ(), but uses the Q-Block1 option instead. */
+#        define Q_BLOCK1_REQ(Seq, Size, ... /* Payload */) \
+            BLOCK1_REQ((Seq), (Size), __VA_ARGS__), .q_block1 = true
+
+/* Same as BLOCK2_REQ(), but uses the Q-Block2 option instead. */
+#        define Q_BLOCK2_REQ(Seq, Size) \
+            BLOCK2_REQ((Seq), (Size)), .q_block2 = true
+
+/* Same as BLOCK2_RES(), but uses the Q-Block2 option instead. */
+#        define Q_BLOCK2_RES(Seq, Size, ... /* Payload */) \
+            BLOCK2_RES((Seq), (Size), __VA_ARGS__), .q_block2 = true
+#    endif // WITH_AVS_COAP_Q_BLOCK
+
 /* Used in COAP_MSG() to specify ETag option value. */
 #    define ETAG(Tag)                \
         .etag = &(avs_coap_etag_t) { \
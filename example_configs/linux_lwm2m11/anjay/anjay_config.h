@@ -76,6 +76,16 @@
  */
 #define ANJAY_WITH_TRACE_LOGS
 
+/**
+ * Store log messages from the hot paths of request and notification handling
+ * in binary form in a ring buffer instead of formatting them. They can be
+ * retrieved with <c>anjay_deferred_log_read()</c> and decoded offline with
+ * <c>tools/anjay_deferred_log_decode.py</c>.
+ *
+ * Requires <c>ANJAY_WITH_LOGS</c> to be enabled.
+ */
+/* #undef ANJAY_WITH_DEFERRED_LOGS */
+
 /**
  * Enable core support for Access Control mechanisms.
  *
@@ -144,6 +154,71 @@
  */
 #define ANJAY_WITH_NET_STATS
 
+/**
+ * Enable support for listing pending scheduler jobs of Anjay and measuring
+ * the number and run time of their executions
+ * (<c>anjay_get_pending_sched_jobs()</c> and
+ * <c>anjay_get_sched_job_stats()</c> APIs).
+ */
+/* #undef ANJAY_WITH_SCHED_STATS */
+
+/**
+ * Enable collecting per-server counters and latency histograms of LwM2M
+ * operations (<c>anjay_get_operation_stats()</c> API).
+ *
+ * The statistics are always updated with the Anjay mutex already held, so no
+ * additional locking is involved. Each operation adds a few reads of the
+ * monotonic clock.
+ */
+/* #undef ANJAY_WITH_OPERATION_STATS */
+
+/**
+ * Enable attributing the amount of LwM2M traffic to kinds of LwM2M operations,
+ * Content-Formats and Objects (<c>anjay_get_operation_traffic_stats()</c>,
+ * <c>anjay_get_content_format_traffic_stats()</c> and
+ * <c>anjay_get_object_traffic_stats()</c> APIs).
+ *
+ * Each exchange adds a few socket option queries, to read the byte counters of
+ * the socket before and after it.
+ *
+ * Requires <c>ANJAY_WITH_NET_STATS</c> to be enabled.
+ */
+/* #undef ANJAY_WITH_TRAFFIC_STATS */
+
+/**
+ * Enable static tracepoints (SystemTap SDT, also known as USDT probes) in the
+ * request handling, data model, notification, registration and download code
+ * paths, for use with tools such as bpftrace, perf or LTTng. See
+ * <c>src/core/anjay_tracepoints.h</c> for the list of tracepoints.
+ *
+ * Each tracepoint compiles to a single NOP instruction, plus evaluation of its
+ * arguments. Requires the <c>sys/sdt.h</c> header.
+ */
+/* #undef ANJAY_WITH_TRACEPOINTS */
+
+/**
+ * Enable collecting heap usage statistics, broken down by the Anjay subsystem
+ * that made each allocation (<c>anjay_get_memory_stats()</c> API).
+ *
+ * When enabled, Anjay provides the implementation of <c>avs_malloc()</c>,
+ * <c>avs_calloc()</c>, <c>avs_realloc()</c> and <c>avs_free()</c>, on top of
+ * the standard C library allocator, so avs_commons MUST be configured without
+ * <c>AVS_COMMONS_UTILS_WITH_STANDARD_ALLOCATOR</c> and
+ * <c>AVS_COMMONS_UTILS_WITH_ALIGNFIX_ALLOCATOR</c>. Every allocation is then
+ * prefixed with a small header.
+ */
+/* #undef ANJAY_WITH_MEMORY_ACCOUNTING */
+
+/**
+ * Enable counting heap allocations and allocated bytes per Anjay call site
+ * (<c>anjay_get_allocation_sites()</c> and
+ * <c>anjay_dump_allocation_sites()</c> APIs), on top of the per-subsystem
+ * statistics.
+ *
+ * Requires <c>ANJAY_WITH_MEMORY_ACCOUNTING</c> to be enabled.
+ */
+/* #undef ANJAY_WITH_ALLOCATION_PROFILING */
+
 /**
  * Enable support for communication timestamp
  * (<c>anjay_get_server_last_registration_time()</c>
@@ -152,11 +227,50 @@
  */
 #define ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
 
+/**
+ * Enable support for measuring the duration of startup phases
+ * (<c>anjay_get_startup_timestamps()</c> and
+ * <c>anjay_get_server_startup_timestamps()</c> APIs).
+ */
+/* #undef ANJAY_WITH_STARTUP_TIMESTAMP_API */
+
 /**
  * Enable support for the <c>anjay_resource_observation_status()</c> API.
  */
 #define ANJAY_WITH_OBSERVATION_STATUS
 
+/**
+ * Enable support for persisting the DTLS session state of server connections
+ * (<c>anjay_dtls_sessions_persist()</c> and
+ * <c>anjay_dtls_sessions_restore()</c> APIs), so that the sessions can be
+ * resumed with an abbreviated handshake after a reboot.
+ *
+ * Requires <c>AVS_COMMONS_WITH_AVS_PERSISTENCE</c> to be enabled in
+ * avs_commons.
+ */
+/* #undef ANJAY_WITH_DTLS_SESSION_PERSISTENCE */
+
+/**
+ * Enable support for persisting the state of observations
+ * (<c>anjay_observe_persist()</c> and <c>anjay_observe_restore()</c> APIs).
+ *
+ * Requires <c>ANJAY_WITH_OBSERVE</c> to be enabled,
+ * <c>AVS_COMMONS_WITH_AVS_PERSISTENCE</c> to be enabled in avs_commons, and
+ * <c>WITH_AVS_COAP_OBSERVE_PERSISTENCE</c> to be enabled in avs_coap
+ * configuration.
+ */
+/* #undef ANJAY_WITH_OBSERVE_PERSISTENCE */
+
+/**
+ * Enable support for persisting the whole state of the client in a single
+ * snapshot (<c>anjay_state_persist()</c> and <c>anjay_state_restore()</c>
+ * APIs), including the state of registrations, for a fast warm boot.
+ *
+ * Requires <c>AVS_COMMONS_WITH_AVS_PERSISTENCE</c> to be enabled in
+ * avs_commons.
+ */
+/* #undef ANJAY_WITH_STATE_PERSISTENCE */
+
 /**
  * Maximum number of servers observing a given Resource listed by
  * <c>anjay_resource_observation_status()</c> function.
@@ -170,6 +284,30 @@
  */
 #define ANJAY_WITH_THREAD_SAFETY
 
+/**
+ * Make <c>anjay_notify_changed()</c> and
+ * <c>anjay_notify_instances_changed()</c> lock-free when called from threads
+ * other than the one running the event loop. The changes are put into a
+ * bounded lock-free queue (see
+ * <c>anjay_configuration_t::notify_change_queue_size</c>) and processed by the
+ * next call to <c>anjay_sched_run()</c> or <c>anjay_serve()</c>. If the queue
+ * is full, the Anjay mutex is taken as usual.
+ *
+ * Requires @ref ANJAY_WITH_THREAD_SAFETY to be enabled, and C11
+ * <c>stdatomic.h</c> header to be available.
+ */
+/* #undef ANJAY_WITH_LOCK_FREE_NOTIFY */
+
+/**
+ * Enable collecting statistics of time spent waiting for and holding the Anjay
+ * mutex, for each function that locks it - i.e. each public API entry point
+ * and each scheduler job. See <c>anjay_get_lock_stats()</c>.
+ *
+ * Requires @ref ANJAY_WITH_THREAD_SAFETY to be enabled. Adds two reads of the
+ * monotonic clock to every locking operation.
+ */
+/* #undef ANJAY_WITH_LOCK_STATS */
+
 /**
  * Enable standard implementation of an event loop.
  *
@@ -187,6 +325,31 @@
  */
 #define ANJAY_WITH_EVENT_LOOP
 
+/**
+ * Use <c>epoll()</c> in the standard event loop instead of <c>poll()</c> or
+ * <c>select()</c>.
+ *
+ * Sockets are registered in the epoll instance persistently, and the
+ * registrations are only updated when the set of sockets changes, so the cost
+ * of each iteration depends on the number of sockets that are ready, and not
+ * on the number of all sockets. Requires Linux, and a socket implementation
+ * for which <c>avs_net_socket_get_system()</c> returns a pointer to a file
+ * descriptor.
+ *
+ * Only meaningful if @ref ANJAY_WITH_EVENT_LOOP is enabled. Mutually
+ * exclusive with @ref ANJAY_WITH_EVENT_LOOP_KQUEUE.
+ */
+/* #undef ANJAY_WITH_EVENT_LOOP_EPOLL */
+
+/**
+ * Use <c>kqueue()</c> in the standard event loop instead of <c>poll()</c> or
+ * <c>select()</c>.
+ *
+ * This is the equivalent of @ref ANJAY_WITH_EVENT_LOOP_EPOLL for BSD systems
+ * and macOS. Only meaningful if @ref ANJAY_WITH_EVENT_LOOP is enabled.
+ */
+/* #undef ANJAY_WITH_EVENT_LOOP_KQUEUE */
+
 /**
  * Enable support for features new to LwM2M protocol version 1.1.
  */
@@ -211,6 +374,15 @@
  */
 #define ANJAY_WITH_SEND
 
+/**
+ * Enable support for storing deferred LwM2M Send requests in a persistent,
+ * user-provided log (<c>anjay_send_persistent_queue_install()</c> API).
+ *
+ * Requires <c>ANJAY_WITH_SEND</c> to be enabled and
+ * <c>AVS_COMMONS_WITH_AVS_PERSISTENCE</c> to be enabled in avs_commons.
+ */
+/* #undef ANJAY_WITH_SEND_PERSISTENCE */
+
 /**
  * Enable support for the SMS binding and the SMS trigger mechanism.
  *
@@ -321,6 +493,36 @@
  */
 #define ANJAY_WITH_CBOR
 
+/**
+ * Encode numeric values in CBOR, SenML CBOR and LwM2M CBOR using the shortest
+ * exact representation: integral values as CBOR integers, and other ones as
+ * half-precision, single-precision or double-precision floats, whichever is the
+ * shortest one that does not lose precision. This noticeably reduces the size
+ * of e.g. notifications carrying sensor readings.
+ *
+ * NOTE: LwM2M Servers need to accept integers in place of floating-point values
+ * of Float Resources, and to support half-precision floats.
+ *
+ * Requires <c>ANJAY_WITH_CBOR</c> to be enabled.
+ */
+/* #undef ANJAY_WITH_CBOR_COMPACT_NUMBERS */
+
+/**
+ * Enable support for generating data in the LwM2M CBOR format, as specified in
+ * LwM2M TS 1.2. It is then used for Read and Observe if the server explicitly
+ * requests it using the Accept option, and for Send if selected using
+ * <c>ANJAY_DEFAULT_SEND_FORMAT</c>. It is never used as the default format, nor
+ * advertised in the Bootstrap-Request, as LwM2M 1.1 servers do not support it
+ * and there is no LwM2M CBOR input context.
+ *
+ * NOTE: LwM2M CBOR is a format defined in LwM2M 1.2, so it shall only be
+ * enabled if the LwM2M Servers used are known to support it. Timestamps are not
+ * encoded, as the format is not capable of representing them.
+ *
+ * Requires <c>ANJAY_WITH_CBOR</c> to be enabled.
+ */
+/* #undef ANJAY_WITH_LWM2M_CBOR */
+
 /**
  * Enable support for Enrollment over Secure Transport.
  *
@@ -451,7 +653,7 @@
  * - @c AVS_COAP_FORMAT_NONE means no default value is used and Anjay will
  *   decide the format based on the what is available.
  * - @c AVS_COAP_FORMAT_OMA_LWM2M_CBOR Anjay will generate a Send message in
- *   LwM2M CBOR format.
+ *   LwM2M CBOR format. Requires <c>ANJAY_WITH_LWM2M_CBOR</c>.
  * - @c AVS_COAP_FORMAT_SENML_CBOR Anjay will generate a Send message in SenML
  *   CBOR format.
  * - @c AVS_COAP_FORMAT_SENML_JSON Anjay will generate a Send message in SenML
@@ -526,6 +728,30 @@
  */
 /* #undef ANJAY_WITH_MODULE_SW_MGMT */
 
+/**
+ * Enable event_log module (implementation of the Event Log object).
+ */
+/* #undef ANJAY_WITH_MODULE_EVENT_LOG */
+
+/**
+ * Enable binary_app_data_container module (implementation of the Binary App
+ * Data Container object).
+ */
+/* #undef ANJAY_WITH_MODULE_BINARY_APP_DATA_CONTAINER */
+
+/**
+ * Enable conn_statistics module (implementation of the Connectivity Statistics
+ * object). Requires ANJAY_WITH_NET_STATS to be enabled.
+ */
+/* #undef ANJAY_WITH_MODULE_CONN_STATISTICS */
+
+/**
+ * Enable lwm2m_gateway module (implementation of the LwM2M Gateway object and
+ * routing of prefixed Uri-Paths to End Device data models). Requires
+ * ANJAY_WITH_LWM2M11 to be enabled.
+ */
+/* #undef ANJAY_WITH_MODULE_LWM2M_GATEWAY */
+
 /**
  * Enables ipso_objects module (generic implementation of basic sensor, three
  * axis sensor and Push Button IPSO objects).
@@ -63,6 +63,16 @@
  */
 #define WITH_AVS_COAP_BLOCK
 
+/**
+ * Enable support for sending request payloads using the Q-Block1 option
+ * (RFC 9177), which allows multiple request blocks to be in flight at once.
+ *
+ * Only meaningful if <c>WITH_AVS_COAP_BLOCK</c> and <c>WITH_AVS_COAP_UDP</c>
+ * are enabled. Q-Block1 also needs to be enabled at runtime for each CoAP/UDP
+ * context, using <c>avs_coap_udp_ctx_set_q_block1()</c>.
+ */
+/* #undef WITH_AVS_COAP_Q_BLOCK */
+
 /**
  * Enable support for observations (RFC 7641).
  */
@@ -140,6 +150,33 @@
  */
 #define AVS_COAP_UDP_NOTIFY_CACHE_SIZE 4
 
+/**
+ * Maximum number of serialized confirmable CoAP/UDP messages kept
+ * for reuse by each context after their exchanges finish. Reusing these
+ * buffers avoids a heap allocation for each message up to
+ * <c>AVS_COAP_UDP_UNCONFIRMED_POOL_MSG_SIZE</c> bytes. Larger messages, and
+ * messages sent while all pooled buffers are in use, are allocated on the
+ * heap. 0 disables the pool.
+ *
+ * Only meaningful if <c>WITH_AVS_COAP_UDP</c> is enabled.
+ *
+ * If editing this file manually, <c>@COAP_UDP_UNCONFIRMED_POOL_SIZE@</c> shall
+ * be replaced with a non-negative integer literal. The default value defined in
+ * CMake build scripts is 4.
+ */
+#define AVS_COAP_UDP_UNCONFIRMED_POOL_SIZE 4
+
+/**
+ * Size of each buffer of the pool described above, in bytes, as the
+ * upper limit of serialized message size.
+ *
+ * If editing this file manually, <c>@COAP_UDP_UNCONFIRMED_POOL_MSG_SIZE@</c>
+ * shall be replaced with a positive integer literal. The default value defined
+ * in CMake build scripts is 1152, which is the message size recommended for
+ * paths with unknown MTU in RFC 7252, 4.6.
+ */
+#define AVS_COAP_UDP_UNCONFIRMED_POOL_MSG_SIZE 1152
+
 /**
  * Enable sending diagnostic payload in error responses.
  */
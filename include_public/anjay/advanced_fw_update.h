@@ -105,6 +105,20 @@ typedef struct {
      * Servers.
      */
     bool prefer_same_socket_downloads;
+
+    /**
+     * Maximum number of Pull-mode downloads, each for a different instance,
+     * that may be performed at the same time. Further downloads are queued
+     * and started as soon as one of the ongoing ones finishes, in order of
+     * the Severity resource of their instances (Critical first), and in order
+     * of request among instances of the same severity.
+     *
+     * Zero (default) is equivalent to 1, i.e. downloads are performed one at
+     * a time. Unless <c>anjay_configuration_t::connection_buffer_pool_size</c>
+     * is set, concurrent CoAP downloads share a single pair of message
+     * buffers.
+     */
+    size_t max_concurrent_downloads;
 #ifdef ANJAY_WITH_SEND
     /**
      * Enables using LwM2M Send to report State, Update Result and Firmware
@@ -951,6 +965,27 @@ void anjay_advanced_fw_update_pull_suspend(anjay_t *anjay);
  *          fails.
  */
 int anjay_advanced_fw_update_pull_reconnect(anjay_t *anjay);
+
+struct anjay_download_stats;
+
+/**
+ * Retrieves statistics of the ongoing PULL-mode download of a given Advanced
+ * Firmware Update object instance. See @ref anjay_download_get_stats for
+ * details.
+ *
+ * @param anjay     Anjay object to operate on.
+ *
+ * @param iid       Instance of Advanced Firmware Update object.
+ *
+ * @param out_stats Structure to fill with the statistics.
+ *
+ * @returns 0 on success, or a negative value if there is no download in
+ *          progress for the given instance.
+ */
+int anjay_advanced_fw_update_get_download_stats(
+        anjay_t *anjay,
+        anjay_iid_t iid,
+        struct anjay_download_stats *out_stats);
 #endif // ANJAY_WITH_DOWNLOADER
 
 #ifdef __cplusplus
@@ -49,7 +49,9 @@ extern "C" {
 
 /**
  * Checks whether the attribute storage has been modified since last successful
- * call to @ref anjay_attr_storage_persist or @ref anjay_attr_storage_restore.
+ * call to @ref anjay_attr_storage_persist, @ref anjay_attr_storage_restore,
+ * @ref anjay_attr_storage_persist_journal or
+ * @ref anjay_attr_storage_restore_journal.
  */
 bool anjay_attr_storage_is_modified(anjay_t *anjay);
 
@@ -87,6 +89,58 @@ avs_error_t anjay_attr_storage_persist(anjay_t *anjay,
  */
 avs_error_t anjay_attr_storage_restore(anjay_t *anjay, avs_stream_t *in_stream);
 
+/**
+ * Appends a journal batch describing the changes made since the last
+ * successful call to @ref anjay_attr_storage_persist,
+ * @ref anjay_attr_storage_restore, @ref anjay_attr_storage_persist_journal or
+ * @ref anjay_attr_storage_restore_journal to the @p out_stream.
+ *
+ * Only the attributes of Objects that actually changed are written, so this
+ * is usually much cheaper than @ref anjay_attr_storage_persist, both in terms
+ * of time and of the amount of data written. Nothing is written if there are
+ * no changes.
+ *
+ * The intended usage is to keep a full snapshot written by
+ * @ref anjay_attr_storage_persist, and a separate journal to which this
+ * function appends. On startup, the snapshot shall be restored using
+ * @ref anjay_attr_storage_restore, followed by the journal restored using
+ * @ref anjay_attr_storage_restore_journal. The journal may be compacted at any
+ * time by writing a new snapshot using @ref anjay_attr_storage_persist and
+ * truncating the journal, e.g. when
+ * @ref anjay_attr_storage_journal_records grows too large.
+ *
+ * @param anjay         Anjay instance.
+ * @param out_stream    Stream to append to.
+ * @returns AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_attr_storage_persist_journal(anjay_t *anjay,
+                                               avs_stream_t *out_stream);
+
+/**
+ * Applies all the journal batches written by
+ * @ref anjay_attr_storage_persist_journal and read from @p in_stream until its
+ * end, on top of the current state of the Attribute Storage.
+ *
+ * @param anjay     Anjay instance.
+ * @param in_stream Stream to read from.
+ * @returns AVS_OK in case of success, or an error code.
+ *
+ * NOTE: if restoration fails, then the Attribute Storage will be untouched.
+ */
+avs_error_t anjay_attr_storage_restore_journal(anjay_t *anjay,
+                                               avs_stream_t *in_stream);
+
+/**
+ * Returns the number of journal records written by
+ * @ref anjay_attr_storage_persist_journal or read by
+ * @ref anjay_attr_storage_restore_journal since the last successful call to
+ * @ref anjay_attr_storage_persist or @ref anjay_attr_storage_restore. It may be
+ * used to decide when to compact the journal.
+ *
+ * @param anjay Anjay instance.
+ */
+size_t anjay_attr_storage_journal_records(anjay_t *anjay);
+
 /**
  * Sets Object level attributes for the specified @p ssid.
  *
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_BINARY_APP_DATA_CONTAINER_H
+#define ANJAY_INCLUDE_ANJAY_BINARY_APP_DATA_CONTAINER_H
+
+#include <anjay/anjay_config.h>
+#include <anjay/dm.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Reads a part of the contents of a Data Resource Instance (/19/iid/0/riid)
+ * from the storage.
+ *
+ * @param user_ptr Opaque pointer passed as <c>storage_user_ptr</c> in
+ *                 @ref anjay_badc_config_t .
+ *
+ * @param iid      Object Instance ID.
+ *
+ * @param riid     Resource Instance ID.
+ *
+ * @param offset   Offset within the stored contents to read from.
+ *
+ * @param buf      Buffer to read the data into.
+ *
+ * @param size     Number of bytes to read. The module never requests reading
+ *                 beyond the size of the data previously written.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+typedef int anjay_badc_storage_read_t(void *user_ptr,
+                                      anjay_iid_t iid,
+                                      anjay_riid_t riid,
+                                      size_t offset,
+                                      void *buf,
+                                      size_t size);
+
+/**
+ * Writes a part of the contents of a Data Resource Instance to the storage.
+ *
+ * The contents are written incrementally, in chunks of a few hundred bytes at
+ * most, with increasing @p offset . A write at offset 0 starts new contents of
+ * the Resource Instance - previously stored data may be discarded at that
+ * point.
+ *
+ * @param user_ptr Opaque pointer passed as <c>storage_user_ptr</c> in
+ *                 @ref anjay_badc_config_t .
+ *
+ * @param iid      Object Instance ID.
+ *
+ * @param riid     Resource Instance ID.
+ *
+ * @param offset   Offset within the stored contents to write to.
+ *
+ * @param data     Data to write.
+ *
+ * @param size     Number of bytes to write.
+ *
+ * @returns 0 on success, a negative value in case of error, e.g. if there is no
+ *          more space in the storage.
+ */
+typedef int anjay_badc_storage_write_t(void *user_ptr,
+                                       anjay_iid_t iid,
+                                       anjay_riid_t riid,
+                                       size_t offset,
+                                       const void *data,
+                                       size_t size);
+
+/**
+ * Discards the contents of a Data Resource Instance, after the Resource
+ * Instance has been removed or after a failed write.
+ *
+ * @param user_ptr Opaque pointer passed as <c>storage_user_ptr</c> in
+ *                 @ref anjay_badc_config_t .
+ *
+ * @param iid      Object Instance ID.
+ *
+ * @param riid     Resource Instance ID.
+ */
+typedef void
+anjay_badc_storage_remove_t(void *user_ptr, anjay_iid_t iid, anjay_riid_t riid);
+
+typedef struct {
+    anjay_badc_storage_read_t *read;
+    anjay_badc_storage_write_t *write;
+    anjay_badc_storage_remove_t *remove;
+} anjay_badc_storage_handlers_t;
+
+typedef struct {
+    /**
+     * Handlers of the storage that holds the contents of Data Resource
+     * Instances, e.g. a flash block device or a memory-mapped file. Required.
+     */
+    const anjay_badc_storage_handlers_t *storage_handlers;
+
+    /**
+     * Opaque pointer passed to the @ref anjay_badc_storage_handlers_t
+     * handlers.
+     */
+    void *storage_user_ptr;
+
+    /**
+     * Maximum size of a single Data Resource Instance, in bytes. Writes of
+     * larger data are rejected. If 0, no limit is enforced by the module.
+     */
+    size_t max_data_size;
+} anjay_badc_config_t;
+
+/**
+ * Installs the Binary App Data Container object (OID 19) in an Anjay object.
+ *
+ * Only the sizes of Data Resource Instances are kept in RAM. Their contents
+ * are streamed between the storage and the network in small chunks, so RAM
+ * usage does not depend on the size of the data.
+ *
+ * NOTE: Contents of the storage are not rolled back if a transaction that
+ * modifies the object fails. A Resource Instance whose write has failed is
+ * left empty.
+ *
+ * @param anjay  Anjay object for which the object is installed.
+ *
+ * @param config Configuration of the module. The structure is copied, it does
+ *               not need to be valid after the call.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_badc_install(anjay_t *anjay, const anjay_badc_config_t *config);
+
+/**
+ * Makes contents already present in the storage (e.g. written before a restart
+ * of the application) available as a Data Resource Instance. The Object
+ * Instance is created if it does not exist.
+ *
+ * @param anjay Anjay object with the Binary App Data Container object
+ *              installed.
+ *
+ * @param iid   Object Instance ID.
+ *
+ * @param riid  Resource Instance ID.
+ *
+ * @param size  Size of the stored contents.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_badc_data_add(anjay_t *anjay,
+                        anjay_iid_t iid,
+                        anjay_riid_t riid,
+                        size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANJAY_INCLUDE_ANJAY_BINARY_APP_DATA_CONTAINER_H */
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_CONN_STATISTICS_H
+#define ANJAY_INCLUDE_ANJAY_CONN_STATISTICS_H
+
+#include <anjay/anjay_config.h>
+#include <anjay/dm.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Installs the Connectivity Statistics object (OID 7) with a single Instance 0
+ * in an Anjay object.
+ *
+ * Values of the object are computed from the statistics that Anjay collects
+ * for all its connections (see <c>anjay/stats.h</c>), so no additional
+ * bookkeeping is necessary on the application side:
+ *
+ * - Tx Data and Rx Data are derived from @ref anjay_get_tx_bytes and
+ *   @ref anjay_get_rx_bytes,
+ * - Average Message Size is derived from @ref anjay_get_total_messages_size,
+ *   @ref anjay_get_num_sent_messages and
+ *   @ref anjay_get_num_received_messages,
+ * - Max Message Size is @ref anjay_get_max_message_size - note that, unlike
+ *   other resources, it is not limited to the collection period, as the
+ *   maximum cannot be derived from monotonic counters.
+ *
+ * All values are 0 until the Start resource is executed, and are frozen after
+ * the Stop resource is executed or, if Collection Period is set, once it
+ * elapses. SMS Tx/Rx Counter resources are not supported.
+ *
+ * @param anjay Anjay object for which the object is installed.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_conn_statistics_install(anjay_t *anjay);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANJAY_INCLUDE_ANJAY_CONN_STATISTICS_H */
@@ -238,6 +238,36 @@ anjay_server_conn_status_t
 anjay_get_server_connection_status(anjay_t *anjay, anjay_ssid_t ssid);
 #endif // ANJAY_WITH_CONN_STATUS_API
 
+/**
+ * Single job dispatched by @ref anjay_parallel_executor_t.
+ *
+ * @param job_arg Opaque argument passed to the executor
+ *
+ * @param index   Index of the job, in the range [0, count)
+ */
+typedef void anjay_parallel_job_t(void *job_arg, size_t index);
+
+/**
+ * Function that runs @p count jobs, possibly concurrently, e.g. on a thread
+ * pool maintained by the application. Each job shall be run exactly once, as
+ * <c>job(job_arg, index)</c> for each index in the range [0, count), and the
+ * function shall not return before all of them finish.
+ *
+ * @param executor_arg Opaque argument as set through the
+ *                     <c>transaction_validate_executor_arg</c> field in
+ *                     @ref anjay_configuration_t
+ *
+ * @param count        Number of jobs to run
+ *
+ * @param job          Function to call for each job
+ *
+ * @param job_arg      Opaque argument to pass to @p job
+ */
+typedef void anjay_parallel_executor_t(void *executor_arg,
+                                       size_t count,
+                                       anjay_parallel_job_t *job,
+                                       void *job_arg);
+
 typedef struct anjay_configuration {
     /**
      * Endpoint name as presented to the LwM2M server. Must be non-NULL, or
@@ -286,6 +316,62 @@ typedef struct anjay_configuration {
      */
     size_t msg_cache_size;
 
+    /**
+     * If nonzero, each CoAP context (i.e. each LwM2M Server connection and
+     * each CoAP download) uses its own pair of input and output buffers, of
+     * sizes specified by <c>in_buffer_size</c> and <c>out_buffer_size</c>,
+     * instead of the pair shared by the whole Anjay object. This allows e.g.
+     * streaming operations on different connections to be in progress at the
+     * same time.
+     *
+     * Buffers are allocated when a CoAP context is created. Up to this number
+     * of buffer pairs no longer in use are kept allocated for reuse; the rest
+     * is freed as soon as the CoAP context using them is destroyed.
+     *
+     * If set to 0 (default), all CoAP contexts share a single pair of buffers.
+     */
+    size_t connection_buffer_pool_size;
+
+    /**
+     * If nonzero and smaller than <c>in_buffer_size</c>, the input buffer
+     * shared by all CoAP contexts is initially allocated with this size. It
+     * grows, up to <c>in_buffer_size</c>, after a CoAP/UDP message that does
+     * not fit in it is received, and shrinks back after a period without such
+     * demand. The message that triggered the growth is handled as with a small
+     * buffer, i.e. it is answered with 4.13 Request Entity Too Large so that
+     * the peer may retry using a block-wise transfer.
+     *
+     * Ignored if <c>connection_buffer_pool_size</c> is nonzero.
+     *
+     * If set to 0 (default), the buffer is always allocated at full size.
+     */
+    size_t in_buffer_min_size;
+
+    /**
+     * If nonzero and smaller than <c>out_buffer_size</c>, the output buffer
+     * shared by all CoAP contexts is initially allocated with this size. It
+     * grows, up to <c>out_buffer_size</c>, after a payload had to be split
+     * into blocks that would have been larger with a larger buffer, and
+     * shrinks back after a period without such demand. The block size of a
+     * transfer already in progress is not changed.
+     *
+     * Ignored if <c>connection_buffer_pool_size</c> is nonzero.
+     *
+     * If set to 0 (default), the buffer is always allocated at full size.
+     */
+    size_t out_buffer_min_size;
+
+    /**
+     * If nonzero and smaller than <c>msg_cache_size</c>, the CoAP response
+     * cache is initially allocated with this size. It grows, up to
+     * <c>msg_cache_size</c>, when storing a response would otherwise require
+     * dropping ones that have not expired yet, and shrinks back once all
+     * cached responses expire.
+     *
+     * If set to 0 (default), the cache is always allocated at full size.
+     */
+    size_t msg_cache_min_size;
+
     /**
      * Socket configuration to use when creating TCP/UDP sockets.
      *
@@ -382,6 +468,338 @@ typedef struct anjay_configuration {
      */
     size_t stored_notification_limit;
 
+    /**
+     * Limit of the estimated amount of memory, in bytes, occupied by
+     * notifications queued to be sent later, across all servers. It is
+     * enforced independently from <c>stored_notification_limit</c>.
+     *
+     * If set to 0 (default), memory usage of the queue is not limited.
+     *
+     * If set to a positive value, queuing a notification that would exceed the
+     * limit drops the oldest queued notifications until it fits, preferring
+     * ones that are not meant to be sent as Confirmable. Error notifications
+     * and notifications that are being sent at the moment are never dropped.
+     * A single notification larger than the limit is still queued.
+     *
+     * See also @ref anjay_get_notification_queue_usage.
+     */
+    size_t stored_notification_memory_limit;
+
+    /**
+     * If set to true, values sampled from the data model for the purpose of
+     * sending notifications are shared between all observations of the same
+     * path and kind (e.g. observations of that path made by different LwM2M
+     * Servers) that are processed within a single iteration of the scheduler.
+     * This limits the number of calls to read handlers in multi-server
+     * deployments.
+     *
+     * If Access Control is in effect, values are only shared between
+     * observations made by the same Server.
+     *
+     * Shared values are dropped whenever @ref anjay_notify_changed or
+     * @ref anjay_notify_instances_changed is called for the affected Object,
+     * so that changes reported within the same scheduler iteration are never
+     * missed. All shared values are also dropped at the end of each
+     * @ref anjay_serve call, as the request it handled may have changed the
+     * data model.
+     */
+    bool share_observation_samples;
+
+    /**
+     * If set to true, automatic notification triggers (resulting from the
+     * pmin and pmax attributes) of all observations made over a single
+     * connection are handled by a single scheduler job, which processes all
+     * observations that are due at once, instead of a separate job being
+     * scheduled for each observation. This limits scheduler overhead when
+     * there are many observations with similar periods.
+     */
+    bool coalesce_observation_triggers;
+
+    /**
+     * Only meaningful if <c>coalesce_observation_triggers</c> is enabled.
+     * Maximum time by which each automatic notification trigger may be
+     * delayed, so that it can be handled together with other ones that are
+     * due later. Greater values result in fewer wakeups, which is mostly
+     * beneficial for devices operating in queue mode, at the expense of
+     * notifications being sent up to that much later than the pmin and pmax
+     * attributes would otherwise dictate.
+     *
+     * Zero (default) means that only triggers that are due at the exact same
+     * time are coalesced.
+     */
+    avs_time_duration_t observation_trigger_slack;
+
+    /**
+     * If set to a positive value, changes reported using
+     * @ref anjay_notify_changed, @ref anjay_notify_changed_multiple,
+     * @ref anjay_notify_instances_changed and similar functions are not
+     * processed during the next @ref anjay_sched_run call, but at most this
+     * much later, counting from the first change reported since the last
+     * processing. All changes reported in the meantime are processed at once,
+     * so that e.g. a burst of sensor readings results in evaluating the
+     * observations only once.
+     *
+     * The window may be overridden for specific paths using
+     * @ref anjay_set_notify_debounce . Changes made by LwM2M Servers are not
+     * affected.
+     *
+     * Zero or invalid value (default) disables debouncing.
+     */
+    avs_time_duration_t notify_debounce_window;
+
+    /**
+     * If set to true, queuing a new notification for an observation that
+     * already has a notification waiting to be sent replaces the older one,
+     * so that only the newest value of each observation is sent when the
+     * queue is flushed (e.g. after reconnecting to the server). Notifications
+     * that are already being delivered are not affected.
+     *
+     * NOTE: This means that historical values are not reported to the server,
+     * even if the Notification Storing When Disabled or Offline Resource is
+     * set to true.
+     */
+    bool merge_queued_notifications;
+
+    /**
+     * Maximum number of queued notifications sent within a single scheduler
+     * job when flushing the notification queue. Sending a notification whose
+     * delivery is confirmed asynchronously (i.e. a Confirmable one) always ends
+     * the burst, and the next one is sent after the delivery is confirmed.
+     *
+     * Zero (default) is treated the same as 1, i.e. each queued notification
+     * is sent in a separate scheduler job.
+     */
+    size_t notification_flush_burst;
+
+    /**
+     * If set to true, the payload of each notification is serialized in full
+     * into a buffer when it is first needed, and subsequent blocks of a
+     * block-wise transfer are copied from that buffer. This allows serving the
+     * blocks in any order (e.g. when the server requests the same block again)
+     * at the expense of holding the whole serialized payload in memory until
+     * the delivery is finished.
+     *
+     * If set to false (default), the payload is serialized on the fly as the
+     * consecutive blocks are sent, and requesting blocks out of order causes
+     * the notification to fail.
+     */
+    bool cache_notification_payload;
+
+    /**
+     * If set to true, the effective attributes of each observed path are
+     * determined once and remembered by the observation, instead of being
+     * resolved through the data model (presence checks and calls to the
+     * attribute read handlers on all levels) every time a notification is
+     * scheduled or evaluated.
+     *
+     * Remembered attributes are dropped whenever attributes are written by a
+     * server, whenever Attribute Storage is modified, and whenever
+     * @ref anjay_notify_changed or @ref anjay_notify_instances_changed is
+     * called for the affected Object or the Server Object. Applications that
+     * implement attribute handlers themselves and change the attributes by
+     * other means shall call one of these functions afterwards.
+     */
+    bool cache_observation_attrs;
+
+    /**
+     * If set to true, values of the Server Object resources that are consulted
+     * on hot paths (Default Minimum Period, Default Maximum Period and, if
+     * LwM2M 1.1 support is compiled in, the Communication Retry resources) are
+     * read from the data model once per Server and remembered. The Short Server
+     * IDs of all Server Object Instances, and the Short Server IDs and
+     * Bootstrap-Server flags of all Security Object Instances, are remembered
+     * as well, so that mapping between these identifiers, done e.g. on each
+     * server activation and Access Control check, does not query the data
+     * model each time.
+     *
+     * Remembered values are dropped whenever the Server or Security Object,
+     * respectively, is written by a server or through
+     * @ref anjay_server_object_restore and similar APIs that notify the
+     * library, and whenever @ref anjay_notify_changed or
+     * @ref anjay_notify_instances_changed is called for it. Applications that
+     * implement these Objects themselves and modify them by other means shall
+     * call one of these functions afterwards.
+     */
+    bool cache_server_params;
+
+    /**
+     * If set to a positive value, LwM2M Send requests (see @ref anjay_send and
+     * @ref anjay_send_deferrable) are not sent immediately. Instead, all the
+     * batches submitted within this time window for the same server are merged
+     * into a single Send message, with a single base name and base time where
+     * the Content-Format allows it. This reduces the number of messages for
+     * applications that send small batches frequently.
+     *
+     * Finished handlers are still called separately for each submitted batch,
+     * with the result of delivering the merged message.
+     *
+     * Zero or invalid value (default) disables coalescing.
+     *
+     * NOTE: This option is only meaningful if LwM2M Send support is compiled
+     * in.
+     */
+    avs_time_duration_t send_coalescing_window;
+
+    /**
+     * Only meaningful if <c>send_coalescing_window</c> is enabled. Estimated
+     * size of the payload, in bytes, above which the pending batches for a
+     * given server are sent before the coalescing window expires. Batches that
+     * would make a merged message exceed this size are sent in a separate one.
+     *
+     * Zero (default) means no limit.
+     */
+    size_t send_coalescing_max_payload_size;
+
+    /**
+     * If set to a positive value, enables a token bucket rate limiter for LwM2M
+     * Send requests, separate for each server. The value is the average rate,
+     * in bytes of estimated payload size per second, at which requests other
+     * than the ones sent with @ref ANJAY_SEND_PRIORITY_URGENT are allowed to be
+     * sent. Requests exceeding the limit are held back, in order of priority,
+     * until enough tokens are accumulated. This leaves the remaining bandwidth
+     * of slow links to other traffic, such as notifications.
+     *
+     * Zero (default) disables rate limiting.
+     *
+     * NOTE: This option is only meaningful if LwM2M Send support is compiled
+     * in.
+     */
+    size_t send_rate_limit;
+
+    /**
+     * Only meaningful if <c>send_rate_limit</c> is enabled. Capacity of the
+     * token bucket, in bytes, i.e. the amount of data that may be sent in a
+     * burst after a period of inactivity. A single message larger than that is
+     * allowed to be sent when the bucket is full.
+     *
+     * Zero (default) means the same value as <c>send_rate_limit</c>.
+     */
+    size_t send_rate_limit_burst;
+
+    /**
+     * If set to a positive value, activities planned for servers with which
+     * the client operates in queue mode are aligned into shared wake windows of
+     * up to this length, so that the radio needs to be powered up fewer times:
+     * - Registration Update is sent earlier if a notification required by the
+     *   Maximum Period attribute is due within this time after it would
+     *   otherwise be sent,
+     * - notifications required by the Maximum Period attribute are sent
+     *   earlier if Registration Update is planned within this time before they
+     *   would otherwise be sent.
+     *
+     * Activities are only ever moved earlier, so the Lifetime and Maximum
+     * Period constraints are always respected. Deferred LwM2M Send requests are
+     * already sent whenever the connection is brought up for any of the above.
+     * See also @ref anjay_next_planned_wake_time.
+     *
+     * Zero or invalid value (default) disables the alignment.
+     */
+    avs_time_duration_t queue_mode_wake_window;
+
+    /**
+     * If set to true, the time for which the socket is kept open after each
+     * interaction with a server operating in queue mode is adapted to the
+     * behaviour of that server, instead of always being MAX_TRANSMIT_WAIT.
+     *
+     * The library measures how long after an interaction the server sends its
+     * next request, if it does so at all while the socket is open. After a few
+     * observed interactions, the socket is closed after twice the longest such
+     * delay recently seen (but not earlier than 2 seconds after the
+     * interaction). MAX_TRANSMIT_WAIT is still used as an upper bound, and the
+     * socket is regularly kept open for the whole MAX_TRANSMIT_WAIT, so that
+     * servers that start responding more slowly are noticed.
+     *
+     * This saves radio-on time if servers usually send their requests shortly
+     * after an interaction or not at all. A request sent by the server later
+     * than expected might not reach the client until the next interaction.
+     *
+     * This setting has no effect if the library is compiled without queue mode
+     * autoclose support.
+     */
+    bool queue_mode_adaptive_close;
+
+    /**
+     * If set to true, the delays between registration retries, determined by
+     * the Communication Retry Timer and Communication Sequence Delay Timer
+     * Resources of the Server object, are randomized. Each retry delay is drawn
+     * using decorrelated exponential backoff, i.e. at random between half of
+     * the Communication Retry Timer and three times the previous delay, and
+     * each sequence delay is drawn between half and the whole Communication
+     * Sequence Delay Timer. The delays never exceed the values mandated by the
+     * LwM2M specification.
+     *
+     * This prevents large fleets of devices from retrying in lockstep after a
+     * server-side outage.
+     */
+    bool randomize_communication_retries;
+
+    /**
+     * If set to a positive value, reconnections of LwM2M server connections
+     * requested using @ref anjay_transport_schedule_reconnect are delayed by a
+     * random time between zero and this value, so that devices reacting to the
+     * same event do not all reconnect at the same time.
+     *
+     * Zero or invalid value (default) means that the reconnection is started
+     * immediately.
+     */
+    avs_time_duration_t reconnect_jitter;
+
+    /**
+     * If set to a positive value, the remote address that a connection to an
+     * LwM2M Server or a CoAP download has been established with is cached for
+     * this time, per hostname, and used for subsequent connections to the same
+     * hostname (e.g. when the socket is reopened in queue mode, on reconnection
+     * or after exiting offline mode) without performing a blocking DNS lookup.
+     * If connecting to a cached address fails, the entry is dropped and the
+     * hostname is resolved again.
+     *
+     * Results of lookups performed by the application itself, e.g. using an
+     * asynchronous resolver, may be added to the same cache, with their actual
+     * TTL, using @ref anjay_dns_cache_put, regardless of this setting.
+     *
+     * Zero or invalid value (default) means that addresses are not cached
+     * after connecting.
+     */
+    avs_time_duration_t dns_cache_lifetime;
+
+    /**
+     * If set, <c>transaction_validate</c> handlers of user-provided Objects
+     * that take part in a single transaction (e.g. a Write-Composite or a
+     * Bootstrap sequence modifying multiple Objects) are called through this
+     * function, so that they may run concurrently, before the transaction is
+     * committed. Handlers of Objects built into Anjay are still called
+     * sequentially. If validation of multiple Objects fails, the error of the
+     * one that joined the transaction first is reported.
+     *
+     * Anjay does not hold its internal lock while the executor runs, so
+     * <c>transaction_validate</c> handlers of different Objects MUST be safe
+     * to call at the same time, from any thread.
+     *
+     * NULL (default) means that all handlers are called sequentially. Only
+     * used if Anjay is compiled with the <c>ANJAY_WITH_THREAD_SAFETY</c>
+     * option.
+     */
+    anjay_parallel_executor_t *transaction_validate_executor;
+
+    /**
+     * Opaque argument that will be passed to the function configured in the
+     * <c>transaction_validate_executor</c> field.
+     */
+    void *transaction_validate_executor_arg;
+
+    /**
+     * If set to a positive value, CoAP retransmissions and other CoAP layer
+     * jobs may be delayed by up to this time, so that they are executed in the
+     * same @ref anjay_sched_run call as other jobs planned shortly after them,
+     * e.g. notifications. This reduces the number of wakeups of devices that
+     * sleep between scheduler runs.
+     *
+     * Zero or invalid value (default) means that CoAP jobs are executed as
+     * soon as they are due. Only used if Anjay is compiled with the
+     * <c>ANJAY_WITH_THREAD_SAFETY</c> option.
+     */
+    avs_time_duration_t coap_sched_slack;
+
     /**
      * Sets the preference of the library for Content-Format used when
      * responding to a request without Accept option.
@@ -393,6 +811,25 @@ typedef struct anjay_configuration {
      */
     bool prefer_hierarchical_formats;
 
+    /**
+     * If set to true, responses to Read and Observe requests without Accept
+     * option are encoded in the Content-Format that yields the smallest
+     * payload. The candidates are Plain Text, TLV and, for LwM2M 1.1, CBOR and
+     * SenML CBOR - as far as they are compiled in and able to represent the
+     * data being read. LwM2M CBOR is never selected, as it requires LwM2M 1.2.
+     *
+     * The sizes are determined by serializing the data in each of the candidate
+     * formats before sending the response. This means that the data needs to
+     * be read in full into memory first, so this option trades CPU time and
+     * memory for smaller payloads, which may be beneficial on constrained
+     * uplinks. Notifications use the same format as the initial response to
+     * the Observe request.
+     *
+     * If set to true, this option takes precedence over
+     * @ref prefer_hierarchical_formats for the requests mentioned above.
+     */
+    bool prefer_compact_formats;
+
     /**
      * Enables support for DTLS connection_id extension for all DTLS
      * connections.
@@ -435,6 +872,130 @@ typedef struct anjay_configuration {
      */
     bool connection_error_is_registration_failure;
 
+    /**
+     * Cache the list of Objects and Object Instances sent in Register and
+     * Update messages, instead of querying the whole data model each time an
+     * Update is about to be sent.
+     *
+     * The cache is invalidated whenever the set of Instances of any Object is
+     * known to change, i.e. on LwM2M Create and Delete operations, and on
+     * @ref anjay_notify_instances_changed calls. When this option is enabled,
+     * it is thus REQUIRED that @ref anjay_notify_instances_changed is called
+     * after every change made by means other than LwM2M - otherwise, stale data
+     * may be sent to the servers.
+     *
+     * Without the cache, payloads longer than 1 KB are not kept in memory at
+     * all - they are generated from the data model again for each block sent.
+     */
+    bool cache_registration_payload;
+
+    /**
+     * Lower the size of messages sent over UDP if large messages are
+     * repeatedly lost while smaller ones get through, which usually indicates
+     * that IP fragments are dropped somewhere on the path. This affects e.g.
+     * the BLOCK size used for large Register and Read responses.
+     *
+     * The detected limit is kept across reconnections to the same server.
+     * See @ref avs_coap_udp_ctx_set_path_mtu_discovery for details.
+     */
+    bool udp_path_mtu_discovery;
+
+    /**
+     * If set to true, the lifetime of the NAT binding on the path to each
+     * LwM2M Server reached over UDP in non-queue mode is estimated, and
+     * Registration Updates - which are sent without any parameters if nothing
+     * changed, making them the cheapest keepalive traffic available - are
+     * scheduled just before the binding is expected to expire, if that is
+     * earlier than mandated by the Lifetime.
+     *
+     * The estimate is lowered to 3/4 of the idle time preceding a request
+     * (Update or confirmable notification) that timed out, and raised to the
+     * idle time preceding a request received from the server. After 8
+     * consecutive successful exchanges it grows again by 1/4, until the
+     * Lifetime becomes the limiting factor again. It is never lower than 15
+     * seconds, and is kept across reconnections to the same server.
+     *
+     * Until the first timeout is observed, Updates are scheduled based only on
+     * the Lifetime.
+     */
+    bool udp_nat_keepalive;
+
+    /**
+     * If nonzero, large requests sent over UDP (e.g. Register or Send) are
+     * transferred using the Q-Block1 option (RFC 9177) instead of BLOCK1, with
+     * up to this number of payload blocks awaiting acknowledgement at once.
+     *
+     * If a server rejects the Q-Block1 option, the request that detected it is
+     * retried using BLOCK1, which is then used for all later requests to that
+     * server. See @ref avs_coap_udp_ctx_set_q_block1 for details.
+     *
+     * Ignored unless avs_coap is compiled with the WITH_AVS_COAP_Q_BLOCK
+     * option.
+     */
+    size_t udp_q_block1_max_payloads;
+
+    /**
+     * If true, CoAP/UDP downloads request the file using the Q-Block2 option
+     * (RFC 9177) instead of BLOCK2, falling back to BLOCK2 if the server
+     * rejects it. See @ref avs_coap_udp_ctx_set_q_block2 for details.
+     *
+     * Read responses are sent using Q-Block2 whenever the LwM2M Server
+     * requests them that way, regardless of this setting.
+     *
+     * Ignored unless avs_coap is compiled with the WITH_AVS_COAP_Q_BLOCK
+     * option.
+     */
+    bool udp_q_block2;
+
+    /**
+     * Compression layer applied to all CoAP/UDP datagrams exchanged with LwM2M
+     * Servers, e.g. @ref AVS_COAP_UDP_STATIC_LWM2M_COMPRESSION . Servers MUST
+     * be configured to use a matching one. If NULL, no compression is used.
+     * See @ref avs_coap_udp_ctx_set_compression for details.
+     */
+    const avs_coap_udp_compression_t *udp_compression;
+
+    /**
+     * Opaque argument passed to the callbacks of <c>udp_compression</c>.
+     */
+    void *udp_compression_arg;
+
+    /**
+     * Size, in bytes, of a buffer preallocated for temporary data used by the
+     * data model code while handling a single request. Such data is released
+     * all at once after the request is handled, which reduces heap
+     * fragmentation on constrained platforms.
+     *
+     * Currently, the buffer is used only for:
+     * - lists of Resources gathered while reading an Instance of an Object
+     *   that implements <c>resource_read_many</c>, for Read and Observe,
+     * - arrays of per-path data sampled for Observe requests and
+     *   notifications.
+     *
+     * Write and Discover, as well as input and output contexts and the values
+     * themselves, still allocate their temporary data on the heap.
+     *
+     * Temporary data that does not fit in the buffer is allocated on the heap
+     * as usual. If set to 0, the buffer is not allocated at all.
+     */
+    size_t request_arena_size;
+
+#ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+    /**
+     * Capacity of the lock-free queue used by @ref anjay_notify_changed and
+     * @ref anjay_notify_instances_changed to report changes without waiting
+     * for the Anjay mutex, e.g. from sensor threads. It is rounded up to the
+     * nearest power of two.
+     *
+     * The queued changes are handled during the next call to
+     * @ref anjay_sched_run or @ref anjay_serve. If the queue is full, the
+     * functions fall back to locking the Anjay mutex.
+     *
+     * If set to 0, a default value of 64 is used.
+     */
+    size_t notify_change_queue_size;
+#endif // ANJAY_WITH_LOCK_FREE_NOTIFY
+
     /**
      * (D)TLS ciphersuites to use if the "DTLS/TLS Ciphersuite" Resource
      * (/0/x/16) is not available or empty.
@@ -484,6 +1045,52 @@ typedef struct anjay_configuration {
      * value of 30s is used.
      */
     avs_time_duration_t coap_tcp_request_timeout;
+
+    /**
+     * Size of the buffer used to coalesce CoAP/TCP messages sent to LwM2M
+     * Servers during a single scheduler run (e.g. multiple notifications), so
+     * that they are written to the socket - and thus encrypted into a TLS
+     * record - together. See @ref avs_coap_tcp_ctx_set_write_coalescing for
+     * details.
+     *
+     * If set to 0, write coalescing is disabled and each message is written to
+     * the socket as soon as it is sent.
+     */
+    size_t coap_tcp_write_coalescing_buffer_size;
+
+    /**
+     * Maximum number of CoAP/TCP messages received from a LwM2M Server and
+     * handled during a single @ref anjay_serve call, so that requests pipelined
+     * by the server do not each require another wakeup of the event loop. See
+     * @ref avs_coap_tcp_ctx_set_receive_budget for details.
+     *
+     * If set to 0, a default value of 8 is used. Setting it to 1 makes Anjay
+     * handle only a single message per call, unless the socket reports more
+     * buffered data.
+     */
+    size_t coap_tcp_receive_budget;
+
+    /**
+     * Maximum time a CoAP/TCP connection to a LwM2M Server may stay idle
+     * before a CoAP Signaling Ping message is sent to check it and to refresh
+     * NAT bindings on the way.
+     *
+     * Any other traffic on the connection (e.g. notifications) postpones the
+     * Ping, and if a Registration Update is due soon, the Ping may be delayed
+     * by up to 1/4 of the interval so that the Update serves as a keepalive
+     * instead.
+     *
+     * If no Pong arrives within @ref coap_tcp_request_timeout , the connection
+     * is considered broken and is reconnected. The idle time after which that
+     * happened is treated as an estimate of the NAT timeout: the interval for
+     * that server is reduced to 3/4 of it (but not below
+     * @ref coap_tcp_request_timeout ). After a number of subsequent successful
+     * Pings, the interval is gradually increased back towards the configured
+     * value.
+     *
+     * If zero-initialized, keepalive Pings are disabled.
+     */
+    avs_time_duration_t coap_tcp_keepalive_interval;
 #endif // defined(WITH_AVS_COAP_TCP) && (defined(ANJAY_WITH_LWM2M11) ||
        // defined(ANJAY_WITH_COAP_DOWNLOAD))
 
@@ -595,6 +1202,16 @@ typedef struct anjay_configuration {
      */
     void *server_connection_status_cb_arg;
 #endif // ANJAY_WITH_CONN_STATUS_API
+
+#ifdef ANJAY_WITH_DEFERRED_LOGS
+    /**
+     * Size, in bytes, of the ring buffer in which log messages from the hot
+     * paths are stored in binary form, see @ref anjay_deferred_log_read .
+     *
+     * If set to 0, the default of 1024 bytes is used.
+     */
+    size_t deferred_log_buffer_size;
+#endif // ANJAY_WITH_DEFERRED_LOGS
 } anjay_configuration_t;
 
 /**
@@ -850,6 +1467,21 @@ typedef uint16_t anjay_riid_t;
  * sending the same request after some delay.
  */
 #define ANJAY_ERR_SERVICE_UNAVAILABLE (-(int) ANJAY_COAP_STATUS(5, 3))
+/**
+ * May be returned by @ref anjay_dm_resource_read_t handlers if the Resource is
+ * temporarily busy, e.g. because obtaining its value has been offloaded to
+ * another thread (such as a slow sensor bus or modem query) that has not
+ * finished yet.
+ *
+ * This is NOT a deferred (separate) response - the request is not kept for
+ * later. A Read or Observe request that encounters it is immediately responded
+ * to with 5.03 Service Unavailable, and it is up to the LwM2M Server to retry
+ * it. A notification that encounters it is not sent, but the observation is
+ * kept. The thread that obtained the value is expected to call
+ * @ref anjay_notify_changed for the Resource in question afterwards, which
+ * triggers the notification again.
+ */
+#define ANJAY_ERR_BUSY (-0xCF0)
 /** @} */
 
 /**
@@ -957,6 +1589,11 @@ void anjay_sched_run(anjay_t *anjay);
  * compatible with <c>poll()</c> or <c>select()</c> through
  * <c>avs_net_socket_get_system()</c>.
  *
+ * If @ref ANJAY_WITH_EVENT_LOOP_EPOLL or @ref ANJAY_WITH_EVENT_LOOP_KQUEUE is
+ * enabled, <c>epoll()</c> or <c>kqueue()</c> is used instead, respectively.
+ * The interrupt semantics and the other guarantees described above remain the
+ * same.
+ *
  * In particular, please be cautious when using SMS or NIDD transports (in
  * versions of Anjay that include the relevant commercial features) - your
  * <c>anjay_smsdrv_system_socket_t</c> and
@@ -1062,6 +1699,11 @@ int anjay_event_loop_interrupt(anjay_t *anjay);
  * is equivalent to <c>anjay_event_loop_run(anjay, max_wait_time)</c>, as long
  * as @ref anjay_event_loop_interrupt is never called.
  *
+ * <c>poll()</c> is used even if @ref ANJAY_WITH_EVENT_LOOP_EPOLL or
+ * @ref ANJAY_WITH_EVENT_LOOP_KQUEUE is enabled, as a kernel event queue would
+ * need to be set up anew on each call. The same applies to
+ * @ref anjay_serve_any_batched .
+ *
  * <strong>CAUTION:</strong> Most of the caveats described in the documentation
  * for @ref anjay_event_loop_run also apply to this function. Please refer there
  * for more information.
@@ -1075,6 +1717,148 @@ int anjay_event_loop_interrupt(anjay_t *anjay);
  *          fatal.
  */
 int anjay_serve_any(anjay_t *anjay, avs_time_duration_t max_wait_time);
+
+/**
+ * Variant of @ref anjay_serve_any optimized for bursts of incoming packets.
+ *
+ * After waiting for any of the sockets to become ready, the Anjay mutex is
+ * locked once, and all readable sockets are served repeatedly, until none of
+ * them has any more data or @p time_budget elapses. Scheduler jobs that are due
+ * are then run, as if by @ref anjay_sched_run.
+ *
+ * This reduces the number of lock acquisitions and system calls when many
+ * packets arrive at once, at the cost of delaying scheduler jobs and other
+ * threads waiting for the mutex by up to @p time_budget.
+ *
+ * <strong>CAUTION:</strong> Most of the caveats described in the documentation
+ * for @ref anjay_event_loop_run also apply to this function. Please refer there
+ * for more information.
+ *
+ * @param anjay         Anjay object to operate on.
+ * @param max_wait_time Maximum time to spend waiting for the sockets.
+ * @param time_budget   Maximum time to spend serving the sockets after waking
+ *                      up. At least one packet from each ready socket is
+ *                      served even if it is zero.
+ *
+ * @returns 0 for success, or a negative value in case of a fatal error. Please
+ *          note that errors from @ref anjay_serve are <em>not</em> considered
+ *          fatal.
+ */
+int anjay_serve_any_batched(anjay_t *anjay,
+                            avs_time_duration_t max_wait_time,
+                            avs_time_duration_t time_budget);
+
+/**
+ * Event loop that serves multiple Anjay objects in a single thread.
+ *
+ * Sockets of all the member instances are combined into a single
+ * <c>poll()</c>, <c>select()</c> or kernel event queue wait, limited by the
+ * nearest scheduler job of any of them. This allows running a large number of
+ * Anjay objects (e.g. one per downstream device of a gateway) without
+ * dedicating a thread to each.
+ *
+ * To distribute the instances across a fixed pool of worker threads, create
+ * one group per thread, run each of them with
+ * @ref anjay_event_loop_group_run in its own thread, and add new instances to
+ * the group for which @ref anjay_event_loop_group_size returns the lowest
+ * value. Anjay itself never creates any threads.
+ */
+typedef struct anjay_event_loop_group_struct anjay_event_loop_group_t;
+
+/**
+ * Creates a new, empty event loop group.
+ *
+ * @returns Created group, or NULL in case of an out-of-memory condition.
+ */
+anjay_event_loop_group_t *anjay_event_loop_group_new(void);
+
+/**
+ * Destroys an event loop group. Any instances that are still its members are
+ * removed from it first.
+ *
+ * The group must not be running while calling this function.
+ *
+ * @param group Group to destroy. NULL is a no-op.
+ */
+void anjay_event_loop_group_delete(anjay_event_loop_group_t *group);
+
+/**
+ * Adds an Anjay object to the group.
+ *
+ * The instance is from now on considered to have its event loop running, so
+ * @ref anjay_event_loop_run and @ref anjay_event_loop_group_add for another
+ * group will fail for it until it is removed. @ref anjay_event_loop_interrupt
+ * has no effect on member instances.
+ *
+ * This function may be called while the group is running in another thread if
+ * @ref ANJAY_WITH_THREAD_SAFETY is enabled. It must not be called from within
+ * any callbacks executed by the group's event loop.
+ *
+ * @param group Group to operate on.
+ * @param anjay Anjay object to add.
+ *
+ * @returns 0 on success, or a negative value if the Anjay object already has
+ *          an event loop running, or in case of an out-of-memory condition.
+ */
+int anjay_event_loop_group_add(anjay_event_loop_group_t *group,
+                               anjay_t *anjay);
+
+/**
+ * Removes an Anjay object from the group.
+ *
+ * When this function returns, the group's event loop is guaranteed not to
+ * access the instance anymore, so it is safe to delete it, or run it using
+ * @ref anjay_event_loop_run. The same concurrency rules as for
+ * @ref anjay_event_loop_group_add apply.
+ *
+ * @param group Group to operate on.
+ * @param anjay Anjay object to remove.
+ *
+ * @returns 0 on success, or a negative value if the Anjay object is not a
+ *          member of the group.
+ */
+int anjay_event_loop_group_remove(anjay_event_loop_group_t *group,
+                                  anjay_t *anjay);
+
+/**
+ * @param group Group to query.
+ *
+ * @returns Number of Anjay objects that are currently members of the group.
+ */
+size_t anjay_event_loop_group_size(anjay_event_loop_group_t *group);
+
+/**
+ * Runs the event loop for all members of the group, until interrupted with
+ * @ref anjay_event_loop_group_interrupt.
+ *
+ * This is equivalent to running @ref anjay_event_loop_run for each member in
+ * a separate thread, except that all of them are handled in the calling one.
+ * Running a group that has no members is allowed - it will just wait until
+ * some are added or the loop is interrupted.
+ *
+ * @param group         Group to operate on.
+ * @param max_wait_time Maximum time to spend waiting for socket events in each
+ *                      iteration. This also limits the latency of picking up
+ *                      newly added instances and scheduler jobs added from
+ *                      other threads.
+ *
+ * @returns 0 after having been successfully interrupted, or a negative value
+ *          in case of a fatal error.
+ */
+int anjay_event_loop_group_run(anjay_event_loop_group_t *group,
+                               avs_time_duration_t max_wait_time);
+
+/**
+ * Interrupts an ongoing execution of @ref anjay_event_loop_group_run. The same
+ * semantics as for @ref anjay_event_loop_interrupt apply.
+ *
+ * @param group Group to operate on.
+ *
+ * @returns 0 if the interrupt has been successfully raised, or a negative value
+ *          if the event loop is either not running or already in the process of
+ *          finishing due to a previous interrupt.
+ */
+int anjay_event_loop_group_interrupt(anjay_event_loop_group_t *group);
 #endif // ANJAY_WITH_EVENT_LOOP
 
 /**
@@ -1373,6 +2157,37 @@ int anjay_transport_set_online(anjay_t *anjay,
 int anjay_transport_schedule_reconnect(anjay_t *anjay,
                                        anjay_transport_set_t transport_set);
 
+/**
+ * Rebinds sockets associated with all servers over the specified transports,
+ * continuing their existing DTLS sessions and registrations. Should be called
+ * instead of @ref anjay_transport_schedule_reconnect if only the local IP
+ * address or network interface has changed, e.g. on mobility events.
+ *
+ * For each online DTLS-over-UDP server connection, the socket is rebound and
+ * reconnected in place during the next @ref anjay_sched_run call. If
+ * <c>use_connection_id</c> is enabled in @ref anjay_configuration_t and the
+ * session is continued using the DTLS Connection ID, no handshake is
+ * performed and no Register or Update message is sent; exchanges that are in
+ * progress, such as confirmable notifications, continue over the new binding.
+ *
+ * All other connections - i.e. ones that do not use DTLS, for which Connection
+ * ID is disabled, or for which the session could not be resumed - are
+ * reconnected in the same way as with @ref anjay_transport_schedule_reconnect .
+ * Suspended connections (e.g. in queue mode) are not affected, as they will be
+ * reconnected when necessary anyway. Ongoing downloads over the specified
+ * transports are reconnected.
+ *
+ * Unlike @ref anjay_transport_schedule_reconnect , this function does not
+ * change the online or offline state of any transport.
+ *
+ * @param anjay         Anjay object to operate on.
+ * @param transport_set Set of transports whose sockets shall be rebound.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_transport_schedule_rebind(anjay_t *anjay,
+                                    anjay_transport_set_t transport_set);
+
 /**
  * Tests if Anjay gave up on any further server connection attempts. It will
  * happen if none of the configured servers could be reached.
@@ -1855,6 +2670,36 @@ avs_time_real_t anjay_transport_next_planned_notify_trigger(
 avs_time_real_t anjay_transport_next_planned_pmax_notify_trigger(
         anjay_t *anjay, anjay_transport_set_t transport_set);
 
+/**
+ * Returns the time at which the library is next planned to communicate with a
+ * server, i.e. the earliest of the times returned by
+ * @ref anjay_next_planned_lifecycle_operation and
+ * @ref anjay_next_planned_notify_trigger, as well as the time at which LwM2M
+ * Send requests held back for coalescing or by the rate limiter (see
+ * @ref anjay_configuration_t::send_coalescing_window and
+ * @ref anjay_configuration_t::send_rate_limit) are planned to be sent.
+ *
+ * For devices operating in queue mode, this is the time until which the radio
+ * may stay powered down if no outside intervention happens. The activities
+ * taken into account may be aligned into shared wake windows using
+ * @ref anjay_configuration_t::queue_mode_wake_window.
+ *
+ * @param anjay Anjay object to operate on.
+ *
+ * @param ssid  Either one of:
+ *              - Short Server ID of a single regular LwM2M Server for which to
+ *                get the information
+ *              - @ref ANJAY_SSID_BOOTSTRAP if information about the Bootstrap
+ *                Server is requested
+ *              - @ref ANJAY_SSID_ANY to get time of the nearest activity
+ *                planned for any known server connection
+ *
+ * @returns Point in time according to the real-time clock at which the earliest
+ *          of the activities mentioned above is planned, or
+ *          <c>AVS_TIME_REAL_INVALID</c> if there are none.
+ */
+avs_time_real_t anjay_next_planned_wake_time(anjay_t *anjay, anjay_ssid_t ssid);
+
 /**
  * Returns whether there are some notifications which have been postponed to be
  * sent later, either due to the connection being offline or a previous failure
@@ -1906,6 +2751,214 @@ bool anjay_has_unsent_notifications(anjay_t *anjay, anjay_ssid_t ssid);
 bool anjay_transport_has_unsent_notifications(
         anjay_t *anjay, anjay_transport_set_t transport_set);
 
+/**
+ * Returns the current usage of the queue of notifications postponed to be sent
+ * later, summed up for all server connections.
+ *
+ * @param anjay     Anjay object to operate on.
+ *
+ * @param out_count Pointer to a variable that will be set to the number of
+ *                  queued notifications. May be NULL.
+ *
+ * @param out_bytes Pointer to a variable that will be set to the estimated
+ *                  amount of memory, in bytes, occupied by them, as compared
+ *                  against <c>stored_notification_memory_limit</c> configured
+ *                  in @ref anjay_configuration_t. May be NULL.
+ */
+void anjay_get_notification_queue_usage(anjay_t *anjay,
+                                        size_t *out_count,
+                                        size_t *out_bytes);
+
+/**
+ * Sets the priority of notifications about a given path, used to decide which
+ * notifications postponed to be sent later are dropped first, when
+ * <c>stored_notification_limit</c> or
+ * <c>stored_notification_memory_limit</c> configured in
+ * @ref anjay_configuration_t is reached.
+ *
+ * Each observation has the highest priority of all the paths set using this
+ * function that either contain, or are contained in, any of its observed
+ * paths. Observations that do not overlap with any such path have priority 0.
+ *
+ * By default, the oldest queued notifications are dropped first. If priorities
+ * have been set for any path, queued notifications of the observations with
+ * the lowest priority are dropped first instead. Among those, notifications
+ * superseded by a newer queued notification for the same observation are
+ * dropped before the others, and older ones before newer ones.
+ *
+ * @param anjay    Anjay object to operate on.
+ *
+ * @param oid      Object ID of the path.
+ *
+ * @param iid      Object Instance ID of the path, or @ref ANJAY_ID_INVALID to
+ *                 set the priority of the whole Object.
+ *
+ * @param rid      Resource ID of the path, or @ref ANJAY_ID_INVALID to set the
+ *                 priority of the whole Object Instance. MUST be
+ *                 @ref ANJAY_ID_INVALID if @p iid is.
+ *
+ * @param priority Priority to set. 0 resets the path to the default priority.
+ *
+ * @returns 0 on success, a negative value if the path is invalid, Observe
+ *          support is not available, or in case of an out-of-memory condition.
+ */
+int anjay_set_notification_priority(anjay_t *anjay,
+                                    anjay_oid_t oid,
+                                    anjay_iid_t iid,
+                                    anjay_rid_t rid,
+                                    uint8_t priority);
+
+#ifdef ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+/**
+ * Dumps the DTLS session state of all server connections into a binary
+ * snapshot, so that the sessions can be resumed using an abbreviated handshake
+ * after @ref anjay_dtls_sessions_restore is called on a device that has been
+ * rebooted.
+ *
+ * The snapshot contains the session resumption data as cached by the socket
+ * layer, which includes session tickets and Connection ID state, if they have
+ * been negotiated. It is keyed by Short Server ID. Sessions that have been
+ * restored, but not used yet, are included in the snapshot as well.
+ *
+ * <strong>CAUTION:</strong> The snapshot contains secret key material of the
+ * sessions. It shall be stored with the same level of protection as the
+ * Security Object contents.
+ *
+ * @param anjay      Anjay object to operate on.
+ * @param out_stream Stream to write the snapshot to.
+ *
+ * @returns AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_dtls_sessions_persist(anjay_t *anjay,
+                                        avs_stream_t *out_stream);
+
+/**
+ * Reads a snapshot of DTLS sessions created by
+ * @ref anjay_dtls_sessions_persist.
+ *
+ * The sessions are not used immediately. Instead, each of them is used when
+ * the socket of the matching server connection is created for the first time,
+ * provided that there is no session cached in memory for it already. If the
+ * server no longer recognizes the session, a full handshake is performed.
+ *
+ * This function is intended to be called just after restoring the Security and
+ * Server Objects, before the first call to @ref anjay_sched_run. Any sessions
+ * restored earlier, but not used yet, are discarded.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param in_stream Stream to read the snapshot from.
+ *
+ * @returns AVS_OK in case of success, or an error code. In case of error, the
+ *          previously restored state is left intact.
+ */
+avs_error_t anjay_dtls_sessions_restore(anjay_t *anjay,
+                                        avs_stream_t *in_stream);
+#endif // ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+
+#ifdef ANJAY_WITH_OBSERVE_PERSISTENCE
+/**
+ * Dumps the state of all active observations into a compact binary snapshot,
+ * so that they can be recreated using @ref anjay_observe_restore after the
+ * device wakes up from a sleep that did not preserve RAM contents.
+ *
+ * For each observation, the snapshot contains the observed paths, the CoAP
+ * Observe state (token, options and sequence number) and the time when the
+ * last notification was sent. Values of the observed Resources are not stored.
+ * Notifications queued for later delivery are not stored either.
+ *
+ * Observations that have been restored, but not recreated yet (see
+ * @ref anjay_observe_restore), are included in the snapshot as well.
+ *
+ * @param anjay      Anjay object to operate on.
+ * @param out_stream Stream to write the snapshot to.
+ *
+ * @returns AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_observe_persist(anjay_t *anjay, avs_stream_t *out_stream);
+
+/**
+ * Reads a snapshot of observations created by @ref anjay_observe_persist.
+ *
+ * The observations are not recreated immediately. Instead, they are recreated
+ * when the connection to the server they belong to is brought online, before
+ * any message is exchanged over it, and only if the (D)TLS session has been
+ * resumed. Otherwise, they are discarded as required by the protocol. They are
+ * also discarded when the client performs a Register operation.
+ *
+ * The values of the observed Resources read when the observations are
+ * recreated are treated as last sent to the server, and the pmax periods
+ * continue to elapse from the time when the last notification was actually
+ * sent. Use @ref anjay_notify_changed to report changes that might have
+ * happened in the meantime.
+ *
+ * Any observations restored earlier, but not recreated yet, are discarded.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param in_stream Stream to read the snapshot from.
+ *
+ * @returns AVS_OK in case of success, or an error code. In case of error, the
+ *          previously restored state is left intact.
+ */
+avs_error_t anjay_observe_restore(anjay_t *anjay, avs_stream_t *in_stream);
+#endif // ANJAY_WITH_OBSERVE_PERSISTENCE
+
+#ifdef ANJAY_WITH_STATE_PERSISTENCE
+/**
+ * Dumps the whole persistable state of the client into a single binary
+ * snapshot, so that the device can resume its operation using
+ * @ref anjay_state_restore after a reboot, without going through Bootstrap or
+ * Register again.
+ *
+ * The snapshot consists of the following sections, each of which is only
+ * present if the respective feature is enabled at compile time (and, for the
+ * objects, installed):
+ *
+ * - Security Object (see @ref anjay_security_object_persist),
+ * - Server Object (see @ref anjay_server_object_persist),
+ * - Access Control Object (see @ref anjay_access_control_persist),
+ * - Attribute Storage (see @ref anjay_attr_storage_persist),
+ * - registration state of each non-Bootstrap server, i.e. the negotiated LwM2M
+ *   version, registration location, lifetime and expiration time,
+ * - observations (see @ref anjay_observe_persist),
+ * - DTLS sessions (see @ref anjay_dtls_sessions_persist).
+ *
+ * <strong>CAUTION:</strong> The snapshot contains the Security Object and DTLS
+ * session secrets. It shall be stored with the same level of protection as
+ * the Security Object contents.
+ *
+ * NOTE: This function calls the persist functions of the respective
+ * components, so it needs to be called without the Anjay mutex locked, just
+ * like each of them.
+ *
+ * @param anjay      Anjay object to operate on.
+ * @param out_stream Stream to write the snapshot to.
+ *
+ * @returns AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_state_persist(anjay_t *anjay, avs_stream_t *out_stream);
+
+/**
+ * Reads a snapshot of the client state created by @ref anjay_state_persist.
+ *
+ * This function is intended to be called after installing all the objects,
+ * before the first call to @ref anjay_sched_run. Sections describing objects
+ * that are not installed, or unknown to this version of the library, are
+ * skipped.
+ *
+ * After a successful restore, the client does not register anew if the
+ * restored registration is still valid. Instead, it sends an Update request to
+ * each server, so that the server learns the current address of the client.
+ * If the (D)TLS session cannot be resumed, a Register request is sent instead.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param in_stream Stream to read the snapshot from.
+ *
+ * @returns AVS_OK in case of success, or an error code. In case of error, the
+ *          sections restored before the failing one are left in place.
+ */
+avs_error_t anjay_state_restore(anjay_t *anjay, avs_stream_t *in_stream);
+#endif // ANJAY_WITH_STATE_PERSISTENCE
+
 /**
  * Changes transmission parameters for given transports.
  *
@@ -1955,6 +3008,43 @@ avs_error_t anjay_update_dtls_handshake_timeouts(
         anjay_t *anjay,
         avs_net_dtls_handshake_timeouts_t dtls_handshake_timeouts);
 
+/**
+ * Stores an address that a hostname has been resolved to, so that connections
+ * to LwM2M Servers and CoAP downloads using that hostname connect to it
+ * without performing a blocking DNS lookup. This allows the application to
+ * resolve hostnames ahead of time using an asynchronous resolver of its
+ * choice. See also the <c>dns_cache_lifetime</c> field of
+ * @ref anjay_configuration_t .
+ *
+ * Secure connections still use the hostname for Server Name Indication and
+ * certificate verification.
+ *
+ * @param anjay    Anjay object to operate on.
+ *
+ * @param hostname Hostname, as present in the URI of the server or download.
+ *
+ * @param address  Numeric IPv4 or IPv6 address of @p hostname . If NULL, the
+ *                 entry for @p hostname is removed from the cache.
+ *
+ * @param ttl      Time after which the entry expires, normally the TTL of the
+ *                 DNS record. If it is not positive, the entry for
+ *                 @p hostname is removed from the cache.
+ *
+ * @returns AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_dns_cache_put(anjay_t *anjay,
+                                const char *hostname,
+                                const char *address,
+                                avs_time_duration_t ttl);
+
+/**
+ * Removes all entries from the cache of resolved hostnames, e.g. after
+ * changing the network the device is attached to.
+ *
+ * @param anjay Anjay object to operate on.
+ */
+void anjay_dns_cache_flush(anjay_t *anjay);
+
 #ifdef ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
 /**
  * Gets the time at which the client has registered successfully to a given
@@ -2037,6 +3127,109 @@ avs_error_t anjay_get_server_last_communication_time(anjay_t *anjay,
                                                      avs_time_real_t *out_time);
 #endif // ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
 
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+/**
+ * Points in time of the startup phases of the whole Anjay object, according to
+ * the monotonic clock. Each of the fields is <c>AVS_TIME_MONOTONIC_INVALID</c>
+ * if the respective phase has not happened yet.
+ */
+typedef struct {
+    /**
+     * Time at which @ref anjay_new was called.
+     */
+    avs_time_monotonic_t created;
+
+    /**
+     * Time at which the most recent LwM2M Object has been installed (e.g. using
+     * @ref anjay_register_object or any of the object modules).
+     */
+    avs_time_monotonic_t last_object_installed;
+
+    /**
+     * Time at which the persisted state was most recently restored using
+     * @ref anjay_state_restore, @ref anjay_dtls_sessions_restore,
+     * @ref anjay_observe_restore or @ref anjay_attr_storage_restore, whichever
+     * of them are enabled.
+     */
+    avs_time_monotonic_t last_state_restored;
+} anjay_startup_timestamps_t;
+
+/**
+ * Points in time of the startup phases of a single LwM2M Server connection,
+ * according to the monotonic clock. Only the first occurrence of each phase
+ * since the server has been configured in the data model is recorded. Each of
+ * the fields is <c>AVS_TIME_MONOTONIC_INVALID</c> if the respective phase has
+ * not happened yet.
+ */
+typedef struct {
+    /**
+     * Time at which the socket of the primary connection has been created.
+     */
+    avs_time_monotonic_t socket_created;
+
+    /**
+     * Time at which connecting the socket has started.
+     */
+    avs_time_monotonic_t connect_started;
+
+    /**
+     * Time at which the socket has been connected. The networking layer
+     * performs both DNS resolution and the (D)TLS handshake, if applicable,
+     * between @ref connect_started and this point in time.
+     */
+    avs_time_monotonic_t connected;
+
+    /**
+     * Time at which the first Register request has been sent. Always invalid
+     * for the Bootstrap Server.
+     */
+    avs_time_monotonic_t register_sent;
+
+    /**
+     * Time at which the first successful response to a Register (or, if
+     * a registration has been restored using @ref anjay_state_restore, Update)
+     * request has been received. Always invalid for the Bootstrap Server.
+     */
+    avs_time_monotonic_t registered;
+} anjay_server_startup_timestamps_t;
+
+/**
+ * Gets the points in time of the startup phases of the Anjay object. This
+ * allows measuring where the time between @ref anjay_new and the first
+ * successful registration goes, together with
+ * @ref anjay_get_server_startup_timestamps.
+ *
+ * @param anjay               Anjay object to operate on.
+ *
+ * @param[out] out_timestamps Non-NULL pointer to a structure to fill.
+ *
+ * @returns AVS_OK on success, or an error code.
+ */
+avs_error_t
+anjay_get_startup_timestamps(anjay_t *anjay,
+                             anjay_startup_timestamps_t *out_timestamps);
+
+/**
+ * Gets the points in time of the startup phases of a connection with a given
+ * LwM2M Server.
+ *
+ * @param anjay               Anjay object to operate on.
+ *
+ * @param ssid                A Short Server ID of a single LwM2M Server,
+ *                            including @ref ANJAY_SSID_BOOTSTRAP, for which to
+ *                            get the information. @ref ANJAY_SSID_ANY is not
+ *                            a valid value.
+ *
+ * @param[out] out_timestamps Non-NULL pointer to a structure to fill.
+ *
+ * @returns AVS_OK on success, or an error code.
+ */
+avs_error_t anjay_get_server_startup_timestamps(
+        anjay_t *anjay,
+        anjay_ssid_t ssid,
+        anjay_server_startup_timestamps_t *out_timestamps);
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_DEFERRED_LOG_H
+#define ANJAY_INCLUDE_ANJAY_DEFERRED_LOG_H
+
+#include <anjay/anjay_config.h>
+
+#include <anjay/core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Retrieves log messages stored by the deferred logging backend.
+ *
+ * When <c>ANJAY_WITH_DEFERRED_LOGS</c> is enabled, log statements on the hot
+ * paths of request and notification handling are not formatted. Instead, a
+ * binary record is stored in a ring buffer of
+ * @ref anjay_configuration_t::deferred_log_buffer_size bytes. When the buffer
+ * is full, the oldest records are dropped.
+ *
+ * Each record consists of the following fields, all in little-endian order:
+ *
+ * - format ID (2 bytes),
+ * - log level, as a value of <c>avs_log_level_t</c> (1 byte),
+ * - number of arguments N (1 byte),
+ * - timestamp, in milliseconds of the monotonic clock, truncated to 32 bits
+ *   (4 bytes),
+ * - N arguments (4 bytes each).
+ *
+ * The data retrieved with this function can be decoded with
+ * <c>tools/anjay_deferred_log_decode.py</c> from the Anjay source
+ * distribution matching the library version.
+ *
+ * Only whole records are copied. Copied records are removed from the ring
+ * buffer.
+ *
+ * @param anjay    Anjay object to operate on.
+ *
+ * @param out_buf  Buffer to copy the records into.
+ *
+ * @param buf_size Size of @p out_buf , in bytes.
+ *
+ * @returns Number of bytes written into @p out_buf . 0 means that there are no
+ *          more records, or that the oldest one does not fit in @p out_buf .
+ */
+size_t anjay_deferred_log_read(anjay_t *anjay, void *out_buf, size_t buf_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANJAY_INCLUDE_ANJAY_DEFERRED_LOG_H */
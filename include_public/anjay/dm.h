@@ -24,6 +24,7 @@ extern "C" {
 #define ANJAY_DM_OID_ACCESS_CONTROL 2
 #define ANJAY_DM_OID_DEVICE 3
 #define ANJAY_DM_OID_FIRMWARE_UPDATE 5
+#define ANJAY_DM_OID_LWM2M_GATEWAY 25
 
 typedef struct anjay_dm_object_def_struct anjay_dm_object_def_t;
 
@@ -174,6 +175,32 @@ int anjay_dm_list_instances_SINGLE(anjay_t *anjay,
                                    const anjay_dm_object_def_t *const *obj_ptr,
                                    anjay_dm_list_ctx_t *ctx);
 
+/**
+ * A handler that checks whether a single Object Instance exists, without
+ * enumerating all of them.
+ *
+ * It allows Objects with large numbers of Instances to handle requests that
+ * target a specific Instance in constant time. Its result MUST be consistent
+ * with @ref anjay_dm_list_instances_t, which is still used whenever the full
+ * set of Instances is needed.
+ *
+ * @param anjay   Anjay object to operate on.
+ * @param obj_ptr Object definition pointer, as passed to
+ *                @ref anjay_register_object .
+ * @param iid     Checked Object Instance ID.
+ *
+ * @returns This handler should return:
+ * - a positive value if the Instance exists,
+ * - 0 if the Instance does not exist,
+ * - a negative value in case of error. If it returns one of ANJAY_ERR_
+ *   constants, the response message will have an appropriate CoAP response
+ *   code.
+ */
+typedef int
+anjay_dm_instance_present_t(anjay_t *anjay,
+                            const anjay_dm_object_def_t *const *obj_ptr,
+                            anjay_iid_t iid);
+
 /**
  * A handler that shall reset Object Instance to its default (after creational)
  * state.
@@ -360,6 +387,10 @@ anjay_dm_list_resources_t(anjay_t *anjay,
  *   If the value returned is a negative number that is not any of the
  *   ANJAY_ERR_ constant, the normal fallback response is
  *   5.00 Internal Server Error.
+ * - @ref ANJAY_ERR_BUSY if the value is being obtained asynchronously and
+ *   is not available yet - the request is then responded to with 5.03 Service
+ *   Unavailable. This handler shall not block for a long time, as the Anjay
+ *   mutex is held while it is called.
  */
 typedef int
 anjay_dm_resource_read_t(anjay_t *anjay,
@@ -369,6 +400,124 @@ anjay_dm_resource_read_t(anjay_t *anjay,
                          anjay_riid_t riid,
                          anjay_output_ctx_t *ctx);
 
+/**
+ * A handler that is called once before multiple Resources of a single Object
+ * Instance are read, with the full list of Resource IDs that are about to be
+ * read. It is intended for Objects backed by hardware that can fetch multiple
+ * values in a single transaction: the handler may sample all the requested
+ * values at once, and the @ref anjay_dm_resource_read_t calls that follow for
+ * each of those Resources may then return the sampled values.
+ *
+ * This handler is used when reading a whole Object Instance (which includes
+ * LwM2M Read and Observe notifications on Object and Object Instance paths),
+ * and by @ref anjay_send_batch_data_add_current_multiple for each run of at
+ * least two consecutive paths referring to the same Object Instance.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param obj_ptr   Object definition pointer, as passed to
+ *                  @ref anjay_register_object .
+ * @param iid       Object Instance ID.
+ * @param rids      Array of IDs of the Resources that are about to be read, in
+ *                  the order in which they will be read.
+ * @param rid_count Number of elements in @p rids .
+ *
+ * NOTE: The @p rids array may include IDs of Resources that will turn out not
+ * to be readable or present. Such entries shall be ignored by the handler.
+ *
+ * NOTE: The values sampled by this handler should be used only for the
+ * @ref anjay_dm_resource_read_t calls directly following it. Anjay may call
+ * @ref anjay_dm_resource_read_t without calling this handler first.
+ *
+ * @returns This handler should return:
+ * - 0 on success,
+ * - a negative value in case of error, which aborts the whole read operation.
+ *   If it returns one of ANJAY_ERR_ constants, the response message will have
+ *   an appropriate CoAP response code.
+ */
+typedef int
+anjay_dm_resource_read_many_t(anjay_t *anjay,
+                              const anjay_dm_object_def_t *const *obj_ptr,
+                              anjay_iid_t iid,
+                              const anjay_rid_t *rids,
+                              size_t rid_count);
+
+/**
+ * Types of values that may be returned by
+ * @ref anjay_dm_resource_read_instances_t .
+ */
+typedef enum {
+    ANJAY_DM_RES_INSTANCES_INT,
+#ifdef ANJAY_WITH_LWM2M11
+    ANJAY_DM_RES_INSTANCES_UINT,
+#endif // ANJAY_WITH_LWM2M11
+    ANJAY_DM_RES_INSTANCES_DOUBLE,
+    ANJAY_DM_RES_INSTANCES_BOOL
+} anjay_dm_res_instances_type_t;
+
+/**
+ * Values of all Instances of a Multiple Resource, stored in contiguous arrays.
+ */
+typedef struct {
+    /** Type of the values, determines which member of <c>values</c> is used. */
+    anjay_dm_res_instances_type_t type;
+    /** Number of Resource Instances. */
+    size_t count;
+    /**
+     * Array of <c>count</c> Resource Instance IDs, in strictly ascending
+     * order.
+     */
+    const anjay_riid_t *riids;
+    /** Array of <c>count</c> values, the i-th one for <c>riids[i]</c>. */
+    union {
+        const int64_t *as_int;
+#ifdef ANJAY_WITH_LWM2M11
+        const uint64_t *as_uint;
+#endif // ANJAY_WITH_LWM2M11
+        const double *as_double;
+        const bool *as_bool;
+    } values;
+} anjay_dm_res_instances_t;
+
+/**
+ * A handler that returns all Instances of a Multiple Resource along with their
+ * values at once, called only if the Resource is PRESENT and is one of the
+ * @ref ANJAY_DM_RES_RM or @ref ANJAY_DM_RES_RWM kinds (as returned by
+ * @ref anjay_dm_list_resources_t).
+ *
+ * It is intended for Resources with a large number of Instances, e.g. buffers
+ * of samples: when it is implemented, reading the whole Resource (which
+ * includes LwM2M Read, Observe notifications and LwM2M Send on paths that
+ * contain it) does not call @ref anjay_dm_list_resource_instances_t and
+ * @ref anjay_dm_resource_read_t for each Instance.
+ *
+ * @param anjay   Anjay object to operate on.
+ * @param obj_ptr Object definition pointer, as passed to
+ *                @ref anjay_register_object .
+ * @param iid     Object Instance ID.
+ * @param rid     Resource ID.
+ * @param out     Structure to fill with pointers to the arrays of Resource
+ *                Instance IDs and values.
+ *
+ * NOTE: The arrays pointed to by @p out are accessed by the library after the
+ * handler returns. They shall remain valid and unchanged until any other
+ * handler of the same Object is called.
+ *
+ * @returns This handler should return:
+ * - 0 on success,
+ * - @ref ANJAY_ERR_NOT_IMPLEMENTED if values of this Resource are not of any of
+ *   the supported types, in which case the library falls back to reading each
+ *   Instance separately,
+ * - a negative value in case of error. If it returns one of ANJAY_ERR_
+ *   constants, the response message will have an appropriate CoAP response
+ *   code.
+ */
+typedef int
+anjay_dm_resource_read_instances_t(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *obj_ptr,
+                                   anjay_iid_t iid,
+                                   anjay_rid_t rid,
+                                   anjay_dm_res_instances_t *out);
+
 /**
  * A handler that writes the Resource value, called only if the Resource is
  * SUPPORTED and not of the @ref ANJAY_DM_RES_E kind (as returned by
@@ -959,6 +1108,41 @@ typedef struct {
      * *Attribute Storage* logic.
      */
     anjay_dm_resource_instance_write_attrs_t *resource_instance_write_attrs;
+
+    /**
+     * Prepare for reading multiple Resources at once,
+     * @ref anjay_dm_resource_read_many_t
+     *
+     * Optional; can be used to reduce the number of I/O transactions needed to
+     * handle *LwM2M Read* operations on Object Instances.
+     *
+     * Can be NULL, in which case only @ref anjay_dm_resource_read_t is used.
+     */
+    anjay_dm_resource_read_many_t *resource_read_many;
+
+    /**
+     * Check existence of a single Object Instance,
+     * @ref anjay_dm_instance_present_t
+     *
+     * Optional; used instead of @ref anjay_dm_list_instances_t when an
+     * operation targets a specific Object Instance.
+     *
+     * Can be NULL, in which case Instances are enumerated with
+     * @ref anjay_dm_list_instances_t .
+     */
+    anjay_dm_instance_present_t *instance_present;
+
+    /**
+     * Read all Instances of a Multiple Resource at once,
+     * @ref anjay_dm_resource_read_instances_t
+     *
+     * Optional; can be used to reduce the overhead of reading Multiple
+     * Resources with many Instances.
+     *
+     * Can be NULL, in which case each Instance is read using
+     * @ref anjay_dm_resource_read_t .
+     */
+    anjay_dm_resource_read_instances_t *resource_read_instances;
 } anjay_dm_handlers_t;
 
 /** A struct defining a LwM2M Object. */
@@ -1004,6 +1188,64 @@ int anjay_notify_changed(anjay_t *anjay,
                          anjay_iid_t iid,
                          anjay_rid_t rid);
 
+/**
+ * Path of a Resource passed to @ref anjay_notify_changed_multiple.
+ */
+typedef struct {
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+    anjay_rid_t rid;
+} anjay_notify_resource_path_t;
+
+/**
+ * Works like calling @ref anjay_notify_changed for each of the specified
+ * Resources, but is considerably cheaper when notifying about many Resources
+ * at once, e.g. after sampling a batch of sensor readings.
+ *
+ * The paths do not need to be sorted and may contain duplicates.
+ *
+ * @param anjay      Anjay object to operate on.
+ * @param paths      Array of paths of the changed Resources.
+ * @param path_count Number of elements in @p paths.
+ *
+ * @returns 0 on success, a negative value in case of error. In case of error,
+ *          notifications about some of the Resources might have been queued
+ *          nevertheless.
+ */
+int anjay_notify_changed_multiple(anjay_t *anjay,
+                                  const anjay_notify_resource_path_t *paths,
+                                  size_t path_count);
+
+/**
+ * Overrides <c>notify_debounce_window</c> configured in
+ * @ref anjay_configuration_t for changes of all Resources within a given
+ * path, e.g. to report latency-critical Resources without delay even if
+ * debouncing is enabled for the rest of the data model.
+ *
+ * If more than one override applies to a change, the one set for the most
+ * specific path is used. If a change that requires processing sooner than
+ * already planned is reported, all changes queued so far are processed at
+ * that earlier time.
+ *
+ * @param anjay  Anjay object to operate on.
+ * @param oid    Object ID; MUST NOT be <c>ANJAY_ID_INVALID</c>.
+ * @param iid    Object Instance ID, or <c>ANJAY_ID_INVALID</c> to apply to all
+ *               Instances of the Object.
+ * @param rid    Resource ID, or <c>ANJAY_ID_INVALID</c> to apply to all
+ *               Resources of the Instance. MUST be <c>ANJAY_ID_INVALID</c> if
+ *               @p iid is.
+ * @param window Maximum delay of processing the changes; zero means no delay.
+ *               Passing <c>AVS_TIME_DURATION_INVALID</c> removes the override
+ *               previously set for this exact path.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_set_notify_debounce(anjay_t *anjay,
+                              anjay_oid_t oid,
+                              anjay_iid_t iid,
+                              anjay_rid_t rid,
+                              avs_time_duration_t window);
+
 /**
  * Notifies the library that the set of Instances existing in a given Object
  * changed. It may trigger a LwM2M Notify message, update server connections
@@ -1022,6 +1264,32 @@ int anjay_notify_changed(anjay_t *anjay,
  */
 int anjay_notify_instances_changed(anjay_t *anjay, anjay_oid_t oid);
 
+/**
+ * Creates @p count new Instances of Object @p oid, calling its
+ * instance_create handler with Instance IDs selected the same way as for a
+ * LwM2M Create request without an explicit Instance ID. All the Instances are
+ * created within a single transaction, and then reported with a single
+ * notification, so there is no need to call
+ * @ref anjay_notify_instances_changed afterwards.
+ *
+ * Selecting free Instance IDs does not require enumerating all Instances each
+ * time if @ref anjay_set_instance_list_caching is enabled for the Object and
+ * it implements the instance_present handler.
+ *
+ * @param anjay    Anjay object to operate on.
+ * @param oid      Object ID of the Object to create Instances of.
+ * @param count    Number of Instances to create.
+ * @param out_iids Array of @p count elements that, on success, is filled with
+ *                 Instance IDs of the created Instances, in ascending order.
+ *
+ * @returns 0 on success, a negative value in case of error, in which case the
+ *          transaction is rolled back.
+ */
+int anjay_create_instances(anjay_t *anjay,
+                           anjay_oid_t oid,
+                           size_t count,
+                           anjay_iid_t *out_iids);
+
 #ifdef ANJAY_WITH_OBSERVATION_STATUS
 /**
  * Maximum number of servers observing a Resource reported in
@@ -1031,6 +1299,43 @@ int anjay_notify_instances_changed(anjay_t *anjay, anjay_oid_t oid);
 #        define ANJAY_MAX_OBSERVATION_SERVERS_REPORTED_NUMBER 0
 #    endif // ANJAY_MAX_OBSERVATION_SERVERS_REPORTED_NUMBER
 
+/**
+ * Counters of events related to sending notifications, maintained for each
+ * observation and for each server connection.
+ */
+typedef struct {
+    /**
+     * Number of notifications successfully sent (or, for Confirmable
+     * notifications, delivered).
+     */
+    uint32_t notifications_sent;
+    /**
+     * Number of times a notification of a change has been postponed because
+     * the <c>pmin</c> period had not elapsed yet.
+     */
+    uint32_t pmin_postponed;
+    /**
+     * Number of times a new value has been sampled, but has not been notified,
+     * because it did not satisfy the change criteria (the <c>st</c>,
+     * <c>gt</c>, <c>lt</c> and <c>edge</c> attributes, or the value not being
+     * changed at all).
+     */
+    uint32_t criteria_suppressed;
+    /**
+     * Number of queued notifications dropped because of the
+     * <c>stored_notification_limit</c> or
+     * <c>stored_notification_memory_limit</c> set in
+     * @ref anjay_configuration_t.
+     */
+    uint32_t queue_dropped;
+    /**
+     * Number of CoAP retransmissions that happened while the notifications
+     * were being delivered. This is an approximation, as it may also include
+     * retransmissions of other messages sent at the same time.
+     */
+    uint32_t retransmissions;
+} anjay_observation_counters_t;
+
 /**
  * Structure representing an observation state of a Resource.
  */
@@ -1062,6 +1367,12 @@ typedef struct {
      */
     anjay_ssid_t servers[ANJAY_MAX_OBSERVATION_SERVERS_REPORTED_NUMBER];
 #    endif //(ANJAY_MAX_OBSERVATION_SERVERS_REPORTED_NUMBER > 0)
+    /**
+     * Sum of the counters of all observations that include the Resource. An
+     * observation is counted once for each of its paths that includes the
+     * Resource.
+     */
+    anjay_observation_counters_t counters;
 } anjay_resource_observation_status_t;
 
 /**
@@ -1112,6 +1423,51 @@ typedef struct {
  */
 anjay_resource_observation_status_t anjay_resource_observation_status(
         anjay_t *anjay, anjay_oid_t oid, anjay_iid_t iid, anjay_rid_t rid);
+
+/**
+ * Structure representing the state of observations established by a single
+ * LwM2M Server.
+ */
+typedef struct {
+    /**
+     * Number of active observations.
+     */
+    size_t observation_count;
+    /**
+     * Counters of all the server's connections. They are accumulated for as
+     * long as the server continuously has any observations active, and reset
+     * afterwards.
+     */
+    anjay_observation_counters_t counters;
+    /**
+     * Number of notifications that are queued to be sent, including the one
+     * being sent at the moment, if any.
+     */
+    size_t queue_depth;
+    /**
+     * Time of the next planned notification trigger, or
+     * <c>AVS_TIME_REAL_INVALID</c> if there is none. See also
+     * @ref anjay_next_planned_notify_trigger.
+     */
+    avs_time_real_t next_trigger;
+} anjay_server_observation_stats_t;
+
+/**
+ * Gets the state of observations established by a given LwM2M Server. See
+ * @ref anjay_server_observation_stats_t for details.
+ *
+ * This function does not perform any I/O nor does it read the data model, so it
+ * is cheap enough to be polled periodically, e.g. for monitoring purposes.
+ *
+ * @param anjay Anjay object to operate on.
+ * @param ssid  Short Server ID of the server to check.
+ *
+ * @returns Observation state of a given LwM2M Server. If there is no such
+ *          server, or it has no observations active, data equivalent to an
+ *          empty state will be returned.
+ */
+anjay_server_observation_stats_t
+anjay_server_observation_stats(anjay_t *anjay, anjay_ssid_t ssid);
 #endif // ANJAY_WITH_OBSERVATION_STATUS
 
 /**
@@ -1154,6 +1510,189 @@ int anjay_register_object(anjay_t *anjay,
 int anjay_unregister_object(anjay_t *anjay,
                             const anjay_dm_object_def_t *const *def_ptr);
 
+/**
+ * Enables or disables caching of the list of Instances of a registered Object.
+ *
+ * When enabled, the result of the Object's <c>list_instances</c> handler is
+ * remembered and reused for subsequent iterations over the Instance list,
+ * until the set of Instances is known to have changed - either through the
+ * Create or Delete operations performed by Anjay, or by calling
+ * @ref anjay_notify_instances_changed.
+ *
+ * NOTE: When caching is enabled, the application MUST call
+ * @ref anjay_notify_instances_changed whenever Instances of the Object are
+ * created or removed by means other than the LwM2M protocol. Otherwise, Anjay
+ * may operate on an outdated Instance list.
+ *
+ * @param anjay   Anjay object to operate on.
+ * @param oid     ID of the Object to configure. The Object MUST be registered.
+ * @param enabled true to enable caching, false to disable it and free the
+ *                cached data.
+ *
+ * @returns 0 on success, -1 if the Object is not registered, in case of an
+ *          out-of-memory condition, or when attempting to disable caching from
+ *          within a data model handler iterating over the Instance list.
+ */
+int anjay_set_instance_list_caching(anjay_t *anjay,
+                                    anjay_oid_t oid,
+                                    bool enabled);
+
+/**
+ * Enables or disables caching of the list of Resources of a registered Object.
+ *
+ * When enabled, the result of the Object's <c>list_resources</c> handler for
+ * the most recently accessed Instance is remembered, so that resolving
+ * multiple paths within the same Instance (e.g. during a Read-Composite or
+ * when sampling values of multiple observations) does not call the handler
+ * again for each of them. The cached list is dropped whenever Anjay performs
+ * a Write, Create, Delete or reset on the Object, and on each call to
+ * @ref anjay_notify_changed or @ref anjay_notify_instances_changed for it.
+ *
+ * NOTE: When caching is enabled, the application MUST call
+ * @ref anjay_notify_changed whenever presence of any Resource of the Object
+ * changes by means other than the LwM2M protocol.
+ *
+ * @param anjay   Anjay object to operate on.
+ * @param oid     ID of the Object to configure. The Object MUST be registered.
+ * @param enabled true to enable caching, false to disable it and free the
+ *                cached data.
+ *
+ * @returns 0 on success, -1 if the Object is not registered, in case of an
+ *          out-of-memory condition, or when attempting to disable caching from
+ *          within a data model handler iterating over the Resource list.
+ */
+int anjay_set_resource_list_caching(anjay_t *anjay,
+                                    anjay_oid_t oid,
+                                    bool enabled);
+
+/**
+ * Enables or disables caching of Discover responses for a registered Object.
+ *
+ * When enabled, the CoRE Link Format payload generated in response to a
+ * Discover request is remembered for each combination of the request path,
+ * depth, Short Server ID and LwM2M version, and sent again for subsequent
+ * identical requests without querying the data model. Access Control is
+ * still checked on every request. The cached responses are dropped whenever
+ * Anjay writes attributes or modifies the Object, and on each call to
+ * @ref anjay_notify_changed or @ref anjay_notify_instances_changed for it.
+ *
+ * NOTE: When caching is enabled, the application MUST call
+ * @ref anjay_notify_changed whenever presence of any Resource or number of
+ * Resource Instances of the Object changes by means other than the LwM2M
+ * protocol, and MUST NOT rely on the attribute handlers of the Object
+ * returning values changed by means other than the Write-Attributes operation
+ * or the Attribute Storage API.
+ *
+ * @param anjay   Anjay object to operate on.
+ * @param oid     ID of the Object to configure. The Object MUST be registered.
+ * @param enabled true to enable caching, false to disable it and free the
+ *                cached data.
+ *
+ * @returns 0 on success, -1 if the Object is not registered or in case of an
+ *          out-of-memory condition.
+ */
+int anjay_set_discover_caching(anjay_t *anjay, anjay_oid_t oid, bool enabled);
+
+/**
+ * Enables or disables short-lived caching of Read responses for a registered
+ * Object.
+ *
+ * This is intended for multi-server setups, in which identical Read requests
+ * (e.g. on /3/0 right after registration) often arrive from several Servers
+ * within a short time. When enabled, the serialized response payload is
+ * remembered for each combination of the request path, requested
+ * Content-Format, LwM2M version and access class, and sent again for identical
+ * requests received within @p ttl, without calling the Object's handlers. The
+ * access class is shared by all Servers, unless the Access Control Object is
+ * in effect, in which case each Server has its own. Presence of the requested
+ * path is still checked on every request. The cached responses are dropped
+ * whenever Anjay modifies the Object or the Access Control Object, and on each
+ * call to @ref anjay_notify_changed or @ref anjay_notify_instances_changed for
+ * the Object.
+ *
+ * Observe and Read-Composite requests do not use the cache.
+ *
+ * NOTE: Changes of Resource values performed by means other than the LwM2M
+ * protocol and not reported using @ref anjay_notify_changed may be reflected
+ * in Read responses only after up to @p ttl.
+ *
+ * @param anjay Anjay object to operate on.
+ * @param oid   ID of the Object to configure. The Object MUST be registered.
+ * @param ttl   Time for which each cached response may be reused. Zero,
+ *              negative or invalid value disables caching and frees the
+ *              cached data.
+ *
+ * @returns 0 on success, -1 if the Object is not registered or in case of an
+ *          out-of-memory condition.
+ */
+int anjay_set_read_response_caching(anjay_t *anjay,
+                                    anjay_oid_t oid,
+                                    avs_time_duration_t ttl);
+
+/**
+ * Enables or disables caching of values of a Resource of a registered Object.
+ *
+ * This is intended for Resources whose values never or very rarely change,
+ * such as Manufacturer or Model Number of the Device Object. When enabled, the
+ * <c>resource_read</c> handler is called only once for each Instance of the
+ * Object, and the value it returned is reused for subsequent Read, Observe,
+ * Send and Bootstrap-Read operations. Access Control is still checked on every
+ * request. The cached values are dropped whenever Anjay writes or resets the
+ * Resource, resets its Instance or modifies the set of Instances, and on each
+ * call to @ref anjay_notify_changed for the Resource or
+ * @ref anjay_notify_instances_changed for the Object.
+ *
+ * NOTE: When caching is enabled, the application MUST call
+ * @ref anjay_notify_changed whenever the value of the Resource changes by
+ * means other than the LwM2M protocol.
+ *
+ * NOTE: Value caching is only available if Anjay is compiled with support for
+ * Observe or Send (<c>ANJAY_WITH_OBSERVE</c> or <c>ANJAY_WITH_SEND</c>).
+ *
+ * @param anjay   Anjay object to operate on.
+ * @param oid     ID of the Object to configure. The Object MUST be registered.
+ * @param rid     ID of the Resource to configure. The setting applies to that
+ *                Resource in all Instances of the Object.
+ * @param enabled true to enable caching, false to disable it and free the
+ *                cached data.
+ *
+ * @returns 0 on success, -1 if the Object is not registered, value caching is
+ *          not available, or in case of an out-of-memory condition.
+ */
+int anjay_set_resource_value_caching(anjay_t *anjay,
+                                     anjay_oid_t oid,
+                                     anjay_rid_t rid,
+                                     bool enabled);
+
+/**
+ * Marks a registered Object as notify-driven, i.e. declares that values of its
+ * Resources change only in ways that Anjay is aware of: through the LwM2M
+ * protocol, or when reported using @ref anjay_notify_changed or
+ * @ref anjay_notify_instances_changed.
+ *
+ * Notifications of observations that only include paths within notify-driven
+ * Objects are then evaluated without reading the data model when no change has
+ * been reported since the last read. In particular, periodic notifications
+ * sent when the Maximum Period expires for values that did not change reuse
+ * the previously read values. Attributes are still evaluated as usual.
+ *
+ * NOTE: When the mark is set, the application MUST report each change of a
+ * Resource value of the Object. Otherwise, notifications may carry outdated
+ * values until some change is reported.
+ *
+ * NOTE: This setting only has effect if Anjay is compiled with support for
+ * Observe (<c>ANJAY_WITH_OBSERVE</c>).
+ *
+ * @param anjay   Anjay object to operate on.
+ * @param oid     ID of the Object to configure. The Object MUST be registered.
+ * @param enabled true to mark the Object as notify-driven, false to remove the
+ *                mark.
+ *
+ * @returns 0 on success, -1 if the Object is not registered, Observe support is
+ *          not available, or in case of an out-of-memory condition.
+ */
+int anjay_set_notify_driven(anjay_t *anjay, anjay_oid_t oid, bool enabled);
+
 /**
  * Checks whether the passed string is a valid LwM2M Binding Mode.
  *
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_DM_TABLE_H
+#define ANJAY_INCLUDE_ANJAY_DM_TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <anjay/dm.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file dm_table.h
+ *
+ * Generic, table-driven implementation of data model handlers for Objects
+ * whose Resources are plain values stored directly in a C structure.
+ *
+ * Such an Object is described by a constant array of
+ * @ref anjay_dm_table_resource_def_t entries, each of them mapping a Resource
+ * ID to a storage location inside the Instance structure. The handlers
+ * declared in this file then implement listing, reading, writing and resetting
+ * of these Resources without any Object-specific callbacks.
+ *
+ * Object definitions of this kind can be generated from the Object's XML
+ * definition using <c>tools/anjay_codegen.py --table</c>.
+ *
+ * Instances are stored in a preallocated array and addressed by Instance ID
+ * in constant time. If a presence bitmap is provided, Instances may also be
+ * created and deleted, both by the application and by LwM2M Servers; see
+ * @ref ANJAY_DM_TABLE_DYNAMIC_HANDLERS.
+ */
+
+/** Storage type of a Resource value in a table-driven Object. */
+typedef enum {
+    /** <c>bool</c> */
+    ANJAY_DM_TABLE_BOOL,
+    /** <c>int32_t</c> */
+    ANJAY_DM_TABLE_I32,
+    /** <c>int64_t</c> */
+    ANJAY_DM_TABLE_I64,
+    /** <c>uint32_t</c> */
+    ANJAY_DM_TABLE_U32,
+    /** <c>uint64_t</c> */
+    ANJAY_DM_TABLE_U64,
+    /** <c>double</c> */
+    ANJAY_DM_TABLE_DOUBLE,
+    /**
+     * Null-terminated string stored in a <c>char</c> array of size specified
+     * in the <c>size</c> field of @ref anjay_dm_table_resource_def_t.
+     */
+    ANJAY_DM_TABLE_STRING
+} anjay_dm_table_type_t;
+
+/** Description of a single Resource of a table-driven Object. */
+typedef struct {
+    /** Resource ID. */
+    anjay_rid_t rid;
+
+    /**
+     * Resource kind. Only Single Resources that are not executable
+     * (@ref ANJAY_DM_RES_R, @ref ANJAY_DM_RES_W, @ref ANJAY_DM_RES_RW and
+     * @ref ANJAY_DM_RES_BS_RW) are supported.
+     */
+    anjay_dm_resource_kind_t kind;
+
+    /** Type of the value stored at <c>offset</c>. */
+    anjay_dm_table_type_t type;
+
+    /** Offset of the value within the Instance structure. */
+    size_t offset;
+
+    /**
+     * Size of the storage in bytes. Only used for
+     * @ref ANJAY_DM_TABLE_STRING, for which it must include space for the
+     * terminating nullbyte.
+     */
+    size_t size;
+} anjay_dm_table_resource_def_t;
+
+/**
+ * Convenience macro for defining @ref anjay_dm_table_resource_def_t entries.
+ *
+ * @param Rid       Resource ID.
+ * @param Kind      Resource kind.
+ * @param Type      Value type, one of @ref anjay_dm_table_type_t values
+ *                  without the <c>ANJAY_DM_TABLE_</c> prefix.
+ * @param InstType  Type of the Instance structure.
+ * @param Field     Name of the field in @p InstType holding the value.
+ */
+#define ANJAY_DM_TABLE_RESOURCE(Rid, Kind, Type, InstType, Field) \
+    {                                                             \
+        .rid = (Rid),                                             \
+        .kind = (Kind),                                           \
+        .type = ANJAY_DM_TABLE_##Type,                            \
+        .offset = offsetof(InstType, Field),                      \
+        .size = sizeof(((InstType *) 0)->Field)                   \
+    }
+
+/**
+ * Number of <c>uint32_t</c> elements needed for the
+ * <c>present_instances</c> bitmap of an Object with @p InstanceCount
+ * Instance slots.
+ */
+#define ANJAY_DM_TABLE_BITMAP_SIZE(InstanceCount) \
+    (((size_t) (InstanceCount) + 31) / 32)
+
+/**
+ * State of a table-driven Object. The <c>def</c> field shall be passed to
+ * @ref anjay_register_object by address, i.e.
+ * <c>anjay_register_object(anjay, &object.def)</c>.
+ *
+ * The Object has up to <c>instance_count</c> Instances, with Instance IDs from
+ * 0 to <c>instance_count - 1</c>, each of them being a structure of size
+ * <c>instance_size</c> stored contiguously in the <c>instances</c> array.
+ */
+typedef struct {
+    /** Object definition, with handlers set to @ref ANJAY_DM_TABLE_HANDLERS */
+    const anjay_dm_object_def_t *def;
+
+    /** Resource descriptions; MUST be sorted by Resource ID. */
+    const anjay_dm_table_resource_def_t *resources;
+
+    /** Number of elements in <c>resources</c>. */
+    size_t resource_count;
+
+    /** Pointer to the first Instance structure. */
+    void *instances;
+
+    /** Size of a single Instance structure. */
+    size_t instance_size;
+
+    /** Number of Instances. */
+    anjay_iid_t instance_count;
+
+    /**
+     * Bitmap of present Instances: Instance <c>iid</c> is present if bit
+     * <c>iid % 32</c> of <c>present_instances[iid / 32]</c> is set. MUST have
+     * at least <c>ANJAY_DM_TABLE_BITMAP_SIZE(instance_count)</c> elements.
+     *
+     * If NULL, all <c>instance_count</c> Instances are always present.
+     */
+    uint32_t *present_instances;
+} anjay_dm_table_object_t;
+
+/**
+ * Checks whether an Instance of a table-driven Object is present.
+ */
+bool anjay_dm_table_instance_present(const anjay_dm_table_object_t *obj,
+                                     anjay_iid_t iid);
+
+/**
+ * Marks an Instance of a table-driven Object as present or absent. This is
+ * meant for applications that create or remove Instances on their own; the
+ * contents of the Instance structure are not modified. Remember to call
+ * @ref anjay_notify_instances_changed afterwards.
+ *
+ * @returns 0 on success, or a negative value if @p iid is out of range or the
+ *          Object does not have a presence bitmap.
+ */
+int anjay_dm_table_instance_set_present(anjay_dm_table_object_t *obj,
+                                        anjay_iid_t iid,
+                                        bool present);
+
+/**
+ * Implementation of @ref anjay_dm_list_instances_t for table-driven Objects.
+ */
+int anjay_dm_table_list_instances(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_dm_list_ctx_t *ctx);
+
+/**
+ * Implementation of @ref anjay_dm_instance_present_t for table-driven Objects.
+ */
+int anjay_dm_table_instance_present_handler(
+        anjay_t *anjay, const anjay_dm_object_def_t *const *obj_ptr,
+        anjay_iid_t iid);
+
+/**
+ * Implementation of @ref anjay_dm_instance_create_t for table-driven Objects
+ * with a presence bitmap. The Instance structure is zeroed and the Instance is
+ * marked as present.
+ */
+int anjay_dm_table_instance_create(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *obj_ptr,
+                                   anjay_iid_t iid);
+
+/**
+ * Implementation of @ref anjay_dm_instance_remove_t for table-driven Objects
+ * with a presence bitmap.
+ */
+int anjay_dm_table_instance_remove(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *obj_ptr,
+                                   anjay_iid_t iid);
+
+/**
+ * Implementation of @ref anjay_dm_instance_reset_t for table-driven Objects.
+ * Sets all writable Resources of the Instance to zero values.
+ */
+int anjay_dm_table_instance_reset(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_iid_t iid);
+
+/**
+ * Implementation of @ref anjay_dm_list_resources_t for table-driven Objects.
+ * All Resources described in the table are reported as present.
+ */
+int anjay_dm_table_list_resources(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_iid_t iid,
+                                  anjay_dm_resource_list_ctx_t *ctx);
+
+/**
+ * Implementation of @ref anjay_dm_resource_read_t for table-driven Objects.
+ */
+int anjay_dm_table_resource_read(anjay_t *anjay,
+                                 const anjay_dm_object_def_t *const *obj_ptr,
+                                 anjay_iid_t iid,
+                                 anjay_rid_t rid,
+                                 anjay_riid_t riid,
+                                 anjay_output_ctx_t *ctx);
+
+/**
+ * Implementation of @ref anjay_dm_resource_write_t for table-driven Objects.
+ *
+ * NOTE: The value is stored directly in the Instance structure, so writes are
+ * not transactional.
+ */
+int anjay_dm_table_resource_write(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  anjay_riid_t riid,
+                                  anjay_input_ctx_t *ctx);
+
+/**
+ * Initializer of @ref anjay_dm_handlers_t for table-driven Objects.
+ */
+#define ANJAY_DM_TABLE_HANDLERS                                  \
+    .list_instances = anjay_dm_table_list_instances,             \
+    .instance_present = anjay_dm_table_instance_present_handler, \
+    .instance_reset = anjay_dm_table_instance_reset,             \
+    .list_resources = anjay_dm_table_list_resources,             \
+    .resource_read = anjay_dm_table_resource_read,               \
+    .resource_write = anjay_dm_table_resource_write,             \
+    .transaction_begin = anjay_dm_transaction_NOOP,              \
+    .transaction_validate = anjay_dm_transaction_NOOP,           \
+    .transaction_commit = anjay_dm_transaction_NOOP,             \
+    .transaction_rollback = anjay_dm_transaction_NOOP
+
+/**
+ * Initializer of @ref anjay_dm_handlers_t for table-driven Objects with a
+ * presence bitmap, which additionally allows LwM2M Servers to create and
+ * delete Instances.
+ *
+ * NOTE: Similarly to writes, creating and deleting Instances is not
+ * transactional.
+ */
+#define ANJAY_DM_TABLE_DYNAMIC_HANDLERS                          \
+    ANJAY_DM_TABLE_HANDLERS,                                     \
+    .instance_create = anjay_dm_table_instance_create,           \
+    .instance_remove = anjay_dm_table_instance_remove
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /*ANJAY_INCLUDE_ANJAY_DM_TABLE_H*/
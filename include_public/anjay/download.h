@@ -75,6 +75,40 @@ anjay_download_next_block_handler_t(anjay_t *anjay,
                                     const anjay_etag_t *etag,
                                     void *user_data);
 
+/**
+ * Alternative to @ref anjay_download_next_block_handler_t for applications
+ * that are able to store the downloaded data at arbitrary positions. When set,
+ * it is called instead of the regular handler, and chunks of data may be passed
+ * to it out of order, e.g. when a HTTP download is performed over multiple
+ * parallel connections (see
+ * @ref anjay_download_config_t#http_parallel_connections).
+ *
+ * Each byte of the remote resource starting from
+ * @ref anjay_download_config_t#start_offset is passed exactly once, unless the
+ * download is suspended and reconnected, in which case some chunks may be
+ * passed again.
+ *
+ * @param anjay     Anjay object managing the download process.
+ * @param offset    Offset of the first byte of @p data in the remote resource.
+ * @param data      Received data.
+ * @param data_size Number of bytes available in @p data .
+ * @param etag      ETag option sent by the server.
+ * @param user_data Value of @ref anjay_download_config_t#user_data passed
+ *                  to @ref anjay_download .
+ *
+ * @return Should return:
+ *         @li <c>AVS_OK</c> on success,
+ *         @li an error value if an error occurred, in which case the download
+ *             will be terminated with @ref ANJAY_DOWNLOAD_ERR_FAILED result.
+ */
+typedef avs_error_t
+anjay_download_block_at_offset_handler_t(anjay_t *anjay,
+                                         size_t offset,
+                                         const uint8_t *data,
+                                         size_t data_size,
+                                         const anjay_etag_t *etag,
+                                         void *user_data);
+
 typedef enum anjay_download_result {
     /** Download finished successfully. */
     ANJAY_DOWNLOAD_FINISHED,
@@ -142,6 +176,39 @@ typedef void anjay_download_finished_handler_t(anjay_t *anjay,
                                                anjay_download_status_t status,
                                                void *user_data);
 
+/**
+ * Source of application-owned buffers that the downloaded data is placed in
+ * before being passed to @ref anjay_download_next_block_handler_t . It may be
+ * used e.g. by applications writing to flash memory that requires aligned page
+ * buffers, to avoid copying the data once again.
+ *
+ * For HTTP(S) downloads performed over a single connection, the data is read
+ * from the network directly into the provided buffers. In other cases (CoAP
+ * downloads and data buffered for parallel HTTP connections), the data is
+ * copied from the internal receive buffer into the provided buffers.
+ *
+ * Both callbacks are called with the Anjay mutex released.
+ */
+typedef struct anjay_download_block_buffer_provider {
+    /**
+     * Returns a buffer for the next chunk of data, and stores its size in
+     * @p out_size . No more than <c>*out_size</c> bytes will be passed to the
+     * next call to @ref anjay_download_next_block_handler_t . NULL may be
+     * returned on error, in which case the download fails.
+     */
+    uint8_t *(*acquire)(void *arg, size_t *out_size);
+
+    /**
+     * Called after the data placed in @p buffer has been passed to
+     * @ref anjay_download_next_block_handler_t , or if it will not be passed
+     * at all.
+     */
+    void (*release)(void *arg, uint8_t *buffer);
+
+    /** Opaque pointer passed as the first argument to the callbacks. */
+    void *arg;
+} anjay_download_block_buffer_provider_t;
+
 typedef struct anjay_download_config {
     /** Required. %coap://, %coaps://, %http:// or %https:// URL */
     const char *url;
@@ -159,7 +226,10 @@ typedef struct anjay_download_config {
      */
     const anjay_etag_t *etag;
 
-    /** Required. Called after receiving a chunk of data from remote server. */
+    /**
+     * Required, unless @ref on_block_at_offset is set for a HTTP(S) download.
+     * Called after receiving a chunk of data from remote server.
+     */
     anjay_download_next_block_handler_t *on_next_block;
 
     /** Required. Called after the download is finished or aborted. */
@@ -206,10 +276,179 @@ typedef struct anjay_download_config {
      * be reused.
      */
     bool prefer_same_socket_downloads;
+
+    /**
+     * CoAPS only. If set to true and the download is not performed over an
+     * LwM2M Server socket (see @ref prefer_same_socket_downloads), the DTLS
+     * session of the LwM2M Server connection to the same host and port (if
+     * any) is used as a starting point for the download's handshake. This
+     * allows for an abbreviated (session resumption) handshake, instead of a
+     * full one that may be expensive on constrained links or devices.
+     *
+     * This shall only be enabled if @p security_config specifies the same
+     * credentials as used for the LwM2M Server connection, e.g. if it has been
+     * obtained using @ref anjay_security_config_from_dm. Note that a resumed
+     * session is not subject to certificate validation again. If the server
+     * refuses to resume the session, full handshake is performed as usual.
+     */
+    bool resume_server_dtls_session;
+
+    /**
+     * HTTP(S) only. If set to a value greater than 1, the downloaded resource
+     * is split into up to this many byte ranges that are fetched over separate,
+     * parallel connections. This may improve throughput on links where a
+     * single TCP connection is not able to utilize the available bandwidth.
+     *
+     * Splitting is only performed if the server reports the total size of the
+     * resource, advertises support for byte ranges and provides an ETag (which
+     * is then used to ensure that all ranges come from the same version of the
+     * resource). Otherwise, or if the resource is too small for splitting to
+     * make sense, the download continues over a single connection. Content
+     * coding (compression) is not negotiated if this option is enabled.
+     *
+     * Unless @ref on_block_at_offset is set, data is still passed to
+     * @ref on_next_block in order. Data received over connections other than
+     * the one delivering the next expected chunk is buffered in memory, up to
+     * @ref http_parallel_buffer_size bytes per connection.
+     */
+    size_t http_parallel_connections;
+
+    /**
+     * Only meaningful if @ref http_parallel_connections is greater than 1 and
+     * @ref on_block_at_offset is not set. Maximum number of bytes buffered for
+     * each connection that is not delivering the next expected chunk of data.
+     * Reading from such connection is paused when its buffer is full.
+     *
+     * Zero (default) means 64 KiB.
+     */
+    size_t http_parallel_buffer_size;
+
+    /**
+     * Optional, HTTP(S) only. If set, called instead of @ref on_next_block to
+     * pass the received data, possibly out of order. No data is buffered for
+     * reordering in that case.
+     *
+     * NOTE: @ref anjay_download_set_next_block_offset is not supported for
+     * downloads that use this handler.
+     */
+    anjay_download_block_at_offset_handler_t *on_block_at_offset;
+
+    /**
+     * CoAP(S) only. If set to a value greater than 1, up to this many BLOCK2
+     * requests are kept in flight at the same time, instead of requesting each
+     * block only after the previous one has arrived. This may greatly improve
+     * throughput on links with high round-trip times, such as NB-IoT.
+     *
+     * Pipelining is only performed if the server reports the total size of the
+     * resource through the Size2 option, which is requested for this purpose.
+     * Otherwise, or if the download is performed over an LwM2M Server socket
+     * (see @ref prefer_same_socket_downloads), blocks are requested one by
+     * one. For CoAP over UDP, NSTART used for the download is raised to this
+     * value if necessary.
+     *
+     * Data is still passed to @ref on_next_block in order. Blocks received out
+     * of order are buffered in memory, so up to <c>coap_block_window - 1</c>
+     * blocks may be held at any given time.
+     *
+     * If <c>udp_q_block2</c> is enabled in @ref anjay_configuration_t, each of
+     * the pipelined requests uses the Q-Block2 option.
+     */
+    size_t coap_block_window;
+
+    /**
+     * Optional. If set, data passed to @ref on_next_block is placed in buffers
+     * obtained from this provider, see
+     * @ref anjay_download_block_buffer_provider_t . Ignored if
+     * @ref on_block_at_offset is set.
+     *
+     * Contents of the structure are NOT copied, so it needs to remain valid
+     * until the download is finished.
+     */
+    const anjay_download_block_buffer_provider_t *block_buffer_provider;
+
+    /**
+     * Maximum average download rate, in bytes per second. If the download is
+     * faster, requesting (CoAP) or reading (HTTP) further data is delayed
+     * accordingly, leaving the link available to other traffic, e.g. LwM2M
+     * notifications. May be changed for an ongoing download using
+     * @ref anjay_download_set_rate_limit .
+     *
+     * The maximum number of requests in flight is controlled separately, using
+     * @ref coap_block_window and @ref http_parallel_connections .
+     *
+     * Zero (default) means no limit.
+     */
+    size_t max_bytes_per_second;
+
+    /**
+     * If set to true, the download is paused while any confirmable
+     * notification is being delivered to an LwM2M Server, so that it does not
+     * compete with the notification for the available bandwidth.
+     */
+    bool pause_during_confirmable_notifications;
+
+    /**
+     * HTTPS only. If set to a positive value, the TLS session established for
+     * this download is kept for this time after the download finishes, so that
+     * a subsequent download from the same host and port, that also has this
+     * option set, may resume it with an abbreviated handshake instead of
+     * performing a full one. This is useful e.g. when multiple packages are
+     * fetched from the same server one after another. If the server refuses
+     * to resume the session, full handshake is performed as usual.
+     *
+     * Up to 4 sessions, for different hosts, are kept at the same time.
+     *
+     * This shall only be enabled for downloads from the same host and port
+     * that use the same @ref security_config . Note that a resumed session is
+     * not subject to certificate validation again.
+     *
+     * Zero (default) means that the TLS session is neither reused nor kept.
+     */
+    avs_time_duration_t http_tls_session_reuse_time;
 } anjay_download_config_t;
 
 typedef void *anjay_download_handle_t;
 
+/**
+ * Statistics of an ongoing download; see @ref anjay_download_get_stats .
+ */
+typedef struct anjay_download_stats {
+    /** Number of bytes of the remote resource passed to the user so far. */
+    size_t bytes_received;
+
+    /**
+     * Number of times block requests had to be issued again for data that
+     * had already been requested, e.g. when a pipelined CoAP transfer falls
+     * back to fetching blocks one by one.
+     */
+    size_t blocks_retried;
+
+    /**
+     * Number of times the transfer has been reconnected, e.g. after a call to
+     * @ref anjay_download_reconnect or when the transport went back online.
+     */
+    size_t reconnects;
+
+    /** Throughput measured over roughly the last second, in bytes per second.
+     */
+    size_t current_throughput;
+
+    /**
+     * Average throughput since the download has been started, not counting
+     * the time spent suspended, in bytes per second.
+     */
+    size_t average_throughput;
+
+    /**
+     * Most recently measured time between sending a request and receiving the
+     * response to it. <c>AVS_TIME_DURATION_INVALID</c> if not measured yet.
+     */
+    avs_time_duration_t rtt;
+
+    /** Total time that the download has spent suspended. */
+    avs_time_duration_t time_suspended;
+} anjay_download_stats_t;
+
 /**
  * Requests asynchronous download of an external resource.
  *
@@ -288,13 +527,54 @@ avs_error_t anjay_download(anjay_t *anjay,
  *  - <c>avs_errno(AVS_EINVAL)</c> if @p next_block_offset is smaller than the
  *    currently recognized value
  *  - <c>avs_errno(AVS_ENOTSUP)</c> if Anjay has been compiled without support
- *    for downloads
+ *    for downloads, or the download passes data using
+ *    @ref anjay_download_config_t#on_block_at_offset
  */
 avs_error_t
 anjay_download_set_next_block_offset(anjay_t *anjay,
                                      anjay_download_handle_t dl_handle,
                                      size_t next_block_offset);
 
+/**
+ * Retrieves statistics of an ongoing download.
+ *
+ * @param anjay     Anjay object managing the download process.
+ * @param dl_handle Download handle previously returned by
+ *                  @ref anjay_download.
+ * @param out_stats Structure to fill with the statistics.
+ *
+ * @returns
+ *  - @ref AVS_OK for success
+ *  - <c>avs_errno(AVS_ENOENT)</c> if @p dl_handle does not refer to an existing
+ *    download process
+ *  - <c>avs_errno(AVS_ENOTSUP)</c> if Anjay has been compiled without support
+ *    for downloads
+ */
+avs_error_t anjay_download_get_stats(anjay_t *anjay,
+                                     anjay_download_handle_t dl_handle,
+                                     anjay_download_stats_t *out_stats);
+
+/**
+ * Changes the maximum average rate of an ongoing download. See
+ * @ref anjay_download_config_t#max_bytes_per_second for details.
+ *
+ * @param anjay                Anjay object managing the download process.
+ * @param dl_handle            Download handle previously returned by
+ *                             @ref anjay_download.
+ * @param max_bytes_per_second New rate limit, in bytes per second, or 0 to
+ *                             disable rate limiting.
+ *
+ * @returns
+ *  - @ref AVS_OK for success
+ *  - <c>avs_errno(AVS_ENOENT)</c> if @p dl_handle does not refer to an existing
+ *    download process
+ *  - <c>avs_errno(AVS_ENOTSUP)</c> if Anjay has been compiled without support
+ *    for downloads
+ */
+avs_error_t anjay_download_set_rate_limit(anjay_t *anjay,
+                                          anjay_download_handle_t dl_handle,
+                                          size_t max_bytes_per_second);
+
 /**
  * Aborts a download identified by @p dl_handle. Does nothing if @p dl_handle
  * does not represent a valid download handle.
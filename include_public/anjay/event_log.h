@@ -0,0 +1,155 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_EVENT_LOG_H
+#define ANJAY_INCLUDE_ANJAY_EVENT_LOG_H
+
+#include <anjay/anjay_config.h>
+#include <anjay/dm.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Reads @p size bytes, starting at @p offset, from the log storage.
+ *
+ * The module never requests a range that crosses the end of the storage, i.e.
+ * <c>offset + size</c> never exceeds configured <c>capacity</c>.
+ *
+ * @param user_ptr Opaque pointer passed as <c>storage_user_ptr</c> in
+ *                 @ref anjay_event_log_config_t .
+ *
+ * @param offset   Offset within the storage to read from.
+ *
+ * @param buf      Buffer to read the data into.
+ *
+ * @param size     Number of bytes to read.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+typedef int anjay_event_log_storage_read_t(void *user_ptr,
+                                           size_t offset,
+                                           void *buf,
+                                           size_t size);
+
+/**
+ * Writes @p size bytes to the log storage, starting at @p offset.
+ *
+ * The module never requests a range that crosses the end of the storage.
+ * Previously written data may be overwritten, as the storage is used as a
+ * circular buffer.
+ *
+ * @param user_ptr Opaque pointer passed as <c>storage_user_ptr</c> in
+ *                 @ref anjay_event_log_config_t .
+ *
+ * @param offset   Offset within the storage to write to.
+ *
+ * @param data     Data to write.
+ *
+ * @param size     Number of bytes to write.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+typedef int anjay_event_log_storage_write_t(void *user_ptr,
+                                            size_t offset,
+                                            const void *data,
+                                            size_t size);
+
+/**
+ * Handlers for an application-provided log storage, e.g. a flash partition.
+ *
+ * NOTE: The handlers may be called from whichever thread calls
+ * @ref anjay_event_log_append, as well as from the thread that handles Anjay's
+ * data model requests, but never concurrently.
+ */
+typedef struct {
+    anjay_event_log_storage_read_t *read;
+    anjay_event_log_storage_write_t *write;
+} anjay_event_log_storage_handlers_t;
+
+typedef struct {
+    /**
+     * Size of the log storage, in bytes. Each entry occupies its own size plus
+     * two bytes of framing. When there is not enough space for a new entry,
+     * the oldest entries are discarded.
+     */
+    size_t capacity;
+
+    /**
+     * Handlers of the log storage. If NULL, the module allocates a RAM buffer
+     * of <c>capacity</c> bytes.
+     */
+    const anjay_event_log_storage_handlers_t *storage_handlers;
+
+    /**
+     * Opaque pointer passed to the @ref anjay_event_log_storage_handlers_t
+     * handlers.
+     */
+    void *storage_user_ptr;
+
+    /**
+     * If true, data collection is running right after installation, as if the
+     * LogStart resource was executed. Otherwise, entries appended before
+     * LogStart is executed are discarded.
+     */
+    bool start_collecting;
+} anjay_event_log_config_t;
+
+typedef struct anjay_event_log_struct anjay_event_log_t;
+
+/**
+ * Installs the Event Log object (OID 20) with a single Instance 0 in an Anjay
+ * object.
+ *
+ * The LogData resource is read from the storage in small chunks, so logs do
+ * not need to fit in a contiguous buffer other than the storage itself.
+ *
+ * NOTE: Position of the entries within the storage is kept in RAM only. Log
+ * contents are not restored after a restart of the application.
+ *
+ * @param anjay  Anjay object for which the Event Log object is installed.
+ *
+ * @param config Configuration of the module. The structure is copied, it does
+ *               not need to be valid after the call.
+ *
+ * @returns Handle to be passed to @ref anjay_event_log_append, valid until
+ *          @p anjay is deleted, or NULL in case of error.
+ */
+anjay_event_log_t *
+anjay_event_log_install(anjay_t *anjay, const anjay_event_log_config_t *config);
+
+/**
+ * Appends an entry to the Event Log.
+ *
+ * This function does not lock the Anjay mutex, so it can be safely called from
+ * any thread, including ones that log continuously. Observers of the LogData
+ * resource are notified from within the next @ref anjay_sched_run call.
+ *
+ * If data collection is stopped, the entry is discarded.
+ *
+ * @param log  Event Log handle returned by @ref anjay_event_log_install .
+ *
+ * @param data Entry contents.
+ *
+ * @param size Size of the entry. It cannot be larger than 65535 or than the
+ *             configured capacity minus two bytes of framing.
+ *
+ * @returns 0 on success (including the case of the entry being discarded), a
+ *          negative value in case of error.
+ */
+int anjay_event_log_append(anjay_event_log_t *log,
+                           const void *data,
+                           size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANJAY_INCLUDE_ANJAY_EVENT_LOG_H */
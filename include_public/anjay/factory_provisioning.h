@@ -37,6 +37,27 @@ extern "C" {
  */
 avs_error_t anjay_factory_provision(anjay_t *anjay, avs_stream_t *data_stream);
 
+/**
+ * Works like @ref anjay_factory_provision, but is optimized for applying large
+ * amounts of Bootstrap Information at once, e.g. on manufacturing lines.
+ *
+ * All records are still applied within a single local bootstrap, validated
+ * once when it finishes and rolled back as a whole on failure. In addition,
+ * notifications about changed Resources and updates of the Last Bootstrapped
+ * Resource of the Server Object are deferred until all the records are
+ * written, and the presence of an Instance is checked only once for a sequence
+ * of consecutive records that target it.
+ *
+ * For best results, records targeting the same Object Instance shall be
+ * grouped together in @p data_stream .
+ *
+ * @param anjay         Anjay Object to operate on.
+ * @param data_stream   Bootstrap Information data stream.
+ * @returns Same values as @ref anjay_factory_provision .
+ */
+avs_error_t anjay_factory_provision_bulk(anjay_t *anjay,
+                                         avs_stream_t *data_stream);
+
 #ifdef __cplusplus
 }
 #endif
@@ -179,6 +179,27 @@ typedef struct {
      */
     bool prefer_same_socket_downloads;
 
+    /**
+     * Minimum number of bytes written to the download stream between
+     * consecutive calls to @ref anjay_fw_update_persist_download_state_t .
+     * Ignored if that handler is not implemented.
+     *
+     * Zero (default) means 16 KiB.
+     */
+    size_t download_checkpoint_interval;
+
+    /**
+     * Enables computing a SHA-256 digest of the package incrementally, as the
+     * data is passed through the download stream. The digest is available via
+     * @ref anjay_fw_update_get_package_digest within
+     * @ref anjay_fw_update_stream_finish_t and afterwards, so that the package
+     * integrity can be verified without re-reading it from storage.
+     *
+     * If @ref anjay_fw_update_handlers_t#delta_patcher is used, the digest is
+     * calculated over the package as received, i.e. over the delta patch.
+     */
+    bool compute_package_digest;
+
 #ifdef ANJAY_WITH_SEND
     /**
      * Enables using LwM2M Send to report State, Update Result and Firmware
@@ -503,6 +524,154 @@ typedef avs_time_duration_t
 anjay_fw_update_get_tcp_request_timeout_t(void *user_ptr,
                                           const char *download_uri);
 
+/**
+ * Persists the state of a Pull-mode download, so that it can be resumed after
+ * an unexpected reboot.
+ *
+ * If this handler is implemented, it is called each time at least
+ * @ref anjay_fw_update_initial_state_t#download_checkpoint_interval bytes have
+ * been written to the download stream since the previous checkpoint. It is
+ * only called after @ref anjay_fw_update_stream_write_t returns, so it is a
+ * good place to also flush the written data to non-volatile storage and to
+ * persist any state derived from it, e.g. the context of a hash function used
+ * for integrity checking. Checkpoints are only made if the remote server
+ * provides an ETag, as a download cannot be resumed safely without it.
+ *
+ * After a reboot, the persisted values shall be passed to
+ * @ref anjay_fw_update_install , with the <c>result</c> field of
+ * @ref anjay_fw_update_initial_state_t set to
+ * <c>ANJAY_FW_UPDATE_INITIAL_DOWNLOADING</c>, @p package_uri as
+ * <c>persisted_uri</c>, @p package_etag as <c>resume_etag</c> and @p offset as
+ * <c>resume_offset</c>. The download stream shall be rewound to @p offset
+ * first, as any data written after the checkpoint will be downloaded again.
+ * The library then resumes the download automatically.
+ *
+ * When the download finishes, fails or is canceled, the handler is called with
+ * @p package_uri and @p package_etag set to <c>NULL</c>, to signal that the
+ * previously persisted state shall be discarded.
+ *
+ * @param user_ptr     Opaque pointer to user data, as passed to
+ *                     @ref anjay_fw_update_install .
+ *
+ * @param package_uri  URI of the package being downloaded, or <c>NULL</c> if
+ *                     there is no download to resume anymore.
+ *
+ * @param package_etag ETag of the package being downloaded, or <c>NULL</c> if
+ *                     there is no download to resume anymore.
+ *
+ * @param offset       Number of bytes of the package written to the download
+ *                     stream so far.
+ *
+ * @returns The callback shall return 0 if successful or a negative value in
+ *          case of error. Errors are logged, but do not affect the download.
+ */
+typedef int
+anjay_fw_update_persist_download_state_t(void *user_ptr,
+                                         const char *package_uri,
+                                         const struct anjay_etag *package_etag,
+                                         size_t offset);
+
+/**
+ * Reads a fragment of the currently installed firmware image, against which
+ * delta patches are applied (see @ref anjay_fw_update_delta_patcher_t).
+ *
+ * @param user_ptr Opaque pointer to user data, as passed to
+ *                 @ref anjay_fw_update_install .
+ *
+ * @param offset   Offset within the current image to read from.
+ *
+ * @param buffer   Buffer to read the data into.
+ *
+ * @param length   Number of bytes to read. The handler shall fail if fewer
+ *                 bytes are available.
+ *
+ * @returns The callback shall return 0 if successful or a negative value in
+ *          case of error.
+ */
+typedef int anjay_fw_update_read_current_image_t(void *user_ptr,
+                                                 size_t offset,
+                                                 void *buffer,
+                                                 size_t length);
+
+/**
+ * Interface through which a delta patcher accesses the images. Passed to the
+ * handlers of @ref anjay_fw_update_delta_patcher_t .
+ */
+typedef struct anjay_fw_update_delta_io_struct {
+    /**
+     * Reads a fragment of the current image; it is a wrapper for
+     * @ref anjay_fw_update_handlers_t#read_current_image .
+     */
+    int (*read_current_image)(const struct anjay_fw_update_delta_io_struct *io,
+                              size_t offset,
+                              void *buffer,
+                              size_t length);
+    /**
+     * Passes a chunk of the reconstructed image to
+     * @ref anjay_fw_update_stream_write_t .
+     */
+    int (*write_image)(const struct anjay_fw_update_delta_io_struct *io,
+                       const void *data,
+                       size_t length);
+    /** Opaque pointer used by the library. */
+    void *arg;
+} anjay_fw_update_delta_io_t;
+
+/**
+ * Delta patcher that reconstructs the firmware image from a differential patch
+ * (e.g. in a bsdiff or detools format) and the currently installed image.
+ *
+ * If configured through @ref anjay_fw_update_handlers_t#delta_patcher , each
+ * package (delivered either in Pull or Push mode) that starts with @p magic is
+ * treated as a patch. Its contents are passed to @p write instead of
+ * @ref anjay_fw_update_stream_write_t , and the patcher is supposed to output
+ * the reconstructed image, in order, via
+ * @ref anjay_fw_update_delta_io_t#write_image . Packages that do not start
+ * with @p magic are passed to the stream unchanged. In both cases,
+ * @ref anjay_fw_update_stream_open_t , @ref anjay_fw_update_stream_finish_t
+ * and @ref anjay_fw_update_reset_t are called as usual, so the application
+ * always sees a full image.
+ *
+ * Download checkpoints (see @ref anjay_fw_update_persist_download_state_t)
+ * are not made while a patch is being applied, nor before enough of the
+ * package has been received to tell that it is not a patch.
+ */
+typedef struct {
+    /** Magic bytes that identify a patch package; required. */
+    const void *magic;
+    /** Number of bytes in @ref magic ; at least 1 and at most 16. */
+    size_t magic_size;
+
+    /**
+     * Called once the package is recognized as a patch; shall allocate the
+     * patching context and store it in <c>*out_patch_ctx</c>. The magic bytes
+     * are then passed to @ref write as well. Shall return 0 on success or a
+     * negative value (possibly one of <c>ANJAY_FW_UPDATE_ERR_*</c>) on error.
+     */
+    int (*open)(void *user_ptr, void **out_patch_ctx);
+    /**
+     * Called for each consecutive chunk of the patch. Shall return 0 on
+     * success or a negative value (possibly one of
+     * <c>ANJAY_FW_UPDATE_ERR_*</c>) on error.
+     */
+    int (*write)(void *patch_ctx,
+                 const void *data,
+                 size_t length,
+                 const anjay_fw_update_delta_io_t *io);
+    /**
+     * Called after the whole patch has been passed to @ref write ; shall
+     * output any remaining data and verify that the patch has been applied
+     * completely. Shall return 0 on success or a negative value (possibly one
+     * of <c>ANJAY_FW_UPDATE_ERR_*</c>) on error.
+     */
+    int (*finish)(void *patch_ctx, const anjay_fw_update_delta_io_t *io);
+    /**
+     * Frees the patching context. Called after @ref finish or whenever the
+     * download is aborted.
+     */
+    void (*close)(void *patch_ctx);
+} anjay_fw_update_delta_patcher_t;
+
 /**
  * Handler callbacks that shall implement the platform-specific part of firmware
  * update process.
@@ -584,6 +753,25 @@ typedef struct {
     /** Queries request timeout to be used during firmware update over CoAP+TCP
      * or HTTP; @ref anjay_fw_update_get_tcp_request_timeout_t */
     anjay_fw_update_get_tcp_request_timeout_t *get_tcp_request_timeout;
+
+    /** Persists the state of a Pull-mode download, so that it can be resumed
+     * after an unexpected reboot;
+     * @ref anjay_fw_update_persist_download_state_t */
+    anjay_fw_update_persist_download_state_t *persist_download_state;
+
+    /** Enables support for delta packages; optional, see
+     * @ref anjay_fw_update_delta_patcher_t */
+    const anjay_fw_update_delta_patcher_t *delta_patcher;
+
+    /** Reads a fragment of the currently installed firmware image; required
+     * if @ref delta_patcher is set;
+     * @ref anjay_fw_update_read_current_image_t */
+    anjay_fw_update_read_current_image_t *read_current_image;
+
+    /** Supplies application-owned buffers that the data of Pull-mode
+     * downloads is placed in before being passed to @ref stream_write;
+     * optional, see @ref anjay_download_block_buffer_provider_t */
+    const struct anjay_download_block_buffer_provider *block_buffer_provider;
 } anjay_fw_update_handlers_t;
 
 /**
@@ -654,6 +842,31 @@ int anjay_fw_update_install(
  */
 int anjay_fw_update_set_result(anjay_t *anjay, anjay_fw_update_result_t result);
 
+/**
+ * Size of the package digest returned by @ref
+ * anjay_fw_update_get_package_digest .
+ */
+#define ANJAY_FW_UPDATE_PACKAGE_DIGEST_SIZE 32
+
+/**
+ * Retrieves the SHA-256 digest of the package that has been most recently
+ * written to the download stream.
+ *
+ * Requires @ref anjay_fw_update_initial_state_t#compute_package_digest to be
+ * set.
+ *
+ * @param anjay      Anjay object to operate on.
+ *
+ * @param out_digest Buffer to store the digest in.
+ *
+ * @returns 0 on success, or a negative value if no complete digest is
+ *          available, e.g. if the download has not finished yet, the package
+ *          has been reset, or the download has been resumed after a reboot.
+ */
+int anjay_fw_update_get_package_digest(
+        anjay_t *anjay,
+        uint8_t out_digest[ANJAY_FW_UPDATE_PACKAGE_DIGEST_SIZE]);
+
 #ifdef ANJAY_WITH_DOWNLOADER
 /**
  * Suspends the operation of PULL-mode downloads in the Firmware Update module.
@@ -691,6 +904,21 @@ void anjay_fw_update_pull_suspend(anjay_t *anjay);
  *          fails.
  */
 int anjay_fw_update_pull_reconnect(anjay_t *anjay);
+
+struct anjay_download_stats;
+
+/**
+ * Retrieves statistics of the ongoing PULL-mode download in the Firmware Update
+ * module. See @ref anjay_download_get_stats for details.
+ *
+ * @param anjay     Anjay object to operate on.
+ *
+ * @param out_stats Structure to fill with the statistics.
+ *
+ * @returns 0 on success, or a negative value if no download is in progress.
+ */
+int anjay_fw_update_get_download_stats(anjay_t *anjay,
+                                       struct anjay_download_stats *out_stats);
 #endif // ANJAY_WITH_DOWNLOADER
 
 #ifdef __cplusplus
@@ -199,6 +199,46 @@ int anjay_ret_bytes_append(anjay_ret_bytes_ctx_t *ctx,
  */
 int anjay_ret_bytes(anjay_output_ctx_t *ctx, const void *data, size_t length);
 
+/**
+ * Function called when the memory passed to @ref anjay_ret_bytes_borrowed is
+ * no longer referenced by Anjay.
+ *
+ * @param arg Opaque argument passed to @ref anjay_ret_bytes_borrowed .
+ */
+typedef void anjay_ret_bytes_release_t(void *arg);
+
+/**
+ * Returns a blob of data from the data model handler, without copying it if
+ * possible.
+ *
+ * This is equivalent to @ref anjay_ret_bytes , except that whenever the value
+ * is stored for later use - e.g. as a notification value that waits to be
+ * sent, or in a LwM2M Send batch - Anjay references @p data directly instead
+ * of making a copy of it. Responses that are serialized immediately are not
+ * affected, as the data is then encoded straight from @p data anyway.
+ *
+ * @p data MUST remain valid and unchanged until @p release is called with
+ * @p release_arg . @p release is called exactly once for each call to this
+ * function, including the case of failure - possibly before this function
+ * returns. If @p release is NULL, @p data MUST remain valid for as long as any
+ * value read from the data model may be in use, e.g. if it is a statically
+ * allocated buffer.
+ *
+ * @param ctx         Context to operate on.
+ * @param data        Data buffer.
+ * @param length      Number of bytes available in the @p data buffer.
+ * @param release     Function to call when @p data is no longer referenced,
+ *                    or NULL.
+ * @param release_arg Opaque argument to pass to @p release .
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_ret_bytes_borrowed(anjay_output_ctx_t *ctx,
+                             const void *data,
+                             size_t length,
+                             anjay_ret_bytes_release_t *release,
+                             void *release_arg);
+
 /**
  * Returns a null-terminated string from the data model handler.
  *
@@ -481,6 +521,35 @@ int anjay_execute_get_arg_value(anjay_execute_ctx_t *ctx,
                                 char *out_buf,
                                 size_t buf_size);
 
+/**
+ * Accesses the (rest of the) currently processed argument's value in place,
+ * without copying it. On success, the value is skipped, just as if it was read
+ * entirely using @ref anjay_execute_get_arg_value.
+ *
+ * The value is NOT null-terminated. The pointer stays valid until the Execute
+ * handler returns.
+ *
+ * This is only possible for values contained within the first 128 bytes of
+ * the payload. For longer payloads, @ref ANJAY_BUFFER_TOO_SHORT may be
+ * returned, in which case nothing is consumed and the value may still be read
+ * using @ref anjay_execute_get_arg_value.
+ *
+ * @param ctx            Execute context
+ * @param out_value      Pointer to a variable that, on successful exit, will be
+ *                       set to point to the value. It is set to an empty
+ *                       string if the argument has no value, or the value has
+ *                       already been read or skipped.
+ * @param out_value_size Pointer to a variable that, on successful exit, will be
+ *                       set to the length of the value.
+ *
+ * @returns 0 on success, -1 if any argument is NULL,
+ *          @ref ANJAY_ERR_BAD_REQUEST in case of malformed message,
+ *          ANJAY_BUFFER_TOO_SHORT if the value cannot be accessed in place.
+ */
+int anjay_execute_get_arg_value_view(anjay_execute_ctx_t *ctx,
+                                     const char **out_value,
+                                     size_t *out_value_size);
+
 /**
  * Reads a chunk of data blob from the request message.
  *
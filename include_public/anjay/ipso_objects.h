@@ -60,6 +60,18 @@ typedef struct anjay_ipso_basic_sensor_impl_struct {
      * User provided callback for reading the sensor value.
      */
     anjay_ipso_basic_sensor_value_reader_t *get_value;
+
+    /**
+     * Deadband for notifying changes of the sensor value.
+     *
+     * If set to a positive value, a change of the value read using
+     * @ref get_value is reported to the observation subsystem only if the new
+     * value differs from the last reported one by at least this amount. The
+     * latest value is still returned when the resource is read.
+     *
+     * Set to 0 to report every change.
+     */
+    double notify_deadband;
 } anjay_ipso_basic_sensor_impl_t;
 
 /**
@@ -120,6 +132,57 @@ int anjay_ipso_basic_sensor_update(anjay_t *anjay,
                                    anjay_oid_t oid,
                                    anjay_iid_t iid);
 
+/**
+ * Aggregates of sensor values of a basic sensor object instance, see
+ * @ref anjay_ipso_basic_sensor_aggregates_get .
+ */
+typedef struct {
+    /** Number of values read since the aggregation window was reset. */
+    size_t count;
+    /** Mean of the values, NaN if @ref count is 0. */
+    double mean;
+    /** Population variance of the values, NaN if @ref count is 0. */
+    double variance;
+} anjay_ipso_basic_sensor_aggregates_t;
+
+/**
+ * Retrieves aggregates of sensor values of a basic sensor object instance.
+ *
+ * The aggregates are updated incrementally, in constant time and memory,
+ * whenever the sensor value is read using the
+ * @ref anjay_ipso_basic_sensor_impl_t::get_value callback (e.g. in
+ * @ref anjay_ipso_basic_sensor_update ), and cover the values read since the
+ * instance has been added or the aggregation window has last been reset,
+ * either with @ref anjay_ipso_basic_sensor_aggregates_reset or by executing
+ * the "Reset Min and Max Measured Values" resource.
+ *
+ * @param anjay          Anjay object with the installed the sensor object.
+ * @param oid            OID of the installed object.
+ * @param iid            IID of the instance.
+ * @param out_aggregates Structure to fill with the aggregates.
+ *
+ * @returns 0 on success, or a negative value in case of error.
+ */
+int anjay_ipso_basic_sensor_aggregates_get(
+        anjay_t *anjay,
+        anjay_oid_t oid,
+        anjay_iid_t iid,
+        anjay_ipso_basic_sensor_aggregates_t *out_aggregates);
+
+/**
+ * Resets the aggregation window of a basic sensor object instance, see
+ * @ref anjay_ipso_basic_sensor_aggregates_get .
+ *
+ * @param anjay Anjay object with the installed the sensor object.
+ * @param oid   OID of the installed object.
+ * @param iid   IID of the instance.
+ *
+ * @returns 0 on success, or a negative value in case of error.
+ */
+int anjay_ipso_basic_sensor_aggregates_reset(anjay_t *anjay,
+                                             anjay_oid_t oid,
+                                             anjay_iid_t iid);
+
 /**
  * Type of the user provided callbacks to read the three-axis sensor value.
  *
@@ -54,6 +54,20 @@ typedef struct anjay_ipso_v2_basic_sensor_meta_struct {
      * this value is set to NaN.
      */
     double max_range_value;
+
+    /**
+     * Deadband for notifying changes of the sensor value.
+     *
+     * If set to a positive value, a change of the sensor value is reported to
+     * the observation subsystem (as if with @ref anjay_notify_changed ) only
+     * if the new value differs from the last reported one by at least this
+     * amount. This avoids processing every tiny change of a noisy sensor that
+     * is updated at a high rate. The latest value is still returned when the
+     * resource is read.
+     *
+     * Set to 0 to report every change. MUST NOT be negative.
+     */
+    double notify_deadband;
 } anjay_ipso_v2_basic_sensor_meta_t;
 
 /**
@@ -108,6 +122,20 @@ typedef struct anjay_ipso_v2_3d_sensor_meta_struct {
      * If the value is NaN the resource won't be created.
      */
     double max_range_value;
+
+    /**
+     * Deadband for notifying changes of the axis values.
+     *
+     * If set to a positive value, a change of any axis value is reported to
+     * the observation subsystem (as if with @ref anjay_notify_changed ) only
+     * if the new value differs from the last reported value of that axis by at
+     * least this amount. This avoids processing every tiny change of a noisy
+     * sensor that is updated at a high rate. The latest value is still
+     * returned when the resource is read.
+     *
+     * Set to 0 to report every change. MUST NOT be negative.
+     */
+    double notify_deadband;
 } anjay_ipso_v2_3d_sensor_meta_t;
 
 /**
@@ -155,6 +183,36 @@ int anjay_ipso_v2_basic_sensor_install(anjay_t *anjay,
                                        const char *version,
                                        size_t instance_count);
 
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Installs a basic IPSO object that additionally keeps a history of sensor
+ * values. This is equivalent to @ref anjay_ipso_v2_basic_sensor_install , but
+ * every instance of the object also stores up to @p history_capacity most
+ * recent values passed to @ref anjay_ipso_v2_basic_sensor_value_update (or
+ * @ref anjay_ipso_v2_basic_sensor_values_update ), along with the time they
+ * have been set. If the history is full, the oldest samples are overwritten.
+ *
+ * Memory for the history is allocated once, when the object is installed. The
+ * history can be reported to the server using
+ * @ref anjay_ipso_v2_basic_sensor_history_send .
+ *
+ * @param anjay            Anjay object for which the object is installed.
+ * @param oid              Object ID of installed object.
+ * @param version          Object version, see
+ *                         @ref anjay_ipso_v2_basic_sensor_install .
+ * @param instance_count   Maximum count of instances of installed object.
+ * @param history_capacity Maximum number of samples stored for each instance.
+ *
+ * @returns 0 on success, or a negative value in case of error.
+ */
+int anjay_ipso_v2_basic_sensor_install_with_history(anjay_t *anjay,
+                                                    anjay_oid_t oid,
+                                                    const char *version,
+                                                    size_t instance_count,
+                                                    size_t history_capacity);
+
 /**
  * @experimental This is experimental IPSO object v2 API. This API can change
  *               in future versions without any notice.
@@ -205,6 +263,132 @@ int anjay_ipso_v2_basic_sensor_value_update(anjay_t *anjay,
                                             anjay_iid_t iid,
                                             double value);
 
+/**
+ * New value of a single instance of basic IPSO object, passed to
+ * @ref anjay_ipso_v2_basic_sensor_values_update .
+ */
+typedef struct {
+    anjay_iid_t iid;
+    double value;
+} anjay_ipso_v2_basic_sensor_value_entry_t;
+
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Updates sensor values of multiple instances of basic IPSO object at once.
+ * This is equivalent to calling @ref anjay_ipso_v2_basic_sensor_value_update
+ * for each of the entries, but locks the Anjay object only once, which is
+ * significantly faster when updating many instances from a different thread
+ * than the one running the event loop.
+ *
+ * Invalid entries do not prevent the remaining ones from being updated.
+ *
+ * CAUTION: Do not call this method from interrupts.
+ *
+ * @param anjay         Anjay object with an installed basic IPSO object.
+ * @param oid           Object ID of the object whose instances are updated.
+ * @param entries       Array of Instance IDs and new sensor values.
+ * @param entries_count Number of elements in @p entries .
+ *
+ * @returns 0 on success, or a negative value if the object is not installed or
+ *          any of the entries could not be applied.
+ */
+int anjay_ipso_v2_basic_sensor_values_update(
+        anjay_t *anjay,
+        anjay_oid_t oid,
+        const anjay_ipso_v2_basic_sensor_value_entry_t *entries,
+        size_t entries_count);
+
+/**
+ * Aggregates of sensor values of a basic IPSO object instance, see
+ * @ref anjay_ipso_v2_basic_sensor_aggregates_get .
+ */
+typedef struct {
+    /** Number of values set since the aggregation window was reset. */
+    size_t count;
+    /** Mean of the values, NaN if @ref count is 0. */
+    double mean;
+    /** Population variance of the values, NaN if @ref count is 0. */
+    double variance;
+} anjay_ipso_v2_basic_sensor_aggregates_t;
+
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Retrieves aggregates of sensor values of a basic IPSO object instance.
+ *
+ * The aggregates are updated incrementally, in constant time and memory, on
+ * every call to @ref anjay_ipso_v2_basic_sensor_value_update (or
+ * @ref anjay_ipso_v2_basic_sensor_values_update ), and cover the values set
+ * since the instance has been added or the aggregation window has last been
+ * reset, either with @ref anjay_ipso_v2_basic_sensor_aggregates_reset or by
+ * executing the "Reset Min and Max Measured Values" resource. This allows e.g.
+ * reporting the average over a reporting interval without the need for
+ * high-rate notifications.
+ *
+ * @param anjay          Anjay object with an installed basic IPSO object.
+ * @param oid            Object ID of the object instance.
+ * @param iid            Instance ID of the object instance.
+ * @param out_aggregates Structure to fill with the aggregates.
+ *
+ * @returns 0 on success, or a negative value in case of error.
+ */
+int anjay_ipso_v2_basic_sensor_aggregates_get(
+        anjay_t *anjay,
+        anjay_oid_t oid,
+        anjay_iid_t iid,
+        anjay_ipso_v2_basic_sensor_aggregates_t *out_aggregates);
+
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Resets the aggregation window of a basic IPSO object instance, see
+ * @ref anjay_ipso_v2_basic_sensor_aggregates_get .
+ *
+ * @param anjay Anjay object with an installed basic IPSO object.
+ * @param oid   Object ID of the object instance.
+ * @param iid   Instance ID of the object instance.
+ *
+ * @returns 0 on success, or a negative value in case of error.
+ */
+int anjay_ipso_v2_basic_sensor_aggregates_reset(anjay_t *anjay,
+                                                anjay_oid_t oid,
+                                                anjay_iid_t iid);
+
+#ifdef ANJAY_WITH_SEND
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Reports the sensor value history of basic IPSO object instances, collected
+ * as described in @ref anjay_ipso_v2_basic_sensor_install_with_history , to
+ * the LwM2M Server using the LwM2M Send operation.
+ *
+ * All the samples are put into a single Send message, as time series of the
+ * "Sensor Value" resources (see @ref anjay_send_batch_series_begin ). The
+ * message is sent using @ref anjay_send_deferrable , so it is delivered as
+ * soon as possible if the server is currently offline. The history is
+ * cleared once the message has been queued for sending.
+ *
+ * @param anjay Anjay object with an installed basic IPSO object.
+ * @param oid   Object ID of the object whose history shall be sent.
+ * @param iid   Instance ID of the instance whose history shall be sent, or
+ *              <c>ANJAY_ID_INVALID</c> to send history of all instances.
+ * @param ssid  Short Server ID of the target LwM2M Server.
+ *
+ * @returns 0 on success (including the case when there was no history to
+ *          send), or a negative value in case of error, in which case the
+ *          history is left intact.
+ */
+int anjay_ipso_v2_basic_sensor_history_send(anjay_t *anjay,
+                                            anjay_oid_t oid,
+                                            anjay_iid_t iid,
+                                            anjay_ssid_t ssid);
+#endif // ANJAY_WITH_SEND
+
 /**
  * @experimental This is experimental IPSO object v2 API. This API can change
  *               in future versions without any notice.
@@ -293,6 +477,81 @@ int anjay_ipso_v2_3d_sensor_value_update(
         anjay_iid_t iid,
         const anjay_ipso_v2_3d_sensor_value_t *value);
 
+/**
+ * New value of a single instance of three-axis IPSO object, passed to
+ * @ref anjay_ipso_v2_3d_sensor_values_update .
+ */
+typedef struct {
+    anjay_iid_t iid;
+    anjay_ipso_v2_3d_sensor_value_t value;
+} anjay_ipso_v2_3d_sensor_value_entry_t;
+
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Updates sensor values of multiple instances of three-axis IPSO object at
+ * once. This is equivalent to calling
+ * @ref anjay_ipso_v2_3d_sensor_value_update for each of the entries, but locks
+ * the Anjay object only once.
+ *
+ * Invalid entries do not prevent the remaining ones from being updated.
+ *
+ * CAUTION: Do not call this method from interrupts.
+ *
+ * @param anjay         Anjay object with an installed three-axis IPSO object.
+ * @param oid           Object ID of the object whose instances are updated.
+ * @param entries       Array of Instance IDs and new sensor values.
+ * @param entries_count Number of elements in @p entries .
+ *
+ * @returns 0 on success, or a negative value if the object is not installed or
+ *          any of the entries could not be applied.
+ */
+int anjay_ipso_v2_3d_sensor_values_update(
+        anjay_t *anjay,
+        anjay_oid_t oid,
+        const anjay_ipso_v2_3d_sensor_value_entry_t *entries,
+        size_t entries_count);
+
+/**
+ * @experimental This is experimental IPSO object v2 API. This API can change
+ *               in future versions without any notice.
+ *
+ * Updates sensor value of a three-axis IPSO object instance with a batch of
+ * samples, e.g. read from the FIFO of an accelerometer.
+ *
+ * The last sample becomes the current sensor value, and Min/Max Value
+ * resources are updated with extremes of the whole batch. Each changed
+ * resource is reported to the observation subsystem at most once per call,
+ * regardless of the number of samples.
+ *
+ * If any of the samples is invalid, no values are updated.
+ *
+ * CAUTION: Do not call this method from interrupts.
+ *
+ * @param anjay             Anjay object with an installed three-axis IPSO
+ *                          object.
+ * @param oid               Object ID of object instance of which the sensor
+ *                          value is updated.
+ * @param iid               Instance ID of object instance of which the sensor
+ *                          value is updated.
+ * @param samples           Array of samples, in chronological order. Fields
+ *                          of axes that are not present are ignored.
+ * @param samples_count     Number of elements in @p samples . MUST NOT be 0.
+ * @param out_max_magnitude If not NULL, the largest magnitude (Euclidean norm
+ *                          over the present axes) of the samples in the batch
+ *                          is stored there on success.
+ *
+ * @returns 0 on success, or a negative value in case of error.
+ */
+int anjay_ipso_v2_3d_sensor_samples_update(
+        anjay_t *anjay,
+        anjay_oid_t oid,
+        anjay_iid_t iid,
+        const anjay_ipso_v2_3d_sensor_value_t *samples,
+        size_t samples_count,
+        double *out_max_magnitude);
+
 /**
  * @experimental This is experimental IPSO object v2 API. This API can change
  *               in future versions without any notice.
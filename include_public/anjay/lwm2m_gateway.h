@@ -0,0 +1,126 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_LWM2M_GATEWAY_H
+#define ANJAY_INCLUDE_ANJAY_LWM2M_GATEWAY_H
+
+#include <anjay/anjay_config.h>
+#include <anjay/dm.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Installs the LwM2M Gateway object (OID 25) in an Anjay object.
+ *
+ * Each Instance of the LwM2M Gateway object represents an End Device, i.e. a
+ * non-LwM2M device connected through this client. Every End Device has its
+ * own data model, with a separate set of registered Objects, that LwM2M
+ * Servers address using Uri-Paths prefixed with the Prefix Resource value of
+ * the corresponding Instance, e.g. <c>/dev0/3/0/1</c>. Such requests are routed
+ * directly to the data model of the addressed End Device; other data models,
+ * including the one of the Gateway itself, are not accessed.
+ *
+ * Only Read (without Observe), Write and Execute operations are supported on
+ * End Device Objects. Access to all Objects of an End Device is governed by
+ * Access Control set up for the respective LwM2M Gateway object Instance.
+ * Attributes, caching enabled using e.g.
+ * @ref anjay_set_instance_list_caching and notifications about changes only
+ * apply to Objects registered directly using @ref anjay_register_object.
+ *
+ * NOTE: End Device Objects are reported to LwM2M Servers only through the IoT
+ * Device Objects Resource of the LwM2M Gateway object. They are not included
+ * in the Register or Update payload.
+ *
+ * @param anjay Anjay object for which the LwM2M Gateway object is installed.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_lwm2m_gateway_install(anjay_t *anjay);
+
+/**
+ * Adds an End Device, represented as a new Instance of the LwM2M Gateway
+ * object, with an initially empty data model. Its Prefix is <c>dev</c>
+ * followed by the Instance ID, e.g. <c>dev4</c>.
+ *
+ * @param anjay     Anjay object with the LwM2M Gateway object installed.
+ *
+ * @param device_id Value of the Device ID Resource. The string is copied, it
+ *                  does not need to be valid after the call.
+ *
+ * @param inout_iid Instance ID to use for the End Device. If it points to
+ *                  @ref ANJAY_ID_INVALID, the lowest free Instance ID is
+ *                  allocated. On success, it is set to the Instance ID
+ *                  actually used.
+ *
+ * @returns 0 on success, a negative value in case of error, including the
+ *          case of the Instance ID being already in use.
+ */
+int anjay_lwm2m_gateway_register_device(anjay_t *anjay,
+                                        const char *device_id,
+                                        anjay_iid_t *inout_iid);
+
+/**
+ * Removes an End Device previously added using
+ * @ref anjay_lwm2m_gateway_register_device, together with its data model.
+ * Objects still registered for it are unregistered first.
+ *
+ * @param anjay      Anjay object with the LwM2M Gateway object installed.
+ *
+ * @param device_iid Instance ID of the End Device.
+ *
+ * @returns 0 on success, a negative value if there is no such End Device.
+ */
+int anjay_lwm2m_gateway_deregister_device(anjay_t *anjay,
+                                          anjay_iid_t device_iid);
+
+/**
+ * Registers an Object in the data model of an End Device. The same
+ * restrictions apply as for @ref anjay_register_object, except that the Object
+ * ID only needs to be unique within that End Device.
+ *
+ * @param anjay      Anjay object with the LwM2M Gateway object installed.
+ *
+ * @param device_iid Instance ID of the End Device.
+ *
+ * @param def_ptr    Pointer to the Object definition struct. The exact value
+ *                   passed to this function will be forwarded to all data
+ *                   model handler calls.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_lwm2m_gateway_register_object(
+        anjay_t *anjay,
+        anjay_iid_t device_iid,
+        const anjay_dm_object_def_t *const *def_ptr);
+
+/**
+ * Unregisters an Object previously registered using
+ * @ref anjay_lwm2m_gateway_register_object.
+ *
+ * @param anjay      Anjay object with the LwM2M Gateway object installed.
+ *
+ * @param device_iid Instance ID of the End Device.
+ *
+ * @param def_ptr    Pointer to the Object definition struct, the same as
+ *                   passed to @ref anjay_lwm2m_gateway_register_object.
+ *
+ * @returns 0 on success, a negative value in case of error.
+ */
+int anjay_lwm2m_gateway_unregister_object(
+        anjay_t *anjay,
+        anjay_iid_t device_iid,
+        const anjay_dm_object_def_t *const *def_ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANJAY_INCLUDE_ANJAY_LWM2M_GATEWAY_H */
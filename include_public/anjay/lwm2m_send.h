@@ -280,6 +280,65 @@ int anjay_send_batch_add_bytes(anjay_send_batch_builder_t *builder,
                                const void *data,
                                size_t length);
 
+/**
+ * Function called when a buffer passed to
+ * @ref anjay_send_batch_add_bytes_external is no longer used by the batch.
+ *
+ * It may be called from any context in which a reference to the batch is
+ * released, also with the Anjay mutex locked, so it MUST NOT call any Anjay
+ * APIs.
+ *
+ * @param arg Opaque argument passed to
+ *            @ref anjay_send_batch_add_bytes_external .
+ */
+typedef void anjay_send_batch_release_handler_t(void *arg);
+
+/**
+ * Adds bytes to batch builder without making a copy of them.
+ *
+ * This function is equivalent to @ref anjay_send_batch_add_bytes, but the batch
+ * references @p data instead of storing its copy, which avoids duplicating
+ * large binary payloads in memory. @p data MUST remain valid and unchanged
+ * until @p release is called with @p release_arg - which happens when the
+ * builder is cleaned up without compiling, or after the compiled batch is
+ * released by the user and by all Send requests it was queued in.
+ *
+ * For example, to pass ownership of a buffer allocated using @c avs_malloc ,
+ * @c avs_free can be passed as @p release and the buffer as @p release_arg .
+ *
+ * NOTE: If the Send request is persisted (see
+ * @ref anjay_send_persistent_queue_install), the data is copied into the
+ * storage, and restored into a regular, internally allocated copy.
+ *
+ * @param builder     Pointer to batch builder
+ * @param oid         Object ID, MUST NOT be @c UINT16_MAX
+ * @param iid         Instance ID, MUST NOT be @c UINT16_MAX
+ * @param rid         Resource ID, MUST NOT be @c UINT16_MAX
+ * @param riid        Resource Instance ID, @c UINT16_MAX for no RIID
+ * @param timestamp   Time related to bytes being send, see
+ *                    @ref anjay_send_batch_add_bytes
+ * @param data        Pointer to data. Can be NULL only if @p length is 0.
+ * @param length      Length of data in bytes.
+ * @param release     Function to call when @p data is no longer needed; may be
+ *                    NULL if @p data is valid for the whole lifetime of the
+ *                    program.
+ * @param release_arg Argument to pass to @p release .
+ *
+ * @returns 0 on success, negative value otherwise. In case of failure, the
+ *          @p builder is left unchanged, and @p release is not called.
+ */
+int anjay_send_batch_add_bytes_external(
+        anjay_send_batch_builder_t *builder,
+        anjay_oid_t oid,
+        anjay_iid_t iid,
+        anjay_rid_t rid,
+        anjay_riid_t riid,
+        avs_time_real_t timestamp,
+        const void *data,
+        size_t length,
+        anjay_send_batch_release_handler_t *release,
+        void *release_arg);
+
 /**
  * Adds an Object Link to batch builder.
  *
@@ -313,6 +372,54 @@ int anjay_send_batch_add_objlnk(anjay_send_batch_builder_t *builder,
                                 anjay_oid_t objlnk_oid,
                                 anjay_iid_t objlnk_iid);
 
+/**
+ * Starts a time series of Float values of a single Resource or Resource
+ * Instance, to which samples can then be added using
+ * @ref anjay_send_batch_series_add_double .
+ *
+ * This is a more efficient alternative to calling
+ * @ref anjay_send_batch_add_double for each sample: the path is stored once
+ * for multiple consecutive samples instead of being copied into each of them,
+ * and in SenML-based formats, the samples are serialized using a common Base
+ * Time and short relative Time values.
+ *
+ * The series is finished by starting another one, or by adding any other data
+ * to the builder.
+ *
+ * @param builder Pointer to batch builder
+ * @param oid     Object ID, MUST NOT be @c UINT16_MAX
+ * @param iid     Instance ID, MUST NOT be @c UINT16_MAX
+ * @param rid     Resource ID, MUST NOT be @c UINT16_MAX
+ * @param riid    Resource Instance ID, @c UINT16_MAX for no RIID
+ *
+ * @returns 0 on success, negative value otherwise.
+ */
+int anjay_send_batch_series_begin(anjay_send_batch_builder_t *builder,
+                                  anjay_oid_t oid,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  anjay_riid_t riid);
+
+/**
+ * Adds a sample to the time series started with
+ * @ref anjay_send_batch_series_begin .
+ *
+ * The same rules regarding relative and absolute @p timestamp apply as in case
+ * of @ref anjay_send_batch_add_int , but unlike there, @p timestamp MUST be
+ * valid.
+ *
+ * @param builder   Pointer to batch builder
+ * @param timestamp Time when the sample was taken
+ * @param value     Value of the sample
+ *
+ * @returns 0 on success, negative value otherwise (including the case when no
+ *          series is started). In case of failure, the @p builder is left
+ *          unchanged.
+ */
+int anjay_send_batch_series_add_double(anjay_send_batch_builder_t *builder,
+                                       avs_time_real_t timestamp,
+                                       double value);
+
 /**
  * Reads value from data model of object @p anjay (without checking access
  * privileges) and adds it to the builder with timestamp set to
@@ -377,6 +484,42 @@ int anjay_send_batch_data_add_current_multiple_ignore_not_found(
         const anjay_send_resource_path_t *paths,
         size_t paths_length);
 
+/**
+ * Reads values of the same set of Resources from a range of Instances of a
+ * single Object from data model of object @p anjay (without checking access
+ * privileges), and adds them to the builder with the same timestamp for every
+ * value. Timestamp is set to @c avs_time_real_now().
+ *
+ * This function is intended for capturing e.g. /3303/x/5700 across many
+ * Instances. Unlike calling @ref anjay_send_batch_data_add_current_multiple
+ * with explicit paths, the Instances are enumerated only once, and if the
+ * Object implements @ref anjay_dm_handlers_t::resource_read_many , it is
+ * called once per Instance with all @p rids .
+ *
+ * Resources that are not present in some of the Instances are ignored.
+ *
+ * @param builder    Pointer to batch builder, MUST NOT be @c NULL
+ * @param anjay      Pointer to Anjay object, MUST NOT be @c NULL
+ * @param oid        Object ID.
+ * @param first_iid  Lowest Instance ID to read from.
+ * @param last_iid   Highest Instance ID to read from (inclusive). To read from
+ *                   all Instances, pass 0 as @p first_iid and @c UINT16_MAX as
+ *                   @p last_iid .
+ * @param rids       Array of Resource IDs to read from each Instance.
+ * @param rids_count Length of @p rids array.
+ *
+ * @returns 0 on success, negative value otherwise. In case of failure, the
+ *          @p builder is left unchanged.
+ */
+int anjay_send_batch_data_add_current_range(
+        anjay_send_batch_builder_t *builder,
+        anjay_t *anjay,
+        anjay_oid_t oid,
+        anjay_iid_t first_iid,
+        anjay_iid_t last_iid,
+        const anjay_rid_t *rids,
+        size_t rids_count);
+
 /**
  * Makes a dynamically-allocated, reference-counted immutable data batch using
  * data from batch builder. Created batch can be used for multiple calls of
@@ -546,6 +689,269 @@ anjay_send_deferrable(anjay_t *anjay,
                       anjay_send_finished_handler_t *finished_handler,
                       void *finished_handler_data);
 
+/**
+ * Priority classes of LwM2M Send requests, see
+ * @ref anjay_send_with_priority .
+ */
+typedef enum {
+    /**
+     * Bulk data, such as logs or historical measurements. Sent only after all
+     * the pending requests of higher priority for the same server.
+     */
+    ANJAY_SEND_PRIORITY_BULK = -1,
+
+    /**
+     * Priority used by @ref anjay_send and @ref anjay_send_deferrable .
+     */
+    ANJAY_SEND_PRIORITY_NORMAL = 0,
+
+    /**
+     * Critical data, such as alarms. Sent before all the pending requests of
+     * lower priority, immediately if possible: neither held back for
+     * coalescing (see @ref anjay_configuration_t::send_coalescing_window), nor
+     * by the rate limiter (see @ref anjay_configuration_t::send_rate_limit),
+     * although its size still counts towards the rate limit.
+     */
+    ANJAY_SEND_PRIORITY_URGENT = 1
+} anjay_send_priority_t;
+
+/**
+ * Sends data to the LwM2M server with a specified priority.
+ *
+ * Apart from the priority, this function is equivalent to @ref anjay_send if
+ * @p deferrable is false, or to @ref anjay_send_deferrable if it is true.
+ *
+ * Requests of the same priority are sent in the order they were submitted.
+ * Requests already in progress are not interrupted.
+ *
+ * @param anjay                 Anjay object to operate on.
+ * @param ssid                  Short Server ID of target LwM2M Server. Cannot
+ *                              be ANJAY_SSID_ANY or ANJAY_SSID_BOOTSTRAP.
+ * @param data                  Content of the message compiled previously with
+ *                              @ref anjay_send_batch_builder_compile .
+ * @param priority              Priority class of the request.
+ * @param deferrable            Whether the request shall be deferred if the
+ *                              server is currently offline.
+ * @param finished_handler      Handler called if the server confirmed message
+ *                              delivery or if no response was received in
+ *                              expected time (handler can be NULL).
+ * @param finished_handler_data Data for the handler.
+ *
+ * @returns one of the @ref anjay_send_result_t enum values.
+ */
+anjay_send_result_t
+anjay_send_with_priority(anjay_t *anjay,
+                         anjay_ssid_t ssid,
+                         const anjay_send_batch_t *data,
+                         anjay_send_priority_t priority,
+                         bool deferrable,
+                         anjay_send_finished_handler_t *finished_handler,
+                         void *finished_handler_data);
+
+/**
+ * Sends the same data to multiple LwM2M servers.
+ *
+ * This function is equivalent to calling @ref anjay_send (if @p deferrable is
+ * false) or @ref anjay_send_deferrable (if it is true) for each of the
+ * servers, but the payload is serialized only once for all the servers that
+ * use the same Content-Format, as long as the result would be identical for
+ * each of them - i.e., all the data is readable by every such server and
+ * timestamps are expressed as absolute time.
+ *
+ * Failure to send to one of the servers does not prevent sending to the
+ * remaining ones. @p finished_handler is called separately for each server
+ * the data has been sent to.
+ *
+ * @param anjay                 Anjay object to operate on.
+ * @param ssids                 Array of Short Server IDs of target LwM2M
+ *                              Servers. None of them can be ANJAY_SSID_ANY or
+ *                              ANJAY_SSID_BOOTSTRAP. If NULL, data is sent to
+ *                              all servers present in the data model.
+ * @param ssids_count           Number of elements in @p ssids . Ignored if
+ *                              @p ssids is NULL.
+ * @param data                  Content of the message compiled previously with
+ *                              @ref anjay_send_batch_builder_compile .
+ * @param deferrable            Whether the requests shall be deferred if the
+ *                              servers are currently offline.
+ * @param finished_handler      Handler called if a server confirmed message
+ *                              delivery or if no response was received in
+ *                              expected time (handler can be NULL).
+ * @param finished_handler_data Data for the handler.
+ *
+ * @returns @ref ANJAY_SEND_OK if the data has been sent (or deferred) to all
+ *          the servers, or the first error that occurred otherwise.
+ */
+anjay_send_result_t
+anjay_send_to_servers(anjay_t *anjay,
+                      const anjay_ssid_t *ssids,
+                      size_t ssids_count,
+                      const anjay_send_batch_t *data,
+                      bool deferrable,
+                      anjay_send_finished_handler_t *finished_handler,
+                      void *finished_handler_data);
+
+/**
+ * State of the queue of LwM2M Send requests, as returned by
+ * @ref anjay_send_queue_stats .
+ */
+typedef struct {
+    /**
+     * Number of requests that are currently being sent, i.e. waiting for a
+     * response from the server.
+     */
+    size_t in_flight_count;
+
+    /**
+     * Number of requests waiting to be sent - deferred until the server
+     * connection is online, or held back for coalescing or by the rate
+     * limiter.
+     */
+    size_t deferred_count;
+
+    /**
+     * Total estimated size of the payloads of the above requests, in bytes.
+     * Requests whose batches are currently only stored in the persistent log
+     * (see @ref anjay_send_persistent_queue_install) are not included.
+     */
+    size_t estimated_payload_size;
+
+    /**
+     * Value that @ref anjay_send would return for the queried server at the
+     * moment, e.g. @ref ANJAY_SEND_OK if it is online and able to receive Send
+     * requests, or @ref ANJAY_SEND_ERR_OFFLINE if not. Always
+     * @ref ANJAY_SEND_ERR_SSID if the stats of all servers were queried.
+     */
+    anjay_send_result_t server_state;
+} anjay_send_queue_stats_t;
+
+/**
+ * Reports the state of the queue of LwM2M Send requests, so that producers of
+ * the data can adapt to the rate at which it can actually be sent.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param ssid      Short Server ID of the server to report the requests for, or
+ *                  @ref ANJAY_SSID_ANY to report the requests for all servers.
+ * @param out_stats Structure to fill with the statistics.
+ *
+ * @returns 0 on success, negative value in case of error.
+ */
+int anjay_send_queue_stats(anjay_t *anjay,
+                           anjay_ssid_t ssid,
+                           anjay_send_queue_stats_t *out_stats);
+
+/**
+ * Type of a handler called when the number of queued LwM2M Send requests drops
+ * below the watermark set with @ref anjay_send_queue_set_low_watermark .
+ *
+ * @param anjay        Anjay object for which the handler is called.
+ * @param queued_count Number of requests (in flight or deferred, for all
+ *                     servers) currently in the queue.
+ * @param arg          Opaque argument passed to
+ *                     @ref anjay_send_queue_set_low_watermark .
+ */
+typedef void anjay_send_queue_watermark_handler_t(anjay_t *anjay,
+                                                  size_t queued_count,
+                                                  void *arg);
+
+/**
+ * Sets a handler to be called when the total number of queued LwM2M Send
+ * requests drops below @p watermark , after having reached it. This makes it
+ * possible to stop producing data when the queue grows, and to resume once it
+ * is drained.
+ *
+ * The handler is called from within @ref anjay_sched_run , at most once per
+ * each time the watermark is reached.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param watermark Number of requests. MUST be positive if @p handler is not
+ *                  NULL.
+ * @param handler   Handler to call, or NULL to disable the notifications.
+ * @param arg       Opaque argument to pass to @p handler .
+ *
+ * @returns 0 on success, negative value in case of error.
+ */
+int anjay_send_queue_set_low_watermark(
+        anjay_t *anjay,
+        size_t watermark,
+        anjay_send_queue_watermark_handler_t *handler,
+        void *arg);
+
+#    ifdef ANJAY_WITH_SEND_PERSISTENCE
+/**
+ * Handlers of a persistent storage (e.g. a file or a flash partition) for an
+ * append-only log, used by @ref anjay_send_persistent_queue_install .
+ *
+ * Offsets passed to the handlers are relative to the beginning of the log as
+ * left by the last call to <c>discard</c>. All handlers shall return 0 on
+ * success, or a negative value in case of error.
+ */
+typedef struct {
+    /**
+     * Appends @p length bytes to the end of the log. Data SHALL either be
+     * appended as a whole, or not at all (e.g. in case of a power loss).
+     */
+    int (*append)(void *arg, const void *data, size_t length);
+
+    /**
+     * Reads up to @p length bytes starting at @p offset into @p buf , and sets
+     * @p *out_bytes_read to the number of bytes actually read. Reading fewer
+     * bytes than requested, including zero, is only allowed at the end of the
+     * log.
+     */
+    int (*read)(void *arg,
+                size_t offset,
+                void *buf,
+                size_t length,
+                size_t *out_bytes_read);
+
+    /**
+     * Removes the first @p length bytes from the log, so that the byte
+     * previously at offset @p length is now at offset 0. @p length may be
+     * equal to the size of the whole log.
+     */
+    int (*discard)(void *arg, size_t length);
+} anjay_send_log_handlers_t;
+
+/**
+ * Enables storing the Send requests deferred by @ref anjay_send_deferrable in
+ * a persistent log, so that they survive a reboot, and so that their amount is
+ * not limited by the available RAM.
+ *
+ * Each deferred request is appended to the log immediately. Up to
+ * @p max_ram_size bytes of the deferred batches are also kept in RAM; the
+ * oldest ones beyond that limit are released and read back from the log when
+ * they are about to be sent. When a request is delivered or cancelled, a
+ * marker is appended to the log. Space taken by the oldest records is reclaimed
+ * using the <c>discard</c> handler once they are no longer needed.
+ *
+ * Requests stored in the log by a previous run of the application are read
+ * when this function is called, and sent as if deferred with
+ * @ref anjay_send_deferrable without a finished handler.
+ *
+ * Requests that are still deferred or in progress when the Anjay object is
+ * deleted are kept in the log (even though their finished handlers are called
+ * with @ref ANJAY_SEND_ABORT), and thus may be sent again by the next run.
+ *
+ * NOTE: The batch passed to the finished handler may be NULL if the request is
+ * cancelled while its batch is only stored in the log.
+ *
+ * @param anjay        Anjay object to operate on.
+ * @param handlers     Log handlers. MUST remain valid until the Anjay object
+ *                     is deleted.
+ * @param arg          Opaque argument passed to the handlers.
+ * @param max_ram_size Maximum total size of the deferred batches kept in RAM,
+ *                     in bytes, as estimated by the library.
+ *
+ * @returns 0 on success, or a negative value in case of error, including the
+ *          case when the persistent queue has already been installed.
+ */
+int anjay_send_persistent_queue_install(
+        anjay_t *anjay,
+        const anjay_send_log_handlers_t *handlers,
+        void *arg,
+        size_t max_ram_size);
+#    endif // ANJAY_WITH_SEND_PERSISTENCE
+
 #endif // ANJAY_WITH_SEND
 
 #ifdef __cplusplus
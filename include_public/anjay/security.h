@@ -80,6 +80,20 @@ typedef struct {
      * for more than one of these fields at the same time. */
     avs_crypto_psk_key_info_t psk_key;
 #endif // ANJAY_WITH_SECURITY_STRUCTURED
+    /**
+     * If set to true, the key material passed in the Public Key Or Identity
+     * and Secret Key fields (including the structured variants, if enabled)
+     * is referenced instead of being copied onto the heap. This is useful
+     * e.g. for keys stored in read-only flash memory, or referred to by a
+     * handle to an external secure storage.
+     *
+     * The referenced memory MUST remain valid and unchanged for as long as the
+     * Instance exists, or until the respective Resource is overwritten. Note
+     * that transaction snapshots share the same reference, and state restored
+     * using @ref anjay_security_object_restore always holds owned copies.
+     * Server Public Key is always copied.
+     */
+    bool key_material_by_reference;
 } anjay_security_instance_t;
 
 /**
@@ -92,7 +106,8 @@ typedef struct {
  *
  * Note: @p instance may be safely freed by the user code after this function
  * finishes (internally a deep copy of @ref anjay_security_instance_t is
- * performed).
+ * performed), unless @ref anjay_security_instance_t::key_material_by_reference
+ * is set - in that case, the key material itself is not copied.
  *
  * Warning: calling this function during active communication with Bootstrap
  * Server may yield undefined behavior and unexpected failures may occur.
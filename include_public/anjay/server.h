@@ -124,8 +124,30 @@ AVS_LIST(const anjay_ssid_t) anjay_server_get_ssids(anjay_t *anjay);
 avs_error_t anjay_server_object_persist(anjay_t *anjay,
                                         avs_stream_t *out_stream);
 
+/**
+ * Dumps Server Object Instances into the @p out_stream as a compact binary
+ * snapshot, protected with a checksum.
+ *
+ * The snapshot is a raw image of the in-memory representation, so it can be
+ * restored with a single read, without decoding each Resource separately. For
+ * the same reason, it is only valid for the exact same build of the library
+ * (and the same target platform) that created it. Restoring it with any other
+ * build will fail with <c>AVS_EBADMSG</c>, in which case a state persisted
+ * with @ref anjay_server_object_persist shall be used instead.
+ *
+ * Snapshots are recognized and restored by @ref anjay_server_object_restore.
+ *
+ * @param anjay         Anjay instance with Server Object installed.
+ * @param out_stream    Stream to write to.
+ * @return AVS_OK in case of success, or an error code.
+ */
+avs_error_t anjay_server_object_persist_snapshot(anjay_t *anjay,
+                                                 avs_stream_t *out_stream);
+
 /**
  * Attempts to restore Server Object Instances from specified @p in_stream .
+ * Both the data written by @ref anjay_server_object_persist and by
+ * @ref anjay_server_object_persist_snapshot are accepted.
  *
  * Note: if restore fails, then Server Object will be left untouched, on
  * success though all Instances stored within the Object will be purged.
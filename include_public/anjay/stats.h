@@ -46,6 +46,627 @@ uint64_t anjay_get_num_incoming_retransmissions(anjay_t *anjay);
  */
 uint64_t anjay_get_num_outgoing_retransmissions(anjay_t *anjay);
 
+/**
+ * @returns the number of confirmable messages sent by the client that were
+ *          acknowledged by the server, either with an empty ACK or a
+ *          piggybacked response.
+ *
+ * NOTE: When ANJAY_WITH_NET_STATS is disabled this function always returns 0.
+ */
+uint64_t anjay_get_num_acknowledged_messages(anjay_t *anjay);
+
+/**
+ * @returns the total time, in milliseconds, spent waiting for acknowledgement
+ *          of messages counted by @ref anjay_get_num_acknowledged_messages,
+ *          including retransmissions. Dividing the two gives the mean ACK wait
+ *          time.
+ *
+ * NOTE: When ANJAY_WITH_NET_STATS is disabled this function always returns 0.
+ */
+uint64_t anjay_get_total_ack_wait_time_ms(anjay_t *anjay);
+
+/**
+ * @returns the number of confirmable messages that are currently sent, but not
+ *          yet acknowledged or responded to. Unlike other statistics, it is not
+ *          accumulated over time.
+ *
+ * NOTE: When ANJAY_WITH_NET_STATS is disabled this function always returns 0.
+ */
+uint64_t anjay_get_num_messages_in_flight(anjay_t *anjay);
+
+/**
+ * @returns the number of CoAP messages sent by the client over UDP, including
+ *          retransmissions and empty messages.
+ *
+ * NOTE: When ANJAY_WITH_NET_STATS is disabled this function always returns 0.
+ */
+uint64_t anjay_get_num_sent_messages(anjay_t *anjay);
+
+/**
+ * @returns the number of CoAP messages received by the client over UDP,
+ *          including duplicates.
+ *
+ * NOTE: When ANJAY_WITH_NET_STATS is disabled this function always returns 0.
+ */
+uint64_t anjay_get_num_received_messages(anjay_t *anjay);
+
+/**
+ * @returns the total size, in bytes, of messages counted by
+ *          @ref anjay_get_num_sent_messages and
+ *          @ref anjay_get_num_received_messages, excluding IP, UDP and DTLS
+ *          overhead.
+ *
+ * NOTE: When ANJAY_WITH_NET_STATS is disabled this function always returns 0.
+ */
+uint64_t anjay_get_total_messages_size(anjay_t *anjay);
+
+/**
+ * @returns the size, in bytes, of the largest message counted by
+ *          @ref anjay_get_total_messages_size.
+ *
+ * NOTE: When ANJAY_WITH_NET_STATS is disabled this function always returns 0.
+ */
+uint64_t anjay_get_max_message_size(anjay_t *anjay);
+
+/**
+ * @param anjay  Anjay object to operate on.
+ *
+ * @param bucket Index of the histogram bucket, smaller than
+ *               <c>AVS_COAP_STATS_RTT_HISTOGRAM_BUCKETS</c>. Bucket 0 counts
+ *               round-trip times shorter than
+ *               <c>AVS_COAP_STATS_RTT_HISTOGRAM_FIRST_BOUND_MS</c>; the upper
+ *               bound of each next one is twice as large, and the last one is
+ *               unbounded.
+ *
+ * @returns the number of confirmable messages acknowledged without any
+ *          retransmissions whose round-trip time falls into the given
+ *          @p bucket, or 0 if @p bucket is out of range.
+ *
+ * NOTE: When ANJAY_WITH_NET_STATS is disabled this function always returns 0.
+ */
+uint64_t anjay_get_rtt_histogram_bucket(anjay_t *anjay, size_t bucket);
+
+/**
+ * Number of buckets in histograms of @ref anjay_lock_stats_entry_t. Bucket 0
+ * counts times shorter than 2 microseconds; the upper bound of each next one is
+ * twice as large, and the last one is unbounded.
+ */
+#define ANJAY_LOCK_STATS_HISTOGRAM_BUCKETS 20
+
+/**
+ * Statistics of locking the Anjay mutex by a single function.
+ */
+typedef struct {
+    /**
+     * Name of the function that locked the mutex - usually a public API
+     * function, or a function implementing a scheduler job (in which case the
+     * hold time is the run time of the job). NULL for the entry aggregating all
+     * functions that did not fit in the statistics table.
+     */
+    const char *function;
+    /** Number of times the mutex has been locked. */
+    uint64_t lock_count;
+    /** Total and maximum time spent waiting for the mutex, in microseconds. */
+    uint64_t total_wait_us;
+    uint64_t max_wait_us;
+    /** Total and maximum time the mutex has been held, in microseconds. */
+    uint64_t total_hold_us;
+    uint64_t max_hold_us;
+    uint64_t wait_histogram[ANJAY_LOCK_STATS_HISTOGRAM_BUCKETS];
+    uint64_t hold_histogram[ANJAY_LOCK_STATS_HISTOGRAM_BUCKETS];
+} anjay_lock_stats_entry_t;
+
+/**
+ * Retrieves statistics of time spent waiting for and holding the Anjay mutex,
+ * collected since the Anjay object was created or since the last call to
+ * @ref anjay_reset_lock_stats.
+ *
+ * Time spent in read-only functions that only take the mutex in shared mode is
+ * not included.
+ *
+ * @param anjay       Anjay object to operate on.
+ * @param out_entries Array to fill with the statistics. May be NULL if
+ *                    @p max_entries is 0.
+ * @param max_entries Number of elements in @p out_entries .
+ *
+ * @returns the number of entries available, which may be larger than
+ *          @p max_entries - in which case only the first @p max_entries are
+ *          written.
+ *
+ * NOTE: When ANJAY_WITH_LOCK_STATS is disabled this function always returns 0.
+ */
+size_t anjay_get_lock_stats(anjay_t *anjay,
+                            anjay_lock_stats_entry_t *out_entries,
+                            size_t max_entries);
+
+/**
+ * Clears all statistics returned by @ref anjay_get_lock_stats.
+ *
+ * NOTE: When ANJAY_WITH_LOCK_STATS is disabled this function does nothing.
+ */
+void anjay_reset_lock_stats(anjay_t *anjay);
+
+/**
+ * Writes a summary of @ref anjay_get_lock_stats results to the log, at INFO
+ * level, one line per function, sorted by total hold time.
+ *
+ * NOTE: When ANJAY_WITH_LOCK_STATS is disabled this function does nothing.
+ */
+void anjay_dump_lock_stats(anjay_t *anjay);
+
+/**
+ * Kinds of scheduler jobs reported by @ref anjay_get_pending_sched_jobs and
+ * @ref anjay_get_sched_job_stats.
+ */
+typedef enum {
+    /** Checking whether a notification shall be sent for an observation. */
+    ANJAY_SCHED_JOB_OBSERVE_TRIGGER,
+    /**
+     * Action planned for an LwM2M server: Register, Update, reconnection
+     * retry, or disabling the server.
+     */
+    ANJAY_SCHED_JOB_SERVER_ACTION,
+    /**
+     * CoAP layer job, e.g. a retransmission or exchange timeout. Only
+     * reported if Anjay is compiled with <c>ANJAY_WITH_THREAD_SAFETY</c>; in
+     * that case all pending CoAP jobs are represented by a single entry.
+     */
+    ANJAY_SCHED_JOB_COAP,
+    /** Reconnecting a download started with @ref anjay_download. */
+    ANJAY_SCHED_JOB_DOWNLOAD_RECONNECT,
+    /**
+     * Closing the socket of a server connection that uses queue mode.
+     */
+    ANJAY_SCHED_JOB_QUEUE_MODE_CLOSE,
+    ANJAY_SCHED_JOB_KIND_LIMIT_
+} anjay_sched_job_kind_t;
+
+/**
+ * Information about a single pending scheduler job.
+ */
+typedef struct {
+    anjay_sched_job_kind_t kind;
+    /**
+     * Short Server ID of the server that the job is related to, or
+     * @ref ANJAY_SSID_ANY if it is not related to a specific server.
+     */
+    anjay_ssid_t ssid;
+    /** Time at which the job is planned to be executed. */
+    avs_time_monotonic_t deadline;
+} anjay_sched_job_info_t;
+
+/**
+ * Lists the pending scheduler jobs of Anjay. Only jobs of the kinds listed in
+ * @ref anjay_sched_job_kind_t are reported; short-lived internal jobs are not.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param out_jobs  Array to fill with the job information. May be NULL if
+ *                  @p max_jobs is 0.
+ * @param max_jobs  Number of elements in @p out_jobs.
+ *
+ * @returns Total number of pending jobs, which may be larger than
+ *          @p max_jobs - in that case, only the first @p max_jobs are stored.
+ *
+ * NOTE: When ANJAY_WITH_SCHED_STATS is disabled this function always returns 0.
+ */
+size_t anjay_get_pending_sched_jobs(anjay_t *anjay,
+                                    anjay_sched_job_info_t *out_jobs,
+                                    size_t max_jobs);
+
+/**
+ * Statistics of executions of scheduler jobs of a single kind.
+ */
+typedef struct {
+    /** Number of times jobs of the given kind have been executed. */
+    uint64_t executions;
+    /** Total and maximum run time of a single job, in microseconds. */
+    uint64_t total_runtime_us;
+    uint64_t max_runtime_us;
+} anjay_sched_job_stats_t;
+
+/**
+ * Retrieves statistics of executions of scheduler jobs of a given kind,
+ * collected since the Anjay object was created or since the last call to
+ * @ref anjay_reset_sched_job_stats.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param kind      Kind of the jobs to query.
+ * @param out_stats Structure to fill with the statistics.
+ *
+ * @returns 0 on success, or a negative value if @p kind is invalid.
+ *
+ * NOTE: When ANJAY_WITH_SCHED_STATS is disabled this function fills
+ * @p out_stats with zeros and returns -1.
+ */
+int anjay_get_sched_job_stats(anjay_t *anjay,
+                              anjay_sched_job_kind_t kind,
+                              anjay_sched_job_stats_t *out_stats);
+
+/**
+ * Resets statistics returned by @ref anjay_get_sched_job_stats to zero.
+ *
+ * NOTE: When ANJAY_WITH_SCHED_STATS is disabled this function does nothing.
+ */
+void anjay_reset_sched_job_stats(anjay_t *anjay);
+
+/**
+ * Kinds of LwM2M operations reported by @ref anjay_get_operation_stats.
+ */
+typedef enum {
+    /** Read, Read-Composite, Discover and Observe requests. */
+    ANJAY_OPERATION_READ,
+    /**
+     * Write, Write-Composite, Write-Attributes, Create and Delete requests.
+     */
+    ANJAY_OPERATION_WRITE,
+    /** Execute requests. */
+    ANJAY_OPERATION_EXECUTE,
+    /** Notifications sent by the client. */
+    ANJAY_OPERATION_NOTIFY,
+    /** Register and Update requests sent by the client. */
+    ANJAY_OPERATION_REGISTER,
+    /** LwM2M Send requests sent by the client. */
+    ANJAY_OPERATION_SEND,
+    ANJAY_OPERATION_KIND_LIMIT_
+} anjay_operation_kind_t;
+
+/**
+ * Number of buckets in histograms of @ref anjay_operation_stats_t. Bucket 0
+ * counts times shorter than 16 microseconds; the upper bound of each next one
+ * is twice as large, and the last one is unbounded.
+ */
+#define ANJAY_OPERATION_STATS_HISTOGRAM_BUCKETS 24
+
+/**
+ * Statistics of a single kind of LwM2M operations performed with a single
+ * server.
+ *
+ * Meaning of the handler and total time depends on the kind of the operation:
+ *
+ * - for requests received from the server (Read, Write, Execute), the handler
+ *   time is the time spent on handling the request in the data model, and
+ *   the total time also includes parsing the request and sending the response,
+ * - for Notify, the handler time is the time spent on serializing and sending
+ *   the notification, and the total time is counted since the notified value
+ *   has been read from the data model - so it includes the time the
+ *   notification spent in the queue,
+ * - for Register, Update and Send, the handler time is the time spent on
+ *   preparing and sending the request, and the total time is counted until the
+ *   response is received.
+ */
+typedef struct {
+    /** Number of operations performed. */
+    uint64_t count;
+    /**
+     * Number of operations counted in <c>count</c> that failed, i.e. the
+     * client either responded with an error or received one.
+     */
+    uint64_t errors;
+    /** Total and maximum handler time, in microseconds. */
+    uint64_t total_handler_us;
+    uint64_t max_handler_us;
+    /** Total and maximum total time, in microseconds. */
+    uint64_t total_time_us;
+    uint64_t max_time_us;
+    uint64_t handler_histogram[ANJAY_OPERATION_STATS_HISTOGRAM_BUCKETS];
+    uint64_t time_histogram[ANJAY_OPERATION_STATS_HISTOGRAM_BUCKETS];
+} anjay_operation_stats_t;
+
+/**
+ * Retrieves statistics of LwM2M operations of a given kind performed with a
+ * given server, collected since the Anjay object was created or since the last
+ * call to @ref anjay_reset_operation_stats.
+ *
+ * Statistics of a server are retained when it is removed from the data model,
+ * so that they are still available if it is created again.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param ssid      Short Server ID of the server to query. Statistics of
+ *                  requests from the Bootstrap Server are available under
+ *                  @ref ANJAY_SSID_BOOTSTRAP . @ref ANJAY_SSID_ANY may be used
+ *                  to get a sum of statistics of all servers.
+ * @param kind      Kind of the operations to query.
+ * @param out_stats Structure to fill with the statistics. It is filled with
+ *                  zeros if no operations have been performed.
+ *
+ * @returns 0 on success, or a negative value if @p kind is invalid.
+ *
+ * NOTE: When ANJAY_WITH_OPERATION_STATS is disabled this function fills
+ * @p out_stats with zeros and returns -1.
+ */
+int anjay_get_operation_stats(anjay_t *anjay,
+                              anjay_ssid_t ssid,
+                              anjay_operation_kind_t kind,
+                              anjay_operation_stats_t *out_stats);
+
+/**
+ * Retrieves the number of payloads of a given Content-Format sent to a given
+ * server, i.e. responses to Read, Read-Composite and Observe requests,
+ * notifications and LwM2M Send requests. This makes it possible to check which
+ * formats the server actually negotiates, e.g. whether it ever sends an Accept
+ * option or relies on the defaults.
+ *
+ * Each payload is counted once, regardless of the number of CoAP blocks it has
+ * been split into. Responses served from the Read response cache are counted as
+ * well.
+ *
+ * @param anjay          Anjay object to operate on.
+ * @param ssid           Short Server ID of the server to query, or
+ *                       @ref ANJAY_SSID_ANY to get a sum for all servers.
+ * @param content_format Content-Format to query.
+ * @param out_payloads   Variable to set to the number of payloads.
+ *
+ * @returns 0 on success, or a negative value in case of error.
+ *
+ * NOTE: When ANJAY_WITH_OPERATION_STATS is disabled this function sets
+ * @p out_payloads to 0 and returns -1.
+ */
+int anjay_get_content_format_payloads(anjay_t *anjay,
+                                      anjay_ssid_t ssid,
+                                      uint16_t content_format,
+                                      uint64_t *out_payloads);
+
+/**
+ * Resets statistics returned by @ref anjay_get_operation_stats and
+ * @ref anjay_get_content_format_payloads of all servers to zero.
+ *
+ * NOTE: When ANJAY_WITH_OPERATION_STATS is disabled this function does
+ * nothing.
+ */
+void anjay_reset_operation_stats(anjay_t *anjay);
+
+/**
+ * Amount of LwM2M traffic attributed to a single kind of operations,
+ * Content-Format or Object.
+ *
+ * Bytes are counted on the socket layer, in the same way as by
+ * @ref anjay_get_tx_bytes and @ref anjay_get_rx_bytes - i.e. including CoAP
+ * headers and (D)TLS record overhead, but not the IP, UDP or TCP headers.
+ *
+ * Traffic is attributed per exchange: all messages of a single exchange (e.g.
+ * a Read request and its response, or a Register request and its response)
+ * count towards the same operation, Content-Format and Object:
+ *
+ * - the Content-Format is the one of the request payload, or if there is none,
+ *   the one requested using the Accept option; for Notify, Register, Update and
+ *   Send, it is the Content-Format of the payload sent by the client,
+ * - the Object is the one from the request URI (or the only path observed, for
+ *   Notify); Register, Update, Send and requests not targeting a single Object
+ *   are counted under @ref ANJAY_ID_INVALID .
+ *
+ * Traffic that cannot be attributed to a single exchange at the time it is
+ * sent or received - most notably CoAP retransmissions, pings, (D)TLS
+ * handshakes and blocks of Register, Update, Send and Notify payloads other
+ * than the first one - is not counted in any of these statistics, but still
+ * counts towards @ref anjay_get_tx_bytes and @ref anjay_get_rx_bytes .
+ */
+typedef struct {
+    uint64_t tx_bytes;
+    uint64_t rx_bytes;
+} anjay_traffic_stats_t;
+
+/**
+ * Retrieves the amount of traffic attributed to LwM2M operations of a given
+ * kind, summed over all servers, since the Anjay object was created or since
+ * the last call to @ref anjay_reset_traffic_stats.
+ *
+ * @param anjay     Anjay object to operate on.
+ * @param kind      Kind of the operations to query.
+ * @param out_stats Structure to fill with the statistics.
+ *
+ * @returns 0 on success, or a negative value if @p kind is invalid.
+ *
+ * NOTE: When ANJAY_WITH_TRAFFIC_STATS is disabled this function fills
+ * @p out_stats with zeros and returns -1.
+ */
+int anjay_get_operation_traffic_stats(anjay_t *anjay,
+                                      anjay_operation_kind_t kind,
+                                      anjay_traffic_stats_t *out_stats);
+
+/**
+ * Works like @ref anjay_get_operation_traffic_stats, but for exchanges with a
+ * given Content-Format. @ref AVS_COAP_FORMAT_NONE may be used to query
+ * exchanges without any payload nor Accept option.
+ */
+int anjay_get_content_format_traffic_stats(anjay_t *anjay,
+                                           uint16_t content_format,
+                                           anjay_traffic_stats_t *out_stats);
+
+/**
+ * Works like @ref anjay_get_operation_traffic_stats, but for exchanges
+ * targeting a given Object. @ref ANJAY_ID_INVALID may be used to query the
+ * exchanges that do not target a single Object.
+ */
+int anjay_get_object_traffic_stats(anjay_t *anjay,
+                                   anjay_oid_t oid,
+                                   anjay_traffic_stats_t *out_stats);
+
+/**
+ * Shorthands for @ref anjay_get_operation_traffic_stats that return only the
+ * number of bytes sent or received, respectively.
+ *
+ * NOTE: When ANJAY_WITH_TRAFFIC_STATS is disabled these functions return 0.
+ */
+uint64_t anjay_get_operation_tx_bytes(anjay_t *anjay,
+                                      anjay_operation_kind_t kind);
+
+uint64_t anjay_get_operation_rx_bytes(anjay_t *anjay,
+                                      anjay_operation_kind_t kind);
+
+/**
+ * Resets all statistics returned by @ref anjay_get_operation_traffic_stats,
+ * @ref anjay_get_content_format_traffic_stats and
+ * @ref anjay_get_object_traffic_stats to zero.
+ *
+ * NOTE: When ANJAY_WITH_TRAFFIC_STATS is disabled this function does nothing.
+ */
+void anjay_reset_traffic_stats(anjay_t *anjay);
+
+/**
+ * Subsystems to which heap allocations are attributed by
+ * @ref anjay_get_memory_stats.
+ *
+ * Allocations are attributed to the subsystem whose code is running at the
+ * time, including ones made by avs_coap or avs_commons on its behalf - e.g.
+ * memory used to send a notification counts towards
+ * @ref ANJAY_MEMORY_TAG_OBSERVE . Reallocations and frees are always
+ * accounted to the subsystem that made the original allocation.
+ */
+typedef enum {
+    /** Allocations not attributed to any of the other subsystems. */
+    ANJAY_MEMORY_TAG_OTHER,
+    /** Observations and queued notifications. */
+    ANJAY_MEMORY_TAG_OBSERVE,
+    /** LwM2M Send messages, including the queue of deferred ones. */
+    ANJAY_MEMORY_TAG_SEND,
+    /** Attribute storage. */
+    ANJAY_MEMORY_TAG_ATTR_STORAGE,
+    /** Downloads started with @ref anjay_download. */
+    ANJAY_MEMORY_TAG_DOWNLOADER,
+    /**
+     * CoAP layer state not attributed to other subsystems: exchanges,
+     * retransmissions and handling of incoming packets up to the point when
+     * the request is dispatched.
+     */
+    ANJAY_MEMORY_TAG_COAP,
+    /**
+     * CoAP/UDP response cache (see
+     * @ref anjay_configuration_t::msg_cache_size). Growth of the cache
+     * configured with @ref anjay_configuration_t::msg_cache_min_size happens
+     * while handling packets, and is attributed to
+     * @ref ANJAY_MEMORY_TAG_COAP .
+     */
+    ANJAY_MEMORY_TAG_RESPONSE_CACHE,
+    /**
+     * Installation of the Security, Server, Access Control and Firmware
+     * Update objects. Data model operations performed on them later on count
+     * towards the subsystem that performs them.
+     */
+    ANJAY_MEMORY_TAG_MODULES,
+    ANJAY_MEMORY_TAG_LIMIT_
+} anjay_memory_tag_t;
+
+/**
+ * Heap usage of a single subsystem. Sizes do not include the per-allocation
+ * overhead of the accounting itself and of the underlying allocator.
+ */
+typedef struct {
+    /** Number of bytes currently allocated. */
+    size_t current_bytes;
+    /**
+     * Largest value of <c>current_bytes</c> since the program start or since
+     * the last call to @ref anjay_reset_memory_peaks.
+     */
+    size_t peak_bytes;
+    /** Number of allocations currently not freed. */
+    size_t current_allocations;
+    /**
+     * Number of allocations made since the program start, not including
+     * reallocations of existing blocks.
+     */
+    size_t total_allocations;
+} anjay_memory_stats_t;
+
+/**
+ * Retrieves heap usage statistics of a given subsystem.
+ *
+ * The statistics are global for the whole program, as they are collected by
+ * the <c>avs_malloc()</c> family of functions and not by any particular Anjay
+ * object. They are not synchronized between threads, so the values are only
+ * reliable if avs_commons memory functions are not used concurrently, e.g.
+ * when only a single Anjay object is used and all calls to it are made from
+ * one thread.
+ *
+ * @param tag       Subsystem to query.
+ * @param out_stats Structure to fill with the statistics.
+ *
+ * @returns 0 on success, or a negative value if @p tag is invalid.
+ *
+ * NOTE: When ANJAY_WITH_MEMORY_ACCOUNTING is disabled this function fills
+ * @p out_stats with zeros and returns -1.
+ */
+int anjay_get_memory_stats(anjay_memory_tag_t tag,
+                           anjay_memory_stats_t *out_stats);
+
+/**
+ * Resets the peak values reported by @ref anjay_get_memory_stats to the
+ * current ones.
+ *
+ * NOTE: When ANJAY_WITH_MEMORY_ACCOUNTING is disabled this function does
+ * nothing.
+ */
+void anjay_reset_memory_peaks(void);
+
+/**
+ * Heap usage attributed to a single call site by
+ * @ref anjay_get_allocation_sites.
+ *
+ * Call sites are Anjay functions that mark themselves as owners of the
+ * allocations made while they run (including ones made by avs_coap or
+ * avs_commons on their behalf): handling of CoAP exchanges, batch building,
+ * the notification queue, observation values and input/output contexts. The
+ * innermost marked function wins. Reallocations and frees are always
+ * accounted to the site that made the original allocation.
+ */
+typedef struct {
+    /**
+     * Name of the function, or NULL for allocations made outside of any
+     * marked function, or when the number of distinct sites exceeded the
+     * internal limit.
+     */
+    const char *site;
+    /** Number of allocations made, not including reallocations. */
+    uint64_t allocations;
+    /** Number of reallocations of blocks allocated by this site. */
+    uint64_t reallocations;
+    /**
+     * Total number of bytes requested by allocations, plus growth of blocks
+     * on reallocations.
+     */
+    uint64_t total_bytes;
+    /** Number of bytes currently allocated. */
+    size_t current_bytes;
+} anjay_allocation_site_stats_t;
+
+/**
+ * Retrieves per-call-site heap usage statistics, sorted by
+ * <c>total_bytes</c>, descending.
+ *
+ * The same caveats about concurrent use as for @ref anjay_get_memory_stats
+ * apply.
+ *
+ * @param out_entries Array to fill with the statistics. May be NULL if
+ *                    @p max_entries is 0.
+ * @param max_entries Number of elements in @p out_entries .
+ *
+ * @returns the number of entries available, which may be larger than
+ *          @p max_entries - in which case only the first @p max_entries are
+ *          written.
+ *
+ * NOTE: When ANJAY_WITH_ALLOCATION_PROFILING is disabled this function always
+ * returns 0.
+ */
+size_t anjay_get_allocation_sites(anjay_allocation_site_stats_t *out_entries,
+                                  size_t max_entries);
+
+/**
+ * Resets the counters returned by @ref anjay_get_allocation_sites, except for
+ * <c>current_bytes</c>, to zero.
+ *
+ * NOTE: When ANJAY_WITH_ALLOCATION_PROFILING is disabled this function does
+ * nothing.
+ */
+void anjay_reset_allocation_sites(void);
+
+/**
+ * Writes a summary of @ref anjay_get_allocation_sites results to the log, at
+ * INFO level, one line per call site.
+ *
+ * NOTE: When ANJAY_WITH_ALLOCATION_PROFILING is disabled this function does
+ * nothing.
+ */
+void anjay_dump_allocation_sites(void);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -932,6 +932,15 @@ typedef struct {
      */
     void *obj_ctx;
 
+    /**
+     * Enables computing a SHA-256 digest of the package incrementally, as the
+     * data is passed to @ref anjay_sw_mgmt_stream_write_t . The digest of the
+     * last successfully finished package can be retrieved using @ref
+     * anjay_sw_mgmt_get_package_digest , e.g. from @ref
+     * anjay_sw_mgmt_check_integrity_t , without re-reading the package.
+     */
+    bool compute_package_digest;
+
 #if defined(ANJAY_WITH_DOWNLOADER)
     /**
      * Informs the module to try reusing sockets of existing LwM2M Servers to
@@ -942,6 +951,12 @@ typedef struct {
 #endif // defined(ANJAY_WITH_DOWNLOADER)
 } anjay_sw_mgmt_settings_t;
 
+/**
+ * Size of the package digest returned by @ref
+ * anjay_sw_mgmt_get_package_digest .
+ */
+#define ANJAY_SW_MGMT_PACKAGE_DIGEST_SIZE 32
+
 /**
  * @experimental This is experimental Software Management object API. This API
  * can change in future versions without any notice.
@@ -994,6 +1009,58 @@ int anjay_sw_mgmt_get_activation_state(anjay_t *anjay,
                                        anjay_iid_t iid,
                                        bool *out_state);
 
+/**
+ * @experimental This is experimental Software Management object API. This API
+ * can change in future versions without any notice.
+ *
+ * Retrieves the SHA-256 digest of the package most recently streamed into the
+ * given instance. The digest is computed on the fly while the package is
+ * written, so it is available already within @ref
+ * anjay_sw_mgmt_stream_finish_t and afterwards, in particular within @ref
+ * anjay_sw_mgmt_check_integrity_t .
+ *
+ * Requires @ref anjay_sw_mgmt_settings_t::compute_package_digest to be set.
+ *
+ * @param anjay       Anjay object for which the Software Management Object is
+ *                    installed.
+ *
+ * @param iid         ID of Software Management object instance.
+ *
+ * @param out_digest  Buffer to store the digest in.
+ *
+ * @returns 0 on success, -1 if there is no such instance or no complete digest
+ *          is available (e.g. digest computation is disabled, the package has
+ *          been reset or was delivered in a previous run of the application).
+ */
+int anjay_sw_mgmt_get_package_digest(
+        anjay_t *anjay,
+        anjay_iid_t iid,
+        uint8_t out_digest[ANJAY_SW_MGMT_PACKAGE_DIGEST_SIZE]);
+
+#ifdef ANJAY_WITH_DOWNLOADER
+struct anjay_download_stats;
+
+/**
+ * @experimental This is experimental Software Management object API. This API
+ * can change in future versions without any notice.
+ *
+ * Retrieves statistics of the ongoing PULL-mode download of a given Software
+ * Management object instance. See @ref anjay_download_get_stats for details.
+ *
+ * @param anjay       Anjay object to operate on.
+ *
+ * @param iid         ID of Software Management object instance.
+ *
+ * @param out_stats   Structure to fill with the statistics.
+ *
+ * @returns 0 on success, -1 if there is no such instance or no download is in
+ *          progress.
+ */
+int anjay_sw_mgmt_get_download_stats(anjay_t *anjay,
+                                     anjay_iid_t iid,
+                                     struct anjay_download_stats *out_stats);
+#endif // ANJAY_WITH_DOWNLOADER
+
 /**
  * @experimental This is experimental Software Management object API. This API
  * can change in future versions without any notice.
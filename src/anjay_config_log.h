@@ -74,6 +74,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_ACCESS_CONTROL
     _anjay_log(anjay, TRACE, "ANJAY_WITH_ACCESS_CONTROL = OFF");
 #endif // ANJAY_WITH_ACCESS_CONTROL
+#ifdef ANJAY_WITH_ALLOCATION_PROFILING
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_ALLOCATION_PROFILING = ON");
+#else // ANJAY_WITH_ALLOCATION_PROFILING
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_ALLOCATION_PROFILING = OFF");
+#endif // ANJAY_WITH_ALLOCATION_PROFILING
 #ifdef ANJAY_WITH_ATTR_STORAGE
     _anjay_log(anjay, TRACE, "ANJAY_WITH_ATTR_STORAGE = ON");
 #else // ANJAY_WITH_ATTR_STORAGE
@@ -89,6 +94,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_CBOR
     _anjay_log(anjay, TRACE, "ANJAY_WITH_CBOR = OFF");
 #endif // ANJAY_WITH_CBOR
+#ifdef ANJAY_WITH_CBOR_COMPACT_NUMBERS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_CBOR_COMPACT_NUMBERS = ON");
+#else // ANJAY_WITH_CBOR_COMPACT_NUMBERS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_CBOR_COMPACT_NUMBERS = OFF");
+#endif // ANJAY_WITH_CBOR_COMPACT_NUMBERS
 #ifdef ANJAY_WITH_COAP_DOWNLOAD
     _anjay_log(anjay, TRACE, "ANJAY_WITH_COAP_DOWNLOAD = ON");
 #else // ANJAY_WITH_COAP_DOWNLOAD
@@ -119,6 +129,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_CORE_PERSISTENCE
     _anjay_log(anjay, TRACE, "ANJAY_WITH_CORE_PERSISTENCE = OFF");
 #endif // ANJAY_WITH_CORE_PERSISTENCE
+#ifdef ANJAY_WITH_DEFERRED_LOGS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_DEFERRED_LOGS = ON");
+#else // ANJAY_WITH_DEFERRED_LOGS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_DEFERRED_LOGS = OFF");
+#endif // ANJAY_WITH_DEFERRED_LOGS
 #ifdef ANJAY_WITH_DISCOVER
     _anjay_log(anjay, TRACE, "ANJAY_WITH_DISCOVER = ON");
 #else // ANJAY_WITH_DISCOVER
@@ -129,6 +144,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_DOWNLOADER
     _anjay_log(anjay, TRACE, "ANJAY_WITH_DOWNLOADER = OFF");
 #endif // ANJAY_WITH_DOWNLOADER
+#ifdef ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_DTLS_SESSION_PERSISTENCE = ON");
+#else // ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_DTLS_SESSION_PERSISTENCE = OFF");
+#endif // ANJAY_WITH_DTLS_SESSION_PERSISTENCE
 #ifdef ANJAY_WITH_EST
     _anjay_log(anjay, TRACE, "ANJAY_WITH_EST = ON");
 #else // ANJAY_WITH_EST
@@ -144,6 +164,16 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_EVENT_LOOP
     _anjay_log(anjay, TRACE, "ANJAY_WITH_EVENT_LOOP = OFF");
 #endif // ANJAY_WITH_EVENT_LOOP
+#ifdef ANJAY_WITH_EVENT_LOOP_EPOLL
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_EVENT_LOOP_EPOLL = ON");
+#else // ANJAY_WITH_EVENT_LOOP_EPOLL
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_EVENT_LOOP_EPOLL = OFF");
+#endif // ANJAY_WITH_EVENT_LOOP_EPOLL
+#ifdef ANJAY_WITH_EVENT_LOOP_KQUEUE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_EVENT_LOOP_KQUEUE = ON");
+#else // ANJAY_WITH_EVENT_LOOP_KQUEUE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_EVENT_LOOP_KQUEUE = OFF");
+#endif // ANJAY_WITH_EVENT_LOOP_KQUEUE
 #ifdef ANJAY_WITH_HTTP_DOWNLOAD
     _anjay_log(anjay, TRACE, "ANJAY_WITH_HTTP_DOWNLOAD = ON");
 #else // ANJAY_WITH_HTTP_DOWNLOAD
@@ -154,6 +184,16 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_LEGACY_CONTENT_FORMAT_SUPPORT
     _anjay_log(anjay, TRACE, "ANJAY_WITH_LEGACY_CONTENT_FORMAT_SUPPORT = OFF");
 #endif // ANJAY_WITH_LEGACY_CONTENT_FORMAT_SUPPORT
+#ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_LOCK_FREE_NOTIFY = ON");
+#else // ANJAY_WITH_LOCK_FREE_NOTIFY
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_LOCK_FREE_NOTIFY = OFF");
+#endif // ANJAY_WITH_LOCK_FREE_NOTIFY
+#ifdef ANJAY_WITH_LOCK_STATS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_LOCK_STATS = ON");
+#else // ANJAY_WITH_LOCK_STATS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_LOCK_STATS = OFF");
+#endif // ANJAY_WITH_LOCK_STATS
 #ifdef ANJAY_WITH_LOGS
     _anjay_log(anjay, TRACE, "ANJAY_WITH_LOGS = ON");
 #else // ANJAY_WITH_LOGS
@@ -169,6 +209,16 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_LWM2M_JSON
     _anjay_log(anjay, TRACE, "ANJAY_WITH_LWM2M_JSON = OFF");
 #endif // ANJAY_WITH_LWM2M_JSON
+#ifdef ANJAY_WITH_LWM2M_CBOR
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_LWM2M_CBOR = ON");
+#else // ANJAY_WITH_LWM2M_CBOR
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_LWM2M_CBOR = OFF");
+#endif // ANJAY_WITH_LWM2M_CBOR
+#ifdef ANJAY_WITH_MEMORY_ACCOUNTING
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_MEMORY_ACCOUNTING = ON");
+#else // ANJAY_WITH_MEMORY_ACCOUNTING
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_MEMORY_ACCOUNTING = OFF");
+#endif // ANJAY_WITH_MEMORY_ACCOUNTING
 #ifdef ANJAY_WITH_MODULE_ACCESS_CONTROL
     _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_ACCESS_CONTROL = ON");
 #else // ANJAY_WITH_MODULE_ACCESS_CONTROL
@@ -189,11 +239,26 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_MODULE_BG96_NIDD
     _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_BG96_NIDD = OFF");
 #endif // ANJAY_WITH_MODULE_BG96_NIDD
+#ifdef ANJAY_WITH_MODULE_BINARY_APP_DATA_CONTAINER
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_BINARY_APP_DATA_CONTAINER = ON");
+#else // ANJAY_WITH_MODULE_BINARY_APP_DATA_CONTAINER
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_BINARY_APP_DATA_CONTAINER = OFF");
+#endif // ANJAY_WITH_MODULE_BINARY_APP_DATA_CONTAINER
 #ifdef ANJAY_WITH_MODULE_BOOTSTRAPPER
     _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_BOOTSTRAPPER = ON");
 #else // ANJAY_WITH_MODULE_BOOTSTRAPPER
     _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_BOOTSTRAPPER = OFF");
 #endif // ANJAY_WITH_MODULE_BOOTSTRAPPER
+#ifdef ANJAY_WITH_MODULE_CONN_STATISTICS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_CONN_STATISTICS = ON");
+#else // ANJAY_WITH_MODULE_CONN_STATISTICS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_CONN_STATISTICS = OFF");
+#endif // ANJAY_WITH_MODULE_CONN_STATISTICS
+#ifdef ANJAY_WITH_MODULE_EVENT_LOG
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_EVENT_LOG = ON");
+#else // ANJAY_WITH_MODULE_EVENT_LOG
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_EVENT_LOG = OFF");
+#endif // ANJAY_WITH_MODULE_EVENT_LOG
 #ifdef ANJAY_WITH_MODULE_FACTORY_PROVISIONING
     _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_FACTORY_PROVISIONING = ON");
 #else // ANJAY_WITH_MODULE_FACTORY_PROVISIONING
@@ -214,6 +279,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_MODULE_IPSO_OBJECTS_V2
     _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_IPSO_OBJECTS_V2 = OFF");
 #endif // ANJAY_WITH_MODULE_IPSO_OBJECTS_V2
+#ifdef ANJAY_WITH_MODULE_LWM2M_GATEWAY
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_LWM2M_GATEWAY = ON");
+#else // ANJAY_WITH_MODULE_LWM2M_GATEWAY
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_LWM2M_GATEWAY = OFF");
+#endif // ANJAY_WITH_MODULE_LWM2M_GATEWAY
 #ifdef ANJAY_WITH_MODULE_OSCORE
     _anjay_log(anjay, TRACE, "ANJAY_WITH_MODULE_OSCORE = ON");
 #else // ANJAY_WITH_MODULE_OSCORE
@@ -264,6 +334,21 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_OBSERVE
     _anjay_log(anjay, TRACE, "ANJAY_WITH_OBSERVE = OFF");
 #endif // ANJAY_WITH_OBSERVE
+#ifdef ANJAY_WITH_OBSERVE_PERSISTENCE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_OBSERVE_PERSISTENCE = ON");
+#else // ANJAY_WITH_OBSERVE_PERSISTENCE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_OBSERVE_PERSISTENCE = OFF");
+#endif // ANJAY_WITH_OBSERVE_PERSISTENCE
+#ifdef ANJAY_WITH_OPERATION_STATS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_OPERATION_STATS = ON");
+#else // ANJAY_WITH_OPERATION_STATS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_OPERATION_STATS = OFF");
+#endif // ANJAY_WITH_OPERATION_STATS
+#ifdef ANJAY_WITH_SCHED_STATS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_SCHED_STATS = ON");
+#else // ANJAY_WITH_SCHED_STATS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_SCHED_STATS = OFF");
+#endif // ANJAY_WITH_SCHED_STATS
 #ifdef ANJAY_WITH_SECURITY_STRUCTURED
     _anjay_log(anjay, TRACE, "ANJAY_WITH_SECURITY_STRUCTURED = ON");
 #else // ANJAY_WITH_SECURITY_STRUCTURED
@@ -274,6 +359,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_SEND
     _anjay_log(anjay, TRACE, "ANJAY_WITH_SEND = OFF");
 #endif // ANJAY_WITH_SEND
+#ifdef ANJAY_WITH_SEND_PERSISTENCE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_SEND_PERSISTENCE = ON");
+#else // ANJAY_WITH_SEND_PERSISTENCE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_SEND_PERSISTENCE = OFF");
+#endif // ANJAY_WITH_SEND_PERSISTENCE
 #ifdef ANJAY_WITH_SENML_JSON
     _anjay_log(anjay, TRACE, "ANJAY_WITH_SENML_JSON = ON");
 #else // ANJAY_WITH_SENML_JSON
@@ -289,17 +379,39 @@ static inline void _anjay_log_feature_list(void) {
 #else // ANJAY_WITH_SMS_MULTIPART
     _anjay_log(anjay, TRACE, "ANJAY_WITH_SMS_MULTIPART = OFF");
 #endif // ANJAY_WITH_SMS_MULTIPART
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_STARTUP_TIMESTAMP_API = ON");
+#else // ANJAY_WITH_STARTUP_TIMESTAMP_API
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_STARTUP_TIMESTAMP_API = OFF");
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+#ifdef ANJAY_WITH_STATE_PERSISTENCE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_STATE_PERSISTENCE = ON");
+#else // ANJAY_WITH_STATE_PERSISTENCE
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_STATE_PERSISTENCE = OFF");
+#endif // ANJAY_WITH_STATE_PERSISTENCE
 #ifdef ANJAY_WITH_THREAD_SAFETY
     _anjay_log(anjay, TRACE, "ANJAY_WITH_THREAD_SAFETY = ON");
 #else // ANJAY_WITH_THREAD_SAFETY
     _anjay_log(anjay, TRACE, "ANJAY_WITH_THREAD_SAFETY = OFF");
 #endif // ANJAY_WITH_THREAD_SAFETY
+#ifdef ANJAY_WITH_TRACEPOINTS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_TRACEPOINTS = ON");
+#else // ANJAY_WITH_TRACEPOINTS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_TRACEPOINTS = OFF");
+#endif // ANJAY_WITH_TRACEPOINTS
 #ifdef ANJAY_WITH_TRACE_LOGS
     _anjay_log(anjay, TRACE, "ANJAY_WITH_TRACE_LOGS = ON");
 #else // ANJAY_WITH_TRACE_LOGS
     _anjay_log(anjay, TRACE, "ANJAY_WITH_TRACE_LOGS = OFF");
 #endif // ANJAY_WITH_TRACE_LOGS
+#ifdef ANJAY_WITH_TRAFFIC_STATS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_TRAFFIC_STATS = ON");
+#else // ANJAY_WITH_TRAFFIC_STATS
+    _anjay_log(anjay, TRACE, "ANJAY_WITH_TRAFFIC_STATS = OFF");
+#endif // ANJAY_WITH_TRAFFIC_STATS
     _anjay_log(anjay, TRACE, "AVS_COAP_UDP_NOTIFY_CACHE_SIZE = " AVS_QUOTE_MACRO(AVS_COAP_UDP_NOTIFY_CACHE_SIZE));
+    _anjay_log(anjay, TRACE, "AVS_COAP_UDP_UNCONFIRMED_POOL_MSG_SIZE = " AVS_QUOTE_MACRO(AVS_COAP_UDP_UNCONFIRMED_POOL_MSG_SIZE));
+    _anjay_log(anjay, TRACE, "AVS_COAP_UDP_UNCONFIRMED_POOL_SIZE = " AVS_QUOTE_MACRO(AVS_COAP_UDP_UNCONFIRMED_POOL_SIZE));
 #ifdef AVS_COMMONS_BIG_ENDIAN
     _anjay_log(anjay, TRACE, "AVS_COMMONS_BIG_ENDIAN = ON");
 #else // AVS_COMMONS_BIG_ENDIAN
@@ -730,6 +842,11 @@ static inline void _anjay_log_feature_list(void) {
 #else // WITH_AVS_COAP_POISONING
     _anjay_log(anjay, TRACE, "WITH_AVS_COAP_POISONING = OFF");
 #endif // WITH_AVS_COAP_POISONING
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    _anjay_log(anjay, TRACE, "WITH_AVS_COAP_Q_BLOCK = ON");
+#else // WITH_AVS_COAP_Q_BLOCK
+    _anjay_log(anjay, TRACE, "WITH_AVS_COAP_Q_BLOCK = OFF");
+#endif // WITH_AVS_COAP_Q_BLOCK
 #ifdef WITH_AVS_COAP_STREAMING_API
     _anjay_log(anjay, TRACE, "WITH_AVS_COAP_STREAMING_API = ON");
 #else // WITH_AVS_COAP_STREAMING_API
@@ -16,6 +16,45 @@
 #    error "ANJAY_WITH_MODULE_ATTR_STORAGE has been removed since Anjay 3.0. Please update your anjay_config.h to use ANJAY_WITH_ATTR_STORAGE instead."
 #endif // ANJAY_WITH_MODULE_ATTR_STORAGE
 
+#if defined(ANJAY_WITH_OBSERVE_PERSISTENCE)               \
+        && (!defined(ANJAY_WITH_OBSERVE)                  \
+            || !defined(AVS_COMMONS_WITH_AVS_PERSISTENCE) \
+            || !defined(WITH_AVS_COAP_OBSERVE_PERSISTENCE))
+#    error "ANJAY_WITH_OBSERVE_PERSISTENCE requires ANJAY_WITH_OBSERVE, AVS_COMMONS_WITH_AVS_PERSISTENCE and WITH_AVS_COAP_OBSERVE_PERSISTENCE to be enabled"
+#endif
+
+#if defined(ANJAY_WITH_STATE_PERSISTENCE) \
+        && !defined(AVS_COMMONS_WITH_AVS_PERSISTENCE)
+#    error "ANJAY_WITH_STATE_PERSISTENCE requires AVS_COMMONS_WITH_AVS_PERSISTENCE to be enabled"
+#endif
+
+#if defined(ANJAY_WITH_MEMORY_ACCOUNTING)                      \
+        && (defined(AVS_COMMONS_UTILS_WITH_STANDARD_ALLOCATOR) \
+            || defined(AVS_COMMONS_UTILS_WITH_ALIGNFIX_ALLOCATOR))
+#    error "ANJAY_WITH_MEMORY_ACCOUNTING requires AVS_COMMONS_UTILS_WITH_STANDARD_ALLOCATOR and AVS_COMMONS_UTILS_WITH_ALIGNFIX_ALLOCATOR to be disabled"
+#endif
+
+#if defined(ANJAY_WITH_ALLOCATION_PROFILING) \
+        && !defined(ANJAY_WITH_MEMORY_ACCOUNTING)
+#    error "ANJAY_WITH_ALLOCATION_PROFILING requires ANJAY_WITH_MEMORY_ACCOUNTING to be enabled"
+#endif
+
+#if defined(ANJAY_WITH_DEFERRED_LOGS) && !defined(ANJAY_WITH_LOGS)
+#    error "ANJAY_WITH_DEFERRED_LOGS requires ANJAY_WITH_LOGS to be enabled"
+#endif
+
+#if defined(ANJAY_WITH_MODULE_CONN_STATISTICS) && !defined(ANJAY_WITH_NET_STATS)
+#    error "ANJAY_WITH_MODULE_CONN_STATISTICS requires ANJAY_WITH_NET_STATS to be enabled"
+#endif
+
+#if defined(ANJAY_WITH_TRAFFIC_STATS) && !defined(ANJAY_WITH_NET_STATS)
+#    error "ANJAY_WITH_TRAFFIC_STATS requires ANJAY_WITH_NET_STATS to be enabled"
+#endif
+
+#if defined(ANJAY_WITH_MODULE_LWM2M_GATEWAY) && !defined(ANJAY_WITH_LWM2M11)
+#    error "ANJAY_WITH_MODULE_LWM2M_GATEWAY requires ANJAY_WITH_LWM2M11 to be enabled"
+#endif
+
 #if defined(AVS_COMMONS_HAVE_VISIBILITY) && !defined(ANJAY_TEST)
 /* set default visibility for external symbols */
 #    pragma GCC visibility push(default)
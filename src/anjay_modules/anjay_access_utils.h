@@ -46,6 +46,15 @@ int _anjay_acl_ref_validate_inst_ref(anjay_unlocked_t *anjay,
                                      anjay_oid_t target_oid,
                                      anjay_iid_t target_iid);
 
+/**
+ * Drops the access permissions precomputed from the Access Control Object.
+ * Changes made through the data model or reported using anjay_notify_*()
+ * functions invalidate them automatically; this function shall be called by
+ * Access Control Object implementations that replace their state by other
+ * means, e.g. when restoring it from persistent storage.
+ */
+void _anjay_access_control_invalidate_cache(anjay_unlocked_t *anjay);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* ANJAY_INCLUDE_ANJAY_MODULES_ACCESS_UTILS_H */
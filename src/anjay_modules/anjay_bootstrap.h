@@ -30,8 +30,17 @@ int _anjay_bootstrap_finish(anjay_unlocked_t *anjay);
               defined(ANJAY_WITH_MODULE_FACTORY_PROVISIONING) */
 
 #    ifdef ANJAY_WITH_MODULE_FACTORY_PROVISIONING
+/**
+ * Writes all the records from @p in_ctx as part of the local bootstrap.
+ *
+ * If @p bulk is true, notifications and Last Bootstrapped updates are
+ * gathered and applied once after all the records are written, and the
+ * presence of an Instance is checked only once for consecutive records
+ * targeting it.
+ */
 int _anjay_bootstrap_write_composite(anjay_unlocked_t *anjay,
-                                     anjay_unlocked_input_ctx_t *in_ctx);
+                                     anjay_unlocked_input_ctx_t *in_ctx,
+                                     bool bulk);
 #    endif // ANJAY_WITH_MODULE_FACTORY_PROVISIONING
 
 #    ifdef ANJAY_WITH_LWM2M11
@@ -559,6 +559,9 @@ typedef enum {
     ANJAY_DM_HANDLER_resource_instance_read_attrs,
     ANJAY_DM_HANDLER_resource_instance_write_attrs,
 #endif // ANJAY_WITH_LWM2M11
+    ANJAY_DM_HANDLER_resource_read_many,
+    ANJAY_DM_HANDLER_instance_present,
+    ANJAY_DM_HANDLER_resource_read_instances,
 } anjay_dm_handler_t;
 
 /**
@@ -596,6 +599,9 @@ int _anjay_dm_call_object_write_default_attrs(
 int _anjay_dm_call_list_instances(anjay_unlocked_t *anjay,
                                   const anjay_dm_installed_object_t *obj_ptr,
                                   anjay_unlocked_dm_list_ctx_t *ctx);
+int _anjay_dm_call_instance_present(anjay_unlocked_t *anjay,
+                                    const anjay_dm_installed_object_t *obj_ptr,
+                                    anjay_iid_t iid);
 int _anjay_dm_call_instance_reset(anjay_unlocked_t *anjay,
                                   const anjay_dm_installed_object_t *obj_ptr,
                                   anjay_iid_t iid);
@@ -628,6 +634,18 @@ int _anjay_dm_call_resource_read(anjay_unlocked_t *anjay,
                                  anjay_rid_t rid,
                                  anjay_riid_t riid,
                                  anjay_unlocked_output_ctx_t *ctx);
+int _anjay_dm_call_resource_read_many(
+        anjay_unlocked_t *anjay,
+        const anjay_dm_installed_object_t *obj_ptr,
+        anjay_iid_t iid,
+        const anjay_rid_t *rids,
+        size_t rid_count);
+int _anjay_dm_call_resource_read_instances(
+        anjay_unlocked_t *anjay,
+        const anjay_dm_installed_object_t *obj_ptr,
+        anjay_iid_t iid,
+        anjay_rid_t rid,
+        anjay_dm_res_instances_t *out);
 int _anjay_dm_call_resource_write(anjay_unlocked_t *anjay,
                                   const anjay_dm_installed_object_t *obj_ptr,
                                   anjay_iid_t iid,
@@ -863,6 +881,15 @@ int _anjay_register_object_unlocked(
         anjay_unlocked_t *anjay,
         AVS_LIST(anjay_dm_installed_object_t) *elem_ptr_move);
 
+/**
+ * Rolls back the transaction on @p obj and removes it from the list of
+ * transaction participants, if it is a part of the currently running
+ * transaction. Shall be called before an Object that is about to be removed
+ * from the data model is freed.
+ */
+void _anjay_dm_transaction_remove_object(
+        anjay_unlocked_t *anjay, const anjay_dm_installed_object_t *obj);
+
 #ifdef ANJAY_WITH_SEND
 int _anjay_send_batch_data_add_current_unlocked(
         anjay_send_batch_builder_t *builder,
@@ -884,6 +911,15 @@ _anjay_send_deferrable_unlocked(anjay_unlocked_t *anjay,
                                 const anjay_send_batch_t *data,
                                 anjay_send_finished_handler_t *finished_handler,
                                 void *finished_handler_data);
+
+anjay_send_result_t
+_anjay_send_to_servers_unlocked(anjay_unlocked_t *anjay,
+                                const anjay_ssid_t *ssids,
+                                size_t ssids_count,
+                                const anjay_send_batch_t *data,
+                                bool deferrable,
+                                anjay_send_finished_handler_t *finished_handler,
+                                void *finished_handler_data);
 #endif // ANJAY_WITH_SEND
 
 void _anjay_dm_emit_unlocked(anjay_unlocked_dm_list_ctx_t *ctx, uint16_t id);
@@ -905,6 +941,12 @@ int _anjay_ret_bytes_unlocked(anjay_unlocked_output_ctx_t *ctx,
                               const void *data,
                               size_t length);
 
+int _anjay_ret_bytes_borrowed_unlocked(anjay_unlocked_output_ctx_t *ctx,
+                                       const void *data,
+                                       size_t length,
+                                       anjay_ret_bytes_release_t *release,
+                                       void *release_arg);
+
 int _anjay_ret_string_unlocked(anjay_unlocked_output_ctx_t *ctx,
                                const char *value);
 
@@ -966,6 +1008,11 @@ int _anjay_execute_get_arg_value_unlocked(anjay_unlocked_execute_ctx_t *ctx,
                                           char *out_buf,
                                           size_t buf_size);
 
+int _anjay_execute_get_arg_value_view_unlocked(
+        anjay_unlocked_execute_ctx_t *ctx,
+        const char **out_value,
+        size_t *out_value_size);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* ANJAY_INCLUDE_ANJAY_MODULES_DM_H */
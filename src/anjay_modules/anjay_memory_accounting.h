@@ -0,0 +1,75 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_MODULES_MEMORY_ACCOUNTING_H
+#define ANJAY_INCLUDE_ANJAY_MODULES_MEMORY_ACCOUNTING_H
+
+#include <anjay_init.h>
+
+#include <anjay/stats.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#ifdef ANJAY_WITH_MEMORY_ACCOUNTING
+
+/**
+ * Sets the subsystem to which subsequent allocations are attributed.
+ *
+ * @returns The previously set subsystem, to be restored with
+ *          @ref _anjay_memory_tag_leave .
+ */
+anjay_memory_tag_t _anjay_memory_tag_enter(anjay_memory_tag_t tag);
+
+void _anjay_memory_tag_leave(anjay_memory_tag_t previous_tag);
+
+/**
+ * Shall be used at the beginning of a subsystem entry point, paired with
+ * @ref ANJAY_MEMORY_TAG_LEAVE on every path that leaves it.
+ */
+#    define ANJAY_MEMORY_TAG_ENTER(PrevTagVar, Tag) \
+        const anjay_memory_tag_t PrevTagVar = _anjay_memory_tag_enter(Tag)
+
+#    define ANJAY_MEMORY_TAG_LEAVE(PrevTagVar) \
+        _anjay_memory_tag_leave(PrevTagVar)
+#else // ANJAY_WITH_MEMORY_ACCOUNTING
+#    define ANJAY_MEMORY_TAG_ENTER(PrevTagVar, Tag) ((void) 0)
+#    define ANJAY_MEMORY_TAG_LEAVE(PrevTagVar) ((void) 0)
+#endif // ANJAY_WITH_MEMORY_ACCOUNTING
+
+#ifdef ANJAY_WITH_ALLOCATION_PROFILING
+
+/**
+ * Sets the call site to which subsequent allocations are attributed. @p site
+ * shall be a string with static storage duration; sites are distinguished by
+ * the pointer value.
+ *
+ * @returns A value identifying the previously set site, to be restored with
+ *          @ref _anjay_allocation_site_leave .
+ */
+size_t _anjay_allocation_site_enter(const char *site);
+
+void _anjay_allocation_site_leave(size_t previous_site);
+
+/**
+ * Attributes allocations made until the matching
+ * @ref ANJAY_ALLOCATION_SITE_LEAVE to the enclosing function.
+ */
+#    define ANJAY_ALLOCATION_SITE_ENTER(PrevSiteVar) \
+        const size_t PrevSiteVar = _anjay_allocation_site_enter(__func__)
+
+#    define ANJAY_ALLOCATION_SITE_LEAVE(PrevSiteVar) \
+        _anjay_allocation_site_leave(PrevSiteVar)
+#else // ANJAY_WITH_ALLOCATION_PROFILING
+#    define ANJAY_ALLOCATION_SITE_ENTER(PrevSiteVar) ((void) 0)
+#    define ANJAY_ALLOCATION_SITE_LEAVE(PrevSiteVar) ((void) 0)
+#endif // ANJAY_WITH_ALLOCATION_PROFILING
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_INCLUDE_ANJAY_MODULES_MEMORY_ACCOUNTING_H */
@@ -18,8 +18,16 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 
 typedef struct {
     bool instance_set_changed;
+    /**
+     * Set if the instance set changed in a way not described by
+     * known_added_iids and known_removed_iids. If false, the two lists are
+     * exhaustive.
+     */
+    bool unknown_change;
     // NOTE: known_added_iids list may not be exhaustive
     AVS_LIST(anjay_iid_t) known_added_iids;
+    // NOTE: known_removed_iids list may not be exhaustive
+    AVS_LIST(anjay_iid_t) known_removed_iids;
 } anjay_notify_queue_instance_entry_t;
 
 typedef struct {
@@ -49,7 +57,10 @@ int _anjay_notify_perform(anjay_unlocked_t *anjay,
 
 /**
  * Works like @ref _anjay_notify_perform but doesn't call
- * server_modified_notify().
+ * server_modified_notify() and doesn't schedule reloading the servers. The
+ * caller is responsible for calling _anjay_schedule_reload_servers() once all
+ * the changes are processed, which allows e.g. Bootstrap-Finish to handle all
+ * of them in a single pass.
  */
 int _anjay_notify_perform_without_servers(anjay_unlocked_t *anjay,
                                           anjay_ssid_t origin_ssid,
@@ -67,6 +78,16 @@ int _anjay_notify_queue_instance_created(anjay_notify_queue_t *out_queue,
                                          anjay_oid_t oid,
                                          anjay_iid_t iid);
 
+/**
+ * Adds notifications about creation of multiple Instances of Object
+ * <c>oid</c>. <c>iids</c> MUST be sorted (duplicates are allowed), which allows
+ * merging them into the queue in a single pass.
+ */
+int _anjay_notify_queue_instances_created(anjay_notify_queue_t *out_queue,
+                                          anjay_oid_t oid,
+                                          const anjay_iid_t *iids,
+                                          size_t iid_count);
+
 int _anjay_notify_queue_instance_removed(anjay_notify_queue_t *out_queue,
                                          anjay_oid_t oid,
                                          anjay_iid_t iid);
@@ -83,12 +104,33 @@ int _anjay_notify_queue_resource_change(anjay_notify_queue_t *out_queue,
                                         anjay_iid_t iid,
                                         anjay_rid_t rid);
 
+/**
+ * Adds notifications about the change of value of multiple data model resources
+ * within Object <c>oid</c>. <c>entries</c> MUST be sorted by IID and RID
+ * (duplicates are allowed), which allows merging them into the queue in a
+ * single pass.
+ */
+int _anjay_notify_queue_resource_changes(
+        anjay_notify_queue_t *out_queue,
+        anjay_oid_t oid,
+        const anjay_notify_queue_resource_entry_t *entries,
+        size_t entry_count);
+
 void _anjay_notify_clear_queue(anjay_notify_queue_t *out_queue);
 
 int _anjay_notify_instance_created(anjay_unlocked_t *anjay,
                                    anjay_oid_t oid,
                                    anjay_iid_t iid);
 
+/**
+ * Schedules notifications about multiple Instances, listed in <c>iids</c>
+ * sorted in ascending order, having been created in Object <c>oid</c>.
+ */
+int _anjay_notify_instances_created(anjay_unlocked_t *anjay,
+                                    anjay_oid_t oid,
+                                    const anjay_iid_t *iids,
+                                    size_t iid_count);
+
 int _anjay_notify_changed_unlocked(anjay_unlocked_t *anjay,
                                    anjay_oid_t oid,
                                    anjay_iid_t iid,
@@ -97,6 +139,28 @@ int _anjay_notify_changed_unlocked(anjay_unlocked_t *anjay,
 int _anjay_notify_instances_changed_unlocked(anjay_unlocked_t *anjay,
                                              anjay_oid_t oid);
 
+#ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+int _anjay_notify_change_queue_init(anjay_unlocked_t *anjay, size_t size);
+
+void _anjay_notify_change_queue_cleanup(anjay_unlocked_t *anjay);
+
+/**
+ * Checks whether there may be any changes to drain, without locking the Anjay
+ * mutex.
+ */
+bool _anjay_notify_change_queue_pending(anjay_t *anjay);
+
+/**
+ * Moves all the changes queued by other threads into the regular notify queue
+ * and schedules it to be flushed.
+ *
+ * If a change cannot be queued (e.g. due to an out-of-memory condition), it
+ * and all the subsequent ones are kept in the lock-free queue, and retried
+ * during the next call.
+ */
+void _anjay_notify_change_queue_drain(anjay_unlocked_t *anjay);
+#endif // ANJAY_WITH_LOCK_FREE_NOTIFY
+
 typedef int anjay_notify_callback_t(anjay_unlocked_t *anjay,
                                     anjay_notify_queue_t queue,
                                     void *data);
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_MODULES_RUNNING_STATS_H
+#define ANJAY_INCLUDE_ANJAY_MODULES_RUNNING_STATS_H
+
+#include <anjay_init.h>
+
+#include <math.h>
+#include <stddef.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Incrementally computed count, mean and variance of a series of samples,
+ * using Welford's algorithm. Used by the IPSO sensor modules to maintain
+ * aggregates of sensor values without storing the samples themselves.
+ */
+typedef struct {
+    size_t count;
+    double mean;
+    // sum of squared differences from the mean
+    double m2;
+} anjay_running_stats_t;
+
+static inline void _anjay_running_stats_reset(anjay_running_stats_t *stats) {
+    stats->count = 0;
+    stats->mean = 0.0;
+    stats->m2 = 0.0;
+}
+
+static inline void _anjay_running_stats_add(anjay_running_stats_t *stats,
+                                            double value) {
+    ++stats->count;
+    const double delta = value - stats->mean;
+    stats->mean += delta / (double) stats->count;
+    stats->m2 += delta * (value - stats->mean);
+}
+
+/**
+ * @returns Mean of the samples, or NaN if there were none.
+ */
+static inline double
+_anjay_running_stats_mean(const anjay_running_stats_t *stats) {
+    return stats->count ? stats->mean : NAN;
+}
+
+/**
+ * @returns Population variance of the samples, or NaN if there were none.
+ */
+static inline double
+_anjay_running_stats_variance(const anjay_running_stats_t *stats) {
+    return stats->count ? stats->m2 / (double) stats->count : NAN;
+}
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_INCLUDE_ANJAY_MODULES_RUNNING_STATS_H */
@@ -38,6 +38,18 @@ typedef struct {
 
 avs_coap_ctx_t *_anjay_connection_get_coap(anjay_connection_ref_t ref);
 
+/**
+ * Copies the DTLS session resumption buffer of a given connection into
+ * @p out_buffer, so that it can be used to resume the session on another
+ * socket.
+ *
+ * @returns true if the buffer has been copied, false if the connection does
+ *          not exist or has no DTLS session cached.
+ */
+bool _anjay_connection_get_dtls_session(anjay_connection_ref_t ref,
+                                        char *out_buffer,
+                                        size_t buffer_size);
+
 /**
  * Reads security information (security mode, keys etc.) for a given Security
  * object instance. This is part of the servers subsystem because it reuses some
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_INCLUDE_ANJAY_MODULES_SHA256_H
+#define ANJAY_INCLUDE_ANJAY_MODULES_SHA256_H
+
+#include <anjay_init.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#define ANJAY_SHA256_DIGEST_SIZE 32
+
+/**
+ * Streaming SHA-256 context, used by the firmware and software update modules
+ * to compute package digests while the package is being written.
+ */
+typedef struct {
+    uint32_t state[8];
+    uint64_t total_size;
+    uint8_t block[64];
+    size_t block_size;
+} anjay_sha256_t;
+
+void _anjay_sha256_init(anjay_sha256_t *ctx);
+
+void _anjay_sha256_update(anjay_sha256_t *ctx, const void *data, size_t size);
+
+/**
+ * Writes the digest of all data passed to @ref _anjay_sha256_update since
+ * @ref _anjay_sha256_init to @p out_digest . The context needs to be
+ * initialized again before it can be reused.
+ */
+void _anjay_sha256_finish(anjay_sha256_t *ctx,
+                          uint8_t out_digest[ANJAY_SHA256_DIGEST_SIZE]);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_INCLUDE_ANJAY_MODULES_SHA256_H */
@@ -10,14 +10,16 @@
 #ifndef ANJAY_INCLUDE_ANJAY_MODULES_UTILS_CORE_H
 #define ANJAY_INCLUDE_ANJAY_MODULES_UTILS_CORE_H
 
-#ifdef ANJAY_WITH_EVENT_LOOP
+#if defined(ANJAY_WITH_EVENT_LOOP) || defined(ANJAY_WITH_LOCK_FREE_NOTIFY)
 #    include <stdatomic.h>
-#endif // ANJAY_WITH_EVENT_LOOP
+#endif // defined(ANJAY_WITH_EVENT_LOOP) ||
+       // defined(ANJAY_WITH_LOCK_FREE_NOTIFY)
 
 #include <avsystem/commons/avs_list.h>
 #include <avsystem/commons/avs_url.h>
 
 #ifdef ANJAY_WITH_THREAD_SAFETY
+#    include <avsystem/commons/avs_condvar.h>
 #    include <avsystem/commons/avs_mutex.h>
 #endif // ANJAY_WITH_THREAD_SAFETY
 
@@ -65,16 +67,57 @@ typedef enum {
 } anjay_event_loop_status_t;
 #endif // ANJAY_WITH_EVENT_LOOP
 
+#ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+typedef struct {
+    /**
+     * Position in the queue for which this entry holds a change (if equal to
+     * <c>position + 1</c>), or is free to be written (if equal to
+     * <c>position</c>).
+     */
+    atomic_size_t sequence;
+    anjay_oid_t oid;
+    /**
+     * ANJAY_ID_INVALID if this entry represents a change of the set of
+     * instances, as reported by anjay_notify_instances_changed().
+     */
+    anjay_iid_t iid;
+    anjay_rid_t rid;
+} anjay_notify_change_queue_entry_t;
+
+/**
+ * Bounded multi-producer single-consumer queue of data model changes reported
+ * by anjay_notify_changed() and anjay_notify_instances_changed() without
+ * locking the Anjay mutex. Drained into anjay_unlocked_t::scheduled_notify by
+ * _anjay_notify_change_queue_drain().
+ */
+typedef struct {
+    anjay_notify_change_queue_entry_t *entries;
+    /**
+     * Number of entries minus one; the number of entries is a power of two.
+     */
+    size_t mask;
+    atomic_size_t enqueue_pos;
+    /**
+     * Only modified by the consumer, with the Anjay mutex locked.
+     */
+    atomic_size_t dequeue_pos;
+} anjay_notify_change_queue_t;
+#endif // ANJAY_WITH_LOCK_FREE_NOTIFY
+
 // Please update this condition if anjay_atomic_fields_t ever gets more fields
-#if defined(ANJAY_WITH_EVENT_LOOP)
+#if defined(ANJAY_WITH_EVENT_LOOP) || defined(ANJAY_WITH_LOCK_FREE_NOTIFY)
 #    define ANJAY_ATOMIC_FIELDS_DEFINED
-#endif // defined(ANJAY_WITH_EVENT_LOOP)
+#endif // defined(ANJAY_WITH_EVENT_LOOP) ||
+       // defined(ANJAY_WITH_LOCK_FREE_NOTIFY)
 
 #ifdef ANJAY_ATOMIC_FIELDS_DEFINED
 typedef struct {
 #    ifdef ANJAY_WITH_EVENT_LOOP
     volatile atomic_int event_loop_status;
 #    endif // ANJAY_WITH_EVENT_LOOP
+#    ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+    anjay_notify_change_queue_t notify_change_queue;
+#    endif // ANJAY_WITH_LOCK_FREE_NOTIFY
 } anjay_atomic_fields_t;
 #endif // ANJAY_ATOMIC_FIELDS_DEFINED
 
@@ -83,7 +126,25 @@ typedef struct {
 typedef struct anjay_unlocked_struct anjay_unlocked_t;
 
 struct anjay_struct {
+    /**
+     * Exclusive lock - held by all ANJAY_MUTEX_LOCK() sections. It is also
+     * taken briefly by ANJAY_MUTEX_LOCK_SHARED() so that no new shared
+     * sections may begin while an exclusive one is pending.
+     */
     avs_mutex_t *mutex;
+    /**
+     * Guards shared_lock_holders. shared_lock_released is signalled whenever
+     * it drops to zero, which is awaited by _anjay_lock_exclusive().
+     */
+    avs_mutex_t *shared_lock_mutex;
+    avs_condvar_t *shared_lock_released;
+    size_t shared_lock_holders;
+#    ifdef ANJAY_WITH_LOCK_STATS
+    /**
+     * Only accessed with the exclusive lock held.
+     */
+    struct anjay_lock_stats_struct *lock_stats;
+#    endif // ANJAY_WITH_LOCK_STATS
 #    ifdef ANJAY_ATOMIC_FIELDS_DEFINED
     anjay_atomic_fields_t atomic_fields;
 #    endif // ANJAY_ATOMIC_FIELDS_DEFINED
@@ -92,6 +153,56 @@ struct anjay_struct {
 
 void _anjay_reschedule_coap_sched_job(anjay_unlocked_t *anjay);
 
+/**
+ * Locks the Anjay object for exclusive access: takes the main mutex and waits
+ * until all the read-only sections entered with ANJAY_MUTEX_LOCK_SHARED() have
+ * finished.
+ *
+ * @returns 0 on success, negative value on failure.
+ */
+int _anjay_lock_exclusive(anjay_t *anjay);
+
+/**
+ * Locks the Anjay object for shared access. Any number of shared sections may
+ * run concurrently with each other, but never concurrently with an exclusive
+ * one.
+ *
+ * This is used by ANJAY_MUTEX_LOCK_SHARED(), which shall only wrap read-only
+ * queries: code run within it MUST NOT modify any state (including lazily
+ * updated caches, see anjay_unlocked_t::shared_lock_held), call any user
+ * callbacks or use ANJAY_MUTEX_UNLOCK_FOR_CALLBACK().
+ *
+ * @returns 0 on success, negative value on failure.
+ */
+int _anjay_lock_shared(anjay_t *anjay);
+
+void _anjay_unlock_shared(anjay_t *anjay);
+
+#    ifdef ANJAY_WITH_LOCK_STATS
+/**
+ * Variant of _anjay_lock_exclusive() that records the time spent waiting for
+ * the lock, and remembers @p function (which MUST be a string with static
+ * storage duration, i.e. __func__) as the current lock holder.
+ */
+int _anjay_lock_exclusive_with_stats(anjay_t *anjay, const char *function);
+
+/**
+ * Records the time the lock has been held by the current holder and releases
+ * the lock taken with _anjay_lock_exclusive_with_stats().
+ */
+void _anjay_unlock_exclusive_with_stats(anjay_t *anjay);
+
+#        define ANJAY_MUTEX_LOCK_IMPL(AnjayLockedVar) \
+            _anjay_lock_exclusive_with_stats((AnjayLockedVar), __func__)
+#        define ANJAY_MUTEX_UNLOCK_IMPL(AnjayLockedVar) \
+            _anjay_unlock_exclusive_with_stats(AnjayLockedVar)
+#    else // ANJAY_WITH_LOCK_STATS
+#        define ANJAY_MUTEX_LOCK_IMPL(AnjayLockedVar) \
+            _anjay_lock_exclusive(AnjayLockedVar)
+#        define ANJAY_MUTEX_UNLOCK_IMPL(AnjayLockedVar) \
+            avs_mutex_unlock((AnjayLockedVar)->mutex)
+#    endif // ANJAY_WITH_LOCK_STATS
+
 #    ifdef ANJAY_WITH_NESTED_FUNCTION_MUTEX_LOCKS
 
 // We are compiling on a reasonably recent version of GCC in Debug mode.
@@ -126,7 +237,7 @@ typedef struct {
             AVS_PRAGMA(GCC diagnostic pop)                              \
             }                                                           \
             if (!(AnjayLockedVar)                                       \
-                    || avs_mutex_lock((AnjayLockedVar)->mutex)) {       \
+                    || ANJAY_MUTEX_LOCK_IMPL(AnjayLockedVar)) {         \
                 _anjay_log(anjay, ERROR, _("Could not lock mutex"));    \
             } else {                                                    \
                 mutex_lock_nested_function(                             \
@@ -135,7 +246,7 @@ typedef struct {
                 _anjay_reschedule_coap_sched_job(                       \
                         (anjay_unlocked_t *) &(AnjayLockedVar)          \
                                 ->anjay_unlocked_placeholder);          \
-                avs_mutex_unlock((AnjayLockedVar)->mutex);              \
+                ANJAY_MUTEX_UNLOCK_IMPL(AnjayLockedVar);                \
             }                                                           \
             }                                                           \
             (void) 0
@@ -156,10 +267,10 @@ typedef struct {
                 mutex_unlock_for_callback_nested_function(                 \
                         anjay_t *AnjayLockedVar) {                         \
                     AVS_PRAGMA(GCC diagnostic pop)                         \
-                    avs_mutex_unlock((AnjayLockedVar)->mutex)
+                    ANJAY_MUTEX_UNLOCK_IMPL(AnjayLockedVar)
 
 #        define ANJAY_MUTEX_LOCK_AFTER_CALLBACK(AnjayLockedVar)         \
-            if (avs_mutex_lock(AnjayLockedVar->mutex)) {                \
+            if (ANJAY_MUTEX_LOCK_IMPL(AnjayLockedVar)) {                \
                 _anjay_log(anjay, ERROR, _("Could not lock mutex"));    \
             }                                                           \
             AVS_PRAGMA(GCC diagnostic push)                             \
@@ -170,6 +281,35 @@ typedef struct {
             }                                                           \
             (void) 0
 
+#        define ANJAY_MUTEX_LOCK_SHARED(AnjayUnlockedVar, AnjayLockedVar) \
+            {                                                             \
+                AVS_PRAGMA(GCC diagnostic push)                           \
+                AVS_PRAGMA(GCC diagnostic ignored "-Wpedantic")           \
+                AVS_PRAGMA(GCC diagnostic ignored "-Wshadow")             \
+                inline anjay_gcc_nested_function_retval_placeholder_t     \
+                mutex_lock_shared_nested_function(                        \
+                        anjay_unlocked_t *AnjayUnlockedVar) {             \
+                    AVS_PRAGMA(GCC diagnostic pop)                        \
+                    (void) AnjayUnlockedVar
+
+#        define ANJAY_MUTEX_UNLOCK_SHARED(AnjayLockedVar)               \
+            AVS_PRAGMA(GCC diagnostic push)                             \
+            AVS_PRAGMA(GCC diagnostic ignored "-Wpedantic")             \
+            return (anjay_gcc_nested_function_retval_placeholder_t) {}; \
+            AVS_PRAGMA(GCC diagnostic pop)                              \
+            }                                                           \
+            if (!(AnjayLockedVar)                                       \
+                    || _anjay_lock_shared(AnjayLockedVar)) {            \
+                _anjay_log(anjay, ERROR, _("Could not lock mutex"));    \
+            } else {                                                    \
+                mutex_lock_shared_nested_function(                      \
+                        (anjay_unlocked_t *) &(AnjayLockedVar)          \
+                                ->anjay_unlocked_placeholder);          \
+                _anjay_unlock_shared(AnjayLockedVar);                   \
+            }                                                           \
+            }                                                           \
+            (void) 0
+
 #    else // ANJAY_WITH_NESTED_FUNCTION_MUTEX_LOCKS
 
 // We are either not compiling on GCC, or we are compiling in Release mode.
@@ -178,7 +318,7 @@ typedef struct {
 
 #        define ANJAY_MUTEX_LOCK(AnjayUnlockedVar, AnjayLockedVar)   \
             if (!(AnjayLockedVar)                                    \
-                    || avs_mutex_lock((AnjayLockedVar)->mutex)) {    \
+                    || ANJAY_MUTEX_LOCK_IMPL(AnjayLockedVar)) {      \
                 _anjay_log(anjay, ERROR, _("Could not lock mutex")); \
             } else {                                                 \
                 anjay_unlocked_t *AnjayUnlockedVar =                 \
@@ -190,7 +330,7 @@ typedef struct {
             _anjay_reschedule_coap_sched_job(              \
                     (anjay_unlocked_t *) &(AnjayLockedVar) \
                             ->anjay_unlocked_placeholder); \
-            avs_mutex_unlock((AnjayLockedVar)->mutex);     \
+            ANJAY_MUTEX_UNLOCK_IMPL(AnjayLockedVar);       \
             }                                              \
             (void) 0
 
@@ -201,15 +341,30 @@ typedef struct {
                         AVS_CONTAINER_OF(AnjayUnlockedVar,            \
                                          anjay_t,                     \
                                          anjay_unlocked_placeholder); \
-                avs_mutex_unlock(AnjayLockedVar->mutex)
+                ANJAY_MUTEX_UNLOCK_IMPL(AnjayLockedVar)
 
 #        define ANJAY_MUTEX_LOCK_AFTER_CALLBACK(AnjayLockedVar)      \
-            if (avs_mutex_lock(AnjayLockedVar->mutex)) {             \
+            if (ANJAY_MUTEX_LOCK_IMPL(AnjayLockedVar)) {             \
                 _anjay_log(anjay, ERROR, _("Could not lock mutex")); \
             }                                                        \
             }                                                        \
             (void) 0
 
+#        define ANJAY_MUTEX_LOCK_SHARED(AnjayUnlockedVar, AnjayLockedVar) \
+            if (!(AnjayLockedVar)                                         \
+                    || _anjay_lock_shared(AnjayLockedVar)) {              \
+                _anjay_log(anjay, ERROR, _("Could not lock mutex"));      \
+            } else {                                                      \
+                anjay_unlocked_t *AnjayUnlockedVar =                      \
+                        (anjay_unlocked_t *) &(AnjayLockedVar)            \
+                                ->anjay_unlocked_placeholder;             \
+                (void) AnjayUnlockedVar
+
+#        define ANJAY_MUTEX_UNLOCK_SHARED(AnjayLockedVar) \
+            _anjay_unlock_shared(AnjayLockedVar);         \
+            }                                             \
+            (void) 0
+
 #    endif // ANJAY_WITH_NESTED_FUNCTION_MUTEX_LOCKS
 
 #else // ANJAY_WITH_THREAD_SAFETY
@@ -239,6 +394,9 @@ typedef anjay_t anjay_unlocked_t;
         }                                                   \
         (void) 0
 
+#    define ANJAY_MUTEX_LOCK_SHARED ANJAY_MUTEX_LOCK
+#    define ANJAY_MUTEX_UNLOCK_SHARED ANJAY_MUTEX_UNLOCK
+
 #endif // ANJAY_WITH_THREAD_SAFETY
 
 typedef enum {
@@ -360,6 +518,11 @@ typedef struct {
     bool use_system_wide;
     AVS_LIST(avs_crypto_certificate_chain_info_t) certs;
     AVS_LIST(avs_crypto_cert_revocation_list_info_t) crls;
+    /**
+     * Incremented each time the contents of the trust store change, so that
+     * data derived from it (e.g. client certificate chains) can be rebuilt.
+     */
+    size_t generation;
 } anjay_trust_store_t;
 
 const anjay_trust_store_t *
@@ -389,6 +552,17 @@ void _anjay_find_matching_coap_context_and_socket(
         avs_coap_ctx_t **out_coap,
         avs_net_socket_t **out_socket);
 
+/**
+ * Looks for an LwM2M Server connection to the same service as @p raw_url and
+ * copies its DTLS session resumption buffer into @p out_buffer.
+ *
+ * @returns true if a session has been found, false otherwise.
+ */
+bool _anjay_find_matching_dtls_session(anjay_unlocked_t *anjay,
+                                       const char *raw_url,
+                                       char *out_buffer,
+                                       size_t buffer_size);
+
 typedef struct {
     avs_crypto_psk_key_info_t *psk_key;
     avs_crypto_psk_identity_info_t *psk_identity;
@@ -418,12 +592,35 @@ void _anjay_download_suspend_unlocked(anjay_unlocked_t *anjay,
 
 int _anjay_download_reconnect_unlocked(anjay_unlocked_t *anjay,
                                        anjay_download_handle_t dl_handle);
+
+avs_error_t _anjay_download_get_stats_unlocked(
+        anjay_unlocked_t *anjay,
+        anjay_download_handle_t dl_handle,
+        anjay_download_stats_t *out_stats);
 #endif // ANJAY_WITH_DOWNLOADER
 
 bool _anjay_ongoing_registration_exists_unlocked(anjay_unlocked_t *anjay);
 
 avs_sched_t *_anjay_get_scheduler_unlocked(anjay_unlocked_t *anjay);
 
+#ifdef ANJAY_WITH_NET_STATS
+/**
+ * Traffic statistics of all connections, current and closed ones, as returned
+ * by the respective public functions declared in <c>anjay/stats.h</c>.
+ */
+typedef struct {
+    uint64_t tx_bytes;
+    uint64_t rx_bytes;
+    uint64_t sent_messages;
+    uint64_t received_messages;
+    uint64_t total_messages_size;
+    uint64_t max_message_size;
+} anjay_net_traffic_stats_t;
+
+void _anjay_get_net_traffic_stats_unlocked(anjay_unlocked_t *anjay,
+                                           anjay_net_traffic_stats_t *out);
+#endif // ANJAY_WITH_NET_STATS
+
 void _anjay_log_oom(void);
 
 VISIBILITY_PRIVATE_HEADER_END
@@ -137,6 +137,10 @@ anjay_unlocked_dm_list_instances_t(anjay_unlocked_t *anjay,
                                    const anjay_dm_installed_object_t obj,
                                    anjay_unlocked_dm_list_ctx_t *ctx);
 typedef int
+anjay_unlocked_dm_instance_present_t(anjay_unlocked_t *anjay,
+                                     const anjay_dm_installed_object_t obj,
+                                     anjay_iid_t iid);
+typedef int
 anjay_unlocked_dm_instance_reset_t(anjay_unlocked_t *anjay,
                                    const anjay_dm_installed_object_t obj,
                                    anjay_iid_t iid);
@@ -173,6 +177,18 @@ anjay_unlocked_dm_resource_read_t(anjay_unlocked_t *anjay,
                                   anjay_riid_t riid,
                                   anjay_unlocked_output_ctx_t *ctx);
 typedef int
+anjay_unlocked_dm_resource_read_many_t(anjay_unlocked_t *anjay,
+                                       const anjay_dm_installed_object_t obj,
+                                       anjay_iid_t iid,
+                                       const anjay_rid_t *rids,
+                                       size_t rid_count);
+typedef int anjay_unlocked_dm_resource_read_instances_t(
+        anjay_unlocked_t *anjay,
+        const anjay_dm_installed_object_t obj,
+        anjay_iid_t iid,
+        anjay_rid_t rid,
+        anjay_dm_res_instances_t *out);
+typedef int
 anjay_unlocked_dm_resource_write_t(anjay_unlocked_t *anjay,
                                    const anjay_dm_installed_object_t obj,
                                    anjay_iid_t iid,
@@ -271,6 +287,9 @@ typedef struct {
     anjay_unlocked_dm_resource_instance_write_attrs_t
             *resource_instance_write_attrs;
 #    endif // ANJAY_WITH_LWM2M11
+    anjay_unlocked_dm_resource_read_many_t *resource_read_many;
+    anjay_unlocked_dm_instance_present_t *instance_present;
+    anjay_unlocked_dm_resource_read_instances_t *resource_read_instances;
 } anjay_unlocked_dm_handlers_t;
 #endif // ANJAY_WITH_THREAD_SAFETY
 
@@ -308,6 +327,43 @@ int _anjay_dm_module_uninstall(anjay_unlocked_t *anjay,
 void *_anjay_dm_module_get_arg(anjay_unlocked_t *anjay,
                                anjay_dm_module_deleter_t *module_deleter);
 
+#ifdef ANJAY_WITH_MODULE_LWM2M_GATEWAY
+/**
+ * Looks up an Object in the data model addressed by a prefixed Uri-Path, i.e.
+ * the data model of an LwM2M Gateway End Device.
+ *
+ * @param anjay              Anjay object to operate on
+ *
+ * @param arg                Opaque pointer passed to
+ *                           @ref _anjay_dm_set_prefix_resolver
+ *
+ * @param prefix             First, non-numeric Uri-Path segment of the request
+ *
+ * @param oid                Object ID to look up
+ *
+ * @param out_gateway_iid    Set to the Instance ID of the LwM2M Gateway object
+ *                           that represents the addressed End Device, if it
+ *                           exists
+ *
+ * @returns Object with the given @p oid registered in the addressed data
+ *          model, or NULL if there is no such data model or Object.
+ */
+typedef const anjay_dm_installed_object_t *
+anjay_dm_prefix_resolver_t(anjay_unlocked_t *anjay,
+                           void *arg,
+                           const char *prefix,
+                           anjay_oid_t oid,
+                           anjay_iid_t *out_gateway_iid);
+
+/**
+ * Sets the function used to route requests with prefixed Uri-Paths. Only one
+ * resolver may be set at a time; passing NULL removes it.
+ */
+void _anjay_dm_set_prefix_resolver(anjay_unlocked_t *anjay,
+                                   anjay_dm_prefix_resolver_t *resolver,
+                                   void *arg);
+#endif // ANJAY_WITH_MODULE_LWM2M_GATEWAY
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* ANJAY_INCLUDE_ANJAY_MODULES_DM_MODULES_H */
@@ -10,6 +10,10 @@
 #include <anjay_init.h>
 
 #include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_memory.h>
 
 #include <anjay_modules/anjay_access_utils.h>
 #include <anjay_modules/anjay_raw_buffer.h>
@@ -259,15 +263,229 @@ static int get_mask(anjay_unlocked_t *anjay,
     return 0;
 }
 
+typedef struct {
+    anjay_dm_cached_acl_entry_t entry;
+    // index of the Access Control Object Instance the entry comes from
+    size_t ac_index;
+} acl_cache_build_entry_t;
+
+typedef struct {
+    acl_cache_build_entry_t *entries;
+    size_t entry_count;
+    size_t entry_capacity;
+    size_t ac_index;
+    anjay_oid_t target_oid;
+    anjay_iid_t target_iid;
+} build_acl_cache_args_t;
+
+static int append_acl_cache_entry(build_acl_cache_args_t *args,
+                                  anjay_ssid_t ssid,
+                                  anjay_access_mask_t mask) {
+    if (args->entry_count == args->entry_capacity) {
+        size_t new_capacity =
+                args->entry_capacity ? 2 * args->entry_capacity : 8;
+        acl_cache_build_entry_t *new_entries = (acl_cache_build_entry_t *)
+                avs_realloc(args->entries,
+                            new_capacity * sizeof(*args->entries));
+        if (!new_entries) {
+            _anjay_log_oom();
+            return -1;
+        }
+        args->entries = new_entries;
+        args->entry_capacity = new_capacity;
+    }
+    args->entries[args->entry_count++] = (acl_cache_build_entry_t) {
+        .entry = {
+            .oid = args->target_oid,
+            .iid = args->target_iid,
+            .ssid = ssid,
+            .mask = mask
+        },
+        .ac_index = args->ac_index
+    };
+    return 0;
+}
+
+static int build_acl_cache_acl_clb(anjay_unlocked_t *anjay,
+                                   const anjay_dm_installed_object_t *obj,
+                                   anjay_iid_t iid,
+                                   anjay_rid_t rid,
+                                   anjay_riid_t riid,
+                                   void *args) {
+    anjay_access_mask_t mask;
+    int result = read_mask(anjay, obj, iid, rid, riid, &mask);
+    if (result) {
+        return result;
+    }
+    return append_acl_cache_entry((build_acl_cache_args_t *) args,
+                                  (anjay_ssid_t) riid, mask);
+}
+
+static int build_acl_cache_instance_clb(anjay_unlocked_t *anjay,
+                                        const anjay_dm_installed_object_t *obj,
+                                        anjay_iid_t ac_iid,
+                                        void *args_) {
+    build_acl_cache_args_t *args = (build_acl_cache_args_t *) args_;
+    int result = read_ids_from_ac_instance(anjay, ac_iid, &args->target_oid,
+                                           &args->target_iid, NULL);
+    if (result) {
+        return result;
+    }
+    size_t first_entry = args->entry_count;
+    if ((result = foreach_acl(anjay, obj, ac_iid, build_acl_cache_acl_clb,
+                              args))) {
+        return result;
+    }
+    if (args->entry_count == first_entry) {
+        // Empty ACL: only the owner has access; if the owner cannot be read,
+        // a default entry with no permissions denies access to everyone
+        anjay_ssid_t owner;
+        if (read_ids_from_ac_instance(anjay, ac_iid, NULL, NULL, &owner)) {
+            result = append_acl_cache_entry(args, 0, ANJAY_ACCESS_MASK_NONE);
+        } else {
+            result = append_acl_cache_entry(
+                    args, owner,
+                    ANJAY_ACCESS_MASK_FULL & ~ANJAY_ACCESS_MASK_CREATE);
+        }
+    }
+    ++args->ac_index;
+    return result;
+}
+
+static int compare_acl_cache_key(anjay_oid_t oid,
+                                 anjay_iid_t iid,
+                                 anjay_ssid_t ssid,
+                                 const anjay_dm_cached_acl_entry_t *entry) {
+    if (oid != entry->oid) {
+        return oid < entry->oid ? -1 : 1;
+    } else if (iid != entry->iid) {
+        return iid < entry->iid ? -1 : 1;
+    } else if (ssid != entry->ssid) {
+        return ssid < entry->ssid ? -1 : 1;
+    }
+    return 0;
+}
+
+static int compare_acl_cache_build_entries(const void *left_,
+                                           const void *right_) {
+    const acl_cache_build_entry_t *left =
+            (const acl_cache_build_entry_t *) left_;
+    const acl_cache_build_entry_t *right =
+            (const acl_cache_build_entry_t *) right_;
+    if (left->entry.oid != right->entry.oid
+            || left->entry.iid != right->entry.iid) {
+        return compare_acl_cache_key(left->entry.oid, left->entry.iid, 0,
+                                     &right->entry);
+    } else if (left->ac_index != right->ac_index) {
+        return left->ac_index < right->ac_index ? -1 : 1;
+    }
+    return compare_acl_cache_key(left->entry.oid, left->entry.iid,
+                                 left->entry.ssid, &right->entry);
+}
+
+/**
+ * Reads the whole Access Control Object in a single pass and stores its
+ * contents in the ACL cache, so that subsequent calls to
+ * @ref access_control_mask do not need to access the data model until the
+ * Object changes.
+ */
+static int rebuild_acl_cache(anjay_unlocked_t *anjay,
+                             const anjay_dm_installed_object_t *ac_obj) {
+    uint32_t generation = anjay->dm.acl.generation;
+    build_acl_cache_args_t args = {
+        .entries = NULL
+    };
+    int result = _anjay_dm_foreach_instance(
+            anjay, ac_obj, build_acl_cache_instance_clb, &args);
+    anjay_dm_cached_acl_entry_t *entries = NULL;
+    size_t entry_count = 0;
+    if (!result && args.entry_count
+            && !(entries = (anjay_dm_cached_acl_entry_t *) avs_malloc(
+                         args.entry_count * sizeof(*entries)))) {
+        _anjay_log_oom();
+        result = -1;
+    }
+    if (!result) {
+        qsort(args.entries, args.entry_count, sizeof(*args.entries),
+              compare_acl_cache_build_entries);
+        for (size_t i = 0; i < args.entry_count; ++i) {
+            const acl_cache_build_entry_t *it = &args.entries[i];
+            if (i > 0 && it->entry.oid == it[-1].entry.oid
+                    && it->entry.iid == it[-1].entry.iid
+                    && it->ac_index != it[-1].ac_index) {
+                // more than one Access Control Object Instance refers to the
+                // same target; the first one is authoritative, mirroring the
+                // lookup in find_ac_instance_by_target()
+                while (i + 1 < args.entry_count
+                       && args.entries[i + 1].entry.oid == it->entry.oid
+                       && args.entries[i + 1].entry.iid == it->entry.iid) {
+                    ++i;
+                }
+                continue;
+            }
+            entries[entry_count++] = it->entry;
+        }
+        _anjay_dm_cache_store_acl(anjay, generation, entries, entry_count);
+    }
+    avs_free(args.entries);
+    return result;
+}
+
+static const anjay_dm_cached_acl_entry_t *
+find_cached_acl_entry(const anjay_dm_acl_cache_t *cache,
+                      anjay_oid_t oid,
+                      anjay_iid_t iid,
+                      anjay_ssid_t ssid) {
+    size_t lower = 0;
+    size_t upper = cache->entry_count;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        int diff = compare_acl_cache_key(oid, iid, ssid,
+                                         &cache->entries[middle]);
+        if (!diff) {
+            return &cache->entries[middle];
+        } else if (diff < 0) {
+            upper = middle;
+        } else {
+            lower = middle + 1;
+        }
+    }
+    return NULL;
+}
+
+static anjay_access_mask_t
+cached_access_control_mask(const anjay_dm_acl_cache_t *cache,
+                           anjay_oid_t oid,
+                           anjay_iid_t iid,
+                           anjay_ssid_t ssid) {
+    assert(cache->valid);
+    const anjay_dm_cached_acl_entry_t *entry;
+    if ((entry = find_cached_acl_entry(cache, oid, iid, ssid))
+            || (entry = find_cached_acl_entry(cache, oid, iid, 0))) {
+        return entry->mask;
+    }
+    return ANJAY_ACCESS_MASK_NONE;
+}
+
 static anjay_access_mask_t access_control_mask(anjay_unlocked_t *anjay,
                                                anjay_oid_t oid,
                                                anjay_iid_t iid,
                                                anjay_ssid_t ssid) {
     const anjay_dm_installed_object_t *ac_obj =
             _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_ACCESS_CONTROL);
+    if (!ac_obj) {
+        return ANJAY_ACCESS_MASK_NONE;
+    }
+    if (!anjay->dm.acl.valid) {
+        // on failure, fall back to reading the data model directly below
+        rebuild_acl_cache(anjay, ac_obj);
+    }
+    if (anjay->dm.acl.valid) {
+        return cached_access_control_mask(&anjay->dm.acl, oid, iid, ssid);
+    }
+
     anjay_iid_t ac_iid;
-    if (!ac_obj
-            || find_ac_instance_by_target(anjay, ac_obj, &ac_iid, oid, iid)) {
+    if (find_ac_instance_by_target(anjay, ac_obj, &ac_iid, oid, iid)) {
         return ANJAY_ACCESS_MASK_NONE;
     }
 
@@ -326,6 +544,14 @@ static bool is_single_ssid_environment(anjay_unlocked_t *anjay) {
     return non_bootstrap_count == 1;
 }
 
+bool _anjay_access_control_in_effect(anjay_unlocked_t *anjay) {
+    return get_access_control(anjay) && !is_single_ssid_environment(anjay);
+}
+
+void _anjay_access_control_invalidate_cache(anjay_unlocked_t *anjay) {
+    _anjay_dm_cache_invalidate_acl(anjay);
+}
+
 #endif // ANJAY_WITH_ACCESS_CONTROL
 
 anjay_instance_action_allowed_stateless_result_t
@@ -577,6 +803,174 @@ typedef struct {
     anjay_iid_t target_iid;
 } orphaned_instance_info_t;
 
+/**
+ * Snapshot of the (target OID, target IID) pairs referred to by all Access
+ * Control object instances, sorted by (target_oid, target_iid, ac_iid). It is
+ * read from the data model at most once per @ref _anjay_sync_access_control
+ * call, and shared by all the synchronization steps, so that each of them can
+ * look up targets with a binary search or a single merge-like pass instead of
+ * re-enumerating the Access Control object.
+ */
+typedef struct {
+    anjay_iid_t ac_iid;
+    anjay_oid_t target_oid;
+    anjay_iid_t target_iid;
+    bool removed;
+} ac_target_t;
+
+typedef struct {
+    bool loaded;
+    ac_target_t *entries;
+    size_t size;
+    size_t capacity;
+} ac_targets_t;
+
+static int read_ac_target_clb(anjay_unlocked_t *anjay,
+                              const anjay_dm_installed_object_t *obj,
+                              anjay_iid_t iid,
+                              void *targets_) {
+    (void) obj;
+    ac_targets_t *targets = (ac_targets_t *) targets_;
+    if (targets->size == targets->capacity) {
+        size_t new_capacity = targets->capacity ? 2 * targets->capacity : 8;
+        ac_target_t *new_entries = (ac_target_t *) avs_realloc(
+                targets->entries, new_capacity * sizeof(*targets->entries));
+        if (!new_entries) {
+            _anjay_log_oom();
+            return -1;
+        }
+        targets->entries = new_entries;
+        targets->capacity = new_capacity;
+    }
+    ac_target_t *target = &targets->entries[targets->size];
+    int result = read_ids_from_ac_instance(anjay, iid, &target->target_oid,
+                                           &target->target_iid, NULL);
+    if (!result) {
+        target->ac_iid = iid;
+        target->removed = false;
+        ++targets->size;
+    }
+    return result;
+}
+
+static int compare_ac_target_key(anjay_oid_t target_oid,
+                                 anjay_iid_t target_iid,
+                                 const ac_target_t *entry) {
+    if (target_oid != entry->target_oid) {
+        return target_oid < entry->target_oid ? -1 : 1;
+    } else if (target_iid != entry->target_iid) {
+        return target_iid < entry->target_iid ? -1 : 1;
+    }
+    return 0;
+}
+
+static int compare_ac_targets(const void *left_, const void *right_) {
+    const ac_target_t *left = (const ac_target_t *) left_;
+    const ac_target_t *right = (const ac_target_t *) right_;
+    int result =
+            compare_ac_target_key(left->target_oid, left->target_iid, right);
+    if (!result && left->ac_iid != right->ac_iid) {
+        result = left->ac_iid < right->ac_iid ? -1 : 1;
+    }
+    return result;
+}
+
+static int load_ac_targets(anjay_unlocked_t *anjay,
+                           const anjay_dm_installed_object_t *ac_obj,
+                           ac_targets_t *targets) {
+    if (targets->loaded) {
+        return 0;
+    }
+    int result = _anjay_dm_foreach_instance(anjay, ac_obj, read_ac_target_clb,
+                                            targets);
+    if (!result) {
+        qsort(targets->entries, targets->size, sizeof(*targets->entries),
+              compare_ac_targets);
+        targets->loaded = true;
+    } else {
+        targets->size = 0;
+    }
+    return result;
+}
+
+static void ac_targets_cleanup(ac_targets_t *targets) {
+    avs_free(targets->entries);
+    memset(targets, 0, sizeof(*targets));
+}
+
+static size_t ac_targets_lower_bound(const ac_targets_t *targets,
+                                     anjay_oid_t target_oid,
+                                     anjay_iid_t target_iid) {
+    assert(targets->loaded);
+    size_t lower = 0;
+    size_t upper = targets->size;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (compare_ac_target_key(target_oid, target_iid,
+                                  &targets->entries[middle])
+                > 0) {
+            lower = middle + 1;
+        } else {
+            upper = middle;
+        }
+    }
+    return lower;
+}
+
+/**
+ * Returns the first entry referring to the given target that has not been
+ * removed during the current synchronization, or NULL if there is none.
+ */
+static ac_target_t *find_ac_target(ac_targets_t *targets,
+                                   anjay_oid_t target_oid,
+                                   anjay_iid_t target_iid) {
+    for (size_t i = ac_targets_lower_bound(targets, target_oid, target_iid);
+         i < targets->size
+         && !compare_ac_target_key(target_oid, target_iid,
+                                   &targets->entries[i]);
+         ++i) {
+        if (!targets->entries[i].removed) {
+            return &targets->entries[i];
+        }
+    }
+    return NULL;
+}
+
+static void mark_ac_target_removed(ac_targets_t *targets,
+                                   const orphaned_instance_info_t *info) {
+    if (!targets->loaded) {
+        // will be loaded later, already without the removed instance
+        return;
+    }
+    for (size_t i = ac_targets_lower_bound(targets, info->target_oid,
+                                           info->target_iid);
+         i < targets->size
+         && !compare_ac_target_key(info->target_oid, info->target_iid,
+                                   &targets->entries[i]);
+         ++i) {
+        if (targets->entries[i].ac_iid == info->ac_iid) {
+            targets->entries[i].removed = true;
+            return;
+        }
+    }
+}
+
+static int remove_ac_target(anjay_unlocked_t *anjay,
+                            const anjay_dm_installed_object_t *ac_obj,
+                            ac_target_t *target,
+                            anjay_notify_queue_t *new_notifications_queue) {
+    int result;
+    (void) ((result = _anjay_dm_call_instance_remove(anjay, ac_obj,
+                                                     target->ac_iid))
+            || (result = _anjay_notify_queue_instance_removed(
+                        new_notifications_queue, ANJAY_DM_OID_ACCESS_CONTROL,
+                        target->ac_iid)));
+    if (!result) {
+        target->removed = true;
+    }
+    return result;
+}
+
 typedef struct {
     AVS_LIST(anjay_ssid_t) valid_ssids;
     AVS_LIST(orphaned_instance_info_t) *orphaned_instance_list_append_ptr;
@@ -715,6 +1109,7 @@ static int remove_referred_instance(anjay_unlocked_t *anjay,
 static int
 remove_orphaned_instances(anjay_unlocked_t *anjay,
                           const anjay_dm_installed_object_t *ac_obj,
+                          ac_targets_t *targets,
                           anjay_notify_queue_t *new_notifications_queue) {
     int result = 0;
     AVS_LIST(anjay_ssid_t) ssid_list = NULL;
@@ -747,6 +1142,9 @@ remove_orphaned_instances(anjay_unlocked_t *anjay,
                             new_notifications_queue,
                             ANJAY_DM_OID_ACCESS_CONTROL,
                             instances_to_remove->ac_iid)));
+        if (!result) {
+            mark_ac_target_removed(targets, instances_to_remove);
+        }
     }
     AVS_LIST_CLEAR(&ssid_list);
     return result;
@@ -831,63 +1229,54 @@ int _anjay_acl_ref_validate_inst_ref(anjay_unlocked_t *anjay,
     return 0;
 }
 
-typedef struct {
-    anjay_acl_ref_validation_ctx_t validation_ctx;
-    AVS_LIST(anjay_iid_t) iids_to_remove;
-} enumerate_instances_to_remove_args_t;
-
-/**
- * Puts IIDs for Accces Control instances that do not refer to any valid object
- * instance onto the args->iids_to_remove list.
- */
-static int
-enumerate_instances_to_remove_clb(anjay_unlocked_t *anjay,
-                                  const anjay_dm_installed_object_t *obj,
-                                  anjay_iid_t iid,
-                                  void *args_) {
-    (void) obj;
-    enumerate_instances_to_remove_args_t *args =
-            (enumerate_instances_to_remove_args_t *) args_;
-    anjay_oid_t target_oid;
-    anjay_iid_t target_iid;
-    int result = read_ids_from_ac_instance(anjay, iid, &target_oid, &target_iid,
-                                           NULL);
-    if (!result
-            && _anjay_acl_ref_validate_inst_ref(anjay, &args->validation_ctx,
-                                                target_oid, target_iid)) {
-        if (!AVS_LIST_INSERT_NEW(anjay_iid_t, &args->iids_to_remove)) {
-            _anjay_log_oom();
-            return -1;
-        }
-        *args->iids_to_remove = iid;
-    }
-    return result;
-}
-
 /**
  * Removes Access Control instances that do not refer to any valid object
- * instance.
+ * instance, or refer to the same one as another Access Control instance with
+ * a lower IID.
+ *
+ * Both the targets and the instance lists of target objects are sorted, so
+ * this is done in a single pass over the targets, retrieving the list of
+ * instances of each target object only once.
  */
 static int perform_removes(anjay_unlocked_t *anjay,
                            const anjay_dm_installed_object_t *ac_obj,
+                           ac_targets_t *targets,
                            anjay_notify_queue_t *new_notifications_queue) {
-    enumerate_instances_to_remove_args_t args = {
-        .validation_ctx = _anjay_acl_ref_validation_ctx_new(),
-        .iids_to_remove = NULL
-    };
-
-    int result = _anjay_dm_foreach_instance(
-            anjay, ac_obj, enumerate_instances_to_remove_clb, &args);
-    _anjay_acl_ref_validation_ctx_cleanup(&args.validation_ctx);
-    AVS_LIST_CLEAR(&args.iids_to_remove) {
-        (void) (result
-                || (result = _anjay_dm_call_instance_remove(
-                            anjay, ac_obj, *args.iids_to_remove))
-                || (result = _anjay_notify_queue_instance_removed(
-                            new_notifications_queue,
-                            ANJAY_DM_OID_ACCESS_CONTROL,
-                            *args.iids_to_remove)));
+    int result = load_ac_targets(anjay, ac_obj, targets);
+    AVS_LIST(anjay_iid_t) target_iids = NULL;
+    AVS_LIST(anjay_iid_t) target_iid_it = NULL;
+    bool target_obj_valid = false;
+    for (size_t i = 0; !result && i < targets->size; ++i) {
+        ac_target_t *target = &targets->entries[i];
+        const ac_target_t *prev = i > 0 ? &targets->entries[i - 1] : NULL;
+        if (!prev || prev->target_oid != target->target_oid) {
+            AVS_LIST_CLEAR(&target_iids);
+            const anjay_dm_installed_object_t *target_obj =
+                    _anjay_dm_find_object_by_oid(anjay, target->target_oid);
+            target_obj_valid =
+                    target_obj
+                    && !_anjay_dm_get_sorted_instance_list(anjay, target_obj,
+                                                           &target_iids);
+            target_iid_it = target_iids;
+        }
+        bool valid =
+                target_obj_valid
+                && (!prev
+                    || compare_ac_target_key(target->target_oid,
+                                             target->target_iid, prev));
+        if (valid && target->target_iid != ANJAY_ID_INVALID) {
+            // ANJAY_ID_INVALID is also allowed for AC target
+            while (target_iid_it && *target_iid_it < target->target_iid) {
+                target_iid_it = AVS_LIST_NEXT(target_iid_it);
+            }
+            valid = target_iid_it && *target_iid_it == target->target_iid;
+        }
+        if (!valid) {
+            result = remove_ac_target(anjay, ac_obj, target,
+                                      new_notifications_queue);
+        }
     }
+    AVS_LIST_CLEAR(&target_iids);
     return result;
 }
 
@@ -971,8 +1360,13 @@ validate_resources_to_write(anjay_unlocked_t *anjay,
  */
 static int perform_adds(anjay_unlocked_t *anjay,
                         const anjay_dm_installed_object_t *ac_obj,
+                        ac_targets_t *targets,
                         anjay_ssid_t origin_ssid,
                         anjay_notify_queue_t *notifications_queue) {
+    int result = load_ac_targets(anjay, ac_obj, targets);
+    if (result) {
+        return result;
+    }
     AVS_LIST(anjay_notify_queue_object_entry_t) it;
     AVS_LIST_FOREACH(it, *notifications_queue) {
         if (it->oid == ANJAY_DM_OID_SECURITY
@@ -983,16 +1377,12 @@ static int perform_adds(anjay_unlocked_t *anjay,
         // create Access Control object instances for created instances
         AVS_LIST(anjay_iid_t) iid_it;
         AVS_LIST_FOREACH(iid_it, it->instance_set_changes.known_added_iids) {
-            int result = find_ac_instance_by_target(anjay, ac_obj, NULL,
-                                                    it->oid, *iid_it);
-            if (!result) {
+            if (find_ac_target(targets, it->oid, *iid_it)) {
                 // AC instance already exists, skip
                 continue;
             }
             anjay_iid_t ac_iid;
-            if (result != ANJAY_ERR_NOT_FOUND
-                    || (result = _anjay_dm_select_free_iid(anjay, ac_obj,
-                                                           &ac_iid))
+            if ((result = _anjay_dm_select_free_iid(anjay, ac_obj, &ac_iid))
                     || (result = _anjay_dm_call_instance_create(anjay, ac_obj,
                                                                 ac_iid))
                     || (result = validate_resources_to_write(anjay, ac_obj,
@@ -1091,15 +1481,19 @@ int _anjay_sync_access_control(anjay_unlocked_t *anjay,
         return ANJAY_ERR_INTERNAL;
     }
     int result = 0;
+    ac_targets_t targets = { false };
     if (might_have_removes) {
-        result = perform_removes(anjay, ac_obj, notifications_queue);
+        result = perform_removes(anjay, ac_obj, &targets, notifications_queue);
     }
     if (!result && might_caused_orphaned_ac_instances) {
-        result = remove_orphaned_instances(anjay, ac_obj, notifications_queue);
+        result = remove_orphaned_instances(anjay, ac_obj, &targets,
+                                           notifications_queue);
     }
     if (!result && have_adds) {
-        result = perform_adds(anjay, ac_obj, origin_ssid, notifications_queue);
+        result = perform_adds(anjay, ac_obj, &targets, origin_ssid,
+                              notifications_queue);
     }
+    ac_targets_cleanup(&targets);
     if (!result) {
         result = generate_apparent_instance_set_change_notifications(
                 anjay, notifications_queue);
@@ -44,6 +44,20 @@ typedef enum {
 bool _anjay_instance_action_allowed(anjay_unlocked_t *anjay,
                                     const anjay_action_info_t *info);
 
+/**
+ * Variant of @ref _anjay_instance_action_allowed for an Instance of @p obj.
+ * Access to Objects of LwM2M Gateway End Devices is always allowed here, as it
+ * is checked against the respective LwM2M Gateway object Instance once per
+ * request, in @ref _anjay_dm_perform_action.
+ */
+static inline bool
+_anjay_object_instance_action_allowed(anjay_unlocked_t *anjay,
+                                      const anjay_dm_installed_object_t *obj,
+                                      const anjay_action_info_t *info) {
+    return !_anjay_dm_is_root_object(anjay, obj)
+           || _anjay_instance_action_allowed(anjay, info);
+}
+
 /**
  * Checks whether an operation described by the @p info on a non-restricted
  * Object is allowed, but only if that can be determined without accessing the
@@ -71,6 +85,15 @@ _anjay_instance_action_allowed_stateless(anjay_unlocked_t *anjay,
  */
 bool _anjay_instance_action_allowed_by_acl(anjay_unlocked_t *anjay,
                                            const anjay_action_info_t *info);
+
+/**
+ * Returns true if results of access checks may differ between non-Bootstrap
+ * Servers, i.e. the Access Control Object is present and there is more than
+ * one such Server.
+ */
+bool _anjay_access_control_in_effect(anjay_unlocked_t *anjay);
+#else  // ANJAY_WITH_ACCESS_CONTROL
+#    define _anjay_access_control_in_effect(Anjay) ((void) (Anjay), false)
 #endif // ANJAY_WITH_ACCESS_CONTROL
 
 /**
@@ -0,0 +1,217 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_memory.h>
+
+#include "anjay_arena.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+typedef struct {
+    size_t prev;
+    size_t size;
+    // freed while not being the most recent allocation
+    bool freed;
+} arena_header_t;
+
+#define ARENA_ALIGNMENT AVS_ALIGNOF(avs_max_align_t)
+
+#define ARENA_ALIGN(Size) \
+    (((Size) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT)
+
+#define ARENA_HEADER_SIZE ARENA_ALIGN(sizeof(arena_header_t))
+
+int _anjay_arena_init(anjay_arena_t *arena, size_t size) {
+    memset(arena, 0, sizeof(*arena));
+    arena->top = SIZE_MAX;
+    if (size) {
+        if (!(arena->buffer = (char *) avs_malloc(size))) {
+            return -1;
+        }
+        arena->size = size;
+    }
+    return 0;
+}
+
+void _anjay_arena_cleanup(anjay_arena_t *arena) {
+    assert(!arena->used);
+    avs_free(arena->buffer);
+    arena->buffer = NULL;
+    arena->size = 0;
+}
+
+static bool in_arena(const anjay_arena_t *arena, const void *ptr) {
+    return arena->buffer && (const char *) ptr >= arena->buffer
+           && (const char *) ptr < arena->buffer + arena->size;
+}
+
+static arena_header_t *header_at(anjay_arena_t *arena, size_t offset) {
+    return (arena_header_t *) (arena->buffer + offset);
+}
+
+static bool is_top(anjay_arena_t *arena, const void *ptr) {
+    return arena->top != SIZE_MAX
+           && (const char *) ptr
+                      == arena->buffer + arena->top + ARENA_HEADER_SIZE;
+}
+
+void *_anjay_arena_alloc(anjay_arena_t *arena, size_t size) {
+    size_t offset = ARENA_ALIGN(arena->used);
+    if (offset > arena->size
+            || arena->size - offset < ARENA_HEADER_SIZE
+            || arena->size - offset - ARENA_HEADER_SIZE < size) {
+        return avs_malloc(size);
+    }
+    arena_header_t *header = header_at(arena, offset);
+    header->prev = arena->top;
+    header->size = size;
+    header->freed = false;
+    arena->top = offset;
+    arena->used = offset + ARENA_HEADER_SIZE + size;
+    return arena->buffer + offset + ARENA_HEADER_SIZE;
+}
+
+void *_anjay_arena_realloc(anjay_arena_t *arena, void *ptr, size_t size) {
+    if (!ptr) {
+        return _anjay_arena_alloc(arena, size);
+    }
+    if (!in_arena(arena, ptr)) {
+        return avs_realloc(ptr, size);
+    }
+    arena_header_t *header =
+            (arena_header_t *) ((char *) ptr - ARENA_HEADER_SIZE);
+    if (is_top(arena, ptr)
+            && arena->size - arena->top - ARENA_HEADER_SIZE >= size) {
+        header->size = size;
+        arena->used = arena->top + ARENA_HEADER_SIZE + size;
+        return ptr;
+    }
+    void *result = _anjay_arena_alloc(arena, size);
+    if (result) {
+        memcpy(result, ptr, AVS_MIN(header->size, size));
+        _anjay_arena_free(arena, ptr);
+    }
+    return result;
+}
+
+void _anjay_arena_free(anjay_arena_t *arena, void *ptr) {
+    if (!in_arena(arena, ptr)) {
+        avs_free(ptr);
+        return;
+    }
+    if (!is_top(arena, ptr)) {
+        // reclaimed together with the allocations made after it
+        ((arena_header_t *) ((char *) ptr - ARENA_HEADER_SIZE))->freed = true;
+        return;
+    }
+    do {
+        arena->used = arena->top;
+        arena->top = header_at(arena, arena->top)->prev;
+    } while (arena->top != SIZE_MAX && header_at(arena, arena->top)->freed);
+}
+
+void _anjay_arena_release(anjay_arena_t *arena, size_t mark) {
+    assert(mark <= arena->used);
+    arena->used = mark;
+    while (arena->top != SIZE_MAX && arena->top >= mark) {
+        arena->top = header_at(arena, arena->top)->prev;
+    }
+}
+
+struct anjay_arena_chunk {
+    anjay_arena_chunk_t *prev;
+    size_t size;
+    size_t used;
+    avs_max_align_t data[];
+};
+
+void _anjay_growable_arena_init(anjay_growable_arena_t *arena,
+                                size_t min_chunk_size,
+                                size_t max_chunk_size) {
+    assert(min_chunk_size <= max_chunk_size);
+    *arena = (anjay_growable_arena_t) {
+        .min_chunk_size = min_chunk_size,
+        .max_chunk_size = max_chunk_size
+    };
+}
+
+static void chunks_free_until(anjay_growable_arena_t *arena,
+                              const anjay_arena_chunk_t *until) {
+    while (arena->chunks != until) {
+        anjay_arena_chunk_t *prev = arena->chunks->prev;
+        avs_free(arena->chunks);
+        arena->chunks = prev;
+    }
+}
+
+void _anjay_growable_arena_cleanup(anjay_growable_arena_t *arena) {
+    chunks_free_until(arena, NULL);
+}
+
+void *_anjay_growable_arena_alloc(anjay_growable_arena_t *arena, size_t size) {
+    if (size > SIZE_MAX - ARENA_ALIGNMENT - sizeof(anjay_arena_chunk_t)) {
+        return NULL;
+    }
+    size = ARENA_ALIGN(size);
+    anjay_arena_chunk_t *chunk = arena->chunks;
+    if (!chunk || chunk->size - chunk->used < size) {
+        size_t chunk_size =
+                chunk ? AVS_MIN(2 * chunk->size, arena->max_chunk_size)
+                      : arena->min_chunk_size;
+        chunk_size = AVS_MAX(chunk_size, size);
+        if (!(chunk = (anjay_arena_chunk_t *) avs_malloc(
+                      sizeof(anjay_arena_chunk_t) + chunk_size))) {
+            return NULL;
+        }
+        chunk->prev = arena->chunks;
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        arena->chunks = chunk;
+    }
+    void *result = (char *) chunk->data + chunk->used;
+    chunk->used += size;
+    return result;
+}
+
+anjay_growable_arena_mark_t
+_anjay_growable_arena_mark(const anjay_growable_arena_t *arena) {
+    return (anjay_growable_arena_mark_t) {
+        .chunk = arena->chunks,
+        .used = arena->chunks ? arena->chunks->used : 0
+    };
+}
+
+void _anjay_growable_arena_release(anjay_growable_arena_t *arena,
+                                   const anjay_growable_arena_mark_t *mark) {
+    chunks_free_until(arena, mark->chunk);
+    if (arena->chunks) {
+        assert(mark->used <= arena->chunks->used);
+        arena->chunks->used = mark->used;
+    }
+}
+
+size_t _anjay_growable_arena_memory_size(const anjay_growable_arena_t *arena) {
+    size_t result = 0;
+    for (const anjay_arena_chunk_t *chunk = arena->chunks; chunk;
+         chunk = chunk->prev) {
+        result += sizeof(*chunk) + chunk->size;
+    }
+    return result;
+}
+
+#ifdef ANJAY_TEST
+#    include "tests/core/arena.c"
+#endif // ANJAY_TEST
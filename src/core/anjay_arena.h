@@ -0,0 +1,121 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_ARENA_H
+#define ANJAY_ARENA_H
+
+#include <anjay_init.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Bump allocator for short-lived temporary data used while handling a single
+ * request. The buffer is allocated once, and all memory allocated from it is
+ * released at once by rewinding to a previously taken mark.
+ *
+ * Allocations that do not fit in the remaining space (or all of them, if the
+ * arena has zero size) fall back to the heap, so callers shall always release
+ * memory using @ref _anjay_arena_free. Freeing the most recent arena
+ * allocation makes its space available again immediately. Space of allocations
+ * freed out of order is made available once all the allocations made after
+ * them are freed too, so the arena is also usable outside of a mark/release
+ * scope, as long as everything allocated there is eventually freed.
+ */
+typedef struct {
+    char *buffer;
+    size_t size;
+    size_t used;
+    /**
+     * Offset of the header of the most recent allocation that has not been
+     * freed yet, or SIZE_MAX if there is none.
+     */
+    size_t top;
+} anjay_arena_t;
+
+int _anjay_arena_init(anjay_arena_t *arena, size_t size);
+
+void _anjay_arena_cleanup(anjay_arena_t *arena);
+
+void *_anjay_arena_alloc(anjay_arena_t *arena, size_t size);
+
+/**
+ * Semantics are the same as for @ref avs_realloc. The most recent arena
+ * allocation is resized in place if possible.
+ */
+void *_anjay_arena_realloc(anjay_arena_t *arena, void *ptr, size_t size);
+
+void _anjay_arena_free(anjay_arena_t *arena, void *ptr);
+
+static inline size_t _anjay_arena_mark(const anjay_arena_t *arena) {
+    return arena->used;
+}
+
+/**
+ * Releases all arena allocations made since @p mark was taken. Heap fallback
+ * allocations are not affected.
+ */
+void _anjay_arena_release(anjay_arena_t *arena, size_t mark);
+
+typedef struct anjay_arena_chunk anjay_arena_chunk_t;
+
+/**
+ * Bump allocator for data that is built incrementally and then kept for
+ * a longer time, e.g. batches of Resource values. Memory is allocated from
+ * heap chunks whose sizes grow geometrically, from @p min_chunk_size up to
+ * @p max_chunk_size (larger allocations get a chunk of their own), so that
+ * small data sets stay small and large ones need only a few heap allocations.
+ *
+ * Unlike @ref anjay_arena_t, individual allocations can't be freed - memory is
+ * released by rewinding to a previously taken mark, or all at once on cleanup.
+ */
+typedef struct {
+    /** Chunks allocated so far, most recent first. */
+    anjay_arena_chunk_t *chunks;
+    size_t min_chunk_size;
+    size_t max_chunk_size;
+} anjay_growable_arena_t;
+
+typedef struct {
+    anjay_arena_chunk_t *chunk;
+    size_t used;
+} anjay_growable_arena_mark_t;
+
+void _anjay_growable_arena_init(anjay_growable_arena_t *arena,
+                                size_t min_chunk_size,
+                                size_t max_chunk_size);
+
+void _anjay_growable_arena_cleanup(anjay_growable_arena_t *arena);
+
+/**
+ * @returns Pointer to @p size bytes suitably aligned for any type, or NULL if
+ *          a new chunk could not be allocated.
+ */
+void *_anjay_growable_arena_alloc(anjay_growable_arena_t *arena, size_t size);
+
+anjay_growable_arena_mark_t
+_anjay_growable_arena_mark(const anjay_growable_arena_t *arena);
+
+/**
+ * Releases all allocations made since @p mark was taken, freeing the chunks
+ * allocated in the meantime.
+ */
+void _anjay_growable_arena_release(anjay_growable_arena_t *arena,
+                                   const anjay_growable_arena_mark_t *mark);
+
+/**
+ * @returns Total size of the heap memory used by the chunks of @p arena .
+ */
+size_t _anjay_growable_arena_memory_size(const anjay_growable_arena_t *arena);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif // ANJAY_ARENA_H
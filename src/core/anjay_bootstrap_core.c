@@ -10,8 +10,10 @@
 #include <anjay_init.h>
 
 #include <inttypes.h>
+#include <stdlib.h>
 
 #include <avsystem/commons/avs_errno.h>
+#include <avsystem/commons/avs_memory.h>
 #include <avsystem/commons/avs_stream_membuf.h>
 
 #include <avsystem/coap/async_client.h>
@@ -95,6 +97,7 @@ static avs_error_t start_bootstrap_if_not_already_started(
         _anjay_servers_foreach_active(anjay, suspend_nonbootstrap_server, NULL);
 
         avs_sched_del(&anjay->bootstrap.purge_bootstrap_handle);
+        _anjay_bootstrap_discover_cache_invalidate(anjay);
     }
     anjay->bootstrap.in_progress = true;
 #    ifdef ANJAY_WITH_CONN_STATUS_API
@@ -108,6 +111,7 @@ static avs_error_t start_bootstrap_if_not_already_started(
 }
 
 static void abort_bootstrap(anjay_unlocked_t *anjay) {
+    _anjay_bootstrap_discover_cache_invalidate(anjay);
     if (anjay->bootstrap.in_progress) {
         _anjay_dm_transaction_rollback(anjay);
         anjay->bootstrap.in_progress = false;
@@ -160,26 +164,182 @@ static uint8_t make_success_response_code(anjay_request_action_t action) {
     return (uint8_t) (-ANJAY_ERR_INTERNAL);
 }
 
+typedef struct {
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+} bulk_instance_ref_t;
+
+/**
+ * State of a bulk write (a Bootstrap Write on a whole Object, or a bulk
+ * Write-Composite): changes are gathered here and applied to the bootstrap
+ * notification queue once after all the entries are written, instead of after
+ * each of them.
+ */
+typedef struct {
+    /** Instance known to be present, for the records targeting it in a row */
+    bulk_instance_ref_t present_instance;
+    /** Resources changed in @ref changes_oid, in order of writing */
+    anjay_oid_t changes_oid;
+    anjay_notify_queue_resource_entry_t *changes;
+    size_t changes_count;
+    size_t changes_capacity;
+    /** Instances of @ref created_oid created on demand, in order of creation */
+    anjay_oid_t created_oid;
+    anjay_iid_t *created_iids;
+    size_t created_count;
+    size_t created_capacity;
+    /** Security and Server Instances that need Last Bootstrapped update */
+    AVS_LIST(bulk_instance_ref_t) bootstrapped_instances;
+} bulk_write_state_t;
+
+static int bulk_reserve(void **array_ptr,
+                        size_t *capacity_ptr,
+                        size_t count,
+                        size_t element_size) {
+    if (count < *capacity_ptr) {
+        return 0;
+    }
+    size_t new_capacity = *capacity_ptr ? 2 * *capacity_ptr : 16;
+    void *new_array = avs_realloc(*array_ptr, new_capacity * element_size);
+    if (!new_array) {
+        _anjay_log_oom();
+        return -1;
+    }
+    *array_ptr = new_array;
+    *capacity_ptr = new_capacity;
+    return 0;
+}
+
+static int compare_notify_resource_entries(const void *left_,
+                                           const void *right_) {
+    const anjay_notify_queue_resource_entry_t *left =
+            (const anjay_notify_queue_resource_entry_t *) left_;
+    const anjay_notify_queue_resource_entry_t *right =
+            (const anjay_notify_queue_resource_entry_t *) right_;
+    if (left->iid != right->iid) {
+        return left->iid < right->iid ? -1 : 1;
+    }
+    return left->rid < right->rid ? -1 : (left->rid > right->rid);
+}
+
+static int compare_iids(const void *left, const void *right) {
+    const anjay_iid_t left_iid = *(const anjay_iid_t *) left;
+    const anjay_iid_t right_iid = *(const anjay_iid_t *) right;
+    return left_iid < right_iid ? -1 : (left_iid > right_iid);
+}
+
+static int bulk_flush_resource_changes(anjay_unlocked_t *anjay,
+                                       bulk_write_state_t *state) {
+    if (!state->changes_count) {
+        return 0;
+    }
+    qsort(state->changes, state->changes_count, sizeof(*state->changes),
+          compare_notify_resource_entries);
+    int result = _anjay_notify_queue_resource_changes(
+            &anjay->bootstrap.notification_queue, state->changes_oid,
+            state->changes, state->changes_count);
+    state->changes_count = 0;
+    return result;
+}
+
+static int bulk_flush_created_instances(anjay_unlocked_t *anjay,
+                                        bulk_write_state_t *state) {
+    if (!state->created_count) {
+        return 0;
+    }
+    qsort(state->created_iids, state->created_count,
+          sizeof(*state->created_iids), compare_iids);
+    int result = _anjay_notify_queue_instances_created(
+            &anjay->bootstrap.notification_queue, state->created_oid,
+            state->created_iids, state->created_count);
+    state->created_count = 0;
+    return result;
+}
+
+static int bulk_flush(anjay_unlocked_t *anjay, bulk_write_state_t *state) {
+    int result = bulk_flush_created_instances(anjay, state);
+    int changes_result = bulk_flush_resource_changes(anjay, state);
+    return result ? result : changes_result;
+}
+
+static int bulk_queue_resource_change(anjay_unlocked_t *anjay,
+                                      bulk_write_state_t *state,
+                                      const anjay_uri_path_t *path) {
+    int result = 0;
+    if (state->changes_count && state->changes_oid != path->ids[ANJAY_ID_OID]
+            && (result = bulk_flush_resource_changes(anjay, state))) {
+        return result;
+    }
+    if (bulk_reserve((void **) &state->changes, &state->changes_capacity,
+                     state->changes_count, sizeof(*state->changes))) {
+        return -1;
+    }
+    state->changes_oid = path->ids[ANJAY_ID_OID];
+    state->changes[state->changes_count++] =
+            (anjay_notify_queue_resource_entry_t) {
+                .iid = path->ids[ANJAY_ID_IID],
+                .rid = path->ids[ANJAY_ID_RID]
+            };
+    return 0;
+}
+
+static int bulk_queue_instance_created(anjay_unlocked_t *anjay,
+                                       bulk_write_state_t *state,
+                                       anjay_oid_t oid,
+                                       anjay_iid_t iid) {
+    int result = 0;
+    if (state->created_count && state->created_oid != oid
+            && (result = bulk_flush_created_instances(anjay, state))) {
+        return result;
+    }
+    if (bulk_reserve((void **) &state->created_iids, &state->created_capacity,
+                     state->created_count, sizeof(*state->created_iids))) {
+        return -1;
+    }
+    state->created_oid = oid;
+    state->created_iids[state->created_count++] = iid;
+    return 0;
+}
+
+static void bulk_cleanup(bulk_write_state_t *state) {
+    avs_free(state->changes);
+    avs_free(state->created_iids);
+    AVS_LIST_CLEAR(&state->bootstrapped_instances);
+}
+
 typedef int with_instance_on_demand_cb_t(anjay_unlocked_t *anjay,
                                          const anjay_dm_installed_object_t *obj,
                                          anjay_iid_t iid,
-                                         anjay_unlocked_input_ctx_t *in_ctx);
+                                         anjay_unlocked_input_ctx_t *in_ctx,
+                                         bulk_write_state_t *bulk);
 
 static int
 write_resource_and_move_to_next_entry(anjay_unlocked_t *anjay,
                                       const anjay_dm_installed_object_t *obj,
                                       anjay_iid_t iid,
-                                      anjay_unlocked_input_ctx_t *in_ctx) {
+                                      anjay_unlocked_input_ctx_t *in_ctx,
+                                      bulk_write_state_t *bulk) {
     (void) iid;
-    return _anjay_dm_write_resource_and_move_to_next_entry(
-            anjay, obj, in_ctx, &anjay->bootstrap.notification_queue);
+    if (!bulk) {
+        return _anjay_dm_write_resource_and_move_to_next_entry(
+                anjay, obj, in_ctx, &anjay->bootstrap.notification_queue);
+    }
+    anjay_uri_path_t path;
+    int retval = _anjay_input_get_path(in_ctx, &path, NULL);
+    if (!retval
+            && !(retval = _anjay_dm_write_resource_and_move_to_next_entry(
+                         anjay, obj, in_ctx, NULL))) {
+        retval = bulk_queue_resource_change(anjay, bulk, &path);
+    }
+    return retval;
 }
 
 static int write_instance_and_move_to_next_entry_inner(
         anjay_unlocked_t *anjay,
         const anjay_dm_installed_object_t *obj,
         anjay_iid_t iid,
-        anjay_unlocked_input_ctx_t *in_ctx) {
+        anjay_unlocked_input_ctx_t *in_ctx,
+        bulk_write_state_t *bulk) {
     int retval;
     anjay_uri_path_t path;
     while (!(retval = _anjay_input_get_path(in_ctx, &path, NULL))) {
@@ -192,7 +352,7 @@ static int write_instance_and_move_to_next_entry_inner(
         if (_anjay_uri_path_has(&path, ANJAY_ID_RID)) {
             /* non-empty instance */
             retval = write_resource_and_move_to_next_entry(anjay, obj, iid,
-                                                           in_ctx);
+                                                           in_ctx, bulk);
             if (retval == ANJAY_ERR_NOT_FOUND
                     || retval == ANJAY_ERR_NOT_IMPLEMENTED) {
                 // LwM2M spec, 5.2.7.1 BOOTSTRAP WRITE:
@@ -220,6 +380,7 @@ static int with_instance_on_demand(anjay_unlocked_t *anjay,
                                    const anjay_dm_installed_object_t *obj,
                                    anjay_iid_t iid,
                                    anjay_unlocked_input_ctx_t *in_ctx,
+                                   bulk_write_state_t *bulk,
                                    with_instance_on_demand_cb_t callback) {
     int result = 0;
     int ipresent = _anjay_dm_instance_present(anjay, obj, iid);
@@ -235,12 +396,17 @@ static int with_instance_on_demand(anjay_unlocked_t *anjay,
     }
 
     if (!result) {
-        result = callback(anjay, obj, iid, in_ctx);
+        result = callback(anjay, obj, iid, in_ctx, bulk);
     }
     if (ipresent == 0 && !result) {
-        result = _anjay_notify_queue_instance_created(
-                &anjay->bootstrap.notification_queue,
-                _anjay_dm_installed_object_oid(obj), iid);
+        if (bulk) {
+            result = bulk_queue_instance_created(
+                    anjay, bulk, _anjay_dm_installed_object_oid(obj), iid);
+        } else {
+            result = _anjay_notify_queue_instance_created(
+                    &anjay->bootstrap.notification_queue,
+                    _anjay_dm_installed_object_oid(obj), iid);
+        }
     }
     return result;
 }
@@ -249,8 +415,9 @@ static int
 write_instance_and_move_to_next_entry(anjay_unlocked_t *anjay,
                                       const anjay_dm_installed_object_t *obj,
                                       anjay_iid_t iid,
-                                      anjay_unlocked_input_ctx_t *in_ctx) {
-    return with_instance_on_demand(anjay, obj, iid, in_ctx,
+                                      anjay_unlocked_input_ctx_t *in_ctx,
+                                      bulk_write_state_t *bulk) {
+    return with_instance_on_demand(anjay, obj, iid, in_ctx, bulk,
                                    write_instance_and_move_to_next_entry_inner);
 }
 
@@ -259,6 +426,14 @@ write_object_and_move_to_next_entry(anjay_unlocked_t *anjay,
                                     const anjay_dm_installed_object_t *obj,
                                     anjay_unlocked_input_ctx_t *in_ctx) {
     // should it remove existing instances?
+    // Notifications for all the Instances are gathered and queued at once, as
+    // a Bootstrap Write on a whole Object may contain hundreds of them.
+    bulk_write_state_t bulk = {
+        .present_instance = {
+            .oid = ANJAY_ID_INVALID,
+            .iid = ANJAY_ID_INVALID
+        }
+    };
     int retval;
     do {
         anjay_uri_path_t path;
@@ -277,9 +452,13 @@ write_object_and_move_to_next_entry(anjay_unlocked_t *anjay,
             break;
         }
         retval = write_instance_and_move_to_next_entry(
-                anjay, obj, path.ids[ANJAY_ID_IID], in_ctx);
+                anjay, obj, path.ids[ANJAY_ID_IID], in_ctx, &bulk);
     } while (!retval);
-    return retval;
+    // entries written before a failure are queued as well, as they are not
+    // rolled back until the Bootstrap Sequence is aborted
+    int flush_result = bulk_flush(anjay, &bulk);
+    bulk_cleanup(&bulk);
+    return retval ? retval : flush_result;
 }
 
 static int security_object_valid_handler(anjay_unlocked_t *anjay,
@@ -361,6 +540,7 @@ static int bootstrap_write_impl(anjay_unlocked_t *anjay,
                 anjay, bootstrap_connection, true))) {
         return ANJAY_ERR_INTERNAL;
     }
+    _anjay_bootstrap_discover_cache_invalidate(anjay);
     const anjay_dm_installed_object_t *obj =
             _anjay_dm_find_object_by_oid(anjay, uri->ids[ANJAY_ID_OID]);
     if (!obj) {
@@ -373,10 +553,10 @@ static int bootstrap_write_impl(anjay_unlocked_t *anjay,
         retval = write_object_and_move_to_next_entry(anjay, obj, in_ctx);
     } else if (_anjay_uri_path_leaf_is(uri, ANJAY_ID_IID)) {
         retval = write_instance_and_move_to_next_entry(
-                anjay, obj, uri->ids[ANJAY_ID_IID], in_ctx);
+                anjay, obj, uri->ids[ANJAY_ID_IID], in_ctx, NULL);
     } else if (_anjay_uri_path_leaf_is(uri, ANJAY_ID_RID)) {
         retval = with_instance_on_demand(anjay, obj, uri->ids[ANJAY_ID_IID],
-                                         in_ctx,
+                                         in_ctx, NULL,
                                          write_resource_and_move_to_next_entry);
     }
     if (!retval && uri->ids[ANJAY_ID_OID] == ANJAY_DM_OID_SECURITY) {
@@ -405,73 +585,136 @@ static int bootstrap_write_impl(anjay_unlocked_t *anjay,
 }
 
 #    ifdef ANJAY_WITH_MODULE_FACTORY_PROVISIONING
-int _anjay_bootstrap_write_composite(anjay_unlocked_t *anjay,
-                                     anjay_unlocked_input_ctx_t *in_ctx) {
-    anjay_log(DEBUG, _("Bootstrap Write from CBOR context"));
-    cancel_client_initiated_bootstrap(anjay);
-    cancel_est_sren(anjay);
-    start_bootstrap_if_not_already_started(
-            anjay, (anjay_connection_ref_t) { NULL }, true);
-
-    int retval;
-    anjay_uri_path_t path;
-    while (!(retval = _anjay_input_get_path(in_ctx, &path, NULL))) {
-        if (!_anjay_uri_path_has(&path, ANJAY_ID_RID)) {
-            return ANJAY_ERR_BAD_REQUEST;
+static int bulk_mark_bootstrapped(bulk_write_state_t *state,
+                                  const anjay_uri_path_t *path) {
+    AVS_LIST(bulk_instance_ref_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &state->bootstrapped_instances) {
+        if ((*it)->oid == path->ids[ANJAY_ID_OID]
+                && (*it)->iid == path->ids[ANJAY_ID_IID]) {
+            return 0;
         }
+    }
+    if (!AVS_LIST_INSERT_NEW(bulk_instance_ref_t, it)) {
+        _anjay_log_oom();
+        return -1;
+    }
+    (*it)->oid = path->ids[ANJAY_ID_OID];
+    (*it)->iid = path->ids[ANJAY_ID_IID];
+    return 0;
+}
 
-        const anjay_dm_installed_object_t *obj =
-                _anjay_dm_find_object_by_oid(anjay, path.ids[ANJAY_ID_OID]);
-        if (!obj) {
-            anjay_log(DEBUG, _("Object not found: ") "%u",
-                      path.ids[ANJAY_ID_OID]);
-            return ANJAY_ERR_NOT_FOUND;
+static int bulk_finish(anjay_unlocked_t *anjay, bulk_write_state_t *state) {
+    int result = bulk_flush(anjay, state);
+    AVS_LIST(bulk_instance_ref_t) it;
+    AVS_LIST_FOREACH(it, state->bootstrapped_instances) {
+        if (result) {
+            break;
         }
+        result = update_last_bootstrapped_time(
+                anjay, _anjay_dm_find_object_by_oid(anjay, it->oid), it->iid);
+    }
+    return result;
+}
+
+static int write_composite_entry(anjay_unlocked_t *anjay,
+                                 anjay_unlocked_input_ctx_t *in_ctx,
+                                 const anjay_uri_path_t *path,
+                                 bulk_write_state_t *bulk) {
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(anjay, path->ids[ANJAY_ID_OID]);
+    if (!obj) {
+        anjay_log(DEBUG, _("Object not found: ") "%u", path->ids[ANJAY_ID_OID]);
+        return ANJAY_ERR_NOT_FOUND;
+    }
 
+    int retval;
+    if (!bulk || bulk->present_instance.oid != path->ids[ANJAY_ID_OID]
+            || bulk->present_instance.iid != path->ids[ANJAY_ID_IID]) {
         int ipresent =
-                _anjay_dm_instance_present(anjay, obj, path.ids[ANJAY_ID_IID]);
+                _anjay_dm_instance_present(anjay, obj, path->ids[ANJAY_ID_IID]);
         if (ipresent < 0) {
             return ANJAY_ERR_BAD_REQUEST;
         } else if (ipresent == 0
                    && (retval = _anjay_dm_call_instance_create(
-                               anjay, obj, path.ids[ANJAY_ID_IID]))) {
+                               anjay, obj, path->ids[ANJAY_ID_IID]))) {
             return retval;
         }
-
-        if ((retval = _anjay_dm_call_resource_write(
-                     anjay, obj, path.ids[ANJAY_ID_IID], path.ids[ANJAY_ID_RID],
-                     path.ids[ANJAY_ID_RIID], in_ctx))) {
-            return retval;
+        if (bulk) {
+            bulk->present_instance.oid = path->ids[ANJAY_ID_OID];
+            bulk->present_instance.iid = path->ids[ANJAY_ID_IID];
         }
+    }
 
-        if ((retval = _anjay_notify_queue_resource_change(
-                     &anjay->bootstrap.notification_queue,
-                     path.ids[ANJAY_ID_OID],
-                     path.ids[ANJAY_ID_IID],
-                     path.ids[ANJAY_ID_RID]))) {
-            return retval;
-        }
+    if ((retval = _anjay_dm_call_resource_write(
+                 anjay, obj, path->ids[ANJAY_ID_IID], path->ids[ANJAY_ID_RID],
+                 path->ids[ANJAY_ID_RIID], in_ctx))) {
+        return retval;
+    }
 
-        if (path.ids[ANJAY_ID_OID] == ANJAY_DM_OID_SERVER
-                || path.ids[ANJAY_ID_OID] == ANJAY_DM_OID_SECURITY) {
-            if ((retval = update_last_bootstrapped_time(
-                         anjay, obj, path.ids[ANJAY_ID_IID]))) {
-                return retval;
-            }
-        }
+    const bool affects_bootstrapped_time =
+            path->ids[ANJAY_ID_OID] == ANJAY_DM_OID_SERVER
+            || path->ids[ANJAY_ID_OID] == ANJAY_DM_OID_SECURITY;
+    if (bulk) {
+        (void) ((retval = bulk_queue_resource_change(anjay, bulk, path))
+                || (affects_bootstrapped_time
+                    && (retval = bulk_mark_bootstrapped(bulk, path))));
+        return retval;
+    }
+
+    if ((retval = _anjay_notify_queue_resource_change(
+                 &anjay->bootstrap.notification_queue, path->ids[ANJAY_ID_OID],
+                 path->ids[ANJAY_ID_IID], path->ids[ANJAY_ID_RID]))) {
+        return retval;
+    }
+    if (affects_bootstrapped_time) {
+        retval = update_last_bootstrapped_time(anjay, obj,
+                                               path->ids[ANJAY_ID_IID]);
+    }
+    return retval;
+}
+
+int _anjay_bootstrap_write_composite(anjay_unlocked_t *anjay,
+                                     anjay_unlocked_input_ctx_t *in_ctx,
+                                     bool bulk) {
+    anjay_log(DEBUG, _("Bootstrap Write from CBOR context"));
+    cancel_client_initiated_bootstrap(anjay);
+    cancel_est_sren(anjay);
+    start_bootstrap_if_not_already_started(
+            anjay, (anjay_connection_ref_t) { NULL }, true);
+    _anjay_bootstrap_discover_cache_invalidate(anjay);
 
-        if ((retval = _anjay_input_next_entry(in_ctx))) {
+    bulk_write_state_t bulk_state = {
+        .present_instance = {
+            .oid = ANJAY_ID_INVALID,
+            .iid = ANJAY_ID_INVALID
+        }
+    };
+    int retval;
+    anjay_uri_path_t path;
+    while (!(retval = _anjay_input_get_path(in_ctx, &path, NULL))) {
+        if (!_anjay_uri_path_has(&path, ANJAY_ID_RID)) {
+            retval = ANJAY_ERR_BAD_REQUEST;
+            break;
+        }
+        if ((retval = write_composite_entry(anjay, in_ctx, &path,
+                                            bulk ? &bulk_state : NULL))
+                || (retval = _anjay_input_next_entry(in_ctx))) {
             break;
         }
     }
 
-    return (retval == ANJAY_GET_PATH_END) ? 0 : retval;
+    if (retval == ANJAY_GET_PATH_END) {
+        retval = bulk ? bulk_finish(anjay, &bulk_state) : 0;
+    }
+    bulk_cleanup(&bulk_state);
+    return retval;
 }
 #    endif // ANJAY_WITH_MODULE_FACTORY_PROVISIONING
 
 static int delete_instance(anjay_unlocked_t *anjay,
                            const anjay_dm_installed_object_t *obj,
                            anjay_iid_t iid) {
+    _anjay_bootstrap_discover_cache_invalidate(anjay);
     int retval = _anjay_dm_call_instance_remove(anjay, obj, iid);
     if (retval) {
         anjay_log(WARNING,
@@ -632,6 +875,7 @@ static void purge_bootstrap(avs_sched_t *sched, const void *dummy) {
     } else if (avs_is_err(_anjay_dm_transaction_begin(anjay))) {
         retval = -1;
     } else {
+        _anjay_bootstrap_discover_cache_invalidate(anjay);
         (void) (retval
                 || (retval = _anjay_dm_call_instance_remove(anjay, obj, iid))
                 || (retval = _anjay_notify_queue_instance_removed(
@@ -705,6 +949,7 @@ static int bootstrap_finish_impl(anjay_unlocked_t *anjay,
                                  anjay_connection_ref_t bootstrap_connection,
                                  int flags) {
     anjay_log(INFO, _("Bootstrap Sequence finished"));
+    _anjay_bootstrap_discover_cache_invalidate(anjay);
     anjay->bootstrap.in_progress = false;
     _anjay_conn_session_token_reset(&anjay->bootstrap.bootstrap_session_token);
     int retval = _anjay_dm_transaction_finish_without_validation(anjay, 0);
@@ -763,6 +1008,9 @@ static int bootstrap_finish_impl(anjay_unlocked_t *anjay,
                     ANJAY_SERV_CONN_STATUS_BOOTSTRAPPED);
         }
 #    endif // ANJAY_WITH_CONN_STATUS_API
+        // _anjay_notify_perform_without_servers() does not schedule reloading
+        // the servers by itself, so this is the only place it happens, no
+        // matter how many Security and Server Instances have changed
         _anjay_schedule_reload_servers(anjay);
     }
     return retval;
@@ -1384,6 +1632,12 @@ void _anjay_bootstrap_init(anjay_bootstrap_t *bootstrap,
     reset_client_initiated_bootstrap_backoff(bootstrap);
 }
 
+#    ifdef ANJAY_WITH_DISCOVER
+void _anjay_bootstrap_discover_cache_invalidate(anjay_unlocked_t *anjay) {
+    AVS_LIST_CLEAR(&anjay->bootstrap.discover_cache);
+}
+#    endif // ANJAY_WITH_DISCOVER
+
 void _anjay_bootstrap_cleanup(anjay_unlocked_t *anjay) {
     assert(!avs_coap_exchange_id_valid(
             anjay->bootstrap.outgoing_request_exchange_id));
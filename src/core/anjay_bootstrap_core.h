@@ -29,6 +29,18 @@ typedef enum {
 
 #ifdef ANJAY_WITH_BOOTSTRAP
 
+#    ifdef ANJAY_WITH_DISCOVER
+/**
+ * Bootstrap-Discover response rendered during the current Bootstrap session.
+ */
+typedef struct {
+    anjay_oid_t oid;
+    anjay_lwm2m_version_t lwm2m_version;
+    size_t payload_size;
+    char payload[];
+} anjay_bootstrap_discover_cached_t;
+#    endif // ANJAY_WITH_DISCOVER
+
 typedef struct {
     bool allow_legacy_server_initiated_bootstrap;
     bool bootstrap_trigger;
@@ -41,6 +53,13 @@ typedef struct {
     avs_sched_handle_t finish_timeout_handle;
     avs_time_monotonic_t client_initiated_bootstrap_last_attempt;
     avs_time_duration_t client_initiated_bootstrap_holdoff;
+#    ifdef ANJAY_WITH_DISCOVER
+    /**
+     * Responses to Bootstrap-Discover requests, so that repeating them is
+     * cheap. Dropped by @ref _anjay_bootstrap_discover_cache_invalidate .
+     */
+    AVS_LIST(anjay_bootstrap_discover_cached_t) discover_cache;
+#    endif // ANJAY_WITH_DISCOVER
 } anjay_bootstrap_t;
 
 int _anjay_bootstrap_notify_regular_connection_available(
@@ -61,6 +80,17 @@ int _anjay_perform_bootstrap_action_if_appropriate(
 void _anjay_bootstrap_init(anjay_bootstrap_t *bootstrap,
                            bool allow_legacy_server_initiated_bootstrap);
 
+#    ifdef ANJAY_WITH_DISCOVER
+/**
+ * Drops the cached Bootstrap-Discover responses. Called whenever the Bootstrap
+ * session starts or ends, on each Bootstrap-Write and Bootstrap-Delete, and
+ * when the set of Instances or the Security object changes otherwise.
+ */
+void _anjay_bootstrap_discover_cache_invalidate(anjay_unlocked_t *anjay);
+#    else  // ANJAY_WITH_DISCOVER
+#        define _anjay_bootstrap_discover_cache_invalidate(anjay) ((void) 0)
+#    endif // ANJAY_WITH_DISCOVER
+
 #else
 
 #    define _anjay_bootstrap_notify_regular_connection_available(anjay) \
@@ -74,6 +104,8 @@ void _anjay_bootstrap_init(anjay_bootstrap_t *bootstrap,
 
 #    define _anjay_perform_bootstrap_action_if_appropriate(...) (-1)
 
+#    define _anjay_bootstrap_discover_cache_invalidate(anjay) ((void) 0)
+
 #endif
 
 VISIBILITY_PRIVATE_HEADER_END
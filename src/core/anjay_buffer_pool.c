@@ -0,0 +1,339 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <assert.h>
+
+#include <avsystem/commons/avs_memory.h>
+
+#include <anjay_modules/anjay_sched.h>
+
+#include "anjay_buffer_pool.h"
+#include "anjay_core.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+/**
+ * Time without any demand for larger buffers after which the growable shared
+ * buffers are shrunk back to their minimum sizes.
+ */
+#define GROWABLE_BUFFERS_SHRINK_DELAY_S 60
+
+void _anjay_buffer_pool_init(anjay_buffer_pool_t *pool,
+                             size_t in_buffer_size,
+                             size_t out_buffer_size,
+                             size_t max_idle_entries) {
+    *pool = (anjay_buffer_pool_t) {
+        .in_buffer_size = in_buffer_size,
+        .out_buffer_size = out_buffer_size,
+        .max_idle_entries = max_idle_entries
+    };
+}
+
+static void delete_entry(AVS_LIST(anjay_buffer_pool_entry_t) *entry_ptr) {
+    avs_free((*entry_ptr)->in_buffer);
+    avs_free((*entry_ptr)->out_buffer);
+    AVS_LIST_DELETE(entry_ptr);
+}
+
+void _anjay_buffer_pool_cleanup(anjay_buffer_pool_t *pool) {
+    while (pool->entries) {
+        delete_entry(&pool->entries);
+    }
+    pool->idle_entries = 0;
+}
+
+anjay_buffer_pool_entry_t *
+_anjay_buffer_pool_lease(anjay_buffer_pool_t *pool) {
+    AVS_LIST(anjay_buffer_pool_entry_t) entry;
+    AVS_LIST_FOREACH(entry, pool->entries) {
+        if (!entry->leased) {
+            assert(pool->idle_entries > 0);
+            --pool->idle_entries;
+            entry->leased = true;
+            return entry;
+        }
+    }
+
+    if (!(entry = AVS_LIST_NEW_ELEMENT(anjay_buffer_pool_entry_t))
+            || !(entry->in_buffer =
+                         avs_shared_buffer_new(pool->in_buffer_size))
+            || !(entry->out_buffer =
+                         avs_shared_buffer_new(pool->out_buffer_size))) {
+        if (entry) {
+            delete_entry(&entry);
+        }
+        return NULL;
+    }
+    entry->leased = true;
+    AVS_LIST_INSERT(&pool->entries, entry);
+    return entry;
+}
+
+void _anjay_buffer_pool_return(anjay_buffer_pool_t *pool,
+                               anjay_buffer_pool_entry_t *entry) {
+    if (!entry) {
+        return;
+    }
+    AVS_LIST(anjay_buffer_pool_entry_t) *entry_ptr =
+            (AVS_LIST(anjay_buffer_pool_entry_t) *) AVS_LIST_FIND_PTR(
+                    &pool->entries, entry);
+    assert(entry_ptr);
+    assert(entry->leased);
+    if (pool->idle_entries < pool->max_idle_entries) {
+        entry->owner = NULL;
+        entry->leased = false;
+        ++pool->idle_entries;
+    } else {
+        delete_entry(entry_ptr);
+    }
+}
+
+anjay_buffer_pool_entry_t *
+_anjay_buffer_pool_find(anjay_buffer_pool_t *pool,
+                        const avs_coap_ctx_t *owner) {
+    if (owner) {
+        AVS_LIST(anjay_buffer_pool_entry_t) entry;
+        AVS_LIST_FOREACH(entry, pool->entries) {
+            if (entry->owner == owner) {
+                return entry;
+            }
+        }
+    }
+    return NULL;
+}
+
+void _anjay_growable_buffers_init(anjay_growable_buffers_t *buffers,
+                                  size_t in_min_size,
+                                  size_t in_max_size,
+                                  size_t out_min_size,
+                                  size_t out_max_size) {
+    *buffers = (anjay_growable_buffers_t) {
+        .in_min_size = AVS_MIN(in_min_size, in_max_size),
+        .in_max_size = in_max_size,
+        .out_min_size = AVS_MIN(out_min_size, out_max_size),
+        .out_max_size = out_max_size
+    };
+}
+
+void _anjay_growable_buffers_cleanup(anjay_growable_buffers_t *buffers) {
+    avs_sched_del(&buffers->shrink_job_handle);
+    AVS_LIST_CLEAR(&buffers->users);
+}
+
+/**
+ * Replaces the shared buffers with ones of the given sizes in all CoAP
+ * contexts. Either all of them are updated, or none.
+ */
+static int resize_shared_buffers(anjay_unlocked_t *anjay,
+                                 size_t in_size,
+                                 size_t out_size) {
+    if (in_size == anjay->in_shared_buffer->capacity
+            && out_size == anjay->out_shared_buffer->capacity) {
+        return 0;
+    }
+    AVS_LIST(avs_coap_ctx_t *) user;
+    AVS_LIST_FOREACH(user, anjay->growable_buffers.users) {
+        if (!avs_coap_ctx_buffers_replaceable(*user, in_size, out_size)) {
+            return -1;
+        }
+    }
+
+    avs_shared_buffer_t *in_buffer = anjay->in_shared_buffer;
+    avs_shared_buffer_t *out_buffer = anjay->out_shared_buffer;
+    if ((in_size != in_buffer->capacity
+         && !(in_buffer = avs_shared_buffer_new(in_size)))
+            || (out_size != out_buffer->capacity
+                && !(out_buffer = avs_shared_buffer_new(out_size)))) {
+        _anjay_log_oom();
+        if (in_buffer != anjay->in_shared_buffer) {
+            avs_free(in_buffer);
+        }
+        return -1;
+    }
+
+    AVS_LIST_FOREACH(user, anjay->growable_buffers.users) {
+        avs_error_t err =
+                avs_coap_ctx_set_buffers(*user, in_buffer, out_buffer);
+        assert(avs_is_ok(err));
+        (void) err;
+    }
+    anjay_log(DEBUG,
+              _("shared buffers resized to ") "%lu" _(" B (in), ") "%lu" _(
+                      " B (out)"),
+              (unsigned long) in_size, (unsigned long) out_size);
+    if (in_buffer != anjay->in_shared_buffer) {
+        avs_free(anjay->in_shared_buffer);
+        anjay->in_shared_buffer = in_buffer;
+    }
+    if (out_buffer != anjay->out_shared_buffer) {
+        avs_free(anjay->out_shared_buffer);
+        anjay->out_shared_buffer = out_buffer;
+    }
+    return 0;
+}
+
+static size_t grown_size(size_t current_size, size_t demand, size_t max_size) {
+    if (demand <= current_size) {
+        return current_size;
+    }
+    return AVS_MIN(AVS_MAX(demand, 2 * current_size), max_size);
+}
+
+/**
+ * Collects buffer demand from all CoAP contexts using the shared buffers.
+ *
+ * @returns true if there has been any demand for larger buffers.
+ */
+static bool take_buffer_demand(anjay_unlocked_t *anjay,
+                               size_t *out_in_demand,
+                               size_t *out_out_demand) {
+    *out_in_demand = 0;
+    *out_out_demand = 0;
+    AVS_LIST(avs_coap_ctx_t *) user;
+    AVS_LIST_FOREACH(user, anjay->growable_buffers.users) {
+        size_t in_demand;
+        size_t out_demand;
+        avs_coap_ctx_take_buffer_demand(*user, &in_demand, &out_demand);
+        *out_in_demand = AVS_MAX(*out_in_demand, in_demand);
+        *out_out_demand = AVS_MAX(*out_out_demand, out_demand);
+    }
+    return *out_in_demand > anjay->in_shared_buffer->capacity
+           || *out_out_demand > anjay->out_shared_buffer->capacity;
+}
+
+static void shrink_shared_buffers_job(avs_sched_t *sched, const void *dummy);
+
+static void schedule_shrink(anjay_unlocked_t *anjay) {
+    avs_sched_del(&anjay->growable_buffers.shrink_job_handle);
+    if (anjay->in_shared_buffer->capacity
+                    <= anjay->growable_buffers.in_min_size
+            && anjay->out_shared_buffer->capacity
+                       <= anjay->growable_buffers.out_min_size) {
+        return;
+    }
+    if (AVS_SCHED_DELAYED(anjay->sched,
+                          &anjay->growable_buffers.shrink_job_handle,
+                          avs_time_duration_from_scalar(
+                                  GROWABLE_BUFFERS_SHRINK_DELAY_S, AVS_TIME_S),
+                          shrink_shared_buffers_job, NULL, 0)) {
+        anjay_log(WARNING, _("could not schedule shrinking shared buffers"));
+    }
+}
+
+static void shrink_shared_buffers_job(avs_sched_t *sched, const void *dummy) {
+    (void) dummy;
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    size_t in_demand;
+    size_t out_demand;
+    if (take_buffer_demand(anjay, &in_demand, &out_demand)) {
+        // larger buffers have been needed since the last check
+        _anjay_growable_buffers_update(anjay);
+    } else if (resize_shared_buffers(anjay,
+                                     anjay->growable_buffers.in_min_size,
+                                     anjay->growable_buffers.out_min_size)) {
+        // retry later, e.g. after exchanges in progress are finished
+        schedule_shrink(anjay);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+void _anjay_growable_buffers_update(anjay_unlocked_t *anjay) {
+    if (!_anjay_growable_buffers_enabled(&anjay->growable_buffers)) {
+        return;
+    }
+    size_t in_demand;
+    size_t out_demand;
+    if (!take_buffer_demand(anjay, &in_demand, &out_demand)) {
+        return;
+    }
+    size_t in_size = grown_size(anjay->in_shared_buffer->capacity, in_demand,
+                                anjay->growable_buffers.in_max_size);
+    size_t out_size =
+            grown_size(anjay->out_shared_buffer->capacity, out_demand,
+                       anjay->growable_buffers.out_max_size);
+    if (resize_shared_buffers(anjay, in_size, out_size)) {
+        anjay_log(DEBUG, _("could not grow shared buffers"));
+    }
+    schedule_shrink(anjay);
+}
+
+int _anjay_coap_buffers_lease(anjay_unlocked_t *anjay,
+                              anjay_coap_buffers_t *out_buffers) {
+    if (!_anjay_buffer_pool_enabled(&anjay->buffer_pool)) {
+        *out_buffers = (anjay_coap_buffers_t) {
+            .in_buffer = anjay->in_shared_buffer,
+            .out_buffer = anjay->out_shared_buffer
+        };
+        if (_anjay_growable_buffers_enabled(&anjay->growable_buffers)
+                && !(out_buffers->user =
+                             AVS_LIST_NEW_ELEMENT(avs_coap_ctx_t *))) {
+            _anjay_log_oom();
+            return -1;
+        }
+        return 0;
+    }
+
+    anjay_buffer_pool_entry_t *entry =
+            _anjay_buffer_pool_lease(&anjay->buffer_pool);
+    if (!entry) {
+        _anjay_log_oom();
+        return -1;
+    }
+    *out_buffers = (anjay_coap_buffers_t) {
+        .in_buffer = entry->in_buffer,
+        .out_buffer = entry->out_buffer,
+        .entry = entry
+    };
+    return 0;
+}
+
+void _anjay_coap_buffers_bind(anjay_unlocked_t *anjay,
+                              const anjay_coap_buffers_t *buffers,
+                              avs_coap_ctx_t *ctx) {
+    if (buffers->user) {
+        AVS_LIST(avs_coap_ctx_t *) user = buffers->user;
+        if (ctx) {
+            *user = ctx;
+            AVS_LIST_INSERT(&anjay->growable_buffers.users, user);
+        } else {
+            AVS_LIST_DELETE(&user);
+        }
+    }
+    if (!buffers->entry) {
+        return;
+    }
+    if (ctx) {
+        assert(!buffers->entry->owner);
+        buffers->entry->owner = ctx;
+    } else {
+        _anjay_buffer_pool_return(&anjay->buffer_pool, buffers->entry);
+    }
+}
+
+anjay_buffer_pool_entry_t *_anjay_coap_buffers_unbind(anjay_unlocked_t *anjay,
+                                                      avs_coap_ctx_t *ctx) {
+    if (!ctx) {
+        return NULL;
+    }
+    AVS_LIST(avs_coap_ctx_t *) *user_ptr;
+    AVS_LIST_FOREACH_PTR(user_ptr, &anjay->growable_buffers.users) {
+        if (**user_ptr == ctx) {
+            AVS_LIST_DELETE(user_ptr);
+            return NULL;
+        }
+    }
+    return _anjay_buffer_pool_find(&anjay->buffer_pool, ctx);
+}
+
+#ifdef ANJAY_TEST
+#    include "tests/core/buffer_pool.c"
+#endif // ANJAY_TEST
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_BUFFER_POOL_H
+#define ANJAY_BUFFER_POOL_H
+
+#include <anjay_init.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_sched.h>
+#include <avsystem/commons/avs_shared_buffer.h>
+
+#include <avsystem/coap/ctx.h>
+
+#include <anjay_modules/anjay_utils_core.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Pair of input and output buffers owned by a single CoAP context.
+ */
+typedef struct {
+    /**
+     * CoAP context using the buffers, or NULL if the entry is idle or the
+     * context is not created yet.
+     */
+    avs_coap_ctx_t *owner;
+    bool leased;
+    avs_shared_buffer_t *in_buffer;
+    avs_shared_buffer_t *out_buffer;
+} anjay_buffer_pool_entry_t;
+
+/**
+ * Pool of buffer pairs, enabled with
+ * @ref anjay_configuration_t::connection_buffer_pool_size , so that each CoAP
+ * context (LwM2M Server connection or CoAP download) uses its own buffers
+ * instead of the ones shared by the whole Anjay object.
+ *
+ * Buffers are allocated when a context is created, and returned to the pool
+ * when it is cleaned up. Up to <c>max_idle_entries</c> idle pairs are kept
+ * allocated for reuse; the rest is freed immediately.
+ */
+typedef struct {
+    size_t in_buffer_size;
+    size_t out_buffer_size;
+    size_t max_idle_entries;
+    size_t idle_entries;
+    AVS_LIST(anjay_buffer_pool_entry_t) entries;
+} anjay_buffer_pool_t;
+
+void _anjay_buffer_pool_init(anjay_buffer_pool_t *pool,
+                             size_t in_buffer_size,
+                             size_t out_buffer_size,
+                             size_t max_idle_entries);
+
+/**
+ * Frees all the buffers, including the leased ones. MUST only be called after
+ * all the CoAP contexts created using them are no longer used.
+ */
+void _anjay_buffer_pool_cleanup(anjay_buffer_pool_t *pool);
+
+static inline bool
+_anjay_buffer_pool_enabled(const anjay_buffer_pool_t *pool) {
+    return pool->max_idle_entries > 0;
+}
+
+/**
+ * Leases an idle entry, or allocates a new one if there is none.
+ *
+ * @returns Leased entry, or NULL in case of an out-of-memory condition.
+ */
+anjay_buffer_pool_entry_t *_anjay_buffer_pool_lease(anjay_buffer_pool_t *pool);
+
+/**
+ * Returns the entry leased with @ref _anjay_buffer_pool_lease to the pool. Does
+ * nothing if @p entry is NULL.
+ */
+void _anjay_buffer_pool_return(anjay_buffer_pool_t *pool,
+                               anjay_buffer_pool_entry_t *entry);
+
+/**
+ * Finds the entry owned by @p owner , or returns NULL if there is none (e.g.
+ * if the context uses the shared buffers).
+ */
+anjay_buffer_pool_entry_t *
+_anjay_buffer_pool_find(anjay_buffer_pool_t *pool, const avs_coap_ctx_t *owner);
+
+/**
+ * State of the buffers shared by the whole Anjay object, if they are allowed to
+ * grow and shrink between the sizes configured with
+ * @ref anjay_configuration_t::in_buffer_min_size ,
+ * @ref anjay_configuration_t::in_buffer_size ,
+ * @ref anjay_configuration_t::out_buffer_min_size and
+ * @ref anjay_configuration_t::out_buffer_size .
+ *
+ * The buffers are grown when any of the CoAP contexts using them reports that
+ * larger ones would have been useful (see
+ * @ref avs_coap_ctx_take_buffer_demand), and shrunk back to the minimum sizes
+ * once there has been no such demand for a while.
+ */
+typedef struct {
+    size_t in_min_size;
+    size_t in_max_size;
+    size_t out_min_size;
+    size_t out_max_size;
+    /**
+     * CoAP contexts using the shared buffers, so that they can be replaced
+     * in all of them when resizing.
+     */
+    AVS_LIST(avs_coap_ctx_t *) users;
+    avs_sched_handle_t shrink_job_handle;
+} anjay_growable_buffers_t;
+
+void _anjay_growable_buffers_init(anjay_growable_buffers_t *buffers,
+                                  size_t in_min_size,
+                                  size_t in_max_size,
+                                  size_t out_min_size,
+                                  size_t out_max_size);
+
+void _anjay_growable_buffers_cleanup(anjay_growable_buffers_t *buffers);
+
+static inline bool
+_anjay_growable_buffers_enabled(const anjay_growable_buffers_t *buffers) {
+    return buffers->in_min_size < buffers->in_max_size
+           || buffers->out_min_size < buffers->out_max_size;
+}
+
+/**
+ * Grows the shared buffers if any of the CoAP contexts using them needs it.
+ * Supposed to be called after handling incoming packets. Does nothing if the
+ * buffers are not growable.
+ */
+void _anjay_growable_buffers_update(anjay_unlocked_t *anjay);
+
+/**
+ * Buffers to create a CoAP context with, as acquired by
+ * @ref _anjay_coap_buffers_lease .
+ */
+typedef struct {
+    avs_shared_buffer_t *in_buffer;
+    avs_shared_buffer_t *out_buffer;
+    /** NULL if the shared buffers are used. */
+    anjay_buffer_pool_entry_t *entry;
+    /**
+     * Element of @ref anjay_growable_buffers_t::users preallocated for the
+     * context, if the shared buffers are used and growable.
+     */
+    AVS_LIST(avs_coap_ctx_t *) user;
+} anjay_coap_buffers_t;
+
+/**
+ * Acquires buffers for a new CoAP context: either a pair leased from the
+ * buffer pool, if enabled, or the buffers shared by the whole @p anjay object.
+ *
+ * The buffers MUST be passed to @ref _anjay_coap_buffers_bind after an attempt
+ * to create the CoAP context, regardless of its result.
+ *
+ * @returns 0 on success, or a negative value in case of an out-of-memory
+ *          condition.
+ */
+int _anjay_coap_buffers_lease(anjay_unlocked_t *anjay,
+                              anjay_coap_buffers_t *out_buffers);
+
+/**
+ * Associates @p buffers with @p ctx so that they are returned to the pool
+ * when the context is cleaned up using @ref _anjay_coap_ctx_cleanup . If
+ * @p ctx is NULL (i.e. its creation failed), the buffers are returned to the
+ * pool immediately.
+ */
+void _anjay_coap_buffers_bind(anjay_unlocked_t *anjay,
+                              const anjay_coap_buffers_t *buffers,
+                              avs_coap_ctx_t *ctx);
+
+/**
+ * Dissociates the buffers from @p ctx before it is cleaned up.
+ *
+ * @returns Buffer pool entry owned by @p ctx , which shall be passed to
+ *          @ref _anjay_buffer_pool_return after the context is cleaned up, or
+ *          NULL if the context uses the shared buffers.
+ */
+anjay_buffer_pool_entry_t *_anjay_coap_buffers_unbind(anjay_unlocked_t *anjay,
+                                                      avs_coap_ctx_t *ctx);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif // ANJAY_BUFFER_POOL_H
@@ -0,0 +1,296 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_LWM2M11
+
+#    include <stdint.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_errno.h>
+#    include <avsystem/commons/avs_memory.h>
+
+#    include "anjay_cert_chain.h"
+#    include "anjay_core.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#    define DER_TAG_SEQUENCE 0x30
+#    define DER_TAG_VERSION 0xA0
+
+// including the client certificate itself
+#    define MAX_CHAIN_LENGTH 8
+
+typedef struct {
+    const uint8_t *ptr;
+    size_t size;
+} der_span_t;
+
+/**
+ * Reads a single TLV element from the beginning of @p in , and advances it past
+ * that element. @p out_element is set to the whole element, and @p out_value
+ * to its contents.
+ */
+static int der_read(der_span_t *in,
+                    uint8_t *out_tag,
+                    der_span_t *out_element,
+                    der_span_t *out_value) {
+    if (in->size < 2) {
+        return -1;
+    }
+    size_t header_size = 2;
+    size_t length = in->ptr[1];
+    if (length & 0x80) {
+        const size_t length_size = length & 0x7F;
+        if (!length_size || length_size > sizeof(uint32_t)
+                || in->size < header_size + length_size) {
+            return -1;
+        }
+        length = 0;
+        for (size_t i = 0; i < length_size; ++i) {
+            length = (length << 8) | in->ptr[header_size + i];
+        }
+        header_size += length_size;
+    }
+    if (length > in->size - header_size) {
+        return -1;
+    }
+    *out_tag = in->ptr[0];
+    if (out_element) {
+        out_element->ptr = in->ptr;
+        out_element->size = header_size + length;
+    }
+    out_value->ptr = in->ptr + header_size;
+    out_value->size = length;
+    in->ptr += header_size + length;
+    in->size -= header_size + length;
+    return 0;
+}
+
+/**
+ * Extracts the encoded issuer and subject Names of a DER-encoded X.509
+ * certificate.
+ */
+static int get_cert_names(const avs_crypto_certificate_chain_info_t *cert,
+                          der_span_t *out_issuer,
+                          der_span_t *out_subject) {
+    if (cert->desc.source != AVS_CRYPTO_DATA_SOURCE_BUFFER) {
+        return -1;
+    }
+    der_span_t in = {
+        .ptr = (const uint8_t *) cert->desc.info.buffer.buffer,
+        .size = cert->desc.info.buffer.buffer_size
+    };
+    der_span_t certificate;
+    der_span_t tbs;
+    der_span_t field;
+    uint8_t tag;
+    if (der_read(&in, &tag, NULL, &certificate) || tag != DER_TAG_SEQUENCE
+            || der_read(&certificate, &tag, NULL, &tbs)
+            || tag != DER_TAG_SEQUENCE
+            // version (optional) or serialNumber
+            || der_read(&tbs, &tag, NULL, &field)
+            || (tag == DER_TAG_VERSION && der_read(&tbs, &tag, NULL, &field))
+            // signature
+            || der_read(&tbs, &tag, NULL, &field) || tag != DER_TAG_SEQUENCE
+            || der_read(&tbs, &tag, out_issuer, &field)
+            || tag != DER_TAG_SEQUENCE
+            // validity
+            || der_read(&tbs, &tag, NULL, &field) || tag != DER_TAG_SEQUENCE
+            || der_read(&tbs, &tag, out_subject, &field)
+            || tag != DER_TAG_SEQUENCE) {
+        return -1;
+    }
+    return 0;
+}
+
+static bool names_equal(const der_span_t *a, const der_span_t *b) {
+    return a->size == b->size && !memcmp(a->ptr, b->ptr, a->size);
+}
+
+static bool trust_store_searchable(const anjay_trust_store_t *trust_store) {
+    if (trust_store->use_system_wide) {
+        return false;
+    }
+    AVS_LIST(avs_crypto_certificate_chain_info_t) cert;
+    AVS_LIST_FOREACH(cert, trust_store->certs) {
+        der_span_t issuer;
+        der_span_t subject;
+        if (get_cert_names(cert, &issuer, &subject)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const avs_crypto_certificate_chain_info_t *
+find_issuer(const anjay_trust_store_t *trust_store,
+            const avs_crypto_certificate_chain_info_t *chain,
+            size_t chain_length,
+            const der_span_t *issuer) {
+    AVS_LIST(avs_crypto_certificate_chain_info_t) cert;
+    AVS_LIST_FOREACH(cert, trust_store->certs) {
+        der_span_t cert_issuer;
+        der_span_t cert_subject;
+        if (get_cert_names(cert, &cert_issuer, &cert_subject)
+                || !names_equal(&cert_subject, issuer)) {
+            continue;
+        }
+        size_t i;
+        for (i = 0; i < chain_length; ++i) {
+            if (chain[i].desc.info.buffer.buffer
+                    == cert->desc.info.buffer.buffer) {
+                break;
+            }
+        }
+        if (i == chain_length) {
+            return cert;
+        }
+    }
+    return NULL;
+}
+
+static avs_error_t build_chain(const anjay_trust_store_t *trust_store,
+                               const avs_crypto_certificate_chain_info_t *certs,
+                               size_t cert_count,
+                               anjay_client_cert_chain_t *out_entry) {
+    avs_crypto_certificate_chain_info_t chain[MAX_CHAIN_LENGTH];
+    if (cert_count > MAX_CHAIN_LENGTH) {
+        return avs_errno(AVS_EINVAL);
+    }
+    memcpy(chain, certs, cert_count * sizeof(*certs));
+    size_t chain_length = cert_count;
+    while (chain_length < MAX_CHAIN_LENGTH) {
+        der_span_t issuer;
+        der_span_t subject;
+        if (get_cert_names(&chain[chain_length - 1], &issuer, &subject)) {
+            return avs_errno(AVS_EINVAL);
+        }
+        if (names_equal(&issuer, &subject)) {
+            // self-signed
+            break;
+        }
+        const avs_crypto_certificate_chain_info_t *parent =
+                find_issuer(trust_store, chain, chain_length, &issuer);
+        if (!parent) {
+            break;
+        }
+        chain[chain_length++] = *parent;
+    }
+    return avs_crypto_certificate_chain_info_copy_as_array(
+            &out_entry->chain, &out_entry->chain_length,
+            avs_crypto_certificate_chain_info_from_array(chain, chain_length));
+}
+
+static void delete_entry(AVS_LIST(anjay_client_cert_chain_t) *entry_ptr) {
+    avs_free((*entry_ptr)->chain);
+    AVS_LIST_DELETE(entry_ptr);
+}
+
+/**
+ * Returns a pointer to the cached chain for @p security_iid and
+ * @p trust_store , or to the list end if there is none. Chains built for
+ * previous versions of the Security object or trust stores are removed.
+ */
+static AVS_LIST(anjay_client_cert_chain_t) *
+find_entry_ptr(anjay_unlocked_t *anjay,
+               anjay_iid_t security_iid,
+               const anjay_trust_store_t *trust_store) {
+    AVS_LIST(anjay_client_cert_chain_t) *entry_ptr = &anjay->client_cert_chains;
+    while (*entry_ptr) {
+        if ((*entry_ptr)->security_generation != anjay->security_generation
+                || ((*entry_ptr)->trust_store == trust_store
+                    && (*entry_ptr)->trust_store_generation
+                                   != trust_store->generation)) {
+            delete_entry(entry_ptr);
+        } else if ((*entry_ptr)->security_iid == security_iid
+                   && (*entry_ptr)->trust_store == trust_store) {
+            break;
+        } else {
+            AVS_LIST_ADVANCE_PTR(&entry_ptr);
+        }
+    }
+    return entry_ptr;
+}
+
+avs_error_t
+_anjay_client_cert_chain_complete(anjay_unlocked_t *anjay,
+                                  anjay_iid_t security_iid,
+                                  const anjay_trust_store_t *trust_store,
+                                  anjay_security_config_cache_t *cache,
+                                  size_t client_cert_count,
+                                  avs_net_certificate_info_t *inout_info) {
+    if (!client_cert_count) {
+        return AVS_OK;
+    }
+    AVS_LIST(anjay_client_cert_chain_t) *entry_ptr =
+            find_entry_ptr(anjay, security_iid, trust_store);
+    if (!*entry_ptr) {
+        if (!trust_store_searchable(trust_store)) {
+            return AVS_OK;
+        }
+        AVS_LIST(anjay_client_cert_chain_t) entry =
+                AVS_LIST_NEW_ELEMENT(anjay_client_cert_chain_t);
+        if (!entry) {
+            _anjay_log_oom();
+            return avs_errno(AVS_ENOMEM);
+        }
+        avs_error_t err = build_chain(trust_store, cache->client_cert_array,
+                                      client_cert_count, entry);
+        if (avs_is_err(err)) {
+            AVS_LIST_DELETE(&entry);
+            // e.g. a PEM-encoded client certificate
+            anjay_log(DEBUG,
+                      _("could not build client certificate chain for ") "%s" _(
+                              ", leaving it to the TLS backend"),
+                      ANJAY_DEBUG_MAKE_PATH(&MAKE_INSTANCE_PATH(
+                              ANJAY_DM_OID_SECURITY, security_iid)));
+            return AVS_OK;
+        }
+        anjay_log(DEBUG,
+                  _("built client certificate chain of ") "%u" _(
+                          " certificates for ") "/%u/%u",
+                  (unsigned) entry->chain_length, ANJAY_DM_OID_SECURITY,
+                  security_iid);
+        entry->security_iid = security_iid;
+        entry->security_generation = anjay->security_generation;
+        entry->trust_store = trust_store;
+        entry->trust_store_generation = trust_store->generation;
+        AVS_LIST_INSERT(entry_ptr, entry);
+    }
+
+    avs_crypto_certificate_chain_info_t *chain = NULL;
+    size_t chain_length;
+    avs_error_t err = avs_crypto_certificate_chain_info_copy_as_array(
+            &chain, &chain_length,
+            avs_crypto_certificate_chain_info_from_array(
+                    (*entry_ptr)->chain, (*entry_ptr)->chain_length));
+    if (avs_is_err(err)) {
+        return err;
+    }
+    avs_free(cache->client_cert_array);
+    cache->client_cert_array = chain;
+    inout_info->client_cert =
+            avs_crypto_certificate_chain_info_from_array(chain, chain_length);
+    inout_info->rebuild_client_cert_chain = false;
+    return AVS_OK;
+}
+
+void _anjay_client_cert_chains_cleanup(anjay_unlocked_t *anjay) {
+    while (anjay->client_cert_chains) {
+        delete_entry(&anjay->client_cert_chains);
+    }
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/core/cert_chain.c"
+#    endif // ANJAY_TEST
+
+#endif // ANJAY_WITH_LWM2M11
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_CERT_CHAIN_H
+#define ANJAY_CERT_CHAIN_H
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_crypto_pki.h>
+#include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_net.h>
+
+#include <anjay_modules/anjay_utils_core.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#ifdef ANJAY_WITH_LWM2M11
+
+/**
+ * Client certificate chain of a Security object instance, completed with its
+ * ancestors found in a trust store.
+ */
+typedef struct {
+    anjay_iid_t security_iid;
+    /** Value of anjay_unlocked_t::security_generation at the time of build. */
+    size_t security_generation;
+    const anjay_trust_store_t *trust_store;
+    /** Value of anjay_trust_store_t::generation at the time of build. */
+    size_t trust_store_generation;
+    avs_crypto_certificate_chain_info_t *chain;
+    size_t chain_length;
+} anjay_client_cert_chain_t;
+
+/**
+ * Completes the client certificate chain in @p inout_info - previously set to
+ * the <c>client_cert_array</c> of @p cache containing @p client_cert_count
+ * elements - with its ancestors from @p trust_store , so that the (D)TLS
+ * backend does not need to rebuild it during each handshake.
+ *
+ * The built chain is cached per Security object instance and reused until the
+ * Security object or the trust store change. On success, the chain is copied
+ * into @p cache and <c>rebuild_client_cert_chain</c> is cleared in
+ * @p inout_info .
+ *
+ * If the trust store cannot be searched by Anjay itself, i.e. it includes the
+ * system-wide trust store or certificates not provided as DER buffers,
+ * @p inout_info is left unchanged, leaving the rebuild to the backend.
+ */
+avs_error_t
+_anjay_client_cert_chain_complete(anjay_unlocked_t *anjay,
+                                  anjay_iid_t security_iid,
+                                  const anjay_trust_store_t *trust_store,
+                                  anjay_security_config_cache_t *cache,
+                                  size_t client_cert_count,
+                                  avs_net_certificate_info_t *inout_info);
+
+void _anjay_client_cert_chains_cleanup(anjay_unlocked_t *anjay);
+
+#endif // ANJAY_WITH_LWM2M11
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_CERT_CHAIN_H */
@@ -16,6 +16,7 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <avsystem/commons/avs_errno.h>
 #include <avsystem/commons/avs_memory.h>
@@ -27,6 +28,7 @@
 #include <anjay/core.h>
 #include <anjay/stats.h>
 
+#include <anjay_modules/anjay_memory_accounting.h>
 #include <anjay_modules/anjay_time_defs.h>
 
 #include <anjay_config_log.h>
@@ -37,6 +39,7 @@
 
 #include "anjay_bootstrap_core.h"
 #include "anjay_dm_core.h"
+#include "anjay_dns_cache.h"
 #include "anjay_downloader.h"
 #include "anjay_io_core.h"
 #include "anjay_servers_utils.h"
@@ -59,6 +62,13 @@ static anjay_lwm2m_version_config_t ALL_VERSIONS = {
 
 static int init_anjay(anjay_unlocked_t *anjay,
                       const anjay_configuration_t *config) {
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+    anjay->startup_timestamps = (anjay_startup_timestamps_t) {
+        .created = avs_time_monotonic_now(),
+        .last_object_installed = AVS_TIME_MONOTONIC_INVALID,
+        .last_state_restored = AVS_TIME_MONOTONIC_INVALID
+    };
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
 #ifdef ANJAY_WITH_THREAD_SAFETY
     if (!(anjay->coap_sched = avs_sched_new("Anjay CoAP", NULL))) {
         _anjay_log_oom();
@@ -155,8 +165,13 @@ static int init_anjay(anjay_unlocked_t *anjay,
     }
     anjay->udp_exchange_timeout = AVS_COAP_DEFAULT_EXCHANGE_MAX_TIME;
     if (config->msg_cache_size) {
-        anjay->udp_response_cache =
-                avs_coap_udp_response_cache_create(config->msg_cache_size);
+        ANJAY_MEMORY_TAG_ENTER(prev_memory_tag,
+                               ANJAY_MEMORY_TAG_RESPONSE_CACHE);
+        anjay->udp_response_cache = avs_coap_udp_response_cache_create_growable(
+                config->msg_cache_min_size ? config->msg_cache_min_size
+                                           : config->msg_cache_size,
+                config->msg_cache_size);
+        ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
         if (!anjay->udp_response_cache) {
             _anjay_log_oom();
             return -1;
@@ -209,24 +224,89 @@ static int init_anjay(anjay_unlocked_t *anjay,
         anjay->coap_tcp_request_timeout =
                 ANJAY_DEFAULT_COAP_TCP_REQUEST_TIMEOUT;
     }
+    anjay->coap_tcp_write_coalescing_buffer_size =
+            config->coap_tcp_write_coalescing_buffer_size;
+    static const size_t ANJAY_DEFAULT_COAP_TCP_RECEIVE_BUDGET = 8;
+    if (config->coap_tcp_receive_budget == 0) {
+        anjay->coap_tcp_receive_budget = ANJAY_DEFAULT_COAP_TCP_RECEIVE_BUDGET;
+    } else {
+        anjay->coap_tcp_receive_budget = config->coap_tcp_receive_budget;
+    }
+    if (avs_time_duration_valid(config->coap_tcp_keepalive_interval)
+            && avs_time_duration_less(AVS_TIME_DURATION_ZERO,
+                                      config->coap_tcp_keepalive_interval)) {
+        anjay->coap_tcp_keepalive_interval =
+                config->coap_tcp_keepalive_interval;
+    } else {
+        anjay->coap_tcp_keepalive_interval = AVS_TIME_DURATION_ZERO;
+    }
     anjay->tcp_exchange_timeout = AVS_COAP_DEFAULT_EXCHANGE_MAX_TIME;
 #    endif // defined(ANJAY_WITH_LWM2M11) || defined(ANJAY_WITH_COAP_DOWNLOAD)
 #endif     // WITH_AVS_COAP_TCP
 
-    anjay->in_shared_buffer = avs_shared_buffer_new(config->in_buffer_size);
+    _anjay_buffer_pool_init(&anjay->buffer_pool, config->in_buffer_size,
+                            config->out_buffer_size,
+                            config->connection_buffer_pool_size);
+    if (_anjay_buffer_pool_enabled(&anjay->buffer_pool)) {
+        // buffers leased from the pool are always allocated at full size
+        _anjay_growable_buffers_init(&anjay->growable_buffers,
+                                     config->in_buffer_size,
+                                     config->in_buffer_size,
+                                     config->out_buffer_size,
+                                     config->out_buffer_size);
+    } else {
+        _anjay_growable_buffers_init(
+                &anjay->growable_buffers,
+                config->in_buffer_min_size ? config->in_buffer_min_size
+                                           : config->in_buffer_size,
+                config->in_buffer_size,
+                config->out_buffer_min_size ? config->out_buffer_min_size
+                                            : config->out_buffer_size,
+                config->out_buffer_size);
+    }
+    anjay->in_shared_buffer =
+            avs_shared_buffer_new(anjay->growable_buffers.in_min_size);
     if (!anjay->in_shared_buffer) {
         _anjay_log_oom();
         return -1;
     }
-    anjay->out_shared_buffer = avs_shared_buffer_new(config->out_buffer_size);
+    anjay->out_shared_buffer =
+            avs_shared_buffer_new(anjay->growable_buffers.out_min_size);
     if (!anjay->out_shared_buffer) {
         _anjay_log_oom();
         return -1;
     }
+    if (_anjay_arena_init(&anjay->request_arena, config->request_arena_size)) {
+        _anjay_log_oom();
+        return -1;
+    }
+#ifdef ANJAY_WITH_DEFERRED_LOGS
+    if (_anjay_deferred_log_init(&anjay->deferred_log,
+                                 config->deferred_log_buffer_size
+                                         ? config->deferred_log_buffer_size
+                                         : ANJAY_DEFERRED_LOG_DEFAULT_SIZE)) {
+        return -1;
+    }
+#endif // ANJAY_WITH_DEFERRED_LOGS
 
     _anjay_observe_init(&anjay->observe,
                         config->confirmable_notifications,
-                        config->stored_notification_limit);
+                        config->stored_notification_limit,
+                        config->stored_notification_memory_limit,
+                        config->share_observation_samples,
+                        config->coalesce_observation_triggers,
+                        config->observation_trigger_slack,
+                        config->merge_queued_notifications,
+                        config->notification_flush_burst,
+                        config->cache_notification_payload,
+                        config->cache_observation_attrs);
+    anjay->dm.server_params.enabled = config->cache_server_params;
+
+#ifdef ANJAY_WITH_SEND
+    _anjay_send_init(&anjay->sender, config->send_coalescing_window,
+                     config->send_coalescing_max_payload_size,
+                     config->send_rate_limit, config->send_rate_limit_burst);
+#endif // ANJAY_WITH_SEND
 
     anjay->online_transports =
             _anjay_transport_set_remove_unavailable(anjay,
@@ -239,11 +319,48 @@ static int init_anjay(anjay_unlocked_t *anjay,
 #endif // ANJAY_WITH_DOWNLOADER
 
     anjay->prefer_hierarchical_formats = config->prefer_hierarchical_formats;
+    anjay->prefer_compact_formats = config->prefer_compact_formats;
     anjay->update_immediately_on_dm_change =
             config->update_immediately_on_dm_change;
     anjay->connection_error_is_registration_failure =
             config->connection_error_is_registration_failure;
+    anjay->cache_registration_payload = config->cache_registration_payload;
+    anjay->udp_path_mtu_discovery = config->udp_path_mtu_discovery;
+    anjay->udp_nat_keepalive = config->udp_nat_keepalive;
+    anjay->udp_compression = config->udp_compression;
+    anjay->udp_compression_arg = config->udp_compression_arg;
+#ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+    if (_anjay_notify_change_queue_init(anjay,
+                                        config->notify_change_queue_size)) {
+        return -1;
+    }
+#endif // ANJAY_WITH_LOCK_FREE_NOTIFY
+    anjay->queue_mode_wake_window = config->queue_mode_wake_window;
+    anjay->queue_mode_adaptive_close = config->queue_mode_adaptive_close;
+    anjay->randomize_communication_retries =
+            config->randomize_communication_retries;
+    anjay->reconnect_jitter = config->reconnect_jitter;
+    anjay->dns_cache_lifetime = config->dns_cache_lifetime;
+#ifdef ANJAY_WITH_THREAD_SAFETY
+    anjay->transaction_validate_executor =
+            config->transaction_validate_executor;
+    anjay->transaction_validate_executor_arg =
+            config->transaction_validate_executor_arg;
+#endif // ANJAY_WITH_THREAD_SAFETY
+#ifdef ANJAY_WITH_THREAD_SAFETY
+    anjay->coap_sched_slack = config->coap_sched_slack;
+#endif // ANJAY_WITH_THREAD_SAFETY
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    anjay->udp_q_block1_max_payloads = config->udp_q_block1_max_payloads;
+    anjay->udp_q_block2 = config->udp_q_block2;
+#endif // WITH_AVS_COAP_Q_BLOCK
     anjay->enable_self_notify = config->enable_self_notify;
+    anjay->scheduled_notify.debounce_window = AVS_TIME_DURATION_ZERO;
+    if (avs_time_duration_less(AVS_TIME_DURATION_ZERO,
+                               config->notify_debounce_window)) {
+        anjay->scheduled_notify.debounce_window =
+                config->notify_debounce_window;
+    }
     anjay->use_connection_id = config->use_connection_id;
     anjay->additional_tls_config_clb = config->additional_tls_config_clb;
 
@@ -268,16 +385,131 @@ static int init_anjay(anjay_unlocked_t *anjay,
 }
 
 #ifdef ANJAY_WITH_THREAD_SAFETY
+static int create_locks(anjay_t *anjay) {
+    if (avs_mutex_create(&anjay->mutex)) {
+        return -1;
+    }
+    if (avs_mutex_create(&anjay->shared_lock_mutex)) {
+        avs_mutex_cleanup(&anjay->mutex);
+        return -1;
+    }
+    if (avs_condvar_create(&anjay->shared_lock_released)) {
+        avs_mutex_cleanup(&anjay->shared_lock_mutex);
+        avs_mutex_cleanup(&anjay->mutex);
+        return -1;
+    }
+#    ifdef ANJAY_WITH_LOCK_STATS
+    if (!(anjay->lock_stats = _anjay_lock_stats_new())) {
+        avs_condvar_cleanup(&anjay->shared_lock_released);
+        avs_mutex_cleanup(&anjay->shared_lock_mutex);
+        avs_mutex_cleanup(&anjay->mutex);
+        return -1;
+    }
+#    endif // ANJAY_WITH_LOCK_STATS
+    return 0;
+}
+
+static void cleanup_locks(anjay_t *anjay) {
+    assert(!anjay->shared_lock_holders);
+#    ifdef ANJAY_WITH_LOCK_STATS
+    _anjay_lock_stats_delete(&anjay->lock_stats);
+#    endif // ANJAY_WITH_LOCK_STATS
+    avs_condvar_cleanup(&anjay->shared_lock_released);
+    avs_mutex_cleanup(&anjay->shared_lock_mutex);
+    avs_mutex_cleanup(&anjay->mutex);
+}
+
+int _anjay_lock_exclusive(anjay_t *anjay) {
+    if (avs_mutex_lock(anjay->mutex)) {
+        return -1;
+    }
+    // Holding the main mutex prevents any new shared sections from beginning,
+    // so we only need to wait for the ones already running
+    if (avs_mutex_lock(anjay->shared_lock_mutex)) {
+        avs_mutex_unlock(anjay->mutex);
+        return -1;
+    }
+    int result = 0;
+    while (!result && anjay->shared_lock_holders) {
+        result = avs_condvar_wait(anjay->shared_lock_released,
+                                  anjay->shared_lock_mutex,
+                                  AVS_TIME_MONOTONIC_INVALID);
+    }
+    avs_mutex_unlock(anjay->shared_lock_mutex);
+    if (result) {
+        avs_mutex_unlock(anjay->mutex);
+        return -1;
+    }
+    return 0;
+}
+
+int _anjay_lock_shared(anjay_t *anjay) {
+    if (avs_mutex_lock(anjay->mutex)) {
+        return -1;
+    }
+    int result = avs_mutex_lock(anjay->shared_lock_mutex);
+    if (!result) {
+        if (!anjay->shared_lock_holders++) {
+            ((anjay_unlocked_t *) &anjay->anjay_unlocked_placeholder)
+                    ->shared_lock_held = true;
+        }
+        avs_mutex_unlock(anjay->shared_lock_mutex);
+    }
+    avs_mutex_unlock(anjay->mutex);
+    return result ? -1 : 0;
+}
+
+void _anjay_unlock_shared(anjay_t *anjay) {
+    if (avs_mutex_lock(anjay->shared_lock_mutex)) {
+        anjay_log(ERROR, _("Could not lock mutex"));
+        return;
+    }
+    assert(anjay->shared_lock_holders > 0);
+    if (!--anjay->shared_lock_holders) {
+        ((anjay_unlocked_t *) &anjay->anjay_unlocked_placeholder)
+                ->shared_lock_held = false;
+        avs_condvar_notify_all(anjay->shared_lock_released);
+    }
+    avs_mutex_unlock(anjay->shared_lock_mutex);
+}
+
 static void coap_sched_job(avs_sched_t *sched, const void *dummy) {
     (void) dummy;
     anjay_t *anjay_locked = _anjay_get_from_sched(sched);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    ANJAY_SCHED_JOB_STATS_BEGIN(job_start_time);
     if (anjay->coap_sched) {
+        ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_COAP);
         avs_sched_run(anjay->coap_sched);
+        ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
     }
+    ANJAY_SCHED_JOB_STATS_END(anjay, ANJAY_SCHED_JOB_COAP, job_start_time);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
 
+static avs_time_monotonic_t
+coalesce_coap_sched_job_time(anjay_unlocked_t *anjay,
+                             avs_time_monotonic_t coap_job_time) {
+    if (!avs_time_duration_less(AVS_TIME_DURATION_ZERO,
+                                anjay->coap_sched_slack)) {
+        return coap_job_time;
+    }
+    // If the proxy job is already scheduled within the allowed slack, or some
+    // other job is due shortly after the CoAP one, run both in one wakeup.
+    // The main scheduler does not know the proxy job's target time otherwise.
+    avs_time_monotonic_t latest_time =
+            avs_time_monotonic_add(coap_job_time, anjay->coap_sched_slack);
+    avs_time_monotonic_t candidate_time =
+            anjay->coap_sched_job_handle ? anjay->coap_sched_job_time
+                                         : avs_sched_time_of_next(anjay->sched);
+    if (avs_time_monotonic_valid(candidate_time)
+            && !avs_time_monotonic_before(candidate_time, coap_job_time)
+            && !avs_time_monotonic_before(latest_time, candidate_time)) {
+        return candidate_time;
+    }
+    return coap_job_time;
+}
+
 void _anjay_reschedule_coap_sched_job(anjay_unlocked_t *anjay) {
     // NOTE: This function is implicitly called at every ANJAY_MUTEX_UNLOCK()
     // This is necessary because the CoAP jobs need to be run with the Anjay
@@ -286,12 +518,22 @@ void _anjay_reschedule_coap_sched_job(anjay_unlocked_t *anjay) {
         avs_time_monotonic_t next_job_time =
                 avs_sched_time_of_next(anjay->coap_sched);
         if (avs_time_monotonic_valid(next_job_time)) {
+            next_job_time = coalesce_coap_sched_job_time(anjay, next_job_time);
+            if (anjay->coap_sched_job_handle
+                    && avs_time_monotonic_equal(next_job_time,
+                                                anjay->coap_sched_job_time)) {
+                // already scheduled at the right time, avoid locking the main
+                // scheduler and reordering its job queue again
+                return;
+            }
             if ((!anjay->coap_sched_job_handle
                  || AVS_RESCHED_AT(&anjay->coap_sched_job_handle,
                                    next_job_time))
                     && AVS_SCHED_AT(anjay->sched, &anjay->coap_sched_job_handle,
                                     next_job_time, coap_sched_job, NULL, 0)) {
                 anjay_log(ERROR, _("Could not reschedule coap_sched_job"));
+            } else {
+                anjay->coap_sched_job_time = next_job_time;
             }
         } else {
             avs_sched_del(&anjay->coap_sched_job_handle);
@@ -317,7 +559,7 @@ static anjay_t *alloc_anjay(void) {
         return NULL;
     }
 #ifdef ANJAY_WITH_THREAD_SAFETY
-    if (avs_mutex_create(&out->mutex)) {
+    if (create_locks(out)) {
         anjay_log(ERROR, _("Could not create mutex"));
         avs_free(out);
         return NULL;
@@ -330,7 +572,7 @@ static anjay_t *alloc_anjay(void) {
     if (!(anjay->sched = avs_sched_new("Anjay", out))) {
         _anjay_log_oom();
 #ifdef ANJAY_WITH_THREAD_SAFETY
-        avs_mutex_cleanup(&out->mutex);
+        cleanup_locks(out);
 #endif // ANJAY_WITH_THREAD_SAFETY
         avs_free(out);
         return NULL;
@@ -356,10 +598,22 @@ static void anjay_cleanup_impl(anjay_unlocked_t *anjay, bool deregister) {
         _anjay_servers_deregister(anjay);
     }
 
+#ifdef ANJAY_WITH_SEND_PERSISTENCE
+    // Requests cancelled by closing the connections shall not be removed from
+    // the persistent log
+    _anjay_send_persistence_cleanup(&anjay->sender);
+#endif // ANJAY_WITH_SEND_PERSISTENCE
+
     // Make sure to deregister from all servers *before* cleaning up the
     // scheduler. That prevents us from updating a registration even though
     // we're about to deregister anyway.
     _anjay_servers_cleanup(anjay);
+#ifdef ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+    AVS_LIST_CLEAR(&anjay->dtls_sessions_restored);
+#endif // ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+#ifdef ANJAY_WITH_STATE_PERSISTENCE
+    _anjay_registrations_restored_cleanup(&anjay->registrations_restored);
+#endif // ANJAY_WITH_STATE_PERSISTENCE
 
     _anjay_bootstrap_cleanup(anjay);
 
@@ -372,6 +626,10 @@ static void anjay_cleanup_impl(anjay_unlocked_t *anjay, bool deregister) {
 #endif // ANJAY_WITH_ATTR_STORAGE
     _anjay_dm_cleanup(anjay);
     _anjay_notify_clear_queue(&anjay->scheduled_notify.queue);
+    AVS_LIST_CLEAR(&anjay->scheduled_notify.debounce_overrides);
+#ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+    _anjay_notify_change_queue_cleanup(anjay);
+#endif // ANJAY_WITH_LOCK_FREE_NOTIFY
 
 #ifdef ANJAY_WITH_SEND
     _anjay_send_cleanup(&anjay->sender);
@@ -379,13 +637,16 @@ static void anjay_cleanup_impl(anjay_unlocked_t *anjay, bool deregister) {
 
     avs_free(anjay->default_tls_ciphersuites.ids);
     avs_free(anjay->endpoint_name);
+    _anjay_dns_cache_cleanup(anjay);
 
 #ifdef WITH_AVS_COAP_UDP
     avs_coap_udp_response_cache_release(&anjay->udp_response_cache);
 #endif // WITH_AVS_COAP_UDP
 
     avs_sched_del(&anjay->reload_servers_sched_job_handle);
+    avs_sched_del(&anjay->rebind_sched_job_handle);
     avs_sched_del(&anjay->scheduled_notify.handle);
+    _anjay_growable_buffers_cleanup(&anjay->growable_buffers);
 
     ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
     avs_sched_cleanup(&anjay->sched);
@@ -400,9 +661,21 @@ static void anjay_cleanup_impl(anjay_unlocked_t *anjay, bool deregister) {
 
     avs_free(anjay->in_shared_buffer);
     avs_free(anjay->out_shared_buffer);
+    _anjay_buffer_pool_cleanup(&anjay->buffer_pool);
+    _anjay_arena_cleanup(&anjay->request_arena);
+#ifdef ANJAY_WITH_DEFERRED_LOGS
+    _anjay_deferred_log_cleanup(&anjay->deferred_log);
+#endif // ANJAY_WITH_DEFERRED_LOGS
+#ifdef ANJAY_WITH_OPERATION_STATS
+    _anjay_operation_stats_cleanup(anjay);
+#endif // ANJAY_WITH_OPERATION_STATS
+#ifdef ANJAY_WITH_TRAFFIC_STATS
+    _anjay_traffic_stats_cleanup(anjay);
+#endif // ANJAY_WITH_TRAFFIC_STATS
     _anjay_security_config_cache_cleanup(&anjay->security_config_from_dm_cache);
 
 #ifdef ANJAY_WITH_LWM2M11
+    _anjay_client_cert_chains_cleanup(anjay);
     _anjay_trust_store_cleanup(&anjay->initial_trust_store);
 #endif // ANJAY_WITH_LWM2M11
 }
@@ -423,7 +696,7 @@ anjay_t *anjay_new(const anjay_configuration_t *config) {
 
     if (result) {
 #ifdef ANJAY_WITH_THREAD_SAFETY
-        avs_mutex_cleanup(&out->mutex);
+        cleanup_locks(out);
         anjay_unlocked_t *anjay_unlocked =
                 (anjay_unlocked_t *) &out->anjay_unlocked_placeholder;
         avs_sched_t **sched_ptr = &anjay_unlocked->sched;
@@ -439,7 +712,7 @@ anjay_t *anjay_new(const anjay_configuration_t *config) {
 
 void anjay_delete(anjay_t *anjay) {
 #ifdef ANJAY_WITH_THREAD_SAFETY
-    int lock_result = avs_mutex_lock(anjay->mutex);
+    int lock_result = _anjay_lock_exclusive(anjay);
     if (lock_result) {
         anjay_log(WARNING, _("Could not lock mutex"));
     }
@@ -448,7 +721,7 @@ void anjay_delete(anjay_t *anjay) {
     if (!lock_result) {
         avs_mutex_unlock(anjay->mutex);
     }
-    avs_mutex_cleanup(&anjay->mutex);
+    cleanup_locks(anjay);
 #else  // ANJAY_WITH_THREAD_SAFETY
     anjay_cleanup_impl(anjay, true);
 #endif // ANJAY_WITH_THREAD_SAFETY
@@ -758,8 +1031,13 @@ static int parse_bs_uri(const avs_coap_request_header_t *hdr, bool *out_is_bs) {
     return result;
 }
 
+/**
+ * If @p out_prefix is not NULL, it is a buffer of ANJAY_MAX_URI_SEGMENT_SIZE
+ * bytes that the first segment is stored in if it is not numeric.
+ */
 static int parse_dm_uri(const avs_coap_request_header_t *hdr,
-                        anjay_uri_path_t *out_uri) {
+                        anjay_uri_path_t *out_uri,
+                        char *out_prefix) {
     char uri[ANJAY_MAX_URI_SEGMENT_SIZE] = "";
     size_t uri_size;
 
@@ -781,6 +1059,11 @@ static int parse_dm_uri(const avs_coap_request_header_t *hdr,
         } else if (expect_no_more_options || uri[0] == '\0') {
             anjay_log(WARNING, _("superfluous empty Uri-Path segment"));
             return -1;
+        } else if (out_prefix && !out_prefix[0] && segment_index == 0
+                   && (uri[0] < '0' || uri[0] > '9')) {
+            // LwM2M Gateway End Device prefix; the next segment is the OID
+            strcpy(out_prefix, uri);
+            continue;
         } else if (segment_index >= AVS_ARRAY_SIZE(out_uri->ids)) {
             // 4 or more segments...
             anjay_log(WARNING, _("prefixed Uri-Path are not supported"));
@@ -796,17 +1079,20 @@ static int parse_dm_uri(const avs_coap_request_header_t *hdr,
 }
 
 static int parse_request_uri(const avs_coap_request_header_t *hdr,
-                             bool *out_is_bs,
-                             anjay_uri_path_t *out_uri) {
-    int result = parse_bs_uri(hdr, out_is_bs);
+                             anjay_request_t *out_request) {
+    int result = parse_bs_uri(hdr, &out_request->is_bs_uri);
     if (result) {
         return result;
     }
-    if (*out_is_bs) {
-        *out_uri = MAKE_ROOT_PATH();
+    if (out_request->is_bs_uri) {
+        out_request->uri = MAKE_ROOT_PATH();
         return 0;
     } else {
-        return parse_dm_uri(hdr, out_uri);
+#ifdef ANJAY_WITH_MODULE_LWM2M_GATEWAY
+        return parse_dm_uri(hdr, &out_request->uri, out_request->prefix);
+#else  // ANJAY_WITH_MODULE_LWM2M_GATEWAY
+        return parse_dm_uri(hdr, &out_request->uri, NULL);
+#endif // ANJAY_WITH_MODULE_LWM2M_GATEWAY
     }
 }
 
@@ -815,7 +1101,7 @@ static int parse_request(const avs_coap_request_header_t *hdr,
                          const avs_coap_observe_id_t *observe_id) {
     memset(out_request, 0, sizeof(*out_request));
     out_request->request_code = hdr->code;
-    if (parse_request_uri(hdr, &out_request->is_bs_uri, &out_request->uri)
+    if (parse_request_uri(hdr, out_request)
             || parse_queries(hdr, &out_request->attributes)
             || avs_coap_options_get_content_format(&hdr->options,
                                                    &out_request->content_format)
@@ -834,6 +1120,9 @@ static int parse_request(const avs_coap_request_header_t *hdr,
 }
 
 uint8_t _anjay_make_error_response_code(int handler_result) {
+    if (handler_result == ANJAY_ERR_BUSY) {
+        return AVS_COAP_CODE_SERVICE_UNAVAILABLE;
+    }
     uint8_t handler_code = (uint8_t) (-handler_result);
     int cls = avs_coap_code_get_class(handler_code);
     if (cls == 4 || cls == 5) {
@@ -872,6 +1161,12 @@ static int handle_request(anjay_connection_ref_t connection,
     int result = -1;
 
     if (_anjay_server_ssid(connection.server) == ANJAY_SSID_BOOTSTRAP) {
+#ifdef ANJAY_WITH_MODULE_LWM2M_GATEWAY
+        if (request->prefix[0]) {
+            anjay_log(DEBUG, _("prefixed Uri-Path in Bootstrap Interface"));
+            return ANJAY_ERR_NOT_FOUND;
+        }
+#endif // ANJAY_WITH_MODULE_LWM2M_GATEWAY
         result = _anjay_bootstrap_perform_action(connection, request);
     } else {
         result = _anjay_dm_perform_action(connection, request);
@@ -880,9 +1175,35 @@ static int handle_request(anjay_connection_ref_t connection,
     return result;
 }
 
+#if defined(ANJAY_WITH_OPERATION_STATS) || defined(ANJAY_WITH_TRAFFIC_STATS)
+static anjay_operation_kind_t
+action_to_operation_kind(anjay_request_action_t action) {
+    switch (action) {
+    case ANJAY_ACTION_READ:
+#    ifdef ANJAY_WITH_LWM2M11
+    case ANJAY_ACTION_READ_COMPOSITE:
+#    endif // ANJAY_WITH_LWM2M11
+    case ANJAY_ACTION_DISCOVER:
+        return ANJAY_OPERATION_READ;
+    case ANJAY_ACTION_EXECUTE:
+        return ANJAY_OPERATION_EXECUTE;
+    default:
+        return ANJAY_OPERATION_WRITE;
+    }
+}
+#endif // defined(ANJAY_WITH_OPERATION_STATS) ||
+       // defined(ANJAY_WITH_TRAFFIC_STATS)
+
 typedef struct {
     anjay_connection_ref_t connection;
     int serve_result;
+#ifdef ANJAY_WITH_OPERATION_STATS
+    // set if the request shall be counted in operation statistics
+    bool operation_handled;
+    anjay_operation_kind_t operation_kind;
+    avs_time_duration_t operation_handler_time;
+    bool operation_failed;
+#endif // ANJAY_WITH_OPERATION_STATS
 } handle_incoming_message_args_t;
 
 static int
@@ -893,12 +1214,16 @@ handle_incoming_message(avs_coap_streaming_request_ctx_t *ctx,
                         void *args_) {
     handle_incoming_message_args_t *args =
             (handle_incoming_message_args_t *) args_;
+    _anjay_connection_queue_mode_request_received(args->connection);
+    _anjay_connection_udp_nat_request_received(args->connection);
 
     if (_anjay_server_ssid(args->connection.server) == ANJAY_SSID_BOOTSTRAP) {
         anjay_log(DEBUG, _("bootstrap server"));
     } else {
-        anjay_log(DEBUG, _("server ID = ") "%u",
-                  _anjay_server_ssid(args->connection.server));
+        anjay_deferred_log(_anjay_from_server(args->connection.server), DEBUG,
+                           SERVER_REQUEST,
+                           (uint32_t) _anjay_server_ssid(
+                                   args->connection.server));
     }
 
     anjay_request_t request;
@@ -910,15 +1235,51 @@ handle_incoming_message(avs_coap_streaming_request_ctx_t *ctx,
     request.ctx = ctx;
     request.payload_stream = payload_stream;
     request.observe = observe_id;
-
+    ANJAY_TRAFFIC_STATS_SET_INCOMING(
+            _anjay_from_server(args->connection.server),
+            action_to_operation_kind(request.action),
+            request.content_format != AVS_COAP_FORMAT_NONE
+                    ? request.content_format
+                    : request.requested_format,
+            request.uri.ids[ANJAY_ID_OID]);
+    ANJAY_TRACEPOINT(request_parsed,
+                     _anjay_server_ssid(args->connection.server),
+                     (int) request.action, request.uri.ids[ANJAY_ID_OID],
+                     request.uri.ids[ANJAY_ID_IID],
+                     request.uri.ids[ANJAY_ID_RID]);
+
+    // data model operations are not a part of the CoAP layer
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_OTHER);
+#ifdef ANJAY_WITH_OPERATION_STATS
+    const avs_time_monotonic_t handler_start_time = avs_time_monotonic_now();
+#endif // ANJAY_WITH_OPERATION_STATS
     int result = handle_request(args->connection, &request);
+    ANJAY_TRACEPOINT(request_handled,
+                     _anjay_server_ssid(args->connection.server),
+                     (int) request.action, result);
+#ifdef ANJAY_WITH_OPERATION_STATS
+    if (request.action != ANJAY_ACTION_BOOTSTRAP_FINISH) {
+        args->operation_handled = true;
+        args->operation_kind = action_to_operation_kind(request.action);
+        args->operation_handler_time =
+                avs_time_monotonic_diff(avs_time_monotonic_now(),
+                                        handler_start_time);
+        args->operation_failed = (result != 0);
+    }
+#endif // ANJAY_WITH_OPERATION_STATS
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
     if (result) {
         const uint8_t error_code = _anjay_make_error_response_code(result);
-        if (error_code != -result) {
+        if (error_code != -result && result != ANJAY_ERR_BUSY) {
             anjay_log(WARNING, _("invalid error code: ") "%d", result);
         }
 
-        if (avs_coap_code_is_client_error(error_code)) {
+        if (result == ANJAY_ERR_BUSY) {
+            // the server may retry the request once the value is available
+            anjay_log(DEBUG, _("resource busy: ") "%s",
+                      AVS_COAP_CODE_STRING(request_header->code));
+            args->serve_result = 0;
+        } else if (avs_coap_code_is_client_error(error_code)) {
             // the request was invalid; that's not really an error on our side,
             anjay_log(TRACE, _("invalid request: ") "%s",
                       AVS_COAP_CODE_STRING(request_header->code));
@@ -1001,8 +1362,34 @@ static int serve_connection(anjay_connection_ref_t connection) {
         .connection = connection,
         .serve_result = 0
     };
+#ifdef ANJAY_WITH_OPERATION_STATS
+    const avs_time_monotonic_t start_time = avs_time_monotonic_now();
+#endif // ANJAY_WITH_OPERATION_STATS
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_COAP);
+    ANJAY_ALLOCATION_SITE_ENTER(prev_site);
+    ANJAY_TRAFFIC_STATS_INCOMING_BEGIN(
+            _anjay_from_server(connection.server), traffic_snapshot,
+            _anjay_connection_get_online_socket(connection));
     avs_error_t err = avs_coap_streaming_handle_incoming_packet(
             coap, handle_incoming_message, &args);
+    ANJAY_TRAFFIC_STATS_INCOMING_END(
+            _anjay_from_server(connection.server), traffic_snapshot,
+            _anjay_connection_get_online_socket(connection));
+    ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+#ifdef ANJAY_WITH_OPERATION_STATS
+    if (args.operation_handled) {
+        // total time includes sending the response, which happens after
+        // handle_incoming_message() returns
+        _anjay_operation_stats_record(
+                _anjay_from_server(connection.server),
+                _anjay_server_ssid(connection.server), args.operation_kind,
+                args.operation_handler_time,
+                avs_time_monotonic_diff(avs_time_monotonic_now(), start_time),
+                args.operation_failed || avs_is_err(err));
+    }
+#endif // ANJAY_WITH_OPERATION_STATS
+    _anjay_growable_buffers_update(_anjay_from_server(connection.server));
     _anjay_connection_schedule_queue_mode_close(connection);
 
     avs_coap_error_recovery_action_t recovery_action =
@@ -1029,10 +1416,12 @@ static int serve_connection(anjay_connection_ref_t connection) {
 
 int _anjay_serve_unlocked(anjay_unlocked_t *anjay,
                           avs_net_socket_t *ready_socket) {
+    ANJAY_TRACEPOINT(packet_received, ready_socket);
     _anjay_security_config_cache_cleanup(&anjay->security_config_from_dm_cache);
 
 #ifdef ANJAY_WITH_DOWNLOADER
     if (!_anjay_downloader_handle_packet(&anjay->downloader, ready_socket)) {
+        _anjay_growable_buffers_update(anjay);
         return 0;
     }
 #endif // ANJAY_WITH_DOWNLOADER
@@ -1044,12 +1433,17 @@ int _anjay_serve_unlocked(anjay_unlocked_t *anjay,
     if (!connection.server) {
         return -1;
     }
-    return serve_connection(connection);
+    int result = serve_connection(connection);
+    _anjay_observe_clear_samples(anjay);
+    return result;
 }
 
 int anjay_serve(anjay_t *anjay_locked, avs_net_socket_t *ready_socket) {
     int result = -1;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+#ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+    _anjay_notify_change_queue_drain(anjay);
+#endif // ANJAY_WITH_LOCK_FREE_NOTIFY
     result = _anjay_serve_unlocked(anjay, ready_socket);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return result;
@@ -1074,6 +1468,13 @@ avs_sched_t *anjay_get_scheduler(anjay_t *anjay) {
 
 int anjay_sched_time_to_next(anjay_t *anjay, avs_time_duration_t *out_delay) {
     *out_delay = AVS_TIME_DURATION_INVALID;
+#ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+    if (anjay && _anjay_notify_change_queue_pending(anjay)) {
+        // anjay_sched_run() needs to be called to drain the queue
+        *out_delay = AVS_TIME_DURATION_ZERO;
+        return 0;
+    }
+#endif // ANJAY_WITH_LOCK_FREE_NOTIFY
     avs_sched_t *sched = anjay_get_scheduler(anjay);
     if (sched) {
         *out_delay = avs_sched_time_to_next(sched);
@@ -1105,6 +1506,14 @@ int anjay_sched_calculate_wait_time_ms(anjay_t *anjay, int limit_ms) {
 }
 
 void anjay_sched_run(anjay_t *anjay) {
+#ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+    if (anjay && _anjay_notify_change_queue_pending(anjay)) {
+        anjay_t *anjay_locked = anjay;
+        ANJAY_MUTEX_LOCK(anjay_unlocked, anjay_locked);
+        _anjay_notify_change_queue_drain(anjay_unlocked);
+        ANJAY_MUTEX_UNLOCK(anjay_locked);
+    }
+#endif // ANJAY_WITH_LOCK_FREE_NOTIFY
     avs_sched_t *sched = anjay_get_scheduler(anjay);
     if (sched) {
         avs_sched_run(sched);
@@ -1189,6 +1598,44 @@ anjay_download_set_next_block_offset(anjay_t *anjay_locked,
 #endif // ANJAY_WITH_DOWNLOADER
 }
 
+avs_error_t anjay_download_get_stats(anjay_t *anjay_locked,
+                                     anjay_download_handle_t dl_handle,
+                                     anjay_download_stats_t *out_stats) {
+#ifdef ANJAY_WITH_DOWNLOADER
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    err = _anjay_downloader_get_stats(&anjay->downloader, dl_handle,
+                                      out_stats);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+#else  // ANJAY_WITH_DOWNLOADER
+    (void) anjay_locked;
+    (void) dl_handle;
+    (void) out_stats;
+    anjay_log(ERROR, _("Download support disabled"));
+    return avs_errno(AVS_ENOTSUP);
+#endif // ANJAY_WITH_DOWNLOADER
+}
+
+avs_error_t anjay_download_set_rate_limit(anjay_t *anjay_locked,
+                                          anjay_download_handle_t dl_handle,
+                                          size_t max_bytes_per_second) {
+#ifdef ANJAY_WITH_DOWNLOADER
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    err = _anjay_downloader_set_rate_limit(&anjay->downloader, dl_handle,
+                                           max_bytes_per_second);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+#else  // ANJAY_WITH_DOWNLOADER
+    (void) anjay_locked;
+    (void) dl_handle;
+    (void) max_bytes_per_second;
+    anjay_log(ERROR, _("Download support disabled"));
+    return avs_errno(AVS_ENOTSUP);
+#endif // ANJAY_WITH_DOWNLOADER
+}
+
 #ifdef ANJAY_WITH_DOWNLOADER
 void _anjay_download_abort_unlocked(anjay_unlocked_t *anjay,
                                     anjay_download_handle_t handle) {
@@ -1205,6 +1652,13 @@ int _anjay_download_reconnect_unlocked(anjay_unlocked_t *anjay,
     return _anjay_downloader_sched_reconnect_by_handle(&anjay->downloader,
                                                        handle);
 }
+
+avs_error_t _anjay_download_get_stats_unlocked(
+        anjay_unlocked_t *anjay,
+        anjay_download_handle_t handle,
+        anjay_download_stats_t *out_stats) {
+    return _anjay_downloader_get_stats(&anjay->downloader, handle, out_stats);
+}
 #endif // ANJAY_WITH_DOWNLOADER
 
 void anjay_download_abort(anjay_t *anjay_locked,
@@ -1397,6 +1851,21 @@ avs_error_t anjay_update_dtls_handshake_timeouts(
     return err;
 }
 
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+avs_error_t
+anjay_get_startup_timestamps(anjay_t *anjay_locked,
+                             anjay_startup_timestamps_t *out_timestamps) {
+    assert(anjay_locked);
+    assert(out_timestamps);
+    avs_error_t err = avs_errno(AVS_EBUSY);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    *out_timestamps = anjay->startup_timestamps;
+    err = AVS_OK;
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+
 #ifdef ANJAY_TEST
 #    include "tests/core/anjay.c"
 #endif // ANJAY_TEST
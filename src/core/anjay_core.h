@@ -22,10 +22,16 @@
 #include "anjay_dm_core.h"
 #include "observe/anjay_observe_core.h"
 
+#include "anjay_arena.h"
+#include "anjay_buffer_pool.h"
 #include "anjay_bootstrap_core.h"
+#include "anjay_cert_chain.h"
+#include "anjay_deferred_log.h"
+#include "anjay_dns_cache.h"
 #include "anjay_downloader.h"
 #include "anjay_servers_private.h"
 #include "anjay_stats.h"
+#include "anjay_tracepoints.h"
 #include "anjay_utils_private.h"
 
 #ifdef ANJAY_WITH_ATTR_STORAGE
@@ -37,14 +43,34 @@
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
+typedef struct {
+    anjay_uri_path_t path;
+    avs_time_duration_t window;
+} anjay_notify_debounce_override_t;
+
 typedef struct {
     anjay_notify_queue_t queue;
     avs_sched_handle_t handle;
+    /**
+     * Maximum delay between reporting a change and flushing the queue, see
+     * anjay_configuration_t::notify_debounce_window.
+     */
+    avs_time_duration_t debounce_window;
+    /** Values set with anjay_set_notify_debounce(). */
+    AVS_LIST(anjay_notify_debounce_override_t) debounce_overrides;
 } anjay_scheduled_notify_t;
 
 typedef struct {
     unsigned depth;
-    AVS_LIST(const anjay_dm_installed_object_t *) objs_in_transaction;
+    /**
+     * Objects that joined the current transaction, in the order of joining.
+     * Each of them also has the <c>in_transaction</c> flag set in its entry of
+     * the Object index, so that checking membership does not require searching
+     * this array.
+     */
+    const anjay_dm_installed_object_t **objs_in_transaction;
+    size_t objs_in_transaction_count;
+    size_t objs_in_transaction_capacity;
 } anjay_transaction_state_t;
 
 typedef struct {
@@ -76,6 +102,7 @@ struct
     anjay_queue_mode_preference_t queue_mode_preference;
     anjay_trust_store_t initial_trust_store;
     bool rebuild_client_cert_chain;
+    AVS_LIST(anjay_client_cert_chain_t) client_cert_chains;
 #endif // ANJAY_WITH_LWM2M11
     avs_net_ssl_version_t dtls_version;
     avs_net_socket_configuration_t socket_config;
@@ -83,6 +110,8 @@ struct
 #ifdef ANJAY_WITH_THREAD_SAFETY
     avs_sched_t *coap_sched;
     avs_sched_handle_t coap_sched_job_handle;
+    avs_time_monotonic_t coap_sched_job_time;
+    avs_time_duration_t coap_sched_slack;
 #endif // ANJAY_WITH_THREAD_SAFETY
     anjay_dm_t dm;
     anjay_security_config_cache_t security_config_from_dm_cache;
@@ -102,7 +131,65 @@ struct
      */
     AVS_LIST(const anjay_socket_entry_t) cached_public_sockets;
 
+    /**
+     * Incremented whenever the set of sockets returned by
+     * _anjay_collect_socket_entries() may have changed, see
+     * _anjay_socket_set_changed().
+     */
+    size_t socket_set_version;
+
+    /**
+     * Incremented whenever anjay->servers may have changed, see
+     * _anjay_servers_changed().
+     */
+    size_t servers_version;
+
+    anjay_servers_index_t servers_index;
+
+    /**
+     * Incremented whenever the Security object may have changed, invalidating
+     * the security configuration cached in server connections.
+     */
+    size_t security_generation;
+
+#ifdef ANJAY_WITH_THREAD_SAFETY
+    /**
+     * True while at least one ANJAY_MUTEX_LOCK_SHARED() section is running.
+     * Only ever changed by the first thread entering and the last one leaving
+     * the shared sections, so it can safely be read from within any locked
+     * section. Lazily updated caches (e.g. servers_index) shall not be
+     * modified while it is set.
+     */
+    bool shared_lock_held;
+#endif // ANJAY_WITH_THREAD_SAFETY
+
+#ifdef ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+    /**
+     * DTLS sessions read by anjay_dtls_sessions_restore() that have not been
+     * used to recreate any connection yet.
+     */
+    AVS_LIST(anjay_dtls_session_restored_t) dtls_sessions_restored;
+#endif // ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+
+#ifdef ANJAY_WITH_STATE_PERSISTENCE
+    /**
+     * Registration state read by anjay_state_restore() that has not been
+     * applied to any server entry yet.
+     */
+    AVS_LIST(anjay_registration_restored_t) registrations_restored;
+#endif // ANJAY_WITH_STATE_PERSISTENCE
+
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+    anjay_startup_timestamps_t startup_timestamps;
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+
     avs_sched_handle_t reload_servers_sched_job_handle;
+    avs_sched_handle_t rebind_sched_job_handle;
+    /**
+     * Transports passed to anjay_transport_schedule_rebind() since the last
+     * run of rebind_sched_job.
+     */
+    anjay_transport_set_t rebind_transports;
 #ifdef ANJAY_WITH_OBSERVE
     anjay_observe_state_t observe;
 #endif
@@ -121,6 +208,9 @@ struct
 #    if defined(ANJAY_WITH_LWM2M11) || defined(ANJAY_WITH_COAP_DOWNLOAD)
     size_t coap_tcp_max_options_size;
     avs_time_duration_t coap_tcp_request_timeout;
+    size_t coap_tcp_write_coalescing_buffer_size;
+    size_t coap_tcp_receive_budget;
+    avs_time_duration_t coap_tcp_keepalive_interval;
     avs_time_duration_t tcp_exchange_timeout;
 #    endif // defined(ANJAY_WITH_LWM2M11) || defined(ANJAY_WITH_COAP_DOWNLOAD)
 #endif     // WITH_AVS_COAP_TCP
@@ -141,17 +231,60 @@ struct
 
     avs_shared_buffer_t *in_shared_buffer;
     avs_shared_buffer_t *out_shared_buffer;
+    anjay_buffer_pool_t buffer_pool;
+    anjay_growable_buffers_t growable_buffers;
+    anjay_arena_t request_arena;
+#ifdef ANJAY_WITH_DEFERRED_LOGS
+    anjay_deferred_log_t deferred_log;
+#endif // ANJAY_WITH_DEFERRED_LOGS
 
 #ifdef ANJAY_WITH_DOWNLOADER
     anjay_downloader_t downloader;
 #endif // ANJAY_WITH_DOWNLOADER
     bool prefer_hierarchical_formats;
+    bool prefer_compact_formats;
     bool update_immediately_on_dm_change;
     bool enable_self_notify;
     bool connection_error_is_registration_failure;
+    bool cache_registration_payload;
+    bool udp_path_mtu_discovery;
+    bool udp_nat_keepalive;
+    const avs_coap_udp_compression_t *udp_compression;
+    void *udp_compression_arg;
+    avs_time_duration_t queue_mode_wake_window;
+    bool queue_mode_adaptive_close;
+    bool randomize_communication_retries;
+    avs_time_duration_t reconnect_jitter;
+    avs_time_duration_t dns_cache_lifetime;
+    AVS_LIST(anjay_dns_cache_entry_t) dns_cache;
+#ifdef ANJAY_WITH_THREAD_SAFETY
+    anjay_parallel_executor_t *transaction_validate_executor;
+    void *transaction_validate_executor_arg;
+#endif // ANJAY_WITH_THREAD_SAFETY
+#ifdef WITH_AVS_COAP_Q_BLOCK
+    size_t udp_q_block1_max_payloads;
+    bool udp_q_block2;
+#endif // WITH_AVS_COAP_Q_BLOCK
 #ifdef ANJAY_WITH_NET_STATS
     closed_connections_stats_t closed_connections_stats;
 #endif // ANJAY_WITH_NET_STATS
+#ifdef ANJAY_WITH_SCHED_STATS
+    anjay_sched_job_stats_t sched_job_stats[ANJAY_SCHED_JOB_KIND_LIMIT_];
+#endif // ANJAY_WITH_SCHED_STATS
+#ifdef ANJAY_WITH_OPERATION_STATS
+    // sorted by SSID
+    AVS_LIST(anjay_server_operation_stats_t) operation_stats;
+#endif // ANJAY_WITH_OPERATION_STATS
+#ifdef ANJAY_WITH_TRAFFIC_STATS
+    anjay_traffic_stats_t operation_traffic_stats[ANJAY_OPERATION_KIND_LIMIT_];
+    // sorted by Content-Format
+    AVS_LIST(anjay_keyed_traffic_stats_t) content_format_traffic_stats;
+    // sorted by OID
+    AVS_LIST(anjay_keyed_traffic_stats_t) object_traffic_stats;
+    // context of the exchange currently handled in serve_connection()
+    bool incoming_traffic_context_set;
+    anjay_traffic_context_t incoming_traffic_context;
+#endif // ANJAY_WITH_TRAFFIC_STATS
     bool use_connection_id;
     avs_ssl_additional_configuration_clb_t *additional_tls_config_clb;
 
@@ -189,6 +322,19 @@ static inline avs_sched_t *_anjay_get_coap_sched(anjay_unlocked_t *anjay) {
 #endif // ANJAY_WITH_THREAD_SAFETY
 }
 
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+/**
+ * Sets @p timestamp to the current time, unless it is already set - only the
+ * first occurrence of each per-server startup phase is recorded.
+ */
+static inline void
+_anjay_startup_timestamp_mark_first(avs_time_monotonic_t *timestamp) {
+    if (!avs_time_monotonic_valid(*timestamp)) {
+        *timestamp = avs_time_monotonic_now();
+    }
+}
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+
 #if defined(ANJAY_WITH_ATTR_STORAGE)
 
 // clang-format off
@@ -0,0 +1,138 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_DEFERRED_LOGS
+
+#    include <assert.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_time.h>
+
+#    include <anjay/deferred_log.h>
+
+#    include "anjay_core.h"
+#    include "anjay_deferred_log.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+/* format ID (2 bytes), level (1 byte), argc (1 byte), timestamp (4 bytes) */
+#    define RECORD_HEADER_SIZE 8
+
+#    define RECORD_MAX_ARGS UINT8_MAX
+
+int _anjay_deferred_log_init(anjay_deferred_log_t *dlog, size_t capacity) {
+    memset(dlog, 0, sizeof(*dlog));
+    if (!(dlog->buffer = (uint8_t *) avs_malloc(capacity))) {
+        _anjay_log_oom();
+        return -1;
+    }
+    dlog->capacity = capacity;
+    return 0;
+}
+
+void _anjay_deferred_log_cleanup(anjay_deferred_log_t *dlog) {
+    avs_free(dlog->buffer);
+    memset(dlog, 0, sizeof(*dlog));
+}
+
+static uint8_t byte_at(const anjay_deferred_log_t *dlog, size_t offset) {
+    return dlog->buffer[(dlog->head + offset) % dlog->capacity];
+}
+
+static size_t oldest_record_size(const anjay_deferred_log_t *dlog) {
+    assert(dlog->size >= RECORD_HEADER_SIZE);
+    return RECORD_HEADER_SIZE + 4 * (size_t) byte_at(dlog, 3);
+}
+
+static void put_bytes(anjay_deferred_log_t *dlog,
+                      const uint8_t *data,
+                      size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        dlog->buffer[(dlog->head + dlog->size + i) % dlog->capacity] = data[i];
+    }
+    dlog->size += size;
+}
+
+static void put_u32(anjay_deferred_log_t *dlog, uint32_t value) {
+    const uint8_t bytes[] = { (uint8_t) value, (uint8_t) (value >> 8),
+                              (uint8_t) (value >> 16),
+                              (uint8_t) (value >> 24) };
+    put_bytes(dlog, bytes, sizeof(bytes));
+}
+
+void _anjay_deferred_log_write(anjay_deferred_log_t *dlog,
+                               uint8_t level,
+                               uint16_t id,
+                               size_t argc,
+                               const uint32_t *argv) {
+#    ifndef ANJAY_WITH_TRACE_LOGS
+    if (level == (uint8_t) AVS_LOG_TRACE) {
+        return;
+    }
+#    endif // ANJAY_WITH_TRACE_LOGS
+    assert(argc <= RECORD_MAX_ARGS);
+    const size_t record_size = RECORD_HEADER_SIZE + 4 * argc;
+    if (record_size > dlog->capacity) {
+        return;
+    }
+    while (dlog->capacity - dlog->size < record_size) {
+        const size_t dropped = oldest_record_size(dlog);
+        dlog->head = (dlog->head + dropped) % dlog->capacity;
+        dlog->size -= dropped;
+    }
+    int64_t timestamp_ms;
+    avs_time_monotonic_to_scalar(&timestamp_ms, AVS_TIME_MS,
+                                 avs_time_monotonic_now());
+    const uint8_t header[] = { (uint8_t) id, (uint8_t) (id >> 8), level,
+                               (uint8_t) argc };
+    put_bytes(dlog, header, sizeof(header));
+    put_u32(dlog, (uint32_t) timestamp_ms);
+    for (size_t i = 0; i < argc; ++i) {
+        put_u32(dlog, argv[i]);
+    }
+}
+
+size_t _anjay_deferred_log_read(anjay_deferred_log_t *dlog,
+                                void *out_buf,
+                                size_t buf_size) {
+    uint8_t *out = (uint8_t *) out_buf;
+    size_t copied = 0;
+    while (dlog->size) {
+        const size_t record_size = oldest_record_size(dlog);
+        if (buf_size - copied < record_size) {
+            break;
+        }
+        for (size_t i = 0; i < record_size; ++i) {
+            out[copied + i] = byte_at(dlog, i);
+        }
+        copied += record_size;
+        dlog->head = (dlog->head + record_size) % dlog->capacity;
+        dlog->size -= record_size;
+    }
+    return copied;
+}
+
+size_t anjay_deferred_log_read(anjay_t *anjay_locked,
+                               void *out_buf,
+                               size_t buf_size) {
+    size_t result = 0;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    result = _anjay_deferred_log_read(&anjay->deferred_log, out_buf, buf_size);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/core/deferred_log.c"
+#    endif // ANJAY_TEST
+
+#endif // ANJAY_WITH_DEFERRED_LOGS
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_DEFERRED_LOG_H
+#define ANJAY_DEFERRED_LOG_H
+
+#include <anjay_init.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "anjay_utils_private.h"
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Messages that may be stored by @ref anjay_deferred_log .
+ *
+ * Each message is defined by a pair of macros: ANJAY_DEFERRED_LOG_ID_<name>,
+ * the identifier stored in the ring buffer, and ANJAY_DEFERRED_LOG_FMT_<name>,
+ * the format string. tools/anjay_deferred_log_decode.py reads these
+ * definitions from this file, so each of them shall fit in a single line, the
+ * format string shall be a single string literal and identifiers shall never
+ * be reused.
+ *
+ * All arguments are stored as uint32_t, so only integer conversions without
+ * length modifiers (%d, %u, %x) are allowed.
+ */
+// clang-format off
+#define ANJAY_DEFERRED_LOG_ID_SERVER_REQUEST 1
+#define ANJAY_DEFERRED_LOG_FMT_SERVER_REQUEST "server ID = %u"
+
+#define ANJAY_DEFERRED_LOG_ID_OBSERVE_SCHED_FLUSH 2
+#define ANJAY_DEFERRED_LOG_FMT_OBSERVE_SCHED_FLUSH "scheduling notifications flush for server SSID %u, connection type %d"
+
+#define ANJAY_DEFERRED_LOG_ID_OBSERVE_CANCEL_FLUSH 3
+#define ANJAY_DEFERRED_LOG_FMT_OBSERVE_CANCEL_FLUSH "Cancelling notifications flush task for server SSID %u, connection type %d"
+
+#define ANJAY_DEFERRED_LOG_ID_OBSERVE_CANCEL_NOTIFY 4
+#define ANJAY_DEFERRED_LOG_FMT_OBSERVE_CANCEL_NOTIFY "Cancelling notification attempt for server SSID %u, connection type %d"
+// clang-format on
+
+#ifdef ANJAY_WITH_DEFERRED_LOGS
+
+#    define ANJAY_DEFERRED_LOG_DEFAULT_SIZE 1024
+
+/**
+ * Ring buffer of binary log records, see <c>anjay/deferred_log.h</c> for the
+ * record layout. When full, the oldest records are dropped to make space for
+ * new ones.
+ */
+typedef struct {
+    uint8_t *buffer;
+    size_t capacity;
+    size_t head;
+    size_t size;
+} anjay_deferred_log_t;
+
+int _anjay_deferred_log_init(anjay_deferred_log_t *dlog, size_t capacity);
+
+void _anjay_deferred_log_cleanup(anjay_deferred_log_t *dlog);
+
+void _anjay_deferred_log_write(anjay_deferred_log_t *dlog,
+                               uint8_t level,
+                               uint16_t id,
+                               size_t argc,
+                               const uint32_t *argv);
+
+size_t _anjay_deferred_log_read(anjay_deferred_log_t *dlog,
+                                void *out_buf,
+                                size_t buf_size);
+
+/**
+ * Stores a log message in the deferred log of @p Anjay (anjay_unlocked_t *),
+ * without formatting it. @p Id is the name of one of the messages defined
+ * above. All variadic arguments are converted to uint32_t.
+ *
+ * If ANJAY_WITH_DEFERRED_LOGS is disabled, the message is logged normally.
+ */
+#    define anjay_deferred_log(Anjay, Level, Id, ...)                      \
+        _anjay_deferred_log_write(                                         \
+                &(Anjay)->deferred_log, (uint8_t) AVS_LOG_##Level,         \
+                ANJAY_DEFERRED_LOG_ID_##Id,                                \
+                sizeof((const uint32_t[]) { __VA_ARGS__ })                 \
+                        / sizeof(uint32_t),                                \
+                (const uint32_t[]) { __VA_ARGS__ })
+
+#else // ANJAY_WITH_DEFERRED_LOGS
+
+#    define anjay_deferred_log(Anjay, Level, Id, ...)                      \
+        do {                                                               \
+            (void) (Anjay);                                                \
+            anjay_log(Level, _(ANJAY_DEFERRED_LOG_FMT_##Id), __VA_ARGS__); \
+        } while (0)
+
+#endif // ANJAY_WITH_DEFERRED_LOGS
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_DEFERRED_LOG_H */
@@ -16,6 +16,7 @@
 #include <string.h>
 
 #include <anjay/core.h>
+#include <avsystem/commons/avs_memory.h>
 #include <avsystem/commons/avs_stream.h>
 #include <avsystem/commons/avs_stream_membuf.h>
 #include <avsystem/commons/avs_stream_v_table.h>
@@ -105,6 +106,48 @@ static int validate_version(const anjay_dm_installed_object_t *obj) {
     return 0;
 }
 
+static int update_objects_index(anjay_unlocked_t *anjay) {
+    anjay_dm_t *dm = &anjay->dm;
+    size_t count = AVS_LIST_SIZE(dm->objects);
+    if (count > dm->objects_index_capacity) {
+        anjay_dm_object_index_entry_t *new_index =
+                (anjay_dm_object_index_entry_t *) avs_realloc(
+                        dm->objects_index, count * sizeof(*new_index));
+        if (!new_index) {
+            _anjay_log_oom();
+            return -1;
+        }
+        dm->objects_index = new_index;
+        dm->objects_index_capacity = count;
+    }
+
+    size_t i = 0;
+    AVS_LIST(anjay_dm_installed_object_t) obj;
+    AVS_LIST_FOREACH(obj, dm->objects) {
+        assert(i < count);
+        dm->objects_index[i].oid = _anjay_dm_installed_object_oid(obj);
+        dm->objects_index[i].obj = obj;
+        dm->objects_index[i].in_transaction = false;
+        ++i;
+    }
+    dm->objects_index_size = count;
+
+    const anjay_transaction_state_t *transaction = &anjay->transaction_state;
+    for (i = 0; i < transaction->objs_in_transaction_count; ++i) {
+        anjay_dm_object_index_entry_t *entry =
+                _anjay_dm_find_object_index_entry(
+                        anjay, _anjay_dm_installed_object_oid(
+                                       transaction->objs_in_transaction[i]));
+        // entry may be missing for an Object that is being unregistered, or
+        // belong to a different Object with the same OID, if the transaction
+        // involves an End Device data model
+        if (entry && entry->obj == transaction->objs_in_transaction[i]) {
+            entry->in_transaction = true;
+        }
+    }
+    return 0;
+}
+
 int _anjay_register_object_unlocked(
         anjay_unlocked_t *anjay,
         AVS_LIST(anjay_dm_installed_object_t) *elem_ptr_move) {
@@ -137,9 +180,17 @@ int _anjay_register_object_unlocked(
     }
 
     AVS_LIST_INSERT(obj_iter, *elem_ptr_move);
+    if (update_objects_index(anjay)) {
+        // *elem_ptr_move still points to the inserted element
+        AVS_LIST_DETACH(obj_iter);
+        return -1;
+    }
 
     dm_log(INFO, _("successfully registered object ") "/%u",
            _anjay_dm_installed_object_oid(*elem_ptr_move));
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+    anjay->startup_timestamps.last_object_installed = avs_time_monotonic_now();
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
     if (_anjay_notify_instances_changed_unlocked(
                 anjay, _anjay_dm_installed_object_oid(*elem_ptr_move))) {
         dm_log(WARNING, _("anjay_notify_instances_changed() failed on ") "/%u",
@@ -203,6 +254,28 @@ static void remove_oid_from_notify_queue(anjay_notify_queue_t *out_queue,
     }
 }
 
+void _anjay_dm_transaction_remove_object(
+        anjay_unlocked_t *anjay, const anjay_dm_installed_object_t *obj) {
+    anjay_transaction_state_t *transaction = &anjay->transaction_state;
+    for (size_t i = 0; i < transaction->objs_in_transaction_count; ++i) {
+        if (transaction->objs_in_transaction[i] == obj) {
+            assert(transaction->depth);
+            if (_anjay_dm_call_transaction_rollback(anjay, obj)) {
+                dm_log(ERROR,
+                       _("cannot rollback transaction on ") "/%u" _(
+                               ", object may be left in undefined state"),
+                       _anjay_dm_installed_object_oid(obj));
+            }
+            --transaction->objs_in_transaction_count;
+            memmove(&transaction->objs_in_transaction[i],
+                    &transaction->objs_in_transaction[i + 1],
+                    (transaction->objs_in_transaction_count - i)
+                            * sizeof(*transaction->objs_in_transaction));
+            return;
+        }
+    }
+}
+
 static int
 unregister_object_unlocked(anjay_unlocked_t *anjay,
                            AVS_LIST(anjay_dm_installed_object_t) *def_ptr) {
@@ -210,25 +283,15 @@ unregister_object_unlocked(anjay_unlocked_t *anjay,
     assert(AVS_LIST_FIND_PTR(&anjay->dm.objects, *def_ptr));
 
     AVS_LIST(anjay_dm_installed_object_t) detached = AVS_LIST_DETACH(def_ptr);
-
-    AVS_LIST(const anjay_dm_installed_object_t *) *obj_in_transaction_iter;
-    AVS_LIST_FOREACH_PTR(obj_in_transaction_iter,
-                         &anjay->transaction_state.objs_in_transaction) {
-        if (**obj_in_transaction_iter >= detached) {
-            if (**obj_in_transaction_iter == detached) {
-                assert(anjay->transaction_state.depth);
-                if (_anjay_dm_call_transaction_rollback(
-                            anjay, **obj_in_transaction_iter)) {
-                    dm_log(ERROR,
-                           _("cannot rollback transaction on ") "/%u" _(
-                                   ", object may be left in undefined state"),
-                           _anjay_dm_installed_object_oid(detached));
-                }
-                AVS_LIST_DELETE(obj_in_transaction_iter);
-            }
-            break;
-        }
-    }
+    // the index never grows here, so updating it cannot fail
+    int index_result = update_objects_index(anjay);
+    assert(!index_result);
+    (void) index_result;
+    _anjay_dm_cache_remove(anjay, _anjay_dm_installed_object_oid(detached));
+    (void) _anjay_observe_set_notify_driven(
+            anjay, _anjay_dm_installed_object_oid(detached), false);
+    _anjay_dm_cache_invalidate_object_links(anjay);
+    _anjay_dm_transaction_remove_object(anjay, detached);
 
     anjay_notify_queue_t notify = NULL;
     if (_anjay_notify_queue_instance_set_unknown_change(
@@ -302,21 +365,44 @@ void _anjay_dm_cleanup(anjay_unlocked_t *anjay) {
         anjay->dm.modules->deleter(anjay->dm.modules->arg);
     }
 
+    _anjay_dm_cache_cleanup(anjay);
     AVS_LIST_CLEAR(&anjay->dm.objects);
+    avs_free(anjay->dm.objects_index);
+    anjay->dm.objects_index = NULL;
+    anjay->dm.objects_index_size = 0;
+    anjay->dm.objects_index_capacity = 0;
+
+    assert(!anjay->transaction_state.objs_in_transaction_count);
+    avs_free(anjay->transaction_state.objs_in_transaction);
+    anjay->transaction_state.objs_in_transaction = NULL;
+    anjay->transaction_state.objs_in_transaction_capacity = 0;
 }
 
-const anjay_dm_installed_object_t *
-_anjay_dm_find_object_by_oid(anjay_unlocked_t *anjay, anjay_oid_t oid) {
-    AVS_LIST(anjay_dm_installed_object_t) obj;
-    AVS_LIST_FOREACH(obj, anjay->dm.objects) {
-        if (_anjay_dm_installed_object_oid(obj) == oid) {
-            return obj;
+anjay_dm_object_index_entry_t *
+_anjay_dm_find_object_index_entry(anjay_unlocked_t *anjay, anjay_oid_t oid) {
+    anjay_dm_object_index_entry_t *index = anjay->dm.objects_index;
+    size_t lower = 0;
+    size_t upper = anjay->dm.objects_index_size;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (index[middle].oid < oid) {
+            lower = middle + 1;
+        } else if (index[middle].oid > oid) {
+            upper = middle;
+        } else {
+            return &index[middle];
         }
     }
-
     return NULL;
 }
 
+const anjay_dm_installed_object_t *
+_anjay_dm_find_object_by_oid(anjay_unlocked_t *anjay, anjay_oid_t oid) {
+    const anjay_dm_object_index_entry_t *entry =
+            _anjay_dm_find_object_index_entry(anjay, oid);
+    return entry ? entry->obj : NULL;
+}
+
 uint8_t _anjay_dm_make_success_response_code(anjay_request_action_t action) {
     switch (action) {
     case ANJAY_ACTION_READ:
@@ -546,8 +632,8 @@ static int dm_execute(anjay_unlocked_t *anjay,
             _anjay_dm_verify_instance_present(anjay, obj,
                                               request->uri.ids[ANJAY_ID_IID]);
     if (!retval) {
-        if (!_anjay_instance_action_allowed(
-                    anjay, &REQUEST_TO_ACTION_INFO(request, ssid))) {
+        if (!_anjay_object_instance_action_allowed(
+                    anjay, obj, &REQUEST_TO_ACTION_INFO(request, ssid))) {
             return ANJAY_ERR_UNAUTHORIZED;
         }
         anjay_dm_resource_kind_t kind;
@@ -570,8 +656,8 @@ static int dm_execute(anjay_unlocked_t *anjay,
 #ifdef ANJAY_WITH_CONN_STATUS_API
         /* RID == 4 -> Disable resource */
         if (!retval && request->uri.ids[ANJAY_ID_OID] == ANJAY_DM_OID_SERVER
-                && request->uri.ids[ANJAY_ID_RID]
-                               == ANJAY_DM_RID_SERVER_DISABLE) {
+                && request->uri.ids[ANJAY_ID_RID] == ANJAY_DM_RID_SERVER_DISABLE
+                && _anjay_dm_is_root_object(anjay, obj)) {
             _anjay_set_server_suspending_flag(anjay, ssid, true);
         }
 #endif // ANJAY_WITH_CONN_STATUS_API
@@ -699,10 +785,67 @@ static int invoke_action(anjay_connection_ref_t connection,
     }
 }
 
+#ifdef ANJAY_WITH_MODULE_LWM2M_GATEWAY
+static int find_end_device_object(anjay_connection_ref_t connection,
+                                  const anjay_request_t *request,
+                                  const anjay_dm_installed_object_t **out_obj) {
+    switch (request->action) {
+    case ANJAY_ACTION_READ:
+        if (request->observe) {
+            dm_log(DEBUG,
+                   _("Observe is not supported on End Device Objects"));
+            return ANJAY_ERR_METHOD_NOT_ALLOWED;
+        }
+        break;
+    case ANJAY_ACTION_WRITE:
+    case ANJAY_ACTION_WRITE_UPDATE:
+    case ANJAY_ACTION_EXECUTE:
+        break;
+    default:
+        dm_log(DEBUG, _("unsupported operation on End Device Objects"));
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+    if (!_anjay_uri_path_has(&request->uri, ANJAY_ID_OID)) {
+        dm_log(DEBUG, _("at least Object ID must follow Uri-Path prefix"));
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+
+    anjay_unlocked_t *anjay = _anjay_from_server(connection.server);
+    anjay_iid_t gateway_iid = ANJAY_ID_INVALID;
+    if (!anjay->dm.prefix_resolver
+            || !(*out_obj = anjay->dm.prefix_resolver(
+                         anjay, anjay->dm.prefix_resolver_arg, request->prefix,
+                         request->uri.ids[ANJAY_ID_OID], &gateway_iid))) {
+        dm_log(DEBUG, _("Object not found: /") "%s" _("/") "%u",
+               request->prefix, request->uri.ids[ANJAY_ID_OID]);
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    // End Device data models have no Access Control of their own
+    const anjay_action_info_t info = {
+        .oid = ANJAY_DM_OID_LWM2M_GATEWAY,
+        .iid = gateway_iid,
+        .ssid = _anjay_server_ssid(connection.server),
+        .action = request->action
+    };
+    if (!_anjay_instance_action_allowed(anjay, &info)) {
+        return ANJAY_ERR_UNAUTHORIZED;
+    }
+    return 0;
+}
+#endif // ANJAY_WITH_MODULE_LWM2M_GATEWAY
+
 int _anjay_dm_perform_action(anjay_connection_ref_t connection,
                              const anjay_request_t *request) {
     const anjay_dm_installed_object_t *obj = NULL;
-    if (_anjay_uri_path_has(&request->uri, ANJAY_ID_OID)) {
+#ifdef ANJAY_WITH_MODULE_LWM2M_GATEWAY
+    if (request->prefix[0]) {
+        int result = find_end_device_object(connection, request, &obj);
+        if (result) {
+            return result;
+        }
+    } else
+#endif // ANJAY_WITH_MODULE_LWM2M_GATEWAY
+            if (_anjay_uri_path_has(&request->uri, ANJAY_ID_OID)) {
         if (!(obj = _anjay_dm_find_object_by_oid(
                       _anjay_from_server(connection.server),
                       request->uri.ids[ANJAY_ID_OID]))) {
@@ -756,8 +899,13 @@ int _anjay_dm_perform_action(anjay_connection_ref_t connection,
         return result;
     }
 
+    anjay_arena_t *arena =
+            &_anjay_from_server(connection.server)->request_arena;
+    const size_t arena_mark = _anjay_arena_mark(arena);
+
     result = invoke_action(connection, obj, request, in_ctx);
 
+    _anjay_arena_release(arena, arena_mark);
     int destroy_result = _anjay_input_ctx_destroy(&in_ctx);
     return result ? result : destroy_result;
 }
@@ -828,15 +976,11 @@ static void foreach_instance_emit(anjay_unlocked_dm_list_ctx_t *ctx_,
     }
 }
 
-int _anjay_dm_foreach_instance(anjay_unlocked_t *anjay,
-                               const anjay_dm_installed_object_t *obj,
-                               anjay_dm_foreach_instance_handler_t *handler,
-                               void *data) {
-    if (!obj) {
-        dm_log(ERROR, _("attempt to iterate through NULL Object"));
-        return -1;
-    }
-
+static int
+foreach_instance_uncached(anjay_unlocked_t *anjay,
+                          const anjay_dm_installed_object_t *obj,
+                          anjay_dm_foreach_instance_handler_t *handler,
+                          void *data) {
     static const anjay_dm_list_ctx_vtable_t VTABLE = {
         .emit = foreach_instance_emit
     };
@@ -861,6 +1005,119 @@ int _anjay_dm_foreach_instance(anjay_unlocked_t *anjay,
     return ctx.result == ANJAY_FOREACH_BREAK ? 0 : ctx.result;
 }
 
+typedef struct {
+    anjay_iid_t *iids;
+    size_t count;
+    size_t capacity;
+} instance_array_builder_t;
+
+static int append_instance_clb(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t *obj,
+                               anjay_iid_t iid,
+                               void *builder_) {
+    (void) anjay;
+    (void) obj;
+    instance_array_builder_t *builder = (instance_array_builder_t *) builder_;
+    if (builder->count == builder->capacity) {
+        size_t new_capacity = builder->capacity ? 2 * builder->capacity : 8;
+        anjay_iid_t *new_iids = (anjay_iid_t *) avs_realloc(
+                builder->iids, new_capacity * sizeof(*new_iids));
+        if (!new_iids) {
+            _anjay_log_oom();
+            return -1;
+        }
+        builder->iids = new_iids;
+        builder->capacity = new_capacity;
+    }
+    builder->iids[builder->count++] = iid;
+    return 0;
+}
+
+static int
+foreach_instance_in_array(anjay_unlocked_t *anjay,
+                          const anjay_dm_installed_object_t *obj,
+                          const anjay_iid_t *iids,
+                          size_t count,
+                          anjay_dm_foreach_instance_handler_t *handler,
+                          void *data) {
+    for (size_t i = 0; i < count; ++i) {
+        int result = handler(anjay, obj, iids[i], data);
+        if (result == ANJAY_FOREACH_BREAK) {
+            dm_log(TRACE, _("foreach_instance: break on ") "/%u/%u",
+                   _anjay_dm_installed_object_oid(obj), iids[i]);
+            return 0;
+        } else if (result) {
+            dm_log(DEBUG,
+                   _("foreach_instance_handler failed for ") "/%u/%u" _(
+                           " (") "%d" _(")"),
+                   _anjay_dm_installed_object_oid(obj), iids[i], result);
+            return result;
+        }
+    }
+    return 0;
+}
+
+static int
+foreach_instance_cached(anjay_unlocked_t *anjay,
+                        const anjay_dm_installed_object_t *obj,
+                        anjay_dm_object_cache_t *cache,
+                        anjay_dm_foreach_instance_handler_t *handler,
+                        void *data) {
+    if (!_anjay_dm_object_cache_valid(cache)) {
+        if (cache->iteration_depth) {
+            // the cached array is in use further up the call stack, so it
+            // cannot be replaced right now
+            return foreach_instance_uncached(anjay, obj, handler, data);
+        }
+        anjay_oid_t oid = cache->oid;
+        uint32_t generation = cache->generation;
+        instance_array_builder_t builder = { NULL, 0, 0 };
+        int result = foreach_instance_uncached(anjay, obj, append_instance_clb,
+                                               &builder);
+        if (result) {
+            avs_free(builder.iids);
+            return result;
+        }
+        // the mutex might have been released while calling list_instances, so
+        // the cache entry needs to be looked up again
+        if (!(cache = _anjay_dm_cache_find(anjay, oid))
+                || cache->iteration_depth) {
+            result = foreach_instance_in_array(anjay, obj, builder.iids,
+                                               builder.count, handler, data);
+            avs_free(builder.iids);
+            return result;
+        }
+        _anjay_dm_cache_store_instances(cache, generation, builder.iids,
+                                        builder.count);
+    }
+    ++cache->iteration_depth;
+    int result = foreach_instance_in_array(anjay, obj, cache->instances,
+                                           cache->instance_count, handler,
+                                           data);
+    --cache->iteration_depth;
+    return result;
+}
+
+int _anjay_dm_foreach_instance(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t *obj,
+                               anjay_dm_foreach_instance_handler_t *handler,
+                               void *data) {
+    if (!obj) {
+        dm_log(ERROR, _("attempt to iterate through NULL Object"));
+        return -1;
+    }
+
+    anjay_dm_object_cache_t *cache =
+            _anjay_dm_is_root_object(anjay, obj)
+                    ? _anjay_dm_cache_find(anjay,
+                                           _anjay_dm_installed_object_oid(obj))
+                    : NULL;
+    if (cache) {
+        return foreach_instance_cached(anjay, obj, cache, handler, data);
+    }
+    return foreach_instance_uncached(anjay, obj, handler, data);
+}
+
 typedef struct {
     anjay_iid_t iid_to_find;
     bool found;
@@ -914,9 +1171,45 @@ static int instance_present_clb(anjay_unlocked_t *anjay,
     return ANJAY_FOREACH_CONTINUE;
 }
 
+static bool cached_instance_present(const anjay_dm_object_cache_t *cache,
+                                    anjay_iid_t iid) {
+    size_t lower = 0;
+    size_t upper = cache->instance_count;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (cache->instances[middle] < iid) {
+            lower = middle + 1;
+        } else if (cache->instances[middle] > iid) {
+            upper = middle;
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
 int _anjay_dm_instance_present(anjay_unlocked_t *anjay,
                                const anjay_dm_installed_object_t *obj_ptr,
                                anjay_iid_t iid) {
+    if (obj_ptr) {
+        const anjay_dm_object_cache_t *cache =
+                _anjay_dm_is_root_object(anjay, obj_ptr)
+                        ? _anjay_dm_cache_find(
+                                  anjay,
+                                  _anjay_dm_installed_object_oid(obj_ptr))
+                        : NULL;
+        if (cache && _anjay_dm_object_cache_valid(cache)) {
+            return cached_instance_present(cache, iid) ? 1 : 0;
+        }
+        if (_anjay_dm_handler_implemented(obj_ptr,
+                                          ANJAY_DM_HANDLER_instance_present)) {
+            int retval = _anjay_dm_call_instance_present(anjay, obj_ptr, iid);
+            if (retval < 0) {
+                return retval;
+            }
+            return retval > 0 ? 1 : 0;
+        }
+    }
     instance_present_args_t args = {
         .iid_to_find = iid,
         .found = false
@@ -1007,16 +1300,12 @@ void anjay_dm_emit_res(anjay_dm_resource_list_ctx_t *ctx,
 #endif // ANJAY_WITH_THREAD_SAFETY
 }
 
-int _anjay_dm_foreach_resource(anjay_unlocked_t *anjay,
-                               const anjay_dm_installed_object_t *obj,
-                               anjay_iid_t iid,
-                               anjay_dm_foreach_resource_handler_t *handler,
-                               void *data) {
-    if (!obj) {
-        dm_log(ERROR, _("attempt to iterate through NULL Object"));
-        return -1;
-    }
-
+static int
+foreach_resource_uncached(anjay_unlocked_t *anjay,
+                          const anjay_dm_installed_object_t *obj,
+                          anjay_iid_t iid,
+                          anjay_dm_foreach_resource_handler_t *handler,
+                          void *data) {
     anjay_unlocked_dm_resource_list_ctx_t ctx = {
         .anjay = anjay,
         .obj = obj,
@@ -1037,6 +1326,151 @@ int _anjay_dm_foreach_resource(anjay_unlocked_t *anjay,
     return ctx.result == ANJAY_FOREACH_BREAK ? 0 : ctx.result;
 }
 
+typedef struct {
+    anjay_dm_cached_resource_t *resources;
+    size_t count;
+    size_t capacity;
+} resource_array_builder_t;
+
+static int append_resource_clb(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t *obj,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               anjay_dm_resource_kind_t kind,
+                               anjay_dm_resource_presence_t presence,
+                               void *builder_) {
+    (void) anjay;
+    (void) obj;
+    (void) iid;
+    resource_array_builder_t *builder = (resource_array_builder_t *) builder_;
+    if (builder->count == builder->capacity) {
+        size_t new_capacity = builder->capacity ? 2 * builder->capacity : 16;
+        anjay_dm_cached_resource_t *new_resources =
+                (anjay_dm_cached_resource_t *) avs_realloc(
+                        builder->resources,
+                        new_capacity * sizeof(*new_resources));
+        if (!new_resources) {
+            _anjay_log_oom();
+            return -1;
+        }
+        builder->resources = new_resources;
+        builder->capacity = new_capacity;
+    }
+    anjay_dm_cached_resource_t *entry = &builder->resources[builder->count++];
+    entry->rid = rid;
+    entry->kind = kind;
+    entry->presence = presence;
+    return 0;
+}
+
+static int
+foreach_resource_in_array(anjay_unlocked_t *anjay,
+                          const anjay_dm_installed_object_t *obj,
+                          anjay_iid_t iid,
+                          const anjay_dm_cached_resource_t *resources,
+                          size_t count,
+                          anjay_dm_foreach_resource_handler_t *handler,
+                          void *data) {
+    for (size_t i = 0; i < count; ++i) {
+        int result = handler(anjay, obj, iid, resources[i].rid,
+                             resources[i].kind, resources[i].presence, data);
+        if (result == ANJAY_FOREACH_BREAK) {
+            dm_log(TRACE, _("foreach_resource: break on ") "/%u/%u/%u",
+                   _anjay_dm_installed_object_oid(obj), iid, resources[i].rid);
+            return 0;
+        } else if (result) {
+            dm_log(DEBUG,
+                   _("foreach_resource_handler failed for ") "/%u/%u/%u" _(
+                           " (") "%d" _(")"),
+                   _anjay_dm_installed_object_oid(obj), iid, resources[i].rid,
+                   result);
+            return result;
+        }
+    }
+    return 0;
+}
+
+static int
+foreach_resource_cached(anjay_unlocked_t *anjay,
+                        const anjay_dm_installed_object_t *obj,
+                        anjay_iid_t iid,
+                        anjay_dm_resource_cache_t *cache,
+                        anjay_dm_foreach_resource_handler_t *handler,
+                        void *data) {
+    if (!_anjay_dm_resource_cache_valid(cache, iid)) {
+        if (cache->iteration_depth) {
+            // the cached array is in use further up the call stack, so it
+            // cannot be replaced right now
+            return foreach_resource_uncached(anjay, obj, iid, handler, data);
+        }
+        anjay_oid_t oid = cache->oid;
+        uint32_t generation = cache->generation;
+        resource_array_builder_t builder = { NULL, 0, 0 };
+        int result = foreach_resource_uncached(anjay, obj, iid,
+                                               append_resource_clb, &builder);
+        if (result) {
+            avs_free(builder.resources);
+            return result;
+        }
+        // the mutex might have been released while calling list_resources, so
+        // the cache entry needs to be looked up again
+        if (!(cache = _anjay_dm_resource_cache_find(anjay, oid))
+                || cache->iteration_depth) {
+            result = foreach_resource_in_array(anjay, obj, iid,
+                                               builder.resources, builder.count,
+                                               handler, data);
+            avs_free(builder.resources);
+            return result;
+        }
+        _anjay_dm_cache_store_resources(cache, generation, iid,
+                                        builder.resources, builder.count);
+    }
+    ++cache->iteration_depth;
+    int result = foreach_resource_in_array(anjay, obj, iid, cache->resources,
+                                           cache->resource_count, handler,
+                                           data);
+    --cache->iteration_depth;
+    return result;
+}
+
+int _anjay_dm_foreach_resource(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t *obj,
+                               anjay_iid_t iid,
+                               anjay_dm_foreach_resource_handler_t *handler,
+                               void *data) {
+    if (!obj) {
+        dm_log(ERROR, _("attempt to iterate through NULL Object"));
+        return -1;
+    }
+
+    anjay_dm_resource_cache_t *cache =
+            _anjay_dm_is_root_object(anjay, obj)
+                    ? _anjay_dm_resource_cache_find(
+                              anjay, _anjay_dm_installed_object_oid(obj))
+                    : NULL;
+    if (cache) {
+        return foreach_resource_cached(anjay, obj, iid, cache, handler, data);
+    }
+    return foreach_resource_uncached(anjay, obj, iid, handler, data);
+}
+
+static const anjay_dm_cached_resource_t *
+find_cached_resource(const anjay_dm_resource_cache_t *cache, anjay_rid_t rid) {
+    size_t lower = 0;
+    size_t upper = cache->resource_count;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (cache->resources[middle].rid < rid) {
+            lower = middle + 1;
+        } else if (cache->resources[middle].rid > rid) {
+            upper = middle;
+        } else {
+            return &cache->resources[middle];
+        }
+    }
+    return NULL;
+}
+
 typedef struct {
     anjay_rid_t rid_to_find;
     anjay_dm_resource_kind_t kind;
@@ -1071,6 +1505,28 @@ int _anjay_dm_resource_kind_and_presence(
         anjay_rid_t rid,
         anjay_dm_resource_kind_t *out_kind,
         anjay_dm_resource_presence_t *out_presence) {
+    if (obj_ptr) {
+        const anjay_dm_resource_cache_t *cache =
+                _anjay_dm_is_root_object(anjay, obj_ptr)
+                        ? _anjay_dm_resource_cache_find(
+                                  anjay,
+                                  _anjay_dm_installed_object_oid(obj_ptr))
+                        : NULL;
+        if (cache && _anjay_dm_resource_cache_valid(cache, iid)) {
+            const anjay_dm_cached_resource_t *entry =
+                    find_cached_resource(cache, rid);
+            if (!entry) {
+                return ANJAY_ERR_NOT_FOUND;
+            }
+            if (out_kind) {
+                *out_kind = entry->kind;
+            }
+            if (out_presence) {
+                *out_presence = entry->presence;
+            }
+            return 0;
+        }
+    }
     resource_present_args_t args = {
         .rid_to_find = rid,
         .kind = (anjay_dm_resource_kind_t) -1,
@@ -1094,10 +1550,11 @@ int _anjay_dm_resource_kind_and_presence(
     return 0;
 }
 
-int _anjay_dm_path_info(anjay_unlocked_t *anjay,
-                        const anjay_dm_installed_object_t *obj,
-                        const anjay_uri_path_t *path,
-                        anjay_dm_path_info_t *out_info) {
+static int path_info_impl(anjay_unlocked_t *anjay,
+                          const anjay_dm_installed_object_t *obj,
+                          const anjay_uri_path_t *path,
+                          bool verify_instance,
+                          anjay_dm_path_info_t *out_info) {
     memset(out_info, 0, sizeof(*out_info));
     out_info->uri = *path;
     out_info->is_present = true;
@@ -1112,7 +1569,7 @@ int _anjay_dm_path_info(anjay_unlocked_t *anjay,
     }
 
     int result = 0;
-    if (_anjay_uri_path_has(path, ANJAY_ID_IID)) {
+    if (verify_instance && _anjay_uri_path_has(path, ANJAY_ID_IID)) {
         result = _anjay_dm_verify_instance_present(anjay, obj,
                                                    path->ids[ANJAY_ID_IID]);
     }
@@ -1151,6 +1608,22 @@ int _anjay_dm_path_info(anjay_unlocked_t *anjay,
     }
 }
 
+int _anjay_dm_path_info(anjay_unlocked_t *anjay,
+                        const anjay_dm_installed_object_t *obj,
+                        const anjay_uri_path_t *path,
+                        anjay_dm_path_info_t *out_info) {
+    return path_info_impl(anjay, obj, path, true, out_info);
+}
+
+int _anjay_dm_path_info_in_present_instance(
+        anjay_unlocked_t *anjay,
+        const anjay_dm_installed_object_t *obj,
+        const anjay_uri_path_t *path,
+        anjay_dm_path_info_t *out_info) {
+    assert(obj);
+    return path_info_impl(anjay, obj, path, false, out_info);
+}
+
 typedef struct {
     const anjay_dm_list_ctx_vtable_t *vtable;
     anjay_unlocked_t *anjay;
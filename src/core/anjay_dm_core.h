@@ -22,6 +22,7 @@
 
 #include "coap/anjay_msg_details.h"
 #include "dm/anjay_dm_attributes.h"
+#include "dm/anjay_dm_cache.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
@@ -30,13 +31,87 @@ typedef struct {
     void *arg;
 } anjay_dm_installed_module_t;
 
+typedef struct {
+    anjay_oid_t oid;
+    const anjay_dm_installed_object_t *obj;
+    /**
+     * Set if the Object is included in the currently running transaction, i.e.
+     * present in <c>anjay->transaction_state.objs_in_transaction</c>.
+     */
+    bool in_transaction;
+} anjay_dm_object_index_entry_t;
+
 struct anjay_dm {
     AVS_LIST(anjay_dm_installed_object_t) objects;
     AVS_LIST(anjay_dm_installed_module_t) modules;
+
+    /**
+     * Array of (OID, object) pairs mirroring the contents of @ref objects, in
+     * the same (ascending by OID) order. It allows
+     * @ref _anjay_dm_find_object_by_oid to perform a binary search instead of
+     * walking the list. Kept in sync by object registration and
+     * unregistration routines.
+     */
+    anjay_dm_object_index_entry_t *objects_index;
+    size_t objects_index_size;
+    size_t objects_index_capacity;
+
+    /**
+     * Per-Object caches of data model structure, sorted by OID. Only Objects
+     * for which caching has been explicitly enabled have entries here.
+     */
+    AVS_LIST(anjay_dm_object_cache_t) caches;
+    AVS_LIST(anjay_dm_resource_cache_t) resource_caches;
+    AVS_LIST(anjay_dm_discover_cache_t) discover_caches;
+    AVS_LIST(anjay_dm_read_cache_t) read_caches;
+#if defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+    /**
+     * Resource value caches, sorted by OID and RID.
+     */
+    AVS_LIST(anjay_dm_value_cache_t) value_caches;
+#endif // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+
+    anjay_dm_object_links_cache_t object_links;
+#ifdef ANJAY_WITH_ACCESS_CONTROL
+    anjay_dm_acl_cache_t acl;
+#endif // ANJAY_WITH_ACCESS_CONTROL
+    anjay_dm_server_params_cache_t server_params;
+#ifdef ANJAY_WITH_MODULE_LWM2M_GATEWAY
+    /**
+     * Resolves Objects addressed by prefixed Uri-Paths, set by the
+     * lwm2m_gateway module. Requests with such paths are rejected if NULL.
+     */
+    anjay_dm_prefix_resolver_t *prefix_resolver;
+    void *prefix_resolver_arg;
+#endif // ANJAY_WITH_MODULE_LWM2M_GATEWAY
 };
 
 void _anjay_dm_cleanup(anjay_unlocked_t *anjay);
 
+anjay_dm_object_index_entry_t *
+_anjay_dm_find_object_index_entry(anjay_unlocked_t *anjay, anjay_oid_t oid);
+
+/**
+ * Checks whether @p obj is registered in the root data model, as opposed to
+ * being an Object of an LwM2M Gateway End Device. Per-OID caches, Access
+ * Control and notifications only apply to the former. NULL, denoting the root
+ * path, is also considered a part of the root data model.
+ */
+static inline bool
+_anjay_dm_is_root_object(anjay_unlocked_t *anjay,
+                         const anjay_dm_installed_object_t *obj) {
+#ifdef ANJAY_WITH_MODULE_LWM2M_GATEWAY
+    return !obj
+           || _anjay_dm_find_object_by_oid(anjay,
+                                           _anjay_dm_installed_object_oid(obj))
+                      == obj;
+#else  // ANJAY_WITH_MODULE_LWM2M_GATEWAY
+    (void) anjay;
+    (void) obj;
+    return true;
+#endif // ANJAY_WITH_MODULE_LWM2M_GATEWAY
+}
+
 typedef struct {
     bool has_min_period;
     bool has_max_period;
@@ -60,6 +135,14 @@ typedef struct {
     bool is_bs_uri;
 
     anjay_uri_path_t uri;
+#ifdef ANJAY_WITH_MODULE_LWM2M_GATEWAY
+    /**
+     * First Uri-Path segment if it is not numeric, i.e. the prefix of an
+     * LwM2M Gateway End Device data model; empty string otherwise. @ref uri
+     * holds the remaining segments.
+     */
+    char prefix[ANJAY_MAX_URI_SEGMENT_SIZE];
+#endif // ANJAY_WITH_MODULE_LWM2M_GATEWAY
 
     anjay_request_action_t action;
     uint16_t content_format;
@@ -126,6 +209,16 @@ int _anjay_dm_path_info(anjay_unlocked_t *anjay,
                         const anjay_uri_path_t *path,
                         anjay_dm_path_info_t *out_info);
 
+/**
+ * Works like @ref _anjay_dm_path_info, but skips checking the presence of the
+ * Object Instance, which shall already be verified by the caller.
+ */
+int _anjay_dm_path_info_in_present_instance(
+        anjay_unlocked_t *anjay,
+        const anjay_dm_installed_object_t *obj,
+        const anjay_uri_path_t *path,
+        anjay_dm_path_info_t *out_info);
+
 uint8_t _anjay_dm_make_success_response_code(anjay_request_action_t action);
 
 #define dm_log(...) _anjay_log(anjay_dm, __VA_ARGS__)
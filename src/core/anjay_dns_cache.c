@@ -0,0 +1,169 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <string.h>
+
+#include <avsystem/commons/avs_errno.h>
+
+#include <anjay/core.h>
+
+#include "anjay_core.h"
+#include "anjay_dns_cache.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+static bool is_ip_literal(const char *host) {
+    if (strchr(host, ':')) {
+        return true;
+    }
+    for (; *host; ++host) {
+        if (*host != '.' && (*host < '0' || *host > '9')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+const char *_anjay_dns_cache_server_name(const char *sni, const char *host) {
+    if (sni || !host || is_ip_literal(host)) {
+        return sni;
+    }
+    return host;
+}
+
+/**
+ * Returns a pointer to the entry for @p hostname , or to the list end if there
+ * is none. Expired entries encountered on the way are removed.
+ */
+static AVS_LIST(anjay_dns_cache_entry_t) *
+find_entry_ptr(anjay_unlocked_t *anjay, const char *hostname) {
+    const avs_time_monotonic_t now = avs_time_monotonic_now();
+    AVS_LIST(anjay_dns_cache_entry_t) *entry_ptr = &anjay->dns_cache;
+    while (*entry_ptr) {
+        if (!avs_time_monotonic_before(now, (*entry_ptr)->expires_at)) {
+            AVS_LIST_DELETE(entry_ptr);
+        } else if (!strcmp((*entry_ptr)->hostname, hostname)) {
+            break;
+        } else {
+            AVS_LIST_ADVANCE_PTR(&entry_ptr);
+        }
+    }
+    return entry_ptr;
+}
+
+static void forget(anjay_unlocked_t *anjay, const char *hostname) {
+    AVS_LIST(anjay_dns_cache_entry_t) *entry_ptr =
+            find_entry_ptr(anjay, hostname);
+    if (*entry_ptr) {
+        AVS_LIST_DELETE(entry_ptr);
+    }
+}
+
+static int put(anjay_unlocked_t *anjay,
+               const char *hostname,
+               const char *address,
+               avs_time_duration_t ttl) {
+    if (strlen(address) >= sizeof(((anjay_dns_cache_entry_t *) 0)->address)) {
+        anjay_log(ERROR, _("invalid address for ") "%s" _(": ") "%s",
+                  hostname, address);
+        return -1;
+    }
+    AVS_LIST(anjay_dns_cache_entry_t) *entry_ptr =
+            find_entry_ptr(anjay, hostname);
+    if (!*entry_ptr) {
+        AVS_LIST(anjay_dns_cache_entry_t) entry =
+                (AVS_LIST(anjay_dns_cache_entry_t)) AVS_LIST_NEW_BUFFER(
+                        sizeof(anjay_dns_cache_entry_t) + strlen(hostname) + 1);
+        if (!entry) {
+            _anjay_log_oom();
+            return -1;
+        }
+        strcpy(entry->hostname, hostname);
+        AVS_LIST_INSERT(entry_ptr, entry);
+    }
+    (*entry_ptr)->expires_at =
+            avs_time_monotonic_add(avs_time_monotonic_now(), ttl);
+    strcpy((*entry_ptr)->address, address);
+    return 0;
+}
+
+static void learn(anjay_unlocked_t *anjay,
+                  avs_net_socket_t *socket,
+                  const char *hostname) {
+    if (!avs_time_duration_less(AVS_TIME_DURATION_ZERO,
+                                anjay->dns_cache_lifetime)
+            || is_ip_literal(hostname)) {
+        return;
+    }
+    char address[sizeof(((anjay_dns_cache_entry_t *) 0)->address)];
+    if (avs_is_ok(avs_net_socket_get_remote_host(socket, address,
+                                                 sizeof(address)))) {
+        (void) put(anjay, hostname, address, anjay->dns_cache_lifetime);
+    }
+}
+
+avs_error_t _anjay_dns_cache_connect(anjay_unlocked_t *anjay,
+                                     avs_net_socket_t *socket,
+                                     const char *host,
+                                     const char *port) {
+    AVS_LIST(anjay_dns_cache_entry_t) entry = *find_entry_ptr(anjay, host);
+    if (entry) {
+        anjay_log(DEBUG, _("using cached address ") "%s" _(" for ") "%s",
+                  entry->address, host);
+        if (avs_is_ok(avs_net_socket_connect(socket, entry->address, port))) {
+            return AVS_OK;
+        }
+        anjay_log(DEBUG,
+                  _("could not connect to cached address ") "%s" _(
+                          ", resolving ") "%s" _(" again"),
+                  entry->address, host);
+        forget(anjay, host);
+        avs_net_socket_close(socket);
+    }
+    avs_error_t err = avs_net_socket_connect(socket, host, port);
+    if (avs_is_ok(err)) {
+        learn(anjay, socket, host);
+    }
+    return err;
+}
+
+void _anjay_dns_cache_cleanup(anjay_unlocked_t *anjay) {
+    AVS_LIST_CLEAR(&anjay->dns_cache);
+}
+
+avs_error_t anjay_dns_cache_put(anjay_t *anjay_locked,
+                                const char *hostname,
+                                const char *address,
+                                avs_time_duration_t ttl) {
+    if (!hostname) {
+        return avs_errno(AVS_EINVAL);
+    }
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    if (!address || !avs_time_duration_less(AVS_TIME_DURATION_ZERO, ttl)) {
+        forget(anjay, hostname);
+        err = AVS_OK;
+    } else if (!put(anjay, hostname, address, ttl)) {
+        err = AVS_OK;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+void anjay_dns_cache_flush(anjay_t *anjay_locked) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    _anjay_dns_cache_cleanup(anjay);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+#ifdef ANJAY_TEST
+#    include "tests/core/dns_cache.c"
+#endif // ANJAY_TEST
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_DNS_CACHE_H
+#define ANJAY_DNS_CACHE_H
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_net.h>
+#include <avsystem/commons/avs_time.h>
+
+#include <anjay_modules/anjay_utils_core.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Address a hostname has been resolved to, either by a successful connection
+ * or by the user through @ref anjay_dns_cache_put .
+ */
+typedef struct {
+    avs_time_monotonic_t expires_at;
+    char address[sizeof("ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255")];
+    char hostname[];
+} anjay_dns_cache_entry_t;
+
+/**
+ * Returns the hostname that shall be used for Server Name Indication and
+ * certificate verification of a secure connection to @p host . It is
+ * explicitly configured @p sni if any, or @p host itself unless it is an IP
+ * address literal, so that connecting to an address taken from the cache
+ * instead of the hostname does not affect TLS.
+ */
+const char *_anjay_dns_cache_server_name(const char *sni, const char *host);
+
+/**
+ * Connects @p socket to @p host : @p port . If a non-expired address for
+ * @p host is cached, it is used without performing a DNS lookup; if connecting
+ * to it fails, the entry is dropped and the connection is retried using the
+ * hostname. After a successful connection using the hostname, the remote
+ * address is cached for the time configured as <c>dns_cache_lifetime</c>.
+ */
+avs_error_t _anjay_dns_cache_connect(anjay_unlocked_t *anjay,
+                                     avs_net_socket_t *socket,
+                                     const char *host,
+                                     const char *port);
+
+void _anjay_dns_cache_cleanup(anjay_unlocked_t *anjay);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_DNS_CACHE_H */
@@ -21,9 +21,26 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 
 typedef struct anjay_download_ctx anjay_download_ctx_t;
 
+typedef struct anjay_http_tls_session anjay_http_tls_session_t;
+
+/**
+ * Maximum number of sockets of the downloader that are compared by
+ * @ref _anjay_downloader_sockets_changed . If there are more of them, they are
+ * assumed to change on every call.
+ */
+#define ANJAY_DOWNLOADER_TRACKED_SOCKETS 8
+
 typedef struct {
     uintptr_t next_id;
     AVS_LIST(anjay_download_ctx_t) downloads;
+#ifdef ANJAY_WITH_HTTP_DOWNLOAD
+    // TLS sessions of finished HTTPS downloads, oldest first
+    AVS_LIST(anjay_http_tls_session_t) http_tls_sessions;
+#endif // ANJAY_WITH_HTTP_DOWNLOAD
+    // online sockets found by the last call to
+    // _anjay_downloader_sockets_changed()
+    avs_net_socket_t *tracked_sockets[ANJAY_DOWNLOADER_TRACKED_SOCKETS];
+    size_t tracked_sockets_count;
 } anjay_downloader_t;
 
 /**
@@ -67,6 +84,14 @@ avs_error_t _anjay_downloader_download(anjay_downloader_t *dl,
                                        avs_coap_ctx_t *forced_coap_context,
                                        avs_net_socket_t *forced_coap_socket);
 
+avs_error_t _anjay_downloader_get_stats(anjay_downloader_t *dl,
+                                        anjay_download_handle_t handle,
+                                        anjay_download_stats_t *out_stats);
+
+avs_error_t _anjay_downloader_set_rate_limit(anjay_downloader_t *dl,
+                                             anjay_download_handle_t handle,
+                                             size_t max_bytes_per_second);
+
 /**
  * Retrieves all sockets used for downloads managed by @p dl and prepends them
  * to @p out_socks.
@@ -75,6 +100,16 @@ int _anjay_downloader_get_sockets(anjay_downloader_t *dl,
                                   AVS_LIST(anjay_socket_entry_t) *out_socks,
                                   bool include_offline);
 
+/**
+ * Checks whether the online sockets that would be returned by
+ * @ref _anjay_downloader_get_sockets have changed since the previous call.
+ *
+ * NOTE: Only the socket objects are compared. Code that reconnects a socket in
+ * place, changing its system descriptor, needs to call
+ * _anjay_socket_set_changed() explicitly.
+ */
+bool _anjay_downloader_sockets_changed(anjay_downloader_t *dl);
+
 /**
  * @returns @li 0 if @p socket was a downloaded socket and the incoming packet
  *              does not require further processing,
@@ -24,8 +24,26 @@
 #        endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
 #    endif     // AVS_COMMONS_POSIX_COMPAT_HEADER
 
+#    if defined(ANJAY_WITH_EVENT_LOOP_EPOLL)
+#        include <errno.h>
+#        include <poll.h>
+#        include <sys/epoll.h>
+#        include <unistd.h>
+#    elif defined(ANJAY_WITH_EVENT_LOOP_KQUEUE)
+#        include <sys/types.h>
+
+#        include <poll.h>
+#        include <sys/event.h>
+#        include <sys/time.h>
+#        include <unistd.h>
+#    endif
+
 #    include <anjay_init.h>
 
+#    include <string.h>
+
+#    include <anjay_modules/anjay_notify.h>
+
 #    include "anjay_core.h"
 
 VISIBILITY_SOURCE_BEGIN
@@ -38,10 +56,34 @@ typedef int sockfd_t;
 #        define INVALID_SOCKET (-1)
 #    endif
 
-static bool should_event_loop_still_run(anjay_t *anjay) {
+#    if defined(ANJAY_WITH_EVENT_LOOP_EPOLL) \
+            || defined(ANJAY_WITH_EVENT_LOOP_KQUEUE)
+#        define EVENT_LOOP_USE_KERNEL_QUEUE
+// The event queue only pays off if it is reused across iterations, so the
+// one-shot anjay_serve_any() and anjay_serve_any_batched() use poll() instead.
+#        define EVENT_LOOP_USE_POLL
+#    elif defined(AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL)
+#        define EVENT_LOOP_USE_POLL
+#    else
+#        define EVENT_LOOP_USE_SELECT
+#    endif
+
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+/**
+ * Maximum number of readiness events retrieved from the kernel in a single
+ * iteration. Sockets that remain ready are reported again in the next one.
+ */
+#        define EVENT_LOOP_MAX_EVENTS 16
+
+typedef struct {
+    sockfd_t fd;
+    avs_net_socket_t *socket;
+} event_loop_registration_t;
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
+
+static bool should_still_run(volatile atomic_int *event_loop_status) {
     int status = ANJAY_EVENT_LOOP_INTERRUPT;
-    if (atomic_compare_exchange_strong(&anjay->atomic_fields.event_loop_status,
-                                       &status,
+    if (atomic_compare_exchange_strong(event_loop_status, &status,
                                        ANJAY_EVENT_LOOP_IDLE)) {
         // interrupt has been just handled
         return false;
@@ -51,23 +93,132 @@ static bool should_event_loop_still_run(anjay_t *anjay) {
     }
 }
 
+static bool should_event_loop_still_run(anjay_t *anjay) {
+    return should_still_run(&anjay->atomic_fields.event_loop_status);
+}
+
 typedef struct {
     anjay_t *const anjay_locked;
     const avs_time_duration_t max_wait_time;
     const bool allow_interrupt;
-#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+    /**
+     * If set, the sockets are waited on using the event queue. Otherwise,
+     * poll() is used, which is cheaper for states that are not reused.
+     */
+    const bool use_queue;
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
+    /**
+     * Sockets collected in one of the previous iterations, with the entries
+     * that have no valid system descriptor already filtered out. Reused for as
+     * long as the version returned by _anjay_socket_set_version() does not
+     * change.
+     */
+    AVS_LIST(const anjay_socket_entry_t) entries;
+    size_t entries_version;
+    bool entries_valid;
+    /**
+     * Set while serving sockets in a batch with the Anjay mutex already
+     * locked, see anjay_serve_any_batched().
+     */
+    anjay_unlocked_t *batch_anjay;
+#    ifdef EVENT_LOOP_USE_POLL
+    /**
+     * Descriptors corresponding to the elements of entries, in the same order.
+     * The array is only reallocated if it needs to grow.
+     */
     struct pollfd *pollfds;
     size_t pollfds_size;
-#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    size_t pollfds_count;
+#    endif // EVENT_LOOP_USE_POLL
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+    /**
+     * epoll or kqueue descriptor, valid if queue_open is true. Descriptors of
+     * the sockets are registered in it persistently, and the registrations are
+     * only updated when the socket set changes.
+     */
+    int queue_fd;
+    bool queue_open;
+    /**
+     * Sockets currently registered in queue_fd. Index into this array is used
+     * as the user data of each registration.
+     */
+    event_loop_registration_t *registrations;
+    size_t registrations_count;
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
+#    ifdef EVENT_LOOP_USE_SELECT
+    /**
+     * Descriptors of the elements of entries. Copied before each call to
+     * select(), as it modifies the sets passed to it.
+     */
+    fd_set fds;
+    sockfd_t nfds;
+#    endif // EVENT_LOOP_USE_SELECT
 } event_loop_state_t;
 
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+static int queue_create(void) {
+#        ifdef ANJAY_WITH_EVENT_LOOP_EPOLL
+    return epoll_create1(EPOLL_CLOEXEC);
+#        else  // ANJAY_WITH_EVENT_LOOP_EPOLL
+    return kqueue();
+#        endif // ANJAY_WITH_EVENT_LOOP_EPOLL
+}
+
+static int queue_register(int queue_fd, sockfd_t fd, size_t index) {
+#        ifdef ANJAY_WITH_EVENT_LOOP_EPOLL
+    struct epoll_event event = {
+        .events = EPOLLIN,
+        .data.u64 = (uint64_t) index
+    };
+    if (!epoll_ctl(queue_fd, EPOLL_CTL_ADD, fd, &event)) {
+        return 0;
+    }
+    // the descriptor might have been registered in a previous iteration,
+    // possibly under a different index
+    return errno == EEXIST ? epoll_ctl(queue_fd, EPOLL_CTL_MOD, fd, &event)
+                           : -1;
+#        else  // ANJAY_WITH_EVENT_LOOP_EPOLL
+    // EV_ADD modifies the existing registration, if any
+    struct kevent change;
+    EV_SET(&change, fd, EVFILT_READ, EV_ADD, 0, 0,
+           (void *) (uintptr_t) index);
+    return kevent(queue_fd, &change, 1, NULL, 0, NULL);
+#        endif // ANJAY_WITH_EVENT_LOOP_EPOLL
+}
+
+static void queue_unregister(int queue_fd, sockfd_t fd) {
+    // Errors are ignored - closing a descriptor removes its registration
+    // anyway, so it might not be there anymore.
+#        ifdef ANJAY_WITH_EVENT_LOOP_EPOLL
+    struct epoll_event event = { 0 };
+    (void) epoll_ctl(queue_fd, EPOLL_CTL_DEL, fd, &event);
+#        else  // ANJAY_WITH_EVENT_LOOP_EPOLL
+    struct kevent change;
+    EV_SET(&change, fd, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+    (void) kevent(queue_fd, &change, 1, NULL, 0, NULL);
+#        endif // ANJAY_WITH_EVENT_LOOP_EPOLL
+}
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
+
 static void event_loop_state_cleanup(event_loop_state_t *state) {
-    (void) state;
-#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    AVS_LIST_CLEAR(&state->entries);
+    state->entries_valid = false;
+#    ifdef EVENT_LOOP_USE_POLL
     avs_free(state->pollfds);
     state->pollfds = NULL;
     state->pollfds_size = 0;
-#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+    state->pollfds_count = 0;
+#    endif // EVENT_LOOP_USE_POLL
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+    if (state->queue_open) {
+        close(state->queue_fd);
+        state->queue_open = false;
+    }
+    avs_free(state->registrations);
+    state->registrations = NULL;
+    state->registrations_count = 0;
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
 }
 
 typedef enum {
@@ -76,90 +227,252 @@ typedef enum {
     HANDLE_SOCKETS_BREAK = 1
 } handle_sockets_result_t;
 
-static handle_sockets_result_t handle_sockets(event_loop_state_t *state) {
-    assert(state->anjay_locked);
-    assert(avs_time_duration_valid(state->max_wait_time)
-           && !avs_time_duration_less(state->max_wait_time,
-                                      AVS_TIME_DURATION_ZERO));
-#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-    size_t numsocks = 0;
-    size_t i = 0;
-#    else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-    fd_set infds;
-    fd_set outfds;
-    fd_set errfds;
-    sockfd_t nfds = 0;
-#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-    handle_sockets_result_t result = HANDLE_SOCKETS_CONTINUE;
-    AVS_LIST(const anjay_socket_entry_t) entries = NULL;
-    AVS_LIST(const anjay_socket_entry_t) *entry_ptr = NULL;
-    AVS_LIST(const anjay_socket_entry_t) entry = NULL;
-    bool sockets_ready = false;
+static sockfd_t get_socket_fd(avs_net_socket_t *socket) {
+    const void *fd_ptr = avs_net_socket_get_system(socket);
+    return fd_ptr ? *(const sockfd_t *) fd_ptr : INVALID_SOCKET;
+}
 
-    ANJAY_MUTEX_LOCK(anjay, state->anjay_locked);
-    entries =
-            _anjay_collect_socket_entries(anjay, /* include_offline = */ false);
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+static bool is_registered(const event_loop_registration_t *registrations,
+                          size_t registrations_count,
+                          sockfd_t fd) {
+    for (size_t i = 0; i < registrations_count; ++i) {
+        if (registrations[i].fd == fd) {
+            return true;
+        }
+    }
+    return false;
+}
 
-#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-    numsocks = AVS_LIST_SIZE(entries);
-    if (numsocks != state->pollfds_size) {
-        struct pollfd *pollfds_new = NULL;
-        if (!numsocks) {
-            avs_free(state->pollfds);
+/**
+ * Registers @p registrations in the event queue, and unregisters the
+ * descriptors that were registered previously but are not in
+ * @p registrations anymore. Takes ownership of @p registrations. Elements that
+ * could not be registered are removed from the array, and flagged in the
+ * corresponding elements of @p out_failed, which shall be @p count long.
+ */
+static void
+queue_replace_registrations(event_loop_state_t *state,
+                            event_loop_registration_t *registrations,
+                            size_t count,
+                            bool *out_failed) {
+    assert(state->queue_open);
+    size_t registered = 0;
+    for (size_t i = 0; i < count; ++i) {
+        out_failed[i] = queue_register(state->queue_fd, registrations[i].fd,
+                                       registered);
+        if (out_failed[i]) {
+            anjay_log(WARNING, "could not register socket in the event queue");
         } else {
-            pollfds_new = (struct pollfd *) avs_realloc(
-                    state->pollfds, numsocks * sizeof(*state->pollfds));
+            registrations[registered++] = registrations[i];
         }
-        if (pollfds_new || !numsocks) {
-            state->pollfds = pollfds_new;
-            state->pollfds_size = numsocks;
-        } else if (numsocks > state->pollfds_size) {
-            _anjay_log_oom();
-            result = HANDLE_SOCKETS_ERROR;
+    }
+    for (size_t i = 0; i < state->registrations_count; ++i) {
+        if (!is_registered(registrations, registered,
+                           state->registrations[i].fd)) {
+            queue_unregister(state->queue_fd, state->registrations[i].fd);
         }
     }
+    avs_free(state->registrations);
+    state->registrations = registrations;
+    state->registrations_count = registered;
+}
 
-    if (result == HANDLE_SOCKETS_CONTINUE) {
-        AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, entry, &entries) {
-            assert(i < numsocks);
-            state->pollfds[i].events = POLLIN;
-            state->pollfds[i].revents = 0;
-            state->pollfds[i].fd = INVALID_SOCKET;
-            const void *fd_ptr =
-                    avs_net_socket_get_system((*entry_ptr)->socket);
-            if (fd_ptr) {
-                state->pollfds[i].fd = *(const sockfd_t *) fd_ptr;
-            }
-            if (state->pollfds[i].fd == INVALID_SOCKET) {
-                AVS_LIST_DELETE(entry_ptr);
-            } else {
-                ++i;
-            }
+static handle_sockets_result_t
+update_queue_registrations(event_loop_state_t *state) {
+    if (!state->queue_open) {
+        if ((state->queue_fd = queue_create()) < 0) {
+            anjay_log(ERROR, "could not create the event queue");
+            return HANDLE_SOCKETS_ERROR;
         }
+        state->queue_open = true;
     }
-#    else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-    FD_ZERO(&infds);
-    FD_ZERO(&outfds);
-    FD_ZERO(&errfds);
-    nfds = 0;
+    const size_t numsocks = AVS_LIST_SIZE(state->entries);
+    event_loop_registration_t *registrations = NULL;
+    bool *failed = NULL;
+    if (numsocks
+            && (!(registrations = (event_loop_registration_t *) avs_malloc(
+                          numsocks * sizeof(*registrations)))
+                || !(failed = (bool *) avs_malloc(numsocks
+                                                  * sizeof(*failed))))) {
+        _anjay_log_oom();
+        avs_free(registrations);
+        return HANDLE_SOCKETS_ERROR;
+    }
+    size_t i = 0;
+    AVS_LIST(const anjay_socket_entry_t) entry;
+    AVS_LIST_FOREACH(entry, state->entries) {
+        registrations[i].fd = get_socket_fd(entry->socket);
+        registrations[i].socket = entry->socket;
+        ++i;
+    }
+    queue_replace_registrations(state, registrations, numsocks, failed);
+    i = 0;
+    AVS_LIST(const anjay_socket_entry_t) *entry_ptr;
+    AVS_LIST(const anjay_socket_entry_t) helper;
+    AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, helper, &state->entries) {
+        if (failed[i++]) {
+            AVS_LIST_DELETE(entry_ptr);
+        }
+    }
+    avs_free(failed);
+    return HANDLE_SOCKETS_CONTINUE;
+}
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
 
-    AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, entry, &entries) {
-        sockfd_t fd = INVALID_SOCKET;
-        const void *fd_ptr = avs_net_socket_get_system((*entry_ptr)->socket);
-        if (fd_ptr) {
-            fd = *(const sockfd_t *) fd_ptr;
+#    ifdef EVENT_LOOP_USE_POLL
+static handle_sockets_result_t update_pollfds(event_loop_state_t *state) {
+    const size_t numsocks = AVS_LIST_SIZE(state->entries);
+    if (numsocks > state->pollfds_size) {
+        struct pollfd *pollfds_new = (struct pollfd *) avs_realloc(
+                state->pollfds, numsocks * sizeof(*state->pollfds));
+        if (!pollfds_new) {
+            _anjay_log_oom();
+            state->pollfds_count = 0;
+            return HANDLE_SOCKETS_ERROR;
         }
-        if (fd == INVALID_SOCKET || fd >= FD_SETSIZE) {
+        state->pollfds = pollfds_new;
+        state->pollfds_size = numsocks;
+    }
+    size_t i = 0;
+    AVS_LIST(const anjay_socket_entry_t) entry;
+    AVS_LIST_FOREACH(entry, state->entries) {
+        state->pollfds[i].fd = get_socket_fd(entry->socket);
+        state->pollfds[i].events = POLLIN;
+        state->pollfds[i].revents = 0;
+        ++i;
+    }
+    state->pollfds_count = i;
+    return HANDLE_SOCKETS_CONTINUE;
+}
+#    else  // EVENT_LOOP_USE_POLL
+static handle_sockets_result_t update_fd_set(event_loop_state_t *state) {
+    FD_ZERO(&state->fds);
+    state->nfds = 0;
+    AVS_LIST(const anjay_socket_entry_t) entry;
+    AVS_LIST_FOREACH(entry, state->entries) {
+        sockfd_t fd = get_socket_fd(entry->socket);
+        FD_SET(fd, &state->fds);
+        state->nfds = AVS_MAX(state->nfds, fd + 1);
+    }
+    return HANDLE_SOCKETS_CONTINUE;
+}
+#    endif // EVENT_LOOP_USE_POLL
+
+/**
+ * Collects the sockets to wait on anew, unless the set has not changed since
+ * the previous call.
+ */
+static handle_sockets_result_t update_socket_set(event_loop_state_t *state,
+                                                 anjay_unlocked_t *anjay) {
+    const size_t version = _anjay_socket_set_version(anjay);
+    if (state->entries_valid && state->entries_version == version) {
+        return HANDLE_SOCKETS_CONTINUE;
+    }
+    AVS_LIST_CLEAR(&state->entries);
+    state->entries_valid = false;
+    state->entries =
+            _anjay_collect_socket_entries(anjay, /* include_offline = */ false);
+
+    AVS_LIST(const anjay_socket_entry_t) *entry_ptr;
+    AVS_LIST(const anjay_socket_entry_t) helper;
+    AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, helper, &state->entries) {
+        sockfd_t fd = get_socket_fd((*entry_ptr)->socket);
+        if (fd == INVALID_SOCKET
+#    ifdef EVENT_LOOP_USE_SELECT
+                || fd >= FD_SETSIZE
+#    endif // EVENT_LOOP_USE_SELECT
+        ) {
             AVS_LIST_DELETE(entry_ptr);
-        } else {
-            FD_SET(fd, &infds);
-            FD_SET(fd, &errfds);
-            nfds = AVS_MAX(nfds, fd + 1);
         }
     }
-#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
+
+    handle_sockets_result_t result;
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+    if (state->use_queue) {
+        result = update_queue_registrations(state);
+    } else {
+        result = update_pollfds(state);
+    }
+#    elif defined(EVENT_LOOP_USE_POLL)
+    result = update_pollfds(state);
+#    else  // EVENT_LOOP_USE_SELECT
+    result = update_fd_set(state);
+#    endif
+    if (result != HANDLE_SOCKETS_CONTINUE) {
+        AVS_LIST_CLEAR(&state->entries);
+        return result;
+    }
+    state->entries_version = version;
+    state->entries_valid = true;
+    return HANDLE_SOCKETS_CONTINUE;
+}
+
+#    ifndef EVENT_LOOP_USE_SELECT
+static int wait_time_to_ms(avs_time_duration_t wait_time) {
+    int64_t wait_ms;
+    if (avs_time_duration_to_scalar(&wait_ms, AVS_TIME_MS, wait_time)
+            || wait_ms > INT_MAX) {
+        wait_ms = (int64_t) INT_MAX;
+    }
+    return (int) wait_ms;
+}
+#    endif // EVENT_LOOP_USE_SELECT
+
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+/**
+ * Waits for readiness events and fills @p out_indices with indices into
+ * registrations of the sockets that are ready. Returns the number of such
+ * sockets, or a negative value in case of error.
+ */
+static int queue_wait(const event_loop_state_t *state,
+                      size_t out_indices[EVENT_LOOP_MAX_EVENTS],
+                      avs_time_duration_t wait_time) {
+#        ifdef ANJAY_WITH_EVENT_LOOP_EPOLL
+    struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+    int result = epoll_wait(state->queue_fd, events, EVENT_LOOP_MAX_EVENTS,
+                            wait_time_to_ms(wait_time));
+    for (int i = 0; i < result; ++i) {
+        out_indices[i] = (size_t) events[i].data.u64;
+    }
+#        else  // ANJAY_WITH_EVENT_LOOP_EPOLL
+    struct kevent events[EVENT_LOOP_MAX_EVENTS];
+    struct timespec timeout = {
+        .tv_sec = (time_t) AVS_MIN(wait_time.seconds, (int64_t) INT_MAX),
+        .tv_nsec = wait_time.nanoseconds
+    };
+    int result = kevent(state->queue_fd, NULL, 0, events,
+                        EVENT_LOOP_MAX_EVENTS, &timeout);
+    for (int i = 0; i < result; ++i) {
+        out_indices[i] = (size_t) (uintptr_t) events[i].udata;
+    }
+#        endif // ANJAY_WITH_EVENT_LOOP_EPOLL
+    return result;
+}
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
+
+static bool should_serve_next(event_loop_state_t *state) {
+    return !state->allow_interrupt
+           || should_event_loop_still_run(state->anjay_locked);
+}
+
+static void serve_socket(event_loop_state_t *state, avs_net_socket_t *socket) {
+    if (state->batch_anjay
+            ? _anjay_serve_unlocked(state->batch_anjay, socket)
+            : anjay_serve(state->anjay_locked, socket)) {
+        anjay_log(WARNING, "anjay_serve failed");
+    }
+}
+
+static handle_sockets_result_t prepare_sockets(event_loop_state_t *state) {
+    handle_sockets_result_t result = HANDLE_SOCKETS_CONTINUE;
+    ANJAY_MUTEX_LOCK(anjay, state->anjay_locked);
+    result = update_socket_set(state, anjay);
     ANJAY_MUTEX_UNLOCK(state->anjay_locked);
+    return result;
+}
 
+static avs_time_duration_t get_wait_time(event_loop_state_t *state) {
     avs_time_duration_t wait_time;
     if (anjay_sched_time_to_next(state->anjay_locked, &wait_time)
             || !avs_time_duration_less(wait_time, state->max_wait_time)) {
@@ -167,62 +480,203 @@ static handle_sockets_result_t handle_sockets(event_loop_state_t *state) {
     }
     assert(avs_time_duration_valid(wait_time)
            && !avs_time_duration_less(wait_time, AVS_TIME_DURATION_ZERO));
+    return wait_time;
+}
 
-    // Wait for the events if necessary, and handle them.
-#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-    int64_t wait_ms;
-    if (result == HANDLE_SOCKETS_CONTINUE) {
-        if (avs_time_duration_to_scalar(&wait_ms, AVS_TIME_MS, wait_time)
-                || wait_ms > INT_MAX) {
-            wait_ms = (int64_t) INT_MAX;
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+static handle_sockets_result_t serve_queued_sockets(event_loop_state_t *state,
+                                                    const size_t *ready,
+                                                    int ready_count) {
+    for (int i = 0; i < ready_count; ++i) {
+        if (!should_serve_next(state)) {
+            return HANDLE_SOCKETS_BREAK;
+        }
+        if (ready[i] < state->registrations_count) {
+            serve_socket(state, state->registrations[ready[i]].socket);
         }
-        sockets_ready = (poll(state->pollfds, i, (int) wait_ms) > 0);
     }
-    i = 0;
-#    else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-           // NOTE: This assumes that time_t is a signed integer type
+    return HANDLE_SOCKETS_CONTINUE;
+}
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
+
+#    ifdef EVENT_LOOP_USE_POLL
+static handle_sockets_result_t serve_ready_sockets(event_loop_state_t *state) {
+    size_t i = 0;
+    AVS_LIST(const anjay_socket_entry_t) entry;
+    AVS_LIST_FOREACH(entry, state->entries) {
+        if (!should_serve_next(state)) {
+            return HANDLE_SOCKETS_BREAK;
+        }
+        assert(i < state->pollfds_count);
+        if (state->pollfds[i++].revents) {
+            serve_socket(state, entry->socket);
+        }
+    }
+    return HANDLE_SOCKETS_CONTINUE;
+}
+#    else  // EVENT_LOOP_USE_POLL
+static handle_sockets_result_t serve_ready_sockets(event_loop_state_t *state,
+                                                   const fd_set *infds,
+                                                   const fd_set *errfds) {
+    AVS_LIST(const anjay_socket_entry_t) entry;
+    AVS_LIST_FOREACH(entry, state->entries) {
+        if (!should_serve_next(state)) {
+            return HANDLE_SOCKETS_BREAK;
+        }
+        sockfd_t fd = get_socket_fd(entry->socket);
+        if (fd != INVALID_SOCKET
+                && (FD_ISSET(fd, infds) || FD_ISSET(fd, errfds))) {
+            serve_socket(state, entry->socket);
+        }
+    }
+    return HANDLE_SOCKETS_CONTINUE;
+}
+
+static struct timeval duration_to_timeval(avs_time_duration_t duration) {
+    // NOTE: This assumes that time_t is a signed integer type
     static const time_t AVS_TIME_MAX =
             (time_t) ((UINT64_C(1) << (8 * sizeof(time_t) - 1)) - 1);
-    struct timeval wait_timeval = {
+    struct timeval result = {
         .tv_sec = AVS_TIME_MAX
     };
-    if (wait_time.seconds <= AVS_TIME_MAX) {
-        wait_timeval.tv_sec = (time_t) wait_time.seconds;
-        wait_timeval.tv_usec = (int32_t) (wait_time.nanoseconds / 1000);
-    }
-    sockets_ready = (select(nfds, &infds, &outfds, &errfds, &wait_timeval) > 0);
-#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-
-    if (sockets_ready) {
-        AVS_LIST_FOREACH(entry, entries) {
-            if (state->allow_interrupt
-                    && !should_event_loop_still_run(state->anjay_locked)) {
-                result = HANDLE_SOCKETS_BREAK;
-                break;
-            }
-#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-            assert(i < numsocks);
-            if (!state->pollfds[i++].revents) {
-                continue;
-            }
-#    else  // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-            sockfd_t fd = INVALID_SOCKET;
-            const void *fd_ptr = avs_net_socket_get_system(entry->socket);
-            if (fd_ptr) {
-                fd = *(const sockfd_t *) fd_ptr;
-            }
-            if (fd == INVALID_SOCKET
-                    || !(FD_ISSET(fd, &infds) || FD_ISSET(fd, &errfds))) {
-                continue;
-            }
-#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL
-            if (anjay_serve(state->anjay_locked, entry->socket)) {
-                anjay_log(WARNING, "anjay_serve failed");
-            }
+    if (duration.seconds <= AVS_TIME_MAX) {
+        result.tv_sec = (time_t) duration.seconds;
+        result.tv_usec = (int32_t) (duration.nanoseconds / 1000);
+    }
+    return result;
+}
+#    endif // EVENT_LOOP_USE_POLL
+
+static handle_sockets_result_t handle_sockets(event_loop_state_t *state) {
+    assert(state->anjay_locked);
+    assert(avs_time_duration_valid(state->max_wait_time)
+           && !avs_time_duration_less(state->max_wait_time,
+                                      AVS_TIME_DURATION_ZERO));
+    handle_sockets_result_t result = prepare_sockets(state);
+    if (result != HANDLE_SOCKETS_CONTINUE) {
+        return result;
+    }
+    avs_time_duration_t wait_time = get_wait_time(state);
+
+    // Wait for the events if necessary, and handle them.
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+    if (state->use_queue) {
+        size_t ready[EVENT_LOOP_MAX_EVENTS];
+        int ready_count = queue_wait(state, ready, wait_time);
+        return serve_queued_sockets(state, ready, ready_count);
+    }
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
+#    ifdef EVENT_LOOP_USE_POLL
+    if (poll(state->pollfds, state->pollfds_count, wait_time_to_ms(wait_time))
+            > 0) {
+        result = serve_ready_sockets(state);
+    }
+#    else  // EVENT_LOOP_USE_POLL
+    fd_set infds = state->fds;
+    fd_set errfds = state->fds;
+    fd_set outfds;
+    FD_ZERO(&outfds);
+    struct timeval wait_timeval = duration_to_timeval(wait_time);
+    if (select(state->nfds, &infds, &outfds, &errfds, &wait_timeval) > 0) {
+        result = serve_ready_sockets(state, &infds, &errfds);
+    }
+#    endif // EVENT_LOOP_USE_POLL
+
+    return result;
+}
+
+/**
+ * Waits for any of the sockets to become ready, without serving them.
+ */
+static bool wait_for_sockets(event_loop_state_t *state,
+                             avs_time_duration_t wait_time) {
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+    if (state->use_queue) {
+        // the event queue descriptor itself becomes readable when any of the
+        // registered sockets are, without consuming the events
+        struct pollfd queue_pollfd = {
+            .fd = state->queue_fd,
+            .events = POLLIN
+        };
+        return poll(&queue_pollfd, 1, wait_time_to_ms(wait_time)) > 0;
+    }
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
+#    ifdef EVENT_LOOP_USE_POLL
+    return poll(state->pollfds, state->pollfds_count,
+                wait_time_to_ms(wait_time))
+           > 0;
+#    else  // EVENT_LOOP_USE_POLL
+    fd_set infds = state->fds;
+    fd_set errfds = state->fds;
+    fd_set outfds;
+    FD_ZERO(&outfds);
+    struct timeval wait_timeval = duration_to_timeval(wait_time);
+    return select(state->nfds, &infds, &outfds, &errfds, &wait_timeval) > 0;
+#    endif // EVENT_LOOP_USE_POLL
+}
+
+/**
+ * Serves the sockets that are ready right now, without waiting. Returns true
+ * if there were any.
+ */
+static bool serve_pending_sockets(event_loop_state_t *state) {
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+    if (state->use_queue) {
+        size_t ready[EVENT_LOOP_MAX_EVENTS];
+        int ready_count = queue_wait(state, ready, AVS_TIME_DURATION_ZERO);
+        if (ready_count <= 0) {
+            return false;
         }
+        (void) serve_queued_sockets(state, ready, ready_count);
+        return true;
     }
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
+#    ifdef EVENT_LOOP_USE_POLL
+    if (poll(state->pollfds, state->pollfds_count, 0) <= 0) {
+        return false;
+    }
+    (void) serve_ready_sockets(state);
+#    else  // EVENT_LOOP_USE_POLL
+    fd_set infds = state->fds;
+    fd_set errfds = state->fds;
+    fd_set outfds;
+    FD_ZERO(&outfds);
+    struct timeval wait_timeval = { 0 };
+    if (select(state->nfds, &infds, &outfds, &errfds, &wait_timeval) <= 0) {
+        return false;
+    }
+    (void) serve_ready_sockets(state, &infds, &errfds);
+#    endif // EVENT_LOOP_USE_POLL
+    return true;
+}
 
-    AVS_LIST_CLEAR(&entries);
+static handle_sockets_result_t
+handle_sockets_batched(event_loop_state_t *state,
+                       avs_time_duration_t time_budget) {
+    handle_sockets_result_t result = prepare_sockets(state);
+    if (result != HANDLE_SOCKETS_CONTINUE
+            || !wait_for_sockets(state, get_wait_time(state))) {
+        return result;
+    }
+    ANJAY_MUTEX_LOCK(anjay, state->anjay_locked);
+#    ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+    _anjay_notify_change_queue_drain(anjay);
+#    endif // ANJAY_WITH_LOCK_FREE_NOTIFY
+    const avs_time_monotonic_t deadline =
+            avs_time_monotonic_add(avs_time_monotonic_now(), time_budget);
+    state->batch_anjay = anjay;
+    // Sockets are level-triggered, so each pass serves one packet from each
+    // socket that still has data. Serving may change the socket set.
+    bool more_data = true;
+    while (more_data) {
+        more_data = (result = update_socket_set(state, anjay))
+                            == HANDLE_SOCKETS_CONTINUE
+                    && serve_pending_sockets(state)
+                    && avs_time_monotonic_before(avs_time_monotonic_now(),
+                                                 deadline);
+    }
+    state->batch_anjay = NULL;
+    ANJAY_MUTEX_UNLOCK(state->anjay_locked);
     return result;
 }
 
@@ -245,7 +699,10 @@ static int event_loop_run_with_error_handling(anjay_t *anjay_locked,
     event_loop_state_t state = {
         .anjay_locked = anjay_locked,
         .max_wait_time = max_wait_time,
-        .allow_interrupt = true
+        .allow_interrupt = true,
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+        .use_queue = true
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
     };
     bool running = should_event_loop_still_run(anjay_locked);
     while (running) {
@@ -311,4 +768,558 @@ int anjay_serve_any(anjay_t *anjay_locked, avs_time_duration_t max_wait_time) {
     return handle_sockets_result == HANDLE_SOCKETS_ERROR ? -1 : 0;
 }
 
+int anjay_serve_any_batched(anjay_t *anjay_locked,
+                            avs_time_duration_t max_wait_time,
+                            avs_time_duration_t time_budget) {
+    if (!avs_time_duration_valid(max_wait_time)
+            || avs_time_duration_less(max_wait_time, AVS_TIME_DURATION_ZERO)) {
+        anjay_log(ERROR, "max_wait_time needs to be valid and non-negative");
+        return -1;
+    }
+    if (!avs_time_duration_valid(time_budget)
+            || avs_time_duration_less(time_budget, AVS_TIME_DURATION_ZERO)) {
+        anjay_log(ERROR, "time_budget needs to be valid and non-negative");
+        return -1;
+    }
+    event_loop_state_t state = {
+        .anjay_locked = anjay_locked,
+        .max_wait_time = max_wait_time,
+        .allow_interrupt = false
+    };
+    handle_sockets_result_t handle_sockets_result =
+            handle_sockets_batched(&state, time_budget);
+    event_loop_state_cleanup(&state);
+    if (handle_sockets_result == HANDLE_SOCKETS_ERROR) {
+        return -1;
+    }
+    // scheduler jobs lock the mutex on their own, so they cannot be run as
+    // part of the batch above
+    anjay_sched_run(anjay_locked);
+    return 0;
+}
+
+
+typedef struct {
+    anjay_t *anjay;
+    /**
+     * Unique within the group, so that a running loop never confuses a newly
+     * added instance with a removed one allocated at the same address.
+     */
+    size_t id;
+    /**
+     * Set while the instance is being served by the group's event loop, which
+     * does not keep the group locked at that time.
+     */
+    bool in_use;
+    /**
+     * Set by anjay_event_loop_group_remove() if the instance was in use. The
+     * event loop deletes the member as soon as it finishes serving it.
+     */
+    bool removed;
+} event_loop_group_member_t;
+
+struct anjay_event_loop_group_struct {
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    avs_mutex_t *mutex;
+    /**
+     * Signalled whenever a removed member is deleted by the event loop.
+     */
+    avs_condvar_t *member_released;
+#    endif // ANJAY_WITH_THREAD_SAFETY
+    AVS_LIST(event_loop_group_member_t) members;
+    size_t next_member_id;
+    /**
+     * Incremented on each change of members, so that a running loop knows when
+     * to update its per-instance state.
+     */
+    size_t members_version;
+    volatile atomic_int status;
+};
+
+typedef struct {
+    event_loop_state_t state;
+    size_t member_id;
+} event_loop_group_state_t;
+
+typedef struct {
+    avs_time_duration_t max_wait_time;
+    AVS_LIST(event_loop_group_state_t) states;
+    size_t members_version;
+    bool states_valid;
+#    ifdef EVENT_LOOP_USE_SELECT
+    fd_set fds;
+    sockfd_t nfds;
+#    else  // EVENT_LOOP_USE_SELECT
+    /**
+     * Concatenation of the descriptor arrays of all the instances in the
+     * poll() backend, or the event queue descriptors of all instances in the
+     * kernel queue backends.
+     */
+    struct pollfd *pollfds;
+    size_t pollfds_size;
+    size_t pollfds_count;
+#    endif // EVENT_LOOP_USE_SELECT
+} event_loop_group_run_t;
+
+static int group_lock(anjay_event_loop_group_t *group) {
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    if (avs_mutex_lock(group->mutex)) {
+        anjay_log(ERROR, "could not lock event loop group mutex");
+        return -1;
+    }
+#    else  // ANJAY_WITH_THREAD_SAFETY
+    (void) group;
+#    endif // ANJAY_WITH_THREAD_SAFETY
+    return 0;
+}
+
+static void group_unlock(anjay_event_loop_group_t *group) {
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    avs_mutex_unlock(group->mutex);
+#    else  // ANJAY_WITH_THREAD_SAFETY
+    (void) group;
+#    endif // ANJAY_WITH_THREAD_SAFETY
+}
+
+static void release_member(anjay_t *anjay) {
+    atomic_store(&anjay->atomic_fields.event_loop_status,
+                 ANJAY_EVENT_LOOP_IDLE);
+}
+
+anjay_event_loop_group_t *anjay_event_loop_group_new(void) {
+    anjay_event_loop_group_t *group =
+            (anjay_event_loop_group_t *) avs_calloc(1, sizeof(*group));
+    if (!group) {
+        _anjay_log_oom();
+        return NULL;
+    }
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    if (avs_mutex_create(&group->mutex)) {
+        anjay_log(ERROR, "could not create event loop group mutex");
+        avs_free(group);
+        return NULL;
+    }
+    if (avs_condvar_create(&group->member_released)) {
+        anjay_log(ERROR, "could not create event loop group condvar");
+        avs_mutex_cleanup(&group->mutex);
+        avs_free(group);
+        return NULL;
+    }
+#    endif // ANJAY_WITH_THREAD_SAFETY
+    atomic_store(&group->status, ANJAY_EVENT_LOOP_IDLE);
+    return group;
+}
+
+void anjay_event_loop_group_delete(anjay_event_loop_group_t *group) {
+    if (!group) {
+        return;
+    }
+    assert(atomic_load(&group->status) == ANJAY_EVENT_LOOP_IDLE);
+    AVS_LIST_CLEAR(&group->members) {
+        assert(!group->members->in_use);
+        release_member(group->members->anjay);
+    }
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    avs_condvar_cleanup(&group->member_released);
+    avs_mutex_cleanup(&group->mutex);
+#    endif // ANJAY_WITH_THREAD_SAFETY
+    avs_free(group);
+}
+
+int anjay_event_loop_group_add(anjay_event_loop_group_t *group,
+                               anjay_t *anjay) {
+    assert(group);
+    assert(anjay);
+    // this also prevents adding the same instance twice
+    if (!atomic_compare_exchange_strong(&anjay->atomic_fields.event_loop_status,
+                                        &(int) { ANJAY_EVENT_LOOP_IDLE },
+                                        ANJAY_EVENT_LOOP_RUNNING)) {
+        anjay_log(ERROR, "Event loop is already running");
+        return -1;
+    }
+    int result = -1;
+    if (!group_lock(group)) {
+        AVS_LIST(event_loop_group_member_t) member =
+                AVS_LIST_NEW_ELEMENT(event_loop_group_member_t);
+        if (!member) {
+            _anjay_log_oom();
+        } else {
+            member->anjay = anjay;
+            member->id = group->next_member_id++;
+            AVS_LIST_INSERT(&group->members, member);
+            ++group->members_version;
+            result = 0;
+        }
+        group_unlock(group);
+    }
+    if (result) {
+        release_member(anjay);
+    }
+    return result;
+}
+
+static AVS_LIST(event_loop_group_member_t) *
+find_member_ptr(anjay_event_loop_group_t *group, size_t member_id) {
+    AVS_LIST(event_loop_group_member_t) *member_ptr;
+    AVS_LIST_FOREACH_PTR(member_ptr, &group->members) {
+        if ((*member_ptr)->id == member_id) {
+            return member_ptr;
+        }
+    }
+    return NULL;
+}
+
+int anjay_event_loop_group_remove(anjay_event_loop_group_t *group,
+                                  anjay_t *anjay) {
+    assert(group);
+    int result = -1;
+    if (!group_lock(group)) {
+        AVS_LIST(event_loop_group_member_t) *member_ptr;
+        AVS_LIST_FOREACH_PTR(member_ptr, &group->members) {
+            if ((*member_ptr)->anjay == anjay && !(*member_ptr)->removed) {
+                break;
+            }
+        }
+        if (member_ptr && *member_ptr) {
+            ++group->members_version;
+            result = 0;
+            if (!(*member_ptr)->in_use) {
+                AVS_LIST_DELETE(member_ptr);
+                release_member(anjay);
+            } else {
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+                // the event loop is serving the instance in another thread;
+                // it will delete the member when it finishes
+                const size_t member_id = (*member_ptr)->id;
+                (*member_ptr)->removed = true;
+                while (find_member_ptr(group, member_id)
+                       && !avs_condvar_wait(group->member_released,
+                                            group->mutex,
+                                            AVS_TIME_MONOTONIC_INVALID)) {
+                }
+#    else  // ANJAY_WITH_THREAD_SAFETY
+                AVS_UNREACHABLE("called from within the group's event loop");
+#    endif // ANJAY_WITH_THREAD_SAFETY
+            }
+        }
+        group_unlock(group);
+        if (result) {
+            anjay_log(ERROR, "Anjay object is not a member of this group");
+        }
+    }
+    return result;
+}
+
+size_t anjay_event_loop_group_size(anjay_event_loop_group_t *group) {
+    assert(group);
+    size_t result = 0;
+    if (!group_lock(group)) {
+        AVS_LIST(event_loop_group_member_t) member;
+        AVS_LIST_FOREACH(member, group->members) {
+            if (!member->removed) {
+                ++result;
+            }
+        }
+        group_unlock(group);
+    }
+    return result;
+}
+
+static bool has_member(anjay_event_loop_group_t *group, size_t member_id) {
+    AVS_LIST(event_loop_group_member_t) *member_ptr =
+            find_member_ptr(group, member_id);
+    return member_ptr && !(*member_ptr)->removed;
+}
+
+static bool has_state(event_loop_group_run_t *run, size_t member_id) {
+    AVS_LIST(event_loop_group_state_t) state;
+    AVS_LIST_FOREACH(state, run->states) {
+        if (state->member_id == member_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Makes run->states correspond to group->members. Needs to be called with the
+ * group locked.
+ */
+static int group_sync_states(event_loop_group_run_t *run,
+                             anjay_event_loop_group_t *group) {
+    if (run->states_valid && run->members_version == group->members_version) {
+        return 0;
+    }
+    AVS_LIST(event_loop_group_state_t) *state_ptr;
+    AVS_LIST(event_loop_group_state_t) helper;
+    AVS_LIST_DELETABLE_FOREACH_PTR(state_ptr, helper, &run->states) {
+        if (!has_member(group, (*state_ptr)->member_id)) {
+            event_loop_state_cleanup(&(*state_ptr)->state);
+            AVS_LIST_DELETE(state_ptr);
+        }
+    }
+    AVS_LIST(event_loop_group_member_t) member;
+    AVS_LIST_FOREACH(member, group->members) {
+        if (has_state(run, member->id)) {
+            continue;
+        }
+        AVS_LIST(event_loop_group_state_t) state =
+                AVS_LIST_NEW_ELEMENT(event_loop_group_state_t);
+        if (!state) {
+            _anjay_log_oom();
+            run->states_valid = false;
+            return -1;
+        }
+        // event_loop_state_t has const fields, so it cannot be assigned to
+        const event_loop_state_t initial_state = {
+            .anjay_locked = member->anjay,
+            .max_wait_time = run->max_wait_time,
+            .allow_interrupt = false,
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+            .use_queue = true
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
+        };
+        memcpy(&state->state, &initial_state, sizeof(initial_state));
+        state->member_id = member->id;
+        AVS_LIST_INSERT(&run->states, state);
+    }
+    run->members_version = group->members_version;
+    run->states_valid = true;
+    return 0;
+}
+
+/**
+ * Refreshes socket sets of all instances, and combines them into a single set
+ * to wait on. Returns the time to wait for.
+ */
+static avs_time_duration_t group_prepare(event_loop_group_run_t *run) {
+    avs_time_duration_t wait_time = run->max_wait_time;
+    AVS_LIST(event_loop_group_state_t) state;
+#    ifdef EVENT_LOOP_USE_SELECT
+    FD_ZERO(&run->fds);
+    run->nfds = 0;
+#    else  // EVENT_LOOP_USE_SELECT
+    size_t numfds = 0;
+#    endif // EVENT_LOOP_USE_SELECT
+    AVS_LIST_FOREACH(state, run->states) {
+        // Failure to update one instance (which may only happen in case of
+        // OOM) shall not affect the others. Such instance is retried in the
+        // next iteration, as its cached socket set has been invalidated.
+        (void) prepare_sockets(&state->state);
+        avs_time_duration_t state_wait_time = get_wait_time(&state->state);
+        if (avs_time_duration_less(state_wait_time, wait_time)) {
+            wait_time = state_wait_time;
+        }
+#    if defined(EVENT_LOOP_USE_KERNEL_QUEUE)
+        ++numfds;
+#    elif defined(EVENT_LOOP_USE_POLL)
+        numfds += state->state.pollfds_count;
+#    else  // EVENT_LOOP_USE_SELECT
+        for (sockfd_t fd = 0; fd < state->state.nfds; ++fd) {
+            if (FD_ISSET(fd, &state->state.fds)) {
+                FD_SET(fd, &run->fds);
+            }
+        }
+        run->nfds = AVS_MAX(run->nfds, state->state.nfds);
+#    endif
+    }
+
+#    ifndef EVENT_LOOP_USE_SELECT
+    run->pollfds_count = 0;
+    if (numfds > run->pollfds_size) {
+        struct pollfd *pollfds_new = (struct pollfd *) avs_realloc(
+                run->pollfds, numfds * sizeof(*run->pollfds));
+        if (!pollfds_new) {
+            _anjay_log_oom();
+            // wait without any sockets; this will still run the schedulers
+            return wait_time;
+        }
+        run->pollfds = pollfds_new;
+        run->pollfds_size = numfds;
+    }
+    AVS_LIST_FOREACH(state, run->states) {
+#        ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+        run->pollfds[run->pollfds_count].fd =
+                state->state.queue_open ? state->state.queue_fd : -1;
+        run->pollfds[run->pollfds_count].events = POLLIN;
+        run->pollfds[run->pollfds_count].revents = 0;
+        ++run->pollfds_count;
+#        else  // EVENT_LOOP_USE_KERNEL_QUEUE
+        memcpy(&run->pollfds[run->pollfds_count], state->state.pollfds,
+               state->state.pollfds_count * sizeof(*run->pollfds));
+        run->pollfds_count += state->state.pollfds_count;
+#        endif // EVENT_LOOP_USE_KERNEL_QUEUE
+    }
+#    endif // EVENT_LOOP_USE_SELECT
+    return wait_time;
+}
+
+/**
+ * Marks the member identified by @p member_id as being in use, so that it is
+ * not deleted while it is being served with the group unlocked. Sets
+ * @p *out_anjay to NULL if it is not a member anymore.
+ */
+static int group_acquire_member(anjay_event_loop_group_t *group,
+                                size_t member_id,
+                                anjay_t **out_anjay) {
+    if (group_lock(group)) {
+        return -1;
+    }
+    AVS_LIST(event_loop_group_member_t) *member_ptr =
+            find_member_ptr(group, member_id);
+    *out_anjay = NULL;
+    if (member_ptr && !(*member_ptr)->removed) {
+        (*member_ptr)->in_use = true;
+        *out_anjay = (*member_ptr)->anjay;
+    }
+    group_unlock(group);
+    return 0;
+}
+
+static void group_release_member(anjay_event_loop_group_t *group,
+                                 size_t member_id) {
+    if (group_lock(group)) {
+        return;
+    }
+    AVS_LIST(event_loop_group_member_t) *member_ptr =
+            find_member_ptr(group, member_id);
+    assert(member_ptr && (*member_ptr)->in_use);
+    (*member_ptr)->in_use = false;
+    if ((*member_ptr)->removed) {
+        release_member((*member_ptr)->anjay);
+        AVS_LIST_DELETE(member_ptr);
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+        avs_condvar_notify_all(group->member_released);
+#    endif // ANJAY_WITH_THREAD_SAFETY
+    }
+    group_unlock(group);
+}
+
+static handle_sockets_result_t
+group_iteration(anjay_event_loop_group_t *group, event_loop_group_run_t *run) {
+    if (group_lock(group)) {
+        return HANDLE_SOCKETS_ERROR;
+    }
+    if (group_sync_states(run, group)) {
+        group_unlock(group);
+        return HANDLE_SOCKETS_ERROR;
+    }
+    avs_time_duration_t wait_time = group_prepare(run);
+    group_unlock(group);
+
+    // The group is not locked while waiting, so that instances can be added
+    // and removed from other threads in the meantime.
+#    ifdef EVENT_LOOP_USE_SELECT
+    fd_set infds = run->fds;
+    fd_set errfds = run->fds;
+    fd_set outfds;
+    FD_ZERO(&outfds);
+    struct timeval wait_timeval = duration_to_timeval(wait_time);
+    bool sockets_ready =
+            (select(run->nfds, &infds, &outfds, &errfds, &wait_timeval) > 0);
+#    else  // EVENT_LOOP_USE_SELECT
+    bool sockets_ready = (poll(run->pollfds, run->pollfds_count,
+                               wait_time_to_ms(wait_time))
+                          > 0);
+    size_t offset = 0;
+#    endif // EVENT_LOOP_USE_SELECT
+
+    // Each instance is only marked as being in use while it is served, and
+    // the group is not locked at that time either. Instances removed in the
+    // meantime are skipped, and ones added are picked up in the next
+    // iteration.
+    handle_sockets_result_t result = HANDLE_SOCKETS_CONTINUE;
+    AVS_LIST(event_loop_group_state_t) state;
+    AVS_LIST_FOREACH(state, run->states) {
+        if (!should_still_run(&group->status)) {
+            result = HANDLE_SOCKETS_BREAK;
+            break;
+        }
+#    if defined(EVENT_LOOP_USE_KERNEL_QUEUE)
+        const size_t state_offset = offset++;
+#    elif defined(EVENT_LOOP_USE_POLL)
+        const size_t state_offset = offset;
+        offset += state->state.pollfds_count;
+#    endif
+        anjay_t *anjay;
+        if (group_acquire_member(group, state->member_id, &anjay)) {
+            result = HANDLE_SOCKETS_ERROR;
+            break;
+        }
+        if (!anjay) {
+            continue;
+        }
+        assert(anjay == state->state.anjay_locked);
+        if (sockets_ready) {
+#    if defined(EVENT_LOOP_USE_KERNEL_QUEUE)
+            if (state_offset < run->pollfds_count
+                    && run->pollfds[state_offset].revents) {
+                size_t ready[EVENT_LOOP_MAX_EVENTS];
+                int ready_count = queue_wait(&state->state, ready,
+                                             AVS_TIME_DURATION_ZERO);
+                (void) serve_queued_sockets(&state->state, ready,
+                                            ready_count);
+            }
+#    elif defined(EVENT_LOOP_USE_POLL)
+            for (size_t i = 0; i < state->state.pollfds_count; ++i) {
+                state->state.pollfds[i].revents =
+                        run->pollfds[state_offset + i].revents;
+            }
+            (void) serve_ready_sockets(&state->state);
+#    else  // EVENT_LOOP_USE_SELECT
+            (void) serve_ready_sockets(&state->state, &infds, &errfds);
+#    endif
+        }
+        anjay_sched_run(anjay);
+        group_release_member(group, state->member_id);
+    }
+    return result;
+}
+
+int anjay_event_loop_group_run(anjay_event_loop_group_t *group,
+                               avs_time_duration_t max_wait_time) {
+    assert(group);
+    if (!avs_time_duration_valid(max_wait_time)
+            || avs_time_duration_less(max_wait_time, AVS_TIME_DURATION_ZERO)) {
+        anjay_log(ERROR, "max_wait_time needs to be valid and non-negative");
+        return -1;
+    }
+    if (!atomic_compare_exchange_strong(&group->status,
+                                        &(int) { ANJAY_EVENT_LOOP_IDLE },
+                                        ANJAY_EVENT_LOOP_RUNNING)) {
+        anjay_log(ERROR, "Event loop is already running");
+        return -1;
+    }
+    event_loop_group_run_t run = {
+        .max_wait_time = max_wait_time
+    };
+    handle_sockets_result_t result = HANDLE_SOCKETS_CONTINUE;
+    while (result == HANDLE_SOCKETS_CONTINUE
+           && should_still_run(&group->status)) {
+        result = group_iteration(group, &run);
+    }
+    if (result == HANDLE_SOCKETS_ERROR) {
+        atomic_store(&group->status, ANJAY_EVENT_LOOP_IDLE);
+    }
+    AVS_LIST_CLEAR(&run.states) {
+        event_loop_state_cleanup(&run.states->state);
+    }
+#    ifndef EVENT_LOOP_USE_SELECT
+    avs_free(run.pollfds);
+#    endif // EVENT_LOOP_USE_SELECT
+    return result == HANDLE_SOCKETS_ERROR ? -1 : 0;
+}
+
+int anjay_event_loop_group_interrupt(anjay_event_loop_group_t *group) {
+    return atomic_compare_exchange_strong(&group->status,
+                                          &(int) { ANJAY_EVENT_LOOP_RUNNING },
+                                          ANJAY_EVENT_LOOP_INTERRUPT)
+                   ? 0
+                   : -1;
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/core/event_loop.c"
+#    endif // ANJAY_TEST
+
 #endif // ANJAY_WITH_EVENT_LOOP
@@ -161,6 +161,47 @@ int anjay_ret_bytes(anjay_output_ctx_t *ctx, const void *data, size_t length) {
     return result;
 }
 
+int _anjay_ret_bytes_borrowed_unlocked(anjay_unlocked_output_ctx_t *ctx,
+                                       const void *data,
+                                       size_t length,
+                                       anjay_ret_bytes_release_t *release,
+                                       void *release_arg) {
+    int result;
+    if (ctx->vtable->bytes_borrowed) {
+        result = ctx->vtable->bytes_borrowed(ctx, data, length, release,
+                                             release_arg);
+        _anjay_update_ret(&ctx->error, result);
+        if (!result) {
+            return 0;
+        }
+    } else {
+        // the data is copied or serialized right away
+        result = _anjay_ret_bytes_unlocked(ctx, data, length);
+    }
+    if (release) {
+        release(release_arg);
+    }
+    return result;
+}
+
+int anjay_ret_bytes_borrowed(anjay_output_ctx_t *ctx,
+                             const void *data,
+                             size_t length,
+                             anjay_ret_bytes_release_t *release,
+                             void *release_arg) {
+    int result = -1;
+#ifdef ANJAY_WITH_THREAD_SAFETY
+    ANJAY_MUTEX_LOCK(anjay, ctx->anjay_locked);
+#endif // ANJAY_WITH_THREAD_SAFETY
+    result = _anjay_ret_bytes_borrowed_unlocked(_anjay_output_get_unlocked(ctx),
+                                                data, length, release,
+                                                release_arg);
+#ifdef ANJAY_WITH_THREAD_SAFETY
+    ANJAY_MUTEX_UNLOCK(ctx->anjay_locked);
+#endif // ANJAY_WITH_THREAD_SAFETY
+    return result;
+}
+
 int _anjay_ret_string_unlocked(anjay_unlocked_output_ctx_t *ctx,
                                const char *value) {
     int result = ANJAY_OUTCTXERR_METHOD_NOT_IMPLEMENTED;
@@ -425,6 +466,17 @@ int _anjay_output_set_time(anjay_unlocked_output_ctx_t *ctx, double value) {
     return result;
 }
 
+int _anjay_output_set_relative_time(anjay_unlocked_output_ctx_t *ctx,
+                                    double base_value,
+                                    double offset) {
+    if (!ctx->vtable->set_relative_time) {
+        return _anjay_output_set_time(ctx, base_value + offset);
+    }
+    int result = ctx->vtable->set_relative_time(ctx, base_value, offset);
+    _anjay_update_ret(&ctx->error, result);
+    return result;
+}
+
 int _anjay_output_ctx_destroy(anjay_unlocked_output_ctx_t **ctx_ptr) {
     anjay_unlocked_output_ctx_t *ctx = *ctx_ptr;
     int result = 0;
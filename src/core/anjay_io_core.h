@@ -186,6 +186,12 @@ anjay_unlocked_output_ctx_t *_anjay_output_text_create(avs_stream_t *stream);
 anjay_unlocked_output_ctx_t *_anjay_output_cbor_create(avs_stream_t *stream);
 #endif // ANJAY_WITH_CBOR
 
+#ifdef ANJAY_WITH_LWM2M_CBOR
+anjay_unlocked_output_ctx_t *
+_anjay_output_lwm2m_cbor_create(avs_stream_t *stream,
+                                const anjay_uri_path_t *uri);
+#endif // ANJAY_WITH_LWM2M_CBOR
+
 #ifndef ANJAY_WITHOUT_TLV
 anjay_unlocked_output_ctx_t *
 _anjay_output_tlv_create(avs_stream_t *stream, const anjay_uri_path_t *uri);
@@ -233,6 +239,15 @@ int _anjay_output_clear_path(anjay_unlocked_output_ctx_t *ctx);
 
 int _anjay_output_set_time(anjay_unlocked_output_ctx_t *ctx, double value);
 
+/**
+ * Equivalent to <c>_anjay_output_set_time(ctx, base_value + offset)</c>, but
+ * allows SenML-based formats to encode @p base_value as Base Time shared with
+ * the subsequent elements, and only @p offset as Time.
+ */
+int _anjay_output_set_relative_time(anjay_unlocked_output_ctx_t *ctx,
+                                    double base_value,
+                                    double offset);
+
 /**
  * @returns Code of the FIRST known error encountered on this output context,
  *          in the following precedence order:
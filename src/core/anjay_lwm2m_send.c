@@ -12,7 +12,9 @@
 #ifdef ANJAY_WITH_LWM2M11
 
 #    include <inttypes.h>
+#    include <string.h>
 
+#    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_stream_membuf.h>
 #    include <avsystem/commons/avs_utils.h>
 
@@ -21,6 +23,8 @@
 
 #    include <anjay/lwm2m_send.h>
 
+#    include <anjay_modules/anjay_memory_accounting.h>
+
 #    include "anjay_access_utils_private.h"
 #    include "anjay_core.h"
 #    include "anjay_io_core.h"
@@ -71,13 +75,46 @@ cast_to_const_send_batch(const anjay_batch_t *batch) {
     return (const anjay_send_batch_t *) batch;
 }
 
+typedef struct {
+    uint16_t content_format;
+    void *data;
+    size_t size;
+} send_shared_payload_t;
+
+/**
+ * State shared by the entries created by a single anjay_send_to_servers()
+ * call. The payload is serialized at most once per Content-Format and reused
+ * for all such entries for which it would be serialized identically.
+ */
+typedef struct {
+    size_t ref_count;
+    AVS_LIST(send_shared_payload_t) payloads;
+} send_group_t;
+
 typedef struct {
     avs_coap_exchange_id_t id;
     avs_stream_t *memstream;
+    /**
+     * Payload serialized in advance, used instead of memstream and out_ctx if
+     * not NULL. Owned by anjay_send_entry_t::group.
+     */
+    const send_shared_payload_t *shared_payload;
     anjay_unlocked_output_ctx_t *out_ctx;
     size_t expected_offset;
     avs_time_real_t serialization_time;
     const anjay_batch_data_output_state_t *output_state;
+    /**
+     * Entry whose batch is currently being serialized - either the one that
+     * owns the exchange, or one of the entries coalesced into it.
+     */
+    anjay_send_entry_t *current;
+#        ifdef ANJAY_WITH_OPERATION_STATS
+    avs_time_monotonic_t start_time;
+    avs_time_duration_t handler_time;
+#        endif // ANJAY_WITH_OPERATION_STATS
+#        ifdef ANJAY_WITH_TRAFFIC_STATS
+    uint16_t content_format;
+#        endif // ANJAY_WITH_TRAFFIC_STATS
 } exchange_status_t;
 
 struct anjay_send_entry {
@@ -86,21 +123,318 @@ struct anjay_send_entry {
     void *finished_handler_data;
     anjay_ssid_t target_ssid;
     bool deferrable;
+    anjay_send_priority_t priority;
     anjay_batch_t *payload_batch;
+    /**
+     * Group of requests for multiple servers this entry belongs to, or NULL.
+     */
+    send_group_t *group;
+    /**
+     * Estimated size of the payload_batch serialized on its own, used to limit
+     * the size of coalesced messages. Zero if not calculated yet.
+     */
+    size_t estimated_payload_size;
+    /**
+     * Entries whose batches are sent in the same message, after this entry's
+     * own one. Only the first entry of such a group is stored in
+     * anjay_sender_t::entries and has its exchange_status filled.
+     */
+    AVS_LIST(anjay_send_entry_t) coalesced;
     exchange_status_t exchange_status;
+#        ifdef ANJAY_WITH_SEND_PERSISTENCE
+    /**
+     * Whether the request is stored in anjay_sender_t::log. If so,
+     * payload_batch may be NULL, which means that it needs to be read back from
+     * the log before sending.
+     */
+    bool persisted;
+    anjay_send_log_record_t log_record;
+    /**
+     * Size of payload_batch accounted in anjay_sender_t::ram_size.
+     */
+    size_t ram_size;
+#        endif // ANJAY_WITH_SEND_PERSISTENCE
+};
+
+struct anjay_send_rate_bucket {
+    anjay_ssid_t ssid;
+    /**
+     * Number of bytes that may currently be sent. May be negative after
+     * sending urgent requests, which are never held back.
+     */
+    double tokens;
+    avs_time_monotonic_t last_refill;
 };
 
+void _anjay_send_init(anjay_sender_t *sender,
+                      avs_time_duration_t coalescing_window,
+                      size_t coalescing_max_payload_size,
+                      size_t rate_limit,
+                      size_t rate_limit_burst) {
+    *sender = (anjay_sender_t) {
+        .coalescing_window = coalescing_window,
+        .coalescing_max_payload_size = coalescing_max_payload_size,
+        .rate_limit = rate_limit,
+        .rate_limit_burst = rate_limit_burst ? rate_limit_burst : rate_limit
+    };
+}
+
+static bool coalescing_enabled(const anjay_sender_t *sender) {
+    return avs_time_duration_less(AVS_TIME_DURATION_ZERO,
+                                  sender->coalescing_window);
+}
+
+static bool rate_limit_enabled(const anjay_sender_t *sender) {
+    return sender->rate_limit > 0;
+}
+
+static anjay_send_rate_bucket_t *get_rate_bucket(anjay_sender_t *sender,
+                                                 anjay_ssid_t ssid) {
+    AVS_LIST(anjay_send_rate_bucket_t) bucket;
+    AVS_LIST_FOREACH(bucket, sender->rate_buckets) {
+        if (bucket->ssid == ssid) {
+            return bucket;
+        }
+    }
+    if (!(bucket = AVS_LIST_NEW_ELEMENT(anjay_send_rate_bucket_t))) {
+        _anjay_log_oom();
+        return NULL;
+    }
+    bucket->ssid = ssid;
+    bucket->tokens = (double) sender->rate_limit_burst;
+    bucket->last_refill = avs_time_monotonic_now();
+    AVS_LIST_INSERT(&sender->rate_buckets, bucket);
+    return bucket;
+}
+
+/**
+ * Takes tokens for sending @p size bytes to server @p ssid from its bucket.
+ *
+ * If there are not enough tokens, nothing is taken and the time after which
+ * there will be is returned. A message larger than the bucket capacity is
+ * allowed once the bucket is full. If @p force is true, the tokens are taken
+ * unconditionally, possibly making the balance negative.
+ *
+ * @returns Zero duration if the message may be sent now.
+ */
+static avs_time_duration_t take_rate_tokens(anjay_sender_t *sender,
+                                            anjay_ssid_t ssid,
+                                            size_t size,
+                                            bool force) {
+    anjay_send_rate_bucket_t *bucket = get_rate_bucket(sender, ssid);
+    if (!bucket) {
+        // better send too much than hold the requests back forever
+        return AVS_TIME_DURATION_ZERO;
+    }
+    const double capacity = (double) sender->rate_limit_burst;
+    const avs_time_monotonic_t now = avs_time_monotonic_now();
+    bucket->tokens = AVS_MIN(
+            capacity,
+            bucket->tokens
+                    + avs_time_duration_to_fscalar(
+                              avs_time_monotonic_diff(now, bucket->last_refill),
+                              AVS_TIME_S)
+                              * (double) sender->rate_limit);
+    bucket->last_refill = now;
+
+    // SIZE_MAX means that the size could not be estimated
+    const double cost = size == SIZE_MAX ? capacity : (double) size;
+    const double needed = AVS_MIN(cost, capacity);
+    if (!force && bucket->tokens < needed) {
+        return avs_time_duration_from_fscalar(
+                (needed - bucket->tokens) / (double) sender->rate_limit,
+                AVS_TIME_S);
+    }
+    bucket->tokens -= cost;
+    return AVS_TIME_DURATION_ZERO;
+}
+
+static bool exchange_started(const exchange_status_t *status) {
+    return status->memstream || status->shared_payload;
+}
+
 static void clear_exchange_status(exchange_status_t *status) {
     assert(!avs_coap_exchange_id_valid(status->id));
     _anjay_output_ctx_destroy(&status->out_ctx);
     avs_stream_cleanup(&status->memstream);
+    status->shared_payload = NULL;
     status->output_state = NULL;
+    status->current = NULL;
+}
+
+#        ifdef ANJAY_WITH_SEND_PERSISTENCE
+static void forget_batch_in_ram(anjay_send_entry_t *entry) {
+    anjay_sender_t *sender = &entry->anjay->sender;
+    assert(sender->ram_size >= entry->ram_size);
+    sender->ram_size -= entry->ram_size;
+    entry->ram_size = 0;
+}
+
+static void account_batch_in_ram(anjay_send_entry_t *entry) {
+    assert(!entry->ram_size);
+    entry->ram_size = _anjay_batch_memory_size(entry->payload_batch);
+    entry->anjay->sender.ram_size += entry->ram_size;
+}
+
+static void update_oldest_offset(const size_t **oldest_offset_ptr,
+                                 const anjay_send_entry_t *entry) {
+    if (entry->persisted
+            && (!*oldest_offset_ptr
+                || entry->log_record.offset < **oldest_offset_ptr)) {
+        *oldest_offset_ptr = &entry->log_record.offset;
+    }
+}
+
+static void compact_send_log(anjay_sender_t *sender) {
+    const size_t *oldest_offset = NULL;
+    AVS_LIST(anjay_send_entry_t) entry;
+    AVS_LIST_FOREACH(entry, sender->entries) {
+        update_oldest_offset(&oldest_offset, entry);
+        AVS_LIST(anjay_send_entry_t) it;
+        AVS_LIST_FOREACH(it, entry->coalesced) {
+            update_oldest_offset(&oldest_offset, it);
+        }
+    }
+    // on failure, compaction will be retried when the next entry is discarded
+    (void) _anjay_send_log_compact(&sender->log, oldest_offset);
+}
+
+static void discard_persisted_entry(anjay_send_entry_t *entry) {
+    anjay_sender_t *sender = &entry->anjay->sender;
+    assert(entry->persisted);
+    entry->persisted = false;
+    if (_anjay_send_log_mark_discarded(&sender->log, &entry->log_record)) {
+        send_log(WARNING,
+                 _("could not remove Send request ") "%" PRIu32 _(
+                         " from the log, it may be sent again after restart"),
+                 entry->log_record.id);
+    }
+    compact_send_log(sender);
+}
+
+/**
+ * Releases the batches of the most recently persisted deferred requests, until
+ * the ones kept in RAM fit in the configured limit. The oldest ones are kept,
+ * as they are going to be sent first.
+ */
+static void limit_batches_in_ram(anjay_sender_t *sender) {
+    while (sender->ram_size > sender->max_ram_size) {
+        anjay_send_entry_t *newest = NULL;
+        AVS_LIST(anjay_send_entry_t) it;
+        AVS_LIST_FOREACH(it, sender->entries) {
+            if (it->persisted && it->payload_batch && !it->coalesced
+                    && !exchange_started(&it->exchange_status)
+                    && (!newest
+                        || it->log_record.offset
+                                   > newest->log_record.offset)) {
+                newest = it;
+            }
+        }
+        if (!newest) {
+            break;
+        }
+        _anjay_batch_release(&newest->payload_batch);
+        forget_batch_in_ram(newest);
+    }
+}
+
+static void persist_send_entry(anjay_send_entry_t *entry) {
+    anjay_sender_t *sender = &entry->anjay->sender;
+    assert(!entry->persisted);
+    if (_anjay_send_log_append(&sender->log, entry->target_ssid,
+                               entry->payload_batch, &entry->log_record)) {
+        send_log(WARNING, _("could not persist deferred Send request, it will "
+                            "only be kept in RAM"));
+        return;
+    }
+    entry->persisted = true;
+    account_batch_in_ram(entry);
+    limit_batches_in_ram(sender);
+}
+#        endif // ANJAY_WITH_SEND_PERSISTENCE
+
+/**
+ * Makes sure that the batch of @p entry is in RAM before sending it, reading
+ * it back from the persistent log if necessary.
+ */
+static int ensure_batch_loaded(anjay_send_entry_t *entry) {
+#        ifdef ANJAY_WITH_SEND_PERSISTENCE
+    if (!entry->payload_batch && entry->persisted) {
+        if (_anjay_send_log_read(&entry->anjay->sender.log, &entry->log_record,
+                                 &entry->payload_batch)) {
+            return -1;
+        }
+        account_batch_in_ram(entry);
+    }
+#        else  // ANJAY_WITH_SEND_PERSISTENCE
+    (void) entry;
+#        endif // ANJAY_WITH_SEND_PERSISTENCE
+    return 0;
+}
+
+static void entry_added(anjay_sender_t *sender) {
+    if (++sender->entry_count >= sender->low_watermark
+            && sender->watermark_handler) {
+        sender->watermark_reached = true;
+    }
+}
+
+static void watermark_job(avs_sched_t *sched, const void *dummy) {
+    (void) dummy;
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    anjay_send_queue_watermark_handler_t *handler = NULL;
+    void *handler_arg = NULL;
+    size_t queued_count = 0;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    handler = anjay->sender.watermark_handler;
+    handler_arg = anjay->sender.watermark_handler_arg;
+    queued_count = anjay->sender.entry_count;
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    if (handler) {
+        handler(anjay_locked, queued_count, handler_arg);
+    }
+}
+
+static void entry_removed(anjay_unlocked_t *anjay) {
+    anjay_sender_t *sender = &anjay->sender;
+    assert(sender->entry_count);
+    if (--sender->entry_count < sender->low_watermark
+            && sender->watermark_reached) {
+        sender->watermark_reached = false;
+        if (!sender->watermark_handle
+                && AVS_SCHED_NOW(anjay->sched, &sender->watermark_handle,
+                                 watermark_job, NULL, 0)) {
+            send_log(ERROR, _("could not schedule Send queue watermark job"));
+        }
+    }
+}
+
+static void release_send_group(send_group_t **group_ptr) {
+    if (*group_ptr && !--(*group_ptr)->ref_count) {
+        AVS_LIST_CLEAR(&(*group_ptr)->payloads) {
+            avs_free((*group_ptr)->payloads->data);
+        }
+        avs_free(*group_ptr);
+    }
+    *group_ptr = NULL;
 }
 
 static void delete_send_entry(AVS_LIST(anjay_send_entry_t) *entry) {
+    anjay_unlocked_t *anjay = (*entry)->anjay;
+    while ((*entry)->coalesced) {
+        delete_send_entry(&(*entry)->coalesced);
+    }
+#        ifdef ANJAY_WITH_SEND_PERSISTENCE
+    forget_batch_in_ram(*entry);
+    if ((*entry)->persisted) {
+        discard_persisted_entry(*entry);
+    }
+#        endif // ANJAY_WITH_SEND_PERSISTENCE
     _anjay_batch_release(&(*entry)->payload_batch);
     clear_exchange_status(&(*entry)->exchange_status);
+    release_send_group(&(*entry)->group);
     AVS_LIST_DELETE(entry);
+    entry_removed(anjay);
 }
 
 static avs_error_t setup_send_options(avs_coap_options_t *options,
@@ -127,6 +461,20 @@ static int request_payload_writer(size_t payload_offset,
                                   size_t *out_payload_chunk_size,
                                   void *entry_) {
     anjay_send_entry_t *entry = (anjay_send_entry_t *) entry_;
+    ANJAY_TRACEPOINT(payload_block, entry->target_ssid,
+                     (int) ANJAY_OPERATION_SEND, payload_offset);
+    const send_shared_payload_t *shared = entry->exchange_status.shared_payload;
+    if (shared) {
+        // the whole payload is already serialized, so any chunk can be served
+        const size_t offset = AVS_MIN(payload_offset, shared->size);
+        *out_payload_chunk_size = AVS_MIN(payload_buf_size,
+                                          shared->size - offset);
+        if (*out_payload_chunk_size) {
+            memcpy(payload_buf, (const char *) shared->data + offset,
+                   *out_payload_chunk_size);
+        }
+        return 0;
+    }
     if (payload_offset != entry->exchange_status.expected_offset) {
         send_log(DEBUG,
                  _("Server requested unexpected chunk of payload (expected "
@@ -153,12 +501,17 @@ static int request_payload_writer(size_t payload_offset,
         if (write_ptr >= end_ptr || !entry->exchange_status.out_ctx) {
             break;
         }
+        anjay_send_entry_t *current = entry->exchange_status.current;
         int result = _anjay_batch_data_output_entry(
-                entry->anjay, entry->payload_batch, entry->target_ssid,
+                entry->anjay, current->payload_batch, entry->target_ssid,
                 entry->exchange_status.serialization_time,
                 &entry->exchange_status.output_state,
                 entry->exchange_status.out_ctx);
-        if (!result && !entry->exchange_status.output_state) {
+        // when done with one batch, continue with the next coalesced one
+        if (!result && !entry->exchange_status.output_state
+                && !(entry->exchange_status.current =
+                             (current == entry ? entry->coalesced
+                                               : AVS_LIST_NEXT(current)))) {
             result = _anjay_output_ctx_destroy_and_process_result(
                     &entry->exchange_status.out_ctx, result);
         }
@@ -189,6 +542,47 @@ static void call_finished_handler(anjay_send_entry_t *entry, int result) {
     ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
 }
 
+static bool has_finished_handlers(const anjay_send_entry_t *entry) {
+    if (entry->finished_handler) {
+        return true;
+    }
+    AVS_LIST(anjay_send_entry_t) it;
+    AVS_LIST_FOREACH(it, entry->coalesced) {
+        if (it->finished_handler) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void call_finished_handlers(anjay_send_entry_t *entry, int result) {
+    call_finished_handler(entry, result);
+    AVS_LIST(anjay_send_entry_t) it;
+    AVS_LIST_FOREACH(it, entry->coalesced) {
+        call_finished_handler(it, result);
+    }
+}
+
+#        ifdef ANJAY_WITH_OPERATION_STATS
+static void
+record_send_stats(anjay_send_entry_t *entry,
+                  avs_coap_client_request_state_t state,
+                  const avs_coap_client_async_response_t *response) {
+    if (state == AVS_COAP_CLIENT_REQUEST_CANCEL) {
+        // either aborted locally, or a follow-up of PARTIAL_CONTENT that has
+        // already been accounted for
+        return;
+    }
+    _anjay_operation_stats_record(
+            entry->anjay, entry->target_ssid, ANJAY_OPERATION_SEND,
+            entry->exchange_status.handler_time,
+            avs_time_monotonic_diff(avs_time_monotonic_now(),
+                                    entry->exchange_status.start_time),
+            state == AVS_COAP_CLIENT_REQUEST_FAIL
+                    || response->header.code != AVS_COAP_CODE_CHANGED);
+}
+#        endif // ANJAY_WITH_OPERATION_STATS
+
 static void response_handler(avs_coap_ctx_t *ctx,
                              avs_coap_exchange_id_t exchange_id,
                              avs_coap_client_request_state_t state,
@@ -198,6 +592,14 @@ static void response_handler(avs_coap_ctx_t *ctx,
     anjay_send_entry_t *entry = (anjay_send_entry_t *) entry_;
     assert(entry);
     assert(avs_coap_exchange_id_equal(exchange_id, entry->exchange_status.id));
+#        ifdef ANJAY_WITH_OPERATION_STATS
+    record_send_stats(entry, state, response);
+#        endif // ANJAY_WITH_OPERATION_STATS
+    if (state != AVS_COAP_CLIENT_REQUEST_CANCEL) {
+        ANJAY_TRAFFIC_STATS_SET_INCOMING(entry->anjay, ANJAY_OPERATION_SEND,
+                                         entry->exchange_status.content_format,
+                                         ANJAY_ID_INVALID);
+    }
     if (avs_is_ok(err)) {
         anjay_server_info_t *server =
                 _anjay_servers_find_active(entry->anjay, entry->target_ssid);
@@ -208,7 +610,7 @@ static void response_handler(avs_coap_ctx_t *ctx,
             });
         }
     }
-    if (entry->finished_handler) {
+    if (has_finished_handlers(entry)) {
         static const int STATE_TO_RESULT[] = {
             [AVS_COAP_CLIENT_REQUEST_OK] = ANJAY_SEND_SUCCESS,
             [AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT] = ANJAY_SEND_SUCCESS,
@@ -225,7 +627,7 @@ static void response_handler(avs_coap_ctx_t *ctx,
                          _("Unexpected payload received in response to Send"));
             }
         }
-        call_finished_handler(entry, result);
+        call_finished_handlers(entry, result);
     }
     if (state == AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT) {
         // We don't want/need to read the rest of the content, so we cancel the
@@ -243,10 +645,30 @@ static void response_handler(avs_coap_ctx_t *ctx,
     }
 }
 
+/**
+ * Inserts @p entry into the sender's list, which is sorted by SSID and then by
+ * descending priority, so that the more urgent deferred requests are sent
+ * first. Requests of the same priority are kept in FIFO order.
+ */
+static AVS_LIST(anjay_send_entry_t) *
+insert_send_entry(anjay_sender_t *sender, AVS_LIST(anjay_send_entry_t) entry) {
+    AVS_LIST(anjay_send_entry_t) *insert_ptr = &sender->entries;
+    while (*insert_ptr
+           && ((*insert_ptr)->target_ssid < entry->target_ssid
+               || ((*insert_ptr)->target_ssid == entry->target_ssid
+                   && (*insert_ptr)->priority >= entry->priority))) {
+        AVS_LIST_ADVANCE_PTR(&insert_ptr);
+    }
+    AVS_LIST_INSERT(insert_ptr, entry);
+    return insert_ptr;
+}
+
 static AVS_LIST(anjay_send_entry_t) *
 create_exchange(anjay_unlocked_t *anjay,
                 anjay_ssid_t target_ssid,
                 bool deferrable,
+                anjay_send_priority_t priority,
+                send_group_t *group,
                 anjay_send_finished_handler_t *finished_handler,
                 void *finished_handler_data,
                 const anjay_send_batch_t *batch) {
@@ -267,21 +689,136 @@ create_exchange(anjay_unlocked_t *anjay,
     entry->finished_handler_data = finished_handler_data;
     entry->target_ssid = target_ssid;
     entry->deferrable = deferrable;
+    entry->priority = priority;
     entry->payload_batch = payload_batch;
+    if (group) {
+        ++group->ref_count;
+        entry->group = group;
+    }
+    entry_added(&anjay->sender);
+    return insert_send_entry(&anjay->sender, entry);
+}
 
-    AVS_LIST(anjay_send_entry_t) *insert_ptr = &anjay->sender.entries;
-    while (*insert_ptr && (*insert_ptr)->target_ssid < target_ssid) {
-        AVS_LIST_ADVANCE_PTR(&insert_ptr);
+static uint16_t send_content_format(anjay_connection_ref_t connection) {
+    (void) connection;
+    return
+#        if defined(ANJAY_DEFAULT_SEND_FORMAT) \
+                && ANJAY_DEFAULT_SEND_FORMAT != AVS_COAP_FORMAT_NONE
+            ANJAY_DEFAULT_SEND_FORMAT
+#        else  // defined(ANJAY_DEFAULT_SEND_FORMAT)
+               // && ANJAY_DEFAULT_SEND_FORMAT != AVS_COAP_FORMAT_NONE
+            _anjay_default_hierarchical_format(
+                    _anjay_server_registration_info(connection.server)
+                            ->lwm2m_version)
+#        endif // defined(ANJAY_DEFAULT_SEND_FORMAT)
+               // && ANJAY_DEFAULT_SEND_FORMAT != AVS_COAP_FORMAT_NONE
+            ;
+}
+
+static int
+coalesced_item_count(anjay_send_entry_t *entry, size_t *out_item_count) {
+    size_t item_count;
+    if (_anjay_batch_outputable_item_count(entry->anjay, entry->payload_batch,
+                                           entry->target_ssid, &item_count)) {
+        return -1;
     }
-    AVS_LIST_INSERT(insert_ptr, entry);
+    AVS_LIST(anjay_send_entry_t) it;
+    AVS_LIST_FOREACH(it, entry->coalesced) {
+        size_t count;
+        if (_anjay_batch_outputable_item_count(entry->anjay, it->payload_batch,
+                                               entry->target_ssid, &count)) {
+            return -1;
+        }
+        item_count += count;
+    }
+    *out_item_count = item_count;
+    return 0;
+}
 
-    return insert_ptr;
+static int serialize_shared_payload(anjay_send_entry_t *entry,
+                                    send_shared_payload_t *payload) {
+    anjay_uri_path_t base_path = MAKE_ROOT_PATH();
+    _anjay_batch_update_common_path_prefix(&(const anjay_uri_path_t *) { NULL },
+                                           &base_path, entry->payload_batch);
+    size_t item_count;
+    avs_stream_t *memstream = avs_stream_membuf_create();
+    if (!memstream) {
+        _anjay_log_oom();
+        return -1;
+    }
+    anjay_unlocked_output_ctx_t *out_ctx = NULL;
+    int result = _anjay_output_dynamic_send_construct(
+            &out_ctx, memstream, &base_path, payload->content_format,
+            coalesced_item_count(entry, &item_count) ? NULL : &item_count);
+    if (!result) {
+        result = _anjay_batch_data_output(entry->anjay, entry->payload_batch,
+                                          entry->target_ssid, out_ctx);
+    }
+    if (!(result = _anjay_output_ctx_destroy_and_process_result(&out_ctx,
+                                                                result))
+            && avs_is_err(avs_stream_membuf_take_ownership(
+                       memstream, &payload->data, &payload->size))) {
+        result = -1;
+    }
+    avs_stream_cleanup(&memstream);
+    return result;
+}
+
+/**
+ * Returns the payload for @p entry serialized in advance, serializing it first
+ * if necessary, or NULL if the entry needs to be serialized on its own.
+ */
+static const send_shared_payload_t *
+get_shared_payload(anjay_send_entry_t *entry, uint16_t content_format) {
+    if (!entry->group || entry->coalesced
+            || !_anjay_batch_serialization_shareable(entry->anjay,
+                                                     entry->payload_batch,
+                                                     entry->target_ssid)) {
+        return NULL;
+    }
+    AVS_LIST(send_shared_payload_t) *payload_ptr;
+    AVS_LIST_FOREACH_PTR(payload_ptr, &entry->group->payloads) {
+        if ((*payload_ptr)->content_format == content_format) {
+            return *payload_ptr;
+        }
+    }
+    if (!(*payload_ptr = AVS_LIST_NEW_ELEMENT(send_shared_payload_t))) {
+        _anjay_log_oom();
+        return NULL;
+    }
+    (*payload_ptr)->content_format = content_format;
+    if (serialize_shared_payload(entry, *payload_ptr)) {
+        send_log(WARNING, _("could not serialize shared Send payload"));
+        AVS_LIST_DELETE(payload_ptr);
+        return NULL;
+    }
+    return *payload_ptr;
+}
+
+static avs_error_t send_request(avs_coap_ctx_t *coap,
+                                anjay_connection_ref_t connection,
+                                anjay_send_entry_t *entry,
+                                const avs_coap_request_header_t *request) {
+    (void) connection;
+    ANJAY_ALLOCATION_SITE_ENTER(prev_site);
+    ANJAY_TRAFFIC_STATS_BEGIN(traffic_snapshot,
+                              _anjay_connection_get_online_socket(connection));
+    avs_error_t err = avs_coap_client_send_async_request(
+            coap, &entry->exchange_status.id, request, request_payload_writer,
+            entry, response_handler, entry);
+    ANJAY_TRAFFIC_STATS_END(entry->anjay, traffic_snapshot,
+                            _anjay_connection_get_online_socket(connection),
+                            ANJAY_OPERATION_SEND,
+                            entry->exchange_status.content_format,
+                            ANJAY_ID_INVALID);
+    ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
+    return err;
 }
 
 static avs_error_t start_send_exchange(anjay_send_entry_t *entry,
                                        anjay_connection_ref_t connection) {
     assert(!avs_coap_exchange_id_valid(entry->exchange_status.id));
-    assert(!entry->exchange_status.memstream);
+    assert(!exchange_started(&entry->exchange_status));
     assert(!entry->exchange_status.out_ctx);
     assert(!entry->exchange_status.output_state);
 
@@ -304,18 +841,10 @@ static avs_error_t start_send_exchange(anjay_send_entry_t *entry,
         return avs_errno(AVS_EBADF);
     }
 
-    uint16_t content_format =
-#        if defined(ANJAY_DEFAULT_SEND_FORMAT) \
-                && ANJAY_DEFAULT_SEND_FORMAT != AVS_COAP_FORMAT_NONE
-            ANJAY_DEFAULT_SEND_FORMAT
-#        else  // defined(ANJAY_DEFAULT_SEND_FORMAT)
-               // && ANJAY_DEFAULT_SEND_FORMAT != AVS_COAP_FORMAT_NONE
-            _anjay_default_hierarchical_format(
-                    _anjay_server_registration_info(connection.server)
-                            ->lwm2m_version)
-#        endif // defined(ANJAY_DEFAULT_SEND_FORMAT)
-               // && ANJAY_DEFAULT_SEND_FORMAT != AVS_COAP_FORMAT_NONE
-            ;
+#        ifdef ANJAY_WITH_OPERATION_STATS
+    entry->exchange_status.start_time = avs_time_monotonic_now();
+#        endif // ANJAY_WITH_OPERATION_STATS
+    uint16_t content_format = send_content_format(connection);
 
     const anjay_url_t *server_uri = _anjay_connection_uri(connection);
     assert(server_uri);
@@ -325,8 +854,14 @@ static avs_error_t start_send_exchange(anjay_send_entry_t *entry,
     };
 
     anjay_uri_path_t base_path = MAKE_ROOT_PATH();
-    _anjay_batch_update_common_path_prefix(&(const anjay_uri_path_t *) { NULL },
-                                           &base_path, entry->payload_batch);
+    const anjay_uri_path_t *base_path_ptr = NULL;
+    _anjay_batch_update_common_path_prefix(&base_path_ptr, &base_path,
+                                           entry->payload_batch);
+    AVS_LIST(anjay_send_entry_t) it;
+    AVS_LIST_FOREACH(it, entry->coalesced) {
+        _anjay_batch_update_common_path_prefix(&base_path_ptr, &base_path,
+                                               it->payload_batch);
+    }
 
     avs_error_t err;
     if (avs_is_err((err = avs_coap_options_dynamic_init(&request.options)))
@@ -336,15 +871,17 @@ static avs_error_t start_send_exchange(anjay_send_entry_t *entry,
         goto finish;
     }
 
+    entry->exchange_status.shared_payload =
+            get_shared_payload(entry, content_format);
     size_t item_count;
-    if (!(entry->exchange_status.memstream = avs_stream_membuf_create())
-            || (_anjay_output_dynamic_send_construct(
+    if (!entry->exchange_status.shared_payload
+            && (!(entry->exchange_status.memstream =
+                          avs_stream_membuf_create())
+                || _anjay_output_dynamic_send_construct(
                        &entry->exchange_status.out_ctx,
                        entry->exchange_status.memstream, &base_path,
                        content_format,
-                       _anjay_batch_outputable_item_count(
-                               entry->anjay, entry->payload_batch,
-                               entry->target_ssid, &item_count)
+                       coalesced_item_count(entry, &item_count)
                                ? NULL
                                : &item_count))) {
         send_log(ERROR, _("could not create output context"));
@@ -353,10 +890,21 @@ static avs_error_t start_send_exchange(anjay_send_entry_t *entry,
     }
     entry->exchange_status.expected_offset = 0;
     entry->exchange_status.serialization_time = avs_time_real_now();
-
-    err = avs_coap_client_send_async_request(coap, &entry->exchange_status.id,
-                                             &request, request_payload_writer,
-                                             entry, response_handler, entry);
+    entry->exchange_status.current = entry;
+#        ifdef ANJAY_WITH_TRAFFIC_STATS
+    entry->exchange_status.content_format = content_format;
+#        endif // ANJAY_WITH_TRAFFIC_STATS
+#        ifdef ANJAY_WITH_OPERATION_STATS
+    _anjay_operation_stats_record_format(entry->anjay, entry->target_ssid,
+                                         content_format);
+#        endif // ANJAY_WITH_OPERATION_STATS
+
+    err = send_request(coap, connection, entry, &request);
+#        ifdef ANJAY_WITH_OPERATION_STATS
+    entry->exchange_status.handler_time =
+            avs_time_monotonic_diff(avs_time_monotonic_now(),
+                                    entry->exchange_status.start_time);
+#        endif // ANJAY_WITH_OPERATION_STATS
     _anjay_connection_schedule_queue_mode_close(connection);
 finish:
     avs_coap_options_cleanup(&request.options);
@@ -430,13 +978,197 @@ check_send_possibility(anjay_unlocked_t *anjay,
     return ANJAY_SEND_OK;
 }
 
+static size_t add_saturated(size_t a, size_t b) {
+    return a > SIZE_MAX - b ? SIZE_MAX : a + b;
+}
+
+static size_t entry_payload_size(anjay_send_entry_t *entry,
+                                 uint16_t content_format) {
+    // batches only stored in the persistent log are not accounted for until
+    // they are loaded
+    if (!entry->estimated_payload_size && entry->payload_batch
+            && _anjay_batch_send_payload_size(
+                       entry->anjay, entry->payload_batch, entry->target_ssid,
+                       content_format, &entry->estimated_payload_size)) {
+        // make sure that the entry is not coalesced with any other one
+        entry->estimated_payload_size = SIZE_MAX;
+    }
+    return entry->estimated_payload_size;
+}
+
+static size_t group_payload_size(anjay_send_entry_t *entry,
+                                 uint16_t content_format) {
+    size_t size = entry_payload_size(entry, content_format);
+    AVS_LIST(anjay_send_entry_t) it;
+    AVS_LIST_FOREACH(it, entry->coalesced) {
+        size = add_saturated(size, entry_payload_size(it, content_format));
+    }
+    return size;
+}
+
+static size_t held_payload_size(anjay_unlocked_t *anjay,
+                                anjay_ssid_t ssid,
+                                uint16_t content_format) {
+    size_t size = 0;
+    AVS_LIST(anjay_send_entry_t) it;
+    AVS_LIST_FOREACH(it, anjay->sender.entries) {
+        if (it->target_ssid > ssid) {
+            break;
+        } else if (it->target_ssid == ssid
+                   && !exchange_started(&it->exchange_status)) {
+            size = add_saturated(size, group_payload_size(it, content_format));
+        }
+    }
+    return size;
+}
+
+/**
+ * Moves the entries directly following @p entry on the sender's list that are
+ * held back for the same server with the same priority into its
+ * <c>coalesced</c> list, as long as the estimated payload size limit, if
+ * configured, allows it.
+ */
+static void coalesce_held_entries(anjay_send_entry_t *entry,
+                                  uint16_t content_format) {
+    const size_t max_size = entry->anjay->sender.coalescing_max_payload_size;
+    size_t size = 0;
+    if (max_size) {
+        size = group_payload_size(entry, content_format);
+    }
+    AVS_LIST(anjay_send_entry_t) *next_ptr = AVS_LIST_NEXT_PTR(&entry);
+    while (*next_ptr && (*next_ptr)->target_ssid == entry->target_ssid
+           && (*next_ptr)->priority == entry->priority
+           && !exchange_started(&(*next_ptr)->exchange_status)) {
+        if (ensure_batch_loaded(*next_ptr)) {
+            // the entry will be cancelled when processed on its own
+            break;
+        }
+        if (max_size) {
+            size_t new_size = add_saturated(
+                    size, group_payload_size(*next_ptr, content_format));
+            if (new_size > max_size) {
+                break;
+            }
+            size = new_size;
+        }
+        AVS_LIST(anjay_send_entry_t) moved = AVS_LIST_DETACH(next_ptr);
+        AVS_LIST(anjay_send_entry_t) moved_coalesced = moved->coalesced;
+        moved->coalesced = NULL;
+        AVS_LIST_APPEND(&entry->coalesced, moved);
+        if (moved_coalesced) {
+            AVS_LIST_APPEND(&entry->coalesced, moved_coalesced);
+        }
+    }
+}
+
+static void retry_deferred_job(avs_sched_t *sched, const void *ssid_);
+
+/**
+ * Holds back a newly created entry so that it can be coalesced with further
+ * ones. All held entries are sent when the coalescing window expires, or
+ * earlier if the ones for @p connection no longer fit in the payload size
+ * limit.
+ */
+static int hold_for_coalescing(anjay_unlocked_t *anjay,
+                               anjay_connection_ref_t connection) {
+    anjay_sender_t *sender = &anjay->sender;
+    if (!sender->coalescing_flush_handle
+            && AVS_SCHED_DELAYED(anjay->sched,
+                                 &sender->coalescing_flush_handle,
+                                 sender->coalescing_window, retry_deferred_job,
+                                 &(const anjay_ssid_t) { ANJAY_SSID_ANY },
+                                 sizeof(anjay_ssid_t))) {
+        send_log(ERROR, _("could not schedule coalesced Send flush job"));
+        return -1;
+    }
+    anjay_ssid_t ssid = _anjay_server_ssid(connection.server);
+    if (sender->coalescing_max_payload_size
+            && held_payload_size(anjay, ssid, send_content_format(connection))
+                           >= sender->coalescing_max_payload_size) {
+        // if this fails, the entries will still be sent by the job above
+        _anjay_send_sched_retry_deferred(anjay, ssid);
+    }
+    return 0;
+}
+
+/**
+ * Schedules retrying the requests held back by the rate limiter after
+ * @p delay , unless it is already scheduled to happen earlier.
+ */
+static void sched_rate_limited_retry(anjay_unlocked_t *anjay,
+                                     avs_time_duration_t delay) {
+    anjay_sender_t *sender = &anjay->sender;
+    const avs_time_monotonic_t time =
+            avs_time_monotonic_add(avs_time_monotonic_now(), delay);
+    if (sender->rate_limit_handle
+            && !avs_time_monotonic_before(
+                       time, avs_sched_time(&sender->rate_limit_handle))) {
+        return;
+    }
+    avs_sched_del(&sender->rate_limit_handle);
+    if (AVS_SCHED_AT(anjay->sched, &sender->rate_limit_handle, time,
+                     retry_deferred_job,
+                     &(const anjay_ssid_t) { ANJAY_SSID_ANY },
+                     sizeof(anjay_ssid_t))) {
+        send_log(ERROR, _("could not schedule rate limited Send retry job"));
+    }
+}
+
+avs_time_real_t _anjay_send_next_planned_retry(anjay_unlocked_t *anjay) {
+    anjay_sender_t *sender = &anjay->sender;
+    avs_time_monotonic_t result = AVS_TIME_MONOTONIC_INVALID;
+    if (sender->coalescing_flush_handle) {
+        result = avs_sched_time(&sender->coalescing_flush_handle);
+    }
+    if (sender->rate_limit_handle
+            && (!avs_time_monotonic_valid(result)
+                || avs_time_monotonic_before(
+                           avs_sched_time(&sender->rate_limit_handle),
+                           result))) {
+        result = avs_sched_time(&sender->rate_limit_handle);
+    }
+    if (!avs_time_monotonic_valid(result)) {
+        return AVS_TIME_REAL_INVALID;
+    }
+    return avs_time_real_add(avs_time_real_now(),
+                             avs_time_monotonic_diff(result,
+                                                     avs_time_monotonic_now()));
+}
+
+/**
+ * Starts sending a newly created entry, or holds it back - for coalescing, or
+ * so that it is sent by retry_deferred_job() with the rate limit applied.
+ * Urgent requests are always sent immediately.
+ */
+static int send_or_hold(anjay_send_entry_t *entry,
+                        anjay_connection_ref_t connection) {
+    anjay_sender_t *sender = &entry->anjay->sender;
+    if (entry->priority == ANJAY_SEND_PRIORITY_URGENT) {
+        if (rate_limit_enabled(sender)) {
+            take_rate_tokens(sender, entry->target_ssid,
+                             entry_payload_size(entry,
+                                                send_content_format(
+                                                        connection)),
+                             true);
+        }
+    } else if (coalescing_enabled(sender)) {
+        return hold_for_coalescing(entry->anjay, connection);
+    } else if (rate_limit_enabled(sender)) {
+        return _anjay_send_sched_retry_deferred(entry->anjay,
+                                                entry->target_ssid);
+    }
+    return avs_is_err(start_send_exchange(entry, connection)) ? -1 : 0;
+}
+
 static anjay_send_result_t
-send_impl(anjay_unlocked_t *anjay,
-          anjay_ssid_t ssid,
-          bool deferrable,
-          const anjay_send_batch_t *data,
-          anjay_send_finished_handler_t *finished_handler,
-          void *finished_handler_data) {
+send_impl_untagged(anjay_unlocked_t *anjay,
+                   anjay_ssid_t ssid,
+                   bool deferrable,
+                   anjay_send_priority_t priority,
+                   send_group_t *group,
+                   const anjay_send_batch_t *data,
+                   anjay_send_finished_handler_t *finished_handler,
+                   void *finished_handler_data) {
     anjay_connection_ref_t ref = {
         .server = NULL
     };
@@ -447,30 +1179,52 @@ send_impl(anjay_unlocked_t *anjay,
     }
 
     AVS_LIST(anjay_send_entry_t) *entry_ptr =
-            create_exchange(anjay, ssid, deferrable, finished_handler,
-                            finished_handler_data, data);
+            create_exchange(anjay, ssid, deferrable, priority, group,
+                            finished_handler, finished_handler_data, data);
     if (!entry_ptr || !*entry_ptr) {
         return ANJAY_SEND_ERR_INTERNAL;
     }
 
     if (!should_defer) {
         assert(ref.server);
-        if (avs_is_err(start_send_exchange(*entry_ptr, ref))) {
+        if (send_or_hold(*entry_ptr, ref)) {
             delete_send_entry(entry_ptr);
             return ANJAY_SEND_ERR_INTERNAL;
         }
     }
+#        ifdef ANJAY_WITH_SEND_PERSISTENCE
+    if (should_defer && _anjay_send_log_enabled(&anjay->sender.log)) {
+        persist_send_entry(*entry_ptr);
+    }
+#        endif // ANJAY_WITH_SEND_PERSISTENCE
     return ANJAY_SEND_OK;
 }
 
+static anjay_send_result_t
+send_impl(anjay_unlocked_t *anjay,
+          anjay_ssid_t ssid,
+          bool deferrable,
+          anjay_send_priority_t priority,
+          send_group_t *group,
+          const anjay_send_batch_t *data,
+          anjay_send_finished_handler_t *finished_handler,
+          void *finished_handler_data) {
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_SEND);
+    anjay_send_result_t result =
+            send_impl_untagged(anjay, ssid, deferrable, priority, group, data,
+                               finished_handler, finished_handler_data);
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+    return result;
+}
+
 anjay_send_result_t
 _anjay_send_deferrable_unlocked(anjay_unlocked_t *anjay,
                                 anjay_ssid_t ssid,
                                 const anjay_send_batch_t *data,
                                 anjay_send_finished_handler_t *finished_handler,
                                 void *finished_handler_data) {
-    return send_impl(anjay, ssid, true, data, finished_handler,
-                     finished_handler_data);
+    return send_impl(anjay, ssid, true, ANJAY_SEND_PRIORITY_NORMAL, NULL, data,
+                     finished_handler, finished_handler_data);
 }
 
 anjay_send_result_t
@@ -495,8 +1249,123 @@ anjay_send_result_t anjay_send(anjay_t *anjay_locked,
                                void *finished_handler_data) {
     anjay_send_result_t result = ANJAY_SEND_ERR_INTERNAL;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    result = send_impl(anjay, ssid, false, data, finished_handler,
-                       finished_handler_data);
+    result = send_impl(anjay, ssid, false, ANJAY_SEND_PRIORITY_NORMAL, NULL,
+                       data, finished_handler, finished_handler_data);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+anjay_send_result_t
+anjay_send_with_priority(anjay_t *anjay_locked,
+                         anjay_ssid_t ssid,
+                         const anjay_send_batch_t *data,
+                         anjay_send_priority_t priority,
+                         bool deferrable,
+                         anjay_send_finished_handler_t *finished_handler,
+                         void *finished_handler_data) {
+    anjay_send_result_t result = ANJAY_SEND_ERR_INTERNAL;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    result = send_impl(anjay, ssid, deferrable, priority, NULL, data,
+                       finished_handler, finished_handler_data);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+typedef struct {
+    send_group_t *group;
+    const anjay_send_batch_t *data;
+    bool deferrable;
+    anjay_send_finished_handler_t *finished_handler;
+    void *finished_handler_data;
+    anjay_send_result_t result;
+} send_to_servers_args_t;
+
+static void send_to_server(anjay_unlocked_t *anjay,
+                           anjay_ssid_t ssid,
+                           send_to_servers_args_t *args) {
+    anjay_send_result_t result =
+            send_impl(anjay, ssid, args->deferrable, ANJAY_SEND_PRIORITY_NORMAL,
+                      args->group, args->data, args->finished_handler,
+                      args->finished_handler_data);
+    if (result != ANJAY_SEND_OK) {
+        send_log(WARNING, _("failed to perform Send, SSID: ") "%" PRIu16,
+                 ssid);
+        if (args->result == ANJAY_SEND_OK) {
+            args->result = result;
+        }
+    }
+}
+
+static int send_to_server_instance(anjay_unlocked_t *anjay,
+                                   const anjay_dm_installed_object_t *obj,
+                                   anjay_iid_t iid,
+                                   void *args) {
+    (void) obj;
+    anjay_ssid_t ssid;
+    if (!_anjay_dm_read_resource_u16(
+                anjay,
+                &MAKE_RESOURCE_PATH(ANJAY_DM_OID_SERVER, iid,
+                                    ANJAY_DM_RID_SERVER_SSID),
+                &ssid)) {
+        send_to_server(anjay, ssid, (send_to_servers_args_t *) args);
+    }
+    return 0;
+}
+
+anjay_send_result_t
+_anjay_send_to_servers_unlocked(anjay_unlocked_t *anjay,
+                                const anjay_ssid_t *ssids,
+                                size_t ssids_count,
+                                const anjay_send_batch_t *data,
+                                bool deferrable,
+                                anjay_send_finished_handler_t *finished_handler,
+                                void *finished_handler_data) {
+    send_to_servers_args_t args = {
+        .group = (send_group_t *) avs_calloc(1, sizeof(send_group_t)),
+        .data = data,
+        .deferrable = deferrable,
+        .finished_handler = finished_handler,
+        .finished_handler_data = finished_handler_data,
+        .result = ANJAY_SEND_OK
+    };
+    if (args.group) {
+        // reference held until all the entries are created
+        args.group->ref_count = 1;
+    } else {
+        // not fatal; the payload will be serialized for each server separately
+        _anjay_log_oom();
+    }
+    if (ssids) {
+        for (size_t i = 0; i < ssids_count; ++i) {
+            send_to_server(anjay, ssids[i], &args);
+        }
+    } else {
+        const anjay_dm_installed_object_t *obj =
+                _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_SERVER);
+        if (!obj
+                || _anjay_dm_foreach_instance(anjay, obj,
+                                              send_to_server_instance, &args)) {
+            send_log(ERROR, _("failed to perform Send to all servers"));
+            args.result = ANJAY_SEND_ERR_INTERNAL;
+        }
+    }
+    release_send_group(&args.group);
+    return args.result;
+}
+
+anjay_send_result_t
+anjay_send_to_servers(anjay_t *anjay_locked,
+                      const anjay_ssid_t *ssids,
+                      size_t ssids_count,
+                      const anjay_send_batch_t *data,
+                      bool deferrable,
+                      anjay_send_finished_handler_t *finished_handler,
+                      void *finished_handler_data) {
+    anjay_send_result_t result = ANJAY_SEND_ERR_INTERNAL;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    result = _anjay_send_to_servers_unlocked(anjay, ssids, ssids_count, data,
+                                             deferrable, finished_handler,
+                                             finished_handler_data);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return result;
 }
@@ -552,6 +1421,23 @@ int anjay_send_batch_add_double(anjay_send_batch_builder_t *builder,
                                    timestamp, value);
 }
 
+int anjay_send_batch_series_begin(anjay_send_batch_builder_t *builder,
+                                  anjay_oid_t oid,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  anjay_riid_t riid) {
+    return _anjay_batch_series_begin(cast_to_builder(builder),
+                                     &MAKE_RESOURCE_INSTANCE_PATH(oid, iid, rid,
+                                                                  riid));
+}
+
+int anjay_send_batch_series_add_double(anjay_send_batch_builder_t *builder,
+                                       avs_time_real_t timestamp,
+                                       double value) {
+    return _anjay_batch_series_add_double(cast_to_builder(builder), timestamp,
+                                          value);
+}
+
 int anjay_send_batch_add_bool(anjay_send_batch_builder_t *builder,
                               anjay_oid_t oid,
                               anjay_iid_t iid,
@@ -591,6 +1477,23 @@ int anjay_send_batch_add_bytes(anjay_send_batch_builder_t *builder,
                                   timestamp, data, length);
 }
 
+int anjay_send_batch_add_bytes_external(
+        anjay_send_batch_builder_t *builder,
+        anjay_oid_t oid,
+        anjay_iid_t iid,
+        anjay_rid_t rid,
+        anjay_riid_t riid,
+        avs_time_real_t timestamp,
+        const void *data,
+        size_t length,
+        anjay_send_batch_release_handler_t *release,
+        void *release_arg) {
+    return _anjay_batch_add_bytes_external(
+            cast_to_builder(builder),
+            &MAKE_RESOURCE_INSTANCE_PATH(oid, iid, rid, riid), timestamp, data,
+            length, release, release_arg);
+}
+
 int anjay_send_batch_add_objlnk(anjay_send_batch_builder_t *builder,
                                 anjay_oid_t oid,
                                 anjay_iid_t iid,
@@ -659,6 +1562,49 @@ int anjay_send_batch_data_add_current(anjay_send_batch_builder_t *builder,
     return result;
 }
 
+static size_t
+same_instance_run_length(const anjay_send_resource_path_t *paths,
+                         size_t paths_length) {
+    size_t length = 1;
+    while (length < paths_length && paths[length].oid == paths[0].oid
+           && paths[length].iid == paths[0].iid) {
+        ++length;
+    }
+    return length;
+}
+
+/**
+ * Announces the Resources in a run of paths referring to a single Object
+ * Instance through the resource_read_many handler, if the Object implements
+ * it. Nonexistent Objects and Instances are ignored here; they are reported
+ * when reading the individual paths.
+ */
+static int read_many_prepare(anjay_unlocked_t *anjay,
+                             const anjay_send_resource_path_t *paths,
+                             size_t run_length) {
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(anjay, paths[0].oid);
+    if (!obj || paths[0].iid == ANJAY_ID_INVALID
+            || !_anjay_dm_handler_implemented(
+                       obj, ANJAY_DM_HANDLER_resource_read_many)
+            || _anjay_dm_instance_present(anjay, obj, paths[0].iid) <= 0) {
+        return 0;
+    }
+    anjay_rid_t *rids =
+            (anjay_rid_t *) avs_malloc(run_length * sizeof(*rids));
+    if (!rids) {
+        _anjay_log_oom();
+        return -1;
+    }
+    for (size_t i = 0; i < run_length; ++i) {
+        rids[i] = paths[i].rid;
+    }
+    int result = _anjay_dm_call_resource_read_many(anjay, obj, paths[0].iid,
+                                                   rids, run_length);
+    avs_free(rids);
+    return result;
+}
+
 int _anjay_send_batch_data_add_current_multiple_unlocked(
         anjay_send_batch_builder_t *builder,
         anjay_unlocked_t *anjay,
@@ -669,10 +1615,24 @@ int _anjay_send_batch_data_add_current_multiple_unlocked(
     assert(anjay);
 
     anjay_batch_builder_t *batch_builder = cast_to_builder(builder);
-    AVS_LIST(anjay_batch_entry_t) *append_ptr = batch_builder->append_ptr;
+    const anjay_batch_builder_mark_t mark =
+            _anjay_batch_builder_mark(batch_builder);
     avs_time_real_t timestamp = avs_time_real_now();
+    size_t run_end = 0;
 
     for (size_t i = 0; i < paths_length; i++) {
+        if (i == run_end) {
+            size_t run_length =
+                    same_instance_run_length(&paths[i], paths_length - i);
+            run_end = i + run_length;
+            int result;
+            if (run_length > 1
+                    && (result = read_many_prepare(anjay, &paths[i],
+                                                   run_length))) {
+                _anjay_batch_builder_rollback(batch_builder, &mark);
+                return result;
+            }
+        }
         int result = batch_data_add_current_impl(builder, anjay, paths[i].oid,
                                                  paths[i].iid, paths[i].rid,
                                                  &timestamp);
@@ -681,8 +1641,7 @@ int _anjay_send_batch_data_add_current_multiple_unlocked(
                      _("resource ") "/%u/%u/%u" _(" not found, ignoring"),
                      paths[i].oid, paths[i].iid, paths[i].rid);
         } else if (result) {
-            batch_builder->append_ptr = append_ptr;
-            _anjay_batch_entry_list_cleanup(batch_builder->append_ptr);
+            _anjay_batch_builder_rollback(batch_builder, &mark);
             return result;
         }
     }
@@ -702,6 +1661,101 @@ int anjay_send_batch_data_add_current_multiple(
     return result;
 }
 
+typedef struct {
+    anjay_batch_builder_t *builder;
+    anjay_iid_t first_iid;
+    anjay_iid_t last_iid;
+    const anjay_rid_t *rids;
+    size_t rids_count;
+    avs_time_real_t timestamp;
+} add_current_range_args_t;
+
+static int add_current_range_instance(anjay_unlocked_t *anjay,
+                                      const anjay_dm_installed_object_t *obj,
+                                      anjay_iid_t iid,
+                                      void *args_) {
+    const add_current_range_args_t *args =
+            (const add_current_range_args_t *) args_;
+    if (iid < args->first_iid) {
+        return ANJAY_FOREACH_CONTINUE;
+    } else if (iid > args->last_iid) {
+        // Instances are listed in ascending order
+        return ANJAY_FOREACH_BREAK;
+    }
+    int result = 0;
+    if (args->rids_count > 1
+            && _anjay_dm_handler_implemented(
+                       obj, ANJAY_DM_HANDLER_resource_read_many)
+            && (result = _anjay_dm_call_resource_read_many(
+                        anjay, obj, iid, args->rids, args->rids_count))) {
+        return result;
+    }
+    // the Instance is known to be present, so _anjay_dm_path_info() is not
+    // used, as it would list the Instances again for each Resource
+    for (size_t i = 0; !result && i < args->rids_count; ++i) {
+        anjay_dm_path_info_t path_info = {
+            .uri = MAKE_RESOURCE_PATH(_anjay_dm_installed_object_oid(obj), iid,
+                                      args->rids[i])
+        };
+        anjay_dm_resource_presence_t presence;
+        if (!(result = _anjay_dm_resource_kind_and_presence(
+                      anjay, obj, iid, args->rids[i], &path_info.kind,
+                      &presence))
+                && presence == ANJAY_DM_RES_PRESENT) {
+            path_info.is_present = true;
+            path_info.has_resource = true;
+            path_info.is_hierarchical =
+                    _anjay_dm_res_kind_multiple(path_info.kind);
+            result = _anjay_dm_read_into_batch(args->builder, anjay, obj,
+                                               &path_info, ANJAY_SSID_BOOTSTRAP,
+                                               &args->timestamp);
+        }
+    }
+    return result;
+}
+
+int anjay_send_batch_data_add_current_range(
+        anjay_send_batch_builder_t *builder,
+        anjay_t *anjay_locked,
+        anjay_oid_t oid,
+        anjay_iid_t first_iid,
+        anjay_iid_t last_iid,
+        const anjay_rid_t *rids,
+        size_t rids_count) {
+    assert(builder);
+    if (!rids_count) {
+        return 0;
+    }
+    if (!rids) {
+        return -1;
+    }
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(anjay, oid);
+    if (!obj) {
+        send_log(ERROR, _("unregistered Object ID: ") "%u", oid);
+        result = ANJAY_ERR_NOT_FOUND;
+    } else {
+        add_current_range_args_t args = {
+            .builder = cast_to_builder(builder),
+            .first_iid = first_iid,
+            .last_iid = last_iid,
+            .rids = rids,
+            .rids_count = rids_count,
+            .timestamp = avs_time_real_now()
+        };
+        const anjay_batch_builder_mark_t mark =
+                _anjay_batch_builder_mark(args.builder);
+        if ((result = _anjay_dm_foreach_instance(
+                     anjay, obj, add_current_range_instance, &args))) {
+            _anjay_batch_builder_rollback(args.builder, &mark);
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
 int anjay_send_batch_data_add_current_multiple_ignore_not_found(
         anjay_send_batch_builder_t *builder,
         anjay_t *anjay_locked,
@@ -737,7 +1791,7 @@ void anjay_send_batch_release(anjay_send_batch_t **batch_ptr) {
 
 static void cancel_send_entry(AVS_LIST(anjay_send_entry_t) *entry_ptr,
                               int result) {
-    call_finished_handler(*entry_ptr, result);
+    call_finished_handlers(*entry_ptr, result);
     delete_send_entry(entry_ptr);
 }
 
@@ -787,10 +1841,227 @@ void _anjay_send_interrupt(anjay_connection_ref_t ref) {
 }
 
 void _anjay_send_cleanup(anjay_sender_t *sender) {
+    avs_sched_del(&sender->coalescing_flush_handle);
+    avs_sched_del(&sender->rate_limit_handle);
+    AVS_LIST_CLEAR(&sender->rate_buckets);
+    sender->watermark_handler = NULL;
+    sender->watermark_reached = false;
     while (sender->entries) {
         cancel_send_entry(&sender->entries, ANJAY_SEND_ABORT);
     }
+    avs_sched_del(&sender->watermark_handle);
+}
+
+static uint16_t stats_content_format(anjay_unlocked_t *anjay,
+                                     anjay_ssid_t ssid) {
+    anjay_server_info_t *server = _anjay_servers_find_active(anjay, ssid);
+    if (server) {
+        return send_content_format((anjay_connection_ref_t) {
+            .server = server,
+            .conn_type = ANJAY_CONNECTION_PRIMARY
+        });
+    }
+    // the format that will be used is not known yet, assume the most likely
+    return _anjay_default_hierarchical_format(ANJAY_LWM2M_VERSION_1_1);
+}
+
+static void add_entry_stats(anjay_send_queue_stats_t *stats,
+                            anjay_send_entry_t *entry,
+                            bool in_flight,
+                            uint16_t content_format) {
+    if (in_flight) {
+        ++stats->in_flight_count;
+    } else {
+        ++stats->deferred_count;
+    }
+    const size_t size = entry_payload_size(entry, content_format);
+    if (size != SIZE_MAX) {
+        stats->estimated_payload_size =
+                add_saturated(stats->estimated_payload_size, size);
+    }
+}
+
+static void queue_stats(anjay_unlocked_t *anjay,
+                        anjay_ssid_t ssid,
+                        anjay_send_queue_stats_t *out_stats) {
+    *out_stats = (anjay_send_queue_stats_t) {
+        .server_state = ANJAY_SEND_ERR_SSID
+    };
+    if (ssid != ANJAY_SSID_ANY) {
+        anjay_connection_ref_t ref = {
+            .server = NULL
+        };
+        out_stats->server_state = check_send_possibility(anjay, ssid, &ref);
+    }
+    anjay_ssid_t format_ssid = ANJAY_SSID_ANY;
+    uint16_t content_format = AVS_COAP_FORMAT_NONE;
+    AVS_LIST(anjay_send_entry_t) entry;
+    AVS_LIST_FOREACH(entry, anjay->sender.entries) {
+        if (ssid != ANJAY_SSID_ANY && entry->target_ssid != ssid) {
+            if (entry->target_ssid > ssid) {
+                break;
+            }
+            continue;
+        }
+        if (format_ssid != entry->target_ssid) {
+            format_ssid = entry->target_ssid;
+            content_format = stats_content_format(anjay, format_ssid);
+        }
+        const bool in_flight = exchange_started(&entry->exchange_status);
+        add_entry_stats(out_stats, entry, in_flight, content_format);
+        AVS_LIST(anjay_send_entry_t) it;
+        AVS_LIST_FOREACH(it, entry->coalesced) {
+            add_entry_stats(out_stats, it, in_flight, content_format);
+        }
+    }
+}
+
+int anjay_send_queue_stats(anjay_t *anjay_locked,
+                           anjay_ssid_t ssid,
+                           anjay_send_queue_stats_t *out_stats) {
+    if (!out_stats) {
+        return -1;
+    }
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    queue_stats(anjay, ssid, out_stats);
+    result = 0;
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+int anjay_send_queue_set_low_watermark(
+        anjay_t *anjay_locked,
+        size_t watermark,
+        anjay_send_queue_watermark_handler_t *handler,
+        void *arg) {
+    if (handler && !watermark) {
+        send_log(ERROR, _("Send queue watermark must be positive"));
+        return -1;
+    }
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    anjay_sender_t *sender = &anjay->sender;
+    sender->low_watermark = watermark;
+    sender->watermark_handler = handler;
+    sender->watermark_handler_arg = arg;
+    sender->watermark_reached =
+            handler && sender->entry_count >= sender->low_watermark;
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return 0;
+}
+
+#        ifdef ANJAY_WITH_SEND_PERSISTENCE
+void _anjay_send_persistence_cleanup(anjay_sender_t *sender) {
+    AVS_LIST(anjay_send_entry_t) entry;
+    AVS_LIST_FOREACH(entry, sender->entries) {
+        entry->persisted = false;
+        AVS_LIST(anjay_send_entry_t) it;
+        AVS_LIST_FOREACH(it, entry->coalesced) {
+            it->persisted = false;
+        }
+    }
+    sender->log = (anjay_send_log_t) {
+        .handlers = NULL
+    };
+}
+
+static int restore_send_entry(void *anjay_,
+                              anjay_ssid_t ssid,
+                              const anjay_send_log_record_t *record) {
+    anjay_unlocked_t *anjay = (anjay_unlocked_t *) anjay_;
+    AVS_LIST(anjay_send_entry_t) entry =
+            AVS_LIST_NEW_ELEMENT(anjay_send_entry_t);
+    if (!entry) {
+        _anjay_log_oom();
+        return -1;
+    }
+    entry->anjay = anjay;
+    entry->target_ssid = ssid;
+    entry->deferrable = true;
+    entry->priority = ANJAY_SEND_PRIORITY_NORMAL;
+    entry->persisted = true;
+    entry->log_record = *record;
+    entry_added(&anjay->sender);
+    insert_send_entry(&anjay->sender, entry);
+    return 0;
+}
+
+static void discard_restored_entry(void *anjay_, uint32_t id) {
+    anjay_unlocked_t *anjay = (anjay_unlocked_t *) anjay_;
+    AVS_LIST(anjay_send_entry_t) *entry_ptr;
+    AVS_LIST_FOREACH_PTR(entry_ptr, &anjay->sender.entries) {
+        if ((*entry_ptr)->persisted && (*entry_ptr)->log_record.id == id) {
+            // already marked as discarded in the log
+            (*entry_ptr)->persisted = false;
+            delete_send_entry(entry_ptr);
+            return;
+        }
+    }
+}
+
+static int persistent_queue_install(anjay_unlocked_t *anjay,
+                                    const anjay_send_log_handlers_t *handlers,
+                                    void *arg,
+                                    size_t max_ram_size) {
+    anjay_sender_t *sender = &anjay->sender;
+    if (_anjay_send_log_enabled(&sender->log)) {
+        send_log(ERROR, _("persistent Send queue is already installed"));
+        return -1;
+    }
+    if (!handlers || !handlers->append || !handlers->read
+            || !handlers->discard) {
+        send_log(ERROR, _("invalid persistent Send queue handlers"));
+        return -1;
+    }
+    if (_anjay_send_log_open(&sender->log, handlers, arg, restore_send_entry,
+                             discard_restored_entry, anjay)) {
+        // entries restored so far are the only persisted ones
+        AVS_LIST(anjay_send_entry_t) *entry_ptr;
+        AVS_LIST(anjay_send_entry_t) helper;
+        AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, helper, &sender->entries) {
+            if ((*entry_ptr)->persisted) {
+                (*entry_ptr)->persisted = false;
+                delete_send_entry(entry_ptr);
+            }
+        }
+        return -1;
+    }
+    sender->max_ram_size = max_ram_size;
+
+    size_t restored_count = 0;
+    AVS_LIST(anjay_send_entry_t) it;
+    AVS_LIST_FOREACH(it, sender->entries) {
+        if (it->persisted) {
+            ++restored_count;
+        } else if (it->deferrable && it->payload_batch
+                   && !exchange_started(&it->exchange_status)) {
+            // requests deferred before the log was installed
+            persist_send_entry(it);
+        }
+    }
+    compact_send_log(sender);
+    if (restored_count) {
+        send_log(INFO, _("restored ") "%lu" _(" deferred Send requests"),
+                 (unsigned long) restored_count);
+        // if this fails, the requests will be retried when any server
+        // connection becomes ready
+        (void) _anjay_send_sched_retry_deferred(anjay, ANJAY_SSID_ANY);
+    }
+    return 0;
+}
+
+int anjay_send_persistent_queue_install(
+        anjay_t *anjay_locked,
+        const anjay_send_log_handlers_t *handlers,
+        void *arg,
+        size_t max_ram_size) {
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    result = persistent_queue_install(anjay, handlers, arg, max_ram_size);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
 }
+#        endif // ANJAY_WITH_SEND_PERSISTENCE
 
 static void retry_deferred_job(avs_sched_t *sched, const void *ssid_) {
     anjay_t *anjay_locked = _anjay_get_from_sched(sched);
@@ -802,17 +2073,24 @@ static void retry_deferred_job(avs_sched_t *sched, const void *ssid_) {
     anjay_connection_ref_t connection = {
         .server = NULL
     };
-
-    AVS_LIST(anjay_send_entry_t) *entry_ptr;
-    AVS_LIST(anjay_send_entry_t) helper;
-    AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, helper, &anjay->sender.entries) {
-        if ((*entry_ptr)->exchange_status.memstream) {
+    // server for which the rate limit has been reached; its remaining
+    // non-urgent requests are not sent in this run
+    anjay_ssid_t rate_limited_ssid = ANJAY_SSID_ANY;
+
+    // NOTE: AVS_LIST_DELETABLE_FOREACH_PTR() is not used, because
+    // coalesce_held_entries() may detach the entries that follow the current
+    // one
+    AVS_LIST(anjay_send_entry_t) *entry_ptr = &anjay->sender.entries;
+    while (*entry_ptr) {
+        if (exchange_started(&(*entry_ptr)->exchange_status)) {
             // Entry is not deferred
+            AVS_LIST_ADVANCE_PTR(&entry_ptr);
             continue;
         }
 
         if (ssid_or_any != ANJAY_SSID_ANY) {
             if ((*entry_ptr)->target_ssid < ssid_or_any) {
+                AVS_LIST_ADVANCE_PTR(&entry_ptr);
                 continue;
             } else if ((*entry_ptr)->target_ssid > ssid_or_any) {
                 break;
@@ -820,19 +2098,49 @@ static void retry_deferred_job(avs_sched_t *sched, const void *ssid_) {
         }
 
         assert((*entry_ptr)->target_ssid != ANJAY_SSID_ANY);
+        if ((*entry_ptr)->target_ssid == rate_limited_ssid
+                && (*entry_ptr)->priority != ANJAY_SEND_PRIORITY_URGENT) {
+            AVS_LIST_ADVANCE_PTR(&entry_ptr);
+            continue;
+        }
+
         if (send_condition_ssid != (*entry_ptr)->target_ssid) {
             send_condition_ssid = (*entry_ptr)->target_ssid;
             send_condition = check_send_possibility(anjay, send_condition_ssid,
                                                     &connection);
         }
 
-        if ((send_condition != ANJAY_SEND_OK
-             && (!(*entry_ptr)->deferrable
-                 || !is_deferrable_condition(send_condition)))
-                || (send_condition == ANJAY_SEND_OK
-                    && avs_is_err(
-                               start_send_exchange(*entry_ptr, connection)))) {
+        bool cancel;
+        if (send_condition != ANJAY_SEND_OK) {
+            cancel = !(*entry_ptr)->deferrable
+                     || !is_deferrable_condition(send_condition);
+        } else if (ensure_batch_loaded(*entry_ptr)) {
+            cancel = true;
+        } else {
+            const uint16_t content_format = send_content_format(connection);
+            if (coalescing_enabled(&anjay->sender)) {
+                coalesce_held_entries(*entry_ptr, content_format);
+            }
+            avs_time_duration_t rate_limit_delay = AVS_TIME_DURATION_ZERO;
+            if (rate_limit_enabled(&anjay->sender)) {
+                rate_limit_delay = take_rate_tokens(
+                        &anjay->sender, (*entry_ptr)->target_ssid,
+                        group_payload_size(*entry_ptr, content_format),
+                        (*entry_ptr)->priority == ANJAY_SEND_PRIORITY_URGENT);
+            }
+            if (avs_time_duration_less(AVS_TIME_DURATION_ZERO,
+                                       rate_limit_delay)) {
+                rate_limited_ssid = (*entry_ptr)->target_ssid;
+                sched_rate_limited_retry(anjay, rate_limit_delay);
+                AVS_LIST_ADVANCE_PTR(&entry_ptr);
+                continue;
+            }
+            cancel = avs_is_err(start_send_exchange(*entry_ptr, connection));
+        }
+        if (cancel) {
             cancel_send_entry(entry_ptr, ANJAY_SEND_DEFERRED_ERROR);
+        } else {
+            AVS_LIST_ADVANCE_PTR(&entry_ptr);
         }
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
@@ -845,7 +2153,7 @@ bool _anjay_send_has_deferred(anjay_unlocked_t *anjay, anjay_ssid_t ssid) {
     AVS_LIST_FOREACH(it, anjay->sender.entries) {
         if (it->target_ssid > ssid) {
             break;
-        } else if (it->exchange_status.memstream) {
+        } else if (exchange_started(&it->exchange_status)) {
             // Entry is not deferred
             continue;
         } else if (it->target_ssid == ssid) {
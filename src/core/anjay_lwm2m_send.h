@@ -11,21 +11,94 @@
 #define ANJAY_LWM2M_SEND_H
 
 #include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_sched.h>
+#include <avsystem/commons/avs_time.h>
+
+#include "anjay_send_log.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
 typedef struct anjay_send_entry anjay_send_entry_t;
 
+typedef struct anjay_send_rate_bucket anjay_send_rate_bucket_t;
+
 typedef struct {
     AVS_LIST(anjay_send_entry_t) entries;
+    /**
+     * Time for which Send requests are held back so that they can be merged
+     * with further ones, see
+     * @ref anjay_configuration_t::send_coalescing_window
+     */
+    avs_time_duration_t coalescing_window;
+    size_t coalescing_max_payload_size;
+    /**
+     * Job that sends all the requests held back for coalescing.
+     */
+    avs_sched_handle_t coalescing_flush_handle;
+    /**
+     * Rate limiter configuration, see
+     * @ref anjay_configuration_t::send_rate_limit ; zero rate means disabled.
+     */
+    size_t rate_limit;
+    size_t rate_limit_burst;
+    /**
+     * Token buckets of the rate limiter, one per server, created on first use.
+     */
+    AVS_LIST(anjay_send_rate_bucket_t) rate_buckets;
+    /**
+     * Job that retries the requests held back by the rate limiter.
+     */
+    avs_sched_handle_t rate_limit_handle;
+    /**
+     * Number of all the entries, including the coalesced ones.
+     */
+    size_t entry_count;
+    /**
+     * Queue watermark configuration, see
+     * @ref anjay_send_queue_set_low_watermark .
+     */
+    size_t low_watermark;
+    anjay_send_queue_watermark_handler_t *watermark_handler;
+    void *watermark_handler_arg;
+    /**
+     * Whether entry_count has reached low_watermark since the last time the
+     * watermark handler was scheduled.
+     */
+    bool watermark_reached;
+    avs_sched_handle_t watermark_handle;
+#ifdef ANJAY_WITH_SEND_PERSISTENCE
+    /**
+     * Log of deferred requests, see
+     * @ref anjay_send_persistent_queue_install
+     */
+    anjay_send_log_t log;
+    size_t max_ram_size;
+    /** Total memory size of logged batches that are currently kept in RAM. */
+    size_t ram_size;
+#endif // ANJAY_WITH_SEND_PERSISTENCE
 } anjay_sender_t;
 
+void _anjay_send_init(anjay_sender_t *sender,
+                      avs_time_duration_t coalescing_window,
+                      size_t coalescing_max_payload_size,
+                      size_t rate_limit,
+                      size_t rate_limit_burst);
+
 bool _anjay_send_in_progress(anjay_connection_ref_t ref);
 
 void _anjay_send_interrupt(anjay_connection_ref_t ref);
 
 void _anjay_send_cleanup(anjay_sender_t *sender);
 
+#ifdef ANJAY_WITH_SEND_PERSISTENCE
+/**
+ * Stops updating the persistent log, so that all the requests currently stored
+ * in it, including the ones in progress, are kept for the next run. Called
+ * when the Anjay object is being deleted, before the connections are closed.
+ */
+void _anjay_send_persistence_cleanup(anjay_sender_t *sender);
+#endif // ANJAY_WITH_SEND_PERSISTENCE
+
 #ifndef ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
 bool _anjay_send_has_deferred(anjay_unlocked_t *anjay, anjay_ssid_t ssid);
 #endif // ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
@@ -33,6 +106,13 @@ bool _anjay_send_has_deferred(anjay_unlocked_t *anjay, anjay_ssid_t ssid);
 int _anjay_send_sched_retry_deferred(anjay_unlocked_t *anjay,
                                      anjay_ssid_t ssid);
 
+/**
+ * Returns the time at which the Send requests held back for coalescing or by
+ * the rate limiter are planned to be sent, or AVS_TIME_REAL_INVALID if there
+ * are none.
+ */
+avs_time_real_t _anjay_send_next_planned_retry(anjay_unlocked_t *anjay);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* ANJAY_LWM2M_SEND_H */
@@ -0,0 +1,310 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_memory.h>
+
+#include <anjay/stats.h>
+
+#include <anjay_modules/anjay_memory_accounting.h>
+#include <anjay_modules/anjay_utils_core.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+#ifdef ANJAY_WITH_MEMORY_ACCOUNTING
+
+/**
+ * Header preceding each allocated block, so that the size and the subsystem
+ * are known when it is freed. Padded to the maximum alignment, so that the
+ * block itself is aligned as the underlying allocator would align it.
+ */
+typedef union {
+    struct {
+        size_t size;
+        anjay_memory_tag_t tag;
+#    ifdef ANJAY_WITH_ALLOCATION_PROFILING
+        size_t site;
+#    endif // ANJAY_WITH_ALLOCATION_PROFILING
+    } info;
+    avs_max_align_t align;
+} alloc_header_t;
+
+static anjay_memory_stats_t MEMORY_STATS[ANJAY_MEMORY_TAG_LIMIT_];
+
+static anjay_memory_tag_t CURRENT_TAG = ANJAY_MEMORY_TAG_OTHER;
+
+anjay_memory_tag_t _anjay_memory_tag_enter(anjay_memory_tag_t tag) {
+    anjay_memory_tag_t previous_tag = CURRENT_TAG;
+    CURRENT_TAG = tag;
+    return previous_tag;
+}
+
+void _anjay_memory_tag_leave(anjay_memory_tag_t previous_tag) {
+    CURRENT_TAG = previous_tag;
+}
+
+#    ifdef ANJAY_WITH_ALLOCATION_PROFILING
+
+#        define alloc_log(...) _anjay_log(alloc_profile, __VA_ARGS__)
+
+#        define MAX_ALLOCATION_SITES 64
+
+/**
+ * Entry 0 collects allocations made outside of any marked function, and ones
+ * made by sites that did not fit in the table.
+ */
+static anjay_allocation_site_stats_t ALLOCATION_SITES[MAX_ALLOCATION_SITES];
+
+static size_t ALLOCATION_SITES_COUNT = 1;
+
+static size_t CURRENT_SITE = 0;
+
+size_t _anjay_allocation_site_enter(const char *site) {
+    const size_t previous_site = CURRENT_SITE;
+    size_t index;
+    for (index = 1; index < ALLOCATION_SITES_COUNT; ++index) {
+        if (ALLOCATION_SITES[index].site == site) {
+            break;
+        }
+    }
+    if (index == ALLOCATION_SITES_COUNT) {
+        if (ALLOCATION_SITES_COUNT < MAX_ALLOCATION_SITES) {
+            ALLOCATION_SITES[ALLOCATION_SITES_COUNT++].site = site;
+        } else {
+            index = 0;
+        }
+    }
+    CURRENT_SITE = index;
+    return previous_site;
+}
+
+void _anjay_allocation_site_leave(size_t previous_site) {
+    CURRENT_SITE = previous_site;
+}
+
+static void site_alloc(size_t site, size_t size) {
+    ++ALLOCATION_SITES[site].allocations;
+    ALLOCATION_SITES[site].total_bytes += size;
+    ALLOCATION_SITES[site].current_bytes += size;
+}
+
+static void site_realloc(size_t site, size_t old_size, size_t new_size) {
+    ++ALLOCATION_SITES[site].reallocations;
+    if (new_size > old_size) {
+        ALLOCATION_SITES[site].total_bytes += new_size - old_size;
+    }
+    ALLOCATION_SITES[site].current_bytes -= old_size;
+    ALLOCATION_SITES[site].current_bytes += new_size;
+}
+
+static void site_free(size_t site, size_t size) {
+    ALLOCATION_SITES[site].current_bytes -= size;
+}
+
+#    endif // ANJAY_WITH_ALLOCATION_PROFILING
+
+static void account_alloc(anjay_memory_tag_t tag, size_t size) {
+    anjay_memory_stats_t *stats = &MEMORY_STATS[tag];
+    stats->current_bytes += size;
+    ++stats->current_allocations;
+    if (stats->current_bytes > stats->peak_bytes) {
+        stats->peak_bytes = stats->current_bytes;
+    }
+}
+
+static void account_free(anjay_memory_tag_t tag, size_t size) {
+    anjay_memory_stats_t *stats = &MEMORY_STATS[tag];
+    stats->current_bytes -= size;
+    --stats->current_allocations;
+}
+
+void *avs_malloc(size_t size) {
+    if (size > SIZE_MAX - sizeof(alloc_header_t)) {
+        return NULL;
+    }
+    alloc_header_t *header =
+            (alloc_header_t *) malloc(sizeof(alloc_header_t) + size);
+    if (!header) {
+        return NULL;
+    }
+    header->info.size = size;
+    header->info.tag = CURRENT_TAG;
+    account_alloc(header->info.tag, size);
+    ++MEMORY_STATS[header->info.tag].total_allocations;
+#    ifdef ANJAY_WITH_ALLOCATION_PROFILING
+    header->info.site = CURRENT_SITE;
+    site_alloc(header->info.site, size);
+#    endif // ANJAY_WITH_ALLOCATION_PROFILING
+    return header + 1;
+}
+
+void *avs_calloc(size_t nmemb, size_t size) {
+    if (size && nmemb > SIZE_MAX / size) {
+        return NULL;
+    }
+    void *result = avs_malloc(nmemb * size);
+    if (result) {
+        memset(result, 0, nmemb * size);
+    }
+    return result;
+}
+
+void *avs_realloc(void *ptr, size_t size) {
+    if (!ptr) {
+        return avs_malloc(size);
+    }
+    if (size > SIZE_MAX - sizeof(alloc_header_t)) {
+        return NULL;
+    }
+    alloc_header_t *header = (alloc_header_t *) ptr - 1;
+    const size_t old_size = header->info.size;
+    const anjay_memory_tag_t tag = header->info.tag;
+    alloc_header_t *new_header = (alloc_header_t *) realloc(
+            header, sizeof(alloc_header_t) + size);
+    if (!new_header) {
+        return NULL;
+    }
+    account_free(tag, old_size);
+    account_alloc(tag, size);
+#    ifdef ANJAY_WITH_ALLOCATION_PROFILING
+    site_realloc(new_header->info.site, old_size, size);
+#    endif // ANJAY_WITH_ALLOCATION_PROFILING
+    new_header->info.size = size;
+    return new_header + 1;
+}
+
+void avs_free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    alloc_header_t *header = (alloc_header_t *) ptr - 1;
+    account_free(header->info.tag, header->info.size);
+#    ifdef ANJAY_WITH_ALLOCATION_PROFILING
+    site_free(header->info.site, header->info.size);
+#    endif // ANJAY_WITH_ALLOCATION_PROFILING
+    free(header);
+}
+
+int anjay_get_memory_stats(anjay_memory_tag_t tag,
+                           anjay_memory_stats_t *out_stats) {
+    if ((int) tag < 0 || tag >= ANJAY_MEMORY_TAG_LIMIT_) {
+        memset(out_stats, 0, sizeof(*out_stats));
+        return -1;
+    }
+    *out_stats = MEMORY_STATS[tag];
+    return 0;
+}
+
+void anjay_reset_memory_peaks(void) {
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(MEMORY_STATS); ++i) {
+        MEMORY_STATS[i].peak_bytes = MEMORY_STATS[i].current_bytes;
+    }
+}
+
+#    ifdef ANJAY_WITH_ALLOCATION_PROFILING
+
+static int compare_sites(const void *left_, const void *right_) {
+    const anjay_allocation_site_stats_t *left =
+            (const anjay_allocation_site_stats_t *) left_;
+    const anjay_allocation_site_stats_t *right =
+            (const anjay_allocation_site_stats_t *) right_;
+    return (left->total_bytes < right->total_bytes)
+           - (left->total_bytes > right->total_bytes);
+}
+
+/**
+ * Copies the site table to @p out_sites, which shall have room for
+ * MAX_ALLOCATION_SITES entries, so that it can be sorted and logged without
+ * any of it being changed by allocations made in the meantime.
+ */
+static size_t snapshot_sites(anjay_allocation_site_stats_t *out_sites) {
+    const size_t count = ALLOCATION_SITES_COUNT;
+    memcpy(out_sites, ALLOCATION_SITES, count * sizeof(*out_sites));
+    qsort(out_sites, count, sizeof(*out_sites), compare_sites);
+    return count;
+}
+
+size_t anjay_get_allocation_sites(anjay_allocation_site_stats_t *out_entries,
+                                  size_t max_entries) {
+    anjay_allocation_site_stats_t sites[MAX_ALLOCATION_SITES];
+    const size_t count = snapshot_sites(sites);
+    if (max_entries) {
+        memcpy(out_entries, sites,
+               AVS_MIN(count, max_entries) * sizeof(*out_entries));
+    }
+    return count;
+}
+
+void anjay_reset_allocation_sites(void) {
+    for (size_t i = 0; i < ALLOCATION_SITES_COUNT; ++i) {
+        ALLOCATION_SITES[i].allocations = 0;
+        ALLOCATION_SITES[i].reallocations = 0;
+        ALLOCATION_SITES[i].total_bytes = 0;
+    }
+}
+
+void anjay_dump_allocation_sites(void) {
+    anjay_allocation_site_stats_t sites[MAX_ALLOCATION_SITES];
+    const size_t count = snapshot_sites(sites);
+    alloc_log(INFO, _("allocations per call site:"));
+    for (size_t i = 0; i < count; ++i) {
+        if (!sites[i].allocations && !sites[i].reallocations
+                && !sites[i].current_bytes) {
+            continue;
+        }
+        alloc_log(INFO,
+                  "%s" _(": ") "%" PRIu64 _(" allocs, ") "%" PRIu64 _(
+                          " reallocs, ") "%" PRIu64 _(" B total, ") "%lu" _(
+                          " B current"),
+                  sites[i].site ? sites[i].site : "(unattributed)",
+                  sites[i].allocations, sites[i].reallocations,
+                  sites[i].total_bytes, (unsigned long) sites[i].current_bytes);
+    }
+}
+
+#    endif // ANJAY_WITH_ALLOCATION_PROFILING
+
+#    ifdef ANJAY_TEST
+#        include "tests/core/memory_accounting.c"
+#    endif // ANJAY_TEST
+
+#else // ANJAY_WITH_MEMORY_ACCOUNTING
+
+int anjay_get_memory_stats(anjay_memory_tag_t tag,
+                           anjay_memory_stats_t *out_stats) {
+    (void) tag;
+    memset(out_stats, 0, sizeof(*out_stats));
+    return -1;
+}
+
+void anjay_reset_memory_peaks(void) {}
+
+#endif // ANJAY_WITH_MEMORY_ACCOUNTING
+
+#ifndef ANJAY_WITH_ALLOCATION_PROFILING
+
+size_t anjay_get_allocation_sites(anjay_allocation_site_stats_t *out_entries,
+                                  size_t max_entries) {
+    (void) out_entries;
+    (void) max_entries;
+    return 0;
+}
+
+void anjay_reset_allocation_sites(void) {}
+
+void anjay_dump_allocation_sites(void) {}
+
+#endif // ANJAY_WITH_ALLOCATION_PROFILING
@@ -9,7 +9,14 @@
 
 #include <anjay_init.h>
 
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_memory.h>
+
 #include <anjay_modules/anjay_dm_utils.h>
+#include <anjay_modules/anjay_memory_accounting.h>
 #include <anjay_modules/anjay_notify.h>
 
 #include "coap/anjay_content_format.h"
@@ -53,7 +60,8 @@ static int observe_notify(anjay_unlocked_t *anjay,
 
 static int
 security_modified_notify(anjay_unlocked_t *anjay,
-                         anjay_notify_queue_object_entry_t *security) {
+                         anjay_notify_queue_object_entry_t *security,
+                         bool server_notify) {
     int ret = 0;
     int32_t last_iid = -1;
     AVS_LIST(anjay_notify_queue_resource_entry_t) it;
@@ -66,7 +74,7 @@ security_modified_notify(anjay_unlocked_t *anjay,
     }
     // NOTE: If anjay->update_immediately_on_dm_change is true,
     // then this will be called from anjay_notify_perform_impl() itself
-    if (!anjay->update_immediately_on_dm_change
+    if (server_notify && !anjay->update_immediately_on_dm_change
             && security->instance_set_changes.instance_set_changed) {
         _anjay_update_ret(&ret, _anjay_schedule_reload_servers(anjay));
     }
@@ -140,14 +148,25 @@ static int anjay_notify_perform_impl(anjay_unlocked_t *anjay,
     AVS_LIST_FOREACH(it, *queue_ptr) {
         if (it->instance_set_changes.instance_set_changed) {
             instances_modified = true;
+            _anjay_dm_cache_invalidate_instances(anjay, it->oid);
+        } else if (it->resources_changed) {
+            _anjay_dm_cache_invalidate_resources(anjay, it->oid);
+        }
+        if (it->instance_set_changes.instance_set_changed
+                || it->oid == ANJAY_DM_OID_SECURITY
+                || it->oid == ANJAY_DM_OID_SERVER) {
+            _anjay_bootstrap_discover_cache_invalidate(anjay);
         }
         if (it->oid == ANJAY_DM_OID_SECURITY) {
-            _anjay_update_ret(&ret, security_modified_notify(anjay, it));
+            ++anjay->security_generation;
+            _anjay_update_ret(&ret, security_modified_notify(anjay, it,
+                                                             server_notify));
         } else if (server_notify && it->oid == ANJAY_DM_OID_SERVER) {
             _anjay_update_ret(&ret, server_modified_notify(anjay, it));
         }
     }
-    if (instances_modified && anjay->update_immediately_on_dm_change) {
+    if (server_notify && instances_modified
+            && anjay->update_immediately_on_dm_change) {
         _anjay_update_ret(&ret, _anjay_schedule_reload_servers(anjay));
     }
     _anjay_update_ret(&ret, observe_notify(anjay,
@@ -191,8 +210,12 @@ find_or_create_object_entry(anjay_notify_queue_t *out_queue, anjay_oid_t oid) {
             break;
         }
     }
-    if (AVS_LIST_INSERT_NEW(anjay_notify_queue_object_entry_t, it)) {
-        (*it)->oid = oid;
+    ANJAY_ALLOCATION_SITE_ENTER(prev_site);
+    AVS_LIST(anjay_notify_queue_object_entry_t) entry =
+            AVS_LIST_INSERT_NEW(anjay_notify_queue_object_entry_t, it);
+    ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
+    if (entry) {
+        entry->oid = oid;
         return it;
     } else {
         return NULL;
@@ -208,8 +231,11 @@ static int add_entry_to_iid_set(AVS_LIST(anjay_iid_t) *iid_set_ptr,
             break;
         }
     }
-    if (AVS_LIST_INSERT_NEW(anjay_iid_t, iid_set_ptr)) {
-        **iid_set_ptr = iid;
+    ANJAY_ALLOCATION_SITE_ENTER(prev_site);
+    AVS_LIST(anjay_iid_t) entry = AVS_LIST_INSERT_NEW(anjay_iid_t, iid_set_ptr);
+    ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
+    if (entry) {
+        *entry = iid;
         return 0;
     } else {
         return -1;
@@ -239,28 +265,61 @@ static void delete_notify_queue_object_entry_if_empty(
         return;
     }
     assert(!(*entry_ptr)->instance_set_changes.known_added_iids);
+    assert(!(*entry_ptr)->instance_set_changes.known_removed_iids);
     AVS_LIST_DELETE(entry_ptr);
 }
 
-int _anjay_notify_queue_instance_created(anjay_notify_queue_t *out_queue,
-                                         anjay_oid_t oid,
-                                         anjay_iid_t iid) {
+int _anjay_notify_queue_instances_created(anjay_notify_queue_t *out_queue,
+                                          anjay_oid_t oid,
+                                          const anjay_iid_t *iids,
+                                          size_t iid_count) {
+    if (!iid_count) {
+        return 0;
+    }
     AVS_LIST(anjay_notify_queue_object_entry_t) *entry_ptr =
             find_or_create_object_entry(out_queue, oid);
     if (!entry_ptr) {
         _anjay_log_oom();
         return -1;
     }
-    if (add_entry_to_iid_set(
-                &(*entry_ptr)->instance_set_changes.known_added_iids, iid)) {
+    AVS_LIST(anjay_iid_t) *iid_set_ptr =
+            &(*entry_ptr)->instance_set_changes.known_added_iids;
+    size_t i;
+    for (i = 0; i < iid_count; ++i) {
+        assert(!i || iids[i - 1] <= iids[i]);
+        // an Instance removed and created again within the same batch is
+        // treated as if it was never removed
+        remove_entry_from_iid_set(
+                &(*entry_ptr)->instance_set_changes.known_removed_iids,
+                iids[i]);
+        if (add_entry_to_iid_set(iid_set_ptr, iids[i])) {
+            break;
+        }
+        // iids are sorted, so the search continues from the previous
+        // insertion point instead of the beginning of the list
+        AVS_LIST_ITERATE_PTR(iid_set_ptr) {
+            if (**iid_set_ptr >= iids[i]) {
+                break;
+            }
+        }
+    }
+    if (i) {
+        (*entry_ptr)->instance_set_changes.instance_set_changed = true;
+    }
+    if (i < iid_count) {
         _anjay_log_oom();
         delete_notify_queue_object_entry_if_empty(entry_ptr);
         return -1;
     }
-    (*entry_ptr)->instance_set_changes.instance_set_changed = true;
     return 0;
 }
 
+int _anjay_notify_queue_instance_created(anjay_notify_queue_t *out_queue,
+                                         anjay_oid_t oid,
+                                         anjay_iid_t iid) {
+    return _anjay_notify_queue_instances_created(out_queue, oid, &iid, 1);
+}
+
 int _anjay_notify_queue_instance_removed(anjay_notify_queue_t *out_queue,
                                          anjay_oid_t oid,
                                          anjay_iid_t iid) {
@@ -273,6 +332,12 @@ int _anjay_notify_queue_instance_removed(anjay_notify_queue_t *out_queue,
     remove_entry_from_iid_set(
             &(*entry_ptr)->instance_set_changes.known_added_iids, iid);
     (*entry_ptr)->instance_set_changes.instance_set_changed = true;
+    if (add_entry_to_iid_set(
+                &(*entry_ptr)->instance_set_changes.known_removed_iids, iid)) {
+        // the removal is still recorded, just not in the exhaustive form
+        _anjay_log_oom();
+        (*entry_ptr)->instance_set_changes.unknown_change = true;
+    }
     return 0;
 }
 
@@ -285,6 +350,7 @@ int _anjay_notify_queue_instance_set_unknown_change(
         return -1;
     }
     (*entry_ptr)->instance_set_changes.instance_set_changed = true;
+    (*entry_ptr)->instance_set_changes.unknown_change = true;
     return 0;
 }
 
@@ -298,45 +364,67 @@ compare_resource_entries(const anjay_notify_queue_resource_entry_t *left,
     return result;
 }
 
-int _anjay_notify_queue_resource_change(anjay_notify_queue_t *out_queue,
-                                        anjay_oid_t oid,
-                                        anjay_iid_t iid,
-                                        anjay_rid_t rid) {
+int _anjay_notify_queue_resource_changes(
+        anjay_notify_queue_t *out_queue,
+        anjay_oid_t oid,
+        const anjay_notify_queue_resource_entry_t *entries,
+        size_t entry_count) {
+    if (!entry_count) {
+        return 0;
+    }
     AVS_LIST(anjay_notify_queue_object_entry_t) *obj_entry_ptr =
             find_or_create_object_entry(out_queue, oid);
     if (!obj_entry_ptr) {
         _anjay_log_oom();
         return -1;
     }
-    anjay_notify_queue_resource_entry_t new_entry = {
-        .iid = iid,
-        .rid = rid
-    };
-    AVS_LIST(anjay_notify_queue_resource_entry_t) *res_entry_ptr;
-    AVS_LIST_FOREACH_PTR(res_entry_ptr, &(*obj_entry_ptr)->resources_changed) {
-        int compare = compare_resource_entries(*res_entry_ptr, &new_entry);
-        if (compare == 0) {
-            return 0;
-        } else if (compare > 0) {
-            break;
+    AVS_LIST(anjay_notify_queue_resource_entry_t) *res_entry_ptr =
+            &(*obj_entry_ptr)->resources_changed;
+    for (size_t i = 0; i < entry_count; ++i) {
+        assert(!i
+               || compare_resource_entries(&entries[i - 1], &entries[i]) <= 0);
+        // entries are sorted, so the search continues from the previous
+        // insertion point instead of the beginning of the list
+        int compare = 1;
+        while (*res_entry_ptr
+               && (compare = compare_resource_entries(*res_entry_ptr,
+                                                      &entries[i]))
+                          < 0) {
+            AVS_LIST_ADVANCE_PTR(&res_entry_ptr);
         }
-    }
-    if (!AVS_LIST_INSERT_NEW(anjay_notify_queue_resource_entry_t,
-                             res_entry_ptr)) {
-        _anjay_log_oom();
-        if (!(*obj_entry_ptr)->instance_set_changes.instance_set_changed
-                && !(*obj_entry_ptr)->resources_changed) {
-            AVS_LIST_DELETE(obj_entry_ptr);
+        if (*res_entry_ptr && compare == 0) {
+            continue;
         }
-        return -1;
+        ANJAY_ALLOCATION_SITE_ENTER(prev_site);
+        AVS_LIST(anjay_notify_queue_resource_entry_t) entry =
+                AVS_LIST_INSERT_NEW(anjay_notify_queue_resource_entry_t,
+                                    res_entry_ptr);
+        ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
+        if (!entry) {
+            _anjay_log_oom();
+            delete_notify_queue_object_entry_if_empty(obj_entry_ptr);
+            return -1;
+        }
+        **res_entry_ptr = entries[i];
     }
-    **res_entry_ptr = new_entry;
     return 0;
 }
 
+int _anjay_notify_queue_resource_change(anjay_notify_queue_t *out_queue,
+                                        anjay_oid_t oid,
+                                        anjay_iid_t iid,
+                                        anjay_rid_t rid) {
+    const anjay_notify_queue_resource_entry_t entry = {
+        .iid = iid,
+        .rid = rid
+    };
+    return _anjay_notify_queue_resource_changes(out_queue, oid, &entry, 1);
+}
+
 void _anjay_notify_clear_queue(anjay_notify_queue_t *out_queue) {
     AVS_LIST_CLEAR(out_queue) {
         AVS_LIST_CLEAR(&(*out_queue)->instance_set_changes.known_added_iids);
+        AVS_LIST_CLEAR(&(*out_queue)->instance_set_changes.known_removed_iids);
         AVS_LIST_CLEAR(&(*out_queue)->resources_changed);
     }
 }
@@ -350,39 +438,231 @@ static void notify_clb(avs_sched_t *sched, const void *dummy) {
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
 
-static int reschedule_notify(anjay_unlocked_t *anjay) {
-    if (anjay->scheduled_notify.handle) {
-        return 0;
+/**
+ * Returns the debounce window applicable to a change of @p path - the one set
+ * for the most specific path that contains it, or the configured default.
+ */
+static avs_time_duration_t debounce_window(anjay_unlocked_t *anjay,
+                                           const anjay_uri_path_t *path) {
+    avs_time_duration_t window = anjay->scheduled_notify.debounce_window;
+    size_t matched_length = 0;
+    AVS_LIST(anjay_notify_debounce_override_t) entry;
+    AVS_LIST_FOREACH(entry, anjay->scheduled_notify.debounce_overrides) {
+        const size_t length = _anjay_uri_path_length(&entry->path);
+        if (length > matched_length
+                && !_anjay_uri_path_outside_base(path, &entry->path)) {
+            window = entry->window;
+            matched_length = length;
+        }
+    }
+    return window;
+}
+
+/**
+ * Makes sure that the queue is flushed at most @p window from now. A flush
+ * that is already scheduled is only moved if it is due later than that, so
+ * that a burst of changes does not postpone it indefinitely.
+ */
+static int reschedule_notify(anjay_unlocked_t *anjay,
+                             avs_time_duration_t window) {
+    const bool immediate =
+            !avs_time_duration_less(AVS_TIME_DURATION_ZERO, window);
+    const avs_time_monotonic_t deadline =
+            immediate ? avs_time_monotonic_now()
+                      : avs_time_monotonic_add(avs_time_monotonic_now(),
+                                               window);
+    avs_sched_handle_t *handle = &anjay->scheduled_notify.handle;
+    if (*handle) {
+        if (!avs_time_monotonic_before(deadline, avs_sched_time(handle))) {
+            return 0;
+        }
+        avs_sched_del(handle);
+    }
+    if (immediate) {
+        return AVS_SCHED_NOW(anjay->sched, handle, notify_clb, NULL, 0);
     }
-    return AVS_SCHED_NOW(anjay->sched, &anjay->scheduled_notify.handle,
-                         notify_clb, NULL, 0);
+    return AVS_SCHED_AT(anjay->sched, handle, deadline, notify_clb, NULL, 0);
+}
+
+int _anjay_notify_instances_created(anjay_unlocked_t *anjay,
+                                    anjay_oid_t oid,
+                                    const anjay_iid_t *iids,
+                                    size_t iid_count) {
+    _anjay_dm_cache_invalidate_instances(anjay, oid);
+    int retval;
+    (void) ((retval = _anjay_notify_queue_instances_created(
+                     &anjay->scheduled_notify.queue, oid, iids, iid_count))
+            || (retval = reschedule_notify(
+                        anjay,
+                        debounce_window(anjay, &MAKE_OBJECT_PATH(oid)))));
+    return retval;
 }
 
 int _anjay_notify_instance_created(anjay_unlocked_t *anjay,
                                    anjay_oid_t oid,
                                    anjay_iid_t iid) {
-    int retval;
-    (void) ((retval = _anjay_notify_queue_instance_created(
-                     &anjay->scheduled_notify.queue, oid, iid))
-            || (retval = reschedule_notify(anjay)));
-    return retval;
+    return _anjay_notify_instances_created(anjay, oid, &iid, 1);
 }
 
 int _anjay_notify_changed_unlocked(anjay_unlocked_t *anjay,
                                    anjay_oid_t oid,
                                    anjay_iid_t iid,
                                    anjay_rid_t rid) {
+    _anjay_dm_cache_invalidate_resources(anjay, oid);
+    _anjay_dm_cache_invalidate_values(anjay, oid, iid, rid);
+    const avs_time_duration_t window =
+            debounce_window(anjay, &MAKE_RESOURCE_PATH(oid, iid, rid));
     int retval;
     (void) ((retval = _anjay_notify_queue_resource_change(
                      &anjay->scheduled_notify.queue, oid, iid, rid))
-            || (retval = reschedule_notify(anjay)));
+            || (retval = reschedule_notify(anjay, window)));
     return retval;
 }
 
+#ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+#    ifdef ANJAY_TEST
+#        include "tests/core/notify_mock.h"
+#    endif // ANJAY_TEST
+
+#    define ANJAY_DEFAULT_NOTIFY_CHANGE_QUEUE_SIZE 64
+
+static anjay_notify_change_queue_t *get_change_queue(anjay_unlocked_t *anjay) {
+    return &AVS_CONTAINER_OF(anjay, anjay_t, anjay_unlocked_placeholder)
+                    ->atomic_fields.notify_change_queue;
+}
+
+int _anjay_notify_change_queue_init(anjay_unlocked_t *anjay, size_t size) {
+    anjay_notify_change_queue_t *queue = get_change_queue(anjay);
+    if (!size) {
+        size = ANJAY_DEFAULT_NOTIFY_CHANGE_QUEUE_SIZE;
+    }
+    size_t capacity = 1;
+    while (capacity < size) {
+        if (capacity > SIZE_MAX / 2) {
+            anjay_log(ERROR, _("notify change queue size too large"));
+            return -1;
+        }
+        capacity *= 2;
+    }
+    if (!(queue->entries = (anjay_notify_change_queue_entry_t *) avs_calloc(
+                  capacity, sizeof(*queue->entries)))) {
+        _anjay_log_oom();
+        return -1;
+    }
+    for (size_t i = 0; i < capacity; ++i) {
+        atomic_init(&queue->entries[i].sequence, i);
+    }
+    queue->mask = capacity - 1;
+    atomic_init(&queue->enqueue_pos, 0);
+    atomic_init(&queue->dequeue_pos, 0);
+    return 0;
+}
+
+void _anjay_notify_change_queue_cleanup(anjay_unlocked_t *anjay) {
+    anjay_notify_change_queue_t *queue = get_change_queue(anjay);
+    avs_free(queue->entries);
+    queue->entries = NULL;
+}
+
+/**
+ * Reserves a free entry using compare-and-swap on enqueue_pos, and publishes
+ * it by storing the next sequence number with release semantics, so that the
+ * consumer never sees a partially written entry. Never blocks - returns -1 if
+ * the queue is full.
+ */
+static int change_queue_push(anjay_notify_change_queue_t *queue,
+                             anjay_oid_t oid,
+                             anjay_iid_t iid,
+                             anjay_rid_t rid) {
+    if (!queue->entries) {
+        return -1;
+    }
+    size_t pos = atomic_load_explicit(&queue->enqueue_pos,
+                                      memory_order_relaxed);
+    anjay_notify_change_queue_entry_t *entry;
+    while (true) {
+        entry = &queue->entries[pos & queue->mask];
+        size_t sequence =
+                atomic_load_explicit(&entry->sequence, memory_order_acquire);
+        if (sequence == pos) {
+            if (atomic_compare_exchange_weak_explicit(
+                        &queue->enqueue_pos, &pos, pos + 1,
+                        memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+            // pos has been updated by the failed CAS
+        } else if ((ptrdiff_t) (sequence - pos) < 0) {
+            // the entry still holds a change from the previous lap: full
+            return -1;
+        } else {
+            pos = atomic_load_explicit(&queue->enqueue_pos,
+                                       memory_order_relaxed);
+        }
+    }
+    entry->oid = oid;
+    entry->iid = iid;
+    entry->rid = rid;
+    atomic_store_explicit(&entry->sequence, pos + 1, memory_order_release);
+    return 0;
+}
+
+bool _anjay_notify_change_queue_pending(anjay_t *anjay) {
+    anjay_notify_change_queue_t *queue =
+            &anjay->atomic_fields.notify_change_queue;
+    return atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed)
+           != atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+}
+
+void _anjay_notify_change_queue_drain(anjay_unlocked_t *anjay) {
+    anjay_notify_change_queue_t *queue = get_change_queue(anjay);
+    if (!queue->entries) {
+        return;
+    }
+    size_t pos =
+            atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    while (true) {
+        anjay_notify_change_queue_entry_t *entry =
+                &queue->entries[pos & queue->mask];
+        if (atomic_load_explicit(&entry->sequence, memory_order_acquire)
+                != pos + 1) {
+            // empty, or the producer has not finished writing the entry yet
+            break;
+        }
+        // the entry is only released after the change is queued, so that it
+        // is retried during the next drain instead of being lost
+        int result = (entry->iid == ANJAY_ID_INVALID)
+                             ? _anjay_notify_instances_changed_unlocked(
+                                       anjay, entry->oid)
+                             : _anjay_notify_changed_unlocked(
+                                       anjay, entry->oid, entry->iid,
+                                       entry->rid);
+        if (result) {
+            anjay_log(WARNING,
+                      _("could not queue change of object ") "%" PRIu16
+                      _(" reported from another thread, will retry"),
+                      entry->oid);
+            break;
+        }
+        atomic_store_explicit(&entry->sequence, pos + queue->mask + 1,
+                              memory_order_release);
+        ++pos;
+    }
+    atomic_store_explicit(&queue->dequeue_pos, pos, memory_order_relaxed);
+}
+#endif // ANJAY_WITH_LOCK_FREE_NOTIFY
+
 int anjay_notify_changed(anjay_t *anjay_locked,
                          anjay_oid_t oid,
                          anjay_iid_t iid,
                          anjay_rid_t rid) {
+#ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+    if (anjay_locked && iid != ANJAY_ID_INVALID
+            && !change_queue_push(&anjay_locked->atomic_fields
+                                           .notify_change_queue,
+                                  oid, iid, rid)) {
+        return 0;
+    }
+#endif // ANJAY_WITH_LOCK_FREE_NOTIFY
     int retval = -1;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     retval = _anjay_notify_changed_unlocked(anjay, oid, iid, rid);
@@ -390,16 +670,110 @@ int anjay_notify_changed(anjay_t *anjay_locked,
     return retval;
 }
 
+static int compare_resource_paths(const void *left_, const void *right_) {
+    const anjay_notify_resource_path_t *left =
+            (const anjay_notify_resource_path_t *) left_;
+    const anjay_notify_resource_path_t *right =
+            (const anjay_notify_resource_path_t *) right_;
+    int result = left->oid - right->oid;
+    if (!result) {
+        result = left->iid - right->iid;
+    }
+    if (!result) {
+        result = left->rid - right->rid;
+    }
+    return result;
+}
+
+static int
+notify_changed_sorted(anjay_unlocked_t *anjay,
+                      const anjay_notify_resource_path_t *paths,
+                      size_t path_count,
+                      anjay_notify_queue_resource_entry_t *entries_buf) {
+    int retval = 0;
+    avs_time_duration_t window = anjay->scheduled_notify.debounce_window;
+    size_t i = 0;
+    while (!retval && i < path_count) {
+        const anjay_oid_t oid = paths[i].oid;
+        size_t entry_count = 0;
+        for (; i < path_count && paths[i].oid == oid; ++i) {
+            entries_buf[entry_count].iid = paths[i].iid;
+            entries_buf[entry_count].rid = paths[i].rid;
+            ++entry_count;
+            if (anjay->scheduled_notify.debounce_overrides) {
+                const avs_time_duration_t path_window = debounce_window(
+                        anjay,
+                        &MAKE_RESOURCE_PATH(oid, paths[i].iid, paths[i].rid));
+                if (avs_time_duration_less(path_window, window)) {
+                    window = path_window;
+                }
+            }
+            _anjay_dm_cache_invalidate_values(anjay, oid, paths[i].iid,
+                                              paths[i].rid);
+        }
+        _anjay_dm_cache_invalidate_resources(anjay, oid);
+        retval = _anjay_notify_queue_resource_changes(
+                &anjay->scheduled_notify.queue, oid, entries_buf, entry_count);
+    }
+    if (anjay->scheduled_notify.queue) {
+        // some of the changes might have been queued even in case of error
+        _anjay_update_ret(&retval, reschedule_notify(anjay, window));
+    }
+    return retval;
+}
+
+int anjay_notify_changed_multiple(anjay_t *anjay_locked,
+                                  const anjay_notify_resource_path_t *paths,
+                                  size_t path_count) {
+    if (!path_count) {
+        return 0;
+    }
+    assert(paths);
+    anjay_notify_resource_path_t *sorted_paths =
+            (anjay_notify_resource_path_t *) avs_malloc(
+                    path_count * sizeof(*sorted_paths));
+    anjay_notify_queue_resource_entry_t *entries_buf =
+            (anjay_notify_queue_resource_entry_t *) avs_malloc(
+                    path_count * sizeof(*entries_buf));
+    int retval = -1;
+    if (!sorted_paths || !entries_buf) {
+        _anjay_log_oom();
+    } else {
+        memcpy(sorted_paths, paths, path_count * sizeof(*sorted_paths));
+        qsort(sorted_paths, path_count, sizeof(*sorted_paths),
+              compare_resource_paths);
+        ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+        retval = notify_changed_sorted(anjay, sorted_paths, path_count,
+                                       entries_buf);
+        ANJAY_MUTEX_UNLOCK(anjay_locked);
+    }
+    avs_free(sorted_paths);
+    avs_free(entries_buf);
+    return retval;
+}
+
 int _anjay_notify_instances_changed_unlocked(anjay_unlocked_t *anjay,
                                              anjay_oid_t oid) {
+    _anjay_dm_cache_invalidate_instances(anjay, oid);
+    _anjay_dm_cache_reset_free_iid_hint(anjay, oid);
     int retval;
     (void) ((retval = _anjay_notify_queue_instance_set_unknown_change(
                      &anjay->scheduled_notify.queue, oid))
-            || (retval = reschedule_notify(anjay)));
+            || (retval = reschedule_notify(
+                        anjay,
+                        debounce_window(anjay, &MAKE_OBJECT_PATH(oid)))));
     return retval;
 }
 
 int anjay_notify_instances_changed(anjay_t *anjay_locked, anjay_oid_t oid) {
+#ifdef ANJAY_WITH_LOCK_FREE_NOTIFY
+    if (anjay_locked
+            && !change_queue_push(&anjay_locked->atomic_fields
+                                           .notify_change_queue,
+                                  oid, ANJAY_ID_INVALID, ANJAY_ID_INVALID)) {
+        return 0;
+    }
+#endif // ANJAY_WITH_LOCK_FREE_NOTIFY
     int retval = -1;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     retval = _anjay_notify_instances_changed_unlocked(anjay, oid);
@@ -407,6 +781,49 @@ int anjay_notify_instances_changed(anjay_t *anjay_locked, anjay_oid_t oid) {
     return retval;
 }
 
+int anjay_set_notify_debounce(anjay_t *anjay_locked,
+                              anjay_oid_t oid,
+                              anjay_iid_t iid,
+                              anjay_rid_t rid,
+                              avs_time_duration_t window) {
+    if (oid == ANJAY_ID_INVALID
+            || (iid == ANJAY_ID_INVALID && rid != ANJAY_ID_INVALID)) {
+        anjay_log(ERROR, _("invalid path for notify debounce window"));
+        return -1;
+    }
+    if (avs_time_duration_less(window, AVS_TIME_DURATION_ZERO)) {
+        anjay_log(ERROR, _("notify debounce window must not be negative"));
+        return -1;
+    }
+    const anjay_uri_path_t path =
+            MAKE_URI_PATH(oid, iid, rid, ANJAY_ID_INVALID);
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_notify_debounce_override_t) *entry_ptr;
+    AVS_LIST_FOREACH_PTR(entry_ptr,
+                         &anjay->scheduled_notify.debounce_overrides) {
+        if (_anjay_uri_path_equal(&(*entry_ptr)->path, &path)) {
+            break;
+        }
+    }
+    if (!avs_time_duration_valid(window)) {
+        if (*entry_ptr) {
+            AVS_LIST_DELETE(entry_ptr);
+        }
+        result = 0;
+    } else if (*entry_ptr
+               || AVS_LIST_INSERT_NEW(anjay_notify_debounce_override_t,
+                                      entry_ptr)) {
+        (*entry_ptr)->path = path;
+        (*entry_ptr)->window = window;
+        result = 0;
+    } else {
+        _anjay_log_oom();
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
 #ifdef ANJAY_WITH_OBSERVATION_STATUS
 anjay_resource_observation_status_t
 anjay_resource_observation_status(anjay_t *anjay_locked,
@@ -452,4 +869,21 @@ anjay_resource_observation_status(anjay_t *anjay_locked,
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return retval;
 }
+
+anjay_server_observation_stats_t
+anjay_server_observation_stats(anjay_t *anjay_locked, anjay_ssid_t ssid) {
+    anjay_server_observation_stats_t retval = {
+        .observation_count = 0,
+        .queue_depth = 0,
+        .next_trigger = AVS_TIME_REAL_INVALID
+    };
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    retval = _anjay_observe_server_stats(anjay, ssid);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return retval;
+}
 #endif // ANJAY_WITH_OBSERVATION_STATUS
+
+#if defined(ANJAY_TEST) && defined(ANJAY_WITH_LOCK_FREE_NOTIFY)
+#    include "tests/core/notify.c"
+#endif // defined(ANJAY_TEST) && defined(ANJAY_WITH_LOCK_FREE_NOTIFY)
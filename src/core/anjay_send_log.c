@@ -0,0 +1,304 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_SEND_PERSISTENCE
+
+#    include <assert.h>
+#    include <inttypes.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_persistence.h>
+#    include <avsystem/commons/avs_stream_inbuf.h>
+#    include <avsystem/commons/avs_stream_membuf.h>
+
+#    include "anjay_core.h"
+#    include "anjay_send_log.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#    define send_log(...) _anjay_log(anjay_send, __VA_ARGS__)
+
+/**
+ * Each record starts with a header consisting of (all big-endian):
+ * - record type (1 byte),
+ * - record ID (4 bytes),
+ * - target SSID (2 bytes),
+ * - payload length (4 bytes).
+ *
+ * Payload of a batch record is the batch stored using _anjay_batch_persist().
+ * Discard records have no payload; their ID is the one of the discarded batch
+ * record.
+ */
+#    define RECORD_HEADER_SIZE 11
+
+typedef enum {
+    RECORD_TYPE_BATCH = 'B',
+    RECORD_TYPE_DISCARD = 'D'
+} record_type_t;
+
+typedef struct {
+    record_type_t type;
+    uint32_t id;
+    anjay_ssid_t ssid;
+    uint32_t payload_length;
+} record_header_t;
+
+static void encode_header(uint8_t *out, const record_header_t *header) {
+    out[0] = (uint8_t) header->type;
+    for (size_t i = 0; i < 4; ++i) {
+        out[1 + i] = (uint8_t) (header->id >> (8 * (3 - i)));
+        out[7 + i] = (uint8_t) (header->payload_length >> (8 * (3 - i)));
+    }
+    out[5] = (uint8_t) (header->ssid >> 8);
+    out[6] = (uint8_t) header->ssid;
+}
+
+static int decode_header(record_header_t *out, const uint8_t *data) {
+    if (data[0] != RECORD_TYPE_BATCH && data[0] != RECORD_TYPE_DISCARD) {
+        return -1;
+    }
+    *out = (record_header_t) {
+        .type = (record_type_t) data[0],
+        .ssid = (anjay_ssid_t) ((data[5] << 8) | data[6])
+    };
+    for (size_t i = 1; i < 5; ++i) {
+        out->id = (out->id << 8) | data[i];
+        out->payload_length = (out->payload_length << 8) | data[i + 6];
+    }
+    if (out->type == RECORD_TYPE_DISCARD && out->payload_length) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @returns 0 if @p length bytes have been read, 1 if there is nothing to read
+ *          at @p offset , or -1 in case of error or if the read is truncated.
+ */
+static int read_at(const anjay_send_log_handlers_t *handlers,
+                   void *arg,
+                   size_t offset,
+                   void *buf,
+                   size_t length) {
+    size_t bytes_read = 0;
+    if (handlers->read(arg, offset, buf, length, &bytes_read)) {
+        send_log(ERROR, _("could not read the log at offset ") "%lu",
+                 (unsigned long) offset);
+        return -1;
+    }
+    if (!bytes_read && length) {
+        return 1;
+    }
+    if (bytes_read != length) {
+        send_log(ERROR, _("truncated record at offset ") "%lu",
+                 (unsigned long) offset);
+        return -1;
+    }
+    return 0;
+}
+
+static int read_header(const anjay_send_log_handlers_t *handlers,
+                       void *arg,
+                       size_t offset,
+                       record_header_t *out_header) {
+    uint8_t data[RECORD_HEADER_SIZE];
+    int result = read_at(handlers, arg, offset, data, sizeof(data));
+    if (!result && decode_header(out_header, data)) {
+        send_log(ERROR, _("malformed record at offset ") "%lu",
+                 (unsigned long) offset);
+        return -1;
+    }
+    return result;
+}
+
+int _anjay_send_log_open(anjay_send_log_t *log,
+                         const anjay_send_log_handlers_t *handlers,
+                         void *arg,
+                         anjay_send_log_restore_clb_t *restore_clb,
+                         anjay_send_log_discard_clb_t *discard_clb,
+                         void *clb_arg) {
+    assert(handlers);
+    uint32_t next_id = 0;
+    size_t offset = 0;
+    while (true) {
+        record_header_t header;
+        int result = read_header(handlers, arg, offset, &header);
+        if (result > 0) {
+            break;
+        } else if (result) {
+            return -1;
+        }
+        if (header.payload_length) {
+            // only check that the whole payload is there; batches themselves
+            // are read when needed
+            uint8_t last_byte;
+            if (read_at(handlers, arg,
+                        offset + RECORD_HEADER_SIZE + header.payload_length - 1,
+                        &last_byte, 1)) {
+                send_log(ERROR, _("truncated record at offset ") "%lu",
+                         (unsigned long) offset);
+                return -1;
+            }
+        }
+        if (header.type == RECORD_TYPE_BATCH) {
+            if (restore_clb(clb_arg, header.ssid,
+                            &(const anjay_send_log_record_t) {
+                                .id = header.id,
+                                .offset = offset
+                            })) {
+                return -1;
+            }
+            if (header.id >= next_id) {
+                next_id = header.id + 1;
+            }
+        } else {
+            discard_clb(clb_arg, header.id);
+        }
+        offset += RECORD_HEADER_SIZE + header.payload_length;
+    }
+    *log = (anjay_send_log_t) {
+        .handlers = handlers,
+        .arg = arg,
+        .end_offset = offset,
+        .next_id = next_id
+    };
+    return 0;
+}
+
+static int append_record(anjay_send_log_t *log, void *data, size_t size) {
+    if (log->handlers->append(log->arg, data, size)) {
+        send_log(ERROR, _("could not append to the log"));
+        return -1;
+    }
+    log->end_offset += size;
+    return 0;
+}
+
+int _anjay_send_log_append(anjay_send_log_t *log,
+                           anjay_ssid_t ssid,
+                           const anjay_batch_t *batch,
+                           anjay_send_log_record_t *out_record) {
+    assert(_anjay_send_log_enabled(log));
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    if (!membuf) {
+        _anjay_log_oom();
+        return -1;
+    }
+    avs_persistence_context_t ctx =
+            avs_persistence_store_context_create(membuf);
+    uint8_t placeholder[RECORD_HEADER_SIZE] = { 0 };
+    void *data = NULL;
+    size_t size = 0;
+    if (avs_is_err(avs_stream_write(membuf, placeholder, sizeof(placeholder)))
+            || avs_is_err(_anjay_batch_persist(&ctx, batch))
+            || avs_is_err(
+                       avs_stream_membuf_take_ownership(membuf, &data, &size))
+            || size - RECORD_HEADER_SIZE > UINT32_MAX) {
+        send_log(ERROR, _("could not serialize batch"));
+        avs_stream_cleanup(&membuf);
+        avs_free(data);
+        return -1;
+    }
+    avs_stream_cleanup(&membuf);
+
+    encode_header((uint8_t *) data,
+                  &(const record_header_t) {
+                      .type = RECORD_TYPE_BATCH,
+                      .id = log->next_id,
+                      .ssid = ssid,
+                      .payload_length = (uint32_t) (size - RECORD_HEADER_SIZE)
+                  });
+    const size_t offset = log->end_offset;
+    int result = append_record(log, data, size);
+    avs_free(data);
+    if (!result) {
+        *out_record = (anjay_send_log_record_t) {
+            .id = log->next_id++,
+            .offset = offset
+        };
+    }
+    return result;
+}
+
+int _anjay_send_log_read(anjay_send_log_t *log,
+                         const anjay_send_log_record_t *record,
+                         anjay_batch_t **out_batch) {
+    assert(_anjay_send_log_enabled(log));
+    assert(record->offset >= log->discarded_size);
+    const size_t offset = record->offset - log->discarded_size;
+    record_header_t header;
+    if (read_header(log->handlers, log->arg, offset, &header)
+            || header.type != RECORD_TYPE_BATCH || header.id != record->id) {
+        send_log(ERROR, _("batch record ") "%" PRIu32 _(" not found"),
+                 record->id);
+        return -1;
+    }
+    void *payload = avs_malloc(header.payload_length ? header.payload_length
+                                                     : 1);
+    if (!payload) {
+        _anjay_log_oom();
+        return -1;
+    }
+    int result = -1;
+    if (!read_at(log->handlers, log->arg, offset + RECORD_HEADER_SIZE, payload,
+                 header.payload_length)) {
+        avs_stream_inbuf_t inbuf = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+        avs_stream_inbuf_set_buffer(&inbuf, payload, header.payload_length);
+        avs_persistence_context_t ctx =
+                avs_persistence_restore_context_create((avs_stream_t *) &inbuf);
+        if (avs_is_ok(_anjay_batch_restore(&ctx, out_batch))) {
+            result = 0;
+        } else {
+            send_log(ERROR, _("could not restore batch record ") "%" PRIu32,
+                     record->id);
+        }
+    }
+    avs_free(payload);
+    return result;
+}
+
+int _anjay_send_log_mark_discarded(anjay_send_log_t *log,
+                                   const anjay_send_log_record_t *record) {
+    assert(_anjay_send_log_enabled(log));
+    uint8_t data[RECORD_HEADER_SIZE];
+    encode_header(data, &(const record_header_t) {
+                            .type = RECORD_TYPE_DISCARD,
+                            .id = record->id
+                        });
+    return append_record(log, data, sizeof(data));
+}
+
+int _anjay_send_log_compact(anjay_send_log_t *log,
+                            const size_t *oldest_live_offset) {
+    assert(_anjay_send_log_enabled(log));
+    const size_t new_start =
+            oldest_live_offset ? *oldest_live_offset : log->end_offset;
+    assert(new_start >= log->discarded_size);
+    assert(new_start <= log->end_offset);
+    const size_t dead_size = new_start - log->discarded_size;
+    if (!dead_size || dead_size < log->end_offset - new_start) {
+        return 0;
+    }
+    if (log->handlers->discard(log->arg, dead_size)) {
+        send_log(WARNING, _("could not discard ") "%lu" _(" bytes of the log"),
+                 (unsigned long) dead_size);
+        return -1;
+    }
+    log->discarded_size = new_start;
+    return 0;
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/core/send_log.c"
+#    endif // ANJAY_TEST
+
+#endif // ANJAY_WITH_SEND_PERSISTENCE
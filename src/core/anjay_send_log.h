@@ -0,0 +1,115 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_SEND_LOG_H
+#define ANJAY_SEND_LOG_H
+
+#include <anjay_init.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <anjay/lwm2m_send.h>
+
+#include "io/anjay_batch_builder.h"
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+#ifdef ANJAY_WITH_SEND_PERSISTENCE
+
+/**
+ * Location of a batch record in the log.
+ */
+typedef struct {
+    uint32_t id;
+    /**
+     * Offset of the record, counted from the beginning of the log at the time
+     * it was opened, so that it does not change when the oldest part of the log
+     * is discarded.
+     */
+    size_t offset;
+} anjay_send_log_record_t;
+
+/**
+ * Persistent log of deferred Send requests, stored using
+ * @ref anjay_send_log_handlers_t . It is a sequence of two types of records:
+ * - batch records, containing the target SSID and the serialized batch,
+ * - discard records, marking the batch record with a given ID as no longer
+ *   needed.
+ */
+typedef struct {
+    /** NULL if the log is not used. */
+    const anjay_send_log_handlers_t *handlers;
+    void *arg;
+    /** Number of bytes discarded from the beginning of the log. */
+    size_t discarded_size;
+    /** Offset at which the next record will be appended. */
+    size_t end_offset;
+    uint32_t next_id;
+} anjay_send_log_t;
+
+static inline bool _anjay_send_log_enabled(const anjay_send_log_t *log) {
+    return log->handlers != NULL;
+}
+
+typedef int anjay_send_log_restore_clb_t(void *arg,
+                                         anjay_ssid_t ssid,
+                                         const anjay_send_log_record_t *record);
+
+typedef void anjay_send_log_discard_clb_t(void *arg, uint32_t id);
+
+/**
+ * Opens the log stored using @p handlers , and calls @p restore_clb for each
+ * batch record and @p discard_clb for each discard record found in it, in
+ * order. Batches themselves are not read.
+ *
+ * @returns 0 on success, or a negative value if the log could not be read,
+ *          it is malformed, or @p restore_clb failed. @p log is left unchanged
+ *          in that case.
+ */
+int _anjay_send_log_open(anjay_send_log_t *log,
+                         const anjay_send_log_handlers_t *handlers,
+                         void *arg,
+                         anjay_send_log_restore_clb_t *restore_clb,
+                         anjay_send_log_discard_clb_t *discard_clb,
+                         void *clb_arg);
+
+int _anjay_send_log_append(anjay_send_log_t *log,
+                           anjay_ssid_t ssid,
+                           const anjay_batch_t *batch,
+                           anjay_send_log_record_t *out_record);
+
+/**
+ * Reads the batch stored in @p record into a newly compiled batch.
+ */
+int _anjay_send_log_read(anjay_send_log_t *log,
+                         const anjay_send_log_record_t *record,
+                         anjay_batch_t **out_batch);
+
+/**
+ * Appends a discard record for @p record .
+ */
+int _anjay_send_log_mark_discarded(anjay_send_log_t *log,
+                                   const anjay_send_log_record_t *record);
+
+/**
+ * Discards the part of the log that precedes @p oldest_live_offset , if it is
+ * at least as large as the rest of the log. If @p oldest_live_offset is NULL
+ * (i.e. there are no batch records that are still needed), the whole log is
+ * discarded.
+ */
+int _anjay_send_log_compact(anjay_send_log_t *log,
+                            const size_t *oldest_live_offset);
+
+#endif // ANJAY_WITH_SEND_PERSISTENCE
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif // ANJAY_SEND_LOG_H
@@ -13,6 +13,7 @@
 #include <anjay/core.h>
 
 #include <anjay_modules/anjay_sched.h>
+#include <anjay_modules/anjay_sha256.h>
 #include <anjay_modules/anjay_servers.h>
 
 #include <avsystem/commons/avs_persistence.h>
@@ -81,6 +82,48 @@ _anjay_conn_session_tokens_equal(anjay_conn_session_token_t left,
     return avs_time_monotonic_equal(left.value, right.value);
 }
 
+#ifdef ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+/**
+ * DTLS session read by anjay_dtls_sessions_restore(), waiting for the
+ * connection it belongs to to be recreated.
+ */
+typedef struct {
+    anjay_ssid_t ssid;
+    anjay_connection_type_t conn_type;
+    // contents of the session resumption buffer, with trailing zeros stripped
+    size_t session_size;
+    char session[ANJAY_DTLS_SESSION_BUFFER_SIZE];
+} anjay_dtls_session_restored_t;
+#endif // ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+
+typedef struct {
+    avs_net_socket_t *socket;
+    anjay_server_info_t *server;
+} anjay_servers_index_socket_entry_t;
+
+/**
+ * Lookup index over anjay_unlocked_t::servers, used to avoid walking the whole
+ * list in _anjay_servers_find(), _anjay_servers_find_active(),
+ * _anjay_servers_find_active_by_security_iid() and
+ * _anjay_servers_find_by_primary_socket(). It is rebuilt lazily on the first
+ * lookup after the server list, the last used Security IIDs or the socket set
+ * have changed.
+ */
+typedef struct {
+    bool valid;
+    size_t servers_version;
+    size_t socket_set_version;
+    size_t capacity;
+    size_t servers_count;
+    /** All known servers, sorted by SSID */
+    anjay_server_info_t **by_ssid;
+    /** All known servers, sorted by last used Security IID, then by SSID */
+    anjay_server_info_t **by_security_iid;
+    size_t sockets_count;
+    /** Servers with a primary socket, sorted by the socket pointer */
+    anjay_servers_index_socket_entry_t *by_socket;
+} anjay_servers_index_t;
+
 // 6.2.2 Object Version format:
 // "The Object Version of an Object is composed of 2 digits separated by a dot"
 // However, we're a bit lenient to support proper numbers and not just digits.
@@ -92,9 +135,28 @@ typedef struct {
     AVS_LIST(anjay_iid_t) instances;
 } anjay_dm_cache_object_t;
 
+/**
+ * Identifies the CoRE Link Format list of Objects and Object Instances sent in
+ * Register and Update messages. The list itself may be arbitrarily large, so
+ * only its fingerprint is kept to detect changes.
+ */
+typedef struct {
+    /** False if the list has not been queried. */
+    bool valid;
+    size_t size;
+    uint8_t digest[ANJAY_SHA256_DIGEST_SIZE];
+    /** Object links cache generation at which the list was queried. */
+    uint32_t generation;
+} anjay_dm_links_fingerprint_t;
+
 typedef struct {
     int64_t lifetime_s;
-    char *dm;
+    anjay_dm_links_fingerprint_t dm;
+    /**
+     * The list itself, if it was short enough to be kept in memory. NULL if it
+     * is generated from the data model for each transmitted block instead.
+     */
+    char *dm_payload;
     anjay_binding_mode_t binding_mode;
 } anjay_update_parameters_t;
 
@@ -123,6 +185,17 @@ typedef struct {
 #endif // ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
 } anjay_registration_info_t;
 
+#ifdef ANJAY_WITH_STATE_PERSISTENCE
+/**
+ * Registration state read by anjay_state_restore(), waiting for the server
+ * entry it belongs to to be created.
+ */
+typedef struct {
+    anjay_ssid_t ssid;
+    anjay_registration_info_t info;
+} anjay_registration_restored_t;
+#endif // ANJAY_WITH_STATE_PERSISTENCE
+
 ////////////////////////////////////////////////////////////////////////////////
 // METHODS ON THE WHOLE SERVERS SUBSYSTEM //////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
@@ -183,11 +256,8 @@ typedef int anjay_servers_foreach_ssid_handler_t(anjay_unlocked_t *anjay,
  * cached since last reload, the data model is NOT queried directly) and returns
  * their SSIDs.
  *
- * Currently used in two places:
- * - access_control_utils.c :: is_single_ssid_environment() - to determine
- *   whether Access Control is even applicable
- * - _anjay_observe_gc() - to determine for which SSIDs to keep observe request
- *   information
+ * Currently used in access_control_utils.c :: is_single_ssid_environment() -
+ * to determine whether Access Control is even applicable.
  */
 int _anjay_servers_foreach_ssid(anjay_unlocked_t *anjay,
                                 anjay_servers_foreach_ssid_handler_t *handler,
@@ -264,11 +334,10 @@ int _anjay_servers_foreach_active(anjay_unlocked_t *anjay,
  *    reloaded, move the untouched remainder of servers that existed before
  *    reloading to the current state, and reschedule whole procedure after
  *    5 seconds.
- * 4. Call _anjay_observe_gc() to remove observation entries for servers that
- *    ceased to exist.
- * 5. Call Deregister on all servers that ceased to exist but were previously
+ * 4. Call Deregister on all servers that ceased to exist but were previously
  *    active.
- * 6. Clean up.
+ * 5. Clean up. This includes removing observation entries for servers that
+ *    ceased to exist, see _anjay_observe_server_removed().
  *
  * The "server reactivation" procedure is performed within the
  * activate_server_job() function and basically consists of the following:
@@ -401,6 +470,28 @@ _anjay_server_primary_session_token(anjay_server_info_t *server);
 const anjay_registration_info_t *
 _anjay_server_registration_info(anjay_server_info_t *server);
 
+/**
+ * Returns the time at which the next Registration Update is planned to be sent
+ * to @p server, or AVS_TIME_REAL_INVALID if there is none.
+ */
+avs_time_real_t _anjay_server_next_update_time(anjay_server_info_t *server);
+
+/**
+ * Returns the length of the window into which the activities planned for
+ * @p server shall be aligned, as configured through
+ * anjay_configuration_t::queue_mode_wake_window, or zero if the client does
+ * not operate in queue mode with that server.
+ */
+avs_time_duration_t _anjay_server_wake_window(anjay_server_info_t *server);
+
+/**
+ * Implementation of anjay_next_planned_lifecycle_operation() for callers that
+ * already hold the Anjay mutex.
+ */
+avs_time_real_t
+_anjay_next_planned_lifecycle_operation_unlocked(anjay_unlocked_t *anjay,
+                                                 anjay_ssid_t ssid);
+
 /**
  * Updates the registration information (the same that can be queried through
  * _anjay_server_registration_info()) within the server. The endpoint path and
@@ -460,16 +551,26 @@ const anjay_url_t *_anjay_connection_uri(anjay_connection_ref_t ref);
 
 #ifdef ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
 #    define _anjay_connection_schedule_queue_mode_close(...) ((void) 0)
+#    define _anjay_connection_queue_mode_request_received(...) ((void) 0)
 #else  // ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
 /**
  * This function schedules closing of the socket (suspending the connection)
- * after MAX_TRANSMIT_WAIT passes. It is supposed to be called after finishing
- * each interaction with a server - generally after each call to
+ * after MAX_TRANSMIT_WAIT passes, or earlier if
+ * anjay_configuration_t::queue_mode_adaptive_close is enabled. It is supposed
+ * to be called after finishing each interaction with a server - generally
+ * after each call to
  * avs_coap_streaming_handle_incoming_packet(),
  * avs_coap_client_send_async_request(), avs_coap_notify_async(), as well as
  * after (re)connecting a socket even if no outgoing message is being sent.
  */
 void _anjay_connection_schedule_queue_mode_close(anjay_connection_ref_t ref);
+
+/**
+ * Records that a request has been received from the server while waiting for
+ * the queue mode socket closure, so that the closure delay can be adapted if
+ * anjay_configuration_t::queue_mode_adaptive_close is enabled.
+ */
+void _anjay_connection_queue_mode_request_received(anjay_connection_ref_t ref);
 #endif // ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
 
 /**
@@ -501,6 +602,39 @@ bool _anjay_connection_ready_for_outgoing_message(anjay_connection_ref_t ref);
  */
 void _anjay_connection_mark_stable(anjay_connection_ref_t ref);
 
+#ifdef WITH_AVS_COAP_UDP
+/**
+ * Functions feeding the NAT binding lifetime measurement used if
+ * anjay_configuration_t::udp_nat_keepalive is enabled. All of them do nothing
+ * if it is not. Successful exchanges are reported through
+ * _anjay_connection_mark_stable().
+ *
+ * - _anjay_connection_udp_nat_request_sent() shall be called after sending a
+ *   request (Update or confirmable notification) whose failure is reported to
+ *   _anjay_connection_udp_nat_request_failed(),
+ * - _anjay_connection_udp_nat_request_received() shall be called when
+ *   a request is received from the server.
+ */
+void _anjay_connection_udp_nat_request_sent(anjay_connection_ref_t ref);
+
+void _anjay_connection_udp_nat_request_failed(anjay_connection_ref_t ref,
+                                              avs_error_t err);
+
+void _anjay_connection_udp_nat_request_received(anjay_connection_ref_t ref);
+
+/**
+ * Returns the time before which traffic shall be exchanged with the server to
+ * keep the NAT binding on the path alive, or AVS_TIME_MONOTONIC_INVALID if it
+ * is unknown or irrelevant.
+ */
+avs_time_monotonic_t
+_anjay_connection_udp_nat_keepalive_deadline(anjay_connection_ref_t ref);
+#else  // WITH_AVS_COAP_UDP
+#    define _anjay_connection_udp_nat_request_sent(...) ((void) 0)
+#    define _anjay_connection_udp_nat_request_failed(...) ((void) 0)
+#    define _anjay_connection_udp_nat_request_received(...) ((void) 0)
+#endif // WITH_AVS_COAP_UDP
+
 /**
  * This function only makes sense when the connection is in a suspended (active
  * but not online) state. It rebinds and reconnects the socket. Data model is
@@ -536,6 +670,31 @@ _anjay_connection_transport(anjay_connection_ref_t conn_ref);
 AVS_LIST(const anjay_socket_entry_t)
 _anjay_collect_socket_entries(anjay_unlocked_t *anjay, bool include_offline);
 
+/**
+ * Notes that the set of online sockets, or their system descriptors, may have
+ * changed. Needs to be called whenever a socket is connected, closed or cleaned
+ * up.
+ */
+void _anjay_socket_set_changed(anjay_unlocked_t *anjay);
+
+/**
+ * Notes that the contents of anjay_unlocked_t::servers, or the Security IIDs
+ * associated with them, may have changed, invalidating the lookup index.
+ */
+void _anjay_servers_changed(anjay_unlocked_t *anjay);
+
+/**
+ * Returns a value that changes whenever the result of
+ * _anjay_collect_socket_entries() with include_offline == false may have
+ * changed, allowing to reuse the previously collected list as long as it stays
+ * the same.
+ *
+ * NOTE: If the downloader uses more than ANJAY_DOWNLOADER_TRACKED_SOCKETS
+ * sockets of its own, they are not tracked precisely, so the version changes
+ * on each call while such downloads are in progress.
+ */
+size_t _anjay_socket_set_version(anjay_unlocked_t *anjay);
+
 #ifdef ANJAY_WITH_CONN_STATUS_API
 /**
  * Set connection status for the server specified by the server argument. This
@@ -554,6 +713,33 @@ void _anjay_set_server_connection_status(anjay_server_info_t *server,
 void _anjay_check_server_connection_status(anjay_server_info_t *server);
 #endif // ANJAY_WITH_CONN_STATUS_API
 
+#ifdef ANJAY_WITH_STATE_PERSISTENCE
+/**
+ * Writes the registration state of all servers with a valid registration,
+ * as well as the entries restored earlier, but not used yet, to @p out_stream.
+ */
+avs_error_t _anjay_registrations_persist(anjay_unlocked_t *anjay,
+                                         avs_stream_t *out_stream);
+
+/**
+ * Reads registration state written by _anjay_registrations_persist(). Each of
+ * the entries is applied when the server entry with the matching SSID is
+ * created, see _anjay_servers_create_inactive(). Entries restored previously,
+ * but not used yet, are discarded.
+ */
+avs_error_t _anjay_registrations_restore(anjay_unlocked_t *anjay,
+                                         avs_stream_t *in_stream);
+
+void _anjay_registrations_restored_cleanup(
+        AVS_LIST(anjay_registration_restored_t) *entries);
+
+/**
+ * Moves the registration state restored for the server's SSID, if any, into
+ * its registration info.
+ */
+void _anjay_server_apply_restored_registration(anjay_server_info_t *server);
+#endif // ANJAY_WITH_STATE_PERSISTENCE
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif // ANJAY_SERVERS_PRIVATE_H
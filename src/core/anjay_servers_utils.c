@@ -21,104 +21,6 @@
 
 VISIBILITY_SOURCE_BEGIN
 
-typedef struct {
-    avs_net_socket_t *socket;
-    anjay_server_info_t *out;
-} find_by_primary_socket_args_t;
-
-static int find_by_primary_socket_clb(anjay_unlocked_t *anjay,
-                                      anjay_server_info_t *server,
-                                      void *args_) {
-    (void) anjay;
-    find_by_primary_socket_args_t *args =
-            (find_by_primary_socket_args_t *) args_;
-    const anjay_connection_ref_t ref = {
-        .server = server,
-        .conn_type = ANJAY_CONNECTION_PRIMARY
-    };
-    if (_anjay_connection_get_online_socket(ref) == args->socket) {
-        args->out = server;
-        return ANJAY_FOREACH_BREAK;
-    }
-    return ANJAY_FOREACH_CONTINUE;
-}
-
-anjay_server_info_t *
-_anjay_servers_find_by_primary_socket(anjay_unlocked_t *anjay,
-                                      avs_net_socket_t *socket) {
-    assert(socket);
-    find_by_primary_socket_args_t arg = {
-        .socket = socket,
-        .out = NULL
-    };
-    if (_anjay_servers_foreach_active(anjay, find_by_primary_socket_clb,
-                                      &arg)) {
-        return NULL;
-    }
-    return arg.out;
-}
-
-typedef struct {
-    anjay_ssid_t ssid;
-    anjay_server_info_t *out;
-} find_active_args_t;
-
-static int find_active_clb(anjay_unlocked_t *anjay,
-                           anjay_server_info_t *server,
-                           void *args_) {
-    (void) anjay;
-    find_active_args_t *args = (find_active_args_t *) args_;
-    if (_anjay_server_ssid(server) == args->ssid) {
-        args->out = server;
-        return ANJAY_FOREACH_BREAK;
-    }
-    return ANJAY_FOREACH_CONTINUE;
-}
-
-anjay_server_info_t *_anjay_servers_find_active(anjay_unlocked_t *anjay,
-                                                anjay_ssid_t ssid) {
-    find_active_args_t arg = {
-        .ssid = ssid,
-        .out = NULL
-    };
-    if (_anjay_servers_foreach_active(anjay, find_active_clb, &arg)) {
-        return NULL;
-    }
-    return arg.out;
-}
-
-typedef struct {
-    anjay_iid_t security_iid;
-    anjay_server_info_t *out;
-} find_active_by_security_iid_args_t;
-
-static int find_active_by_security_iid_clb(anjay_unlocked_t *anjay,
-                                           anjay_server_info_t *server,
-                                           void *args_) {
-    (void) anjay;
-    find_active_by_security_iid_args_t *args =
-            (find_active_by_security_iid_args_t *) args_;
-    if (_anjay_server_last_used_security_iid(server) == args->security_iid) {
-        args->out = server;
-        return ANJAY_FOREACH_BREAK;
-    }
-    return ANJAY_FOREACH_CONTINUE;
-}
-
-anjay_server_info_t *
-_anjay_servers_find_active_by_security_iid(anjay_unlocked_t *anjay,
-                                           anjay_iid_t security_iid) {
-    find_active_by_security_iid_args_t arg = {
-        .security_iid = security_iid,
-        .out = NULL
-    };
-    if (_anjay_servers_foreach_active(anjay, find_active_by_security_iid_clb,
-                                      &arg)) {
-        return NULL;
-    }
-    return arg.out;
-}
-
 anjay_connection_ref_t
 _anjay_servers_find_active_primary_connection(anjay_unlocked_t *anjay,
                                               anjay_ssid_t ssid) {
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <string.h>
+
+#include <anjay_modules/anjay_sha256.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotr(uint32_t value, unsigned bits) {
+    return (value >> bits) | (value << (32 - bits));
+}
+
+static void process_block(anjay_sha256_t *ctx, const uint8_t *block) {
+    uint32_t w[64];
+    for (size_t i = 0; i < 16; ++i) {
+        w[i] = ((uint32_t) block[4 * i] << 24)
+               | ((uint32_t) block[4 * i + 1] << 16)
+               | ((uint32_t) block[4 * i + 2] << 8)
+               | (uint32_t) block[4 * i + 3];
+    }
+    for (size_t i = 16; i < 64; ++i) {
+        const uint32_t s0 =
+                rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint32_t s1 =
+                rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = ctx->state[0];
+    uint32_t b = ctx->state[1];
+    uint32_t c = ctx->state[2];
+    uint32_t d = ctx->state[3];
+    uint32_t e = ctx->state[4];
+    uint32_t f = ctx->state[5];
+    uint32_t g = ctx->state[6];
+    uint32_t h = ctx->state[7];
+    for (size_t i = 0; i < 64; ++i) {
+        const uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        const uint32_t ch = (e & f) ^ (~e & g);
+        const uint32_t t1 = h + s1 + ch + SHA256_K[i] + w[i];
+        const uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        const uint32_t t2 = s0 + maj;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    ctx->state[0] += a;
+    ctx->state[1] += b;
+    ctx->state[2] += c;
+    ctx->state[3] += d;
+    ctx->state[4] += e;
+    ctx->state[5] += f;
+    ctx->state[6] += g;
+    ctx->state[7] += h;
+}
+
+void _anjay_sha256_init(anjay_sha256_t *ctx) {
+    static const uint32_t INITIAL_STATE[8] = { 0x6a09e667, 0xbb67ae85,
+                                               0x3c6ef372, 0xa54ff53a,
+                                               0x510e527f, 0x9b05688c,
+                                               0x1f83d9ab, 0x5be0cd19 };
+    memcpy(ctx->state, INITIAL_STATE, sizeof(ctx->state));
+    ctx->total_size = 0;
+    ctx->block_size = 0;
+}
+
+void _anjay_sha256_update(anjay_sha256_t *ctx, const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *) data;
+    ctx->total_size += size;
+    while (size > 0) {
+        if (!ctx->block_size && size >= sizeof(ctx->block)) {
+            process_block(ctx, bytes);
+            bytes += sizeof(ctx->block);
+            size -= sizeof(ctx->block);
+            continue;
+        }
+        size_t chunk = sizeof(ctx->block) - ctx->block_size;
+        if (chunk > size) {
+            chunk = size;
+        }
+        memcpy(ctx->block + ctx->block_size, bytes, chunk);
+        ctx->block_size += chunk;
+        bytes += chunk;
+        size -= chunk;
+        if (ctx->block_size == sizeof(ctx->block)) {
+            process_block(ctx, ctx->block);
+            ctx->block_size = 0;
+        }
+    }
+}
+
+void _anjay_sha256_finish(anjay_sha256_t *ctx,
+                          uint8_t out_digest[ANJAY_SHA256_DIGEST_SIZE]) {
+    const uint64_t total_bits = ctx->total_size * 8;
+    ctx->block[ctx->block_size++] = 0x80;
+    if (ctx->block_size > sizeof(ctx->block) - 8) {
+        memset(ctx->block + ctx->block_size, 0,
+               sizeof(ctx->block) - ctx->block_size);
+        process_block(ctx, ctx->block);
+        ctx->block_size = 0;
+    }
+    memset(ctx->block + ctx->block_size, 0,
+           sizeof(ctx->block) - 8 - ctx->block_size);
+    for (size_t i = 0; i < 8; ++i) {
+        ctx->block[sizeof(ctx->block) - 1 - i] =
+                (uint8_t) (total_bits >> (8 * i));
+    }
+    process_block(ctx, ctx->block);
+    ctx->block_size = 0;
+
+    for (size_t i = 0; i < 8; ++i) {
+        out_digest[4 * i] = (uint8_t) (ctx->state[i] >> 24);
+        out_digest[4 * i + 1] = (uint8_t) (ctx->state[i] >> 16);
+        out_digest[4 * i + 2] = (uint8_t) (ctx->state[i] >> 8);
+        out_digest[4 * i + 3] = (uint8_t) ctx->state[i];
+    }
+}
+
+#ifdef ANJAY_TEST
+#    include "tests/core/sha256.c"
+#endif // ANJAY_TEST
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_STATE_PERSISTENCE
+
+#    include <assert.h>
+
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_persistence.h>
+#    include <avsystem/commons/avs_stream_inbuf.h>
+#    include <avsystem/commons/avs_stream_membuf.h>
+
+#    include <anjay/core.h>
+
+#    ifdef ANJAY_WITH_MODULE_ACCESS_CONTROL
+#        include <anjay/access_control.h>
+#    endif // ANJAY_WITH_MODULE_ACCESS_CONTROL
+#    ifdef ANJAY_WITH_ATTR_STORAGE
+#        include <anjay/attr_storage.h>
+#    endif // ANJAY_WITH_ATTR_STORAGE
+#    ifdef ANJAY_WITH_MODULE_SECURITY
+#        include <anjay/security.h>
+#    endif // ANJAY_WITH_MODULE_SECURITY
+#    ifdef ANJAY_WITH_MODULE_SERVER
+#        include <anjay/server.h>
+#    endif // ANJAY_WITH_MODULE_SERVER
+
+#    include "anjay_core.h"
+#    include "anjay_servers_private.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+/**
+ * The snapshot consists of a header, followed by a sequence of sections, each
+ * of which is:
+ * - section tag (1 byte),
+ * - section length (4 bytes, as written by avs_persistence_sized_buffer()),
+ * - section payload, as written by the component's own persist function.
+ *
+ * The sequence is terminated by a zero tag. Sections with unknown tags are
+ * skipped on restore, so that snapshots created by a client with more features
+ * enabled can still be used.
+ */
+static const char STATE_MAGIC[] = "AST";
+
+static const uint8_t STATE_VERSIONS[] = { 0 };
+
+typedef enum {
+    STATE_SECTION_END = 0,
+    STATE_SECTION_SECURITY = 1,
+    STATE_SECTION_SERVER = 2,
+    STATE_SECTION_ACCESS_CONTROL = 3,
+    STATE_SECTION_ATTR_STORAGE = 4,
+    STATE_SECTION_REGISTRATIONS = 5,
+    STATE_SECTION_OBSERVE = 6,
+    STATE_SECTION_DTLS_SESSIONS = 7
+} state_section_tag_t;
+
+typedef avs_error_t state_section_handler_t(anjay_t *anjay,
+                                            avs_stream_t *stream);
+
+typedef struct {
+    state_section_tag_t tag;
+    const char *name;
+    state_section_handler_t *persist;
+    state_section_handler_t *restore;
+} state_section_t;
+
+static avs_error_t registrations_persist(anjay_t *anjay_locked,
+                                         avs_stream_t *out_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    err = _anjay_registrations_persist(anjay, out_stream);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+static avs_error_t registrations_restore(anjay_t *anjay_locked,
+                                         avs_stream_t *in_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    err = _anjay_registrations_restore(anjay, in_stream);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+/**
+ * Order of the sections matters on restore: the data model objects need to be
+ * in place before the state bound to the servers they describe.
+ */
+static const state_section_t STATE_SECTIONS[] = {
+#    ifdef ANJAY_WITH_MODULE_SECURITY
+    { STATE_SECTION_SECURITY, "Security Object", anjay_security_object_persist,
+      anjay_security_object_restore },
+#    endif // ANJAY_WITH_MODULE_SECURITY
+#    ifdef ANJAY_WITH_MODULE_SERVER
+    { STATE_SECTION_SERVER, "Server Object", anjay_server_object_persist,
+      anjay_server_object_restore },
+#    endif // ANJAY_WITH_MODULE_SERVER
+#    ifdef ANJAY_WITH_MODULE_ACCESS_CONTROL
+    { STATE_SECTION_ACCESS_CONTROL, "Access Control Object",
+      anjay_access_control_persist, anjay_access_control_restore },
+#    endif // ANJAY_WITH_MODULE_ACCESS_CONTROL
+#    ifdef ANJAY_WITH_ATTR_STORAGE
+    { STATE_SECTION_ATTR_STORAGE, "Attribute Storage",
+      anjay_attr_storage_persist, anjay_attr_storage_restore },
+#    endif // ANJAY_WITH_ATTR_STORAGE
+    { STATE_SECTION_REGISTRATIONS, "registrations", registrations_persist,
+      registrations_restore },
+#    ifdef ANJAY_WITH_OBSERVE_PERSISTENCE
+    { STATE_SECTION_OBSERVE, "observations", anjay_observe_persist,
+      anjay_observe_restore },
+#    endif // ANJAY_WITH_OBSERVE_PERSISTENCE
+#    ifdef ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+    { STATE_SECTION_DTLS_SESSIONS, "DTLS sessions",
+      anjay_dtls_sessions_persist, anjay_dtls_sessions_restore },
+#    endif // ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+};
+
+static const state_section_t *find_section(uint8_t tag) {
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(STATE_SECTIONS); ++i) {
+        if ((uint8_t) STATE_SECTIONS[i].tag == tag) {
+            return &STATE_SECTIONS[i];
+        }
+    }
+    return NULL;
+}
+
+static bool is_object_not_installed_error(avs_error_t err) {
+    return err.category == AVS_ERRNO_CATEGORY && err.code == AVS_EBADF;
+}
+
+static avs_error_t persist_section(anjay_t *anjay,
+                                   avs_persistence_context_t *ctx,
+                                   const state_section_t *section) {
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    if (!membuf) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    void *data = NULL;
+    size_t size = 0;
+    avs_error_t err = section->persist(anjay, membuf);
+    if (is_object_not_installed_error(err)) {
+        anjay_log(DEBUG, _("skipping ") "%s" _(" in state snapshot"),
+                  section->name);
+        err = AVS_OK;
+    } else {
+        uint8_t tag = (uint8_t) section->tag;
+        (void) (avs_is_err(err)
+                || avs_is_err((err = avs_stream_membuf_take_ownership(
+                                       membuf, &data, &size)))
+                || avs_is_err((err = avs_persistence_u8(ctx, &tag)))
+                || avs_is_err((err = avs_persistence_sized_buffer(ctx, &data,
+                                                                  &size))));
+        if (avs_is_err(err)) {
+            anjay_log(ERROR, _("could not persist ") "%s", section->name);
+        }
+    }
+    avs_free(data);
+    avs_stream_cleanup(&membuf);
+    return err;
+}
+
+avs_error_t anjay_state_persist(anjay_t *anjay, avs_stream_t *out_stream) {
+    assert(anjay);
+    avs_persistence_context_t ctx =
+            avs_persistence_store_context_create(out_stream);
+    uint8_t version = 0;
+    avs_error_t err;
+    if (avs_is_err((err = avs_persistence_magic_string(&ctx, STATE_MAGIC)))
+            || avs_is_err((err = avs_persistence_version(
+                                   &ctx, &version, STATE_VERSIONS,
+                                   sizeof(STATE_VERSIONS))))) {
+        return err;
+    }
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(STATE_SECTIONS); ++i) {
+        if (avs_is_err((err = persist_section(anjay, &ctx,
+                                              &STATE_SECTIONS[i])))) {
+            return err;
+        }
+    }
+    uint8_t end_tag = STATE_SECTION_END;
+    if (avs_is_ok((err = avs_persistence_u8(&ctx, &end_tag)))) {
+        anjay_log(INFO, _("client state persisted"));
+    }
+    return err;
+}
+
+static avs_error_t restore_section(anjay_t *anjay,
+                                   const state_section_t *section,
+                                   void *data,
+                                   size_t size) {
+    avs_stream_inbuf_t inbuf = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&inbuf, data, size);
+    avs_error_t err = section->restore(anjay, (avs_stream_t *) &inbuf);
+    if (is_object_not_installed_error(err)) {
+        anjay_log(DEBUG, _("skipping ") "%s" _(" in state snapshot"),
+                  section->name);
+        return AVS_OK;
+    }
+    if (avs_is_err(err)) {
+        anjay_log(ERROR, _("could not restore ") "%s", section->name);
+    }
+    return err;
+}
+
+avs_error_t anjay_state_restore(anjay_t *anjay, avs_stream_t *in_stream) {
+    assert(anjay);
+    avs_persistence_context_t ctx =
+            avs_persistence_restore_context_create(in_stream);
+    uint8_t version;
+    avs_error_t err;
+    if (avs_is_err((err = avs_persistence_magic_string(&ctx, STATE_MAGIC)))
+            || avs_is_err((err = avs_persistence_version(
+                                   &ctx, &version, STATE_VERSIONS,
+                                   sizeof(STATE_VERSIONS))))) {
+        return err;
+    }
+    while (true) {
+        uint8_t tag;
+        if (avs_is_err((err = avs_persistence_u8(&ctx, &tag)))) {
+            return err;
+        }
+        if (tag == STATE_SECTION_END) {
+            break;
+        }
+        void *data = NULL;
+        size_t size = 0;
+        if (avs_is_err((err = avs_persistence_sized_buffer(&ctx, &data,
+                                                            &size)))) {
+            return err;
+        }
+        const state_section_t *section = find_section(tag);
+        if (!section) {
+            anjay_log(DEBUG, _("skipping unknown state section ") "%u",
+                      (unsigned) tag);
+        } else {
+            err = restore_section(anjay, section, data, size);
+        }
+        avs_free(data);
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+#    ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_unlocked->startup_timestamps.last_state_restored =
+            avs_time_monotonic_now();
+    ANJAY_MUTEX_UNLOCK(anjay);
+#    endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+    anjay_log(INFO, _("client state restored"));
+    return AVS_OK;
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/core/state_persistence.c"
+#    endif // ANJAY_TEST
+
+#endif // ANJAY_WITH_STATE_PERSISTENCE
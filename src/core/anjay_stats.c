@@ -9,6 +9,8 @@
 
 #include <anjay_init.h>
 
+#include <string.h>
+
 #include <anjay/stats.h>
 #include <anjay_modules/anjay_dm_utils.h>
 
@@ -26,9 +28,26 @@ typedef enum {
     NET_STATS_BYTES_SENT,
     NET_STATS_BYTES_RECEIVED,
     NET_STATS_OUTGOING_RETRANSMISSIONS,
-    NET_STATS_INCOMING_RETRANSMISSIONS
+    NET_STATS_INCOMING_RETRANSMISSIONS,
+    NET_STATS_ACKNOWLEDGED_MESSAGES,
+    NET_STATS_ACK_WAIT_TIME_MS,
+    NET_STATS_MESSAGES_IN_FLIGHT,
+    NET_STATS_RTT_HISTOGRAM_BUCKET,
+    NET_STATS_SENT_MESSAGES,
+    NET_STATS_RECEIVED_MESSAGES,
+    NET_STATS_TOTAL_MESSAGES_SIZE,
+    NET_STATS_MAX_MESSAGE_SIZE
 } net_stats_type_t;
 
+typedef struct {
+    net_stats_type_t type;
+    /**
+     * Index of the histogram bucket, used only for
+     * NET_STATS_RTT_HISTOGRAM_BUCKET.
+     */
+    size_t bucket;
+} net_stats_query_t;
+
 static uint64_t get_socket_stats(avs_net_socket_t *socket,
                                  net_stats_type_t type) {
     avs_net_socket_opt_value_t bytes_stats;
@@ -61,50 +80,116 @@ static uint64_t get_socket_stats(avs_net_socket_t *socket,
     }
 }
 
-static uint64_t get_current_stats_of_connection(anjay_connection_ref_t conn_ref,
-                                                net_stats_type_t type) {
+static uint64_t get_coap_stats(const avs_coap_stats_t *stats,
+                               const net_stats_query_t *query) {
+    switch (query->type) {
+    case NET_STATS_OUTGOING_RETRANSMISSIONS:
+        return stats->outgoing_retransmissions_count;
+    case NET_STATS_INCOMING_RETRANSMISSIONS:
+        return stats->incoming_retransmissions_count;
+    case NET_STATS_ACKNOWLEDGED_MESSAGES:
+        return stats->acknowledged_count;
+    case NET_STATS_ACK_WAIT_TIME_MS: {
+        int64_t result;
+        if (avs_time_duration_to_scalar(&result, AVS_TIME_MS,
+                                        stats->total_ack_wait_time)
+                || result < 0) {
+            return 0;
+        }
+        return (uint64_t) result;
+    }
+    case NET_STATS_MESSAGES_IN_FLIGHT:
+        return stats->messages_in_flight;
+    case NET_STATS_RTT_HISTOGRAM_BUCKET:
+        assert(query->bucket < AVS_COAP_STATS_RTT_HISTOGRAM_BUCKETS);
+        return stats->rtt_histogram[query->bucket];
+    case NET_STATS_SENT_MESSAGES:
+        return stats->sent_messages_count;
+    case NET_STATS_RECEIVED_MESSAGES:
+        return stats->received_messages_count;
+    case NET_STATS_TOTAL_MESSAGES_SIZE:
+        return stats->total_messages_size;
+    case NET_STATS_MAX_MESSAGE_SIZE:
+        return stats->max_message_size;
+    default:
+        AVS_UNREACHABLE("this function accepts only CoAP stats types");
+        return 0;
+    }
+}
+
+static uint64_t
+get_current_stats_of_connection(anjay_connection_ref_t conn_ref,
+                                const net_stats_query_t *query) {
     avs_net_socket_t *socket;
     avs_coap_ctx_t *coap_ctx;
-    switch (type) {
+    switch (query->type) {
     case NET_STATS_BYTES_SENT:
     case NET_STATS_BYTES_RECEIVED:
         socket = _anjay_connection_get_online_socket(conn_ref);
-        return socket ? get_socket_stats(socket, type) : 0;
+        return socket ? get_socket_stats(socket, query->type) : 0;
     case NET_STATS_OUTGOING_RETRANSMISSIONS:
-        coap_ctx = _anjay_connection_get_coap(conn_ref);
-        return coap_ctx ? avs_coap_get_stats(coap_ctx)
-                                  .outgoing_retransmissions_count
-                        : 0;
     case NET_STATS_INCOMING_RETRANSMISSIONS:
+    case NET_STATS_ACKNOWLEDGED_MESSAGES:
+    case NET_STATS_ACK_WAIT_TIME_MS:
+    case NET_STATS_MESSAGES_IN_FLIGHT:
+    case NET_STATS_RTT_HISTOGRAM_BUCKET:
+    case NET_STATS_SENT_MESSAGES:
+    case NET_STATS_RECEIVED_MESSAGES:
+    case NET_STATS_TOTAL_MESSAGES_SIZE:
+    case NET_STATS_MAX_MESSAGE_SIZE:
         coap_ctx = _anjay_connection_get_coap(conn_ref);
-        return coap_ctx ? avs_coap_get_stats(coap_ctx)
-                                  .incoming_retransmissions_count
-                        : 0;
+        if (coap_ctx) {
+            avs_coap_stats_t stats = avs_coap_get_stats(coap_ctx);
+            return get_coap_stats(&stats, query);
+        }
+        return 0;
     }
     AVS_UNREACHABLE("invalid enum value");
     return 0;
 }
 
-static uint64_t get_stats_of_closed_connections(anjay_unlocked_t *anjay,
-                                                net_stats_type_t type) {
-    switch (type) {
+static uint64_t
+get_stats_of_closed_connections(anjay_unlocked_t *anjay,
+                                const net_stats_query_t *query) {
+    switch (query->type) {
     case NET_STATS_BYTES_SENT:
         return anjay->closed_connections_stats.socket_stats.bytes_sent;
     case NET_STATS_BYTES_RECEIVED:
         return anjay->closed_connections_stats.socket_stats.bytes_received;
+    case NET_STATS_MESSAGES_IN_FLIGHT:
+        // closed connections have nothing in flight
+        return 0;
     case NET_STATS_OUTGOING_RETRANSMISSIONS:
-        return anjay->closed_connections_stats.coap_stats
-                .outgoing_retransmissions_count;
     case NET_STATS_INCOMING_RETRANSMISSIONS:
-        return anjay->closed_connections_stats.coap_stats
-                .incoming_retransmissions_count;
+    case NET_STATS_ACKNOWLEDGED_MESSAGES:
+    case NET_STATS_ACK_WAIT_TIME_MS:
+    case NET_STATS_RTT_HISTOGRAM_BUCKET:
+    case NET_STATS_SENT_MESSAGES:
+    case NET_STATS_RECEIVED_MESSAGES:
+    case NET_STATS_TOTAL_MESSAGES_SIZE:
+    case NET_STATS_MAX_MESSAGE_SIZE:
+        return get_coap_stats(&anjay->closed_connections_stats.coap_stats,
+                              query);
     }
     AVS_UNREACHABLE("invalid enum value");
     return 0;
 }
 
+/**
+ * Combines statistics of two connections - most are summed up, but for the
+ * maximum message size, the larger value is taken.
+ */
+static uint64_t aggregate_stats(const net_stats_query_t *query,
+                                uint64_t first,
+                                uint64_t second) {
+    if (query->type == NET_STATS_MAX_MESSAGE_SIZE) {
+        return AVS_MAX(first, second);
+    }
+    return first + second;
+}
+
 typedef struct {
-    net_stats_type_t net_stats_type;
+    const net_stats_query_t *query;
     uint64_t result_for_active_servers;
 } get_current_stats_of_server_args_t;
 
@@ -120,55 +205,118 @@ static int get_current_stats_of_server(anjay_unlocked_t *anjay,
             .server = server,
             .conn_type = conn_type
         };
-        args->result_for_active_servers +=
-                get_current_stats_of_connection(conn_ref, args->net_stats_type);
+        args->result_for_active_servers = aggregate_stats(
+                args->query, args->result_for_active_servers,
+                get_current_stats_of_connection(conn_ref, args->query));
     }
     return 0;
 }
 
 static uint64_t get_stats_of_all_connections(anjay_unlocked_t *anjay,
-                                             net_stats_type_t type) {
+                                             const net_stats_query_t *query) {
     get_current_stats_of_server_args_t args = {
-        .net_stats_type = type,
+        .query = query,
         .result_for_active_servers = 0
     };
     _anjay_servers_foreach_active(anjay, get_current_stats_of_server, &args);
-    return args.result_for_active_servers
-           + get_stats_of_closed_connections(anjay, type);
+    return aggregate_stats(query, args.result_for_active_servers,
+                           get_stats_of_closed_connections(anjay, query));
 }
 
-uint64_t anjay_get_tx_bytes(anjay_t *anjay_locked) {
+static uint64_t get_stats_of_type_unlocked(anjay_unlocked_t *anjay,
+                                           net_stats_type_t type) {
+    const net_stats_query_t query = {
+        .type = type
+    };
+    return get_stats_of_all_connections(anjay, &query);
+}
+
+void _anjay_get_net_traffic_stats_unlocked(anjay_unlocked_t *anjay,
+                                           anjay_net_traffic_stats_t *out) {
+    out->tx_bytes = get_stats_of_type_unlocked(anjay, NET_STATS_BYTES_SENT);
+    out->rx_bytes = get_stats_of_type_unlocked(anjay, NET_STATS_BYTES_RECEIVED);
+    out->sent_messages =
+            get_stats_of_type_unlocked(anjay, NET_STATS_SENT_MESSAGES);
+    out->received_messages =
+            get_stats_of_type_unlocked(anjay, NET_STATS_RECEIVED_MESSAGES);
+    out->total_messages_size =
+            get_stats_of_type_unlocked(anjay, NET_STATS_TOTAL_MESSAGES_SIZE);
+    out->max_message_size =
+            get_stats_of_type_unlocked(anjay, NET_STATS_MAX_MESSAGE_SIZE);
+}
+
+static uint64_t query_stats(anjay_t *anjay_locked,
+                            const net_stats_query_t *query) {
     uint64_t result = 0;
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    result = get_stats_of_all_connections(anjay, NET_STATS_BYTES_SENT);
-    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
+    result = get_stats_of_all_connections(anjay, query);
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
     return result;
 }
 
+static uint64_t get_stats(anjay_t *anjay_locked, net_stats_type_t type) {
+    const net_stats_query_t query = {
+        .type = type
+    };
+    return query_stats(anjay_locked, &query);
+}
+
+uint64_t anjay_get_tx_bytes(anjay_t *anjay_locked) {
+    return get_stats(anjay_locked, NET_STATS_BYTES_SENT);
+}
+
 uint64_t anjay_get_rx_bytes(anjay_t *anjay_locked) {
-    uint64_t result = 0;
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    result = get_stats_of_all_connections(anjay, NET_STATS_BYTES_RECEIVED);
-    ANJAY_MUTEX_UNLOCK(anjay_locked);
-    return result;
+    return get_stats(anjay_locked, NET_STATS_BYTES_RECEIVED);
 }
 
 uint64_t anjay_get_num_incoming_retransmissions(anjay_t *anjay_locked) {
-    uint64_t result = 0;
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    result = get_stats_of_all_connections(anjay,
-                                          NET_STATS_INCOMING_RETRANSMISSIONS);
-    ANJAY_MUTEX_UNLOCK(anjay_locked);
-    return result;
+    return get_stats(anjay_locked, NET_STATS_INCOMING_RETRANSMISSIONS);
 }
 
 uint64_t anjay_get_num_outgoing_retransmissions(anjay_t *anjay_locked) {
-    uint64_t result = 0;
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    result = get_stats_of_all_connections(anjay,
-                                          NET_STATS_OUTGOING_RETRANSMISSIONS);
-    ANJAY_MUTEX_UNLOCK(anjay_locked);
-    return result;
+    return get_stats(anjay_locked, NET_STATS_OUTGOING_RETRANSMISSIONS);
+}
+
+uint64_t anjay_get_num_acknowledged_messages(anjay_t *anjay_locked) {
+    return get_stats(anjay_locked, NET_STATS_ACKNOWLEDGED_MESSAGES);
+}
+
+uint64_t anjay_get_total_ack_wait_time_ms(anjay_t *anjay_locked) {
+    return get_stats(anjay_locked, NET_STATS_ACK_WAIT_TIME_MS);
+}
+
+uint64_t anjay_get_num_messages_in_flight(anjay_t *anjay_locked) {
+    return get_stats(anjay_locked, NET_STATS_MESSAGES_IN_FLIGHT);
+}
+
+uint64_t anjay_get_num_sent_messages(anjay_t *anjay_locked) {
+    return get_stats(anjay_locked, NET_STATS_SENT_MESSAGES);
+}
+
+uint64_t anjay_get_num_received_messages(anjay_t *anjay_locked) {
+    return get_stats(anjay_locked, NET_STATS_RECEIVED_MESSAGES);
+}
+
+uint64_t anjay_get_total_messages_size(anjay_t *anjay_locked) {
+    return get_stats(anjay_locked, NET_STATS_TOTAL_MESSAGES_SIZE);
+}
+
+uint64_t anjay_get_max_message_size(anjay_t *anjay_locked) {
+    return get_stats(anjay_locked, NET_STATS_MAX_MESSAGE_SIZE);
+}
+
+uint64_t anjay_get_rtt_histogram_bucket(anjay_t *anjay_locked,
+                                        size_t bucket) {
+    if (bucket >= AVS_COAP_STATS_RTT_HISTOGRAM_BUCKETS) {
+        stats_log(ERROR, _("invalid RTT histogram bucket: ") "%u",
+                  (unsigned) bucket);
+        return 0;
+    }
+    const net_stats_query_t query = {
+        .type = NET_STATS_RTT_HISTOGRAM_BUCKET,
+        .bucket = bucket
+    };
+    return query_stats(anjay_locked, &query);
 }
 
 void _anjay_coap_ctx_cleanup(anjay_unlocked_t *anjay, avs_coap_ctx_t **ctx) {
@@ -180,8 +328,27 @@ void _anjay_coap_ctx_cleanup(anjay_unlocked_t *anjay, avs_coap_ctx_t **ctx) {
         anjay->closed_connections_stats.coap_stats
                 .incoming_retransmissions_count +=
                 stats.incoming_retransmissions_count;
+        anjay->closed_connections_stats.coap_stats.acknowledged_count +=
+                stats.acknowledged_count;
+        anjay->closed_connections_stats.coap_stats.total_ack_wait_time =
+                avs_time_duration_add(anjay->closed_connections_stats
+                                              .coap_stats.total_ack_wait_time,
+                                      stats.total_ack_wait_time);
+        for (size_t i = 0; i < AVS_COAP_STATS_RTT_HISTOGRAM_BUCKETS; ++i) {
+            anjay->closed_connections_stats.coap_stats.rtt_histogram[i] +=
+                    stats.rtt_histogram[i];
+        }
+        avs_coap_stats_t *closed = &anjay->closed_connections_stats.coap_stats;
+        closed->sent_messages_count += stats.sent_messages_count;
+        closed->received_messages_count += stats.received_messages_count;
+        closed->total_messages_size += stats.total_messages_size;
+        closed->max_message_size =
+                AVS_MAX(closed->max_message_size, stats.max_message_size);
     }
+    anjay_buffer_pool_entry_t *buffers =
+            ctx ? _anjay_coap_buffers_unbind(anjay, *ctx) : NULL;
     avs_coap_ctx_cleanup(ctx);
+    _anjay_buffer_pool_return(&anjay->buffer_pool, buffers);
 }
 
 #else // ANJAY_WITH_NET_STATS
@@ -218,9 +385,76 @@ uint64_t anjay_get_num_outgoing_retransmissions(anjay_t *anjay) {
     return 0;
 }
 
-void _anjay_coap_ctx_cleanup(anjay_unlocked_t *anjay, avs_coap_ctx_t **ctx) {
+uint64_t anjay_get_num_acknowledged_messages(anjay_t *anjay) {
+    (void) anjay;
+    stats_log(ERROR,
+              _("NET_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_NET_STATS option."));
+    return 0;
+}
+
+uint64_t anjay_get_total_ack_wait_time_ms(anjay_t *anjay) {
+    (void) anjay;
+    stats_log(ERROR,
+              _("NET_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_NET_STATS option."));
+    return 0;
+}
+
+uint64_t anjay_get_num_messages_in_flight(anjay_t *anjay) {
+    (void) anjay;
+    stats_log(ERROR,
+              _("NET_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_NET_STATS option."));
+    return 0;
+}
+
+uint64_t anjay_get_num_sent_messages(anjay_t *anjay) {
+    (void) anjay;
+    stats_log(ERROR,
+              _("NET_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_NET_STATS option."));
+    return 0;
+}
+
+uint64_t anjay_get_num_received_messages(anjay_t *anjay) {
+    (void) anjay;
+    stats_log(ERROR,
+              _("NET_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_NET_STATS option."));
+    return 0;
+}
+
+uint64_t anjay_get_total_messages_size(anjay_t *anjay) {
+    (void) anjay;
+    stats_log(ERROR,
+              _("NET_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_NET_STATS option."));
+    return 0;
+}
+
+uint64_t anjay_get_max_message_size(anjay_t *anjay) {
     (void) anjay;
+    stats_log(ERROR,
+              _("NET_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_NET_STATS option."));
+    return 0;
+}
+
+uint64_t anjay_get_rtt_histogram_bucket(anjay_t *anjay, size_t bucket) {
+    (void) anjay;
+    (void) bucket;
+    stats_log(ERROR,
+              _("NET_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_NET_STATS option."));
+    return 0;
+}
+
+void _anjay_coap_ctx_cleanup(anjay_unlocked_t *anjay, avs_coap_ctx_t **ctx) {
+    anjay_buffer_pool_entry_t *buffers =
+            ctx ? _anjay_coap_buffers_unbind(anjay, *ctx) : NULL;
     avs_coap_ctx_cleanup(ctx);
+    _anjay_buffer_pool_return(&anjay->buffer_pool, buffers);
 }
 
 #endif // ANJAY_WITH_NET_STATS
@@ -229,6 +463,7 @@ avs_error_t _anjay_socket_cleanup(anjay_unlocked_t *anjay,
                                   avs_net_socket_t **socket) {
     assert(socket);
     if (*socket) {
+        _anjay_socket_set_changed(anjay);
         avs_net_socket_shutdown(*socket);
 #ifdef ANJAY_WITH_NET_STATS
         anjay->closed_connections_stats.socket_stats.bytes_sent +=
@@ -240,3 +475,768 @@ avs_error_t _anjay_socket_cleanup(anjay_unlocked_t *anjay,
     }
     return avs_net_socket_cleanup(socket);
 }
+
+#if defined(ANJAY_WITH_LOCK_STATS) || defined(ANJAY_WITH_OPERATION_STATS)
+static uint64_t duration_to_us(avs_time_duration_t duration) {
+    int64_t us;
+    if (avs_time_duration_to_scalar(&us, AVS_TIME_US, duration) || us < 0) {
+        return 0;
+    }
+    return (uint64_t) us;
+}
+
+/**
+ * Adds @p duration to a histogram of @p buckets buckets, in which bucket 0
+ * counts times shorter than @p first_bound_us, the upper bound of each next
+ * one is twice as large, and the last one is unbounded.
+ */
+static void record_time(uint64_t *histogram,
+                        size_t buckets,
+                        uint64_t first_bound_us,
+                        uint64_t *total_us,
+                        uint64_t *max_us,
+                        avs_time_duration_t duration) {
+    uint64_t us = duration_to_us(duration);
+    size_t bucket = 0;
+    for (uint64_t bound = first_bound_us; bucket < buckets - 1 && us >= bound;
+         bound *= 2) {
+        ++bucket;
+    }
+    ++histogram[bucket];
+    *total_us += us;
+    *max_us = AVS_MAX(*max_us, us);
+}
+#endif // defined(ANJAY_WITH_LOCK_STATS) ||
+       // defined(ANJAY_WITH_OPERATION_STATS)
+
+#ifdef ANJAY_WITH_SCHED_STATS
+
+void _anjay_sched_jobs_collect(anjay_sched_jobs_collector_t *collector,
+                               anjay_sched_job_kind_t kind,
+                               anjay_ssid_t ssid,
+                               const avs_sched_handle_t *handle) {
+    if (!*handle) {
+        return;
+    }
+    if (collector->count < collector->max_jobs) {
+        anjay_sched_job_info_t *info = &collector->out_jobs[collector->count];
+        info->kind = kind;
+        info->ssid = ssid;
+        info->deadline = avs_sched_time(handle);
+    }
+    ++collector->count;
+}
+
+static void collect_coap_sched_jobs(anjay_unlocked_t *anjay,
+                                    anjay_sched_jobs_collector_t *collector) {
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    _anjay_sched_jobs_collect(collector, ANJAY_SCHED_JOB_COAP, ANJAY_SSID_ANY,
+                              &anjay->coap_sched_job_handle);
+#    else  // ANJAY_WITH_THREAD_SAFETY
+    // CoAP jobs are scheduled directly in the main scheduler and their
+    // handles are private to avs_coap
+    (void) anjay;
+    (void) collector;
+#    endif // ANJAY_WITH_THREAD_SAFETY
+}
+
+size_t anjay_get_pending_sched_jobs(anjay_t *anjay_locked,
+                                    anjay_sched_job_info_t *out_jobs,
+                                    size_t max_jobs) {
+    anjay_sched_jobs_collector_t collector = {
+        .out_jobs = out_jobs,
+        .max_jobs = max_jobs,
+        .count = 0
+    };
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
+    _anjay_servers_collect_sched_jobs(anjay, &collector);
+#    ifdef ANJAY_WITH_OBSERVE
+    _anjay_observe_collect_sched_jobs(anjay, &collector);
+#    endif // ANJAY_WITH_OBSERVE
+#    ifdef ANJAY_WITH_DOWNLOADER
+    _anjay_downloader_collect_sched_jobs(anjay, &collector);
+#    endif // ANJAY_WITH_DOWNLOADER
+    collect_coap_sched_jobs(anjay, &collector);
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
+    return collector.count;
+}
+
+void _anjay_sched_job_stats_record(anjay_unlocked_t *anjay,
+                                   anjay_sched_job_kind_t kind,
+                                   avs_time_monotonic_t start_time) {
+    assert((unsigned) kind < ANJAY_SCHED_JOB_KIND_LIMIT_);
+    int64_t runtime_us;
+    if (avs_time_duration_to_scalar(
+                &runtime_us, AVS_TIME_US,
+                avs_time_monotonic_diff(avs_time_monotonic_now(), start_time))
+            || runtime_us < 0) {
+        runtime_us = 0;
+    }
+    anjay_sched_job_stats_t *stats = &anjay->sched_job_stats[kind];
+    ++stats->executions;
+    stats->total_runtime_us += (uint64_t) runtime_us;
+    stats->max_runtime_us =
+            AVS_MAX(stats->max_runtime_us, (uint64_t) runtime_us);
+}
+
+int anjay_get_sched_job_stats(anjay_t *anjay_locked,
+                              anjay_sched_job_kind_t kind,
+                              anjay_sched_job_stats_t *out_stats) {
+    memset(out_stats, 0, sizeof(*out_stats));
+    if ((unsigned) kind >= ANJAY_SCHED_JOB_KIND_LIMIT_) {
+        stats_log(ERROR, _("invalid scheduler job kind: ") "%d", (int) kind);
+        return -1;
+    }
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
+    *out_stats = anjay->sched_job_stats[kind];
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
+    return 0;
+}
+
+void anjay_reset_sched_job_stats(anjay_t *anjay_locked) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    memset(anjay->sched_job_stats, 0, sizeof(anjay->sched_job_stats));
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+#else // ANJAY_WITH_SCHED_STATS
+
+size_t anjay_get_pending_sched_jobs(anjay_t *anjay,
+                                    anjay_sched_job_info_t *out_jobs,
+                                    size_t max_jobs) {
+    (void) anjay;
+    (void) out_jobs;
+    (void) max_jobs;
+    stats_log(ERROR,
+              _("SCHED_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_SCHED_STATS option."));
+    return 0;
+}
+
+int anjay_get_sched_job_stats(anjay_t *anjay,
+                              anjay_sched_job_kind_t kind,
+                              anjay_sched_job_stats_t *out_stats) {
+    (void) anjay;
+    (void) kind;
+    memset(out_stats, 0, sizeof(*out_stats));
+    stats_log(ERROR,
+              _("SCHED_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_SCHED_STATS option."));
+    return -1;
+}
+
+void anjay_reset_sched_job_stats(anjay_t *anjay) {
+    (void) anjay;
+}
+
+#endif // ANJAY_WITH_SCHED_STATS
+
+#ifdef ANJAY_WITH_LOCK_STATS
+
+#    include <inttypes.h>
+#    include <stdlib.h>
+
+/**
+ * Capacity of the hash table of per-function statistics. Functions that lock
+ * the mutex after it fills up are aggregated in the overflow entry.
+ */
+#    define LOCK_STATS_TABLE_SIZE 128
+
+struct anjay_lock_stats_struct {
+    /**
+     * Open addressing hash table keyed by the function name pointer. Entries
+     * with function == NULL are free.
+     */
+    anjay_lock_stats_entry_t entries[LOCK_STATS_TABLE_SIZE];
+    size_t entries_count;
+    anjay_lock_stats_entry_t overflow;
+    /**
+     * Entry of the function currently holding the mutex.
+     */
+    anjay_lock_stats_entry_t *holder;
+    avs_time_monotonic_t locked_since;
+};
+
+struct anjay_lock_stats_struct *_anjay_lock_stats_new(void) {
+    struct anjay_lock_stats_struct *stats =
+            (struct anjay_lock_stats_struct *) avs_calloc(1, sizeof(*stats));
+    if (!stats) {
+        _anjay_log_oom();
+    }
+    return stats;
+}
+
+void _anjay_lock_stats_delete(struct anjay_lock_stats_struct **stats_ptr) {
+    avs_free(*stats_ptr);
+    *stats_ptr = NULL;
+}
+
+static anjay_lock_stats_entry_t *
+find_lock_stats_entry(struct anjay_lock_stats_struct *stats,
+                      const char *function) {
+    size_t index = (size_t) (((uintptr_t) function) >> 3)
+                   % LOCK_STATS_TABLE_SIZE;
+    for (size_t i = 0; i < LOCK_STATS_TABLE_SIZE; ++i) {
+        anjay_lock_stats_entry_t *entry = &stats->entries[index];
+        if (entry->function == function) {
+            return entry;
+        }
+        if (!entry->function) {
+            // keep a few free entries, so that lookups terminate quickly
+            if (stats->entries_count >= LOCK_STATS_TABLE_SIZE * 3 / 4) {
+                break;
+            }
+            entry->function = function;
+            ++stats->entries_count;
+            return entry;
+        }
+        index = (index + 1) % LOCK_STATS_TABLE_SIZE;
+    }
+    return &stats->overflow;
+}
+
+int _anjay_lock_exclusive_with_stats(anjay_t *anjay, const char *function) {
+    avs_time_monotonic_t wait_start = avs_time_monotonic_now();
+    if (_anjay_lock_exclusive(anjay)) {
+        return -1;
+    }
+    struct anjay_lock_stats_struct *stats = anjay->lock_stats;
+    if (stats) {
+        stats->locked_since = avs_time_monotonic_now();
+        stats->holder = find_lock_stats_entry(stats, function);
+        ++stats->holder->lock_count;
+        record_time(stats->holder->wait_histogram,
+                    ANJAY_LOCK_STATS_HISTOGRAM_BUCKETS, 2,
+                    &stats->holder->total_wait_us, &stats->holder->max_wait_us,
+                    avs_time_monotonic_diff(stats->locked_since, wait_start));
+    }
+    return 0;
+}
+
+void _anjay_unlock_exclusive_with_stats(anjay_t *anjay) {
+    struct anjay_lock_stats_struct *stats = anjay->lock_stats;
+    if (stats && stats->holder) {
+        record_time(stats->holder->hold_histogram,
+                    ANJAY_LOCK_STATS_HISTOGRAM_BUCKETS, 2,
+                    &stats->holder->total_hold_us, &stats->holder->max_hold_us,
+                    avs_time_monotonic_diff(avs_time_monotonic_now(),
+                                            stats->locked_since));
+        stats->holder = NULL;
+    }
+    avs_mutex_unlock(anjay->mutex);
+}
+
+static size_t get_lock_stats(struct anjay_lock_stats_struct *stats,
+                             anjay_lock_stats_entry_t *out_entries,
+                             size_t max_entries) {
+    size_t count = 0;
+    for (size_t i = 0; i < LOCK_STATS_TABLE_SIZE; ++i) {
+        if (stats->entries[i].function) {
+            if (count < max_entries) {
+                out_entries[count] = stats->entries[i];
+            }
+            ++count;
+        }
+    }
+    if (stats->overflow.lock_count) {
+        if (count < max_entries) {
+            out_entries[count] = stats->overflow;
+        }
+        ++count;
+    }
+    return count;
+}
+
+size_t anjay_get_lock_stats(anjay_t *anjay_locked,
+                            anjay_lock_stats_entry_t *out_entries,
+                            size_t max_entries) {
+    size_t result = 0;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    (void) anjay;
+    if (anjay_locked->lock_stats) {
+        result = get_lock_stats(anjay_locked->lock_stats, out_entries,
+                                max_entries);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+void anjay_reset_lock_stats(anjay_t *anjay_locked) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    (void) anjay;
+    struct anjay_lock_stats_struct *stats = anjay_locked->lock_stats;
+    if (stats) {
+        // the holder entry is about to be cleared, so the hold time of this
+        // very call is not recorded anywhere
+        memset(stats->entries, 0, sizeof(stats->entries));
+        memset(&stats->overflow, 0, sizeof(stats->overflow));
+        stats->entries_count = 0;
+        stats->holder = NULL;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+static int compare_by_total_hold_time(const void *left_, const void *right_) {
+    const anjay_lock_stats_entry_t *left =
+            (const anjay_lock_stats_entry_t *) left_;
+    const anjay_lock_stats_entry_t *right =
+            (const anjay_lock_stats_entry_t *) right_;
+    if (left->total_hold_us != right->total_hold_us) {
+        return left->total_hold_us > right->total_hold_us ? -1 : 1;
+    }
+    return 0;
+}
+
+void anjay_dump_lock_stats(anjay_t *anjay) {
+    size_t count = anjay_get_lock_stats(anjay, NULL, 0);
+    if (!count) {
+        return;
+    }
+    anjay_lock_stats_entry_t *entries = (anjay_lock_stats_entry_t *) avs_calloc(
+            count, sizeof(anjay_lock_stats_entry_t));
+    if (!entries) {
+        _anjay_log_oom();
+        return;
+    }
+    // more entries might have been added in the meantime
+    count = AVS_MIN(count, anjay_get_lock_stats(anjay, entries, count));
+    qsort(entries, count, sizeof(*entries), compare_by_total_hold_time);
+    for (size_t i = 0; i < count; ++i) {
+        stats_log(INFO,
+                  "%s" _(": locked ") "%" PRIu64 _(" times, wait total/max ")
+                          "%" PRIu64 "/%" PRIu64 _(" us, hold total/max ")
+                                  "%" PRIu64 "/%" PRIu64 _(" us"),
+                  entries[i].function ? entries[i].function : "(other)",
+                  entries[i].lock_count, entries[i].total_wait_us,
+                  entries[i].max_wait_us, entries[i].total_hold_us,
+                  entries[i].max_hold_us);
+    }
+    avs_free(entries);
+}
+
+#else // ANJAY_WITH_LOCK_STATS
+
+size_t anjay_get_lock_stats(anjay_t *anjay,
+                            anjay_lock_stats_entry_t *out_entries,
+                            size_t max_entries) {
+    (void) anjay;
+    (void) out_entries;
+    (void) max_entries;
+    stats_log(ERROR,
+              _("LOCK_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_LOCK_STATS option."));
+    return 0;
+}
+
+void anjay_reset_lock_stats(anjay_t *anjay) {
+    (void) anjay;
+}
+
+void anjay_dump_lock_stats(anjay_t *anjay) {
+    (void) anjay;
+    stats_log(ERROR,
+              _("LOCK_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_LOCK_STATS option."));
+}
+
+#endif // ANJAY_WITH_LOCK_STATS
+
+#ifdef ANJAY_WITH_OPERATION_STATS
+
+static void record_operation(anjay_operation_stats_t *stats,
+                             avs_time_duration_t handler_time,
+                             avs_time_duration_t total_time,
+                             bool failed) {
+    ++stats->count;
+    if (failed) {
+        ++stats->errors;
+    }
+    record_time(stats->handler_histogram,
+                ANJAY_OPERATION_STATS_HISTOGRAM_BUCKETS, 16,
+                &stats->total_handler_us, &stats->max_handler_us,
+                handler_time);
+    record_time(stats->time_histogram, ANJAY_OPERATION_STATS_HISTOGRAM_BUCKETS,
+                16, &stats->total_time_us, &stats->max_time_us, total_time);
+}
+
+static anjay_server_operation_stats_t *
+find_or_create_server_stats(anjay_unlocked_t *anjay, anjay_ssid_t ssid) {
+    AVS_LIST(anjay_server_operation_stats_t) *stats_ptr;
+    AVS_LIST_FOREACH_PTR(stats_ptr, &anjay->operation_stats) {
+        if ((*stats_ptr)->ssid >= ssid) {
+            break;
+        }
+    }
+    if (!*stats_ptr || (*stats_ptr)->ssid != ssid) {
+        AVS_LIST(anjay_server_operation_stats_t) new_stats =
+                AVS_LIST_NEW_ELEMENT(anjay_server_operation_stats_t);
+        if (!new_stats) {
+            _anjay_log_oom();
+            return NULL;
+        }
+        new_stats->ssid = ssid;
+        AVS_LIST_INSERT(stats_ptr, new_stats);
+    }
+    return *stats_ptr;
+}
+
+void _anjay_operation_stats_record(anjay_unlocked_t *anjay,
+                                   anjay_ssid_t ssid,
+                                   anjay_operation_kind_t kind,
+                                   avs_time_duration_t handler_time,
+                                   avs_time_duration_t total_time,
+                                   bool failed) {
+    assert((unsigned) kind < ANJAY_OPERATION_KIND_LIMIT_);
+    anjay_server_operation_stats_t *stats =
+            find_or_create_server_stats(anjay, ssid);
+    // statistics are best-effort, losing a sample is not an error
+    if (stats) {
+        record_operation(&stats->operations[kind], handler_time, total_time,
+                         failed);
+    }
+}
+
+void _anjay_operation_stats_record_format(anjay_unlocked_t *anjay,
+                                          anjay_ssid_t ssid,
+                                          uint16_t content_format) {
+    anjay_server_operation_stats_t *stats =
+            find_or_create_server_stats(anjay, ssid);
+    if (!stats) {
+        return;
+    }
+    AVS_LIST(anjay_format_usage_t) *usage_ptr;
+    AVS_LIST_FOREACH_PTR(usage_ptr, &stats->formats) {
+        if ((*usage_ptr)->content_format >= content_format) {
+            break;
+        }
+    }
+    if (!*usage_ptr || (*usage_ptr)->content_format != content_format) {
+        AVS_LIST(anjay_format_usage_t) new_usage =
+                AVS_LIST_NEW_ELEMENT(anjay_format_usage_t);
+        if (!new_usage) {
+            _anjay_log_oom();
+            return;
+        }
+        new_usage->content_format = content_format;
+        AVS_LIST_INSERT(usage_ptr, new_usage);
+    }
+    ++(*usage_ptr)->payloads;
+}
+
+void _anjay_operation_stats_cleanup(anjay_unlocked_t *anjay) {
+    AVS_LIST_CLEAR(&anjay->operation_stats) {
+        AVS_LIST_CLEAR(&anjay->operation_stats->formats);
+    }
+}
+
+static void add_operation_stats(anjay_operation_stats_t *sum,
+                                const anjay_operation_stats_t *stats) {
+    sum->count += stats->count;
+    sum->errors += stats->errors;
+    sum->total_handler_us += stats->total_handler_us;
+    sum->max_handler_us = AVS_MAX(sum->max_handler_us, stats->max_handler_us);
+    sum->total_time_us += stats->total_time_us;
+    sum->max_time_us = AVS_MAX(sum->max_time_us, stats->max_time_us);
+    for (size_t i = 0; i < ANJAY_OPERATION_STATS_HISTOGRAM_BUCKETS; ++i) {
+        sum->handler_histogram[i] += stats->handler_histogram[i];
+        sum->time_histogram[i] += stats->time_histogram[i];
+    }
+}
+
+int anjay_get_operation_stats(anjay_t *anjay_locked,
+                              anjay_ssid_t ssid,
+                              anjay_operation_kind_t kind,
+                              anjay_operation_stats_t *out_stats) {
+    memset(out_stats, 0, sizeof(*out_stats));
+    if ((unsigned) kind >= ANJAY_OPERATION_KIND_LIMIT_) {
+        stats_log(ERROR, _("invalid operation kind: ") "%d", (int) kind);
+        return -1;
+    }
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
+    AVS_LIST(anjay_server_operation_stats_t) stats;
+    AVS_LIST_FOREACH(stats, anjay->operation_stats) {
+        if (ssid == ANJAY_SSID_ANY || stats->ssid == ssid) {
+            add_operation_stats(out_stats, &stats->operations[kind]);
+        }
+    }
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
+    return 0;
+}
+
+int anjay_get_content_format_payloads(anjay_t *anjay_locked,
+                                      anjay_ssid_t ssid,
+                                      uint16_t content_format,
+                                      uint64_t *out_payloads) {
+    *out_payloads = 0;
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
+    AVS_LIST(anjay_server_operation_stats_t) stats;
+    AVS_LIST_FOREACH(stats, anjay->operation_stats) {
+        if (ssid != ANJAY_SSID_ANY && stats->ssid != ssid) {
+            continue;
+        }
+        AVS_LIST(anjay_format_usage_t) usage;
+        AVS_LIST_FOREACH(usage, stats->formats) {
+            if (usage->content_format >= content_format) {
+                if (usage->content_format == content_format) {
+                    *out_payloads += usage->payloads;
+                }
+                break;
+            }
+        }
+    }
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
+    return 0;
+}
+
+void anjay_reset_operation_stats(anjay_t *anjay_locked) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    _anjay_operation_stats_cleanup(anjay);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+#else // ANJAY_WITH_OPERATION_STATS
+
+int anjay_get_operation_stats(anjay_t *anjay,
+                              anjay_ssid_t ssid,
+                              anjay_operation_kind_t kind,
+                              anjay_operation_stats_t *out_stats) {
+    (void) anjay;
+    (void) ssid;
+    (void) kind;
+    memset(out_stats, 0, sizeof(*out_stats));
+    stats_log(ERROR,
+              _("OPERATION_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_OPERATION_STATS option."));
+    return -1;
+}
+
+int anjay_get_content_format_payloads(anjay_t *anjay,
+                                      anjay_ssid_t ssid,
+                                      uint16_t content_format,
+                                      uint64_t *out_payloads) {
+    (void) anjay;
+    (void) ssid;
+    (void) content_format;
+    *out_payloads = 0;
+    stats_log(ERROR,
+              _("OPERATION_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_OPERATION_STATS option."));
+    return -1;
+}
+
+void anjay_reset_operation_stats(anjay_t *anjay) {
+    (void) anjay;
+}
+
+#endif // ANJAY_WITH_OPERATION_STATS
+
+#ifdef ANJAY_WITH_TRAFFIC_STATS
+
+anjay_traffic_snapshot_t _anjay_traffic_snapshot(avs_net_socket_t *socket) {
+    anjay_traffic_snapshot_t snapshot = {
+        .socket = socket
+    };
+    if (socket) {
+        snapshot.bytes_sent = get_socket_stats(socket, NET_STATS_BYTES_SENT);
+        snapshot.bytes_received =
+                get_socket_stats(socket, NET_STATS_BYTES_RECEIVED);
+    }
+    return snapshot;
+}
+
+static anjay_traffic_stats_t *
+find_or_insert_keyed_stats(AVS_LIST(anjay_keyed_traffic_stats_t) *list_ptr,
+                           uint16_t key) {
+    AVS_LIST(anjay_keyed_traffic_stats_t) *stats_ptr;
+    AVS_LIST_FOREACH_PTR(stats_ptr, list_ptr) {
+        if ((*stats_ptr)->key >= key) {
+            break;
+        }
+    }
+    if (!*stats_ptr || (*stats_ptr)->key != key) {
+        AVS_LIST(anjay_keyed_traffic_stats_t) new_stats =
+                AVS_LIST_NEW_ELEMENT(anjay_keyed_traffic_stats_t);
+        if (!new_stats) {
+            // statistics are best-effort, losing a sample is not an error
+            _anjay_log_oom();
+            return NULL;
+        }
+        new_stats->key = key;
+        AVS_LIST_INSERT(stats_ptr, new_stats);
+    }
+    return &(*stats_ptr)->stats;
+}
+
+static void add_traffic(anjay_traffic_stats_t *stats,
+                        uint64_t tx_bytes,
+                        uint64_t rx_bytes) {
+    if (stats) {
+        stats->tx_bytes += tx_bytes;
+        stats->rx_bytes += rx_bytes;
+    }
+}
+
+void _anjay_traffic_stats_record(anjay_unlocked_t *anjay,
+                                 const anjay_traffic_snapshot_t *snapshot,
+                                 avs_net_socket_t *socket,
+                                 const anjay_traffic_context_t *context) {
+    if (!context || !socket || socket != snapshot->socket) {
+        // the connection was closed or reconnected in the meantime, the
+        // counters of the new socket cannot be compared with the snapshot
+        return;
+    }
+    assert((unsigned) context->kind < ANJAY_OPERATION_KIND_LIMIT_);
+    const anjay_traffic_snapshot_t current = _anjay_traffic_snapshot(socket);
+    uint64_t tx_bytes = current.bytes_sent >= snapshot->bytes_sent
+                                ? current.bytes_sent - snapshot->bytes_sent
+                                : 0;
+    uint64_t rx_bytes =
+            current.bytes_received >= snapshot->bytes_received
+                    ? current.bytes_received - snapshot->bytes_received
+                    : 0;
+    if (!tx_bytes && !rx_bytes) {
+        return;
+    }
+    add_traffic(&anjay->operation_traffic_stats[context->kind], tx_bytes,
+                rx_bytes);
+    add_traffic(find_or_insert_keyed_stats(
+                        &anjay->content_format_traffic_stats,
+                        context->content_format),
+                tx_bytes, rx_bytes);
+    add_traffic(find_or_insert_keyed_stats(&anjay->object_traffic_stats,
+                                           context->oid),
+                tx_bytes, rx_bytes);
+}
+
+void _anjay_traffic_stats_cleanup(anjay_unlocked_t *anjay) {
+    memset(anjay->operation_traffic_stats, 0,
+           sizeof(anjay->operation_traffic_stats));
+    AVS_LIST_CLEAR(&anjay->content_format_traffic_stats);
+    AVS_LIST_CLEAR(&anjay->object_traffic_stats);
+}
+
+int anjay_get_operation_traffic_stats(anjay_t *anjay_locked,
+                                      anjay_operation_kind_t kind,
+                                      anjay_traffic_stats_t *out_stats) {
+    memset(out_stats, 0, sizeof(*out_stats));
+    if ((unsigned) kind >= ANJAY_OPERATION_KIND_LIMIT_) {
+        stats_log(ERROR, _("invalid operation kind: ") "%d", (int) kind);
+        return -1;
+    }
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
+    *out_stats = anjay->operation_traffic_stats[kind];
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
+    return 0;
+}
+
+static void get_keyed_traffic_stats(AVS_LIST(anjay_keyed_traffic_stats_t) list,
+                                    uint16_t key,
+                                    anjay_traffic_stats_t *out_stats) {
+    AVS_LIST_ITERATE(list) {
+        if (list->key >= key) {
+            if (list->key == key) {
+                *out_stats = list->stats;
+            }
+            return;
+        }
+    }
+}
+
+int anjay_get_content_format_traffic_stats(anjay_t *anjay_locked,
+                                           uint16_t content_format,
+                                           anjay_traffic_stats_t *out_stats) {
+    memset(out_stats, 0, sizeof(*out_stats));
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
+    get_keyed_traffic_stats(anjay->content_format_traffic_stats,
+                            content_format, out_stats);
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
+    return 0;
+}
+
+int anjay_get_object_traffic_stats(anjay_t *anjay_locked,
+                                   anjay_oid_t oid,
+                                   anjay_traffic_stats_t *out_stats) {
+    memset(out_stats, 0, sizeof(*out_stats));
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
+    get_keyed_traffic_stats(anjay->object_traffic_stats, oid, out_stats);
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
+    return 0;
+}
+
+uint64_t anjay_get_operation_tx_bytes(anjay_t *anjay,
+                                      anjay_operation_kind_t kind) {
+    anjay_traffic_stats_t stats;
+    (void) anjay_get_operation_traffic_stats(anjay, kind, &stats);
+    return stats.tx_bytes;
+}
+
+uint64_t anjay_get_operation_rx_bytes(anjay_t *anjay,
+                                      anjay_operation_kind_t kind) {
+    anjay_traffic_stats_t stats;
+    (void) anjay_get_operation_traffic_stats(anjay, kind, &stats);
+    return stats.rx_bytes;
+}
+
+void anjay_reset_traffic_stats(anjay_t *anjay_locked) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    _anjay_traffic_stats_cleanup(anjay);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+#else // ANJAY_WITH_TRAFFIC_STATS
+
+static int traffic_stats_disabled(anjay_traffic_stats_t *out_stats) {
+    memset(out_stats, 0, sizeof(*out_stats));
+    stats_log(ERROR,
+              _("TRAFFIC_STATS feature disabled. Anjay was compiled without "
+                "ANJAY_WITH_TRAFFIC_STATS option."));
+    return -1;
+}
+
+int anjay_get_operation_traffic_stats(anjay_t *anjay,
+                                      anjay_operation_kind_t kind,
+                                      anjay_traffic_stats_t *out_stats) {
+    (void) anjay;
+    (void) kind;
+    return traffic_stats_disabled(out_stats);
+}
+
+int anjay_get_content_format_traffic_stats(anjay_t *anjay,
+                                           uint16_t content_format,
+                                           anjay_traffic_stats_t *out_stats) {
+    (void) anjay;
+    (void) content_format;
+    return traffic_stats_disabled(out_stats);
+}
+
+int anjay_get_object_traffic_stats(anjay_t *anjay,
+                                   anjay_oid_t oid,
+                                   anjay_traffic_stats_t *out_stats) {
+    (void) anjay;
+    (void) oid;
+    return traffic_stats_disabled(out_stats);
+}
+
+uint64_t anjay_get_operation_tx_bytes(anjay_t *anjay,
+                                      anjay_operation_kind_t kind) {
+    anjay_traffic_stats_t stats;
+    (void) anjay_get_operation_traffic_stats(anjay, kind, &stats);
+    return 0;
+}
+
+uint64_t anjay_get_operation_rx_bytes(anjay_t *anjay,
+                                      anjay_operation_kind_t kind) {
+    anjay_traffic_stats_t stats;
+    (void) anjay_get_operation_traffic_stats(anjay, kind, &stats);
+    return 0;
+}
+
+void anjay_reset_traffic_stats(anjay_t *anjay) {
+    (void) anjay;
+}
+
+#endif // ANJAY_WITH_TRAFFIC_STATS
+
+#ifdef ANJAY_TEST
+#    include "tests/core/stats.c"
+#endif // ANJAY_TEST
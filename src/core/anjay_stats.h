@@ -15,7 +15,9 @@
 #include <stdint.h>
 
 #include <anjay/core.h>
+#include <anjay/stats.h>
 #include <avsystem/coap/ctx.h>
+#include <avsystem/commons/avs_sched.h>
 #include <avsystem/commons/avs_socket.h>
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
@@ -35,6 +37,195 @@ typedef struct {
 
 #endif // ANJAY_WITH_NET_STATS
 
+#ifdef ANJAY_WITH_LOCK_STATS
+struct anjay_lock_stats_struct *_anjay_lock_stats_new(void);
+
+void _anjay_lock_stats_delete(struct anjay_lock_stats_struct **stats_ptr);
+#endif // ANJAY_WITH_LOCK_STATS
+
+#ifdef ANJAY_WITH_SCHED_STATS
+typedef struct {
+    anjay_sched_job_info_t *out_jobs;
+    size_t max_jobs;
+    size_t count;
+} anjay_sched_jobs_collector_t;
+
+/**
+ * Reports a pending job to @ref anjay_get_pending_sched_jobs. Does nothing if
+ * @p handle is not scheduled.
+ */
+void _anjay_sched_jobs_collect(anjay_sched_jobs_collector_t *collector,
+                               anjay_sched_job_kind_t kind,
+                               anjay_ssid_t ssid,
+                               const avs_sched_handle_t *handle);
+
+void _anjay_servers_collect_sched_jobs(anjay_unlocked_t *anjay,
+                                       anjay_sched_jobs_collector_t *collector);
+
+#    ifdef ANJAY_WITH_OBSERVE
+void _anjay_observe_collect_sched_jobs(anjay_unlocked_t *anjay,
+                                       anjay_sched_jobs_collector_t *collector);
+#    endif // ANJAY_WITH_OBSERVE
+
+#    ifdef ANJAY_WITH_DOWNLOADER
+void _anjay_downloader_collect_sched_jobs(
+        anjay_unlocked_t *anjay, anjay_sched_jobs_collector_t *collector);
+#    endif // ANJAY_WITH_DOWNLOADER
+
+void _anjay_sched_job_stats_record(anjay_unlocked_t *anjay,
+                                   anjay_sched_job_kind_t kind,
+                                   avs_time_monotonic_t start_time);
+
+/**
+ * Shall be used at the beginning of a job function, after locking the Anjay
+ * mutex, paired with @ref ANJAY_SCHED_JOB_STATS_END before unlocking it.
+ */
+#    define ANJAY_SCHED_JOB_STATS_BEGIN(StartTimeVar) \
+        const avs_time_monotonic_t StartTimeVar = avs_time_monotonic_now()
+
+#    define ANJAY_SCHED_JOB_STATS_END(Anjay, Kind, StartTimeVar) \
+        _anjay_sched_job_stats_record((Anjay), (Kind), (StartTimeVar))
+#else // ANJAY_WITH_SCHED_STATS
+#    define ANJAY_SCHED_JOB_STATS_BEGIN(StartTimeVar) ((void) 0)
+#    define ANJAY_SCHED_JOB_STATS_END(Anjay, Kind, StartTimeVar) ((void) 0)
+#endif // ANJAY_WITH_SCHED_STATS
+
+#ifdef ANJAY_WITH_OPERATION_STATS
+typedef struct {
+    uint16_t content_format;
+    uint64_t payloads;
+} anjay_format_usage_t;
+
+typedef struct {
+    anjay_ssid_t ssid;
+    anjay_operation_stats_t operations[ANJAY_OPERATION_KIND_LIMIT_];
+    /**
+     * List of Content-Formats of payloads sent to the server, sorted by
+     * content_format.
+     */
+    AVS_LIST(anjay_format_usage_t) formats;
+} anjay_server_operation_stats_t;
+
+/**
+ * Records a single operation reported by @ref anjay_get_operation_stats.
+ * Negative or invalid durations are recorded as 0.
+ */
+void _anjay_operation_stats_record(anjay_unlocked_t *anjay,
+                                   anjay_ssid_t ssid,
+                                   anjay_operation_kind_t kind,
+                                   avs_time_duration_t handler_time,
+                                   avs_time_duration_t total_time,
+                                   bool failed);
+
+/**
+ * Records a single payload of a given Content-Format sent to a server, as
+ * reported by @ref anjay_get_content_format_payloads.
+ */
+void _anjay_operation_stats_record_format(anjay_unlocked_t *anjay,
+                                          anjay_ssid_t ssid,
+                                          uint16_t content_format);
+
+void _anjay_operation_stats_cleanup(anjay_unlocked_t *anjay);
+#endif // ANJAY_WITH_OPERATION_STATS
+
+#ifdef ANJAY_WITH_TRAFFIC_STATS
+/**
+ * Exchange to which traffic is attributed in statistics reported by
+ * @ref anjay_get_operation_traffic_stats and related functions.
+ */
+typedef struct {
+    anjay_operation_kind_t kind;
+    uint16_t content_format;
+    anjay_oid_t oid;
+} anjay_traffic_context_t;
+
+typedef struct {
+    /** Content-Format or OID, depending on the list. */
+    uint16_t key;
+    anjay_traffic_stats_t stats;
+} anjay_keyed_traffic_stats_t;
+
+typedef struct {
+    avs_net_socket_t *socket;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+} anjay_traffic_snapshot_t;
+
+/**
+ * Reads the byte counters of @p socket, which may be NULL.
+ */
+anjay_traffic_snapshot_t _anjay_traffic_snapshot(avs_net_socket_t *socket);
+
+/**
+ * Attributes bytes transferred through @p socket since @p snapshot has been
+ * taken to @p context, or drops them if @p context is NULL. Does nothing if
+ * @p socket is not the one @p snapshot has been taken of, e.g. because the
+ * connection has been closed in the meantime.
+ */
+void _anjay_traffic_stats_record(anjay_unlocked_t *anjay,
+                                 const anjay_traffic_snapshot_t *snapshot,
+                                 avs_net_socket_t *socket,
+                                 const anjay_traffic_context_t *context);
+
+void _anjay_traffic_stats_cleanup(anjay_unlocked_t *anjay);
+
+/**
+ * Shall be used around sending a request that starts an exchange initiated by
+ * the client.
+ */
+#    define ANJAY_TRAFFIC_STATS_BEGIN(SnapshotVar, Socket) \
+        const anjay_traffic_snapshot_t SnapshotVar =       \
+                _anjay_traffic_snapshot(Socket)
+
+#    define ANJAY_TRAFFIC_STATS_END(Anjay, SnapshotVar, Socket, Kind, Format, \
+                                    Oid)                                      \
+        _anjay_traffic_stats_record((Anjay), &(SnapshotVar), (Socket),        \
+                                    &(const anjay_traffic_context_t) {        \
+                                        .kind = (Kind),                       \
+                                        .content_format = (Format),           \
+                                        .oid = (Oid)                          \
+                                    })
+
+/**
+ * Shall be used around handling an incoming packet. Traffic is attributed to
+ * the exchange set using @ref ANJAY_TRAFFIC_STATS_SET_INCOMING while handling
+ * it, if any.
+ */
+#    define ANJAY_TRAFFIC_STATS_INCOMING_BEGIN(Anjay, SnapshotVar, Socket) \
+        (Anjay)->incoming_traffic_context_set = false;                     \
+        ANJAY_TRAFFIC_STATS_BEGIN(SnapshotVar, Socket)
+
+#    define ANJAY_TRAFFIC_STATS_INCOMING_END(Anjay, SnapshotVar, Socket) \
+        _anjay_traffic_stats_record(                                    \
+                (Anjay), &(SnapshotVar), (Socket),                      \
+                (Anjay)->incoming_traffic_context_set                   \
+                        ? &(Anjay)->incoming_traffic_context            \
+                        : NULL)
+
+/**
+ * Shall be called by handlers of incoming requests and of responses to
+ * requests sent by the client.
+ */
+#    define ANJAY_TRAFFIC_STATS_SET_INCOMING(Anjay, Kind, Format, Oid)   \
+        ((Anjay)->incoming_traffic_context = (anjay_traffic_context_t) { \
+             .kind = (Kind),                                             \
+             .content_format = (Format),                                 \
+             .oid = (Oid)                                                \
+         },                                                              \
+         (Anjay)->incoming_traffic_context_set = true)
+#else // ANJAY_WITH_TRAFFIC_STATS
+#    define ANJAY_TRAFFIC_STATS_BEGIN(SnapshotVar, Socket) ((void) 0)
+#    define ANJAY_TRAFFIC_STATS_END(Anjay, SnapshotVar, Socket, Kind, Format, \
+                                    Oid)                                      \
+        ((void) 0)
+#    define ANJAY_TRAFFIC_STATS_INCOMING_BEGIN(Anjay, SnapshotVar, Socket) \
+        ((void) 0)
+#    define ANJAY_TRAFFIC_STATS_INCOMING_END(Anjay, SnapshotVar, Socket) \
+        ((void) 0)
+#    define ANJAY_TRAFFIC_STATS_SET_INCOMING(Anjay, Kind, Format, Oid) \
+        ((void) 0)
+#endif // ANJAY_WITH_TRAFFIC_STATS
+
 void _anjay_coap_ctx_cleanup(anjay_unlocked_t *anjay, avs_coap_ctx_t **ctx);
 
 avs_error_t _anjay_socket_cleanup(anjay_unlocked_t *anjay,
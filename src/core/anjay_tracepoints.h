@@ -0,0 +1,74 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_TRACEPOINTS_H
+#define ANJAY_TRACEPOINTS_H
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_TRACEPOINTS
+#    include <sys/sdt.h>
+#endif // ANJAY_WITH_TRACEPOINTS
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Fires a static tracepoint in the <c>anjay</c> provider. The first argument is
+ * the tracepoint name, followed by up to 10 integer or pointer arguments.
+ *
+ * With <c>ANJAY_WITH_TRACEPOINTS</c> enabled, this expands to a SystemTap SDT
+ * probe, i.e. a single NOP instruction plus an ELF note describing it, which
+ * may be attached to with e.g. <c>bpftrace -e 'usdt:libanjay.so:anjay:name
+ * { ... }'</c>, <c>perf probe sdt_anjay:name</c> or LTTng's userspace probe
+ * support. Arguments are evaluated even when no tracer is attached, so they
+ * shall be cheap to compute and free of side effects.
+ *
+ * Otherwise, the tracepoint expands to nothing and its arguments are not
+ * evaluated at all.
+ *
+ * All available tracepoints are listed below, together with their arguments.
+ *
+ * - <c>packet_received(socket)</c> - @ref _anjay_serve_unlocked called for
+ *   @c socket (avs_net_socket_t *)
+ * - <c>request_parsed(ssid, action, oid, iid, rid)</c> - incoming request
+ *   parsed; @c action is an @ref anjay_request_action_t value, path elements
+ *   not present are 65535
+ * - <c>request_handled(ssid, action, result)</c> - incoming request handled,
+ *   before sending the response; @c result is 0 or an Anjay error code
+ * - <c>dm_handler_enter(handler, oid)</c> and
+ *   <c>dm_handler_exit(handler, oid, result)</c> - data model handler called;
+ *   @c handler is an @ref anjay_dm_handler_t value
+ * - <c>notify_scheduled(ssid, observation, seconds, nanoseconds)</c> -
+ *   notification trigger scheduled at the given monotonic time;
+ *   @c observation (anjay_observation_t *) identifies the observation
+ * - <c>notify_sent(ssid, observation, failed)</c> - notification passed to
+ *   the CoAP layer
+ * - <c>notify_delivered(ssid, observation, retransmissions, failed)</c> -
+ *   notification delivery finished, after @c retransmissions CoAP
+ *   retransmissions
+ * - <c>register_sent(ssid, is_update, attempt)</c> - Register or Update
+ *   request sent; @c attempt is greater than 1 for Register retries
+ * - <c>payload_block(ssid, operation, offset)</c> - next block of an outgoing
+ *   Register, Update, Notify or Send payload requested by the CoAP layer;
+ *   @c operation is an @ref anjay_operation_kind_t value
+ * - <c>download_block(id, size, total)</c> - downloaded data passed to the
+ *   application; @c total is the number of bytes delivered so far
+ * - <c>download_blocks_retried(id, count)</c> - pipelined CoAP download
+ *   falling back to sequential transfer, @c count blocks will be requested
+ *   again
+ */
+#ifdef ANJAY_WITH_TRACEPOINTS
+#    define ANJAY_TRACEPOINT(...) STAP_PROBEV(anjay, __VA_ARGS__)
+#else // ANJAY_WITH_TRACEPOINTS
+#    define ANJAY_TRACEPOINT(...) ((void) 0)
+#endif // ANJAY_WITH_TRACEPOINTS
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* ANJAY_TRACEPOINTS_H */
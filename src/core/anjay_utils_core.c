@@ -12,13 +12,16 @@
 #include <assert.h>
 #include <ctype.h>
 #include <errno.h>
+#include <float.h>
 #include <inttypes.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "anjay_core.h"
+#include "anjay_servers_utils.h"
 
 #include "dm/anjay_query.h"
 
@@ -504,6 +507,11 @@ typedef union {
         // socket used by the `coap` instance above
         avs_net_socket_t *socket;
     } socket_info;
+    struct {
+        char *out;
+        size_t out_size;
+        bool session_found;
+    } dtls_session;
 } security_or_socket_info_t;
 
 typedef int
@@ -618,6 +626,38 @@ try_security_instance_get_coap_and_socket(anjay_unlocked_t *anjay,
     return result;
 }
 
+static int
+try_security_instance_get_dtls_session(anjay_unlocked_t *anjay,
+                                       security_or_socket_info_t *out_info,
+                                       anjay_ssid_t ssid,
+                                       anjay_iid_t security_iid,
+                                       const avs_url_t *url,
+                                       const avs_url_t *server_url) {
+    (void) security_iid;
+    const anjay_transport_info_t *transport_info =
+            _anjay_transport_info_by_uri_scheme(avs_url_protocol(url));
+    if (!transport_info
+            || transport_info->security != ANJAY_TRANSPORT_ENCRYPTED
+            || !url_service_matches(server_url, url,
+                                    transport_info->default_port)) {
+        return ANJAY_FOREACH_CONTINUE;
+    }
+    anjay_connection_ref_t connection =
+            _anjay_servers_find_active_primary_connection(anjay, ssid);
+    if (!connection.server
+            || !_anjay_connection_get_dtls_session(
+                       connection, out_info->dtls_session.out,
+                       out_info->dtls_session.out_size)) {
+        return ANJAY_FOREACH_CONTINUE;
+    }
+    anjay_log(DEBUG,
+              _("attempting to resume DTLS session of SSID=") "%" PRIu16 _(
+                      " for the download"),
+              ssid);
+    out_info->dtls_session.session_found = true;
+    return ANJAY_FOREACH_BREAK;
+}
+
 static bool optional_strings_equal(const char *left, const char *right) {
     if (left && right) {
         return strcmp(left, right) == 0;
@@ -793,6 +833,19 @@ void _anjay_find_matching_coap_context_and_socket(
     *out_socket = info.socket_info.socket;
 }
 
+bool _anjay_find_matching_dtls_session(anjay_unlocked_t *anjay,
+                                       const char *raw_url,
+                                       char *out_buffer,
+                                       size_t buffer_size) {
+    security_or_socket_info_t info;
+    memset(&info, 0, sizeof(info));
+    info.dtls_session.out = out_buffer;
+    info.dtls_session.out_size = buffer_size;
+    try_get_info_from_dm(anjay, raw_url, &info,
+                         try_security_instance_get_dtls_session);
+    return info.dtls_session.session_found;
+}
+
 static int map_str_conversion_result(const char *input, const char *endptr) {
     return (!*input || isspace((unsigned char) *input) || errno || !endptr
             || *endptr)
@@ -821,12 +874,65 @@ int _anjay_safe_strtod(const char *in, double *value) {
     return map_str_conversion_result(in, endptr);
 }
 
+const char *_anjay_double_as_shortest_string(char *buf,
+                                             size_t buf_size,
+                                             double value) {
+    assert(buf_size > 0);
+    if (isfinite(value)) {
+        // Integers below 10^15 are printed without an exponent by all the
+        // precisions tried below, so they can be formatted directly.
+        if (value != 0.0 && value > -1e15 && value < 1e15
+                && value == (double) (int64_t) value) {
+            if (avs_simple_snprintf(buf, buf_size, "%s",
+                                    AVS_INT64_AS_STRING((int64_t) value))
+                    >= 0) {
+                return buf;
+            }
+        }
+        // Every decimal number with up to DBL_DIG significant digits survives
+        // a round trip through double, so if the value can be represented
+        // with that many digits, %g-style formatting with precision DBL_DIG
+        // yields the shortest representation after trailing zeros are
+        // stripped.
+        for (uint8_t precision = DBL_DIG; precision < 17; ++precision) {
+            double parsed;
+            if (avs_simple_snprintf(buf, buf_size, "%s",
+                                    AVS_DOUBLE_AS_STRING(value, precision))
+                            >= 0
+                    && !_anjay_safe_strtod(buf, &parsed) && parsed == value) {
+                return buf;
+            }
+        }
+    }
+    if (avs_simple_snprintf(buf, buf_size, "%s",
+                            AVS_DOUBLE_AS_STRING(value, 17))
+            < 0) {
+        buf[0] = '\0';
+    }
+    return buf;
+}
+
 // || defined(ANJAY_WITH_CORE_PERSISTENCE))
 
 void _anjay_log_oom(void) {
     anjay_log(ERROR, _("out of memory"));
 }
 
+avs_time_duration_t _anjay_random_duration(anjay_unlocked_t *anjay,
+                                           avs_time_duration_t min,
+                                           avs_time_duration_t max) {
+    uint32_t random;
+    if (!avs_time_duration_less(min, max)
+            || avs_crypto_prng_bytes(anjay->prng_ctx.ctx,
+                                     (unsigned char *) &random,
+                                     sizeof(random))) {
+        return min;
+    }
+    return avs_time_duration_add(
+            min, avs_time_duration_fmul(avs_time_duration_diff(max, min),
+                                        (double) random / (double) UINT32_MAX));
+}
+
 #ifdef ANJAY_TEST
 #    include "tests/core/utils.c"
 #endif // ANJAY_TEST
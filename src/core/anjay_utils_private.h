@@ -34,6 +34,26 @@ int _anjay_safe_strtoll(const char *in, long long *value);
 int _anjay_safe_strtoull(const char *in, unsigned long long *value);
 int _anjay_safe_strtod(const char *in, double *value);
 
+#define ANJAY_DOUBLE_AS_SHORTEST_STRING_BUF_SIZE 32
+
+/**
+ * Formats @p value using the smallest number of significant digits that is
+ * enough to parse it back (with @ref _anjay_safe_strtod) into exactly the same
+ * value, falling back to the 17 digits that are always sufficient. Subnormal
+ * values, which have less precision, are not guaranteed to get the shortest
+ * representation, but still survive a round trip.
+ *
+ * @returns @p buf
+ */
+const char *_anjay_double_as_shortest_string(char *buf,
+                                             size_t buf_size,
+                                             double value);
+
+#define ANJAY_DOUBLE_AS_SHORTEST_STRING(Value)                              \
+    _anjay_double_as_shortest_string(                                       \
+            &(char[ANJAY_DOUBLE_AS_SHORTEST_STRING_BUF_SIZE]){ "" }[0],     \
+            ANJAY_DOUBLE_AS_SHORTEST_STRING_BUF_SIZE, (Value))
+
 AVS_LIST(const anjay_string_t)
 _anjay_make_string_list(const char *string, ... /* strings */) AVS_F_SENTINEL;
 
@@ -128,6 +148,15 @@ bool _anjay_socket_transport_included(anjay_transport_set_t set,
 bool _anjay_socket_transport_is_online(anjay_unlocked_t *anjay,
                                        anjay_socket_transport_t transport);
 
+/**
+ * Returns a duration drawn uniformly at random from the range between @p min
+ * and @p max, inclusive, using the PRNG context of @p anjay. @p min is returned
+ * if the PRNG fails or the range is empty.
+ */
+avs_time_duration_t _anjay_random_duration(anjay_unlocked_t *anjay,
+                                           avs_time_duration_t min,
+                                           avs_time_duration_t max);
+
 // || defined(ANJAY_WITH_CORE_PERSISTENCE))
 
 #define ANJAY_SMS_URI_SCHEME "tel"
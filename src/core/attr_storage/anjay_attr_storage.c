@@ -16,9 +16,11 @@
 #    include <math.h>
 #    include <string.h>
 
+#    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_stream_membuf.h>
 
 #    include <anjay_modules/anjay_dm_utils.h>
+#    include <anjay_modules/anjay_memory_accounting.h>
 #    include <anjay_modules/anjay_raw_buffer.h>
 
 #    include "../anjay_core.h"
@@ -37,12 +39,18 @@ int _anjay_attr_storage_init(anjay_unlocked_t *anjay) {
                   avs_stream_membuf_create())) {
         return -1;
     }
+    anjay->attr_storage.journal_baseline_valid = true;
     return 0;
 }
 
 void _anjay_attr_storage_cleanup(anjay_attr_storage_t *as) {
     assert(as);
     _anjay_attr_storage_clear(as);
+    avs_free(as->index);
+    as->index = NULL;
+    as->index_size = 0;
+    as->index_capacity = 0;
+    AVS_LIST_CLEAR(&as->journal_baseline);
     avs_stream_cleanup(&as->saved_state.persist_data);
 }
 
@@ -58,12 +66,14 @@ void _anjay_attr_storage_clear(anjay_attr_storage_t *as) {
     while (as->objects) {
         remove_object_entry(as, &as->objects);
     }
+    _anjay_attr_storage_invalidate_index(as);
 }
 
 void anjay_attr_storage_purge(anjay_t *anjay_locked) {
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     _anjay_attr_storage_clear(&anjay->attr_storage);
     _anjay_attr_storage_mark_modified(&anjay->attr_storage);
+    _anjay_dm_cache_invalidate_all_discover(anjay);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
 
@@ -160,19 +170,23 @@ find_or_create_resource_instance(as_resource_entry_t *parent, anjay_riid_t id) {
 }
 #    endif // ANJAY_WITH_LWM2M11
 
-static void remove_instance_if_empty(AVS_LIST(as_instance_entry_t) *entry_ptr) {
+static void remove_instance_if_empty(anjay_attr_storage_t *as,
+                                     AVS_LIST(as_instance_entry_t) *entry_ptr) {
     if (!(*entry_ptr)->default_attrs && !(*entry_ptr)->resources) {
         AVS_LIST_DELETE(entry_ptr);
+        _anjay_attr_storage_invalidate_index(as);
     }
 }
 
-static void remove_resource_if_empty(AVS_LIST(as_resource_entry_t) *entry_ptr) {
+static void remove_resource_if_empty(anjay_attr_storage_t *as,
+                                     AVS_LIST(as_resource_entry_t) *entry_ptr) {
     if (!(*entry_ptr)->attrs
 #    ifdef ANJAY_WITH_LWM2M11
             && !(*entry_ptr)->resource_instances
 #    endif // ANJAY_WITH_LWM2M11
     ) {
         AVS_LIST_DELETE(entry_ptr);
+        _anjay_attr_storage_invalidate_index(as);
     }
 }
 
@@ -277,11 +291,11 @@ static void remove_servers_not_on_ssid_list(anjay_attr_storage_t *as,
                     remove_resource_instance_if_empty(res_instance_ptr);
                 }
 #    endif // ANJAY_WITH_LWM2M11
-                remove_resource_if_empty(res_ptr);
+                remove_resource_if_empty(as, res_ptr);
             }
-            remove_instance_if_empty(instance_ptr);
+            remove_instance_if_empty(as, instance_ptr);
         }
-        remove_object_if_empty(object_ptr);
+        remove_object_if_empty(as, object_ptr);
     }
 }
 
@@ -348,7 +362,7 @@ int _anjay_attr_storage_remove_absent_resources(
             remove_resource_entry(&anjay->attr_storage, resource_ptr);
         }
     }
-    remove_instance_if_empty(instance_ptr);
+    remove_instance_if_empty(&anjay->attr_storage, instance_ptr);
     return result;
 }
 
@@ -404,7 +418,7 @@ int _anjay_attr_storage_remove_absent_resource_instances(
                                            resource_instance_ptr);
         }
     }
-    remove_resource_if_empty(resource_ptr);
+    remove_resource_if_empty(&anjay->attr_storage, resource_ptr);
     return result;
 }
 #    endif // ANJAY_WITH_LWM2M11
@@ -456,7 +470,10 @@ static int write_attrs_impl(anjay_attr_storage_t *as,
         // writing non-empty set of attributes
         if (!found) {
             // entry does not exist, creating
+            ANJAY_MEMORY_TAG_ENTER(prev_memory_tag,
+                                   ANJAY_MEMORY_TAG_ATTR_STORAGE);
             AVS_LIST(void) new_attrs = AVS_LIST_NEW_BUFFER(element_size);
+            ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
             if (!new_attrs) {
                 _anjay_log_oom();
                 return ANJAY_ERR_INTERNAL;
@@ -496,7 +513,7 @@ static int write_object_attrs(anjay_unlocked_t *anjay,
     int result =
             WRITE_ATTRS(&anjay->attr_storage, &(*object_ptr)->default_attrs,
                         default_attrs_empty, ssid, attrs);
-    remove_object_if_empty(object_ptr);
+    remove_object_if_empty(&anjay->attr_storage, object_ptr);
     return result;
 }
 
@@ -518,10 +535,10 @@ static int write_instance_attrs(anjay_unlocked_t *anjay,
     }
 
     if (instance_ptr) {
-        remove_instance_if_empty(instance_ptr);
+        remove_instance_if_empty(&anjay->attr_storage, instance_ptr);
     }
     if (object_ptr) {
-        remove_object_if_empty(object_ptr);
+        remove_object_if_empty(&anjay->attr_storage, object_ptr);
     }
     return result;
 }
@@ -546,13 +563,13 @@ static int write_resource_attrs(anjay_unlocked_t *anjay,
     }
 
     if (resource_ptr) {
-        remove_resource_if_empty(resource_ptr);
+        remove_resource_if_empty(&anjay->attr_storage, resource_ptr);
     }
     if (instance_ptr) {
-        remove_instance_if_empty(instance_ptr);
+        remove_instance_if_empty(&anjay->attr_storage, instance_ptr);
     }
     if (object_ptr) {
-        remove_object_if_empty(object_ptr);
+        remove_object_if_empty(&anjay->attr_storage, object_ptr);
     }
     return result;
 }
@@ -588,13 +605,13 @@ write_resource_instance_attrs(anjay_unlocked_t *anjay,
         remove_resource_instance_if_empty(resource_instance_ptr);
     }
     if (resource_ptr) {
-        remove_resource_if_empty(resource_ptr);
+        remove_resource_if_empty(&anjay->attr_storage, resource_ptr);
     }
     if (instance_ptr) {
-        remove_instance_if_empty(instance_ptr);
+        remove_instance_if_empty(&anjay->attr_storage, instance_ptr);
     }
     if (object_ptr) {
-        remove_object_if_empty(object_ptr);
+        remove_object_if_empty(&anjay->attr_storage, object_ptr);
     }
     return result;
 }
@@ -666,26 +683,78 @@ static int compare_u16ids(const void *a, const void *b, size_t element_size) {
     return *(const uint16_t *) a - *(const uint16_t *) b;
 }
 
-static int remove_absent_resources(anjay_unlocked_t *anjay,
-                                   AVS_LIST(as_object_entry_t) *as_object_ptr,
-                                   const anjay_dm_installed_object_t *obj_ptr,
-                                   anjay_iid_t iid) {
-    assert(as_object_ptr);
+static void
+remove_known_removed_instances(anjay_attr_storage_t *as,
+                               AVS_LIST(as_object_entry_t) *object_ptr,
+                               AVS_LIST(anjay_iid_t) removed_iids) {
+    AVS_LIST(as_instance_entry_t) *instance_ptr = &(*object_ptr)->instances;
+    AVS_LIST(anjay_iid_t) iid;
+    AVS_LIST_FOREACH(iid, removed_iids) {
+        // both lists are sorted, so the search continues from the previous
+        // instance instead of the beginning of the list
+        while (*instance_ptr && (*instance_ptr)->iid < *iid) {
+            AVS_LIST_ADVANCE_PTR(&instance_ptr);
+        }
+        if (*instance_ptr && (*instance_ptr)->iid == *iid) {
+            remove_instance_entry(as, instance_ptr);
+        }
+    }
+}
+
+static bool
+ssid_resource_changed(anjay_oid_t oid,
+                      AVS_LIST(anjay_notify_queue_resource_entry_t)
+                              resources_changed) {
+    AVS_LIST(anjay_notify_queue_resource_entry_t) resource_entry;
+    AVS_LIST_FOREACH(resource_entry, resources_changed) {
+        if (resource_entry->rid == ssid_rid(oid)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Checks whether the set of Short Server IDs defined in the Security or Server
+ * object might have been changed by @p object_entry . Removed instances are
+ * known only by their IIDs, so the SSIDs they used to define cannot be read
+ * anymore - the remaining ones are enumerated instead.
+ */
+static bool
+ssid_set_might_have_changed(const anjay_notify_queue_object_entry_t
+                                    *object_entry) {
+    return is_ssid_reference_object(object_entry->oid)
+           && (object_entry->instance_set_changes.unknown_change
+               || object_entry->instance_set_changes.known_removed_iids
+               || ssid_resource_changed(object_entry->oid,
+                                        object_entry->resources_changed));
+}
+
+static int
+remove_resource_if_absent(anjay_unlocked_t *anjay,
+                          AVS_LIST(as_object_entry_t) *object_ptr,
+                          const anjay_dm_installed_object_t *def_ptr,
+                          const anjay_notify_queue_resource_entry_t *entry) {
     AVS_LIST(as_instance_entry_t) *instance_ptr =
-            find_instance(*as_object_ptr, iid);
-    if (!instance_ptr) {
+            find_instance(*object_ptr, entry->iid);
+    AVS_LIST(as_resource_entry_t) *resource_ptr;
+    if (!instance_ptr
+            || !(resource_ptr = find_resource(*instance_ptr, entry->rid))) {
         return 0;
     }
-    int result = 0;
-    if (obj_ptr) {
-        result =
-                _anjay_attr_storage_remove_absent_resources(anjay, instance_ptr,
-                                                            obj_ptr);
+    anjay_dm_resource_presence_t presence;
+    int result = _anjay_dm_resource_kind_and_presence(
+            anjay, def_ptr, entry->iid, entry->rid, NULL, &presence);
+    if (result == ANJAY_ERR_NOT_FOUND
+            || (!result && presence == ANJAY_DM_RES_ABSENT)) {
+        remove_resource_entry(&anjay->attr_storage, resource_ptr);
+        remove_instance_if_empty(&anjay->attr_storage, instance_ptr);
+        result = 0;
     }
     return result;
 }
 
-static int remove_absent_resources_in_all_instances(
+static int remove_absent_changed_resources(
         anjay_unlocked_t *anjay,
         const anjay_dm_installed_object_t *def_ptr,
         AVS_LIST(anjay_notify_queue_resource_entry_t) resources_changed) {
@@ -694,19 +763,14 @@ static int remove_absent_resources_in_all_instances(
             find_object(&anjay->attr_storage,
                         _anjay_dm_installed_object_oid(def_ptr));
     if (object_ptr) {
-        anjay_iid_t last_iid = ANJAY_ID_INVALID;
         AVS_LIST(anjay_notify_queue_resource_entry_t) resource_entry;
         AVS_LIST_FOREACH(resource_entry, resources_changed) {
-            if (resource_entry->iid != last_iid) {
-                // note that remove_absent_resources() does NOT call
-                // remove_object_if_empty().
-                _anjay_update_ret(&result, remove_absent_resources(
-                                                   anjay, object_ptr, def_ptr,
-                                                   resource_entry->iid));
-            }
-            last_iid = resource_entry->iid;
+            _anjay_update_ret(&result,
+                              remove_resource_if_absent(anjay, object_ptr,
+                                                        def_ptr,
+                                                        resource_entry));
         }
-        remove_object_if_empty(object_ptr);
+        remove_object_if_empty(&anjay->attr_storage, object_ptr);
     }
     return result;
 }
@@ -719,7 +783,8 @@ int _anjay_attr_storage_notify(anjay_unlocked_t *anjay,
         AVS_LIST(as_object_entry_t) *object_ptr =
                 find_object(&anjay->attr_storage, object_entry->oid);
         assert(!object_ptr || *object_ptr);
-        if (!object_ptr && !is_ssid_reference_object(object_entry->oid)) {
+        const bool ssid_set_changed = ssid_set_might_have_changed(object_entry);
+        if (!object_ptr && !ssid_set_changed) {
             continue;
         }
         const anjay_dm_installed_object_t *def_ptr =
@@ -728,25 +793,36 @@ int _anjay_attr_storage_notify(anjay_unlocked_t *anjay,
             remove_object_entry(&anjay->attr_storage, object_ptr);
             continue;
         }
-        AVS_LIST(anjay_ssid_t) ssids = NULL;
-        int partial_result =
-                remove_absent_instances_and_enumerate_ssids(anjay, def_ptr,
-                                                            object_ptr, &ssids);
-        if (object_ptr) {
-            remove_object_if_empty(object_ptr);
-        }
-        if (!partial_result && is_ssid_reference_object(object_entry->oid)) {
-            AVS_LIST_SORT(&ssids, compare_u16ids);
-            remove_servers_not_on_ssid_list(&anjay->attr_storage, ssids);
+        int partial_result = 0;
+        if (ssid_set_changed
+                || object_entry->instance_set_changes.unknown_change) {
+            AVS_LIST(anjay_ssid_t) ssids = NULL;
+            partial_result = remove_absent_instances_and_enumerate_ssids(
+                    anjay, def_ptr, object_ptr, &ssids);
+            if (object_ptr) {
+                remove_object_if_empty(&anjay->attr_storage, object_ptr);
+            }
+            if (!partial_result && ssid_set_changed) {
+                AVS_LIST_SORT(&ssids, compare_u16ids);
+                remove_servers_not_on_ssid_list(&anjay->attr_storage, ssids);
+            }
+            AVS_LIST_CLEAR(&ssids);
+        } else if (object_ptr
+                   && object_entry->instance_set_changes.known_removed_iids) {
+            // the notification lists all the removed instances, so there is
+            // no need to ask the data model about the remaining ones
+            remove_known_removed_instances(
+                    &anjay->attr_storage, object_ptr,
+                    object_entry->instance_set_changes.known_removed_iids);
+            remove_object_if_empty(&anjay->attr_storage, object_ptr);
         }
-        AVS_LIST_CLEAR(&ssids);
         if (!partial_result) {
             // NOTE: This looks up object_ptr the second time, which is
             // necessary because the above code might have removed
             // as_object_entry_t entries, thus potentially invalidating
             // object_ptr
             assert(def_ptr);
-            partial_result = remove_absent_resources_in_all_instances(
+            partial_result = remove_absent_changed_resources(
                     anjay, def_ptr, object_entry->resources_changed);
         }
         _anjay_update_ret(&result, partial_result);
@@ -754,6 +830,118 @@ int _anjay_attr_storage_notify(anjay_unlocked_t *anjay,
     return result;
 }
 
+//// LOOKUP INDEX //////////////////////////////////////////////////////////////
+
+static inline uint64_t
+index_key(anjay_oid_t oid, anjay_iid_t iid, anjay_rid_t rid) {
+    // Instance entries use rid == ANJAY_ID_INVALID and are mapped to 0, so
+    // that they sort before all Resource entries of the same Instance.
+    return ((uint64_t) oid << 34) | ((uint64_t) iid << 17)
+           | (rid == ANJAY_ID_INVALID ? 0 : (uint64_t) rid + 1);
+}
+
+static int index_append(anjay_attr_storage_t *as, uint64_t key, void *entry) {
+    assert(!as->index_size || as->index[as->index_size - 1].key < key);
+    if (as->index_size >= as->index_capacity) {
+        size_t new_capacity = as->index_capacity ? 2 * as->index_capacity : 16;
+        ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_ATTR_STORAGE);
+        as_index_entry_t *new_index = (as_index_entry_t *) avs_realloc(
+                as->index, new_capacity * sizeof(*new_index));
+        ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+        if (!new_index) {
+            _anjay_log_oom();
+            return -1;
+        }
+        as->index = new_index;
+        as->index_capacity = new_capacity;
+    }
+    as->index[as->index_size].key = key;
+    as->index[as->index_size].entry = entry;
+    ++as->index_size;
+    return 0;
+}
+
+static int rebuild_index(anjay_attr_storage_t *as) {
+    as->index_size = 0;
+    AVS_LIST(as_object_entry_t) object;
+    AVS_LIST_FOREACH(object, as->objects) {
+        AVS_LIST(as_instance_entry_t) instance;
+        AVS_LIST_FOREACH(instance, object->instances) {
+            if (index_append(as,
+                             index_key(object->oid, instance->iid,
+                                       ANJAY_ID_INVALID),
+                             instance)) {
+                return -1;
+            }
+            AVS_LIST(as_resource_entry_t) resource;
+            AVS_LIST_FOREACH(resource, instance->resources) {
+                if (index_append(as,
+                                 index_key(object->oid, instance->iid,
+                                           resource->rid),
+                                 resource)) {
+                    return -1;
+                }
+            }
+        }
+    }
+    as->index_valid = true;
+    return 0;
+}
+
+/**
+ * Looks up an entry in the index, rebuilding it first if necessary.
+ *
+ * @returns 0 if the index could be used, in which case @p out_entry is set to
+ *          the found entry or NULL if there is none; -1 if the index could
+ *          not be rebuilt and the caller shall fall back to walking the lists.
+ */
+static int
+index_lookup(anjay_attr_storage_t *as, uint64_t key, void **out_entry) {
+    if (!as->index_valid && rebuild_index(as)) {
+        return -1;
+    }
+    size_t begin = 0;
+    size_t end = as->index_size;
+    while (begin < end) {
+        size_t mid = begin + (end - begin) / 2;
+        if (as->index[mid].key < key) {
+            begin = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    *out_entry = (begin < as->index_size && as->index[begin].key == key)
+                         ? as->index[begin].entry
+                         : NULL;
+    return 0;
+}
+
+static as_instance_entry_t *
+lookup_instance(anjay_attr_storage_t *as, anjay_oid_t oid, anjay_iid_t iid) {
+    void *entry;
+    if (!index_lookup(as, index_key(oid, iid, ANJAY_ID_INVALID), &entry)) {
+        return (as_instance_entry_t *) entry;
+    }
+    AVS_LIST(as_object_entry_t) *object_ptr = find_object(as, oid);
+    AVS_LIST(as_instance_entry_t) *instance_ptr =
+            object_ptr ? find_instance(*object_ptr, iid) : NULL;
+    return instance_ptr ? *instance_ptr : NULL;
+}
+
+static as_resource_entry_t *lookup_resource(anjay_attr_storage_t *as,
+                                            anjay_oid_t oid,
+                                            anjay_iid_t iid,
+                                            anjay_rid_t rid) {
+    void *entry;
+    if (!index_lookup(as, index_key(oid, iid, rid), &entry)) {
+        return (as_resource_entry_t *) entry;
+    }
+    as_instance_entry_t *instance = lookup_instance(as, oid, iid);
+    AVS_LIST(as_resource_entry_t) *res_ptr =
+            instance ? find_resource(instance, rid) : NULL;
+    return res_ptr ? *res_ptr : NULL;
+}
+
 //// ATTRIBUTE HANDLERS ////////////////////////////////////////////////////////
 
 static int object_read_default_attrs(anjay_unlocked_t *anjay,
@@ -782,13 +970,10 @@ instance_read_default_attrs(anjay_unlocked_t *anjay,
                             anjay_iid_t iid,
                             anjay_ssid_t ssid,
                             anjay_dm_oi_attributes_t *out) {
-    AVS_LIST(as_object_entry_t) *object_ptr =
-            find_object(&anjay->attr_storage,
-                        _anjay_dm_installed_object_oid(&obj_ptr));
-    AVS_LIST(as_instance_entry_t) *instance_ptr =
-            object_ptr ? find_instance(*object_ptr, iid) : NULL;
-    read_default_attrs(instance_ptr ? (*instance_ptr)->default_attrs : NULL,
-                       ssid, out);
+    as_instance_entry_t *instance =
+            lookup_instance(&anjay->attr_storage,
+                            _anjay_dm_installed_object_oid(&obj_ptr), iid);
+    read_default_attrs(instance ? instance->default_attrs : NULL, ssid, out);
     return 0;
 }
 
@@ -809,14 +994,10 @@ static int resource_read_attrs(anjay_unlocked_t *anjay,
                                anjay_rid_t rid,
                                anjay_ssid_t ssid,
                                anjay_dm_r_attributes_t *out) {
-    AVS_LIST(as_object_entry_t) *object_ptr =
-            find_object(&anjay->attr_storage,
-                        _anjay_dm_installed_object_oid(&obj_ptr));
-    AVS_LIST(as_instance_entry_t) *instance_ptr =
-            object_ptr ? find_instance(*object_ptr, iid) : NULL;
-    AVS_LIST(as_resource_entry_t) *res_ptr =
-            instance_ptr ? find_resource(*instance_ptr, rid) : NULL;
-    read_resource_attrs(res_ptr ? (*res_ptr)->attrs : NULL, ssid, out);
+    as_resource_entry_t *res =
+            lookup_resource(&anjay->attr_storage,
+                            _anjay_dm_installed_object_oid(&obj_ptr), iid, rid);
+    read_resource_attrs(res ? res->attrs : NULL, ssid, out);
     return 0;
 }
 
@@ -840,15 +1021,11 @@ resource_instance_read_attrs(anjay_unlocked_t *anjay,
                              anjay_riid_t riid,
                              anjay_ssid_t ssid,
                              anjay_dm_r_attributes_t *out) {
-    AVS_LIST(as_object_entry_t) *object_ptr =
-            find_object(&anjay->attr_storage,
-                        _anjay_dm_installed_object_oid(&obj_ptr));
-    AVS_LIST(as_instance_entry_t) *instance_ptr =
-            object_ptr ? find_instance(*object_ptr, iid) : NULL;
-    AVS_LIST(as_resource_entry_t) *res_ptr =
-            instance_ptr ? find_resource(*instance_ptr, rid) : NULL;
+    as_resource_entry_t *res =
+            lookup_resource(&anjay->attr_storage,
+                            _anjay_dm_installed_object_oid(&obj_ptr), iid, rid);
     AVS_LIST(as_resource_instance_entry_t) *res_instance_ptr =
-            res_ptr ? find_resource_instance(*res_ptr, riid) : NULL;
+            res ? find_resource_instance(res, riid) : NULL;
     read_resource_attrs(res_instance_ptr ? (*res_instance_ptr)->attrs : NULL,
                         ssid, out);
     return 0;
@@ -892,8 +1069,11 @@ static void saved_state_reset(anjay_attr_storage_t *as) {
 avs_error_t _anjay_attr_storage_transaction_begin(anjay_unlocked_t *anjay) {
     anjay->attr_storage.saved_state.modified_since_persist =
             anjay->attr_storage.modified_since_persist;
-    return _anjay_attr_storage_persist_inner(
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_ATTR_STORAGE);
+    avs_error_t err = _anjay_attr_storage_persist_inner(
             &anjay->attr_storage, anjay->attr_storage.saved_state.persist_data);
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+    return err;
 }
 
 void _anjay_attr_storage_transaction_commit(anjay_unlocked_t *anjay) {
@@ -901,10 +1081,11 @@ void _anjay_attr_storage_transaction_commit(anjay_unlocked_t *anjay) {
 }
 
 avs_error_t _anjay_attr_storage_transaction_rollback(anjay_unlocked_t *anjay) {
-    avs_error_t err;
-    if (avs_is_err((err = _anjay_attr_storage_restore_inner(
-                            anjay,
-                            anjay->attr_storage.saved_state.persist_data)))) {
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_ATTR_STORAGE);
+    avs_error_t err = _anjay_attr_storage_restore_inner(
+            anjay, anjay->attr_storage.saved_state.persist_data);
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+    if (avs_is_err(err)) {
         anjay->attr_storage.modified_since_persist = true;
     } else {
         anjay->attr_storage.modified_since_persist =
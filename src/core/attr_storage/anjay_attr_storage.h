@@ -24,10 +24,32 @@ typedef struct {
     bool modified_since_persist;
 } as_saved_state_t;
 
+typedef struct as_index_entry as_index_entry_t;
+typedef struct as_journal_object as_journal_object_t;
+
 typedef struct {
     AVS_LIST(as_object_entry_t) objects;
     bool modified_since_persist;
     as_saved_state_t saved_state;
+    /**
+     * Array of all Instance and Resource entries from @ref objects, sorted by
+     * path. It is used by the attribute read handlers to find entries with a
+     * binary search instead of walking the nested lists, and is rebuilt
+     * lazily after any change to the structure of @ref objects.
+     */
+    as_index_entry_t *index;
+    size_t index_size;
+    size_t index_capacity;
+    bool index_valid;
+    /**
+     * Digests of all the Objects as of the last persisted or restored state,
+     * sorted by Object ID. Used by anjay_attr_storage_persist_journal() to
+     * determine which Objects changed.
+     */
+    AVS_LIST(as_journal_object_t) journal_baseline;
+    // false if journal_baseline could not be determined due to an error
+    bool journal_baseline_valid;
+    size_t journal_records;
 } anjay_attr_storage_t;
 
 static inline bool _anjay_dm_implements_any_object_default_attrs_handlers(
@@ -11,15 +11,18 @@
 
 #ifdef ANJAY_WITH_ATTR_STORAGE
 
+#    include <inttypes.h>
 #    include <stdio.h>
 #    include <string.h>
 
 #    include "core/anjay_core.h"
 
 #    include <avsystem/commons/avs_persistence.h>
+#    include <avsystem/commons/avs_stream_membuf.h>
 
 #    include <anjay_modules/anjay_dm_utils.h>
 #    include <anjay_modules/anjay_io_utils.h>
+#    include <anjay_modules/anjay_memory_accounting.h>
 #    include <anjay_modules/anjay_raw_buffer.h>
 
 #    define ANJAY_ATTR_STORAGE_INTERNALS
@@ -359,12 +362,285 @@ static avs_error_t clear_nonexistent_entries(anjay_unlocked_t *anjay,
             if (retval || clear_nonexistent_rids(anjay, object_ptr, def_ptr)) {
                 return avs_errno(AVS_EPROTO);
             }
-            remove_object_if_empty(object_ptr);
+            remove_object_if_empty(as, object_ptr);
         }
     }
     return AVS_OK;
 }
 
+//// JOURNAL ///////////////////////////////////////////////////////////////////
+
+/**
+ * NOTE: The journal is a sequence of batches, each appended by a single call to
+ * anjay_attr_storage_persist_journal(). Each batch starts with JOURNAL_MAGIC,
+ * followed by a version byte (with the same meaning as for the full snapshot)
+ * and a 32-bit number of records. Each record is a presence flag, followed
+ * either by the whole Object entry, if it is present, or by the Object ID
+ * only, if the Object no longer has any attributes.
+ */
+static const char *JOURNAL_MAGIC = "FAJ";
+
+static uint64_t journal_digest(const void *data, size_t size) {
+    // 64-bit FNV-1a
+    uint64_t digest = UINT64_C(0xcbf29ce484222325);
+    for (size_t i = 0; i < size; ++i) {
+        digest ^= ((const uint8_t *) data)[i];
+        digest *= UINT64_C(0x100000001b3);
+    }
+    return digest;
+}
+
+static avs_error_t serialize_object(as_object_entry_t *object,
+                                    void **out_data,
+                                    size_t *out_size) {
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    if (!membuf) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    avs_persistence_context_t ctx =
+            avs_persistence_store_context_create(membuf);
+    avs_error_t err;
+    (void) (avs_is_err((err = handle_object(
+                                &ctx, object,
+                                (void *) (intptr_t)
+                                        AS_PERSISTENCE_VERSION_CURRENT)))
+            || avs_is_err((err = avs_stream_membuf_take_ownership(
+                                   membuf, out_data, out_size))));
+    avs_stream_cleanup(&membuf);
+    return err;
+}
+
+static avs_error_t
+append_journal_record(avs_persistence_context_t *batch_ctx,
+                      avs_stream_t *batch,
+                      anjay_oid_t oid,
+                      const void *data,
+                      size_t size) {
+    bool present = !!data;
+    avs_error_t err = avs_persistence_bool(batch_ctx, &present);
+    if (avs_is_ok(err)) {
+        err = present ? avs_stream_write(batch, data, size)
+                      : avs_persistence_u16(batch_ctx, &oid);
+    }
+    return err;
+}
+
+/**
+ * Serializes all the Objects, appending records for the changed ones to
+ * @p batch (if not NULL), and builds a new list of digests.
+ */
+static avs_error_t
+build_journal_batch(anjay_attr_storage_t *as,
+                    avs_stream_t *batch,
+                    uint32_t *out_records,
+                    AVS_LIST(as_journal_object_t) *out_baseline) {
+    avs_persistence_context_t batch_ctx =
+            avs_persistence_store_context_create(batch);
+    AVS_LIST(as_journal_object_t) *baseline_tail = out_baseline;
+    AVS_LIST(as_journal_object_t) old = as->journal_baseline;
+    AVS_LIST(as_object_entry_t) object = as->objects;
+    avs_error_t err = AVS_OK;
+    *out_records = 0;
+    while (avs_is_ok(err) && (object || old)) {
+        if (!object || (old && old->oid < object->oid)) {
+            if (batch) {
+                err = append_journal_record(&batch_ctx, batch, old->oid, NULL,
+                                            0);
+                ++*out_records;
+            }
+            AVS_LIST_ADVANCE(&old);
+            continue;
+        }
+        void *data = NULL;
+        size_t size = 0;
+        if (avs_is_err((err = serialize_object(object, &data, &size)))) {
+            break;
+        }
+        AVS_LIST(as_journal_object_t) entry =
+                AVS_LIST_NEW_ELEMENT(as_journal_object_t);
+        if (!entry) {
+            _anjay_log_oom();
+            avs_free(data);
+            err = avs_errno(AVS_ENOMEM);
+            break;
+        }
+        entry->oid = object->oid;
+        entry->size = size;
+        entry->digest = journal_digest(data, size);
+        AVS_LIST_INSERT(baseline_tail, entry);
+        AVS_LIST_ADVANCE_PTR(&baseline_tail);
+
+        bool changed = true;
+        if (old && old->oid == object->oid) {
+            changed = (old->size != entry->size
+                       || old->digest != entry->digest);
+            AVS_LIST_ADVANCE(&old);
+        }
+        if (batch && changed) {
+            err = append_journal_record(&batch_ctx, batch, object->oid, data,
+                                        size);
+            ++*out_records;
+        }
+        avs_free(data);
+        AVS_LIST_ADVANCE(&object);
+    }
+    if (avs_is_err(err)) {
+        AVS_LIST_CLEAR(out_baseline);
+    }
+    return err;
+}
+
+static void set_journal_baseline(anjay_attr_storage_t *as,
+                                 AVS_LIST(as_journal_object_t) baseline) {
+    AVS_LIST_CLEAR(&as->journal_baseline);
+    as->journal_baseline = baseline;
+    as->journal_baseline_valid = true;
+}
+
+static void reset_journal_baseline(anjay_attr_storage_t *as) {
+    uint32_t records;
+    AVS_LIST(as_journal_object_t) baseline = NULL;
+    if (avs_is_ok(build_journal_batch(as, NULL, &records, &baseline))) {
+        set_journal_baseline(as, baseline);
+    } else {
+        as_log(WARNING, _("could not determine journal baseline, journal "
+                          "will not be written until the next full persist"));
+        AVS_LIST_CLEAR(&as->journal_baseline);
+        as->journal_baseline_valid = false;
+    }
+}
+
+static avs_error_t persist_journal_inner(anjay_attr_storage_t *as,
+                                         avs_stream_t *out,
+                                         uint32_t *out_records) {
+    if (!as->journal_baseline_valid) {
+        as_log(ERROR, _("journal baseline unknown, full persist required"));
+        return avs_errno(AVS_EINVAL);
+    }
+    avs_stream_t *batch = avs_stream_membuf_create();
+    if (!batch) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    AVS_LIST(as_journal_object_t) baseline = NULL;
+    void *data = NULL;
+    size_t size = 0;
+    avs_error_t err;
+    if (avs_is_ok((err = build_journal_batch(as, batch, out_records,
+                                             &baseline)))
+            && *out_records
+            && avs_is_ok((err = avs_stream_membuf_take_ownership(batch, &data,
+                                                                 &size)))) {
+        avs_persistence_context_t ctx =
+                avs_persistence_store_context_create(out);
+        as_persistence_version_t version = AS_PERSISTENCE_VERSION_CURRENT;
+        (void) (avs_is_err((err = avs_persistence_magic_string(&ctx,
+                                                               JOURNAL_MAGIC)))
+                || avs_is_err((err = avs_persistence_version(
+                                       &ctx, (uint8_t *) &version,
+                                       SUPPORTED_VERSIONS_ARRAY,
+                                       sizeof(SUPPORTED_VERSIONS_ARRAY))))
+                || avs_is_err((err = avs_persistence_u32(&ctx, out_records)))
+                || avs_is_err((err = avs_stream_write(out, data, size))));
+        avs_free(data);
+    }
+    avs_stream_cleanup(&batch);
+    if (avs_is_ok(err)) {
+        set_journal_baseline(as, baseline);
+    } else {
+        AVS_LIST_CLEAR(&baseline);
+    }
+    return err;
+}
+
+static avs_error_t restore_journal_record(anjay_attr_storage_t *as,
+                                          avs_persistence_context_t *ctx,
+                                          as_persistence_version_t version) {
+    bool present;
+    avs_error_t err = avs_persistence_bool(ctx, &present);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    AVS_LIST(as_object_entry_t) object = NULL;
+    anjay_oid_t oid;
+    if (present) {
+        if (!(object = AVS_LIST_NEW_ELEMENT(as_object_entry_t))) {
+            _anjay_log_oom();
+            return avs_errno(AVS_ENOMEM);
+        }
+        if (avs_is_err((err = handle_object(ctx, object,
+                                            (void *) (intptr_t) version)))) {
+            remove_object_entry(as, &object);
+            return err;
+        }
+        oid = object->oid;
+    } else if (avs_is_err((err = avs_persistence_u16(ctx, &oid)))) {
+        return err;
+    }
+
+    AVS_LIST(as_object_entry_t) *object_ptr;
+    AVS_LIST_FOREACH_PTR(object_ptr, &as->objects) {
+        if ((*object_ptr)->oid >= oid) {
+            break;
+        }
+    }
+    if (*object_ptr && (*object_ptr)->oid == oid) {
+        remove_object_entry(as, object_ptr);
+    }
+    if (object) {
+        AVS_LIST_INSERT(object_ptr, object);
+    }
+    _anjay_attr_storage_mark_modified(as);
+    return AVS_OK;
+}
+
+static avs_error_t restore_journal_batch(anjay_attr_storage_t *as,
+                                         avs_persistence_context_t *ctx,
+                                         size_t *inout_records) {
+    as_persistence_version_t version = (as_persistence_version_t) 0;
+    uint32_t records = 0;
+    avs_error_t err;
+    (void) (avs_is_err(
+                    (err = avs_persistence_magic_string(ctx, JOURNAL_MAGIC)))
+            || avs_is_err((err = avs_persistence_version(
+                                   ctx, (uint8_t *) &version,
+                                   SUPPORTED_VERSIONS_ARRAY,
+                                   sizeof(SUPPORTED_VERSIONS_ARRAY))))
+            || avs_is_err((err = avs_persistence_u32(ctx, &records))));
+    for (uint32_t i = 0; avs_is_ok(err) && i < records; ++i) {
+        err = restore_journal_record(as, ctx, version);
+    }
+    if (avs_is_ok(err)) {
+        *inout_records += records;
+    } else if (avs_is_eof(err)) {
+        // end of stream in the middle of a batch
+        err = avs_errno(AVS_EBADMSG);
+    }
+    return err;
+}
+
+static avs_error_t restore_journal_inner(anjay_unlocked_t *anjay,
+                                         avs_stream_t *in,
+                                         size_t *inout_records) {
+    avs_persistence_context_t ctx = avs_persistence_restore_context_create(in);
+    avs_error_t err;
+    char peeked;
+    while (avs_is_ok((err = avs_stream_peek(in, 0, &peeked)))) {
+        if (avs_is_err((err = restore_journal_batch(
+                                &anjay->attr_storage, &ctx, inout_records)))) {
+            return err;
+        }
+    }
+    if (!avs_is_eof(err)) {
+        return err;
+    }
+    if (!is_attr_storage_sane(&anjay->attr_storage)) {
+        return avs_errno(AVS_EBADMSG);
+    }
+    return clear_nonexistent_entries(anjay, &anjay->attr_storage);
+}
+
 //// PUBLIC FUNCTIONS //////////////////////////////////////////////////////////
 
 avs_error_t
@@ -417,6 +693,8 @@ avs_error_t anjay_attr_storage_persist(anjay_t *anjay_locked,
     if (avs_is_ok((err = _anjay_attr_storage_persist_inner(&anjay->attr_storage,
                                                            out)))) {
         anjay->attr_storage.modified_since_persist = false;
+        anjay->attr_storage.journal_records = 0;
+        reset_journal_baseline(&anjay->attr_storage);
         as_log(INFO, _("Attribute Storage state persisted"));
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
@@ -428,11 +706,64 @@ avs_error_t anjay_attr_storage_restore(anjay_t *anjay_locked,
     avs_error_t err = avs_errno(AVS_EINVAL);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     if (avs_is_ok((err = _anjay_attr_storage_transaction_begin(anjay)))) {
-        if (avs_is_ok((err = _anjay_attr_storage_restore_inner(anjay, in)))) {
+        ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_ATTR_STORAGE);
+        err = _anjay_attr_storage_restore_inner(anjay, in);
+        ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+        if (avs_is_ok(err)) {
             _anjay_attr_storage_transaction_commit(anjay);
             anjay->attr_storage.modified_since_persist = false;
+            anjay->attr_storage.journal_records = 0;
+            reset_journal_baseline(&anjay->attr_storage);
+            _anjay_dm_cache_invalidate_all_discover(anjay);
 
             as_log(INFO, _("Attribute Storage state restored"));
+#    ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+            anjay->startup_timestamps.last_state_restored =
+                    avs_time_monotonic_now();
+#    endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+        } else {
+            avs_error_t rollback_err =
+                    _anjay_attr_storage_transaction_rollback(anjay);
+            if (avs_is_err(rollback_err)) {
+                err = rollback_err;
+            }
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+avs_error_t anjay_attr_storage_persist_journal(anjay_t *anjay_locked,
+                                               avs_stream_t *out) {
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    uint32_t records = 0;
+    if (avs_is_ok((err = persist_journal_inner(&anjay->attr_storage, out,
+                                               &records)))) {
+        anjay->attr_storage.modified_since_persist = false;
+        anjay->attr_storage.journal_records += records;
+        as_log(INFO, _("Attribute Storage journal persisted, ") "%" PRIu32
+                             _(" records"),
+               records);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+avs_error_t anjay_attr_storage_restore_journal(anjay_t *anjay_locked,
+                                               avs_stream_t *in) {
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    size_t records = 0;
+    if (avs_is_ok((err = _anjay_attr_storage_transaction_begin(anjay)))) {
+        if (avs_is_ok((err = restore_journal_inner(anjay, in, &records)))) {
+            _anjay_attr_storage_transaction_commit(anjay);
+            anjay->attr_storage.modified_since_persist = false;
+            anjay->attr_storage.journal_records += records;
+            reset_journal_baseline(&anjay->attr_storage);
+            _anjay_dm_cache_invalidate_all_discover(anjay);
+
+            as_log(INFO, _("Attribute Storage journal restored"));
         } else {
             avs_error_t rollback_err =
                     _anjay_attr_storage_transaction_rollback(anjay);
@@ -445,6 +776,14 @@ avs_error_t anjay_attr_storage_restore(anjay_t *anjay_locked,
     return err;
 }
 
+size_t anjay_attr_storage_journal_records(anjay_t *anjay_locked) {
+    size_t result = 0;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    result = anjay->attr_storage.journal_records;
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
 #    ifdef ANJAY_TEST
 #        include "tests/core/attr_storage/persistence.c"
 #    endif // ANJAY_TEST
@@ -55,6 +55,22 @@ struct as_object_entry {
     AVS_LIST(as_instance_entry_t) instances;
 };
 
+struct as_index_entry {
+    uint64_t key;
+    /**
+     * Conceptually of type as_instance_entry_t * or as_resource_entry_t *,
+     * depending on the key.
+     */
+    void *entry;
+};
+
+struct as_journal_object {
+    anjay_oid_t oid;
+    // size and digest of the Object entry serialized in the persistence format
+    size_t size;
+    uint64_t digest;
+};
+
 void _anjay_attr_storage_clear(anjay_attr_storage_t *as);
 
 /**
@@ -88,8 +104,14 @@ int _anjay_attr_storage_remove_absent_resource_instances(
         AVS_LIST(as_resource_entry_t) *resource_ptr);
 #endif // ANJAY_WITH_LWM2M11
 
+static inline void
+_anjay_attr_storage_invalidate_index(anjay_attr_storage_t *as) {
+    as->index_valid = false;
+}
+
 static inline void _anjay_attr_storage_mark_modified(anjay_attr_storage_t *as) {
     as->modified_since_persist = true;
+    _anjay_attr_storage_invalidate_index(as);
 }
 
 #ifdef ANJAY_WITH_LWM2M11
@@ -134,9 +156,11 @@ static void remove_object_entry(anjay_attr_storage_t *as,
     _anjay_attr_storage_mark_modified(as);
 }
 
-static void remove_object_if_empty(AVS_LIST(as_object_entry_t) *entry_ptr) {
+static void remove_object_if_empty(anjay_attr_storage_t *as,
+                                   AVS_LIST(as_object_entry_t) *entry_ptr) {
     if (!(*entry_ptr)->default_attrs && !(*entry_ptr)->instances) {
         AVS_LIST_DELETE(entry_ptr);
+        _anjay_attr_storage_invalidate_index(as);
     }
 }
 
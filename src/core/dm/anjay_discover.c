@@ -12,6 +12,10 @@
 #ifdef ANJAY_WITH_DISCOVER
 
 #    include <inttypes.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream_membuf.h>
 
 #    include <anjay_modules/anjay_time_defs.h>
 
@@ -54,8 +58,9 @@ print_double_attr(avs_stream_t *stream, const char *name, double value) {
     if (isnan(value)) {
         return 0;
     }
-    return avs_is_ok(avs_stream_write_f(stream, ";%s=%s", name,
-                                        AVS_DOUBLE_AS_STRING(value, 17)))
+    return avs_is_ok(avs_stream_write_f(
+                   stream, ";%s=%s", name,
+                   ANJAY_DOUBLE_AS_SHORTEST_STRING(value)))
                    ? 0
                    : -1;
 }
@@ -423,37 +428,20 @@ static int discover_object(anjay_unlocked_t *anjay,
     return result;
 }
 
-int _anjay_discover(anjay_unlocked_t *anjay,
-                    avs_stream_t *stream,
-                    const anjay_dm_installed_object_t *obj,
-                    anjay_iid_t iid,
-                    anjay_rid_t rid,
-                    uint8_t depth,
-                    anjay_ssid_t ssid,
-                    anjay_lwm2m_version_t lwm2m_version) {
-    assert(obj);
-
+static int discover_uncached(anjay_unlocked_t *anjay,
+                             avs_stream_t *stream,
+                             const anjay_dm_installed_object_t *obj,
+                             anjay_iid_t iid,
+                             anjay_rid_t rid,
+                             uint8_t depth,
+                             anjay_ssid_t ssid,
+                             anjay_lwm2m_version_t lwm2m_version) {
     if (iid == ANJAY_ID_INVALID) {
         return discover_object(
                 anjay, stream, obj, ssid, lwm2m_version, ANJAY_ID_OID,
                 (anjay_id_type_t) AVS_MIN(ANJAY_ID_OID + depth, ANJAY_ID_RIID));
     }
 
-    int result = _anjay_dm_verify_instance_present(anjay, obj, iid);
-    if (result) {
-        return result;
-    }
-
-    const anjay_action_info_t info = {
-        .oid = _anjay_dm_installed_object_oid(obj),
-        .iid = iid,
-        .ssid = ssid,
-        .action = ANJAY_ACTION_DISCOVER
-    };
-    if (!_anjay_instance_action_allowed(anjay, &info)) {
-        return ANJAY_ERR_UNAUTHORIZED;
-    }
-
     if (rid == ANJAY_ID_INVALID) {
         return discover_instance(
                 anjay, stream, obj, iid, ssid, lwm2m_version, ANJAY_ID_IID,
@@ -461,8 +449,9 @@ int _anjay_discover(anjay_unlocked_t *anjay,
     }
 
     anjay_dm_resource_kind_t kind;
-    if ((result = _anjay_dm_verify_resource_present(anjay, obj, iid, rid,
-                                                    &kind))) {
+    int result =
+            _anjay_dm_verify_resource_present(anjay, obj, iid, rid, &kind);
+    if (result) {
         return result;
     }
 
@@ -472,6 +461,100 @@ int _anjay_discover(anjay_unlocked_t *anjay,
                                                        ANJAY_ID_RIID));
 }
 
+static int discover_and_cache(anjay_unlocked_t *anjay,
+                              avs_stream_t *stream,
+                              const anjay_dm_installed_object_t *obj,
+                              anjay_dm_discover_cache_t *cache,
+                              anjay_iid_t iid,
+                              anjay_rid_t rid,
+                              uint8_t depth,
+                              anjay_ssid_t ssid,
+                              anjay_lwm2m_version_t lwm2m_version) {
+    const anjay_oid_t oid = _anjay_dm_installed_object_oid(obj);
+    const uint32_t generation = cache->generation;
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    if (!membuf) {
+        _anjay_log_oom();
+        return -1;
+    }
+    anjay_dm_cached_discover_t entry = {
+        .iid = iid,
+        .rid = rid,
+        .ssid = ssid,
+        .depth = depth,
+        .lwm2m_version = lwm2m_version
+    };
+    int result = discover_uncached(anjay, membuf, obj, iid, rid, depth, ssid,
+                                   lwm2m_version);
+    if (!result
+            && avs_is_err(avs_stream_membuf_take_ownership(
+                       membuf, &entry.payload, &entry.payload_size))) {
+        result = -1;
+    }
+    avs_stream_cleanup(&membuf);
+    if (!result
+            && avs_is_err(avs_stream_write(stream, entry.payload,
+                                           entry.payload_size))) {
+        result = -1;
+    }
+    if (result) {
+        avs_free(entry.payload);
+    } else {
+        // cache pointer is not reused, as the data model handlers might have
+        // changed the set of cached Objects
+        _anjay_dm_discover_cache_store(anjay, oid, generation, &entry);
+    }
+    return result;
+}
+
+int _anjay_discover(anjay_unlocked_t *anjay,
+                    avs_stream_t *stream,
+                    const anjay_dm_installed_object_t *obj,
+                    anjay_iid_t iid,
+                    anjay_rid_t rid,
+                    uint8_t depth,
+                    anjay_ssid_t ssid,
+                    anjay_lwm2m_version_t lwm2m_version) {
+    assert(obj);
+
+    if (iid != ANJAY_ID_INVALID) {
+        int result = _anjay_dm_verify_instance_present(anjay, obj, iid);
+        if (result) {
+            return result;
+        }
+
+        const anjay_action_info_t info = {
+            .oid = _anjay_dm_installed_object_oid(obj),
+            .iid = iid,
+            .ssid = ssid,
+            .action = ANJAY_ACTION_DISCOVER
+        };
+        if (!_anjay_instance_action_allowed(anjay, &info)) {
+            return ANJAY_ERR_UNAUTHORIZED;
+        }
+    }
+
+    anjay_dm_discover_cache_t *cache =
+            _anjay_dm_discover_cache_find(anjay,
+                                          _anjay_dm_installed_object_oid(obj));
+    if (!cache) {
+        return discover_uncached(anjay, stream, obj, iid, rid, depth, ssid,
+                                 lwm2m_version);
+    }
+
+    const anjay_dm_cached_discover_t *cached =
+            _anjay_dm_discover_cache_get(cache, iid, rid, ssid, depth,
+                                         lwm2m_version);
+    if (cached) {
+        return avs_is_ok(avs_stream_write(stream, cached->payload,
+                                          cached->payload_size))
+                       ? 0
+                       : -1;
+    }
+    return discover_and_cache(anjay, stream, obj, cache, iid, rid, depth, ssid,
+                              lwm2m_version);
+}
+
 #    ifdef ANJAY_WITH_BOOTSTRAP
 static int print_ssid_attr(avs_stream_t *stream, uint16_t ssid) {
     return avs_is_ok(avs_stream_write_f(stream, ";" ANJAY_ATTR_SSID "=%" PRIu16,
@@ -589,17 +672,11 @@ static int bootstrap_discover_object(anjay_unlocked_t *anjay,
     return result;
 }
 
-int _anjay_bootstrap_discover(anjay_unlocked_t *anjay,
-                              avs_stream_t *stream,
-                              anjay_oid_t oid,
-                              anjay_lwm2m_version_t lwm2m_version) {
-    const anjay_dm_installed_object_t *obj = NULL;
-    if (oid != ANJAY_ID_INVALID) {
-        obj = _anjay_dm_find_object_by_oid(anjay, oid);
-        if (!obj) {
-            return ANJAY_ERR_NOT_FOUND;
-        }
-    }
+static int
+bootstrap_discover_uncached(anjay_unlocked_t *anjay,
+                            avs_stream_t *stream,
+                            const anjay_dm_installed_object_t *obj,
+                            anjay_lwm2m_version_t lwm2m_version) {
     int result = print_enabler_version(stream, lwm2m_version);
     if (result) {
         return result;
@@ -615,6 +692,77 @@ int _anjay_bootstrap_discover(anjay_unlocked_t *anjay,
                                         &args);
     }
 }
+
+static int bootstrap_discover_and_cache(anjay_unlocked_t *anjay,
+                                        avs_stream_t *stream,
+                                        const anjay_dm_installed_object_t *obj,
+                                        anjay_oid_t oid,
+                                        anjay_lwm2m_version_t lwm2m_version) {
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    if (!membuf) {
+        _anjay_log_oom();
+        return -1;
+    }
+    void *payload = NULL;
+    size_t payload_size = 0;
+    int result = bootstrap_discover_uncached(anjay, membuf, obj, lwm2m_version);
+    if (!result
+            && avs_is_err(avs_stream_membuf_take_ownership(membuf, &payload,
+                                                           &payload_size))) {
+        result = -1;
+    }
+    avs_stream_cleanup(&membuf);
+    if (!result
+            && avs_is_err(avs_stream_write(stream, payload, payload_size))) {
+        result = -1;
+    }
+    AVS_LIST(anjay_bootstrap_discover_cached_t) entry = NULL;
+    // failing to cache the response is not an error, it will be rendered
+    // again next time
+    if (!result
+            && (entry = (AVS_LIST(anjay_bootstrap_discover_cached_t))
+                        AVS_LIST_NEW_BUFFER(
+                                sizeof(anjay_bootstrap_discover_cached_t)
+                                + payload_size))) {
+        entry->oid = oid;
+        entry->lwm2m_version = lwm2m_version;
+        entry->payload_size = payload_size;
+        if (payload_size) {
+            memcpy(entry->payload, payload, payload_size);
+        }
+        AVS_LIST_INSERT(&anjay->bootstrap.discover_cache, entry);
+    }
+    avs_free(payload);
+    return result;
+}
+
+int _anjay_bootstrap_discover(anjay_unlocked_t *anjay,
+                              avs_stream_t *stream,
+                              anjay_oid_t oid,
+                              anjay_lwm2m_version_t lwm2m_version) {
+    const anjay_dm_installed_object_t *obj = NULL;
+    if (oid != ANJAY_ID_INVALID) {
+        obj = _anjay_dm_find_object_by_oid(anjay, oid);
+        if (!obj) {
+            return ANJAY_ERR_NOT_FOUND;
+        }
+    }
+    if (!anjay->bootstrap.in_progress) {
+        // nothing would invalidate the cache outside of a Bootstrap session
+        return bootstrap_discover_uncached(anjay, stream, obj, lwm2m_version);
+    }
+    AVS_LIST(anjay_bootstrap_discover_cached_t) cached;
+    AVS_LIST_FOREACH(cached, anjay->bootstrap.discover_cache) {
+        if (cached->oid == oid && cached->lwm2m_version == lwm2m_version) {
+            return avs_is_ok(avs_stream_write(stream, cached->payload,
+                                              cached->payload_size))
+                           ? 0
+                           : -1;
+        }
+    }
+    return bootstrap_discover_and_cache(anjay, stream, obj, oid,
+                                        lwm2m_version);
+}
 #    endif
 
 #endif // ANJAY_WITH_DISCOVER
@@ -16,6 +16,7 @@
 #include "../anjay_utils_private.h"
 
 #include "anjay_dm_attributes.h"
+#include "anjay_dm_cache.h"
 #include "anjay_query.h"
 
 VISIBILITY_SOURCE_BEGIN
@@ -89,10 +90,8 @@ int _anjay_read_period(anjay_unlocked_t *anjay,
                        anjay_rid_t rid,
                        int32_t *out) {
     int64_t value;
-    const anjay_uri_path_t path =
-            MAKE_RESOURCE_PATH(ANJAY_DM_OID_SERVER, server_iid, rid);
-
-    int result = _anjay_dm_read_resource_i64(anjay, &path, &value);
+    int result = _anjay_dm_cached_read_server_resource_i64(anjay, server_iid,
+                                                           rid, &value);
     if (result == ANJAY_ERR_METHOD_NOT_ALLOWED
             || result == ANJAY_ERR_NOT_FOUND) {
         *out = ANJAY_ATTRIB_INTEGER_NONE;
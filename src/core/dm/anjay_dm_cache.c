@@ -0,0 +1,823 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_memory.h>
+
+#include "../anjay_core.h"
+#include "../anjay_dm_core.h"
+#include "../io/anjay_batch_builder.h"
+#include "../observe/anjay_observe_core.h"
+
+#include "anjay_dm_cache.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+static AVS_LIST(anjay_dm_object_cache_t) *
+find_cache_ptr(anjay_unlocked_t *anjay, anjay_oid_t oid) {
+    AVS_LIST(anjay_dm_object_cache_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &anjay->dm.caches) {
+        if ((*it)->oid >= oid) {
+            break;
+        }
+    }
+    return it;
+}
+
+anjay_dm_object_cache_t *_anjay_dm_cache_find(anjay_unlocked_t *anjay,
+                                              anjay_oid_t oid) {
+    AVS_LIST(anjay_dm_object_cache_t) *it = find_cache_ptr(anjay, oid);
+    if (*it && (*it)->oid == oid) {
+        return *it;
+    }
+    return NULL;
+}
+
+static AVS_LIST(anjay_dm_resource_cache_t) *
+find_resource_cache_ptr(anjay_unlocked_t *anjay, anjay_oid_t oid) {
+    AVS_LIST(anjay_dm_resource_cache_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &anjay->dm.resource_caches) {
+        if ((*it)->oid >= oid) {
+            break;
+        }
+    }
+    return it;
+}
+
+anjay_dm_resource_cache_t *
+_anjay_dm_resource_cache_find(anjay_unlocked_t *anjay, anjay_oid_t oid) {
+    AVS_LIST(anjay_dm_resource_cache_t) *it =
+            find_resource_cache_ptr(anjay, oid);
+    if (*it && (*it)->oid == oid) {
+        return *it;
+    }
+    return NULL;
+}
+
+static AVS_LIST(anjay_dm_discover_cache_t) *
+find_discover_cache_ptr(anjay_unlocked_t *anjay, anjay_oid_t oid) {
+    AVS_LIST(anjay_dm_discover_cache_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &anjay->dm.discover_caches) {
+        if ((*it)->oid >= oid) {
+            break;
+        }
+    }
+    return it;
+}
+
+anjay_dm_discover_cache_t *
+_anjay_dm_discover_cache_find(anjay_unlocked_t *anjay, anjay_oid_t oid) {
+    AVS_LIST(anjay_dm_discover_cache_t) *it =
+            find_discover_cache_ptr(anjay, oid);
+    if (*it && (*it)->oid == oid) {
+        return *it;
+    }
+    return NULL;
+}
+
+static AVS_LIST(anjay_dm_read_cache_t) *
+find_read_cache_ptr(anjay_unlocked_t *anjay, anjay_oid_t oid) {
+    AVS_LIST(anjay_dm_read_cache_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &anjay->dm.read_caches) {
+        if ((*it)->oid >= oid) {
+            break;
+        }
+    }
+    return it;
+}
+
+anjay_dm_read_cache_t *_anjay_dm_read_cache_find(anjay_unlocked_t *anjay,
+                                                 anjay_oid_t oid) {
+    AVS_LIST(anjay_dm_read_cache_t) *it = find_read_cache_ptr(anjay, oid);
+    if (*it && (*it)->oid == oid) {
+        return *it;
+    }
+    return NULL;
+}
+
+#if defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+static AVS_LIST(anjay_dm_value_cache_t) *
+find_value_cache_ptr(anjay_unlocked_t *anjay,
+                     anjay_oid_t oid,
+                     anjay_rid_t rid) {
+    AVS_LIST(anjay_dm_value_cache_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &anjay->dm.value_caches) {
+        if ((*it)->oid > oid || ((*it)->oid == oid && (*it)->rid >= rid)) {
+            break;
+        }
+    }
+    return it;
+}
+
+anjay_dm_value_cache_t *_anjay_dm_value_cache_find(anjay_unlocked_t *anjay,
+                                                   anjay_oid_t oid,
+                                                   anjay_rid_t rid) {
+    AVS_LIST(anjay_dm_value_cache_t) *it =
+            find_value_cache_ptr(anjay, oid, rid);
+    if (*it && (*it)->oid == oid && (*it)->rid == rid) {
+        return *it;
+    }
+    return NULL;
+}
+
+static void clear_value_cache_entry(anjay_dm_value_cache_t *cache) {
+    AVS_LIST_CLEAR(&cache->entries) {
+        _anjay_batch_release(&cache->entries->batch);
+    }
+}
+
+void _anjay_dm_cache_invalidate_values(anjay_unlocked_t *anjay,
+                                       anjay_oid_t oid,
+                                       anjay_iid_t iid,
+                                       anjay_rid_t rid) {
+    AVS_LIST(anjay_dm_value_cache_t) it;
+    AVS_LIST_FOREACH(it, anjay->dm.value_caches) {
+        if (it->oid > oid) {
+            break;
+        }
+        if (it->oid < oid || (rid != ANJAY_ID_INVALID && it->rid != rid)) {
+            continue;
+        }
+        ++it->generation;
+        if (iid == ANJAY_ID_INVALID) {
+            clear_value_cache_entry(it);
+            continue;
+        }
+        AVS_LIST(anjay_dm_cached_value_t) *entry_ptr;
+        AVS_LIST_FOREACH_PTR(entry_ptr, &it->entries) {
+            if ((*entry_ptr)->iid == iid) {
+                _anjay_batch_release(&(*entry_ptr)->batch);
+                AVS_LIST_DELETE(entry_ptr);
+                break;
+            }
+        }
+    }
+}
+
+const anjay_batch_t *
+_anjay_dm_value_cache_get(const anjay_dm_value_cache_t *cache,
+                          anjay_iid_t iid) {
+    AVS_LIST(const anjay_dm_cached_value_t) it;
+    AVS_LIST_FOREACH(it, cache->entries) {
+        if (it->iid == iid) {
+            return it->batch;
+        }
+    }
+    return NULL;
+}
+
+void _anjay_dm_value_cache_store(anjay_unlocked_t *anjay,
+                                 anjay_oid_t oid,
+                                 anjay_iid_t iid,
+                                 anjay_rid_t rid,
+                                 uint32_t generation,
+                                 const anjay_batch_t *batch) {
+    // the cache is looked up again, as it might have been disabled while the
+    // value was being read
+    anjay_dm_value_cache_t *cache = _anjay_dm_value_cache_find(anjay, oid, rid);
+    AVS_LIST(anjay_dm_cached_value_t) entry = NULL;
+    if (!cache || cache->generation != generation
+            || _anjay_dm_value_cache_get(cache, iid)
+            || !(entry = AVS_LIST_NEW_ELEMENT(anjay_dm_cached_value_t))) {
+        return;
+    }
+    entry->iid = iid;
+    entry->batch = _anjay_batch_acquire(batch);
+    AVS_LIST_INSERT(&cache->entries, entry);
+}
+#endif // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+
+static void clear_discover_cache_entry(anjay_dm_discover_cache_t *cache) {
+    AVS_LIST_CLEAR(&cache->entries) {
+        avs_free(cache->entries->payload);
+    }
+}
+
+void _anjay_dm_cache_invalidate_discover(anjay_unlocked_t *anjay,
+                                         anjay_oid_t oid) {
+    anjay_dm_discover_cache_t *cache =
+            _anjay_dm_discover_cache_find(anjay, oid);
+    if (cache) {
+        ++cache->generation;
+        clear_discover_cache_entry(cache);
+    }
+    _anjay_observe_invalidate_attrs(anjay, oid);
+}
+
+void _anjay_dm_cache_invalidate_all_discover(anjay_unlocked_t *anjay) {
+    AVS_LIST(anjay_dm_discover_cache_t) it;
+    AVS_LIST_FOREACH(it, anjay->dm.discover_caches) {
+        ++it->generation;
+        clear_discover_cache_entry(it);
+    }
+    _anjay_observe_invalidate_attrs(anjay, ANJAY_ID_INVALID);
+}
+
+static void clear_read_cache_entry(anjay_dm_read_cache_t *cache) {
+    AVS_LIST_CLEAR(&cache->entries) {
+        avs_free(cache->entries->payload);
+    }
+}
+
+void _anjay_dm_cache_invalidate_read(anjay_unlocked_t *anjay,
+                                     anjay_oid_t oid) {
+    anjay_dm_read_cache_t *cache = _anjay_dm_read_cache_find(anjay, oid);
+    if (cache) {
+        ++cache->generation;
+        clear_read_cache_entry(cache);
+    }
+}
+
+void _anjay_dm_cache_invalidate_all_read(anjay_unlocked_t *anjay) {
+    AVS_LIST(anjay_dm_read_cache_t) it;
+    AVS_LIST_FOREACH(it, anjay->dm.read_caches) {
+        ++it->generation;
+        clear_read_cache_entry(it);
+    }
+}
+
+void _anjay_dm_cache_invalidate_resources(anjay_unlocked_t *anjay,
+                                          anjay_oid_t oid) {
+    anjay_dm_resource_cache_t *cache =
+            _anjay_dm_resource_cache_find(anjay, oid);
+    if (cache) {
+        ++cache->generation;
+    }
+    if (oid == ANJAY_DM_OID_ACCESS_CONTROL) {
+        _anjay_dm_cache_invalidate_acl(anjay);
+    } else if (oid == ANJAY_DM_OID_SERVER) {
+        _anjay_dm_cache_invalidate_server_params(anjay);
+    } else if (oid == ANJAY_DM_OID_SECURITY) {
+        _anjay_dm_cache_invalidate_security_ids(anjay);
+    }
+    _anjay_dm_cache_invalidate_discover(anjay, oid);
+    _anjay_dm_cache_invalidate_read(anjay, oid);
+    _anjay_observe_drop_samples(anjay, oid);
+}
+
+void _anjay_dm_cache_invalidate_instances(anjay_unlocked_t *anjay,
+                                          anjay_oid_t oid) {
+    anjay_dm_object_cache_t *cache = _anjay_dm_cache_find(anjay, oid);
+    if (cache) {
+        ++cache->generation;
+    }
+    _anjay_dm_cache_invalidate_resources(anjay, oid);
+    _anjay_dm_cache_invalidate_values(anjay, oid, ANJAY_ID_INVALID,
+                                      ANJAY_ID_INVALID);
+    _anjay_dm_cache_invalidate_object_links(anjay);
+}
+
+anjay_iid_t
+_anjay_dm_cache_first_free_iid(const anjay_dm_object_cache_t *cache) {
+    assert(_anjay_dm_object_cache_valid(cache));
+    // the list is sorted and free of duplicates, so instances[i] >= i, with
+    // equality holding exactly for the leading run of consecutive IDs
+    size_t lower = 0;
+    size_t upper = cache->instance_count;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (cache->instances[middle] == middle) {
+            lower = middle + 1;
+        } else {
+            upper = middle;
+        }
+    }
+    return lower < ANJAY_ID_INVALID ? (anjay_iid_t) lower : ANJAY_ID_INVALID;
+}
+
+void _anjay_dm_cache_instance_created(anjay_unlocked_t *anjay,
+                                      anjay_oid_t oid,
+                                      anjay_iid_t iid) {
+    anjay_dm_object_cache_t *cache = _anjay_dm_cache_find(anjay, oid);
+    if (cache && cache->free_iid_hint == iid) {
+        cache->free_iid_hint = (anjay_iid_t) (iid + 1);
+    }
+}
+
+void _anjay_dm_cache_instance_removed(anjay_unlocked_t *anjay,
+                                      anjay_oid_t oid,
+                                      anjay_iid_t iid) {
+    anjay_dm_object_cache_t *cache = _anjay_dm_cache_find(anjay, oid);
+    if (cache && iid < cache->free_iid_hint) {
+        cache->free_iid_hint = iid;
+    }
+}
+
+void _anjay_dm_cache_reset_free_iid_hint(anjay_unlocked_t *anjay,
+                                         anjay_oid_t oid) {
+    anjay_dm_object_cache_t *cache = _anjay_dm_cache_find(anjay, oid);
+    if (cache) {
+        cache->free_iid_hint = 0;
+    }
+}
+
+static void clear_cache_entry(anjay_dm_object_cache_t *cache) {
+    assert(!cache->iteration_depth);
+    avs_free(cache->instances);
+    cache->instances = NULL;
+    cache->instance_count = 0;
+}
+
+static void clear_resource_cache_entry(anjay_dm_resource_cache_t *cache) {
+    assert(!cache->iteration_depth);
+    avs_free(cache->resources);
+    cache->resources = NULL;
+    cache->resource_count = 0;
+}
+
+void _anjay_dm_cache_remove(anjay_unlocked_t *anjay, anjay_oid_t oid) {
+    AVS_LIST(anjay_dm_object_cache_t) *it = find_cache_ptr(anjay, oid);
+    if (*it && (*it)->oid == oid) {
+        clear_cache_entry(*it);
+        AVS_LIST_DELETE(it);
+    }
+    AVS_LIST(anjay_dm_resource_cache_t) *res_it =
+            find_resource_cache_ptr(anjay, oid);
+    if (*res_it && (*res_it)->oid == oid) {
+        clear_resource_cache_entry(*res_it);
+        AVS_LIST_DELETE(res_it);
+    }
+    AVS_LIST(anjay_dm_discover_cache_t) *discover_it =
+            find_discover_cache_ptr(anjay, oid);
+    if (*discover_it && (*discover_it)->oid == oid) {
+        clear_discover_cache_entry(*discover_it);
+        AVS_LIST_DELETE(discover_it);
+    }
+    AVS_LIST(anjay_dm_read_cache_t) *read_it = find_read_cache_ptr(anjay, oid);
+    if (*read_it && (*read_it)->oid == oid) {
+        clear_read_cache_entry(*read_it);
+        AVS_LIST_DELETE(read_it);
+    }
+#if defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+    AVS_LIST(anjay_dm_value_cache_t) *value_it =
+            find_value_cache_ptr(anjay, oid, 0);
+    while (*value_it && (*value_it)->oid == oid) {
+        clear_value_cache_entry(*value_it);
+        AVS_LIST_DELETE(value_it);
+    }
+#endif // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+    if (oid == ANJAY_DM_OID_ACCESS_CONTROL) {
+        _anjay_dm_cache_invalidate_acl(anjay);
+    } else if (oid == ANJAY_DM_OID_SERVER) {
+        _anjay_dm_cache_invalidate_server_params(anjay);
+    } else if (oid == ANJAY_DM_OID_SECURITY) {
+        _anjay_dm_cache_invalidate_security_ids(anjay);
+    }
+}
+
+void _anjay_dm_cache_cleanup(anjay_unlocked_t *anjay) {
+    AVS_LIST_CLEAR(&anjay->dm.caches) {
+        clear_cache_entry(anjay->dm.caches);
+    }
+    AVS_LIST_CLEAR(&anjay->dm.resource_caches) {
+        clear_resource_cache_entry(anjay->dm.resource_caches);
+    }
+    AVS_LIST_CLEAR(&anjay->dm.discover_caches) {
+        clear_discover_cache_entry(anjay->dm.discover_caches);
+    }
+    AVS_LIST_CLEAR(&anjay->dm.read_caches) {
+        clear_read_cache_entry(anjay->dm.read_caches);
+    }
+#if defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+    AVS_LIST_CLEAR(&anjay->dm.value_caches) {
+        clear_value_cache_entry(anjay->dm.value_caches);
+    }
+#endif // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+    _anjay_dm_cache_invalidate_object_links(anjay);
+    _anjay_dm_cache_invalidate_acl(anjay);
+    _anjay_dm_cache_invalidate_server_params(anjay);
+}
+
+void _anjay_dm_cache_store_instances(anjay_dm_object_cache_t *cache,
+                                     uint32_t generation,
+                                     anjay_iid_t *instances,
+                                     size_t instance_count) {
+    assert(!cache->iteration_depth);
+    avs_free(cache->instances);
+    cache->instances = instances;
+    cache->instance_count = instance_count;
+    cache->valid_generation = generation;
+}
+
+void _anjay_dm_cache_store_resources(anjay_dm_resource_cache_t *cache,
+                                     uint32_t generation,
+                                     anjay_iid_t iid,
+                                     anjay_dm_cached_resource_t *resources,
+                                     size_t resource_count) {
+    assert(!cache->iteration_depth);
+    avs_free(cache->resources);
+    cache->iid = iid;
+    cache->resources = resources;
+    cache->resource_count = resource_count;
+    cache->valid_generation = generation;
+}
+
+const char *
+_anjay_dm_cache_get_object_links(anjay_unlocked_t *anjay,
+                                 anjay_dm_object_links_format_t format,
+                                 uint32_t *out_generation) {
+    assert(format < ANJAY_DM_OBJECT_LINKS_FORMATS_COUNT);
+    *out_generation = anjay->dm.object_links.generation;
+    return anjay->dm.object_links.payloads[format];
+}
+
+void _anjay_dm_cache_store_object_links(anjay_unlocked_t *anjay,
+                                        anjay_dm_object_links_format_t format,
+                                        uint32_t generation,
+                                        char *payload) {
+    assert(format < ANJAY_DM_OBJECT_LINKS_FORMATS_COUNT);
+    anjay_dm_object_links_cache_t *cache = &anjay->dm.object_links;
+    if (generation != cache->generation) {
+        // data model changed while the payload was being generated
+        avs_free(payload);
+        return;
+    }
+    avs_free(cache->payloads[format]);
+    cache->payloads[format] = payload;
+}
+
+void _anjay_dm_cache_invalidate_object_links(anjay_unlocked_t *anjay) {
+    anjay_dm_object_links_cache_t *cache = &anjay->dm.object_links;
+    ++cache->generation;
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(cache->payloads); ++i) {
+        avs_free(cache->payloads[i]);
+        cache->payloads[i] = NULL;
+    }
+}
+
+#ifdef ANJAY_WITH_ACCESS_CONTROL
+void _anjay_dm_cache_store_acl(anjay_unlocked_t *anjay,
+                               uint32_t generation,
+                               anjay_dm_cached_acl_entry_t *entries,
+                               size_t entry_count) {
+    anjay_dm_acl_cache_t *cache = &anjay->dm.acl;
+    if (generation != cache->generation) {
+        // Access Control Object changed while the entries were being read
+        avs_free(entries);
+        return;
+    }
+    avs_free(cache->entries);
+    cache->entries = entries;
+    cache->entry_count = entry_count;
+    cache->valid = true;
+}
+
+void _anjay_dm_cache_invalidate_acl(anjay_unlocked_t *anjay) {
+    anjay_dm_acl_cache_t *cache = &anjay->dm.acl;
+    ++cache->generation;
+    cache->valid = false;
+    avs_free(cache->entries);
+    cache->entries = NULL;
+    cache->entry_count = 0;
+    // cached Read responses of any Object may depend on access rights
+    _anjay_dm_cache_invalidate_all_read(anjay);
+}
+#endif // ANJAY_WITH_ACCESS_CONTROL
+
+int _anjay_dm_cached_read_server_resource_i64(anjay_unlocked_t *anjay,
+                                              anjay_iid_t server_iid,
+                                              anjay_rid_t rid,
+                                              int64_t *out_value) {
+    anjay_dm_server_params_cache_t *cache = &anjay->dm.server_params;
+    const anjay_uri_path_t path =
+            MAKE_RESOURCE_PATH(ANJAY_DM_OID_SERVER, server_iid, rid);
+    if (!cache->enabled) {
+        return _anjay_dm_read_resource_i64(anjay, &path, out_value);
+    }
+    AVS_LIST(anjay_dm_cached_server_resource_t) it;
+    AVS_LIST_FOREACH(it, cache->resources) {
+        if (it->iid == server_iid && it->rid == rid) {
+            if (!it->result) {
+                *out_value = it->value;
+            }
+            return it->result;
+        }
+    }
+    const uint32_t generation = cache->generation;
+    int64_t value = 0;
+    int result = _anjay_dm_read_resource_i64(anjay, &path, &value);
+    if (generation == cache->generation) {
+        AVS_LIST(anjay_dm_cached_server_resource_t) entry =
+                AVS_LIST_NEW_ELEMENT(anjay_dm_cached_server_resource_t);
+        if (entry) {
+            entry->iid = server_iid;
+            entry->rid = rid;
+            entry->result = result;
+            entry->value = value;
+            AVS_LIST_INSERT(&cache->resources, entry);
+        }
+    }
+    if (!result) {
+        *out_value = value;
+    }
+    return result;
+}
+
+void _anjay_dm_cache_invalidate_server_params(anjay_unlocked_t *anjay) {
+    anjay_dm_server_params_cache_t *cache = &anjay->dm.server_params;
+    ++cache->generation;
+    cache->server_ids_valid = false;
+    AVS_LIST_CLEAR(&cache->server_ids);
+    cache->security_ids_valid = false;
+    AVS_LIST_CLEAR(&cache->security_ids);
+    AVS_LIST_CLEAR(&cache->resources);
+}
+
+void _anjay_dm_cache_invalidate_security_ids(anjay_unlocked_t *anjay) {
+    anjay_dm_server_params_cache_t *cache = &anjay->dm.server_params;
+    ++cache->generation;
+    cache->security_ids_valid = false;
+    AVS_LIST_CLEAR(&cache->security_ids);
+}
+
+const anjay_dm_cached_discover_t *
+_anjay_dm_discover_cache_get(const anjay_dm_discover_cache_t *cache,
+                             anjay_iid_t iid,
+                             anjay_rid_t rid,
+                             anjay_ssid_t ssid,
+                             uint8_t depth,
+                             anjay_lwm2m_version_t lwm2m_version) {
+    AVS_LIST(const anjay_dm_cached_discover_t) it;
+    AVS_LIST_FOREACH(it, cache->entries) {
+        if (it->iid == iid && it->rid == rid && it->ssid == ssid
+                && it->depth == depth && it->lwm2m_version == lwm2m_version) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+void _anjay_dm_discover_cache_store(anjay_unlocked_t *anjay,
+                                    anjay_oid_t oid,
+                                    uint32_t generation,
+                                    const anjay_dm_cached_discover_t *key) {
+    // the cache is looked up again, as it might have been disabled while the
+    // response was being generated
+    anjay_dm_discover_cache_t *cache =
+            _anjay_dm_discover_cache_find(anjay, oid);
+    AVS_LIST(anjay_dm_cached_discover_t) entry = NULL;
+    if (!cache || cache->generation != generation
+            || !(entry = AVS_LIST_NEW_ELEMENT(anjay_dm_cached_discover_t))) {
+        avs_free(key->payload);
+        return;
+    }
+    *entry = *key;
+    AVS_LIST_INSERT(&cache->entries, entry);
+}
+
+const anjay_dm_cached_read_t *
+_anjay_dm_read_cache_get(anjay_dm_read_cache_t *cache,
+                         const anjay_uri_path_t *path,
+                         uint16_t requested_format,
+                         anjay_ssid_t ssid,
+                         anjay_lwm2m_version_t lwm2m_version) {
+    const avs_time_monotonic_t now = avs_time_monotonic_now();
+    AVS_LIST(anjay_dm_cached_read_t) *it;
+    AVS_LIST(anjay_dm_cached_read_t) helper;
+    AVS_LIST_DELETABLE_FOREACH_PTR(it, helper, &cache->entries) {
+        if (!avs_time_monotonic_before(now, (*it)->expires)) {
+            avs_free((*it)->payload);
+            AVS_LIST_DELETE(it);
+        } else if ((*it)->requested_format == requested_format
+                   && (*it)->ssid == ssid
+                   && (*it)->lwm2m_version == lwm2m_version
+                   && _anjay_uri_path_equal(&(*it)->path, path)) {
+            return *it;
+        }
+    }
+    return NULL;
+}
+
+void _anjay_dm_read_cache_store(anjay_unlocked_t *anjay,
+                                anjay_oid_t oid,
+                                uint32_t generation,
+                                const anjay_dm_cached_read_t *key) {
+    // the cache is looked up again, as it might have been disabled while the
+    // response was being generated
+    anjay_dm_read_cache_t *cache = _anjay_dm_read_cache_find(anjay, oid);
+    AVS_LIST(anjay_dm_cached_read_t) entry = NULL;
+    if (!cache || cache->generation != generation
+            || _anjay_dm_read_cache_get(cache, &key->path,
+                                        key->requested_format, key->ssid,
+                                        key->lwm2m_version)
+            || !(entry = AVS_LIST_NEW_ELEMENT(anjay_dm_cached_read_t))) {
+        avs_free(key->payload);
+        return;
+    }
+    *entry = *key;
+    entry->expires = avs_time_monotonic_add(avs_time_monotonic_now(),
+                                            cache->ttl);
+    AVS_LIST_INSERT(&cache->entries, entry);
+}
+
+int anjay_set_instance_list_caching(anjay_t *anjay_locked,
+                                    anjay_oid_t oid,
+                                    bool enabled) {
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_dm_object_cache_t) *it = find_cache_ptr(anjay, oid);
+    bool exists = (*it && (*it)->oid == oid);
+    if (!_anjay_dm_find_object_by_oid(anjay, oid)) {
+        dm_log(ERROR, _("Object ") "/%u" _(" is not registered"),
+               (unsigned) oid);
+    } else if (!enabled) {
+        if (exists) {
+            if ((*it)->iteration_depth) {
+                dm_log(ERROR,
+                       _("cannot disable Instance list caching for ") "/%u" _(
+                               " while it is being iterated over"),
+                       (unsigned) oid);
+            } else {
+                clear_cache_entry(*it);
+                AVS_LIST_DELETE(it);
+                result = 0;
+            }
+        } else {
+            result = 0;
+        }
+    } else if (exists) {
+        result = 0;
+    } else if (!AVS_LIST_INSERT_NEW(anjay_dm_object_cache_t, it)) {
+        _anjay_log_oom();
+    } else {
+        (*it)->oid = oid;
+        // generation != valid_generation, so the cache starts out invalid
+        (*it)->generation = 1;
+        result = 0;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+int anjay_set_resource_list_caching(anjay_t *anjay_locked,
+                                    anjay_oid_t oid,
+                                    bool enabled) {
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_dm_resource_cache_t) *it =
+            find_resource_cache_ptr(anjay, oid);
+    bool exists = (*it && (*it)->oid == oid);
+    if (!_anjay_dm_find_object_by_oid(anjay, oid)) {
+        dm_log(ERROR, _("Object ") "/%u" _(" is not registered"),
+               (unsigned) oid);
+    } else if (!enabled) {
+        if (exists) {
+            if ((*it)->iteration_depth) {
+                dm_log(ERROR,
+                       _("cannot disable Resource list caching for ") "/%u" _(
+                               " while it is being iterated over"),
+                       (unsigned) oid);
+            } else {
+                clear_resource_cache_entry(*it);
+                AVS_LIST_DELETE(it);
+                result = 0;
+            }
+        } else {
+            result = 0;
+        }
+    } else if (exists) {
+        result = 0;
+    } else if (!AVS_LIST_INSERT_NEW(anjay_dm_resource_cache_t, it)) {
+        _anjay_log_oom();
+    } else {
+        (*it)->oid = oid;
+        (*it)->iid = ANJAY_ID_INVALID;
+        // generation != valid_generation, so the cache starts out invalid
+        (*it)->generation = 1;
+        result = 0;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+int anjay_set_discover_caching(anjay_t *anjay_locked,
+                               anjay_oid_t oid,
+                               bool enabled) {
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_dm_discover_cache_t) *it =
+            find_discover_cache_ptr(anjay, oid);
+    bool exists = (*it && (*it)->oid == oid);
+    if (!_anjay_dm_find_object_by_oid(anjay, oid)) {
+        dm_log(ERROR, _("Object ") "/%u" _(" is not registered"),
+               (unsigned) oid);
+    } else if (!enabled) {
+        if (exists) {
+            clear_discover_cache_entry(*it);
+            AVS_LIST_DELETE(it);
+        }
+        result = 0;
+    } else if (exists) {
+        result = 0;
+    } else if (!AVS_LIST_INSERT_NEW(anjay_dm_discover_cache_t, it)) {
+        _anjay_log_oom();
+    } else {
+        (*it)->oid = oid;
+        result = 0;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+int anjay_set_read_response_caching(anjay_t *anjay_locked,
+                                    anjay_oid_t oid,
+                                    avs_time_duration_t ttl) {
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_dm_read_cache_t) *it = find_read_cache_ptr(anjay, oid);
+    bool exists = (*it && (*it)->oid == oid);
+    if (!_anjay_dm_find_object_by_oid(anjay, oid)) {
+        dm_log(ERROR, _("Object ") "/%u" _(" is not registered"),
+               (unsigned) oid);
+    } else if (!avs_time_duration_less(AVS_TIME_DURATION_ZERO, ttl)) {
+        if (exists) {
+            clear_read_cache_entry(*it);
+            AVS_LIST_DELETE(it);
+        }
+        result = 0;
+    } else if (!exists && !AVS_LIST_INSERT_NEW(anjay_dm_read_cache_t, it)) {
+        _anjay_log_oom();
+    } else {
+        // entries already stored keep their expiration times
+        (*it)->oid = oid;
+        (*it)->ttl = ttl;
+        result = 0;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+int anjay_set_resource_value_caching(anjay_t *anjay_locked,
+                                     anjay_oid_t oid,
+                                     anjay_rid_t rid,
+                                     bool enabled) {
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+#if defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+    AVS_LIST(anjay_dm_value_cache_t) *it =
+            find_value_cache_ptr(anjay, oid, rid);
+    bool exists = (*it && (*it)->oid == oid && (*it)->rid == rid);
+    if (!_anjay_dm_find_object_by_oid(anjay, oid)) {
+        dm_log(ERROR, _("Object ") "/%u" _(" is not registered"),
+               (unsigned) oid);
+    } else if (!enabled) {
+        if (exists) {
+            clear_value_cache_entry(*it);
+            AVS_LIST_DELETE(it);
+        }
+        result = 0;
+    } else if (exists) {
+        result = 0;
+    } else if (!AVS_LIST_INSERT_NEW(anjay_dm_value_cache_t, it)) {
+        _anjay_log_oom();
+    } else {
+        (*it)->oid = oid;
+        (*it)->rid = rid;
+        result = 0;
+    }
+#else  // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+    (void) anjay;
+    (void) oid;
+    (void) rid;
+    if (!enabled) {
+        result = 0;
+    } else {
+        dm_log(ERROR, _("Resource value caching requires Observe or Send "
+                        "support"));
+    }
+#endif // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+int anjay_set_notify_driven(anjay_t *anjay_locked,
+                            anjay_oid_t oid,
+                            bool enabled) {
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+#ifdef ANJAY_WITH_OBSERVE
+    if (!_anjay_dm_find_object_by_oid(anjay, oid)) {
+        dm_log(ERROR, _("Object ") "/%u" _(" is not registered"),
+               (unsigned) oid);
+    } else {
+        result = _anjay_observe_set_notify_driven(anjay, oid, enabled);
+    }
+#else  // ANJAY_WITH_OBSERVE
+    (void) anjay;
+    (void) oid;
+    if (!enabled) {
+        result = 0;
+    } else {
+        dm_log(ERROR, _("Notify-driven Objects require Observe support"));
+    }
+#endif // ANJAY_WITH_OBSERVE
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
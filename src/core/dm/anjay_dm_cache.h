@@ -0,0 +1,548 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_DM_CACHE_H
+#define ANJAY_DM_CACHE_H
+
+#include <avsystem/commons/avs_list.h>
+
+#include <anjay_modules/anjay_dm_utils.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Cached list of Instance IDs of a single installed Object, enabled using
+ * @ref anjay_set_instance_list_caching.
+ *
+ * The cache is considered valid only if <c>valid_generation</c> is equal to
+ * <c>generation</c> (newly created entries start with these being different).
+ * The latter is incremented each time the set of Instances is known to change,
+ * which also covers changes that might happen while the list is being
+ * populated with the mutex released for the sake of calling the user's
+ * list_instances handler.
+ */
+typedef struct {
+    anjay_oid_t oid;
+    uint32_t generation;
+    uint32_t valid_generation;
+    /**
+     * Number of foreach_instance calls currently iterating over
+     * <c>instances</c>. The array is never reallocated while it is nonzero.
+     */
+    unsigned iteration_depth;
+    size_t instance_count;
+    anjay_iid_t *instances;
+    /**
+     * Instance ID from which the search for a free one starts when creating
+     * Instances without an explicit ID. All lower IDs are believed to be in
+     * use. Unlike <c>instances</c>, it is kept up to date across Instances
+     * created and removed by the library itself, so that repeated Creates do
+     * not need to enumerate all Instances. It is only a hint - the selected ID
+     * is always verified to be free.
+     */
+    anjay_iid_t free_iid_hint;
+} anjay_dm_object_cache_t;
+
+static inline bool
+_anjay_dm_object_cache_valid(const anjay_dm_object_cache_t *cache) {
+    return cache->valid_generation == cache->generation;
+}
+
+anjay_dm_object_cache_t *_anjay_dm_cache_find(anjay_unlocked_t *anjay,
+                                              anjay_oid_t oid);
+
+/**
+ * Marks the cached Instance list of Object @p oid as outdated. Does nothing if
+ * caching is not enabled for that Object. As Instances might have been
+ * recreated with different sets of Resources, the cached Resource list is
+ * invalidated as well, and so is the Registration payload cache.
+ */
+void _anjay_dm_cache_invalidate_instances(anjay_unlocked_t *anjay,
+                                          anjay_oid_t oid);
+
+/**
+ * Returns the lowest Instance ID not present in the valid cached Instance
+ * list of @p cache, or @ref ANJAY_ID_INVALID if all are in use.
+ */
+anjay_iid_t
+_anjay_dm_cache_first_free_iid(const anjay_dm_object_cache_t *cache);
+
+/**
+ * Updates the free Instance ID hint of Object @p oid after Instance @p iid has
+ * been successfully created or removed using the instance_create or
+ * instance_remove handler, respectively.
+ */
+void _anjay_dm_cache_instance_created(anjay_unlocked_t *anjay,
+                                      anjay_oid_t oid,
+                                      anjay_iid_t iid);
+void _anjay_dm_cache_instance_removed(anjay_unlocked_t *anjay,
+                                      anjay_oid_t oid,
+                                      anjay_iid_t iid);
+
+/**
+ * Resets the free Instance ID hint of Object @p oid, after its Instances have
+ * changed in an unknown way.
+ */
+void _anjay_dm_cache_reset_free_iid_hint(anjay_unlocked_t *anjay,
+                                         anjay_oid_t oid);
+
+/**
+ * Drops the cache entries for Object @p oid altogether. Used when the Object is
+ * unregistered.
+ */
+void _anjay_dm_cache_remove(anjay_unlocked_t *anjay, anjay_oid_t oid);
+
+void _anjay_dm_cache_cleanup(anjay_unlocked_t *anjay);
+
+/**
+ * Replaces the cached Instance list with @p instances, taking ownership of the
+ * array allocated with @ref avs_malloc. The list is marked as valid only if no
+ * invalidation happened since @p generation was sampled; otherwise it is still
+ * stored but will be refreshed on next use.
+ */
+void _anjay_dm_cache_store_instances(anjay_dm_object_cache_t *cache,
+                                     uint32_t generation,
+                                     anjay_iid_t *instances,
+                                     size_t instance_count);
+
+typedef struct {
+    anjay_rid_t rid;
+    anjay_dm_resource_kind_t kind;
+    anjay_dm_resource_presence_t presence;
+} anjay_dm_cached_resource_t;
+
+/**
+ * Cached result of the list_resources handler for the most recently listed
+ * Instance of a single installed Object, enabled using
+ * @ref anjay_set_resource_list_caching.
+ *
+ * Validity rules are the same as for @ref anjay_dm_object_cache_t; in addition,
+ * the cached list applies only to the Instance identified by <c>iid</c>.
+ */
+typedef struct {
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+    uint32_t generation;
+    uint32_t valid_generation;
+    /**
+     * Number of foreach_resource calls currently iterating over
+     * <c>resources</c>. The array is never reallocated while it is nonzero.
+     */
+    unsigned iteration_depth;
+    size_t resource_count;
+    anjay_dm_cached_resource_t *resources;
+} anjay_dm_resource_cache_t;
+
+static inline bool
+_anjay_dm_resource_cache_valid(const anjay_dm_resource_cache_t *cache,
+                               anjay_iid_t iid) {
+    return cache->valid_generation == cache->generation && cache->iid == iid;
+}
+
+anjay_dm_resource_cache_t *
+_anjay_dm_resource_cache_find(anjay_unlocked_t *anjay, anjay_oid_t oid);
+
+/**
+ * Marks the cached Resource list of Object @p oid as outdated. Does nothing if
+ * caching is not enabled for that Object.
+ */
+void _anjay_dm_cache_invalidate_resources(anjay_unlocked_t *anjay,
+                                          anjay_oid_t oid);
+
+/**
+ * Replaces the cached Resource list with @p resources, describing Instance
+ * @p iid. Semantics are the same as for @ref _anjay_dm_cache_store_instances.
+ */
+void _anjay_dm_cache_store_resources(anjay_dm_resource_cache_t *cache,
+                                     uint32_t generation,
+                                     anjay_iid_t iid,
+                                     anjay_dm_cached_resource_t *resources,
+                                     size_t resource_count);
+
+/**
+ * Variants of the Registration Objects and Object Instances list, which differ
+ * in formatting of the Object Version attribute.
+ */
+typedef enum {
+    ANJAY_DM_OBJECT_LINKS_LWM2M10,
+#ifdef ANJAY_WITH_LWM2M11
+    ANJAY_DM_OBJECT_LINKS_LWM2M11,
+#endif // ANJAY_WITH_LWM2M11
+    ANJAY_DM_OBJECT_LINKS_FORMATS_COUNT
+} anjay_dm_object_links_format_t;
+
+/**
+ * Cached CoRE Link Format payload of Register and Update messages, enabled
+ * using @ref anjay_configuration_t::cache_registration_payload. It is
+ * invalidated each time the set of Instances of any Object is known to change.
+ */
+typedef struct {
+    uint32_t generation;
+    char *payloads[ANJAY_DM_OBJECT_LINKS_FORMATS_COUNT];
+} anjay_dm_object_links_cache_t;
+
+/**
+ * Returns the cached payload in the given @p format, or NULL if it needs to be
+ * regenerated. In the latter case, the current generation is stored in
+ * @p out_generation, to be passed to @ref _anjay_dm_cache_store_object_links.
+ */
+const char *
+_anjay_dm_cache_get_object_links(anjay_unlocked_t *anjay,
+                                 anjay_dm_object_links_format_t format,
+                                 uint32_t *out_generation);
+
+/**
+ * Stores @p payload (allocated using @ref avs_malloc) as the cached payload in
+ * the given @p format, taking ownership of it. If the cache has been
+ * invalidated since @p generation was sampled, the payload is discarded
+ * instead.
+ */
+void _anjay_dm_cache_store_object_links(anjay_unlocked_t *anjay,
+                                        anjay_dm_object_links_format_t format,
+                                        uint32_t generation,
+                                        char *payload);
+
+void _anjay_dm_cache_invalidate_object_links(anjay_unlocked_t *anjay);
+
+#ifdef ANJAY_WITH_ACCESS_CONTROL
+/**
+ * Single effective permission derived from the Access Control Object: access
+ * mask that Server @c ssid has to Object Instance /oid/iid (@c iid may be
+ * ANJAY_ID_INVALID for the Create permission). Entries with @c ssid == 0
+ * represent the default ACL entry of the target.
+ */
+typedef struct {
+    anjay_oid_t oid;
+    anjay_iid_t iid;
+    anjay_ssid_t ssid;
+    anjay_access_mask_t mask;
+} anjay_dm_cached_acl_entry_t;
+
+/**
+ * Cached contents of the Access Control Object, as an array of entries sorted
+ * by (oid, iid, ssid). Unlike the other caches, it is always enabled. It is
+ * populated lazily on the first access check and invalidated whenever the
+ * Resource list cache of the Access Control Object would be, or the Object
+ * itself is unregistered.
+ *
+ * <c>generation</c> is incremented on each invalidation, which protects
+ * against storing entries read while the data model handlers were called with
+ * the mutex released and the Access Control Object changed in the meantime.
+ */
+typedef struct {
+    uint32_t generation;
+    bool valid;
+    size_t entry_count;
+    anjay_dm_cached_acl_entry_t *entries;
+} anjay_dm_acl_cache_t;
+
+/**
+ * Replaces the cached ACL entries with @p entries (allocated using
+ * @ref avs_malloc and sorted by (oid, iid, ssid)), taking ownership of them. If
+ * the cache has been invalidated since @p generation was sampled, the array is
+ * discarded instead.
+ */
+void _anjay_dm_cache_store_acl(anjay_unlocked_t *anjay,
+                               uint32_t generation,
+                               anjay_dm_cached_acl_entry_t *entries,
+                               size_t entry_count);
+
+void _anjay_dm_cache_invalidate_acl(anjay_unlocked_t *anjay);
+#else // ANJAY_WITH_ACCESS_CONTROL
+#    define _anjay_dm_cache_invalidate_acl(...) ((void) 0)
+#endif // ANJAY_WITH_ACCESS_CONTROL
+
+/**
+ * Identifiers of a single Server Object Instance. @c result is the value
+ * returned by @ref _anjay_dm_read_resource_i64 for its Short Server ID
+ * Resource; @c ssid is only meaningful if it is 0.
+ */
+typedef struct {
+    anjay_iid_t iid;
+    int result;
+    int64_t ssid;
+} anjay_dm_cached_server_ids_t;
+
+/**
+ * Identifiers of a single Security Object Instance. The Short Server ID
+ * Resource is not read for Bootstrap-Server Instances; otherwise,
+ * @c ssid_result is 0 if it has been read successfully and is in the valid
+ * range, and @c ssid is only meaningful in that case.
+ */
+typedef struct {
+    anjay_iid_t iid;
+    bool is_bootstrap;
+    int ssid_result;
+    anjay_ssid_t ssid;
+} anjay_dm_cached_security_ids_t;
+
+/**
+ * Cached result of reading an integer Resource /1/iid/rid. @c result is the
+ * value returned by @ref _anjay_dm_read_resource_i64; @c value is only
+ * meaningful if it is 0.
+ */
+typedef struct {
+    anjay_iid_t iid;
+    anjay_rid_t rid;
+    int result;
+    int64_t value;
+} anjay_dm_cached_server_resource_t;
+
+/**
+ * Cache of Server Object parameters that are queried on hot paths, i.e. the
+ * Default Minimum/Maximum Period resources consulted when resolving
+ * notification attributes, and the Communication Retry resources consulted on
+ * each registration failure. Enabled using the <c>cache_server_params</c>
+ * configuration option.
+ *
+ * The cache also holds the identifiers of all Server and Security Object
+ * Instances, used by the helpers declared in anjay_query.h. Each of these
+ * lists is only meaningful if the matching <c>*_valid</c> flag is set, as an
+ * empty list is a valid state.
+ *
+ * The whole cache is dropped whenever the Resource list cache of the Server
+ * Object would be invalidated - that is, on each write to the Server Object
+ * performed through the data model, and on each @ref anjay_notify_changed or
+ * @ref anjay_notify_instances_changed call concerning it. The same events
+ * concerning the Security Object drop <c>security_ids</c>.
+ *
+ * <c>generation</c> is incremented on each invalidation, which protects
+ * against storing values read while the data model handlers were called with
+ * the mutex released and the Server Object changed in the meantime.
+ */
+typedef struct {
+    bool enabled;
+    uint32_t generation;
+    bool server_ids_valid;
+    AVS_LIST(anjay_dm_cached_server_ids_t) server_ids;
+    bool security_ids_valid;
+    AVS_LIST(anjay_dm_cached_security_ids_t) security_ids;
+    AVS_LIST(anjay_dm_cached_server_resource_t) resources;
+} anjay_dm_server_params_cache_t;
+
+/**
+ * Equivalent of calling @ref _anjay_dm_read_resource_i64 on /1/server_iid/rid
+ * that uses the Server parameters cache if it is enabled. Failed reads are
+ * cached as well.
+ */
+int _anjay_dm_cached_read_server_resource_i64(anjay_unlocked_t *anjay,
+                                              anjay_iid_t server_iid,
+                                              anjay_rid_t rid,
+                                              int64_t *out_value);
+
+void _anjay_dm_cache_invalidate_server_params(anjay_unlocked_t *anjay);
+
+void _anjay_dm_cache_invalidate_security_ids(anjay_unlocked_t *anjay);
+
+/**
+ * Single rendered Discover response, along with the parameters it was
+ * generated for.
+ */
+typedef struct {
+    anjay_iid_t iid;
+    anjay_rid_t rid;
+    anjay_ssid_t ssid;
+    uint8_t depth;
+    anjay_lwm2m_version_t lwm2m_version;
+    size_t payload_size;
+    void *payload;
+} anjay_dm_cached_discover_t;
+
+/**
+ * Cached Discover responses for a single installed Object, enabled using
+ * @ref anjay_set_discover_caching.
+ *
+ * All entries are dropped and <c>generation</c> is incremented whenever the
+ * Resource list cache of the Object would be invalidated (which also covers
+ * changes of Resource values and Instance sets), and whenever attributes are
+ * written.
+ */
+typedef struct {
+    anjay_oid_t oid;
+    uint32_t generation;
+    AVS_LIST(anjay_dm_cached_discover_t) entries;
+} anjay_dm_discover_cache_t;
+
+anjay_dm_discover_cache_t *
+_anjay_dm_discover_cache_find(anjay_unlocked_t *anjay, anjay_oid_t oid);
+
+/**
+ * Returns the cached response matching all the parameters, or NULL if there
+ * is none.
+ */
+const anjay_dm_cached_discover_t *
+_anjay_dm_discover_cache_get(const anjay_dm_discover_cache_t *cache,
+                             anjay_iid_t iid,
+                             anjay_rid_t rid,
+                             anjay_ssid_t ssid,
+                             uint8_t depth,
+                             anjay_lwm2m_version_t lwm2m_version);
+
+/**
+ * Stores a copy of @p key, taking ownership of the <c>payload</c> allocated
+ * with @ref avs_malloc, in the Discover cache of Object @p oid. The payload is
+ * discarded instead if caching has been disabled or the cache has been
+ * invalidated since @p generation was sampled.
+ */
+void _anjay_dm_discover_cache_store(anjay_unlocked_t *anjay,
+                                    anjay_oid_t oid,
+                                    uint32_t generation,
+                                    const anjay_dm_cached_discover_t *key);
+
+/**
+ * Drops the cached Discover responses of Object @p oid. Does nothing if
+ * caching is not enabled for that Object.
+ */
+void _anjay_dm_cache_invalidate_discover(anjay_unlocked_t *anjay,
+                                         anjay_oid_t oid);
+
+/**
+ * Drops the cached Discover responses of all Objects.
+ */
+void _anjay_dm_cache_invalidate_all_discover(anjay_unlocked_t *anjay);
+
+/**
+ * Single serialized Read response, along with the parameters it was generated
+ * for. <c>requested_format</c> is the Accept option of the request
+ * (AVS_COAP_FORMAT_NONE if absent), while <c>response_format</c> is the
+ * Content-Format the payload is actually encoded in.
+ *
+ * <c>ssid</c> identifies the access class: it is ANJAY_SSID_ANY if Access
+ * Control checks yield the same results for all non-Bootstrap Servers, or the
+ * Short Server ID of the requesting Server otherwise.
+ */
+typedef struct {
+    anjay_uri_path_t path;
+    uint16_t requested_format;
+    anjay_ssid_t ssid;
+    anjay_lwm2m_version_t lwm2m_version;
+    avs_time_monotonic_t expires;
+    uint16_t response_format;
+    size_t payload_size;
+    void *payload;
+} anjay_dm_cached_read_t;
+
+/**
+ * Cached Read responses for a single installed Object, enabled using
+ * @ref anjay_set_read_response_caching.
+ *
+ * Each entry is used for at most <c>ttl</c> after it has been generated. All
+ * entries are dropped and <c>generation</c> is incremented whenever the
+ * Resource list cache of the Object would be invalidated (which also covers
+ * changes of Resource values and Instance sets). Entries of all Objects are
+ * dropped whenever the Access Control Object changes.
+ */
+typedef struct {
+    anjay_oid_t oid;
+    avs_time_duration_t ttl;
+    uint32_t generation;
+    AVS_LIST(anjay_dm_cached_read_t) entries;
+} anjay_dm_read_cache_t;
+
+anjay_dm_read_cache_t *_anjay_dm_read_cache_find(anjay_unlocked_t *anjay,
+                                                 anjay_oid_t oid);
+
+/**
+ * Returns the cached response matching all the parameters, or NULL if there
+ * is none. Expired entries encountered during the lookup are dropped.
+ */
+const anjay_dm_cached_read_t *
+_anjay_dm_read_cache_get(anjay_dm_read_cache_t *cache,
+                         const anjay_uri_path_t *path,
+                         uint16_t requested_format,
+                         anjay_ssid_t ssid,
+                         anjay_lwm2m_version_t lwm2m_version);
+
+/**
+ * Stores a copy of @p key, taking ownership of the <c>payload</c> allocated
+ * with @ref avs_malloc, in the Read response cache of Object @p oid. The
+ * <c>expires</c> field is filled in according to the configured TTL. The
+ * payload is discarded instead if caching has been disabled or the cache has
+ * been invalidated since @p generation was sampled.
+ */
+void _anjay_dm_read_cache_store(anjay_unlocked_t *anjay,
+                                anjay_oid_t oid,
+                                uint32_t generation,
+                                const anjay_dm_cached_read_t *key);
+
+/**
+ * Drops the cached Read responses of Object @p oid. Does nothing if caching is
+ * not enabled for that Object.
+ */
+void _anjay_dm_cache_invalidate_read(anjay_unlocked_t *anjay, anjay_oid_t oid);
+
+/**
+ * Drops the cached Read responses of all Objects.
+ */
+void _anjay_dm_cache_invalidate_all_read(anjay_unlocked_t *anjay);
+
+#if defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+/**
+ * Value of a Resource in a single Instance, as read from the data model.
+ */
+typedef struct {
+    anjay_iid_t iid;
+    struct anjay_batch_struct *batch;
+} anjay_dm_cached_value_t;
+
+/**
+ * Cached values of a single Resource in all Instances of an installed Object,
+ * enabled using @ref anjay_set_resource_value_caching.
+ *
+ * All entries are dropped and <c>generation</c> is incremented whenever the
+ * Resource is known to change: when Anjay writes or resets it or resets its
+ * Instance, when the set of Instances changes, and on each call to
+ * @ref anjay_notify_changed that covers it.
+ */
+typedef struct {
+    anjay_oid_t oid;
+    anjay_rid_t rid;
+    uint32_t generation;
+    AVS_LIST(anjay_dm_cached_value_t) entries;
+} anjay_dm_value_cache_t;
+
+anjay_dm_value_cache_t *_anjay_dm_value_cache_find(anjay_unlocked_t *anjay,
+                                                   anjay_oid_t oid,
+                                                   anjay_rid_t rid);
+
+/**
+ * Returns the cached value of the Resource in Instance @p iid, or NULL if
+ * there is none.
+ */
+const struct anjay_batch_struct *
+_anjay_dm_value_cache_get(const anjay_dm_value_cache_t *cache, anjay_iid_t iid);
+
+/**
+ * Stores a new reference to @p batch as the cached value of /oid/iid/rid. The
+ * value is not stored if caching has been disabled or the cache has been
+ * invalidated since @p generation was sampled.
+ */
+void _anjay_dm_value_cache_store(anjay_unlocked_t *anjay,
+                                 anjay_oid_t oid,
+                                 anjay_iid_t iid,
+                                 anjay_rid_t rid,
+                                 uint32_t generation,
+                                 const struct anjay_batch_struct *batch);
+
+/**
+ * Drops the cached values of Resource /oid/iid/rid. @p iid and @p rid may be
+ * ANJAY_ID_INVALID, in which case values for all Instances or Resources of the
+ * Object are dropped.
+ */
+void _anjay_dm_cache_invalidate_values(anjay_unlocked_t *anjay,
+                                       anjay_oid_t oid,
+                                       anjay_iid_t iid,
+                                       anjay_rid_t rid);
+#else // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+#    define _anjay_dm_cache_invalidate_values(...) ((void) 0)
+#endif // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif // ANJAY_DM_CACHE_H
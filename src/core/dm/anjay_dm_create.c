@@ -18,6 +18,7 @@
 #include "../io/anjay_vtable.h"
 
 #include <inttypes.h>
+#include <stdlib.h>
 
 VISIBILITY_SOURCE_BEGIN
 
@@ -71,17 +72,125 @@ static int dm_create_select_iid_clb(anjay_unlocked_t *anjay,
     }
 }
 
+/**
+ * Maximum number of instance_present calls made when looking for a free
+ * Instance ID starting from the hint, before falling back to enumerating all
+ * Instances.
+ */
+#define MAX_FREE_IID_HINT_PROBES 8
+
+/**
+ * Attempts to select a free Instance ID using the Instance list cache of
+ * @p obj. Returns 0 on success, a negative value in case of error, or a
+ * positive value if a full enumeration of Instances is necessary.
+ */
+static int select_free_iid_cached(anjay_unlocked_t *anjay,
+                                  const anjay_dm_installed_object_t *obj,
+                                  anjay_iid_t *new_iid_ptr) {
+    const anjay_oid_t oid = _anjay_dm_installed_object_oid(obj);
+    anjay_dm_object_cache_t *cache = _anjay_dm_cache_find(anjay, oid);
+    if (!cache) {
+        return 1;
+    }
+    if (_anjay_dm_object_cache_valid(cache)) {
+        cache->free_iid_hint = _anjay_dm_cache_first_free_iid(cache);
+        *new_iid_ptr = cache->free_iid_hint;
+        return *new_iid_ptr == ANJAY_ID_INVALID ? 1 : 0;
+    }
+    if (!_anjay_dm_handler_implemented(obj,
+                                       ANJAY_DM_HANDLER_instance_present)) {
+        return 1;
+    }
+    anjay_iid_t iid = cache->free_iid_hint;
+    for (size_t i = 0; i < MAX_FREE_IID_HINT_PROBES && iid != ANJAY_ID_INVALID;
+         ++i, ++iid) {
+        int result = _anjay_dm_call_instance_present(anjay, obj, iid);
+        if (result < 0) {
+            return result;
+        } else if (!result) {
+            // the mutex might have been released while calling
+            // instance_present, so the cache entry needs to be looked up again
+            if ((cache = _anjay_dm_cache_find(anjay, oid))) {
+                cache->free_iid_hint = iid;
+            }
+            *new_iid_ptr = iid;
+            return 0;
+        }
+    }
+    return 1;
+}
+
 int _anjay_dm_select_free_iid(anjay_unlocked_t *anjay,
                               const anjay_dm_installed_object_t *obj,
                               anjay_iid_t *new_iid_ptr) {
+    int result = select_free_iid_cached(anjay, obj, new_iid_ptr);
+    if (result <= 0) {
+        return result;
+    }
     *new_iid_ptr = 0;
-    int result =
+    result =
             _anjay_dm_foreach_instance(anjay, obj, dm_create_select_iid_clb,
                                        new_iid_ptr);
     if (!result && *new_iid_ptr == ANJAY_ID_INVALID) {
         dm_log(ERROR, _("65535 object instances already exist"));
         return ANJAY_ERR_BAD_REQUEST;
     }
+    anjay_dm_object_cache_t *cache =
+            _anjay_dm_cache_find(anjay, _anjay_dm_installed_object_oid(obj));
+    if (!result && cache) {
+        cache->free_iid_hint = *new_iid_ptr;
+    }
+    return result;
+}
+
+static int compare_iids(const void *left, const void *right) {
+    const anjay_iid_t left_iid = *(const anjay_iid_t *) left;
+    const anjay_iid_t right_iid = *(const anjay_iid_t *) right;
+    return left_iid < right_iid ? -1 : (left_iid > right_iid);
+}
+
+static int create_instances_unlocked(anjay_unlocked_t *anjay,
+                                     anjay_oid_t oid,
+                                     size_t count,
+                                     anjay_iid_t *out_iids) {
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(anjay, oid);
+    if (!obj) {
+        dm_log(ERROR, _("Object ") "/%" PRIu16 _(" not installed"), oid);
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    if (avs_is_err(_anjay_dm_transaction_begin(anjay))) {
+        return -1;
+    }
+    int result = 0;
+    for (size_t i = 0; !result && i < count; ++i) {
+        (void) ((result = _anjay_dm_select_free_iid(anjay, obj, &out_iids[i]))
+                || (result = _anjay_dm_call_instance_create(anjay, obj,
+                                                            out_iids[i])));
+    }
+    if ((result = _anjay_dm_transaction_finish(anjay, result))) {
+        dm_log(DEBUG,
+               _("Creating ") "%lu" _(" Instances of ") "/%" PRIu16 _(
+                       " failed"),
+               (unsigned long) count, oid);
+        return result;
+    }
+    qsort(out_iids, count, sizeof(*out_iids), compare_iids);
+    return _anjay_notify_instances_created(anjay, oid, out_iids, count);
+}
+
+int anjay_create_instances(anjay_t *anjay_locked,
+                           anjay_oid_t oid,
+                           size_t count,
+                           anjay_iid_t *out_iids) {
+    if (count && !out_iids) {
+        dm_log(ERROR, _("out_iids must not be NULL"));
+        return -1;
+    }
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    result = create_instances_unlocked(anjay, oid, count, out_iids);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
     return result;
 }
 
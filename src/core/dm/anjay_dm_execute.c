@@ -12,6 +12,7 @@
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "../anjay_dm_core.h"
 #include "../anjay_io_core.h"
@@ -23,25 +24,41 @@ static anjay_execute_state_t state_read_value(anjay_unlocked_execute_ctx_t *ctx,
                                               int ch);
 static anjay_execute_state_t
 state_read_argument(anjay_unlocked_execute_ctx_t *ctx, int ch);
+static anjay_execute_state_t
+expect_separator_or_eof(anjay_unlocked_execute_ctx_t *ctx, int ch);
 
 static int get_next_char(anjay_unlocked_execute_ctx_t *ctx) {
+    if (ctx->buffer_offset < ctx->buffer_size) {
+        return (unsigned char) ctx->buffer[ctx->buffer_offset++];
+    }
+    if (ctx->stream_finished) {
+        return EOF;
+    }
+
     char read_char;
     avs_error_t err = avs_stream_read_reliably(
             ctx->payload_stream, &read_char, sizeof(read_char));
 
     if (avs_is_ok(err)) {
-        return read_char;
+        return (unsigned char) read_char;
     }
 
     return EOF;
 }
 
 static int peek_next_char(anjay_unlocked_execute_ctx_t *ctx) {
+    if (ctx->buffer_offset < ctx->buffer_size) {
+        return (unsigned char) ctx->buffer[ctx->buffer_offset];
+    }
+    if (ctx->stream_finished) {
+        return EOF;
+    }
+
     char peeked_char;
     avs_error_t err = avs_stream_peek(ctx->payload_stream, 0, &peeked_char);
 
     if (avs_is_ok(err)) {
-        return peeked_char;
+        return (unsigned char) peeked_char;
     }
 
     return EOF;
@@ -142,6 +159,51 @@ int _anjay_execute_get_arg_value_unlocked(anjay_unlocked_execute_ctx_t *ctx,
     }
 }
 
+int _anjay_execute_get_arg_value_view_unlocked(
+        anjay_unlocked_execute_ctx_t *ctx,
+        const char **out_value,
+        size_t *out_value_size) {
+    if (!out_value || !out_value_size) {
+        dm_log(ERROR, _("Invalid arguments passed to "
+                        "anjay_execute_get_arg_value_view()"));
+        return -1;
+    }
+    *out_value = "";
+    *out_value_size = 0;
+    if (ctx->state == STATE_ERROR) {
+        return ANJAY_ERR_BAD_REQUEST;
+    } else if (ctx->state != STATE_READ_VALUE) {
+        return 0;
+    }
+
+    const char *value = &ctx->buffer[ctx->buffer_offset];
+    const char *value_end = (const char *) memchr(
+            value, '\'', ctx->buffer_size - ctx->buffer_offset);
+    if (!value_end) {
+        if (ctx->stream_finished) {
+            // unterminated value
+            ctx->state = STATE_ERROR;
+            return ANJAY_ERR_BAD_REQUEST;
+        }
+        // the rest of the value is not buffered
+        return ANJAY_BUFFER_TOO_SHORT;
+    }
+    for (const char *ch = value; ch < value_end; ++ch) {
+        if (!is_value((unsigned char) *ch)) {
+            ctx->state = STATE_ERROR;
+            return ANJAY_ERR_BAD_REQUEST;
+        }
+    }
+    ctx->buffer_offset = (size_t) (value_end - ctx->buffer) + 1;
+    if ((ctx->state = expect_separator_or_eof(ctx, get_next_char(ctx)))
+            == STATE_ERROR) {
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+    *out_value = value;
+    *out_value_size = (size_t) (value_end - value);
+    return 0;
+}
+
 static int skip_value(anjay_unlocked_execute_ctx_t *ctx) {
     /*
      * If we are in the middle of reading the value assigned to the argument,
@@ -214,6 +276,37 @@ int anjay_execute_get_arg_value(anjay_execute_ctx_t *ctx,
     return result;
 }
 
+int anjay_execute_get_arg_value_view(anjay_execute_ctx_t *ctx,
+                                     const char **out_value,
+                                     size_t *out_value_size) {
+    int result = -1;
+#ifdef ANJAY_WITH_THREAD_SAFETY
+    ANJAY_MUTEX_LOCK(anjay, ctx->anjay_locked);
+#endif // ANJAY_WITH_THREAD_SAFETY
+    result = _anjay_execute_get_arg_value_view_unlocked(
+            _anjay_execute_get_unlocked(ctx), out_value, out_value_size);
+#ifdef ANJAY_WITH_THREAD_SAFETY
+    ANJAY_MUTEX_UNLOCK(ctx->anjay_locked);
+#endif // ANJAY_WITH_THREAD_SAFETY
+    return result;
+}
+
+static void fill_buffer(anjay_unlocked_execute_ctx_t *ctx) {
+    while (!ctx->stream_finished && ctx->buffer_size < sizeof(ctx->buffer)) {
+        size_t bytes_read;
+        if (avs_is_err(avs_stream_read(ctx->payload_stream, &bytes_read,
+                                       &ctx->stream_finished,
+                                       &ctx->buffer[ctx->buffer_size],
+                                       sizeof(ctx->buffer)
+                                               - ctx->buffer_size))) {
+            // treat the payload as ending here, like get_next_char() does
+            ctx->stream_finished = true;
+            return;
+        }
+        ctx->buffer_size += bytes_read;
+    }
+}
+
 anjay_unlocked_execute_ctx_t *
 _anjay_execute_ctx_create(avs_stream_t *payload_stream) {
     anjay_unlocked_execute_ctx_t *ret =
@@ -223,6 +316,7 @@ _anjay_execute_ctx_create(avs_stream_t *payload_stream) {
         ret->payload_stream = payload_stream;
         ret->arg = -1;
         ret->state = STATE_READ_ARGUMENT;
+        fill_buffer(ret);
     }
     return ret;
 }
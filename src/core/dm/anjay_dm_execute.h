@@ -22,11 +22,24 @@ typedef enum {
     STATE_ERROR
 } anjay_execute_state_t;
 
+/**
+ * Number of bytes at the beginning of the Execute payload that are read from
+ * the stream at once when creating the execute context. Payloads that fit in
+ * it are parsed without any further stream calls, and their argument values
+ * may be accessed in place.
+ */
+#define ANJAY_EXECUTE_PAYLOAD_BUFFER_SIZE 128
+
 struct anjay_unlocked_execute_ctx_struct {
     avs_stream_t *payload_stream;
     anjay_execute_state_t state;
     int arg;
     bool arg_has_value;
+    // set if payload_stream has nothing more to read after the buffer
+    bool stream_finished;
+    size_t buffer_size;
+    size_t buffer_offset;
+    char buffer[ANJAY_EXECUTE_PAYLOAD_BUFFER_SIZE];
 };
 
 VISIBILITY_PRIVATE_HEADER_END
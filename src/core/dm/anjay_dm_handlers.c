@@ -9,7 +9,10 @@
 
 #include <anjay_init.h>
 
+#include <string.h>
+
 #include <avsystem/coap/code.h>
+#include <avsystem/commons/avs_memory.h>
 
 #include <anjay_modules/anjay_dm_utils.h>
 
@@ -464,6 +467,64 @@ static int unlocking_resource_instance_write_attrs(
 }
 #    endif // ANJAY_WITH_LWM2M11
 
+static int
+unlocking_resource_read_many(anjay_unlocked_t *anjay,
+                             const anjay_dm_installed_object_t obj_def,
+                             anjay_iid_t iid,
+                             const anjay_rid_t *rids,
+                             size_t rid_count) {
+    assert(obj_def.type == ANJAY_DM_OBJECT_USER_PROVIDED);
+    assert(obj_def.impl.user_provided);
+    assert(*obj_def.impl.user_provided);
+    assert((*obj_def.impl.user_provided)->handlers.resource_read_many);
+    int result = -1;
+    ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
+    result = (*obj_def.impl.user_provided)
+                     ->handlers.resource_read_many(anjay_locked,
+                                                   obj_def.impl.user_provided,
+                                                   iid, rids, rid_count);
+    ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
+    return result;
+}
+
+static int
+unlocking_instance_present(anjay_unlocked_t *anjay,
+                           const anjay_dm_installed_object_t obj_def,
+                           anjay_iid_t iid) {
+    assert(obj_def.type == ANJAY_DM_OBJECT_USER_PROVIDED);
+    assert(obj_def.impl.user_provided);
+    assert(*obj_def.impl.user_provided);
+    assert((*obj_def.impl.user_provided)->handlers.instance_present);
+    int result = -1;
+    ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
+    result = (*obj_def.impl.user_provided)
+                     ->handlers.instance_present(anjay_locked,
+                                                 obj_def.impl.user_provided,
+                                                 iid);
+    ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
+    return result;
+}
+
+static int
+unlocking_resource_read_instances(anjay_unlocked_t *anjay,
+                                  const anjay_dm_installed_object_t obj_def,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  anjay_dm_res_instances_t *out) {
+    assert(obj_def.type == ANJAY_DM_OBJECT_USER_PROVIDED);
+    assert(obj_def.impl.user_provided);
+    assert(*obj_def.impl.user_provided);
+    assert((*obj_def.impl.user_provided)->handlers.resource_read_instances);
+    int result = -1;
+    ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
+    result = (*obj_def.impl.user_provided)
+                     ->handlers.resource_read_instances(
+                             anjay_locked, obj_def.impl.user_provided, iid, rid,
+                             out);
+    ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
+    return result;
+}
+
 static const anjay_unlocked_dm_handlers_t UNLOCKING_HANDLER_WRAPPERS = {
     unlocking_object_read_default_attrs,
     unlocking_object_write_default_attrs,
@@ -489,6 +550,9 @@ static const anjay_unlocked_dm_handlers_t UNLOCKING_HANDLER_WRAPPERS = {
     unlocking_resource_instance_read_attrs,
     unlocking_resource_instance_write_attrs,
 #    endif // ANJAY_WITH_LWM2M11
+    unlocking_resource_read_many,
+    unlocking_instance_present,
+    unlocking_resource_read_instances,
 };
 
 static bool has_handler_locked(const anjay_dm_handlers_t *def,
@@ -522,6 +586,9 @@ static bool has_handler_locked(const anjay_dm_handlers_t *def,
         HANDLER_CASE(resource_instance_read_attrs);
         HANDLER_CASE(resource_instance_write_attrs);
 #    endif // ANJAY_WITH_LWM2M11
+        HANDLER_CASE(resource_read_many);
+        HANDLER_CASE(instance_present);
+        HANDLER_CASE(resource_read_instances);
     }
 #    undef HANDLER_CASE
     AVS_UNREACHABLE("unknown handler type passed");
@@ -561,6 +628,9 @@ static bool has_handler_unlocked(const anjay_unlocked_dm_handlers_t *def,
         HANDLER_CASE(resource_instance_read_attrs);
         HANDLER_CASE(resource_instance_write_attrs);
 #endif // ANJAY_WITH_LWM2M11
+        HANDLER_CASE(resource_read_many);
+        HANDLER_CASE(instance_present);
+        HANDLER_CASE(resource_read_instances);
     }
 #undef HANDLER_CASE
     AVS_UNREACHABLE("unknown handler type passed");
@@ -670,8 +740,15 @@ bool _anjay_dm_handler_implemented(const anjay_dm_installed_object_t *obj_ptr,
         const anjay_unlocked_dm_handlers_t *handler =                         \
                 get_handler((ObjPtr), ANJAY_DM_HANDLER_##HandlerName);        \
         if (handler) {                                                        \
+            ANJAY_TRACEPOINT(dm_handler_enter,                                \
+                             (int) ANJAY_DM_HANDLER_##HandlerName,            \
+                             _anjay_dm_installed_object_oid(ObjPtr));         \
             int AVS_CONCAT(result, __LINE__) =                                \
                     handler->HandlerName(__VA_ARGS__);                        \
+            ANJAY_TRACEPOINT(dm_handler_exit,                                 \
+                             (int) ANJAY_DM_HANDLER_##HandlerName,            \
+                             _anjay_dm_installed_object_oid(ObjPtr),          \
+                             AVS_CONCAT(result, __LINE__));                   \
             if (AVS_CONCAT(result, __LINE__)) {                               \
                 dm_log(DEBUG, #HandlerName _(" failed with code ") "%d (%s)", \
                        AVS_CONCAT(result, __LINE__),                          \
@@ -717,16 +794,58 @@ int _anjay_dm_call_list_instances(anjay_unlocked_t *anjay,
     CHECKED_TAIL_CALL_HANDLER(obj_ptr, list_instances, anjay, *obj_ptr, ctx);
 }
 
+int _anjay_dm_call_instance_present(anjay_unlocked_t *anjay,
+                                    const anjay_dm_installed_object_t *obj_ptr,
+                                    anjay_iid_t iid) {
+    dm_log(TRACE, _("instance_present ") "/%u/%u",
+           _anjay_dm_installed_object_oid(obj_ptr), iid);
+    const anjay_unlocked_dm_handlers_t *handler =
+            get_handler(obj_ptr, ANJAY_DM_HANDLER_instance_present);
+    if (!handler) {
+        dm_log(DEBUG, _("instance_present handler not set for object ") "/%u",
+               _anjay_dm_installed_object_oid(obj_ptr));
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+    // positive result means success, so CHECKED_TAIL_CALL_HANDLER can't be used
+    ANJAY_TRACEPOINT(dm_handler_enter, (int) ANJAY_DM_HANDLER_instance_present,
+                     _anjay_dm_installed_object_oid(obj_ptr));
+    int result = handler->instance_present(anjay, *obj_ptr, iid);
+    ANJAY_TRACEPOINT(dm_handler_exit, (int) ANJAY_DM_HANDLER_instance_present,
+                     _anjay_dm_installed_object_oid(obj_ptr), result);
+    if (result < 0) {
+        dm_log(DEBUG, _("instance_present failed with code ") "%d (%s)", result,
+               AVS_COAP_CODE_STRING(_anjay_make_error_response_code(result)));
+    }
+    return result;
+}
+
+static int call_instance_reset(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t *obj_ptr,
+                               anjay_iid_t iid) {
+    CHECKED_TAIL_CALL_HANDLER(obj_ptr, instance_reset, anjay, *obj_ptr, iid);
+}
+
 int _anjay_dm_call_instance_reset(anjay_unlocked_t *anjay,
                                   const anjay_dm_installed_object_t *obj_ptr,
                                   anjay_iid_t iid) {
     dm_log(TRACE, _("instance_reset ") "/%u/%u",
            _anjay_dm_installed_object_oid(obj_ptr), iid);
     int result = _anjay_dm_transaction_include_object(anjay, obj_ptr);
-    if (result) {
-        return result;
+    if (!result) {
+        result = call_instance_reset(anjay, obj_ptr, iid);
     }
-    CHECKED_TAIL_CALL_HANDLER(obj_ptr, instance_reset, anjay, *obj_ptr, iid);
+    _anjay_dm_cache_invalidate_resources(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr));
+    _anjay_dm_cache_invalidate_values(anjay,
+                                      _anjay_dm_installed_object_oid(obj_ptr),
+                                      iid, ANJAY_ID_INVALID);
+    return result;
+}
+
+static int call_instance_create(anjay_unlocked_t *anjay,
+                                const anjay_dm_installed_object_t *obj_ptr,
+                                anjay_iid_t iid) {
+    CHECKED_TAIL_CALL_HANDLER(obj_ptr, instance_create, anjay, *obj_ptr, iid);
 }
 
 int _anjay_dm_call_instance_create(anjay_unlocked_t *anjay,
@@ -735,10 +854,22 @@ int _anjay_dm_call_instance_create(anjay_unlocked_t *anjay,
     dm_log(TRACE, _("instance_create ") "/%u/%u",
            _anjay_dm_installed_object_oid(obj_ptr), iid);
     int result = _anjay_dm_transaction_include_object(anjay, obj_ptr);
-    if (result) {
-        return result;
+    if (!result) {
+        result = call_instance_create(anjay, obj_ptr, iid);
     }
-    CHECKED_TAIL_CALL_HANDLER(obj_ptr, instance_create, anjay, *obj_ptr, iid);
+    _anjay_dm_cache_invalidate_instances(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr));
+    if (!result) {
+        _anjay_dm_cache_instance_created(
+                anjay, _anjay_dm_installed_object_oid(obj_ptr), iid);
+    }
+    return result;
+}
+
+static int call_instance_remove(anjay_unlocked_t *anjay,
+                                const anjay_dm_installed_object_t *obj_ptr,
+                                anjay_iid_t iid) {
+    CHECKED_TAIL_CALL_HANDLER(obj_ptr, instance_remove, anjay, *obj_ptr, iid);
 }
 
 int _anjay_dm_call_instance_remove(anjay_unlocked_t *anjay,
@@ -747,10 +878,16 @@ int _anjay_dm_call_instance_remove(anjay_unlocked_t *anjay,
     dm_log(TRACE, _("instance_remove ") "/%u/%u",
            _anjay_dm_installed_object_oid(obj_ptr), iid);
     int result = _anjay_dm_transaction_include_object(anjay, obj_ptr);
-    if (result) {
-        return result;
+    if (!result) {
+        result = call_instance_remove(anjay, obj_ptr, iid);
     }
-    CHECKED_TAIL_CALL_HANDLER(obj_ptr, instance_remove, anjay, *obj_ptr, iid);
+    _anjay_dm_cache_invalidate_instances(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr));
+    if (!result) {
+        _anjay_dm_cache_instance_removed(
+                anjay, _anjay_dm_installed_object_oid(obj_ptr), iid);
+    }
+    return result;
 }
 
 int _anjay_dm_call_instance_read_default_attrs(
@@ -800,6 +937,42 @@ int _anjay_dm_call_resource_read(anjay_unlocked_t *anjay,
                               riid, ctx);
 }
 
+int _anjay_dm_call_resource_read_many(
+        anjay_unlocked_t *anjay,
+        const anjay_dm_installed_object_t *obj_ptr,
+        anjay_iid_t iid,
+        const anjay_rid_t *rids,
+        size_t rid_count) {
+    dm_log(TRACE,
+           _("resource_read_many ") "/%u/%u" _(", ") "%lu" _(" Resources"),
+           _anjay_dm_installed_object_oid(obj_ptr), iid,
+           (unsigned long) rid_count);
+    CHECKED_TAIL_CALL_HANDLER(obj_ptr, resource_read_many, anjay, *obj_ptr, iid,
+                              rids, rid_count);
+}
+
+int _anjay_dm_call_resource_read_instances(
+        anjay_unlocked_t *anjay,
+        const anjay_dm_installed_object_t *obj_ptr,
+        anjay_iid_t iid,
+        anjay_rid_t rid,
+        anjay_dm_res_instances_t *out) {
+    dm_log(TRACE, _("resource_read_instances ") "/%u/%u/%u",
+           _anjay_dm_installed_object_oid(obj_ptr), iid, rid);
+    CHECKED_TAIL_CALL_HANDLER(obj_ptr, resource_read_instances, anjay,
+                              *obj_ptr, iid, rid, out);
+}
+
+static int call_resource_write(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t *obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               anjay_riid_t riid,
+                               anjay_unlocked_input_ctx_t *ctx) {
+    CHECKED_TAIL_CALL_HANDLER(obj_ptr, resource_write, anjay, *obj_ptr, iid,
+                              rid, riid, ctx);
+}
+
 int _anjay_dm_call_resource_write(anjay_unlocked_t *anjay,
                                   const anjay_dm_installed_object_t *obj_ptr,
                                   anjay_iid_t iid,
@@ -810,11 +983,15 @@ int _anjay_dm_call_resource_write(anjay_unlocked_t *anjay,
            ANJAY_DEBUG_MAKE_PATH(&MAKE_RESOURCE_INSTANCE_PATH(
                    _anjay_dm_installed_object_oid(obj_ptr), iid, rid, riid)));
     int result = _anjay_dm_transaction_include_object(anjay, obj_ptr);
-    if (result) {
-        return result;
+    if (!result) {
+        result = call_resource_write(anjay, obj_ptr, iid, rid, riid, ctx);
     }
-    CHECKED_TAIL_CALL_HANDLER(obj_ptr, resource_write, anjay, *obj_ptr, iid,
-                              rid, riid, ctx);
+    // writing may make an optional Resource present
+    _anjay_dm_cache_invalidate_resources(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr));
+    _anjay_dm_cache_invalidate_values(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr), iid, rid);
+    return result;
 }
 
 int _anjay_dm_call_resource_execute(anjay_unlocked_t *anjay,
@@ -828,6 +1005,14 @@ int _anjay_dm_call_resource_execute(anjay_unlocked_t *anjay,
                               rid, execute_ctx);
 }
 
+static int call_resource_reset(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t *obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid) {
+    CHECKED_TAIL_CALL_HANDLER(obj_ptr, resource_reset, anjay, *obj_ptr, iid,
+                              rid);
+}
+
 int _anjay_dm_call_resource_reset(anjay_unlocked_t *anjay,
                                   const anjay_dm_installed_object_t *obj_ptr,
                                   anjay_iid_t iid,
@@ -835,11 +1020,14 @@ int _anjay_dm_call_resource_reset(anjay_unlocked_t *anjay,
     dm_log(TRACE, _("resource_reset ") "/%u/%u/%u",
            _anjay_dm_installed_object_oid(obj_ptr), iid, rid);
     int result = _anjay_dm_transaction_include_object(anjay, obj_ptr);
-    if (result) {
-        return result;
+    if (!result) {
+        result = call_resource_reset(anjay, obj_ptr, iid, rid);
     }
-    CHECKED_TAIL_CALL_HANDLER(obj_ptr, resource_reset, anjay, *obj_ptr, iid,
-                              rid);
+    _anjay_dm_cache_invalidate_resources(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr));
+    _anjay_dm_cache_invalidate_values(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr), iid, rid);
+    return result;
 }
 
 int _anjay_dm_call_list_resource_instances(
@@ -939,11 +1127,23 @@ int _anjay_dm_call_transaction_commit(
     CHECKED_TAIL_CALL_HANDLER(obj_ptr, transaction_commit, anjay, *obj_ptr);
 }
 
+static int
+call_transaction_rollback(anjay_unlocked_t *anjay,
+                          const anjay_dm_installed_object_t *obj_ptr) {
+    CHECKED_TAIL_CALL_HANDLER(obj_ptr, transaction_rollback, anjay, *obj_ptr);
+}
+
 int _anjay_dm_call_transaction_rollback(
         anjay_unlocked_t *anjay, const anjay_dm_installed_object_t *obj_ptr) {
     dm_log(TRACE, _("rollback_object ") "/%u",
            _anjay_dm_installed_object_oid(obj_ptr));
-    CHECKED_TAIL_CALL_HANDLER(obj_ptr, transaction_rollback, anjay, *obj_ptr);
+    int result = call_transaction_rollback(anjay, obj_ptr);
+    // rollback may bring back removed Instances, or remove created ones
+    _anjay_dm_cache_invalidate_instances(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr));
+    _anjay_dm_cache_reset_free_iid_hint(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr));
+    return result;
 }
 
 #define MAX_SANE_TRANSACTION_DEPTH 64
@@ -961,37 +1161,106 @@ avs_error_t _anjay_dm_transaction_begin(anjay_unlocked_t *anjay) {
     return err;
 }
 
+/**
+ * Returns the index entry of @p obj_ptr, or NULL if it is not installed in the
+ * root data model, i.e. if it is an Object of an LwM2M Gateway End Device.
+ */
+static anjay_dm_object_index_entry_t *
+find_index_entry(anjay_unlocked_t *anjay,
+                 const anjay_dm_installed_object_t *obj_ptr) {
+    anjay_dm_object_index_entry_t *entry = _anjay_dm_find_object_index_entry(
+            anjay, _anjay_dm_installed_object_oid(obj_ptr));
+#ifdef ANJAY_WITH_MODULE_LWM2M_GATEWAY
+    if (!entry || entry->obj != obj_ptr) {
+        return NULL;
+    }
+#endif // ANJAY_WITH_MODULE_LWM2M_GATEWAY
+    assert(entry && entry->obj == obj_ptr);
+    return entry;
+}
+
+static bool
+is_transaction_participant(const anjay_transaction_state_t *transaction,
+                           const anjay_dm_installed_object_t *obj_ptr) {
+    for (size_t i = 0; i < transaction->objs_in_transaction_count; ++i) {
+        if (transaction->objs_in_transaction[i] == obj_ptr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int add_transaction_participant(
+        anjay_transaction_state_t *transaction,
+        const anjay_dm_installed_object_t *obj_ptr) {
+    if (transaction->objs_in_transaction_count
+            >= transaction->objs_in_transaction_capacity) {
+        size_t new_capacity = 2 * transaction->objs_in_transaction_capacity;
+        if (!new_capacity) {
+            new_capacity = 8;
+        }
+        const anjay_dm_installed_object_t **new_array =
+                (const anjay_dm_installed_object_t **) avs_realloc(
+                        transaction->objs_in_transaction,
+                        new_capacity * sizeof(*new_array));
+        if (!new_array) {
+            _anjay_log_oom();
+            return -1;
+        }
+        transaction->objs_in_transaction = new_array;
+        transaction->objs_in_transaction_capacity = new_capacity;
+    }
+    transaction->objs_in_transaction
+            [transaction->objs_in_transaction_count++] = obj_ptr;
+    return 0;
+}
+
+static void remove_transaction_participant(
+        anjay_transaction_state_t *transaction,
+        const anjay_dm_installed_object_t *obj_ptr) {
+    // entries are only ever appended, so the most recent ones are at the end
+    size_t i = transaction->objs_in_transaction_count;
+    while (i-- > 0) {
+        if (transaction->objs_in_transaction[i] == obj_ptr) {
+            --transaction->objs_in_transaction_count;
+            memmove(&transaction->objs_in_transaction[i],
+                    &transaction->objs_in_transaction[i + 1],
+                    (transaction->objs_in_transaction_count - i)
+                            * sizeof(*transaction->objs_in_transaction));
+            return;
+        }
+    }
+}
+
 int _anjay_dm_transaction_include_object(
         anjay_unlocked_t *anjay, const anjay_dm_installed_object_t *obj_ptr) {
     dm_log(TRACE, _("transaction_include_object ") "/%u",
            _anjay_dm_installed_object_oid(obj_ptr));
     assert(anjay->transaction_state.depth > 0);
-    AVS_LIST(const anjay_dm_installed_object_t *) *it;
-    AVS_LIST_FOREACH_PTR(it, &anjay->transaction_state.objs_in_transaction) {
-        if (**it >= obj_ptr) {
-            break;
-        }
+    anjay_dm_object_index_entry_t *entry = find_index_entry(anjay, obj_ptr);
+    // End Device Objects are not indexed, but there are few participants
+    // in transactions that involve them
+    if (entry ? entry->in_transaction
+              : is_transaction_participant(&anjay->transaction_state,
+                                           obj_ptr)) {
+        return 0;
     }
-    if (!*it || **it != obj_ptr) {
-        AVS_LIST(const anjay_dm_installed_object_t *) new_entry =
-                AVS_LIST_NEW_ELEMENT(const anjay_dm_installed_object_t *);
-        if (!new_entry) {
-            _anjay_log_oom();
-            return -1;
-        }
-        *new_entry = obj_ptr;
-        AVS_LIST_INSERT(it, new_entry);
-        int result = _anjay_dm_call_transaction_begin(anjay, obj_ptr);
-        if (result) {
-            // transaction_begin may have added new entries
-            while (*it != new_entry) {
-                AVS_LIST_ADVANCE_PTR(&it);
-            }
-            AVS_LIST_DELETE(it);
-            return result;
+    if (add_transaction_participant(&anjay->transaction_state, obj_ptr)) {
+        return -1;
+    }
+    if (entry) {
+        entry->in_transaction = true;
+    }
+    int result = _anjay_dm_call_transaction_begin(anjay, obj_ptr);
+    if (result) {
+        // transaction_begin may have added new entries, or even registered
+        // Objects, which invalidates the index entry pointer
+        remove_transaction_participant(&anjay->transaction_state, obj_ptr);
+        if ((entry = find_index_entry(anjay, obj_ptr))) {
+            entry->in_transaction = false;
         }
     }
-    return 0;
+    return result;
 }
 
 static int commit_or_rollback_object(anjay_unlocked_t *anjay,
@@ -1014,16 +1283,127 @@ static int commit_or_rollback_object(anjay_unlocked_t *anjay,
     return predicate;
 }
 
+#ifdef ANJAY_WITH_THREAD_SAFETY
+typedef struct {
+    anjay_t *anjay_locked;
+    const anjay_dm_installed_object_t *const *objs;
+    // indices into objs of the objects validated by the executor
+    const size_t *job_indices;
+    int *results;
+} parallel_validation_t;
+
+static bool
+validates_in_parallel(const anjay_dm_installed_object_t *obj_ptr) {
+    return obj_ptr->type == ANJAY_DM_OBJECT_USER_PROVIDED
+           && _anjay_dm_handler_implemented(
+                      obj_ptr, ANJAY_DM_HANDLER_transaction_validate);
+}
+
+static void parallel_validation_job(void *validation_, size_t index) {
+    parallel_validation_t *validation = (parallel_validation_t *) validation_;
+    size_t obj_index = validation->job_indices[index];
+    const anjay_dm_installed_object_t *obj = validation->objs[obj_index];
+    ANJAY_TRACEPOINT(dm_handler_enter,
+                     (int) ANJAY_DM_HANDLER_transaction_validate,
+                     _anjay_dm_installed_object_oid(obj));
+    validation->results[obj_index] =
+            (*obj->impl.user_provided)
+                    ->handlers.transaction_validate(validation->anjay_locked,
+                                                    obj->impl.user_provided);
+    ANJAY_TRACEPOINT(dm_handler_exit,
+                     (int) ANJAY_DM_HANDLER_transaction_validate,
+                     _anjay_dm_installed_object_oid(obj),
+                     validation->results[obj_index]);
+}
+
+/**
+ * Validates all objects in the transaction, dispatching the user-provided
+ * transaction_validate handlers to the configured executor. Returns false,
+ * without calling any handlers, if sequential validation shall be used
+ * instead.
+ */
+static bool
+transaction_validate_parallel(anjay_unlocked_t *anjay, int *out_result) {
+    const anjay_transaction_state_t *transaction = &anjay->transaction_state;
+    const size_t count = transaction->objs_in_transaction_count;
+    size_t jobs_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (validates_in_parallel(transaction->objs_in_transaction[i])) {
+            ++jobs_count;
+        }
+    }
+    if (!anjay->transaction_validate_executor || jobs_count < 2) {
+        return false;
+    }
+    int *results = (int *) avs_calloc(count, sizeof(int));
+    size_t *job_indices = (size_t *) avs_calloc(jobs_count, sizeof(size_t));
+    if (!results || !job_indices) {
+        avs_free(results);
+        avs_free(job_indices);
+        return false;
+    }
+
+    jobs_count = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const anjay_dm_installed_object_t *obj =
+                transaction->objs_in_transaction[i];
+        if (validates_in_parallel(obj)) {
+            job_indices[jobs_count++] = i;
+        } else {
+            dm_log(TRACE, _("validate_object ") "/%u",
+                   _anjay_dm_installed_object_oid(obj));
+            results[i] = _anjay_dm_call_transaction_validate(anjay, obj);
+        }
+    }
+
+    dm_log(TRACE, _("validating ") "%u" _(" objects in parallel"),
+           (unsigned) jobs_count);
+    anjay_parallel_executor_t *executor = anjay->transaction_validate_executor;
+    void *executor_arg = anjay->transaction_validate_executor_arg;
+    ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
+    parallel_validation_t validation = {
+        .anjay_locked = anjay_locked,
+        .objs = transaction->objs_in_transaction,
+        .job_indices = job_indices,
+        .results = results
+    };
+    executor(executor_arg, jobs_count, parallel_validation_job, &validation);
+    ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
+
+    *out_result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (results[i]) {
+            dm_log(ERROR, _("Validation failed for ") "/%u",
+                   _anjay_dm_installed_object_oid(
+                           transaction->objs_in_transaction[i]));
+            *out_result = results[i];
+            break;
+        }
+    }
+    avs_free(results);
+    avs_free(job_indices);
+    return true;
+}
+#endif // ANJAY_WITH_THREAD_SAFETY
+
 int _anjay_dm_transaction_validate(anjay_unlocked_t *anjay) {
     dm_log(TRACE, _("transaction_validate"));
-    AVS_LIST(const anjay_dm_installed_object_t *) obj;
-    AVS_LIST_FOREACH(obj, anjay->transaction_state.objs_in_transaction) {
+#ifdef ANJAY_WITH_THREAD_SAFETY
+    int parallel_result;
+    if (transaction_validate_parallel(anjay, &parallel_result)) {
+        return parallel_result;
+    }
+#endif // ANJAY_WITH_THREAD_SAFETY
+    const anjay_transaction_state_t *transaction = &anjay->transaction_state;
+    for (size_t i = 0; i < transaction->objs_in_transaction_count; ++i) {
+        const anjay_dm_installed_object_t *obj =
+                transaction->objs_in_transaction[i];
         dm_log(TRACE, _("validate_object ") "/%u",
-               _anjay_dm_installed_object_oid(*obj));
-        int result = _anjay_dm_call_transaction_validate(anjay, *obj);
+               _anjay_dm_installed_object_oid(obj));
+        int result = _anjay_dm_call_transaction_validate(anjay, obj);
         if (result) {
             dm_log(ERROR, _("Validation failed for ") "/%u",
-                   _anjay_dm_installed_object_oid(*obj));
+                   _anjay_dm_installed_object_oid(obj));
             return result;
         }
     }
@@ -1038,13 +1418,20 @@ int _anjay_dm_transaction_finish_without_validation(anjay_unlocked_t *anjay,
         return result;
     }
     int final_result = result;
-    AVS_LIST_CLEAR(&anjay->transaction_state.objs_in_transaction) {
-        int commit_result = commit_or_rollback_object(
-                anjay, *anjay->transaction_state.objs_in_transaction, result);
+    anjay_transaction_state_t *transaction = &anjay->transaction_state;
+    for (size_t i = 0; i < transaction->objs_in_transaction_count; ++i) {
+        const anjay_dm_installed_object_t *obj =
+                transaction->objs_in_transaction[i];
+        int commit_result = commit_or_rollback_object(anjay, obj, result);
         if (!final_result && commit_result) {
             final_result = commit_result;
         }
+        anjay_dm_object_index_entry_t *entry = find_index_entry(anjay, obj);
+        if (entry) {
+            entry->in_transaction = false;
+        }
     }
+    transaction->objs_in_transaction_count = 0;
 #ifdef ANJAY_WITH_ATTR_STORAGE
     if (!final_result) {
         _anjay_attr_storage_transaction_commit(anjay);
@@ -1065,15 +1452,10 @@ int _anjay_dm_transaction_finish(anjay_unlocked_t *anjay, int result) {
 bool _anjay_dm_transaction_object_included(
         anjay_unlocked_t *anjay, const anjay_dm_installed_object_t *obj_ptr) {
     if (anjay->transaction_state.depth > 0) {
-        AVS_LIST(const anjay_dm_installed_object_t *) *it;
-        AVS_LIST_FOREACH_PTR(it,
-                             &anjay->transaction_state.objs_in_transaction) {
-            if (**it == obj_ptr) {
-                return true;
-            } else if (**it > obj_ptr) {
-                break;
-            }
-        }
+        const anjay_dm_object_index_entry_t *entry =
+                _anjay_dm_find_object_index_entry(
+                        anjay, _anjay_dm_installed_object_oid(obj_ptr));
+        return entry && entry->obj == obj_ptr && entry->in_transaction;
     }
     return false;
 }
@@ -9,14 +9,19 @@
 
 #include <anjay_init.h>
 
+#include <inttypes.h>
+
 #include <avsystem/coap/code.h>
 
+#include <avsystem/commons/avs_memory.h>
 #include <avsystem/commons/avs_stream_membuf.h>
 
 #include "anjay_dm_read.h"
 
 #include "../anjay_access_utils_private.h"
+#include "../anjay_core.h"
 #include "../coap/anjay_content_format.h"
+#include "../io/anjay_batch_builder.h"
 #include "../io/anjay_vtable.h"
 
 VISIBILITY_SOURCE_BEGIN
@@ -85,24 +90,94 @@ static int read_resource_instance_clb(anjay_unlocked_t *anjay,
     return result;
 }
 
+static int ret_res_instance_value(anjay_unlocked_output_ctx_t *out_ctx,
+                                  const anjay_dm_res_instances_t *instances,
+                                  size_t index) {
+    switch (instances->type) {
+    case ANJAY_DM_RES_INSTANCES_INT:
+        return _anjay_ret_i64_unlocked(out_ctx,
+                                       instances->values.as_int[index]);
+#ifdef ANJAY_WITH_LWM2M11
+    case ANJAY_DM_RES_INSTANCES_UINT:
+        return _anjay_ret_u64_unlocked(out_ctx,
+                                       instances->values.as_uint[index]);
+#endif // ANJAY_WITH_LWM2M11
+    case ANJAY_DM_RES_INSTANCES_DOUBLE:
+        return _anjay_ret_double_unlocked(out_ctx,
+                                          instances->values.as_double[index]);
+    case ANJAY_DM_RES_INSTANCES_BOOL:
+        return _anjay_ret_bool_unlocked(out_ctx,
+                                        instances->values.as_bool[index]);
+    }
+    dm_log(ERROR, _("invalid Resource Instance value type: ") "%d",
+           (int) instances->type);
+    return ANJAY_ERR_INTERNAL;
+}
+
+static int output_res_instances(const anjay_dm_installed_object_t *obj,
+                                anjay_iid_t iid,
+                                anjay_rid_t rid,
+                                const anjay_dm_res_instances_t *instances,
+                                anjay_unlocked_output_ctx_t *out_ctx) {
+    if (instances->count && !instances->riids) {
+        dm_log(ERROR, _("resource_read_instances returned no Resource "
+                        "Instance IDs for ") "/%u/%u/%u",
+               _anjay_dm_installed_object_oid(obj), iid, rid);
+        return ANJAY_ERR_INTERNAL;
+    }
+    int32_t last_riid = -1;
+    int result = 0;
+    for (size_t i = 0; !result && i < instances->count; ++i) {
+        const anjay_riid_t riid = instances->riids[i];
+        if (riid == ANJAY_ID_INVALID || (int32_t) riid <= last_riid) {
+            dm_log(ERROR,
+                   _("resource_read_instances MUST return valid Resource "
+                     "Instance IDs in strictly ascending order; ") "%" PRIu16
+                           _(" returned after ") "%" PRId32,
+                   riid, last_riid);
+            return ANJAY_ERR_INTERNAL;
+        }
+        last_riid = riid;
+        (void) ((result = _anjay_output_set_path(
+                         out_ctx, &MAKE_RESOURCE_INSTANCE_PATH(
+                                          _anjay_dm_installed_object_oid(obj),
+                                          iid, rid, riid)))
+                || (result = ret_res_instance_value(out_ctx, instances, i)));
+    }
+    return result;
+}
+
 static int read_multiple_resource(anjay_unlocked_t *anjay,
                                   const anjay_dm_installed_object_t *obj,
                                   anjay_iid_t iid,
                                   anjay_rid_t rid,
                                   anjay_unlocked_output_ctx_t *out_ctx) {
     int result;
-    (void) ((result = _anjay_output_set_path(
-                     out_ctx,
-                     &MAKE_RESOURCE_PATH(_anjay_dm_installed_object_oid(obj),
-                                         iid, rid)))
-            || (result = _anjay_output_start_aggregate(out_ctx))
-            || (result = _anjay_dm_foreach_resource_instance(
-                        anjay, obj, iid, rid, read_resource_instance_clb,
-                        out_ctx)));
-    return result;
+    if ((result = _anjay_output_set_path(
+                 out_ctx,
+                 &MAKE_RESOURCE_PATH(_anjay_dm_installed_object_oid(obj), iid,
+                                     rid)))
+            || (result = _anjay_output_start_aggregate(out_ctx))) {
+        return result;
+    }
+    if (_anjay_dm_handler_implemented(
+                obj, ANJAY_DM_HANDLER_resource_read_instances)) {
+        anjay_dm_res_instances_t instances = {
+            .count = 0
+        };
+        result = _anjay_dm_call_resource_read_instances(anjay, obj, iid, rid,
+                                                        &instances);
+        if (result != ANJAY_ERR_NOT_IMPLEMENTED) {
+            return result ? result
+                          : output_res_instances(obj, iid, rid, &instances,
+                                                 out_ctx);
+        }
+    }
+    return _anjay_dm_foreach_resource_instance(
+            anjay, obj, iid, rid, read_resource_instance_clb, out_ctx);
 }
 
-static int read_resource_internal(anjay_unlocked_t *anjay,
+static int read_resource_uncached(anjay_unlocked_t *anjay,
                                   const anjay_dm_installed_object_t *obj,
                                   anjay_iid_t iid,
                                   anjay_rid_t rid,
@@ -122,6 +197,99 @@ static int read_resource_internal(anjay_unlocked_t *anjay,
     }
 }
 
+#if defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+typedef struct {
+    const anjay_dm_installed_object_t *obj;
+    anjay_iid_t iid;
+    anjay_rid_t rid;
+    anjay_dm_resource_kind_t kind;
+} read_resource_uncached_args_t;
+
+static int read_resource_uncached_clb(anjay_unlocked_t *anjay,
+                                      anjay_unlocked_output_ctx_t *out_ctx,
+                                      void *args_) {
+    const read_resource_uncached_args_t *args =
+            (const read_resource_uncached_args_t *) args_;
+    return read_resource_uncached(anjay, args->obj, args->iid, args->rid,
+                                  args->kind, out_ctx);
+}
+
+static int read_resource_cached(anjay_unlocked_t *anjay,
+                                const anjay_dm_value_cache_t *cache,
+                                const anjay_dm_installed_object_t *obj,
+                                anjay_iid_t iid,
+                                anjay_rid_t rid,
+                                anjay_dm_resource_kind_t kind,
+                                anjay_unlocked_output_ctx_t *out_ctx) {
+    const anjay_uri_path_t path =
+            MAKE_RESOURCE_PATH(_anjay_dm_installed_object_oid(obj), iid, rid);
+    const anjay_batch_t *cached_batch = _anjay_dm_value_cache_get(cache, iid);
+    anjay_batch_t *batch = NULL;
+    int result = 0;
+    if (cached_batch) {
+        batch = _anjay_batch_acquire(cached_batch);
+    } else {
+        // NOTE: cache may be freed while the mutex is released for the sake
+        // of calling the resource_read handler, so it is not used below
+        const uint32_t generation = cache->generation;
+        anjay_batch_builder_t *builder = _anjay_batch_builder_new();
+        if (!builder) {
+            _anjay_log_oom();
+            return ANJAY_ERR_INTERNAL;
+        }
+        // timestamps are assigned by whoever consumes the value later
+        result = _anjay_batch_builder_read(
+                builder, anjay, &path, &AVS_TIME_REAL_INVALID,
+                read_resource_uncached_clb,
+                &(read_resource_uncached_args_t) {
+                    .obj = obj,
+                    .iid = iid,
+                    .rid = rid,
+                    .kind = kind
+                });
+        if (!result && !(batch = _anjay_batch_builder_compile(&builder))) {
+            _anjay_log_oom();
+            result = ANJAY_ERR_INTERNAL;
+        }
+        _anjay_batch_builder_cleanup(&builder);
+        if (result) {
+            // callers expect the path to be set when the handler fails, so
+            // that they can clear it and skip the Resource
+            int set_path_result = _anjay_output_set_path(out_ctx, &path);
+            return set_path_result ? set_path_result : result;
+        }
+        _anjay_dm_value_cache_store(anjay, path.ids[ANJAY_ID_OID], iid, rid,
+                                    generation, batch);
+    }
+    // NOTE: Access Control permissions have already been checked by the
+    // caller, so we're "spoofing" ANJAY_SSID_BOOTSTRAP
+    result = _anjay_batch_data_output(anjay, batch, ANJAY_SSID_BOOTSTRAP,
+                                      out_ctx);
+    _anjay_batch_release(&batch);
+    return result;
+}
+#endif // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+
+static int read_resource_internal(anjay_unlocked_t *anjay,
+                                  const anjay_dm_installed_object_t *obj,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  anjay_dm_resource_kind_t kind,
+                                  anjay_unlocked_output_ctx_t *out_ctx) {
+#if defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+    const anjay_dm_value_cache_t *cache =
+            _anjay_dm_is_root_object(anjay, obj)
+                    ? _anjay_dm_value_cache_find(
+                              anjay, _anjay_dm_installed_object_oid(obj), rid)
+                    : NULL;
+    if (cache) {
+        return read_resource_cached(anjay, cache, obj, iid, rid, kind,
+                                    out_ctx);
+    }
+#endif // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+    return read_resource_uncached(anjay, obj, iid, rid, kind, out_ctx);
+}
+
 static int read_resource(anjay_unlocked_t *anjay,
                          const anjay_dm_installed_object_t *obj,
                          anjay_iid_t iid,
@@ -136,6 +304,16 @@ static int read_resource(anjay_unlocked_t *anjay,
     return read_resource_internal(anjay, obj, iid, rid, kind, out_ctx);
 }
 
+static bool resource_read_allowed(anjay_dm_resource_kind_t kind,
+                                  anjay_ssid_t requesting_ssid) {
+    bool read_allowed = _anjay_dm_res_kind_readable(kind);
+    if (!read_allowed && requesting_ssid == ANJAY_SSID_BOOTSTRAP) {
+        read_allowed = _anjay_dm_res_kind_bootstrappable(kind)
+                       || _anjay_dm_res_kind_writable(kind);
+    }
+    return read_allowed;
+}
+
 typedef struct {
     anjay_unlocked_output_ctx_t *out_ctx;
     anjay_ssid_t requesting_ssid;
@@ -155,12 +333,7 @@ static int read_instance_resource_clb(anjay_unlocked_t *anjay,
                _anjay_dm_installed_object_oid(obj), iid, rid);
         return 0;
     }
-    bool read_allowed = _anjay_dm_res_kind_readable(kind);
-    if (!read_allowed && args->requesting_ssid == ANJAY_SSID_BOOTSTRAP) {
-        read_allowed = _anjay_dm_res_kind_bootstrappable(kind)
-                       || _anjay_dm_res_kind_writable(kind);
-    }
-    if (!read_allowed) {
+    if (!resource_read_allowed(kind, args->requesting_ssid)) {
         dm_log(DEBUG, "/%u/%u/%u" _(" is not readable, skipping"),
                _anjay_dm_installed_object_oid(obj), iid, rid);
         return 0;
@@ -179,24 +352,120 @@ static int read_instance_resource_clb(anjay_unlocked_t *anjay,
     return result;
 }
 
+typedef struct {
+    anjay_rid_t rid;
+    anjay_dm_resource_kind_t kind;
+    anjay_dm_resource_presence_t presence;
+} resource_entry_t;
+
+typedef struct {
+    resource_entry_t *entries;
+    size_t count;
+    size_t capacity;
+} resource_entry_array_t;
+
+static int gather_resource_clb(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t *obj,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               anjay_dm_resource_kind_t kind,
+                               anjay_dm_resource_presence_t presence,
+                               void *array_) {
+    (void) obj;
+    (void) iid;
+    resource_entry_array_t *array = (resource_entry_array_t *) array_;
+    if (array->count == array->capacity) {
+        size_t new_capacity = array->capacity ? 2 * array->capacity : 16;
+        resource_entry_t *new_entries =
+                (resource_entry_t *) _anjay_arena_realloc(
+                        &anjay->request_arena, array->entries,
+                        new_capacity * sizeof(*new_entries));
+        if (!new_entries) {
+            _anjay_log_oom();
+            return -1;
+        }
+        array->entries = new_entries;
+        array->capacity = new_capacity;
+    }
+    array->entries[array->count++] = (resource_entry_t) {
+        .rid = rid,
+        .kind = kind,
+        .presence = presence
+    };
+    return 0;
+}
+
+/**
+ * Variant of reading all Resources of an Instance used for Objects that
+ * implement the resource_read_many handler: the Resource list is gathered
+ * first, so that all the readable Resource IDs can be announced to the handler
+ * before the first resource_read call.
+ */
+static int read_instance_resources_batched(
+        anjay_unlocked_t *anjay,
+        const anjay_dm_installed_object_t *obj,
+        anjay_iid_t iid,
+        read_instance_resource_clb_args_t *args) {
+    resource_entry_array_t array = { NULL, 0, 0 };
+    anjay_rid_t *rids = NULL;
+    int result = _anjay_dm_foreach_resource(anjay, obj, iid,
+                                            gather_resource_clb, &array);
+    if (!result && array.count
+            && !(rids = (anjay_rid_t *) _anjay_arena_alloc(
+                         &anjay->request_arena,
+                         array.count * sizeof(*rids)))) {
+        _anjay_log_oom();
+        result = -1;
+    }
+    if (!result) {
+        size_t rid_count = 0;
+        for (size_t i = 0; i < array.count; ++i) {
+            if (array.entries[i].presence == ANJAY_DM_RES_PRESENT
+                    && resource_read_allowed(array.entries[i].kind,
+                                             args->requesting_ssid)) {
+                rids[rid_count++] = array.entries[i].rid;
+            }
+        }
+        if (rid_count) {
+            result = _anjay_dm_call_resource_read_many(anjay, obj, iid, rids,
+                                                       rid_count);
+        }
+    }
+    for (size_t i = 0; !result && i < array.count; ++i) {
+        result = read_instance_resource_clb(
+                anjay, obj, iid, array.entries[i].rid, array.entries[i].kind,
+                array.entries[i].presence, args);
+    }
+    // freed in reverse order, so that the arena space is reclaimed right away
+    _anjay_arena_free(&anjay->request_arena, rids);
+    _anjay_arena_free(&anjay->request_arena, array.entries);
+    return result;
+}
+
 static int read_instance(anjay_unlocked_t *anjay,
                          const anjay_dm_installed_object_t *obj,
                          anjay_iid_t iid,
                          anjay_ssid_t requesting_ssid,
                          anjay_unlocked_output_ctx_t *out_ctx) {
+    read_instance_resource_clb_args_t args = {
+        .out_ctx = out_ctx,
+        .requesting_ssid = requesting_ssid
+    };
     int result;
     (void) ((result = _anjay_output_set_path(
                      out_ctx,
                      &MAKE_INSTANCE_PATH(_anjay_dm_installed_object_oid(obj),
                                          iid)))
-            || (result = _anjay_output_start_aggregate(out_ctx))
-            || (result = _anjay_dm_foreach_resource(
-                        anjay, obj, iid, read_instance_resource_clb,
-                        &(read_instance_resource_clb_args_t) {
-                            .out_ctx = out_ctx,
-                            .requesting_ssid = requesting_ssid
-                        })));
-    return result;
+            || (result = _anjay_output_start_aggregate(out_ctx)));
+    if (result) {
+        return result;
+    }
+    if (_anjay_dm_handler_implemented(obj,
+                                      ANJAY_DM_HANDLER_resource_read_many)) {
+        return read_instance_resources_batched(anjay, obj, iid, &args);
+    }
+    return _anjay_dm_foreach_resource(anjay, obj, iid,
+                                      read_instance_resource_clb, &args);
 }
 
 typedef struct {
@@ -216,7 +485,7 @@ static int read_instance_clb(anjay_unlocked_t *anjay,
         .ssid = args->requesting_ssid,
         .action = ANJAY_ACTION_READ
     };
-    if (!_anjay_instance_action_allowed(anjay, &info)) {
+    if (!_anjay_object_instance_action_allowed(anjay, obj, &info)) {
         return ANJAY_FOREACH_CONTINUE;
     }
     return read_instance(anjay, obj, iid, args->requesting_ssid, args->out_ctx);
@@ -278,7 +547,8 @@ int _anjay_dm_read(anjay_unlocked_t *anjay,
             .ssid = requesting_ssid,
             .action = ANJAY_ACTION_READ
         };
-        if (!_anjay_instance_action_allowed(anjay, &action_info)) {
+        if (!_anjay_object_instance_action_allowed(anjay, obj,
+                                                   &action_info)) {
             return ANJAY_ERR_UNAUTHORIZED;
         }
     }
@@ -351,6 +621,196 @@ _anjay_dm_response_details_for_read(anjay_unlocked_t *anjay,
     };
 }
 
+/**
+ * Destination of a Read response payload: the CoAP response stream of
+ * <c>request</c>, or <c>membuf</c> if the response is generated for the Read
+ * response cache. In the latter case, the Content-Format is stored in
+ * <c>format</c>.
+ */
+typedef struct {
+    const anjay_request_t *request;
+    avs_stream_t *membuf;
+    uint16_t format;
+} read_response_target_t;
+
+static avs_stream_t *
+setup_response_stream(anjay_connection_ref_t connection,
+                      const anjay_request_t *request,
+                      const anjay_msg_details_t *details) {
+#ifdef ANJAY_WITH_OPERATION_STATS
+    _anjay_operation_stats_record_format(_anjay_from_server(connection.server),
+                                         _anjay_server_ssid(connection.server),
+                                         details->format);
+#else  // ANJAY_WITH_OPERATION_STATS
+    (void) connection;
+#endif // ANJAY_WITH_OPERATION_STATS
+    return _anjay_coap_setup_response_stream(request->ctx, details);
+}
+
+static avs_stream_t *
+setup_read_response_stream(anjay_connection_ref_t connection,
+                           read_response_target_t *target,
+                           const anjay_msg_details_t *details) {
+    if (target->membuf) {
+        // format usage is recorded when the cached response is sent
+        target->format = details->format;
+        return target->membuf;
+    }
+    return setup_response_stream(connection, target->request, details);
+}
+
+#if defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+static int read_in_compact_format(anjay_connection_ref_t connection,
+                                  const anjay_dm_installed_object_t *obj,
+                                  const anjay_request_t *request,
+                                  const anjay_dm_path_info_t *path_info,
+                                  read_response_target_t *target) {
+    anjay_unlocked_t *anjay = _anjay_from_server(connection.server);
+    anjay_batch_builder_t *builder = _anjay_batch_builder_new();
+    if (!builder) {
+        _anjay_log_oom();
+        return ANJAY_ERR_INTERNAL;
+    }
+    // timestamps are not included in Read responses, so they are not recorded
+    anjay_batch_t *batch = NULL;
+    int result =
+            _anjay_dm_read_into_batch(builder, anjay, obj, path_info,
+                                      _anjay_server_ssid(connection.server),
+                                      &AVS_TIME_REAL_INVALID);
+    if (!result && !(batch = _anjay_batch_builder_compile(&builder))) {
+        _anjay_log_oom();
+        result = ANJAY_ERR_INTERNAL;
+    }
+    _anjay_batch_builder_cleanup(&builder);
+    if (result) {
+        return result;
+    }
+
+    const anjay_lwm2m_version_t lwm2m_version =
+            _anjay_server_registration_info(connection.server)->lwm2m_version;
+    anjay_msg_details_t details = _anjay_dm_response_details_for_read(
+            anjay, request, path_info->is_hierarchical, lwm2m_version);
+    details.format = _anjay_batch_smallest_format(
+            anjay, lwm2m_version, &request->uri, ANJAY_ACTION_READ, 1,
+            &(const anjay_batch_t *) { batch }, details.format);
+
+    anjay_unlocked_output_ctx_t *out_ctx = NULL;
+    avs_stream_t *response_stream =
+            setup_read_response_stream(connection, target, &details);
+    if (!response_stream) {
+        result = ANJAY_ERR_INTERNAL;
+    } else if (!(result = _anjay_output_dynamic_construct(
+                         &out_ctx, response_stream, &request->uri,
+                         details.format, NULL, ANJAY_ACTION_READ))) {
+        // NOTE: Access Control permissions have been checked while reading
+        // the data into the batch, so we're "spoofing" ANJAY_SSID_BOOTSTRAP
+        result = _anjay_batch_data_output(anjay, batch, ANJAY_SSID_BOOTSTRAP,
+                                          out_ctx);
+        result = _anjay_output_ctx_destroy_and_process_result(&out_ctx,
+                                                              result);
+    }
+    _anjay_batch_release(&batch);
+    return result;
+}
+#endif // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+
+static int read_uncached(anjay_connection_ref_t connection,
+                         const anjay_dm_installed_object_t *obj,
+                         const anjay_request_t *request,
+                         const anjay_dm_path_info_t *path_info,
+                         read_response_target_t *target) {
+    anjay_unlocked_t *anjay = _anjay_from_server(connection.server);
+#if defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+    if (anjay->prefer_compact_formats
+            && request->requested_format == AVS_COAP_FORMAT_NONE) {
+        return read_in_compact_format(connection, obj, request, path_info,
+                                      target);
+    }
+#endif // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+    const anjay_msg_details_t details = _anjay_dm_response_details_for_read(
+            anjay, request, path_info->is_hierarchical,
+            _anjay_server_registration_info(connection.server)->lwm2m_version);
+
+    avs_stream_t *response_stream =
+            setup_read_response_stream(connection, target, &details);
+    if (!response_stream) {
+        return ANJAY_ERR_INTERNAL;
+    }
+
+    anjay_unlocked_output_ctx_t *out_ctx = NULL;
+    int result;
+    if ((result = _anjay_output_dynamic_construct(&out_ctx, response_stream,
+                                                  &request->uri, details.format,
+                                                  NULL, ANJAY_ACTION_READ))) {
+        return result;
+    }
+    return _anjay_dm_read_and_destroy_ctx(anjay, obj, path_info,
+                                          _anjay_server_ssid(connection.server),
+                                          &out_ctx);
+}
+
+static int send_cached_read_response(anjay_connection_ref_t connection,
+                                     const anjay_request_t *request,
+                                     const anjay_dm_cached_read_t *cached) {
+    const anjay_msg_details_t details = {
+        .msg_code = _anjay_dm_make_success_response_code(request->action),
+        .format = cached->response_format
+    };
+    avs_stream_t *response_stream =
+            setup_response_stream(connection, request, &details);
+    if (!response_stream
+            || avs_is_err(avs_stream_write(response_stream, cached->payload,
+                                           cached->payload_size))) {
+        return ANJAY_ERR_INTERNAL;
+    }
+    return 0;
+}
+
+static int read_and_cache(anjay_connection_ref_t connection,
+                          const anjay_dm_installed_object_t *obj,
+                          const anjay_request_t *request,
+                          const anjay_dm_path_info_t *path_info,
+                          anjay_dm_read_cache_t *cache,
+                          anjay_ssid_t access_class,
+                          anjay_lwm2m_version_t lwm2m_version) {
+    anjay_unlocked_t *anjay = _anjay_from_server(connection.server);
+    const uint32_t generation = cache->generation;
+    read_response_target_t target = {
+        .request = request,
+        .membuf = avs_stream_membuf_create()
+    };
+    if (!target.membuf) {
+        _anjay_log_oom();
+        return ANJAY_ERR_INTERNAL;
+    }
+    anjay_dm_cached_read_t entry = {
+        .path = request->uri,
+        .requested_format = request->requested_format,
+        .ssid = access_class,
+        .lwm2m_version = lwm2m_version
+    };
+    int result = read_uncached(connection, obj, request, path_info, &target);
+    if (!result
+            && avs_is_err(avs_stream_membuf_take_ownership(
+                       target.membuf, &entry.payload, &entry.payload_size))) {
+        result = ANJAY_ERR_INTERNAL;
+    }
+    avs_stream_cleanup(&target.membuf);
+    if (!result) {
+        entry.response_format = target.format;
+        result = send_cached_read_response(connection, request, &entry);
+    }
+    if (result) {
+        avs_free(entry.payload);
+    } else {
+        // cache pointer is not reused, as the data model handlers might have
+        // changed the set of cached Objects
+        _anjay_dm_read_cache_store(anjay, _anjay_dm_installed_object_oid(obj),
+                                   generation, &entry);
+    }
+    return result;
+}
+
 int _anjay_dm_read_or_observe(anjay_connection_ref_t connection,
                               const anjay_dm_installed_object_t *obj,
                               const anjay_request_t *request) {
@@ -372,25 +832,36 @@ int _anjay_dm_read_or_observe(anjay_connection_ref_t connection,
     if (result) {
         return result;
     }
-    const anjay_msg_details_t details = _anjay_dm_response_details_for_read(
-            anjay, request, path_info.is_hierarchical,
-            _anjay_server_registration_info(connection.server)->lwm2m_version);
 
-    avs_stream_t *response_stream =
-            _anjay_coap_setup_response_stream(request->ctx, &details);
-    if (!response_stream) {
-        return ANJAY_ERR_INTERNAL;
+    anjay_dm_read_cache_t *cache =
+            _anjay_dm_is_root_object(anjay, obj)
+                    ? _anjay_dm_read_cache_find(
+                              anjay, _anjay_dm_installed_object_oid(obj))
+                    : NULL;
+    if (!cache) {
+        return read_uncached(connection, obj, request, &path_info,
+                             &(read_response_target_t) {
+                                 .request = request
+                             });
     }
 
-    anjay_unlocked_output_ctx_t *out_ctx = NULL;
-    if ((result = _anjay_output_dynamic_construct(&out_ctx, response_stream,
-                                                  &request->uri, details.format,
-                                                  NULL, ANJAY_ACTION_READ))) {
-        return result;
+    const anjay_ssid_t access_class =
+            _anjay_access_control_in_effect(anjay)
+                    ? _anjay_server_ssid(connection.server)
+                    : ANJAY_SSID_ANY;
+    const anjay_lwm2m_version_t lwm2m_version =
+            _anjay_server_registration_info(connection.server)->lwm2m_version;
+    const anjay_dm_cached_read_t *cached =
+            _anjay_dm_read_cache_get(cache, &request->uri,
+                                     request->requested_format, access_class,
+                                     lwm2m_version);
+    if (cached) {
+        dm_log(LAZY_DEBUG, _("Read ") "%s" _(" (cached)"),
+               ANJAY_DEBUG_MAKE_PATH(&request->uri));
+        return send_cached_read_response(connection, request, cached);
     }
-    return _anjay_dm_read_and_destroy_ctx(anjay, obj, &path_info,
-                                          _anjay_server_ssid(connection.server),
-                                          &out_ctx);
+    return read_and_cache(connection, obj, request, &path_info, cache,
+                          access_class, lwm2m_version);
 }
 
 int _anjay_dm_read_resource_into_ctx(anjay_unlocked_t *anjay,
@@ -557,6 +1028,58 @@ static int cache_all_paths(anjay_unlocked_input_ctx_t *in_ctx,
     return result;
 }
 
+/**
+ * Orders paths so that each one directly precedes all paths it contains, e.g.
+ * /3 < /3/0 < /3/0/1 < /3/1 < /4.
+ */
+static int composite_path_cmp(const void *left_, const void *right_,
+                              size_t size) {
+    assert(size == sizeof(anjay_uri_path_t));
+    (void) size;
+    const anjay_uri_path_t *left = (const anjay_uri_path_t *) left_;
+    const anjay_uri_path_t *right = (const anjay_uri_path_t *) right_;
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(left->ids); ++i) {
+        if (left->ids[i] == right->ids[i]) {
+            if (left->ids[i] == ANJAY_ID_INVALID) {
+                break;
+            }
+        } else if (left->ids[i] == ANJAY_ID_INVALID) {
+            return -1;
+        } else if (right->ids[i] == ANJAY_ID_INVALID) {
+            return 1;
+        } else {
+            return left->ids[i] < right->ids[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Turns the requested paths into a plan in which paths belonging to the same
+ * Object and Object Instance are adjacent, and no path is contained in another
+ * one, so that each value is read exactly once.
+ */
+static void plan_composite_read(AVS_LIST(anjay_uri_path_t) *paths) {
+    AVS_LIST_SORT(paths, composite_path_cmp);
+    if (!*paths) {
+        return;
+    }
+    AVS_LIST(anjay_uri_path_t) covering = *paths;
+    AVS_LIST(anjay_uri_path_t) *next_ptr = AVS_LIST_NEXT_PTR(paths);
+    while (*next_ptr) {
+        if (_anjay_uri_path_outside_base(*next_ptr, covering)) {
+            covering = *next_ptr;
+            AVS_LIST_ADVANCE_PTR(&next_ptr);
+        } else {
+            dm_log(DEBUG,
+                   "%s" _(" already covered by ") "%s" _(", ignoring it"),
+                   ANJAY_DEBUG_MAKE_PATH(*next_ptr),
+                   ANJAY_DEBUG_MAKE_PATH(covering));
+            AVS_LIST_DELETE(next_ptr);
+        }
+    }
+}
+
 int _anjay_dm_read_or_observe_composite(anjay_connection_ref_t connection,
                                         const anjay_request_t *request,
                                         anjay_unlocked_input_ctx_t *in_ctx) {
@@ -586,7 +1109,7 @@ int _anjay_dm_read_or_observe_composite(anjay_connection_ref_t connection,
                 _anjay_server_registration_info(connection.server)
                         ->lwm2m_version);
         avs_stream_t *response_stream =
-                _anjay_coap_setup_response_stream(request->ctx, &details);
+                setup_response_stream(connection, request, &details);
         if (!response_stream) {
             return ANJAY_ERR_INTERNAL;
         }
@@ -601,10 +1124,18 @@ int _anjay_dm_read_or_observe_composite(anjay_connection_ref_t connection,
             }
         }
 
+        plan_composite_read(&cached_paths);
+
         anjay_unlocked_output_ctx_t *out_ctx = NULL;
         (void) ((result = _anjay_output_dynamic_construct(
                          &out_ctx, response_stream, &root_path, details.format,
                          NULL, ANJAY_ACTION_READ_COMPOSITE)));
+        // The plan is sorted, so the Object lookup and the Instance presence
+        // check are only repeated when the target changes.
+        const anjay_dm_installed_object_t *obj = NULL;
+        anjay_oid_t obj_oid = ANJAY_ID_INVALID;
+        anjay_iid_t checked_iid = ANJAY_ID_INVALID;
+        int instance_result = 0;
         while (!result && cached_paths) {
             const anjay_uri_path_t path = *cached_paths;
             AVS_LIST_DELETE(&cached_paths);
@@ -612,25 +1143,39 @@ int _anjay_dm_read_or_observe_composite(anjay_connection_ref_t connection,
             dm_log(DEBUG, _("Read Composite ") "%s",
                    ANJAY_DEBUG_MAKE_PATH(&path));
 
-            const anjay_dm_installed_object_t *obj = NULL;
-            if (_anjay_uri_path_has(&path, ANJAY_ID_OID)) {
-                obj = _anjay_dm_find_object_by_oid(anjay,
-                                                   path.ids[ANJAY_ID_OID]);
-
-                if (!obj) {
-                    dm_log(DEBUG,
-                           _("Object not found: ") "%u" _(", ignoring it"),
-                           path.ids[ANJAY_ID_OID]);
+            if (path.ids[ANJAY_ID_OID] != obj_oid) {
+                obj_oid = path.ids[ANJAY_ID_OID];
+                checked_iid = ANJAY_ID_INVALID;
+                obj = _anjay_uri_path_has(&path, ANJAY_ID_OID)
+                              ? _anjay_dm_find_object_by_oid(anjay, obj_oid)
+                              : NULL;
+            }
+            if (_anjay_uri_path_has(&path, ANJAY_ID_OID) && !obj) {
+                dm_log(DEBUG, _("Object not found: ") "%u" _(", ignoring it"),
+                       path.ids[ANJAY_ID_OID]);
+                continue;
+            }
+            anjay_dm_path_info_t path_info;
+            if (_anjay_uri_path_has(&path, ANJAY_ID_IID)) {
+                if (path.ids[ANJAY_ID_IID] != checked_iid) {
+                    checked_iid = path.ids[ANJAY_ID_IID];
+                    instance_result = _anjay_dm_verify_instance_present(
+                            anjay, obj, checked_iid);
+                }
+                if (instance_result == ANJAY_ERR_NOT_FOUND) {
                     continue;
                 }
+                (void) ((result = instance_result)
+                        || (result = _anjay_dm_path_info_in_present_instance(
+                                    anjay, obj, &path, &path_info)));
+            } else {
+                result = _anjay_dm_path_info(anjay, obj, &path, &path_info);
+            }
+            if (!result) {
+                result = _anjay_dm_read(anjay, obj, &path_info,
+                                        _anjay_server_ssid(connection.server),
+                                        out_ctx);
             }
-            anjay_dm_path_info_t path_info;
-            (void) ((result =
-                             _anjay_dm_path_info(anjay, obj, &path, &path_info))
-                    || (result = _anjay_dm_read(anjay, obj, &path_info,
-                                                _anjay_server_ssid(
-                                                        connection.server),
-                                                out_ctx)));
             if (result
                     && avs_coap_code_is_client_error(
                                _anjay_make_error_response_code(result))) {
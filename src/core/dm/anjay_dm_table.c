@@ -0,0 +1,282 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <string.h>
+
+#include <avsystem/commons/avs_memory.h>
+
+#include <anjay/dm_table.h>
+
+#include "../anjay_dm_core.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+static inline const anjay_dm_table_object_t *
+get_table_obj(const anjay_dm_object_def_t *const *obj_ptr) {
+    assert(obj_ptr);
+    return AVS_CONTAINER_OF(obj_ptr, anjay_dm_table_object_t, def);
+}
+
+static inline anjay_dm_table_object_t *
+get_table_obj_mutable(const anjay_dm_object_def_t *const *obj_ptr) {
+    return (anjay_dm_table_object_t *) (intptr_t) get_table_obj(obj_ptr);
+}
+
+bool anjay_dm_table_instance_present(const anjay_dm_table_object_t *obj,
+                                     anjay_iid_t iid) {
+    assert(obj);
+    return iid < obj->instance_count
+           && (!obj->present_instances
+               || (obj->present_instances[iid / 32]
+                   & ((uint32_t) 1 << (iid % 32))));
+}
+
+int anjay_dm_table_instance_set_present(anjay_dm_table_object_t *obj,
+                                        anjay_iid_t iid,
+                                        bool present) {
+    assert(obj);
+    if (iid >= obj->instance_count || !obj->present_instances) {
+        return -1;
+    }
+    if (present) {
+        obj->present_instances[iid / 32] |= (uint32_t) 1 << (iid % 32);
+    } else {
+        obj->present_instances[iid / 32] &= ~((uint32_t) 1 << (iid % 32));
+    }
+    return 0;
+}
+
+static void *get_instance_storage(const anjay_dm_table_object_t *obj,
+                                  anjay_iid_t iid) {
+    assert(iid < obj->instance_count);
+    return (char *) obj->instances + (size_t) iid * obj->instance_size;
+}
+
+static void *get_instance(const anjay_dm_table_object_t *obj,
+                          anjay_iid_t iid) {
+    if (!anjay_dm_table_instance_present(obj, iid)) {
+        return NULL;
+    }
+    return get_instance_storage(obj, iid);
+}
+
+static const anjay_dm_table_resource_def_t *
+find_resource(const anjay_dm_table_object_t *obj, anjay_rid_t rid) {
+    size_t lower = 0;
+    size_t upper = obj->resource_count;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (obj->resources[middle].rid < rid) {
+            lower = middle + 1;
+        } else if (obj->resources[middle].rid > rid) {
+            upper = middle;
+        } else {
+            return &obj->resources[middle];
+        }
+    }
+    return NULL;
+}
+
+int anjay_dm_table_list_instances(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    const anjay_dm_table_object_t *obj = get_table_obj(obj_ptr);
+    if (!obj->present_instances) {
+        for (anjay_iid_t iid = 0; iid < obj->instance_count; ++iid) {
+            anjay_dm_emit(ctx, iid);
+        }
+        return 0;
+    }
+    const size_t words = ANJAY_DM_TABLE_BITMAP_SIZE(obj->instance_count);
+    for (size_t i = 0; i < words; ++i) {
+        // skip 32 absent Instances at once
+        for (uint32_t word = obj->present_instances[i]; word;
+             word &= word - 1) {
+            uint32_t bit = 0;
+            while (!(word & ((uint32_t) 1 << bit))) {
+                ++bit;
+            }
+            const size_t iid = i * 32 + bit;
+            if (iid >= obj->instance_count) {
+                break;
+            }
+            anjay_dm_emit(ctx, (anjay_iid_t) iid);
+        }
+    }
+    return 0;
+}
+
+int anjay_dm_table_instance_present_handler(
+        anjay_t *anjay, const anjay_dm_object_def_t *const *obj_ptr,
+        anjay_iid_t iid) {
+    (void) anjay;
+    return anjay_dm_table_instance_present(get_table_obj(obj_ptr), iid) ? 1
+                                                                        : 0;
+}
+
+int anjay_dm_table_instance_create(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *obj_ptr,
+                                   anjay_iid_t iid) {
+    (void) anjay;
+    anjay_dm_table_object_t *obj = get_table_obj_mutable(obj_ptr);
+    if (!obj->present_instances) {
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+    if (iid >= obj->instance_count) {
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+    assert(!anjay_dm_table_instance_present(obj, iid));
+    memset(get_instance_storage(obj, iid), 0, obj->instance_size);
+    return anjay_dm_table_instance_set_present(obj, iid, true)
+                   ? ANJAY_ERR_INTERNAL
+                   : 0;
+}
+
+int anjay_dm_table_instance_remove(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *obj_ptr,
+                                   anjay_iid_t iid) {
+    (void) anjay;
+    anjay_dm_table_object_t *obj = get_table_obj_mutable(obj_ptr);
+    if (!obj->present_instances) {
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+    if (!anjay_dm_table_instance_present(obj, iid)) {
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    return anjay_dm_table_instance_set_present(obj, iid, false)
+                   ? ANJAY_ERR_INTERNAL
+                   : 0;
+}
+
+int anjay_dm_table_instance_reset(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_iid_t iid) {
+    (void) anjay;
+    const anjay_dm_table_object_t *obj = get_table_obj(obj_ptr);
+    char *inst = (char *) get_instance(obj, iid);
+    if (!inst) {
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    for (size_t i = 0; i < obj->resource_count; ++i) {
+        const anjay_dm_table_resource_def_t *res = &obj->resources[i];
+        if (_anjay_dm_res_kind_writable(res->kind)) {
+            memset(inst + res->offset, 0, res->size);
+        }
+    }
+    return 0;
+}
+
+int anjay_dm_table_list_resources(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_iid_t iid,
+                                  anjay_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+    const anjay_dm_table_object_t *obj = get_table_obj(obj_ptr);
+    for (size_t i = 0; i < obj->resource_count; ++i) {
+        anjay_dm_emit_res(ctx, obj->resources[i].rid, obj->resources[i].kind,
+                          ANJAY_DM_RES_PRESENT);
+    }
+    return 0;
+}
+
+int anjay_dm_table_resource_read(anjay_t *anjay,
+                                 const anjay_dm_object_def_t *const *obj_ptr,
+                                 anjay_iid_t iid,
+                                 anjay_rid_t rid,
+                                 anjay_riid_t riid,
+                                 anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    (void) riid;
+    assert(riid == ANJAY_ID_INVALID);
+    const anjay_dm_table_object_t *obj = get_table_obj(obj_ptr);
+    const char *inst = (const char *) get_instance(obj, iid);
+    const anjay_dm_table_resource_def_t *res = find_resource(obj, rid);
+    if (!inst || !res) {
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    const void *storage = inst + res->offset;
+
+    switch (res->type) {
+    case ANJAY_DM_TABLE_BOOL:
+        return anjay_ret_bool(ctx, *(const bool *) storage);
+    case ANJAY_DM_TABLE_I32:
+        return anjay_ret_i32(ctx, *(const int32_t *) storage);
+    case ANJAY_DM_TABLE_I64:
+        return anjay_ret_i64(ctx, *(const int64_t *) storage);
+    case ANJAY_DM_TABLE_U32:
+        return anjay_ret_u32(ctx, *(const uint32_t *) storage);
+    case ANJAY_DM_TABLE_U64:
+        return anjay_ret_u64(ctx, *(const uint64_t *) storage);
+    case ANJAY_DM_TABLE_DOUBLE:
+        return anjay_ret_double(ctx, *(const double *) storage);
+    case ANJAY_DM_TABLE_STRING:
+        return anjay_ret_string(ctx, (const char *) storage);
+    }
+    return ANJAY_ERR_INTERNAL;
+}
+
+static int write_string(anjay_input_ctx_t *ctx,
+                        const anjay_dm_table_resource_def_t *res,
+                        char *storage) {
+    // read into a temporary buffer, so that the stored value is left intact
+    // if the new one does not fit
+    char *buf = (char *) avs_malloc(res->size);
+    if (!buf) {
+        _anjay_log_oom();
+        return ANJAY_ERR_INTERNAL;
+    }
+    int result = anjay_get_string(ctx, buf, res->size);
+    if (result == ANJAY_BUFFER_TOO_SHORT) {
+        result = ANJAY_ERR_BAD_REQUEST;
+    } else if (!result) {
+        memcpy(storage, buf, res->size);
+    }
+    avs_free(buf);
+    return result;
+}
+
+int anjay_dm_table_resource_write(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  anjay_riid_t riid,
+                                  anjay_input_ctx_t *ctx) {
+    (void) anjay;
+    (void) riid;
+    assert(riid == ANJAY_ID_INVALID);
+    const anjay_dm_table_object_t *obj = get_table_obj(obj_ptr);
+    char *inst = (char *) get_instance(obj, iid);
+    const anjay_dm_table_resource_def_t *res = find_resource(obj, rid);
+    if (!inst || !res) {
+        return ANJAY_ERR_NOT_FOUND;
+    }
+    void *storage = inst + res->offset;
+
+    switch (res->type) {
+    case ANJAY_DM_TABLE_BOOL:
+        return anjay_get_bool(ctx, (bool *) storage);
+    case ANJAY_DM_TABLE_I32:
+        return anjay_get_i32(ctx, (int32_t *) storage);
+    case ANJAY_DM_TABLE_I64:
+        return anjay_get_i64(ctx, (int64_t *) storage);
+    case ANJAY_DM_TABLE_U32:
+        return anjay_get_u32(ctx, (uint32_t *) storage);
+    case ANJAY_DM_TABLE_U64:
+        return anjay_get_u64(ctx, (uint64_t *) storage);
+    case ANJAY_DM_TABLE_DOUBLE:
+        return anjay_get_double(ctx, (double *) storage);
+    case ANJAY_DM_TABLE_STRING:
+        return write_string(ctx, res, (char *) storage);
+    }
+    return ANJAY_ERR_INTERNAL;
+}
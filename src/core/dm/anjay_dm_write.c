@@ -347,8 +347,8 @@ int _anjay_dm_write(anjay_unlocked_t *anjay,
     if (result) {
         return result;
     }
-    if (!_anjay_instance_action_allowed(anjay, &REQUEST_TO_ACTION_INFO(request,
-                                                                       ssid))) {
+    if (!_anjay_object_instance_action_allowed(
+                anjay, obj, &REQUEST_TO_ACTION_INFO(request, ssid))) {
         return ANJAY_ERR_UNAUTHORIZED;
     }
 
@@ -398,7 +398,8 @@ int _anjay_dm_write(anjay_unlocked_t *anjay,
             }
         }
     }
-    if (!result) {
+    // there are no observations nor caches for End Device Objects
+    if (!result && _anjay_dm_is_root_object(anjay, obj)) {
         result = _anjay_notify_perform(anjay, ssid, &notify_queue);
     }
     _anjay_notify_clear_queue(&notify_queue);
@@ -416,6 +417,8 @@ int _anjay_dm_write_composite(anjay_unlocked_t *anjay,
     }
 
     anjay_notify_queue_t notify_queue = NULL;
+    const anjay_dm_installed_object_t *obj = NULL;
+    anjay_iid_t verified_iid = ANJAY_ID_INVALID;
     anjay_uri_path_t path;
     bool is_array;
     int result;
@@ -427,18 +430,26 @@ int _anjay_dm_write_composite(anjay_unlocked_t *anjay,
             result = ANJAY_ERR_BAD_REQUEST;
             goto finish;
         }
-        const anjay_dm_installed_object_t *obj =
-                _anjay_dm_find_object_by_oid(anjay, path.ids[ANJAY_ID_OID]);
-
-        if (!obj) {
-            dm_log(DEBUG, _("Object not found: ") "%u", path.ids[ANJAY_ID_OID]);
-            result = ANJAY_ERR_NOT_FOUND;
-            goto finish;
-        }
+        // Records addressing the same Object Instance are typically grouped
+        // together in the payload, so the Object lookup and the Instance
+        // presence check are only repeated when the target changes.
+        if (!obj
+                || path.ids[ANJAY_ID_OID] != _anjay_dm_installed_object_oid(obj)
+                || path.ids[ANJAY_ID_IID] != verified_iid) {
+            verified_iid = ANJAY_ID_INVALID;
+            if (!(obj = _anjay_dm_find_object_by_oid(
+                          anjay, path.ids[ANJAY_ID_OID]))) {
+                dm_log(DEBUG, _("Object not found: ") "%u",
+                       path.ids[ANJAY_ID_OID]);
+                result = ANJAY_ERR_NOT_FOUND;
+                goto finish;
+            }
 
-        if ((result = _anjay_dm_verify_instance_present(
-                     anjay, obj, path.ids[ANJAY_ID_IID]))) {
-            goto finish;
+            if ((result = _anjay_dm_verify_instance_present(
+                         anjay, obj, path.ids[ANJAY_ID_IID]))) {
+                goto finish;
+            }
+            verified_iid = path.ids[ANJAY_ID_IID];
         }
 
         anjay_dm_resource_kind_t kind;
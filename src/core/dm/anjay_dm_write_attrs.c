@@ -243,6 +243,10 @@ int _anjay_dm_write_attributes(anjay_unlocked_t *anjay,
     } else {
         result = dm_write_object_attrs(anjay, obj, ssid, &request->attributes);
     }
+    if (!result) {
+        _anjay_dm_cache_invalidate_discover(
+                anjay, request->uri.ids[ANJAY_ID_OID]);
+    }
 #ifdef ANJAY_WITH_OBSERVE
     if (!result) {
         // verify that new attributes are "seen" by the observe code
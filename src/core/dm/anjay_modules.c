@@ -68,3 +68,13 @@ void *_anjay_dm_module_get_arg(anjay_unlocked_t *anjay,
             _anjay_dm_module_find_ptr(anjay, module_deleter);
     return entry_ptr ? (*entry_ptr)->arg : NULL;
 }
+
+#ifdef ANJAY_WITH_MODULE_LWM2M_GATEWAY
+void _anjay_dm_set_prefix_resolver(anjay_unlocked_t *anjay,
+                                   anjay_dm_prefix_resolver_t *resolver,
+                                   void *arg) {
+    assert(!resolver || !anjay->dm.prefix_resolver);
+    anjay->dm.prefix_resolver = resolver;
+    anjay->dm.prefix_resolver_arg = arg;
+}
+#endif // ANJAY_WITH_MODULE_LWM2M_GATEWAY
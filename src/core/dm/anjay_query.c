@@ -16,8 +16,83 @@
 #include "../anjay_core.h"
 #include "../anjay_dm_core.h"
 
+#include "anjay_dm_cache.h"
+
 VISIBILITY_SOURCE_BEGIN
 
+static int read_server_ids(anjay_unlocked_t *anjay,
+                           anjay_iid_t iid,
+                           anjay_dm_cached_server_ids_t *out_ids) {
+    const anjay_uri_path_t ssid_path =
+            MAKE_RESOURCE_PATH(ANJAY_DM_OID_SERVER, iid,
+                               ANJAY_DM_RID_SERVER_SSID);
+    out_ids->iid = iid;
+    out_ids->result =
+            _anjay_dm_read_resource_i64(anjay, &ssid_path, &out_ids->ssid);
+    return out_ids->result;
+}
+
+static int collect_server_ids_handler(anjay_unlocked_t *anjay,
+                                      const anjay_dm_installed_object_t *obj,
+                                      anjay_iid_t iid,
+                                      void *tail_ptr_) {
+    (void) obj;
+    AVS_LIST(anjay_dm_cached_server_ids_t) **tail_ptr =
+            (AVS_LIST(anjay_dm_cached_server_ids_t) **) tail_ptr_;
+    AVS_LIST(anjay_dm_cached_server_ids_t) entry =
+            AVS_LIST_NEW_ELEMENT(anjay_dm_cached_server_ids_t);
+    if (!entry) {
+        _anjay_log_oom();
+        return -1;
+    }
+    (void) read_server_ids(anjay, iid, entry);
+    AVS_LIST_INSERT(*tail_ptr, entry);
+    *tail_ptr = AVS_LIST_NEXT_PTR(*tail_ptr);
+    return 0;
+}
+
+/**
+ * Returns 0 and sets @p *out_ids to the cached identifiers of all Server
+ * Object Instances, populating the cache if necessary. Returns -1 if the cache
+ * is disabled or could not be populated, in which case the caller shall query
+ * the data model directly.
+ */
+static int
+get_cached_server_ids(anjay_unlocked_t *anjay,
+                      AVS_LIST(const anjay_dm_cached_server_ids_t) *out_ids) {
+    anjay_dm_server_params_cache_t *cache = &anjay->dm.server_params;
+    if (!cache->enabled) {
+        return -1;
+    }
+    if (!cache->server_ids_valid) {
+        const anjay_dm_installed_object_t *obj =
+                _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_SERVER);
+        if (!obj) {
+            return -1;
+        }
+        const uint32_t generation = cache->generation;
+        AVS_LIST(anjay_dm_cached_server_ids_t) ids = NULL;
+        AVS_LIST(anjay_dm_cached_server_ids_t) *tail_ptr = &ids;
+        if (_anjay_dm_foreach_instance(anjay, obj, collect_server_ids_handler,
+                                       &tail_ptr)
+                || generation != cache->generation) {
+            // the Server Object might have changed while the data model
+            // handlers were called with the mutex released
+            AVS_LIST_CLEAR(&ids);
+            return -1;
+        }
+        if (cache->server_ids_valid) {
+            // populated concurrently by another thread
+            AVS_LIST_CLEAR(&ids);
+        } else {
+            cache->server_ids = ids;
+            cache->server_ids_valid = true;
+        }
+    }
+    *out_ids = cache->server_ids;
+    return 0;
+}
+
 typedef struct {
     anjay_ssid_t ssid;
     anjay_iid_t out_iid;
@@ -29,15 +104,11 @@ static int find_server_iid_handler(anjay_unlocked_t *anjay,
                                    void *args_) {
     (void) obj;
     find_iid_args_t *args = (find_iid_args_t *) args_;
-    int64_t ssid;
-    const anjay_uri_path_t ssid_path =
-            MAKE_RESOURCE_PATH(ANJAY_DM_OID_SERVER, iid,
-                               ANJAY_DM_RID_SERVER_SSID);
-
-    if (_anjay_dm_read_resource_i64(anjay, &ssid_path, &ssid)) {
+    anjay_dm_cached_server_ids_t ids;
+    if (read_server_ids(anjay, iid, &ids)) {
         return -1;
     }
-    if (ssid == (int32_t) args->ssid) {
+    if (ids.ssid == (int32_t) args->ssid) {
         args->out_iid = iid;
         return ANJAY_FOREACH_BREAK;
     }
@@ -47,16 +118,32 @@ static int find_server_iid_handler(anjay_unlocked_t *anjay,
 int _anjay_find_server_iid(anjay_unlocked_t *anjay,
                            anjay_ssid_t ssid,
                            anjay_iid_t *out_iid) {
+    if (ssid == ANJAY_SSID_ANY || ssid == ANJAY_SSID_BOOTSTRAP) {
+        return -1;
+    }
+
+    AVS_LIST(const anjay_dm_cached_server_ids_t) cached;
+    if (!get_cached_server_ids(anjay, &cached)) {
+        AVS_LIST(const anjay_dm_cached_server_ids_t) it;
+        AVS_LIST_FOREACH(it, cached) {
+            if (it->result) {
+                return -1;
+            }
+            if (it->ssid == (int32_t) ssid) {
+                *out_iid = it->iid;
+                return 0;
+            }
+        }
+        return -1;
+    }
+
     find_iid_args_t args = {
         .ssid = ssid,
         .out_iid = ANJAY_ID_INVALID
     };
-
     const anjay_dm_installed_object_t *obj =
             _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_SERVER);
-    if (ssid == ANJAY_SSID_ANY || ssid == ANJAY_SSID_BOOTSTRAP
-            || _anjay_dm_foreach_instance(anjay, obj, find_server_iid_handler,
-                                          &args)
+    if (_anjay_dm_foreach_instance(anjay, obj, find_server_iid_handler, &args)
             || args.out_iid == ANJAY_ID_INVALID) {
         return -1;
     }
@@ -73,39 +160,167 @@ bool _anjay_dm_ssid_exists(anjay_unlocked_t *anjay, anjay_ssid_t ssid) {
 int _anjay_ssid_from_server_iid(anjay_unlocked_t *anjay,
                                 anjay_iid_t server_iid,
                                 anjay_ssid_t *out_ssid) {
+    AVS_LIST(const anjay_dm_cached_server_ids_t) cached;
+    anjay_dm_cached_server_ids_t ids = {
+        .result = -1
+    };
+    if (!get_cached_server_ids(anjay, &cached)) {
+        AVS_LIST(const anjay_dm_cached_server_ids_t) it;
+        AVS_LIST_FOREACH(it, cached) {
+            if (it->iid == server_iid) {
+                ids = *it;
+                break;
+            }
+        }
+    } else {
+        (void) read_server_ids(anjay, server_iid, &ids);
+    }
+    if (ids.result) {
+        return -1;
+    }
+    *out_ssid = (anjay_ssid_t) ids.ssid;
+    return 0;
+}
+
+static bool read_bootstrap_flag(anjay_unlocked_t *anjay,
+                                anjay_iid_t security_iid) {
+#ifdef ANJAY_WITH_BOOTSTRAP
+    bool is_bootstrap;
+    const anjay_uri_path_t path =
+            MAKE_RESOURCE_PATH(ANJAY_DM_OID_SECURITY, security_iid,
+                               ANJAY_DM_RID_SECURITY_BOOTSTRAP);
+
+    if (_anjay_dm_read_resource_bool(anjay, &path, &is_bootstrap)
+            || !is_bootstrap) {
+        return false;
+    }
+
+    return true;
+#else  // ANJAY_WITH_BOOTSTRAP
+    (void) anjay;
+    (void) security_iid;
+    return false;
+#endif // ANJAY_WITH_BOOTSTRAP
+}
+
+static void read_security_ids(anjay_unlocked_t *anjay,
+                              anjay_iid_t iid,
+                              anjay_dm_cached_security_ids_t *out_ids) {
+    out_ids->iid = iid;
+    out_ids->is_bootstrap = read_bootstrap_flag(anjay, iid);
+    out_ids->ssid_result = -1;
+    out_ids->ssid = 0;
+    if (out_ids->is_bootstrap) {
+        return;
+    }
+
     int64_t ssid;
-    const anjay_uri_path_t ssid_path =
-            MAKE_RESOURCE_PATH(ANJAY_DM_OID_SERVER, server_iid,
-                               ANJAY_DM_RID_SERVER_SSID);
-    if (_anjay_dm_read_resource_i64(anjay, &ssid_path, &ssid)) {
+    const anjay_uri_path_t path =
+            MAKE_RESOURCE_PATH(ANJAY_DM_OID_SECURITY, iid,
+                               ANJAY_DM_RID_SECURITY_SSID);
+    if (!_anjay_dm_read_resource_i64(anjay, &path, &ssid) && ssid > 0
+            && ssid <= UINT16_MAX) {
+        out_ids->ssid_result = 0;
+        out_ids->ssid = (anjay_ssid_t) ssid;
+    }
+}
+
+static int collect_security_ids_handler(anjay_unlocked_t *anjay,
+                                        const anjay_dm_installed_object_t *obj,
+                                        anjay_iid_t iid,
+                                        void *tail_ptr_) {
+    (void) obj;
+    AVS_LIST(anjay_dm_cached_security_ids_t) **tail_ptr =
+            (AVS_LIST(anjay_dm_cached_security_ids_t) **) tail_ptr_;
+    AVS_LIST(anjay_dm_cached_security_ids_t) entry =
+            AVS_LIST_NEW_ELEMENT(anjay_dm_cached_security_ids_t);
+    if (!entry) {
+        _anjay_log_oom();
+        return -1;
+    }
+    read_security_ids(anjay, iid, entry);
+    AVS_LIST_INSERT(*tail_ptr, entry);
+    *tail_ptr = AVS_LIST_NEXT_PTR(*tail_ptr);
+    return 0;
+}
+
+/**
+ * Works like @ref get_cached_server_ids, but for the Security Object.
+ */
+static int get_cached_security_ids(
+        anjay_unlocked_t *anjay,
+        AVS_LIST(const anjay_dm_cached_security_ids_t) *out_ids) {
+    anjay_dm_server_params_cache_t *cache = &anjay->dm.server_params;
+    if (!cache->enabled) {
         return -1;
     }
-    *out_ssid = (anjay_ssid_t) ssid;
+    if (!cache->security_ids_valid) {
+        const anjay_dm_installed_object_t *obj =
+                _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_SECURITY);
+        if (!obj) {
+            return -1;
+        }
+        const uint32_t generation = cache->generation;
+        AVS_LIST(anjay_dm_cached_security_ids_t) ids = NULL;
+        AVS_LIST(anjay_dm_cached_security_ids_t) *tail_ptr = &ids;
+        if (_anjay_dm_foreach_instance(anjay, obj, collect_security_ids_handler,
+                                       &tail_ptr)
+                || generation != cache->generation) {
+            AVS_LIST_CLEAR(&ids);
+            return -1;
+        }
+        if (cache->security_ids_valid) {
+            AVS_LIST_CLEAR(&ids);
+        } else {
+            cache->security_ids = ids;
+            cache->security_ids_valid = true;
+        }
+    }
+    *out_ids = cache->security_ids;
     return 0;
 }
 
+static void get_security_ids(anjay_unlocked_t *anjay,
+                             anjay_iid_t security_iid,
+                             anjay_dm_cached_security_ids_t *out_ids) {
+    AVS_LIST(const anjay_dm_cached_security_ids_t) cached;
+    if (get_cached_security_ids(anjay, &cached)) {
+        read_security_ids(anjay, security_iid, out_ids);
+        return;
+    }
+    AVS_LIST(const anjay_dm_cached_security_ids_t) it;
+    AVS_LIST_FOREACH(it, cached) {
+        if (it->iid == security_iid) {
+            *out_ids = *it;
+            return;
+        }
+    }
+    *out_ids = (anjay_dm_cached_security_ids_t) {
+        .iid = security_iid,
+        .is_bootstrap = false,
+        .ssid_result = -1
+    };
+}
+
 int _anjay_ssid_from_security_iid(anjay_unlocked_t *anjay,
                                   anjay_iid_t security_iid,
                                   uint16_t *out_ssid) {
     assert(security_iid != ANJAY_ID_INVALID);
-    if (_anjay_is_bootstrap_security_instance(anjay, security_iid)) {
+    anjay_dm_cached_security_ids_t ids;
+    get_security_ids(anjay, security_iid, &ids);
+    if (ids.is_bootstrap) {
         *out_ssid = ANJAY_SSID_BOOTSTRAP;
         return 0;
     }
-
-    int64_t _ssid;
-    const anjay_uri_path_t path =
-            MAKE_RESOURCE_PATH(ANJAY_DM_OID_SECURITY, security_iid,
-                               ANJAY_DM_RID_SECURITY_SSID);
-
-    if (_anjay_dm_read_resource_i64(anjay, &path, &_ssid) || _ssid <= 0
-            || _ssid > UINT16_MAX) {
+    if (ids.ssid_result) {
+        const anjay_uri_path_t path =
+                MAKE_RESOURCE_PATH(ANJAY_DM_OID_SECURITY, security_iid,
+                                   ANJAY_DM_RID_SECURITY_SSID);
         anjay_log(ERROR, _("could not get Short Server ID from ") "%s",
                   ANJAY_DEBUG_MAKE_PATH(&path));
         return -1;
     }
-
-    *out_ssid = (uint16_t) _ssid;
+    *out_ssid = ids.ssid;
     return 0;
 }
 
@@ -129,17 +344,17 @@ int _anjay_server_uri_from_security_iid(anjay_unlocked_t *anjay,
 #ifdef ANJAY_WITH_BOOTSTRAP
 bool _anjay_is_bootstrap_security_instance(anjay_unlocked_t *anjay,
                                            anjay_iid_t security_iid) {
-    bool is_bootstrap;
-    const anjay_uri_path_t path =
-            MAKE_RESOURCE_PATH(ANJAY_DM_OID_SECURITY, security_iid,
-                               ANJAY_DM_RID_SECURITY_BOOTSTRAP);
-
-    if (_anjay_dm_read_resource_bool(anjay, &path, &is_bootstrap)
-            || !is_bootstrap) {
-        return false;
+    AVS_LIST(const anjay_dm_cached_security_ids_t) cached;
+    if (get_cached_security_ids(anjay, &cached)) {
+        return read_bootstrap_flag(anjay, security_iid);
     }
-
-    return true;
+    AVS_LIST(const anjay_dm_cached_security_ids_t) it;
+    AVS_LIST_FOREACH(it, cached) {
+        if (it->iid == security_iid) {
+            return it->is_bootstrap;
+        }
+    }
+    return false;
 }
 
 static int
@@ -148,7 +363,7 @@ bootstrap_security_iid_find_helper(anjay_unlocked_t *anjay,
                                    anjay_iid_t iid,
                                    void *result_ptr) {
     (void) obj;
-    if (_anjay_is_bootstrap_security_instance(anjay, iid)) {
+    if (read_bootstrap_flag(anjay, iid)) {
         *(anjay_iid_t *) result_ptr = iid;
         return ANJAY_FOREACH_BREAK;
     }
@@ -156,6 +371,17 @@ bootstrap_security_iid_find_helper(anjay_unlocked_t *anjay,
 }
 
 anjay_iid_t _anjay_find_bootstrap_security_iid(anjay_unlocked_t *anjay) {
+    AVS_LIST(const anjay_dm_cached_security_ids_t) cached;
+    if (!get_cached_security_ids(anjay, &cached)) {
+        AVS_LIST(const anjay_dm_cached_security_ids_t) it;
+        AVS_LIST_FOREACH(it, cached) {
+            if (it->is_bootstrap) {
+                return it->iid;
+            }
+        }
+        return ANJAY_ID_INVALID;
+    }
+
     anjay_iid_t result = ANJAY_ID_INVALID;
     const anjay_dm_installed_object_t *obj =
             _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_SECURITY);
@@ -37,6 +37,12 @@ AVS_STATIC_ASSERT(offsetof(anjay_etag_t, value)
 AVS_STATIC_ASSERT(AVS_ALIGNOF(anjay_etag_t) == AVS_ALIGNOF(avs_coap_etag_t),
                   coap_etag_alignment_compatible);
 
+typedef struct {
+    size_t offset;
+    size_t size;
+    uint8_t data[];
+} anjay_coap_buffered_block_t;
+
 typedef struct {
     anjay_download_ctx_common_t common;
 
@@ -68,6 +74,24 @@ typedef struct {
     avs_sched_handle_t job_start;
     bool aborting;
     bool reconnecting;
+
+    /**
+     * Pipelined block-wise transfer state. If window_size is greater than 1,
+     * after the first block is received, the window is opened: up to
+     * window_size exchanges (exchange_id and extra_exchanges) are kept in
+     * flight, each of them fetching every window_size-th block. Blocks that
+     * arrive ahead of bytes_downloaded are kept in buffered_blocks (sorted by
+     * offset) until they can be delivered in order.
+     */
+    size_t window_size;
+    size_t block_size;
+    size_t total_size;
+    size_t extra_exchange_count;
+    avs_coap_exchange_id_t *extra_exchanges;
+    AVS_LIST(anjay_coap_buffered_block_t) buffered_blocks;
+    bool window_disabled;
+    bool window_restart_requested;
+    bool retiring;
 } anjay_coap_download_ctx_t;
 
 typedef struct {
@@ -104,6 +128,7 @@ static void cleanup_coap_transfer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
         AVS_LIST_DELETE(ctx_ptr);
         return;
     }
+    AVS_LIST_CLEAR(&ctx->buffered_blocks);
     anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->common.dl);
 
     const cleanup_coap_context_args_t args = {
@@ -121,6 +146,9 @@ static void cleanup_coap_transfer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
          * AVS_LIST_DELETE(ctx_ptr) to cleanup_coap_context().
          */
         avs_coap_exchange_cancel(ctx->coap, ctx->exchange_id);
+        for (size_t i = 0; i < ctx->extra_exchange_count; ++i) {
+            avs_coap_exchange_cancel(ctx->coap, ctx->extra_exchanges[i]);
+        }
         /**
          * HACK: this is necessary, because CoAP context may be destroyed while
          * handling a response, and when the control returns, it may access some
@@ -132,6 +160,7 @@ static void cleanup_coap_transfer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
             cleanup_coap_context_unlocked(NULL, args);
         }
     }
+    avs_free(ctx->extra_exchanges);
     AVS_LIST_DELETE(ctx_ptr);
 }
 
@@ -168,6 +197,9 @@ static void abort_download_transfer(anjay_coap_download_ctx_t *dl_ctx,
 
     avs_coap_exchange_cancel(dl_ctx->coap, dl_ctx->exchange_id);
     assert(!avs_coap_exchange_id_valid(dl_ctx->exchange_id));
+    for (size_t i = 0; i < dl_ctx->extra_exchange_count; ++i) {
+        avs_coap_exchange_cancel(dl_ctx->coap, dl_ctx->extra_exchanges[i]);
+    }
 
     AVS_LIST(anjay_download_ctx_t) *dl_ctx_ptr =
             _anjay_downloader_find_ctx_ptr_by_id(dl_ctx->common.dl,
@@ -177,6 +209,322 @@ static void abort_download_transfer(anjay_coap_download_ctx_t *dl_ctx,
     }
 }
 
+static avs_error_t sched_start_download(anjay_coap_download_ctx_t *ctx);
+static void start_download_job(avs_sched_t *sched, const void *id_ptr);
+
+static void
+handle_coap_response(avs_coap_ctx_t *ctx,
+                     avs_coap_exchange_id_t id,
+                     avs_coap_client_request_state_t result,
+                     const avs_coap_client_async_response_t *response,
+                     avs_error_t err,
+                     void *arg);
+
+static avs_error_t add_uri_options(anjay_coap_download_ctx_t *ctx,
+                                   avs_coap_options_t *options) {
+    avs_error_t err = AVS_OK;
+    AVS_LIST(const anjay_string_t) elem;
+    AVS_LIST_FOREACH(elem, ctx->uri.uri_path) {
+        if (avs_is_err((err = avs_coap_options_add_string(
+                                options, AVS_COAP_OPTION_URI_PATH,
+                                elem->c_str)))) {
+            return err;
+        }
+    }
+    AVS_LIST_FOREACH(elem, ctx->uri.uri_query) {
+        if (avs_is_err((err = avs_coap_options_add_string(
+                                options, AVS_COAP_OPTION_URI_QUERY,
+                                elem->c_str)))) {
+            return err;
+        }
+    }
+    return err;
+}
+
+static avs_coap_exchange_id_t *
+find_exchange_id_ptr(anjay_coap_download_ctx_t *ctx,
+                     avs_coap_exchange_id_t id) {
+    if (ctx->exchange_id.value == id.value) {
+        return &ctx->exchange_id;
+    }
+    for (size_t i = 0; i < ctx->extra_exchange_count; ++i) {
+        if (ctx->extra_exchanges[i].value == id.value) {
+            return &ctx->extra_exchanges[i];
+        }
+    }
+    return NULL;
+}
+
+static void retire_exchange(anjay_coap_download_ctx_t *ctx,
+                            avs_coap_exchange_id_t *id_ptr) {
+    ctx->retiring = true;
+    avs_coap_exchange_cancel(ctx->coap, *id_ptr);
+    ctx->retiring = false;
+    assert(!avs_coap_exchange_id_valid(*id_ptr));
+}
+
+static void close_window(anjay_coap_download_ctx_t *ctx) {
+    for (size_t i = 0; i < ctx->extra_exchange_count; ++i) {
+        retire_exchange(ctx, &ctx->extra_exchanges[i]);
+    }
+    avs_free(ctx->extra_exchanges);
+    ctx->extra_exchanges = NULL;
+    ctx->extra_exchange_count = 0;
+    AVS_LIST_CLEAR(&ctx->buffered_blocks);
+    ctx->block_size = 0;
+    ctx->total_size = 0;
+    ctx->window_restart_requested = false;
+}
+
+static void restart_sequentially(anjay_coap_download_ctx_t *ctx) {
+    dl_log(DEBUG,
+           _("transfer id = ") "%" PRIuPTR _(
+                   ": continuing with sequential block-wise transfer"),
+           ctx->common.id);
+    // every block requested in the window will be requested again
+    ctx->common.stats.blocks_retried += ctx->extra_exchange_count;
+    ANJAY_TRACEPOINT(download_blocks_retried, ctx->common.id,
+                     ctx->extra_exchange_count);
+    retire_exchange(ctx, &ctx->exchange_id);
+    close_window(ctx);
+    ctx->window_disabled = true;
+    avs_error_t err = sched_start_download(ctx);
+    if (avs_is_err(err)) {
+        abort_download_transfer(ctx, _anjay_download_status_failed(err));
+    }
+}
+
+/**
+ * Pauses the transfer if required by the throttling settings. All exchanges
+ * are cancelled, and the transfer is restarted from bytes_downloaded after the
+ * pause.
+ *
+ * @returns true if the transfer has been paused (or aborted).
+ */
+static bool pause_if_throttled(anjay_coap_download_ctx_t *ctx,
+                               size_t bytes_received) {
+    const avs_time_duration_t delay =
+            _anjay_downloader_throttle_delay(&ctx->common, bytes_received);
+    if (avs_time_duration_equal(delay, AVS_TIME_DURATION_ZERO)) {
+        return false;
+    }
+    dl_log(TRACE,
+           _("transfer id = ") "%" PRIuPTR _(": throttled for ") "%s" _(" s"),
+           ctx->common.id, AVS_TIME_DURATION_AS_STRING(delay));
+    retire_exchange(ctx, &ctx->exchange_id);
+    close_window(ctx);
+    avs_sched_del(&ctx->job_start);
+    if (AVS_SCHED_DELAYED(_anjay_downloader_get_anjay(ctx->common.dl)->sched,
+                          &ctx->job_start, delay, start_download_job,
+                          &ctx->common.id, sizeof(ctx->common.id))) {
+        abort_download_transfer(ctx, _anjay_download_status_failed(
+                                             avs_errno(AVS_ENOMEM)));
+    }
+    return true;
+}
+
+static avs_error_t start_extra_exchange(anjay_coap_download_ctx_t *ctx,
+                                        avs_coap_exchange_id_t *out_id,
+                                        size_t offset) {
+    // The block is requested explicitly whenever the block size of the first
+    // response is a valid BLOCK2 size (i.e. the response was not BERT), so
+    // that the first request does not fetch the data that the main exchange
+    // has already delivered. avs_coap sends it as Q-Block2 if negotiated.
+    const bool explicit_block2 =
+            ctx->block_size <= AVS_COAP_BLOCK_MAX_SIZE
+            && !(ctx->block_size & (ctx->block_size - 1));
+    const avs_coap_option_block_t block2 = {
+        .type = AVS_COAP_BLOCK2,
+        .seq_num = (uint32_t) (offset / ctx->block_size),
+        .size = (uint16_t) ctx->block_size
+    };
+    avs_error_t err;
+    avs_coap_options_t options;
+    (void) (avs_is_err((err = avs_coap_options_dynamic_init(&options)))
+            || avs_is_err((err = add_uri_options(ctx, &options)))
+            || (explicit_block2
+                && avs_is_err((err = avs_coap_options_add_block(&options,
+                                                                &block2))))
+            || avs_is_err((err = avs_coap_client_send_async_request(
+                                   ctx->coap, out_id,
+                                   &(avs_coap_request_header_t) {
+                                       .code = AVS_COAP_CODE_GET,
+                                       .options = options
+                                   },
+                                   NULL, NULL, handle_coap_response,
+                                   (void *) ctx)))
+            || (!explicit_block2
+                && avs_is_err((
+                           err = avs_coap_client_set_next_response_payload_offset(
+                                   ctx->coap, *out_id, offset)))));
+    avs_coap_options_cleanup(&options);
+    return err;
+}
+
+/**
+ * Called after the first block has been delivered over the main exchange,
+ * which will request the block starting at bytes_downloaded next. If the total
+ * size of the resource is known, extra exchanges are started for the following
+ * blocks, so that window_size blocks are requested at a time.
+ */
+static void open_window(anjay_coap_download_ctx_t *ctx,
+                        const avs_coap_client_async_response_t *response) {
+    assert(!ctx->extra_exchange_count);
+    uint32_t total_size;
+    if (avs_coap_options_get_u32(&response->header.options,
+                                 AVS_COAP_OPTION_SIZE2, &total_size)) {
+        dl_log(DEBUG,
+               _("Size2 option not present, block requests will not be "
+                 "pipelined"));
+        ctx->window_disabled = true;
+        return;
+    }
+    const size_t block_size = response->payload_size;
+    if (!block_size || total_size <= ctx->bytes_downloaded) {
+        ctx->window_disabled = true;
+        return;
+    }
+    const size_t blocks_left =
+            (total_size - ctx->bytes_downloaded + block_size - 1) / block_size;
+    const size_t window_size = AVS_MIN(ctx->window_size, blocks_left);
+    if (window_size < 2) {
+        ctx->window_disabled = true;
+        return;
+    }
+
+    if (!(ctx->extra_exchanges = (avs_coap_exchange_id_t *) avs_calloc(
+                  window_size - 1, sizeof(avs_coap_exchange_id_t)))) {
+        _anjay_log_oom();
+        ctx->window_disabled = true;
+        return;
+    }
+    ctx->extra_exchange_count = window_size - 1;
+    ctx->block_size = block_size;
+    ctx->total_size = total_size;
+    for (size_t i = 0; i < ctx->extra_exchange_count; ++i) {
+        ctx->extra_exchanges[i] = AVS_COAP_EXCHANGE_ID_INVALID;
+    }
+    for (size_t i = 0; i < ctx->extra_exchange_count; ++i) {
+        if (avs_is_err(start_extra_exchange(
+                    ctx, &ctx->extra_exchanges[i],
+                    ctx->bytes_downloaded + (i + 1) * block_size))) {
+            dl_log(DEBUG, _("could not start pipelined block requests"));
+            close_window(ctx);
+            ctx->window_disabled = true;
+            return;
+        }
+    }
+    dl_log(DEBUG,
+           _("transfer id = ") "%" PRIuPTR _(": ") "%lu" _(
+                   " block requests in flight"),
+           ctx->common.id, (unsigned long) window_size);
+}
+
+static avs_error_t deliver_in_order(anjay_coap_download_ctx_t *ctx,
+                                    size_t offset,
+                                    const uint8_t *data,
+                                    size_t size) {
+    assert(offset <= ctx->bytes_downloaded);
+    if (offset + size <= ctx->bytes_downloaded) {
+        return AVS_OK;
+    }
+    const size_t skipped = ctx->bytes_downloaded - offset;
+    avs_error_t err = _anjay_downloader_call_on_next_block(
+            &ctx->common, data + skipped, size - skipped,
+            ctx->etag.size > 0 ? (const anjay_etag_t *) &ctx->etag : NULL);
+    if (avs_is_ok(err) && !ctx->window_restart_requested) {
+        ctx->bytes_downloaded = offset + size;
+    }
+    return err;
+}
+
+static avs_error_t handle_windowed_block(anjay_coap_download_ctx_t *ctx,
+                                         size_t offset,
+                                         const uint8_t *data,
+                                         size_t size) {
+    if (offset > ctx->bytes_downloaded) {
+        AVS_LIST(anjay_coap_buffered_block_t) block =
+                (AVS_LIST(anjay_coap_buffered_block_t)) AVS_LIST_NEW_BUFFER(
+                        sizeof(anjay_coap_buffered_block_t) + size);
+        if (!block) {
+            _anjay_log_oom();
+            return avs_errno(AVS_ENOMEM);
+        }
+        block->offset = offset;
+        block->size = size;
+        memcpy(block->data, data, size);
+        AVS_LIST(anjay_coap_buffered_block_t) *insert_ptr =
+                &ctx->buffered_blocks;
+        while (*insert_ptr && (*insert_ptr)->offset < offset) {
+            insert_ptr = AVS_LIST_NEXT_PTR(insert_ptr);
+        }
+        AVS_LIST_INSERT(insert_ptr, block);
+        return AVS_OK;
+    }
+
+    avs_error_t err = deliver_in_order(ctx, offset, data, size);
+    while (avs_is_ok(err) && !ctx->window_restart_requested
+           && ctx->buffered_blocks
+           && ctx->buffered_blocks->offset <= ctx->bytes_downloaded) {
+        AVS_LIST(anjay_coap_buffered_block_t) block =
+                AVS_LIST_DETACH(&ctx->buffered_blocks);
+        err = deliver_in_order(ctx, block->offset, block->data, block->size);
+        AVS_LIST_DELETE(&block);
+    }
+    return err;
+}
+
+static void
+handle_windowed_response(anjay_coap_download_ctx_t *ctx,
+                         avs_coap_exchange_id_t *id_ptr,
+                         avs_coap_client_request_state_t result,
+                         const avs_coap_client_async_response_t *response) {
+    const size_t offset = response->payload_offset;
+    const size_t size = response->payload_size;
+    if (result == AVS_COAP_CLIENT_REQUEST_OK) {
+        ctx->total_size = offset + size;
+    } else if (size != ctx->block_size || offset + size >= ctx->total_size) {
+        // either the block size changed, which would leave gaps between the
+        // blocks requested by different exchanges, or the resource is larger
+        // than reported in the Size2 option
+        restart_sequentially(ctx);
+        return;
+    }
+
+    avs_error_t err = handle_windowed_block(
+            ctx, offset, (const uint8_t *) response->payload, size);
+    if (avs_is_err(err)) {
+        abort_download_transfer(ctx, _anjay_download_status_failed(err));
+        return;
+    }
+    if (ctx->window_restart_requested) {
+        restart_sequentially(ctx);
+        return;
+    }
+    if (ctx->bytes_downloaded >= ctx->total_size) {
+        dl_log(INFO, _("transfer id = ") "%" PRIuPTR _(" finished"),
+               ctx->common.id);
+        abort_download_transfer(ctx, _anjay_download_status_success());
+        return;
+    }
+    dl_log(TRACE,
+           _("transfer id = ") "%" PRIuPTR _(": ") "%lu" _(" B downloaded"),
+           ctx->common.id, (unsigned long) ctx->bytes_downloaded);
+    if (pause_if_throttled(ctx, size)) {
+        return;
+    }
+    if (result == AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT) {
+        const size_t next_offset =
+                offset + (ctx->extra_exchange_count + 1) * ctx->block_size;
+        if (next_offset >= ctx->total_size) {
+            retire_exchange(ctx, id_ptr);
+        } else if (avs_is_err(avs_coap_client_set_next_response_payload_offset(
+                           ctx->coap, *id_ptr, next_offset))) {
+            restart_sequentially(ctx);
+        }
+    }
+}
+
 static void
 handle_coap_response(avs_coap_ctx_t *ctx,
                      avs_coap_exchange_id_t id,
@@ -187,14 +535,15 @@ handle_coap_response(avs_coap_ctx_t *ctx,
     (void) ctx;
     anjay_coap_download_ctx_t *dl_ctx = (anjay_coap_download_ctx_t *) arg;
 
-    assert(dl_ctx->exchange_id.value == id.value);
-    (void) id;
+    avs_coap_exchange_id_t *id_ptr = find_exchange_id_ptr(dl_ctx, id);
+    assert(id_ptr);
+    const bool extra_exchange = (id_ptr != &dl_ctx->exchange_id);
     if (result != AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT) {
         // The exchange is being finished one way or another, so let's set the
         // exchange_id field so that it can be used to check if there is an
         // ongoing exchange or not (it is checked in suspend_coap_transfer()
         // and reconnect_coap_transfer()).
-        dl_ctx->exchange_id = AVS_COAP_EXCHANGE_ID_INVALID;
+        *id_ptr = AVS_COAP_EXCHANGE_ID_INVALID;
     }
 
     switch (result) {
@@ -207,8 +556,12 @@ handle_coap_response(avs_coap_ctx_t *ctx,
                            ")"),
                    AVS_COAP_CODE_STRING(code),
                    AVS_COAP_CODE_STRING(AVS_COAP_CODE_CONTENT));
-            abort_download_transfer(
-                    dl_ctx, _anjay_download_status_invalid_response(code));
+            if (extra_exchange) {
+                restart_sequentially(dl_ctx);
+            } else {
+                abort_download_transfer(
+                        dl_ctx, _anjay_download_status_invalid_response(code));
+            }
             return;
         }
         avs_coap_etag_t etag;
@@ -230,6 +583,15 @@ handle_coap_response(avs_coap_ctx_t *ctx,
             abort_download_transfer(dl_ctx, _anjay_download_status_expired());
             return;
         }
+        if (dl_ctx->extra_exchange_count) {
+            handle_windowed_response(dl_ctx, id_ptr, result, response);
+            return;
+        }
+        _anjay_downloader_stats_response_received(&dl_ctx->common);
+        if (result == AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT) {
+            // avs_coap requests the next block right after this handler
+            _anjay_downloader_stats_request_sent(&dl_ctx->common);
+        }
         assert(dl_ctx->bytes_downloaded == response->payload_offset);
         if (avs_is_err((err = _anjay_downloader_call_on_next_block(
                                 &dl_ctx->common,
@@ -252,6 +614,15 @@ handle_coap_response(avs_coap_ctx_t *ctx,
                    _("transfer id = ") "%" PRIuPTR _(": ") "%lu" _(
                            " B downloaded"),
                    dl_ctx->common.id, (unsigned long) dl_ctx->bytes_downloaded);
+            if (pause_if_throttled(dl_ctx, response->payload_size)) {
+                break;
+            }
+            if (dl_ctx->window_size > 1 && !dl_ctx->window_disabled
+                    && dl_ctx->bytes_downloaded
+                                   == response->payload_offset
+                                              + response->payload_size) {
+                open_window(dl_ctx, response);
+            }
         }
         break;
     }
@@ -260,6 +631,8 @@ handle_coap_response(avs_coap_ctx_t *ctx,
         if (err.category == AVS_COAP_ERR_CATEGORY
                 && err.code == AVS_COAP_ERR_ETAG_MISMATCH) {
             abort_download_transfer(dl_ctx, _anjay_download_status_expired());
+        } else if (extra_exchange) {
+            restart_sequentially(dl_ctx);
         } else {
             abort_download_transfer(dl_ctx, _anjay_download_status_failed(err));
         }
@@ -267,7 +640,7 @@ handle_coap_response(avs_coap_ctx_t *ctx,
     }
     case AVS_COAP_CLIENT_REQUEST_CANCEL:
         dl_log(DEBUG, _("download request canceled"));
-        if (!dl_ctx->reconnecting) {
+        if (!dl_ctx->reconnecting && !dl_ctx->retiring) {
             abort_download_transfer(dl_ctx, _anjay_download_status_aborted());
         }
         break;
@@ -318,20 +691,12 @@ static void start_download_job(avs_sched_t *sched, const void *id_ptr) {
             goto end;
         }
 
-        AVS_LIST(const anjay_string_t) elem;
-        AVS_LIST_FOREACH(elem, ctx->uri.uri_path) {
-            if (avs_is_err((err = avs_coap_options_add_string(
-                                    &options, AVS_COAP_OPTION_URI_PATH,
-                                    elem->c_str)))) {
-                goto end;
-            }
-        }
-        AVS_LIST_FOREACH(elem, ctx->uri.uri_query) {
-            if (avs_is_err((err = avs_coap_options_add_string(
-                                    &options, AVS_COAP_OPTION_URI_QUERY,
-                                    elem->c_str)))) {
-                goto end;
-            }
+        if (avs_is_err((err = add_uri_options(ctx, &options)))
+                || (ctx->window_size > 1 && !ctx->window_disabled
+                    && avs_is_err((err = avs_coap_options_add_u32(
+                                           &options, AVS_COAP_OPTION_SIZE2,
+                                           0))))) {
+            goto end;
         }
 
         assert(!avs_coap_exchange_id_valid(ctx->exchange_id));
@@ -347,6 +712,9 @@ static void start_download_job(avs_sched_t *sched, const void *id_ptr) {
                            err = avs_coap_client_set_next_response_payload_offset(
                                    ctx->coap, ctx->exchange_id,
                                    ctx->bytes_downloaded))));
+        if (avs_is_ok(err)) {
+            _anjay_downloader_stats_request_sent(&ctx->common);
+        }
 
     end:
         avs_coap_options_cleanup(&options);
@@ -366,6 +734,11 @@ static avs_error_t reset_coap_ctx(anjay_coap_download_ctx_t *ctx) {
     _anjay_coap_ctx_cleanup(anjay, &ctx->coap);
     assert(!avs_coap_exchange_id_valid(ctx->exchange_id));
 
+    anjay_coap_buffers_t buffers;
+    if (_anjay_coap_buffers_lease(anjay, &buffers)) {
+        return avs_errno(AVS_ENOMEM);
+    }
+
     switch (ctx->transport) {
 #    ifdef WITH_AVS_COAP_UDP
     case ANJAY_SOCKET_TRANSPORT_UDP:
@@ -375,10 +748,13 @@ static avs_error_t reset_coap_ctx(anjay_coap_download_ctx_t *ctx) {
         // expect receiving any requests that would need handling.
         if ((ctx->coap = avs_coap_udp_ctx_create(
                      _anjay_get_coap_sched(anjay), &ctx->protocol.udp.tx_params,
-                     anjay->in_shared_buffer, anjay->out_shared_buffer, NULL,
+                     buffers.in_buffer, buffers.out_buffer, NULL,
                      anjay->prng_ctx.ctx))) {
             avs_coap_set_exchange_max_time(ctx->coap,
                                            anjay->udp_exchange_timeout);
+#        ifdef WITH_AVS_COAP_Q_BLOCK
+            avs_coap_udp_ctx_set_q_block2(ctx->coap, anjay->udp_q_block2);
+#        endif // WITH_AVS_COAP_Q_BLOCK
         }
         break;
 #    endif // WITH_AVS_COAP_UDP
@@ -386,8 +762,8 @@ static avs_error_t reset_coap_ctx(anjay_coap_download_ctx_t *ctx) {
 #    ifdef WITH_AVS_COAP_TCP
     case ANJAY_SOCKET_TRANSPORT_TCP:
         if ((ctx->coap = avs_coap_tcp_ctx_create(
-                     _anjay_get_coap_sched(anjay), anjay->in_shared_buffer,
-                     anjay->out_shared_buffer, anjay->coap_tcp_max_options_size,
+                     _anjay_get_coap_sched(anjay), buffers.in_buffer,
+                     buffers.out_buffer, anjay->coap_tcp_max_options_size,
                      ctx->protocol.tcp.request_timeout, anjay->prng_ctx.ctx))) {
             avs_coap_set_exchange_max_time(ctx->coap,
                                            anjay->tcp_exchange_timeout);
@@ -399,9 +775,11 @@ static avs_error_t reset_coap_ctx(anjay_coap_download_ctx_t *ctx) {
                _("anjay_coap_download_ctx_t is compatible only with "
                  "ANJAY_SOCKET_TRANSPORT_UDP and "
                  "ANJAY_SOCKET_TRANSPORT_TCP (if they are compiled-in)"));
+        _anjay_coap_buffers_bind(anjay, &buffers, NULL);
         return avs_errno(AVS_EPROTONOSUPPORT);
     }
 
+    _anjay_coap_buffers_bind(anjay, &buffers, ctx->coap);
     if (!ctx->coap) {
         dl_log(ERROR, _("could not create CoAP context"));
         return avs_errno(AVS_ENOMEM);
@@ -426,6 +804,7 @@ static void suspend_coap_transfer(anjay_download_ctx_t *ctx_) {
         avs_coap_exchange_cancel(ctx->coap, ctx->exchange_id);
         assert(!avs_coap_exchange_id_valid(ctx->exchange_id));
     }
+    close_window(ctx);
     if (ctx->common.same_socket_download) {
         return;
     }
@@ -469,10 +848,21 @@ reconnect_coap_transfer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
         return sched_start_download(ctx);
     }
 
+    if (ctx->extra_exchange_count) {
+        // the main exchange is requesting blocks out of order, so the transfer
+        // needs to be restarted from bytes_downloaded in any case
+        avs_coap_exchange_cancel(ctx->coap, ctx->exchange_id);
+        assert(!avs_coap_exchange_id_valid(ctx->exchange_id));
+        close_window(ctx);
+    }
+
+    anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->common.dl);
     avs_net_socket_shutdown(ctx->socket);
     avs_net_socket_close(ctx->socket);
-    avs_error_t err =
-            avs_net_socket_connect(ctx->socket, ctx->uri.host, ctx->uri.port);
+    // the socket object stays the same, but its system descriptor does not
+    _anjay_socket_set_changed(anjay);
+    avs_error_t err = _anjay_dns_cache_connect(anjay, ctx->socket,
+                                               ctx->uri.host, ctx->uri.port);
     if (avs_is_err(err)) {
         dl_log(WARNING,
                _("could not connect socket for download id = ") "%" PRIuPTR,
@@ -496,6 +886,14 @@ reconnect_coap_transfer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
 static avs_error_t set_next_coap_block_offset(anjay_download_ctx_t *ctx_,
                                               size_t next_block_offset) {
     anjay_coap_download_ctx_t *ctx = (anjay_coap_download_ctx_t *) ctx_;
+    if (ctx->extra_exchange_count) {
+        // exchanges are already requesting further blocks; the transfer is
+        // restarted sequentially from the new offset once the block currently
+        // being delivered is handled
+        ctx->bytes_downloaded = next_block_offset;
+        ctx->window_restart_requested = true;
+        return AVS_OK;
+    }
     avs_error_t err = AVS_OK;
     if (avs_coap_exchange_id_valid(ctx->exchange_id)) {
         err = avs_coap_client_set_next_response_payload_offset(
@@ -563,6 +961,12 @@ _anjay_downloader_coap_ctx_new(anjay_downloader_t *dl,
     }
 
     if (!ctx->common.same_socket_download) {
+        if (cfg->resume_server_dtls_session
+                && transport_info->security == ANJAY_TRANSPORT_ENCRYPTED) {
+            (void) _anjay_find_matching_dtls_session(
+                    anjay, cfg->url, ctx->dtls_session_buffer,
+                    sizeof(ctx->dtls_session_buffer));
+        }
         ssl_config = (avs_net_ssl_configuration_t) {
             .version = anjay->dtls_version,
             .security = cfg->security_config.security_info,
@@ -578,6 +982,8 @@ _anjay_downloader_coap_ctx_new(anjay_downloader_t *dl,
                     cfg->security_config.server_name_indication,
 #    endif // ANJAY_WITH_LWM2M11
         };
+        ssl_config.server_name_indication = _anjay_dns_cache_server_name(
+                ssl_config.server_name_indication, ctx->uri.host);
         ssl_config.backend_configuration.reuse_addr = 1;
         ssl_config.backend_configuration.preferred_endpoint =
                 &ctx->preferred_endpoint;
@@ -652,7 +1058,11 @@ _anjay_downloader_coap_ctx_new(anjay_downloader_t *dl,
     ctx->common.on_next_block = cfg->on_next_block;
     ctx->common.on_download_finished = cfg->on_download_finished;
     ctx->common.user_data = cfg->user_data;
+    ctx->common.block_buffer_provider = cfg->block_buffer_provider;
     ctx->bytes_downloaded = cfg->start_offset;
+    if (!ctx->common.same_socket_download) {
+        ctx->window_size = cfg->coap_block_window;
+    }
 
     if (cfg->etag) {
         ctx->etag.size = cfg->etag->size;
@@ -673,6 +1083,9 @@ _anjay_downloader_coap_ctx_new(anjay_downloader_t *dl,
                 goto error;
             }
         }
+        if (ctx->protocol.udp.tx_params.nstart < ctx->window_size) {
+            ctx->protocol.udp.tx_params.nstart = ctx->window_size;
+        }
     }
 #    endif // WITH_AVS_COAP_UDP
 
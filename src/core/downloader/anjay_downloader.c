@@ -12,11 +12,15 @@
 #ifdef ANJAY_WITH_DOWNLOADER
 
 #    include <inttypes.h>
+#    include <stdint.h>
+#    include <string.h>
 
 #    include <avsystem/commons/avs_errno.h>
 #    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_utils.h>
 
+#    include <anjay_modules/anjay_memory_accounting.h>
+
 #    include "../anjay_core.h"
 #    include "../anjay_downloader.h"
 
@@ -57,24 +61,218 @@ static void cleanup_transfer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
     (*ctx_ptr)->common.vtable->cleanup(ctx_ptr);
 }
 
+#    define THROUGHPUT_WINDOW_MS 1000
+
+static size_t bytes_per_second(size_t bytes, avs_time_duration_t duration) {
+    int64_t duration_us;
+    if (avs_time_duration_to_scalar(&duration_us, AVS_TIME_US, duration)
+            || duration_us <= 0) {
+        return 0;
+    }
+    return (size_t) ((uint64_t) bytes * 1000000 / (uint64_t) duration_us);
+}
+
+static void stats_data_delivered(anjay_download_ctx_common_t *ctx,
+                                 size_t data_size) {
+    const avs_time_monotonic_t now = avs_time_monotonic_now();
+    ctx->stats.bytes_received += data_size;
+    ANJAY_TRACEPOINT(download_block, ctx->id, data_size,
+                     ctx->stats.bytes_received);
+    if (!avs_time_monotonic_valid(ctx->throughput_window_start)) {
+        ctx->throughput_window_start = now;
+    }
+    ctx->throughput_window_bytes += data_size;
+    const avs_time_duration_t elapsed =
+            avs_time_monotonic_diff(now, ctx->throughput_window_start);
+    if (!avs_time_duration_less(
+                elapsed, avs_time_duration_from_scalar(THROUGHPUT_WINDOW_MS,
+                                                       AVS_TIME_MS))) {
+        ctx->stats.current_throughput =
+                bytes_per_second(ctx->throughput_window_bytes, elapsed);
+        ctx->throughput_window_start = now;
+        ctx->throughput_window_bytes = 0;
+    }
+}
+
+uint8_t *_anjay_downloader_acquire_block_buffer(
+        anjay_unlocked_t *anjay,
+        const anjay_download_block_buffer_provider_t *provider,
+        size_t *out_size) {
+    uint8_t *buffer = NULL;
+    *out_size = 0;
+    ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
+    buffer = provider->acquire(provider->arg, out_size);
+    ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
+    if (buffer && !*out_size) {
+        dl_log(ERROR, _("empty block buffer provided"));
+        _anjay_downloader_release_block_buffer(anjay, provider, buffer);
+        buffer = NULL;
+    }
+    return buffer;
+}
+
+void _anjay_downloader_release_block_buffer(
+        anjay_unlocked_t *anjay,
+        const anjay_download_block_buffer_provider_t *provider,
+        uint8_t *buffer) {
+    ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
+    provider->release(provider->arg, buffer);
+    ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
+}
+
+static avs_error_t call_on_next_block_handler(anjay_download_ctx_common_t *ctx,
+                                              const uint8_t *data,
+                                              size_t data_size,
+                                              const anjay_etag_t *etag) {
+    anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->dl);
+    anjay_download_next_block_handler_t *handler = ctx->on_next_block;
+    void *user_data = ctx->user_data;
+    assert(handler);
+
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    (void) err;
+    stats_data_delivered(ctx, data_size);
+    ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
+    err = handler(anjay_locked, data, data_size, etag, user_data);
+    ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
+    return err;
+}
+
 avs_error_t
 _anjay_downloader_call_on_next_block(anjay_download_ctx_common_t *ctx,
                                      const uint8_t *data,
                                      size_t data_size,
                                      const anjay_etag_t *etag) {
+    const anjay_download_block_buffer_provider_t *provider =
+            ctx->block_buffer_provider;
+    if (!provider || ctx->delivering_from_block_buffer || !data_size) {
+        return call_on_next_block_handler(ctx, data, data_size, etag);
+    }
+    // the data resides in an internal buffer - copy it into the buffers owned
+    // by the application
     anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->dl);
-    anjay_download_next_block_handler_t *handler = ctx->on_next_block;
+    avs_error_t err = AVS_OK;
+    while (avs_is_ok(err) && data_size > 0) {
+        size_t buffer_size;
+        uint8_t *buffer =
+                _anjay_downloader_acquire_block_buffer(anjay, provider,
+                                                       &buffer_size);
+        if (!buffer) {
+            dl_log(ERROR, _("could not acquire block buffer"));
+            return avs_errno(AVS_ENOMEM);
+        }
+        size_t chunk_size = AVS_MIN(buffer_size, data_size);
+        memcpy(buffer, data, chunk_size);
+        err = call_on_next_block_handler(ctx, buffer, chunk_size, etag);
+        _anjay_downloader_release_block_buffer(anjay, provider, buffer);
+        data += chunk_size;
+        data_size -= chunk_size;
+    }
+    return err;
+}
+
+avs_error_t
+_anjay_downloader_call_on_block_at_offset(anjay_download_ctx_common_t *ctx,
+                                          size_t offset,
+                                          const uint8_t *data,
+                                          size_t data_size,
+                                          const anjay_etag_t *etag) {
+    anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->dl);
+    anjay_download_block_at_offset_handler_t *handler =
+            ctx->on_block_at_offset;
     void *user_data = ctx->user_data;
     assert(handler);
 
     avs_error_t err = avs_errno(AVS_EINVAL);
     (void) err;
+    stats_data_delivered(ctx, data_size);
     ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
-    err = handler(anjay_locked, data, data_size, etag, user_data);
+    err = handler(anjay_locked, offset, data, data_size, etag, user_data);
     ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
     return err;
 }
 
+/**
+ * Interval at which downloads paused because of confirmable notifications
+ * being delivered check whether they can be resumed.
+ */
+#    define NOTIFICATION_PAUSE_POLL_INTERVAL_MS 200
+
+/**
+ * If the transfer lags behind the rate limit by more than this, the rate
+ * measurement is restarted, so that the idle period does not turn into a burst.
+ */
+#    define RATE_LIMIT_MAX_LAG_MS 1000
+
+avs_time_duration_t
+_anjay_downloader_throttle_delay(anjay_download_ctx_common_t *ctx,
+                                 size_t bytes_received) {
+    avs_time_duration_t delay = AVS_TIME_DURATION_ZERO;
+    if (ctx->max_bytes_per_second) {
+        const avs_time_monotonic_t now = avs_time_monotonic_now();
+        if (!avs_time_monotonic_valid(ctx->rate_limit_start)) {
+            ctx->rate_limit_start = now;
+            ctx->rate_limit_bytes = 0;
+        }
+        ctx->rate_limit_bytes += bytes_received;
+        const size_t rate = ctx->max_bytes_per_second;
+        const avs_time_duration_t expected_duration = avs_time_duration_add(
+                avs_time_duration_from_scalar(
+                        (int64_t) (ctx->rate_limit_bytes / rate), AVS_TIME_S),
+                avs_time_duration_from_scalar(
+                        (int64_t) ((uint64_t) (ctx->rate_limit_bytes % rate)
+                                   * 1000000 / rate),
+                        AVS_TIME_US));
+        delay = avs_time_monotonic_diff(
+                avs_time_monotonic_add(ctx->rate_limit_start,
+                                       expected_duration),
+                now);
+        if (avs_time_duration_less(
+                    delay, avs_time_duration_from_scalar(-RATE_LIMIT_MAX_LAG_MS,
+                                                         AVS_TIME_MS))) {
+            ctx->rate_limit_start = now;
+            ctx->rate_limit_bytes = 0;
+        }
+        if (!avs_time_duration_less(AVS_TIME_DURATION_ZERO, delay)) {
+            delay = AVS_TIME_DURATION_ZERO;
+        }
+    }
+    if (avs_time_duration_equal(delay, AVS_TIME_DURATION_ZERO)
+            && ctx->pause_during_confirmable_notifications
+            && _anjay_observe_any_confirmable_in_delivery(
+                       _anjay_downloader_get_anjay(ctx->dl))) {
+        delay = avs_time_duration_from_scalar(
+                NOTIFICATION_PAUSE_POLL_INTERVAL_MS, AVS_TIME_MS);
+    }
+    return delay;
+}
+
+static void resume_reading_job(avs_sched_t *sched, const void *id_ptr) {
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    uintptr_t id = *(const uintptr_t *) id_ptr;
+    AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
+            _anjay_downloader_find_ctx_ptr_by_id(&anjay->downloader, id);
+    if (!ctx_ptr) {
+        dl_log(DEBUG, _("download id = ") "%" PRIuPTR _(" expired"), id);
+    } else if ((*ctx_ptr)->common.vtable->resume_reading) {
+        ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_DOWNLOADER);
+        (*ctx_ptr)->common.vtable->resume_reading(ctx_ptr);
+        ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+int _anjay_downloader_pause_reading(anjay_download_ctx_common_t *ctx,
+                                    avs_time_duration_t delay) {
+    dl_log(TRACE,
+           _("download id = ") "%" PRIuPTR _(" throttled for ") "%s" _(" s"),
+           ctx->id, AVS_TIME_DURATION_AS_STRING(delay));
+    return AVS_SCHED_DELAYED(_anjay_downloader_get_anjay(ctx->dl)->sched,
+                             &ctx->resume_reading_job, delay,
+                             resume_reading_job, &ctx->id, sizeof(ctx->id));
+}
+
 static void call_on_download_finished(anjay_download_ctx_t *ctx,
                                       anjay_download_status_t status) {
     anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->common.dl);
@@ -125,12 +323,18 @@ void _anjay_downloader_abort_transfer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr,
     call_on_download_finished(*ctx_ptr, status);
 
     avs_sched_del(&(*ctx_ptr)->common.reconnect_job_handle);
+    avs_sched_del(&(*ctx_ptr)->common.resume_reading_job);
     cleanup_transfer(ctx_ptr);
 }
 
 static void suspend_transfer(anjay_download_ctx_t *ctx) {
     assert(ctx);
     assert(ctx->common.vtable);
+    // reading is restarted anyway when reconnecting
+    avs_sched_del(&ctx->common.resume_reading_job);
+    if (!avs_time_monotonic_valid(ctx->common.suspended_since)) {
+        ctx->common.suspended_since = avs_time_monotonic_now();
+    }
     ctx->common.vtable->suspend(ctx);
 }
 
@@ -139,6 +343,16 @@ static void reconnect_transfer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
     assert(*ctx_ptr);
     assert((*ctx_ptr)->common.vtable);
 
+    anjay_download_ctx_common_t *common = &(*ctx_ptr)->common;
+    if (avs_time_monotonic_valid(common->suspended_since)) {
+        common->stats.time_suspended = avs_time_duration_add(
+                common->stats.time_suspended,
+                avs_time_monotonic_diff(avs_time_monotonic_now(),
+                                        common->suspended_since));
+        common->suspended_since = AVS_TIME_MONOTONIC_INVALID;
+    }
+    ++common->stats.reconnects;
+
     avs_error_t err = (*ctx_ptr)->common.vtable->reconnect(ctx_ptr);
     if (avs_is_err(err)) {
         _anjay_downloader_abort_transfer(ctx_ptr,
@@ -152,6 +366,9 @@ void _anjay_downloader_cleanup(anjay_downloader_t *dl) {
         _anjay_downloader_abort_transfer(&dl->downloads,
                                          _anjay_download_status_aborted());
     }
+#ifdef ANJAY_WITH_HTTP_DOWNLOAD
+    _anjay_downloader_http_tls_sessions_cleanup(dl);
+#endif // ANJAY_WITH_HTTP_DOWNLOAD
 }
 
 static avs_net_socket_t *get_ctx_socket(anjay_download_ctx_t *ctx) {
@@ -167,8 +384,24 @@ get_ctx_socket_transport(anjay_download_ctx_t *ctx) {
     return ctx->common.vtable->get_socket_transport(ctx);
 }
 
+static size_t get_ctx_extra_socket_count(anjay_download_ctx_t *ctx) {
+    assert(ctx);
+    assert(ctx->common.vtable);
+    if (!ctx->common.vtable->get_extra_socket_count) {
+        return 0;
+    }
+    return ctx->common.vtable->get_extra_socket_count(ctx);
+}
+
+/**
+ * Finds the transfer that @p socket belongs to. @p out_extra_index is set to
+ * SIZE_MAX if it is the main socket of the transfer, or to the index of an
+ * extra socket otherwise.
+ */
 static AVS_LIST(anjay_download_ctx_t) *
-find_ctx_ptr_by_socket(anjay_downloader_t *dl, avs_net_socket_t *socket) {
+find_ctx_ptr_by_socket(anjay_downloader_t *dl,
+                       avs_net_socket_t *socket,
+                       size_t *out_extra_index) {
     assert(socket);
     AVS_LIST(anjay_download_ctx_t) *ctx_ptr;
     AVS_LIST_FOREACH_PTR(ctx_ptr, &dl->downloads) {
@@ -176,12 +409,42 @@ find_ctx_ptr_by_socket(anjay_downloader_t *dl, avs_net_socket_t *socket) {
             continue;
         }
         if (get_ctx_socket(*ctx_ptr) == socket) {
+            *out_extra_index = SIZE_MAX;
             return ctx_ptr;
         }
+        size_t extra_count = get_ctx_extra_socket_count(*ctx_ptr);
+        for (size_t i = 0; i < extra_count; ++i) {
+            if ((*ctx_ptr)->common.vtable->get_extra_socket(*ctx_ptr, i,
+                                                            false)
+                    == socket) {
+                *out_extra_index = i;
+                return ctx_ptr;
+            }
+        }
     }
     return NULL;
 }
 
+static int add_socket_entry(AVS_LIST(anjay_socket_entry_t) *sockets,
+                            avs_net_socket_t *socket,
+                            anjay_socket_transport_t transport,
+                            bool include_offline) {
+    if (socket && (include_offline || _anjay_socket_is_online(socket))) {
+        AVS_LIST(anjay_socket_entry_t) elem =
+                AVS_LIST_NEW_ELEMENT(anjay_socket_entry_t);
+        if (!elem) {
+            return -1;
+        }
+
+        elem->socket = socket;
+        elem->transport = transport;
+        elem->ssid = ANJAY_SSID_ANY;
+        elem->queue_mode = false;
+        AVS_LIST_INSERT(sockets, elem);
+    }
+    return 0;
+}
+
 int _anjay_downloader_get_sockets(anjay_downloader_t *dl,
                                   AVS_LIST(anjay_socket_entry_t) *out_socks,
                                   bool include_offline) {
@@ -189,23 +452,25 @@ int _anjay_downloader_get_sockets(anjay_downloader_t *dl,
     AVS_LIST(anjay_download_ctx_t) dl_ctx;
 
     AVS_LIST_FOREACH(dl_ctx, dl->downloads) {
-        if (dl_ctx->common.same_socket_download) {
+        if (dl_ctx->common.same_socket_download
+                || dl_ctx->common.resume_reading_job) {
             continue;
         }
-        avs_net_socket_t *socket = get_ctx_socket(dl_ctx);
-        if (socket && (include_offline || _anjay_socket_is_online(socket))) {
-            AVS_LIST(anjay_socket_entry_t) elem =
-                    AVS_LIST_NEW_ELEMENT(anjay_socket_entry_t);
-            if (!elem) {
+        anjay_socket_transport_t transport = get_ctx_socket_transport(dl_ctx);
+        if (add_socket_entry(&sockets, get_ctx_socket(dl_ctx), transport,
+                             include_offline)) {
+            AVS_LIST_CLEAR(&sockets);
+            return -1;
+        }
+        size_t extra_count = get_ctx_extra_socket_count(dl_ctx);
+        for (size_t i = 0; i < extra_count; ++i) {
+            if (add_socket_entry(&sockets,
+                                 dl_ctx->common.vtable->get_extra_socket(
+                                         dl_ctx, i, true),
+                                 transport, include_offline)) {
                 AVS_LIST_CLEAR(&sockets);
                 return -1;
             }
-
-            elem->socket = socket;
-            elem->transport = get_ctx_socket_transport(dl_ctx);
-            elem->ssid = ANJAY_SSID_ANY;
-            elem->queue_mode = false;
-            AVS_LIST_INSERT(&sockets, elem);
         }
     }
 
@@ -213,6 +478,48 @@ int _anjay_downloader_get_sockets(anjay_downloader_t *dl,
     return 0;
 }
 
+static void track_socket(avs_net_socket_t **sockets,
+                         size_t *inout_count,
+                         avs_net_socket_t *socket) {
+    if (!_anjay_socket_is_online(socket)) {
+        return;
+    }
+    if (*inout_count < ANJAY_DOWNLOADER_TRACKED_SOCKETS) {
+        sockets[*inout_count] = socket;
+    }
+    ++*inout_count;
+}
+
+bool _anjay_downloader_sockets_changed(anjay_downloader_t *dl) {
+    // the same traversal as in _anjay_downloader_get_sockets()
+    avs_net_socket_t *sockets[ANJAY_DOWNLOADER_TRACKED_SOCKETS];
+    size_t count = 0;
+    AVS_LIST(anjay_download_ctx_t) dl_ctx;
+    AVS_LIST_FOREACH(dl_ctx, dl->downloads) {
+        if (dl_ctx->common.same_socket_download
+                || dl_ctx->common.resume_reading_job) {
+            continue;
+        }
+        track_socket(sockets, &count, get_ctx_socket(dl_ctx));
+        size_t extra_count = get_ctx_extra_socket_count(dl_ctx);
+        for (size_t i = 0; i < extra_count; ++i) {
+            track_socket(sockets, &count,
+                         dl_ctx->common.vtable->get_extra_socket(dl_ctx, i,
+                                                                 true));
+        }
+    }
+    if (count > ANJAY_DOWNLOADER_TRACKED_SOCKETS) {
+        dl->tracked_sockets_count = count;
+        return true;
+    }
+    bool changed =
+            count != dl->tracked_sockets_count
+            || memcmp(sockets, dl->tracked_sockets, count * sizeof(*sockets));
+    memcpy(dl->tracked_sockets, sockets, count * sizeof(*sockets));
+    dl->tracked_sockets_count = count;
+    return changed;
+}
+
 AVS_LIST(anjay_download_ctx_t) *
 _anjay_downloader_find_ctx_ptr_by_id(anjay_downloader_t *dl, uintptr_t id) {
     AVS_LIST(anjay_download_ctx_t) *ctx_ptr;
@@ -229,8 +536,9 @@ int _anjay_downloader_handle_packet(anjay_downloader_t *dl,
                                     avs_net_socket_t *socket) {
     assert(&_anjay_downloader_get_anjay(dl)->downloader == dl);
 
+    size_t extra_index;
     AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
-            find_ctx_ptr_by_socket(dl, socket);
+            find_ctx_ptr_by_socket(dl, socket, &extra_index);
     if (!ctx_ptr) {
         // unknown socket
         return -1;
@@ -238,7 +546,17 @@ int _anjay_downloader_handle_packet(anjay_downloader_t *dl,
 
     assert(*ctx_ptr);
     assert((*ctx_ptr)->common.vtable);
-    (*ctx_ptr)->common.vtable->handle_packet(ctx_ptr);
+    if ((*ctx_ptr)->common.resume_reading_job) {
+        // reading is paused due to throttling; the data will be read later
+        return 0;
+    }
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_DOWNLOADER);
+    if (extra_index == SIZE_MAX) {
+        (*ctx_ptr)->common.vtable->handle_packet(ctx_ptr);
+    } else {
+        (*ctx_ptr)->common.vtable->handle_extra_packet(ctx_ptr, extra_index);
+    }
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
     return 0;
 }
 
@@ -302,6 +620,13 @@ avs_error_t _anjay_downloader_download(anjay_downloader_t *dl,
     assert(&_anjay_downloader_get_anjay(dl)->downloader == dl);
     assert(out_handle);
 
+    if (config->block_buffer_provider
+            && (!config->block_buffer_provider->acquire
+                || !config->block_buffer_provider->release)) {
+        dl_log(ERROR, _("incomplete block buffer provider"));
+        return avs_errno(AVS_EINVAL);
+    }
+
     anjay_downloader_ctx_constructor_t *constructor = NULL;
     anjay_socket_transport_t transport;
     avs_error_t err = find_downloader_ctx_constructor(config->url, &constructor,
@@ -313,8 +638,11 @@ avs_error_t _anjay_downloader_download(anjay_downloader_t *dl,
         if (_anjay_socket_transport_included(
                     _anjay_downloader_get_anjay(dl)->online_transports,
                     transport)) {
+            ANJAY_MEMORY_TAG_ENTER(prev_memory_tag,
+                                   ANJAY_MEMORY_TAG_DOWNLOADER);
             err = constructor(dl, &dl_ctx, config, find_free_id(dl),
                               forced_coap_ctx, forced_coap_socket);
+            ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
         } else {
             dl_log(WARNING, _("transport currently offline for URL: ") "%s",
                    config->url);
@@ -323,6 +651,16 @@ avs_error_t _anjay_downloader_download(anjay_downloader_t *dl,
     }
 
     if (dl_ctx) {
+        dl_ctx->common.max_bytes_per_second = config->max_bytes_per_second;
+        dl_ctx->common.pause_during_confirmable_notifications =
+                config->pause_during_confirmable_notifications;
+        dl_ctx->common.rate_limit_start = AVS_TIME_MONOTONIC_INVALID;
+        dl_ctx->common.stats.rtt = AVS_TIME_DURATION_INVALID;
+        dl_ctx->common.stats.time_suspended = AVS_TIME_DURATION_ZERO;
+        dl_ctx->common.stats_start_time = avs_time_monotonic_now();
+        dl_ctx->common.suspended_since = AVS_TIME_MONOTONIC_INVALID;
+        dl_ctx->common.throughput_window_start = AVS_TIME_MONOTONIC_INVALID;
+        dl_ctx->common.request_sent_time = AVS_TIME_MONOTONIC_INVALID;
         AVS_LIST_APPEND(&dl->downloads, dl_ctx);
 
         assert(dl_ctx->common.id != INVALID_DOWNLOAD_ID);
@@ -351,6 +689,62 @@ _anjay_downloader_set_next_block_offset(anjay_downloader_t *dl,
                                                             next_block_offset);
 }
 
+avs_error_t _anjay_downloader_get_stats(anjay_downloader_t *dl,
+                                        anjay_download_handle_t handle,
+                                        anjay_download_stats_t *out_stats) {
+    uintptr_t id = (uintptr_t) handle;
+
+    AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
+            _anjay_downloader_find_ctx_ptr_by_id(dl, id);
+    if (!ctx_ptr) {
+        dl_log(DEBUG, _("download id = ") "%" PRIuPTR _(" not found"), id);
+        return avs_errno(AVS_ENOENT);
+    }
+    const anjay_download_ctx_common_t *common = &(*ctx_ptr)->common;
+    const avs_time_monotonic_t now = avs_time_monotonic_now();
+    *out_stats = common->stats;
+    if (avs_time_monotonic_valid(common->suspended_since)) {
+        out_stats->time_suspended = avs_time_duration_add(
+                out_stats->time_suspended,
+                avs_time_monotonic_diff(now, common->suspended_since));
+    }
+    out_stats->average_throughput = bytes_per_second(
+            out_stats->bytes_received,
+            avs_time_duration_diff(
+                    avs_time_monotonic_diff(now, common->stats_start_time),
+                    out_stats->time_suspended));
+    if (avs_time_monotonic_valid(common->throughput_window_start)) {
+        // if no data has been received for a while, the last completed
+        // measurement is no longer representative
+        const avs_time_duration_t elapsed =
+                avs_time_monotonic_diff(now, common->throughput_window_start);
+        if (!avs_time_duration_less(
+                    elapsed, avs_time_duration_from_scalar(THROUGHPUT_WINDOW_MS,
+                                                           AVS_TIME_MS))) {
+            out_stats->current_throughput =
+                    bytes_per_second(common->throughput_window_bytes, elapsed);
+        }
+    }
+    return AVS_OK;
+}
+
+avs_error_t _anjay_downloader_set_rate_limit(anjay_downloader_t *dl,
+                                             anjay_download_handle_t handle,
+                                             size_t max_bytes_per_second) {
+    uintptr_t id = (uintptr_t) handle;
+
+    AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
+            _anjay_downloader_find_ctx_ptr_by_id(dl, id);
+    if (!ctx_ptr) {
+        dl_log(DEBUG, _("download id = ") "%" PRIuPTR _(" not found"), id);
+        return avs_errno(AVS_ENOENT);
+    }
+    (*ctx_ptr)->common.max_bytes_per_second = max_bytes_per_second;
+    // restart the measurement, so that the new limit applies from now on
+    (*ctx_ptr)->common.rate_limit_start = AVS_TIME_MONOTONIC_INVALID;
+    return AVS_OK;
+}
+
 void _anjay_downloader_abort(anjay_downloader_t *dl,
                              anjay_download_handle_t handle) {
     uintptr_t id = (uintptr_t) handle;
@@ -384,6 +778,8 @@ void _anjay_downloader_suspend(anjay_downloader_t *dl,
 static void reconnect_job(avs_sched_t *sched, const void *id_ptr) {
     anjay_t *anjay_locked = _anjay_get_from_sched(sched);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    ANJAY_SCHED_JOB_STATS_BEGIN(job_start_time);
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_DOWNLOADER);
     uintptr_t id = *(const uintptr_t *) id_ptr;
     AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
             _anjay_downloader_find_ctx_ptr_by_id(&anjay->downloader, id);
@@ -399,9 +795,25 @@ static void reconnect_job(avs_sched_t *sched, const void *id_ptr) {
             suspend_transfer(*ctx_ptr);
         }
     }
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+    ANJAY_SCHED_JOB_STATS_END(anjay, ANJAY_SCHED_JOB_DOWNLOAD_RECONNECT,
+                              job_start_time);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
 
+#    ifdef ANJAY_WITH_SCHED_STATS
+void _anjay_downloader_collect_sched_jobs(
+        anjay_unlocked_t *anjay, anjay_sched_jobs_collector_t *collector) {
+    AVS_LIST(anjay_download_ctx_t) ctx;
+    AVS_LIST_FOREACH(ctx, anjay->downloader.downloads) {
+        _anjay_sched_jobs_collect(collector,
+                                  ANJAY_SCHED_JOB_DOWNLOAD_RECONNECT,
+                                  ANJAY_SSID_ANY,
+                                  &ctx->common.reconnect_job_handle);
+    }
+}
+#    endif // ANJAY_WITH_SCHED_STATS
+
 int _anjay_downloader_sched_reconnect_ctx(anjay_download_ctx_t *ctx) {
     return AVS_SCHED_NOW(_anjay_downloader_get_anjay(ctx->common.dl)->sched,
                          &ctx->common.reconnect_job_handle, reconnect_job,
@@ -17,6 +17,7 @@
 
 #    include <errno.h>
 #    include <inttypes.h>
+#    include <stdint.h>
 
 #    include <avsystem/commons/avs_errno.h>
 #    include <avsystem/commons/avs_http.h>
@@ -28,13 +29,50 @@
 
 #    include "anjay_private.h"
 
+#    ifdef ANJAY_TEST
+#        include "tests/core/downloader/http_mock.h"
+#    endif // ANJAY_TEST
+
 VISIBILITY_SOURCE_BEGIN
 
+#    define HTTP_PARALLEL_DEFAULT_BUFFER_SIZE 65536
+#    define HTTP_PARALLEL_MIN_RANGE_SIZE 65536
+#    define HTTP_TLS_SESSION_POOL_SIZE 4
+
+/**
+ * TLS session of a finished HTTPS download, kept for subsequent downloads from
+ * the same host and port.
+ */
+struct anjay_http_tls_session {
+    avs_time_monotonic_t expires_at;
+    char port[sizeof("65535")];
+    char session[ANJAY_DTLS_SESSION_BUFFER_SIZE];
+    char host[];
+};
+
+/**
+ * Byte range of the remote resource that is fetched over its own connection
+ * when the download is split into parallel ranges.
+ */
+typedef struct {
+    avs_stream_t *stream;
+    size_t start;    // offset of the first byte of the range
+    size_t end;      // offset one past the last byte of the range
+    size_t received; // number of bytes of the range received so far
+    // Data received while some earlier range was still being delivered; only
+    // used if the data is passed to the user in order
+    uint8_t *buffer;
+    size_t buffered;
+    bool open_attempted;
+} anjay_http_range_t;
+
 typedef struct {
     anjay_download_ctx_common_t common;
     avs_net_ssl_configuration_t ssl_configuration;
     anjay_security_config_cache_t security_config_cache;
     avs_net_resolved_endpoint_t preferred_endpoint;
+    avs_time_duration_t tls_session_reuse_time;
+    char tls_session_buffer[ANJAY_DTLS_SESSION_BUFFER_SIZE];
     avs_time_duration_t request_timeout;
     avs_http_t *client;
     avs_url_t *parsed_url;
@@ -49,6 +87,17 @@ typedef struct {
     // we request Range: bytes=1200-, but the server responds with
     // Content-Range: bytes 1024-..., because it insists on using regular block
     // boundaries; we would then need to ignore 176 bytes without writing them.
+
+    // State related to parallel range downloads:
+    size_t parallel_connections;
+    size_t range_buffer_size;
+    // Offset at which the part of the resource fetched over <c>stream</c>
+    // ends; SIZE_MAX if the download has not been split
+    size_t primary_end;
+    // Remaining ranges, fetched over separate connections, sorted by offset
+    size_t range_count;
+    anjay_http_range_t *ranges;
+    avs_sched_handle_t ranges_job;
 } anjay_http_download_ctx_t;
 
 static int parse_number(const char **inout_ptr, unsigned long long *out_value) {
@@ -65,9 +114,16 @@ static int parse_number(const char **inout_ptr, unsigned long long *out_value) {
     return 0;
 }
 
-static int read_start_byte_from_content_range(const char *content_range,
-                                              uint64_t *out_start_byte) {
-    unsigned long long complete_length;
+/**
+ * Parses the Content-Range header. If @p out_end_byte is NULL, the range is
+ * required to extend up to the end of the resource. @p out_complete_length is
+ * set to 0 if the complete length of the resource is unknown.
+ */
+static int read_content_range(const char *content_range,
+                              uint64_t *out_start_byte,
+                              uint64_t *out_end_byte,
+                              uint64_t *out_complete_length) {
+    unsigned long long complete_length = 0;
     unsigned long long start;
     unsigned long long end;
     if (avs_match_token(&content_range, "bytes", AVS_SPACES)
@@ -77,14 +133,20 @@ static int read_start_byte_from_content_range(const char *content_range,
         return -1;
     }
 
-    *out_start_byte = start;
+    if (strcmp(content_range, "*") != 0
+            && (*content_range == '-'
+                || _anjay_safe_strtoull(content_range, &complete_length)
+                || complete_length < 1 || end >= complete_length
+                || (!out_end_byte && complete_length - 1 != end))) {
+        return -1;
+    }
 
-    return (strcmp(content_range, "*") == 0
-            || (*content_range != '-'
-                && !_anjay_safe_strtoull(content_range, &complete_length)
-                && complete_length >= 1 && complete_length - 1 == end))
-                   ? 0
-                   : -1;
+    *out_start_byte = start;
+    if (out_end_byte) {
+        *out_end_byte = end;
+    }
+    *out_complete_length = complete_length;
+    return 0;
 }
 
 static anjay_etag_t *read_etag(const char *text) {
@@ -107,6 +169,538 @@ static inline bool etag_matches(const anjay_etag_t *etag, const char *text) {
            && memcmp(etag->value, &text[1], etag->size) == 0;
 }
 
+static void cleanup_stream_job(avs_sched_t *sched, const void *stream_ptr) {
+    (void) sched;
+    avs_stream_t *stream = *(avs_stream_t *const *) stream_ptr;
+    avs_stream_cleanup(&stream);
+}
+
+/**
+ * Closes a stream that is no longer needed. Like in cleanup_http_transfer(),
+ * the actual cleanup is deferred, as this might be called from within
+ * anjay_serve() for the stream's own socket.
+ */
+static void release_stream(anjay_unlocked_t *anjay,
+                           avs_stream_t **stream_ptr) {
+    if (*stream_ptr
+            && (!anjay->sched
+                || AVS_SCHED_NOW(anjay->sched, NULL, cleanup_stream_job,
+                                 stream_ptr, sizeof(*stream_ptr)))) {
+        avs_stream_cleanup(stream_ptr);
+    }
+    *stream_ptr = NULL;
+}
+
+static inline size_t range_size(const anjay_http_range_t *range) {
+    return range->end - range->start;
+}
+
+static inline bool ordered_delivery(const anjay_http_download_ctx_t *ctx) {
+    return !ctx->common.on_block_at_offset;
+}
+
+static inline bool primary_finished(const anjay_http_download_ctx_t *ctx) {
+    return ctx->bytes_downloaded >= ctx->primary_end;
+}
+
+/**
+ * Returns the index of the first range that has not been completely passed to
+ * the user yet (or ctx->range_count if there is none). Only meaningful if the
+ * primary part of the download has been finished.
+ */
+static size_t front_range_index(const anjay_http_download_ctx_t *ctx) {
+    size_t index = 0;
+    if (ordered_delivery(ctx)) {
+        while (index < ctx->range_count
+               && ctx->ranges[index].end <= ctx->bytes_written) {
+            ++index;
+        }
+    } else {
+        while (index < ctx->range_count
+               && ctx->ranges[index].received
+                          == range_size(&ctx->ranges[index])) {
+            ++index;
+        }
+    }
+    return index;
+}
+
+static void refresh_timeout(anjay_http_download_ctx_t *ctx) {
+    // NOTE: ctx->next_action_job might be NULL
+    // if anjay_download_suspend() was called
+    if (ctx->next_action_job) {
+        int result = AVS_RESCHED_DELAYED(&ctx->next_action_job,
+                                         ctx->request_timeout);
+        assert(!result);
+        (void) result;
+    }
+}
+
+/**
+ * Pauses reading from the sockets of the transfer if required by the
+ * throttling settings. The data is left in the socket buffers in the meantime,
+ * so TCP flow control slows down the sender.
+ *
+ * @returns true if reading has been paused.
+ */
+static bool pause_if_throttled(anjay_http_download_ctx_t *ctx,
+                               size_t bytes_received) {
+    const avs_time_duration_t delay =
+            _anjay_downloader_throttle_delay(&ctx->common, bytes_received);
+    if (avs_time_duration_equal(delay, AVS_TIME_DURATION_ZERO)
+            || ctx->common.resume_reading_job) {
+        return false;
+    }
+    if (_anjay_downloader_pause_reading(&ctx->common, delay)) {
+        dl_log(WARNING, _("could not schedule throttling job"));
+        return false;
+    }
+    // the transfer shall not time out while it is paused
+    if (ctx->next_action_job) {
+        int result = AVS_RESCHED_DELAYED(
+                &ctx->next_action_job,
+                avs_time_duration_add(ctx->request_timeout, delay));
+        assert(!result);
+        (void) result;
+    }
+    return true;
+}
+
+/**
+ * Passes data found at @p offset of the remote resource to the user. If
+ * @p in_order is true, @p offset MUST NOT be greater than ctx->bytes_written,
+ * and the part of data that lies before it is skipped.
+ */
+static avs_error_t deliver_data(anjay_http_download_ctx_t *ctx,
+                                size_t offset,
+                                const uint8_t *data,
+                                size_t data_size,
+                                bool in_order) {
+    if (!in_order) {
+        return _anjay_downloader_call_on_block_at_offset(
+                &ctx->common, offset, data, data_size, ctx->etag);
+    }
+    assert(offset <= ctx->bytes_written);
+    avs_error_t err = AVS_OK;
+    while (avs_is_ok(err) && offset + data_size > ctx->bytes_written) {
+        size_t original_offset = ctx->bytes_written;
+        size_t skipped = original_offset - offset;
+        if (ctx->common.on_block_at_offset) {
+            err = _anjay_downloader_call_on_block_at_offset(
+                    &ctx->common, original_offset, &data[skipped],
+                    data_size - skipped, ctx->etag);
+        } else {
+            err = _anjay_downloader_call_on_next_block(
+                    &ctx->common, &data[skipped], data_size - skipped,
+                    ctx->etag);
+        }
+        if (avs_is_ok(err) && ctx->bytes_written == original_offset) {
+            ctx->bytes_written = offset + data_size;
+        }
+    }
+    return err;
+}
+
+static void cleanup_ranges(anjay_http_download_ctx_t *ctx) {
+    anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->common.dl);
+    avs_sched_del(&ctx->ranges_job);
+    for (size_t i = 0; i < ctx->range_count; ++i) {
+        release_stream(anjay, &ctx->ranges[i].stream);
+        avs_free(ctx->ranges[i].buffer);
+    }
+    avs_free(ctx->ranges);
+    ctx->ranges = NULL;
+    ctx->range_count = 0;
+    ctx->primary_end = SIZE_MAX;
+}
+
+static void ranges_job(avs_sched_t *sched, const void *id_ptr);
+
+static int schedule_ranges_job(anjay_http_download_ctx_t *ctx) {
+    anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->common.dl);
+    if (ctx->ranges_job) {
+        return 0;
+    }
+    return AVS_SCHED_NOW(anjay->sched, &ctx->ranges_job, ranges_job,
+                         &ctx->common.id, sizeof(ctx->common.id));
+}
+
+/**
+ * Splits the rest of the download into ranges, if possible. Failures are not
+ * fatal - the download continues over a single connection in that case.
+ */
+static void setup_ranges(anjay_http_download_ctx_t *ctx,
+                         uint64_t total_length) {
+    assert(!ctx->ranges);
+    if (!ctx->etag) {
+        dl_log(INFO, _("no ETag received, not splitting the download"));
+        return;
+    }
+    if (total_length <= ctx->bytes_written || total_length > SIZE_MAX) {
+        dl_log(INFO, _("resource size unknown, not splitting the download"));
+        return;
+    }
+    size_t remaining = (size_t) total_length - ctx->bytes_written;
+    size_t count = ctx->parallel_connections;
+    if (remaining / count < HTTP_PARALLEL_MIN_RANGE_SIZE) {
+        count = remaining / HTTP_PARALLEL_MIN_RANGE_SIZE;
+    }
+    if (count <= 1) {
+        return;
+    }
+    if (!(ctx->ranges = (anjay_http_range_t *) avs_calloc(
+                  count - 1, sizeof(anjay_http_range_t)))) {
+        _anjay_log_oom();
+        return;
+    }
+    ctx->range_count = count - 1;
+    size_t chunk_size = remaining / count;
+    for (size_t i = 0; i < ctx->range_count; ++i) {
+        ctx->ranges[i].start = ctx->bytes_written + (i + 1) * chunk_size;
+        ctx->ranges[i].end = (i + 1 < ctx->range_count)
+                                     ? ctx->ranges[i].start + chunk_size
+                                     : (size_t) total_length;
+    }
+    ctx->primary_end = ctx->ranges[0].start;
+    if (schedule_ranges_job(ctx)) {
+        dl_log(WARNING, _("could not schedule range download job"));
+        cleanup_ranges(ctx);
+        return;
+    }
+    dl_log(INFO,
+           _("HTTP transfer id = ") "%" PRIuPTR _(" split into ") "%lu" _(
+                   " ranges"),
+           ctx->common.id, (unsigned long) count);
+}
+
+static int open_range_stream(anjay_http_download_ctx_t *ctx,
+                             anjay_http_range_t *range,
+                             anjay_download_status_t *out_status) {
+    assert(!range->stream);
+    assert(!range->received);
+    assert(ctx->etag);
+    AVS_LIST(const avs_http_header_t) received_headers = NULL;
+    avs_error_t err =
+            avs_http_open_stream(&range->stream, ctx->client, AVS_HTTP_GET,
+                                 AVS_HTTP_CONTENT_IDENTITY, ctx->parsed_url,
+                                 NULL, NULL);
+    if (avs_is_err(err) || !range->stream) {
+        *out_status = _anjay_download_status_failed(
+                avs_is_err(err) ? err : avs_errno(AVS_ENOMEM));
+        return -1;
+    }
+
+    avs_http_set_header_storage(range->stream, &received_headers);
+
+    char ifmatch[258];
+    // see docs on UINT_STR_BUF_SIZE in Commons for details on this formula
+    char range_header[sizeof("bytes=-") + 2 * ((12 * sizeof(size_t)) / 5 + 1)];
+    if (avs_simple_snprintf(ifmatch, sizeof(ifmatch), "\"%.*s\"",
+                            (int) ctx->etag->size, ctx->etag->value)
+                    < 0
+            || avs_http_add_header(range->stream, "If-Match", ifmatch)
+            || avs_simple_snprintf(range_header, sizeof(range_header),
+                                   "bytes=%lu-%lu",
+                                   (unsigned long) range->start,
+                                   (unsigned long) (range->end - 1))
+                           < 0
+            || avs_http_add_header(range->stream, "Range", range_header)) {
+        dl_log(ERROR, _("Could not send range request headers"));
+        *out_status = _anjay_download_status_failed(avs_errno(AVS_ENOMEM));
+        goto error;
+    }
+
+    err = avs_stream_finish_message(range->stream);
+    // the HTTP client might have (re)connected the socket of the stream
+    _anjay_socket_set_changed(_anjay_downloader_get_anjay(ctx->common.dl));
+    if (avs_is_err(err)) {
+        int http_status = 200;
+        if (err.category == AVS_HTTP_ERROR_CATEGORY) {
+            http_status = avs_http_status_code(range->stream);
+        }
+        if (http_status < 200 || http_status >= 300) {
+            dl_log(WARNING, _("HTTP error code ") "%d" _(" received"),
+                   http_status);
+            *out_status = (http_status == 412) // Precondition Failed
+                                  ? _anjay_download_status_expired()
+                                  : _anjay_download_status_invalid_response(
+                                            http_status);
+        } else {
+            dl_log(ERROR, _("Could not send HTTP request: ") "%s",
+                   AVS_COAP_STRERROR(err));
+            *out_status = _anjay_download_status_failed(err);
+        }
+        goto error;
+    }
+
+    bool content_range_valid = false;
+    AVS_LIST(const avs_http_header_t) it;
+    AVS_LIST_FOREACH(it, received_headers) {
+        if (avs_strcasecmp(it->key, "Content-Range") == 0) {
+            uint64_t start;
+            uint64_t end;
+            uint64_t complete_length;
+            content_range_valid =
+                    !read_content_range(it->value, &start, &end,
+                                        &complete_length)
+                    && start == range->start && end == range->end - 1;
+        } else if (avs_strcasecmp(it->key, "ETag") == 0
+                   && !etag_matches(ctx->etag, it->value)) {
+            dl_log(ERROR, _("ETag does not match"));
+            *out_status = _anjay_download_status_expired();
+            goto error;
+        }
+    }
+    if (!content_range_valid) {
+        dl_log(ERROR, _("Server did not respond with the requested range"));
+        *out_status = _anjay_download_status_failed(avs_errno(AVS_EPROTO));
+        goto error;
+    }
+    avs_http_set_header_storage(range->stream, NULL);
+    return 0;
+error:
+    avs_stream_cleanup(&range->stream);
+    return -1;
+}
+
+/**
+ * Moves the in-order delivery position past the ranges that have been fully
+ * received, passing the data buffered for them to the user. Finishes the
+ * transfer if there is nothing more to download.
+ *
+ * @returns 0 if the transfer is still ongoing, or -1 if it has been finished or
+ *          aborted, in which case @p ctx_ptr is no longer valid.
+ */
+static int update_ranges_progress(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
+    anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) *ctx_ptr;
+    if (!primary_finished(ctx)) {
+        return 0;
+    }
+    anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->common.dl);
+    anjay_http_range_t *range;
+    while (true) {
+        size_t index = front_range_index(ctx);
+        if (!ordered_delivery(ctx)) {
+            ctx->bytes_written =
+                    (index < ctx->range_count)
+                            ? ctx->ranges[index].start
+                                      + ctx->ranges[index].received
+                            : ctx->ranges[ctx->range_count - 1].end;
+        }
+        if (index >= ctx->range_count) {
+            dl_log(INFO, _("HTTP transfer id = ") "%" PRIuPTR _(" finished"),
+                   ctx->common.id);
+            _anjay_downloader_abort_transfer(ctx_ptr,
+                                             _anjay_download_status_success());
+            return -1;
+        }
+        for (size_t i = 0; i < index; ++i) {
+            // ranges skipped using anjay_download_set_next_block_offset()
+            release_stream(anjay, &ctx->ranges[i].stream);
+            avs_free(ctx->ranges[i].buffer);
+            ctx->ranges[i].buffer = NULL;
+            ctx->ranges[i].buffered = 0;
+        }
+        range = &ctx->ranges[index];
+        if (!ordered_delivery(ctx) || !range->buffered) {
+            break;
+        }
+        // pass the data received while the range was not the front one
+        uint8_t *data = range->buffer;
+        size_t data_size = range->buffered;
+        range->buffer = NULL;
+        range->buffered = 0;
+        avs_error_t err =
+                deliver_data(ctx, range->start, data, data_size, true);
+        avs_free(data);
+        if (avs_is_err(err)) {
+            _anjay_downloader_abort_transfer(
+                    ctx_ptr, _anjay_download_status_failed(err));
+            return -1;
+        }
+    }
+    if ((!range->stream || avs_stream_nonblock_read_ready(range->stream))
+            && schedule_ranges_job(ctx)) {
+        dl_log(ERROR, _("could not schedule range download job"));
+        _anjay_downloader_abort_transfer(
+                ctx_ptr, _anjay_download_status_failed(avs_errno(AVS_ENOMEM)));
+        return -1;
+    }
+    return 0;
+}
+
+static int
+handle_range_packet_with_locked_buffer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr,
+                                       size_t index,
+                                       uint8_t *buffer) {
+    anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) *ctx_ptr;
+    anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->common.dl);
+    anjay_http_range_t *range = &ctx->ranges[index];
+    const bool in_order = ordered_delivery(ctx) && primary_finished(ctx)
+                          && front_range_index(ctx) == index;
+    const bool buffering = ordered_delivery(ctx) && !in_order;
+    bool nonblock_read_ready;
+    bool paused = false;
+    do {
+        uint8_t *target = buffer;
+        size_t target_size = anjay->in_shared_buffer->capacity;
+        if (buffering) {
+            if (!range->buffer
+                    && !(range->buffer = (uint8_t *) avs_malloc(
+                                 ctx->range_buffer_size))) {
+                _anjay_log_oom();
+                _anjay_downloader_abort_transfer(
+                        ctx_ptr,
+                        _anjay_download_status_failed(avs_errno(AVS_ENOMEM)));
+                return -1;
+            }
+            target = &range->buffer[range->buffered];
+            target_size = ctx->range_buffer_size - range->buffered;
+        }
+        target_size = AVS_MIN(target_size, range_size(range) - range->received);
+        if (!target_size) {
+            // buffer is full; reading will be resumed when it is passed to
+            // the user
+            break;
+        }
+
+        size_t bytes_read;
+        bool message_finished = false;
+        avs_error_t err = avs_stream_read(range->stream, &bytes_read,
+                                          &message_finished, target,
+                                          target_size);
+        if (avs_is_err(err)) {
+            _anjay_downloader_abort_transfer(
+                    ctx_ptr, _anjay_download_status_failed(err));
+            return -1;
+        }
+        if (bytes_read) {
+            size_t offset = range->start + range->received;
+            range->received += bytes_read;
+            if (buffering) {
+                range->buffered += bytes_read;
+            } else if (avs_is_err((err = deliver_data(ctx, offset, target,
+                                                      bytes_read, in_order)))) {
+                _anjay_downloader_abort_transfer(
+                        ctx_ptr, _anjay_download_status_failed(err));
+                return -1;
+            }
+        }
+        if (range->received == range_size(range)) {
+            release_stream(anjay, &range->stream);
+            break;
+        }
+        if (message_finished) {
+            dl_log(ERROR, _("HTTP range ends prematurely"));
+            _anjay_downloader_abort_transfer(
+                    ctx_ptr,
+                    _anjay_download_status_failed(avs_errno(AVS_EPROTO)));
+            return -1;
+        }
+        if ((paused = pause_if_throttled(ctx, bytes_read))) {
+            break;
+        }
+        nonblock_read_ready = avs_stream_nonblock_read_ready(range->stream);
+    } while (nonblock_read_ready);
+    if (!paused) {
+        refresh_timeout(ctx);
+    }
+    return update_ranges_progress(ctx_ptr);
+}
+
+static int handle_range_packet(AVS_LIST(anjay_download_ctx_t) *ctx_ptr,
+                               size_t index) {
+    anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) *ctx_ptr;
+    anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->common.dl);
+    uint8_t *buffer = avs_shared_buffer_acquire(anjay->in_shared_buffer);
+    assert(buffer);
+    int result = handle_range_packet_with_locked_buffer(ctx_ptr, index, buffer);
+    avs_shared_buffer_release(anjay->in_shared_buffer);
+    return result;
+}
+
+static void process_ranges(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
+    anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) *ctx_ptr;
+    const size_t front =
+            primary_finished(ctx) ? front_range_index(ctx) : SIZE_MAX;
+    for (size_t i = 0; i < ctx->range_count; ++i) {
+        anjay_http_range_t *range = &ctx->ranges[i];
+        if (range->stream || range->received == range_size(range)
+                || (range->open_attempted && i != front)) {
+            continue;
+        }
+        // Ranges that could not be opened are retried once all the previous
+        // ones have been passed to the user. Failure at that point is fatal.
+        range->open_attempted = true;
+        anjay_download_status_t status;
+        if (open_range_stream(ctx, range, &status) && i == front) {
+            _anjay_downloader_abort_transfer(ctx_ptr, status);
+            return;
+        }
+    }
+    // If the beginning of the response body has been read along with the
+    // headers, poll() will not report it; see also send_request_unlocked()
+    for (size_t i = 0; i < ctx->range_count && !ctx->common.resume_reading_job;
+         ++i) {
+        if (ctx->ranges[i].stream
+                && avs_stream_nonblock_read_ready(ctx->ranges[i].stream)
+                && handle_range_packet(ctx_ptr, i)) {
+            return;
+        }
+    }
+}
+
+static void ranges_job(avs_sched_t *sched, const void *id_ptr) {
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    uintptr_t id = *(const uintptr_t *) id_ptr;
+    AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
+            _anjay_downloader_find_ctx_ptr_by_id(&anjay->downloader, id);
+    if (!ctx_ptr) {
+        dl_log(DEBUG, _("download id = ") "%" PRIuPTR _("expired"), id);
+    } else {
+        process_ranges(ctx_ptr);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+/**
+ * Reads a chunk of the primary HTTP stream into @p buffer and passes it to the
+ * user. If a block buffer provider is configured, the chunk is read directly
+ * into a buffer acquired from it instead.
+ */
+static avs_error_t read_and_deliver_primary(anjay_http_download_ctx_t *ctx,
+                                            uint8_t *buffer,
+                                            bool *out_message_finished) {
+    anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->common.dl);
+    const anjay_download_block_buffer_provider_t *provider =
+            ctx->common.block_buffer_provider;
+    size_t buffer_size = anjay->in_shared_buffer->capacity;
+    if (provider
+            && !(buffer = _anjay_downloader_acquire_block_buffer(
+                         anjay, provider, &buffer_size))) {
+        dl_log(ERROR, _("could not acquire block buffer"));
+        return avs_errno(AVS_ENOMEM);
+    }
+    size_t bytes_read;
+    // if the download has been split, only read up to the first range
+    size_t read_size =
+            AVS_MIN(buffer_size, ctx->primary_end - ctx->bytes_downloaded);
+    avs_error_t err = avs_stream_read(ctx->stream, &bytes_read,
+                                      out_message_finished, buffer, read_size);
+    if (avs_is_ok(err) && bytes_read) {
+        size_t offset = ctx->bytes_downloaded;
+        ctx->bytes_downloaded += bytes_read;
+        ctx->common.delivering_from_block_buffer = !!provider;
+        err = deliver_data(ctx, offset, buffer, bytes_read, true);
+        ctx->common.delivering_from_block_buffer = false;
+    }
+    if (provider) {
+        _anjay_downloader_release_block_buffer(anjay, provider, buffer);
+    }
+    return err;
+}
+
 static void
 handle_http_packet_with_locked_buffer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr,
                                       uint8_t *buffer) {
@@ -114,37 +708,28 @@ handle_http_packet_with_locked_buffer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr,
     anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->common.dl);
     bool nonblock_read_ready;
     do {
-        size_t bytes_read;
         bool message_finished = false;
-
+        const size_t previous_bytes_downloaded = ctx->bytes_downloaded;
         avs_error_t err =
-                avs_stream_read(ctx->stream, &bytes_read, &message_finished,
-                                buffer, anjay->in_shared_buffer->capacity);
+                read_and_deliver_primary(ctx, buffer, &message_finished);
         if (avs_is_err(err)) {
             _anjay_downloader_abort_transfer(
                     ctx_ptr, _anjay_download_status_failed(err));
             return;
         }
-        if (bytes_read) {
-            assert(ctx->bytes_written >= ctx->bytes_downloaded);
-            ctx->bytes_downloaded += bytes_read;
-            while (ctx->bytes_downloaded > ctx->bytes_written) {
-                size_t bytes_to_write =
-                        ctx->bytes_downloaded - ctx->bytes_written;
-                assert(bytes_read >= bytes_to_write);
-                size_t original_offset = ctx->bytes_written;
-                if (avs_is_err((err = _anjay_downloader_call_on_next_block(
-                                        &ctx->common,
-                                        &buffer[bytes_read - bytes_to_write],
-                                        bytes_to_write, ctx->etag)))) {
-                    _anjay_downloader_abort_transfer(
-                            ctx_ptr, _anjay_download_status_failed(err));
-                    return;
-                }
-                if (ctx->bytes_written == original_offset) {
-                    ctx->bytes_written += bytes_to_write;
-                }
-            }
+        if (primary_finished(ctx)) {
+            // the rest of the resource is downloaded using the ranges
+            release_stream(anjay, &ctx->stream);
+            refresh_timeout(ctx);
+            (void) update_ranges_progress(ctx_ptr);
+            return;
+        }
+        if (message_finished && ctx->range_count) {
+            dl_log(ERROR, _("HTTP response ends prematurely"));
+            _anjay_downloader_abort_transfer(
+                    ctx_ptr,
+                    _anjay_download_status_failed(avs_errno(AVS_EPROTO)));
+            return;
         }
         if (message_finished) {
             dl_log(INFO, _("HTTP transfer id = ") "%" PRIuPTR _(" finished"),
@@ -153,16 +738,13 @@ handle_http_packet_with_locked_buffer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr,
                                              _anjay_download_status_success());
             return;
         }
+        if (pause_if_throttled(ctx, ctx->bytes_downloaded
+                                            - previous_bytes_downloaded)) {
+            return;
+        }
         nonblock_read_ready = avs_stream_nonblock_read_ready(ctx->stream);
     } while (nonblock_read_ready);
-    // NOTE: ctx->next_action_job might be NULL
-    // if anjay_download_suspend() was called
-    if (ctx->next_action_job) {
-        int result = AVS_RESCHED_DELAYED(&ctx->next_action_job,
-                                         ctx->request_timeout);
-        assert(!result);
-        (void) result;
-    }
+    refresh_timeout(ctx);
 }
 
 static void handle_http_packet(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
@@ -174,6 +756,21 @@ static void handle_http_packet(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
     avs_shared_buffer_release(anjay->in_shared_buffer);
 }
 
+static void resume_http_reading(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
+    anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) *ctx_ptr;
+    refresh_timeout(ctx);
+    // data already buffered in the streams is not reported by poll()
+    if (ctx->range_count && schedule_ranges_job(ctx)) {
+        dl_log(ERROR, _("could not schedule range download job"));
+        _anjay_downloader_abort_transfer(
+                ctx_ptr, _anjay_download_status_failed(avs_errno(AVS_ENOMEM)));
+        return;
+    }
+    if (ctx->stream && avs_stream_nonblock_read_ready(ctx->stream)) {
+        handle_http_packet(ctx_ptr);
+    }
+}
+
 static void timeout_job(avs_sched_t *sched, const void *id_ptr) {
     anjay_t *anjay_locked = _anjay_get_from_sched(sched);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
@@ -242,7 +839,12 @@ static void send_request_unlocked(anjay_unlocked_t *anjay, uintptr_t id) {
         }
     }
 
-    if (avs_is_err((err = avs_stream_finish_message(ctx->stream)))) {
+    _anjay_downloader_stats_request_sent(&ctx->common);
+    err = avs_stream_finish_message(ctx->stream);
+    _anjay_downloader_stats_response_received(&ctx->common);
+    // the HTTP client might have (re)connected the socket of the stream
+    _anjay_socket_set_changed(anjay);
+    if (avs_is_err(err)) {
         int http_status = 200;
         if (err.category == AVS_HTTP_ERROR_CATEGORY) {
             http_status = avs_http_status_code(ctx->stream);
@@ -269,11 +871,17 @@ static void send_request_unlocked(anjay_unlocked_t *anjay, uintptr_t id) {
 
     ctx->bytes_downloaded = 0;
 
+    // used to determine whether the download can be split into ranges
+    uint64_t complete_length = 0;
+    unsigned long long content_length = 0;
+    bool content_range_received = false;
+    bool accepts_ranges = false;
     AVS_LIST(const avs_http_header_t) it;
     AVS_LIST_FOREACH(it, received_headers) {
         if (avs_strcasecmp(it->key, "Content-Range") == 0) {
             uint64_t bytes_downloaded;
-            if (read_start_byte_from_content_range(it->value, &bytes_downloaded)
+            if (read_content_range(it->value, &bytes_downloaded, NULL,
+                                   &complete_length)
                     || bytes_downloaded > ctx->bytes_written) {
                 dl_log(ERROR,
                        _("Could not resume HTTP download: invalid "
@@ -285,6 +893,13 @@ static void send_request_unlocked(anjay_unlocked_t *anjay, uintptr_t id) {
                 return;
             }
             ctx->bytes_downloaded = (size_t) bytes_downloaded;
+            content_range_received = true;
+        } else if (avs_strcasecmp(it->key, "Accept-Ranges") == 0) {
+            accepts_ranges = (avs_strcasecmp(it->value, "bytes") == 0);
+        } else if (avs_strcasecmp(it->key, "Content-Length") == 0) {
+            if (_anjay_safe_strtoull(it->value, &content_length)) {
+                content_length = 0;
+            }
         } else if (avs_strcasecmp(it->key, "ETag") == 0) {
             if (ctx->etag) {
                 if (!etag_matches(ctx->etag, it->value)) {
@@ -302,6 +917,18 @@ static void send_request_unlocked(anjay_unlocked_t *anjay, uintptr_t id) {
     }
     avs_http_set_header_storage(ctx->stream, NULL);
 
+    if (ctx->parallel_connections > 1) {
+        if (content_range_received) {
+            setup_ranges(ctx, complete_length);
+        } else if (accepts_ranges) {
+            // full response, Content-Length is the size of the resource
+            setup_ranges(ctx, content_length);
+        } else {
+            dl_log(INFO, _("server does not support byte ranges, not "
+                           "splitting the download"));
+        }
+    }
+
     if (AVS_SCHED_DELAYED(anjay->sched, &ctx->next_action_job,
                           ctx->request_timeout, timeout_job, &ctx->common.id,
                           sizeof(ctx->common.id))) {
@@ -347,9 +974,126 @@ get_http_socket_transport(anjay_download_ctx_t *ctx) {
     return ANJAY_SOCKET_TRANSPORT_TCP;
 }
 
+static size_t get_http_extra_socket_count(anjay_download_ctx_t *ctx) {
+    return ((anjay_http_download_ctx_t *) ctx)->range_count;
+}
+
+static avs_net_socket_t *get_http_extra_socket(anjay_download_ctx_t *ctx_,
+                                               size_t index,
+                                               bool polled_only) {
+    anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) ctx_;
+    assert(index < ctx->range_count);
+    const anjay_http_range_t *range = &ctx->ranges[index];
+    if (!range->stream
+            || (polled_only && ordered_delivery(ctx)
+                && range->buffered >= ctx->range_buffer_size)) {
+        // reading from ranges with full buffers is paused
+        return NULL;
+    }
+    return avs_stream_net_getsock(range->stream);
+}
+
+static void handle_http_extra_packet(AVS_LIST(anjay_download_ctx_t) *ctx_ptr,
+                                     size_t index) {
+    (void) handle_range_packet(ctx_ptr, index);
+}
+
+static bool session_data_present(const char *buffer, size_t buffer_size) {
+    // unused parts of the buffer are zero-filled
+    for (size_t i = 0; i < buffer_size; ++i) {
+        if (buffer[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static const char *tls_session_port(const avs_url_t *url) {
+    const char *port = avs_url_port(url);
+    return port ? port : "443";
+}
+
+/**
+ * Returns a pointer to the pooled session for the host and port of @p url , or
+ * to the list end if there is none. Expired sessions encountered on the way
+ * are removed.
+ */
+static AVS_LIST(anjay_http_tls_session_t) *
+find_tls_session_ptr(anjay_downloader_t *dl, const avs_url_t *url) {
+    const char *host = avs_url_host(url);
+    const char *port = tls_session_port(url);
+    const avs_time_monotonic_t now = avs_time_monotonic_now();
+    AVS_LIST(anjay_http_tls_session_t) *session_ptr = &dl->http_tls_sessions;
+    while (*session_ptr) {
+        if (!avs_time_monotonic_before(now, (*session_ptr)->expires_at)) {
+            AVS_LIST_DELETE(session_ptr);
+        } else if (host && !strcmp((*session_ptr)->host, host)
+                   && !strcmp((*session_ptr)->port, port)) {
+            break;
+        } else {
+            AVS_LIST_ADVANCE_PTR(&session_ptr);
+        }
+    }
+    return session_ptr;
+}
+
+static void restore_tls_session(anjay_http_download_ctx_t *ctx) {
+    AVS_LIST(anjay_http_tls_session_t) session =
+            *find_tls_session_ptr(ctx->common.dl, ctx->parsed_url);
+    if (session) {
+        dl_log(DEBUG,
+               _("using TLS session of a previous download from ") "%s",
+               session->host);
+        memcpy(ctx->tls_session_buffer, session->session,
+               sizeof(ctx->tls_session_buffer));
+    }
+}
+
+static void store_tls_session(anjay_http_download_ctx_t *ctx) {
+    const char *host = avs_url_host(ctx->parsed_url);
+    const char *port = tls_session_port(ctx->parsed_url);
+    if (!avs_time_duration_less(AVS_TIME_DURATION_ZERO,
+                                ctx->tls_session_reuse_time)
+            || !host
+            || strlen(port) >= sizeof(((anjay_http_tls_session_t *) 0)->port)
+            || !session_data_present(ctx->tls_session_buffer,
+                                     sizeof(ctx->tls_session_buffer))) {
+        return;
+    }
+    AVS_LIST(anjay_http_tls_session_t) *session_ptr =
+            find_tls_session_ptr(ctx->common.dl, ctx->parsed_url);
+    AVS_LIST(anjay_http_tls_session_t) session = NULL;
+    if (*session_ptr) {
+        session = AVS_LIST_DETACH(session_ptr);
+    } else {
+        if (AVS_LIST_SIZE(ctx->common.dl->http_tls_sessions)
+                >= HTTP_TLS_SESSION_POOL_SIZE) {
+            AVS_LIST_DELETE(&ctx->common.dl->http_tls_sessions);
+        }
+        if (!(session = (AVS_LIST(anjay_http_tls_session_t))
+                      AVS_LIST_NEW_BUFFER(sizeof(anjay_http_tls_session_t)
+                                          + strlen(host) + 1))) {
+            _anjay_log_oom();
+            return;
+        }
+        strcpy(session->port, port);
+        strcpy(session->host, host);
+    }
+    session->expires_at = avs_time_monotonic_add(avs_time_monotonic_now(),
+                                                 ctx->tls_session_reuse_time);
+    memcpy(session->session, ctx->tls_session_buffer,
+           sizeof(session->session));
+    AVS_LIST_APPEND(&ctx->common.dl->http_tls_sessions, session);
+}
+
+void _anjay_downloader_http_tls_sessions_cleanup(anjay_downloader_t *dl) {
+    AVS_LIST_CLEAR(&dl->http_tls_sessions);
+}
+
 static void
 cleanup_http_stream_unlocked(AVS_LIST(anjay_download_ctx_t) detached_ctx) {
     anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) detached_ctx;
+    assert(!ctx->ranges);
     avs_free(ctx->etag);
     avs_stream_cleanup(&ctx->stream);
     avs_url_free(ctx->parsed_url);
@@ -373,6 +1117,10 @@ static void cleanup_http_transfer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
     anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->common.dl);
 
     avs_sched_del(&ctx->next_action_job);
+    cleanup_ranges(ctx);
+    if (ctx->parsed_url) {
+        store_tls_session(ctx);
+    }
     AVS_LIST(anjay_download_ctx_t) detached_ctx = AVS_LIST_DETACH(ctx_ptr);
     /**
      * HACK: this is necessary, because the download might be aborted from
@@ -391,12 +1139,15 @@ static void cleanup_http_transfer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
 static void suspend_http_transfer(anjay_download_ctx_t *ctx_) {
     anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) ctx_;
     avs_sched_del(&ctx->next_action_job);
+    // the download is split anew after reconnecting
+    cleanup_ranges(ctx);
     avs_stream_cleanup(&ctx->stream);
 }
 
 static avs_error_t
 reconnect_http_transfer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
     anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) *ctx_ptr;
+    cleanup_ranges(ctx);
     avs_stream_cleanup(&ctx->stream);
     anjay_unlocked_t *anjay = _anjay_downloader_get_anjay(ctx->common.dl);
     if (AVS_SCHED_NOW(anjay->sched, &ctx->next_action_job, send_request,
@@ -410,6 +1161,11 @@ reconnect_http_transfer(AVS_LIST(anjay_download_ctx_t) *ctx_ptr) {
 static avs_error_t set_next_http_block_offset(anjay_download_ctx_t *ctx_,
                                               size_t next_block_offset) {
     anjay_http_download_ctx_t *ctx = (anjay_http_download_ctx_t *) ctx_;
+    if (ctx->common.on_block_at_offset) {
+        dl_log(DEBUG, _("download offset cannot be changed when data is "
+                        "passed at arbitrary offsets"));
+        return avs_errno(AVS_ENOTSUP);
+    }
     if (next_block_offset <= ctx->bytes_written) {
         dl_log(DEBUG, _("attempted to move download offset backwards"));
         return avs_errno(AVS_EINVAL);
@@ -539,7 +1295,8 @@ _anjay_downloader_http_ctx_new(anjay_downloader_t *dl,
     (void) forced_coap_ctx;
     (void) forced_coap_socket;
 
-    if (!cfg->on_next_block || !cfg->on_download_finished) {
+    if ((!cfg->on_next_block && !cfg->on_block_at_offset)
+            || !cfg->on_download_finished) {
         dl_log(ERROR, _("invalid download config: handlers not set up"));
         return avs_errno(AVS_EINVAL);
     }
@@ -559,12 +1316,16 @@ _anjay_downloader_http_ctx_new(anjay_downloader_t *dl,
         .cleanup = cleanup_http_transfer,
         .suspend = suspend_http_transfer,
         .reconnect = reconnect_http_transfer,
-        .set_next_block_offset = set_next_http_block_offset
+        .set_next_block_offset = set_next_http_block_offset,
+        .get_extra_socket_count = get_http_extra_socket_count,
+        .get_extra_socket = get_http_extra_socket,
+        .handle_extra_packet = handle_http_extra_packet,
+        .resume_reading = resume_http_reading
     };
     ctx->common.vtable = &VTABLE;
 
     avs_http_buffer_sizes_t http_buffer_sizes = AVS_HTTP_DEFAULT_BUFFER_SIZES;
-    if (cfg->start_offset > 0) {
+    if (cfg->start_offset > 0 || cfg->http_parallel_connections > 1) {
         // prevent sending Accept-Encoding
         http_buffer_sizes.content_coding_input = 0;
     }
@@ -619,11 +1380,32 @@ _anjay_downloader_http_ctx_new(anjay_downloader_t *dl,
     }
 
     ctx->common.dl = dl;
+    const char *protocol = avs_url_protocol(ctx->parsed_url);
+    if (avs_time_duration_less(AVS_TIME_DURATION_ZERO,
+                               cfg->http_tls_session_reuse_time)
+            && protocol && !avs_strcasecmp(protocol, "https")) {
+        // ssl_configuration is referenced, not copied, by the HTTP client
+        ctx->tls_session_reuse_time = cfg->http_tls_session_reuse_time;
+        ctx->ssl_configuration.session_resumption_buffer =
+                ctx->tls_session_buffer;
+        ctx->ssl_configuration.session_resumption_buffer_size =
+                sizeof(ctx->tls_session_buffer);
+        restore_tls_session(ctx);
+    }
     ctx->common.id = id;
     ctx->common.on_next_block = cfg->on_next_block;
+    ctx->common.on_block_at_offset = cfg->on_block_at_offset;
     ctx->common.on_download_finished = cfg->on_download_finished;
     ctx->common.user_data = cfg->user_data;
+    if (!cfg->on_block_at_offset) {
+        ctx->common.block_buffer_provider = cfg->block_buffer_provider;
+    }
     ctx->bytes_written = cfg->start_offset;
+    ctx->parallel_connections = cfg->http_parallel_connections;
+    ctx->range_buffer_size = cfg->http_parallel_buffer_size
+                                     ? cfg->http_parallel_buffer_size
+                                     : HTTP_PARALLEL_DEFAULT_BUFFER_SIZE;
+    ctx->primary_end = SIZE_MAX;
     if (cfg->etag) {
         if (!(ctx->etag = anjay_etag_clone(cfg->etag))) {
             dl_log(ERROR, _("could not copy ETag"));
@@ -648,4 +1430,8 @@ error:
     return err;
 }
 
+#    ifdef ANJAY_TEST
+#        include "tests/core/downloader/http.c"
+#    endif // ANJAY_TEST
+
 #endif // ANJAY_WITH_HTTP_DOWNLOAD
@@ -30,6 +30,26 @@ typedef struct {
     avs_error_t (*reconnect)(AVS_LIST(anjay_download_ctx_t) *ctx_ptr);
     avs_error_t (*set_next_block_offset)(anjay_download_ctx_t *ctx,
                                          size_t next_block_offset);
+    /**
+     * Optional. Transfers that may use more than one socket at a time (i.e.
+     * parallel HTTP range downloads) report the additional sockets through
+     * @ref get_extra_socket, for indices lower than the value returned by
+     * @ref get_extra_socket_count. NULL may be returned for indices that do not
+     * currently have a socket - or, if @p polled_only is true, a socket that
+     * shall be polled. Packets received on those sockets are handled by
+     * @ref handle_extra_packet.
+     */
+    size_t (*get_extra_socket_count)(anjay_download_ctx_t *ctx);
+    avs_net_socket_t *(*get_extra_socket)(anjay_download_ctx_t *ctx,
+                                          size_t index,
+                                          bool polled_only);
+    void (*handle_extra_packet)(AVS_LIST(anjay_download_ctx_t) *ctx_ptr,
+                                size_t index);
+    /**
+     * Optional. Called when reading from the sockets of the transfer, paused
+     * using @ref _anjay_downloader_pause_reading, is allowed again.
+     */
+    void (*resume_reading)(AVS_LIST(anjay_download_ctx_t) *ctx_ptr);
 } anjay_download_ctx_vtable_t;
 
 typedef struct {
@@ -40,12 +60,34 @@ typedef struct {
     avs_sched_handle_t reconnect_job_handle;
 
     anjay_download_next_block_handler_t *on_next_block;
+    anjay_download_block_at_offset_handler_t *on_block_at_offset;
     anjay_download_finished_handler_t *on_download_finished;
     void *user_data;
 
+    const anjay_download_block_buffer_provider_t *block_buffer_provider;
+    // Set while the data being delivered already resides in a buffer obtained
+    // from block_buffer_provider.
+    bool delivering_from_block_buffer;
+
     bool administratively_suspended;
     // This download re-uses socket of the already existing connection.
     bool same_socket_download;
+
+    // Throttling state; see _anjay_downloader_throttle_delay()
+    size_t max_bytes_per_second;
+    bool pause_during_confirmable_notifications;
+    avs_time_monotonic_t rate_limit_start;
+    size_t rate_limit_bytes;
+    // Scheduled while the sockets of the transfer are not supposed to be read
+    avs_sched_handle_t resume_reading_job;
+
+    // Transfer statistics; see _anjay_downloader_get_stats()
+    anjay_download_stats_t stats;
+    avs_time_monotonic_t stats_start_time;
+    avs_time_monotonic_t suspended_since;
+    avs_time_monotonic_t throughput_window_start;
+    size_t throughput_window_bytes;
+    avs_time_monotonic_t request_sent_time;
 } anjay_download_ctx_common_t;
 
 static inline anjay_unlocked_t *
@@ -67,6 +109,63 @@ _anjay_downloader_call_on_next_block(anjay_download_ctx_common_t *ctx,
                                      size_t data_size,
                                      const anjay_etag_t *etag);
 
+uint8_t *_anjay_downloader_acquire_block_buffer(
+        anjay_unlocked_t *anjay,
+        const anjay_download_block_buffer_provider_t *provider,
+        size_t *out_size);
+
+void _anjay_downloader_release_block_buffer(
+        anjay_unlocked_t *anjay,
+        const anjay_download_block_buffer_provider_t *provider,
+        uint8_t *buffer);
+
+/**
+ * Marks the moment a request has been sent, for the purpose of measuring RTT.
+ */
+static inline void
+_anjay_downloader_stats_request_sent(anjay_download_ctx_common_t *ctx) {
+    ctx->request_sent_time = avs_time_monotonic_now();
+}
+
+/**
+ * Updates the RTT measurement after receiving a response to the request
+ * previously passed to @ref _anjay_downloader_stats_request_sent.
+ */
+static inline void
+_anjay_downloader_stats_response_received(anjay_download_ctx_common_t *ctx) {
+    if (avs_time_monotonic_valid(ctx->request_sent_time)) {
+        ctx->stats.rtt = avs_time_monotonic_diff(avs_time_monotonic_now(),
+                                                 ctx->request_sent_time);
+        ctx->request_sent_time = AVS_TIME_MONOTONIC_INVALID;
+    }
+}
+
+/**
+ * Accounts for @p bytes_received bytes of the transfer having been received,
+ * and returns the time for which the transfer shall be paused before receiving
+ * any more data, so that the configured rate limit is not exceeded, and no
+ * data is received while confirmable notifications are being delivered (if
+ * configured so). AVS_TIME_DURATION_ZERO is returned if no pause is necessary.
+ */
+avs_time_duration_t
+_anjay_downloader_throttle_delay(anjay_download_ctx_common_t *ctx,
+                                 size_t bytes_received);
+
+/**
+ * Stops reporting the sockets of the transfer in @ref
+ * _anjay_downloader_get_sockets and handling packets received on them for
+ * @p delay. The resume_reading vtable method is called afterwards.
+ */
+int _anjay_downloader_pause_reading(anjay_download_ctx_common_t *ctx,
+                                    avs_time_duration_t delay);
+
+avs_error_t
+_anjay_downloader_call_on_block_at_offset(anjay_download_ctx_common_t *ctx,
+                                          size_t offset,
+                                          const uint8_t *data,
+                                          size_t data_size,
+                                          const anjay_etag_t *etag);
+
 static inline anjay_download_status_t _anjay_download_status_success(void) {
     return (anjay_download_status_t) {
         .result = ANJAY_DOWNLOAD_FINISHED
@@ -119,6 +218,8 @@ anjay_downloader_ctx_constructor_t _anjay_downloader_coap_ctx_new;
 
 #ifdef ANJAY_WITH_HTTP_DOWNLOAD
 anjay_downloader_ctx_constructor_t _anjay_downloader_http_ctx_new;
+
+void _anjay_downloader_http_tls_sessions_cleanup(anjay_downloader_t *dl);
 #endif // ANJAY_WITH_HTTP_DOWNLOAD
 
 VISIBILITY_PRIVATE_HEADER_END
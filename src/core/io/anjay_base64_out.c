@@ -55,21 +55,28 @@ static int base64_ret_encode_and_write(base64_ret_bytes_ctx_t *ctx,
 static int base64_ret_bytes_flush(base64_ret_bytes_ctx_t *ctx,
                                   const uint8_t **dataptr,
                                   size_t bytes_to_write) {
-    uint8_t chunk[TEXT_CHUNK_SIZE];
     while (bytes_to_write > 0) {
-        memcpy(chunk, ctx->bytes_cached, ctx->num_bytes_cached);
         size_t new_bytes_written =
                 AVS_MIN(TEXT_CHUNK_SIZE - ctx->num_bytes_cached,
                         bytes_to_write);
         assert(new_bytes_written <= TEXT_CHUNK_SIZE);
-        memcpy(&chunk[ctx->num_bytes_cached], *dataptr, new_bytes_written);
-        *dataptr += new_bytes_written;
 
         int retval;
-        if ((retval = base64_ret_encode_and_write(
-                     ctx, chunk, new_bytes_written + ctx->num_bytes_cached))) {
+        if (ctx->num_bytes_cached) {
+            uint8_t chunk[TEXT_CHUNK_SIZE];
+            memcpy(chunk, ctx->bytes_cached, ctx->num_bytes_cached);
+            memcpy(&chunk[ctx->num_bytes_cached], *dataptr, new_bytes_written);
+            retval = base64_ret_encode_and_write(
+                    ctx, chunk, new_bytes_written + ctx->num_bytes_cached);
+        } else {
+            // nothing to prepend, encode straight from the caller's buffer
+            retval = base64_ret_encode_and_write(ctx, *dataptr,
+                                                 new_bytes_written);
+        }
+        if (retval) {
             return retval;
         }
+        *dataptr += new_bytes_written;
         bytes_to_write -= new_bytes_written;
         ctx->num_bytes_left -= new_bytes_written;
         ctx->num_bytes_cached = 0;
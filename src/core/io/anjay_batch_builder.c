@@ -13,18 +13,33 @@
 
 #    include "../anjay_access_utils_private.h"
 #    include "../anjay_utils_private.h"
+#    include "../coap/anjay_content_format.h"
 #    include "../dm/anjay_dm_read.h"
 #    include "anjay_batch_builder.h"
 #    include "anjay_vtable.h"
 
-#    include <avsystem/commons/avs_list.h>
+#    include <avsystem/commons/avs_defs.h>
+#    include <avsystem/commons/avs_stream_v_table.h>
 #    include <avsystem/commons/avs_utils.h>
 
+#    ifdef ANJAY_WITH_SEND_PERSISTENCE
+#        include <avsystem/commons/avs_persistence.h>
+#    endif // ANJAY_WITH_SEND_PERSISTENCE
+
 #    ifdef ANJAY_WITH_THREAD_SAFETY
-#        include <avsystem/commons/avs_init_once.h>
-#    endif // ANJAY_WITH_THREAD_SAFETY
+// stdatomic.h is required by ANJAY_WITH_EVENT_LOOP anyway
+#        if defined(ANJAY_WITH_EVENT_LOOP)                                    \
+                || (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L \
+                    && !defined(__STDC_NO_ATOMICS__))
+#            define ANJAY_BATCH_ATOMIC_REF_COUNT
+#            include <stdatomic.h>
+#        else // ANJAY_WITH_EVENT_LOOP || C11 atomics
+#            include <avsystem/commons/avs_init_once.h>
+#        endif // ANJAY_WITH_EVENT_LOOP || C11 atomics
+#    endif     // ANJAY_WITH_THREAD_SAFETY
 
 #    include <anjay_modules/anjay_dm_utils.h>
+#    include <anjay_modules/anjay_memory_accounting.h>
 
 #    include <string.h>
 
@@ -43,8 +58,18 @@ typedef enum {
 #    ifdef ANJAY_WITH_LWM2M11
     ANJAY_BATCH_DATA_UINT,
 #    endif // ANJAY_WITH_LWM2M11
+    ANJAY_BATCH_DATA_DOUBLE_SERIES,
 } anjay_batch_data_type_t;
 
+typedef struct {
+    /**
+     * Time of the sample, in seconds, relative to the timestamp of the entry
+     * it belongs to.
+     */
+    double time_offset;
+    double value;
+} anjay_batch_sample_t;
+
 typedef struct {
     anjay_batch_data_type_t type;
     union {
@@ -63,19 +88,65 @@ typedef struct {
             anjay_oid_t oid;
             anjay_iid_t iid;
         } objlnk;
+        struct {
+            anjay_batch_sample_t *samples;
+            size_t count;
+            size_t capacity;
+        } series;
     } value;
 } anjay_batch_data_t;
 
 struct anjay_batch_entry {
+    anjay_batch_entry_t *next;
     anjay_uri_path_t path;
     anjay_batch_data_t data;
     avs_time_real_t timestamp;
 };
 
+/**
+ * Entries and their payloads are bump-allocated from a growable arena, so that
+ * building a batch requires only a few heap allocations, and the entries are
+ * laid out contiguously in memory. Chunk sizes grow geometrically, so that
+ * small batches (e.g. a single observed Resource) stay small.
+ */
+#    define BATCH_CHUNK_MIN_SIZE 128
+#    define BATCH_CHUNK_MAX_SIZE 2048
+
+/**
+ * Samples of a time series are stored in segments, each of them being a single
+ * entry with its own copy of the path. Segment sizes grow geometrically, just
+ * like chunk sizes, so that short series don't waste memory, and long ones
+ * only need a path copy per BATCH_SERIES_SEGMENT_MAX_SIZE samples.
+ */
+#    define BATCH_SERIES_SEGMENT_MIN_SIZE 8
+#    define BATCH_SERIES_SEGMENT_MAX_SIZE 64
+
+struct anjay_batch_external {
+    anjay_batch_external_t *prev;
+    anjay_batch_release_handler_t *release;
+    void *release_arg;
+    size_t length;
+};
+
 struct anjay_batch_struct {
-    AVS_LIST(anjay_batch_entry_t) list;
+    anjay_growable_arena_t arena;
+    anjay_batch_entry_t *list;
+    anjay_batch_external_t *externals;
+#    ifdef ANJAY_BATCH_ATOMIC_REF_COUNT
+    atomic_size_t ref_count;
+#    else  // ANJAY_BATCH_ATOMIC_REF_COUNT
     size_t ref_count;
+#    endif // ANJAY_BATCH_ATOMIC_REF_COUNT
     avs_time_real_t compilation_time;
+    /**
+     * Numerical values of all entries, in order, if the batch consists of
+     * numeric-typed Resource Instances of a single Multiple-Instance Resource.
+     * Filled on the first call to _anjay_batch_data_numeric_array() (which
+     * sets numeric_array_filled); NULL otherwise.
+     */
+    double *numeric_array;
+    size_t numeric_array_size;
+    bool numeric_array_filled;
 };
 
 struct anjay_batch_data_output_state_struct {
@@ -100,24 +171,80 @@ typedef struct builder_out_struct {
 } builder_out_ctx_t;
 
 anjay_batch_builder_t *_anjay_batch_builder_new(void) {
+    ANJAY_ALLOCATION_SITE_ENTER(prev_site);
     anjay_batch_builder_t *builder =
             (anjay_batch_builder_t *) avs_calloc(1,
                                                  sizeof(anjay_batch_builder_t));
+    ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
     if (!builder) {
         return NULL;
     }
+    _anjay_growable_arena_init(&builder->arena, BATCH_CHUNK_MIN_SIZE,
+                               BATCH_CHUNK_MAX_SIZE);
     builder->append_ptr = &builder->list;
+    builder->series_path = MAKE_ROOT_PATH();
     return builder;
 }
 
-static int make_data_with_duplicated_string(anjay_batch_data_t *batch_data,
+/**
+ * Releases the external buffers more recent than @p until . Needs to be called
+ * before freeing the arena, as the records are allocated from it.
+ */
+static void externals_release(anjay_batch_external_t *externals,
+                              const anjay_batch_external_t *until) {
+    while (externals != until) {
+        anjay_batch_external_t *prev = externals->prev;
+        externals->release(externals->release_arg);
+        externals = prev;
+    }
+}
+
+static void *builder_alloc(anjay_batch_builder_t *builder, size_t size) {
+    ANJAY_ALLOCATION_SITE_ENTER(prev_site);
+    void *result = _anjay_growable_arena_alloc(&builder->arena, size);
+    ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
+    return result;
+}
+
+anjay_batch_builder_mark_t
+_anjay_batch_builder_mark(const anjay_batch_builder_t *builder) {
+    return (anjay_batch_builder_mark_t) {
+        .arena = _anjay_growable_arena_mark(&builder->arena),
+        .append_ptr = builder->append_ptr,
+        .externals = builder->externals
+    };
+}
+
+void _anjay_batch_builder_rollback(anjay_batch_builder_t *builder,
+                                   const anjay_batch_builder_mark_t *mark) {
+    externals_release(builder->externals, mark->externals);
+    builder->externals = mark->externals;
+    _anjay_growable_arena_release(&builder->arena, &mark->arena);
+    builder->append_ptr = mark->append_ptr;
+    *builder->append_ptr = NULL;
+    // the current series segment might have been rolled back
+    builder->series_tail = NULL;
+}
+
+size_t _anjay_batch_builder_entry_count(const anjay_batch_builder_t *builder) {
+    size_t count = 0;
+    for (const anjay_batch_entry_t *it = builder->list; it; it = it->next) {
+        ++count;
+    }
+    return count;
+}
+
+static int make_data_with_duplicated_string(anjay_batch_builder_t *builder,
+                                            anjay_batch_data_t *batch_data,
                                             const char *str) {
     assert(batch_data);
     assert(str);
-    char *new_str = avs_strdup(str);
+    size_t size = strlen(str) + 1;
+    char *new_str = (char *) builder_alloc(builder, size);
     if (!new_str) {
         return -1;
     }
+    memcpy(new_str, str, size);
     *batch_data = (anjay_batch_data_t) {
         .type = ANJAY_BATCH_DATA_STRING,
         .value = {
@@ -127,12 +254,23 @@ static int make_data_with_duplicated_string(anjay_batch_data_t *batch_data,
     return 0;
 }
 
-static void batch_data_cleanup(anjay_batch_data_t *data) {
-    if (data->type == ANJAY_BATCH_DATA_STRING) {
-        avs_free((void *) (intptr_t) data->value.string);
-    } else if (data->type == ANJAY_BATCH_DATA_BYTES) {
-        avs_free((void *) (intptr_t) data->value.bytes.data);
+static anjay_batch_entry_t *append_entry(anjay_batch_builder_t *builder,
+                                         const anjay_uri_path_t *uri,
+                                         avs_time_real_t timestamp,
+                                         anjay_batch_data_t data) {
+    anjay_batch_entry_t *entry = (anjay_batch_entry_t *) builder_alloc(
+            builder, sizeof(anjay_batch_entry_t));
+    if (!entry) {
+        return NULL;
     }
+    *entry = (anjay_batch_entry_t) {
+        .path = *uri,
+        .timestamp = timestamp,
+        .data = data
+    };
+    *builder->append_ptr = entry;
+    builder->append_ptr = &entry->next;
+    return entry;
 }
 
 static int batch_data_add(anjay_batch_builder_t *builder,
@@ -142,21 +280,12 @@ static int batch_data_add(anjay_batch_builder_t *builder,
     assert(builder);
     if (data.type != ANJAY_BATCH_DATA_START_AGGREGATE
             && !_anjay_uri_path_has(uri, ANJAY_ID_RID)) {
-        batch_data_cleanup(&data);
         return -1;
     }
-    *builder->append_ptr = AVS_LIST_NEW_ELEMENT(anjay_batch_entry_t);
-    if (!*builder->append_ptr) {
-        batch_data_cleanup(&data);
-        return -1;
-    }
-    **builder->append_ptr = (anjay_batch_entry_t) {
-        .path = *uri,
-        .timestamp = timestamp,
-        .data = data
-    };
-    AVS_LIST_ADVANCE_PTR(&builder->append_ptr);
-    return 0;
+    // adding any other data finishes the current time series
+    builder->series_path = MAKE_ROOT_PATH();
+    builder->series_tail = NULL;
+    return append_entry(builder, uri, timestamp, data) ? 0 : -1;
 }
 
 int _anjay_batch_add_int(anjay_batch_builder_t *builder,
@@ -217,15 +346,19 @@ int _anjay_batch_add_string(anjay_batch_builder_t *builder,
                             const anjay_uri_path_t *uri,
                             avs_time_real_t timestamp,
                             const char *str) {
+    const anjay_batch_builder_mark_t mark = _anjay_batch_builder_mark(builder);
     anjay_batch_data_t str_data;
-    if (make_data_with_duplicated_string(&str_data, str)) {
+    if (make_data_with_duplicated_string(builder, &str_data, str)
+            || batch_data_add(builder, uri, timestamp, str_data)) {
+        _anjay_batch_builder_rollback(builder, &mark);
         return -1;
     }
-    return batch_data_add(builder, uri, timestamp, str_data);
+    return 0;
 }
 
 #    ifdef ANJAY_WITH_LWM2M11
-static int make_data_with_duplicated_bytes(anjay_batch_data_t *batch_data,
+static int make_data_with_duplicated_bytes(anjay_batch_builder_t *builder,
+                                           anjay_batch_data_t *batch_data,
                                            const void *data,
                                            size_t length) {
     assert(batch_data);
@@ -235,7 +368,7 @@ static int make_data_with_duplicated_bytes(anjay_batch_data_t *batch_data,
     void *new_data = NULL;
 
     if (data && length) {
-        new_data = avs_malloc(length);
+        new_data = builder_alloc(builder, length);
         if (!new_data) {
             return -1;
         }
@@ -259,14 +392,56 @@ int _anjay_batch_add_bytes(anjay_batch_builder_t *builder,
                            avs_time_real_t timestamp,
                            const void *data,
                            size_t length) {
+    const anjay_batch_builder_mark_t mark = _anjay_batch_builder_mark(builder);
     anjay_batch_data_t bytes_data;
-    if (make_data_with_duplicated_bytes(&bytes_data, data, length)) {
+    if (make_data_with_duplicated_bytes(builder, &bytes_data, data, length)
+            || batch_data_add(builder, uri, timestamp, bytes_data)) {
+        _anjay_batch_builder_rollback(builder, &mark);
         return -1;
     }
-    return batch_data_add(builder, uri, timestamp, bytes_data);
+    return 0;
 }
 #    endif // ANJAY_WITH_LWM2M11
 
+int _anjay_batch_add_bytes_external(anjay_batch_builder_t *builder,
+                                    const anjay_uri_path_t *uri,
+                                    avs_time_real_t timestamp,
+                                    const void *data,
+                                    size_t length,
+                                    anjay_batch_release_handler_t *release,
+                                    void *release_arg) {
+    if (!data && length) {
+        return -1;
+    }
+    const anjay_batch_builder_mark_t mark = _anjay_batch_builder_mark(builder);
+    anjay_batch_external_t *external = NULL;
+    const anjay_batch_data_t bytes_data = {
+        .type = ANJAY_BATCH_DATA_BYTES,
+        .value = {
+            .bytes = {
+                .data = data,
+                .length = length
+            }
+        }
+    };
+    if ((release
+         && !(external = (anjay_batch_external_t *) builder_alloc(
+                      builder, sizeof(anjay_batch_external_t))))
+            || batch_data_add(builder, uri, timestamp, bytes_data)) {
+        _anjay_batch_builder_rollback(builder, &mark);
+        return -1;
+    }
+    // linked only on success, so that the rollback above does not release it
+    if (external) {
+        external->prev = builder->externals;
+        external->release = release;
+        external->release_arg = release_arg;
+        external->length = length;
+        builder->externals = external;
+    }
+    return 0;
+}
+
 int _anjay_batch_add_objlnk(anjay_batch_builder_t *builder,
                             const anjay_uri_path_t *uri,
                             avs_time_real_t timestamp,
@@ -284,26 +459,106 @@ int _anjay_batch_add_objlnk(anjay_batch_builder_t *builder,
     return batch_data_add(builder, uri, timestamp, data);
 }
 
-static void batch_entry_cleanup(void *entry_) {
-    anjay_batch_entry_t *entry = (anjay_batch_entry_t *) entry_;
-    batch_data_cleanup(&entry->data);
+static bool is_timestamp_absolute(avs_time_real_t timestamp) {
+    /**
+     * timestamp.since_real_epoch contatins time measured since reboot if no
+     * source of real time is provided. We assume that no device will run for
+     * SENML_TIME_SECONDS_THRESHOLD or longer without reboot.
+     */
+    return timestamp.since_real_epoch.seconds >= SENML_TIME_SECONDS_THRESHOLD;
+}
+
+static bool is_timestamp_relative(avs_time_real_t timestamp) {
+    return !is_timestamp_absolute(timestamp);
+}
+
+int _anjay_batch_series_begin(anjay_batch_builder_t *builder,
+                              const anjay_uri_path_t *uri) {
+    assert(builder);
+    if (!_anjay_uri_path_has(uri, ANJAY_ID_RID)) {
+        return -1;
+    }
+    builder->series_path = *uri;
+    builder->series_tail = NULL;
+    return 0;
+}
+
+static bool series_segment_accepts(const anjay_batch_entry_t *segment,
+                                   avs_time_real_t timestamp) {
+    return segment
+           && segment->data.value.series.count
+                      < segment->data.value.series.capacity
+           && is_timestamp_absolute(segment->timestamp)
+                      == is_timestamp_absolute(timestamp);
 }
 
-void _anjay_batch_entry_list_cleanup(AVS_LIST(anjay_batch_entry_t) *list) {
-    AVS_LIST_CLEAR(list) {
-        batch_entry_cleanup(*list);
+static anjay_batch_entry_t *
+series_segment_new(anjay_batch_builder_t *builder,
+                   avs_time_real_t timestamp) {
+    size_t capacity = BATCH_SERIES_SEGMENT_MIN_SIZE;
+    if (builder->series_tail) {
+        capacity = AVS_MIN(2 * builder->series_tail->data.value.series.capacity,
+                           BATCH_SERIES_SEGMENT_MAX_SIZE);
+    }
+    const anjay_batch_builder_mark_t mark = _anjay_batch_builder_mark(builder);
+    anjay_batch_sample_t *samples = (anjay_batch_sample_t *) builder_alloc(
+            builder, capacity * sizeof(anjay_batch_sample_t));
+    anjay_batch_entry_t *segment = NULL;
+    if (!samples
+            || !(segment = append_entry(
+                         builder, &builder->series_path, timestamp,
+                         (const anjay_batch_data_t) {
+                             .type = ANJAY_BATCH_DATA_DOUBLE_SERIES,
+                             .value.series = {
+                                 .samples = samples,
+                                 .count = 0,
+                                 .capacity = capacity
+                             }
+                         }))) {
+        _anjay_batch_builder_rollback(builder, &mark);
+        return NULL;
     }
+    return segment;
+}
+
+int _anjay_batch_series_add_double(anjay_batch_builder_t *builder,
+                                   avs_time_real_t timestamp,
+                                   double value) {
+    assert(builder);
+    if (!_anjay_uri_path_has(&builder->series_path, ANJAY_ID_RID)) {
+        batch_log(ERROR, _("no time series started"));
+        return -1;
+    }
+    if (!avs_time_real_valid(timestamp)) {
+        return -1;
+    }
+    anjay_batch_entry_t *segment = builder->series_tail;
+    if (!series_segment_accepts(segment, timestamp)) {
+        if (!(segment = series_segment_new(builder, timestamp))) {
+            return -1;
+        }
+        builder->series_tail = segment;
+    }
+    anjay_batch_sample_t *sample =
+            &segment->data.value.series
+                     .samples[segment->data.value.series.count++];
+    sample->time_offset = avs_time_duration_to_fscalar(
+            avs_time_real_diff(timestamp, segment->timestamp), AVS_TIME_S);
+    sample->value = value;
+    return 0;
 }
 
 void _anjay_batch_builder_cleanup(anjay_batch_builder_t **builder) {
     if (builder && *builder) {
-        _anjay_batch_entry_list_cleanup(&(*builder)->list);
+        externals_release((*builder)->externals, NULL);
+        _anjay_growable_arena_cleanup(&(*builder)->arena);
         avs_free(*builder);
         *builder = NULL;
     }
 }
 
-#    ifdef ANJAY_WITH_THREAD_SAFETY
+#    if defined(ANJAY_WITH_THREAD_SAFETY) \
+            && !defined(ANJAY_BATCH_ATOMIC_REF_COUNT)
 static avs_init_once_handle_t REF_COUNT_MUTEX_INIT_HANDLE;
 static avs_mutex_t *REF_COUNT_MUTEX;
 
@@ -321,23 +576,87 @@ static int ensure_ref_count_mutex_initialized(void) {
     }
     return result;
 }
-#    endif // ANJAY_WITH_THREAD_SAFETY
+#    endif /* defined(ANJAY_WITH_THREAD_SAFETY) && \
+              !defined(ANJAY_BATCH_ATOMIC_REF_COUNT) */
+
+static bool entry_numeric_value(const anjay_batch_entry_t *entry,
+                                double *out_value) {
+    switch (entry->data.type) {
+    case ANJAY_BATCH_DATA_INT:
+        *out_value = (double) entry->data.value.int_value;
+        return true;
+#    ifdef ANJAY_WITH_LWM2M11
+    case ANJAY_BATCH_DATA_UINT:
+        *out_value = (double) entry->data.value.uint_value;
+        return true;
+#    endif // ANJAY_WITH_LWM2M11
+    case ANJAY_BATCH_DATA_DOUBLE:
+        *out_value = entry->data.value.double_value;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void fill_numeric_array(anjay_batch_t *batch) {
+    batch->numeric_array_filled = true;
+    if (!batch->list || !batch->list->next) {
+        // single values are handled by _anjay_batch_data_numeric_value()
+        return;
+    }
+    size_t count = 0;
+    const anjay_batch_entry_t *it;
+    for (it = batch->list; it; it = it->next) {
+        double value;
+        if (!_anjay_uri_path_has(&it->path, ANJAY_ID_RIID)
+                || it->path.ids[ANJAY_ID_OID]
+                               != batch->list->path.ids[ANJAY_ID_OID]
+                || it->path.ids[ANJAY_ID_IID]
+                               != batch->list->path.ids[ANJAY_ID_IID]
+                || it->path.ids[ANJAY_ID_RID]
+                               != batch->list->path.ids[ANJAY_ID_RID]
+                || !entry_numeric_value(it, &value)) {
+            return;
+        }
+        ++count;
+    }
+    if (!(batch->numeric_array =
+                  (double *) avs_malloc(count * sizeof(double)))) {
+        // not an error - the array is an optional optimization only
+        return;
+    }
+    double *value_ptr = batch->numeric_array;
+    for (it = batch->list; it; it = it->next) {
+        entry_numeric_value(it, value_ptr++);
+    }
+    batch->numeric_array_size = count;
+}
 
 anjay_batch_t *_anjay_batch_builder_compile(anjay_batch_builder_t **builder) {
     assert(builder && *builder);
-#    ifdef ANJAY_WITH_THREAD_SAFETY
+#    if defined(ANJAY_WITH_THREAD_SAFETY) \
+            && !defined(ANJAY_BATCH_ATOMIC_REF_COUNT)
     if (ensure_ref_count_mutex_initialized()) {
         return NULL;
     }
     assert(REF_COUNT_MUTEX);
-#    endif // ANJAY_WITH_THREAD_SAFETY
+#    endif /* defined(ANJAY_WITH_THREAD_SAFETY) && \
+              !defined(ANJAY_BATCH_ATOMIC_REF_COUNT) */
+    ANJAY_ALLOCATION_SITE_ENTER(prev_site);
     anjay_batch_t *batch =
             (anjay_batch_t *) avs_calloc(1, sizeof(anjay_batch_t));
+    ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
     if (!batch) {
         return NULL;
     }
+    batch->arena = (*builder)->arena;
     batch->list = (*builder)->list;
+    batch->externals = (*builder)->externals;
+#    ifdef ANJAY_BATCH_ATOMIC_REF_COUNT
+    atomic_init(&batch->ref_count, 1);
+#    else  // ANJAY_BATCH_ATOMIC_REF_COUNT
     batch->ref_count = 1;
+#    endif // ANJAY_BATCH_ATOMIC_REF_COUNT
     batch->compilation_time = avs_time_real_now();
     avs_free(*builder);
     *builder = NULL;
@@ -347,37 +666,65 @@ anjay_batch_t *_anjay_batch_builder_compile(anjay_batch_builder_t **builder) {
 anjay_batch_t *_anjay_batch_acquire(const anjay_batch_t *batch_) {
     assert(batch_);
     anjay_batch_t *batch = (anjay_batch_t *) (intptr_t) batch_;
-#    ifdef ANJAY_WITH_THREAD_SAFETY
+#    ifdef ANJAY_BATCH_ATOMIC_REF_COUNT
+    // the caller already holds a reference, so no ordering is necessary
+    atomic_fetch_add_explicit(&batch->ref_count, 1, memory_order_relaxed);
+#    else // ANJAY_BATCH_ATOMIC_REF_COUNT
+#        ifdef ANJAY_WITH_THREAD_SAFETY
     if (avs_mutex_lock(REF_COUNT_MUTEX)) {
         batch_log(ERROR, _("Could not lock mutex"));
         return NULL;
     }
-#    endif // ANJAY_WITH_THREAD_SAFETY
+#        endif // ANJAY_WITH_THREAD_SAFETY
     ++batch->ref_count;
-#    ifdef ANJAY_WITH_THREAD_SAFETY
+#        ifdef ANJAY_WITH_THREAD_SAFETY
     avs_mutex_unlock(REF_COUNT_MUTEX);
-#    endif // ANJAY_WITH_THREAD_SAFETY
+#        endif // ANJAY_WITH_THREAD_SAFETY
+#    endif     // ANJAY_BATCH_ATOMIC_REF_COUNT
     return batch;
 }
 
+size_t _anjay_batch_memory_size(const anjay_batch_t *batch) {
+    assert(batch);
+    size_t result = sizeof(*batch);
+    // entries and their payloads are all stored in the arena
+    result += _anjay_growable_arena_memory_size(&batch->arena);
+    for (const anjay_batch_external_t *external = batch->externals; external;
+         external = external->prev) {
+        result += external->length;
+    }
+    result += batch->numeric_array_size * sizeof(double);
+    return result;
+}
+
 void _anjay_batch_release(anjay_batch_t **batch) {
     assert(batch && *batch);
-#    ifdef ANJAY_WITH_THREAD_SAFETY
+#    ifdef ANJAY_BATCH_ATOMIC_REF_COUNT
+    // acquire-release, so that all accesses made through other references
+    // happen before the batch is freed by whoever drops the last one
+    size_t old_count = atomic_fetch_sub_explicit(&(*batch)->ref_count, 1,
+                                                 memory_order_acq_rel);
+    assert(old_count);
+#    else // ANJAY_BATCH_ATOMIC_REF_COUNT
+#        ifdef ANJAY_WITH_THREAD_SAFETY
     int mutex_lock_result = avs_mutex_lock(REF_COUNT_MUTEX);
     if (mutex_lock_result) {
         batch_log(ERROR, _("Could not lock mutex"));
     }
-#    endif // ANJAY_WITH_THREAD_SAFETY
+#        endif // ANJAY_WITH_THREAD_SAFETY
     assert((*batch)->ref_count);
     size_t old_count = ((*batch)->ref_count)--;
-#    ifdef ANJAY_WITH_THREAD_SAFETY
+#        ifdef ANJAY_WITH_THREAD_SAFETY
     if (!mutex_lock_result) {
         avs_mutex_unlock(REF_COUNT_MUTEX);
     }
-#    endif // ANJAY_WITH_THREAD_SAFETY
+#        endif // ANJAY_WITH_THREAD_SAFETY
+#    endif     // ANJAY_BATCH_ATOMIC_REF_COUNT
 
     if (old_count <= 1) {
-        _anjay_batch_entry_list_cleanup(&(*batch)->list);
+        externals_release((*batch)->externals, NULL);
+        _anjay_growable_arena_cleanup(&(*batch)->arena);
+        avs_free((*batch)->numeric_array);
         avs_free(*batch);
     }
     *batch = NULL;
@@ -387,8 +734,8 @@ void _anjay_batch_release(anjay_batch_t **batch) {
 void _anjay_batch_update_common_path_prefix(const anjay_uri_path_t **prefix_ptr,
                                             anjay_uri_path_t *prefix_buf,
                                             const anjay_batch_t *batch) {
-    AVS_LIST(anjay_batch_entry_t) element;
-    AVS_LIST_FOREACH(element, batch->list) {
+    for (const anjay_batch_entry_t *element = batch->list; element;
+         element = element->next) {
         _anjay_uri_path_update_common_prefix(prefix_ptr, prefix_buf,
                                              &element->path);
     }
@@ -434,12 +781,11 @@ static int bytes_begin(anjay_unlocked_output_ctx_t *ctx_,
         return -1;
     }
 
+    // memory allocated here is reclaimed by _anjay_batch_builder_read()
+    // in case of failure
     void *buf = NULL;
-    if (length) {
-        buf = avs_malloc(length);
-        if (!buf) {
-            return -1;
-        }
+    if (length && !(buf = builder_alloc(ctx->builder, length))) {
+        return -1;
     }
 
     anjay_batch_data_t data = {
@@ -451,19 +797,35 @@ static int bytes_begin(anjay_unlocked_output_ctx_t *ctx_,
     };
 
     if (batch_data_add(ctx->builder, &ctx->path, ctx->timestamp, data)) {
-        avs_free(buf);
         return -1;
     }
 
     value_returned(ctx);
 
-    // Doesn't change owner of buf
     ctx->bytes.data = buf;
     ctx->bytes.remaining_bytes = length;
     *out_bytes_ctx = (anjay_unlocked_ret_bytes_ctx_t *) &ctx->bytes;
     return 0;
 }
 
+static int ret_bytes_borrowed(anjay_unlocked_output_ctx_t *ctx_,
+                              const void *data,
+                              size_t length,
+                              anjay_ret_bytes_release_t *release,
+                              void *release_arg) {
+    builder_out_ctx_t *ctx = (builder_out_ctx_t *) ctx_;
+    int result = -1;
+    if (ctx->bytes.remaining_bytes) {
+        batch_log(ERROR, _("bytes already being returned"));
+    } else if (_anjay_uri_path_has(&ctx->path, ANJAY_ID_RID)) {
+        result = _anjay_batch_add_bytes_external(ctx->builder, &ctx->path,
+                                                 ctx->timestamp, data, length,
+                                                 release, release_arg);
+        value_returned(ctx);
+    }
+    return result;
+}
+
 static int ret_string(anjay_unlocked_output_ctx_t *ctx_, const char *str) {
     builder_out_ctx_t *ctx = (builder_out_ctx_t *) ctx_;
     int result = -1;
@@ -593,6 +955,7 @@ static int output_close(anjay_unlocked_output_ctx_t *ctx_) {
 
 static const anjay_output_ctx_vtable_t BUILDER_OUT_VTABLE = {
     .bytes_begin = bytes_begin,
+    .bytes_borrowed = ret_bytes_borrowed,
     .string = ret_string,
     .integer = ret_integer,
 #    ifdef ANJAY_WITH_LWM2M11
@@ -627,55 +990,63 @@ builder_out_ctx_new(anjay_batch_builder_t *builder,
     return ctx;
 }
 
-static int read_into_batch(anjay_batch_builder_t *builder,
-                           anjay_unlocked_t *anjay,
-                           const anjay_dm_installed_object_t *obj,
-                           const anjay_dm_path_info_t *path_info,
-                           anjay_ssid_t requesting_ssid,
-                           const avs_time_real_t *forced_timestamp) {
-    builder_out_ctx_t ctx =
-            builder_out_ctx_new(builder, &path_info->uri, forced_timestamp);
-    int retval = _anjay_dm_read(anjay, obj, path_info, requesting_ssid,
-                                (anjay_unlocked_output_ctx_t *) &ctx);
-    int close_retval = output_close((anjay_unlocked_output_ctx_t *) &ctx);
-    return close_retval ? close_retval : retval;
-}
-
-int _anjay_dm_read_into_batch(anjay_batch_builder_t *builder,
+int _anjay_batch_builder_read(anjay_batch_builder_t *builder,
                               anjay_unlocked_t *anjay,
-                              const anjay_dm_installed_object_t *obj,
-                              const anjay_dm_path_info_t *path_info,
-                              anjay_ssid_t requesting_ssid,
-                              const avs_time_real_t *forced_timestamp) {
+                              const anjay_uri_path_t *root_path,
+                              const avs_time_real_t *forced_timestamp,
+                              anjay_batch_read_clb_t *read_clb,
+                              void *read_clb_arg) {
     assert(builder);
     assert(anjay);
-    assert(!obj
-           || path_info->uri.ids[ANJAY_ID_OID]
-                      == _anjay_dm_installed_object_oid(obj));
+    assert(read_clb);
 
-    AVS_LIST(anjay_batch_entry_t) *initial_append_ptr = builder->append_ptr;
-    int result = read_into_batch(builder, anjay, obj, path_info,
-                                 requesting_ssid, forced_timestamp);
+    const anjay_batch_builder_mark_t mark = _anjay_batch_builder_mark(builder);
+    builder_out_ctx_t ctx =
+            builder_out_ctx_new(builder, root_path, forced_timestamp);
+    int result = read_clb(anjay, (anjay_unlocked_output_ctx_t *) &ctx,
+                          read_clb_arg);
+    int close_result = output_close((anjay_unlocked_output_ctx_t *) &ctx);
+    if (close_result) {
+        result = close_result;
+    }
 
     // Despite of failure, the new element may be added. Remove it.
     if (result) {
-        builder->append_ptr = initial_append_ptr;
-        _anjay_batch_entry_list_cleanup(builder->append_ptr);
+        _anjay_batch_builder_rollback(builder, &mark);
     }
     return result;
 }
 
-static bool is_timestamp_absolute(avs_time_real_t timestamp) {
-    /**
-     * timestamp.since_real_epoch contatins time measured since reboot if no
-     * source of real time is provided. We assume that no device will run for
-     * SENML_TIME_SECONDS_THRESHOLD or longer without reboot.
-     */
-    return timestamp.since_real_epoch.seconds >= SENML_TIME_SECONDS_THRESHOLD;
+typedef struct {
+    const anjay_dm_installed_object_t *obj;
+    const anjay_dm_path_info_t *path_info;
+    anjay_ssid_t requesting_ssid;
+} dm_read_clb_args_t;
+
+static int dm_read_clb(anjay_unlocked_t *anjay,
+                       anjay_unlocked_output_ctx_t *out_ctx,
+                       void *args_) {
+    const dm_read_clb_args_t *args = (const dm_read_clb_args_t *) args_;
+    return _anjay_dm_read(anjay, args->obj, args->path_info,
+                          args->requesting_ssid, out_ctx);
 }
 
-static bool is_timestamp_relative(avs_time_real_t timestamp) {
-    return !is_timestamp_absolute(timestamp);
+int _anjay_dm_read_into_batch(anjay_batch_builder_t *builder,
+                              anjay_unlocked_t *anjay,
+                              const anjay_dm_installed_object_t *obj,
+                              const anjay_dm_path_info_t *path_info,
+                              anjay_ssid_t requesting_ssid,
+                              const avs_time_real_t *forced_timestamp) {
+    assert(!obj
+           || path_info->uri.ids[ANJAY_ID_OID]
+                      == _anjay_dm_installed_object_oid(obj));
+    return _anjay_batch_builder_read(builder, anjay, &path_info->uri,
+                                     forced_timestamp, dm_read_clb,
+                                     &(dm_read_clb_args_t) {
+                                         .obj = obj,
+                                         .path_info = path_info,
+                                         .requesting_ssid = requesting_ssid
+                                     });
 }
 
 static double convert_to_senml_time(avs_time_real_t timestamp,
@@ -701,9 +1072,31 @@ static double convert_to_senml_time(avs_time_real_t timestamp,
     }
 }
 
+static int serialize_series(const anjay_batch_entry_t *entry,
+                            avs_time_real_t serialization_time,
+                            anjay_unlocked_output_ctx_t *output) {
+    const double base_time =
+            convert_to_senml_time(entry->timestamp, serialization_time);
+    int result = 0;
+    for (size_t i = 0; !result && i < entry->data.value.series.count; ++i) {
+        const anjay_batch_sample_t *sample =
+                &entry->data.value.series.samples[i];
+        (void) ((result = _anjay_output_set_path(output, &entry->path))
+                || (!isnan(base_time)
+                    && (result = _anjay_output_set_relative_time(
+                                output, base_time, sample->time_offset)))
+                || (result = _anjay_ret_double_unlocked(output,
+                                                        sample->value)));
+    }
+    return result;
+}
+
 static int serialize_batch_entry(const anjay_batch_entry_t *entry,
                                  avs_time_real_t serialization_time,
                                  anjay_unlocked_output_ctx_t *output) {
+    if (entry->data.type == ANJAY_BATCH_DATA_DOUBLE_SERIES) {
+        return serialize_series(entry, serialization_time, output);
+    }
     int result = _anjay_output_set_path(output, &entry->path);
     if (result) {
         return result;
@@ -767,12 +1160,11 @@ int _anjay_batch_data_output_entry(
         const anjay_batch_data_output_state_t **state,
         anjay_unlocked_output_ctx_t *out_ctx) {
     assert(state);
-    AVS_LIST(const anjay_batch_entry_t) it;
+    const anjay_batch_entry_t *it;
     if (!*state) {
         it = batch->list;
     } else {
         it = &(*state)->entry;
-        assert(AVS_LIST_FIND_PTR(&batch->list, it) != NULL);
     }
     while (it
            && !_anjay_instance_action_allowed(
@@ -782,12 +1174,12 @@ int _anjay_batch_data_output_entry(
                                  .ssid = target_ssid,
                                  .action = ANJAY_ACTION_READ
                              })) {
-        AVS_LIST_ADVANCE((AVS_LIST(anjay_batch_entry_t) *) (intptr_t) &it);
+        it = it->next;
     }
     int result = 0;
     if (it) {
         result = serialize_batch_entry(it, serialization_time, out_ctx);
-        AVS_LIST_ADVANCE((AVS_LIST(anjay_batch_entry_t) *) (intptr_t) &it);
+        it = it->next;
     }
     *state = AVS_CONTAINER_OF(it, anjay_batch_data_output_state_t, entry);
     return result;
@@ -814,6 +1206,17 @@ static bool batch_data_equal(const anjay_batch_data_t *a,
 #    endif // ANJAY_WITH_LWM2M11
     case ANJAY_BATCH_DATA_DOUBLE:
         return a->value.double_value == b->value.double_value;
+    case ANJAY_BATCH_DATA_DOUBLE_SERIES:
+        if (a->value.series.count != b->value.series.count) {
+            return false;
+        }
+        for (size_t i = 0; i < a->value.series.count; ++i) {
+            if (a->value.series.samples[i].value
+                    != b->value.series.samples[i].value) {
+                return false;
+            }
+        }
+        return true;
     case ANJAY_BATCH_DATA_BOOL:
         return a->value.bool_value == b->value.bool_value;
     case ANJAY_BATCH_DATA_OBJLNK:
@@ -828,22 +1231,38 @@ bool _anjay_batch_values_equal(const anjay_batch_t *a, const anjay_batch_t *b) {
     if (!a || !b) {
         return !a && !b;
     }
-    AVS_LIST(anjay_batch_entry_t) ait = a->list;
-    AVS_LIST(anjay_batch_entry_t) bit = b->list;
+    const anjay_batch_entry_t *ait = a->list;
+    const anjay_batch_entry_t *bit = b->list;
     while (ait && bit) {
         if (!_anjay_uri_path_equal(&ait->path, &bit->path)
                 || !batch_data_equal(&ait->data, &bit->data)) {
             return false;
         }
-        AVS_LIST_ADVANCE(&ait);
-        AVS_LIST_ADVANCE(&bit);
+        ait = ait->next;
+        bit = bit->next;
+    }
+    return !ait && !bit;
+}
+
+bool _anjay_batch_paths_equal(const anjay_batch_t *a, const anjay_batch_t *b) {
+    if (!a || !b) {
+        return !a && !b;
+    }
+    const anjay_batch_entry_t *ait = a->list;
+    const anjay_batch_entry_t *bit = b->list;
+    while (ait && bit) {
+        if (!_anjay_uri_path_equal(&ait->path, &bit->path)) {
+            return false;
+        }
+        ait = ait->next;
+        bit = bit->next;
     }
     return !ait && !bit;
 }
 
 bool _anjay_batch_data_requires_hierarchical_format(
         const anjay_batch_t *batch) {
-    if (!batch || !batch->list || AVS_LIST_NEXT(batch->list)) {
+    if (!batch || !batch->list || batch->list->next) {
         // entry list is not exactly 1 element long
         return true;
     }
@@ -852,6 +1271,10 @@ bool _anjay_batch_data_requires_hierarchical_format(
         // batch consists of an empty aggregate, so isn't a single simple value
         return true;
     }
+    if (entry->data.type == ANJAY_BATCH_DATA_DOUBLE_SERIES) {
+        // a series segment may hold any number of values
+        return true;
+    }
     assert(_anjay_uri_path_has(&entry->path, ANJAY_ID_RID));
     return false;
 }
@@ -862,8 +1285,7 @@ int _anjay_batch_outputable_item_count(anjay_unlocked_t *anjay,
                                        size_t *out_count) {
     size_t count = 0;
     if (batch) {
-        AVS_LIST(anjay_batch_entry_t) it;
-        AVS_LIST_FOREACH(it, batch->list) {
+        for (const anjay_batch_entry_t *it = batch->list; it; it = it->next) {
             anjay_instance_action_allowed_stateless_result_t result =
                     _anjay_instance_action_allowed_stateless(
                             anjay, &(const anjay_action_info_t) {
@@ -877,8 +1299,13 @@ int _anjay_batch_outputable_item_count(anjay_unlocked_t *anjay,
                 return -1;
             }
 #    endif // ANJAY_WITH_ACCESS_CONTROL
-            if (result == ANJAY_INSTANCE_ACTION_ALLOWED
-                    && it->data.type != ANJAY_BATCH_DATA_START_AGGREGATE) {
+            if (result != ANJAY_INSTANCE_ACTION_ALLOWED
+                    || it->data.type == ANJAY_BATCH_DATA_START_AGGREGATE) {
+                continue;
+            }
+            if (it->data.type == ANJAY_BATCH_DATA_DOUBLE_SERIES) {
+                count += it->data.value.series.count;
+            } else {
                 ++count;
             }
         }
@@ -888,23 +1315,31 @@ int _anjay_batch_outputable_item_count(anjay_unlocked_t *anjay,
 }
 
 double _anjay_batch_data_numeric_value(const anjay_batch_t *batch) {
-    if (_anjay_batch_data_requires_hierarchical_format(batch)) {
-        // not a simple value
+    double result = NAN;
+    if (_anjay_batch_data_requires_hierarchical_format(batch)
+            || !entry_numeric_value(batch->list, &result)) {
+        // not a simple numeric value
         return NAN;
     }
-    const anjay_batch_entry_t *const entry = batch->list;
-    switch (entry->data.type) {
-    case ANJAY_BATCH_DATA_INT:
-        return (double) entry->data.value.int_value;
-#    ifdef ANJAY_WITH_LWM2M11
-    case ANJAY_BATCH_DATA_UINT:
-        return (double) entry->data.value.uint_value;
-#    endif // ANJAY_WITH_LWM2M11
-    case ANJAY_BATCH_DATA_DOUBLE:
-        return entry->data.value.double_value;
-    default:
-        return NAN;
+    return result;
+}
+
+const double *_anjay_batch_data_numeric_array(const anjay_batch_t *batch_,
+                                              size_t *out_count) {
+    if (!batch_) {
+        return NULL;
     }
+    // the array is a cache that does not change the batch's contents, so it
+    // may be filled even though the batch is otherwise immutable
+    anjay_batch_t *batch = (anjay_batch_t *) (intptr_t) batch_;
+    if (!batch->numeric_array_filled) {
+        fill_numeric_array(batch);
+    }
+    if (!batch->numeric_array) {
+        return NULL;
+    }
+    *out_count = batch->numeric_array_size;
+    return batch->numeric_array;
 }
 
 int _anjay_batch_data_boolean_value(const anjay_batch_t *batch,
@@ -927,6 +1362,332 @@ avs_time_real_t _anjay_batch_get_compilation_time(const anjay_batch_t *batch) {
     return batch->compilation_time;
 }
 
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    size_t size;
+} size_counting_stream_t;
+
+static avs_error_t size_counting_write_some(avs_stream_t *stream,
+                                            const void *buffer,
+                                            size_t *inout_data_length) {
+    (void) buffer;
+    ((size_counting_stream_t *) stream)->size += *inout_data_length;
+    return AVS_OK;
+}
+
+static const avs_stream_v_table_t SIZE_COUNTING_STREAM_VTABLE = {
+    .write_some = size_counting_write_some
+};
+
+static int measure_encoded_size(anjay_unlocked_t *anjay,
+                                const anjay_uri_path_t *root_path,
+                                anjay_request_action_t action,
+                                size_t values_count,
+                                const anjay_batch_t *const *values,
+                                const size_t *item_count,
+                                uint16_t format,
+                                size_t *out_size) {
+    size_counting_stream_t stream = {
+        .vtable = &SIZE_COUNTING_STREAM_VTABLE
+    };
+    anjay_unlocked_output_ctx_t *out_ctx = NULL;
+    int result = _anjay_output_dynamic_construct(
+            &out_ctx, (avs_stream_t *) &stream, root_path, format, item_count,
+            action);
+    for (size_t i = 0; !result && i < values_count; ++i) {
+        result = _anjay_batch_data_output(anjay, values[i],
+                                          ANJAY_SSID_BOOTSTRAP, out_ctx);
+    }
+    if (!(result = _anjay_output_ctx_destroy_and_process_result(&out_ctx,
+                                                                result))) {
+        *out_size = stream.size;
+    }
+    return result;
+}
+
+uint16_t _anjay_batch_smallest_format(anjay_unlocked_t *anjay,
+                                      anjay_lwm2m_version_t lwm2m_version,
+                                      const anjay_uri_path_t *root_path,
+                                      anjay_request_action_t action,
+                                      size_t values_count,
+                                      const anjay_batch_t *const *values,
+                                      uint16_t default_format) {
+    // formats from the first LWM2M10_FORMATS_COUNT entries are valid for all
+    // LwM2M versions, the rest require LwM2M 1.1; LwM2M CBOR is not considered,
+    // as it requires LwM2M 1.2, which is not supported
+    static const uint16_t CANDIDATES[] = {
+        AVS_COAP_FORMAT_PLAINTEXT,
+        AVS_COAP_FORMAT_OMA_LWM2M_TLV,
+#    ifdef ANJAY_WITH_LWM2M11
+        AVS_COAP_FORMAT_CBOR,
+        AVS_COAP_FORMAT_SENML_CBOR
+#    endif // ANJAY_WITH_LWM2M11
+    };
+    static const size_t LWM2M10_FORMATS_COUNT = 2;
+#    ifdef ANJAY_WITH_LWM2M11
+    const size_t candidates_count = lwm2m_version >= ANJAY_LWM2M_VERSION_1_1
+                                            ? AVS_ARRAY_SIZE(CANDIDATES)
+                                            : LWM2M10_FORMATS_COUNT;
+#    else  // ANJAY_WITH_LWM2M11
+    (void) lwm2m_version;
+    const size_t candidates_count = LWM2M10_FORMATS_COUNT;
+#    endif // ANJAY_WITH_LWM2M11
+
+    size_t item_count = 0;
+    const size_t *item_count_ptr = &item_count;
+    for (size_t i = 0; i < values_count; ++i) {
+        size_t batch_count;
+        if (_anjay_batch_outputable_item_count(
+                    anjay, values[i], ANJAY_SSID_BOOTSTRAP, &batch_count)) {
+            item_count_ptr = NULL;
+            break;
+        }
+        item_count += batch_count;
+    }
+
+    uint16_t best_format = default_format;
+    size_t best_size = SIZE_MAX;
+    for (size_t i = 0; i < candidates_count; ++i) {
+        size_t size;
+        if (!measure_encoded_size(anjay, root_path, action, values_count,
+                                  values, item_count_ptr, CANDIDATES[i], &size)
+                && size < best_size) {
+            best_format = CANDIDATES[i];
+            best_size = size;
+        }
+    }
+    return best_format;
+}
+
+#    ifdef ANJAY_WITH_SEND
+int _anjay_batch_send_payload_size(anjay_unlocked_t *anjay,
+                                   const anjay_batch_t *batch,
+                                   anjay_ssid_t target_ssid,
+                                   uint16_t format,
+                                   size_t *out_size) {
+    anjay_uri_path_t base_path = MAKE_ROOT_PATH();
+    _anjay_batch_update_common_path_prefix(&(const anjay_uri_path_t *) { NULL },
+                                           &base_path, batch);
+    size_t item_count;
+    size_counting_stream_t stream = {
+        .vtable = &SIZE_COUNTING_STREAM_VTABLE
+    };
+    anjay_unlocked_output_ctx_t *out_ctx = NULL;
+    int result = _anjay_output_dynamic_send_construct(
+            &out_ctx, (avs_stream_t *) &stream, &base_path, format,
+            _anjay_batch_outputable_item_count(anjay, batch, target_ssid,
+                                               &item_count)
+                    ? NULL
+                    : &item_count);
+    if (!result) {
+        result = _anjay_batch_data_output(anjay, batch, target_ssid, out_ctx);
+    }
+    if (!(result = _anjay_output_ctx_destroy_and_process_result(&out_ctx,
+                                                                result))) {
+        *out_size = stream.size;
+    }
+    return result;
+}
+
+bool _anjay_batch_serialization_shareable(anjay_unlocked_t *anjay,
+                                          const anjay_batch_t *batch,
+                                          anjay_ssid_t target_ssid) {
+    for (const anjay_batch_entry_t *it = batch->list; it; it = it->next) {
+        if ((avs_time_real_valid(it->timestamp)
+             && is_timestamp_relative(it->timestamp))
+                || _anjay_instance_action_allowed_stateless(
+                           anjay, &(const anjay_action_info_t) {
+                                      .oid = it->path.ids[ANJAY_ID_OID],
+                                      .iid = it->path.ids[ANJAY_ID_IID],
+                                      .ssid = target_ssid,
+                                      .action = ANJAY_ACTION_READ
+                                  })
+                           != ANJAY_INSTANCE_ACTION_ALLOWED) {
+            return false;
+        }
+    }
+    return true;
+}
+#    endif // ANJAY_WITH_SEND
+
+#    ifdef ANJAY_WITH_SEND_PERSISTENCE
+static avs_error_t persist_path(avs_persistence_context_t *ctx,
+                                anjay_uri_path_t *path) {
+    avs_error_t err = AVS_OK;
+    for (size_t i = 0; avs_is_ok(err) && i < AVS_ARRAY_SIZE(path->ids); ++i) {
+        err = avs_persistence_u16(ctx, &path->ids[i]);
+    }
+    return err;
+}
+
+/**
+ * Persists a buffer preceded by its length. When restoring, the buffer is
+ * allocated from @p builder .
+ */
+static avs_error_t persist_buffer(avs_persistence_context_t *ctx,
+                                  anjay_batch_builder_t *builder,
+                                  const void **data,
+                                  size_t *length) {
+    uint32_t length32 = (uint32_t) *length;
+    avs_error_t err = avs_persistence_u32(ctx, &length32);
+    if (avs_is_err(err) || !length32) {
+        *length = length32;
+        return err;
+    }
+    if (avs_persistence_direction(ctx) == AVS_PERSISTENCE_RESTORE) {
+        if (!(*data = builder_alloc(builder, length32))) {
+            return avs_errno(AVS_ENOMEM);
+        }
+        *length = length32;
+    }
+    return avs_persistence_bytes(ctx, (void *) (intptr_t) *data, *length);
+}
+
+static avs_error_t persist_string(avs_persistence_context_t *ctx,
+                                  anjay_batch_builder_t *builder,
+                                  const char **str) {
+    const void *data = *str;
+    size_t size = 0;
+    if (avs_persistence_direction(ctx) == AVS_PERSISTENCE_STORE) {
+        size = strlen(*str) + 1;
+    }
+    avs_error_t err = persist_buffer(ctx, builder, &data, &size);
+    if (avs_is_ok(err)
+            && avs_persistence_direction(ctx) == AVS_PERSISTENCE_RESTORE) {
+        if (!size || ((const char *) data)[size - 1] != '\0') {
+            return avs_errno(AVS_EBADMSG);
+        }
+        *str = (const char *) data;
+    }
+    return err;
+}
+
+static avs_error_t persist_series(avs_persistence_context_t *ctx,
+                                  anjay_batch_builder_t *builder,
+                                  anjay_batch_data_t *data) {
+    uint32_t count32 = (uint32_t) data->value.series.count;
+    avs_error_t err = avs_persistence_u32(ctx, &count32);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    if (avs_persistence_direction(ctx) == AVS_PERSISTENCE_RESTORE) {
+        if (!count32 || count32 > BATCH_SERIES_SEGMENT_MAX_SIZE) {
+            return avs_errno(AVS_EBADMSG);
+        }
+        if (!(data->value.series.samples =
+                      (anjay_batch_sample_t *) builder_alloc(
+                              builder,
+                              count32 * sizeof(anjay_batch_sample_t)))) {
+            return avs_errno(AVS_ENOMEM);
+        }
+        data->value.series.count = count32;
+        data->value.series.capacity = count32;
+    }
+    for (size_t i = 0; avs_is_ok(err) && i < data->value.series.count; ++i) {
+        anjay_batch_sample_t *sample = &data->value.series.samples[i];
+        (void) (avs_is_err((err = avs_persistence_double(
+                                    ctx, &sample->time_offset)))
+                || avs_is_err((err = avs_persistence_double(ctx,
+                                                            &sample->value))));
+    }
+    return err;
+}
+
+static avs_error_t persist_entry(avs_persistence_context_t *ctx,
+                                 anjay_batch_builder_t *builder,
+                                 anjay_batch_entry_t *entry) {
+    uint8_t type = (uint8_t) entry->data.type;
+    avs_error_t err;
+    if (avs_is_err((err = persist_path(ctx, &entry->path)))
+            || avs_is_err((err = avs_persistence_i64(
+                                   ctx,
+                                   &entry->timestamp.since_real_epoch.seconds)))
+            || avs_is_err((err = avs_persistence_i32(
+                                   ctx, &entry->timestamp.since_real_epoch
+                                                 .nanoseconds)))
+            || avs_is_err((err = avs_persistence_u8(ctx, &type)))) {
+        return err;
+    }
+    anjay_batch_data_t *data = &entry->data;
+    data->type = (anjay_batch_data_type_t) type;
+    switch (data->type) {
+    case ANJAY_BATCH_DATA_BYTES:
+        return persist_buffer(ctx, builder, &data->value.bytes.data,
+                              &data->value.bytes.length);
+    case ANJAY_BATCH_DATA_STRING:
+        return persist_string(ctx, builder, &data->value.string);
+    case ANJAY_BATCH_DATA_INT:
+        return avs_persistence_i64(ctx, &data->value.int_value);
+#        ifdef ANJAY_WITH_LWM2M11
+    case ANJAY_BATCH_DATA_UINT:
+        return avs_persistence_u64(ctx, &data->value.uint_value);
+#        endif // ANJAY_WITH_LWM2M11
+    case ANJAY_BATCH_DATA_DOUBLE:
+        return avs_persistence_double(ctx, &data->value.double_value);
+    case ANJAY_BATCH_DATA_DOUBLE_SERIES:
+        return persist_series(ctx, builder, data);
+    case ANJAY_BATCH_DATA_BOOL:
+        return avs_persistence_bool(ctx, &data->value.bool_value);
+    case ANJAY_BATCH_DATA_OBJLNK:
+        (void) (avs_is_err((err = avs_persistence_u16(
+                                    ctx, &data->value.objlnk.oid)))
+                || avs_is_err((err = avs_persistence_u16(
+                                       ctx, &data->value.objlnk.iid))));
+        return err;
+    case ANJAY_BATCH_DATA_START_AGGREGATE:
+        return AVS_OK;
+    }
+    batch_log(DEBUG, _("invalid persisted batch entry type: ") "%u",
+              (unsigned) type);
+    return avs_errno(AVS_EBADMSG);
+}
+
+avs_error_t _anjay_batch_persist(avs_persistence_context_t *ctx,
+                                 const anjay_batch_t *batch) {
+    assert(avs_persistence_direction(ctx) == AVS_PERSISTENCE_STORE);
+    uint32_t count = 0;
+    for (const anjay_batch_entry_t *it = batch->list; it; it = it->next) {
+        ++count;
+    }
+    avs_error_t err = avs_persistence_u32(ctx, &count);
+    for (const anjay_batch_entry_t *it = batch->list; avs_is_ok(err) && it;
+         it = it->next) {
+        anjay_batch_entry_t entry = *it;
+        err = persist_entry(ctx, NULL, &entry);
+    }
+    return err;
+}
+
+avs_error_t _anjay_batch_restore(avs_persistence_context_t *ctx,
+                                 anjay_batch_t **out_batch) {
+    assert(avs_persistence_direction(ctx) == AVS_PERSISTENCE_RESTORE);
+    uint32_t count;
+    avs_error_t err = avs_persistence_u32(ctx, &count);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    anjay_batch_builder_t *builder = _anjay_batch_builder_new();
+    if (!builder) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    for (uint32_t i = 0; avs_is_ok(err) && i < count; ++i) {
+        anjay_batch_entry_t entry;
+        memset(&entry, 0, sizeof(entry));
+        if (avs_is_ok((err = persist_entry(ctx, builder, &entry)))
+                && batch_data_add(builder, &entry.path, entry.timestamp,
+                                  entry.data)) {
+            err = avs_errno(AVS_EBADMSG);
+        }
+    }
+    if (avs_is_ok(err)
+            && !(*out_batch = _anjay_batch_builder_compile(&builder))) {
+        err = avs_errno(AVS_ENOMEM);
+    }
+    _anjay_batch_builder_cleanup(&builder);
+    return err;
+}
+#    endif // ANJAY_WITH_SEND_PERSISTENCE
+
 #    ifdef ANJAY_TEST
 #        include "tests/core/io/batch_builder.c"
 #        ifdef ANJAY_WITH_LWM2M11
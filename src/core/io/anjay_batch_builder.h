@@ -12,6 +12,11 @@
 
 #include <anjay/anjay.h>
 
+#ifdef ANJAY_WITH_SEND_PERSISTENCE
+#    include <avsystem/commons/avs_persistence.h>
+#endif // ANJAY_WITH_SEND_PERSISTENCE
+
+#include "../anjay_arena.h"
 #include "../anjay_dm_core.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
@@ -27,11 +32,49 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 
 typedef struct anjay_batch_entry anjay_batch_entry_t;
 
+typedef struct anjay_batch_external anjay_batch_external_t;
+
+/**
+ * Function called to release a buffer added with
+ * @ref _anjay_batch_add_bytes_external .
+ */
+typedef void anjay_batch_release_handler_t(void *arg);
+
 typedef struct anjay_batch_builder_struct {
-    AVS_LIST(anjay_batch_entry_t) list;
-    AVS_LIST(anjay_batch_entry_t) *append_ptr;
+    /**
+     * Arena that all entries and their String and Opaque payloads are
+     * allocated from. Ownership is passed to the compiled batch, which frees
+     * them all at once.
+     */
+    anjay_growable_arena_t arena;
+    anjay_batch_entry_t *list;
+    anjay_batch_entry_t **append_ptr;
+    /**
+     * Buffers referenced by Opaque entries instead of being copied into the
+     * arena, most recent first. Released along with the arena.
+     */
+    anjay_batch_external_t *externals;
+    /**
+     * Path of the time series started with @ref _anjay_batch_series_begin ,
+     * or root path if there is none.
+     */
+    anjay_uri_path_t series_path;
+    /**
+     * Last segment of the current time series, or NULL if the next sample
+     * shall start a new one.
+     */
+    anjay_batch_entry_t *series_tail;
 } anjay_batch_builder_t;
 
+/**
+ * State of the batch builder, as returned by @ref _anjay_batch_builder_mark .
+ */
+typedef struct {
+    anjay_growable_arena_mark_t arena;
+    anjay_batch_entry_t **append_ptr;
+    anjay_batch_external_t *externals;
+} anjay_batch_builder_mark_t;
+
 typedef struct anjay_batch_struct anjay_batch_t;
 
 typedef struct anjay_batch_data_output_state_struct
@@ -80,6 +123,24 @@ int _anjay_batch_add_bytes(anjay_batch_builder_t *builder,
                            size_t length);
 #endif // ANJAY_WITH_LWM2M11
 
+/**
+ * Adds an Opaque value without copying @p data , which needs to stay valid
+ * until @p release is called with @p release_arg - either when the last
+ * reference to the compiled batch is released, or when the entry is discarded
+ * along with the builder or by @ref _anjay_batch_builder_rollback . If
+ * @p release is NULL, @p data needs to stay valid for the lifetime of the
+ * batch.
+ *
+ * In case of failure, @p release is not called.
+ */
+int _anjay_batch_add_bytes_external(anjay_batch_builder_t *builder,
+                                    const anjay_uri_path_t *uri,
+                                    avs_time_real_t timestamp,
+                                    const void *data,
+                                    size_t length,
+                                    anjay_batch_release_handler_t *release,
+                                    void *release_arg);
+
 int _anjay_batch_add_objlnk(anjay_batch_builder_t *builder,
                             const anjay_uri_path_t *uri,
                             avs_time_real_t timestamp,
@@ -87,6 +148,32 @@ int _anjay_batch_add_objlnk(anjay_batch_builder_t *builder,
                             anjay_iid_t objlnk_iid);
 /**@}*/
 
+/**
+ * Starts a time series of Float values under @p uri , which MUST point to a
+ * Resource or Resource Instance. Samples are then added using
+ * @ref _anjay_batch_series_add_double , until any other data is added to the
+ * builder.
+ *
+ * Samples are stored compactly, in entries that hold multiple of them under a
+ * single path, and are serialized as separate values. Note that adding samples
+ * to an already existing entry is not undone by
+ * @ref _anjay_batch_builder_rollback .
+ *
+ * @returns 0 on success, negative value otherwise.
+ */
+int _anjay_batch_series_begin(anjay_batch_builder_t *builder,
+                              const anjay_uri_path_t *uri);
+
+/**
+ * Adds a sample to the current time series. @p timestamp MUST be valid.
+ *
+ * @returns 0 on success, negative value otherwise. In case of failure,
+ *          @p builder is left unmodified.
+ */
+int _anjay_batch_series_add_double(anjay_batch_builder_t *builder,
+                                   avs_time_real_t timestamp,
+                                   double value);
+
 /**
  * Releases batch builder and discards all data. It has no effect if builder was
  * previously compiled.
@@ -130,7 +217,23 @@ anjay_batch_t *_anjay_batch_acquire(const anjay_batch_t *batch);
  */
 void _anjay_batch_release(anjay_batch_t **batch);
 
-void _anjay_batch_entry_list_cleanup(AVS_LIST(anjay_batch_entry_t) *list);
+/**
+ * Returns the estimated amount of heap memory occupied by @p batch, including
+ * the contents of all String and Opaque values.
+ */
+size_t _anjay_batch_memory_size(const anjay_batch_t *batch);
+
+anjay_batch_builder_mark_t
+_anjay_batch_builder_mark(const anjay_batch_builder_t *builder);
+
+/**
+ * Discards all entries added to @p builder after @p mark was taken, and frees
+ * the memory occupied by them.
+ */
+void _anjay_batch_builder_rollback(anjay_batch_builder_t *builder,
+                                   const anjay_batch_builder_mark_t *mark);
+
+size_t _anjay_batch_builder_entry_count(const anjay_batch_builder_t *builder);
 
 int _anjay_dm_read_into_batch(anjay_batch_builder_t *builder,
                               anjay_unlocked_t *anjay,
@@ -139,6 +242,23 @@ int _anjay_dm_read_into_batch(anjay_batch_builder_t *builder,
                               anjay_ssid_t requesting_ssid,
                               const avs_time_real_t *forced_timestamp);
 
+typedef int anjay_batch_read_clb_t(anjay_unlocked_t *anjay,
+                                   anjay_unlocked_output_ctx_t *out_ctx,
+                                   void *arg);
+
+/**
+ * Generalized variant of @ref _anjay_dm_read_into_batch: calls @p read_clb
+ * with an output context that appends everything returned through it, which
+ * MUST be located under @p root_path , to @p builder . If @p read_clb fails,
+ * the builder is left unmodified.
+ */
+int _anjay_batch_builder_read(anjay_batch_builder_t *builder,
+                              anjay_unlocked_t *anjay,
+                              const anjay_uri_path_t *root_path,
+                              const avs_time_real_t *forced_timestamp,
+                              anjay_batch_read_clb_t *read_clb,
+                              void *read_clb_arg);
+
 /**
  * Filters content of the batch for server with specified @p target_ssid
  * according to Access Control permissions of this server. Then outputs the data
@@ -270,8 +390,38 @@ int _anjay_batch_outputable_item_count(anjay_unlocked_t *anjay,
  */
 bool _anjay_batch_values_equal(const anjay_batch_t *a, const anjay_batch_t *b);
 
+/**
+ * Checks whether both batches contain entries for the same sequence of paths,
+ * regardless of their values.
+ */
+bool _anjay_batch_paths_equal(const anjay_batch_t *a, const anjay_batch_t *b);
+
 bool _anjay_batch_data_requires_hierarchical_format(const anjay_batch_t *batch);
 
+/**
+ * Chooses the Content-Format in which the concatenation of @p values would be
+ * serialized into the smallest payload, in response to a request of type
+ * @p action rooted at @p root_path . Every candidate format is checked by
+ * serializing the data into a stream that only counts the bytes written.
+ *
+ * Formats that are not compiled in, are not valid for @p lwm2m_version or
+ * @p action , or cannot represent the data (e.g. Plain Text for more than one
+ * value) are skipped.
+ *
+ * NOTE: Access Control permissions are not checked, it is assumed that it has
+ * already been done when reading the data into @p values .
+ *
+ * @returns The chosen format, or @p default_format if none of the candidates
+ *          can be used.
+ */
+uint16_t _anjay_batch_smallest_format(anjay_unlocked_t *anjay,
+                                      anjay_lwm2m_version_t lwm2m_version,
+                                      const anjay_uri_path_t *root_path,
+                                      anjay_request_action_t action,
+                                      size_t values_count,
+                                      const anjay_batch_t *const *values,
+                                      uint16_t default_format);
+
 /**
  * If batch consists of a single entry pertaining to a Single Resource or
  * Resource Instance, with a value of numeric type (int, uint or double), then
@@ -279,6 +429,21 @@ bool _anjay_batch_data_requires_hierarchical_format(const anjay_batch_t *batch);
  */
 double _anjay_batch_data_numeric_value(const anjay_batch_t *batch);
 
+/**
+ * If batch consists of at least two entries, all pertaining to Resource
+ * Instances of a single Multiple-Instance Resource and with values of numeric
+ * type, returns a pointer to a contiguous array of their numerical values (in
+ * the same order as the entries) and stores its length in @p out_count. The
+ * array is computed on the first call, and remains valid for as long as the
+ * batch does. As that modifies the batch, concurrent calls for the same batch
+ * need to be serialized - this is the case for the observe subsystem, which
+ * calls it with the Anjay mutex locked.
+ *
+ * Otherwise, returns NULL and leaves @p out_count untouched.
+ */
+const double *_anjay_batch_data_numeric_array(const anjay_batch_t *batch,
+                                              size_t *out_count);
+
 /**
  * If batch consists of a single entry pertaining to a Single Resource or
  * Resource Instance, with a value of boolean type, then writes the value to
@@ -299,6 +464,53 @@ void _anjay_batch_update_common_path_prefix(const anjay_uri_path_t **prefix_ptr,
                                             const anjay_batch_t *batch);
 #endif // ANJAY_WITH_LWM2M11
 
+#ifdef ANJAY_WITH_SEND
+/**
+ * Calculates the size of the LwM2M Send payload into which @p batch alone
+ * would be serialized using @p format , by serializing it into a stream that
+ * only counts the bytes written.
+ *
+ * NOTE: The result is an estimate if the batch contains timestamps relative to
+ * the serialization time, or Instances whose readability is subject to Access
+ * Control changes.
+ *
+ * @returns 0 for success, or a negative value in case of error.
+ */
+int _anjay_batch_send_payload_size(anjay_unlocked_t *anjay,
+                                   const anjay_batch_t *batch,
+                                   anjay_ssid_t target_ssid,
+                                   uint16_t format,
+                                   size_t *out_size);
+
+/**
+ * Checks whether @p batch , when serialized for @p target_ssid , would yield
+ * exactly the same payload as when serialized in full - i.e., all its entries
+ * are readable by the target server regardless of Access Control state, and
+ * none of the timestamps is relative to the serialization time.
+ *
+ * Such payload can be serialized once and sent to multiple servers.
+ */
+bool _anjay_batch_serialization_shareable(anjay_unlocked_t *anjay,
+                                          const anjay_batch_t *batch,
+                                          anjay_ssid_t target_ssid);
+#endif // ANJAY_WITH_SEND
+
+#ifdef ANJAY_WITH_SEND_PERSISTENCE
+/**
+ * Stores the contents of @p batch using a persistence context created with
+ * @ref avs_persistence_store_context_create .
+ */
+avs_error_t _anjay_batch_persist(avs_persistence_context_t *ctx,
+                                 const anjay_batch_t *batch);
+
+/**
+ * Reads data stored with @ref _anjay_batch_persist and compiles it into a new
+ * batch, with reference count initialized to 1.
+ */
+avs_error_t _anjay_batch_restore(avs_persistence_context_t *ctx,
+                                 anjay_batch_t **out_batch);
+#endif // ANJAY_WITH_SEND_PERSISTENCE
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif // ANJAY_BATCH_BUILDER_H
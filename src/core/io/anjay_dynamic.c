@@ -15,6 +15,8 @@
 
 #include <avsystem/commons/avs_stream.h>
 
+#include <anjay_modules/anjay_memory_accounting.h>
+
 #include "../anjay_core.h"
 #include "../anjay_dm_core.h"
 #include "../anjay_io_core.h"
@@ -91,6 +93,16 @@ static anjay_unlocked_output_ctx_t *spawn_cbor(avs_stream_t *stream,
 
 #endif // ANJAY_WITH_CBOR
 
+#ifdef ANJAY_WITH_LWM2M_CBOR
+static anjay_unlocked_output_ctx_t *
+spawn_lwm2m_cbor(avs_stream_t *stream,
+                 const anjay_uri_path_t *uri,
+                 const size_t *items_count) {
+    (void) items_count;
+    return _anjay_output_lwm2m_cbor_create(stream, uri);
+}
+#endif // ANJAY_WITH_LWM2M_CBOR
+
 typedef struct {
     uint16_t format;
     anjay_input_ctx_constructor_t *input_ctx_constructor;
@@ -125,6 +137,9 @@ static const dynamic_format_def_t SUPPORTED_HIERARCHICAL_FORMATS[] = {
     { AVS_COAP_FORMAT_SENML_CBOR, _anjay_input_senml_cbor_create,
       spawn_senml_cbor },
 #endif // ANJAY_WITH_CBOR
+#ifdef ANJAY_WITH_LWM2M_CBOR
+    { AVS_COAP_FORMAT_OMA_LWM2M_CBOR, NULL, spawn_lwm2m_cbor },
+#endif // ANJAY_WITH_LWM2M_CBOR
     { AVS_COAP_FORMAT_NONE, NULL, NULL }
 };
 
@@ -141,6 +156,9 @@ static const dynamic_format_def_t SUPPORTED_COMPOSITE_READ_FORMATS[] = {
     { AVS_COAP_FORMAT_SENML_JSON, _anjay_input_json_composite_read_create,
       spawn_senml_json },
 #    endif // ANJAY_WITH_SENML_JSON
+#    ifdef ANJAY_WITH_LWM2M_CBOR
+    { AVS_COAP_FORMAT_OMA_LWM2M_CBOR, NULL, spawn_lwm2m_cbor },
+#    endif // ANJAY_WITH_LWM2M_CBOR
     { AVS_COAP_FORMAT_NONE, NULL, NULL }
 };
 #endif // defined(ANJAY_WITH_LWM2M11) &&
@@ -168,6 +186,9 @@ static const dynamic_format_def_t SUPPORTED_SEND_FORMATS[] = {
     { AVS_COAP_FORMAT_SENML_JSON, _anjay_input_json_composite_read_create,
       spawn_senml_json },
 #    endif // ANJAY_WITH_SENML_JSON
+#    ifdef ANJAY_WITH_LWM2M_CBOR
+    { AVS_COAP_FORMAT_OMA_LWM2M_CBOR, NULL, spawn_lwm2m_cbor },
+#    endif // ANJAY_WITH_LWM2M_CBOR
     { AVS_COAP_FORMAT_NONE, NULL, NULL }
 };
 #endif // ANJAY_WITH_SEND
@@ -199,7 +220,10 @@ static int spawn_output_ctx(anjay_unlocked_output_ctx_t **out_ctx,
         return ANJAY_ERR_NOT_ACCEPTABLE;
     }
 
-    if (!(*out_ctx = def->output_ctx_spawn_func(stream, uri, items_count))) {
+    ANJAY_ALLOCATION_SITE_ENTER(prev_site);
+    *out_ctx = def->output_ctx_spawn_func(stream, uri, items_count);
+    ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
+    if (!*out_ctx) {
         anjay_log(DEBUG, _("Failed to spawn output context"));
         return ANJAY_ERR_INTERNAL;
     }
@@ -211,6 +235,7 @@ uint16_t _anjay_default_hierarchical_format(anjay_lwm2m_version_t version) {
 #ifdef ANJAY_WITH_LWM2M11
     switch (version) {
     case ANJAY_LWM2M_VERSION_1_1:
+        // LwM2M CBOR is not used here, as it is only defined in LwM2M 1.2
 #    if defined(ANJAY_WITH_CBOR)
         return AVS_COAP_FORMAT_SENML_CBOR;
 #    elif defined(ANJAY_WITH_SENML_JSON)
@@ -317,10 +342,13 @@ int _anjay_input_dynamic_construct_raw(anjay_unlocked_input_ctx_t **out,
         // Nothing to prepare - the action does not need an input context.
         return 0;
     }
-    if (constructor) {
-        return constructor(out, stream, uri);
+    if (!constructor) {
+        return ANJAY_ERR_UNSUPPORTED_CONTENT_FORMAT;
     }
-    return ANJAY_ERR_UNSUPPORTED_CONTENT_FORMAT;
+    ANJAY_ALLOCATION_SITE_ENTER(prev_site);
+    int result = constructor(out, stream, uri);
+    ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
+    return result;
 }
 
 int _anjay_input_dynamic_construct(anjay_unlocked_input_ctx_t **out,
@@ -16,6 +16,7 @@
 #    include <avsystem/commons/avs_utils.h>
 
 #    include "../anjay_io_core.h"
+#    include "../anjay_utils_private.h"
 #    include "../coap/anjay_content_format.h"
 #    include "anjay_base64_out.h"
 #    include "anjay_common.h"
@@ -135,9 +136,9 @@ static int maybe_write_separator(json_encoder_t *ctx) {
 static inline int maybe_write_time(json_encoder_t *ctx, double time_s) {
     if (!isnan(time_s)) {
         if (begin_pair(ctx, SENML_LABEL_TIME)
-                || avs_is_err(avs_stream_write_f(ctx->stream, "%s",
-                                                 AVS_DOUBLE_AS_STRING(time_s,
-                                                                      17)))) {
+                || avs_is_err(avs_stream_write_f(
+                           ctx->stream, "%s",
+                           ANJAY_DOUBLE_AS_SHORTEST_STRING(time_s)))) {
             return -1;
         }
     }
@@ -221,7 +222,8 @@ static inline int maybe_write_basetime(json_encoder_t *ctx, double time_s) {
 
     if (begin_pair(ctx, SENML_LABEL_BASE_TIME)
             || avs_is_err(avs_stream_write_f(
-                       ctx->stream, "%s", AVS_DOUBLE_AS_STRING(time_s, 17)))) {
+                       ctx->stream, "%s",
+                       ANJAY_DOUBLE_AS_SHORTEST_STRING(time_s)))) {
         return -1;
     }
     return 0;
@@ -261,6 +263,9 @@ static int senml_encode_key(json_encoder_t *ctx, senml_label_t type) {
     case SENML_LABEL_BASE_TIME:
         key = "\"bt\":";
         break;
+    case SENML_LABEL_TIME:
+        key = "\"t\":";
+        break;
     case SENML_EXT_LABEL_OBJLNK:
         key = "\"vlo\":";
         break;
@@ -288,6 +293,25 @@ static int senml_element_begin(anjay_senml_like_encoder_t *ctx_,
     return 0;
 }
 
+static int senml_element_begin_relative(anjay_senml_like_encoder_t *ctx_,
+                                        const char *basename,
+                                        const char *name,
+                                        double base_time_s,
+                                        double time_offset_s) {
+    json_encoder_t *ctx = (json_encoder_t *) ctx_;
+    if (senml_element_begin(ctx_, basename, name, base_time_s)) {
+        return -1;
+    }
+    if (!isnan(time_offset_s) && time_offset_s != 0.0
+            && (begin_pair(ctx, SENML_LABEL_TIME)
+                || avs_is_err(avs_stream_write_f(
+                           ctx->stream, "%s",
+                           ANJAY_DOUBLE_AS_SHORTEST_STRING(time_offset_s))))) {
+        return -1;
+    }
+    return 0;
+}
+
 static int senml_encoder_cleanup(anjay_senml_like_encoder_t **ctx_) {
     json_encoder_t *ctx = (json_encoder_t *) *ctx_;
     int retval = -1;
@@ -343,7 +367,8 @@ static int encode_double(anjay_senml_like_encoder_t *ctx_, double value) {
     json_encoder_t *ctx = (json_encoder_t *) ctx_;
     if (begin_pair(ctx, SENML_LABEL_VALUE)
             || avs_is_err(avs_stream_write_f(
-                       ctx->stream, "%s", AVS_DOUBLE_AS_STRING(value, 17)))) {
+                       ctx->stream, "%s",
+                       ANJAY_DOUBLE_AS_SHORTEST_STRING(value)))) {
         return -1;
     }
     return 0;
@@ -444,6 +469,7 @@ static const anjay_senml_like_encoder_vtable_t LWM2M_JSON_ENCODER_VTABLE = {
 static const anjay_senml_like_encoder_vtable_t SENML_JSON_ENCODER_VTABLE = {
     JSON_VTABLE_COMMON_DEF,
     .senml_like_element_begin = senml_element_begin,
+    .senml_like_element_begin_relative = senml_element_begin_relative,
     .senml_like_encoder_cleanup = senml_encoder_cleanup
 };
 #    endif // ANJAY_WITH_SENML_JSON
@@ -0,0 +1,374 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_LWM2M_CBOR
+
+#    include <assert.h>
+#    include <inttypes.h>
+
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream.h>
+#    include <avsystem/commons/avs_utils.h>
+
+#    include <anjay/core.h>
+
+#    include "anjay_common.h"
+#    include "anjay_vtable.h"
+
+#    include "cbor/anjay_cbor_encoder_ll.h"
+
+#    define lwm2m_cbor_log(level, ...) \
+        _anjay_log(lwm2m_cbor_out, level, __VA_ARGS__)
+
+VISIBILITY_SOURCE_BEGIN
+
+/*
+ * LwM2M CBOR (LwM2M TS 1.2, 7.4.7) represents data as nested maps keyed by
+ * path components, e.g. {3: {0: {0: "Manufacturer", 1: "Model"}}}. A key
+ * may also be an array of subsequent path components, so that a common prefix
+ * is only written once, e.g. {[3, 0]: {0: "Manufacturer", 1: "Model"}}.
+ *
+ * All maps are written as indefinite-length ones, so that the data can be
+ * streamed without knowing the number of entries in advance. The prefix
+ * shared by all entries (i.e. the base path) is encoded as a single key.
+ * Entries then open maps for subsequent path components, which are kept open
+ * for as long as the following entries share them.
+ *
+ * If entries are not serialized in ascending order of paths (which may happen
+ * for Read-Composite and Send), reusing the open maps could lead to duplicate
+ * keys. In that case, all subsequent entries are written directly into the
+ * base path map, using full relative paths as keys.
+ */
+
+typedef struct {
+    const anjay_ret_bytes_ctx_vtable_t *vtable;
+    size_t num_bytes_left;
+} lwm2m_cbor_bytes_t;
+
+typedef struct {
+    anjay_unlocked_output_ctx_t base;
+    lwm2m_cbor_bytes_t bytes;
+    avs_stream_t *stream;
+    anjay_uri_path_t base_path;
+    anjay_uri_path_t path;
+    /** Path of the most recently written entry. */
+    anjay_uri_path_t last_path;
+    /**
+     * Number of path components covered by each of the currently open nested
+     * maps, not including the top-level one.
+     */
+    size_t open_maps_lengths[_ANJAY_URI_PATH_MAX_LENGTH];
+    size_t open_maps_count;
+    /** True if any entry was not written in ascending order of paths. */
+    bool unordered;
+} lwm2m_cbor_out_t;
+
+static size_t common_prefix_length(const anjay_uri_path_t *left,
+                                   const anjay_uri_path_t *right) {
+    size_t result = 0;
+    while (result < AVS_ARRAY_SIZE(left->ids)
+           && left->ids[result] != ANJAY_ID_INVALID
+           && left->ids[result] == right->ids[result]) {
+        ++result;
+    }
+    return result;
+}
+
+static int write_key(avs_stream_t *stream,
+                     const anjay_uri_path_t *path,
+                     size_t begin,
+                     size_t end) {
+    assert(begin < end);
+    if (end - begin > 1
+            && _anjay_cbor_ll_definite_array_begin(stream, end - begin)) {
+        return -1;
+    }
+    for (size_t i = begin; i < end; ++i) {
+        if (_anjay_cbor_ll_encode_uint(stream, path->ids[i])) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static size_t open_maps_covered_length(const lwm2m_cbor_out_t *ctx) {
+    return ctx->open_maps_count
+                   ? ctx->open_maps_lengths[ctx->open_maps_count - 1]
+                   : 0;
+}
+
+static int open_map(lwm2m_cbor_out_t *ctx, size_t end) {
+    assert(ctx->open_maps_count < AVS_ARRAY_SIZE(ctx->open_maps_lengths));
+    if (write_key(ctx->stream, &ctx->path, open_maps_covered_length(ctx), end)
+            || _anjay_cbor_ll_indefinite_map_begin(ctx->stream)) {
+        return -1;
+    }
+    ctx->open_maps_lengths[ctx->open_maps_count++] = end;
+    return 0;
+}
+
+/**
+ * Closes the maps that cannot contain the entry at the current path, opens
+ * the ones that are necessary, and writes the key for the entry itself.
+ */
+static int entry_begin(lwm2m_cbor_out_t *ctx) {
+    if (ctx->bytes.num_bytes_left) {
+        lwm2m_cbor_log(ERROR, _("previous bytes value not finished"));
+        return -1;
+    }
+    size_t path_length = _anjay_uri_path_length(&ctx->path);
+    size_t base_path_length = _anjay_uri_path_length(&ctx->base_path);
+    if (!path_length) {
+        return -1;
+    }
+
+    if (!ctx->unordered && _anjay_uri_path_length(&ctx->last_path)
+            && _anjay_uri_path_compare(&ctx->path, &ctx->last_path) <= 0) {
+        lwm2m_cbor_log(DEBUG, _("entries not in order, prefixes will not be "
+                                "reused any further"));
+        ctx->unordered = true;
+    }
+
+    size_t common_length = common_prefix_length(&ctx->path, &ctx->last_path);
+    while (ctx->open_maps_count) {
+        size_t length = ctx->open_maps_lengths[ctx->open_maps_count - 1];
+        bool is_base_map = (ctx->open_maps_count == 1
+                            && length == base_path_length);
+        if (length <= common_length && length < path_length
+                && (!ctx->unordered || is_base_map)) {
+            break;
+        }
+        if (_anjay_cbor_ll_indefinite_structure_end(ctx->stream)) {
+            return -1;
+        }
+        --ctx->open_maps_count;
+    }
+
+    if (!ctx->open_maps_count && base_path_length > 0
+            && base_path_length < path_length
+            && open_map(ctx, base_path_length)) {
+        return -1;
+    }
+    if (!ctx->unordered) {
+        while (open_maps_covered_length(ctx) + 1 < path_length) {
+            if (open_map(ctx, open_maps_covered_length(ctx) + 1)) {
+                return -1;
+            }
+        }
+    }
+    ctx->last_path = ctx->path;
+    return write_key(ctx->stream, &ctx->path, open_maps_covered_length(ctx),
+                     path_length);
+}
+
+static int entry_end(lwm2m_cbor_out_t *ctx, int result) {
+    if (!result) {
+        ctx->path = MAKE_ROOT_PATH();
+    }
+    return result;
+}
+
+static int lwm2m_cbor_bytes_append(anjay_unlocked_ret_bytes_ctx_t *ctx_,
+                                   const void *data,
+                                   size_t length) {
+    lwm2m_cbor_out_t *ctx = AVS_CONTAINER_OF(ctx_, lwm2m_cbor_out_t, bytes);
+    if (length > ctx->bytes.num_bytes_left) {
+        return -1;
+    }
+    if (!length) {
+        return 0;
+    }
+    int result = _anjay_cbor_ll_bytes_append(ctx->stream, data, length);
+    if (!result) {
+        ctx->bytes.num_bytes_left -= length;
+    }
+    return result;
+}
+
+static const anjay_ret_bytes_ctx_vtable_t LWM2M_CBOR_BYTES_VTABLE = {
+    .append = lwm2m_cbor_bytes_append
+};
+
+static int
+lwm2m_cbor_ret_bytes(anjay_unlocked_output_ctx_t *ctx_,
+                     size_t length,
+                     anjay_unlocked_ret_bytes_ctx_t **out_bytes_ctx) {
+    lwm2m_cbor_out_t *ctx = (lwm2m_cbor_out_t *) ctx_;
+    int result;
+    if (!(result = entry_begin(ctx))
+            && !(result = _anjay_cbor_ll_bytes_begin(ctx->stream, length))) {
+        ctx->bytes.num_bytes_left = length;
+        *out_bytes_ctx = (anjay_unlocked_ret_bytes_ctx_t *) &ctx->bytes;
+    }
+    return entry_end(ctx, result);
+}
+
+static int lwm2m_cbor_ret_string(anjay_unlocked_output_ctx_t *ctx_,
+                                 const char *value) {
+    lwm2m_cbor_out_t *ctx = (lwm2m_cbor_out_t *) ctx_;
+    int result;
+    (void) ((result = entry_begin(ctx))
+            || (result = _anjay_cbor_ll_encode_string(ctx->stream, value)));
+    return entry_end(ctx, result);
+}
+
+static int lwm2m_cbor_ret_integer(anjay_unlocked_output_ctx_t *ctx_,
+                                  int64_t value) {
+    lwm2m_cbor_out_t *ctx = (lwm2m_cbor_out_t *) ctx_;
+    int result;
+    (void) ((result = entry_begin(ctx))
+            || (result = _anjay_cbor_ll_encode_int(ctx->stream, value)));
+    return entry_end(ctx, result);
+}
+
+static int lwm2m_cbor_ret_uint(anjay_unlocked_output_ctx_t *ctx_,
+                               uint64_t value) {
+    lwm2m_cbor_out_t *ctx = (lwm2m_cbor_out_t *) ctx_;
+    int result;
+    (void) ((result = entry_begin(ctx))
+            || (result = _anjay_cbor_ll_encode_uint(ctx->stream, value)));
+    return entry_end(ctx, result);
+}
+
+static int lwm2m_cbor_ret_double(anjay_unlocked_output_ctx_t *ctx_,
+                                 double value) {
+    lwm2m_cbor_out_t *ctx = (lwm2m_cbor_out_t *) ctx_;
+    int result;
+    (void) ((result = entry_begin(ctx))
+            || (result = _anjay_cbor_ll_encode_double(ctx->stream, value)));
+    return entry_end(ctx, result);
+}
+
+static int lwm2m_cbor_ret_bool(anjay_unlocked_output_ctx_t *ctx_,
+                               bool value) {
+    lwm2m_cbor_out_t *ctx = (lwm2m_cbor_out_t *) ctx_;
+    int result;
+    (void) ((result = entry_begin(ctx))
+            || (result = _anjay_cbor_ll_encode_bool(ctx->stream, value)));
+    return entry_end(ctx, result);
+}
+
+static int lwm2m_cbor_ret_objlnk(anjay_unlocked_output_ctx_t *ctx_,
+                                 anjay_oid_t oid,
+                                 anjay_iid_t iid) {
+    char objlnk[MAX_OBJLNK_STRING_SIZE];
+    int result = avs_simple_snprintf(objlnk, sizeof(objlnk),
+                                     "%" PRIu16 ":%" PRIu16, oid, iid);
+    assert(result > 0);
+    (void) result;
+
+    return lwm2m_cbor_ret_string(ctx_, objlnk);
+}
+
+static int lwm2m_cbor_ret_start_aggregate(anjay_unlocked_output_ctx_t *ctx_) {
+    lwm2m_cbor_out_t *ctx = (lwm2m_cbor_out_t *) ctx_;
+    if (!_anjay_uri_path_leaf_is(&ctx->path, ANJAY_ID_IID)
+            && !_anjay_uri_path_leaf_is(&ctx->path, ANJAY_ID_RID)) {
+        return -1;
+    }
+    // empty aggregate is represented as an empty map
+    int result;
+    (void) ((result = entry_begin(ctx))
+            || (result = _anjay_cbor_ll_definite_map_begin(ctx->stream, 0)));
+    return entry_end(ctx, result);
+}
+
+static int lwm2m_cbor_set_path(anjay_unlocked_output_ctx_t *ctx_,
+                               const anjay_uri_path_t *uri) {
+    lwm2m_cbor_out_t *ctx = (lwm2m_cbor_out_t *) ctx_;
+    AVS_ASSERT(!_anjay_uri_path_outside_base(uri, &ctx->base_path),
+               "Attempted to set path outside the context's base path. "
+               "This is a bug in resource reading logic.");
+    if (_anjay_uri_path_length(&ctx->path) > 0) {
+        lwm2m_cbor_log(ERROR, _("Path already set"));
+        return -1;
+    }
+    ctx->path = *uri;
+    return 0;
+}
+
+static int lwm2m_cbor_clear_path(anjay_unlocked_output_ctx_t *ctx_) {
+    lwm2m_cbor_out_t *ctx = (lwm2m_cbor_out_t *) ctx_;
+    if (_anjay_uri_path_length(&ctx->path) == 0) {
+        lwm2m_cbor_log(ERROR, _("Path not set"));
+        return -1;
+    }
+    ctx->path = MAKE_ROOT_PATH();
+    return 0;
+}
+
+static int lwm2m_cbor_set_time(anjay_unlocked_output_ctx_t *ctx_,
+                               double value) {
+    // LwM2M CBOR has no means of representing timestamps
+    (void) ctx_;
+    (void) value;
+    return 0;
+}
+
+static int lwm2m_cbor_output_close(anjay_unlocked_output_ctx_t *ctx_) {
+    lwm2m_cbor_out_t *ctx = (lwm2m_cbor_out_t *) ctx_;
+    int result = 0;
+    if (ctx->bytes.num_bytes_left) {
+        result = -1;
+    }
+    // nested maps and the top-level one
+    for (size_t i = 0; !result && i <= ctx->open_maps_count; ++i) {
+        result = _anjay_cbor_ll_indefinite_structure_end(ctx->stream);
+    }
+    if (_anjay_uri_path_length(&ctx->path) > 0) {
+        _anjay_update_ret(&result, ANJAY_OUTCTXERR_ANJAY_RET_NOT_CALLED);
+    }
+    return result;
+}
+
+static const anjay_output_ctx_vtable_t LWM2M_CBOR_OUT_VTABLE = {
+    .bytes_begin = lwm2m_cbor_ret_bytes,
+    .string = lwm2m_cbor_ret_string,
+    .integer = lwm2m_cbor_ret_integer,
+    .uint = lwm2m_cbor_ret_uint,
+    .floating = lwm2m_cbor_ret_double,
+    .boolean = lwm2m_cbor_ret_bool,
+    .objlnk = lwm2m_cbor_ret_objlnk,
+    .start_aggregate = lwm2m_cbor_ret_start_aggregate,
+    .set_path = lwm2m_cbor_set_path,
+    .clear_path = lwm2m_cbor_clear_path,
+    .set_time = lwm2m_cbor_set_time,
+    .close = lwm2m_cbor_output_close
+};
+
+anjay_unlocked_output_ctx_t *
+_anjay_output_lwm2m_cbor_create(avs_stream_t *stream,
+                                const anjay_uri_path_t *uri) {
+    lwm2m_cbor_out_t *ctx =
+            (lwm2m_cbor_out_t *) avs_calloc(1, sizeof(lwm2m_cbor_out_t));
+    if (!ctx) {
+        return NULL;
+    }
+    ctx->base.vtable = &LWM2M_CBOR_OUT_VTABLE;
+    ctx->bytes.vtable = &LWM2M_CBOR_BYTES_VTABLE;
+    ctx->stream = stream;
+    ctx->base_path = *uri;
+    ctx->path = MAKE_ROOT_PATH();
+    ctx->last_path = MAKE_ROOT_PATH();
+
+    if (_anjay_cbor_ll_indefinite_map_begin(stream)) {
+        lwm2m_cbor_log(DEBUG, _("failed to create LwM2M CBOR context"));
+        avs_free(ctx);
+        return NULL;
+    }
+    return (anjay_unlocked_output_ctx_t *) ctx;
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/core/io/lwm2m_cbor_out.c"
+#    endif // ANJAY_TEST
+
+#endif // ANJAY_WITH_LWM2M_CBOR
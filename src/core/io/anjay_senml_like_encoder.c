@@ -69,6 +69,20 @@ int _anjay_senml_like_element_begin(anjay_senml_like_encoder_t *ctx,
     return ctx->vtable->senml_like_element_begin(ctx, basename, name, time_s);
 }
 
+int _anjay_senml_like_element_begin_relative(anjay_senml_like_encoder_t *ctx,
+                                             const char *basename,
+                                             const char *name,
+                                             double base_time_s,
+                                             double time_offset_s) {
+    assert(ctx && ctx->vtable);
+    if (!ctx->vtable->senml_like_element_begin_relative) {
+        return _anjay_senml_like_element_begin(ctx, basename, name,
+                                               base_time_s + time_offset_s);
+    }
+    return ctx->vtable->senml_like_element_begin_relative(
+            ctx, basename, name, base_time_s, time_offset_s);
+}
+
 int _anjay_senml_like_element_end(anjay_senml_like_encoder_t *ctx) {
     assert(ctx && ctx->vtable);
     assert(ctx->vtable->senml_like_element_end);
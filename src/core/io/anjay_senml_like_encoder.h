@@ -61,6 +61,19 @@ int _anjay_senml_like_element_begin(anjay_senml_like_encoder_t *ctx,
                                     const char *name,
                                     double time_s);
 
+/**
+ * Variant of @ref _anjay_senml_like_element_begin for elements whose time is
+ * <c>base_time_s + time_offset_s</c>. Formats that support it encode
+ * @p base_time_s as Base Time (only if it differs from the previous one) and
+ * @p time_offset_s as Time, so that consecutive elements sharing the same base
+ * only differ in the, usually short, relative value.
+ */
+int _anjay_senml_like_element_begin_relative(anjay_senml_like_encoder_t *ctx,
+                                             const char *basename,
+                                             const char *name,
+                                             double base_time_s,
+                                             double time_offset_s);
+
 /**
  * @param ctx Pointer to SenML-like encoder.
  * @returns 0 in case of success, negative value otherwise.
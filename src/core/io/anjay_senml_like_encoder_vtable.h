@@ -28,6 +28,11 @@ typedef int (*senml_like_element_begin_t)(anjay_senml_like_encoder_t *,
                                           const char *basename,
                                           const char *name,
                                           double time_s);
+typedef int (*senml_like_element_begin_relative_t)(anjay_senml_like_encoder_t *,
+                                                   const char *basename,
+                                                   const char *name,
+                                                   double base_time_s,
+                                                   double time_offset_s);
 typedef int (*senml_like_element_end_t)(anjay_senml_like_encoder_t *);
 typedef int (*senml_like_bytes_begin_t)(anjay_senml_like_encoder_t *, size_t);
 typedef int (*senml_like_bytes_append_t)(anjay_senml_like_encoder_t *,
@@ -44,6 +49,8 @@ typedef struct {
     senml_like_encode_string_t senml_like_encode_string;
     senml_like_encode_objlnk_t senml_like_encode_objlnk;
     senml_like_element_begin_t senml_like_element_begin;
+    /** Optional; if NULL, base and offset are summed up. */
+    senml_like_element_begin_relative_t senml_like_element_begin_relative;
     senml_like_element_end_t senml_like_element_end;
     senml_like_bytes_begin_t senml_like_bytes_begin;
     senml_like_bytes_append_t senml_like_bytes_append;
@@ -35,6 +35,20 @@ typedef struct {
     const anjay_ret_bytes_ctx_vtable_t *vtable;
 } senml_bytes_t;
 
+/**
+ * String representation of the path of the most recently written element.
+ * Components shared with the next element's path are not rendered again.
+ */
+typedef struct {
+    anjay_uri_path_t path;
+    char str[MAX_PATH_STRING_SIZE];
+    /**
+     * lengths[i] is the length of the representation of the first i path
+     * components.
+     */
+    uint8_t lengths[_ANJAY_URI_PATH_MAX_LENGTH + 1];
+} rendered_path_t;
+
 typedef struct senml_out_struct {
     anjay_unlocked_output_ctx_t base;
     anjay_senml_like_encoder_t *encoder;
@@ -42,54 +56,137 @@ typedef struct senml_out_struct {
     anjay_uri_path_t base_path;
     senml_bytes_t bytes;
     bool returning_bytes;
-    bool basename_written;
+    /**
+     * If true, basename is written once, when creating the encoder, and is
+     * then never changed. Otherwise, it is chosen for each element.
+     */
+    bool basename_fixed;
+    /** Number of path components included in the basename currently used. */
+    size_t basename_length;
+    /**
+     * Estimated number of bytes taken by the basename label, excluding the
+     * path itself - used to decide whether changing the basename pays off.
+     */
+    size_t basename_overhead;
+    /**
+     * Number of elements written so far that share the first N path
+     * components of the most recently written one.
+     */
+    size_t group_size[_ANJAY_URI_PATH_MAX_LENGTH + 1];
+    /**
+     * Number of elements that shared the first N path components, for the last
+     * group with such prefix that is already finished.
+     */
+    size_t prev_group_size[_ANJAY_URI_PATH_MAX_LENGTH + 1];
+    rendered_path_t rendered;
     double timestamp;
+    /**
+     * If not NAN, the time of the next element is timestamp + time_offset,
+     * and timestamp shall be encoded as Base Time.
+     */
+    double time_offset;
 } senml_out_t;
 
-static int path_to_string(const anjay_uri_path_t *path,
-                          size_t start_index,
-                          size_t end_index,
-                          char *dest,
-                          size_t size) {
-    for (; start_index < end_index; start_index++) {
-        int written_chars = avs_simple_snprintf(dest, size, "/%" PRIu16,
-                                                path->ids[start_index]);
-        if (written_chars < 0) {
-            return -1;
-        }
-        dest += written_chars;
-        size -= (size_t) written_chars;
+static size_t render_id(char *dest, uint16_t id) {
+    char digits[sizeof("65535") - 1];
+    size_t length = 0;
+    do {
+        digits[length++] = (char) ('0' + id % 10);
+        id /= 10;
+    } while (id);
+    for (size_t i = 0; i < length; ++i) {
+        dest[i] = digits[length - 1 - i];
     }
-    return 0;
+    return length;
 }
 
-static char *maybe_get_basename(senml_out_t *ctx, char *buf, size_t size) {
-    size_t base_path_length = _anjay_uri_path_length(&ctx->base_path);
-    char *retptr = NULL;
-    if (!ctx->basename_written && base_path_length > 0) {
-        *buf = '\0';
-        int result =
-                path_to_string(&ctx->base_path, 0, base_path_length, buf, size);
-        AVS_ASSERT(result == 0, "buffer too small");
-        (void) result;
-        retptr = buf;
+static size_t common_prefix_length(const anjay_uri_path_t *left,
+                                   const anjay_uri_path_t *right) {
+    size_t result = 0;
+    while (result < AVS_ARRAY_SIZE(left->ids)
+           && left->ids[result] != ANJAY_ID_INVALID
+           && left->ids[result] == right->ids[result]) {
+        ++result;
     }
-    return retptr;
+    return result;
 }
 
-static char *maybe_get_name(senml_out_t *ctx, char *buf, size_t size) {
-    size_t base_path_length = _anjay_uri_path_length(&ctx->base_path);
-    size_t path_length = _anjay_uri_path_length(&ctx->path);
-    char *retptr = NULL;
-    if (path_length > base_path_length) {
-        *buf = '\0';
-        int result = path_to_string(&ctx->path, base_path_length, path_length,
-                                    buf, size);
-        AVS_ASSERT(result == 0, "buffer too small");
-        (void) result;
-        retptr = buf;
+/**
+ * Renders @p path into @p rendered , assuming that its first
+ * @p common_length components are already there.
+ */
+static void render_path(rendered_path_t *rendered,
+                        const anjay_uri_path_t *path,
+                        size_t common_length) {
+    size_t path_length = _anjay_uri_path_length(path);
+    for (size_t i = common_length; i < path_length; ++i) {
+        char *dest = &rendered->str[rendered->lengths[i]];
+        *dest++ = '/';
+        rendered->lengths[i + 1] =
+                (uint8_t) (rendered->lengths[i] + 1
+                           + render_id(dest, path->ids[i]));
+    }
+    rendered->str[rendered->lengths[path_length]] = '\0';
+    rendered->path = *path;
+}
+
+static void update_group_sizes(senml_out_t *ctx,
+                               size_t common_length,
+                               size_t path_length) {
+    for (size_t i = common_length + 1; i <= path_length; ++i) {
+        if (ctx->group_size[i]) {
+            ctx->prev_group_size[i] = ctx->group_size[i];
+        }
+        ctx->group_size[i] = 0;
+    }
+}
+
+/**
+ * Chooses the number of path components that shall be included in the
+ * basename of the element that is about to be written, so that the expected
+ * payload size is minimal.
+ *
+ * The number of elements that will share the candidate prefix is estimated
+ * from the size of the previous group of elements on the same level, e.g. the
+ * number of Resources in the previous Object Instance. The cost of writing
+ * a new basename is amortized over that many elements.
+ */
+static size_t choose_basename_length(senml_out_t *ctx,
+                                     size_t common_length,
+                                     size_t path_length) {
+    if (ctx->basename_fixed) {
+        return ctx->basename_length;
+    }
+    // Costs are scaled to avoid losing precision when amortizing
+    static const size_t SCALE = 16;
+    const uint8_t *lengths = ctx->rendered.lengths;
+    size_t min_length = _anjay_uri_path_length(&ctx->base_path);
+    size_t max_length = AVS_MAX(min_length, path_length - 1);
+
+    size_t best_length = ctx->basename_length;
+    size_t best_cost = SIZE_MAX;
+    if (ctx->basename_length >= min_length
+            && ctx->basename_length <= common_length) {
+        // current basename is still a valid prefix, keep it if there is no
+        // better option
+        best_cost = SCALE * (lengths[path_length] - lengths[best_length]);
     }
-    return retptr;
+    for (size_t i = min_length; i <= max_length; ++i) {
+        if (i == ctx->basename_length && best_cost != SIZE_MAX) {
+            continue;
+        }
+        size_t remaining = 1;
+        if (ctx->prev_group_size[i] > ctx->group_size[i]) {
+            remaining = ctx->prev_group_size[i] - ctx->group_size[i];
+        }
+        size_t cost = SCALE * (ctx->basename_overhead + lengths[i]) / remaining
+                      + SCALE * (lengths[path_length] - lengths[i]);
+        if (cost < best_cost) {
+            best_length = i;
+            best_cost = cost;
+        }
+    }
+    return best_length;
 }
 
 static int finish_ret_bytes(senml_out_t *ctx) {
@@ -112,16 +209,43 @@ static int element_begin(senml_out_t *ctx) {
         }
     }
 
+    size_t common_length =
+            common_prefix_length(&ctx->path, &ctx->rendered.path);
+    size_t path_length = _anjay_uri_path_length(&ctx->path);
+    render_path(&ctx->rendered, &ctx->path, common_length);
+    update_group_sizes(ctx, common_length, path_length);
+
     char basename_buf[MAX_PATH_STRING_SIZE];
-    char name_buf[MAX_PATH_STRING_SIZE];
-
-    char *name = maybe_get_name(ctx, name_buf, sizeof(name_buf));
-    char *basename =
-            maybe_get_basename(ctx, basename_buf, sizeof(basename_buf));
-    ctx->basename_written = true;
-    int result = _anjay_senml_like_element_begin(ctx->encoder, basename, name,
-                                                 ctx->timestamp);
+    const char *basename = NULL;
+    size_t basename_length =
+            choose_basename_length(ctx, common_length, path_length);
+    // basename needs to be written also if the one currently used is no
+    // longer a prefix of the path
+    if (basename_length != ctx->basename_length
+            || basename_length > common_length) {
+        size_t basename_size = ctx->rendered.lengths[basename_length];
+        memcpy(basename_buf, ctx->rendered.str, basename_size);
+        basename_buf[basename_size] = '\0';
+        basename = basename_buf;
+        ctx->basename_length = basename_length;
+    }
+    const char *name = NULL;
+    if (path_length > basename_length) {
+        name = &ctx->rendered.str[ctx->rendered.lengths[basename_length]];
+    }
+    for (size_t i = 1; i <= path_length; ++i) {
+        ++ctx->group_size[i];
+    }
+
+    int result = isnan(ctx->time_offset)
+                         ? _anjay_senml_like_element_begin(ctx->encoder,
+                                                           basename, name,
+                                                           ctx->timestamp)
+                         : _anjay_senml_like_element_begin_relative(
+                                   ctx->encoder, basename, name,
+                                   ctx->timestamp, ctx->time_offset);
     ctx->timestamp = NAN;
+    ctx->time_offset = NAN;
     ctx->path = MAKE_ROOT_PATH();
     return result;
 }
@@ -255,6 +379,15 @@ static int senml_set_time(anjay_unlocked_output_ctx_t *ctx_, double value) {
     return 0;
 }
 
+static int senml_set_relative_time(anjay_unlocked_output_ctx_t *ctx_,
+                                   double base_value,
+                                   double offset) {
+    senml_out_t *ctx = (senml_out_t *) ctx_;
+    ctx->timestamp = base_value;
+    ctx->time_offset = offset;
+    return 0;
+}
+
 static int senml_output_close(anjay_unlocked_output_ctx_t *ctx_) {
     senml_out_t *ctx = (senml_out_t *) ctx_;
     int result = 0;
@@ -283,6 +416,7 @@ static const anjay_output_ctx_vtable_t SENML_OUT_VTABLE = {
     .set_path = senml_set_path,
     .clear_path = senml_clear_path,
     .set_time = senml_set_time,
+    .set_relative_time = senml_set_relative_time,
     .close = senml_output_close
 };
 
@@ -301,28 +435,35 @@ _anjay_output_senml_like_create(avs_stream_t *stream,
     ctx->base.vtable = &SENML_OUT_VTABLE;
     ctx->bytes.vtable = &STREAMED_BYTES_VTABLE;
     ctx->timestamp = NAN;
+    ctx->time_offset = NAN;
     ctx->path = MAKE_ROOT_PATH();
     ctx->base_path = *uri;
+    ctx->rendered.path = MAKE_ROOT_PATH();
 
     switch (format) {
 #    ifdef ANJAY_WITH_LWM2M_JSON
     case AVS_COAP_FORMAT_OMA_LWM2M_JSON: {
-        char basename_buf[MAX_PATH_STRING_SIZE];
-        char *basename =
-                maybe_get_basename(ctx, basename_buf, sizeof(basename_buf));
-        ctx->encoder = _anjay_lwm2m_json_encoder_new(stream, basename);
-        ctx->basename_written = true;
+        size_t base_path_length = _anjay_uri_path_length(&ctx->base_path);
+        render_path(&ctx->rendered, &ctx->base_path, 0);
+        ctx->encoder = _anjay_lwm2m_json_encoder_new(
+                stream, base_path_length > 0 ? ctx->rendered.str : NULL);
+        ctx->basename_fixed = true;
+        ctx->basename_length = base_path_length;
         break;
     }
 #    endif // ANJAY_WITH_LWM2M_JSON
 #    ifdef ANJAY_WITH_SENML_JSON
     case AVS_COAP_FORMAT_SENML_JSON:
         ctx->encoder = _anjay_senml_json_encoder_new(stream);
+        // "bn":"",
+        ctx->basename_overhead = 8;
         break;
 #    endif // ANJAY_WITH_SENML_JSON
 #    ifdef ANJAY_WITH_CBOR
     case AVS_COAP_FORMAT_SENML_CBOR:
         ctx->encoder = _anjay_senml_cbor_encoder_new(stream, items_count);
+        // label and text string header
+        ctx->basename_overhead = 2;
         break;
 #    endif // ANJAY_WITH_CBOR
     default:
@@ -343,5 +484,9 @@ error:
     return NULL;
 }
 
+#    if defined(ANJAY_TEST) && defined(ANJAY_WITH_SENML_JSON)
+#        include "tests/core/io/senml_like_out.c"
+#    endif // defined(ANJAY_TEST) && defined(ANJAY_WITH_SENML_JSON)
+
 #endif // defined(ANJAY_WITH_LWM2M_JSON) || defined(ANJAY_WITH_SENML_JSON) ||
        // defined(ANJAY_WITH_CBOR)
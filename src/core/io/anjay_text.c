@@ -114,8 +114,9 @@ static int text_ret_double(anjay_unlocked_output_ctx_t *ctx_, double value) {
     // As printing floating-point numbers in C as pure decimal with sane
     // precision is tricky, let's take the spec a bit loosely for now.
     if (ctx->state == STATE_PATH_SET
-            && avs_is_ok(avs_stream_write_f(ctx->stream, "%s",
-                                            AVS_DOUBLE_AS_STRING(value, 17)))) {
+            && avs_is_ok(avs_stream_write_f(
+                       ctx->stream, "%s",
+                       ANJAY_DOUBLE_AS_SHORTEST_STRING(value)))) {
         ctx->state = STATE_FINISHED;
         return 0;
     }
@@ -215,6 +216,11 @@ typedef struct {
     anjay_uri_path_t request_uri;
 } text_in_t;
 
+// Maximum number of Base64 characters decoded at once, must be a multiple of 4
+#    define TEXT_DECODE_CHUNK_SIZE (4 * 64u)
+AVS_STATIC_ASSERT(TEXT_DECODE_CHUNK_SIZE % 4 == 0,
+                  chunk_must_be_a_multiple_of_4);
+
 static int
 has_valid_padding(const char *buffer, size_t size, bool msg_finished) {
     const char *last = buffer + size;
@@ -247,34 +253,52 @@ static int text_get_some_bytes(anjay_unlocked_input_ctx_t *ctx_,
     *out_bytes_read = 0;
 
     text_get_some_bytes_cache_flush(ctx, &current, &buf_size);
-    // 4bytes + null terminator
-    char encoded[5];
-    size_t stream_bytes_read;
+    char encoded[TEXT_DECODE_CHUNK_SIZE + 1];
     bool stream_msg_finished = false;
 
     while (buf_size > 0) {
-        if (avs_is_err(avs_stream_read(ctx->stream, &stream_bytes_read,
-                                       &stream_msg_finished, encoded,
-                                       sizeof(encoded) - 1))) {
-            return -1;
-        }
-        encoded[stream_bytes_read] = '\0';
-        if (stream_bytes_read % 4) {
+        // As many full groups as fit in the output buffer are decoded directly
+        // into it. If it is shorter than a single group, the group is decoded
+        // into the cache instead.
+        size_t num_groups =
+                AVS_MIN(AVS_MAX(buf_size / 3, 1), TEXT_DECODE_CHUNK_SIZE / 4);
+        size_t encoded_capacity = 4 * num_groups;
+        size_t encoded_size = 0;
+        do {
+            size_t stream_bytes_read;
+            if (avs_is_err(avs_stream_read(ctx->stream, &stream_bytes_read,
+                                           &stream_msg_finished,
+                                           encoded + encoded_size,
+                                           encoded_capacity - encoded_size))) {
+                return -1;
+            }
+            encoded_size += stream_bytes_read;
+        } while (!stream_msg_finished && encoded_size % 4);
+        encoded[encoded_size] = '\0';
+        if (encoded_size % 4) {
             return ANJAY_ERR_BAD_REQUEST;
         }
-        if (has_valid_padding(encoded, stream_bytes_read,
-                              stream_msg_finished)) {
+        if (has_valid_padding(encoded, encoded_size, stream_msg_finished)) {
             return ANJAY_ERR_BAD_REQUEST;
         }
         assert(ctx->num_bytes_cached == 0);
         size_t num_decoded;
-        if (avs_base64_decode_strict(&num_decoded,
-                                     (uint8_t *) ctx->bytes_cached,
-                                     sizeof(ctx->bytes_cached), encoded)) {
-            return ANJAY_ERR_BAD_REQUEST;
+        if (buf_size >= 3) {
+            if (avs_base64_decode_strict(&num_decoded, current, buf_size,
+                                         encoded)) {
+                return ANJAY_ERR_BAD_REQUEST;
+            }
+            current += num_decoded;
+            buf_size -= num_decoded;
+        } else {
+            if (avs_base64_decode_strict(&num_decoded,
+                                         (uint8_t *) ctx->bytes_cached,
+                                         sizeof(ctx->bytes_cached), encoded)) {
+                return ANJAY_ERR_BAD_REQUEST;
+            }
+            ctx->num_bytes_cached = num_decoded;
+            text_get_some_bytes_cache_flush(ctx, &current, &buf_size);
         }
-        ctx->num_bytes_cached = num_decoded;
-        text_get_some_bytes_cache_flush(ctx, &current, &buf_size);
         if (stream_msg_finished) {
             break;
         }
@@ -14,7 +14,6 @@
 #    include <assert.h>
 #    include <string.h>
 
-#    include <avsystem/commons/avs_list.h>
 #    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_stream.h>
 #    include <avsystem/commons/avs_utils.h>
@@ -26,18 +25,9 @@
 
 VISIBILITY_SOURCE_BEGIN
 
-typedef struct {
-    tlv_id_type_t type;
-    uint16_t id;
-} tlv_id_t;
-
 #    define TLV_MAX_LENGTH ((1 << 24) - 1)
 
-typedef struct {
-    size_t data_length;
-    tlv_id_t id;
-    char data[];
-} tlv_entry_t;
+#    define TLV_MIN_BUFFER_CAPACITY 64
 
 typedef struct {
     const anjay_ret_bytes_ctx_vtable_t *vtable;
@@ -49,8 +39,13 @@ typedef struct {
 } tlv_bytes_t;
 
 typedef struct {
-    AVS_LIST(tlv_entry_t) entries;
-    AVS_LIST(tlv_entry_t) *next_entry_ptr;
+    // Serialized entries (headers and payloads) of the aggregate being built on
+    // this level. Not used at the root level, which is streamed directly. The
+    // buffer is kept allocated when the aggregate is finished, so that it is
+    // reused by the next one on the same level.
+    char *buffer;
+    size_t buffer_size;
+    size_t buffer_capacity;
 
     // ID that will be used when serializing the next element.
     // ANJAY_ID_INVALID if it's not set.
@@ -172,31 +167,48 @@ static int get_current_level_value_type(tlv_out_t *ctx, tlv_id_type_t *out) {
     }
 }
 
-static int write_entry(avs_stream_t *stream,
-                       const tlv_id_t *id,
-                       const void *buf,
-                       size_t length) {
-    if (write_header(stream, id->type, id->id, length)
-            || avs_is_err(avs_stream_write(stream, buf, length))) {
-        return -1;
+static char *reserve_buffer(tlv_out_level_t *level, size_t length) {
+    if (length > SIZE_MAX - level->buffer_size) {
+        return NULL;
     }
-    return 0;
+    size_t required_size = level->buffer_size + length;
+    if (required_size > level->buffer_capacity) {
+        size_t new_capacity = AVS_MAX(required_size, TLV_MIN_BUFFER_CAPACITY);
+        if (level->buffer_capacity <= SIZE_MAX / 2) {
+            new_capacity = AVS_MAX(new_capacity, 2 * level->buffer_capacity);
+        }
+        char *new_buffer = (char *) avs_realloc(level->buffer, new_capacity);
+        if (!new_buffer) {
+            return NULL;
+        }
+        level->buffer = new_buffer;
+        level->buffer_capacity = new_capacity;
+    }
+    char *result = level->buffer + level->buffer_size;
+    level->buffer_size = required_size;
+    return result;
 }
 
 static char *
 add_buffered_entry(tlv_out_t *ctx, tlv_id_type_t type, size_t length) {
-    tlv_entry_t *new_entry =
-            (tlv_entry_t *) AVS_LIST_NEW_BUFFER(sizeof(tlv_entry_t) + length);
-    if (!new_entry) {
+    tlv_out_level_t *level = current_level(ctx);
+    uint16_t id = level->next_id;
+    level->next_id = ANJAY_ID_INVALID;
+    if (id == ANJAY_ID_INVALID) {
         return NULL;
     }
-    new_entry->data_length = length;
-    new_entry->id.type = type;
-    new_entry->id.id = current_level(ctx)->next_id;
-    current_level(ctx)->next_id = ANJAY_ID_INVALID;
-    *current_level(ctx)->next_entry_ptr = new_entry;
-    AVS_LIST_ADVANCE_PTR(&current_level(ctx)->next_entry_ptr);
-    return new_entry->data;
+    size_t entry_header_size = header_size(id, length);
+    char *entry = reserve_buffer(level, entry_header_size + length);
+    if (!entry) {
+        return NULL;
+    }
+    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+    avs_stream_outbuf_set_buffer(&outbuf, entry, entry_header_size);
+    if (write_header((avs_stream_t *) &outbuf, type, id, length)) {
+        level->buffer_size -= entry_header_size + length;
+        return NULL;
+    }
+    return entry + entry_header_size;
 }
 
 static int streamed_bytes_append(anjay_unlocked_ret_bytes_ctx_t *ctx_,
@@ -376,44 +388,30 @@ static int tlv_slave_finish(tlv_out_t *ctx) {
         AVS_UNREACHABLE("Already at root level of TLV structure");
         return -1;
     }
-    size_t data_size = 0;
-    {
-        tlv_entry_t *entry = NULL;
-        AVS_LIST_FOREACH(entry, current_level(ctx)->entries) {
-            data_size += header_size(entry->id.id, entry->data_length)
-                         + entry->data_length;
-        }
-    }
-    char *buffer = (char *) (data_size ? avs_malloc(data_size) : NULL);
-    int retval = ((!data_size || buffer) ? 0 : -1);
-    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
-    avs_stream_outbuf_set_buffer(&outbuf, buffer, data_size);
-    AVS_LIST_CLEAR(&current_level(ctx)->entries) {
-        if (!retval) {
-            retval = write_entry((avs_stream_t *) &outbuf,
-                                 &current_level(ctx)->entries->id,
-                                 current_level(ctx)->entries->data,
-                                 current_level(ctx)->entries->data_length);
-        }
+    tlv_out_level_t *level = current_level(ctx);
+    if (level->bytes_ctx.bytes_left) {
+        // value not returned in full, make sure that no uninitialized leftovers
+        // of previous aggregates are sent
+        assert(level->bytes_ctx.vtable == &BUFFERED_BYTES_VTABLE);
+        memset(level->bytes_ctx.output.buffer_ptr, 0,
+               level->bytes_ctx.bytes_left);
+        level->bytes_ctx.bytes_left = 0;
     }
     ctx->level = (tlv_out_level_id_t) (ctx->level - 1);
-    if (!retval) {
-        size_t length = avs_stream_outbuf_offset(&outbuf);
-        anjay_unlocked_ret_bytes_ctx_t *bytes = NULL;
-        switch (ctx->level) {
-        case TLV_OUT_LEVEL_RID:
-            bytes = add_entry(ctx, TLV_ID_RID_ARRAY, length);
-            break;
-        case TLV_OUT_LEVEL_IID:
-            bytes = add_entry(ctx, TLV_ID_IID, length);
-            break;
-        default:;
-        }
-        retval = !bytes ? -1
-                        : _anjay_ret_bytes_append_unlocked(bytes, buffer,
-                                                           length);
-    }
-    avs_free(buffer);
+    anjay_unlocked_ret_bytes_ctx_t *bytes = NULL;
+    switch (ctx->level) {
+    case TLV_OUT_LEVEL_RID:
+        bytes = add_entry(ctx, TLV_ID_RID_ARRAY, level->buffer_size);
+        break;
+    case TLV_OUT_LEVEL_IID:
+        bytes = add_entry(ctx, TLV_ID_IID, level->buffer_size);
+        break;
+    default:;
+    }
+    int retval = !bytes ? -1
+                        : _anjay_ret_bytes_append_unlocked(
+                                  bytes, level->buffer, level->buffer_size);
+    level->buffer_size = 0;
     return retval;
 }
 
@@ -585,7 +583,10 @@ static int tlv_output_close(anjay_unlocked_output_ctx_t *ctx_) {
         }
     }
     for (uint8_t i = 0; i < AVS_ARRAY_SIZE(ctx->levels); ++i) {
-        AVS_LIST_CLEAR(&ctx->levels[i].entries);
+        avs_free(ctx->levels[i].buffer);
+        ctx->levels[i].buffer = NULL;
+        ctx->levels[i].buffer_size = 0;
+        ctx->levels[i].buffer_capacity = 0;
     }
     return result;
 }
@@ -609,8 +610,7 @@ static const anjay_output_ctx_vtable_t TLV_OUT_VTABLE = {
 static void tlv_slave_start(tlv_out_t *ctx) {
     assert((size_t) (ctx->level + 1) <= AVS_ARRAY_SIZE(ctx->levels));
     ctx->level = (tlv_out_level_id_t) (ctx->level + 1);
-    assert(!current_level(ctx)->entries);
-    current_level(ctx)->next_entry_ptr = &current_level(ctx)->entries;
+    assert(!current_level(ctx)->buffer_size);
     current_level(ctx)->next_id = ANJAY_ID_INVALID;
 }
 
@@ -629,7 +629,6 @@ _anjay_output_tlv_create(avs_stream_t *stream, const anjay_uri_path_t *uri) {
     ctx->base.vtable = &TLV_OUT_VTABLE;
     ctx->stream = stream;
     ctx->root_path = *uri;
-    current_level(ctx)->next_entry_ptr = &current_level(ctx)->entries;
     current_level(ctx)->next_id = ANJAY_ID_INVALID;
     return (anjay_unlocked_output_ctx_t *) ctx;
 }
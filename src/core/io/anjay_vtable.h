@@ -27,6 +27,15 @@ typedef int (*anjay_output_ctx_bytes_begin_t)(
         anjay_unlocked_output_ctx_t *,
         size_t,
         anjay_unlocked_ret_bytes_ctx_t **);
+/**
+ * Optional; if not implemented, the data is returned the same way as with
+ * bytes_begin. The release function shall NOT be called on failure.
+ */
+typedef int (*anjay_output_ctx_bytes_borrowed_t)(anjay_unlocked_output_ctx_t *,
+                                                 const void *,
+                                                 size_t,
+                                                 anjay_ret_bytes_release_t *,
+                                                 void *);
 typedef int (*anjay_output_ctx_string_t)(anjay_unlocked_output_ctx_t *,
                                          const char *);
 typedef int (*anjay_output_ctx_integer_t)(anjay_unlocked_output_ctx_t *,
@@ -53,10 +62,13 @@ typedef int (*anjay_output_ctx_set_path_t)(anjay_unlocked_output_ctx_t *,
 typedef int (*anjay_output_ctx_clear_path_t)(anjay_unlocked_output_ctx_t *);
 typedef int (*anjay_output_ctx_set_time_t)(anjay_unlocked_output_ctx_t *,
                                            double);
+typedef int (*anjay_output_ctx_set_relative_time_t)(
+        anjay_unlocked_output_ctx_t *, double, double);
 typedef int (*anjay_output_ctx_close_t)(anjay_unlocked_output_ctx_t *);
 
 struct anjay_output_ctx_vtable_struct {
     anjay_output_ctx_bytes_begin_t bytes_begin;
+    anjay_output_ctx_bytes_borrowed_t bytes_borrowed;
     anjay_output_ctx_string_t string;
     anjay_output_ctx_integer_t integer;
 #ifdef ANJAY_WITH_LWM2M11
@@ -73,6 +85,7 @@ struct anjay_output_ctx_vtable_struct {
     anjay_output_ctx_set_path_t set_path;
     anjay_output_ctx_clear_path_t clear_path;
     anjay_output_ctx_set_time_t set_time;
+    anjay_output_ctx_set_relative_time_t set_relative_time;
     anjay_output_ctx_close_t close;
 };
 
@@ -110,7 +110,85 @@ int _anjay_cbor_ll_encode_float(avs_stream_t *stream, float value) {
     return retval;
 }
 
+#    ifdef ANJAY_WITH_CBOR_COMPACT_NUMBERS
+/**
+ * Converts @p value to an IEEE 754 half-precision number, if it can be
+ * represented exactly.
+ */
+static bool float_to_half(float value, uint16_t *out_half) {
+    if (isnan(value)) {
+        // canonical NaN; payload is not preserved
+        *out_half = 0x7E00;
+        return true;
+    }
+    union {
+        float f;
+        uint32_t u;
+    } conv;
+    conv.f = value;
+    const uint16_t sign = (uint16_t) ((conv.u >> 16) & 0x8000);
+    const int32_t exponent = (int32_t) ((conv.u >> 23) & 0xFF) - 127;
+    const uint32_t mantissa = conv.u & 0x7FFFFF;
+
+    if (exponent == 128) {
+        // infinity
+        *out_half = (uint16_t) (sign | 0x7C00);
+        return true;
+    } else if (exponent == -127) {
+        // zero, or a single-precision subnormal that is too small for half
+        if (mantissa) {
+            return false;
+        }
+        *out_half = sign;
+        return true;
+    } else if (exponent >= -14 && exponent <= 15) {
+        if (mantissa & 0x1FFF) {
+            return false;
+        }
+        *out_half = (uint16_t) (sign | ((exponent + 15) << 10)
+                                | (mantissa >> 13));
+        return true;
+    } else if (exponent >= -24 && exponent < -14) {
+        // half-precision subnormal: significand * 2^-24
+        const uint32_t significand = mantissa | 0x800000;
+        const int shift = -1 - exponent;
+        if (significand & ((UINT32_C(1) << shift) - 1)) {
+            return false;
+        }
+        *out_half = (uint16_t) (sign | (significand >> shift));
+        return true;
+    }
+    return false;
+}
+
+static int encode_half(avs_stream_t *stream, uint16_t half) {
+    uint16_t portable = avs_convert_be16(half);
+    int retval = write_cbor_header(stream,
+                                   CBOR_MAJOR_TYPE_FLOAT_OR_SIMPLE_VALUE,
+                                   CBOR_EXT_LENGTH_2BYTE);
+    if (!retval
+            && avs_is_err(
+                       avs_stream_write(stream, &portable, sizeof(portable)))) {
+        retval = -1;
+    }
+    return retval;
+}
+#    endif // ANJAY_WITH_CBOR_COMPACT_NUMBERS
+
 int _anjay_cbor_ll_encode_double(avs_stream_t *stream, double value) {
+#    ifdef ANJAY_WITH_CBOR_COMPACT_NUMBERS
+    // -0.0 is not an integer, as that would lose the sign
+    if (value >= (double) INT64_MIN && value < -(double) INT64_MIN
+            && (double) (int64_t) value == value
+            && (value != 0.0 || !signbit(value))) {
+        return _anjay_cbor_ll_encode_int(stream, (int64_t) value);
+    }
+    uint16_t half;
+    if ((isnan(value) || ((float) value) == value)
+            && float_to_half((float) value, &half)) {
+        return encode_half(stream, half);
+    }
+#    endif // ANJAY_WITH_CBOR_COMPACT_NUMBERS
     if (((float) value) == value) {
         return _anjay_cbor_ll_encode_float(stream, (float) value);
     }
@@ -151,4 +229,14 @@ int _anjay_cbor_ll_definite_array_begin(avs_stream_t *stream,
     return encode_type_and_number(stream, CBOR_MAJOR_TYPE_ARRAY, items_count);
 }
 
+int _anjay_cbor_ll_indefinite_map_begin(avs_stream_t *stream) {
+    return write_cbor_header(stream, CBOR_MAJOR_TYPE_MAP,
+                             CBOR_EXT_LENGTH_INDEFINITE);
+}
+
+int _anjay_cbor_ll_indefinite_structure_end(avs_stream_t *stream) {
+    static const uint8_t BREAK = CBOR_INDEFINITE_STRUCTURE_BREAK;
+    return avs_is_ok(avs_stream_write(stream, &BREAK, 1)) ? 0 : -1;
+}
+
 #endif // ANJAY_WITH_CBOR
@@ -29,6 +29,14 @@ int _anjay_cbor_ll_encode_bool(avs_stream_t *stream, bool value);
 
 int _anjay_cbor_ll_encode_float(avs_stream_t *stream, float value);
 
+/**
+ * Encodes @p value as a single-precision float if that is exact, or as a
+ * double otherwise.
+ *
+ * If <c>ANJAY_WITH_CBOR_COMPACT_NUMBERS</c> is enabled, integral values are
+ * encoded as integers instead, and other ones as half-precision floats if that
+ * is exact.
+ */
 int _anjay_cbor_ll_encode_double(avs_stream_t *stream, double value);
 
 int _anjay_cbor_ll_encode_string(avs_stream_t *stream, const char *data);
@@ -46,6 +54,14 @@ int _anjay_cbor_ll_definite_map_begin(avs_stream_t *stream, size_t items_count);
 int _anjay_cbor_ll_definite_array_begin(avs_stream_t *stream,
                                         size_t items_count);
 
+int _anjay_cbor_ll_indefinite_map_begin(avs_stream_t *stream);
+
+/**
+ * Writes the "break" byte, finishing a structure started with one of the
+ * <c>_anjay_cbor_ll_indefinite_*_begin()</c> functions.
+ */
+int _anjay_cbor_ll_indefinite_structure_end(avs_stream_t *stream);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif // ANJAY_IO_CBOR_ENCODER_LL_H
@@ -399,26 +399,65 @@ static inline int maybe_encode_name(cbor_encoder_t *ctx, const char *name) {
     return 0;
 }
 
-static int senml_cbor_element_begin(anjay_senml_like_encoder_t *ctx_,
-                                    const char *basename,
-                                    const char *name,
-                                    double time_s) {
-    cbor_encoder_t *ctx = (cbor_encoder_t *) ctx_;
-    if (isnan(time_s)) {
-        time_s = 0.0;
+/**
+ * Encodes the relative Time label. Integral values, which are typical for
+ * periodic sampling, are encoded as integers, which take less space.
+ */
+static int maybe_encode_time(cbor_encoder_t *ctx, double time_s) {
+    if (isnan(time_s) || time_s == 0.0) {
+        return 0;
+    }
+    assert(ctx->map_remaining_items);
+    int retval;
+    (void) ((retval = cbor_encode_int(ctx, SENML_LABEL_TIME))
+            || (retval = (time_s >= (double) INT32_MIN
+                          && time_s <= (double) INT32_MAX
+                          && (double) (int32_t) time_s == time_s)
+                                 ? cbor_encode_int(ctx, (int32_t) time_s)
+                                 : cbor_encode_double(ctx, time_s)));
+    ctx->map_remaining_items--;
+    return retval;
+}
+
+static int element_begin(cbor_encoder_t *ctx,
+                         const char *basename,
+                         const char *name,
+                         double base_time_s,
+                         double time_offset_s) {
+    if (isnan(base_time_s)) {
+        base_time_s = 0.0;
     }
 
     ctx->map_remaining_items =
             (uint8_t) (!!basename + !!name
-                       + (ctx->last_encoded_time_s != time_s) + 1);
+                       + (ctx->last_encoded_time_s != base_time_s)
+                       + (!isnan(time_offset_s) && time_offset_s != 0.0) + 1);
     int retval;
     (void) ((retval = cbor_definite_map_begin(ctx, ctx->map_remaining_items))
             || (retval = maybe_encode_basename(ctx, basename))
             || (retval = maybe_encode_name(ctx, name))
-            || (retval = maybe_encode_basetime(ctx, time_s)));
+            || (retval = maybe_encode_basetime(ctx, base_time_s))
+            || (retval = maybe_encode_time(ctx, time_offset_s)));
     return retval;
 }
 
+static int senml_cbor_element_begin(anjay_senml_like_encoder_t *ctx_,
+                                    const char *basename,
+                                    const char *name,
+                                    double time_s) {
+    return element_begin((cbor_encoder_t *) ctx_, basename, name, time_s, NAN);
+}
+
+static int
+senml_cbor_element_begin_relative(anjay_senml_like_encoder_t *ctx_,
+                                  const char *basename,
+                                  const char *name,
+                                  double base_time_s,
+                                  double time_offset_s) {
+    return element_begin((cbor_encoder_t *) ctx_, basename, name, base_time_s,
+                         time_offset_s);
+}
+
 static int senml_cbor_element_end(anjay_senml_like_encoder_t *ctx_) {
     cbor_encoder_t *ctx = (cbor_encoder_t *) ctx_;
     assert(ctx->map_remaining_items == 0);
@@ -482,6 +521,7 @@ static const anjay_senml_like_encoder_vtable_t SENML_CBOR_ENCODER_VTABLE = {
     .senml_like_encode_string = senml_cbor_encode_string,
     .senml_like_encode_objlnk = senml_cbor_encode_objlnk,
     .senml_like_element_begin = senml_cbor_element_begin,
+    .senml_like_element_begin_relative = senml_cbor_element_begin_relative,
     .senml_like_element_end = senml_cbor_element_end,
     .senml_like_bytes_begin = senml_cbor_bytes_begin,
     .senml_like_bytes_append = senml_cbor_bytes_append,
@@ -27,6 +27,8 @@ VISIBILITY_SOURCE_BEGIN
 
 #    define MAX_NEST_STACK_SIZE 2
 
+#    define INPUT_BUFFER_SIZE 64
+
 typedef enum {
     JSON_NESTED_NONE,
     JSON_NESTED_ARRAY_ELEMENT,
@@ -40,6 +42,13 @@ typedef struct {
     anjay_json_like_decoder_state_t state;
     anjay_json_like_value_type_t current_item_type;
     json_nested_type_t nested_types[MAX_NEST_STACK_SIZE];
+
+    // Look-ahead buffer, so that the input is consumed in chunks and scanned
+    // locally instead of calling the stream API for every character.
+    size_t buffer_pos;
+    size_t buffer_size;
+    bool message_finished;
+    char buffer[INPUT_BUFFER_SIZE];
 } anjay_json_decoder_t;
 
 static anjay_json_like_decoder_state_t
@@ -59,7 +68,108 @@ json_decoder_current_value_type(anjay_json_like_decoder_t *ctx_,
 }
 
 static bool is_json_whitespace(int ch) {
-    return strchr(" \r\n\t", ch);
+    return ch == ' ' || ch == '\r' || ch == '\n' || ch == '\t';
+}
+
+static avs_error_t fill_buffer(anjay_json_decoder_t *ctx) {
+    while (ctx->buffer_pos >= ctx->buffer_size) {
+        if (ctx->message_finished) {
+            return AVS_EOF;
+        }
+        size_t bytes_read;
+        avs_error_t err = avs_stream_read(ctx->stream, &bytes_read,
+                                          &ctx->message_finished, ctx->buffer,
+                                          sizeof(ctx->buffer));
+        if (avs_is_err(err)) {
+            return err;
+        }
+        ctx->buffer_pos = 0;
+        ctx->buffer_size = bytes_read;
+    }
+    return AVS_OK;
+}
+
+static avs_error_t peek_char(anjay_json_decoder_t *ctx, unsigned char *out) {
+    avs_error_t err = fill_buffer(ctx);
+    if (avs_is_ok(err)) {
+        *out = (unsigned char) ctx->buffer[ctx->buffer_pos];
+    }
+    return err;
+}
+
+static avs_error_t get_char(anjay_json_decoder_t *ctx, unsigned char *out) {
+    avs_error_t err = peek_char(ctx, out);
+    if (avs_is_ok(err)) {
+        ++ctx->buffer_pos;
+    }
+    return err;
+}
+
+static avs_error_t
+read_reliably(anjay_json_decoder_t *ctx, void *out, size_t size) {
+    while (size) {
+        avs_error_t err = fill_buffer(ctx);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        size_t chunk_size = AVS_MIN(size, ctx->buffer_size - ctx->buffer_pos);
+        memcpy(out, &ctx->buffer[ctx->buffer_pos], chunk_size);
+        ctx->buffer_pos += chunk_size;
+        out = (char *) out + chunk_size;
+        size -= chunk_size;
+    }
+    return AVS_OK;
+}
+
+static avs_error_t skip_whitespace(anjay_json_decoder_t *ctx) {
+    while (true) {
+        avs_error_t err = fill_buffer(ctx);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        while (ctx->buffer_pos < ctx->buffer_size
+               && is_json_whitespace(
+                          (unsigned char) ctx->buffer[ctx->buffer_pos])) {
+            ++ctx->buffer_pos;
+        }
+        if (ctx->buffer_pos < ctx->buffer_size) {
+            return AVS_OK;
+        }
+    }
+}
+
+#    define SWAR_ONES UINT64_C(0x0101010101010101)
+#    define SWAR_HAS_BYTE_LESS(Word, Value) \
+        (((Word) - SWAR_ONES * (Value)) & ~(Word) & (SWAR_ONES << 7))
+#    define SWAR_HAS_BYTE(Word, Value) \
+        SWAR_HAS_BYTE_LESS((Word) ^ (SWAR_ONES * (Value)), 1)
+
+static bool is_plain_string_char(unsigned char ch) {
+    AVS_STATIC_ASSERT(' ' == 0x20, ascii);
+    return ch >= ' ' && ch != '"' && ch != '\\';
+}
+
+/**
+ * Returns the number of leading bytes of @p data that can be copied verbatim
+ * as string contents, i.e. that are neither quotes, backslashes nor control
+ * characters. Eight bytes are checked at a time as long as possible.
+ */
+static size_t plain_string_run_length(const char *data, size_t size) {
+    size_t length = 0;
+    while (size - length >= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + length, sizeof(word));
+        if (SWAR_HAS_BYTE_LESS(word, ' ') || SWAR_HAS_BYTE(word, '"')
+                || SWAR_HAS_BYTE(word, '\\')) {
+            break;
+        }
+        length += sizeof(word);
+    }
+    while (length < size
+           && is_plain_string_char((unsigned char) data[length])) {
+        ++length;
+    }
+    return length;
 }
 
 static size_t json_decoder_nesting_level(anjay_json_like_decoder_t *ctx_) {
@@ -84,65 +194,56 @@ static json_nested_type_t *top_level_nesting_ptr(anjay_json_decoder_t *ctx) {
 static int preprocess_possible_value(anjay_json_decoder_t *ctx) {
     assert(ctx->state == ANJAY_JSON_LIKE_DECODER_STATE_OK);
     json_nested_type_t *nested_type = top_level_nesting_ptr(ctx);
-    while (true) {
-        unsigned char value;
-        avs_error_t err = avs_stream_peek(ctx->stream, 0, (char *) &value);
-        if (avs_is_eof(err)) {
-            ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_FINISHED;
-            return value;
-        } else if (avs_is_err(err)) {
-            LOG(DEBUG,
-                _("JSON parse error: could not read input stream: ") "%s",
-                AVS_COAP_STRERROR(err));
-            ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_ERROR;
-            return value;
-        }
-
-        if (is_json_whitespace(value)) {
-            err = avs_stream_getch(ctx->stream, (char *) &value, NULL);
-            assert(avs_is_ok(err));
-            assert(is_json_whitespace(value));
-            (void) err;
-            continue;
-        }
+    unsigned char value = 0;
+    avs_error_t err = skip_whitespace(ctx);
+    if (avs_is_ok(err)) {
+        err = peek_char(ctx, &value);
+    }
+    if (avs_is_eof(err)) {
+        ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_FINISHED;
+        return value;
+    } else if (avs_is_err(err)) {
+        LOG(DEBUG, _("JSON parse error: could not read input stream: ") "%s",
+            AVS_COAP_STRERROR(err));
+        ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_ERROR;
+        return value;
+    }
 
-        if (isdigit(value) || value == '-') {
-            ctx->current_item_type = ANJAY_JSON_LIKE_VALUE_DOUBLE;
-        } else {
-            switch (value) {
-            case 'n':
-                ctx->current_item_type = ANJAY_JSON_LIKE_VALUE_NULL;
-                break;
+    if (isdigit(value) || value == '-') {
+        ctx->current_item_type = ANJAY_JSON_LIKE_VALUE_DOUBLE;
+    } else {
+        switch (value) {
+        case 'n':
+            ctx->current_item_type = ANJAY_JSON_LIKE_VALUE_NULL;
+            break;
 
-            case '"':
-                ctx->current_item_type = ANJAY_JSON_LIKE_VALUE_TEXT_STRING;
-                break;
+        case '"':
+            ctx->current_item_type = ANJAY_JSON_LIKE_VALUE_TEXT_STRING;
+            break;
 
-            case '{':
-                ctx->current_item_type = ANJAY_JSON_LIKE_VALUE_MAP;
-                break;
+        case '{':
+            ctx->current_item_type = ANJAY_JSON_LIKE_VALUE_MAP;
+            break;
 
-            case '[':
-                ctx->current_item_type = ANJAY_JSON_LIKE_VALUE_ARRAY;
-                break;
+        case '[':
+            ctx->current_item_type = ANJAY_JSON_LIKE_VALUE_ARRAY;
+            break;
 
-            case 't':
-            case 'f':
-                ctx->current_item_type = ANJAY_JSON_LIKE_VALUE_BOOL;
-                break;
+        case 't':
+        case 'f':
+            ctx->current_item_type = ANJAY_JSON_LIKE_VALUE_BOOL;
+            break;
 
-            default:
-                return value;
-            }
-        }
-        if (nested_type && *nested_type == JSON_NESTED_MAP_KEY
-                && ctx->current_item_type
-                               != ANJAY_JSON_LIKE_VALUE_TEXT_STRING) {
-            LOG(DEBUG, _("JSON parse error: only strings can be map keys"));
-            ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_ERROR;
+        default:
+            return value;
         }
-        return 0;
     }
+    if (nested_type && *nested_type == JSON_NESTED_MAP_KEY
+            && ctx->current_item_type != ANJAY_JSON_LIKE_VALUE_TEXT_STRING) {
+        LOG(DEBUG, _("JSON parse error: only strings can be map keys"));
+        ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_ERROR;
+    }
+    return 0;
 }
 
 static void preprocess_value(anjay_json_decoder_t *ctx) {
@@ -183,7 +284,7 @@ static void preprocess_first_nested_value(anjay_json_decoder_t *ctx) {
     } else if ((*nested_type == JSON_NESTED_ARRAY_ELEMENT && value == ']')
                || (*nested_type == JSON_NESTED_MAP_KEY && value == '}')) {
         unsigned char ch;
-        avs_error_t err = avs_stream_getch(ctx->stream, (char *) &ch, NULL);
+        avs_error_t err = get_char(ctx, &ch);
         assert(avs_is_ok(err));
         assert(ch == value);
         (void) ch;
@@ -201,10 +302,10 @@ static void preprocess_next_value(anjay_json_decoder_t *ctx) {
     while (true) {
         json_nested_type_t *nested_type = top_level_nesting_ptr(ctx);
         unsigned char ch;
-        avs_error_t err;
-        do {
-            err = avs_stream_getch(ctx->stream, (char *) &ch, NULL);
-        } while (avs_is_ok(err) && is_json_whitespace(ch));
+        avs_error_t err = skip_whitespace(ctx);
+        if (avs_is_ok(err)) {
+            err = get_char(ctx, &ch);
+        }
 
         if (avs_is_eof(err) && !nested_type) {
             ctx->state = ANJAY_JSON_LIKE_DECODER_STATE_FINISHED;
@@ -248,14 +349,14 @@ static int json_decoder_bool(anjay_json_like_decoder_t *ctx_, bool *out_value) {
         return -1;
     }
     char buf[4];
-    if (avs_is_err(avs_stream_read_reliably(ctx->stream, buf, sizeof(buf)))) {
+    if (avs_is_err(read_reliably(ctx, buf, sizeof(buf)))) {
         goto error;
     }
     if (memcmp(buf, "true", 4) == 0) {
         *out_value = true;
     } else if (memcmp(buf, "fals", 4) == 0) {
-        char ch;
-        if (avs_is_err(avs_stream_getch(ctx->stream, &ch, NULL)) || ch != 'e') {
+        unsigned char ch;
+        if (avs_is_err(get_char(ctx, &ch)) || ch != 'e') {
             goto error;
         }
         *out_value = false;
@@ -304,7 +405,7 @@ static int json_decoder_number(anjay_json_like_decoder_t *ctx_,
     char buf[ANJAY_MAX_DOUBLE_STRING_SIZE];
     while (true) {
         unsigned char ch;
-        avs_error_t err = avs_stream_peek(ctx->stream, 0, (char *) &ch);
+        avs_error_t err = peek_char(ctx, &ch);
         if (avs_is_err(err) && !avs_is_eof(err)) {
             goto error;
         } else if (avs_is_eof(err) || !is_valid_json_number_character(ch)) {
@@ -312,11 +413,11 @@ static int json_decoder_number(anjay_json_like_decoder_t *ctx_,
             break;
         }
 
-        if (avs_is_err(avs_stream_read_reliably(ctx->stream, buf + length, 1))
-                || ++length >= sizeof(buf)) {
+        ++ctx->buffer_pos;
+        buf[length] = (char) ch;
+        if (++length >= sizeof(buf)) {
             goto error;
         }
-        assert(((const unsigned char *) buf)[length - 1] == ch);
     }
     if (validate_number(buf)
             || _anjay_safe_strtod(buf, &out_value->value.f64)) {
@@ -333,7 +434,7 @@ error:
 static int handle_unicode_escape(anjay_json_decoder_t *ctx,
                                  avs_stream_t *target_stream) {
     char hex[5] = "";
-    if (avs_is_err(avs_stream_read_reliably(ctx->stream, &hex, sizeof(hex) - 1))
+    if (avs_is_err(read_reliably(ctx, &hex, sizeof(hex) - 1))
             || !hex[0] || isspace((unsigned char) hex[0])) {
         return -1;
     }
@@ -376,7 +477,7 @@ static int handle_unicode_escape(anjay_json_decoder_t *ctx,
 static int handle_string_escape(anjay_json_decoder_t *ctx,
                                 avs_stream_t *target_stream) {
     unsigned char ch;
-    if (avs_is_err(avs_stream_getch(ctx->stream, (char *) &ch, NULL))) {
+    if (avs_is_err(get_char(ctx, &ch))) {
         return -1;
     }
     switch (ch) {
@@ -416,27 +517,26 @@ static int json_decoder_bytes(anjay_json_like_decoder_t *ctx_,
         return -1;
     }
     unsigned char ch;
-    avs_error_t err = avs_stream_getch(ctx->stream, (char *) &ch, NULL);
+    avs_error_t err = get_char(ctx, &ch);
     assert(avs_is_ok(err));
     assert(ch == '"'); // previously checked using peek in preprocess_next_value
-    (void) err;
-    while (avs_is_ok(avs_stream_getch(ctx->stream, (char *) &ch, NULL))) {
-        AVS_STATIC_ASSERT(' ' == 0x20, ascii);
+    while (avs_is_ok((err = fill_buffer(ctx)))) {
+        const char *run = &ctx->buffer[ctx->buffer_pos];
+        size_t run_length = plain_string_run_length(
+                run, ctx->buffer_size - ctx->buffer_pos);
+        if (run_length) {
+            ctx->buffer_pos += run_length;
+            if (avs_is_err(avs_stream_write(target_stream, run, run_length))) {
+                break;
+            }
+            continue;
+        }
+        ch = (unsigned char) ctx->buffer[ctx->buffer_pos++];
         if (ch == '"') {
             preprocess_next_value(ctx);
             return 0;
-        } else if (ch < ' ') {
-            // Note: includes EOF and other negative values
-            break;
-        } else if (ch == '\\') {
-            if (handle_string_escape(ctx, target_stream)) {
-                break;
-            }
-        } else if (avs_is_err(avs_stream_write(target_stream,
-                                               &(unsigned char) {
-                                                       (unsigned char) ch },
-                                               1))) {
-            // Note: the "ch < ' '" case includes EOF and other negative values
+        } else if (ch != '\\' || handle_string_escape(ctx, target_stream)) {
+            // control character or invalid escape sequence
             break;
         }
     }
@@ -452,7 +552,7 @@ static int json_decoder_enter_array(anjay_json_like_decoder_t *ctx_) {
         return -1;
     }
     unsigned char ch;
-    avs_error_t err = avs_stream_getch(ctx->stream, (char *) &ch, NULL);
+    avs_error_t err = get_char(ctx, &ch);
     assert(avs_is_ok(err));
     assert(ch == '['); // previously checked using peek in preprocess_next_value
     (void) err;
@@ -469,7 +569,7 @@ static int json_decoder_enter_map(anjay_json_like_decoder_t *ctx_) {
         return -1;
     }
     unsigned char ch;
-    avs_error_t err = avs_stream_getch(ctx->stream, (char *) &ch, NULL);
+    avs_error_t err = get_char(ctx, &ch);
     assert(avs_is_ok(err));
     assert(ch == '{'); // previously checked using peek in preprocess_next_value
     (void) err;
@@ -15,11 +15,16 @@
 #    include <math.h>
 
 #    include <avsystem/commons/avs_errno.h>
+#    ifdef ANJAY_WITH_OBSERVE_PERSISTENCE
+#        include <avsystem/commons/avs_stream_inbuf.h>
+#    endif // ANJAY_WITH_OBSERVE_PERSISTENCE
 #    include <avsystem/commons/avs_stream_membuf.h>
 #    include <avsystem/commons/avs_stream_v_table.h>
 
+#    include <anjay_modules/anjay_memory_accounting.h>
 #    include <anjay_modules/anjay_time_defs.h>
 
+#    include "../anjay_access_utils_private.h"
 #    include "../anjay_core.h"
 #    include "../anjay_io_core.h"
 #    include "../anjay_servers_utils.h"
@@ -70,9 +75,26 @@ int _anjay_observe_path_entry_cmp(const void *left, const void *right) {
 
 void _anjay_observe_init(anjay_observe_state_t *observe,
                          bool confirmable_notifications,
-                         size_t stored_notification_limit) {
+                         size_t stored_notification_limit,
+                         size_t stored_notification_memory_limit,
+                         bool share_samples,
+                         bool coalesce_triggers,
+                         avs_time_duration_t trigger_slack,
+                         bool merge_unsent,
+                         size_t flush_burst,
+                         bool cache_payload,
+                         bool cache_attrs) {
     assert(!observe->connection_entries);
     observe->confirmable_notifications = confirmable_notifications;
+    observe->share_samples = share_samples;
+    observe->coalesce_triggers = coalesce_triggers;
+    observe->trigger_slack = avs_time_duration_valid(trigger_slack)
+                                     ? trigger_slack
+                                     : AVS_TIME_DURATION_ZERO;
+    observe->merge_unsent = merge_unsent;
+    observe->flush_burst = AVS_MAX(flush_burst, 1);
+    observe->cache_payload = cache_payload;
+    observe->cache_attrs = cache_attrs;
 
     if (stored_notification_limit == 0) {
         observe->notify_queue_limit_mode = NOTIFY_QUEUE_UNLIMITED;
@@ -80,12 +102,25 @@ void _anjay_observe_init(anjay_observe_state_t *observe,
         observe->notify_queue_limit = stored_notification_limit;
         observe->notify_queue_limit_mode = NOTIFY_QUEUE_DROP_OLDEST;
     }
+    observe->notify_queue_memory_limit = stored_notification_memory_limit;
 }
 
 static inline bool is_error_value(const anjay_observation_value_t *value) {
     return _anjay_observe_is_error_details(&value->details);
 }
 
+#    ifdef ANJAY_WITH_OBSERVATION_STATUS
+/**
+ * Adds @p Value to the counter called @p Counter of both @p Conn and
+ * @p Observation.
+ */
+#        define ADD_TO_COUNTER(Conn, Observation, Counter, Value) \
+            ((void) ((Conn)->counters.Counter += (Value),           \
+                     (Observation)->counters.Counter += (Value)))
+#    else // ANJAY_WITH_OBSERVATION_STATUS
+#        define ADD_TO_COUNTER(Conn, Observation, Counter, Value) ((void) 0)
+#    endif // ANJAY_WITH_OBSERVATION_STATUS
+
 static void delete_value(anjay_unlocked_t *anjay,
                          AVS_LIST(anjay_observation_value_t) *value_ptr) {
     (void) anjay;
@@ -105,6 +140,87 @@ path_entry_query(const anjay_uri_path_t *path) {
     return AVS_CONTAINER_OF(path, anjay_observe_path_entry_t, path);
 }
 
+static inline const anjay_observe_path_index_entry_t *
+path_index_entry_query(const anjay_uri_path_t *path) {
+    return AVS_CONTAINER_OF(path, anjay_observe_path_index_entry_t, path);
+}
+
+static int path_index_entry_cmp(const void *left, const void *right) {
+    return _anjay_uri_path_compare(
+            &((const anjay_observe_path_index_entry_t *) left)->path,
+            &((const anjay_observe_path_index_entry_t *) right)->path);
+}
+
+static int add_path_to_index(anjay_observe_connection_entry_t *connection,
+                             const anjay_uri_path_t *path) {
+    anjay_observe_state_t *observe = connection->observe;
+    if (!observe->observed_paths_index
+            && !(observe->observed_paths_index = AVS_SORTED_SET_NEW(
+                         anjay_observe_path_index_entry_t,
+                         path_index_entry_cmp))) {
+        _anjay_log_oom();
+        return -1;
+    }
+    AVS_SORTED_SET_ELEM(anjay_observe_path_index_entry_t) entry =
+            AVS_SORTED_SET_FIND(observe->observed_paths_index,
+                                path_index_entry_query(path));
+    if (!entry) {
+        AVS_SORTED_SET_ELEM(anjay_observe_path_index_entry_t) new_entry =
+                AVS_SORTED_SET_ELEM_NEW(anjay_observe_path_index_entry_t);
+        if (!new_entry) {
+            _anjay_log_oom();
+            return -1;
+        }
+        memcpy((void *) (intptr_t) (const void *) &new_entry->path, path,
+               sizeof(*path));
+        entry = AVS_SORTED_SET_INSERT(observe->observed_paths_index,
+                                      new_entry);
+        assert(entry == new_entry);
+    }
+    AVS_LIST(anjay_observe_connection_entry_t *) connection_ref =
+            AVS_LIST_INSERT_NEW(anjay_observe_connection_entry_t *,
+                                &entry->connections);
+    if (!connection_ref) {
+        _anjay_log_oom();
+        if (!entry->connections) {
+            AVS_SORTED_SET_DELETE_ELEM(observe->observed_paths_index, &entry);
+        }
+        return -1;
+    }
+    *connection_ref = connection;
+    return 0;
+}
+
+static void
+remove_path_from_index(anjay_observe_connection_entry_t *connection,
+                       const anjay_uri_path_t *path) {
+    anjay_observe_state_t *observe = connection->observe;
+    AVS_SORTED_SET_ELEM(anjay_observe_path_index_entry_t) entry =
+            AVS_SORTED_SET_FIND(observe->observed_paths_index,
+                                path_index_entry_query(path));
+    assert(entry);
+    AVS_LIST(anjay_observe_connection_entry_t *) *connection_ref_ptr;
+    AVS_LIST_FOREACH_PTR(connection_ref_ptr, &entry->connections) {
+        if (**connection_ref_ptr == connection) {
+            AVS_LIST_DELETE(connection_ref_ptr);
+            if (!entry->connections) {
+                AVS_SORTED_SET_DELETE_ELEM(observe->observed_paths_index,
+                                           &entry);
+            }
+            return;
+        }
+    }
+    AVS_UNREACHABLE("Connection entry not attached to the path index");
+}
+
+static void
+delete_observe_path_entry(anjay_observe_connection_entry_t *connection,
+                          AVS_SORTED_SET_ELEM(anjay_observe_path_entry_t)
+                                  *entry_ptr) {
+    remove_path_from_index(connection, &(*entry_ptr)->path);
+    AVS_SORTED_SET_DELETE_ELEM(connection->observed_paths, entry_ptr);
+}
+
 static AVS_SORTED_SET_ELEM(anjay_observe_path_entry_t)
 find_or_create_observe_path_entry(anjay_observe_connection_entry_t *connection,
                                   const anjay_uri_path_t *path) {
@@ -112,10 +228,14 @@ find_or_create_observe_path_entry(anjay_observe_connection_entry_t *connection,
             AVS_SORTED_SET_FIND(connection->observed_paths,
                                 path_entry_query(path));
     if (!entry) {
+        if (add_path_to_index(connection, path)) {
+            return NULL;
+        }
         AVS_SORTED_SET_ELEM(anjay_observe_path_entry_t) new_entry =
                 AVS_SORTED_SET_ELEM_NEW(anjay_observe_path_entry_t);
         if (!new_entry) {
             _anjay_log_oom();
+            remove_path_from_index(connection, path);
             return NULL;
         }
 
@@ -142,7 +262,7 @@ static int add_path_to_observed_paths(
     if (!entry) {
         _anjay_log_oom();
         if (!observed_path->refs) {
-            AVS_SORTED_SET_DELETE_ELEM(conn->observed_paths, &observed_path);
+            delete_observe_path_entry(conn, &observed_path);
         }
         return -1;
     }
@@ -162,8 +282,7 @@ static void remove_path_from_observed_paths(
         if (**ref_ptr == observation) {
             AVS_LIST_DELETE(ref_ptr);
             if (!observed_path->refs) {
-                AVS_SORTED_SET_DELETE_ELEM(conn->observed_paths,
-                                           &observed_path);
+                delete_observe_path_entry(conn, &observed_path);
             }
             return;
         }
@@ -197,10 +316,82 @@ static void remove_from_observed_paths(
     }
 }
 
+static bool
+observation_trigger_scheduled(const anjay_observation_t *observation) {
+    return observation->notify_task
+           || avs_time_monotonic_valid(observation->trigger_deadline);
+}
+
+static avs_time_monotonic_t
+observation_trigger_time(const anjay_observation_t *observation) {
+    if (avs_time_monotonic_valid(observation->trigger_deadline)) {
+        return observation->trigger_deadline;
+    }
+    return avs_sched_time(&observation->notify_task);
+}
+
+static void
+release_path_set_sample(const anjay_observe_path_set_t *set,
+                        AVS_LIST(anjay_observe_path_set_sample_t) *sample_ptr) {
+    for (size_t i = 0; i < set->paths_count; ++i) {
+        _anjay_batch_release(&(*sample_ptr)->values[i]);
+    }
+    AVS_LIST_DELETE(sample_ptr);
+}
+
+static void clear_path_set_samples(anjay_observe_path_set_t *set) {
+    while (set->samples) {
+        release_path_set_sample(set, &set->samples);
+    }
+}
+
+static void clear_all_samples(anjay_observe_state_t *observe) {
+    AVS_LIST_CLEAR(&observe->samples) {
+        _anjay_batch_release(&observe->samples->batch);
+    }
+    AVS_LIST(anjay_observe_path_set_t) set;
+    AVS_LIST_FOREACH(set, observe->path_sets) {
+        clear_path_set_samples(set);
+    }
+}
+
+static void release_path_set(anjay_observe_state_t *observe,
+                             anjay_observe_path_set_t *set) {
+    assert(set->refcount);
+    if (--set->refcount) {
+        return;
+    }
+    clear_path_set_samples(set);
+    AVS_LIST(anjay_observe_path_set_t) *set_ptr =
+            (AVS_LIST(anjay_observe_path_set_t) *) AVS_LIST_FIND_PTR(
+                    &observe->path_sets, set);
+    assert(set_ptr);
+    AVS_LIST_DELETE(set_ptr);
+}
+
+/**
+ * Releases the reference to the shared path set, if any. Shall be called
+ * right before freeing @p observation; its paths are not accessible anymore
+ * afterwards.
+ */
+static void release_observation_paths(anjay_observe_state_t *observe,
+                                      anjay_observation_t *observation) {
+    if (observation->path_set) {
+        release_path_set(observe, observation->path_set);
+        observation->path_set = NULL;
+    }
+}
+
+static void cancel_observation_trigger(anjay_observation_t *observation) {
+    avs_sched_del(&observation->notify_task);
+    // if triggers are coalesced, trigger_task will just skip this observation
+    observation->trigger_deadline = AVS_TIME_MONOTONIC_INVALID;
+}
+
 static void clear_observation(anjay_observe_connection_entry_t *connection,
                               anjay_observation_t *observation) {
     anjay_unlocked_t *anjay = _anjay_from_server(connection->conn_ref.server);
-    avs_sched_del(&observation->notify_task);
+    cancel_observation_trigger(observation);
     while (observation->last_sent) {
         delete_value(anjay, &observation->last_sent);
     }
@@ -215,6 +406,7 @@ static void clear_observation(anjay_observe_connection_entry_t *connection,
                 server_last_unsent = *unsent_ptr;
             } else {
                 delete_value(anjay, unsent_ptr);
+                --connection->observe->unsent_count;
             }
         }
         connection->unsent_last = server_last_unsent;
@@ -235,12 +427,13 @@ cleanup_observation(anjay_observe_connection_entry_t *conn,
     if (conn->observed_paths) {
         remove_from_observed_paths(conn, observation);
     }
-    avs_sched_del(&observation->notify_task);
+    cancel_observation_trigger(observation);
     if (observation->last_sent) {
         delete_value(_anjay_from_server(conn->conn_ref.server),
                      &observation->last_sent);
     }
     assert(!observation->last_sent);
+    release_observation_paths(conn->observe, observation);
 }
 
 static void cleanup_connection_without_observations_set(
@@ -249,6 +442,7 @@ static void cleanup_connection_without_observations_set(
         anjay_unlocked_t *anjay = _anjay_from_server(conn->conn_ref.server);
         while (conn->unsent) {
             delete_value(anjay, &conn->unsent);
+            --conn->observe->unsent_count;
         }
     }
     assert(!conn->unsent);
@@ -263,6 +457,7 @@ static void cleanup_connection_without_observations_set(
     if (conn->flush_task) {
         avs_sched_del(&conn->flush_task);
     }
+    avs_sched_del(&conn->trigger_task);
 }
 
 void _anjay_observe_cleanup_connection(anjay_observe_connection_entry_t *conn) {
@@ -281,6 +476,70 @@ cancel_ongoing_notify_exchange(anjay_observe_connection_entry_t *conn) {
     assert(!conn->serialization_state.out_ctx);
 }
 
+static void update_earliest_trigger(anjay_observe_connection_entry_t **earliest,
+                                    anjay_observe_connection_entry_t *conn,
+                                    size_t trigger_field_offset) {
+    avs_time_real_t trigger = *AVS_APPLY_OFFSET(avs_time_real_t, conn,
+                                                trigger_field_offset);
+    if (avs_time_real_valid(trigger)
+            && (!*earliest
+                || avs_time_real_before(
+                           trigger,
+                           *AVS_APPLY_OFFSET(avs_time_real_t, *earliest,
+                                             trigger_field_offset)))) {
+        *earliest = conn;
+    }
+}
+
+static void recalculate_earliest_triggers(anjay_observe_state_t *observe) {
+    observe->earliest_trigger_conn = NULL;
+    observe->earliest_pmax_trigger_conn = NULL;
+    AVS_LIST(anjay_observe_connection_entry_t) conn;
+    AVS_LIST_FOREACH(conn, observe->connection_entries) {
+        update_earliest_trigger(
+                &observe->earliest_trigger_conn, conn,
+                offsetof(anjay_observe_connection_entry_t, next_trigger));
+        update_earliest_trigger(
+                &observe->earliest_pmax_trigger_conn, conn,
+                offsetof(anjay_observe_connection_entry_t, next_pmax_trigger));
+    }
+}
+
+/**
+ * Updates the earliest_*_trigger_conn fields of the observe state after the
+ * trigger times of @p conn have changed. This is constant-time, unless @p conn
+ * used to hold the earliest trigger - its trigger times might have been
+ * postponed then, so all connections need to be checked.
+ */
+static void
+conn_trigger_times_changed(anjay_observe_connection_entry_t *conn) {
+    anjay_observe_state_t *observe = conn->observe;
+    if (observe->earliest_trigger_conn == conn
+            || observe->earliest_pmax_trigger_conn == conn) {
+        recalculate_earliest_triggers(observe);
+    } else {
+        update_earliest_trigger(
+                &observe->earliest_trigger_conn, conn,
+                offsetof(anjay_observe_connection_entry_t, next_trigger));
+        update_earliest_trigger(
+                &observe->earliest_pmax_trigger_conn, conn,
+                offsetof(anjay_observe_connection_entry_t, next_pmax_trigger));
+    }
+}
+
+/**
+ * Shall be called after @p conn has been removed from the connection_entries
+ * list, to make sure that it is not referenced as the one holding the earliest
+ * trigger.
+ */
+static void conn_removed(anjay_observe_state_t *observe,
+                         const anjay_observe_connection_entry_t *conn) {
+    if (observe->earliest_trigger_conn == conn
+            || observe->earliest_pmax_trigger_conn == conn) {
+        recalculate_earliest_triggers(observe);
+    }
+}
+
 void _anjay_observe_invalidate(anjay_connection_ref_t ref) {
     AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr =
             _anjay_observe_find_connection_state(ref);
@@ -296,6 +555,7 @@ void _anjay_observe_invalidate(anjay_connection_ref_t ref) {
     // Detach the connection entry so that it won't be found by
     // _anjay_observe_find_connection_state() in _anjay_observe_cancel_handler()
     AVS_LIST(anjay_observe_connection_entry_t) conn = AVS_LIST_DETACH(conn_ptr);
+    conn_removed(conn->observe, conn);
     avs_coap_ctx_t *coap = _anjay_connection_get_coap(ref);
 
     // Now cancel the observations. We're doing it after having cleaned up all
@@ -314,16 +574,43 @@ void _anjay_observe_invalidate(anjay_connection_ref_t ref) {
     AVS_LIST_DELETE(&conn);
 }
 
+#    ifdef ANJAY_WITH_OBSERVE_PERSISTENCE
+static void restored_entry_cleanup(anjay_observe_restored_t *entry) {
+    avs_free(entry->paths);
+    avs_free(entry->coap_state);
+}
+#    endif // ANJAY_WITH_OBSERVE_PERSISTENCE
+
 void _anjay_observe_cleanup(anjay_observe_state_t *observe) {
     AVS_LIST_CLEAR(&observe->connection_entries) {
         _anjay_observe_cleanup_connection(observe->connection_entries);
     }
+    observe->earliest_trigger_conn = NULL;
+    observe->earliest_pmax_trigger_conn = NULL;
+#    ifdef ANJAY_WITH_OBSERVE_PERSISTENCE
+    AVS_LIST_CLEAR(&observe->restored) {
+        restored_entry_cleanup(observe->restored);
+    }
+#    endif // ANJAY_WITH_OBSERVE_PERSISTENCE
+    if (observe->observed_paths_index) {
+        assert(!AVS_SORTED_SET_FIRST(observe->observed_paths_index));
+        AVS_SORTED_SET_DELETE(&observe->observed_paths_index);
+    }
+    avs_sched_del(&observe->samples_cleanup_handle);
+    clear_all_samples(observe);
+    AVS_LIST_CLEAR(&observe->notify_driven_oids);
+    AVS_LIST_CLEAR(&observe->priorities);
+    // all path sets are released along with the observations
+    assert(!observe->path_sets);
 }
 
 static void
 delete_connection(AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr) {
-    _anjay_observe_cleanup_connection(*conn_ptr);
+    anjay_observe_connection_entry_t *conn = *conn_ptr;
+    anjay_observe_state_t *observe = conn->observe;
+    _anjay_observe_cleanup_connection(conn);
     AVS_LIST_DELETE(conn_ptr);
+    conn_removed(observe, conn);
 }
 
 static void delete_connection_if_empty(
@@ -343,6 +630,46 @@ typedef struct {
 
 static void trigger_observe(avs_sched_t *sched, const void *args_);
 
+static void trigger_due_observations_job(avs_sched_t *sched,
+                                         const void *conn_ptr);
+
+static int
+schedule_conn_trigger_task(anjay_observe_connection_entry_t *conn_state,
+                           avs_time_monotonic_t deadline) {
+    avs_time_monotonic_t fire_time =
+            avs_time_monotonic_add(deadline, conn_state->observe->trigger_slack);
+    if (conn_state->trigger_task
+            && !avs_time_monotonic_before(
+                       fire_time, avs_sched_time(&conn_state->trigger_task))) {
+        // the job will handle this deadline, too
+        return 0;
+    }
+    avs_sched_del(&conn_state->trigger_task);
+    return AVS_SCHED_AT(_anjay_from_server(conn_state->conn_ref.server)->sched,
+                        &conn_state->trigger_task, fire_time,
+                        trigger_due_observations_job, &conn_state,
+                        sizeof(conn_state));
+}
+
+static int
+reschedule_conn_trigger_task(anjay_observe_connection_entry_t *conn_state) {
+    avs_time_monotonic_t earliest = AVS_TIME_MONOTONIC_INVALID;
+    AVS_SORTED_SET_ELEM(anjay_observation_t) observation;
+    AVS_SORTED_SET_FOREACH(observation, conn_state->observations) {
+        if (avs_time_monotonic_valid(observation->trigger_deadline)
+                && (!avs_time_monotonic_valid(earliest)
+                    || avs_time_monotonic_before(observation->trigger_deadline,
+                                                 earliest))) {
+            earliest = observation->trigger_deadline;
+        }
+    }
+    if (!avs_time_monotonic_valid(earliest)) {
+        avs_sched_del(&conn_state->trigger_task);
+        return 0;
+    }
+    return schedule_conn_trigger_task(conn_state, earliest);
+}
+
 static const anjay_observation_value_t *
 newest_value(const anjay_observation_t *observation) {
     if (observation->last_unsent) {
@@ -358,6 +685,35 @@ typedef enum {
     SCHEDULE_PERIOD_MAX
 } schedule_period_type_t;
 
+/**
+ * Moves the notification trigger required by the Maximum Period attribute
+ * earlier, to the time of the next Registration Update, if that is planned
+ * within the wake window before it. The Update wakes up the device anyway, so
+ * that the notification does not need a separate wake-up.
+ */
+static avs_time_real_t
+align_pmax_trigger_with_update(anjay_observe_connection_entry_t *conn_state,
+                               avs_time_real_t trigger_instant_real,
+                               avs_time_real_t real_now) {
+    anjay_server_info_t *server = conn_state->conn_ref.server;
+    avs_time_duration_t window = _anjay_server_wake_window(server);
+    if (conn_state->conn_ref.conn_type != ANJAY_CONNECTION_PRIMARY
+            || !avs_time_duration_less(AVS_TIME_DURATION_ZERO, window)) {
+        return trigger_instant_real;
+    }
+    avs_time_real_t update_time = _anjay_server_next_update_time(server);
+    if (avs_time_real_valid(update_time)
+            && avs_time_real_before(update_time, trigger_instant_real)
+            && !avs_time_real_before(
+                       update_time,
+                       avs_time_real_add(trigger_instant_real,
+                                         avs_time_duration_mul(window, -1)))) {
+        return avs_time_real_before(update_time, real_now) ? real_now
+                                                           : update_time;
+    }
+    return trigger_instant_real;
+}
+
 static int schedule_trigger(anjay_observe_connection_entry_t *conn_state,
                             anjay_observation_t *observation,
                             int32_t period,
@@ -374,6 +730,12 @@ static int schedule_trigger(anjay_observe_connection_entry_t *conn_state,
             avs_time_duration_from_scalar(period, AVS_TIME_S));
     if (avs_time_real_before(trigger_instant_real, real_now)) {
         trigger_instant_real = real_now;
+    } else if (period_type == SCHEDULE_PERIOD_MIN
+               && avs_time_real_before(real_now, trigger_instant_real)) {
+        ADD_TO_COUNTER(conn_state, observation, pmin_postponed, 1);
+    } else if (period_type == SCHEDULE_PERIOD_MAX) {
+        trigger_instant_real = align_pmax_trigger_with_update(
+                conn_state, trigger_instant_real, real_now);
     }
 
     if (!avs_time_real_before(conn_state->next_trigger, trigger_instant_real)) {
@@ -388,10 +750,11 @@ static int schedule_trigger(anjay_observe_connection_entry_t *conn_state,
             conn_state->next_pmax_trigger = trigger_instant_real;
         }
     }
+    conn_trigger_times_changed(conn_state);
 
     avs_time_monotonic_t trigger_instant_monotonic = avs_time_monotonic_add(
             monotonic_now, avs_time_real_diff(trigger_instant_real, real_now));
-    if (avs_time_monotonic_before(avs_sched_time(&observation->notify_task),
+    if (avs_time_monotonic_before(observation_trigger_time(observation),
                                   trigger_instant_monotonic)) {
         anjay_log(
                 LAZY_TRACE,
@@ -410,16 +773,30 @@ static int schedule_trigger(anjay_observe_connection_entry_t *conn_state,
             ANJAY_TOKEN_TO_STRING(observation->token),
             (long) trigger_instant_monotonic.since_monotonic_epoch.seconds,
             (long) trigger_instant_monotonic.since_monotonic_epoch.nanoseconds);
-
-    int retval =
-            AVS_SCHED_AT(_anjay_from_server(conn_state->conn_ref.server)->sched,
-                         &observation->notify_task, trigger_instant_monotonic,
-                         trigger_observe,
-                         (&(const trigger_observe_args_t) {
-                             .conn_state = conn_state,
-                             .observation = observation
-                         }),
-                         sizeof(trigger_observe_args_t));
+    ANJAY_TRACEPOINT(
+            notify_scheduled, _anjay_server_ssid(conn_state->conn_ref.server),
+            observation,
+            trigger_instant_monotonic.since_monotonic_epoch.seconds,
+            trigger_instant_monotonic.since_monotonic_epoch.nanoseconds);
+
+    int retval;
+    if (conn_state->observe->coalesce_triggers) {
+        observation->trigger_deadline = trigger_instant_monotonic;
+        if ((retval = schedule_conn_trigger_task(conn_state,
+                                                 trigger_instant_monotonic))) {
+            observation->trigger_deadline = AVS_TIME_MONOTONIC_INVALID;
+        }
+    } else {
+        retval = AVS_SCHED_AT(
+                _anjay_from_server(conn_state->conn_ref.server)->sched,
+                &observation->notify_task, trigger_instant_monotonic,
+                trigger_observe,
+                (&(const trigger_observe_args_t) {
+                    .conn_state = conn_state,
+                    .observation = observation
+                }),
+                sizeof(trigger_observe_args_t));
+    }
     if (retval) {
         anjay_log(ERROR,
                   _("Could not schedule automatic notification trigger, "
@@ -439,8 +816,10 @@ create_observation_value(const anjay_msg_details_t *details,
             _anjay_observe_is_error_details(details) ? 0 : ref->paths_count;
     const size_t element_size = offsetof(anjay_observation_value_t, values)
                                 + values_count * sizeof(anjay_batch_t *);
+    ANJAY_ALLOCATION_SITE_ENTER(prev_site);
     AVS_LIST(anjay_observation_value_t) result = (AVS_LIST(
             anjay_observation_value_t)) AVS_LIST_NEW_BUFFER(element_size);
+    ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
     if (!result) {
         _anjay_log_oom();
         return NULL;
@@ -449,6 +828,8 @@ create_observation_value(const anjay_msg_details_t *details,
     result->reliability_hint = reliability_hint;
     memcpy((void *) (intptr_t) (const void *) &result->ref, &ref, sizeof(ref));
     result->timestamp = *timestamp;
+    result->memory_size = sizeof(AVS_LIST(anjay_observation_value_t))
+                          + element_size;
     for (size_t i = 0; i < values_count; ++i) {
         assert(values);
         assert(values[i]);
@@ -456,19 +837,32 @@ create_observation_value(const anjay_msg_details_t *details,
             AVS_LIST_CLEAR(&result);
             break;
         }
+        result->memory_size += _anjay_batch_memory_size(values[i]);
     }
     return result;
 }
 
-static size_t count_queued_notifications(const anjay_observe_state_t *observe) {
+void _anjay_observe_queue_usage(const anjay_observe_state_t *observe,
+                                size_t *out_count,
+                                size_t *out_bytes) {
     size_t count = 0;
+    size_t bytes = 0;
 
     AVS_LIST(anjay_observe_connection_entry_t) conn;
     AVS_LIST_FOREACH(conn, observe->connection_entries) {
-        count += AVS_LIST_SIZE(conn->unsent);
+        AVS_LIST(anjay_observation_value_t) value;
+        AVS_LIST_FOREACH(value, conn->unsent) {
+            ++count;
+            bytes += value->memory_size;
+        }
     }
 
-    return count;
+    if (out_count) {
+        *out_count = count;
+    }
+    if (out_bytes) {
+        *out_bytes = bytes;
+    }
 }
 
 static bool is_observe_queue_full(const anjay_observe_state_t *observe) {
@@ -476,7 +870,7 @@ static bool is_observe_queue_full(const anjay_observe_state_t *observe) {
         return false;
     }
 
-    size_t num_queued = count_queued_notifications(observe);
+    size_t num_queued = observe->unsent_count;
     anjay_log(TRACE, "%u/%u" _(" queued notifications"), (unsigned) num_queued,
               (unsigned) observe->notify_queue_limit);
 
@@ -510,6 +904,7 @@ detach_first_unsent_value(anjay_observe_connection_entry_t *conn_state) {
         observation->last_unsent = NULL;
     }
     anjay_observation_value_t *result = AVS_LIST_DETACH(&conn_state->unsent);
+    --conn_state->observe->unsent_count;
     if (conn_state->unsent_last == result) {
         assert(!conn_state->unsent);
         conn_state->unsent_last = NULL;
@@ -517,8 +912,148 @@ detach_first_unsent_value(anjay_observe_connection_entry_t *conn_state) {
     return result;
 }
 
+/**
+ * Checks whether @p value, being an element of the unsent queue of
+ * @p conn_state, can be dropped, i.e. it is not an error value (which needs to
+ * be delivered to cancel the observation) and it is not being sent.
+ */
+static bool
+unsent_value_droppable(const anjay_observe_connection_entry_t *conn_state,
+                       const anjay_observation_value_t *value) {
+    return !is_error_value(value)
+           && (value != conn_state->unsent
+               || !avs_coap_exchange_id_valid(conn_state->notify_exchange_id));
+}
+
+/**
+ * Deletes an arbitrary element of the unsent queue of @p conn_state, pointed
+ * to by @p value_ptr, updating the references to it.
+ */
+static void
+delete_unsent_value(anjay_observe_connection_entry_t *conn_state,
+                    AVS_LIST(anjay_observation_value_t) *value_ptr) {
+    anjay_observation_value_t *value = *value_ptr;
+    anjay_observation_t *observation = value->ref;
+    anjay_observation_value_t *prev = NULL;
+    anjay_observation_value_t *prev_of_observation = NULL;
+    AVS_LIST(anjay_observation_value_t) it;
+    AVS_LIST_FOREACH(it, conn_state->unsent) {
+        if (it == value) {
+            break;
+        }
+        if (it->ref == observation) {
+            prev_of_observation = it;
+        }
+        prev = it;
+    }
+    assert(it == value);
+    if (conn_state->unsent_last == value) {
+        conn_state->unsent_last = prev;
+    }
+    if (observation->last_unsent == value) {
+        observation->last_unsent = prev_of_observation;
+    }
+    delete_value(_anjay_from_server(conn_state->conn_ref.server), value_ptr);
+    --conn_state->observe->unsent_count;
+}
+
+/**
+ * Removes the newest unsent value of @p observation from the queue, if it can
+ * be dropped.
+ */
+static void
+drop_superseded_unsent_value(anjay_observe_connection_entry_t *conn_state,
+                             anjay_observation_t *observation) {
+    anjay_observation_value_t *superseded = observation->last_unsent;
+    if (!superseded || !unsent_value_droppable(conn_state, superseded)) {
+        return;
+    }
+    AVS_LIST(anjay_observation_value_t) *value_ptr =
+            (AVS_LIST(anjay_observation_value_t) *) AVS_LIST_FIND_PTR(
+                    &conn_state->unsent, superseded);
+    assert(value_ptr);
+    delete_unsent_value(conn_state, value_ptr);
+}
+
+static bool is_confirmable_value(const anjay_observation_value_t *value) {
+    return value->reliability_hint == AVS_COAP_NOTIFY_PREFER_CONFIRMABLE;
+}
+
+/**
+ * Checks whether @p value shall be evicted from the queue before @p victim.
+ * If any notification priorities are set, values of observations with lower
+ * priority go first. Then, values not meant to be sent as Confirmable go
+ * first if @p prefer_non_confirmable is set. Then, if priorities are set,
+ * values superseded by a newer queued value of the same observation go first.
+ * Finally, older values go before newer ones.
+ */
+static bool evict_before(const anjay_observe_state_t *observe,
+                         const anjay_observation_value_t *value,
+                         const anjay_observation_value_t *victim,
+                         bool prefer_non_confirmable) {
+    if (observe->priorities && value->ref->priority != victim->ref->priority) {
+        return value->ref->priority < victim->ref->priority;
+    }
+    if (prefer_non_confirmable
+            && is_confirmable_value(value) != is_confirmable_value(victim)) {
+        return !is_confirmable_value(value);
+    }
+    if (observe->priorities) {
+        bool value_superseded = (value != value->ref->last_unsent);
+        bool victim_superseded = (victim != victim->ref->last_unsent);
+        if (value_superseded != victim_superseded) {
+            return value_superseded;
+        }
+    }
+    return avs_time_real_before(value->timestamp, victim->timestamp);
+}
+
+/**
+ * Finds the droppable queued value that shall be evicted first, according to
+ * evict_before(). Returns NULL if there is none.
+ */
+static AVS_LIST(anjay_observation_value_t) *
+find_eviction_victim(anjay_observe_state_t *observe,
+                     bool prefer_non_confirmable,
+                     anjay_observe_connection_entry_t **out_conn) {
+    AVS_LIST(anjay_observation_value_t) *victim_ptr = NULL;
+    AVS_LIST(anjay_observe_connection_entry_t) conn;
+    AVS_LIST_FOREACH(conn, observe->connection_entries) {
+        AVS_LIST(anjay_observation_value_t) *value_ptr;
+        AVS_LIST_FOREACH_PTR(value_ptr, &conn->unsent) {
+            if (!unsent_value_droppable(conn, *value_ptr)) {
+                continue;
+            }
+            if (!victim_ptr
+                    || evict_before(observe, *value_ptr, *victim_ptr,
+                                    prefer_non_confirmable)) {
+                victim_ptr = value_ptr;
+                *out_conn = conn;
+            }
+            if (!observe->priorities
+                    && (!prefer_non_confirmable
+                        || !is_confirmable_value(*value_ptr))) {
+                // values within a connection are ordered by age
+                break;
+            }
+        }
+    }
+    return victim_ptr;
+}
+
 static void drop_oldest_queued_notification(anjay_unlocked_t *anjay,
                                             anjay_observe_state_t *observe) {
+    if (observe->priorities) {
+        anjay_observe_connection_entry_t *victim_conn = NULL;
+        AVS_LIST(anjay_observation_value_t) *victim_ptr =
+                find_eviction_victim(observe, false, &victim_conn);
+        if (victim_ptr) {
+            ADD_TO_COUNTER(victim_conn, (*victim_ptr)->ref, queue_dropped, 1);
+            delete_unsent_value(victim_conn, victim_ptr);
+            return;
+        }
+    }
+
     AVS_LIST(anjay_observe_connection_entry_t) oldest =
             find_oldest_queued_notification(observe);
 
@@ -526,9 +1061,35 @@ static void drop_oldest_queued_notification(anjay_unlocked_t *anjay,
                        "no queued notifications");
 
     anjay_observation_value_t *entry = detach_first_unsent_value(oldest);
+    ADD_TO_COUNTER(oldest, entry->ref, queue_dropped, 1);
     delete_value(anjay, &entry);
 }
 
+/**
+ * Drops queued values until @p new_value_size more bytes fit within
+ * notify_queue_memory_limit, or there are no more droppable values. The oldest
+ * values not meant to be sent as Confirmable are dropped first, unless
+ * notification priorities are set (see evict_before()).
+ */
+static void enforce_queue_memory_limit(anjay_observe_state_t *observe,
+                                       size_t new_value_size) {
+    size_t usage;
+    _anjay_observe_queue_usage(observe, NULL, &usage);
+    while (usage + new_value_size > observe->notify_queue_memory_limit) {
+        anjay_observe_connection_entry_t *victim_conn = NULL;
+        AVS_LIST(anjay_observation_value_t) *victim_ptr =
+                find_eviction_victim(observe, true, &victim_conn);
+        if (!victim_ptr) {
+            break;
+        }
+        usage -= (*victim_ptr)->memory_size;
+        anjay_log(DEBUG, _("dropping queued notification to fit within the "
+                           "memory limit"));
+        ADD_TO_COUNTER(victim_conn, (*victim_ptr)->ref, queue_dropped, 1);
+        delete_unsent_value(victim_conn, victim_ptr);
+    }
+}
+
 static int insert_new_value(anjay_observe_connection_entry_t *conn_state,
                             anjay_observation_t *observation,
                             avs_coap_notify_reliability_hint_t reliability_hint,
@@ -537,11 +1098,26 @@ static int insert_new_value(anjay_observe_connection_entry_t *conn_state,
                             const anjay_batch_t *const *values) {
     anjay_unlocked_t *anjay = _anjay_from_server(conn_state->conn_ref.server);
     anjay_observe_state_t *observe = &anjay->observe;
+    // NOTE: details and values may refer to the current newest value, so the
+    // new one needs to be created before any old ones are deleted
+    AVS_LIST(anjay_observation_value_t) res_value =
+            create_observation_value(details, reliability_hint, observation,
+                                     timestamp, values);
+    if (!res_value) {
+        return -1;
+    }
+
+    if (observe->merge_unsent && !is_error_value(res_value)) {
+        drop_superseded_unsent_value(conn_state, observation);
+    }
+
     if (is_observe_queue_full(observe)) {
         switch (observe->notify_queue_limit_mode) {
         case NOTIFY_QUEUE_UNLIMITED:
+            // the queue never fills up in this mode, so even if it did
+            // somehow, appending the value is the right thing to do
             AVS_UNREACHABLE("is_observe_queue_full broken");
-            return -1;
+            break;
 
         case NOTIFY_QUEUE_DROP_OLDEST:
             assert(observe->notify_queue_limit != 0);
@@ -549,12 +1125,8 @@ static int insert_new_value(anjay_observe_connection_entry_t *conn_state,
             break;
         }
     }
-
-    AVS_LIST(anjay_observation_value_t) res_value =
-            create_observation_value(details, reliability_hint, observation,
-                                     timestamp, values);
-    if (!res_value) {
-        return -1;
+    if (observe->notify_queue_memory_limit) {
+        enforce_queue_memory_limit(observe, res_value->memory_size);
     }
 
     AVS_LIST_APPEND(&conn_state->unsent_last, res_value);
@@ -562,6 +1134,7 @@ static int insert_new_value(anjay_observe_connection_entry_t *conn_state,
     if (!conn_state->unsent) {
         conn_state->unsent = res_value;
     }
+    ++observe->unsent_count;
     observation->last_unsent = res_value;
     return 0;
 }
@@ -569,7 +1142,7 @@ static int insert_new_value(anjay_observe_connection_entry_t *conn_state,
 static int insert_error(anjay_observe_connection_entry_t *conn_state,
                         anjay_observation_t *observation,
                         int outer_result) {
-    avs_sched_del(&observation->notify_task);
+    cancel_observation_trigger(observation);
     const anjay_msg_details_t details = {
         .msg_code = _anjay_make_error_response_code(outer_result),
         .format = AVS_COAP_FORMAT_NONE
@@ -625,6 +1198,185 @@ static int get_effective_attrs(anjay_unlocked_t *anjay,
     return _anjay_dm_effective_attrs(anjay, &details, out_attrs);
 }
 
+static size_t attrs_cache_offset(size_t inline_paths_count) {
+    const size_t alignment = AVS_ALIGNOF(anjay_observe_attrs_cache_entry_t);
+    size_t offset = offsetof(anjay_observation_t, inline_paths)
+                    + inline_paths_count * sizeof(const anjay_uri_path_t);
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * Returns the memoized attributes of @p observation . MUST only be called if
+ * anjay_observe_state_t::cache_attrs is enabled.
+ */
+static anjay_observe_attrs_cache_entry_t *
+observation_attrs_cache(anjay_observation_t *observation) {
+    const size_t inline_paths_count =
+            observation->path_set ? 0 : observation->paths_count;
+    return (anjay_observe_attrs_cache_entry_t *) ((char *) observation
+                                                  + attrs_cache_offset(
+                                                          inline_paths_count));
+}
+
+static int get_observation_attrs(anjay_unlocked_t *anjay,
+                                 anjay_dm_r_attributes_t *out_attrs,
+                                 anjay_observation_t *observation,
+                                 size_t path_index,
+                                 anjay_ssid_t ssid) {
+    assert(path_index < observation->paths_count);
+    if (!anjay->observe.cache_attrs) {
+        return get_effective_attrs(anjay, out_attrs,
+                                   &observation->paths[path_index], ssid);
+    }
+    anjay_observe_attrs_cache_entry_t *entry =
+            &observation_attrs_cache(observation)[path_index];
+    if (!entry->valid) {
+        int result = get_effective_attrs(anjay, &entry->attrs,
+                                         &observation->paths[path_index], ssid);
+        if (result) {
+            return result;
+        }
+        entry->valid = true;
+    }
+    *out_attrs = entry->attrs;
+    return 0;
+}
+
+static bool attrs_affected_by_oid(const anjay_uri_path_t *path,
+                                  anjay_oid_t oid) {
+    // Server Object holds the server-level default pmin and pmax values, which
+    // may affect all the paths
+    return oid == ANJAY_ID_INVALID || oid == ANJAY_DM_OID_SERVER
+           || !_anjay_uri_path_has(path, ANJAY_ID_OID)
+           || path->ids[ANJAY_ID_OID] == oid;
+}
+
+void _anjay_observe_invalidate_attrs(anjay_unlocked_t *anjay,
+                                     anjay_oid_t oid) {
+    if (!anjay->observe.cache_attrs) {
+        return;
+    }
+    AVS_LIST(anjay_observe_connection_entry_t) conn;
+    AVS_LIST_FOREACH(conn, anjay->observe.connection_entries) {
+        AVS_SORTED_SET_ELEM(anjay_observation_t) observation;
+        AVS_SORTED_SET_FOREACH(observation, conn->observations) {
+            anjay_observe_attrs_cache_entry_t *attrs_cache =
+                    observation_attrs_cache(observation);
+            for (size_t i = 0; i < observation->paths_count; ++i) {
+                if (attrs_affected_by_oid(&observation->paths[i], oid)) {
+                    attrs_cache[i].valid = false;
+                }
+            }
+        }
+    }
+}
+
+static bool is_notify_driven(anjay_observe_state_t *observe,
+                             const anjay_observation_t *observation) {
+    if (!observe->notify_driven_oids || !observation->paths_count) {
+        return false;
+    }
+    for (size_t i = 0; i < observation->paths_count; ++i) {
+        AVS_LIST(anjay_oid_t) oid;
+        AVS_LIST_FOREACH(oid, observe->notify_driven_oids) {
+            if (_anjay_uri_path_has(&observation->paths[i], ANJAY_ID_OID)
+                    && observation->paths[i].ids[ANJAY_ID_OID] == *oid) {
+                break;
+            }
+        }
+        if (!oid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int _anjay_observe_set_notify_driven(anjay_unlocked_t *anjay,
+                                     anjay_oid_t oid,
+                                     bool enabled) {
+    AVS_LIST(anjay_oid_t) *oid_ptr;
+    AVS_LIST_FOREACH_PTR(oid_ptr, &anjay->observe.notify_driven_oids) {
+        if (**oid_ptr == oid) {
+            break;
+        }
+    }
+    if (!enabled) {
+        if (*oid_ptr) {
+            AVS_LIST_DELETE(oid_ptr);
+            AVS_LIST(anjay_observe_connection_entry_t) conn;
+            AVS_LIST_FOREACH(conn, anjay->observe.connection_entries) {
+                AVS_SORTED_SET_ELEM(anjay_observation_t) observation;
+                AVS_SORTED_SET_FOREACH(observation, conn->observations) {
+                    observation->values_fresh = false;
+                }
+            }
+        }
+        return 0;
+    }
+    if (!*oid_ptr) {
+        if (!AVS_LIST_INSERT_NEW(anjay_oid_t, oid_ptr)) {
+            _anjay_log_oom();
+            return -1;
+        }
+        **oid_ptr = oid;
+    }
+    return 0;
+}
+
+static uint8_t observation_priority(const anjay_observe_state_t *observe,
+                                    const anjay_observation_t *observation) {
+    uint8_t result = 0;
+    AVS_LIST(anjay_observe_priority_entry_t) entry;
+    AVS_LIST_FOREACH(entry, observe->priorities) {
+        for (size_t i = 0; i < observation->paths_count; ++i) {
+            if (!_anjay_uri_path_outside_base(&observation->paths[i],
+                                              &entry->path)
+                    || !_anjay_uri_path_outside_base(&entry->path,
+                                                     &observation->paths[i])) {
+                result = AVS_MAX(result, entry->priority);
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+int _anjay_observe_set_priority(anjay_unlocked_t *anjay,
+                                const anjay_uri_path_t *path,
+                                uint8_t priority) {
+    anjay_observe_state_t *observe = &anjay->observe;
+    AVS_LIST(anjay_observe_priority_entry_t) *entry_ptr;
+    AVS_LIST_FOREACH_PTR(entry_ptr, &observe->priorities) {
+        if (_anjay_uri_path_equal(&(*entry_ptr)->path, path)) {
+            break;
+        }
+    }
+    if (!priority) {
+        if (*entry_ptr) {
+            AVS_LIST_DELETE(entry_ptr);
+        }
+    } else {
+        if (!*entry_ptr) {
+            if (!AVS_LIST_INSERT_NEW(anjay_observe_priority_entry_t,
+                                     entry_ptr)) {
+                _anjay_log_oom();
+                return -1;
+            }
+            (*entry_ptr)->path = *path;
+        }
+        (*entry_ptr)->priority = priority;
+    }
+
+    AVS_LIST(anjay_observe_connection_entry_t) conn;
+    AVS_LIST_FOREACH(conn, observe->connection_entries) {
+        AVS_SORTED_SET_ELEM(anjay_observation_t) observation;
+        AVS_SORTED_SET_FOREACH(observation, conn->observations) {
+            observation->priority = observation_priority(observe, observation);
+        }
+    }
+    return 0;
+}
+
 static inline bool is_pmax_valid(anjay_dm_oi_attributes_t attr) {
     if (attr.max_period < 0) {
         return false;
@@ -657,9 +1409,9 @@ int _anjay_observe_schedule_pmax_trigger(
 
     for (size_t i = 0; i < observation->paths_count; ++i) {
         anjay_dm_r_attributes_t attrs;
-        int result = get_effective_attrs(
+        int result = get_observation_attrs(
                 _anjay_from_server(conn_state->conn_ref.server), &attrs,
-                &observation->paths[i],
+                observation, i,
                 _anjay_server_ssid(conn_state->conn_ref.server));
         if (result) {
             anjay_log(DEBUG,
@@ -709,40 +1461,113 @@ typedef struct {
     size_t count;
 } paths_arg_t;
 
+static const anjay_uri_path_t *next_path_arg(const paths_arg_t *paths,
+                                             const anjay_uri_path_t *path) {
+    if (paths->type == PATHS_POINTER_LIST) {
+        return AVS_LIST_NEXT((AVS_LIST(anjay_uri_path_t)) (intptr_t) path);
+    }
+    return path + 1;
+}
+
+static void copy_paths(anjay_uri_path_t *out, const paths_arg_t *paths) {
+    const anjay_uri_path_t *path = paths->paths;
+    for (size_t i = 0; i < paths->count; ++i) {
+        out[i] = *path;
+        path = next_path_arg(paths, path);
+    }
+}
+
+#    if defined(ANJAY_WITH_LWM2M11) \
+            && !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+static bool path_set_matches(const anjay_observe_path_set_t *set,
+                             const paths_arg_t *paths) {
+    if (set->paths_count != paths->count) {
+        return false;
+    }
+    const anjay_uri_path_t *path = paths->paths;
+    for (size_t i = 0; i < set->paths_count; ++i) {
+        if (!_anjay_uri_path_equal(&set->paths[i], path)) {
+            return false;
+        }
+        path = next_path_arg(paths, path);
+    }
+    return true;
+}
+
+static anjay_observe_path_set_t *
+acquire_path_set(anjay_observe_state_t *observe, const paths_arg_t *paths) {
+    AVS_LIST(anjay_observe_path_set_t) set;
+    AVS_LIST_FOREACH(set, observe->path_sets) {
+        if (path_set_matches(set, paths)) {
+            ++set->refcount;
+            return set;
+        }
+    }
+    if (!(set = (AVS_LIST(anjay_observe_path_set_t)) AVS_LIST_NEW_BUFFER(
+                  offsetof(anjay_observe_path_set_t, paths)
+                  + paths->count * sizeof(anjay_uri_path_t)))) {
+        _anjay_log_oom();
+        return NULL;
+    }
+    set->refcount = 1;
+    set->paths_count = paths->count;
+    copy_paths(set->paths, paths);
+    AVS_LIST_INSERT(&observe->path_sets, set);
+    return set;
+}
+#    endif // defined(ANJAY_WITH_LWM2M11) &&
+           // !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+
 static AVS_SORTED_SET_ELEM(anjay_observation_t)
-create_detached_observation(const avs_coap_token_t *token,
-                            const anjay_request_t *request,
+create_detached_observation(anjay_observe_state_t *observe,
+                            const avs_coap_token_t *token,
+                            anjay_request_action_t action,
                             const paths_arg_t *paths) {
+    anjay_observe_path_set_t *path_set = NULL;
+#    if defined(ANJAY_WITH_LWM2M11) \
+            && !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+    if (action == ANJAY_ACTION_READ_COMPOSITE
+            && !(path_set = acquire_path_set(observe, paths))) {
+        return NULL;
+    }
+#    endif // defined(ANJAY_WITH_LWM2M11) &&
+           // !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+    const size_t inline_paths_count = path_set ? 0 : paths->count;
+    // the attribute cache is only allocated if it is going to be used
+    size_t size = offsetof(anjay_observation_t, inline_paths)
+                  + inline_paths_count * sizeof(anjay_uri_path_t);
+    if (observe->cache_attrs) {
+        size = attrs_cache_offset(inline_paths_count)
+               + paths->count * sizeof(anjay_observe_attrs_cache_entry_t);
+    }
     AVS_SORTED_SET_ELEM(anjay_observation_t) new_observation =
             (AVS_SORTED_SET_ELEM(anjay_observation_t))
-                    AVS_SORTED_SET_ELEM_NEW_BUFFER(
-                            offsetof(anjay_observation_t, paths)
-                            + paths->count * sizeof(const anjay_uri_path_t));
+                    AVS_SORTED_SET_ELEM_NEW_BUFFER(size);
     if (!new_observation) {
         _anjay_log_oom();
+        if (path_set) {
+            release_path_set(observe, path_set);
+        }
         return NULL;
     }
     memcpy((void *) (intptr_t) (const void *) &new_observation->token, token,
            sizeof(*token));
     memcpy((void *) (intptr_t) (const void *) &new_observation->action,
-           &request->action, sizeof(request->action));
+           &action, sizeof(action));
     memcpy((void *) (intptr_t) (const void *) &new_observation->paths_count,
            &paths->count, sizeof(paths->count));
-    if (paths->type == PATHS_POINTER_LIST) {
-        AVS_LIST(anjay_uri_path_t) it =
-                (AVS_LIST(anjay_uri_path_t)) (intptr_t) paths->paths;
-        for (size_t i = 0; i < paths->count; ++i) {
-            memcpy((void *) (intptr_t) (const void *) &new_observation
-                           ->paths[i],
-                   it, sizeof(*it));
-            AVS_LIST_ADVANCE(&it);
-        }
+    const anjay_uri_path_t *observation_paths = new_observation->inline_paths;
+    if (path_set) {
+        new_observation->path_set = path_set;
+        observation_paths = path_set->paths;
     } else {
-        assert(paths->count == 1);
-        memcpy((void *) (intptr_t) (const void *) &new_observation->paths[0],
-               paths->paths, sizeof(*paths->paths));
+        copy_paths((anjay_uri_path_t *) (intptr_t) observation_paths, paths);
     }
+    memcpy((void *) (intptr_t) (const void *) &new_observation->paths,
+           &observation_paths, sizeof(observation_paths));
+    new_observation->trigger_deadline = AVS_TIME_MONOTONIC_INVALID;
     new_observation->next_pmax_trigger = AVS_TIME_REAL_INVALID;
+    new_observation->priority = observation_priority(observe, new_observation);
     return new_observation;
 }
 
@@ -786,6 +1611,7 @@ find_or_create_connection_state(anjay_connection_ref_t ref) {
         }
         memcpy((void *) (intptr_t) (const void *) &(*conn_ptr)->conn_ref, &ref,
                sizeof(ref));
+        (*conn_ptr)->observe = &_anjay_from_server(ref.server)->observe;
         (*conn_ptr)->next_trigger = AVS_TIME_REAL_INVALID;
         (*conn_ptr)->next_pmax_trigger = AVS_TIME_REAL_INVALID;
     }
@@ -796,7 +1622,7 @@ static int schedule_all_triggers(anjay_observe_connection_entry_t *conn) {
     int result = 0;
     AVS_SORTED_SET_ELEM(anjay_observation_t) observation;
     AVS_SORTED_SET_FOREACH(observation, conn->observations) {
-        if (!observation->notify_task) {
+        if (!observation_trigger_scheduled(observation)) {
             _anjay_update_ret(&result, _anjay_observe_schedule_pmax_trigger(
                                                conn, observation));
         }
@@ -806,16 +1632,32 @@ static int schedule_all_triggers(anjay_observe_connection_entry_t *conn) {
 
 static void flush_next_unsent(anjay_observe_connection_entry_t *conn);
 
+static bool connection_exists(anjay_unlocked_t *anjay,
+                              anjay_observe_connection_entry_t *conn);
+
 static void flush_send_queue_job(avs_sched_t *sched, const void *conn_ptr) {
     anjay_t *anjay_locked = _anjay_get_from_sched(sched);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     anjay_observe_connection_entry_t *conn =
             *(anjay_observe_connection_entry_t *const *) conn_ptr;
-    if (conn && conn->unsent
-            && !avs_coap_exchange_id_valid(conn->notify_exchange_id)
-            && _anjay_connection_ready_for_outgoing_message(conn->conn_ref)
-            && _anjay_connection_get_online_socket(conn->conn_ref)) {
+    for (size_t i = 0; i < anjay->observe.flush_burst; ++i) {
+        if (!conn || !conn->unsent
+                || avs_coap_exchange_id_valid(conn->notify_exchange_id)
+                || !_anjay_connection_ready_for_outgoing_message(conn->conn_ref)
+                || !_anjay_connection_get_online_socket(conn->conn_ref)) {
+            break;
+        }
+        if (i > 0) {
+            // flush_task has been rescheduled by on_entry_flushed(); send the
+            // next notification right away instead
+            avs_sched_del(&conn->flush_task);
+        }
         flush_next_unsent(conn);
+        // NOTE: flush_next_unsent() may invalidate conn; flush_task is only
+        // rescheduled if the notification has been delivered successfully
+        if (!connection_exists(anjay, conn) || !conn->flush_task) {
+            break;
+        }
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
@@ -851,6 +1693,7 @@ delete_observation(AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr,
     AVS_LIST(anjay_observe_connection_entry_t) conn = *conn_ptr;
     clear_observation(conn, *observation_ptr);
     detach_observation(conn, *observation_ptr);
+    release_observation_paths(conn->observe, *observation_ptr);
     AVS_SORTED_SET_ELEM_DELETE_DETACHED(observation_ptr);
     delete_connection_if_empty(conn_ptr);
 
@@ -875,14 +1718,14 @@ recalculate_conn_trigger_times(anjay_observe_connection_entry_t *conn) {
         }
         avs_time_real_t next_trigger = avs_time_real_add(
                 real_now,
-                avs_time_monotonic_diff(avs_sched_time(
-                                                &observation->notify_task),
+                avs_time_monotonic_diff(observation_trigger_time(observation),
                                         monotonic_now));
         if (avs_time_real_valid(next_trigger)
                 && !avs_time_real_before(conn->next_trigger, next_trigger)) {
             conn->next_trigger = next_trigger;
         }
     }
+    conn_trigger_times_changed(conn);
 }
 
 static void observe_remove_entry(anjay_connection_ref_t connection,
@@ -942,8 +1785,9 @@ put_entry_into_connection_state(const anjay_request_t *request,
                                 anjay_observe_connection_entry_t *conn_state,
                                 const paths_arg_t *paths) {
     AVS_SORTED_SET_ELEM(anjay_observation_t) observation =
-            create_detached_observation(&request->observe->token, request,
-                                        paths);
+            create_detached_observation(conn_state->observe,
+                                        &request->observe->token,
+                                        request->action, paths);
     if (!observation) {
         return NULL;
     }
@@ -951,6 +1795,7 @@ put_entry_into_connection_state(const anjay_request_t *request,
 
     if (attach_new_observation(conn_state, observation)) {
         clear_observation(conn_state, observation);
+        release_observation_paths(conn_state->observe, observation);
         AVS_SORTED_SET_ELEM_DELETE_DETACHED(&observation);
         return NULL;
     }
@@ -1027,6 +1872,76 @@ static anjay_uri_path_t get_response_path(anjay_observation_value_t *value) {
     return observation->paths[0];
 }
 
+static int serialize_next_entry(anjay_observe_connection_entry_t *conn) {
+    anjay_unlocked_t *anjay = _anjay_from_server(conn->conn_ref.server);
+    anjay_observation_value_t *value = conn->unsent;
+    // NOTE: Access Control permissions have been checked during the
+    // read_as_batch() stage, so we're "spoofing" ANJAY_SSID_BOOTSTRAP
+    // as the permissions are checked now
+    int result = _anjay_batch_data_output_entry(
+            anjay, value->values[conn->serialization_state.curr_value_idx],
+            ANJAY_SSID_BOOTSTRAP, conn->serialization_state.serialization_time,
+            &conn->serialization_state.output_state,
+            conn->serialization_state.out_ctx);
+    if (!result && !conn->serialization_state.output_state) {
+        ++conn->serialization_state.curr_value_idx;
+        if (conn->serialization_state.curr_value_idx
+                >= value->ref->paths_count) {
+            result = _anjay_output_ctx_destroy_and_process_result(
+                    &conn->serialization_state.out_ctx, result);
+        }
+    }
+    return result;
+}
+
+static int cache_whole_payload(anjay_observe_connection_entry_t *conn) {
+    assert(!conn->serialization_state.payload_cached);
+    while (conn->serialization_state.out_ctx) {
+        int result = serialize_next_entry(conn);
+        if (result) {
+            return result;
+        }
+    }
+    if (avs_is_err(avs_stream_membuf_take_ownership(
+                conn->serialization_state.membuf_stream,
+                &conn->serialization_state.payload,
+                &conn->serialization_state.payload_size))) {
+        return -1;
+    }
+    conn->serialization_state.payload_cached = true;
+    return 0;
+}
+
+static int write_cached_notify_payload(anjay_observe_connection_entry_t *conn,
+                                       size_t payload_offset,
+                                       void *payload_buf,
+                                       size_t payload_buf_size,
+                                       size_t *out_payload_chunk_size) {
+    int result;
+    if (!conn->serialization_state.payload_cached
+            && (result = cache_whole_payload(conn))) {
+        return result;
+    }
+    if (payload_offset > conn->serialization_state.payload_size) {
+        anjay_log(DEBUG,
+                  _("Server requested chunk of payload at offset ") "%u" _(
+                          " beyond its size ") "%u",
+                  (unsigned) payload_offset,
+                  (unsigned) conn->serialization_state.payload_size);
+        return -1;
+    }
+    *out_payload_chunk_size =
+            AVS_MIN(payload_buf_size,
+                    conn->serialization_state.payload_size - payload_offset);
+    if (*out_payload_chunk_size) {
+        memcpy(payload_buf,
+               (const char *) conn->serialization_state.payload
+                       + payload_offset,
+               *out_payload_chunk_size);
+    }
+    return 0;
+}
+
 static int write_notify_payload(size_t payload_offset,
                                 void *payload_buf,
                                 size_t payload_buf_size,
@@ -1034,6 +1949,13 @@ static int write_notify_payload(size_t payload_offset,
                                 void *conn_) {
     anjay_observe_connection_entry_t *conn =
             (anjay_observe_connection_entry_t *) conn_;
+    ANJAY_TRACEPOINT(payload_block, _anjay_server_ssid(conn->conn_ref.server),
+                     (int) ANJAY_OPERATION_NOTIFY, payload_offset);
+    if (conn->observe->cache_payload) {
+        return write_cached_notify_payload(conn, payload_offset, payload_buf,
+                                           payload_buf_size,
+                                           out_payload_chunk_size);
+    }
     if (payload_offset != conn->serialization_state.expected_offset) {
         anjay_log(DEBUG,
                   _("Server requested unexpected chunk of payload (expected "
@@ -1043,10 +1965,6 @@ static int write_notify_payload(size_t payload_offset,
         return -1;
     }
 
-    anjay_unlocked_t *anjay = _anjay_from_server(conn->conn_ref.server);
-    anjay_observation_value_t *value = conn->unsent;
-    anjay_observation_t *observation = value->ref;
-
     char *write_ptr = (char *) payload_buf;
     const char *end_ptr = write_ptr + payload_buf_size;
     while (true) {
@@ -1060,23 +1978,7 @@ static int write_notify_payload(size_t payload_offset,
         if (write_ptr >= end_ptr || !conn->serialization_state.out_ctx) {
             break;
         }
-        // NOTE: Access Control permissions have been checked during the
-        // read_as_batch() stage, so we're "spoofing" ANJAY_SSID_BOOTSTRAP
-        // as the permissions are checked now
-        int result = _anjay_batch_data_output_entry(
-                anjay, value->values[conn->serialization_state.curr_value_idx],
-                ANJAY_SSID_BOOTSTRAP,
-                conn->serialization_state.serialization_time,
-                &conn->serialization_state.output_state,
-                conn->serialization_state.out_ctx);
-        if (!result && !conn->serialization_state.output_state) {
-            ++conn->serialization_state.curr_value_idx;
-            if (conn->serialization_state.curr_value_idx
-                    >= observation->paths_count) {
-                result = _anjay_output_ctx_destroy_and_process_result(
-                        &conn->serialization_state.out_ctx, result);
-            }
-        }
+        int result = serialize_next_entry(conn);
         if (result) {
             return result;
         }
@@ -1086,10 +1988,27 @@ static int write_notify_payload(size_t payload_offset,
     return 0;
 }
 
+static anjay_uri_path_t
+initial_response_root_path(const anjay_request_t *request,
+                           size_t values_count,
+                           const anjay_batch_t *const *values) {
+#    if defined(ANJAY_WITH_LWM2M11) \
+            && !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+    if (request->action == ANJAY_ACTION_READ_COMPOSITE) {
+        return get_composite_root_path(values, values_count);
+    }
+#    endif // defined(ANJAY_WITH_LWM2M11) &&
+           // !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+    (void) values_count;
+    (void) values;
+    return request->uri;
+}
+
 static anjay_msg_details_t
 initial_response_details(anjay_unlocked_t *anjay,
                          const anjay_request_t *request,
                          anjay_lwm2m_version_t lwm2m_version,
+                         size_t values_count,
                          const anjay_batch_t *const *values) {
     bool requires_hierarchical_format;
 #    if defined(ANJAY_WITH_LWM2M11) \
@@ -1105,8 +2024,17 @@ initial_response_details(anjay_unlocked_t *anjay,
         requires_hierarchical_format =
                 _anjay_batch_data_requires_hierarchical_format(values[0]);
     }
-    return _anjay_dm_response_details_for_read(
+    anjay_msg_details_t details = _anjay_dm_response_details_for_read(
             anjay, request, requires_hierarchical_format, lwm2m_version);
+    if (anjay->prefer_compact_formats
+            && request->requested_format == AVS_COAP_FORMAT_NONE) {
+        const anjay_uri_path_t root_path =
+                initial_response_root_path(request, values_count, values);
+        details.format = _anjay_batch_smallest_format(
+                anjay, lwm2m_version, &root_path, request->action,
+                values_count, values, details.format);
+    }
+    return details;
 }
 
 static int multiple_batches_item_count(anjay_unlocked_t *anjay,
@@ -1139,14 +2067,8 @@ static int send_initial_response(anjay_unlocked_t *anjay,
         return -1;
     }
 
-    anjay_uri_path_t root_path = request->uri;
-#    if defined(ANJAY_WITH_LWM2M11) \
-            && !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
-    if (request->action == ANJAY_ACTION_READ_COMPOSITE) {
-        root_path = get_composite_root_path(values, values_count);
-    }
-#    endif // defined(ANJAY_WITH_LWM2M11) &&
-           // !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+    const anjay_uri_path_t root_path =
+            initial_response_root_path(request, values_count, values);
 
     size_t item_count;
     anjay_unlocked_output_ctx_t *out_ctx = NULL;
@@ -1174,23 +2096,143 @@ static int send_initial_response(anjay_unlocked_t *anjay,
 #        include "tests/core/observe/observe_mock.h"
 #    endif // ANJAY_TEST
 
-static void delete_batch_array(anjay_batch_t ***batches_ptr,
+/**
+ * Arrays of batches only live while a single observation is being sampled, so
+ * they are allocated from the request arena.
+ */
+static anjay_batch_t **new_batch_array(anjay_unlocked_t *anjay,
+                                       size_t batches_count) {
+    anjay_batch_t **batches = (anjay_batch_t **) _anjay_arena_alloc(
+            &anjay->request_arena, batches_count * sizeof(anjay_batch_t *));
+    if (!batches) {
+        _anjay_log_oom();
+        return NULL;
+    }
+    memset(batches, 0, batches_count * sizeof(anjay_batch_t *));
+    return batches;
+}
+
+static void delete_batch_array(anjay_unlocked_t *anjay,
+                               anjay_batch_t ***batches_ptr,
                                size_t batches_count) {
+    if (!*batches_ptr) {
+        return;
+    }
     for (size_t i = 0; i < batches_count; ++i) {
         if ((*batches_ptr)[i]) {
             _anjay_batch_release(&(*batches_ptr)[i]);
         }
     }
-    avs_free(*batches_ptr);
+    _anjay_arena_free(&anjay->request_arena, *batches_ptr);
     *batches_ptr = NULL;
 }
 
+static void samples_cleanup_job(avs_sched_t *sched, const void *dummy) {
+    (void) dummy;
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    clear_all_samples(&anjay->observe);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+void _anjay_observe_clear_samples(anjay_unlocked_t *anjay) {
+    avs_sched_del(&anjay->observe.samples_cleanup_handle);
+    clear_all_samples(&anjay->observe);
+}
+
+static bool path_in_dropped_object(const anjay_uri_path_t *path,
+                                   anjay_oid_t oid) {
+    return path->ids[ANJAY_ID_OID] == oid
+           || path->ids[ANJAY_ID_OID] == ANJAY_ID_INVALID;
+}
+
+void _anjay_observe_drop_samples(anjay_unlocked_t *anjay, anjay_oid_t oid) {
+    AVS_LIST(anjay_observe_sample_t) *sample_ptr;
+    AVS_LIST(anjay_observe_sample_t) helper;
+    AVS_LIST_DELETABLE_FOREACH_PTR(sample_ptr, helper,
+                                   &anjay->observe.samples) {
+        if (path_in_dropped_object(&(*sample_ptr)->path, oid)) {
+            _anjay_batch_release(&(*sample_ptr)->batch);
+            AVS_LIST_DELETE(sample_ptr);
+        }
+    }
+    AVS_LIST(anjay_observe_path_set_t) set;
+    AVS_LIST_FOREACH(set, anjay->observe.path_sets) {
+        for (size_t i = 0; set->samples && i < set->paths_count; ++i) {
+            if (path_in_dropped_object(&set->paths[i], oid)) {
+                clear_path_set_samples(set);
+            }
+        }
+    }
+}
+
+static bool ensure_samples_cleanup_scheduled(anjay_unlocked_t *anjay) {
+    return anjay->observe.samples_cleanup_handle
+           || !AVS_SCHED_NOW(anjay->sched,
+                             &anjay->observe.samples_cleanup_handle,
+                             samples_cleanup_job, NULL, 0);
+}
+
+static anjay_ssid_t sample_ssid(anjay_unlocked_t *anjay,
+                                anjay_ssid_t connection_ssid) {
+    return _anjay_access_control_in_effect(anjay) ? connection_ssid
+                                                  : ANJAY_SSID_ANY;
+}
+
+static anjay_batch_t *find_sample(anjay_unlocked_t *anjay,
+                                  const anjay_uri_path_t *path,
+                                  anjay_request_action_t action,
+                                  anjay_ssid_t ssid) {
+    AVS_LIST(anjay_observe_sample_t) sample;
+    AVS_LIST_FOREACH(sample, anjay->observe.samples) {
+        if (sample->action == action && sample->ssid == ssid
+                && _anjay_uri_path_equal(&sample->path, path)) {
+            return sample->batch;
+        }
+    }
+    return NULL;
+}
+
+static void store_sample(anjay_unlocked_t *anjay,
+                         const anjay_uri_path_t *path,
+                         anjay_request_action_t action,
+                         anjay_ssid_t ssid,
+                         const anjay_batch_t *batch) {
+    // failures are not fatal, the value just won't be shared
+    if (!ensure_samples_cleanup_scheduled(anjay)) {
+        return;
+    }
+    AVS_LIST(anjay_observe_sample_t) sample =
+            AVS_LIST_NEW_ELEMENT(anjay_observe_sample_t);
+    if (!sample) {
+        _anjay_log_oom();
+        return;
+    }
+    if (!(sample->batch = _anjay_batch_acquire(batch))) {
+        AVS_LIST_DELETE(&sample);
+        return;
+    }
+    sample->path = *path;
+    sample->action = action;
+    sample->ssid = ssid;
+    AVS_LIST_INSERT(&anjay->observe.samples, sample);
+}
+
 static int read_observation_path(anjay_unlocked_t *anjay,
                                  const anjay_uri_path_t *path,
                                  anjay_request_action_t action,
                                  anjay_ssid_t connection_ssid,
                                  const avs_time_real_t *timestamp,
                                  anjay_batch_t **out_batch) {
+    anjay_ssid_t ssid = ANJAY_SSID_ANY;
+    if (anjay->observe.share_samples) {
+        ssid = sample_ssid(anjay, connection_ssid);
+        const anjay_batch_t *sample = find_sample(anjay, path, action, ssid);
+        if (sample) {
+            return (*out_batch = _anjay_batch_acquire(sample)) ? 0 : -1;
+        }
+    }
+
     const anjay_dm_installed_object_t *obj = NULL;
     if (_anjay_uri_path_has(path, ANJAY_ID_OID)) {
         obj = _anjay_dm_find_object_by_oid(anjay, path->ids[ANJAY_ID_OID]);
@@ -1200,6 +2242,81 @@ static int read_observation_path(anjay_unlocked_t *anjay,
     (void) ((result = _anjay_dm_path_info(anjay, obj, path, &path_info))
             || (result = read_as_batch(anjay, obj, &path_info, action,
                                        connection_ssid, timestamp, out_batch)));
+    if (!result && anjay->observe.share_samples) {
+        store_sample(anjay, path, action, ssid, *out_batch);
+    }
+    return result;
+}
+
+static AVS_LIST(anjay_observe_path_set_sample_t)
+find_path_set_sample(const anjay_observe_path_set_t *set, anjay_ssid_t ssid) {
+    AVS_LIST(anjay_observe_path_set_sample_t) sample;
+    AVS_LIST_FOREACH(sample, set->samples) {
+        if (sample->ssid == ssid) {
+            break;
+        }
+    }
+    return sample;
+}
+
+static void store_path_set_sample(anjay_unlocked_t *anjay,
+                                  anjay_observe_path_set_t *set,
+                                  size_t index,
+                                  anjay_ssid_t ssid,
+                                  const anjay_batch_t *batch) {
+    assert(index < set->paths_count);
+    AVS_LIST(anjay_observe_path_set_sample_t) sample =
+            find_path_set_sample(set, ssid);
+    if (!sample) {
+        // failures are not fatal, the value just won't be shared
+        if (!ensure_samples_cleanup_scheduled(anjay)
+                || !(sample = (AVS_LIST(anjay_observe_path_set_sample_t))
+                             AVS_LIST_NEW_BUFFER(
+                                     offsetof(anjay_observe_path_set_sample_t,
+                                              values)
+                                     + set->paths_count
+                                               * sizeof(anjay_batch_t *)))) {
+            return;
+        }
+        sample->ssid = ssid;
+        AVS_LIST_INSERT(&set->samples, sample);
+    }
+    if (!sample->values[index]) {
+        sample->values[index] = _anjay_batch_acquire(batch);
+    }
+}
+
+/**
+ * Equivalent of read_observation_path() for path number @p index of
+ * @p observation. If the observation uses a shared path set, values sampled
+ * for it are shared with all other observations of the same set, so that
+ * evaluating each of them does not need to look up each of the paths again.
+ */
+static int read_observation_path_at(anjay_unlocked_t *anjay,
+                                    anjay_observation_t *observation,
+                                    size_t index,
+                                    anjay_ssid_t connection_ssid,
+                                    const avs_time_real_t *timestamp,
+                                    anjay_batch_t **out_batch) {
+    anjay_observe_path_set_t *set = observation->path_set;
+    const anjay_ssid_t ssid = sample_ssid(anjay, connection_ssid);
+    if (set && anjay->observe.share_samples) {
+        AVS_LIST(anjay_observe_path_set_sample_t) sample =
+                find_path_set_sample(set, ssid);
+        if (sample && sample->values[index]) {
+            return (*out_batch = _anjay_batch_acquire(sample->values[index]))
+                           ? 0
+                           : -1;
+        }
+    }
+    int result = read_observation_path(anjay, &observation->paths[index],
+                                       observation->action, connection_ssid,
+                                       timestamp, out_batch);
+    // the sample is looked up again, as the data model handlers might have
+    // caused it to be dropped
+    if (!result && set && anjay->observe.share_samples) {
+        store_path_set_sample(anjay, set, index, ssid, *out_batch);
+    }
     return result;
 }
 
@@ -1214,9 +2331,7 @@ static int read_observation_values(anjay_unlocked_t *anjay,
            || paths->count == AVS_LIST_SIZE(paths->paths));
 
     if (paths->count
-            && !(*out_batches = (anjay_batch_t **) avs_calloc(
-                         paths->count, sizeof(anjay_batch_t *)))) {
-        _anjay_log_oom();
+            && !(*out_batches = new_batch_array(anjay, paths->count))) {
         return -1;
     }
 
@@ -1250,14 +2365,14 @@ static int read_observation_values(anjay_unlocked_t *anjay,
     }
 
     if (result) {
-        delete_batch_array(out_batches, paths->count);
+        delete_batch_array(anjay, out_batches, paths->count);
     }
     return result;
 }
 
-static int observe_handle(anjay_connection_ref_t ref,
-                          const paths_arg_t *paths,
-                          const anjay_request_t *request) {
+static int observe_handle_impl(anjay_connection_ref_t ref,
+                               const paths_arg_t *paths,
+                               const anjay_request_t *request) {
     AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr =
             find_or_create_connection_state(ref);
     if (!conn_ptr) {
@@ -1281,7 +2396,7 @@ static int observe_handle(anjay_connection_ref_t ref,
     response_details = initial_response_details(
             anjay, request,
             _anjay_server_registration_info(ref.server)->lwm2m_version,
-            cast_to_const_batch_array(batches));
+            paths->count, cast_to_const_batch_array(batches));
 
     if (!(observation =
                   put_entry_into_connection_state(request, *conn_ptr, paths))
@@ -1294,6 +2409,10 @@ static int observe_handle(anjay_connection_ref_t ref,
     // No matter if we succeeded with adding the observation to internal
     // state or not, as long as we have some payload, we may as well just
     // "process the request as usual" (RFC 7641, section 4.1).
+#    ifdef ANJAY_WITH_OPERATION_STATS
+    _anjay_operation_stats_record_format(anjay, _anjay_server_ssid(ref.server),
+                                         response_details.format);
+#    endif // ANJAY_WITH_OPERATION_STATS
     send_result = send_initial_response(anjay, &response_details, request,
                                         paths->count,
                                         cast_to_const_batch_array(batches));
@@ -1304,7 +2423,7 @@ static int observe_handle(anjay_connection_ref_t ref,
             delete_connection_if_empty(conn_ptr);
         }
     }
-    delete_batch_array(&batches, paths->count);
+    delete_batch_array(anjay, &batches, paths->count);
 
     if (result && !send_result) {
         // we sent the response as if it was a read request
@@ -1313,6 +2432,15 @@ static int observe_handle(anjay_connection_ref_t ref,
     return result;
 }
 
+static int observe_handle(anjay_connection_ref_t ref,
+                          const paths_arg_t *paths,
+                          const anjay_request_t *request) {
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_OBSERVE);
+    int result = observe_handle_impl(ref, paths, request);
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+    return result;
+}
+
 int _anjay_observe_handle(anjay_connection_ref_t ref,
                           const anjay_request_t *request) {
     assert(request->action == ANJAY_ACTION_READ);
@@ -1342,36 +2470,33 @@ int _anjay_observe_composite_handle(anjay_connection_ref_t ref,
 #    endif // defined(ANJAY_WITH_LWM2M11) &&
            // !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
 
-static int observe_gc_ssid_iterate(anjay_unlocked_t *anjay,
-                                   anjay_ssid_t ssid,
-                                   void *conn_ptr_ptr_) {
-    (void) anjay;
-    AVS_LIST(anjay_observe_connection_entry_t) **conn_ptr_ptr =
-            (AVS_LIST(anjay_observe_connection_entry_t) **) conn_ptr_ptr_;
-    while (**conn_ptr_ptr
-           && _anjay_server_ssid((**conn_ptr_ptr)->conn_ref.server) < ssid) {
-        delete_connection(*conn_ptr_ptr);
-    }
-    while (**conn_ptr_ptr
-           && _anjay_server_ssid((**conn_ptr_ptr)->conn_ref.server) == ssid) {
-        AVS_LIST_ADVANCE_PTR(conn_ptr_ptr);
-    }
-    return 0;
-}
-
-void _anjay_observe_gc(anjay_unlocked_t *anjay) {
+void _anjay_observe_server_removed(anjay_server_info_t *server) {
+    const anjay_ssid_t ssid = _anjay_server_ssid(server);
+    // entries are sorted by SSID, so all the ones for server are adjacent
     AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr =
-            &anjay->observe.connection_entries;
-    _anjay_servers_foreach_ssid(anjay, observe_gc_ssid_iterate, &conn_ptr);
-    while (*conn_ptr) {
+            &_anjay_from_server(server)->observe.connection_entries;
+    while (*conn_ptr
+           && _anjay_server_ssid((*conn_ptr)->conn_ref.server) < ssid) {
+        AVS_LIST_ADVANCE_PTR(&conn_ptr);
+    }
+    while (*conn_ptr && (*conn_ptr)->conn_ref.server == server) {
         delete_connection(conn_ptr);
     }
 }
 
+/**
+ * Checks whether the Maximum Period has passed since @p value has been sent.
+ * @p wake_window is the time by which the notification trigger might have been
+ * moved earlier by align_pmax_trigger_with_update().
+ */
 static bool has_pmax_expired(const anjay_observation_value_t *value,
-                             const anjay_dm_oi_attributes_t *attrs) {
+                             const anjay_dm_oi_attributes_t *attrs,
+                             avs_time_duration_t wake_window) {
     return is_pmax_valid(*attrs)
-           && avs_time_real_diff(avs_time_real_now(), value->timestamp).seconds
+           && avs_time_real_diff(avs_time_real_add(avs_time_real_now(),
+                                                   wake_window),
+                                 value->timestamp)
+                              .seconds
                       >= attrs->max_period;
 }
 
@@ -1399,6 +2524,31 @@ process_ltgt(double threshold, double previous_value, double new_value) {
                || (previous_value >= threshold && new_value < threshold));
 }
 
+/**
+ * Evaluates the st/lt/gt criteria pairwise over contiguous arrays of Resource
+ * Instance values. The loop body is deliberately branch-free: comparisons
+ * against NAN thresholds always yield false, so unset attributes need no
+ * special casing, which lets the compiler vectorize the loop where the target
+ * supports it.
+ */
+static bool process_numeric_arrays(const anjay_dm_r_attributes_t *attrs,
+                                   const double *previous_values,
+                                   const double *new_values,
+                                   size_t count) {
+    const double step = attrs->step;
+    const double lt = attrs->less_than;
+    const double gt = attrs->greater_than;
+    int result = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const double prev = previous_values[i];
+        const double curr = new_values[i];
+        result |= (fabs(curr - prev) >= step)
+                  | ((prev <= lt) & (curr > lt)) | ((prev >= lt) & (curr < lt))
+                  | ((prev <= gt) & (curr > gt)) | ((prev >= gt) & (curr < gt));
+    }
+    return result;
+}
+
 static bool should_update(const anjay_uri_path_t *path,
                           const anjay_dm_r_attributes_t *attrs,
                           const anjay_batch_t *previous_value,
@@ -1407,6 +2557,30 @@ static bool should_update(const anjay_uri_path_t *path,
         return false;
     }
 
+    if (isnan(attrs->greater_than) && isnan(attrs->less_than)
+            && isnan(attrs->step)) {
+        // none of lt/gt/st/edge attributes are set - notifying each change
+        return true;
+    }
+
+    size_t previous_count = 0;
+    size_t new_count = 0;
+    const double *previous_array = NULL;
+    const double *new_array = NULL;
+    if (_anjay_uri_path_leaf_is(path, ANJAY_ID_RID)
+            && (previous_array =
+                        _anjay_batch_data_numeric_array(previous_value,
+                                                        &previous_count))
+            && (new_array = _anjay_batch_data_numeric_array(new_value,
+                                                            &new_count))
+            && previous_count == new_count
+            && _anjay_batch_paths_equal(previous_value, new_value)) {
+        // Multiple-Instance Resource with the same set of numeric Resource
+        // Instances - notifying if any of them meets the criteria
+        return process_numeric_arrays(attrs, previous_array, new_array,
+                                      new_count);
+    }
+
     double previous_numeric = NAN;
     double new_numeric = NAN;
     bool is_previous_value_boolean = false;
@@ -1423,11 +2597,9 @@ static bool should_update(const anjay_uri_path_t *path,
         }
     }
     if ((isnan(new_numeric) && !is_new_value_boolean)
-            || (isnan(previous_numeric) && !is_previous_value_boolean)
-            || (isnan(attrs->greater_than) && isnan(attrs->less_than)
-                && isnan(attrs->step))) {
-        // either previous or current value is not numeric/boolean, or none of
-        // lt/gt/st/edge attributes are set - notifying each value change
+            || (isnan(previous_numeric) && !is_previous_value_boolean)) {
+        // either previous or current value is not numeric/boolean - notifying
+        // each value change
         return true;
     }
 
@@ -1550,12 +2722,16 @@ static void
 cleanup_serialization_state(anjay_observation_serialization_state_t *state) {
     _anjay_output_ctx_destroy(&state->out_ctx);
     avs_stream_cleanup(&state->membuf_stream);
+    avs_free(state->payload);
+    state->payload = NULL;
+    state->payload_cached = false;
 }
 
 static int
 initialize_serialization_state(anjay_observe_connection_entry_t *conn) {
     assert(!conn->serialization_state.membuf_stream);
     assert(!conn->serialization_state.out_ctx);
+    assert(!conn->serialization_state.payload);
     memset(&conn->serialization_state, 0, sizeof(conn->serialization_state));
 
     anjay_observation_value_t *value = conn->unsent;
@@ -1581,22 +2757,48 @@ initialize_serialization_state(anjay_observe_connection_entry_t *conn) {
     return 0;
 }
 
+#    ifdef ANJAY_WITH_TRAFFIC_STATS
+static anjay_oid_t notification_oid(const anjay_observation_t *observation) {
+    return observation->paths_count == 1
+                   ? observation->paths[0].ids[ANJAY_ID_OID]
+                   : ANJAY_ID_INVALID;
+}
+#    endif // ANJAY_WITH_TRAFFIC_STATS
+
 static void
 handle_notify_delivery(avs_coap_ctx_t *coap, avs_error_t err, void *conn_) {
     (void) coap;
     anjay_observe_connection_entry_t *conn =
             (anjay_observe_connection_entry_t *) conn_;
+    ANJAY_TRAFFIC_STATS_SET_INCOMING(_anjay_from_server(conn->conn_ref.server),
+                                     ANJAY_OPERATION_NOTIFY,
+                                     conn->unsent->details.format,
+                                     notification_oid(conn->unsent->ref));
 
     bool is_error = is_error_value(conn->unsent);
     conn->notify_exchange_id = AVS_COAP_EXCHANGE_ID_INVALID;
     cleanup_serialization_state(&conn->serialization_state);
+#    if defined(ANJAY_WITH_OBSERVATION_STATUS) \
+            || defined(ANJAY_WITH_TRACEPOINTS)
+    const uint32_t retransmissions =
+            avs_coap_get_stats(coap).outgoing_retransmissions_count
+            - conn->notify_retransmissions_base;
+    ANJAY_TRACEPOINT(notify_delivered,
+                     _anjay_server_ssid(conn->conn_ref.server),
+                     conn->unsent->ref, retransmissions, avs_is_err(err));
+#    endif // defined(ANJAY_WITH_OBSERVATION_STATUS) ||
+           // defined(ANJAY_WITH_TRACEPOINTS)
+    ADD_TO_COUNTER(conn, conn->unsent->ref, retransmissions, retransmissions);
     if (avs_is_ok(err)) {
+        ADD_TO_COUNTER(conn, conn->unsent->ref, notifications_sent, 1);
         _anjay_connection_mark_stable(conn->conn_ref);
         if (conn->unsent->reliability_hint
                 == AVS_COAP_NOTIFY_PREFER_CONFIRMABLE) {
             conn->unsent->ref->last_confirmable = avs_time_real_now();
         }
         value_sent(conn);
+    } else {
+        _anjay_connection_udp_nat_request_failed(conn->conn_ref, err);
     }
     if (!is_error || avs_is_err(err)) {
         on_entry_flushed(conn, err);
@@ -1607,6 +2809,13 @@ static void flush_next_unsent(anjay_observe_connection_entry_t *conn) {
     assert(conn->unsent);
     anjay_observation_t *observation = conn->unsent->ref;
     anjay_msg_details_t details = conn->unsent->details;
+#    ifdef ANJAY_WITH_OPERATION_STATS
+    const avs_time_monotonic_t start_time = avs_time_monotonic_now();
+    const avs_time_real_t value_timestamp = conn->unsent->timestamp;
+#    endif // ANJAY_WITH_OPERATION_STATS
+#    ifdef ANJAY_WITH_TRAFFIC_STATS
+    const anjay_oid_t traffic_oid = notification_oid(observation);
+#    endif // ANJAY_WITH_TRAFFIC_STATS
 
     if (confirmable_required(conn)) {
         conn->unsent->reliability_hint = AVS_COAP_NOTIFY_PREFER_CONFIRMABLE;
@@ -1647,6 +2856,23 @@ static void flush_next_unsent(anjay_observe_connection_entry_t *conn) {
             // may be called by avs_coap_notify_async(), which may invalidate
             // conn. That's also why we need this intermediate exchange_id
             avs_coap_exchange_id_t exchange_id = AVS_COAP_EXCHANGE_ID_INVALID;
+#    if defined(ANJAY_WITH_OBSERVATION_STATUS) \
+            || defined(ANJAY_WITH_TRACEPOINTS)
+            conn->notify_retransmissions_base =
+                    avs_coap_get_stats(coap).outgoing_retransmissions_count;
+#    endif // defined(ANJAY_WITH_OBSERVATION_STATUS) ||
+           // defined(ANJAY_WITH_TRACEPOINTS)
+#    ifdef ANJAY_WITH_OPERATION_STATS
+            if (payload_writer) {
+                _anjay_operation_stats_record_format(
+                        anjay, _anjay_server_ssid(conn_ref.server),
+                        details.format);
+            }
+#    endif // ANJAY_WITH_OPERATION_STATS
+            ANJAY_ALLOCATION_SITE_ENTER(prev_site);
+            ANJAY_TRAFFIC_STATS_BEGIN(
+                    traffic_snapshot,
+                    _anjay_connection_get_online_socket(conn_ref));
             err = avs_coap_notify_async(coap, &exchange_id,
                                         (avs_coap_observe_id_t) {
                                             .token = observation->token
@@ -1655,6 +2881,12 @@ static void flush_next_unsent(anjay_observe_connection_entry_t *conn) {
                                         conn->unsent->reliability_hint,
                                         payload_writer, conn,
                                         handle_notify_delivery, conn);
+            // the socket may have been closed by handle_notify_delivery()
+            ANJAY_TRAFFIC_STATS_END(
+                    anjay, traffic_snapshot,
+                    _anjay_connection_get_online_socket(conn_ref),
+                    ANJAY_OPERATION_NOTIFY, details.format, traffic_oid);
+            ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
             if (avs_is_err(err)) {
                 if (connection_exists(anjay, conn)) {
                     cleanup_serialization_state(&conn->serialization_state);
@@ -1666,10 +2898,21 @@ static void flush_next_unsent(anjay_observe_connection_entry_t *conn) {
                             conn->notify_exchange_id));
                     conn->notify_exchange_id = exchange_id;
                 }
+                _anjay_connection_udp_nat_request_sent(conn_ref);
             }
         }
     }
     avs_coap_options_cleanup(&response.options);
+    ANJAY_TRACEPOINT(notify_sent, _anjay_server_ssid(conn_ref.server),
+                     observation, avs_is_err(err));
+#    ifdef ANJAY_WITH_OPERATION_STATS
+    // conn may have been invalidated, but the server entry is still valid
+    _anjay_operation_stats_record(
+            anjay, _anjay_server_ssid(conn_ref.server), ANJAY_OPERATION_NOTIFY,
+            avs_time_monotonic_diff(avs_time_monotonic_now(), start_time),
+            avs_time_real_diff(avs_time_real_now(), value_timestamp),
+            avs_is_err(err));
+#    endif // ANJAY_WITH_OPERATION_STATS
 #    ifndef ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
     // on_entry_flushed() may have closed the socket already,
     // so we need to check if it's still open
@@ -1692,17 +2935,17 @@ void _anjay_observe_interrupt(anjay_connection_ref_t ref) {
         return;
     }
     if ((*conn_ptr)->flush_task) {
-        anjay_log(TRACE,
-                  _("Cancelling notifications flush task for server "
-                    "SSID ") "%u" _(", connection type ") "%d",
-                  _anjay_server_ssid(ref.server), ref.conn_type);
+        anjay_deferred_log(_anjay_from_server(ref.server), TRACE,
+                           OBSERVE_CANCEL_FLUSH,
+                           (uint32_t) _anjay_server_ssid(ref.server),
+                           (uint32_t) ref.conn_type);
         avs_sched_del(&(*conn_ptr)->flush_task);
     }
     if (avs_coap_exchange_id_valid((*conn_ptr)->notify_exchange_id)) {
-        anjay_log(TRACE,
-                  _("Cancelling notification attempt for server SSID ") "%u" _(
-                          ", connection type ") "%d",
-                  _anjay_server_ssid(ref.server), ref.conn_type);
+        anjay_deferred_log(_anjay_from_server(ref.server), TRACE,
+                           OBSERVE_CANCEL_NOTIFY,
+                           (uint32_t) _anjay_server_ssid(ref.server),
+                           (uint32_t) ref.conn_type);
         avs_coap_exchange_cancel(_anjay_connection_get_coap(ref),
                                  (*conn_ptr)->notify_exchange_id);
         assert(!avs_coap_exchange_id_valid((*conn_ptr)->notify_exchange_id));
@@ -1716,6 +2959,16 @@ bool _anjay_observe_confirmable_in_delivery(anjay_connection_ref_t ref) {
            && avs_coap_exchange_id_valid((*conn_ptr)->notify_exchange_id);
 }
 
+bool _anjay_observe_any_confirmable_in_delivery(anjay_unlocked_t *anjay) {
+    AVS_LIST(anjay_observe_connection_entry_t) conn;
+    AVS_LIST_FOREACH(conn, anjay->observe.connection_entries) {
+        if (avs_coap_exchange_id_valid(conn->notify_exchange_id)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 #    ifndef ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
 bool _anjay_observe_needs_flushing(anjay_connection_ref_t ref) {
     AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr =
@@ -1729,10 +2982,10 @@ bool _anjay_observe_needs_flushing(anjay_connection_ref_t ref) {
 #    endif // ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
 
 int _anjay_observe_sched_flush(anjay_connection_ref_t ref) {
-    anjay_log(TRACE,
-              _("scheduling notifications flush for server SSID ") "%u" _(
-                      ", connection type ") "%d",
-              _anjay_server_ssid(ref.server), ref.conn_type);
+    anjay_deferred_log(_anjay_from_server(ref.server), TRACE,
+                       OBSERVE_SCHED_FLUSH,
+                       (uint32_t) _anjay_server_ssid(ref.server),
+                       (uint32_t) ref.conn_type);
     AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr =
             _anjay_observe_find_connection_state(ref);
     if (!conn_ptr) {
@@ -1758,40 +3011,65 @@ update_notification_value(anjay_observe_connection_entry_t *conn_state,
     anjay_dm_con_attr_t con = ANJAY_DM_CON_ATTR_NONE;
 
     if (observation->paths_count
-            && !(batches = (anjay_batch_t **) avs_calloc(
-                         observation->paths_count, sizeof(anjay_batch_t *)))) {
-        _anjay_log_oom();
+            && !(batches = new_batch_array(anjay, observation->paths_count))) {
         return -1;
     }
 
     const avs_time_real_t timestamp = avs_time_real_now();
+    const avs_time_duration_t wake_window =
+            conn_state->conn_ref.conn_type == ANJAY_CONNECTION_PRIMARY
+                    ? _anjay_server_wake_window(conn_state->conn_ref.server)
+                    : AVS_TIME_DURATION_ZERO;
 
     int result = 0;
+    bool value_busy = false;
+    // values of notify-driven Objects cannot have changed since the last read
+    // if no change has been reported, so there is no need to read them again
+    const bool reuse_values = observation->values_fresh;
+    bool values_read = true;
     for (size_t i = 0; i < observation->paths_count; ++i) {
         anjay_dm_r_attributes_t attrs;
-        if ((result = get_effective_attrs(anjay, &attrs, &observation->paths[i],
-                                          ssid))) {
+        if ((result = get_observation_attrs(anjay, &attrs, observation, i,
+                                            ssid))) {
             anjay_log(ERROR, _("Could not get attributes of path ") "%s",
                       ANJAY_DEBUG_MAKE_PATH(&observation->paths[i]));
             goto finish;
         }
 
-        if (has_epmin_expired(newest_value(observation)->values[i],
-                              &attrs.common)) {
-            if ((result = read_observation_path(anjay, &observation->paths[i],
-                                                observation->action, ssid,
-                                                &timestamp, &batches[i]))) {
+        if (!value_busy && !reuse_values
+                && has_epmin_expired(newest_value(observation)->values[i],
+                                     &attrs.common)) {
+            result = read_observation_path_at(anjay, observation, i, ssid,
+                                              &timestamp, &batches[i]);
+            if (result == ANJAY_ERR_BUSY) {
+                anjay_log(DEBUG,
+                          _("path ") "%s" _(" busy, holding notification"),
+                          ANJAY_DEBUG_MAKE_PATH(&observation->paths[i]));
+                // The rest of the paths is only processed to calculate pmax,
+                // the notification will be retried when anjay_notify_changed()
+                // is called for the busy Resource, or when pmax expires.
+                value_busy = true;
+                result = 0;
+                update_batch_pmax(&pmax, &attrs);
+                continue;
+            } else if (result) {
                 anjay_log(ERROR,
                           _("Could not read path ") "%s" _(" for notifying"),
                           ANJAY_DEBUG_MAKE_PATH(&observation->paths[i]));
                 goto finish;
             }
+        } else if (value_busy) {
+            update_batch_pmax(&pmax, &attrs);
+            continue;
         } else {
-            anjay_log(DEBUG,
-                      _("epmin == ") "%" PRId32 _(" set for path ") "%s" _(
-                              " caused holding from reading a new value"),
-                      attrs.common.min_eval_period,
-                      ANJAY_DEBUG_MAKE_PATH(&observation->paths[i]));
+            if (!reuse_values) {
+                anjay_log(DEBUG,
+                          _("epmin == ") "%" PRId32 _(" set for path ") "%s" _(
+                                  " caused holding from reading a new value"),
+                          attrs.common.min_eval_period,
+                          ANJAY_DEBUG_MAKE_PATH(&observation->paths[i]));
+                values_read = false;
+            }
             // Do not even call read_handler, just copy previous value
             if (!(batches[i] = _anjay_batch_acquire(
                           newest_value(observation)->values[i]))) {
@@ -1801,7 +3079,8 @@ update_notification_value(anjay_observe_connection_entry_t *conn_state,
         }
 
         if (!should_update_batch
-                && (has_pmax_expired(newest_value(observation), &attrs.common)
+                && (has_pmax_expired(newest_value(observation), &attrs.common,
+                                     wake_window)
                     || should_update(&observation->paths[i], &attrs,
                                      newest_value(observation)->values[i],
                                      batches[i]))) {
@@ -1814,7 +3093,15 @@ update_notification_value(anjay_observe_connection_entry_t *conn_state,
 #    endif // ANJAY_WITH_CON_ATTR
     }
 
-    if (should_update_batch) {
+    observation->values_fresh =
+            !value_busy
+            && (reuse_values
+                || (values_read && is_notify_driven(&anjay->observe,
+                                                    observation)));
+
+    if (value_busy) {
+        // do not send anything yet
+    } else if (should_update_batch) {
         if (con < 0 && anjay->observe.confirmable_notifications) {
             con = ANJAY_DM_CON_ATTR_CON;
         }
@@ -1826,6 +3113,8 @@ update_notification_value(anjay_observe_connection_entry_t *conn_state,
                                   &newest_value(observation)->details,
                                   &timestamp,
                                   cast_to_const_batch_array(batches));
+    } else {
+        ADD_TO_COUNTER(conn_state, observation, criteria_suppressed, 1);
     }
 
     if (!result && pmax >= 0) {
@@ -1833,71 +3122,167 @@ update_notification_value(anjay_observe_connection_entry_t *conn_state,
     }
 
 finish:
-    delete_batch_array(&batches, observation->paths_count);
+    delete_batch_array(anjay, &batches, observation->paths_count);
     return result;
 }
 
-static void trigger_observe(avs_sched_t *sched, const void *args_) {
-    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    const trigger_observe_args_t *args = (const trigger_observe_args_t *) args_;
-    assert(args->conn_state);
-    assert(args->observation);
-    args->observation->next_pmax_trigger = AVS_TIME_REAL_INVALID;
-    recalculate_conn_trigger_times(args->conn_state);
+static void update_triggered_observation(
+        anjay_observe_connection_entry_t *conn_state,
+        anjay_observation_t *observation) {
+    int result = update_notification_value(conn_state, observation);
+    if (result) {
+        insert_error(conn_state, observation, result);
+    }
+}
+
+/**
+ * Handles automatic notification trigger of @p observation or, if it is NULL,
+ * of all observations in @p conn_state that have <c>trigger_due</c> set.
+ *
+ * @returns false if @p conn_state has been invalidated and must not be used
+ *          anymore, true otherwise.
+ */
+static bool handle_triggers(anjay_observe_connection_entry_t *conn_state,
+                            anjay_observation_t *observation) {
+    recalculate_conn_trigger_times(conn_state);
     bool ready_for_notifying =
-            _anjay_connection_ready_for_outgoing_message(
-                    args->conn_state->conn_ref)
+            _anjay_connection_ready_for_outgoing_message(conn_state->conn_ref)
             && _anjay_socket_transport_is_online(
-                       _anjay_from_server(args->conn_state->conn_ref.server),
-                       _anjay_connection_transport(args->conn_state->conn_ref));
+                       _anjay_from_server(conn_state->conn_ref.server),
+                       _anjay_connection_transport(conn_state->conn_ref));
     if (!ready_for_notifying
-            && _anjay_server_registration_expired(
-                       args->conn_state->conn_ref.server)) {
+            && _anjay_server_registration_expired(conn_state->conn_ref.server)) {
         // Registration expired - notifications would be cleared at the time of
         // Register anyway, so we might as well do it here to conserve memory
-        _anjay_observe_invalidate(args->conn_state->conn_ref);
-    } else {
-        if (ready_for_notifying
-                || notification_storing_enabled(args->conn_state->conn_ref)) {
-            int result = update_notification_value(args->conn_state,
-                                                   args->observation);
-            if (result) {
-                insert_error(args->conn_state, args->observation, result);
-            }
+        _anjay_observe_invalidate(conn_state->conn_ref);
+        return false;
+    }
+    bool should_update =
+            ready_for_notifying
+            || notification_storing_enabled(conn_state->conn_ref);
+    if (observation) {
+        if (should_update) {
+            update_triggered_observation(conn_state, observation);
         }
-        if (args->conn_state->unsent) {
-            if (ready_for_notifying
-                    && !avs_coap_exchange_id_valid(
-                               args->conn_state->notify_exchange_id)) {
-                avs_sched_del(&args->conn_state->flush_task);
-                assert(!args->conn_state->flush_task);
-                if (_anjay_connection_get_online_socket(
-                            args->conn_state->conn_ref)) {
-                    flush_next_unsent(args->conn_state);
-                } else if (_anjay_server_registration_info(
-                                   args->conn_state->conn_ref.server)
-                                   ->queue_mode) {
-                    _anjay_connection_bring_online(args->conn_state->conn_ref);
-                    // once the connection is up, _anjay_observe_sched_flush()
-                    // will be called; we're done here
-                } else if (!notification_storing_enabled(
-                                   args->conn_state->conn_ref)) {
-                    remove_all_unsent_values(args->conn_state);
+    } else {
+        AVS_SORTED_SET_FOREACH(observation, conn_state->observations) {
+            if (observation->trigger_due) {
+                observation->trigger_due = false;
+                if (should_update) {
+                    update_triggered_observation(conn_state, observation);
                 }
             }
         }
     }
+    if (conn_state->unsent && ready_for_notifying
+            && !avs_coap_exchange_id_valid(conn_state->notify_exchange_id)) {
+        avs_sched_del(&conn_state->flush_task);
+        assert(!conn_state->flush_task);
+        if (_anjay_connection_get_online_socket(conn_state->conn_ref)) {
+            flush_next_unsent(conn_state);
+        } else if (_anjay_server_registration_info(conn_state->conn_ref.server)
+                           ->queue_mode) {
+            _anjay_connection_bring_online(conn_state->conn_ref);
+            // once the connection is up, _anjay_observe_sched_flush()
+            // will be called; we're done here
+        } else if (!notification_storing_enabled(conn_state->conn_ref)) {
+            remove_all_unsent_values(conn_state);
+        }
+    }
+    return true;
+}
+
+static void trigger_observe(avs_sched_t *sched, const void *args_) {
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    ANJAY_SCHED_JOB_STATS_BEGIN(job_start_time);
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_OBSERVE);
+    const trigger_observe_args_t *args = (const trigger_observe_args_t *) args_;
+    assert(args->conn_state);
+    assert(args->observation);
+    args->observation->next_pmax_trigger = AVS_TIME_REAL_INVALID;
+    handle_triggers(args->conn_state, args->observation);
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+    ANJAY_SCHED_JOB_STATS_END(anjay, ANJAY_SCHED_JOB_OBSERVE_TRIGGER,
+                              job_start_time);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+static void trigger_due_observations_job(avs_sched_t *sched,
+                                         const void *conn_ptr) {
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    ANJAY_SCHED_JOB_STATS_BEGIN(job_start_time);
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_OBSERVE);
+    anjay_observe_connection_entry_t *conn =
+            *(anjay_observe_connection_entry_t *const *) conn_ptr;
+    assert(conn);
+    const avs_time_monotonic_t now = avs_time_monotonic_now();
+    bool any_due = false;
+    AVS_SORTED_SET_ELEM(anjay_observation_t) observation;
+    AVS_SORTED_SET_FOREACH(observation, conn->observations) {
+        observation->trigger_due =
+                avs_time_monotonic_valid(observation->trigger_deadline)
+                && !avs_time_monotonic_before(now,
+                                              observation->trigger_deadline);
+        if (observation->trigger_due) {
+            observation->trigger_deadline = AVS_TIME_MONOTONIC_INVALID;
+            observation->next_pmax_trigger = AVS_TIME_REAL_INVALID;
+            any_due = true;
+        }
+    }
+    if (!any_due || handle_triggers(conn, NULL)) {
+        if (reschedule_conn_trigger_task(conn)) {
+            anjay_log(ERROR, _("Could not reschedule automatic notification "
+                               "triggers"));
+        }
+    }
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+    ANJAY_SCHED_JOB_STATS_END(anjay, ANJAY_SCHED_JOB_OBSERVE_TRIGGER,
+                              job_start_time);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
 
+#    ifdef ANJAY_WITH_SCHED_STATS
+void _anjay_observe_collect_sched_jobs(
+        anjay_unlocked_t *anjay, anjay_sched_jobs_collector_t *collector) {
+    AVS_LIST(anjay_observe_connection_entry_t) conn;
+    AVS_LIST_FOREACH(conn, anjay->observe.connection_entries) {
+        anjay_ssid_t ssid = _anjay_server_ssid(conn->conn_ref.server);
+        _anjay_sched_jobs_collect(collector, ANJAY_SCHED_JOB_OBSERVE_TRIGGER,
+                                  ssid, &conn->trigger_task);
+        AVS_SORTED_SET_ELEM(anjay_observation_t) observation;
+        AVS_SORTED_SET_FOREACH(observation, conn->observations) {
+            _anjay_sched_jobs_collect(collector,
+                                      ANJAY_SCHED_JOB_OBSERVE_TRIGGER, ssid,
+                                      &observation->notify_task);
+        }
+    }
+}
+#    endif // ANJAY_WITH_SCHED_STATS
+
 static anjay_dm_oi_attributes_t
 get_oi_attributes(anjay_observe_connection_entry_t *connection,
                   anjay_observe_path_entry_t *path_entry) {
+    anjay_unlocked_t *anjay = _anjay_from_server(connection->conn_ref.server);
+    anjay_ssid_t ssid = _anjay_server_ssid(connection->conn_ref.server);
     anjay_dm_r_attributes_t attrs = ANJAY_DM_R_ATTRIBUTES_EMPTY;
-    if (get_effective_attrs(_anjay_from_server(connection->conn_ref.server),
-                            &attrs, &path_entry->path,
-                            _anjay_server_ssid(connection->conn_ref.server))) {
+    // all observations including this path share its attributes, so the
+    // memoized copy of any of them can be used
+    anjay_observation_t *observation =
+            path_entry->refs ? *path_entry->refs : NULL;
+    size_t i = 0;
+    while (observation && i < observation->paths_count
+           && !_anjay_uri_path_equal(&observation->paths[i],
+                                     &path_entry->path)) {
+        ++i;
+    }
+    int result =
+            (observation && i < observation->paths_count)
+                    ? get_observation_attrs(anjay, &attrs, observation, i, ssid)
+                    : get_effective_attrs(anjay, &attrs, &path_entry->path,
+                                          ssid);
+    if (result) {
         return ANJAY_DM_OI_ATTRIBUTES_EMPTY;
     }
     return attrs.common;
@@ -1921,6 +3306,18 @@ static int notify_path_changed(anjay_observe_connection_entry_t *connection,
     return 0;
 }
 
+static int mark_values_stale(anjay_observe_connection_entry_t *connection,
+                             anjay_observe_path_entry_t *path_entry,
+                             void *arg) {
+    (void) connection;
+    (void) arg;
+    AVS_LIST(AVS_SORTED_SET_ELEM(anjay_observation_t)) ref;
+    AVS_LIST_FOREACH(ref, path_entry->refs) {
+        (*ref)->values_fresh = false;
+    }
+    return 0;
+}
+
 typedef int
 observe_for_each_matching_clb_t(anjay_observe_connection_entry_t *connection,
                                 anjay_observe_path_entry_t *path_entry,
@@ -2035,23 +3432,115 @@ finish:
     return retval == ANJAY_FOREACH_BREAK ? 0 : retval;
 }
 
+typedef struct {
+    const anjay_uri_path_t *path;
+    anjay_ssid_t ssid;
+    bool invert_server_match;
+    observe_for_each_matching_clb_t *clb;
+    void *clb_arg;
+    unsigned visit;
+} observe_for_each_matching_connection_args_t;
+
+static void visit_indexed_connections(
+        const anjay_observe_path_index_entry_t *index_entry,
+        const observe_for_each_matching_connection_args_t *args) {
+    AVS_LIST(anjay_observe_connection_entry_t *) it;
+    AVS_LIST_FOREACH(it, index_entry->connections) {
+        anjay_observe_connection_entry_t *connection = *it;
+        // the connection might observe more than one matching path
+        if (connection->index_visit == args->visit) {
+            continue;
+        }
+        connection->index_visit = args->visit;
+        /* Some compilers complain about promotion of comparison result, so
+         * we're casting it to bool explicitly */
+        if ((bool) (_anjay_server_ssid(connection->conn_ref.server)
+                    == args->ssid)
+                == args->invert_server_match) {
+            continue;
+        }
+        observe_for_each_matching(connection, args->path, args->clb,
+                                  args->clb_arg);
+    }
+}
+
+/**
+ * Calls observe_for_each_matching() for <c>path</c> on each connection entry
+ * of a server whose SSID is <c>ssid</c> (or, if <c>invert_server_match</c> is
+ * true, is not <c>ssid</c>) that has any matching Observe path entry.
+ *
+ * The lookups described for observe_for_each_matching() are first performed
+ * once on observed_paths_index, and only the connection entries found there
+ * are visited, so the cost does not depend on the number of connections that
+ * do not observe the path. <c>clb</c> must not add or remove Observe path
+ * entries.
+ */
+static void
+observe_for_each_matching_connection(anjay_observe_state_t *observe,
+                                     const anjay_uri_path_t *path,
+                                     anjay_ssid_t ssid,
+                                     bool invert_server_match,
+                                     observe_for_each_matching_clb_t *clb,
+                                     void *clb_arg) {
+    if (!observe->observed_paths_index) {
+        return;
+    }
+    if (!++observe->index_visit) {
+        // wrapped around - make sure no entry looks visited already
+        AVS_LIST(anjay_observe_connection_entry_t) connection;
+        AVS_LIST_FOREACH(connection, observe->connection_entries) {
+            connection->index_visit = 0;
+        }
+        observe->index_visit = 1;
+    }
+    const observe_for_each_matching_connection_args_t args = {
+        .path = path,
+        .ssid = ssid,
+        .invert_server_match = invert_server_match,
+        .clb = clb,
+        .clb_arg = clb_arg,
+        .visit = observe->index_visit
+    };
+
+    size_t path_length = _anjay_uri_path_length(path);
+    for (size_t i = 0; i < path_length; ++i) {
+        anjay_uri_path_t parent = *path;
+        for (size_t j = i; j < _ANJAY_URI_PATH_MAX_LENGTH; ++j) {
+            parent.ids[j] = ANJAY_ID_INVALID;
+        }
+        AVS_SORTED_SET_ELEM(anjay_observe_path_index_entry_t) entry =
+                AVS_SORTED_SET_FIND(observe->observed_paths_index,
+                                    path_index_entry_query(&parent));
+        if (entry) {
+            visit_indexed_connections(entry, &args);
+        }
+    }
+
+    anjay_uri_path_t lower_bound = *path;
+    anjay_uri_path_t upper_bound = *path;
+    for (size_t i = path_length; i < _ANJAY_URI_PATH_MAX_LENGTH; ++i) {
+        lower_bound.ids[i] = 0;
+        upper_bound.ids[i] = ANJAY_ID_INVALID;
+    }
+    AVS_SORTED_SET_ELEM(anjay_observe_path_index_entry_t) it =
+            AVS_SORTED_SET_LOWER_BOUND(observe->observed_paths_index,
+                                       path_index_entry_query(&lower_bound));
+    AVS_SORTED_SET_ELEM(anjay_observe_path_index_entry_t) end =
+            AVS_SORTED_SET_UPPER_BOUND(observe->observed_paths_index,
+                                       path_index_entry_query(&upper_bound));
+    for (; it != end; it = AVS_SORTED_SET_ELEM_NEXT(it)) {
+        visit_indexed_connections(it, &args);
+    }
+}
+
 static int observe_notify_impl(anjay_unlocked_t *anjay,
                                const anjay_uri_path_t *path,
                                anjay_ssid_t ssid,
                                bool invert_server_match,
                                observe_for_each_matching_clb_t *clb) {
-    // iterate through all SSIDs we have
     int result = 0;
-    AVS_LIST(anjay_observe_connection_entry_t) connection;
-    AVS_LIST_FOREACH(connection, anjay->observe.connection_entries) {
-        /* Some compilers complain about promotion of comparison result, so
-         * we're casting it to bool explicitly */
-        if ((bool) (_anjay_server_ssid(connection->conn_ref.server) == ssid)
-                == invert_server_match) {
-            continue;
-        }
-        observe_for_each_matching(connection, path, clb, &result);
-    }
+    observe_for_each_matching_connection(&anjay->observe, path, ssid,
+                                         invert_server_match, clb, &result);
     return result;
 }
 
@@ -2062,11 +3551,402 @@ int _anjay_observe_notify(anjay_unlocked_t *anjay,
     // This extra level of indirection is required to be able to mock
     // notify_path_changed in unit tests.
     // Hopefully compilers will inline it in production builds.
-    return observe_notify_impl(anjay, path, ssid, invert_ssid_match,
-                               notify_path_changed);
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_OBSERVE);
+    if (anjay->observe.notify_driven_oids) {
+        // observations of the originating server are not notified, but their
+        // values are outdated nevertheless; no server has ANJAY_SSID_ANY, so
+        // all of them are matched
+        observe_for_each_matching_connection(&anjay->observe, path,
+                                             ANJAY_SSID_ANY, true,
+                                             mark_values_stale, NULL);
+    }
+    int result = observe_notify_impl(anjay, path, ssid, invert_ssid_match,
+                                     notify_path_changed);
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+    return result;
+}
+
+#    ifdef ANJAY_WITH_OBSERVE_PERSISTENCE
+static const char OBSERVE_PERSISTENCE_MAGIC[] = "OBS";
+
+static const uint8_t OBSERVE_PERSISTENCE_VERSIONS[] = { 0 };
+
+static avs_error_t persist_uri_path(avs_persistence_context_t *ctx,
+                                    anjay_uri_path_t *path) {
+    avs_error_t err = AVS_OK;
+    for (size_t i = 0; avs_is_ok(err) && i < AVS_ARRAY_SIZE(path->ids); ++i) {
+        err = avs_persistence_u16(ctx, &path->ids[i]);
+    }
+    return err;
+}
+
+static avs_error_t restored_entry_persistence_handler(
+        avs_persistence_context_t *ctx, anjay_observe_restored_t *entry) {
+    uint8_t conn_type = (uint8_t) entry->conn_type;
+    uint8_t token_size = (uint8_t) entry->token.size;
+    uint8_t action = (uint8_t) entry->action;
+    int64_t seconds = entry->timestamp.since_real_epoch.seconds;
+    int32_t nanoseconds = entry->timestamp.since_real_epoch.nanoseconds;
+    uint32_t paths_count = (uint32_t) entry->paths_count;
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_persistence_u16(ctx, &entry->ssid)))
+            || avs_is_err((err = avs_persistence_u8(ctx, &conn_type)))
+            || avs_is_err((err = avs_persistence_u8(ctx, &token_size)))
+            || avs_is_err((err = (token_size <= sizeof(entry->token.bytes)
+                                          ? AVS_OK
+                                          : avs_errno(AVS_EBADMSG))))
+            || avs_is_err((err = avs_persistence_bytes(ctx, entry->token.bytes,
+                                                       token_size)))
+            || avs_is_err((err = avs_persistence_u8(ctx, &action)))
+            || avs_is_err((err = avs_persistence_u8(ctx, &entry->msg_code)))
+            || avs_is_err((err = avs_persistence_u16(ctx, &entry->format)))
+            || avs_is_err((err = avs_persistence_i64(ctx, &seconds)))
+            || avs_is_err((err = avs_persistence_i32(ctx, &nanoseconds)))
+            || avs_is_err((err = avs_persistence_u32(ctx, &paths_count))));
+    if (avs_is_ok(err)
+            && avs_persistence_direction(ctx) == AVS_PERSISTENCE_RESTORE) {
+        entry->conn_type = (anjay_connection_type_t) conn_type;
+        entry->token.size = token_size;
+        entry->action = (anjay_request_action_t) action;
+        entry->timestamp.since_real_epoch.seconds = seconds;
+        entry->timestamp.since_real_epoch.nanoseconds = nanoseconds;
+        entry->paths_count = paths_count;
+        if (entry->conn_type >= ANJAY_CONNECTION_LIMIT_ || !paths_count
+                || (entry->action != ANJAY_ACTION_READ
+                    && entry->action != ANJAY_ACTION_READ_COMPOSITE)
+                || !avs_time_real_valid(entry->timestamp)) {
+            err = avs_errno(AVS_EBADMSG);
+        } else if (!(entry->paths = (anjay_uri_path_t *) avs_calloc(
+                             paths_count, sizeof(anjay_uri_path_t)))) {
+            _anjay_log_oom();
+            err = avs_errno(AVS_ENOMEM);
+        }
+    }
+    for (size_t i = 0; avs_is_ok(err) && i < entry->paths_count; ++i) {
+        err = persist_uri_path(ctx, &entry->paths[i]);
+    }
+    if (avs_is_ok(err)) {
+        err = avs_persistence_sized_buffer(ctx, &entry->coap_state,
+                                           &entry->coap_state_size);
+    }
+    return err;
+}
+
+static avs_error_t persist_coap_observe_state(avs_coap_ctx_t *coap,
+                                              const avs_coap_token_t *token,
+                                              void **out_data,
+                                              size_t *out_size) {
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    if (!membuf) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    avs_persistence_context_t ctx =
+            avs_persistence_store_context_create(membuf);
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_coap_observe_persist(
+                                coap,
+                                (avs_coap_observe_id_t) {
+                                    .token = *token
+                                },
+                                &ctx)))
+            || avs_is_err((err = avs_stream_membuf_take_ownership(
+                                   membuf, out_data, out_size))));
+    avs_stream_cleanup(&membuf);
+    return err;
+}
+
+static avs_error_t
+snapshot_observation(AVS_LIST(anjay_observe_restored_t) **tail_ptr_ptr,
+                     anjay_observe_connection_entry_t *conn,
+                     avs_coap_ctx_t *coap,
+                     const anjay_observation_t *observation) {
+    if (!observation->last_sent || is_error_value(observation->last_sent)) {
+        return AVS_OK;
+    }
+    AVS_LIST(anjay_observe_restored_t) entry =
+            AVS_LIST_NEW_ELEMENT(anjay_observe_restored_t);
+    const size_t paths_size =
+            observation->paths_count * sizeof(anjay_uri_path_t);
+    if (!entry
+            || !(entry->paths = (anjay_uri_path_t *) avs_malloc(paths_size))) {
+        _anjay_log_oom();
+        AVS_LIST_CLEAR(&entry);
+        return avs_errno(AVS_ENOMEM);
+    }
+    entry->ssid = _anjay_server_ssid(conn->conn_ref.server);
+    entry->conn_type = conn->conn_ref.conn_type;
+    entry->token = observation->token;
+    entry->action = observation->action;
+    entry->msg_code = observation->last_sent->details.msg_code;
+    entry->format = observation->last_sent->details.format;
+    entry->timestamp = observation->last_sent->timestamp;
+    entry->paths_count = observation->paths_count;
+    memcpy(entry->paths, observation->paths, paths_size);
+    avs_error_t err =
+            persist_coap_observe_state(coap, &observation->token,
+                                       &entry->coap_state,
+                                       &entry->coap_state_size);
+    if (avs_is_err(err)) {
+        restored_entry_cleanup(entry);
+        AVS_LIST_DELETE(&entry);
+        if (err.category == AVS_ERRNO_CATEGORY && err.code == AVS_EINVAL) {
+            // not known to avs_coap, e.g. cancelled in the meantime
+            return AVS_OK;
+        }
+        return err;
+    }
+    AVS_LIST_INSERT(*tail_ptr_ptr, entry);
+    AVS_LIST_ADVANCE_PTR(tail_ptr_ptr);
+    return AVS_OK;
+}
+
+static avs_error_t
+snapshot_observations(anjay_unlocked_t *anjay,
+                      AVS_LIST(anjay_observe_restored_t) *out_entries) {
+    AVS_LIST(anjay_observe_restored_t) *tail_ptr = out_entries;
+    AVS_LIST(anjay_observe_connection_entry_t) conn;
+    AVS_LIST_FOREACH(conn, anjay->observe.connection_entries) {
+        avs_coap_ctx_t *coap = _anjay_connection_get_coap(conn->conn_ref);
+        if (!coap) {
+            continue;
+        }
+        AVS_SORTED_SET_ELEM(anjay_observation_t) observation;
+        AVS_SORTED_SET_FOREACH(observation, conn->observations) {
+            avs_error_t err =
+                    snapshot_observation(&tail_ptr, conn, coap, observation);
+            if (avs_is_err(err)) {
+                return err;
+            }
+        }
+    }
+    return AVS_OK;
+}
+
+avs_error_t anjay_observe_persist(anjay_t *anjay_locked,
+                                  avs_stream_t *out_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_observe_restored_t) entries = NULL;
+    if (avs_is_ok((err = snapshot_observations(anjay, &entries)))) {
+        avs_persistence_context_t ctx =
+                avs_persistence_store_context_create(out_stream);
+        uint8_t version = 0;
+        // observations restored earlier, but not applied yet, are kept
+        uint32_t count = (uint32_t) (AVS_LIST_SIZE(entries)
+                                     + AVS_LIST_SIZE(anjay->observe.restored));
+        (void) (avs_is_err((err = avs_persistence_magic_string(
+                                    &ctx, OBSERVE_PERSISTENCE_MAGIC)))
+                || avs_is_err((err = avs_persistence_version(
+                                       &ctx, &version,
+                                       OBSERVE_PERSISTENCE_VERSIONS,
+                                       sizeof(OBSERVE_PERSISTENCE_VERSIONS))))
+                || avs_is_err((err = avs_persistence_u32(&ctx, &count))));
+        AVS_LIST(anjay_observe_restored_t) entry;
+        AVS_LIST_FOREACH(entry, entries) {
+            if (avs_is_err(err)) {
+                break;
+            }
+            err = restored_entry_persistence_handler(&ctx, entry);
+        }
+        AVS_LIST_FOREACH(entry, anjay->observe.restored) {
+            if (avs_is_err(err)) {
+                break;
+            }
+            err = restored_entry_persistence_handler(&ctx, entry);
+        }
+    }
+    AVS_LIST_CLEAR(&entries) {
+        restored_entry_cleanup(entries);
+    }
+    if (avs_is_ok(err)) {
+        anjay_log(INFO, _("Observations state persisted"));
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+static avs_error_t
+read_restored_entries(avs_stream_t *in_stream,
+                      AVS_LIST(anjay_observe_restored_t) *out_entries) {
+    avs_persistence_context_t ctx =
+            avs_persistence_restore_context_create(in_stream);
+    uint8_t version;
+    uint32_t count;
+    avs_error_t err;
+    if (avs_is_err((err = avs_persistence_magic_string(
+                            &ctx, OBSERVE_PERSISTENCE_MAGIC)))
+            || avs_is_err((err = avs_persistence_version(
+                                   &ctx, &version,
+                                   OBSERVE_PERSISTENCE_VERSIONS,
+                                   sizeof(OBSERVE_PERSISTENCE_VERSIONS))))
+            || avs_is_err((err = avs_persistence_u32(&ctx, &count)))) {
+        return err;
+    }
+    AVS_LIST(anjay_observe_restored_t) *tail_ptr = out_entries;
+    for (uint32_t i = 0; i < count; ++i) {
+        AVS_LIST(anjay_observe_restored_t) entry =
+                AVS_LIST_NEW_ELEMENT(anjay_observe_restored_t);
+        if (!entry) {
+            _anjay_log_oom();
+            return avs_errno(AVS_ENOMEM);
+        }
+        AVS_LIST_INSERT(tail_ptr, entry);
+        AVS_LIST_ADVANCE_PTR(&tail_ptr);
+        if (avs_is_err((err = restored_entry_persistence_handler(&ctx,
+                                                                 entry)))) {
+            return err;
+        }
+    }
+    return AVS_OK;
+}
+
+avs_error_t anjay_observe_restore(anjay_t *anjay_locked,
+                                  avs_stream_t *in_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_observe_restored_t) entries = NULL;
+    if (avs_is_ok((err = read_restored_entries(in_stream, &entries)))) {
+        AVS_LIST_CLEAR(&anjay->observe.restored) {
+            restored_entry_cleanup(anjay->observe.restored);
+        }
+        anjay->observe.restored = entries;
+        entries = NULL;
+        anjay_log(INFO, _("Observations state restored"));
+#        ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+        anjay->startup_timestamps.last_state_restored =
+                avs_time_monotonic_now();
+#        endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+    }
+    AVS_LIST_CLEAR(&entries) {
+        restored_entry_cleanup(entries);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+static int restore_coap_observe(anjay_connection_ref_t ref,
+                                avs_coap_ctx_t *coap,
+                                const anjay_observe_restored_t *entry) {
+    anjay_connection_ref_t *heap_conn = (anjay_connection_ref_t *) avs_malloc(
+            sizeof(anjay_connection_ref_t));
+    if (!heap_conn) {
+        _anjay_log_oom();
+        return -1;
+    }
+    *heap_conn = ref;
+    avs_stream_inbuf_t inbuf = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&inbuf, entry->coap_state,
+                                entry->coap_state_size);
+    avs_persistence_context_t ctx =
+            avs_persistence_restore_context_create((avs_stream_t *) &inbuf);
+    avs_coap_observe_id_t id;
+    if (avs_is_err(avs_coap_observe_restore_with_id(
+                coap, _anjay_observe_cancel_handler, heap_conn, &id, &ctx))) {
+        avs_free(heap_conn);
+        return -1;
+    }
+    if (!avs_coap_token_equal(&id.token, &entry->token)) {
+        // this calls _anjay_observe_cancel_handler(), which frees heap_conn
+        avs_coap_observe_cancel(coap, id);
+        return -1;
+    }
+    return 0;
+}
+
+static int restore_observation(anjay_connection_ref_t ref,
+                               avs_coap_ctx_t *coap,
+                               const anjay_observe_restored_t *entry) {
+    AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr =
+            find_or_create_connection_state(ref);
+    if (!conn_ptr) {
+        return -1;
+    }
+    if (AVS_SORTED_SET_FIND((*conn_ptr)->observations,
+                            _anjay_observation_query(&entry->token))) {
+        return -1;
+    }
+
+    const paths_arg_t paths = {
+        .type = PATHS_POINTER_ARRAY,
+        .paths = entry->paths,
+        .count = entry->paths_count
+    };
+    const anjay_msg_details_t details = {
+        .msg_code = entry->msg_code,
+        .format = entry->format
+    };
+    const avs_time_real_t now = avs_time_real_now();
+    AVS_SORTED_SET_ELEM(anjay_observation_t) observation = NULL;
+    anjay_batch_t **batches = NULL;
+    // The values the server has last seen are not stored, so the current ones
+    // are treated as such. The original timestamp is kept, so that pmax
+    // elapses as if the observation has never been interrupted.
+    int result = read_observation_values(_anjay_from_server(ref.server), &paths,
+                                         entry->action,
+                                         _anjay_server_ssid(ref.server), &now,
+                                         &batches);
+    if (!result) {
+        if (!(observation = create_detached_observation(
+                      (*conn_ptr)->observe, &entry->token, entry->action,
+                      &paths))) {
+            result = -1;
+        } else if ((result = attach_new_observation(*conn_ptr, observation))) {
+            clear_observation(*conn_ptr, observation);
+            release_observation_paths((*conn_ptr)->observe, observation);
+            AVS_SORTED_SET_ELEM_DELETE_DETACHED(&observation);
+        } else if ((result = insert_initial_value(
+                            *conn_ptr, observation, &details,
+                            &entry->timestamp,
+                            cast_to_const_batch_array(batches)))
+                   || (result = restore_coap_observe(ref, coap, entry))) {
+            observe_remove_entry(ref, &entry->token);
+        }
+    }
+    delete_batch_array(_anjay_from_server(ref.server), &batches, paths.count);
+    if (*conn_ptr) {
+        delete_connection_if_empty(conn_ptr);
+    }
+    return result;
+}
+
+void _anjay_observe_apply_restored(anjay_connection_ref_t ref,
+                                   bool session_resumed) {
+    anjay_unlocked_t *anjay = _anjay_from_server(ref.server);
+    avs_coap_ctx_t *coap = _anjay_connection_get_coap(ref);
+    anjay_ssid_t ssid = _anjay_server_ssid(ref.server);
+    AVS_LIST(anjay_observe_restored_t) *entry_ptr;
+    AVS_LIST(anjay_observe_restored_t) helper;
+    AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, helper,
+                                   &anjay->observe.restored) {
+        if ((*entry_ptr)->ssid != ssid
+                || (*entry_ptr)->conn_type != ref.conn_type) {
+            continue;
+        }
+        if (session_resumed && coap
+                && restore_observation(ref, coap, *entry_ptr)) {
+            anjay_log(WARNING,
+                      _("Could not restore observation for token ") "%s",
+                      ANJAY_TOKEN_TO_STRING((*entry_ptr)->token));
+        }
+        restored_entry_cleanup(*entry_ptr);
+        AVS_LIST_DELETE(entry_ptr);
+    }
 }
+#    endif // ANJAY_WITH_OBSERVE_PERSISTENCE
 
 #    ifdef ANJAY_WITH_OBSERVATION_STATUS
+static void add_counters(anjay_observation_counters_t *sum,
+                         const anjay_observation_counters_t *counters) {
+    sum->notifications_sent += counters->notifications_sent;
+    sum->pmin_postponed += counters->pmin_postponed;
+    sum->criteria_suppressed += counters->criteria_suppressed;
+    sum->queue_dropped += counters->queue_dropped;
+    sum->retransmissions += counters->retransmissions;
+}
+
 static int get_observe_status(anjay_observe_connection_entry_t *connection,
                               anjay_observe_path_entry_t *entry,
                               void *out_status_) {
@@ -2091,6 +3971,10 @@ static int get_observe_status(anjay_observe_connection_entry_t *connection,
                 _anjay_server_ssid(connection->conn_ref.server);
     }
 #        endif //(ANJAY_MAX_OBSERVATION_SERVERS_REPORTED_NUMBER > 0)
+    AVS_LIST(AVS_SORTED_SET_ELEM(anjay_observation_t)) ref;
+    AVS_LIST_FOREACH(ref, entry->refs) {
+        add_counters(&out_status->counters, &(*ref)->counters);
+    }
     return 0;
 }
 
@@ -2108,17 +3992,39 @@ _anjay_observe_status(anjay_unlocked_t *anjay,
         .min_period = ANJAY_ATTRIB_INTEGER_NONE,
         .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
     };
+    // no server has ANJAY_SSID_ANY, so all of them are matched
+    observe_for_each_matching_connection(&anjay->observe,
+                                         &MAKE_RESOURCE_PATH(oid, iid, rid),
+                                         ANJAY_SSID_ANY, true,
+                                         get_observe_status, &result);
+    result.min_period = AVS_MAX(result.min_period, 0);
+
+    return result;
+}
+
+anjay_server_observation_stats_t
+_anjay_observe_server_stats(anjay_unlocked_t *anjay, anjay_ssid_t ssid) {
+    anjay_server_observation_stats_t result = {
+        .observation_count = 0,
+        .queue_depth = 0,
+        .next_trigger = AVS_TIME_REAL_INVALID
+    };
     AVS_LIST(anjay_observe_connection_entry_t) connection;
     AVS_LIST_FOREACH(connection, anjay->observe.connection_entries) {
-        int retval =
-                observe_for_each_matching(connection,
-                                          &MAKE_RESOURCE_PATH(oid, iid, rid),
-                                          get_observe_status, &result);
-        assert(!retval);
-        (void) retval;
+        if (_anjay_server_ssid(connection->conn_ref.server) != ssid) {
+            continue;
+        }
+        result.observation_count +=
+                AVS_SORTED_SET_SIZE(connection->observations);
+        add_counters(&result.counters, &connection->counters);
+        result.queue_depth += AVS_LIST_SIZE(connection->unsent);
+        if (avs_time_real_valid(connection->next_trigger)
+                && (!avs_time_real_valid(result.next_trigger)
+                    || avs_time_real_before(connection->next_trigger,
+                                            result.next_trigger))) {
+            result.next_trigger = connection->next_trigger;
+        }
     }
-    result.min_period = AVS_MAX(result.min_period, 0);
-
     return result;
 }
 #    endif // ANJAY_WITH_OBSERVATION_STATUS
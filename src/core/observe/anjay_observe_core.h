@@ -28,12 +28,150 @@ typedef enum {
     NOTIFY_QUEUE_DROP_OLDEST
 } notify_queue_limit_mode_t;
 
+typedef struct {
+    const anjay_uri_path_t path;
+
+    // Connection entries whose observed_paths contain "path"
+    AVS_LIST(anjay_observe_connection_entry_t *) connections;
+} anjay_observe_path_index_entry_t;
+
+typedef struct {
+    anjay_uri_path_t path;
+    anjay_request_action_t action;
+    // ANJAY_SSID_ANY if the value does not depend on Access Control
+    anjay_ssid_t ssid;
+    anjay_batch_t *batch;
+} anjay_observe_sample_t;
+
+typedef struct {
+    // ANJAY_SSID_ANY if the values do not depend on Access Control
+    anjay_ssid_t ssid;
+    // values[i] corresponds to paths[i] of the path set, NULL if not sampled
+    anjay_batch_t *values[];
+} anjay_observe_path_set_sample_t;
+
+/**
+ * List of paths of an Observe-Composite observation, shared by all
+ * observations (on any connection) created for an identical list of paths.
+ */
+typedef struct {
+    size_t refcount;
+    /**
+     * Values sampled during the current scheduler iteration, if
+     * share_samples is enabled. Cleared along with
+     * anjay_observe_state_t::samples.
+     */
+    AVS_LIST(anjay_observe_path_set_sample_t) samples;
+    size_t paths_count;
+    anjay_uri_path_t paths[];
+} anjay_observe_path_set_t;
+
+/**
+ * Notification priority assigned to a path with
+ * anjay_set_notification_priority().
+ */
+typedef struct {
+    anjay_uri_path_t path;
+    uint8_t priority;
+} anjay_observe_priority_entry_t;
+
+#ifdef ANJAY_WITH_OBSERVE_PERSISTENCE
+/**
+ * Observation read by anjay_observe_restore(), waiting for the connection it
+ * belongs to to be brought online.
+ */
+typedef struct {
+    anjay_ssid_t ssid;
+    anjay_connection_type_t conn_type;
+    avs_coap_token_t token;
+    anjay_request_action_t action;
+    // details and timestamp of the last value sent to the server
+    uint8_t msg_code;
+    uint16_t format;
+    avs_time_real_t timestamp;
+    size_t paths_count;
+    anjay_uri_path_t *paths;
+    // state of the observation in avs_coap, as stored by
+    // avs_coap_observe_persist()
+    void *coap_state;
+    size_t coap_state_size;
+} anjay_observe_restored_t;
+#endif // ANJAY_WITH_OBSERVE_PERSISTENCE
+
 typedef struct {
     AVS_LIST(anjay_observe_connection_entry_t) connection_entries;
+
+    /**
+     * Union of observed_paths sets of all connection entries, mapping each
+     * path to the connection entries observing it. It allows
+     * _anjay_observe_notify and _anjay_observe_status to only look into the
+     * connection entries that observe the path in question. Lazily created
+     * when the first path is observed.
+     */
+    AVS_SORTED_SET(anjay_observe_path_index_entry_t) observed_paths_index;
+    // incremented on each lookup in observed_paths_index, see
+    // anjay_observe_connection_entry_t::index_visit
+    unsigned index_visit;
+
+    /**
+     * Connection entries with the earliest next_trigger and next_pmax_trigger
+     * values, respectively, or NULL if no connection has any trigger planned.
+     * Updated whenever the trigger times of any connection entry change, so
+     * that the queries in anjay_observe_planning.c can usually be answered
+     * without walking all the connections.
+     */
+    anjay_observe_connection_entry_t *earliest_trigger_conn;
+    anjay_observe_connection_entry_t *earliest_pmax_trigger_conn;
+    // total number of values in the unsent queues of all connection entries
+    size_t unsent_count;
+
     bool confirmable_notifications;
 
     notify_queue_limit_mode_t notify_queue_limit_mode;
     size_t notify_queue_limit;
+    // 0 if unlimited
+    size_t notify_queue_memory_limit;
+
+    bool share_samples;
+    /**
+     * Values sampled during the current scheduler iteration, if
+     * share_samples is enabled. Cleared by a job scheduled to run right after
+     * all the currently due ones, and at the end of each anjay_serve() call.
+     */
+    AVS_LIST(anjay_observe_sample_t) samples;
+    avs_sched_handle_t samples_cleanup_handle;
+
+    // path sets of all Observe-Composite observations
+    AVS_LIST(anjay_observe_path_set_t) path_sets;
+
+    /**
+     * If set, automatic notification triggers are handled by a single
+     * trigger_task per connection entry instead of each observation's
+     * notify_task. Each trigger may then be delayed by up to trigger_slack.
+     */
+    bool coalesce_triggers;
+    avs_time_duration_t trigger_slack;
+
+    // if set, only the newest unsent value of each observation is kept
+    bool merge_unsent;
+    // maximum number of notifications sent by a single flush_task run
+    size_t flush_burst;
+    // if set, each notification payload is serialized in full up front
+    bool cache_payload;
+    // if set, effective attributes are memoized in each observation
+    bool cache_attrs;
+    // Objects marked with anjay_set_notify_driven()
+    AVS_LIST(anjay_oid_t) notify_driven_oids;
+    /**
+     * Paths with non-default priorities. If any are set, queued values are
+     * evicted in the order of priority of their observations, superseded
+     * values first, instead of strictly by age.
+     */
+    AVS_LIST(anjay_observe_priority_entry_t) priorities;
+
+#ifdef ANJAY_WITH_OBSERVE_PERSISTENCE
+    AVS_LIST(anjay_observe_restored_t) restored;
+#endif // ANJAY_WITH_OBSERVE_PERSISTENCE
 } anjay_observe_state_t;
 
 typedef struct {
@@ -41,6 +179,8 @@ typedef struct {
     anjay_msg_details_t details;
     avs_coap_notify_reliability_hint_t reliability_hint;
     avs_time_real_t timestamp;
+    // estimated memory usage, including all the values
+    size_t memory_size;
 
     // Array size is ref->paths_count for "normal" entry, or 0 for error entry
     // (determined based on is_error_value()). values[i] is a value
@@ -50,15 +190,41 @@ typedef struct {
     anjay_batch_t *values[];
 } anjay_observation_value_t;
 
+/**
+ * Returns the time of the earliest notification trigger planned on the primary
+ * connection of server @p ssid (or any server, if ANJAY_SSID_ANY is passed),
+ * like anjay_next_planned_notify_trigger() or, if @p pmax_only is true,
+ * anjay_next_planned_pmax_notify_trigger().
+ */
+avs_time_real_t _anjay_observe_next_planned_trigger(anjay_unlocked_t *anjay,
+                                                    anjay_ssid_t ssid,
+                                                    bool pmax_only);
+
 #ifdef ANJAY_WITH_OBSERVE
 
 void _anjay_observe_init(anjay_observe_state_t *observe,
                          bool confirmable_notifications,
-                         size_t stored_notification_limit);
+                         size_t stored_notification_limit,
+                         size_t stored_notification_memory_limit,
+                         bool share_samples,
+                         bool coalesce_triggers,
+                         avs_time_duration_t trigger_slack,
+                         bool merge_unsent,
+                         size_t flush_burst,
+                         bool cache_payload,
+                         bool cache_attrs);
 
 void _anjay_observe_cleanup(anjay_observe_state_t *observe);
 
-void _anjay_observe_gc(anjay_unlocked_t *anjay);
+/**
+ * Removes all observation entries of @p server . Shall be called whenever a
+ * server entry is about to be removed, while it is still valid.
+ */
+void _anjay_observe_server_removed(anjay_server_info_t *server);
+
+void _anjay_observe_queue_usage(const anjay_observe_state_t *observe,
+                                size_t *out_count,
+                                size_t *out_bytes);
 
 int _anjay_observe_handle(anjay_connection_ref_t ref,
                           const anjay_request_t *request);
@@ -77,6 +243,12 @@ void _anjay_observe_invalidate(anjay_connection_ref_t ref);
 
 bool _anjay_observe_confirmable_in_delivery(anjay_connection_ref_t ref);
 
+/**
+ * Checks whether a confirmable notification is being delivered over any of the
+ * connections.
+ */
+bool _anjay_observe_any_confirmable_in_delivery(anjay_unlocked_t *anjay);
+
 #    ifndef ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
 bool _anjay_observe_needs_flushing(anjay_connection_ref_t ref);
 #    endif // ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
@@ -88,24 +260,80 @@ int _anjay_observe_notify(anjay_unlocked_t *anjay,
                           anjay_ssid_t ssid,
                           bool invert_ssid_match);
 
+/**
+ * Drops the shared values sampled for paths within Object @p oid (and for the
+ * root path). Called whenever the data model is known to change.
+ */
+void _anjay_observe_drop_samples(anjay_unlocked_t *anjay, anjay_oid_t oid);
+
+/**
+ * Drops all the shared values sampled so far. Called after handling each
+ * incoming packet, as the data model may have been changed by it.
+ */
+void _anjay_observe_clear_samples(anjay_unlocked_t *anjay);
+
+/**
+ * Drops the effective attributes memoized by the observations of paths within
+ * Object @p oid. If @p oid is the Server Object or ANJAY_ID_INVALID, the
+ * attributes of all observations are dropped. Called whenever attributes
+ * might have changed.
+ */
+void _anjay_observe_invalidate_attrs(anjay_unlocked_t *anjay, anjay_oid_t oid);
+
+/**
+ * Marks Object @p oid as notify-driven (see anjay_set_notify_driven()), or
+ * removes the mark if @p enabled is false.
+ */
+int _anjay_observe_set_notify_driven(anjay_unlocked_t *anjay,
+                                     anjay_oid_t oid,
+                                     bool enabled);
+
+/**
+ * Sets the notification priority of @p path to @p priority (see
+ * anjay_set_notification_priority()) and updates the priorities of existing
+ * observations.
+ */
+int _anjay_observe_set_priority(anjay_unlocked_t *anjay,
+                                const anjay_uri_path_t *path,
+                                uint8_t priority);
+
+#    ifdef ANJAY_WITH_OBSERVE_PERSISTENCE
+/**
+ * Recreates the observations restored by anjay_observe_restore() that belong
+ * to connection @p ref, whose CoAP context has no socket assigned yet. The
+ * pending entries are dropped without being restored if @p session_resumed is
+ * false, as the observations do not survive a new (D)TLS session.
+ */
+void _anjay_observe_apply_restored(anjay_connection_ref_t ref,
+                                   bool session_resumed);
+#    endif // ANJAY_WITH_OBSERVE_PERSISTENCE
+
 #    ifdef ANJAY_WITH_OBSERVATION_STATUS
 anjay_resource_observation_status_t
 _anjay_observe_status(anjay_unlocked_t *anjay,
                       anjay_oid_t oid,
                       anjay_iid_t iid,
                       anjay_rid_t rid);
+
+anjay_server_observation_stats_t
+_anjay_observe_server_stats(anjay_unlocked_t *anjay, anjay_ssid_t ssid);
 #    endif // ANJAY_WITH_OBSERVATION_STATUS
 
 #else // ANJAY_WITH_OBSERVE
 
 #    define _anjay_observe_init(...) ((void) 0)
 #    define _anjay_observe_cleanup(...) ((void) 0)
-#    define _anjay_observe_gc(...) ((void) 0)
+#    define _anjay_observe_server_removed(...) ((void) 0)
 #    define _anjay_observe_interrupt(...) ((void) 0)
 #    define _anjay_observe_invalidate(...) ((void) 0)
 #    define _anjay_observe_confirmable_in_delivery(...) false
+#    define _anjay_observe_any_confirmable_in_delivery(...) false
 #    define _anjay_observe_needs_flushing(...) false
 #    define _anjay_observe_sched_flush(...) 0
+#    define _anjay_observe_drop_samples(...) ((void) 0)
+#    define _anjay_observe_clear_samples(...) ((void) 0)
+#    define _anjay_observe_invalidate_attrs(...) ((void) 0)
+#    define _anjay_observe_set_notify_driven(...) 0
 
 #    ifdef ANJAY_WITH_OBSERVATION_STATUS
 #        define _anjay_observe_status(...)         \
@@ -113,6 +341,10 @@ _anjay_observe_status(anjay_unlocked_t *anjay,
                 .is_observed = false,              \
                 .min_period = -1                   \
             })
+#        define _anjay_observe_server_stats(...)     \
+            ((anjay_server_observation_stats_t) {    \
+                .next_trigger = AVS_TIME_REAL_INVALID \
+            })
 #    endif // ANJAY_WITH_OBSERVATION_STATUS
 
 #endif // ANJAY_WITH_OBSERVE
@@ -18,12 +18,33 @@
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
+typedef struct {
+    bool valid;
+    anjay_dm_r_attributes_t attrs;
+} anjay_observe_attrs_cache_entry_t;
+
 struct anjay_observation_struct {
     const avs_coap_token_t token;
+    // NOTE: the small fields below are kept right after the token, which
+    // leaves them enough space before the first pointer-aligned field, so
+    // that they do not require any padding
+
+    // see trigger_deadline
+    bool trigger_due;
+    // set if all paths belong to notify-driven Objects and the newest value
+    // has been read from the data model after their last change, so that it
+    // may be reused instead of reading the paths again
+    bool values_fresh;
+    // highest priority of anjay_observe_state_t::priorities entries that
+    // overlap with any of the paths
+    uint8_t priority;
 
     const anjay_request_action_t action;
 
     avs_sched_handle_t notify_task;
+    // used instead of notify_task if anjay_observe_state_t::coalesce_triggers
+    // is enabled; handled by anjay_observe_connection_entry_t::trigger_task
+    avs_time_monotonic_t trigger_deadline;
     avs_time_real_t last_confirmable;
     avs_time_real_t next_pmax_trigger;
 
@@ -39,8 +60,22 @@ struct anjay_observation_struct {
     // to this resource+format or not)
     AVS_LIST(anjay_observation_value_t) last_unsent;
 
+#ifdef ANJAY_WITH_OBSERVATION_STATUS
+    anjay_observation_counters_t counters;
+#endif // ANJAY_WITH_OBSERVATION_STATUS
+
     const size_t paths_count;
-    const anjay_uri_path_t paths[];
+    // Path set shared with other observations if this is an Observe-Composite
+    // observation, NULL if the paths are stored in inline_paths.
+    anjay_observe_path_set_t *path_set;
+    // Points to either path_set->paths or inline_paths.
+    const anjay_uri_path_t *const paths;
+    const anjay_uri_path_t inline_paths[];
+    // If anjay_observe_state_t::cache_attrs is enabled, inline_paths are
+    // followed by an array of paths_count anjay_observe_attrs_cache_entry_t
+    // elements, holding the effective attributes of each of the paths,
+    // memoized by get_observation_attrs() and invalidated by
+    // _anjay_observe_invalidate_attrs(). It is not allocated otherwise.
 };
 
 typedef struct {
@@ -58,14 +93,24 @@ typedef struct {
     avs_time_real_t serialization_time;
     size_t curr_value_idx;
     const anjay_batch_data_output_state_t *output_state;
+    // whole serialized payload, if anjay_observe_state_t::cache_payload is set
+    bool payload_cached;
+    void *payload;
+    size_t payload_size;
 } anjay_observation_serialization_state_t;
 
 struct anjay_observe_connection_entry_struct {
     const anjay_connection_ref_t conn_ref;
+    anjay_observe_state_t *observe;
+    // value of anjay_observe_state_t::index_visit during the last lookup in
+    // observed_paths_index that reached this entry
+    unsigned index_visit;
 
     AVS_SORTED_SET(anjay_observation_t) observations;
     AVS_SORTED_SET(anjay_observe_path_entry_t) observed_paths;
     avs_sched_handle_t flush_task;
+    // handles trigger_deadline of all observations, if triggers are coalesced
+    avs_sched_handle_t trigger_task;
     avs_coap_exchange_id_t notify_exchange_id;
     anjay_observation_serialization_state_t serialization_state;
     avs_time_real_t next_trigger;
@@ -74,6 +119,17 @@ struct anjay_observe_connection_entry_struct {
     AVS_LIST(anjay_observation_value_t) unsent;
     // pointer to the last element of unsent
     AVS_LIST(anjay_observation_value_t) unsent_last;
+
+#ifdef ANJAY_WITH_OBSERVATION_STATUS
+    // sums of the counters of all observations, including the removed ones
+    anjay_observation_counters_t counters;
+#endif // ANJAY_WITH_OBSERVATION_STATUS
+#if defined(ANJAY_WITH_OBSERVATION_STATUS) || defined(ANJAY_WITH_TRACEPOINTS)
+    // outgoing retransmission count of the CoAP context at the time the
+    // current notification was started, see avs_coap_get_stats()
+    uint32_t notify_retransmissions_base;
+#endif // defined(ANJAY_WITH_OBSERVATION_STATUS) ||
+       // defined(ANJAY_WITH_TRACEPOINTS)
 };
 
 #ifdef ANJAY_WITH_OBSERVE
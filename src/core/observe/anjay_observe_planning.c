@@ -26,6 +26,15 @@ typedef struct {
     void *cb_data;
 } foreach_relevant_connection_helper_arg_t;
 
+static bool connection_relevant(anjay_connection_ref_t ref,
+                                unsigned conn_type_mask,
+                                anjay_transport_set_t transport_set) {
+    return (conn_type_mask & (1U << ref.conn_type))
+           && _anjay_server_connection_active(ref)
+           && _anjay_socket_transport_included(
+                      transport_set, _anjay_connection_transport(ref));
+}
+
 static int foreach_relevant_connection_helper(anjay_unlocked_t *anjay,
                                               anjay_server_info_t *server,
                                               void *arg_) {
@@ -34,17 +43,15 @@ static int foreach_relevant_connection_helper(anjay_unlocked_t *anjay,
             (foreach_relevant_connection_helper_arg_t *) arg_;
     anjay_connection_type_t conn_type;
     ANJAY_CONNECTION_TYPE_FOREACH(conn_type) {
-        if (arg->conn_type_mask & (1U << conn_type)) {
-            anjay_connection_ref_t ref = {
-                .server = server,
-                .conn_type = conn_type
-            };
+        anjay_connection_ref_t ref = {
+            .server = server,
+            .conn_type = conn_type
+        };
+        if (connection_relevant(ref, arg->conn_type_mask,
+                                arg->transport_set)) {
             AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr =
                     _anjay_observe_find_connection_state(ref);
-            if (conn_ptr && *conn_ptr && _anjay_server_connection_active(ref)
-                    && _anjay_socket_transport_included(
-                               arg->transport_set,
-                               _anjay_connection_transport(ref))) {
+            if (conn_ptr && *conn_ptr) {
                 int result = arg->cb(conn_ptr, arg->cb_data);
                 if (result) {
                     return result;
@@ -83,6 +90,43 @@ static int foreach_relevant_connection(anjay_unlocked_t *anjay,
     }
 }
 
+/**
+ * Attempts to answer a next_planned_trigger() query in constant time, using the
+ * connection entry known to hold the earliest trigger of all. Returns false if
+ * that connection is not relevant for the query, in which case all the
+ * relevant connections need to be checked.
+ */
+static bool earliest_trigger_fast_path(anjay_unlocked_t *anjay,
+                                       anjay_ssid_t ssid,
+                                       unsigned conn_type_mask,
+                                       anjay_transport_set_t transport_set,
+                                       size_t trigger_field_offset,
+                                       avs_time_real_t *out_result) {
+    const anjay_observe_connection_entry_t *earliest;
+    if (trigger_field_offset
+            == offsetof(anjay_observe_connection_entry_t, next_pmax_trigger)) {
+        earliest = anjay->observe.earliest_pmax_trigger_conn;
+    } else {
+        assert(trigger_field_offset
+               == offsetof(anjay_observe_connection_entry_t, next_trigger));
+        earliest = anjay->observe.earliest_trigger_conn;
+    }
+    if (!earliest) {
+        // no triggers planned on any connection
+        *out_result = AVS_TIME_REAL_INVALID;
+        return true;
+    }
+    if ((ssid != ANJAY_SSID_ANY
+         && _anjay_server_ssid(earliest->conn_ref.server) != ssid)
+            || !connection_relevant(earliest->conn_ref, conn_type_mask,
+                                    transport_set)) {
+        return false;
+    }
+    *out_result = *AVS_APPLY_OFFSET(const avs_time_real_t, earliest,
+                                    trigger_field_offset);
+    return true;
+}
+
 #else // ANJAY_WITH_OBSERVE
 
 #    define foreach_relevant_connection(Anjay, Ssid, ConnTypeMask, \
@@ -90,6 +134,8 @@ static int foreach_relevant_connection(anjay_unlocked_t *anjay,
         ((void) (Anjay), (void) (Ssid), (void) (ConnTypeMask),     \
          (void) (TransportSet))
 
+#    define earliest_trigger_fast_path(...) false
+
 #endif // ANJAY_WITH_OBSERVE
 
 typedef struct {
@@ -112,22 +158,48 @@ next_planned_trigger_cb(AVS_LIST(anjay_observe_connection_entry_t) *conn_ptr,
 }
 #endif // ANJAY_WITH_OBSERVE
 
-static avs_time_real_t next_planned_trigger(anjay_t *anjay_locked,
-                                            anjay_ssid_t ssid,
-                                            unsigned conn_type_mask,
-                                            anjay_transport_set_t transport_set,
-                                            size_t trigger_field_offset) {
+static avs_time_real_t
+next_planned_trigger_unlocked(anjay_unlocked_t *anjay,
+                              anjay_ssid_t ssid,
+                              unsigned conn_type_mask,
+                              anjay_transport_set_t transport_set,
+                              size_t trigger_field_offset) {
     next_planned_trigger_cb_arg_t arg = {
         .trigger_field_offset = trigger_field_offset,
         .result = AVS_TIME_REAL_INVALID
     };
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    foreach_relevant_connection(anjay, ssid, conn_type_mask, transport_set,
-                                next_planned_trigger_cb, &arg);
-    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    if (!earliest_trigger_fast_path(anjay, ssid, conn_type_mask, transport_set,
+                                    trigger_field_offset, &arg.result)) {
+        foreach_relevant_connection(anjay, ssid, conn_type_mask, transport_set,
+                                    next_planned_trigger_cb, &arg);
+    }
     return arg.result;
 }
 
+static avs_time_real_t next_planned_trigger(anjay_t *anjay_locked,
+                                            anjay_ssid_t ssid,
+                                            unsigned conn_type_mask,
+                                            anjay_transport_set_t transport_set,
+                                            size_t trigger_field_offset) {
+    avs_time_real_t result = AVS_TIME_REAL_INVALID;
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
+    result = next_planned_trigger_unlocked(anjay, ssid, conn_type_mask,
+                                           transport_set, trigger_field_offset);
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
+    return result;
+}
+
+avs_time_real_t _anjay_observe_next_planned_trigger(anjay_unlocked_t *anjay,
+                                                    anjay_ssid_t ssid,
+                                                    bool pmax_only) {
+    return next_planned_trigger_unlocked(
+            anjay, ssid, 1 << ANJAY_CONNECTION_PRIMARY, ANJAY_TRANSPORT_SET_ALL,
+            pmax_only ? offsetof(anjay_observe_connection_entry_t,
+                                 next_pmax_trigger)
+                      : offsetof(anjay_observe_connection_entry_t,
+                                 next_trigger));
+}
+
 avs_time_real_t anjay_next_planned_notify_trigger(anjay_t *anjay,
                                                   anjay_ssid_t ssid) {
     return next_planned_trigger(
@@ -169,26 +241,76 @@ static int has_unsent_notifications_cb(
     }
     return 0;
 }
+
+// there is nothing to look for if all the unsent queues are empty
+#    define any_notifications_queued(Anjay) ((Anjay)->observe.unsent_count > 0)
+#else // ANJAY_WITH_OBSERVE
+#    define any_notifications_queued(Anjay) ((void) (Anjay), false)
 #endif // ANJAY_WITH_OBSERVE
 
 bool anjay_has_unsent_notifications(anjay_t *anjay_locked, anjay_ssid_t ssid) {
     bool result = false;
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    foreach_relevant_connection(anjay, ssid, 1 << ANJAY_CONNECTION_PRIMARY,
-                                ANJAY_TRANSPORT_SET_ALL,
-                                has_unsent_notifications_cb, &result);
-    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
+    if (any_notifications_queued(anjay)) {
+        foreach_relevant_connection(anjay, ssid, 1 << ANJAY_CONNECTION_PRIMARY,
+                                    ANJAY_TRANSPORT_SET_ALL,
+                                    has_unsent_notifications_cb, &result);
+    }
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
     return result;
 }
 
 bool anjay_transport_has_unsent_notifications(
         anjay_t *anjay_locked, anjay_transport_set_t transport_set) {
     bool result = false;
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
+    if (any_notifications_queued(anjay)) {
+        foreach_relevant_connection(anjay, ANJAY_SSID_ANY,
+                                    (1 << ANJAY_CONNECTION_LIMIT_) - 1,
+                                    transport_set, has_unsent_notifications_cb,
+                                    &result);
+    }
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
+    return result;
+}
+
+void anjay_get_notification_queue_usage(anjay_t *anjay_locked,
+                                        size_t *out_count,
+                                        size_t *out_bytes) {
+    if (out_count) {
+        *out_count = 0;
+    }
+    if (out_bytes) {
+        *out_bytes = 0;
+    }
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
+#ifdef ANJAY_WITH_OBSERVE
+    _anjay_observe_queue_usage(&anjay->observe, out_count, out_bytes);
+#else  // ANJAY_WITH_OBSERVE
+    (void) anjay;
+#endif // ANJAY_WITH_OBSERVE
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
+}
+
+int anjay_set_notification_priority(anjay_t *anjay_locked,
+                                    anjay_oid_t oid,
+                                    anjay_iid_t iid,
+                                    anjay_rid_t rid,
+                                    uint8_t priority) {
+    if (oid == ANJAY_ID_INVALID
+            || (iid == ANJAY_ID_INVALID && rid != ANJAY_ID_INVALID)) {
+        anjay_log(ERROR, _("invalid path for notification priority"));
+        return -1;
+    }
+    int result = -1;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    foreach_relevant_connection(anjay, ANJAY_SSID_ANY,
-                                (1 << ANJAY_CONNECTION_LIMIT_) - 1,
-                                transport_set, has_unsent_notifications_cb,
-                                &result);
+#ifdef ANJAY_WITH_OBSERVE
+    result = _anjay_observe_set_priority(
+            anjay, &MAKE_URI_PATH(oid, iid, rid, ANJAY_ID_INVALID), priority);
+#else  // ANJAY_WITH_OBSERVE
+    (void) anjay;
+    anjay_log(ERROR, _("Notification priorities require Observe support"));
+#endif // ANJAY_WITH_OBSERVE
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return result;
 }
@@ -19,6 +19,7 @@
 #include "../anjay_servers_inactive.h"
 #include "../anjay_servers_reload.h"
 #include "../anjay_servers_utils.h"
+#include "../dm/anjay_dm_cache.h"
 #include "../dm/anjay_query.h"
 
 #include "anjay_activate.h"
@@ -87,6 +88,8 @@ static int deactivate_server(anjay_server_info_t *server) {
                 _anjay_servers_find_ptr(&server->anjay->servers, server->ssid);
         assert(server_ptr);
         assert(*server_ptr == server);
+        _anjay_servers_changed(server->anjay);
+        _anjay_observe_server_removed(server);
         AVS_LIST_DELETE(server_ptr);
         return -1;
     }
@@ -110,11 +113,9 @@ static void try_read_server_resource_u32(anjay_server_info_t *server,
     int64_t result;
 
     if (server_iid != ANJAY_ID_INVALID
-            && !_anjay_dm_read_resource_i64(
-                       server->anjay,
-                       &MAKE_RESOURCE_PATH(ANJAY_DM_OID_SERVER, server_iid,
-                                           rid),
-                       &result)
+            && !_anjay_dm_cached_read_server_resource_i64(server->anjay,
+                                                          server_iid, rid,
+                                                          &result)
             && result >= min_value && result <= UINT32_MAX) {
         *out_result = (uint32_t) result;
     }
@@ -154,6 +155,30 @@ query_server_communication_retry_params(anjay_server_info_t *server) {
             &params.sequence_delay_timer_s);
     return params;
 }
+
+/**
+ * Draws the delay before the next registration retry using decorrelated
+ * exponential backoff, bounded by @p max_delay - the delay mandated by the
+ * LwM2M specification for this attempt.
+ */
+static avs_time_duration_t
+randomized_retry_delay(anjay_server_info_t *server,
+                       uint32_t retry_timer_s,
+                       avs_time_duration_t max_delay) {
+    const avs_time_duration_t base = avs_time_duration_div(
+            avs_time_duration_from_scalar(retry_timer_s, AVS_TIME_S), 2);
+    avs_time_duration_t upper = avs_time_duration_mul(
+            server->registration_attempts > 1 ? server->last_retry_delay
+                                              : base,
+            3);
+    if (!avs_time_duration_valid(upper)
+            || avs_time_duration_less(max_delay, upper)) {
+        upper = max_delay;
+    }
+    server->last_retry_delay =
+            _anjay_random_duration(server->anjay, base, upper);
+    return server->last_retry_delay;
+}
 #endif // ANJAY_WITH_LWM2M11
 
 void _anjay_server_on_failure(anjay_server_info_t *server,
@@ -185,13 +210,16 @@ void _anjay_server_on_failure(anjay_server_info_t *server,
                           server->registration_attempts,
                           params.retry_count - 1);
 
-                const avs_time_duration_t retry_timer = avs_time_duration_mul(
+                avs_time_duration_t retry_timer = avs_time_duration_mul(
                         avs_time_duration_from_scalar(params.retry_timer_s,
                                                       AVS_TIME_S),
                         (1 << (server->registration_attempts - 1)));
                 if (!avs_time_duration_valid(retry_timer)) {
                     anjay_log(WARNING, _("Calculated retry time overflowed. "
                                          "Assuming infinity"));
+                } else if (server->anjay->randomize_communication_retries) {
+                    retry_timer = randomized_retry_delay(
+                            server, params.retry_timer_s, retry_timer);
                 }
                 server->reactivate_time =
                         avs_time_real_add(avs_time_real_now(), retry_timer);
@@ -217,6 +245,11 @@ void _anjay_server_on_failure(anjay_server_info_t *server,
                                       _(" indefinitely."),
                               server->ssid);
                     disable_duration = AVS_TIME_DURATION_INVALID;
+                } else if (server->anjay->randomize_communication_retries) {
+                    disable_duration = _anjay_random_duration(
+                            server->anjay,
+                            avs_time_duration_div(disable_duration, 2),
+                            disable_duration);
                 }
                 server->reactivate_time = avs_time_real_add(avs_time_real_now(),
                                                             disable_duration);
@@ -430,6 +463,10 @@ void _anjay_server_on_updated_registration(anjay_server_info_t *server,
 #ifdef ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
         server->registration_info.last_registration_time = avs_time_real_now();
 #endif // ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+        _anjay_startup_timestamp_mark_first(
+                &server->startup_timestamps.registered);
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
        // Failure to handle Bootstrap state is not a failure of the
        // Register operation - hence, not checking return value.
         _anjay_bootstrap_notify_regular_connection_available(server->anjay);
@@ -562,7 +599,8 @@ int _anjay_server_sched_activate(anjay_server_info_t *server) {
     }
 }
 
-int _anjay_servers_sched_reactivate_all_given_up(anjay_unlocked_t *anjay) {
+int _anjay_servers_sched_reactivate_all_given_up(anjay_unlocked_t *anjay,
+                                                 avs_time_duration_t delay) {
     int result = 0;
     bool active_server_exists = false;
     anjay_server_info_t *bootstrap_server = NULL;
@@ -579,7 +617,7 @@ int _anjay_servers_sched_reactivate_all_given_up(anjay_unlocked_t *anjay) {
                 continue;
             }
         }
-        it->reactivate_time = avs_time_real_now();
+        it->reactivate_time = avs_time_real_add(avs_time_real_now(), delay);
         it->registration_attempts = 0;
         it->registration_sequences_performed = 0;
         if (!_anjay_server_sched_activate(it)) {
@@ -594,7 +632,8 @@ int _anjay_servers_sched_reactivate_all_given_up(anjay_unlocked_t *anjay) {
     if (!active_server_exists && bootstrap_server) {
         assert(!_anjay_server_active(bootstrap_server));
         assert(bootstrap_server->refresh_failed);
-        bootstrap_server->reactivate_time = avs_time_real_now();
+        bootstrap_server->reactivate_time =
+                avs_time_real_add(avs_time_real_now(), delay);
         if (_anjay_server_sched_activate(bootstrap_server)) {
             result = -1;
         }
@@ -615,6 +654,7 @@ void _anjay_servers_add(AVS_LIST(anjay_server_info_t) *servers,
                "entry");
 
     AVS_LIST_INSERT(insert_ptr, server);
+    _anjay_servers_changed(server->anjay);
 }
 
 AVS_LIST(anjay_server_info_t)
@@ -632,6 +672,12 @@ _anjay_servers_create_inactive(anjay_unlocked_t *anjay, anjay_ssid_t ssid) {
     new_server->registration_info.last_update_params.lifetime_s = -1;
     _anjay_connection_get(&new_server->connections, ANJAY_CONNECTION_PRIMARY)
             ->transport = ANJAY_SOCKET_TRANSPORT_INVALID;
+#ifdef WITH_AVS_COAP_UDP
+    _anjay_connection_get(&new_server->connections, ANJAY_CONNECTION_PRIMARY)
+            ->udp_nat.last_activity = AVS_TIME_MONOTONIC_INVALID;
+    _anjay_connection_get(&new_server->connections, ANJAY_CONNECTION_PRIMARY)
+            ->udp_nat.request_idle_time = AVS_TIME_DURATION_INVALID;
+#endif // WITH_AVS_COAP_UDP
     new_server->reactivate_time = AVS_TIME_REAL_INVALID;
     new_server->registration_info.lwm2m_version =
 #ifdef ANJAY_WITH_LWM2M11
@@ -644,6 +690,18 @@ _anjay_servers_create_inactive(anjay_unlocked_t *anjay, anjay_ssid_t ssid) {
             AVS_TIME_REAL_INVALID;
     new_server->last_communication_time = AVS_TIME_REAL_INVALID;
 #endif // ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+    new_server->startup_timestamps = (anjay_server_startup_timestamps_t) {
+        .socket_created = AVS_TIME_MONOTONIC_INVALID,
+        .connect_started = AVS_TIME_MONOTONIC_INVALID,
+        .connected = AVS_TIME_MONOTONIC_INVALID,
+        .register_sent = AVS_TIME_MONOTONIC_INVALID,
+        .registered = AVS_TIME_MONOTONIC_INVALID
+    };
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+#ifdef ANJAY_WITH_STATE_PERSISTENCE
+    _anjay_server_apply_restored_registration(new_server);
+#endif // ANJAY_WITH_STATE_PERSISTENCE
     return new_server;
 }
 
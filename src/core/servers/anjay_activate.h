@@ -68,7 +68,12 @@ void _anjay_server_on_updated_registration(anjay_server_info_t *server,
  */
 int _anjay_server_sched_activate(anjay_server_info_t *server);
 
-int _anjay_servers_sched_reactivate_all_given_up(anjay_unlocked_t *anjay);
+/**
+ * Schedules reactivation, after @p delay , of all servers for which the
+ * activation has been given up on.
+ */
+int _anjay_servers_sched_reactivate_all_given_up(anjay_unlocked_t *anjay,
+                                                 avs_time_duration_t delay);
 
 /**
  * Inserts an active server entry into @p servers .
@@ -24,6 +24,8 @@
 #define ANJAY_SERVERS_CONNECTION_SOURCE
 #define ANJAY_SERVERS_INTERNALS
 
+#include "../anjay_dns_cache.h"
+
 #include "anjay_connections_internal.h"
 #include "anjay_server_connections.h"
 #include "anjay_servers_internal.h"
@@ -117,12 +119,10 @@ prepare_connection(anjay_unlocked_t *anjay,
 
 static avs_error_t connect_socket(anjay_unlocked_t *anjay,
                                   anjay_server_connection_t *connection) {
-    (void) anjay;
-
     avs_net_socket_t *socket =
             _anjay_connection_internal_get_socket(connection);
-    avs_error_t err = avs_net_socket_connect(socket, connection->uri.host,
-                                             connection->uri.port);
+    avs_error_t err = _anjay_dns_cache_connect(
+            anjay, socket, connection->uri.host, connection->uri.port);
     if (avs_is_err(err)) {
         anjay_log(ERROR, _("could not connect to ") "%s" _(":") "%s",
                   connection->uri.host, connection->uri.port);
@@ -154,14 +154,27 @@ static int ensure_tcp_coap_context(anjay_connection_ref_t ref) {
     anjay_unlocked_t *anjay = _anjay_from_server(ref.server);
     anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
     if (!connection->coap_ctx) {
+        anjay_coap_buffers_t buffers;
+        if (_anjay_coap_buffers_lease(anjay, &buffers)) {
+            return -1;
+        }
         connection->coap_ctx = avs_coap_tcp_ctx_create(
-                _anjay_get_coap_sched(anjay), anjay->in_shared_buffer,
-                anjay->out_shared_buffer, anjay->coap_tcp_max_options_size,
+                _anjay_get_coap_sched(anjay), buffers.in_buffer,
+                buffers.out_buffer, anjay->coap_tcp_max_options_size,
                 anjay->coap_tcp_request_timeout, anjay->prng_ctx.ctx);
+        _anjay_coap_buffers_bind(anjay, &buffers, connection->coap_ctx);
         if (!connection->coap_ctx) {
             anjay_log(ERROR, _("could not create CoAP/TCP context"));
             return -1;
         }
+        if (anjay->coap_tcp_write_coalescing_buffer_size
+                && avs_coap_tcp_ctx_set_write_coalescing(
+                           connection->coap_ctx,
+                           anjay->coap_tcp_write_coalescing_buffer_size)) {
+            anjay_log(WARNING, _("could not enable CoAP/TCP write coalescing"));
+        }
+        avs_coap_tcp_ctx_set_receive_budget(connection->coap_ctx,
+                                            anjay->coap_tcp_receive_budget);
     }
 
     return 0;
@@ -175,14 +188,36 @@ static int ensure_udp_coap_context(anjay_connection_ref_t ref) {
     anjay_unlocked_t *anjay = _anjay_from_server(ref.server);
     anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
     if (!connection->coap_ctx) {
+        anjay_coap_buffers_t buffers;
+        if (_anjay_coap_buffers_lease(anjay, &buffers)) {
+            return -1;
+        }
         connection->coap_ctx = avs_coap_udp_ctx_create(
                 _anjay_get_coap_sched(anjay), &anjay->udp_tx_params,
-                anjay->in_shared_buffer, anjay->out_shared_buffer,
+                buffers.in_buffer, buffers.out_buffer,
                 anjay->udp_response_cache, anjay->prng_ctx.ctx);
+        _anjay_coap_buffers_bind(anjay, &buffers, connection->coap_ctx);
         if (!connection->coap_ctx) {
             anjay_log(ERROR, _("could not create CoAP/UDP context"));
             return -1;
         }
+        if (anjay->udp_path_mtu_discovery) {
+            avs_coap_udp_ctx_set_path_mtu_discovery(
+                    connection->coap_ctx, true,
+                    connection->nontransient_state.udp_path_mtu);
+        }
+        if (anjay->udp_compression) {
+            avs_coap_udp_ctx_set_compression(connection->coap_ctx,
+                                             anjay->udp_compression,
+                                             anjay->udp_compression_arg);
+        }
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+        if (anjay->udp_q_block1_max_payloads
+                && !connection->nontransient_state.udp_q_block1_rejected) {
+            avs_coap_udp_ctx_set_q_block1(connection->coap_ctx,
+                                          anjay->udp_q_block1_max_payloads);
+        }
+#    endif // WITH_AVS_COAP_Q_BLOCK
     }
     return 0;
 }
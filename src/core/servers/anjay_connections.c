@@ -54,6 +54,25 @@ avs_net_socket_t *_anjay_connection_internal_get_socket(
     return connection->conn_socket_;
 }
 
+static void cleanup_coap_ctx(anjay_unlocked_t *anjay,
+                             anjay_server_connection_t *connection) {
+#ifdef WITH_AVS_COAP_UDP
+    if (connection->coap_ctx && anjay->udp_path_mtu_discovery
+            && connection->transport == ANJAY_SOCKET_TRANSPORT_UDP) {
+        connection->nontransient_state.udp_path_mtu =
+                avs_coap_udp_ctx_get_path_mtu(connection->coap_ctx);
+    }
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+    if (connection->coap_ctx
+            && connection->transport == ANJAY_SOCKET_TRANSPORT_UDP
+            && avs_coap_udp_ctx_q_block1_rejected(connection->coap_ctx)) {
+        connection->nontransient_state.udp_q_block1_rejected = true;
+    }
+#    endif // WITH_AVS_COAP_Q_BLOCK
+#endif // WITH_AVS_COAP_UDP
+    _anjay_coap_ctx_cleanup(anjay, &connection->coap_ctx);
+}
+
 void _anjay_connection_internal_clean_socket(
         anjay_unlocked_t *anjay, anjay_server_connection_t *connection) {
 #ifdef ANJAY_WITH_DOWNLOADER
@@ -64,11 +83,20 @@ void _anjay_connection_internal_clean_socket(
     _anjay_downloader_abort_same_socket(&anjay->downloader,
                                         connection->conn_socket_);
 #endif // ANJAY_WITH_DOWNLOADER
-    _anjay_coap_ctx_cleanup(anjay, &connection->coap_ctx);
+    cleanup_coap_ctx(anjay, connection);
     _anjay_socket_cleanup(anjay, &connection->conn_socket_);
 #ifndef ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
     avs_sched_del(&connection->queue_mode_close_socket_clb);
 #endif // ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
+#ifdef WITH_AVS_COAP_UDP
+    // a new socket means a new NAT binding
+    connection->udp_nat.last_activity = AVS_TIME_MONOTONIC_INVALID;
+    connection->udp_nat.request_idle_time = AVS_TIME_DURATION_INVALID;
+#endif // WITH_AVS_COAP_UDP
+#if defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
+    avs_sched_del(&connection->tcp_keepalive.job);
+    connection->tcp_keepalive.failed = false;
+#endif // defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
 }
 
 typedef struct {
@@ -383,11 +411,25 @@ avs_error_t _anjay_server_connection_internal_bring_online(
 #endif // ANJAY_WITH_CONN_STATUS_API
        // defined(ANJAY_WITH_CORE_PERSISTENCE)
 
+    // the socket is either connected or closed below
+    _anjay_socket_set_changed(server->anjay);
     bool session_resumed;
     avs_error_t err = AVS_OK;
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+    if (conn_type == ANJAY_CONNECTION_PRIMARY) {
+        _anjay_startup_timestamp_mark_first(
+                &server->startup_timestamps.connect_started);
+    }
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
     if (avs_is_err((err = def->connect_socket(server->anjay, connection)))) {
         goto error;
     }
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+    if (conn_type == ANJAY_CONNECTION_PRIMARY) {
+        _anjay_startup_timestamp_mark_first(
+                &server->startup_timestamps.connected);
+    }
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
 
     if (!(session_resumed =
                   _anjay_was_session_resumed(connection->conn_socket_))) {
@@ -395,13 +437,25 @@ avs_error_t _anjay_server_connection_internal_bring_online(
         // Clean up and recreate the CoAP context to discard observations
         // NOTE: In old versions of avs_coap, this was sending the Release
         // message. This may need to be revised if it's ever reintroduced.
-        _anjay_coap_ctx_cleanup(server->anjay, &connection->coap_ctx);
+        cleanup_coap_ctx(server->anjay, connection);
     }
 
     if (_anjay_connection_ensure_coap_context(server, conn_type)) {
         err = avs_errno(AVS_ENOMEM);
         goto error;
     }
+#ifdef ANJAY_WITH_OBSERVE_PERSISTENCE
+    if (!avs_coap_ctx_has_socket(connection->coap_ctx)) {
+        // observations can only be restored into a CoAP context that has no
+        // socket assigned yet
+        _anjay_observe_apply_restored(
+                (anjay_connection_ref_t) {
+                    .server = server,
+                    .conn_type = conn_type
+                },
+                session_resumed);
+    }
+#endif // ANJAY_WITH_OBSERVE_PERSISTENCE
     if (!avs_coap_ctx_has_socket(connection->coap_ctx)
             && avs_is_err((err = avs_coap_ctx_set_socket(
                                    connection->coap_ctx,
@@ -426,11 +480,15 @@ avs_error_t _anjay_server_connection_internal_bring_online(
     // NOTE: needs_observe_flush also controls flushing Send messages,
     // so we need it even if there are no observations due to new session
     connection->needs_observe_flush = true;
+    _anjay_connection_schedule_tcp_keepalive((anjay_connection_ref_t) {
+        .server = server,
+        .conn_type = conn_type
+    });
     return AVS_OK;
 
 error:
     connection->state = ANJAY_SERVER_CONNECTION_OFFLINE;
-    _anjay_coap_ctx_cleanup(server->anjay, &connection->coap_ctx);
+    cleanup_coap_ctx(server->anjay, connection);
 
     if (connection->conn_socket_
             && avs_is_err(avs_net_socket_close(connection->conn_socket_))) {
@@ -439,10 +497,66 @@ error:
     return err;
 }
 
+avs_error_t
+_anjay_server_connection_internal_rebind(anjay_server_info_t *server,
+                                         anjay_connection_type_t conn_type) {
+    assert(server);
+    anjay_server_connection_t *connection =
+            _anjay_connection_get(&server->connections, conn_type);
+    assert(connection);
+    if (!server->anjay->use_connection_id
+            || connection->transport != ANJAY_SOCKET_TRANSPORT_UDP
+            || !connection->security_cache.is_encrypted
+            || !connection->coap_ctx
+            || !_anjay_connection_is_online(connection)) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+
+    const anjay_connection_type_definition_t *def =
+            get_connection_type_def(connection->transport);
+    assert(def);
+    avs_net_socket_t *socket =
+            _anjay_connection_internal_get_socket(connection);
+
+    // the socket is either reconnected or closed below
+    _anjay_socket_set_changed(server->anjay);
+    avs_error_t err = avs_net_socket_close(socket);
+    if (avs_is_ok(err)
+            && avs_is_ok((err = def->connect_socket(server->anjay,
+                                                    connection)))) {
+        if (_anjay_was_connection_id_resumed(socket)) {
+            // CoAP context, exchanges and registration stay intact
+            anjay_log(INFO, _("rebound connection, continuing via Connection "
+                              "ID"));
+            return AVS_OK;
+        }
+        if (_anjay_was_session_resumed(socket)) {
+            if (connection->stateful) {
+                connection->state = ANJAY_SERVER_CONNECTION_FRESHLY_CONNECTED;
+            }
+            anjay_log(INFO, _("rebound connection, session resumed"));
+            return AVS_OK;
+        }
+        anjay_log(DEBUG, _("could not resume the session after rebinding"));
+        _anjay_conn_session_token_reset(&connection->session_token);
+        cleanup_coap_ctx(server->anjay, connection);
+        err = avs_errno(AVS_ECONNRESET);
+    }
+    avs_net_socket_close(socket);
+    return err;
+}
+
+static void security_cache_cleanup(anjay_server_connection_t *connection) {
+    _anjay_security_config_cache_cleanup(&connection->security_cache.cache);
+    memset(&connection->security_cache, 0,
+           sizeof(connection->security_cache));
+}
+
 static void connection_cleanup(anjay_unlocked_t *anjay,
                                anjay_server_connection_t *connection) {
     _anjay_connection_internal_clean_socket(anjay, connection);
     _anjay_url_cleanup(&connection->uri);
+    security_cache_cleanup(connection);
 }
 
 void _anjay_connections_close(anjay_unlocked_t *anjay,
@@ -466,6 +580,71 @@ void _anjay_connection_internal_invalidate_session(
            sizeof(connection->nontransient_state.dtls_session_buffer));
 }
 
+static size_t session_data_size(const char *buffer, size_t buffer_size) {
+    // unused parts of the buffer are zero-filled
+    while (buffer_size > 0 && !buffer[buffer_size - 1]) {
+        --buffer_size;
+    }
+    return buffer_size;
+}
+
+bool _anjay_connections_has_cached_session(anjay_server_info_t *server) {
+    const anjay_server_connection_t *connection =
+            _anjay_connection_get(&server->connections,
+                                  ANJAY_CONNECTION_PRIMARY);
+    if (session_data_size(
+                connection->nontransient_state.dtls_session_buffer,
+                sizeof(connection->nontransient_state.dtls_session_buffer))) {
+        return true;
+    }
+#ifdef ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+    AVS_LIST(anjay_dtls_session_restored_t) entry;
+    AVS_LIST_FOREACH(entry, server->anjay->dtls_sessions_restored) {
+        if (entry->ssid == server->ssid
+                && entry->conn_type == ANJAY_CONNECTION_PRIMARY) {
+            return true;
+        }
+    }
+#endif // ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+    return false;
+}
+
+/**
+ * Makes sure that connection->security_cache holds the security configuration
+ * for @p inout_info . It is only read from the data model if the Security
+ * object has changed since it was last read, so that PKI material is not parsed
+ * again each time the socket is recreated.
+ */
+static avs_error_t
+ensure_security_config(anjay_unlocked_t *anjay,
+                       anjay_server_connection_t *connection,
+                       anjay_connection_info_t *inout_info) {
+    if (connection->security_cache.valid
+            && connection->security_cache.generation
+                           == anjay->security_generation
+            && connection->security_cache.security_iid
+                           == inout_info->security_iid
+            && connection->security_cache.transport_info
+                           == inout_info->transport_info) {
+        inout_info->is_encrypted = connection->security_cache.is_encrypted;
+        return AVS_OK;
+    }
+    security_cache_cleanup(connection);
+    avs_error_t err = _anjay_connection_security_generic_get_config(
+            anjay, &connection->security_cache.config,
+            &connection->security_cache.cache, inout_info);
+    if (avs_is_err(err)) {
+        security_cache_cleanup(connection);
+        return err;
+    }
+    connection->security_cache.valid = true;
+    connection->security_cache.generation = anjay->security_generation;
+    connection->security_cache.security_iid = inout_info->security_iid;
+    connection->security_cache.transport_info = inout_info->transport_info;
+    connection->security_cache.is_encrypted = inout_info->is_encrypted;
+    return AVS_OK;
+}
+
 static avs_error_t
 recreate_socket(anjay_unlocked_t *anjay,
                 const anjay_connection_type_definition_t *def,
@@ -495,36 +674,71 @@ recreate_socket(anjay_unlocked_t *anjay,
 
     // At this point, inout_info has "global" settings filled,
     // but transport-specific (i.e. UDP or SMS) fields are not
-    anjay_security_config_t security_config;
-    anjay_security_config_cache_t security_config_cache;
-    memset(&security_config_cache, 0, sizeof(security_config_cache));
-    avs_error_t err;
-    {
-        err = _anjay_connection_security_generic_get_config(
-                anjay, &security_config, &security_config_cache, inout_info);
-    }
+    avs_error_t err = ensure_security_config(anjay, connection, inout_info);
     if (avs_is_err(err)) {
         anjay_log(DEBUG,
                   _("could not get ") "%s" _(
                           " security config for server ") "/%u/%u",
                   def->name, ANJAY_DM_OID_SECURITY, inout_info->security_iid);
     } else {
-        socket_config.security = security_config.security_info;
-        socket_config.ciphersuites = security_config.tls_ciphersuites;
-        socket_config.server_name_indication =
-                security_config.server_name_indication;
-        if (avs_is_err((err = def->prepare_connection(
-                                anjay, connection, &socket_config,
-                                security_config.dane_tlsa_record, inout_info)))
-                && connection->conn_socket_) {
-            avs_net_socket_shutdown(connection->conn_socket_);
-            avs_net_socket_close(connection->conn_socket_);
+        const anjay_security_config_t *security_config =
+                &connection->security_cache.config;
+        socket_config.security = security_config->security_info;
+        socket_config.ciphersuites = security_config->tls_ciphersuites;
+        socket_config.server_name_indication = _anjay_dns_cache_server_name(
+                security_config->server_name_indication,
+                avs_url_host(inout_info->uri));
+        err = def->prepare_connection(anjay, connection, &socket_config,
+                                      security_config->dane_tlsa_record,
+                                      inout_info);
+        if (connection->conn_socket_) {
+            // a new socket may have been created, which also invalidates the
+            // primary socket lookup index
+            _anjay_socket_set_changed(anjay);
+            if (avs_is_err(err)) {
+                avs_net_socket_shutdown(connection->conn_socket_);
+                avs_net_socket_close(connection->conn_socket_);
+            }
         }
     }
-    _anjay_security_config_cache_cleanup(&security_config_cache);
     return err;
 }
 
+#ifdef ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+/**
+ * Moves the session restored by anjay_dtls_sessions_restore() for the given
+ * connection, if any, into its session resumption buffer. The restored entry
+ * is discarded without being used if a session is already cached in RAM, as
+ * that one is necessarily more recent.
+ */
+static void apply_restored_dtls_session(anjay_unlocked_t *anjay,
+                                        anjay_ssid_t ssid,
+                                        anjay_connection_type_t conn_type,
+                                        anjay_server_connection_t *connection) {
+    AVS_LIST(anjay_dtls_session_restored_t) *entry_ptr;
+    AVS_LIST_FOREACH_PTR(entry_ptr, &anjay->dtls_sessions_restored) {
+        if ((*entry_ptr)->ssid == ssid
+                && (*entry_ptr)->conn_type == conn_type) {
+            break;
+        }
+    }
+    if (!*entry_ptr) {
+        return;
+    }
+    char *buffer = connection->nontransient_state.dtls_session_buffer;
+    const size_t buffer_size =
+            sizeof(connection->nontransient_state.dtls_session_buffer);
+    if (!session_data_size(buffer, buffer_size)) {
+        memcpy(buffer, (*entry_ptr)->session, (*entry_ptr)->session_size);
+        memset(buffer + (*entry_ptr)->session_size, 0,
+               buffer_size - (*entry_ptr)->session_size);
+        anjay_log(DEBUG, _("using restored DTLS session for SSID ") "%u",
+                  (unsigned) ssid);
+    }
+    AVS_LIST_DELETE(entry_ptr);
+}
+#endif // ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+
 static avs_error_t
 ensure_socket_connected(anjay_server_info_t *server,
                         anjay_connection_type_t conn_type,
@@ -539,12 +753,22 @@ ensure_socket_connected(anjay_server_info_t *server,
             _anjay_connection_internal_get_socket(connection);
 
     if (existing_socket == NULL) {
+#ifdef ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+        apply_restored_dtls_session(server->anjay, server->ssid, conn_type,
+                                    connection);
+#endif // ANJAY_WITH_DTLS_SESSION_PERSISTENCE
         avs_error_t err =
                 recreate_socket(server->anjay, def, connection, inout_info);
         if (avs_is_err(err)) {
             connection->state = ANJAY_SERVER_CONNECTION_OFFLINE;
             return err;
         }
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+        if (conn_type == ANJAY_CONNECTION_PRIMARY) {
+            _anjay_startup_timestamp_mark_first(
+                    &server->startup_timestamps.socket_created);
+        }
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
     }
 
     return _anjay_server_connection_internal_bring_online(server, conn_type);
@@ -627,8 +851,10 @@ void _anjay_server_connections_refresh(anjay_server_info_t *server,
         *move_uri = NULL;
     }
 
-    if (security_iid != ANJAY_ID_INVALID) {
+    if (security_iid != ANJAY_ID_INVALID
+            && server->last_used_security_iid != security_iid) {
         server->last_used_security_iid = security_iid;
+        _anjay_servers_changed(server->anjay);
     }
     anjay_server_connection_t *primary_conn =
             _anjay_connection_get(&server->connections,
@@ -864,3 +1090,171 @@ avs_error_t _anjay_server_read_sni(anjay_unlocked_t *anjay,
     return err;
 }
 #endif // ANJAY_WITH_LWM2M11
+
+#ifdef ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+static const char DTLS_SESSIONS_MAGIC[] = "DTS";
+
+static const uint8_t DTLS_SESSIONS_VERSIONS[] = { 0 };
+
+static avs_error_t
+dtls_session_persistence_handler(avs_persistence_context_t *ctx,
+                                 anjay_dtls_session_restored_t *entry) {
+    uint8_t conn_type = (uint8_t) entry->conn_type;
+    uint32_t session_size = (uint32_t) entry->session_size;
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_persistence_u16(ctx, &entry->ssid)))
+            || avs_is_err((err = avs_persistence_u8(ctx, &conn_type)))
+            || avs_is_err((err = avs_persistence_u32(ctx, &session_size))));
+    if (avs_is_ok(err)
+            && avs_persistence_direction(ctx) == AVS_PERSISTENCE_RESTORE) {
+        entry->conn_type = (anjay_connection_type_t) conn_type;
+        entry->session_size = session_size;
+        // sessions that do not fit are rejected instead of being truncated,
+        // e.g. if ANJAY_DTLS_SESSION_BUFFER_SIZE has been decreased
+        if (entry->conn_type >= ANJAY_CONNECTION_LIMIT_
+                || session_size > sizeof(entry->session)) {
+            err = avs_errno(AVS_EBADMSG);
+        }
+    }
+    if (avs_is_ok(err)) {
+        err = avs_persistence_bytes(ctx, entry->session, entry->session_size);
+    }
+    return err;
+}
+
+static avs_error_t
+snapshot_dtls_sessions(anjay_unlocked_t *anjay,
+                       AVS_LIST(anjay_dtls_session_restored_t) *out_entries) {
+    AVS_LIST(anjay_dtls_session_restored_t) *tail_ptr = out_entries;
+    AVS_LIST(anjay_server_info_t) server;
+    AVS_LIST_FOREACH(server, anjay->servers) {
+        anjay_connection_type_t conn_type;
+        ANJAY_CONNECTION_TYPE_FOREACH(conn_type) {
+            const anjay_server_connection_t *connection =
+                    _anjay_connection_get(&server->connections, conn_type);
+            const size_t size = session_data_size(
+                    connection->nontransient_state.dtls_session_buffer,
+                    sizeof(connection->nontransient_state.dtls_session_buffer));
+            if (!size) {
+                continue;
+            }
+            AVS_LIST(anjay_dtls_session_restored_t) entry =
+                    AVS_LIST_NEW_ELEMENT(anjay_dtls_session_restored_t);
+            if (!entry) {
+                _anjay_log_oom();
+                return avs_errno(AVS_ENOMEM);
+            }
+            entry->ssid = server->ssid;
+            entry->conn_type = conn_type;
+            entry->session_size = size;
+            memcpy(entry->session,
+                   connection->nontransient_state.dtls_session_buffer, size);
+            AVS_LIST_INSERT(tail_ptr, entry);
+            AVS_LIST_ADVANCE_PTR(&tail_ptr);
+        }
+    }
+    return AVS_OK;
+}
+
+avs_error_t anjay_dtls_sessions_persist(anjay_t *anjay_locked,
+                                        avs_stream_t *out_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_dtls_session_restored_t) entries = NULL;
+    if (avs_is_ok((err = snapshot_dtls_sessions(anjay, &entries)))) {
+        avs_persistence_context_t ctx =
+                avs_persistence_store_context_create(out_stream);
+        uint8_t version = 0;
+        // sessions restored earlier, but not used yet, are kept
+        uint32_t count =
+                (uint32_t) (AVS_LIST_SIZE(entries)
+                            + AVS_LIST_SIZE(anjay->dtls_sessions_restored));
+        (void) (avs_is_err((err = avs_persistence_magic_string(
+                                    &ctx, DTLS_SESSIONS_MAGIC)))
+                || avs_is_err((err = avs_persistence_version(
+                                       &ctx, &version,
+                                       DTLS_SESSIONS_VERSIONS,
+                                       sizeof(DTLS_SESSIONS_VERSIONS))))
+                || avs_is_err((err = avs_persistence_u32(&ctx, &count))));
+        AVS_LIST(anjay_dtls_session_restored_t) entry;
+        AVS_LIST_FOREACH(entry, entries) {
+            if (avs_is_err(err)) {
+                break;
+            }
+            err = dtls_session_persistence_handler(&ctx, entry);
+        }
+        AVS_LIST_FOREACH(entry, anjay->dtls_sessions_restored) {
+            if (avs_is_err(err)) {
+                break;
+            }
+            err = dtls_session_persistence_handler(&ctx, entry);
+        }
+    }
+    AVS_LIST_CLEAR(&entries);
+    if (avs_is_ok(err)) {
+        anjay_log(INFO, _("DTLS sessions state persisted"));
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+static avs_error_t
+read_dtls_sessions(avs_stream_t *in_stream,
+                   AVS_LIST(anjay_dtls_session_restored_t) *out_entries) {
+    avs_persistence_context_t ctx =
+            avs_persistence_restore_context_create(in_stream);
+    uint8_t version;
+    uint32_t count;
+    avs_error_t err;
+    if (avs_is_err((err = avs_persistence_magic_string(
+                            &ctx, DTLS_SESSIONS_MAGIC)))
+            || avs_is_err((err = avs_persistence_version(
+                                   &ctx, &version,
+                                   DTLS_SESSIONS_VERSIONS,
+                                   sizeof(DTLS_SESSIONS_VERSIONS))))
+            || avs_is_err((err = avs_persistence_u32(&ctx, &count)))) {
+        return err;
+    }
+    AVS_LIST(anjay_dtls_session_restored_t) *tail_ptr = out_entries;
+    for (uint32_t i = 0; i < count; ++i) {
+        AVS_LIST(anjay_dtls_session_restored_t) entry =
+                AVS_LIST_NEW_ELEMENT(anjay_dtls_session_restored_t);
+        if (!entry) {
+            _anjay_log_oom();
+            return avs_errno(AVS_ENOMEM);
+        }
+        AVS_LIST_INSERT(tail_ptr, entry);
+        AVS_LIST_ADVANCE_PTR(&tail_ptr);
+        if (avs_is_err((err = dtls_session_persistence_handler(&ctx, entry)))) {
+            return err;
+        }
+    }
+    return AVS_OK;
+}
+
+avs_error_t anjay_dtls_sessions_restore(anjay_t *anjay_locked,
+                                        avs_stream_t *in_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_dtls_session_restored_t) entries = NULL;
+    if (avs_is_ok((err = read_dtls_sessions(in_stream, &entries)))) {
+        AVS_LIST_CLEAR(&anjay->dtls_sessions_restored);
+        anjay->dtls_sessions_restored = entries;
+        entries = NULL;
+        anjay_log(INFO, _("DTLS sessions state restored"));
+#    ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+        anjay->startup_timestamps.last_state_restored =
+                avs_time_monotonic_now();
+#    endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+    }
+    AVS_LIST_CLEAR(&entries);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+#endif // ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+
+#ifdef ANJAY_TEST
+#    include "tests/core/servers/connections.c"
+#endif // ANJAY_TEST
@@ -29,6 +29,48 @@ typedef struct {
 #endif // ANJAY_WITHOUT_IP_STICKINESS
     char dtls_session_buffer[ANJAY_DTLS_SESSION_BUFFER_SIZE];
     char last_local_port[ANJAY_MAX_URL_PORT_SIZE];
+#ifdef WITH_AVS_COAP_UDP
+    /**
+     * Path MTU detected by the CoAP/UDP context, preserved across reconnects.
+     * 0 if unknown.
+     */
+    size_t udp_path_mtu;
+    /**
+     * Estimated lifetime of the NAT binding on the path to the server,
+     * preserved across reconnects. Zero if unknown, i.e. no limit has been
+     * observed. See anjay_configuration_t::udp_nat_keepalive.
+     */
+    avs_time_duration_t udp_nat_binding_lifetime;
+#    ifdef WITH_AVS_COAP_Q_BLOCK
+    /**
+     * True if the server has been detected not to support the Q-Block1
+     * option, preserved across reconnects.
+     */
+    bool udp_q_block1_rejected;
+#    endif // WITH_AVS_COAP_Q_BLOCK
+#endif // WITH_AVS_COAP_UDP
+#if defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
+    /**
+     * CoAP/TCP keepalive interval adapted to the NAT timeouts observed on the
+     * path to the server, preserved across reconnects. Zero if no keepalive
+     * failure has been observed, i.e. the configured value is used.
+     */
+    avs_time_duration_t tcp_keepalive_interval;
+#endif // defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
+#ifndef ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
+    /**
+     * Longest recently observed delay between the end of an interaction with
+     * the server and the next request received from it, used for
+     * anjay_configuration_t::queue_mode_adaptive_close. Decays with each queue
+     * mode window that ends. Preserved across reconnects.
+     */
+    avs_time_duration_t queue_mode_request_delay;
+    /**
+     * Number of queue mode windows that ended by closing the socket, saturating
+     * at UINT_MAX. Preserved across reconnects.
+     */
+    unsigned queue_mode_windows;
+#endif // ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
 } anjay_server_connection_nontransient_state_t;
 
 typedef enum {
@@ -184,6 +226,22 @@ typedef struct {
      */
     anjay_server_connection_nontransient_state_t nontransient_state;
 
+    /**
+     * Security configuration read from the data model when the socket was last
+     * created. It is reused when the socket is recreated (e.g. in queue mode or
+     * after going offline), as long as the Security object has not changed
+     * since - see anjay_unlocked_t::security_generation.
+     */
+    struct {
+        bool valid;
+        size_t generation;
+        anjay_iid_t security_iid;
+        const anjay_transport_info_t *transport_info;
+        bool is_encrypted;
+        anjay_security_config_t config;
+        anjay_security_config_cache_t cache;
+    } security_cache;
+
 #ifndef ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
     /**
      * Handle to scheduled queue_mode_close_socket() scheduler job. Generally
@@ -192,7 +250,71 @@ typedef struct {
      * defer the action if CoAP exchanges are in progress.
      */
     avs_sched_handle_t queue_mode_close_socket_clb;
+    /**
+     * Time at which queue_mode_close_socket_clb was last scheduled, i.e. the
+     * end of the last interaction with the server. Only meaningful while
+     * queue_mode_close_socket_clb is scheduled.
+     */
+    avs_time_monotonic_t queue_mode_window_start;
 #endif // ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
+
+#ifdef WITH_AVS_COAP_UDP
+    /**
+     * State of the NAT binding lifetime measurement, see
+     * anjay_configuration_t::udp_nat_keepalive.
+     */
+    struct {
+        /**
+         * Time of the last traffic known to have passed in both directions,
+         * or AVS_TIME_MONOTONIC_INVALID if there was none on the current
+         * socket.
+         */
+        avs_time_monotonic_t last_activity;
+        /**
+         * Idle time of the connection at the moment of sending the last
+         * request, or an invalid duration if it was unknown.
+         */
+        avs_time_duration_t request_idle_time;
+        /**
+         * Number of exchanges that succeeded since the estimate was last
+         * changed.
+         */
+        unsigned successful_exchanges;
+    } udp_nat;
+#endif // WITH_AVS_COAP_UDP
+
+#if defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
+    /**
+     * State of the CoAP/TCP keepalive mechanism, see
+     * _anjay_connection_schedule_tcp_keepalive().
+     */
+    struct {
+        /**
+         * Handle to the tcp_keepalive_job() scheduler job. Not scheduled while
+         * a Ping is waiting for a Pong.
+         */
+        avs_sched_handle_t job;
+        /**
+         * Set while a Ping is waiting for a Pong.
+         */
+        bool ping_in_progress;
+        /**
+         * Idle time of the connection at the moment of sending the Ping that
+         * is currently in progress.
+         */
+        avs_time_duration_t ping_idle_time;
+        /**
+         * Number of Pings that succeeded since the keepalive interval was last
+         * changed.
+         */
+        unsigned successful_pings;
+        /**
+         * Set if the last Ping was not answered; the connection is then
+         * recreated by the keepalive job.
+         */
+        bool failed;
+    } tcp_keepalive;
+#endif // defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
 } anjay_server_connection_t;
 
 typedef struct {
@@ -227,6 +349,13 @@ _anjay_connections_get_primary_session_token(anjay_connections_t *connections);
 void _anjay_connection_internal_invalidate_session(
         anjay_server_connection_t *connection);
 
+/**
+ * Checks whether a DTLS session is cached for the primary connection of
+ * @p server (either in RAM, or restored by anjay_dtls_sessions_restore()), so
+ * that connecting it will likely only require an abbreviated handshake.
+ */
+bool _anjay_connections_has_cached_session(anjay_server_info_t *server);
+
 static inline bool
 _anjay_connection_is_online(anjay_server_connection_t *connection) {
     return _anjay_socket_is_online(
@@ -239,6 +368,21 @@ int _anjay_connection_ensure_coap_context(anjay_server_info_t *server,
 avs_error_t _anjay_server_connection_internal_bring_online(
         anjay_server_info_t *server, anjay_connection_type_t conn_type);
 
+/**
+ * Reconnects an online DTLS-over-UDP socket in place, e.g. after a change of
+ * the local IP address, without touching the CoAP context. This is only
+ * attempted if Connection ID is enabled, as otherwise the server would not be
+ * able to associate the new address with the existing session.
+ *
+ * If the DTLS session has been resumed, the connection continues as if nothing
+ * happened. Otherwise, the socket is left closed, the CoAP context is cleaned
+ * up and an error is returned - the caller is then expected to refresh the
+ * server as it would after a regular reconnect.
+ */
+avs_error_t
+_anjay_server_connection_internal_rebind(anjay_server_info_t *server,
+                                         anjay_connection_type_t conn_type);
+
 void _anjay_connections_close(anjay_unlocked_t *anjay,
                               anjay_connections_t *connections);
 
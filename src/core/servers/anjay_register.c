@@ -10,13 +10,18 @@
 #include <anjay_init.h>
 
 #include <inttypes.h>
+#include <string.h>
 
 #include <avsystem/commons/avs_errno.h>
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_persistence.h>
 #include <avsystem/commons/avs_stream_membuf.h>
+#include <avsystem/commons/avs_utils.h>
 
 #include <avsystem/coap/async_client.h>
 #include <avsystem/coap/code.h>
 
+#include <anjay_modules/anjay_memory_accounting.h>
 #include <anjay_modules/anjay_time_defs.h>
 
 #define ANJAY_SERVERS_INTERNALS
@@ -113,8 +118,27 @@ calculate_time_of_next_update(anjay_server_info_t *server) {
             avs_time_duration_less(half_lifetime, max_transmit_wait)
                     ? half_lifetime
                     : max_transmit_wait;
-    return avs_time_real_add(expire_time,
-                             avs_time_duration_mul(interval_margin, -1));
+    avs_time_real_t update_time =
+            avs_time_real_add(expire_time,
+                              avs_time_duration_mul(interval_margin, -1));
+#ifdef WITH_AVS_COAP_UDP
+    avs_time_monotonic_t nat_deadline =
+            _anjay_connection_udp_nat_keepalive_deadline(
+                    (anjay_connection_ref_t) {
+                        .server = server,
+                        .conn_type = ANJAY_CONNECTION_PRIMARY
+                    });
+    if (avs_time_monotonic_valid(nat_deadline)) {
+        avs_time_real_t nat_update_time = avs_time_real_add(
+                avs_time_real_now(),
+                avs_time_monotonic_diff(nat_deadline,
+                                        avs_time_monotonic_now()));
+        if (avs_time_real_before(nat_update_time, update_time)) {
+            update_time = nat_update_time;
+        }
+    }
+#endif // WITH_AVS_COAP_UDP
+    return update_time;
 }
 
 static avs_time_real_t get_time_of_next_update(anjay_server_info_t *server) {
@@ -134,6 +158,57 @@ static avs_time_real_t get_time_of_next_update(anjay_server_info_t *server) {
     return calculate_time_of_next_update(server);
 }
 
+avs_time_real_t _anjay_server_next_update_time(anjay_server_info_t *server) {
+    if (server->ssid == ANJAY_SSID_BOOTSTRAP || !_anjay_server_active(server)
+            || server->registration_info.last_update_params.lifetime_s == 0) {
+        return AVS_TIME_REAL_INVALID;
+    }
+    return get_time_of_next_update(server);
+}
+
+avs_time_duration_t _anjay_server_wake_window(anjay_server_info_t *server) {
+    if (!server->registration_info.queue_mode
+            || !avs_time_duration_less(AVS_TIME_DURATION_ZERO,
+                                       server->anjay->queue_mode_wake_window)) {
+        return AVS_TIME_DURATION_ZERO;
+    }
+    return server->anjay->queue_mode_wake_window;
+}
+
+/**
+ * Moves @p update_time earlier, to the nearest notification trigger required
+ * by the Maximum Period attribute, if that is due within the wake window after
+ * it. The notification would wake up the device anyway, so that the Update
+ * does not need a separate wake-up.
+ */
+static avs_time_real_t
+align_update_with_notifications(anjay_server_info_t *server,
+                                avs_time_real_t update_time) {
+    avs_time_duration_t window = _anjay_server_wake_window(server);
+    if (!avs_time_duration_less(AVS_TIME_DURATION_ZERO, window)
+            || !avs_time_real_valid(update_time)) {
+        return update_time;
+    }
+    avs_time_real_t pmax_trigger =
+            _anjay_observe_next_planned_trigger(server->anjay, server->ssid,
+                                                true);
+    if (avs_time_real_valid(pmax_trigger)
+            && avs_time_real_before(pmax_trigger, update_time)
+            && !avs_time_real_before(
+                       pmax_trigger,
+                       avs_time_real_add(update_time,
+                                         avs_time_duration_mul(window, -1)))) {
+        anjay_log(DEBUG,
+                  _("aligning update for SSID ") "%u" _(
+                          " with a notification due ") "%s" _(" earlier"),
+                  server->ssid,
+                  AVS_TIME_DURATION_AS_STRING(
+                          avs_time_real_diff(update_time, pmax_trigger)));
+        return pmax_trigger;
+    }
+    return update_time;
+}
+
 static int schedule_next_update(anjay_server_info_t *server) {
     if (server->registration_info.last_update_params.lifetime_s == 0
             || !_anjay_server_active(server)) {
@@ -141,7 +216,8 @@ static int schedule_next_update(anjay_server_info_t *server) {
         // disabled or when lifetime is set to infinity (lifetime==0).
         return 0;
     }
-    avs_time_real_t update_time = calculate_time_of_next_update(server);
+    avs_time_real_t update_time = align_update_with_notifications(
+            server, calculate_time_of_next_update(server));
     avs_time_duration_t min_margin =
             avs_time_duration_from_scalar(ANJAY_MIN_UPDATE_INTERVAL_S,
                                           AVS_TIME_S);
@@ -220,23 +296,6 @@ int anjay_schedule_registration_update(anjay_t *anjay_locked,
     return result;
 }
 
-static int dm_payload_writer(size_t payload_offset,
-                             void *payload_buf,
-                             size_t payload_buf_size,
-                             size_t *out_payload_chunk_size,
-                             void *state_) {
-    anjay_registration_async_exchange_state_t *state =
-            (anjay_registration_async_exchange_state_t *) state_;
-    size_t length = state->new_params.dm ? strlen(state->new_params.dm) : 0;
-    assert(payload_offset <= length);
-    if ((*out_payload_chunk_size =
-                 AVS_MIN(length - payload_offset, payload_buf_size))) {
-        memcpy(payload_buf, &state->new_params.dm[payload_offset],
-               *out_payload_chunk_size);
-    }
-    return 0;
-}
-
 static int get_server_lifetime(anjay_unlocked_t *anjay,
                                anjay_ssid_t ssid,
                                int64_t *out_lifetime) {
@@ -266,10 +325,88 @@ static int get_server_lifetime(anjay_unlocked_t *anjay,
     return 0;
 }
 
+/**
+ * Register and Update payloads up to this size are generated once and kept in
+ * memory. Longer ones are generated from the data model block by block.
+ */
+#define MAX_BUFFERED_DM_PAYLOAD_SIZE 1024
+
+/**
+ * Destination of the CoRE Link Format payload generated by @ref query_dm.
+ *
+ * Only the bytes in the <c>[skip, skip + buf_size)</c> range are copied into
+ * @p buf - the generation is stopped as soon as it is filled. All bytes are
+ * additionally passed to @p digest and @p stream, if set. The latter is
+ * dropped if the payload exceeds @p stream_limit, unless it is zero.
+ *
+ * If @p cursor is set, the generation is resumed from it, and it is advanced
+ * to the furthest position not beyond <c>skip + buf_size</c>, so that the next
+ * block does not require walking the data model from the beginning again.
+ */
 typedef struct {
-    bool first;
+    size_t skip;
+    char *buf;
+    size_t buf_size;
+    size_t buf_written;
+    size_t total_size;
+    anjay_sha256_t *digest;
     avs_stream_t *stream;
+    size_t stream_limit;
+    anjay_dm_links_cursor_t *cursor;
+} dm_links_sink_t;
+
+static bool dm_links_sink_full(const dm_links_sink_t *sink) {
+    return sink->buf && sink->buf_written == sink->buf_size;
+}
+
+static int
+dm_links_sink_write(dm_links_sink_t *sink, const char *data, size_t size) {
+    if (sink->digest) {
+        _anjay_sha256_update(sink->digest, data, size);
+    }
+    if (sink->stream && sink->stream_limit
+            && sink->total_size + size > sink->stream_limit) {
+        avs_stream_cleanup(&sink->stream);
+    }
+    if (sink->stream
+            && avs_is_err(avs_stream_write(sink->stream, data, size))) {
+        return -1;
+    }
+    if (sink->buf && sink->total_size + size > sink->skip) {
+        const size_t offset = sink->total_size < sink->skip
+                                      ? sink->skip - sink->total_size
+                                      : 0;
+        const size_t chunk_size =
+                AVS_MIN(size - offset, sink->buf_size - sink->buf_written);
+        memcpy(&sink->buf[sink->buf_written], &data[offset], chunk_size);
+        sink->buf_written += chunk_size;
+    }
+    sink->total_size += size;
+    return 0;
+}
+
+static int dm_links_sink_write_str(dm_links_sink_t *sink, const char *str) {
+    return dm_links_sink_write(sink, str, strlen(str));
+}
+
+static void dm_links_sink_advance_cursor(dm_links_sink_t *sink,
+                                         anjay_oid_t oid,
+                                         anjay_iid_t iid) {
+    if (sink->cursor && sink->total_size <= sink->skip + sink->buf_size) {
+        *sink->cursor = (anjay_dm_links_cursor_t) {
+            .offset = sink->total_size,
+            .oid = oid,
+            .iid = iid
+        };
+    }
+}
+
+typedef struct {
+    bool first;
+    dm_links_sink_t *sink;
     anjay_lwm2m_version_t version;
+    /** Position from which the generation is resumed, or NULL. */
+    const anjay_dm_links_cursor_t *resume;
 } query_dm_args_t;
 
 static int query_dm_instance(anjay_unlocked_t *anjay,
@@ -278,12 +415,22 @@ static int query_dm_instance(anjay_unlocked_t *anjay,
                              void *args_) {
     (void) anjay;
     query_dm_args_t *args = (query_dm_args_t *) args_;
-    avs_error_t err =
-            avs_stream_write_f(args->stream, "%s</%u/%u>",
-                               args->first ? "" : ",",
-                               _anjay_dm_installed_object_oid(obj), iid);
+    const anjay_oid_t oid = _anjay_dm_installed_object_oid(obj);
+    if (args->resume && args->resume->oid == oid
+            && args->resume->iid != ANJAY_ID_INVALID
+            && iid <= args->resume->iid) {
+        // already generated; instances are iterated in ascending order
+        return 0;
+    }
+    char entry[sizeof(",</65535/65535>")];
+    int length = avs_simple_snprintf(entry, sizeof(entry), "%s</%u/%u>",
+                                     args->first ? "" : ",", oid, iid);
     args->first = false;
-    return avs_is_ok(err) ? 0 : -1;
+    if (length < 0 || dm_links_sink_write(args->sink, entry, (size_t) length)) {
+        return -1;
+    }
+    dm_links_sink_advance_cursor(args->sink, oid, iid);
+    return dm_links_sink_full(args->sink) ? ANJAY_FOREACH_BREAK : 0;
 }
 
 static int query_dm_object(anjay_unlocked_t *anjay,
@@ -298,31 +445,50 @@ static int query_dm_object(anjay_unlocked_t *anjay,
     }
 
     query_dm_args_t *args = (query_dm_args_t *) args_;
-    if (args->first) {
+    bool obj_written = false;
+    if (args->resume && oid < args->resume->oid) {
+        // already generated; objects are iterated in ascending order
+        return 0;
+    } else if (args->resume && oid == args->resume->oid
+               && args->resume->iid != ANJAY_ID_INVALID) {
+        // resuming in the middle of entries for this object
         args->first = false;
-    } else if (avs_is_err(avs_stream_write(args->stream, ",", 1))) {
-        return -1;
+        obj_written = true;
+    } else {
+        dm_links_sink_advance_cursor(args->sink, oid, ANJAY_ID_INVALID);
+        if (args->first) {
+            args->first = false;
+        } else if (dm_links_sink_write(args->sink, ",", 1)) {
+            return -1;
+        }
     }
-    bool obj_written = false;
-    const char *version = _anjay_dm_installed_object_version(obj);
+    char entry[sizeof("</65535>;ver=\"")];
+    int length;
+    const char *version = obj_written ? NULL
+                                      : _anjay_dm_installed_object_version(obj);
     if (version) {
-        const char *format = "</%u>;ver=\"%s\"";
+        const char *quote = "\"";
 #ifdef ANJAY_WITH_LWM2M11
         if (args->version > ANJAY_LWM2M_VERSION_1_0) {
-            format = "</%u>;ver=%s";
+            quote = "";
         }
 #endif // ANJAY_WITH_LWM2M11
 
-        if (avs_is_err(
-                    avs_stream_write_f(args->stream, format, oid, version))) {
+        if ((length = avs_simple_snprintf(entry, sizeof(entry), "</%u>;ver=%s",
+                                          oid, quote))
+                        < 0
+                || dm_links_sink_write(args->sink, entry, (size_t) length)
+                || dm_links_sink_write_str(args->sink, version)
+                || dm_links_sink_write_str(args->sink, quote)) {
             return -1;
         }
         obj_written = true;
     }
     query_dm_args_t instance_args = {
         .first = !obj_written,
-        .stream = args->stream,
-        .version = args->version
+        .sink = args->sink,
+        .version = args->version,
+        .resume = args->resume
     };
     int result = _anjay_dm_foreach_instance(anjay, obj, query_dm_instance,
                                             &instance_args);
@@ -333,45 +499,196 @@ static int query_dm_object(anjay_unlocked_t *anjay,
         obj_written = true;
     }
     if (!obj_written
-            && avs_is_err(avs_stream_write_f(args->stream, "</%u>", oid))) {
+            && ((length = avs_simple_snprintf(entry, sizeof(entry), "</%u>",
+                                              oid))
+                        < 0
+                || dm_links_sink_write(args->sink, entry, (size_t) length))) {
         return -1;
     }
-    return 0;
+    return dm_links_sink_full(args->sink) ? ANJAY_FOREACH_BREAK : 0;
 }
 
-static int
-query_dm(anjay_unlocked_t *anjay, anjay_lwm2m_version_t version, char **out) {
-    assert(out);
-    assert(!*out);
-    avs_stream_t *stream = avs_stream_membuf_create();
-    if (!stream) {
-        _anjay_log_oom();
-        return -1;
+static anjay_dm_object_links_format_t
+object_links_format(anjay_lwm2m_version_t version) {
+#ifdef ANJAY_WITH_LWM2M11
+    if (version > ANJAY_LWM2M_VERSION_1_0) {
+        return ANJAY_DM_OBJECT_LINKS_LWM2M11;
     }
-    int retval;
-    void *data = NULL;
-    if ((retval = _anjay_dm_foreach_object(anjay, query_dm_object,
-                                           &(query_dm_args_t) {
-                                               .first = true,
-                                               .stream = stream,
-                                               .version = version
-                                           }))
-            || (retval =
-                        (avs_is_ok(avs_stream_write(stream, "\0", 1)) ? 0 : -1))
-            || (retval = (avs_is_ok(avs_stream_membuf_take_ownership(
-                                  stream, &data, NULL))
-                                  ? 0
-                                  : -1))) {
+#else  // ANJAY_WITH_LWM2M11
+    (void) version;
+#endif // ANJAY_WITH_LWM2M11
+    return ANJAY_DM_OBJECT_LINKS_LWM2M10;
+}
+
+/**
+ * Walks the data model, passing the list of Objects and Object Instances to
+ * @p sink. If the payload is not stored, this is done separately for each
+ * block of it that is transmitted, starting from @p sink->cursor.
+ */
+static int query_dm(anjay_unlocked_t *anjay,
+                    anjay_lwm2m_version_t version,
+                    dm_links_sink_t *sink) {
+    anjay_dm_links_cursor_t resume;
+    if (sink->cursor) {
+        resume = *sink->cursor;
+        sink->total_size = resume.offset;
+    }
+    int retval = _anjay_dm_foreach_object(anjay, query_dm_object,
+                                          &(query_dm_args_t) {
+                                              .first = (sink->total_size == 0),
+                                              .sink = sink,
+                                              .version = version,
+                                              .resume = sink->cursor ? &resume
+                                                                     : NULL
+                                          });
+    if (retval) {
         anjay_log(ERROR, _("could not enumerate objects"));
     }
-    avs_stream_cleanup(&stream);
-    *out = (char *) data;
     return retval;
 }
 
+static void dm_links_fingerprint_finish(anjay_sha256_t *digest,
+                                        size_t size,
+                                        anjay_dm_links_fingerprint_t *out) {
+    out->valid = true;
+    out->size = size;
+    _anjay_sha256_finish(digest, out->digest);
+}
+
+static void
+dm_links_fingerprint_from_string(const char *str,
+                                 anjay_dm_links_fingerprint_t *out) {
+    anjay_sha256_t digest;
+    _anjay_sha256_init(&digest);
+    const size_t size = strlen(str);
+    _anjay_sha256_update(&digest, str, size);
+    dm_links_fingerprint_finish(&digest, size, out);
+}
+
+static int query_dm_payload(anjay_unlocked_t *anjay,
+                            anjay_lwm2m_version_t version,
+                            anjay_update_parameters_t *out_params) {
+    assert(!out_params->dm_payload);
+    const anjay_dm_object_links_format_t format = object_links_format(version);
+    uint32_t generation;
+    const char *cached =
+            _anjay_dm_cache_get_object_links(anjay, format, &generation);
+    if (anjay->cache_registration_payload && cached) {
+        dm_links_fingerprint_from_string(cached, &out_params->dm);
+        out_params->dm.generation = generation;
+        // long payloads are sent directly from the cache
+        if (out_params->dm.size <= MAX_BUFFERED_DM_PAYLOAD_SIZE
+                && !(out_params->dm_payload = avs_strdup(cached))) {
+            _anjay_log_oom();
+            return -1;
+        }
+        return 0;
+    }
+
+    anjay_sha256_t digest;
+    _anjay_sha256_init(&digest);
+    // failing to buffer the payload is not an error - it will be generated
+    // again while sending it
+    dm_links_sink_t sink = {
+        .digest = &digest,
+        .stream = avs_stream_membuf_create(),
+        .stream_limit = anjay->cache_registration_payload
+                                ? 0
+                                : MAX_BUFFERED_DM_PAYLOAD_SIZE
+    };
+    int retval = query_dm(anjay, version, &sink);
+    char *payload = NULL;
+    if (!retval) {
+        dm_links_fingerprint_finish(&digest, sink.total_size, &out_params->dm);
+        out_params->dm.generation = generation;
+        void *data = NULL;
+        if (sink.stream && avs_is_ok(avs_stream_write(sink.stream, "\0", 1))
+                && avs_is_ok(avs_stream_membuf_take_ownership(sink.stream,
+                                                              &data, NULL))) {
+            payload = (char *) data;
+        }
+    }
+    avs_stream_cleanup(&sink.stream);
+    if (payload && anjay->cache_registration_payload) {
+        if (sink.total_size <= MAX_BUFFERED_DM_PAYLOAD_SIZE) {
+            out_params->dm_payload = payload;
+            payload = avs_strdup(payload);
+        }
+        if (payload) {
+            _anjay_dm_cache_store_object_links(anjay, format, generation,
+                                               payload);
+        }
+    } else {
+        out_params->dm_payload = payload;
+    }
+    return retval;
+}
+
+static int dm_payload_writer(size_t payload_offset,
+                             void *payload_buf,
+                             size_t payload_buf_size,
+                             size_t *out_payload_chunk_size,
+                             void *state_) {
+    anjay_registration_async_exchange_state_t *state =
+            (anjay_registration_async_exchange_state_t *) state_;
+    anjay_server_info_t *server =
+            AVS_CONTAINER_OF(state, anjay_server_info_t,
+                             registration_exchange_state);
+    ANJAY_TRACEPOINT(payload_block, _anjay_server_ssid(server),
+                     (int) ANJAY_OPERATION_REGISTER, payload_offset);
+    const char *payload = state->new_params.dm_payload;
+    if (!payload) {
+        uint32_t generation;
+        const char *cached = _anjay_dm_cache_get_object_links(
+                server->anjay, object_links_format(state->attempted_version),
+                &generation);
+        if (generation != state->new_params.dm.generation) {
+            // blocks generated now would not match the ones already sent
+            anjay_log(INFO,
+                      _("data model changed during Register/Update for "
+                        "SSID = ") "%u" _(", restarting it"),
+                      server->ssid);
+            state->dm_changed = true;
+            return -1;
+        }
+        if (server->anjay->cache_registration_payload) {
+            payload = cached;
+        }
+    }
+    if (payload) {
+        size_t length = strlen(payload);
+        if (payload_offset < length
+                && (*out_payload_chunk_size = AVS_MIN(length - payload_offset,
+                                                      payload_buf_size))) {
+            memcpy(payload_buf, &payload[payload_offset],
+                   *out_payload_chunk_size);
+        }
+        return 0;
+    }
+
+    if (payload_offset < state->dm_cursor.offset) {
+        // retransmission of an earlier block
+        state->dm_cursor = (anjay_dm_links_cursor_t) {
+            .iid = ANJAY_ID_INVALID
+        };
+    }
+    dm_links_sink_t sink = {
+        .skip = payload_offset,
+        .buf = (char *) payload_buf,
+        .buf_size = payload_buf_size,
+        .cursor = &state->dm_cursor
+    };
+    if (query_dm(server->anjay, state->attempted_version, &sink)) {
+        return -1;
+    }
+    *out_payload_chunk_size = sink.buf_written;
+    return 0;
+}
+
 static void update_parameters_cleanup(anjay_update_parameters_t *params) {
-    avs_free(params->dm);
-    params->dm = NULL;
+    avs_free(params->dm_payload);
+    params->dm_payload = NULL;
+    params->dm.valid = false;
 }
 
 static void
@@ -413,7 +730,7 @@ update_parameters_init(anjay_server_info_t *server,
         err = avs_errno(AVS_EBADF);
         goto error;
     }
-    if (query_dm(server->anjay, lwm2m_version, &out_params->dm)) {
+    if (query_dm_payload(server->anjay, lwm2m_version, out_params)) {
         goto error;
     }
     if (get_server_lifetime(server->anjay, _anjay_server_ssid(server),
@@ -685,6 +1002,31 @@ handle_register_response(anjay_server_info_t *server,
     }
 }
 
+#ifdef ANJAY_WITH_OPERATION_STATS
+static void record_registration_stats(anjay_server_info_t *server,
+                                      anjay_registration_result_t result) {
+    const anjay_registration_async_exchange_state_t *state =
+            &server->registration_exchange_state;
+    _anjay_operation_stats_record(
+            server->anjay, _anjay_server_ssid(server), ANJAY_OPERATION_REGISTER,
+            state->handler_time,
+            avs_time_monotonic_diff(avs_time_monotonic_now(),
+                                    state->start_time),
+            result != ANJAY_REGISTRATION_SUCCESS);
+}
+
+static void start_registration_stats(anjay_server_info_t *server) {
+    server->registration_exchange_state.start_time = avs_time_monotonic_now();
+    server->registration_exchange_state.handler_time = AVS_TIME_DURATION_ZERO;
+}
+
+static void mark_registration_stats_sent(anjay_server_info_t *server) {
+    server->registration_exchange_state.handler_time = avs_time_monotonic_diff(
+            avs_time_monotonic_now(),
+            server->registration_exchange_state.start_time);
+}
+#endif // ANJAY_WITH_OPERATION_STATS
+
 static void
 receive_register_response(avs_coap_ctx_t *coap,
                           avs_coap_exchange_id_t exchange_id,
@@ -694,6 +1036,8 @@ receive_register_response(avs_coap_ctx_t *coap,
                           void *state_) {
     anjay_registration_async_exchange_state_t *state =
             (anjay_registration_async_exchange_state_t *) state_;
+    anjay_server_info_t *server = AVS_CONTAINER_OF(state, anjay_server_info_t,
+                                                   registration_exchange_state);
     anjay_registration_result_t result = ANJAY_REGISTRATION_ERROR_OTHER;
     AVS_LIST(const anjay_string_t) endpoint_path = NULL;
     if (request_state != AVS_COAP_CLIENT_REQUEST_PARTIAL_CONTENT) {
@@ -713,6 +1057,18 @@ receive_register_response(avs_coap_ctx_t *coap,
 
     case AVS_COAP_CLIENT_REQUEST_FAIL: {
         assert(avs_is_err(err));
+        if (state->dm_changed) {
+            update_parameters_cleanup(&state->new_params);
+            if (avs_is_ok(update_parameters_init(server,
+                                                 state->attempted_version,
+                                                 &state->new_params))) {
+                register_with_version(server, state->attempted_version,
+                                      &state->new_params);
+                return;
+            }
+            result = ANJAY_REGISTRATION_ERROR_OTHER;
+            break;
+        }
         anjay_log(WARNING,
                   _("failure while receiving Register response: ") "%s",
                   AVS_COAP_STRERROR(err));
@@ -724,9 +1080,12 @@ receive_register_response(avs_coap_ctx_t *coap,
         return;
     }
 
-    handle_register_response(AVS_CONTAINER_OF(state, anjay_server_info_t,
-                                              registration_exchange_state),
-                             state->attempted_version, &endpoint_path,
+    ANJAY_TRAFFIC_STATS_SET_INCOMING(server->anjay, ANJAY_OPERATION_REGISTER,
+                                     state->content_format, ANJAY_ID_INVALID);
+#ifdef ANJAY_WITH_OPERATION_STATS
+    record_registration_stats(server, result);
+#endif // ANJAY_WITH_OPERATION_STATS
+    handle_register_response(server, state->attempted_version, &endpoint_path,
                              &state->new_params, result, err);
     assert(!endpoint_path);
 }
@@ -736,10 +1095,12 @@ static void move_assign_update_params(anjay_update_parameters_t *out,
     assert(out);
     assert(move_in);
     if (out != move_in) {
-        if (move_in->dm) {
-            avs_free(out->dm);
+        if (move_in->dm.valid) {
+            avs_free(out->dm_payload);
             out->dm = move_in->dm;
-            move_in->dm = NULL;
+            out->dm_payload = move_in->dm_payload;
+            move_in->dm.valid = false;
+            move_in->dm_payload = NULL;
         }
 
         out->lifetime_s = move_in->lifetime_s;
@@ -748,6 +1109,45 @@ static void move_assign_update_params(anjay_update_parameters_t *out,
     }
 }
 
+static avs_error_t
+send_registration_request(anjay_server_info_t *server,
+                          avs_coap_ctx_t *coap,
+                          const avs_coap_request_header_t *request,
+                          avs_coap_payload_writer_t *payload_writer,
+                          avs_coap_client_async_response_handler_t *handler) {
+#ifdef ANJAY_WITH_TRAFFIC_STATS
+    if (avs_coap_options_get_content_format(
+                &request->options,
+                &server->registration_exchange_state.content_format)) {
+        server->registration_exchange_state.content_format =
+                AVS_COAP_FORMAT_NONE;
+    }
+    const anjay_connection_ref_t connection = {
+        .server = server,
+        .conn_type = ANJAY_CONNECTION_PRIMARY
+    };
+#endif // ANJAY_WITH_TRAFFIC_STATS
+    server->registration_exchange_state.dm_cursor =
+            (anjay_dm_links_cursor_t) {
+                .iid = ANJAY_ID_INVALID
+            };
+    server->registration_exchange_state.dm_changed = false;
+    ANJAY_ALLOCATION_SITE_ENTER(prev_site);
+    ANJAY_TRAFFIC_STATS_BEGIN(traffic_snapshot,
+                              _anjay_connection_get_online_socket(connection));
+    avs_error_t err = avs_coap_client_send_async_request(
+            coap, &server->registration_exchange_state.exchange_id, request,
+            payload_writer, &server->registration_exchange_state, handler,
+            &server->registration_exchange_state);
+    ANJAY_TRAFFIC_STATS_END(server->anjay, traffic_snapshot,
+                            _anjay_connection_get_online_socket(connection),
+                            ANJAY_OPERATION_REGISTER,
+                            server->registration_exchange_state.content_format,
+                            ANJAY_ID_INVALID);
+    ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
+    return err;
+}
+
 static void send_register(anjay_server_info_t *server,
                           avs_coap_ctx_t *coap,
                           anjay_lwm2m_version_t lwm2m_version,
@@ -805,19 +1205,31 @@ static void send_register(anjay_server_info_t *server,
 #ifdef ANJAY_WITH_LWM2M11
     server->registration_exchange_state.lwm2m11_queue_mode = lwm2m11_queue_mode;
 #endif // ANJAY_WITH_LWM2M11
-    if (avs_is_err(
-                (err = avs_coap_client_send_async_request(
-                         coap, &server->registration_exchange_state.exchange_id,
-                         &request, dm_payload_writer,
-                         &server->registration_exchange_state,
-                         receive_register_response,
-                         &server->registration_exchange_state)))) {
+#ifdef ANJAY_WITH_OPERATION_STATS
+    start_registration_stats(server);
+#endif // ANJAY_WITH_OPERATION_STATS
+    if (avs_is_err((err = send_registration_request(
+                            server, coap, &request, dm_payload_writer,
+                            receive_register_response)))) {
         anjay_log(ERROR, _("could not send Register: ") "%s",
                   AVS_COAP_STRERROR(err));
+#ifdef ANJAY_WITH_OPERATION_STATS
+        mark_registration_stats_sent(server);
+        record_registration_stats(server, map_coap_error(err));
+#endif // ANJAY_WITH_OPERATION_STATS
         _anjay_server_on_updated_registration(server, map_coap_error(err), err);
     } else {
         anjay_log(INFO, _("Register sent"));
+        ANJAY_TRACEPOINT(register_sent, _anjay_server_ssid(server), 0,
+                         server->registration_attempts);
+#ifdef ANJAY_WITH_OPERATION_STATS
+        mark_registration_stats_sent(server);
+#endif // ANJAY_WITH_OPERATION_STATS
         server->registration_info.update_forced = false;
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+        _anjay_startup_timestamp_mark_first(
+                &server->startup_timestamps.register_sent);
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
 #ifdef ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
         _anjay_server_set_last_communication_time(server);
 #endif // ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
@@ -870,8 +1282,14 @@ static void do_register(anjay_server_info_t *server,
     register_with_version(server, attempted_version, move_params);
 }
 
-static inline bool dm_caches_equal(const char *left, const char *right) {
-    return strcmp(left ? left : "", right ? right : "") == 0;
+static inline bool
+dm_caches_equal(const anjay_dm_links_fingerprint_t *left,
+                const anjay_dm_links_fingerprint_t *right) {
+    const size_t left_size = left->valid ? left->size : 0;
+    const size_t right_size = right->valid ? right->size : 0;
+    return left_size == right_size
+           && (!left_size
+               || !memcmp(left->digest, right->digest, sizeof(left->digest)));
 }
 
 static avs_error_t
@@ -897,7 +1315,7 @@ setup_update_request_options(anjay_unlocked_t *anjay,
                                        : new_params->binding_mode.data;
     const char *sms_msisdn = NULL;
     *out_dm_changed_since_last_update =
-            !dm_caches_equal(old_params->dm, new_params->dm);
+            !dm_caches_equal(&old_params->dm, &new_params->dm);
 
     avs_error_t err;
     (void) ((*out_dm_changed_since_last_update
@@ -1033,8 +1451,20 @@ receive_update_response(avs_coap_ctx_t *coap,
 
     case AVS_COAP_CLIENT_REQUEST_FAIL: {
         assert(avs_is_err(err));
+        if (state->dm_changed) {
+            update_parameters_cleanup(&state->new_params);
+            server->registration_info.update_forced = true;
+            _anjay_server_ensure_valid_registration(server);
+            return;
+        }
         anjay_log(WARNING, _("failure while receiving Update response: ") "%s",
                   AVS_COAP_STRERROR(err));
+        _anjay_connection_udp_nat_request_failed(
+                (anjay_connection_ref_t) {
+                    .server = server,
+                    .conn_type = ANJAY_CONNECTION_PRIMARY
+                },
+                err);
         result = map_coap_error(err);
         break;
     }
@@ -1044,6 +1474,11 @@ receive_update_response(avs_coap_ctx_t *coap,
         server->registration_info.update_forced = true;
         return;
     }
+    ANJAY_TRAFFIC_STATS_SET_INCOMING(server->anjay, ANJAY_OPERATION_REGISTER,
+                                     state->content_format, ANJAY_ID_INVALID);
+#ifdef ANJAY_WITH_OPERATION_STATS
+    record_registration_stats(server, result);
+#endif // ANJAY_WITH_OPERATION_STATS
 #ifdef ANJAY_WITH_CONN_STATUS_API
     if (result == ANJAY_REGISTRATION_ERROR_TIMEOUT
             || result == ANJAY_REGISTRATION_ERROR_REJECTED) {
@@ -1095,20 +1530,32 @@ static void send_update(anjay_server_info_t *server,
             (old_info->queue_mode
              && old_info->lwm2m_version >= ANJAY_LWM2M_VERSION_1_1);
 #endif // ANJAY_WITH_LWM2M11
-    if (avs_is_err((
-                err = avs_coap_client_send_async_request(
-                        coap, &server->registration_exchange_state.exchange_id,
-                        &request,
-                        dm_changed_since_last_update ? dm_payload_writer : NULL,
-                        &server->registration_exchange_state,
-                        receive_update_response,
-                        &server->registration_exchange_state)))) {
+#ifdef ANJAY_WITH_OPERATION_STATS
+    start_registration_stats(server);
+#endif // ANJAY_WITH_OPERATION_STATS
+    if (avs_is_err((err = send_registration_request(
+                            server, coap, &request,
+                            dm_changed_since_last_update ? dm_payload_writer
+                                                         : NULL,
+                            receive_update_response)))) {
         anjay_log(ERROR, _("could not send Update: ") "%s",
                   AVS_COAP_STRERROR(err));
+#ifdef ANJAY_WITH_OPERATION_STATS
+        mark_registration_stats_sent(server);
+        record_registration_stats(server, map_coap_error(err));
+#endif // ANJAY_WITH_OPERATION_STATS
         on_registration_update_result(server, move_params, map_coap_error(err),
                                       err);
     } else {
         anjay_log(INFO, _("Update sent"));
+        ANJAY_TRACEPOINT(register_sent, _anjay_server_ssid(server), 1, 1);
+        _anjay_connection_udp_nat_request_sent((anjay_connection_ref_t) {
+            .server = server,
+            .conn_type = ANJAY_CONNECTION_PRIMARY
+        });
+#ifdef ANJAY_WITH_OPERATION_STATS
+        mark_registration_stats_sent(server);
+#endif // ANJAY_WITH_OPERATION_STATS
         server->registration_info.update_forced = false;
 #ifdef ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
         _anjay_server_set_last_communication_time(server);
@@ -1127,7 +1574,7 @@ static bool params_require_registration_update(
     return old_params->lifetime_s != new_params->lifetime_s
            || strcmp(old_params->binding_mode.data,
                      new_params->binding_mode.data)
-           || !dm_caches_equal(old_params->dm, new_params->dm);
+           || !dm_caches_equal(&old_params->dm, &new_params->dm);
 }
 
 static void update_registration(anjay_server_info_t *server,
@@ -1360,6 +1807,9 @@ void _anjay_server_update_registration_info(
 
     if (move_params) {
         move_assign_update_params(&info->last_update_params, move_params);
+        // only the fingerprint is needed to detect further changes
+        avs_free(info->last_update_params.dm_payload);
+        info->last_update_params.dm_payload = NULL;
     }
 
     info->lwm2m_version = lwm2m_version;
@@ -1458,14 +1908,14 @@ avs_time_real_t anjay_registration_expiration_time_with_status(
         *out_status = ANJAY_REGISTRATION_EXPIRATION_STATUS_EXPIRED;
     }
 
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    ANJAY_MUTEX_LOCK_SHARED(anjay, anjay_locked);
     anjay_server_info_t *server = _anjay_servers_find_active(anjay, ssid);
 
     if (server) {
         result =
                 _anjay_registration_expire_time_with_status(server, out_status);
     }
-    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    ANJAY_MUTEX_UNLOCK_SHARED(anjay_locked);
     return result;
 }
 
@@ -1504,10 +1954,10 @@ next_planned_lifecycle_operation(anjay_server_info_t *server) {
     }
 }
 
-avs_time_real_t anjay_next_planned_lifecycle_operation(anjay_t *anjay_locked,
-                                                       anjay_ssid_t ssid) {
+avs_time_real_t
+_anjay_next_planned_lifecycle_operation_unlocked(anjay_unlocked_t *anjay,
+                                                 anjay_ssid_t ssid) {
     avs_time_real_t result = AVS_TIME_REAL_INVALID;
-    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     if (ssid == ANJAY_SSID_ANY) {
         AVS_LIST(anjay_server_info_t) it;
         AVS_LIST_FOREACH(it, anjay->servers) {
@@ -1526,6 +1976,14 @@ avs_time_real_t anjay_next_planned_lifecycle_operation(anjay_t *anjay_locked,
             result = next_planned_lifecycle_operation(server);
         }
     }
+    return result;
+}
+
+avs_time_real_t anjay_next_planned_lifecycle_operation(anjay_t *anjay_locked,
+                                                       anjay_ssid_t ssid) {
+    avs_time_real_t result = AVS_TIME_REAL_INVALID;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    result = _anjay_next_planned_lifecycle_operation_unlocked(anjay, ssid);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return result;
 }
@@ -1554,6 +2012,30 @@ avs_time_real_t anjay_transport_next_planned_lifecycle_operation(
     return result;
 }
 
+static void take_earlier(avs_time_real_t *result, avs_time_real_t time) {
+    if (avs_time_real_valid(time)
+            && (!avs_time_real_valid(*result)
+                || avs_time_real_before(time, *result))) {
+        *result = time;
+    }
+}
+
+avs_time_real_t anjay_next_planned_wake_time(anjay_t *anjay_locked,
+                                             anjay_ssid_t ssid) {
+    avs_time_real_t result = AVS_TIME_REAL_INVALID;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    result = _anjay_next_planned_lifecycle_operation_unlocked(anjay, ssid);
+    if (ssid != ANJAY_SSID_BOOTSTRAP) {
+        take_earlier(&result,
+                     _anjay_observe_next_planned_trigger(anjay, ssid, false));
+#ifdef ANJAY_WITH_SEND
+        take_earlier(&result, _anjay_send_next_planned_retry(anjay));
+#endif // ANJAY_WITH_SEND
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
 #ifdef ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
 avs_error_t anjay_get_server_last_registration_time(anjay_t *anjay,
                                                     anjay_ssid_t ssid,
@@ -1681,3 +2163,298 @@ avs_error_t anjay_get_server_last_communication_time(
     return err;
 }
 #endif // ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
+
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+avs_error_t anjay_get_server_startup_timestamps(
+        anjay_t *anjay,
+        anjay_ssid_t ssid,
+        anjay_server_startup_timestamps_t *out_timestamps) {
+    assert(anjay);
+    assert(out_timestamps);
+
+    avs_error_t err = avs_errno(AVS_EBUSY);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_server_info_t *server = NULL;
+    if (ssid == ANJAY_SSID_ANY) {
+        err = avs_errno(AVS_EINVAL);
+    } else if (!(server = _anjay_servers_find(anjay_unlocked, ssid))) {
+        anjay_log(WARNING, _("no server with SSID = ") "%u", ssid);
+        err = avs_errno(AVS_EEXIST);
+    } else {
+        *out_timestamps = server->startup_timestamps;
+        err = AVS_OK;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    return err;
+}
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+
+#ifdef ANJAY_WITH_STATE_PERSISTENCE
+static const char REGISTRATIONS_MAGIC[] = "ARS";
+
+/**
+ * Version 1 replaces the stored Register payload with its fingerprint.
+ */
+static const uint8_t REGISTRATIONS_VERSIONS[] = { 0, 1 };
+
+static avs_error_t persist_real_time(avs_persistence_context_t *ctx,
+                                     avs_time_real_t *time) {
+    bool valid = avs_time_real_valid(*time);
+    int64_t ms = 0;
+    if (valid && avs_time_real_to_scalar(&ms, AVS_TIME_MS, *time)) {
+        valid = false;
+    }
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_persistence_bool(ctx, &valid)))
+            || (valid && avs_is_err((err = avs_persistence_i64(ctx, &ms)))));
+    if (avs_is_ok(err)
+            && avs_persistence_direction(ctx) == AVS_PERSISTENCE_RESTORE) {
+        *time = valid ? avs_time_real_from_scalar(ms, AVS_TIME_MS)
+                      : AVS_TIME_REAL_INVALID;
+    }
+    return err;
+}
+
+static avs_error_t
+persist_endpoint_path(avs_persistence_context_t *ctx,
+                      AVS_LIST(const anjay_string_t) *path) {
+    uint32_t count = (uint32_t) AVS_LIST_SIZE(*path);
+    avs_error_t err = avs_persistence_u32(ctx, &count);
+    if (avs_persistence_direction(ctx) == AVS_PERSISTENCE_STORE) {
+        AVS_LIST(const anjay_string_t) segment;
+        AVS_LIST_FOREACH(segment, *path) {
+            if (avs_is_err(err)) {
+                break;
+            }
+            char *str = (char *) (intptr_t) segment->c_str;
+            err = avs_persistence_string(ctx, &str);
+        }
+        return err;
+    }
+    AVS_LIST(const anjay_string_t) *tail_ptr = path;
+    for (uint32_t i = 0; avs_is_ok(err) && i < count; ++i) {
+        char *str = NULL;
+        if (avs_is_ok((err = avs_persistence_string(ctx, &str)))) {
+            const size_t size = (str ? strlen(str) : 0) + 1;
+            AVS_LIST(anjay_string_t) segment =
+                    (AVS_LIST(anjay_string_t)) AVS_LIST_NEW_BUFFER(size);
+            if (!segment) {
+                _anjay_log_oom();
+                err = avs_errno(AVS_ENOMEM);
+            } else {
+                memcpy(segment, str ? str : "", size);
+                AVS_LIST_INSERT(tail_ptr, segment);
+                AVS_LIST_ADVANCE_PTR(&tail_ptr);
+            }
+        }
+        avs_free(str);
+    }
+    return err;
+}
+
+static avs_error_t
+persist_dm_links_fingerprint(avs_persistence_context_t *ctx,
+                             uint8_t version,
+                             anjay_dm_links_fingerprint_t *fingerprint) {
+    avs_error_t err;
+    if (version < 1) {
+        assert(avs_persistence_direction(ctx) == AVS_PERSISTENCE_RESTORE);
+        char *dm = NULL;
+        if (avs_is_ok((err = avs_persistence_string(ctx, &dm)))) {
+            if (dm) {
+                dm_links_fingerprint_from_string(dm, fingerprint);
+            }
+            avs_free(dm);
+        }
+        return err;
+    }
+    uint32_t size = (uint32_t) fingerprint->size;
+    (void) (avs_is_err((err = avs_persistence_bool(ctx, &fingerprint->valid)))
+            || avs_is_err((err = avs_persistence_u32(ctx, &size)))
+            || avs_is_err((err = avs_persistence_bytes(
+                                   ctx, fingerprint->digest,
+                                   sizeof(fingerprint->digest)))));
+    fingerprint->size = size;
+    return err;
+}
+
+static avs_error_t
+registration_persistence_handler(avs_persistence_context_t *ctx,
+                                 uint8_t version,
+                                 anjay_registration_restored_t *entry) {
+    anjay_registration_info_t *info = &entry->info;
+    uint8_t lwm2m_version = (uint8_t) info->lwm2m_version;
+    avs_time_real_t last_registration_time = AVS_TIME_REAL_INVALID;
+#    ifdef ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
+    last_registration_time = info->last_registration_time;
+#    endif // ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_persistence_u16(ctx, &entry->ssid)))
+            || avs_is_err((err = avs_persistence_u8(ctx, &lwm2m_version)))
+            || avs_is_err((err = avs_persistence_bool(ctx, &info->queue_mode)))
+            || avs_is_err((err = persist_real_time(ctx, &info->expire_time)))
+            || avs_is_err((err = persist_real_time(ctx,
+                                                   &last_registration_time)))
+            || avs_is_err((err = avs_persistence_i64(
+                                   ctx, &info->last_update_params.lifetime_s)))
+            || avs_is_err((err = avs_persistence_bytes(
+                                   ctx,
+                                   info->last_update_params.binding_mode.data,
+                                   sizeof(info->last_update_params.binding_mode
+                                                  .data))))
+            || avs_is_err((err = persist_dm_links_fingerprint(
+                                   ctx, version, &info->last_update_params.dm)))
+            || avs_is_err((err = persist_endpoint_path(
+                                   ctx, &info->endpoint_path))));
+    if (avs_is_ok(err)
+            && avs_persistence_direction(ctx) == AVS_PERSISTENCE_RESTORE) {
+        info->lwm2m_version = (anjay_lwm2m_version_t) lwm2m_version;
+        // binding mode is always a NULL-terminated string in memory
+        info->last_update_params.binding_mode
+                .data[sizeof(info->last_update_params.binding_mode.data) - 1] =
+                '\0';
+#    ifdef ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
+        info->last_registration_time = last_registration_time;
+#    endif // ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
+        if (entry->ssid == ANJAY_SSID_ANY || entry->ssid == ANJAY_SSID_BOOTSTRAP
+                || lwm2m_version > ANJAY_LWM2M_VERSION_1_1) {
+            err = avs_errno(AVS_EBADMSG);
+        }
+    }
+    return err;
+}
+
+void _anjay_registrations_restored_cleanup(
+        AVS_LIST(anjay_registration_restored_t) *entries) {
+    AVS_LIST_CLEAR(entries) {
+        _anjay_registration_info_cleanup(&(*entries)->info);
+    }
+}
+
+static avs_error_t
+persist_registration(avs_persistence_context_t *ctx,
+                     uint8_t version,
+                     anjay_ssid_t ssid,
+                     const anjay_registration_info_t *info) {
+    // the handler does not modify the entry when storing
+    anjay_registration_restored_t entry = {
+        .ssid = ssid,
+        .info = *info
+    };
+    return registration_persistence_handler(ctx, version, &entry);
+}
+
+avs_error_t _anjay_registrations_persist(anjay_unlocked_t *anjay,
+                                         avs_stream_t *out_stream) {
+    uint32_t count = (uint32_t) AVS_LIST_SIZE(anjay->registrations_restored);
+    AVS_LIST(anjay_server_info_t) server;
+    AVS_LIST_FOREACH(server, anjay->servers) {
+        if (server->ssid != ANJAY_SSID_BOOTSTRAP
+                && !_anjay_server_registration_expired(server)) {
+            ++count;
+        }
+    }
+
+    avs_persistence_context_t ctx =
+            avs_persistence_store_context_create(out_stream);
+    uint8_t version = 1;
+    avs_error_t err;
+    (void) (avs_is_err((err = avs_persistence_magic_string(
+                                &ctx, REGISTRATIONS_MAGIC)))
+            || avs_is_err((err = avs_persistence_version(
+                                   &ctx, &version, REGISTRATIONS_VERSIONS,
+                                   sizeof(REGISTRATIONS_VERSIONS))))
+            || avs_is_err((err = avs_persistence_u32(&ctx, &count))));
+    AVS_LIST_FOREACH(server, anjay->servers) {
+        if (avs_is_err(err)) {
+            break;
+        }
+        if (server->ssid != ANJAY_SSID_BOOTSTRAP
+                && !_anjay_server_registration_expired(server)) {
+            err = persist_registration(&ctx, version, server->ssid,
+                                       &server->registration_info);
+        }
+    }
+    AVS_LIST(anjay_registration_restored_t) entry;
+    AVS_LIST_FOREACH(entry, anjay->registrations_restored) {
+        if (avs_is_err(err)) {
+            break;
+        }
+        err = persist_registration(&ctx, version, entry->ssid, &entry->info);
+    }
+    return err;
+}
+
+static avs_error_t
+read_registrations(avs_stream_t *in_stream,
+                   AVS_LIST(anjay_registration_restored_t) *out_entries) {
+    avs_persistence_context_t ctx =
+            avs_persistence_restore_context_create(in_stream);
+    uint8_t version;
+    uint32_t count;
+    avs_error_t err;
+    if (avs_is_err((err = avs_persistence_magic_string(&ctx,
+                                                       REGISTRATIONS_MAGIC)))
+            || avs_is_err((err = avs_persistence_version(
+                                   &ctx, &version, REGISTRATIONS_VERSIONS,
+                                   sizeof(REGISTRATIONS_VERSIONS))))
+            || avs_is_err((err = avs_persistence_u32(&ctx, &count)))) {
+        return err;
+    }
+    AVS_LIST(anjay_registration_restored_t) *tail_ptr = out_entries;
+    for (uint32_t i = 0; i < count; ++i) {
+        AVS_LIST(anjay_registration_restored_t) entry =
+                AVS_LIST_NEW_ELEMENT(anjay_registration_restored_t);
+        if (!entry) {
+            _anjay_log_oom();
+            return avs_errno(AVS_ENOMEM);
+        }
+        AVS_LIST_INSERT(tail_ptr, entry);
+        AVS_LIST_ADVANCE_PTR(&tail_ptr);
+        if (avs_is_err((err = registration_persistence_handler(&ctx, version,
+                                                               entry)))) {
+            return err;
+        }
+    }
+    return AVS_OK;
+}
+
+avs_error_t _anjay_registrations_restore(anjay_unlocked_t *anjay,
+                                         avs_stream_t *in_stream) {
+    AVS_LIST(anjay_registration_restored_t) entries = NULL;
+    avs_error_t err = read_registrations(in_stream, &entries);
+    if (avs_is_ok(err)) {
+        _anjay_registrations_restored_cleanup(&anjay->registrations_restored);
+        anjay->registrations_restored = entries;
+        entries = NULL;
+    }
+    _anjay_registrations_restored_cleanup(&entries);
+    return err;
+}
+
+void _anjay_server_apply_restored_registration(anjay_server_info_t *server) {
+    AVS_LIST(anjay_registration_restored_t) *entry_ptr;
+    AVS_LIST_FOREACH_PTR(entry_ptr, &server->anjay->registrations_restored) {
+        if ((*entry_ptr)->ssid == server->ssid) {
+            break;
+        }
+    }
+    if (!*entry_ptr) {
+        return;
+    }
+    _anjay_registration_info_cleanup(&server->registration_info);
+    server->registration_info = (*entry_ptr)->info;
+    // The registration is bound to the current session token of the
+    // connection. It stays valid only if the (D)TLS session is resumed on
+    // connect; otherwise the token changes and a Register is performed.
+    server->registration_info.session_token =
+            _anjay_server_primary_session_token(server);
+    // the server may need to learn the new address of the client
+    server->registration_info.update_forced = true;
+    anjay_log(DEBUG, _("using restored registration for SSID ") "%u",
+              (unsigned) server->ssid);
+    AVS_LIST_DELETE(entry_ptr);
+}
+#endif // ANJAY_WITH_STATE_PERSISTENCE
@@ -24,13 +24,54 @@
 
 VISIBILITY_SOURCE_BEGIN
 
+typedef struct {
+    AVS_LIST(anjay_server_info_t) *old_servers;
+    /**
+     * Servers for which no DTLS session is cached, so that connecting them
+     * will likely require a full handshake. Socket connections are blocking,
+     * so these are activated only after all the others, to let the servers
+     * that can resume their sessions quickly connect and register without
+     * waiting for the slow handshakes.
+     */
+    AVS_LIST(anjay_server_info_t *) deferred_activations;
+    int retval;
+} reload_servers_state_t;
+
+static int sched_activate(reload_servers_state_t *state,
+                          anjay_server_info_t *server) {
+    if (!_anjay_connections_has_cached_session(server)) {
+        AVS_LIST(anjay_server_info_t *) entry =
+                AVS_LIST_NEW_ELEMENT(anjay_server_info_t *);
+        // in case of OOM, just schedule activation right away; the order is
+        // only an optimization
+        if (entry) {
+            *entry = server;
+            AVS_LIST_APPEND(&state->deferred_activations, entry);
+            return 0;
+        }
+    }
+    return _anjay_server_sched_activate(server);
+}
+
+static int sched_deferred_activations(reload_servers_state_t *state) {
+    int result = 0;
+    AVS_LIST_CLEAR(&state->deferred_activations) {
+        int partial_result =
+                _anjay_server_sched_activate(*state->deferred_activations);
+        if (!result) {
+            result = partial_result;
+        }
+    }
+    return result;
+}
+
 static int reload_server_by_ssid(anjay_unlocked_t *anjay,
-                                 AVS_LIST(anjay_server_info_t) *old_servers,
+                                 reload_servers_state_t *state,
                                  anjay_ssid_t ssid) {
     anjay_log(TRACE, _("reloading server SSID ") "%u", ssid);
 
     AVS_LIST(anjay_server_info_t) *server_ptr =
-            _anjay_servers_find_ptr(old_servers, ssid);
+            _anjay_servers_find_ptr(state->old_servers, ssid);
     if (server_ptr) {
         AVS_LIST(anjay_server_info_t) server = AVS_LIST_DETACH(server_ptr);
         _anjay_servers_add(&anjay->servers, server);
@@ -42,7 +83,7 @@ static int reload_server_by_ssid(anjay_unlocked_t *anjay,
                                                       AVS_TIME_DURATION_ZERO);
             } else if (!server->next_action_handle
                        && avs_time_real_valid(server->reactivate_time)) {
-                return _anjay_server_sched_activate(server);
+                return sched_activate(state, server);
             }
         }
         return 0;
@@ -60,7 +101,7 @@ static int reload_server_by_ssid(anjay_unlocked_t *anjay,
     if ((ssid != ANJAY_SSID_BOOTSTRAP && !_anjay_bootstrap_in_progress(anjay))
             || _anjay_bootstrap_legacy_server_initiated_allowed(anjay)) {
         new_server->reactivate_time = avs_time_real_now();
-        result = _anjay_server_sched_activate(new_server);
+        result = sched_activate(state, new_server);
     }
 #ifdef ANJAY_WITH_CONN_STATUS_API
     _anjay_set_server_connection_status(new_server,
@@ -69,11 +110,6 @@ static int reload_server_by_ssid(anjay_unlocked_t *anjay,
     return result;
 }
 
-typedef struct {
-    AVS_LIST(anjay_server_info_t) *old_servers;
-    int retval;
-} reload_servers_state_t;
-
 static int reload_server_by_server_iid(anjay_unlocked_t *anjay,
                                        const anjay_dm_installed_object_t *obj,
                                        anjay_iid_t iid,
@@ -87,7 +123,7 @@ static int reload_server_by_server_iid(anjay_unlocked_t *anjay,
         return 0;
     }
 
-    if (reload_server_by_ssid(anjay, state->old_servers, ssid)) {
+    if (reload_server_by_ssid(anjay, state, ssid)) {
         anjay_log(TRACE, _("could not reload server SSID ") "%u", ssid);
         state->retval = -1;
     }
@@ -103,8 +139,10 @@ static void reload_servers_sched_job(avs_sched_t *sched, const void *unused) {
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     AVS_LIST(anjay_server_info_t) old_servers = anjay->servers;
     anjay->servers = NULL;
+    _anjay_servers_changed(anjay);
     reload_servers_state_t reload_state = {
         .old_servers = &old_servers,
+        .deferred_activations = NULL,
         .retval = 0
     };
 
@@ -118,9 +156,12 @@ static void reload_servers_sched_job(avs_sched_t *sched, const void *unused) {
     }
     if (!reload_state.retval
             && _anjay_find_bootstrap_security_iid(anjay) != ANJAY_ID_INVALID) {
-        reload_state.retval = reload_server_by_ssid(anjay, &old_servers,
+        reload_state.retval = reload_server_by_ssid(anjay, &reload_state,
                                                     ANJAY_SSID_BOOTSTRAP);
     }
+    if (sched_deferred_activations(&reload_state) && !reload_state.retval) {
+        reload_state.retval = -1;
+    }
 
     // If the only entry we have is a bootstrap server that's inactive and not
     // scheduled for activation - schedule that. It's necessary to perform
@@ -154,7 +195,6 @@ static void reload_servers_sched_job(avs_sched_t *sched, const void *unused) {
             anjay_log(WARNING,
                       _("Security object not present, no servers to create"));
         }
-        _anjay_observe_gc(anjay);
     }
 
     _anjay_servers_internal_deregister(&old_servers);
@@ -164,14 +204,12 @@ static void reload_servers_sched_job(avs_sched_t *sched, const void *unused) {
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
 
-static int schedule_reload_servers(anjay_unlocked_t *anjay, bool delayed) {
-    static const long RELOAD_DELAY_S = 5;
+static int schedule_reload_servers(anjay_unlocked_t *anjay,
+                                   avs_time_duration_t delay) {
     if (!anjay->sched
-            || AVS_SCHED_DELAYED(
-                       anjay->sched, &anjay->reload_servers_sched_job_handle,
-                       avs_time_duration_from_scalar(
-                               delayed ? RELOAD_DELAY_S : 0, AVS_TIME_S),
-                       reload_servers_sched_job, NULL, 0)) {
+            || AVS_SCHED_DELAYED(anjay->sched,
+                                 &anjay->reload_servers_sched_job_handle, delay,
+                                 reload_servers_sched_job, NULL, 0)) {
         anjay_log(ERROR, _("could not schedule reload_servers_job"));
         return -1;
     }
@@ -179,11 +217,13 @@ static int schedule_reload_servers(anjay_unlocked_t *anjay, bool delayed) {
 }
 
 int _anjay_schedule_reload_servers(anjay_unlocked_t *anjay) {
-    return schedule_reload_servers(anjay, false);
+    return schedule_reload_servers(anjay, AVS_TIME_DURATION_ZERO);
 }
 
 int _anjay_schedule_delayed_reload_servers(anjay_unlocked_t *anjay) {
-    return schedule_reload_servers(anjay, true);
+    static const long RELOAD_DELAY_S = 5;
+    return schedule_reload_servers(
+            anjay, avs_time_duration_from_scalar(RELOAD_DELAY_S, AVS_TIME_S));
 }
 
 int _anjay_schedule_refresh_server(anjay_server_info_t *server,
@@ -366,12 +406,25 @@ int anjay_transport_set_online(anjay_t *anjay_locked,
  *   servers that have reached the ICMP failure limit
  * - Calls _anjay_downloader_sched_reconnect_all() to reconnect downloader
  *   sockets
+ *
+ * If anjay_configuration_t::reconnect_jitter is set, the reload and
+ * reactivation of the servers are delayed by a random time within it.
  */
 int anjay_transport_schedule_reconnect(anjay_t *anjay_locked,
                                        anjay_transport_set_t transport_set) {
     int result = -1;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    if (!(result = exit_offline_unlocked(anjay, transport_set))) {
+    const avs_time_duration_t jitter =
+            _anjay_random_duration(anjay, AVS_TIME_DURATION_ZERO,
+                                   anjay->reconnect_jitter);
+    if (!(result = exit_offline_unlocked(anjay, transport_set))
+            && avs_time_duration_less(AVS_TIME_DURATION_ZERO, jitter)) {
+        anjay_log(DEBUG, _("delaying reconnect by ") "%s",
+                  AVS_TIME_DURATION_AS_STRING(jitter));
+        avs_sched_del(&anjay->reload_servers_sched_job_handle);
+        result = schedule_reload_servers(anjay, jitter);
+    }
+    if (!result) {
         AVS_LIST(anjay_server_info_t) server;
         AVS_LIST_FOREACH(server, anjay->servers) {
             anjay_connection_type_t conn_type;
@@ -389,7 +442,7 @@ int anjay_transport_schedule_reconnect(anjay_t *anjay_locked,
                 }
             }
         }
-        result = _anjay_servers_sched_reactivate_all_given_up(anjay);
+        result = _anjay_servers_sched_reactivate_all_given_up(anjay, jitter);
 #ifdef ANJAY_WITH_DOWNLOADER
         if (!result) {
             result = _anjay_downloader_sched_reconnect_by_transports(
@@ -401,6 +454,67 @@ int anjay_transport_schedule_reconnect(anjay_t *anjay_locked,
     return result;
 }
 
+static void rebind_sched_job(avs_sched_t *sched, const void *unused) {
+    (void) unused;
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    const anjay_transport_set_t transport_set = anjay->rebind_transports;
+    memset(&anjay->rebind_transports, 0, sizeof(anjay->rebind_transports));
+    AVS_LIST(anjay_server_info_t) server;
+    AVS_LIST_FOREACH(server, anjay->servers) {
+        bool needs_refresh = false;
+        anjay_connection_type_t conn_type;
+        ANJAY_CONNECTION_TYPE_FOREACH(conn_type) {
+            const anjay_connection_ref_t ref = {
+                .server = server,
+                .conn_type = conn_type
+            };
+            anjay_server_connection_t *connection =
+                    _anjay_get_server_connection(ref);
+            // suspended connections will be reconnected when needed anyway
+            if (!_anjay_connection_is_online(connection)
+                    || !_anjay_socket_transport_included(
+                               transport_set, connection->transport)
+                    || avs_is_ok(_anjay_server_connection_internal_rebind(
+                               server, conn_type))) {
+                continue;
+            }
+            anjay_log(DEBUG,
+                      _("falling back to reconnect for SSID ") "%" PRIu16,
+                      server->ssid);
+            _anjay_connection_suspend(ref);
+            needs_refresh = true;
+        }
+        if (needs_refresh) {
+            (void) _anjay_schedule_refresh_server(server,
+                                                  AVS_TIME_DURATION_ZERO);
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+int anjay_transport_schedule_rebind(anjay_t *anjay_locked,
+                                    anjay_transport_set_t transport_set) {
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    if (!anjay->sched
+            || (!anjay->rebind_sched_job_handle
+                && AVS_SCHED_NOW(anjay->sched, &anjay->rebind_sched_job_handle,
+                                 rebind_sched_job, NULL, 0))) {
+        anjay_log(ERROR, _("could not schedule rebind_sched_job"));
+    } else {
+        anjay->rebind_transports =
+                transport_set_union(anjay->rebind_transports, transport_set);
+        result = 0;
+#ifdef ANJAY_WITH_DOWNLOADER
+        result = _anjay_downloader_sched_reconnect_by_transports(
+                &anjay->downloader, transport_set);
+#endif // ANJAY_WITH_DOWNLOADER
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
 void _anjay_security_config_cache_cleanup(
         anjay_security_config_cache_t *cache) {
     avs_free(cache->psk_key);
@@ -413,3 +527,7 @@ void _anjay_security_config_cache_cleanup(
     avs_free(cache->ciphersuites.ids);
     memset(cache, 0, sizeof(*cache));
 }
+
+#ifdef ANJAY_TEST
+#    include "tests/core/servers/reload.c"
+#endif // ANJAY_TEST
@@ -14,6 +14,7 @@
 #include <avsystem/commons/avs_stream_membuf.h>
 #include <avsystem/commons/avs_utils.h>
 
+#include "../anjay_cert_chain.h"
 #include "../anjay_io_core.h"
 
 #define ANJAY_SERVERS_CONNECTION_SOURCE
@@ -186,21 +187,21 @@ static avs_error_t init_cert_security(anjay_unlocked_t *anjay,
     avs_net_certificate_info_t certificate_info = {
         .ignore_system_trust_store = true
     };
+    size_t client_cert_count = 0;
 
     {
         AVS_STATIC_ASSERT(sizeof(*cache->client_cert_array)
                                   == sizeof(avs_crypto_security_info_union_t),
                           certificate_chain_info_equivalent_to_union);
-        size_t element_count = 0;
         avs_error_t err = _anjay_dm_read_security_info(
                 anjay, security_iid, ANJAY_DM_RID_SECURITY_PK_OR_IDENTITY,
                 AVS_CRYPTO_SECURITY_INFO_CERTIFICATE_CHAIN,
                 (avs_crypto_security_info_union_t **) &cache->client_cert_array,
-                &element_count);
+                &client_cert_count);
         if (avs_is_err(err)) {
             return err;
         }
-        switch (element_count) {
+        switch (client_cert_count) {
         case 0:
             break;
         case 1:
@@ -209,7 +210,7 @@ static avs_error_t init_cert_security(anjay_unlocked_t *anjay,
         default:
             certificate_info.client_cert =
                     avs_crypto_certificate_chain_info_from_array(
-                            cache->client_cert_array, element_count);
+                            cache->client_cert_array, client_cert_count);
         }
     }
 
@@ -319,6 +320,13 @@ static avs_error_t init_cert_security(anjay_unlocked_t *anjay,
             // Enforce usage of non-initial trust store
             certificate_info.server_cert_validation = true;
         }
+        if (certificate_info.rebuild_client_cert_chain
+                && avs_is_err((err = _anjay_client_cert_chain_complete(
+                                       anjay, security_iid, trust_store, cache,
+                                       client_cert_count,
+                                       &certificate_info)))) {
+            return err;
+        }
     }
     if (dane_tlsa_record.certificate_usage == AVS_NET_SOCKET_DANE_CA_CONSTRAINT
             || dane_tlsa_record.certificate_usage
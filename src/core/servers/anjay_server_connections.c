@@ -10,10 +10,15 @@
 #include <anjay_init.h>
 
 #include <inttypes.h>
+#include <limits.h>
 
 #include <avsystem/commons/avs_stream_net.h>
 #include <avsystem/commons/avs_utils.h>
 
+#if defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
+#    include <avsystem/coap/tcp.h>
+#endif // defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
+
 #define ANJAY_SERVERS_INTERNALS
 
 #include "../anjay_servers_reload.h"
@@ -375,11 +380,148 @@ void _anjay_connection_suspend(anjay_connection_ref_t conn_ref) {
     avs_net_socket_t *socket = _anjay_connection_internal_get_socket(conn);
     cancel_exchanges(conn_ref);
     if (socket) {
+        _anjay_socket_set_changed(conn_ref.server->anjay);
         avs_net_socket_shutdown(socket);
         avs_net_socket_close(socket);
     }
 }
 
+#ifdef WITH_AVS_COAP_UDP
+// Number of successful exchanges after which a NAT binding lifetime estimate
+// is increased again, to follow NAT timeouts getting longer.
+static const unsigned UDP_NAT_EXCHANGES_BEFORE_PROBING = 8;
+static const long UDP_NAT_MIN_BINDING_LIFETIME_S = 15;
+
+static bool udp_nat_measured(anjay_connection_ref_t ref,
+                             const anjay_server_connection_t *connection) {
+    return ref.server->anjay->udp_nat_keepalive
+           && ref.server->ssid != ANJAY_SSID_BOOTSTRAP
+           && ref.conn_type == ANJAY_CONNECTION_PRIMARY
+           && connection->transport == ANJAY_SOCKET_TRANSPORT_UDP
+           && !ref.server->registration_info.queue_mode;
+}
+
+static void set_udp_nat_binding_lifetime(anjay_connection_ref_t ref,
+                                         anjay_server_connection_t *connection,
+                                         avs_time_duration_t lifetime) {
+    const avs_time_duration_t min_lifetime =
+            avs_time_duration_from_scalar(UDP_NAT_MIN_BINDING_LIFETIME_S,
+                                          AVS_TIME_S);
+    if (avs_time_duration_less(lifetime, min_lifetime)) {
+        lifetime = min_lifetime;
+    }
+    const int64_t registration_lifetime_s =
+            ref.server->registration_info.last_update_params.lifetime_s;
+    if (registration_lifetime_s > 0
+            && avs_time_duration_less(
+                       avs_time_duration_from_scalar(registration_lifetime_s,
+                                                     AVS_TIME_S),
+                       lifetime)) {
+        // the Lifetime is the limiting factor anyway
+        lifetime = AVS_TIME_DURATION_ZERO;
+    }
+    connection->nontransient_state.udp_nat_binding_lifetime = lifetime;
+    connection->udp_nat.successful_exchanges = 0;
+    anjay_log(DEBUG,
+              _("NAT binding lifetime estimate for server SSID ") "%" PRIu16
+                      _(" set to ") "%s",
+              ref.server->ssid, AVS_TIME_DURATION_AS_STRING(lifetime));
+}
+
+static void udp_nat_exchange_succeeded(anjay_connection_ref_t ref,
+                                       anjay_server_connection_t *connection) {
+    if (!udp_nat_measured(ref, connection)) {
+        return;
+    }
+    connection->udp_nat.last_activity = avs_time_monotonic_now();
+    connection->udp_nat.request_idle_time = AVS_TIME_DURATION_INVALID;
+    const avs_time_duration_t lifetime =
+            connection->nontransient_state.udp_nat_binding_lifetime;
+    if (!avs_time_duration_equal(lifetime, AVS_TIME_DURATION_ZERO)
+            && ++connection->udp_nat.successful_exchanges
+                           >= UDP_NAT_EXCHANGES_BEFORE_PROBING) {
+        set_udp_nat_binding_lifetime(
+                ref, connection,
+                avs_time_duration_add(lifetime,
+                                      avs_time_duration_div(lifetime, 4)));
+    }
+}
+
+void _anjay_connection_udp_nat_request_sent(anjay_connection_ref_t ref) {
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    if (!connection || !udp_nat_measured(ref, connection)) {
+        return;
+    }
+    connection->udp_nat.request_idle_time =
+            avs_time_monotonic_diff(avs_time_monotonic_now(),
+                                    connection->udp_nat.last_activity);
+}
+
+void _anjay_connection_udp_nat_request_failed(anjay_connection_ref_t ref,
+                                              avs_error_t err) {
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    if (!connection || !udp_nat_measured(ref, connection)
+            || err.category != AVS_COAP_ERR_CATEGORY
+            || err.code != AVS_COAP_ERR_TIMEOUT
+            || !avs_time_duration_valid(
+                       connection->udp_nat.request_idle_time)) {
+        return;
+    }
+    anjay_log(WARNING,
+              _("request to server SSID ") "%" PRIu16 _(
+                      " timed out after ") "%s" _(" of inactivity"),
+              ref.server->ssid,
+              AVS_TIME_DURATION_AS_STRING(
+                      connection->udp_nat.request_idle_time));
+    // The NAT binding apparently expired during the idle time, so leave some
+    // margin below it.
+    avs_time_duration_t new_lifetime = avs_time_duration_div(
+            avs_time_duration_mul(connection->udp_nat.request_idle_time, 3),
+            4);
+    const avs_time_duration_t lifetime =
+            connection->nontransient_state.udp_nat_binding_lifetime;
+    if (avs_time_duration_equal(lifetime, AVS_TIME_DURATION_ZERO)
+            || avs_time_duration_less(new_lifetime, lifetime)) {
+        set_udp_nat_binding_lifetime(ref, connection, new_lifetime);
+    }
+    connection->udp_nat.request_idle_time = AVS_TIME_DURATION_INVALID;
+}
+
+void _anjay_connection_udp_nat_request_received(anjay_connection_ref_t ref) {
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    if (!connection || !udp_nat_measured(ref, connection)) {
+        return;
+    }
+    const avs_time_monotonic_t now = avs_time_monotonic_now();
+    const avs_time_duration_t idle_time =
+            avs_time_monotonic_diff(now, connection->udp_nat.last_activity);
+    const avs_time_duration_t lifetime =
+            connection->nontransient_state.udp_nat_binding_lifetime;
+    // the server could reach us, so the binding lived at least that long
+    if (avs_time_duration_valid(idle_time)
+            && !avs_time_duration_equal(lifetime, AVS_TIME_DURATION_ZERO)
+            && avs_time_duration_less(lifetime, idle_time)) {
+        set_udp_nat_binding_lifetime(ref, connection, idle_time);
+    }
+    connection->udp_nat.last_activity = now;
+}
+
+avs_time_monotonic_t
+_anjay_connection_udp_nat_keepalive_deadline(anjay_connection_ref_t ref) {
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    if (!connection || !udp_nat_measured(ref, connection)
+            || avs_time_duration_equal(
+                       connection->nontransient_state.udp_nat_binding_lifetime,
+                       AVS_TIME_DURATION_ZERO)) {
+        return AVS_TIME_MONOTONIC_INVALID;
+    }
+    // invalid if there was no traffic on the socket yet
+    return avs_time_monotonic_add(
+            connection->udp_nat.last_activity,
+            connection->nontransient_state.udp_nat_binding_lifetime);
+}
+#endif // WITH_AVS_COAP_UDP
+
 anjay_socket_transport_t
 _anjay_connection_transport(anjay_connection_ref_t conn_ref) {
     anjay_server_connection_t *connection =
@@ -394,6 +536,9 @@ void _anjay_connection_mark_stable(anjay_connection_ref_t ref) {
     assert(connection);
     assert(_anjay_connection_is_online(connection));
     connection->state = ANJAY_SERVER_CONNECTION_STABLE;
+#ifdef WITH_AVS_COAP_UDP
+    udp_nat_exchange_succeeded(ref, connection);
+#endif // WITH_AVS_COAP_UDP
 }
 
 void _anjay_connection_bring_online(anjay_connection_ref_t ref) {
@@ -421,10 +566,57 @@ void _anjay_connection_bring_online(anjay_connection_ref_t ref) {
 }
 
 #ifndef ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
+// Number of queue mode windows during which MAX_TRANSMIT_WAIT is always used,
+// to learn how the server behaves before closing the socket earlier.
+static const unsigned QUEUE_MODE_LEARNING_WINDOWS = 4;
+// Every this many windows, MAX_TRANSMIT_WAIT is used again, so that requests
+// the server starts sending later than before can still be observed.
+static const unsigned QUEUE_MODE_PROBING_PERIOD = 16;
+static const long QUEUE_MODE_MIN_CLOSE_DELAY_S = 2;
+
+static avs_time_duration_t
+queue_mode_close_delay(anjay_unlocked_t *anjay,
+                       const anjay_server_connection_t *connection) {
+    const avs_time_duration_t max_delay =
+            _anjay_max_transmit_wait_for_transport(anjay,
+                                                   connection->transport);
+    const unsigned windows = connection->nontransient_state.queue_mode_windows;
+    if (!anjay->queue_mode_adaptive_close
+            || windows < QUEUE_MODE_LEARNING_WINDOWS
+            || windows % QUEUE_MODE_PROBING_PERIOD == 0) {
+        return max_delay;
+    }
+    avs_time_duration_t delay = avs_time_duration_mul(
+            connection->nontransient_state.queue_mode_request_delay, 2);
+    const avs_time_duration_t min_delay =
+            avs_time_duration_from_scalar(QUEUE_MODE_MIN_CLOSE_DELAY_S,
+                                          AVS_TIME_S);
+    if (avs_time_duration_less(delay, min_delay)) {
+        delay = min_delay;
+    }
+    if (!avs_time_duration_less(delay, max_delay)) {
+        return max_delay;
+    }
+    return delay;
+}
+
+static void queue_mode_window_finished(anjay_server_connection_t *connection) {
+    anjay_server_connection_nontransient_state_t *state =
+            &connection->nontransient_state;
+    if (state->queue_mode_windows < UINT_MAX) {
+        ++state->queue_mode_windows;
+    }
+    // let the estimate follow servers that start responding faster
+    state->queue_mode_request_delay = avs_time_duration_sub(
+            state->queue_mode_request_delay,
+            avs_time_duration_div(state->queue_mode_request_delay, 8));
+}
+
 static void queue_mode_close_socket(avs_sched_t *sched, const void *ref_ptr) {
     static const long RETRY_DELAY_S = 1;
     anjay_t *anjay_locked = _anjay_get_from_sched(sched);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    ANJAY_SCHED_JOB_STATS_BEGIN(job_start_time);
     anjay_connection_ref_t ref = *(const anjay_connection_ref_t *) ref_ptr;
     bool skip_suspend = false;
     if (_anjay_connection_outgoing_exchanges_in_progress(ref)) {
@@ -445,8 +637,15 @@ static void queue_mode_close_socket(avs_sched_t *sched, const void *ref_ptr) {
         }
     }
     if (!skip_suspend) {
+        anjay_server_connection_t *connection =
+                _anjay_get_server_connection(ref);
+        if (connection) {
+            queue_mode_window_finished(connection);
+        }
         _anjay_connection_suspend(ref);
     }
+    ANJAY_SCHED_JOB_STATS_END(anjay, ANJAY_SCHED_JOB_QUEUE_MODE_CLOSE,
+                              job_start_time);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
 
@@ -462,18 +661,245 @@ void _anjay_connection_schedule_queue_mode_close(anjay_connection_ref_t ref) {
     }
 
     avs_time_duration_t delay =
-            _anjay_max_transmit_wait_for_transport(ref.server->anjay,
-                                                   connection->transport);
+            queue_mode_close_delay(ref.server->anjay, connection);
 
     // see comment on field declaration for logic summary
     if (AVS_SCHED_DELAYED(ref.server->anjay->sched,
                           &connection->queue_mode_close_socket_clb, delay,
                           queue_mode_close_socket, &ref, sizeof(ref))) {
         anjay_log(ERROR, _("could not schedule queue mode operations"));
+    } else {
+        connection->queue_mode_window_start = avs_time_monotonic_now();
+    }
+}
+
+void _anjay_connection_queue_mode_request_received(anjay_connection_ref_t ref) {
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    if (!connection || !connection->queue_mode_close_socket_clb
+            || !ref.server->anjay->queue_mode_adaptive_close) {
+        return;
+    }
+    avs_time_duration_t delay =
+            avs_time_monotonic_diff(avs_time_monotonic_now(),
+                                    connection->queue_mode_window_start);
+    if (avs_time_duration_less(
+                connection->nontransient_state.queue_mode_request_delay,
+                delay)) {
+        anjay_log(DEBUG,
+                  _("server SSID ") "%" PRIu16 _(" sent a request ") "%s" _(
+                          " after the last interaction"),
+                  ref.server->ssid, AVS_TIME_DURATION_AS_STRING(delay));
+        connection->nontransient_state.queue_mode_request_delay = delay;
     }
 }
 #endif // ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
 
+#if defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
+// Number of successful Pings after which a keepalive interval reduced because
+// of a failure is increased again, to follow NAT timeouts getting longer.
+static const unsigned TCP_KEEPALIVE_PINGS_BEFORE_PROBING = 8;
+
+static avs_time_duration_t
+tcp_keepalive_interval(anjay_unlocked_t *anjay,
+                       const anjay_server_connection_t *connection) {
+    avs_time_duration_t interval =
+            connection->nontransient_state.tcp_keepalive_interval;
+    if (avs_time_duration_equal(interval, AVS_TIME_DURATION_ZERO)) {
+        return anjay->coap_tcp_keepalive_interval;
+    }
+    return interval;
+}
+
+static void set_tcp_keepalive_interval(anjay_unlocked_t *anjay,
+                                       anjay_server_connection_t *connection,
+                                       avs_time_duration_t interval) {
+    if (avs_time_duration_less(interval, anjay->coap_tcp_request_timeout)) {
+        // pinging more often than we are willing to wait for a Pong makes no
+        // sense
+        interval = anjay->coap_tcp_request_timeout;
+    }
+    if (!avs_time_duration_less(interval, anjay->coap_tcp_keepalive_interval)) {
+        interval = AVS_TIME_DURATION_ZERO;
+    }
+    connection->nontransient_state.tcp_keepalive_interval = interval;
+    connection->tcp_keepalive.successful_pings = 0;
+}
+
+static void tcp_keepalive_job(avs_sched_t *sched, const void *ref_ptr);
+
+static void schedule_tcp_keepalive_job(anjay_connection_ref_t ref,
+                                       avs_time_monotonic_t time) {
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    avs_sched_del(&connection->tcp_keepalive.job);
+    if (AVS_SCHED_AT(ref.server->anjay->sched, &connection->tcp_keepalive.job,
+                     time, tcp_keepalive_job, &ref, sizeof(ref))) {
+        anjay_log(ERROR, _("could not schedule CoAP/TCP keepalive"));
+    }
+}
+
+static void
+tcp_pong_handler(avs_coap_ctx_t *coap, avs_error_t err, void *server_) {
+    (void) coap;
+    anjay_connection_ref_t ref = {
+        .server = (anjay_server_info_t *) server_,
+        .conn_type = ANJAY_CONNECTION_PRIMARY
+    };
+    anjay_unlocked_t *anjay = ref.server->anjay;
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    avs_time_duration_t idle_time = connection->tcp_keepalive.ping_idle_time;
+    connection->tcp_keepalive.ping_in_progress = false;
+
+    if (err.category == AVS_COAP_ERR_CATEGORY
+            && err.code == AVS_COAP_ERR_EXCHANGE_CANCELED) {
+        // CoAP context is being cleaned up
+        return;
+    }
+
+    avs_time_duration_t interval = tcp_keepalive_interval(anjay, connection);
+    if (avs_is_err(err)) {
+        anjay_log(WARNING,
+                  _("no Pong from server SSID ") "%" PRIu16 _(
+                          " after ") "%s" _(" of inactivity"),
+                  ref.server->ssid, AVS_TIME_DURATION_AS_STRING(idle_time));
+        // The NAT timeout is apparently shorter than the idle time, so leave
+        // some margin below it.
+        avs_time_duration_t new_interval =
+                avs_time_duration_div(avs_time_duration_mul(idle_time, 3), 4);
+        if (avs_time_duration_less(new_interval, interval)) {
+            set_tcp_keepalive_interval(anjay, connection, new_interval);
+        }
+        // The connection cannot be recreated from within the CoAP context's
+        // callback, so let the job do it.
+        connection->tcp_keepalive.failed = true;
+        schedule_tcp_keepalive_job(ref, avs_time_monotonic_now());
+        return;
+    }
+
+    if (!avs_time_duration_equal(
+                connection->nontransient_state.tcp_keepalive_interval,
+                AVS_TIME_DURATION_ZERO)
+            && ++connection->tcp_keepalive.successful_pings
+                           >= TCP_KEEPALIVE_PINGS_BEFORE_PROBING) {
+        set_tcp_keepalive_interval(
+                anjay, connection,
+                avs_time_duration_add(interval,
+                                      avs_time_duration_div(interval, 4)));
+        anjay_log(DEBUG,
+                  _("CoAP/TCP keepalive interval for server SSID ") "%" PRIu16
+                          _(" increased to ") "%s",
+                  ref.server->ssid,
+                  AVS_TIME_DURATION_AS_STRING(
+                          tcp_keepalive_interval(anjay, connection)));
+    }
+    _anjay_connection_schedule_tcp_keepalive(ref);
+}
+
+static avs_time_monotonic_t next_update_time(anjay_server_info_t *server) {
+    if (server->next_action_handle
+            && server->next_action == ANJAY_SERVER_NEXT_ACTION_SEND_UPDATE) {
+        return avs_sched_time(&server->next_action_handle);
+    }
+    return AVS_TIME_MONOTONIC_INVALID;
+}
+
+static void send_tcp_keepalive(anjay_connection_ref_t ref) {
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    avs_time_monotonic_t now = avs_time_monotonic_now();
+    avs_time_monotonic_t last_activity =
+            avs_coap_tcp_ctx_get_last_activity(connection->coap_ctx);
+    avs_time_duration_t interval =
+            tcp_keepalive_interval(ref.server->anjay, connection);
+    avs_time_monotonic_t deadline =
+            avs_time_monotonic_add(last_activity, interval);
+    if (avs_time_monotonic_before(now, deadline)) {
+        // there was some traffic since the job was scheduled
+        schedule_tcp_keepalive_job(ref, deadline);
+        return;
+    }
+
+    // If an Update is going to be sent soon anyway, let it refresh the
+    // connection instead of waking up the radio twice.
+    avs_time_monotonic_t latest = avs_time_monotonic_add(
+            deadline, avs_time_duration_div(interval, 4));
+    avs_time_monotonic_t update_time = next_update_time(ref.server);
+    if (avs_time_monotonic_before(now, latest)
+            && avs_time_monotonic_valid(update_time)
+            && !avs_time_monotonic_before(latest, update_time)) {
+        // If the Update job is already due, it will be executed in the current
+        // scheduler run, so just check again at the latest acceptable time.
+        schedule_tcp_keepalive_job(
+                ref, avs_time_monotonic_before(now, update_time) ? update_time
+                                                                 : latest);
+        return;
+    }
+
+    avs_error_t err = avs_coap_tcp_ctx_send_ping(connection->coap_ctx,
+                                                 tcp_pong_handler, ref.server);
+    if (avs_is_ok(err)) {
+        connection->tcp_keepalive.ping_in_progress = true;
+        connection->tcp_keepalive.ping_idle_time =
+                avs_time_monotonic_diff(now, last_activity);
+    } else {
+        anjay_log(WARNING, _("could not send CoAP/TCP Ping: ") "%s",
+                  AVS_COAP_STRERROR(err));
+        if (avs_coap_error_recovery_action(err)
+                == AVS_COAP_ERR_RECOVERY_RECREATE_CONTEXT) {
+            _anjay_server_on_fatal_coap_error(ref, err);
+        } else {
+            schedule_tcp_keepalive_job(ref,
+                                       avs_time_monotonic_add(now, interval));
+        }
+    }
+}
+
+static void tcp_keepalive_job(avs_sched_t *sched, const void *ref_ptr) {
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    anjay_connection_ref_t ref = *(const anjay_connection_ref_t *) ref_ptr;
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    bool failed = connection->tcp_keepalive.failed;
+    connection->tcp_keepalive.failed = false;
+    if (!_anjay_connection_is_online(connection) || !connection->coap_ctx) {
+        // connection has been suspended in the meantime; the job will be
+        // scheduled again when it is brought back online
+    } else if (failed) {
+        anjay_log(INFO, _("reconnecting to server SSID ") "%" PRIu16,
+                  ref.server->ssid);
+        _anjay_server_on_fatal_coap_error(
+                ref, (avs_error_t) {
+                         .category = AVS_COAP_ERR_CATEGORY,
+                         .code = AVS_COAP_ERR_TCP_CONN_CLOSED
+                     });
+    } else {
+        send_tcp_keepalive(ref);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+void _anjay_connection_schedule_tcp_keepalive(anjay_connection_ref_t ref) {
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    if (ref.conn_type != ANJAY_CONNECTION_PRIMARY
+            || connection->transport != ANJAY_SOCKET_TRANSPORT_TCP
+            || !connection->coap_ctx
+            || avs_time_duration_equal(
+                       ref.server->anjay->coap_tcp_keepalive_interval,
+                       AVS_TIME_DURATION_ZERO)
+            || connection->tcp_keepalive.ping_in_progress) {
+        return;
+    }
+    avs_time_monotonic_t last_activity =
+            avs_coap_tcp_ctx_get_last_activity(connection->coap_ctx);
+    if (!avs_time_monotonic_valid(last_activity)) {
+        return;
+    }
+    schedule_tcp_keepalive_job(
+            ref, avs_time_monotonic_add(
+                         last_activity,
+                         tcp_keepalive_interval(ref.server->anjay,
+                                                connection)));
+}
+#endif // defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
+
 const anjay_url_t *_anjay_connection_uri(anjay_connection_ref_t ref) {
     return &_anjay_get_server_connection(ref)->uri;
 }
@@ -645,3 +1071,7 @@ anjay_update_coap_exchange_timeout(anjay_t *anjay_locked,
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return err;
 }
+
+#ifdef ANJAY_TEST
+#    include "tests/core/servers/server_connections.c"
+#endif // ANJAY_TEST
@@ -32,6 +32,21 @@ void _anjay_active_server_refresh(anjay_server_info_t *server);
 
 void _anjay_connections_flush_notifications(anjay_connections_t *connections);
 
+#if defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
+/**
+ * Schedules sending a CoAP Signaling Ping on the connection after it stays idle
+ * for anjay_configuration_t::coap_tcp_keepalive_interval (or the interval
+ * adapted to the observed NAT timeouts). Does nothing if the connection does
+ * not use CoAP/TCP, keepalive is disabled, or a Ping is already in progress.
+ *
+ * It is enough to call it once after bringing the connection online - the job
+ * reschedules itself, taking any traffic in the meantime into account.
+ */
+void _anjay_connection_schedule_tcp_keepalive(anjay_connection_ref_t ref);
+#else  // defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
+#    define _anjay_connection_schedule_tcp_keepalive(...) ((void) 0)
+#endif // defined(ANJAY_WITH_LWM2M11) && defined(WITH_AVS_COAP_TCP)
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif // ANJAY_SERVERS_SERVER_CONNECTIONS_H
@@ -10,6 +10,8 @@
 #include <anjay_init.h>
 
 #include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <anjay_modules/anjay_time_defs.h>
 
@@ -28,6 +30,10 @@
 #include "anjay_server_connections.h"
 #include "anjay_servers_internal.h"
 
+#ifdef ANJAY_TEST
+#    include "tests/core/servers/servers_mock.h"
+#endif // ANJAY_TEST
+
 VISIBILITY_SOURCE_BEGIN
 
 void _anjay_server_clean_active_data(anjay_server_info_t *server) {
@@ -40,6 +46,7 @@ void _anjay_server_clean_active_data(anjay_server_info_t *server) {
 void _anjay_server_cleanup(anjay_server_info_t *server) {
     anjay_log(TRACE, _("clear_server SSID ") "%u", server->ssid);
 
+    _anjay_observe_server_removed(server);
     _anjay_server_clean_active_data(server);
     _anjay_registration_info_cleanup(&server->registration_info);
 }
@@ -72,9 +79,18 @@ void _anjay_servers_deregister(anjay_unlocked_t *anjay) {
 }
 #endif // ANJAY_WITHOUT_DEREGISTER
 
+static void servers_index_cleanup(anjay_servers_index_t *index) {
+    avs_free(index->by_ssid);
+    avs_free(index->by_security_iid);
+    avs_free(index->by_socket);
+    memset(index, 0, sizeof(*index));
+}
+
 void _anjay_servers_cleanup(anjay_unlocked_t *anjay) {
+    _anjay_servers_changed(anjay);
     _anjay_servers_internal_cleanup(&anjay->servers);
     AVS_LIST_CLEAR(&anjay->cached_public_sockets);
+    servers_index_cleanup(&anjay->servers_index);
 }
 
 void _anjay_servers_cleanup_inactive_nonbootstrap(anjay_unlocked_t *anjay) {
@@ -83,6 +99,7 @@ void _anjay_servers_cleanup_inactive_nonbootstrap(anjay_unlocked_t *anjay) {
     AVS_LIST_DELETABLE_FOREACH_PTR(server_ptr, helper, &anjay->servers) {
         if ((*server_ptr)->ssid != ANJAY_SSID_BOOTSTRAP
                 && !_anjay_server_active(*server_ptr)) {
+            _anjay_servers_changed(anjay);
             _anjay_server_cleanup(*server_ptr);
             AVS_LIST_DELETE(server_ptr);
         }
@@ -94,6 +111,29 @@ avs_coap_ctx_t *_anjay_connection_get_coap(anjay_connection_ref_t ref) {
     return _anjay_get_server_connection(ref)->coap_ctx;
 }
 
+bool _anjay_connection_get_dtls_session(anjay_connection_ref_t ref,
+                                        char *out_buffer,
+                                        size_t buffer_size) {
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    if (!connection
+            || buffer_size
+                           < sizeof(connection->nontransient_state
+                                            .dtls_session_buffer)) {
+        return false;
+    }
+    const char *session = connection->nontransient_state.dtls_session_buffer;
+    const size_t session_size =
+            sizeof(connection->nontransient_state.dtls_session_buffer);
+    for (size_t i = 0; i < session_size; ++i) {
+        // an all-zero buffer means that there is no session to resume
+        if (session[i]) {
+            memcpy(out_buffer, session, session_size);
+            return true;
+        }
+    }
+    return false;
+}
+
 avs_net_socket_t *
 _anjay_connection_get_online_socket(anjay_connection_ref_t ref) {
     anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
@@ -161,6 +201,19 @@ _anjay_collect_socket_entries(anjay_unlocked_t *anjay, bool include_offline) {
     return result;
 }
 
+void _anjay_socket_set_changed(anjay_unlocked_t *anjay) {
+    ++anjay->socket_set_version;
+}
+
+size_t _anjay_socket_set_version(anjay_unlocked_t *anjay) {
+#ifdef ANJAY_WITH_DOWNLOADER
+    if (_anjay_downloader_sockets_changed(&anjay->downloader)) {
+        _anjay_socket_set_changed(anjay);
+    }
+#endif // ANJAY_WITH_DOWNLOADER
+    return anjay->socket_set_version;
+}
+
 AVS_LIST(const anjay_socket_entry_t)
 anjay_get_socket_entries(anjay_t *anjay_locked) {
     AVS_LIST(const anjay_socket_entry_t) result = NULL;
@@ -198,11 +251,223 @@ _anjay_servers_find_ptr(AVS_LIST(anjay_server_info_t) *servers,
     return NULL;
 }
 
+void _anjay_servers_changed(anjay_unlocked_t *anjay) {
+    ++anjay->servers_version;
+}
+
+static int compare_by_security_iid(const void *left_, const void *right_) {
+    const anjay_server_info_t *left = *(anjay_server_info_t *const *) left_;
+    const anjay_server_info_t *right = *(anjay_server_info_t *const *) right_;
+    if (left->last_used_security_iid != right->last_used_security_iid) {
+        return left->last_used_security_iid < right->last_used_security_iid
+                       ? -1
+                       : 1;
+    }
+    return left->ssid < right->ssid ? -1 : (left->ssid > right->ssid ? 1 : 0);
+}
+
+static int compare_by_socket(const void *left_, const void *right_) {
+    uintptr_t left = (uintptr_t) ((const anjay_servers_index_socket_entry_t *)
+                                          left_)
+                             ->socket;
+    uintptr_t right = (uintptr_t) ((const anjay_servers_index_socket_entry_t *)
+                                           right_)
+                              ->socket;
+    return left < right ? -1 : (left > right ? 1 : 0);
+}
+
+static int servers_index_reserve(anjay_servers_index_t *index, size_t count) {
+    if (count <= index->capacity) {
+        return 0;
+    }
+    anjay_server_info_t **by_ssid = (anjay_server_info_t **) avs_realloc(
+            index->by_ssid, count * sizeof(*by_ssid));
+    if (!by_ssid) {
+        return -1;
+    }
+    index->by_ssid = by_ssid;
+    anjay_server_info_t **by_security_iid = (anjay_server_info_t **)
+            avs_realloc(index->by_security_iid,
+                        count * sizeof(*by_security_iid));
+    if (!by_security_iid) {
+        return -1;
+    }
+    index->by_security_iid = by_security_iid;
+    anjay_servers_index_socket_entry_t *by_socket =
+            (anjay_servers_index_socket_entry_t *) avs_realloc(
+                    index->by_socket, count * sizeof(*by_socket));
+    if (!by_socket) {
+        return -1;
+    }
+    index->by_socket = by_socket;
+    index->capacity = count;
+    return 0;
+}
+
+/**
+ * Makes sure that anjay->servers_index reflects the current state of
+ * anjay->servers. Returns a non-zero value if the index could not be built -
+ * callers shall fall back to iterating over the list in that case.
+ */
+static int servers_index_update(anjay_unlocked_t *anjay) {
+    anjay_servers_index_t *index = &anjay->servers_index;
+    if (index->valid && index->servers_version == anjay->servers_version
+            && index->socket_set_version == anjay->socket_set_version) {
+        return 0;
+    }
+#ifdef ANJAY_WITH_THREAD_SAFETY
+    if (anjay->shared_lock_held) {
+        // other read-only sections may be using the index concurrently;
+        // callers will fall back to walking the server list
+        return -1;
+    }
+#endif // ANJAY_WITH_THREAD_SAFETY
+    index->valid = false;
+    if (servers_index_reserve(index, AVS_LIST_SIZE(anjay->servers))) {
+        _anjay_log_oom();
+        return -1;
+    }
+
+    index->servers_count = 0;
+    index->sockets_count = 0;
+    AVS_LIST(anjay_server_info_t) server;
+    AVS_LIST_FOREACH(server, anjay->servers) {
+        // anjay->servers is already sorted by SSID
+        index->by_ssid[index->servers_count] = server;
+        index->by_security_iid[index->servers_count] = server;
+        ++index->servers_count;
+
+        avs_net_socket_t *socket = _anjay_connection_internal_get_socket(
+                _anjay_connection_get(&server->connections,
+                                      ANJAY_CONNECTION_PRIMARY));
+        if (socket) {
+            index->by_socket[index->sockets_count].socket = socket;
+            index->by_socket[index->sockets_count].server = server;
+            ++index->sockets_count;
+        }
+    }
+    qsort(index->by_security_iid, index->servers_count,
+          sizeof(*index->by_security_iid), compare_by_security_iid);
+    qsort(index->by_socket, index->sockets_count, sizeof(*index->by_socket),
+          compare_by_socket);
+
+    index->servers_version = anjay->servers_version;
+    index->socket_set_version = anjay->socket_set_version;
+    index->valid = true;
+    return 0;
+}
+
 anjay_server_info_t *_anjay_servers_find(anjay_unlocked_t *anjay,
                                          anjay_ssid_t ssid) {
-    AVS_LIST(anjay_server_info_t) *ptr =
-            _anjay_servers_find_ptr(&anjay->servers, ssid);
-    return ptr ? *ptr : NULL;
+    if (servers_index_update(anjay)) {
+        AVS_LIST(anjay_server_info_t) *ptr =
+                _anjay_servers_find_ptr(&anjay->servers, ssid);
+        return ptr ? *ptr : NULL;
+    }
+
+    anjay_server_info_t **by_ssid = anjay->servers_index.by_ssid;
+    size_t lower = 0;
+    size_t upper = anjay->servers_index.servers_count;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (by_ssid[middle]->ssid < ssid) {
+            lower = middle + 1;
+        } else if (by_ssid[middle]->ssid > ssid) {
+            upper = middle;
+        } else {
+            return by_ssid[middle];
+        }
+    }
+    anjay_log(TRACE, _("no server with SSID ") "%u", ssid);
+    return NULL;
+}
+
+anjay_server_info_t *_anjay_servers_find_active(anjay_unlocked_t *anjay,
+                                                anjay_ssid_t ssid) {
+    anjay_server_info_t *server = _anjay_servers_find(anjay, ssid);
+    return server && _anjay_server_active(server) ? server : NULL;
+}
+
+anjay_server_info_t *
+_anjay_servers_find_active_by_security_iid(anjay_unlocked_t *anjay,
+                                           anjay_iid_t security_iid) {
+    if (servers_index_update(anjay)) {
+        AVS_LIST(anjay_server_info_t) server;
+        AVS_LIST_FOREACH(server, anjay->servers) {
+            if (server->last_used_security_iid == security_iid
+                    && _anjay_server_active(server)) {
+                return server;
+            }
+        }
+        return NULL;
+    }
+
+    anjay_server_info_t **by_security_iid =
+            anjay->servers_index.by_security_iid;
+    size_t count = anjay->servers_index.servers_count;
+    size_t lower = 0;
+    size_t upper = count;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (by_security_iid[middle]->last_used_security_iid < security_iid) {
+            lower = middle + 1;
+        } else {
+            upper = middle;
+        }
+    }
+    // several servers may share the Security IID, e.g. while one of them is
+    // being deactivated; return the first active one, in the order of SSIDs
+    for (; lower < count
+           && by_security_iid[lower]->last_used_security_iid == security_iid;
+         ++lower) {
+        if (_anjay_server_active(by_security_iid[lower])) {
+            return by_security_iid[lower];
+        }
+    }
+    return NULL;
+}
+
+static bool is_primary_socket_of(anjay_server_info_t *server,
+                                 avs_net_socket_t *socket) {
+    const anjay_connection_ref_t ref = {
+        .server = server,
+        .conn_type = ANJAY_CONNECTION_PRIMARY
+    };
+    return _anjay_server_active(server)
+           && _anjay_connection_get_online_socket(ref) == socket;
+}
+
+anjay_server_info_t *
+_anjay_servers_find_by_primary_socket(anjay_unlocked_t *anjay,
+                                      avs_net_socket_t *socket) {
+    assert(socket);
+    if (servers_index_update(anjay)) {
+        AVS_LIST(anjay_server_info_t) server;
+        AVS_LIST_FOREACH(server, anjay->servers) {
+            if (is_primary_socket_of(server, socket)) {
+                return server;
+            }
+        }
+        return NULL;
+    }
+
+    anjay_servers_index_socket_entry_t *by_socket =
+            anjay->servers_index.by_socket;
+    size_t lower = 0;
+    size_t upper = anjay->servers_index.sockets_count;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if ((uintptr_t) by_socket[middle].socket < (uintptr_t) socket) {
+            lower = middle + 1;
+        } else if ((uintptr_t) by_socket[middle].socket > (uintptr_t) socket) {
+            upper = middle;
+        } else {
+            return is_primary_socket_of(by_socket[middle].server, socket)
+                           ? by_socket[middle].server
+                           : NULL;
+        }
+    }
+    return NULL;
 }
 
 bool _anjay_server_is_disable_scheduled(anjay_server_info_t *server) {
@@ -327,6 +592,7 @@ bool _anjay_bootstrap_server_exists(anjay_unlocked_t *anjay) {
 static void server_next_action_job(avs_sched_t *sched, const void *server_ptr) {
     anjay_t *anjay_locked = _anjay_get_from_sched(sched);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    ANJAY_SCHED_JOB_STATS_BEGIN(job_start_time);
     anjay_server_info_t *server = *(anjay_server_info_t *const *) server_ptr;
     switch (server->next_action) {
     case ANJAY_SERVER_NEXT_ACTION_COMMUNICATION_ERROR:
@@ -362,9 +628,38 @@ static void server_next_action_job(avs_sched_t *sched, const void *server_ptr) {
     }
     AVS_UNREACHABLE("Invalid next_action enum value");
 success:;
+    ANJAY_SCHED_JOB_STATS_END(anjay, ANJAY_SCHED_JOB_SERVER_ACTION,
+                              job_start_time);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
 
+#ifdef ANJAY_WITH_SCHED_STATS
+void _anjay_servers_collect_sched_jobs(
+        anjay_unlocked_t *anjay, anjay_sched_jobs_collector_t *collector) {
+    AVS_LIST(anjay_server_info_t) server;
+    AVS_LIST_FOREACH(server, anjay->servers) {
+        _anjay_sched_jobs_collect(collector, ANJAY_SCHED_JOB_SERVER_ACTION,
+                                  server->ssid, &server->next_action_handle);
+#    ifndef ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
+        anjay_connection_type_t conn_type;
+        ANJAY_CONNECTION_TYPE_FOREACH(conn_type) {
+            const anjay_connection_ref_t ref = {
+                .server = server,
+                .conn_type = conn_type
+            };
+            anjay_server_connection_t *connection =
+                    _anjay_get_server_connection(ref);
+            if (connection) {
+                _anjay_sched_jobs_collect(
+                        collector, ANJAY_SCHED_JOB_QUEUE_MODE_CLOSE,
+                        server->ssid, &connection->queue_mode_close_socket_clb);
+            }
+        }
+#    endif // ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
+    }
+}
+#endif // ANJAY_WITH_SCHED_STATS
+
 int _anjay_server_reschedule_next_action(
         anjay_server_info_t *server,
         avs_time_duration_t delay,
@@ -387,3 +682,7 @@ int _anjay_server_reschedule_next_action(
     }
     return result;
 }
+
+#ifdef ANJAY_TEST
+#    include "tests/core/servers/servers_internal.c"
+#endif // ANJAY_TEST
@@ -22,13 +22,47 @@
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
+/**
+ * Position in the list of Objects and Object Instances generated for
+ * a Register or Update message, from which the generation may be resumed.
+ */
+typedef struct {
+    /** Payload offset at which the position lies. */
+    size_t offset;
+    /** Object whose entries begin or continue at the position. */
+    anjay_oid_t oid;
+    /**
+     * Object Instance whose entry ends at the position, or ANJAY_ID_INVALID if
+     * the position is at the beginning of entries for @ref oid.
+     */
+    anjay_iid_t iid;
+} anjay_dm_links_cursor_t;
+
 typedef struct {
     avs_coap_exchange_id_t exchange_id;
     anjay_lwm2m_version_t attempted_version;
     anjay_update_parameters_t new_params;
+    /**
+     * Furthest position known to lie before the blocks of the payload still
+     * to be sent, if it is generated from the data model for each block.
+     */
+    anjay_dm_links_cursor_t dm_cursor;
+    /**
+     * Set if the exchange was aborted because the data model changed after
+     * the payload had been queried.
+     */
+    bool dm_changed;
 #ifdef ANJAY_WITH_LWM2M11
     bool lwm2m11_queue_mode;
 #endif // ANJAY_WITH_LWM2M11
+#ifdef ANJAY_WITH_OPERATION_STATS
+    avs_time_monotonic_t start_time;
+    avs_time_duration_t handler_time;
+#endif // ANJAY_WITH_OPERATION_STATS
+#ifdef ANJAY_WITH_TRAFFIC_STATS
+    // Content-Format of the request payload, or AVS_COAP_FORMAT_NONE
+    uint16_t content_format;
+#endif // ANJAY_WITH_TRAFFIC_STATS
 } anjay_registration_async_exchange_state_t;
 
 typedef enum {
@@ -203,6 +237,15 @@ struct anjay_server_info_struct {
      */
     uint32_t registration_sequences_performed;
 
+#ifdef ANJAY_WITH_LWM2M11
+    /**
+     * Delay used before the last registration retry, if
+     * anjay_configuration_t::randomize_communication_retries is enabled. The
+     * next one is drawn based on it, see randomized_retry_delay().
+     */
+    avs_time_duration_t last_retry_delay;
+#endif // ANJAY_WITH_LWM2M11
+
 #ifdef ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
     /**
      * Stores the time when the last communication with a given server was done.
@@ -212,6 +255,10 @@ struct anjay_server_info_struct {
     avs_time_real_t last_communication_time;
 #endif // ANJAY_WITH_COMMUNICATION_TIMESTAMP_API
 
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+    anjay_server_startup_timestamps_t startup_timestamps;
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+
 #ifdef ANJAY_WITH_CONN_STATUS_API
     /**
      * Stores current server connection status.
@@ -15,6 +15,7 @@
 #    include <string.h>
 
 #    include <anjay_modules/anjay_access_utils.h>
+#    include <anjay_modules/anjay_memory_accounting.h>
 #    include <anjay_modules/anjay_notify.h>
 #    include <avsystem/commons/avs_sorted_set.h>
 
@@ -536,6 +537,7 @@ int anjay_access_control_install(anjay_t *anjay_locked) {
     }
     int result = -1;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_MODULES);
     AVS_LIST(access_control_t) access_control =
             AVS_LIST_NEW_ELEMENT(access_control_t);
     if (access_control) {
@@ -559,6 +561,7 @@ int anjay_access_control_install(anjay_t *anjay_locked) {
             AVS_LIST_CLEAR(&access_control);
         }
     }
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return result;
 }
@@ -17,6 +17,8 @@
 
 #    include <anjay/access_control.h>
 
+#    include <anjay_modules/anjay_access_utils.h>
+
 #    include "anjay_mod_access_control.h"
 
 #    include <string.h>
@@ -143,6 +145,7 @@ restore(anjay_unlocked_t *anjay, access_control_t *ac, avs_stream_t *in) {
     _anjay_access_control_clear_state(&ac->current);
     ac->current = state;
     ac->last_accessed_instance = NULL;
+    _anjay_access_control_invalidate_cache(anjay);
     return AVS_OK;
 }
 
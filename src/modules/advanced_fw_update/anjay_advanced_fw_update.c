@@ -112,7 +112,8 @@ typedef struct {
     size_t supplemental_iid_cache_count;
 
 #    ifdef ANJAY_WITH_DOWNLOADER
-    current_download_t current_download;
+    AVS_LIST(current_download_t) current_downloads;
+    size_t max_concurrent_downloads;
     bool downloads_suspended;
     AVS_LIST(anjay_download_config_t) download_queue;
 #    endif // ANJAY_WITH_DOWNLOADER
@@ -137,37 +138,11 @@ get_fw(const anjay_dm_installed_object_t obj_ptr) {
 #        define SEND_FW_RES_PATH(Iid, Res) \
             SEND_RES_PATH(ANJAY_ADVANCED_FW_UPDATE_OID, Iid, ADV_FW_RES_##Res)
 
-static int perform_send(anjay_unlocked_t *anjay,
-                        const anjay_dm_installed_object_t *obj,
-                        anjay_iid_t iid,
-                        void *batch) {
-    (void) obj;
-    anjay_ssid_t ssid;
-    const anjay_uri_path_t ssid_path =
-            MAKE_RESOURCE_PATH(ANJAY_DM_OID_SERVER, iid,
-                               ANJAY_DM_RID_SERVER_SSID);
-
-    if (_anjay_dm_read_resource_u16(anjay, &ssid_path, &ssid)) {
-        return 0;
-    }
-
-    if (_anjay_send_deferrable_unlocked(
-                anjay, ssid, (anjay_send_batch_t *) batch, NULL, NULL)
-            != ANJAY_SEND_OK) {
-        fw_log(WARNING, _("failed to perform Send, SSID: ") "%" PRIu16, ssid);
-    }
-
-    return 0;
-}
-
 static void send_batch_to_all_servers(anjay_unlocked_t *anjay,
                                       anjay_send_batch_t *batch) {
-    const anjay_dm_installed_object_t *obj =
-            _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_SERVER);
-
-    if (_anjay_dm_foreach_instance(anjay, obj, perform_send, batch)) {
-        fw_log(ERROR, _("failed to perform Send to all servers"));
-    }
+    // failures for particular servers are logged by the Send implementation
+    (void) _anjay_send_to_servers_unlocked(anjay, NULL, 0, batch, true, NULL,
+                                           NULL);
 }
 
 static void perform_lwm2m_send(anjay_unlocked_t *anjay,
@@ -782,6 +757,17 @@ static int schedule_background_anjay_download(anjay_unlocked_t *anjay,
                                               advanced_fw_repr_t *fw,
                                               advanced_fw_instance_t *inst);
 
+static AVS_LIST(current_download_t) *
+find_current_download_ptr(advanced_fw_repr_t *fw, anjay_iid_t iid) {
+    AVS_LIST(current_download_t) *download_ptr;
+    AVS_LIST_FOREACH_PTR(download_ptr, &fw->current_downloads) {
+        if ((*download_ptr)->iid == iid) {
+            return download_ptr;
+        }
+    }
+    return NULL;
+}
+
 static int schedule_download_now(anjay_unlocked_t *anjay,
                                  advanced_fw_repr_t *fw,
                                  advanced_fw_instance_t *inst,
@@ -797,10 +783,18 @@ static int schedule_download_now(anjay_unlocked_t *anjay,
             return -1;
         }
     }
-    avs_error_t err =
-            _anjay_download_unlocked(anjay, cfg,
-                                     &fw->current_download.download_handle);
+    assert(!find_current_download_ptr(fw, inst->iid));
+    AVS_LIST(current_download_t) download =
+            AVS_LIST_NEW_ELEMENT(current_download_t);
+    avs_error_t err = avs_errno(AVS_ENOMEM);
+    if (!download) {
+        _anjay_log_oom();
+    } else {
+        download->iid = inst->iid;
+        err = _anjay_download_unlocked(anjay, cfg, &download->download_handle);
+    }
     if (avs_is_err(err)) {
+        AVS_LIST_DELETE(&download);
         anjay_advanced_fw_update_result_t update_result =
                 ANJAY_ADVANCED_FW_UPDATE_RESULT_CONNECTION_LOST;
         if (err.category == AVS_ERRNO_CATEGORY) {
@@ -825,10 +819,9 @@ static int schedule_download_now(anjay_unlocked_t *anjay,
 #        endif // ANJAY_WITH_SEND
         return -1;
     }
-    fw->current_download.iid = inst->iid;
+    AVS_LIST_INSERT(&fw->current_downloads, download);
     if (fw->downloads_suspended) {
-        _anjay_download_suspend_unlocked(anjay,
-                                         fw->current_download.download_handle);
+        _anjay_download_suspend_unlocked(anjay, download->download_handle);
     }
     inst->retry_download_on_expired = (false);
     update_state_and_update_result(anjay, fw, inst,
@@ -839,9 +832,14 @@ static int schedule_download_now(anjay_unlocked_t *anjay,
     return 0;
 }
 
+static bool can_start_download_now(advanced_fw_repr_t *fw) {
+    return AVS_LIST_SIZE(fw->current_downloads)
+           < AVS_MAX(fw->max_concurrent_downloads, 1);
+}
+
 static void start_next_download_if_waiting(anjay_unlocked_t *anjay,
                                            advanced_fw_repr_t *fw) {
-    if (fw->download_queue != NULL) {
+    while (fw->download_queue != NULL && can_start_download_now(fw)) {
         advanced_fw_instance_t *inst =
                 (advanced_fw_instance_t *) fw->download_queue->user_data;
         if (schedule_download_now(anjay, fw, inst, fw->download_queue)) {
@@ -865,8 +863,11 @@ static void download_finished(anjay_t *anjay_locked,
     } else {
         advanced_fw_repr_t *fw = get_fw(*obj);
         advanced_fw_instance_t *inst = (advanced_fw_instance_t *) inst_;
-        fw->current_download.download_handle = NULL;
-        fw->current_download.iid = ANJAY_ID_INVALID;
+        AVS_LIST(current_download_t) *download_ptr =
+                find_current_download_ptr(fw, inst->iid);
+        if (download_ptr) {
+            AVS_LIST_DELETE(download_ptr);
+        }
         if (inst->state != ANJAY_ADVANCED_FW_UPDATE_STATE_DOWNLOADING) {
             // something already failed in download_write_block()
             reset_user_state(anjay, inst);
@@ -940,7 +941,7 @@ static void download_finished(anjay_t *anjay_locked,
 }
 
 static bool is_any_download_in_progress(advanced_fw_repr_t *fw) {
-    return fw->current_download.download_handle || fw->download_queue;
+    return fw->current_downloads || fw->download_queue;
 }
 
 static int enqueue_download(anjay_unlocked_t *anjay,
@@ -955,8 +956,16 @@ static int enqueue_download(anjay_unlocked_t *anjay,
         assert(queued_inst->iid != inst->iid);
     }
 #        endif // NDEBUG
+    // the queue is ordered by Severity, in which lower values mean more
+    // urgent updates; downloads of equal severity are queued in FIFO order
+    AVS_LIST(anjay_download_config_t) *insert_ptr = &fw->download_queue;
+    while (*insert_ptr
+           && ((advanced_fw_instance_t *) (*insert_ptr)->user_data)->severity
+                      <= inst->severity) {
+        insert_ptr = AVS_LIST_NEXT_PTR(insert_ptr);
+    }
     AVS_LIST(anjay_download_config_t) new_download =
-            AVS_LIST_APPEND_NEW(anjay_download_config_t, &fw->download_queue);
+            AVS_LIST_NEW_ELEMENT(anjay_download_config_t);
     if (!new_download) {
         goto cleanup;
     }
@@ -974,6 +983,7 @@ static int enqueue_download(anjay_unlocked_t *anjay,
         memcpy(new_download->coap_tx_params, cfg->coap_tx_params,
                sizeof(avs_coap_udp_tx_params_t));
     }
+    AVS_LIST_INSERT(insert_ptr, new_download);
 
     update_state_and_update_result(anjay, fw, inst,
                                    ANJAY_ADVANCED_FW_UPDATE_STATE_DOWNLOADING,
@@ -1001,14 +1011,17 @@ static int schedule_download(anjay_unlocked_t *anjay,
         .on_next_block = download_write_block,
         .on_download_finished = download_finished,
         .user_data = inst,
-        .prefer_same_socket_downloads = fw->prefer_same_socket_downloads
+        .prefer_same_socket_downloads = fw->prefer_same_socket_downloads,
+        // security_config is then read from the data model
+        .resume_server_dtls_session =
+                !inst->user_state.handlers->get_security_config
     };
     avs_coap_udp_tx_params_t tx_params;
     if (!get_coap_tx_params(anjay, inst, &tx_params)) {
         cfg.coap_tx_params = &tx_params;
     }
     cfg.tcp_request_timeout = get_tcp_request_timeout(anjay, inst);
-    if (is_any_download_in_progress(fw)) {
+    if (fw->download_queue || !can_start_download_now(fw)) {
         return enqueue_download(anjay, fw, inst, &cfg);
     }
     return schedule_download_now(anjay, fw, inst, &cfg);
@@ -1134,12 +1147,13 @@ cancel_existing_download_if_in_progress(anjay_unlocked_t *anjay,
                                         advanced_fw_repr_t *fw,
                                         advanced_fw_instance_t *inst) {
     if (inst->state == ANJAY_ADVANCED_FW_UPDATE_STATE_DOWNLOADING) {
-        if (fw->current_download.download_handle
-                && fw->current_download.iid == inst->iid) {
-            _anjay_download_abort_unlocked(
-                    anjay, fw->current_download.download_handle);
-            assert(!fw->current_download.download_handle);
-            fw->current_download.iid = ANJAY_ID_INVALID;
+        AVS_LIST(current_download_t) *download_ptr =
+                find_current_download_ptr(fw, inst->iid);
+        if (download_ptr) {
+            // download_finished() removes the entry from the list
+            _anjay_download_abort_unlocked(anjay,
+                                           (*download_ptr)->download_handle);
+            assert(!find_current_download_ptr(fw, inst->iid));
             fw_log(TRACE,
                    _("Aborted ongoing download for instance ") "%" PRIu16,
                    inst->iid);
@@ -1780,6 +1794,7 @@ static void fw_delete(void *fw_) {
     AVS_LIST_CLEAR(&fw->download_queue) {
         download_queue_entry_cleanup(fw->download_queue);
     }
+    AVS_LIST_CLEAR(&fw->current_downloads);
 #    endif // ANJAY_WITH_DOWNLOADER
     // NOTE: fw itself will be freed when cleaning the objects list
 }
@@ -1796,11 +1811,11 @@ int anjay_advanced_fw_update_install(
         _anjay_log_oom();
     } else {
         repr->def = &FIRMWARE_UPDATE;
-        repr->current_download.iid = ANJAY_ID_INVALID;
         if (config) {
 #    ifdef ANJAY_WITH_DOWNLOADER
             repr->prefer_same_socket_downloads =
                     config->prefer_same_socket_downloads;
+            repr->max_concurrent_downloads = config->max_concurrent_downloads;
 #    endif // ANJAY_WITH_DOWNLOADER
 #    ifdef ANJAY_WITH_SEND
             repr->use_lwm2m_send = config->use_lwm2m_send;
@@ -2321,9 +2336,9 @@ void anjay_advanced_fw_update_pull_suspend(anjay_t *anjay_locked) {
     } else {
         advanced_fw_repr_t *fw = get_fw(*obj);
         assert(fw);
-        if (fw->current_download.download_handle) {
-            _anjay_download_suspend_unlocked(
-                    anjay, fw->current_download.download_handle);
+        AVS_LIST(current_download_t) download;
+        AVS_LIST_FOREACH(download, fw->current_downloads) {
+            _anjay_download_suspend_unlocked(anjay, download->download_handle);
         }
         fw->downloads_suspended = true;
     }
@@ -2342,11 +2357,44 @@ int anjay_advanced_fw_update_pull_reconnect(anjay_t *anjay_locked) {
         advanced_fw_repr_t *fw = get_fw(*obj);
         assert(fw);
         fw->downloads_suspended = false;
-        if (fw->current_download.download_handle) {
-            result = _anjay_download_reconnect_unlocked(
-                    anjay, fw->current_download.download_handle);
-        } else {
-            result = 0;
+        result = 0;
+        AVS_LIST(current_download_t) download;
+        AVS_LIST_FOREACH(download, fw->current_downloads) {
+            // attempt to reconnect all downloads even if some of them fail
+            if (_anjay_download_reconnect_unlocked(anjay,
+                                                   download->download_handle)) {
+                result = -1;
+            }
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+int anjay_advanced_fw_update_get_download_stats(
+        anjay_t *anjay_locked,
+        anjay_iid_t iid,
+        anjay_download_stats_t *out_stats) {
+    assert(anjay_locked);
+    assert(out_stats);
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(anjay, ANJAY_ADVANCED_FW_UPDATE_OID);
+    if (!obj) {
+        fw_log(WARNING, _("Advanced Firmware Update object not installed"));
+    } else {
+        advanced_fw_repr_t *fw = get_fw(*obj);
+        assert(fw);
+        AVS_LIST(current_download_t) download;
+        AVS_LIST_FOREACH(download, fw->current_downloads) {
+            if (download->iid == iid) {
+                if (avs_is_ok(_anjay_download_get_stats_unlocked(
+                            anjay, download->download_handle, out_stats))) {
+                    result = 0;
+                }
+                break;
+            }
         }
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
@@ -2354,4 +2402,8 @@ int anjay_advanced_fw_update_pull_reconnect(anjay_t *anjay_locked) {
 }
 #    endif // ANJAY_WITH_DOWNLOADER
 
+#    ifdef ANJAY_TEST
+#        include "tests/modules/advanced_fw_update/advanced_fw_update.c"
+#    endif // ANJAY_TEST
+
 #endif // ANJAY_WITH_MODULE_ADVANCED_FW_UPDATE
@@ -0,0 +1,502 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_MODULE_BINARY_APP_DATA_CONTAINER
+
+#    include <assert.h>
+#    include <inttypes.h>
+
+#    include <anjay/binary_app_data_container.h>
+
+#    include <avsystem/commons/avs_defs.h>
+#    include <avsystem/commons/avs_list.h>
+#    include <avsystem/commons/avs_memory.h>
+
+#    include <anjay_modules/anjay_dm_utils.h>
+#    include <anjay_modules/anjay_notify.h>
+#    include <anjay_modules/anjay_utils_core.h>
+#    include <anjay_modules/dm/anjay_modules.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+#    define badc_log(level, ...) _anjay_log(badc, level, __VA_ARGS__)
+
+#    define OID 19
+
+/**
+ * Data: RW, Multiple, Mandatory
+ * type: opaque, range: N/A, unit: N/A
+ * Indicates the application data content.
+ */
+#    define RID_DATA 0
+
+/**
+ * Size of the stack buffer used to pass data between the storage and the
+ * input/output contexts.
+ */
+#    define TRANSFER_CHUNK_SIZE 256
+
+typedef struct {
+    anjay_riid_t riid;
+    size_t size;
+} badc_data_t;
+
+typedef struct {
+    anjay_iid_t iid;
+    AVS_LIST(badc_data_t) data;
+} badc_instance_t;
+
+typedef struct {
+    anjay_dm_installed_object_t def_ptr;
+    const anjay_unlocked_dm_object_def_t *def;
+
+    anjay_badc_storage_handlers_t storage_handlers;
+    void *storage_user_ptr;
+    size_t max_data_size;
+
+    AVS_LIST(badc_instance_t) instances;
+} badc_object_t;
+
+static inline badc_object_t *
+get_obj(const anjay_dm_installed_object_t obj_ptr) {
+    return AVS_CONTAINER_OF(_anjay_dm_installed_object_get_unlocked(&obj_ptr),
+                            badc_object_t, def);
+}
+
+static AVS_LIST(badc_instance_t) *find_instance_ptr(badc_object_t *obj,
+                                                    anjay_iid_t iid) {
+    AVS_LIST(badc_instance_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &obj->instances) {
+        if ((*it)->iid >= iid) {
+            break;
+        }
+    }
+    return it;
+}
+
+static badc_instance_t *find_instance(badc_object_t *obj, anjay_iid_t iid) {
+    AVS_LIST(badc_instance_t) *it = find_instance_ptr(obj, iid);
+    return (*it && (*it)->iid == iid) ? *it : NULL;
+}
+
+static AVS_LIST(badc_data_t) *find_data_ptr(badc_instance_t *inst,
+                                            anjay_riid_t riid) {
+    AVS_LIST(badc_data_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &inst->data) {
+        if ((*it)->riid >= riid) {
+            break;
+        }
+    }
+    return it;
+}
+
+static void remove_all_data(badc_object_t *obj, badc_instance_t *inst) {
+    AVS_LIST_CLEAR(&inst->data) {
+        obj->storage_handlers.remove(obj->storage_user_ptr, inst->iid,
+                                     inst->data->riid);
+    }
+}
+
+static AVS_LIST(badc_instance_t) *create_instance(badc_object_t *obj,
+                                                  anjay_iid_t iid) {
+    AVS_LIST(badc_instance_t) created = AVS_LIST_NEW_ELEMENT(badc_instance_t);
+    if (!created) {
+        _anjay_log_oom();
+        return NULL;
+    }
+    created->iid = iid;
+
+    AVS_LIST(badc_instance_t) *ptr = find_instance_ptr(obj, iid);
+    assert(!*ptr || (*ptr)->iid != iid);
+    AVS_LIST_INSERT(ptr, created);
+    return ptr;
+}
+
+static int badc_list_instances(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t obj_ptr,
+                               anjay_unlocked_dm_list_ctx_t *ctx) {
+    (void) anjay;
+
+    badc_instance_t *it;
+    AVS_LIST_FOREACH(it, get_obj(obj_ptr)->instances) {
+        _anjay_dm_emit_unlocked(ctx, it->iid);
+    }
+    return 0;
+}
+
+static int badc_instance_create(anjay_unlocked_t *anjay,
+                                const anjay_dm_installed_object_t obj_ptr,
+                                anjay_iid_t iid) {
+    (void) anjay;
+    return create_instance(get_obj(obj_ptr), iid) ? 0 : ANJAY_ERR_INTERNAL;
+}
+
+static int badc_instance_remove(anjay_unlocked_t *anjay,
+                                const anjay_dm_installed_object_t obj_ptr,
+                                anjay_iid_t iid) {
+    (void) anjay;
+
+    badc_object_t *obj = get_obj(obj_ptr);
+    AVS_LIST(badc_instance_t) *it = find_instance_ptr(obj, iid);
+    assert(*it && (*it)->iid == iid);
+    remove_all_data(obj, *it);
+    AVS_LIST_DELETE(it);
+    return 0;
+}
+
+static int badc_instance_reset(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t obj_ptr,
+                               anjay_iid_t iid) {
+    (void) anjay;
+
+    badc_object_t *obj = get_obj(obj_ptr);
+    badc_instance_t *inst = find_instance(obj, iid);
+    assert(inst);
+    remove_all_data(obj, inst);
+    return 0;
+}
+
+static int badc_list_resources(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_unlocked_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+
+    _anjay_dm_emit_res_unlocked(ctx, RID_DATA, ANJAY_DM_RES_RWM,
+                                ANJAY_DM_RES_PRESENT);
+    return 0;
+}
+
+static int
+badc_list_resource_instances(anjay_unlocked_t *anjay,
+                             const anjay_dm_installed_object_t obj_ptr,
+                             anjay_iid_t iid,
+                             anjay_rid_t rid,
+                             anjay_unlocked_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) rid;
+    assert(rid == RID_DATA);
+
+    badc_instance_t *inst = find_instance(get_obj(obj_ptr), iid);
+    assert(inst);
+
+    badc_data_t *it;
+    AVS_LIST_FOREACH(it, inst->data) {
+        _anjay_dm_emit_unlocked(ctx, it->riid);
+    }
+    return 0;
+}
+
+static int read_data(badc_object_t *obj,
+                     anjay_iid_t iid,
+                     const badc_data_t *data,
+                     anjay_unlocked_output_ctx_t *ctx) {
+    anjay_unlocked_ret_bytes_ctx_t *bytes_ctx =
+            _anjay_ret_bytes_begin_unlocked(ctx, data->size);
+    if (!bytes_ctx) {
+        return ANJAY_ERR_INTERNAL;
+    }
+
+    uint8_t chunk[TRANSFER_CHUNK_SIZE];
+    for (size_t offset = 0; offset < data->size;) {
+        const size_t chunk_size = AVS_MIN(data->size - offset, sizeof(chunk));
+        if (obj->storage_handlers.read(obj->storage_user_ptr, iid, data->riid,
+                                       offset, chunk, chunk_size)) {
+            badc_log(ERROR,
+                     _("could not read /19/") "%" PRIu16 _("/0/") "%" PRIu16
+                     _(" from storage"),
+                     iid, data->riid);
+            return ANJAY_ERR_INTERNAL;
+        }
+        int result =
+                _anjay_ret_bytes_append_unlocked(bytes_ctx, chunk, chunk_size);
+        if (result) {
+            return result;
+        }
+        offset += chunk_size;
+    }
+    return 0;
+}
+
+static int badc_resource_read(anjay_unlocked_t *anjay,
+                              const anjay_dm_installed_object_t obj_ptr,
+                              anjay_iid_t iid,
+                              anjay_rid_t rid,
+                              anjay_riid_t riid,
+                              anjay_unlocked_output_ctx_t *ctx) {
+    (void) anjay;
+
+    badc_object_t *obj = get_obj(obj_ptr);
+    badc_instance_t *inst = find_instance(obj, iid);
+    assert(inst);
+
+    switch (rid) {
+    case RID_DATA: {
+        AVS_LIST(badc_data_t) *data_ptr = find_data_ptr(inst, riid);
+        if (!*data_ptr || (*data_ptr)->riid != riid) {
+            return ANJAY_ERR_NOT_FOUND;
+        }
+        return read_data(obj, iid, *data_ptr, ctx);
+    }
+
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int write_data(badc_object_t *obj,
+                      anjay_iid_t iid,
+                      badc_data_t *data,
+                      anjay_unlocked_input_ctx_t *ctx) {
+    uint8_t chunk[TRANSFER_CHUNK_SIZE];
+    size_t offset = 0;
+    bool finished = false;
+    while (!finished) {
+        size_t chunk_size;
+        int result = _anjay_get_bytes_unlocked(ctx, &chunk_size, &finished,
+                                               chunk, sizeof(chunk));
+        if (result) {
+            return result;
+        }
+        if (obj->max_data_size && chunk_size > obj->max_data_size - offset) {
+            badc_log(WARNING, _("data too large, max allowed size: ") "%lu",
+                     (unsigned long) obj->max_data_size);
+            return ANJAY_ERR_BAD_REQUEST;
+        }
+        // Always write at offset 0, so that the storage knows that previous
+        // contents are to be replaced even if the new data is empty
+        if ((chunk_size || !offset)
+                && obj->storage_handlers.write(obj->storage_user_ptr, iid,
+                                               data->riid, offset, chunk,
+                                               chunk_size)) {
+            badc_log(ERROR,
+                     _("could not write /19/") "%" PRIu16 _("/0/") "%" PRIu16
+                     _(" to storage"),
+                     iid, data->riid);
+            return ANJAY_ERR_INTERNAL;
+        }
+        offset += chunk_size;
+    }
+    data->size = offset;
+    return 0;
+}
+
+static int badc_resource_write(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               anjay_riid_t riid,
+                               anjay_unlocked_input_ctx_t *ctx) {
+    (void) anjay;
+
+    badc_object_t *obj = get_obj(obj_ptr);
+    badc_instance_t *inst = find_instance(obj, iid);
+    assert(inst);
+
+    switch (rid) {
+    case RID_DATA: {
+        AVS_LIST(badc_data_t) *data_ptr = find_data_ptr(inst, riid);
+        if (!*data_ptr || (*data_ptr)->riid != riid) {
+            AVS_LIST(badc_data_t) created = AVS_LIST_NEW_ELEMENT(badc_data_t);
+            if (!created) {
+                _anjay_log_oom();
+                return ANJAY_ERR_INTERNAL;
+            }
+            created->riid = riid;
+            AVS_LIST_INSERT(data_ptr, created);
+        }
+
+        int result = write_data(obj, iid, *data_ptr, ctx);
+        if (result) {
+            // contents in the storage may be incomplete at this point
+            obj->storage_handlers.remove(obj->storage_user_ptr, iid, riid);
+            (*data_ptr)->size = 0;
+        }
+        return result;
+    }
+
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int badc_resource_reset(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid) {
+    (void) anjay;
+    (void) rid;
+    assert(rid == RID_DATA);
+
+    badc_object_t *obj = get_obj(obj_ptr);
+    badc_instance_t *inst = find_instance(obj, iid);
+    assert(inst);
+    remove_all_data(obj, inst);
+    return 0;
+}
+
+static int badc_transaction_noop(anjay_unlocked_t *anjay,
+                                 const anjay_dm_installed_object_t obj_ptr) {
+    (void) anjay;
+    (void) obj_ptr;
+    return 0;
+}
+
+static const anjay_unlocked_dm_object_def_t OBJ_DEF = {
+    .oid = OID,
+    .handlers = {
+        .list_instances = badc_list_instances,
+        .instance_create = badc_instance_create,
+        .instance_remove = badc_instance_remove,
+        .instance_reset = badc_instance_reset,
+
+        .list_resources = badc_list_resources,
+        .resource_read = badc_resource_read,
+        .resource_write = badc_resource_write,
+        .resource_reset = badc_resource_reset,
+        .list_resource_instances = badc_list_resource_instances,
+
+        // Transactions are not supported, as snapshotting the data would
+        // defeat the purpose of keeping it out of RAM
+        .transaction_begin = badc_transaction_noop,
+        .transaction_validate = badc_transaction_noop,
+        .transaction_commit = badc_transaction_noop,
+        .transaction_rollback = badc_transaction_noop
+    }
+};
+
+static void badc_delete(void *obj_) {
+    badc_object_t *obj = (badc_object_t *) obj_;
+    AVS_LIST_CLEAR(&obj->instances) {
+        // NOTE: contents of the storage are not removed, as they may be
+        // restored later using anjay_badc_data_add()
+        AVS_LIST_CLEAR(&obj->instances->data);
+    }
+    // NOTE: obj itself will be freed when cleaning the objects list
+}
+
+int anjay_badc_install(anjay_t *anjay_locked,
+                       const anjay_badc_config_t *config) {
+    assert(anjay_locked);
+    assert(config);
+
+    if (!config->storage_handlers || !config->storage_handlers->read
+            || !config->storage_handlers->write
+            || !config->storage_handlers->remove) {
+        badc_log(ERROR, _("incomplete storage handlers"));
+        return -1;
+    }
+
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(badc_object_t) obj = AVS_LIST_NEW_ELEMENT(badc_object_t);
+    if (!obj) {
+        _anjay_log_oom();
+    } else {
+        obj->def = &OBJ_DEF;
+        _anjay_dm_installed_object_init_unlocked(&obj->def_ptr, &obj->def);
+        _ANJAY_ASSERT_INSTALLED_OBJECT_IS_FIRST_FIELD(badc_object_t, def_ptr);
+        obj->storage_handlers = *config->storage_handlers;
+        obj->storage_user_ptr = config->storage_user_ptr;
+        obj->max_data_size = config->max_data_size;
+
+        if (!_anjay_dm_module_install(anjay, badc_delete, obj)) {
+            AVS_LIST(anjay_dm_installed_object_t) entry = &obj->def_ptr;
+            if (_anjay_register_object_unlocked(anjay, &entry)) {
+                result = _anjay_dm_module_uninstall(anjay, badc_delete);
+                assert(!result);
+                result = -1;
+            } else {
+                result = 0;
+            }
+        }
+
+        if (result) {
+            AVS_LIST_CLEAR(&obj);
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+static int data_add(anjay_unlocked_t *anjay,
+                    badc_object_t *obj,
+                    anjay_iid_t iid,
+                    anjay_riid_t riid,
+                    size_t size) {
+    if (obj->max_data_size && size > obj->max_data_size) {
+        badc_log(ERROR, _("data too large, max allowed size: ") "%lu",
+                 (unsigned long) obj->max_data_size);
+        return -1;
+    }
+
+    bool instance_created = false;
+    badc_instance_t *inst = find_instance(obj, iid);
+    if (!inst) {
+        AVS_LIST(badc_instance_t) *inst_ptr = create_instance(obj, iid);
+        if (!inst_ptr) {
+            return -1;
+        }
+        inst = *inst_ptr;
+        instance_created = true;
+    }
+
+    AVS_LIST(badc_data_t) *data_ptr = find_data_ptr(inst, riid);
+    if (!*data_ptr || (*data_ptr)->riid != riid) {
+        AVS_LIST(badc_data_t) created = AVS_LIST_NEW_ELEMENT(badc_data_t);
+        if (!created) {
+            _anjay_log_oom();
+            if (instance_created) {
+                AVS_LIST_DELETE(find_instance_ptr(obj, iid));
+            }
+            return -1;
+        }
+        created->riid = riid;
+        AVS_LIST_INSERT(data_ptr, created);
+    }
+    (*data_ptr)->size = size;
+
+    if (instance_created) {
+        return _anjay_notify_instances_changed_unlocked(anjay, OID);
+    }
+    return _anjay_notify_changed_unlocked(anjay, OID, iid, RID_DATA);
+}
+
+int anjay_badc_data_add(anjay_t *anjay_locked,
+                        anjay_iid_t iid,
+                        anjay_riid_t riid,
+                        size_t size) {
+    assert(anjay_locked);
+    if (iid == ANJAY_ID_INVALID || riid == ANJAY_ID_INVALID) {
+        badc_log(ERROR, _("invalid ID"));
+        return -1;
+    }
+
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    badc_object_t *obj =
+            (badc_object_t *) _anjay_dm_module_get_arg(anjay, badc_delete);
+    if (!obj) {
+        badc_log(ERROR, _("Binary App Data Container object not installed"));
+    } else {
+        result = data_add(anjay, obj, iid, riid, size);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/modules/binary_app_data_container/api.c"
+#    endif
+
+#endif // ANJAY_WITH_MODULE_BINARY_APP_DATA_CONTAINER
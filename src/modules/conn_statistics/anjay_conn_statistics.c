@@ -0,0 +1,386 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_MODULE_CONN_STATISTICS
+
+#    include <assert.h>
+#    include <inttypes.h>
+
+#    include <anjay/conn_statistics.h>
+
+#    include <avsystem/commons/avs_defs.h>
+#    include <avsystem/commons/avs_memory.h>
+
+#    include <anjay_modules/anjay_dm_utils.h>
+#    include <anjay_modules/anjay_notify.h>
+#    include <anjay_modules/anjay_sched.h>
+#    include <anjay_modules/anjay_utils_core.h>
+#    include <anjay_modules/dm/anjay_modules.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+#    define cs_log(level, ...) _anjay_log(conn_statistics, level, __VA_ARGS__)
+
+#    define OID 7
+#    define IID 0
+
+/**
+ * Tx Data: R, Single, Optional
+ * type: integer, range: N/A, unit: kilo-bytes
+ * Indicate the total amount of IP data transmitted during the collection
+ * period.
+ */
+#    define RID_TX_DATA 2
+
+/**
+ * Rx Data: R, Single, Optional
+ * type: integer, range: N/A, unit: kilo-bytes
+ * Indicate the total amount of IP data received during the collection period.
+ */
+#    define RID_RX_DATA 3
+
+/**
+ * Max Message Size: R, Single, Optional
+ * type: integer, range: N/A, unit: byte
+ * The maximum IP message size that is used during the collection period.
+ */
+#    define RID_MAX_MESSAGE_SIZE 4
+
+/**
+ * Average Message Size: R, Single, Optional
+ * type: integer, range: N/A, unit: byte
+ * The average IP message size that is used during the collection period.
+ */
+#    define RID_AVERAGE_MESSAGE_SIZE 5
+
+/**
+ * Start: E, Single, Mandatory
+ * Reset resources 0-5 to 0 and start to collect information. If Resource 8
+ * (Collection Period) value is 0, the client will keep collecting information
+ * until Resource 7 (Stop) is executed, otherwise the client will stop
+ * collecting information after the specified period ended.
+ */
+#    define RID_START 6
+
+/**
+ * Stop: E, Single, Mandatory
+ * Stop collecting information, but do not reset resources 0-5.
+ */
+#    define RID_STOP 7
+
+/**
+ * Collection Period: RW, Single, Optional
+ * type: integer, range: N/A, unit: seconds
+ * The default collection period in seconds. The value 0 indicates that the
+ * collection period is not set.
+ */
+#    define RID_COLLECTION_PERIOD 8
+
+typedef struct {
+    anjay_dm_installed_object_t def_ptr;
+    const anjay_unlocked_dm_object_def_t *def;
+
+    avs_sched_handle_t stop_job;
+    bool collecting;
+    /** Counters at the time of executing Start. */
+    anjay_net_traffic_stats_t baseline;
+    /** Counters collected during the last finished collection period. */
+    anjay_net_traffic_stats_t collected;
+
+    int32_t collection_period;
+    int32_t saved_collection_period;
+} conn_stats_t;
+
+static inline conn_stats_t *get_obj(const anjay_dm_installed_object_t obj_ptr) {
+    return AVS_CONTAINER_OF(_anjay_dm_installed_object_get_unlocked(&obj_ptr),
+                            conn_stats_t, def);
+}
+
+static void get_collected_stats(anjay_unlocked_t *anjay,
+                                conn_stats_t *obj,
+                                anjay_net_traffic_stats_t *out) {
+    if (!obj->collecting) {
+        *out = obj->collected;
+        return;
+    }
+    _anjay_get_net_traffic_stats_unlocked(anjay, out);
+    // counters of closed connections are retained, so they never decrease
+    out->tx_bytes -= obj->baseline.tx_bytes;
+    out->rx_bytes -= obj->baseline.rx_bytes;
+    out->sent_messages -= obj->baseline.sent_messages;
+    out->received_messages -= obj->baseline.received_messages;
+    out->total_messages_size -= obj->baseline.total_messages_size;
+}
+
+static void notify_collected_stats(anjay_unlocked_t *anjay) {
+    (void) (_anjay_notify_changed_unlocked(anjay, OID, IID, RID_TX_DATA)
+            || _anjay_notify_changed_unlocked(anjay, OID, IID, RID_RX_DATA)
+            || _anjay_notify_changed_unlocked(anjay, OID, IID,
+                                              RID_MAX_MESSAGE_SIZE)
+            || _anjay_notify_changed_unlocked(anjay, OID, IID,
+                                              RID_AVERAGE_MESSAGE_SIZE));
+}
+
+static void stop_collecting(anjay_unlocked_t *anjay, conn_stats_t *obj) {
+    get_collected_stats(anjay, obj, &obj->collected);
+    obj->collecting = false;
+    avs_sched_del(&obj->stop_job);
+}
+
+static void stop_job(avs_sched_t *sched, const void *obj_ptr) {
+    conn_stats_t *obj = *(conn_stats_t *const *) obj_ptr;
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    cs_log(INFO, _("collection period elapsed"));
+    stop_collecting(anjay, obj);
+    notify_collected_stats(anjay);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+static int start_collecting(anjay_unlocked_t *anjay, conn_stats_t *obj) {
+    avs_sched_del(&obj->stop_job);
+    if (obj->collection_period > 0
+            && AVS_SCHED_DELAYED(_anjay_get_scheduler_unlocked(anjay),
+                                 &obj->stop_job,
+                                 avs_time_duration_from_scalar(
+                                         obj->collection_period, AVS_TIME_S),
+                                 stop_job, &obj, sizeof(obj))) {
+        cs_log(ERROR, _("could not schedule end of collection period"));
+        return ANJAY_ERR_INTERNAL;
+    }
+    _anjay_get_net_traffic_stats_unlocked(anjay, &obj->baseline);
+    obj->collecting = true;
+    return 0;
+}
+
+static int cs_list_instances(anjay_unlocked_t *anjay,
+                             const anjay_dm_installed_object_t obj_ptr,
+                             anjay_unlocked_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    _anjay_dm_emit_unlocked(ctx, IID);
+    return 0;
+}
+
+static int cs_instance_reset(anjay_unlocked_t *anjay,
+                             const anjay_dm_installed_object_t obj_ptr,
+                             anjay_iid_t iid) {
+    (void) anjay;
+    (void) iid;
+    assert(iid == IID);
+    get_obj(obj_ptr)->collection_period = 0;
+    return 0;
+}
+
+static int cs_list_resources(anjay_unlocked_t *anjay,
+                             const anjay_dm_installed_object_t obj_ptr,
+                             anjay_iid_t iid,
+                             anjay_unlocked_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+
+    _anjay_dm_emit_res_unlocked(ctx, RID_TX_DATA, ANJAY_DM_RES_R,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_RX_DATA, ANJAY_DM_RES_R,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_MAX_MESSAGE_SIZE, ANJAY_DM_RES_R,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_AVERAGE_MESSAGE_SIZE, ANJAY_DM_RES_R,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_START, ANJAY_DM_RES_E,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_STOP, ANJAY_DM_RES_E,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_COLLECTION_PERIOD, ANJAY_DM_RES_RW,
+                                ANJAY_DM_RES_PRESENT);
+    return 0;
+}
+
+static int64_t to_i64(uint64_t value) {
+    return (int64_t) AVS_MIN(value, (uint64_t) INT64_MAX);
+}
+
+static int cs_resource_read(anjay_unlocked_t *anjay,
+                            const anjay_dm_installed_object_t obj_ptr,
+                            anjay_iid_t iid,
+                            anjay_rid_t rid,
+                            anjay_riid_t riid,
+                            anjay_unlocked_output_ctx_t *ctx) {
+    (void) iid;
+    (void) riid;
+    assert(iid == IID);
+    assert(riid == ANJAY_ID_INVALID);
+
+    conn_stats_t *obj = get_obj(obj_ptr);
+    if (rid == RID_COLLECTION_PERIOD) {
+        return _anjay_ret_i64_unlocked(ctx, obj->collection_period);
+    }
+
+    anjay_net_traffic_stats_t stats;
+    get_collected_stats(anjay, obj, &stats);
+    const uint64_t messages = stats.sent_messages + stats.received_messages;
+
+    switch (rid) {
+    case RID_TX_DATA:
+        return _anjay_ret_i64_unlocked(ctx, to_i64(stats.tx_bytes / 1024));
+    case RID_RX_DATA:
+        return _anjay_ret_i64_unlocked(ctx, to_i64(stats.rx_bytes / 1024));
+    case RID_MAX_MESSAGE_SIZE:
+        return _anjay_ret_i64_unlocked(ctx, to_i64(stats.max_message_size));
+    case RID_AVERAGE_MESSAGE_SIZE:
+        return _anjay_ret_i64_unlocked(
+                ctx, messages ? to_i64(stats.total_messages_size / messages)
+                              : 0);
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int cs_resource_write(anjay_unlocked_t *anjay,
+                             const anjay_dm_installed_object_t obj_ptr,
+                             anjay_iid_t iid,
+                             anjay_rid_t rid,
+                             anjay_riid_t riid,
+                             anjay_unlocked_input_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+    (void) riid;
+    assert(iid == IID);
+    assert(riid == ANJAY_ID_INVALID);
+
+    conn_stats_t *obj = get_obj(obj_ptr);
+    switch (rid) {
+    case RID_COLLECTION_PERIOD: {
+        int32_t value;
+        int result = _anjay_get_i32_unlocked(ctx, &value);
+        if (result) {
+            return result;
+        } else if (value < 0) {
+            return ANJAY_ERR_BAD_REQUEST;
+        }
+        obj->collection_period = value;
+        return 0;
+    }
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int cs_resource_execute(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               anjay_unlocked_execute_ctx_t *arg_ctx) {
+    (void) iid;
+    (void) arg_ctx;
+    assert(iid == IID);
+
+    conn_stats_t *obj = get_obj(obj_ptr);
+    int result;
+    switch (rid) {
+    case RID_START:
+        if (!(result = start_collecting(anjay, obj))) {
+            notify_collected_stats(anjay);
+        }
+        return result;
+    case RID_STOP:
+        if (!obj->collecting) {
+            return ANJAY_ERR_BAD_REQUEST;
+        }
+        stop_collecting(anjay, obj);
+        notify_collected_stats(anjay);
+        return 0;
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int cs_transaction_begin(anjay_unlocked_t *anjay,
+                                const anjay_dm_installed_object_t obj_ptr) {
+    (void) anjay;
+    conn_stats_t *obj = get_obj(obj_ptr);
+    obj->saved_collection_period = obj->collection_period;
+    return 0;
+}
+
+static int cs_transaction_noop(anjay_unlocked_t *anjay,
+                               const anjay_dm_installed_object_t obj_ptr) {
+    (void) anjay;
+    (void) obj_ptr;
+    return 0;
+}
+
+static int cs_transaction_rollback(anjay_unlocked_t *anjay,
+                                   const anjay_dm_installed_object_t obj_ptr) {
+    (void) anjay;
+    conn_stats_t *obj = get_obj(obj_ptr);
+    obj->collection_period = obj->saved_collection_period;
+    return 0;
+}
+
+static const anjay_unlocked_dm_object_def_t OBJ_DEF = {
+    .oid = OID,
+    .handlers = {
+        .list_instances = cs_list_instances,
+        .instance_reset = cs_instance_reset,
+
+        .list_resources = cs_list_resources,
+        .resource_read = cs_resource_read,
+        .resource_write = cs_resource_write,
+        .resource_execute = cs_resource_execute,
+
+        .transaction_begin = cs_transaction_begin,
+        .transaction_validate = cs_transaction_noop,
+        .transaction_commit = cs_transaction_noop,
+        .transaction_rollback = cs_transaction_rollback
+    }
+};
+
+static void conn_stats_delete(void *obj_) {
+    conn_stats_t *obj = (conn_stats_t *) obj_;
+    avs_sched_del(&obj->stop_job);
+    // NOTE: obj itself will be freed when cleaning the objects list
+}
+
+int anjay_conn_statistics_install(anjay_t *anjay_locked) {
+    assert(anjay_locked);
+
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(conn_stats_t) obj = AVS_LIST_NEW_ELEMENT(conn_stats_t);
+    if (!obj) {
+        _anjay_log_oom();
+    } else {
+        obj->def = &OBJ_DEF;
+        _anjay_dm_installed_object_init_unlocked(&obj->def_ptr, &obj->def);
+        _ANJAY_ASSERT_INSTALLED_OBJECT_IS_FIRST_FIELD(conn_stats_t, def_ptr);
+
+        if (!_anjay_dm_module_install(anjay, conn_stats_delete, obj)) {
+            AVS_LIST(anjay_dm_installed_object_t) entry = &obj->def_ptr;
+            if (_anjay_register_object_unlocked(anjay, &entry)) {
+                result = _anjay_dm_module_uninstall(anjay, conn_stats_delete);
+                assert(!result);
+                result = -1;
+            } else {
+                result = 0;
+            }
+        }
+
+        if (result) {
+            AVS_LIST_CLEAR(&obj);
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+#endif // ANJAY_WITH_MODULE_CONN_STATISTICS
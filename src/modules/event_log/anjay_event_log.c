@@ -0,0 +1,680 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_MODULE_EVENT_LOG
+
+#    include <assert.h>
+#    include <inttypes.h>
+#    include <stdio.h>
+#    include <string.h>
+
+#    include <anjay/event_log.h>
+
+#    include <avsystem/commons/avs_defs.h>
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_mutex.h>
+
+#    include <anjay_modules/anjay_dm_utils.h>
+#    include <anjay_modules/anjay_notify.h>
+#    include <anjay_modules/anjay_sched.h>
+#    include <anjay_modules/anjay_utils_core.h>
+#    include <anjay_modules/dm/anjay_modules.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+#    define event_log_log(level, ...) _anjay_log(event_log, level, __VA_ARGS__)
+
+#    define OID 20
+#    define IID 0
+
+#    define RID_LOGCLASS 4010
+#    define RID_LOGSTART 4011
+#    define RID_LOGSTOP 4012
+#    define RID_LOGSTATUS 4013
+#    define RID_LOGDATA 4014
+#    define RID_LOGDATAFORMAT 4015
+
+#    define LOGSTART_ARG_KEEP_DATA 0
+#    define LOGSTART_ARG_STOP_DELAY 1
+#    define LOGSTOP_ARG_CLEAR_DATA 0
+
+#    define LOG_STATUS_STOPPED 0x01
+#    define LOG_STATUS_DATA_VALID 0x02
+#    define LOG_STATUS_ERROR 0x04
+
+/**
+ * Each entry is stored as a 16-bit big-endian length followed by its contents.
+ */
+#    define ENTRY_HEADER_SIZE 2
+
+/**
+ * Size of the stack buffer used to pass LogData contents from the storage to
+ * the output context.
+ */
+#    define READ_CHUNK_SIZE 64
+
+struct anjay_event_log_struct {
+    anjay_dm_installed_object_t def_ptr;
+    const anjay_unlocked_dm_object_def_t *def;
+
+    avs_sched_t *sched;
+    avs_sched_handle_t notify_job;
+    avs_sched_handle_t stop_job;
+
+    anjay_event_log_storage_handlers_t storage_handlers;
+    void *storage_user_ptr;
+    size_t capacity;
+
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    /**
+     * Guards the fields below, so that entries may be appended without locking
+     * the Anjay mutex. Always locked after the Anjay mutex, if both are held.
+     */
+    avs_mutex_t *mutex;
+#    endif // ANJAY_WITH_THREAD_SAFETY
+
+    /**
+     * Positions in an infinite byte stream, which is mapped onto the storage
+     * modulo its capacity. Data between start and end is valid.
+     */
+    uint64_t start;
+    uint64_t end;
+    /** Sum of sizes of all stored entries, excluding their headers. */
+    size_t data_size;
+    bool running;
+    bool error;
+    bool notify_pending;
+
+    /** Fields below are only accessed with the Anjay mutex held. */
+    uint8_t log_class;
+    uint8_t log_data_format;
+
+    /** Used if no storage handlers are configured. */
+    uint8_t ram_storage[];
+};
+
+static inline anjay_event_log_t *
+get_log(const anjay_dm_installed_object_t obj_ptr) {
+    return AVS_CONTAINER_OF(_anjay_dm_installed_object_get_unlocked(&obj_ptr),
+                            anjay_event_log_t, def);
+}
+
+static void lock_log(anjay_event_log_t *log) {
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    int result = avs_mutex_lock(log->mutex);
+    assert(!result);
+    (void) result;
+#    else  // ANJAY_WITH_THREAD_SAFETY
+    (void) log;
+#    endif // ANJAY_WITH_THREAD_SAFETY
+}
+
+static void unlock_log(anjay_event_log_t *log) {
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    avs_mutex_unlock(log->mutex);
+#    else  // ANJAY_WITH_THREAD_SAFETY
+    (void) log;
+#    endif // ANJAY_WITH_THREAD_SAFETY
+}
+
+static int
+ram_storage_read(void *user_ptr, size_t offset, void *buf, size_t size) {
+    memcpy(buf, (const uint8_t *) user_ptr + offset, size);
+    return 0;
+}
+
+static int ram_storage_write(void *user_ptr,
+                             size_t offset,
+                             const void *data,
+                             size_t size) {
+    memcpy((uint8_t *) user_ptr + offset, data, size);
+    return 0;
+}
+
+static const anjay_event_log_storage_handlers_t RAM_STORAGE_HANDLERS = {
+    .read = ram_storage_read,
+    .write = ram_storage_write
+};
+
+static int
+storage_read(anjay_event_log_t *log, uint64_t pos, void *buf, size_t size) {
+    const size_t offset = (size_t) (pos % log->capacity);
+    const size_t chunk_size = AVS_MIN(size, log->capacity - offset);
+    int result = log->storage_handlers.read(log->storage_user_ptr, offset,
+                                            buf, chunk_size);
+    if (!result && chunk_size < size) {
+        result = log->storage_handlers.read(log->storage_user_ptr, 0,
+                                            (uint8_t *) buf + chunk_size,
+                                            size - chunk_size);
+    }
+    if (result) {
+        event_log_log(ERROR, _("could not read from log storage"));
+        log->error = true;
+    }
+    return result;
+}
+
+static int storage_write(anjay_event_log_t *log,
+                         uint64_t pos,
+                         const void *data,
+                         size_t size) {
+    const size_t offset = (size_t) (pos % log->capacity);
+    const size_t chunk_size = AVS_MIN(size, log->capacity - offset);
+    int result = log->storage_handlers.write(log->storage_user_ptr, offset,
+                                             data, chunk_size);
+    if (!result && chunk_size < size) {
+        result = log->storage_handlers.write(log->storage_user_ptr, 0,
+                                             (const uint8_t *) data
+                                                     + chunk_size,
+                                             size - chunk_size);
+    }
+    if (result) {
+        event_log_log(ERROR, _("could not write to log storage"));
+        log->error = true;
+    }
+    return result;
+}
+
+static void clear_entries(anjay_event_log_t *log) {
+    log->start = log->end;
+    log->data_size = 0;
+}
+
+static int
+read_entry_size(anjay_event_log_t *log, uint64_t pos, size_t *out_size) {
+    uint8_t header[ENTRY_HEADER_SIZE];
+    if (storage_read(log, pos, header, sizeof(header))) {
+        return -1;
+    }
+    *out_size = (size_t) ((header[0] << 8) | header[1]);
+    if (!*out_size || pos + ENTRY_HEADER_SIZE + *out_size > log->end) {
+        event_log_log(ERROR, _("log storage is corrupted, discarding entries"));
+        log->error = true;
+        clear_entries(log);
+        return -1;
+    }
+    return 0;
+}
+
+static int append_entry(anjay_event_log_t *log, const void *data, size_t size) {
+    const size_t entry_size = ENTRY_HEADER_SIZE + size;
+    while (log->end - log->start + entry_size > log->capacity) {
+        size_t dropped_size;
+        if (read_entry_size(log, log->start, &dropped_size)) {
+            return -1;
+        }
+        log->start += ENTRY_HEADER_SIZE + dropped_size;
+        log->data_size -= dropped_size;
+    }
+
+    const uint8_t header[ENTRY_HEADER_SIZE] = { (uint8_t) (size >> 8),
+                                                (uint8_t) size };
+    if (storage_write(log, log->end, header, sizeof(header))
+            || storage_write(log, log->end + ENTRY_HEADER_SIZE, data, size)) {
+        return -1;
+    }
+    log->end += entry_size;
+    log->data_size += size;
+    return 0;
+}
+
+static int32_t get_log_status(anjay_event_log_t *log) {
+    lock_log(log);
+    int32_t status = 0;
+    if (!log->running) {
+        status |= LOG_STATUS_STOPPED;
+    }
+    if (log->data_size) {
+        status |= LOG_STATUS_DATA_VALID;
+    }
+    if (log->error) {
+        status |= LOG_STATUS_ERROR;
+    }
+    unlock_log(log);
+    return status;
+}
+
+static int read_log_data(anjay_event_log_t *log,
+                         anjay_unlocked_output_ctx_t *ctx) {
+    lock_log(log);
+    uint64_t pos = log->start;
+    const uint64_t end = log->end;
+    const size_t data_size = log->data_size;
+    unlock_log(log);
+
+    anjay_unlocked_ret_bytes_ctx_t *bytes_ctx =
+            _anjay_ret_bytes_begin_unlocked(ctx, data_size);
+    if (!bytes_ctx) {
+        return -1;
+    }
+
+    // The log lock is only held while accessing the storage, so that
+    // appending entries does not have to wait for the response to be sent.
+    uint8_t chunk[READ_CHUNK_SIZE];
+    size_t entry_left = 0;
+    while (pos < end) {
+        size_t chunk_size = 0;
+        int result = 0;
+        lock_log(log);
+        if (pos < log->start) {
+            event_log_log(WARNING,
+                          _("LogData overwritten while being read"));
+            result = ANJAY_ERR_SERVICE_UNAVAILABLE;
+        } else if (!entry_left
+                   && !(result = read_entry_size(log, pos, &entry_left))) {
+            pos += ENTRY_HEADER_SIZE;
+        }
+        if (!result) {
+            chunk_size = AVS_MIN(entry_left, sizeof(chunk));
+            if (!(result = storage_read(log, pos, chunk, chunk_size))) {
+                pos += chunk_size;
+                entry_left -= chunk_size;
+            }
+        }
+        unlock_log(log);
+
+        if (result
+                || (result = _anjay_ret_bytes_append_unlocked(bytes_ctx, chunk,
+                                                              chunk_size))) {
+            return result;
+        }
+    }
+    return 0;
+}
+
+static void set_collection_state(anjay_unlocked_t *anjay,
+                                 anjay_event_log_t *log,
+                                 bool running,
+                                 bool clear_data) {
+    lock_log(log);
+    log->running = running;
+    if (clear_data) {
+        clear_entries(log);
+        log->error = false;
+    }
+    unlock_log(log);
+
+    (void) (_anjay_notify_changed_unlocked(anjay, OID, IID, RID_LOGSTATUS)
+            || (clear_data
+                && _anjay_notify_changed_unlocked(anjay, OID, IID,
+                                                  RID_LOGDATA)));
+}
+
+static void notify_job(avs_sched_t *sched, const void *log_ptr) {
+    anjay_event_log_t *log = *(anjay_event_log_t *const *) log_ptr;
+    lock_log(log);
+    log->notify_pending = false;
+    unlock_log(log);
+
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    (void) (_anjay_notify_changed_unlocked(anjay, OID, IID, RID_LOGDATA)
+            || _anjay_notify_changed_unlocked(anjay, OID, IID, RID_LOGSTATUS));
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+static void stop_job(avs_sched_t *sched, const void *log_ptr) {
+    anjay_event_log_t *log = *(anjay_event_log_t *const *) log_ptr;
+    anjay_t *anjay_locked = _anjay_get_from_sched(sched);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    event_log_log(INFO, _("stopping data collection"));
+    set_collection_state(anjay, log, false, false);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+static int
+event_log_list_resources(anjay_unlocked_t *anjay,
+                         const anjay_dm_installed_object_t obj_ptr,
+                         anjay_iid_t iid,
+                         anjay_unlocked_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+
+    _anjay_dm_emit_res_unlocked(ctx, RID_LOGCLASS, ANJAY_DM_RES_RW,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_LOGSTART, ANJAY_DM_RES_E,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_LOGSTOP, ANJAY_DM_RES_E,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_LOGSTATUS, ANJAY_DM_RES_R,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_LOGDATA, ANJAY_DM_RES_R,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_LOGDATAFORMAT, ANJAY_DM_RES_RW,
+                                ANJAY_DM_RES_PRESENT);
+    return 0;
+}
+
+static int event_log_resource_read(anjay_unlocked_t *anjay,
+                                   const anjay_dm_installed_object_t obj_ptr,
+                                   anjay_iid_t iid,
+                                   anjay_rid_t rid,
+                                   anjay_riid_t riid,
+                                   anjay_unlocked_output_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+    (void) riid;
+    assert(iid == IID);
+    assert(riid == ANJAY_ID_INVALID);
+
+    anjay_event_log_t *log = get_log(obj_ptr);
+
+    switch (rid) {
+    case RID_LOGCLASS:
+        return _anjay_ret_i64_unlocked(ctx, log->log_class);
+    case RID_LOGSTATUS:
+        return _anjay_ret_i64_unlocked(ctx, get_log_status(log));
+    case RID_LOGDATA:
+        return read_log_data(log, ctx);
+    case RID_LOGDATAFORMAT:
+        return _anjay_ret_i64_unlocked(ctx, log->log_data_format);
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int get_u8(anjay_unlocked_input_ctx_t *ctx, uint8_t *out) {
+    int32_t value;
+    int result = _anjay_get_i32_unlocked(ctx, &value);
+    if (result) {
+        return result;
+    }
+    if (value < 0 || value > UINT8_MAX) {
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+    *out = (uint8_t) value;
+    return 0;
+}
+
+static int event_log_resource_write(anjay_unlocked_t *anjay,
+                                    const anjay_dm_installed_object_t obj_ptr,
+                                    anjay_iid_t iid,
+                                    anjay_rid_t rid,
+                                    anjay_riid_t riid,
+                                    anjay_unlocked_input_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+    (void) riid;
+    assert(iid == IID);
+    assert(riid == ANJAY_ID_INVALID);
+
+    anjay_event_log_t *log = get_log(obj_ptr);
+
+    switch (rid) {
+    case RID_LOGCLASS:
+        return get_u8(ctx, &log->log_class);
+    case RID_LOGDATAFORMAT:
+        return get_u8(ctx, &log->log_data_format);
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int get_arg_value(anjay_unlocked_execute_ctx_t *arg_ctx,
+                         int64_t *out_value) {
+    char value[AVS_INT_STR_BUF_SIZE(int64_t)];
+    int result = _anjay_execute_get_arg_value_unlocked(arg_ctx, NULL, value,
+                                                       sizeof(value));
+    if (result < 0) {
+        return result;
+    }
+    int num_read;
+    if (sscanf(value, "%" SCNd64 "%n", out_value, &num_read) != 1
+            || value[num_read] != '\0' || *out_value < 0) {
+        return ANJAY_ERR_BAD_REQUEST;
+    }
+    return 0;
+}
+
+static int parse_execute_args(anjay_unlocked_execute_ctx_t *arg_ctx,
+                              anjay_rid_t rid,
+                              bool *out_flag,
+                              int64_t *out_stop_delay_s) {
+    int arg;
+    bool has_value;
+    int result;
+    while (!(result = _anjay_execute_get_next_arg_unlocked(arg_ctx, &arg,
+                                                           &has_value))) {
+        if (!has_value) {
+            continue;
+        }
+        int64_t value;
+        if ((result = get_arg_value(arg_ctx, &value))) {
+            return result;
+        }
+        const int flag_arg = (rid == RID_LOGSTART ? LOGSTART_ARG_KEEP_DATA
+                                                  : LOGSTOP_ARG_CLEAR_DATA);
+        if (arg == flag_arg && value <= 1) {
+            *out_flag = (value == 1);
+        } else if (rid == RID_LOGSTART && arg == LOGSTART_ARG_STOP_DELAY) {
+            *out_stop_delay_s = value;
+        } else {
+            return ANJAY_ERR_BAD_REQUEST;
+        }
+    }
+    return result == ANJAY_EXECUTE_GET_ARG_END ? 0 : result;
+}
+
+static int event_log_resource_execute(anjay_unlocked_t *anjay,
+                                      const anjay_dm_installed_object_t obj_ptr,
+                                      anjay_iid_t iid,
+                                      anjay_rid_t rid,
+                                      anjay_unlocked_execute_ctx_t *arg_ctx) {
+    (void) iid;
+    assert(iid == IID);
+
+    anjay_event_log_t *log = get_log(obj_ptr);
+    bool flag = false;
+    int64_t stop_delay_s = 0;
+    int result;
+
+    switch (rid) {
+    case RID_LOGSTART:
+        if ((result = parse_execute_args(arg_ctx, rid, &flag,
+                                         &stop_delay_s))) {
+            return result;
+        }
+        avs_sched_del(&log->stop_job);
+        if (stop_delay_s
+                && AVS_SCHED_DELAYED(log->sched, &log->stop_job,
+                                     avs_time_duration_from_scalar(
+                                             stop_delay_s, AVS_TIME_S),
+                                     stop_job, &log, sizeof(log))) {
+            event_log_log(ERROR, _("could not schedule LogStop"));
+            return ANJAY_ERR_INTERNAL;
+        }
+        // LogData is emptied unless argument 0 is set to 1
+        set_collection_state(anjay, log, true, !flag);
+        return 0;
+
+    case RID_LOGSTOP:
+        if ((result = parse_execute_args(arg_ctx, rid, &flag, NULL))) {
+            return result;
+        }
+        avs_sched_del(&log->stop_job);
+        // LogData is kept unless argument 0 is set to 1
+        set_collection_state(anjay, log, false, flag);
+        return 0;
+
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int event_log_instance_reset(anjay_unlocked_t *anjay,
+                                    const anjay_dm_installed_object_t obj_ptr,
+                                    anjay_iid_t iid) {
+    (void) anjay;
+    (void) iid;
+    assert(iid == IID);
+
+    anjay_event_log_t *log = get_log(obj_ptr);
+    log->log_class = 0;
+    log->log_data_format = 0;
+    return 0;
+}
+
+static int event_log_list_instances(anjay_unlocked_t *anjay,
+                                    const anjay_dm_installed_object_t obj_ptr,
+                                    anjay_unlocked_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    _anjay_dm_emit_unlocked(ctx, IID);
+    return 0;
+}
+
+static int
+event_log_transaction_noop(anjay_unlocked_t *anjay,
+                           const anjay_dm_installed_object_t obj_ptr) {
+    (void) anjay;
+    (void) obj_ptr;
+    return 0;
+}
+
+static const anjay_unlocked_dm_object_def_t OBJ_DEF = {
+    .oid = OID,
+    .handlers = {
+        .list_instances = event_log_list_instances,
+        .instance_reset = event_log_instance_reset,
+
+        .list_resources = event_log_list_resources,
+        .resource_read = event_log_resource_read,
+        .resource_write = event_log_resource_write,
+        .resource_execute = event_log_resource_execute,
+
+        .transaction_begin = event_log_transaction_noop,
+        .transaction_validate = event_log_transaction_noop,
+        .transaction_commit = event_log_transaction_noop,
+        .transaction_rollback = event_log_transaction_noop
+    }
+};
+
+static void event_log_delete(void *log_) {
+    anjay_event_log_t *log = (anjay_event_log_t *) log_;
+    avs_sched_del(&log->notify_job);
+    avs_sched_del(&log->stop_job);
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    avs_mutex_cleanup(&log->mutex);
+#    endif // ANJAY_WITH_THREAD_SAFETY
+    // NOTE: log itself will be freed when cleaning the objects list
+}
+
+anjay_event_log_t *
+anjay_event_log_install(anjay_t *anjay_locked,
+                        const anjay_event_log_config_t *config) {
+    assert(anjay_locked);
+    assert(config);
+
+    if (config->capacity <= ENTRY_HEADER_SIZE) {
+        event_log_log(ERROR, _("log storage capacity too small"));
+        return NULL;
+    }
+    if (config->storage_handlers
+            && (!config->storage_handlers->read
+                || !config->storage_handlers->write)) {
+        event_log_log(ERROR, _("incomplete log storage handlers"));
+        return NULL;
+    }
+
+    anjay_event_log_t *result = NULL;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_event_log_t) log =
+            (AVS_LIST(anjay_event_log_t)) AVS_LIST_NEW_BUFFER(
+                    sizeof(anjay_event_log_t)
+                    + (config->storage_handlers ? 0 : config->capacity));
+    if (!log) {
+        _anjay_log_oom();
+        goto finish;
+    }
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    if (avs_mutex_create(&log->mutex)) {
+        event_log_log(ERROR, _("could not create mutex"));
+        AVS_LIST_CLEAR(&log);
+        goto finish;
+    }
+#    endif // ANJAY_WITH_THREAD_SAFETY
+
+    log->def = &OBJ_DEF;
+    _anjay_dm_installed_object_init_unlocked(&log->def_ptr, &log->def);
+    _ANJAY_ASSERT_INSTALLED_OBJECT_IS_FIRST_FIELD(anjay_event_log_t, def_ptr);
+    log->sched = _anjay_get_scheduler_unlocked(anjay);
+    if (config->storage_handlers) {
+        log->storage_handlers = *config->storage_handlers;
+        log->storage_user_ptr = config->storage_user_ptr;
+    } else {
+        log->storage_handlers = RAM_STORAGE_HANDLERS;
+        log->storage_user_ptr = log->ram_storage;
+    }
+    log->capacity = config->capacity;
+    log->running = config->start_collecting;
+
+    if (_anjay_dm_module_install(anjay, event_log_delete, log)) {
+        event_log_delete(log);
+    } else {
+        AVS_LIST(anjay_dm_installed_object_t) entry = &log->def_ptr;
+        if (_anjay_register_object_unlocked(anjay, &entry)) {
+            int uninstall_result =
+                    _anjay_dm_module_uninstall(anjay, event_log_delete);
+            assert(!uninstall_result);
+            (void) uninstall_result;
+        } else {
+            result = log;
+        }
+    }
+    if (!result) {
+        AVS_LIST_CLEAR(&log);
+    }
+finish:;
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+int anjay_event_log_append(anjay_event_log_t *log,
+                           const void *data,
+                           size_t size) {
+    assert(log);
+    assert(data || !size);
+    if (!size || size > UINT16_MAX
+            || size > log->capacity - ENTRY_HEADER_SIZE) {
+        event_log_log(ERROR, _("invalid log entry size: ") "%lu",
+                      (unsigned long) size);
+        return -1;
+    }
+
+    int result = 0;
+    bool schedule_notify = false;
+    lock_log(log);
+    if (log->running && !(result = append_entry(log, data, size))) {
+        schedule_notify = !log->notify_pending;
+        log->notify_pending = true;
+    }
+    unlock_log(log);
+
+    // avs_sched is thread-safe on its own when Anjay is built with thread
+    // safety, so the notification is deferred instead of waiting for the
+    // Anjay mutex here
+    if (schedule_notify
+            && AVS_SCHED_NOW(log->sched, &log->notify_job, notify_job, &log,
+                             sizeof(log))) {
+        event_log_log(WARNING, _("could not schedule LogData notification"));
+        lock_log(log);
+        log->notify_pending = false;
+        unlock_log(log);
+    }
+    return result;
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/modules/event_log/event_log.c"
+#    endif
+
+#endif // ANJAY_WITH_MODULE_EVENT_LOG
@@ -33,7 +33,8 @@ VISIBILITY_SOURCE_BEGIN
         _anjay_log(anjay_factory_provision, __VA_ARGS__)
 
 static avs_error_t factory_provisioning_unlocked(anjay_unlocked_t *anjay,
-                                                 avs_stream_t *data_stream) {
+                                                 avs_stream_t *data_stream,
+                                                 bool bulk) {
     if (_anjay_bootstrap_in_progress(anjay)) {
         provisioning_log(ERROR,
                          _("Transaction with LwM2M Bootstrap Server in "
@@ -50,7 +51,7 @@ static avs_error_t factory_provisioning_unlocked(anjay_unlocked_t *anjay,
             provisioning_log(ERROR, _("Cannot create CBOR context"));
             err = avs_errno(AVS_ENOMEM);
         } else {
-            if (_anjay_bootstrap_write_composite(anjay, input_ctx)) {
+            if (_anjay_bootstrap_write_composite(anjay, input_ctx, bulk)) {
                 provisioning_log(ERROR,
                                  _("Error occured during writing bootstrap "
                                    "information"));
@@ -77,7 +78,16 @@ avs_error_t anjay_factory_provision(anjay_t *anjay_locked,
                                     avs_stream_t *data_stream) {
     avs_error_t err = avs_errno(AVS_EINVAL);
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    err = factory_provisioning_unlocked(anjay, data_stream);
+    err = factory_provisioning_unlocked(anjay, data_stream, false);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+avs_error_t anjay_factory_provision_bulk(anjay_t *anjay_locked,
+                                         avs_stream_t *data_stream) {
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    err = factory_provisioning_unlocked(anjay, data_stream, true);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return err;
 }
@@ -31,7 +31,9 @@
 
 #    include <anjay_modules/anjay_dm_utils.h>
 #    include <anjay_modules/anjay_io_utils.h>
+#    include <anjay_modules/anjay_memory_accounting.h>
 #    include <anjay_modules/anjay_sched.h>
+#    include <anjay_modules/anjay_sha256.h>
 #    include <anjay_modules/anjay_utils_core.h>
 #    include <anjay_modules/dm/anjay_modules.h>
 
@@ -64,10 +66,37 @@ typedef enum {
     UPDATE_STATE_UPDATING
 } fw_update_state_t;
 
+#    define DELTA_MAGIC_MAX_SIZE 16
+
+typedef enum {
+    DELTA_MODE_UNDECIDED = 0,
+    DELTA_MODE_FULL_IMAGE,
+    DELTA_MODE_PATCH
+} delta_mode_t;
+
+typedef enum {
+    DIGEST_STATE_NONE = 0,
+    DIGEST_STATE_COMPUTING,
+    DIGEST_STATE_DONE
+} digest_state_t;
+
 typedef struct {
     const anjay_fw_update_handlers_t *handlers;
     void *arg;
     fw_update_state_t state;
+
+    // beginning of the package is buffered in delta_magic until it can be
+    // determined whether it is a delta patch
+    delta_mode_t delta_mode;
+    uint8_t delta_magic[DELTA_MAGIC_MAX_SIZE];
+    size_t delta_magic_size;
+    void *delta_ctx;
+
+    // digest of the package as received, i.e. before applying delta patches
+    bool compute_digest;
+    digest_state_t digest_state;
+    anjay_sha256_t digest_ctx;
+    uint8_t digest[ANJAY_FW_UPDATE_PACKAGE_DIGEST_SIZE];
 } fw_user_state_t;
 
 typedef struct fw_repr {
@@ -87,6 +116,10 @@ typedef struct fw_repr {
     bool downloads_suspended;
     avs_sched_handle_t resume_download_job;
     avs_time_monotonic_t resume_download_deadline;
+    size_t download_checkpoint_interval;
+    size_t download_offset;
+    size_t last_checkpoint_offset;
+    bool download_checkpointed;
 #    endif // ANJAY_WITH_DOWNLOADER
 #    ifdef ANJAY_WITH_SEND
     bool use_lwm2m_send;
@@ -108,38 +141,11 @@ static inline fw_repr_t *get_fw(const anjay_dm_installed_object_t obj_ptr) {
 
 #        define SEND_FW_RES_PATH(Res) SEND_RES_PATH(FW_OID, 0, FW_RES_##Res)
 
-static int perform_send(anjay_unlocked_t *anjay,
-                        const anjay_dm_installed_object_t *obj,
-                        anjay_iid_t iid,
-                        void *batch) {
-    (void) obj;
-    anjay_ssid_t ssid;
-    const anjay_uri_path_t ssid_path =
-            MAKE_RESOURCE_PATH(ANJAY_DM_OID_SERVER, iid,
-                               ANJAY_DM_RID_SERVER_SSID);
-
-    if (_anjay_dm_read_resource_u16(anjay, &ssid_path, &ssid)) {
-        return 0;
-    }
-
-    if (_anjay_send_deferrable_unlocked(anjay, (anjay_ssid_t) ssid,
-                                        (anjay_send_batch_t *) batch, NULL,
-                                        NULL)
-            != ANJAY_SEND_OK) {
-        fw_log(WARNING, _("failed to perform Send, SSID: ") "%d", ssid);
-    }
-
-    return 0;
-}
-
 static void send_batch_to_all_servers(anjay_unlocked_t *anjay,
                                       anjay_send_batch_t *batch) {
-    const anjay_dm_installed_object_t *obj =
-            _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_SERVER);
-
-    if (_anjay_dm_foreach_instance(anjay, obj, perform_send, batch)) {
-        fw_log(ERROR, _("failed to perform Send to all servers"));
-    }
+    // failures for particular servers are logged by the Send implementation
+    (void) _anjay_send_to_servers_unlocked(anjay, NULL, 0, batch, true, NULL,
+                                           NULL);
 }
 
 static void perform_lwm2m_send(anjay_unlocked_t *anjay,
@@ -225,6 +231,95 @@ static void set_user_state(fw_user_state_t *user, fw_update_state_t new_state) {
     user->state = new_state;
 }
 
+static int delta_io_read_current_image(const anjay_fw_update_delta_io_t *io,
+                                       size_t offset,
+                                       void *buffer,
+                                       size_t length) {
+    const fw_user_state_t *user = (const fw_user_state_t *) io->arg;
+    return user->handlers->read_current_image(user->arg, offset, buffer,
+                                              length);
+}
+
+static int delta_io_write_image(const anjay_fw_update_delta_io_t *io,
+                                const void *data,
+                                size_t length) {
+    const fw_user_state_t *user = (const fw_user_state_t *) io->arg;
+    if (!length) {
+        return 0;
+    }
+    return user->handlers->stream_write(user->arg, data, length);
+}
+
+static anjay_fw_update_delta_io_t delta_io(fw_user_state_t *user) {
+    return (anjay_fw_update_delta_io_t) {
+        .read_current_image = delta_io_read_current_image,
+        .write_image = delta_io_write_image,
+        .arg = user
+    };
+}
+
+// NOTE: delta_* functions call user handlers directly, so they shall only be
+// called with the Anjay mutex unlocked.
+static int
+delta_stream_write(fw_user_state_t *user, const uint8_t *data, size_t length) {
+    const anjay_fw_update_delta_patcher_t *patcher =
+            user->handlers->delta_patcher;
+    const anjay_fw_update_delta_io_t io = delta_io(user);
+    int result = 0;
+    if (user->delta_mode == DELTA_MODE_UNDECIDED) {
+        const size_t chunk =
+                AVS_MIN(length, patcher->magic_size - user->delta_magic_size);
+        memcpy(user->delta_magic + user->delta_magic_size, data, chunk);
+        user->delta_magic_size += chunk;
+        data += chunk;
+        length -= chunk;
+        if (memcmp(user->delta_magic, patcher->magic,
+                   user->delta_magic_size)) {
+            user->delta_mode = DELTA_MODE_FULL_IMAGE;
+            result = user->handlers->stream_write(
+                    user->arg, user->delta_magic, user->delta_magic_size);
+        } else if (user->delta_magic_size == patcher->magic_size) {
+            fw_log(INFO, _("delta package detected"));
+            if (!(result = patcher->open(user->arg, &user->delta_ctx))) {
+                user->delta_mode = DELTA_MODE_PATCH;
+                result = patcher->write(user->delta_ctx, user->delta_magic,
+                                        user->delta_magic_size, &io);
+            }
+        }
+        if (result || !length) {
+            return result;
+        }
+    }
+    if (user->delta_mode == DELTA_MODE_PATCH) {
+        return patcher->write(user->delta_ctx, data, length, &io);
+    }
+    return user->handlers->stream_write(user->arg, data, length);
+}
+
+static void delta_reset(fw_user_state_t *user) {
+    if (user->delta_ctx) {
+        user->handlers->delta_patcher->close(user->delta_ctx);
+        user->delta_ctx = NULL;
+    }
+    user->delta_mode = DELTA_MODE_UNDECIDED;
+    user->delta_magic_size = 0;
+}
+
+static int delta_stream_finish(fw_user_state_t *user) {
+    const anjay_fw_update_delta_io_t io = delta_io(user);
+    int result = 0;
+    if (user->delta_mode == DELTA_MODE_PATCH) {
+        result = user->handlers->delta_patcher->finish(user->delta_ctx, &io);
+    } else if (user->delta_magic_size > 0
+               && user->delta_mode == DELTA_MODE_UNDECIDED) {
+        // package shorter than the magic
+        result = user->handlers->stream_write(user->arg, user->delta_magic,
+                                              user->delta_magic_size);
+    }
+    delta_reset(user);
+    return result;
+}
+
 static int
 user_state_ensure_stream_open(anjay_unlocked_t *anjay,
                               fw_user_state_t *user,
@@ -240,6 +335,10 @@ user_state_ensure_stream_open(anjay_unlocked_t *anjay,
     ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
     if (!result) {
         set_user_state(user, UPDATE_STATE_DOWNLOADING);
+        if (user->compute_digest) {
+            _anjay_sha256_init(&user->digest_ctx);
+            user->digest_state = DIGEST_STATE_COMPUTING;
+        }
     }
     return result;
 }
@@ -251,8 +350,19 @@ static int user_state_stream_write(anjay_unlocked_t *anjay,
     assert(user->state == UPDATE_STATE_DOWNLOADING);
     int result = -1;
     ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
-    result = user->handlers->stream_write(user->arg, data, length);
+    if (user->handlers->delta_patcher) {
+        result = delta_stream_write(user, (const uint8_t *) data, length);
+    } else {
+        result = user->handlers->stream_write(user->arg, data, length);
+    }
     ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
+    if (user->digest_state == DIGEST_STATE_COMPUTING) {
+        if (result) {
+            user->digest_state = DIGEST_STATE_NONE;
+        } else {
+            _anjay_sha256_update(&user->digest_ctx, data, length);
+        }
+    }
     return result;
 }
 
@@ -308,10 +418,26 @@ static int user_state_perform_upgrade(anjay_unlocked_t *anjay, fw_repr_t *fw) {
 static int finish_user_stream(anjay_unlocked_t *anjay, fw_repr_t *fw) {
     assert(fw->user_state.state == UPDATE_STATE_DOWNLOADING);
     int result = -1;
+    // digest is finalized beforehand, so that it can already be verified
+    // within the stream_finish handler
+    if (fw->user_state.digest_state == DIGEST_STATE_COMPUTING) {
+        _anjay_sha256_finish(&fw->user_state.digest_ctx,
+                             fw->user_state.digest);
+        fw->user_state.digest_state = DIGEST_STATE_DONE;
+    }
     ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
-    result = fw->user_state.handlers->stream_finish(fw->user_state.arg);
+    if (fw->user_state.handlers->delta_patcher
+            && (result = delta_stream_finish(&fw->user_state))) {
+        fw_log(ERROR, _("could not apply delta package"));
+        // the stream is considered closed after a failed finish, so it needs
+        // to be closed on the user side as well
+        fw->user_state.handlers->reset(fw->user_state.arg);
+    } else {
+        result = fw->user_state.handlers->stream_finish(fw->user_state.arg);
+    }
     ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
     if (result) {
+        fw->user_state.digest_state = DIGEST_STATE_NONE;
         set_user_state(&fw->user_state, UPDATE_STATE_IDLE);
     } else {
         set_user_state(&fw->user_state, UPDATE_STATE_DOWNLOADED);
@@ -320,7 +446,11 @@ static int finish_user_stream(anjay_unlocked_t *anjay, fw_repr_t *fw) {
 }
 
 static void reset_user_state(anjay_unlocked_t *anjay, fw_repr_t *fw) {
+    fw->user_state.digest_state = DIGEST_STATE_NONE;
     ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
+    if (fw->user_state.handlers->delta_patcher) {
+        delta_reset(&fw->user_state);
+    }
     fw->user_state.handlers->reset(fw->user_state.arg);
     ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
     set_user_state(&fw->user_state, UPDATE_STATE_IDLE);
@@ -570,6 +700,48 @@ static anjay_transport_security_t transport_security_from_uri(const char *uri) {
 #    endif // ANJAY_WITH_COAP_DOWNLOAD || ANJAY_WITH_HTTP_DOWNLOAD
 
 #    ifdef ANJAY_WITH_DOWNLOADER
+#        define DEFAULT_DOWNLOAD_CHECKPOINT_INTERVAL 16384
+
+static void persist_download_state(anjay_unlocked_t *anjay,
+                                   fw_repr_t *fw,
+                                   const anjay_etag_t *etag) {
+    if (!fw->user_state.handlers->persist_download_state) {
+        return;
+    }
+    int result = -1;
+    ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, anjay);
+    result = fw->user_state.handlers->persist_download_state(
+            fw->user_state.arg, etag ? fw->package_uri : NULL, etag,
+            etag ? fw->download_offset : 0);
+    ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
+    if (result) {
+        fw_log(WARNING, _("could not persist firmware download state"));
+    }
+    fw->download_checkpointed = (etag != NULL);
+}
+
+// A checkpoint is only valid once every byte counted in download_offset has
+// been passed to stream_write. This is not the case while the beginning of the
+// package is still held in delta_magic, nor while a patch is being applied.
+static bool download_checkpoint_allowed(const fw_user_state_t *user) {
+    return !user->handlers->delta_patcher
+           || user->delta_mode == DELTA_MODE_FULL_IMAGE;
+}
+
+static void maybe_checkpoint_download(anjay_unlocked_t *anjay,
+                                      fw_repr_t *fw,
+                                      const anjay_etag_t *etag) {
+    size_t interval = fw->download_checkpoint_interval;
+    if (!interval) {
+        interval = DEFAULT_DOWNLOAD_CHECKPOINT_INTERVAL;
+    }
+    if (etag && download_checkpoint_allowed(&fw->user_state)
+            && fw->download_offset - fw->last_checkpoint_offset >= interval) {
+        fw->last_checkpoint_offset = fw->download_offset;
+        persist_download_state(anjay, fw, etag);
+    }
+}
+
 static avs_error_t download_write_block(anjay_t *anjay_locked,
                                         const uint8_t *data,
                                         size_t data_size,
@@ -589,6 +761,9 @@ static avs_error_t download_write_block(anjay_t *anjay_locked,
         fw_log(ERROR, _("could not write firmware"));
         handle_err_result(anjay, fw, UPDATE_STATE_IDLE, result,
                           ANJAY_FW_UPDATE_RESULT_NOT_ENOUGH_SPACE);
+    } else {
+        fw->download_offset += data_size;
+        maybe_checkpoint_download(anjay, fw, etag);
     }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return result ? avs_errno(AVS_UNKNOWN_ERROR) : AVS_OK;
@@ -605,6 +780,9 @@ static void download_finished(anjay_t *anjay_locked,
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     fw_repr_t *fw = (fw_repr_t *) fw_;
     fw->download_handle = NULL;
+    if (fw->download_checkpointed) {
+        persist_download_state(anjay, fw, NULL);
+    }
     if (fw->state != UPDATE_STATE_DOWNLOADING) {
         // something already failed in download_write_block()
         reset_user_state(anjay, fw);
@@ -675,7 +853,11 @@ static int schedule_download(anjay_unlocked_t *anjay,
         .on_next_block = download_write_block,
         .on_download_finished = download_finished,
         .user_data = fw,
-        .prefer_same_socket_downloads = fw->prefer_same_socket_downloads
+        .prefer_same_socket_downloads = fw->prefer_same_socket_downloads,
+        // security_config is then read from the data model
+        .resume_server_dtls_session =
+                !fw->user_state.handlers->get_security_config,
+        .block_buffer_provider = fw->user_state.handlers->block_buffer_provider
     };
 
     if (transport_security_from_uri(fw->package_uri)
@@ -726,6 +908,8 @@ static int schedule_download(anjay_unlocked_t *anjay,
         _anjay_download_suspend_unlocked(anjay, fw->download_handle);
     }
     fw->retry_download_on_expired = (etag != NULL);
+    fw->download_offset = start_offset;
+    fw->last_checkpoint_offset = start_offset;
     update_state_and_update_result(anjay, fw, UPDATE_STATE_DOWNLOADING,
                                    ANJAY_FW_UPDATE_RESULT_INITIAL);
     fw_log(INFO, _("download started: ") "%s", fw->package_uri);
@@ -1188,10 +1372,16 @@ initialize_fw_repr(anjay_unlocked_t *anjay,
 #    ifdef ANJAY_WITH_DOWNLOADER
     repr->prefer_same_socket_downloads =
             initial_state->prefer_same_socket_downloads;
+    repr->download_checkpoint_interval =
+            initial_state->download_checkpoint_interval;
+    // a resumed download has been checkpointed before the reboot
+    repr->download_checkpointed =
+            (initial_state->result == ANJAY_FW_UPDATE_INITIAL_DOWNLOADING);
 #    endif // ANJAY_WITH_DOWNLOADER
 #    ifdef ANJAY_WITH_SEND
     repr->use_lwm2m_send = initial_state->use_lwm2m_send;
 #    endif // ANJAY_WITH_SEND
+    repr->user_state.compute_digest = initial_state->compute_package_digest;
 
     switch (initial_state->result) {
     case ANJAY_FW_UPDATE_INITIAL_DOWNLOADED:
@@ -1213,6 +1403,10 @@ initialize_fw_repr(anjay_unlocked_t *anjay,
             reset_user_state(anjay, repr);
             resume_offset = 0;
         }
+        if (resume_offset > 0) {
+            // checkpoints are never made for delta packages
+            repr->user_state.delta_mode = DELTA_MODE_FULL_IMAGE;
+        }
         if (!initial_state->persisted_uri
                 || !(repr->package_uri =
                              avs_strdup(initial_state->persisted_uri))) {
@@ -1261,8 +1455,18 @@ int anjay_fw_update_install(
         void *user_arg,
         const anjay_fw_update_initial_state_t *initial_state) {
     assert(anjay_locked);
+    const anjay_fw_update_delta_patcher_t *patcher = handlers->delta_patcher;
+    if (patcher
+            && (!handlers->read_current_image || !patcher->magic
+                || !patcher->magic_size
+                || patcher->magic_size > DELTA_MAGIC_MAX_SIZE || !patcher->open
+                || !patcher->write || !patcher->finish || !patcher->close)) {
+        fw_log(ERROR, _("invalid delta patcher configuration"));
+        return -1;
+    }
     int result = -1;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_MODULES);
     AVS_LIST(fw_repr_t) repr = AVS_LIST_NEW_ELEMENT(fw_repr_t);
     if (!repr) {
         _anjay_log_oom();
@@ -1293,6 +1497,7 @@ int anjay_fw_update_install(
             AVS_LIST_CLEAR(&repr);
         }
     }
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return result;
 }
@@ -1351,6 +1556,30 @@ int anjay_fw_update_set_result(anjay_t *anjay_locked,
     return retval;
 }
 
+int anjay_fw_update_get_package_digest(
+        anjay_t *anjay_locked,
+        uint8_t out_digest[ANJAY_FW_UPDATE_PACKAGE_DIGEST_SIZE]) {
+    assert(anjay_locked);
+    assert(out_digest);
+    int retval = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_FIRMWARE_UPDATE);
+    if (!obj) {
+        fw_log(WARNING, _("Firmware Update object not installed"));
+    } else {
+        fw_repr_t *fw = get_fw(*obj);
+        assert(fw);
+        if (fw->user_state.digest_state == DIGEST_STATE_DONE) {
+            memcpy(out_digest, fw->user_state.digest,
+                   sizeof(fw->user_state.digest));
+            retval = 0;
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return retval;
+}
+
 #    ifdef ANJAY_WITH_DOWNLOADER
 void anjay_fw_update_pull_suspend(anjay_t *anjay_locked) {
     assert(anjay_locked);
@@ -1392,6 +1621,34 @@ int anjay_fw_update_pull_reconnect(anjay_t *anjay_locked) {
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return result;
 }
+
+int anjay_fw_update_get_download_stats(anjay_t *anjay_locked,
+                                       anjay_download_stats_t *out_stats) {
+    assert(anjay_locked);
+    assert(out_stats);
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_FIRMWARE_UPDATE);
+    if (!obj) {
+        fw_log(WARNING, _("Firmware Update object not installed"));
+    } else {
+        fw_repr_t *fw = get_fw(*obj);
+        assert(fw);
+        if (fw->download_handle
+                && avs_is_ok(_anjay_download_get_stats_unlocked(
+                           anjay, fw->download_handle, out_stats))) {
+            result = 0;
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
 #    endif // ANJAY_WITH_DOWNLOADER
 
+#    ifdef ANJAY_TEST
+#        include "tests/modules/fw_update/checkpoint.c"
+#        include "tests/modules/fw_update/delta.c"
+#    endif // ANJAY_TEST
+
 #endif // ANJAY_WITH_MODULE_FW_UPDATE
@@ -19,6 +19,7 @@
 #    include <anjay/ipso_objects.h>
 
 #    include <anjay_modules/anjay_dm_utils.h>
+#    include <anjay_modules/anjay_running_stats.h>
 #    include <anjay_modules/anjay_utils_core.h>
 
 #    include <avsystem/commons/avs_defs.h>
@@ -81,8 +82,11 @@ typedef struct {
     bool initialized;
 
     double curr_value;
+    // last value reported with anjay_notify_changed(), see notify_deadband
+    double notified_value;
     double min_value;
     double max_value;
+    anjay_running_stats_t aggregates;
 } anjay_ipso_basic_sensor_instance_t;
 
 typedef struct {
@@ -166,8 +170,14 @@ static int update_curr_value(anjay_unlocked_t *anjay,
         return err;
     }
 
-    if (value != inst->curr_value) {
-        inst->curr_value = value;
+    if (isfinite(value)) {
+        _anjay_running_stats_add(&inst->aggregates, value);
+    }
+    inst->curr_value = value;
+    if (value != inst->notified_value
+            && !(fabs(value - inst->notified_value)
+                 < inst->impl.notify_deadband)) {
+        inst->notified_value = value;
         (void) _anjay_notify_changed_unlocked(anjay, oid, iid,
                                               RID_SENSOR_VALUE);
     }
@@ -283,6 +293,7 @@ basic_sensor_resource_execute(anjay_unlocked_t *anjay,
             (void) _anjay_notify_changed_unlocked(anjay, obj->def.oid, iid,
                                                   RID_MAX_MEASURED_VALUE);
         }
+        _anjay_running_stats_reset(&inst->aggregates);
 
         return 0;
 
@@ -402,8 +413,13 @@ int anjay_ipso_basic_sensor_instance_add(
     inst->initialized = true;
     inst->impl = impl;
     inst->curr_value = value;
+    inst->notified_value = value;
     inst->min_value = value;
     inst->max_value = value;
+    _anjay_running_stats_reset(&inst->aggregates);
+    if (isfinite(value)) {
+        _anjay_running_stats_add(&inst->aggregates, value);
+    }
 
     _anjay_notify_instances_changed_unlocked(anjay, oid);
 
@@ -489,4 +505,67 @@ finish:;
     return err;
 }
 
+static anjay_ipso_basic_sensor_instance_t *
+initialized_instance(anjay_unlocked_t *anjay,
+                     anjay_oid_t oid,
+                     anjay_iid_t iid) {
+    anjay_ipso_basic_sensor_t *obj = obj_from_oid(anjay, oid);
+    if (!obj) {
+        _anjay_log(ipso, ERROR, _("Object") " %d" _(" is not installed"), oid);
+        return NULL;
+    }
+    if (iid >= obj->num_instances || !obj->instances[iid].initialized) {
+        _anjay_log(ipso, ERROR, _("Object") " %d" _(" has no instance") " %d",
+                   oid, iid);
+        return NULL;
+    }
+    return &obj->instances[iid];
+}
+
+int anjay_ipso_basic_sensor_aggregates_get(
+        anjay_t *anjay_locked,
+        anjay_oid_t oid,
+        anjay_iid_t iid,
+        anjay_ipso_basic_sensor_aggregates_t *out_aggregates) {
+    if (!anjay_locked) {
+        _anjay_log(ipso, ERROR, _("Anjay pointer is NULL"));
+        return -1;
+    }
+    assert(out_aggregates);
+
+    int err = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    const anjay_ipso_basic_sensor_instance_t *inst =
+            initialized_instance(anjay, oid, iid);
+    if (inst) {
+        out_aggregates->count = inst->aggregates.count;
+        out_aggregates->mean = _anjay_running_stats_mean(&inst->aggregates);
+        out_aggregates->variance =
+                _anjay_running_stats_variance(&inst->aggregates);
+        err = 0;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+int anjay_ipso_basic_sensor_aggregates_reset(anjay_t *anjay_locked,
+                                             anjay_oid_t oid,
+                                             anjay_iid_t iid) {
+    if (!anjay_locked) {
+        _anjay_log(ipso, ERROR, _("Anjay pointer is NULL"));
+        return -1;
+    }
+
+    int err = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    anjay_ipso_basic_sensor_instance_t *inst =
+            initialized_instance(anjay, oid, iid);
+    if (inst) {
+        _anjay_running_stats_reset(&inst->aggregates);
+        err = 0;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
 #endif // ANJAY_WITH_MODULE_IPSO_OBJECTS
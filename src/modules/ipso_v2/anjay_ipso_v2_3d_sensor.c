@@ -125,6 +125,8 @@ typedef struct {
     bool initialized;
     sensor_meta_t meta;
     sensor_value_t curr_value;
+    // last values reported with anjay_notify_changed(), see notify_deadband
+    sensor_value_t notified_value;
     sensor_value_t min_value;
     sensor_value_t max_value;
 } instance_t;
@@ -480,6 +482,11 @@ static int sensor_instance_add_unlocked(anjay_unlocked_t *anjay,
         return -1;
     }
 
+    if (!(meta->notify_deadband >= 0.0) || !isfinite(meta->notify_deadband)) {
+        log_invalid_parameters(_("Notify deadband invalid"));
+        return -1;
+    }
+
     if (!value_valid(meta, initial_value)) {
         log_invalid_parameters(_("Initial value invalid"));
         return -1;
@@ -494,6 +501,7 @@ static int sensor_instance_add_unlocked(anjay_unlocked_t *anjay,
     inst->initialized = true;
     inst->meta = *meta;
     inst->curr_value = *initial_value;
+    inst->notified_value = *initial_value;
     inst->min_value = *initial_value;
     inst->max_value = *initial_value;
 
@@ -552,85 +560,104 @@ int anjay_ipso_v2_3d_sensor_instance_remove(anjay_t *anjay_locked,
     return res;
 }
 
-static void update_curr_value(anjay_unlocked_t *anjay,
+static void update_axis_value(anjay_unlocked_t *anjay,
                               anjay_oid_t oid,
                               anjay_iid_t iid,
-                              instance_t *inst,
-                              const sensor_value_t *value) {
-    if (value->x != inst->curr_value.x) {
-        inst->curr_value.x = value->x;
-        (void) _anjay_notify_changed_unlocked(anjay, oid, iid, RID_X_VALUE);
-    }
-    if (inst->meta.y_axis_present && value->y != inst->curr_value.y) {
-        inst->curr_value.y = value->y;
-        (void) _anjay_notify_changed_unlocked(anjay, oid, iid, RID_Y_VALUE);
-    }
-    if (inst->meta.z_axis_present && value->z != inst->curr_value.z) {
-        inst->curr_value.z = value->z;
-        (void) _anjay_notify_changed_unlocked(anjay, oid, iid, RID_Z_VALUE);
+                              anjay_rid_t rid,
+                              double deadband,
+                              double *curr_value,
+                              double *notified_value,
+                              double value) {
+    *curr_value = value;
+    if (value != *notified_value
+            && !(fabs(value - *notified_value) < deadband)) {
+        *notified_value = value;
+        (void) _anjay_notify_changed_unlocked(anjay, oid, iid, rid);
     }
 }
 
-static void update_x_min_max(anjay_unlocked_t *anjay,
-                             anjay_oid_t oid,
-                             anjay_iid_t iid,
-                             instance_t *inst,
-                             const sensor_value_t *value) {
-    if (value->x < inst->min_value.x) {
-        inst->min_value.x = value->x;
-        (void) _anjay_notify_changed_unlocked(anjay, oid, iid, RID_MIN_X_VALUE);
+static void update_curr_value(anjay_unlocked_t *anjay,
+                              anjay_oid_t oid,
+                              anjay_iid_t iid,
+                              instance_t *inst,
+                              const sensor_value_t *value) {
+    const double deadband = inst->meta.notify_deadband;
+    update_axis_value(anjay, oid, iid, RID_X_VALUE, deadband,
+                      &inst->curr_value.x, &inst->notified_value.x, value->x);
+    if (inst->meta.y_axis_present) {
+        update_axis_value(anjay, oid, iid, RID_Y_VALUE, deadband,
+                          &inst->curr_value.y, &inst->notified_value.y,
+                          value->y);
     }
-    if (value->x > inst->max_value.x) {
-        inst->max_value.x = value->x;
-        (void) _anjay_notify_changed_unlocked(anjay, oid, iid, RID_MAX_X_VALUE);
+    if (inst->meta.z_axis_present) {
+        update_axis_value(anjay, oid, iid, RID_Z_VALUE, deadband,
+                          &inst->curr_value.z, &inst->notified_value.z,
+                          value->z);
     }
 }
 
-static void update_y_min_max(anjay_unlocked_t *anjay,
-                             anjay_oid_t oid,
-                             anjay_iid_t iid,
-                             instance_t *inst,
-                             const sensor_value_t *value) {
-    if (value->y < inst->min_value.y) {
-        inst->min_value.y = value->y;
-        (void) _anjay_notify_changed_unlocked(anjay, oid, iid, RID_MIN_Y_VALUE);
-    }
-    if (value->y > inst->max_value.y) {
-        inst->max_value.y = value->y;
-        (void) _anjay_notify_changed_unlocked(anjay, oid, iid, RID_MAX_Y_VALUE);
+static void update_axis_min_max(anjay_unlocked_t *anjay,
+                                anjay_oid_t oid,
+                                anjay_iid_t iid,
+                                anjay_rid_t min_rid,
+                                anjay_rid_t max_rid,
+                                double *min_value,
+                                double *max_value,
+                                double new_min,
+                                double new_max) {
+    if (new_min < *min_value) {
+        *min_value = new_min;
+        (void) _anjay_notify_changed_unlocked(anjay, oid, iid, min_rid);
+    }
+    if (new_max > *max_value) {
+        *max_value = new_max;
+        (void) _anjay_notify_changed_unlocked(anjay, oid, iid, max_rid);
     }
 }
 
-static void update_z_min_max(anjay_unlocked_t *anjay,
-                             anjay_oid_t oid,
-                             anjay_iid_t iid,
-                             instance_t *inst,
-                             const sensor_value_t *value) {
-    if (value->z < inst->min_value.z) {
-        inst->min_value.z = value->z;
-        (void) _anjay_notify_changed_unlocked(anjay, oid, iid, RID_MIN_Z_VALUE);
+static void update_min_max(anjay_unlocked_t *anjay,
+                           anjay_oid_t oid,
+                           anjay_iid_t iid,
+                           instance_t *inst,
+                           const sensor_value_t *new_min,
+                           const sensor_value_t *new_max) {
+    if (!inst->meta.min_max_measured_value_present) {
+        return;
+    }
+    update_axis_min_max(anjay, oid, iid, RID_MIN_X_VALUE, RID_MAX_X_VALUE,
+                        &inst->min_value.x, &inst->max_value.x, new_min->x,
+                        new_max->x);
+    if (inst->meta.y_axis_present) {
+        update_axis_min_max(anjay, oid, iid, RID_MIN_Y_VALUE, RID_MAX_Y_VALUE,
+                            &inst->min_value.y, &inst->max_value.y,
+                            new_min->y, new_max->y);
     }
-    if (value->z > inst->max_value.z) {
-        inst->max_value.z = value->z;
-        (void) _anjay_notify_changed_unlocked(anjay, oid, iid, RID_MAX_Z_VALUE);
+    if (inst->meta.z_axis_present) {
+        update_axis_min_max(anjay, oid, iid, RID_MIN_Z_VALUE, RID_MAX_Z_VALUE,
+                            &inst->min_value.z, &inst->max_value.z,
+                            new_min->z, new_max->z);
     }
 }
 
-static int sensor_value_update_unlocked(anjay_unlocked_t *anjay,
-                                        anjay_oid_t oid,
-                                        anjay_iid_t iid,
-                                        const sensor_value_t *value) {
-    object_t *obj = obj_from_oid(anjay, oid);
-    if (!obj) {
-        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
-        return -1;
-    }
-
+static instance_t *
+get_instance(object_t *obj, anjay_oid_t oid, anjay_iid_t iid) {
     instance_t *inst;
-    if (iid > obj->instance_count
+    if (iid >= obj->instance_count
             || !(inst = &obj->instances[iid])->initialized) {
         log_invalid_parameters(_("Object") " %d" _(" has no instance") " %d",
                                oid, iid);
+        return NULL;
+    }
+    return inst;
+}
+
+static int instance_value_update(anjay_unlocked_t *anjay,
+                                 object_t *obj,
+                                 anjay_iid_t iid,
+                                 const sensor_value_t *value) {
+    const anjay_oid_t oid = obj->def.oid;
+    instance_t *inst = get_instance(obj, oid, iid);
+    if (!inst) {
         return -1;
     }
 
@@ -640,19 +667,23 @@ static int sensor_value_update_unlocked(anjay_unlocked_t *anjay,
     }
 
     update_curr_value(anjay, oid, iid, inst, value);
-    if (inst->meta.min_max_measured_value_present) {
-        update_x_min_max(anjay, oid, iid, inst, value);
-        if (inst->meta.y_axis_present) {
-            update_y_min_max(anjay, oid, iid, inst, value);
-        }
-        if (inst->meta.z_axis_present) {
-            update_z_min_max(anjay, oid, iid, inst, value);
-        }
-    }
+    update_min_max(anjay, oid, iid, inst, value, value);
 
     return 0;
 }
 
+static int sensor_value_update_unlocked(anjay_unlocked_t *anjay,
+                                        anjay_oid_t oid,
+                                        anjay_iid_t iid,
+                                        const sensor_value_t *value) {
+    object_t *obj = obj_from_oid(anjay, oid);
+    if (!obj) {
+        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
+        return -1;
+    }
+    return instance_value_update(anjay, obj, iid, value);
+}
+
 int anjay_ipso_v2_3d_sensor_value_update(anjay_t *anjay_locked,
                                          anjay_oid_t oid,
                                          anjay_iid_t iid,
@@ -668,4 +699,125 @@ int anjay_ipso_v2_3d_sensor_value_update(anjay_t *anjay_locked,
     return res;
 }
 
+int anjay_ipso_v2_3d_sensor_values_update(
+        anjay_t *anjay_locked,
+        anjay_oid_t oid,
+        const anjay_ipso_v2_3d_sensor_value_entry_t *entries,
+        size_t entries_count) {
+    assert(anjay_locked);
+    assert(entries || !entries_count);
+
+    int res = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    object_t *obj = obj_from_oid(anjay, oid);
+    if (!obj) {
+        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
+    } else {
+        res = 0;
+        for (size_t i = 0; i < entries_count; ++i) {
+            if (instance_value_update(anjay, obj, entries[i].iid,
+                                      &entries[i].value)) {
+                res = -1;
+            }
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+
+    return res;
+}
+
+/**
+ * Computes per-axis minimum and maximum, and the maximum squared magnitude of
+ * a batch of samples. Axes that are not present are treated as 0, so unused
+ * fields of the samples do not need to be initialized.
+ *
+ * The loop body is kept free of data-dependent branches, so that compilers can
+ * vectorize it. Validity of the samples is checked only once after the loop:
+ * (v - v) is 0 for finite values and NaN otherwise.
+ */
+static bool samples_min_max(const sensor_meta_t *meta,
+                            const sensor_value_t *samples,
+                            size_t samples_count,
+                            sensor_value_t *out_min,
+                            sensor_value_t *out_max,
+                            double *out_max_magnitude_sq) {
+    const bool y_present = meta->y_axis_present;
+    const bool z_present = meta->z_axis_present;
+    sensor_value_t min = { INFINITY, INFINITY, INFINITY };
+    sensor_value_t max = { -INFINITY, -INFINITY, -INFINITY };
+    double max_magnitude_sq = 0.0;
+    double invalid = 0.0;
+
+    for (size_t i = 0; i < samples_count; ++i) {
+        const double x = samples[i].x;
+        const double y = y_present ? samples[i].y : 0.0;
+        const double z = z_present ? samples[i].z : 0.0;
+        const double magnitude_sq = x * x + y * y + z * z;
+
+        invalid += (x - x) + (y - y) + (z - z);
+        min.x = x < min.x ? x : min.x;
+        min.y = y < min.y ? y : min.y;
+        min.z = z < min.z ? z : min.z;
+        max.x = x > max.x ? x : max.x;
+        max.y = y > max.y ? y : max.y;
+        max.z = z > max.z ? z : max.z;
+        max_magnitude_sq = magnitude_sq > max_magnitude_sq ? magnitude_sq
+                                                           : max_magnitude_sq;
+    }
+
+    if (invalid != 0.0) {
+        return false;
+    }
+    *out_min = min;
+    *out_max = max;
+    *out_max_magnitude_sq = max_magnitude_sq;
+    return true;
+}
+
+int anjay_ipso_v2_3d_sensor_samples_update(anjay_t *anjay_locked,
+                                           anjay_oid_t oid,
+                                           anjay_iid_t iid,
+                                           const sensor_value_t *samples,
+                                           size_t samples_count,
+                                           double *out_max_magnitude) {
+    assert(anjay_locked);
+    assert(samples || !samples_count);
+
+    if (!samples_count) {
+        log_invalid_parameters(_("Empty batch of samples"));
+        return -1;
+    }
+
+    int res = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    object_t *obj = obj_from_oid(anjay, oid);
+    instance_t *inst = NULL;
+    sensor_value_t min, max;
+    double max_magnitude_sq;
+    if (!obj) {
+        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
+    } else if ((inst = get_instance(obj, oid, iid))) {
+        if (!samples_min_max(&inst->meta, samples, samples_count, &min, &max,
+                             &max_magnitude_sq)) {
+            log_invalid_parameters(_("Update of") " /%d/%d" _(" failed"), oid,
+                                   iid);
+        } else {
+            update_curr_value(anjay, oid, iid, inst,
+                              &samples[samples_count - 1]);
+            update_min_max(anjay, oid, iid, inst, &min, &max);
+            if (out_max_magnitude) {
+                *out_max_magnitude = sqrt(max_magnitude_sq);
+            }
+            res = 0;
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+
+    return res;
+}
+
+#    ifdef ANJAY_TEST
+#        include "tests/modules/ipso_v2/3d_sensor.c"
+#    endif // ANJAY_TEST
+
 #endif // ANJAY_WITH_MODULE_IPSO_OBJECTS_V2
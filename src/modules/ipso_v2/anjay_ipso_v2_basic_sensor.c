@@ -13,17 +13,21 @@
 #    include <assert.h>
 #    include <math.h>
 #    include <stdbool.h>
+#    include <stdint.h>
 
 #    include <anjay/anjay.h>
 #    include <anjay/dm.h>
 #    include <anjay/ipso_objects_v2.h>
+#    include <anjay/lwm2m_send.h>
 
 #    include <anjay_modules/anjay_dm_utils.h>
+#    include <anjay_modules/anjay_running_stats.h>
 #    include <anjay_modules/anjay_utils_core.h>
 
 #    include <avsystem/commons/avs_defs.h>
 #    include <avsystem/commons/avs_log.h>
 #    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_time.h>
 
 VISIBILITY_SOURCE_BEGIN
 
@@ -78,12 +82,25 @@ VISIBILITY_SOURCE_BEGIN
 
 typedef anjay_ipso_v2_basic_sensor_meta_t sensor_meta_t;
 
+typedef struct {
+    avs_time_real_t timestamp;
+    double value;
+} sample_t;
+
 typedef struct {
     bool initialized;
     sensor_meta_t meta;
     double curr_value;
+    // last value reported with anjay_notify_changed(), see notify_deadband
+    double notified_value;
     double min_value;
     double max_value;
+    anjay_running_stats_t aggregates;
+
+    // ring buffer of sensor values, see object_t::history_capacity
+    sample_t *history;
+    size_t history_start;
+    size_t history_count;
 } instance_t;
 
 typedef struct {
@@ -92,6 +109,9 @@ typedef struct {
     const anjay_unlocked_dm_object_def_t *def_ptr;
 
     size_t instance_count;
+    // number of samples stored per instance, 0 if history is disabled; the
+    // storage is allocated right after the instances array
+    size_t history_capacity;
     instance_t instances[];
 } object_t;
 
@@ -245,6 +265,7 @@ static int resource_execute(anjay_unlocked_t *anjay,
             (void) _anjay_notify_changed_unlocked(anjay, obj->def.oid, iid,
                                                   RID_MAX_MEASURED_VALUE);
         }
+        _anjay_running_stats_reset(&inst->aggregates);
 
         return 0;
 
@@ -271,14 +292,25 @@ static object_t *obj_from_oid(anjay_unlocked_t *anjay, anjay_oid_t oid) {
 static int sensor_install_unlocked(anjay_unlocked_t *anjay,
                                    anjay_oid_t oid,
                                    const char *version,
-                                   size_t instance_count) {
+                                   size_t instance_count,
+                                   size_t history_capacity) {
     if (instance_count == 0 || instance_count >= ANJAY_ID_INVALID) {
         log_invalid_parameters(_("Instance count of out range"));
         return -1;
     }
+    if (history_capacity
+            > (SIZE_MAX - sizeof(object_t)
+               - instance_count * sizeof(instance_t))
+                          / instance_count / sizeof(sample_t)) {
+        log_invalid_parameters(_("History capacity out of range"));
+        return -1;
+    }
     AVS_LIST(anjay_dm_installed_object_t) entry;
+    // instance_t contains doubles, so the samples array placed right after the
+    // instances one is properly aligned
     object_t *obj = (object_t *) AVS_LIST_NEW_BUFFER(
-            sizeof(object_t) + instance_count * sizeof(instance_t));
+            sizeof(object_t) + instance_count * sizeof(instance_t)
+            + instance_count * history_capacity * sizeof(sample_t));
     if (!obj) {
         _anjay_log_oom();
         return -1;
@@ -297,6 +329,14 @@ static int sensor_install_unlocked(anjay_unlocked_t *anjay,
 
     obj->def_ptr = &obj->def;
     obj->instance_count = instance_count;
+    obj->history_capacity = history_capacity;
+    if (history_capacity) {
+        sample_t *history_storage =
+                (sample_t *) (void *) &obj->instances[instance_count];
+        for (size_t i = 0; i < instance_count; ++i) {
+            obj->instances[i].history = &history_storage[i * history_capacity];
+        }
+    }
 
     _anjay_dm_installed_object_init_unlocked(&obj->installed_obj,
                                              &obj->def_ptr);
@@ -317,7 +357,23 @@ int anjay_ipso_v2_basic_sensor_install(anjay_t *anjay_locked,
 
     int res = -1;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
-    res = sensor_install_unlocked(anjay, oid, version, instance_count);
+    res = sensor_install_unlocked(anjay, oid, version, instance_count, 0);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+
+    return res;
+}
+
+int anjay_ipso_v2_basic_sensor_install_with_history(anjay_t *anjay_locked,
+                                                    anjay_oid_t oid,
+                                                    const char *version,
+                                                    size_t instance_count,
+                                                    size_t history_capacity) {
+    assert(anjay_locked);
+
+    int res = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    res = sensor_install_unlocked(anjay, oid, version, instance_count,
+                                  history_capacity);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 
     return res;
@@ -352,6 +408,11 @@ static int sensor_instance_add_unlocked(anjay_unlocked_t *anjay,
         return -1;
     }
 
+    if (!(meta->notify_deadband >= 0.0) || !isfinite(meta->notify_deadband)) {
+        log_invalid_parameters(_("Notify deadband invalid"));
+        return -1;
+    }
+
     if (!isfinite(initial_value)) {
         log_invalid_parameters(_("Initial value invalid"));
         return -1;
@@ -366,8 +427,12 @@ static int sensor_instance_add_unlocked(anjay_unlocked_t *anjay,
     inst->initialized = true;
     inst->meta = *meta;
     inst->curr_value = initial_value;
+    inst->notified_value = initial_value;
     inst->min_value = initial_value;
     inst->max_value = initial_value;
+    _anjay_running_stats_reset(&inst->aggregates);
+    inst->history_start = 0;
+    inst->history_count = 0;
 
     _anjay_notify_instances_changed_unlocked(anjay, oid);
     return 0;
@@ -424,18 +489,31 @@ int anjay_ipso_v2_basic_sensor_instance_remove(anjay_t *anjay_locked,
     return res;
 }
 
-static int sensor_value_update_unlocked(anjay_unlocked_t *anjay,
-                                        anjay_oid_t oid,
-                                        anjay_iid_t iid,
-                                        double value) {
-    object_t *obj = obj_from_oid(anjay, oid);
-    if (!obj) {
-        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
-        return -1;
+static void history_append(const object_t *obj,
+                           instance_t *inst,
+                           double value) {
+    if (!obj->history_capacity) {
+        return;
     }
+    size_t index = (inst->history_start + inst->history_count)
+                   % obj->history_capacity;
+    if (inst->history_count < obj->history_capacity) {
+        ++inst->history_count;
+    } else {
+        // overwrite the oldest sample
+        inst->history_start = (inst->history_start + 1) % obj->history_capacity;
+    }
+    inst->history[index].timestamp = avs_time_real_now();
+    inst->history[index].value = value;
+}
 
+static int instance_value_update(anjay_unlocked_t *anjay,
+                                 object_t *obj,
+                                 anjay_iid_t iid,
+                                 double value) {
+    const anjay_oid_t oid = obj->def.oid;
     instance_t *inst;
-    if (iid > obj->instance_count
+    if (iid >= obj->instance_count
             || !(inst = &obj->instances[iid])->initialized) {
         log_invalid_parameters(_("Object") " %d" _(" has no instance") " %d",
                                oid, iid);
@@ -447,8 +525,14 @@ static int sensor_value_update_unlocked(anjay_unlocked_t *anjay,
         return -1;
     }
 
-    if (value != inst->curr_value) {
-        inst->curr_value = value;
+    _anjay_running_stats_add(&inst->aggregates, value);
+    history_append(obj, inst, value);
+
+    inst->curr_value = value;
+    if (value != inst->notified_value
+            && !(fabs(value - inst->notified_value)
+                 < inst->meta.notify_deadband)) {
+        inst->notified_value = value;
         (void) _anjay_notify_changed_unlocked(anjay, oid, iid,
                                               RID_SENSOR_VALUE);
     }
@@ -468,6 +552,18 @@ static int sensor_value_update_unlocked(anjay_unlocked_t *anjay,
     return 0;
 }
 
+static int sensor_value_update_unlocked(anjay_unlocked_t *anjay,
+                                        anjay_oid_t oid,
+                                        anjay_iid_t iid,
+                                        double value) {
+    object_t *obj = obj_from_oid(anjay, oid);
+    if (!obj) {
+        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
+        return -1;
+    }
+    return instance_value_update(anjay, obj, iid, value);
+}
+
 int anjay_ipso_v2_basic_sensor_value_update(anjay_t *anjay_locked,
                                             anjay_oid_t oid,
                                             anjay_iid_t iid,
@@ -482,4 +578,200 @@ int anjay_ipso_v2_basic_sensor_value_update(anjay_t *anjay_locked,
     return res;
 }
 
+int anjay_ipso_v2_basic_sensor_values_update(
+        anjay_t *anjay_locked,
+        anjay_oid_t oid,
+        const anjay_ipso_v2_basic_sensor_value_entry_t *entries,
+        size_t entries_count) {
+    assert(anjay_locked);
+    assert(entries || !entries_count);
+
+    int res = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    object_t *obj = obj_from_oid(anjay, oid);
+    if (!obj) {
+        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
+    } else {
+        res = 0;
+        for (size_t i = 0; i < entries_count; ++i) {
+            if (instance_value_update(anjay, obj, entries[i].iid,
+                                      entries[i].value)) {
+                res = -1;
+            }
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+
+    return res;
+}
+
+static instance_t *initialized_instance(anjay_unlocked_t *anjay,
+                                        anjay_oid_t oid,
+                                        anjay_iid_t iid) {
+    object_t *obj = obj_from_oid(anjay, oid);
+    if (!obj) {
+        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
+        return NULL;
+    }
+    if (iid >= obj->instance_count || !obj->instances[iid].initialized) {
+        log_invalid_parameters(_("Object") " %d" _(" has no instance") " %d",
+                               oid, iid);
+        return NULL;
+    }
+    return &obj->instances[iid];
+}
+
+int anjay_ipso_v2_basic_sensor_aggregates_get(
+        anjay_t *anjay_locked,
+        anjay_oid_t oid,
+        anjay_iid_t iid,
+        anjay_ipso_v2_basic_sensor_aggregates_t *out_aggregates) {
+    assert(anjay_locked);
+    assert(out_aggregates);
+
+    int res = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    const instance_t *inst = initialized_instance(anjay, oid, iid);
+    if (inst) {
+        out_aggregates->count = inst->aggregates.count;
+        out_aggregates->mean = _anjay_running_stats_mean(&inst->aggregates);
+        out_aggregates->variance =
+                _anjay_running_stats_variance(&inst->aggregates);
+        res = 0;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+
+    return res;
+}
+
+int anjay_ipso_v2_basic_sensor_aggregates_reset(anjay_t *anjay_locked,
+                                                anjay_oid_t oid,
+                                                anjay_iid_t iid) {
+    assert(anjay_locked);
+
+    int res = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    instance_t *inst = initialized_instance(anjay, oid, iid);
+    if (inst) {
+        _anjay_running_stats_reset(&inst->aggregates);
+        res = 0;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+
+    return res;
+}
+
+#    ifdef ANJAY_WITH_SEND
+static int history_add_to_batch(anjay_send_batch_builder_t *builder,
+                                const object_t *obj,
+                                anjay_iid_t iid) {
+    const instance_t *inst = &obj->instances[iid];
+    if (!inst->history_count) {
+        return 0;
+    }
+    if (anjay_send_batch_series_begin(builder, obj->def.oid, iid,
+                                      RID_SENSOR_VALUE, ANJAY_ID_INVALID)) {
+        return -1;
+    }
+    for (size_t i = 0; i < inst->history_count; ++i) {
+        const sample_t *sample =
+                &inst->history[(inst->history_start + i)
+                               % obj->history_capacity];
+        if (anjay_send_batch_series_add_double(builder, sample->timestamp,
+                                               sample->value)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int sensor_history_send_unlocked(anjay_unlocked_t *anjay,
+                                        anjay_oid_t oid,
+                                        anjay_iid_t iid,
+                                        anjay_ssid_t ssid) {
+    object_t *obj = obj_from_oid(anjay, oid);
+    if (!obj) {
+        log_invalid_parameters(_("Object") " %d" _(" not installed"), oid);
+        return -1;
+    }
+    if (iid != ANJAY_ID_INVALID
+            && (iid >= obj->instance_count
+                || !obj->instances[iid].initialized)) {
+        log_invalid_parameters(_("Object") " %d" _(" has no instance") " %d",
+                               oid, iid);
+        return -1;
+    }
+
+    const anjay_iid_t first_iid = (iid == ANJAY_ID_INVALID) ? 0 : iid;
+    const anjay_iid_t end_iid = (iid == ANJAY_ID_INVALID)
+                                        ? (anjay_iid_t) obj->instance_count
+                                        : (anjay_iid_t) (iid + 1);
+    bool history_present = false;
+    for (anjay_iid_t i = first_iid; i < end_iid; ++i) {
+        if (obj->instances[i].initialized && obj->instances[i].history_count) {
+            history_present = true;
+            break;
+        }
+    }
+    if (!history_present) {
+        return 0;
+    }
+
+    anjay_send_batch_builder_t *builder = anjay_send_batch_builder_new();
+    if (!builder) {
+        _anjay_log_oom();
+        return -1;
+    }
+    for (anjay_iid_t i = first_iid; i < end_iid; ++i) {
+        if (obj->instances[i].initialized
+                && history_add_to_batch(builder, obj, i)) {
+            _anjay_log(ipso, ERROR, _("failed to add history to batch"));
+            anjay_send_batch_builder_cleanup(&builder);
+            return -1;
+        }
+    }
+    anjay_send_batch_t *batch = anjay_send_batch_builder_compile(&builder);
+    if (!batch) {
+        anjay_send_batch_builder_cleanup(&builder);
+        _anjay_log_oom();
+        return -1;
+    }
+
+    int result = -1;
+    anjay_send_result_t send_result =
+            _anjay_send_deferrable_unlocked(anjay, ssid, batch, NULL, NULL);
+    if (send_result == ANJAY_SEND_OK) {
+        for (anjay_iid_t i = first_iid; i < end_iid; ++i) {
+            obj->instances[i].history_start = 0;
+            obj->instances[i].history_count = 0;
+        }
+        result = 0;
+    } else {
+        _anjay_log(ipso, ERROR,
+                   _("could not send history of /") "%d" _(": ") "%d", oid,
+                   (int) send_result);
+    }
+    anjay_send_batch_release(&batch);
+    return result;
+}
+
+int anjay_ipso_v2_basic_sensor_history_send(anjay_t *anjay_locked,
+                                            anjay_oid_t oid,
+                                            anjay_iid_t iid,
+                                            anjay_ssid_t ssid) {
+    assert(anjay_locked);
+
+    int res = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    res = sensor_history_send_unlocked(anjay, oid, iid, ssid);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+
+    return res;
+}
+#    endif // ANJAY_WITH_SEND
+
+#    ifdef ANJAY_TEST
+#        include "tests/modules/ipso_v2/basic_sensor.c"
+#    endif // ANJAY_TEST
+
 #endif // ANJAY_WITH_MODULE_IPSO_OBJECTS_V2
@@ -0,0 +1,617 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_MODULE_LWM2M_GATEWAY
+
+#    include <assert.h>
+#    include <inttypes.h>
+#    include <stdio.h>
+#    include <string.h>
+
+#    include <anjay/lwm2m_gateway.h>
+
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream.h>
+#    include <avsystem/commons/avs_stream_membuf.h>
+#    include <avsystem/commons/avs_utils.h>
+
+#    include <anjay_modules/anjay_dm_utils.h>
+#    include <anjay_modules/anjay_notify.h>
+#    include <anjay_modules/anjay_utils_core.h>
+#    include <anjay_modules/dm/anjay_modules.h>
+
+VISIBILITY_SOURCE_BEGIN
+
+#    define gw_log(level, ...) _anjay_log(lwm2m_gateway, level, __VA_ARGS__)
+
+#    define RID_DEVICE_ID 0
+#    define RID_PREFIX 1
+#    define RID_IOT_DEVICE_OBJECTS 3
+
+#    define PREFIX_BASE "dev"
+
+typedef struct {
+    anjay_iid_t iid;
+    char prefix[sizeof(PREFIX_BASE "65535")];
+    char *device_id;
+    /**
+     * Data model of the End Device, sorted by OID. Elements are only ever
+     * allocated and freed by this module, so their addresses remain valid
+     * while they are referenced by a running transaction.
+     */
+    AVS_LIST(anjay_dm_installed_object_t) objects;
+} gateway_device_t;
+
+typedef struct {
+    anjay_dm_installed_object_t def_ptr;
+    const anjay_unlocked_dm_object_def_t *def;
+
+    /**
+     * End Devices, sorted by IID. The prefix of every End Device is derived
+     * from its IID, which allows a request to be routed to the addressed data
+     * model with a single binary search, regardless of the number of End
+     * Devices.
+     */
+    gateway_device_t *devices;
+    size_t devices_count;
+    size_t devices_capacity;
+} gateway_t;
+
+static inline gateway_t *
+get_gateway(const anjay_dm_installed_object_t obj_ptr) {
+    return AVS_CONTAINER_OF(_anjay_dm_installed_object_get_unlocked(&obj_ptr),
+                            gateway_t, def);
+}
+
+/**
+ * Returns the index of the End Device with the given @p iid, or the index at
+ * which it would be inserted if there is no such End Device.
+ */
+static size_t find_device_index(const gateway_t *gw, anjay_iid_t iid) {
+    size_t lower = 0;
+    size_t upper = gw->devices_count;
+    while (lower < upper) {
+        size_t middle = lower + (upper - lower) / 2;
+        if (gw->devices[middle].iid < iid) {
+            lower = middle + 1;
+        } else {
+            upper = middle;
+        }
+    }
+    return lower;
+}
+
+static gateway_device_t *find_device(gateway_t *gw, anjay_iid_t iid) {
+    size_t index = find_device_index(gw, iid);
+    if (index < gw->devices_count && gw->devices[index].iid == iid) {
+        return &gw->devices[index];
+    }
+    return NULL;
+}
+
+static int parse_prefix_iid(const char *prefix, anjay_iid_t *out_iid) {
+    if (strncmp(prefix, PREFIX_BASE, sizeof(PREFIX_BASE) - 1)) {
+        return -1;
+    }
+    const char *digits = prefix + sizeof(PREFIX_BASE) - 1;
+    if (!*digits) {
+        return -1;
+    }
+    uint32_t iid = 0;
+    for (; *digits; ++digits) {
+        if (*digits < '0' || *digits > '9') {
+            return -1;
+        }
+        iid = 10 * iid + (uint32_t) (*digits - '0');
+        if (iid >= ANJAY_ID_INVALID) {
+            return -1;
+        }
+    }
+    *out_iid = (anjay_iid_t) iid;
+    return 0;
+}
+
+static gateway_device_t *find_device_by_prefix(gateway_t *gw,
+                                               const char *prefix) {
+    anjay_iid_t iid;
+    if (parse_prefix_iid(prefix, &iid)) {
+        return NULL;
+    }
+    gateway_device_t *device = find_device(gw, iid);
+    // reject non-canonical forms, e.g. "dev01"
+    if (!device || strcmp(device->prefix, prefix)) {
+        return NULL;
+    }
+    return device;
+}
+
+static AVS_LIST(anjay_dm_installed_object_t) *
+find_device_object_ptr(gateway_device_t *device, anjay_oid_t oid) {
+    AVS_LIST(anjay_dm_installed_object_t) *it;
+    AVS_LIST_FOREACH_PTR(it, &device->objects) {
+        if (_anjay_dm_installed_object_oid(*it) >= oid) {
+            break;
+        }
+    }
+    return it;
+}
+
+static const anjay_dm_installed_object_t *
+gateway_resolve_prefix(anjay_unlocked_t *anjay,
+                       void *gw_,
+                       const char *prefix,
+                       anjay_oid_t oid,
+                       anjay_iid_t *out_gateway_iid) {
+    (void) anjay;
+    gateway_device_t *device = find_device_by_prefix((gateway_t *) gw_, prefix);
+    if (!device) {
+        return NULL;
+    }
+    AVS_LIST(anjay_dm_installed_object_t) *obj_ptr =
+            find_device_object_ptr(device, oid);
+    if (!*obj_ptr || _anjay_dm_installed_object_oid(*obj_ptr) != oid) {
+        return NULL;
+    }
+    *out_gateway_iid = device->iid;
+    return *obj_ptr;
+}
+
+static int
+gateway_list_instances(anjay_unlocked_t *anjay,
+                       const anjay_dm_installed_object_t obj_ptr,
+                       anjay_unlocked_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    gateway_t *gw = get_gateway(obj_ptr);
+    for (size_t i = 0; i < gw->devices_count; ++i) {
+        _anjay_dm_emit_unlocked(ctx, gw->devices[i].iid);
+    }
+    return 0;
+}
+
+static int
+gateway_list_resources(anjay_unlocked_t *anjay,
+                       const anjay_dm_installed_object_t obj_ptr,
+                       anjay_iid_t iid,
+                       anjay_unlocked_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+
+    _anjay_dm_emit_res_unlocked(ctx, RID_DEVICE_ID, ANJAY_DM_RES_R,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_PREFIX, ANJAY_DM_RES_R,
+                                ANJAY_DM_RES_PRESENT);
+    _anjay_dm_emit_res_unlocked(ctx, RID_IOT_DEVICE_OBJECTS, ANJAY_DM_RES_R,
+                                ANJAY_DM_RES_PRESENT);
+    return 0;
+}
+
+typedef struct {
+    avs_stream_t *stream;
+    const char *prefix;
+    bool first;
+    bool instance_written;
+} device_objects_args_t;
+
+static int device_objects_instance(anjay_unlocked_t *anjay,
+                                   const anjay_dm_installed_object_t *obj,
+                                   anjay_iid_t iid,
+                                   void *args_) {
+    (void) anjay;
+    device_objects_args_t *args = (device_objects_args_t *) args_;
+    avs_error_t err = avs_stream_write_f(args->stream, "%s</%s/%u/%u>",
+                                         args->first ? "" : ",", args->prefix,
+                                         _anjay_dm_installed_object_oid(obj),
+                                         iid);
+    args->first = false;
+    args->instance_written = true;
+    return avs_is_ok(err) ? 0 : -1;
+}
+
+/**
+ * Writes the list of Objects and Object Instances of @p device in the same
+ * CoRE Link format as used in the LwM2M 1.1 Register payload.
+ */
+static int write_device_objects(anjay_unlocked_t *anjay,
+                                gateway_device_t *device,
+                                avs_stream_t *stream) {
+    device_objects_args_t args = {
+        .stream = stream,
+        .prefix = device->prefix,
+        .first = true
+    };
+    AVS_LIST(anjay_dm_installed_object_t) obj;
+    AVS_LIST_FOREACH(obj, device->objects) {
+        anjay_oid_t oid = _anjay_dm_installed_object_oid(obj);
+        const char *version = _anjay_dm_installed_object_version(obj);
+        bool obj_written = false;
+        if (version) {
+            if (avs_is_err(avs_stream_write_f(stream, "%s</%s/%u>;ver=%s",
+                                              args.first ? "" : ",",
+                                              device->prefix, oid, version))) {
+                return -1;
+            }
+            args.first = false;
+            obj_written = true;
+        }
+        args.instance_written = false;
+        int result = _anjay_dm_foreach_instance(anjay, obj,
+                                                device_objects_instance, &args);
+        if (result) {
+            return result;
+        }
+        if (!obj_written && !args.instance_written) {
+            if (avs_is_err(avs_stream_write_f(stream, "%s</%s/%u>",
+                                              args.first ? "" : ",",
+                                              device->prefix, oid))) {
+                return -1;
+            }
+            args.first = false;
+        }
+    }
+    return 0;
+}
+
+static int read_device_objects(anjay_unlocked_t *anjay,
+                               gateway_device_t *device,
+                               anjay_unlocked_output_ctx_t *ctx) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    if (!stream) {
+        _anjay_log_oom();
+        return ANJAY_ERR_INTERNAL;
+    }
+    void *links = NULL;
+    int result = write_device_objects(anjay, device, stream);
+    if (!result
+            && (avs_is_err(avs_stream_write(stream, "", 1))
+                || avs_is_err(avs_stream_membuf_take_ownership(stream, &links,
+                                                               NULL)))) {
+        result = ANJAY_ERR_INTERNAL;
+    }
+    avs_stream_cleanup(&stream);
+    if (!result) {
+        result = _anjay_ret_string_unlocked(ctx, (const char *) links);
+    }
+    avs_free(links);
+    return result;
+}
+
+static int gateway_resource_read(anjay_unlocked_t *anjay,
+                                 const anjay_dm_installed_object_t obj_ptr,
+                                 anjay_iid_t iid,
+                                 anjay_rid_t rid,
+                                 anjay_riid_t riid,
+                                 anjay_unlocked_output_ctx_t *ctx) {
+    (void) riid;
+    assert(riid == ANJAY_ID_INVALID);
+    gateway_device_t *device = find_device(get_gateway(obj_ptr), iid);
+    assert(device);
+
+    switch (rid) {
+    case RID_DEVICE_ID:
+        return _anjay_ret_string_unlocked(ctx, device->device_id);
+    case RID_PREFIX:
+        return _anjay_ret_string_unlocked(ctx, device->prefix);
+    case RID_IOT_DEVICE_OBJECTS:
+        return read_device_objects(anjay, device, ctx);
+    default:
+        AVS_UNREACHABLE("Read handler called on unknown resource");
+        return ANJAY_ERR_NOT_FOUND;
+    }
+}
+
+static const anjay_unlocked_dm_object_def_t OBJ_DEF = {
+    .oid = ANJAY_DM_OID_LWM2M_GATEWAY,
+    .version = "2.0",
+    .handlers = {
+        .list_instances = gateway_list_instances,
+        .list_resources = gateway_list_resources,
+        .resource_read = gateway_resource_read
+    }
+};
+
+static void notify_gateway_changed(anjay_unlocked_t *anjay,
+                                   anjay_iid_t device_iid) {
+    int result =
+            device_iid == ANJAY_ID_INVALID
+                    ? _anjay_notify_instances_changed_unlocked(
+                              anjay, ANJAY_DM_OID_LWM2M_GATEWAY)
+                    : _anjay_notify_changed_unlocked(
+                              anjay, ANJAY_DM_OID_LWM2M_GATEWAY, device_iid,
+                              RID_IOT_DEVICE_OBJECTS);
+    if (result) {
+        gw_log(WARNING, _("could not notify about LwM2M Gateway changes"));
+    }
+}
+
+static void unregister_device_object(anjay_unlocked_t *anjay,
+                                     gateway_device_t *device,
+                                     AVS_LIST(anjay_dm_installed_object_t) *
+                                             obj_ptr) {
+    AVS_LIST(anjay_dm_installed_object_t) detached = AVS_LIST_DETACH(obj_ptr);
+    if (anjay) {
+        _anjay_dm_transaction_remove_object(anjay, detached);
+    }
+    gw_log(INFO, _("unregistered object /") "%s" _("/") "%u", device->prefix,
+           _anjay_dm_installed_object_oid(detached));
+    AVS_LIST_DELETE(&detached);
+}
+
+static void cleanup_device(anjay_unlocked_t *anjay, gateway_device_t *device) {
+    while (device->objects) {
+        unregister_device_object(anjay, device, &device->objects);
+    }
+    avs_free(device->device_id);
+}
+
+static void gateway_delete(void *gw_) {
+    gateway_t *gw = (gateway_t *) gw_;
+    // the transaction state is already gone at this point
+    for (size_t i = 0; i < gw->devices_count; ++i) {
+        cleanup_device(NULL, &gw->devices[i]);
+    }
+    avs_free(gw->devices);
+    // NOTE: gw itself will be freed when cleaning the objects list
+}
+
+static gateway_t *get_installed_gateway(anjay_unlocked_t *anjay) {
+    gateway_t *gw = (gateway_t *) _anjay_dm_module_get_arg(anjay,
+                                                           gateway_delete);
+    if (!gw) {
+        gw_log(ERROR, _("LwM2M Gateway object not installed"));
+    }
+    return gw;
+}
+
+int anjay_lwm2m_gateway_install(anjay_t *anjay_locked) {
+    assert(anjay_locked);
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(gateway_t) gw = AVS_LIST_NEW_ELEMENT(gateway_t);
+    if (!gw) {
+        _anjay_log_oom();
+        goto finish;
+    }
+
+    gw->def = &OBJ_DEF;
+    _anjay_dm_installed_object_init_unlocked(&gw->def_ptr, &gw->def);
+    _ANJAY_ASSERT_INSTALLED_OBJECT_IS_FIRST_FIELD(gateway_t, def_ptr);
+
+    if (!_anjay_dm_module_install(anjay, gateway_delete, gw)) {
+        AVS_LIST(anjay_dm_installed_object_t) entry = &gw->def_ptr;
+        if (_anjay_register_object_unlocked(anjay, &entry)) {
+            int uninstall_result =
+                    _anjay_dm_module_uninstall(anjay, gateway_delete);
+            assert(!uninstall_result);
+            (void) uninstall_result;
+        } else {
+            _anjay_dm_set_prefix_resolver(anjay, gateway_resolve_prefix, gw);
+            result = 0;
+        }
+    }
+    if (result) {
+        AVS_LIST_CLEAR(&gw);
+    }
+finish:;
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+static int allocate_device_iid(gateway_t *gw, anjay_iid_t *out_iid) {
+    anjay_iid_t iid = 0;
+    // devices are sorted, so the first gap in IDs is the lowest free one
+    for (size_t i = 0; i < gw->devices_count && gw->devices[i].iid == iid;
+         ++i) {
+        if (iid == ANJAY_ID_INVALID - 1) {
+            return -1;
+        }
+        ++iid;
+    }
+    *out_iid = iid;
+    return 0;
+}
+
+static int register_device(anjay_unlocked_t *anjay,
+                           gateway_t *gw,
+                           const char *device_id,
+                           anjay_iid_t *inout_iid) {
+    if (*inout_iid == ANJAY_ID_INVALID) {
+        if (allocate_device_iid(gw, inout_iid)) {
+            gw_log(ERROR, _("no free End Device Instance IDs"));
+            return -1;
+        }
+    } else if (find_device(gw, *inout_iid)) {
+        gw_log(ERROR, _("End Device ") "%u" _(" already registered"),
+               *inout_iid);
+        return -1;
+    }
+
+    if (gw->devices_count >= gw->devices_capacity) {
+        size_t new_capacity = 2 * gw->devices_capacity;
+        if (!new_capacity) {
+            new_capacity = 8;
+        }
+        gateway_device_t *new_devices = (gateway_device_t *) avs_realloc(
+                gw->devices, new_capacity * sizeof(*new_devices));
+        if (!new_devices) {
+            _anjay_log_oom();
+            return -1;
+        }
+        gw->devices = new_devices;
+        gw->devices_capacity = new_capacity;
+    }
+
+    char *device_id_copy = avs_strdup(device_id);
+    if (!device_id_copy) {
+        _anjay_log_oom();
+        return -1;
+    }
+    size_t index = find_device_index(gw, *inout_iid);
+    memmove(&gw->devices[index + 1], &gw->devices[index],
+            (gw->devices_count - index) * sizeof(*gw->devices));
+    ++gw->devices_count;
+
+    gateway_device_t *device = &gw->devices[index];
+    memset(device, 0, sizeof(*device));
+    device->iid = *inout_iid;
+    device->device_id = device_id_copy;
+    avs_simple_snprintf(device->prefix, sizeof(device->prefix),
+                        PREFIX_BASE "%u", device->iid);
+
+    gw_log(INFO, _("registered End Device ") "%s" _(" as /") "%s",
+           device->device_id, device->prefix);
+    notify_gateway_changed(anjay, ANJAY_ID_INVALID);
+    return 0;
+}
+
+int anjay_lwm2m_gateway_register_device(anjay_t *anjay_locked,
+                                        const char *device_id,
+                                        anjay_iid_t *inout_iid) {
+    assert(anjay_locked);
+    assert(device_id);
+    assert(inout_iid);
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    gateway_t *gw = get_installed_gateway(anjay);
+    if (gw) {
+        result = register_device(anjay, gw, device_id, inout_iid);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+int anjay_lwm2m_gateway_deregister_device(anjay_t *anjay_locked,
+                                          anjay_iid_t device_iid) {
+    assert(anjay_locked);
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    gateway_t *gw = get_installed_gateway(anjay);
+    gateway_device_t *device;
+    if (!gw) {
+        // error already logged
+    } else if (!(device = find_device(gw, device_iid))) {
+        gw_log(ERROR, _("End Device ") "%u" _(" is not registered"),
+               device_iid);
+    } else {
+        cleanup_device(anjay, device);
+        size_t index = (size_t) (device - gw->devices);
+        --gw->devices_count;
+        memmove(&gw->devices[index], &gw->devices[index + 1],
+                (gw->devices_count - index) * sizeof(*gw->devices));
+        gw_log(INFO, _("deregistered End Device ") "%u", device_iid);
+        notify_gateway_changed(anjay, ANJAY_ID_INVALID);
+        result = 0;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+static int register_device_object(anjay_unlocked_t *anjay,
+                                  gateway_device_t *device,
+                                  const anjay_dm_object_def_t *const *def_ptr) {
+    AVS_LIST(anjay_dm_installed_object_t) *obj_ptr =
+            find_device_object_ptr(device, (*def_ptr)->oid);
+    if (*obj_ptr
+            && _anjay_dm_installed_object_oid(*obj_ptr) == (*def_ptr)->oid) {
+        gw_log(ERROR, _("object /") "%s" _("/") "%u" _(" already registered"),
+               device->prefix, (*def_ptr)->oid);
+        return -1;
+    }
+
+    AVS_LIST(anjay_dm_installed_object_t) new_elem =
+            AVS_LIST_NEW_ELEMENT(anjay_dm_installed_object_t);
+    if (!new_elem) {
+        _anjay_log_oom();
+        return -1;
+    }
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    new_elem->type = ANJAY_DM_OBJECT_USER_PROVIDED;
+    new_elem->impl.user_provided = def_ptr;
+#    else  // ANJAY_WITH_THREAD_SAFETY
+    *new_elem = def_ptr;
+#    endif // ANJAY_WITH_THREAD_SAFETY
+    AVS_LIST_INSERT(obj_ptr, new_elem);
+
+    gw_log(INFO, _("registered object /") "%s" _("/") "%u", device->prefix,
+           (*def_ptr)->oid);
+    notify_gateway_changed(anjay, device->iid);
+    return 0;
+}
+
+int anjay_lwm2m_gateway_register_object(
+        anjay_t *anjay_locked,
+        anjay_iid_t device_iid,
+        const anjay_dm_object_def_t *const *def_ptr) {
+    assert(anjay_locked);
+    if (!def_ptr || !*def_ptr || (*def_ptr)->oid == ANJAY_ID_INVALID) {
+        gw_log(ERROR, _("invalid object pointer"));
+        return -1;
+    }
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    gateway_t *gw = get_installed_gateway(anjay);
+    gateway_device_t *device;
+    if (!gw) {
+        // error already logged
+    } else if (!(device = find_device(gw, device_iid))) {
+        gw_log(ERROR, _("End Device ") "%u" _(" is not registered"),
+               device_iid);
+    } else {
+        result = register_device_object(anjay, device, def_ptr);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+static bool is_same_object(const anjay_dm_installed_object_t *obj,
+                           const anjay_dm_object_def_t *const *def_ptr) {
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    return obj->type == ANJAY_DM_OBJECT_USER_PROVIDED
+           && obj->impl.user_provided == def_ptr;
+#    else  // ANJAY_WITH_THREAD_SAFETY
+    return *obj == def_ptr;
+#    endif // ANJAY_WITH_THREAD_SAFETY
+}
+
+int anjay_lwm2m_gateway_unregister_object(
+        anjay_t *anjay_locked,
+        anjay_iid_t device_iid,
+        const anjay_dm_object_def_t *const *def_ptr) {
+    assert(anjay_locked);
+    if (!def_ptr || !*def_ptr) {
+        gw_log(ERROR, _("invalid object pointer"));
+        return -1;
+    }
+    int result = -1;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    gateway_t *gw = get_installed_gateway(anjay);
+    gateway_device_t *device;
+    AVS_LIST(anjay_dm_installed_object_t) *obj_ptr;
+    if (!gw) {
+        // error already logged
+    } else if (!(device = find_device(gw, device_iid))) {
+        gw_log(ERROR, _("End Device ") "%u" _(" is not registered"),
+               device_iid);
+    } else if (!*(obj_ptr = find_device_object_ptr(device, (*def_ptr)->oid))
+               || !is_same_object(*obj_ptr, def_ptr)) {
+        gw_log(ERROR,
+               _("object /") "%s" _("/") "%u" _(" is not currently registered"),
+               device->prefix, (*def_ptr)->oid);
+    } else {
+        unregister_device_object(anjay, device, obj_ptr);
+        notify_gateway_changed(anjay, device->iid);
+        result = 0;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+#endif // ANJAY_WITH_MODULE_LWM2M_GATEWAY
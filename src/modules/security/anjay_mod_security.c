@@ -16,6 +16,7 @@
 #    include <string.h>
 
 #    include <anjay_modules/anjay_io_utils.h>
+#    include <anjay_modules/anjay_memory_accounting.h>
 
 #    include "anjay_mod_security.h"
 #    include "anjay_security_transaction.h"
@@ -144,21 +145,35 @@ static int add_instance(sec_repr_t *repr,
         goto error;
     }
     if (instance->public_cert.desc.source != AVS_CRYPTO_DATA_SOURCE_EMPTY) {
-        if (_anjay_sec_init_certificate_chain_resource(
+        if (instance->key_material_by_reference) {
+            _anjay_sec_init_key_reference_resource(
+                    &new_instance->public_cert_or_psk_identity,
+                    &instance->public_cert.desc);
+        } else if (_anjay_sec_init_certificate_chain_resource(
                     &new_instance->public_cert_or_psk_identity,
                     SEC_KEY_AS_KEY_EXTERNAL, &instance->public_cert)) {
             goto error;
         }
     } else if (instance->psk_identity.desc.source
                != AVS_CRYPTO_DATA_SOURCE_EMPTY) {
-        if (_anjay_sec_init_psk_identity_resource(
+        if (instance->key_material_by_reference) {
+            _anjay_sec_init_key_reference_resource(
+                    &new_instance->public_cert_or_psk_identity,
+                    &instance->psk_identity.desc);
+        } else if (_anjay_sec_init_psk_identity_resource(
                     &new_instance->public_cert_or_psk_identity,
                     SEC_KEY_AS_KEY_EXTERNAL, &instance->psk_identity)) {
             goto error;
         }
     } else
 #    endif // ANJAY_WITH_SECURITY_STRUCTURED
-    {
+    if (instance->key_material_by_reference
+            && instance->public_cert_or_psk_identity) {
+        _anjay_sec_init_data_reference_resource(
+                &new_instance->public_cert_or_psk_identity,
+                instance->public_cert_or_psk_identity,
+                instance->public_cert_or_psk_identity_size);
+    } else {
         new_instance->public_cert_or_psk_identity.type = SEC_KEY_AS_DATA;
         if (_anjay_raw_buffer_clone(
                     &new_instance->public_cert_or_psk_identity.value.data,
@@ -184,14 +199,22 @@ static int add_instance(sec_repr_t *repr,
         goto error;
     }
     if (instance->private_key.desc.source != AVS_CRYPTO_DATA_SOURCE_EMPTY) {
-        if (_anjay_sec_init_private_key_resource(
+        if (instance->key_material_by_reference) {
+            _anjay_sec_init_key_reference_resource(
+                    &new_instance->private_cert_or_psk_key,
+                    &instance->private_key.desc);
+        } else if (_anjay_sec_init_private_key_resource(
                     &new_instance->private_cert_or_psk_key,
                     SEC_KEY_AS_KEY_EXTERNAL,
                     &instance->private_key)) {
             goto error;
         }
     } else if (instance->psk_key.desc.source != AVS_CRYPTO_DATA_SOURCE_EMPTY) {
-        if (_anjay_sec_init_psk_key_resource(
+        if (instance->key_material_by_reference) {
+            _anjay_sec_init_key_reference_resource(
+                    &new_instance->private_cert_or_psk_key,
+                    &instance->psk_key.desc);
+        } else if (_anjay_sec_init_psk_key_resource(
                     &new_instance->private_cert_or_psk_key,
                     SEC_KEY_AS_KEY_EXTERNAL,
                     &instance->psk_key)) {
@@ -199,7 +222,13 @@ static int add_instance(sec_repr_t *repr,
         }
     } else
 #    endif // ANJAY_WITH_SECURITY_STRUCTURED
-    {
+    if (instance->key_material_by_reference
+            && instance->private_cert_or_psk_key) {
+        _anjay_sec_init_data_reference_resource(
+                &new_instance->private_cert_or_psk_key,
+                instance->private_cert_or_psk_key,
+                instance->private_cert_or_psk_key_size);
+    } else {
         new_instance->private_cert_or_psk_key.type = SEC_KEY_AS_DATA;
         if (_anjay_raw_buffer_clone(
                     &new_instance->private_cert_or_psk_key.value.data,
@@ -265,6 +294,9 @@ static int add_instance(sec_repr_t *repr,
 
     _anjay_sec_instance_update_resource_presence(new_instance);
 
+    if (_anjay_sec_transaction_save_created(repr, new_instance->iid)) {
+        goto error;
+    }
     AVS_LIST(sec_instance_t) *ptr;
     AVS_LIST_FOREACH_PTR(ptr, &repr->instances) {
         if ((*ptr)->iid > new_instance->iid) {
@@ -298,7 +330,7 @@ static int del_instance(sec_repr_t *repr, anjay_iid_t iid) {
     AVS_LIST_FOREACH_PTR(it, &repr->instances) {
         if ((*it)->iid == iid) {
             AVS_LIST(sec_instance_t) element = AVS_LIST_DETACH(it);
-            _anjay_sec_destroy_instances(&element, true);
+            _anjay_sec_transaction_save_removed(repr, &element);
             _anjay_sec_mark_modified(repr);
             return 0;
         }
@@ -386,6 +418,7 @@ static int ret_sec_key_or_data(anjay_unlocked_output_ctx_t *ctx,
                                const sec_key_or_data_t *res) {
     switch (res->type) {
     case SEC_KEY_AS_DATA:
+    case SEC_KEY_AS_DATA_REFERENCE:
         return _anjay_ret_bytes_unlocked(ctx, res->value.data.data,
                                          res->value.data.size);
 #    if defined(ANJAY_WITH_SECURITY_STRUCTURED)
@@ -505,6 +538,9 @@ static int sec_write(anjay_unlocked_t *anjay,
     int retval;
     assert(inst);
 
+    if (_anjay_sec_transaction_save_instance(repr, inst)) {
+        return ANJAY_ERR_INTERNAL;
+    }
     _anjay_sec_mark_modified(repr);
 
     switch ((security_rid_t) rid) {
@@ -609,8 +645,12 @@ static int sec_resource_reset(anjay_unlocked_t *anjay,
     assert(rid == SEC_RES_DTLS_TLS_CIPHERSUITE);
     (void) rid;
 
-    const sec_instance_t *inst = find_instance(_anjay_sec_get(obj_ptr), iid);
+    sec_repr_t *repr = _anjay_sec_get(obj_ptr);
+    sec_instance_t *inst = find_instance(repr, iid);
     assert(inst);
+    if (_anjay_sec_transaction_save_instance(repr, inst)) {
+        return ANJAY_ERR_INTERNAL;
+    }
 
     AVS_LIST_CLEAR(&inst->enabled_ciphersuites);
     return 0;
@@ -644,6 +684,10 @@ static int sec_instance_create(anjay_unlocked_t *anjay,
     }
 
     init_instance(created, iid);
+    if (_anjay_sec_transaction_save_created(repr, iid)) {
+        _anjay_sec_destroy_instances(&created, true);
+        return ANJAY_ERR_INTERNAL;
+    }
 
     AVS_LIST(sec_instance_t) *ptr;
     AVS_LIST_FOREACH_PTR(ptr, &repr->instances) {
@@ -692,8 +736,12 @@ static int sec_instance_reset(anjay_unlocked_t *anjay,
                               const anjay_dm_installed_object_t obj_ptr,
                               anjay_iid_t iid) {
     (void) anjay;
-    sec_instance_t *inst = find_instance(_anjay_sec_get(obj_ptr), iid);
+    sec_repr_t *repr = _anjay_sec_get(obj_ptr);
+    sec_instance_t *inst = find_instance(repr, iid);
     assert(inst);
+    if (_anjay_sec_transaction_save_instance(repr, inst)) {
+        return ANJAY_ERR_INTERNAL;
+    }
 
     _anjay_sec_destroy_instance_fields(inst, true);
     init_instance(inst, iid);
@@ -769,8 +817,8 @@ static void security_delete(void *repr_) {
     sec_repr_t *repr = (sec_repr_t *) repr_;
     if (repr->in_transaction) {
         _anjay_sec_destroy_instances(&repr->instances, true);
-        _anjay_sec_destroy_instances(&repr->saved_instances,
-                                     repr->saved_modified_since_persist);
+        _anjay_sec_transaction_cleanup(repr,
+                                       repr->saved_modified_since_persist);
     } else {
         assert(!repr->saved_instances);
         _anjay_sec_destroy_instances(&repr->instances,
@@ -792,7 +840,7 @@ void anjay_security_object_purge(anjay_t *anjay_locked) {
         if (repr->instances) {
             _anjay_sec_mark_modified(repr);
         }
-        _anjay_sec_destroy_instances(&repr->saved_instances, true);
+        _anjay_sec_transaction_cleanup(repr, true);
         _anjay_sec_destroy_instances(&repr->instances, true);
         if (_anjay_notify_instances_changed_unlocked(anjay, SECURITY.oid)) {
             security_log(WARNING, _("Could not schedule socket reload"));
@@ -851,7 +899,9 @@ int anjay_security_object_install(anjay_t *anjay_locked) {
     assert(anjay_locked);
     sec_repr_t *repr = NULL;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_MODULES);
     repr = security_install_unlocked(anjay);
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return repr ? 0 : -1;
 }
@@ -45,7 +45,12 @@ typedef struct {
 typedef enum {
     SEC_KEY_AS_DATA,
     SEC_KEY_AS_KEY_EXTERNAL,
-    SEC_KEY_AS_KEY_OWNED
+    SEC_KEY_AS_KEY_OWNED,
+    /**
+     * Like SEC_KEY_AS_DATA, but value.data refers to memory owned by the user
+     * (e.g. read-only flash), which is never modified nor freed.
+     */
+    SEC_KEY_AS_DATA_REFERENCE
 } sec_key_or_data_type_t;
 
 typedef struct sec_key_or_data_struct sec_key_or_data_t;
@@ -117,7 +122,24 @@ typedef struct {
     anjay_dm_installed_object_t def_ptr;
     const anjay_unlocked_dm_object_def_t *def;
     AVS_LIST(sec_instance_t) instances;
+    /**
+     * Copy-on-write snapshot of the state from before the current transaction:
+     * pre-transaction copies of Instances modified or removed within it, sorted
+     * by IID. Instances that are not modified are not copied.
+     */
     AVS_LIST(sec_instance_t) saved_instances;
+    /**
+     * Sorted IIDs of Instances that did not exist before the current
+     * transaction, and have been created within it.
+     */
+    AVS_LIST(anjay_iid_t) created_iids;
+    /**
+     * Full list of Instances from before the current transaction, assembled
+     * from @ref instances and the snapshot only when explicitly requested
+     * using @ref _anjay_sec_saved_instances. Elements of this list are shallow
+     * copies that do not own any of the resources they refer to.
+     */
+    AVS_LIST(sec_instance_t) saved_instances_view;
     bool modified_since_persist;
     bool saved_modified_since_persist;
     bool in_transaction;
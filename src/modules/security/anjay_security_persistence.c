@@ -154,6 +154,8 @@ static avs_error_t handle_sec_key_or_data_type(avs_persistence_context_t *ctx,
     if (direction == AVS_PERSISTENCE_STORE) {
         switch (*type) {
         case SEC_KEY_AS_DATA:
+        case SEC_KEY_AS_DATA_REFERENCE:
+            // referenced data is restored as an owned copy
             type_ch = 'D';
             break;
         case SEC_KEY_AS_KEY_EXTERNAL:
@@ -391,7 +393,9 @@ handle_sec_key_or_data(avs_persistence_context_t *ctx,
     (void) stream_version;
     (void) min_version_for_key;
     (void) default_tag;
-    assert(value->type == SEC_KEY_AS_DATA);
+    assert(value->type == SEC_KEY_AS_DATA
+           || (value->type == SEC_KEY_AS_DATA_REFERENCE
+               && avs_persistence_direction(ctx) == AVS_PERSISTENCE_STORE));
     avs_error_t err = handle_raw_buffer(ctx, &value->value.data);
     assert(avs_is_err(err)
            || avs_persistence_direction(ctx) != AVS_PERSISTENCE_RESTORE
@@ -481,17 +485,19 @@ avs_error_t anjay_security_object_persist(anjay_t *anjay_locked,
     const anjay_dm_installed_object_t *sec_obj =
             _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_SECURITY);
     sec_repr_t *repr = sec_obj ? _anjay_sec_get(*sec_obj) : NULL;
+    AVS_LIST(sec_instance_t) *instances_ptr =
+            repr ? _anjay_sec_saved_instances(repr) : NULL;
     if (!repr) {
         err = avs_errno(AVS_EBADF);
+    } else if (!instances_ptr) {
+        err = avs_errno(AVS_ENOMEM);
     } else if (avs_is_ok((err = avs_stream_write(out_stream, MAGIC_V5,
                                                  sizeof(MAGIC_V5))))) {
         avs_persistence_context_t ctx =
                 avs_persistence_store_context_create(out_stream);
         err = avs_persistence_list(
                 &ctx,
-                (AVS_LIST(void) *) (repr->in_transaction
-                                            ? &repr->saved_instances
-                                            : &repr->instances),
+                (AVS_LIST(void) *) instances_ptr,
                 sizeof(sec_instance_t), handle_instance, (void *) (intptr_t) 5,
                 NULL);
         if (avs_is_ok(err)) {
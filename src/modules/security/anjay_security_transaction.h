@@ -24,6 +24,38 @@ int _anjay_sec_transaction_validate_impl(anjay_unlocked_t *anjay,
                                          sec_repr_t *repr);
 int _anjay_sec_transaction_rollback_impl(sec_repr_t *repr);
 
+/**
+ * Stores a copy of @p inst in the transaction snapshot, unless the repr is not
+ * in transaction, or the pre-transaction state of that Instance is already
+ * known. Shall be called before modifying any Instance.
+ */
+int _anjay_sec_transaction_save_instance(sec_repr_t *repr,
+                                         sec_instance_t *inst);
+
+/**
+ * Records that Instance @p iid is about to be created within the current
+ * transaction (if any).
+ */
+int _anjay_sec_transaction_save_created(sec_repr_t *repr, anjay_iid_t iid);
+
+/**
+ * Takes ownership of a single Instance element @p *removed_ptr that has just
+ * been detached from the Instance list. It is moved into the transaction
+ * snapshot if that is necessary for rollback, or destroyed otherwise.
+ */
+void _anjay_sec_transaction_save_removed(
+        sec_repr_t *repr, AVS_LIST(sec_instance_t) *removed_ptr);
+
+/**
+ * Returns a pointer to the list of Instances as seen before the current
+ * transaction, or to the current list of Instances if there is no ongoing
+ * transaction. May return NULL if the list could not be assembled due to an
+ * out-of-memory condition.
+ */
+AVS_LIST(sec_instance_t) *_anjay_sec_saved_instances(sec_repr_t *repr);
+
+void _anjay_sec_transaction_cleanup(sec_repr_t *repr, bool remove_from_engine);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* SECURITY_TRANSACTION_H */
@@ -151,6 +151,32 @@ int _anjay_sec_init_psk_key_resource(
               (defined(ANJAY_WITH_MODULE_SECURITY_ENGINE_SUPPORT) && \
               defined(AVS_COMMONS_WITH_AVS_CRYPTO_PSK_ENGINE)) */
 
+void _anjay_sec_init_data_reference_resource(sec_key_or_data_t *out_resource,
+                                             const void *data,
+                                             size_t size) {
+    assert(!out_resource->prev_ref);
+    assert(!out_resource->next_ref);
+    out_resource->type = SEC_KEY_AS_DATA_REFERENCE;
+    out_resource->value.data = (anjay_raw_buffer_t) {
+        .data = (void *) (intptr_t) data,
+        .size = size,
+        .capacity = size
+    };
+}
+
+#    ifdef ANJAY_WITH_SECURITY_STRUCTURED
+void _anjay_sec_init_key_reference_resource(
+        sec_key_or_data_t *out_resource,
+        const avs_crypto_security_info_union_t *in_value) {
+    assert(!out_resource->prev_ref);
+    assert(!out_resource->next_ref);
+    out_resource->type = SEC_KEY_AS_KEY_EXTERNAL;
+    out_resource->value.key.info = *in_value;
+    // no heap_buf means that there is nothing to free on cleanup
+    out_resource->value.key.heap_buf = NULL;
+}
+#    endif // ANJAY_WITH_SECURITY_STRUCTURED
+
 void _anjay_sec_key_or_data_cleanup(sec_key_or_data_t *value,
                                     bool remove_from_engine) {
     (void) remove_from_engine;
@@ -160,6 +186,8 @@ void _anjay_sec_key_or_data_cleanup(sec_key_or_data_t *value,
             memset(value->value.data.data, 0, value->value.data.capacity);
             _anjay_raw_buffer_clear(&value->value.data);
             break;
+        case SEC_KEY_AS_DATA_REFERENCE:
+            break;
 #    if defined(ANJAY_WITH_SECURITY_STRUCTURED)
         case SEC_KEY_AS_KEY_OWNED:
             // fall-through
@@ -218,10 +246,22 @@ static void sec_key_or_data_create_ref(sec_key_or_data_t *dest,
     src->next_ref = dest;
 }
 
-static int _anjay_sec_clone_instance(sec_instance_t *dest,
-                                     sec_instance_t *src) {
+int _anjay_sec_clone_instance(sec_instance_t *dest, sec_instance_t *src) {
     *dest = *src;
 
+    // first make dest not refer to any of the resources owned by src, so that
+    // it is always safe to destroy it, even if one of the steps below fails
+    sec_key_or_data_create_ref(&dest->public_cert_or_psk_identity,
+                               &src->public_cert_or_psk_identity);
+    sec_key_or_data_create_ref(&dest->private_cert_or_psk_key,
+                               &src->private_cert_or_psk_key);
+    dest->server_uri = NULL;
+    dest->server_public_key = ANJAY_RAW_BUFFER_EMPTY;
+#    ifdef ANJAY_WITH_LWM2M11
+    dest->server_name_indication = NULL;
+    dest->enabled_ciphersuites = NULL;
+#    endif // ANJAY_WITH_LWM2M11
+
     assert(src->server_uri);
     dest->server_uri = avs_strdup(src->server_uri);
     if (!dest->server_uri) {
@@ -229,12 +269,6 @@ static int _anjay_sec_clone_instance(sec_instance_t *dest,
         return -1;
     }
 
-    sec_key_or_data_create_ref(&dest->public_cert_or_psk_identity,
-                               &src->public_cert_or_psk_identity);
-    sec_key_or_data_create_ref(&dest->private_cert_or_psk_key,
-                               &src->private_cert_or_psk_key);
-
-    dest->server_public_key = ANJAY_RAW_BUFFER_EMPTY;
     if (_anjay_raw_buffer_clone(&dest->server_public_key,
                                 &src->server_public_key)) {
         security_log(ERROR, _("Cannot clone Server Public Key resource"));
@@ -242,13 +276,19 @@ static int _anjay_sec_clone_instance(sec_instance_t *dest,
     }
 
 #    ifdef ANJAY_WITH_LWM2M11
-    dest->server_name_indication = NULL;
     if (src->server_name_indication
             && !(dest->server_name_indication =
                          avs_strdup(src->server_name_indication))) {
         security_log(ERROR, _("Cannot clone SNI resource"));
         return -1;
     }
+
+    if (src->enabled_ciphersuites
+            && !(dest->enabled_ciphersuites =
+                         AVS_LIST_SIMPLE_CLONE(src->enabled_ciphersuites))) {
+        security_log(ERROR, _("Cannot clone DTLS/TLS Ciphersuite resource"));
+        return -1;
+    }
 #    endif // ANJAY_WITH_LWM2M11
 
     return 0;
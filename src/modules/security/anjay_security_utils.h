@@ -62,6 +62,24 @@ int _anjay_sec_init_psk_key_resource(sec_key_or_data_t *out_resource,
           (defined(ANJAY_WITH_MODULE_SECURITY_ENGINE_SUPPORT) && \
           defined(AVS_COMMONS_WITH_AVS_CRYPTO_PSK_ENGINE)) */
 
+/**
+ * Initializes @p out_resource so that it refers to @p size bytes at @p data
+ * without copying them. The memory needs to outlive the resource.
+ */
+void _anjay_sec_init_data_reference_resource(sec_key_or_data_t *out_resource,
+                                             const void *data,
+                                             size_t size);
+
+#ifdef ANJAY_WITH_SECURITY_STRUCTURED
+/**
+ * Initializes @p out_resource so that it uses the @p in_value descriptor
+ * directly, without copying it nor any of the data it points to.
+ */
+void _anjay_sec_init_key_reference_resource(
+        sec_key_or_data_t *out_resource,
+        const avs_crypto_security_info_union_t *in_value);
+#endif // ANJAY_WITH_SECURITY_STRUCTURED
+
 void _anjay_sec_key_or_data_cleanup(sec_key_or_data_t *value,
                                     bool remove_from_engine);
 
@@ -78,6 +96,14 @@ void _anjay_sec_destroy_instance_fields(sec_instance_t *instance,
 void _anjay_sec_destroy_instances(AVS_LIST(sec_instance_t) *instances_ptr,
                                   bool remove_from_engine);
 
+/**
+ * Fills @p dest with a copy of @p src . Key resources are shared with @p src
+ * by reference, all other resources are duplicated. On failure, @p dest is
+ * left in a state that can be safely freed using
+ * @ref _anjay_sec_destroy_instance_fields .
+ */
+int _anjay_sec_clone_instance(sec_instance_t *dest, sec_instance_t *src);
+
 /**
  * Clones all instances of the given Security Object @p repr . Return NULL
  * if either there was nothing to clone or an error has occurred.
@@ -17,6 +17,7 @@
 #    include <anjay/server.h>
 
 #    include <anjay_modules/anjay_bootstrap.h>
+#    include <anjay_modules/anjay_memory_accounting.h>
 #    include <anjay_modules/anjay_servers.h>
 
 #    include "anjay_mod_server.h"
@@ -150,8 +151,11 @@ static int assign_iid(server_repr_t *repr, anjay_iid_t *inout_iid) {
     return 0;
 }
 
-static void insert_created_instance(server_repr_t *repr,
-                                    AVS_LIST(server_instance_t) new_instance) {
+static int insert_created_instance(server_repr_t *repr,
+                                   AVS_LIST(server_instance_t) new_instance) {
+    if (_anjay_serv_transaction_save_created(repr, new_instance->iid)) {
+        return -1;
+    }
     AVS_LIST(server_instance_t) *ptr;
     AVS_LIST_FOREACH_PTR(ptr, &repr->instances) {
         assert((*ptr)->iid != new_instance->iid);
@@ -161,6 +165,7 @@ static void insert_created_instance(server_repr_t *repr,
     }
     _anjay_serv_mark_modified(repr);
     AVS_LIST_INSERT(ptr, new_instance);
+    return 0;
 }
 
 static int add_instance(server_repr_t *repr,
@@ -265,7 +270,10 @@ static int add_instance(server_repr_t *repr,
 #        endif // ANJAY_WITH_SEND
 #    endif     // ANJAY_WITH_LWM2M11
 
-    insert_created_instance(repr, new_instance);
+    if (insert_created_instance(repr, new_instance)) {
+        AVS_LIST_CLEAR(&new_instance);
+        return -1;
+    }
     server_log(INFO, _("Added instance ") "%u" _(" (SSID: ") "%u" _(")"),
                *inout_iid, instance->ssid);
     return 0;
@@ -275,7 +283,8 @@ static int del_instance(server_repr_t *repr, anjay_iid_t iid) {
     AVS_LIST(server_instance_t) *it;
     AVS_LIST_FOREACH_PTR(it, &repr->instances) {
         if ((*it)->iid == iid) {
-            AVS_LIST_DELETE(it);
+            AVS_LIST(server_instance_t) removed = AVS_LIST_DETACH(it);
+            _anjay_serv_transaction_save_removed(repr, &removed);
             _anjay_serv_mark_modified(repr);
             return 0;
         } else if ((*it)->iid > iid) {
@@ -314,7 +323,10 @@ static int serv_instance_create(anjay_unlocked_t *anjay,
     created->iid = iid;
     _anjay_serv_reset_instance(created);
 
-    insert_created_instance(repr, created);
+    if (insert_created_instance(repr, created)) {
+        AVS_LIST_CLEAR(&created);
+        return ANJAY_ERR_INTERNAL;
+    }
     return 0;
 }
 
@@ -329,8 +341,12 @@ static int serv_instance_reset(anjay_unlocked_t *anjay,
                                const anjay_dm_installed_object_t obj_ptr,
                                anjay_iid_t iid) {
     (void) anjay;
-    server_instance_t *inst = find_instance(_anjay_serv_get(obj_ptr), iid);
+    server_repr_t *repr = _anjay_serv_get(obj_ptr);
+    server_instance_t *inst = find_instance(repr, iid);
     assert(inst);
+    if (_anjay_serv_transaction_save_instance(repr, inst)) {
+        return ANJAY_ERR_INTERNAL;
+    }
 
     anjay_ssid_t ssid = inst->ssid;
     _anjay_serv_reset_instance(inst);
@@ -445,6 +461,9 @@ static int serv_write(anjay_unlocked_t *anjay,
     assert(inst);
     int retval;
 
+    if (_anjay_serv_transaction_save_instance(repr, inst)) {
+        return ANJAY_ERR_INTERNAL;
+    }
     _anjay_serv_mark_modified(repr);
 
     switch ((server_rid_t) rid) {
@@ -674,7 +693,7 @@ static void server_purge(server_repr_t *repr) {
         _anjay_serv_mark_modified(repr);
     }
     _anjay_serv_destroy_instances(&repr->instances);
-    _anjay_serv_destroy_instances(&repr->saved_instances);
+    _anjay_serv_transaction_cleanup(repr);
 }
 
 static void server_delete(void *repr) {
@@ -702,16 +721,17 @@ void anjay_server_object_purge(anjay_t *anjay_locked) {
 
 AVS_LIST(const anjay_ssid_t) anjay_server_get_ssids(anjay_t *anjay_locked) {
     assert(anjay_locked);
-    AVS_LIST(server_instance_t) source = NULL;
+    AVS_LIST(server_instance_t) *source_ptr = NULL;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     const anjay_dm_installed_object_t *server_obj =
             _anjay_dm_find_object_by_oid(anjay, SERVER.oid);
     server_repr_t *repr = _anjay_serv_get(*server_obj);
     if (_anjay_dm_transaction_object_included(anjay, server_obj)) {
-        source = repr->saved_instances;
+        source_ptr = _anjay_serv_saved_instances(repr);
     } else {
-        source = repr->instances;
+        source_ptr = &repr->instances;
     }
+    AVS_LIST(server_instance_t) source = source_ptr ? *source_ptr : NULL;
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     // We rely on the fact that the "ssid" field is first in server_instance_t,
     // which means that both "source" and "&source->ssid" point to exactly the
@@ -746,6 +766,7 @@ int anjay_server_object_install(anjay_t *anjay_locked) {
     assert(anjay_locked);
     int result = -1;
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_MODULES);
     AVS_LIST(server_repr_t) repr = AVS_LIST_NEW_ELEMENT(server_repr_t);
     if (!repr) {
         _anjay_log_oom();
@@ -768,6 +789,7 @@ int anjay_server_object_install(anjay_t *anjay_locked) {
             AVS_LIST_CLEAR(&repr);
         }
     }
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
     ANJAY_MUTEX_UNLOCK(anjay_locked);
     return result;
 }
@@ -785,7 +807,7 @@ int anjay_server_object_set_lifetime(anjay_t *anjay_locked,
     const anjay_dm_installed_object_t *server_obj =
             _anjay_dm_find_object_by_oid(anjay, SERVER.oid);
     server_repr_t *repr = _anjay_serv_get(*server_obj);
-    if (repr->saved_instances) {
+    if (repr->in_transaction) {
         server_log(ERROR, _("cannot set Lifetime while some transaction is "
                             "started on the Server Object"));
     } else {
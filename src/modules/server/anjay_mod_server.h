@@ -80,7 +80,23 @@ typedef struct {
     anjay_dm_installed_object_t def_ptr;
     const anjay_unlocked_dm_object_def_t *def;
     AVS_LIST(server_instance_t) instances;
+    /**
+     * Copy-on-write snapshot of the state from before the current transaction:
+     * pre-transaction copies of Instances modified or removed within it, sorted
+     * by IID. Instances that are not modified are not copied.
+     */
     AVS_LIST(server_instance_t) saved_instances;
+    /**
+     * Sorted IIDs of Instances that did not exist before the current
+     * transaction, and have been created within it.
+     */
+    AVS_LIST(anjay_iid_t) created_iids;
+    /**
+     * Full list of Instances from before the current transaction, assembled
+     * from @ref instances and the snapshot only when explicitly requested
+     * using @ref _anjay_serv_saved_instances.
+     */
+    AVS_LIST(server_instance_t) saved_instances_view;
     bool modified_since_persist;
     bool saved_modified_since_persist;
     bool in_transaction;
@@ -14,6 +14,8 @@
 #    ifdef AVS_COMMONS_WITH_AVS_PERSISTENCE
 #        include <avsystem/commons/avs_persistence.h>
 #    endif // AVS_COMMONS_WITH_AVS_PERSISTENCE
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream.h>
 #    include <avsystem/commons/avs_utils.h>
 
 #    include <anjay/server.h>
@@ -21,6 +23,7 @@
 #    include <anjay_modules/anjay_dm_utils.h>
 
 #    include <inttypes.h>
+#    include <stddef.h>
 #    include <string.h>
 
 #    include "anjay_server_transaction.h"
@@ -65,6 +68,22 @@ static const magic_t MAGIC_V1 = { 'S', 'R', 'V', PERSISTENCE_VERSION_1 };
 static const magic_t MAGIC_V2 = { 'S', 'R', 'V', PERSISTENCE_VERSION_2 };
 static const magic_t MAGIC_V3 = { 'S', 'R', 'V', PERSISTENCE_VERSION_3 };
 
+/**
+ * Magic of the snapshot format written by
+ * anjay_server_object_persist_snapshot(). It is followed by a
+ * snapshot_header_t and a raw image of server_instance_t structures, so it can
+ * only be restored by a build of the library with the same layout of that
+ * structure, as identified by snapshot_layout().
+ */
+static const magic_t MAGIC_SNAPSHOT = { 'S', 'R', 'V', 'S' };
+
+typedef struct {
+    uint32_t layout;
+    uint32_t instance_size;
+    uint32_t instance_count;
+    uint32_t checksum;
+} snapshot_header_t;
+
 static avs_error_t handle_v0_v1_sized_fields(avs_persistence_context_t *ctx,
                                              server_instance_t *element) {
     assert(avs_persistence_direction(ctx) == AVS_PERSISTENCE_RESTORE);
@@ -417,8 +436,12 @@ avs_error_t anjay_server_object_persist(anjay_t *anjay_locked,
     const anjay_dm_installed_object_t *server_obj =
             _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_SERVER);
     server_repr_t *repr = server_obj ? _anjay_serv_get(*server_obj) : NULL;
+    AVS_LIST(server_instance_t) *instances_ptr =
+            repr ? _anjay_serv_saved_instances(repr) : NULL;
     if (!repr) {
         err = avs_errno(AVS_EBADF);
+    } else if (!instances_ptr) {
+        err = avs_errno(AVS_ENOMEM);
     } else {
         avs_persistence_context_t persist_ctx =
                 avs_persistence_store_context_create(out_stream);
@@ -429,9 +452,7 @@ avs_error_t anjay_server_object_persist(anjay_t *anjay_locked,
                     PERSISTENCE_VERSION_3;
             err = avs_persistence_list(
                     &persist_ctx,
-                    (AVS_LIST(void) *) (repr->in_transaction
-                                                ? &repr->saved_instances
-                                                : &repr->instances),
+                    (AVS_LIST(void) *) instances_ptr,
                     sizeof(server_instance_t),
                     server_instance_persistence_handler, &persistence_version,
                     NULL);
@@ -445,6 +466,183 @@ avs_error_t anjay_server_object_persist(anjay_t *anjay_locked,
     return err;
 }
 
+static uint32_t snapshot_checksum(uint32_t hash, const void *data,
+                                  size_t size) {
+    // 32-bit FNV-1a
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= ((const uint8_t *) data)[i];
+        hash *= UINT32_C(16777619);
+    }
+    return hash;
+}
+
+#        define SNAPSHOT_CHECKSUM_INIT UINT32_C(2166136261)
+
+enum {
+    SNAPSHOT_CONFIG_WITHOUT_DEREGISTER = (1 << 0),
+    SNAPSHOT_CONFIG_WITH_LWM2M11 = (1 << 1),
+    SNAPSHOT_CONFIG_WITH_SEND = (1 << 2)
+};
+
+#        define SNAPSHOT_LAYOUT_FIELD(Hash, Field)                   \
+            snapshot_layout_field((Hash),                              \
+                                  offsetof(server_instance_t, Field), \
+                                  sizeof(((server_instance_t *) 0)->Field))
+
+static uint32_t
+snapshot_layout_field(uint32_t hash, size_t offset, size_t size) {
+    const uint32_t values[] = { (uint32_t) offset, (uint32_t) size };
+    return snapshot_checksum(hash, values, sizeof(values));
+}
+
+/**
+ * Fingerprint of the server_instance_t memory layout: the set of compiled-in
+ * fields, their offsets and sizes, and the byte order, which all need to match
+ * for a raw snapshot image to be meaningful.
+ */
+static uint32_t snapshot_layout(void) {
+    const uint32_t byte_order = UINT32_C(0x01020304);
+    uint32_t config = 0;
+#        ifdef ANJAY_WITHOUT_DEREGISTER
+    config |= SNAPSHOT_CONFIG_WITHOUT_DEREGISTER;
+#        endif // ANJAY_WITHOUT_DEREGISTER
+#        ifdef ANJAY_WITH_LWM2M11
+    config |= SNAPSHOT_CONFIG_WITH_LWM2M11;
+#            ifdef ANJAY_WITH_SEND
+    config |= SNAPSHOT_CONFIG_WITH_SEND;
+#            endif // ANJAY_WITH_SEND
+#        endif     // ANJAY_WITH_LWM2M11
+    uint32_t hash = snapshot_checksum(SNAPSHOT_CHECKSUM_INIT, &byte_order,
+                                      sizeof(byte_order));
+    hash = snapshot_checksum(hash, &config, sizeof(config));
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, ssid);
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, binding);
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, lifetime);
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, default_min_period);
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, default_max_period);
+#        ifndef ANJAY_WITHOUT_DEREGISTER
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, disable_timeout);
+#        endif // ANJAY_WITHOUT_DEREGISTER
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, notification_storing);
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, iid);
+#        ifdef ANJAY_WITH_LWM2M11
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, last_bootstrapped_timestamp);
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, last_alert);
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, bootstrap_on_registration_failure);
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, server_communication_retry_count);
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, server_communication_retry_timer);
+    hash = SNAPSHOT_LAYOUT_FIELD(hash,
+                                 server_communication_sequence_retry_count);
+    hash = SNAPSHOT_LAYOUT_FIELD(hash,
+                                 server_communication_sequence_delay_timer);
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, preferred_transport);
+#            ifdef ANJAY_WITH_SEND
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, mute_send);
+#            endif // ANJAY_WITH_SEND
+#        endif     // ANJAY_WITH_LWM2M11
+    hash = SNAPSHOT_LAYOUT_FIELD(hash, present_resources);
+    return hash;
+}
+
+avs_error_t anjay_server_object_persist_snapshot(anjay_t *anjay_locked,
+                                                 avs_stream_t *out_stream) {
+    assert(anjay_locked);
+    avs_error_t err = avs_errno(AVS_EINVAL);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    const anjay_dm_installed_object_t *server_obj =
+            _anjay_dm_find_object_by_oid(anjay, ANJAY_DM_OID_SERVER);
+    server_repr_t *repr = server_obj ? _anjay_serv_get(*server_obj) : NULL;
+    AVS_LIST(server_instance_t) *instances_ptr =
+            repr ? _anjay_serv_saved_instances(repr) : NULL;
+    if (!repr) {
+        err = avs_errno(AVS_EBADF);
+    } else if (!instances_ptr) {
+        err = avs_errno(AVS_ENOMEM);
+    } else {
+        snapshot_header_t header = {
+            .layout = snapshot_layout(),
+            .instance_size = (uint32_t) sizeof(server_instance_t),
+            .instance_count = (uint32_t) AVS_LIST_SIZE(*instances_ptr),
+            .checksum = SNAPSHOT_CHECKSUM_INIT
+        };
+        AVS_LIST(server_instance_t) it;
+        AVS_LIST_FOREACH(it, *instances_ptr) {
+            header.checksum =
+                    snapshot_checksum(header.checksum, it, sizeof(*it));
+        }
+        if (avs_is_ok((err = avs_stream_write(out_stream, MAGIC_SNAPSHOT,
+                                              sizeof(MAGIC_SNAPSHOT))))
+                && avs_is_ok((err = avs_stream_write(out_stream, &header,
+                                                     sizeof(header))))) {
+            AVS_LIST_FOREACH(it, *instances_ptr) {
+                if (avs_is_err((err = avs_stream_write(out_stream, it,
+                                                       sizeof(*it))))) {
+                    break;
+                }
+            }
+        }
+        if (avs_is_ok(err)) {
+            _anjay_serv_clear_modified(repr);
+            persistence_log(INFO, _("Server Object snapshot persisted"));
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return err;
+}
+
+static avs_error_t
+restore_snapshot(avs_stream_t *in_stream,
+                 AVS_LIST(server_instance_t) *out_instances) {
+    snapshot_header_t header;
+    avs_error_t err =
+            avs_stream_read_reliably(in_stream, &header, sizeof(header));
+    if (avs_is_err(err)) {
+        return err;
+    }
+    if (header.layout != snapshot_layout()
+            || header.instance_size != sizeof(server_instance_t)
+            || header.instance_count > ANJAY_ID_INVALID) {
+        persistence_log(WARNING,
+                        _("Server Object snapshot made by incompatible build"));
+        return avs_errno(AVS_EBADMSG);
+    }
+    if (!header.instance_count) {
+        return header.checksum == SNAPSHOT_CHECKSUM_INIT
+                       ? AVS_OK
+                       : avs_errno(AVS_EBADMSG);
+    }
+
+    const size_t image_size =
+            (size_t) header.instance_count * sizeof(server_instance_t);
+    server_instance_t *image = (server_instance_t *) avs_malloc(image_size);
+    if (!image) {
+        _anjay_log_oom();
+        return avs_errno(AVS_ENOMEM);
+    }
+    if (avs_is_ok((err = avs_stream_read_reliably(in_stream, image,
+                                                  image_size)))
+            && snapshot_checksum(SNAPSHOT_CHECKSUM_INIT, image, image_size)
+                           != header.checksum) {
+        persistence_log(WARNING, _("Server Object snapshot checksum mismatch"));
+        err = avs_errno(AVS_EBADMSG);
+    }
+
+    AVS_LIST(server_instance_t) *tail = out_instances;
+    for (uint32_t i = 0; avs_is_ok(err) && i < header.instance_count; ++i) {
+        if (i > 0 && image[i].iid <= image[i - 1].iid) {
+            err = avs_errno(AVS_EBADMSG);
+        } else if (!(*tail = AVS_LIST_NEW_ELEMENT(server_instance_t))) {
+            _anjay_log_oom();
+            err = avs_errno(AVS_ENOMEM);
+        } else {
+            memcpy(*tail, &image[i], sizeof(server_instance_t));
+            AVS_LIST_ADVANCE_PTR(&tail);
+        }
+    }
+    avs_free(image);
+    return err;
+}
+
 static int check_magic_header(magic_t magic_header,
                               server_persistence_version_t *out_version) {
     if (!memcmp(magic_header, MAGIC_V0, sizeof(magic_t))) {
@@ -487,16 +685,23 @@ avs_error_t anjay_server_object_restore(anjay_t *anjay_locked,
             persistence_log(WARNING, _("Could not read Server Object header"));
         } else {
             server_persistence_version_t persistence_version;
-            if (check_magic_header(magic_header, &persistence_version)) {
+            const bool is_snapshot = !memcmp(magic_header, MAGIC_SNAPSHOT,
+                                             sizeof(magic_t));
+            if (!is_snapshot
+                    && check_magic_header(magic_header, &persistence_version)) {
                 persistence_log(WARNING, _("Header magic constant mismatch"));
                 err = avs_errno(AVS_EBADMSG);
             } else {
                 repr->instances = NULL;
-                err = avs_persistence_list(&restore_ctx,
-                                           (AVS_LIST(void) *) &repr->instances,
-                                           sizeof(server_instance_t),
-                                           server_instance_persistence_handler,
-                                           &persistence_version, NULL);
+                if (is_snapshot) {
+                    err = restore_snapshot(in_stream, &repr->instances);
+                } else {
+                    err = avs_persistence_list(
+                            &restore_ctx, (AVS_LIST(void) *) &repr->instances,
+                            sizeof(server_instance_t),
+                            server_instance_persistence_handler,
+                            &persistence_version, NULL);
+                }
                 if (avs_is_ok(err) && _anjay_serv_object_validate(repr)) {
                     err = avs_errno(AVS_EBADMSG);
                 }
@@ -529,6 +734,14 @@ avs_error_t anjay_server_object_persist(anjay_t *anjay,
     return avs_errno(AVS_ENOTSUP);
 }
 
+avs_error_t anjay_server_object_persist_snapshot(anjay_t *anjay,
+                                                 avs_stream_t *out_stream) {
+    (void) anjay;
+    (void) out_stream;
+    persistence_log(ERROR, _("Persistence not compiled in"));
+    return avs_errno(AVS_ENOTSUP);
+}
+
 avs_error_t anjay_server_object_restore(anjay_t *anjay,
                                         avs_stream_t *in_stream) {
     (void) anjay;
@@ -160,13 +160,139 @@ int _anjay_serv_object_validate(server_repr_t *repr) {
     return result;
 }
 
+static AVS_LIST(server_instance_t) *
+find_instance_ptr(AVS_LIST(server_instance_t) *list, anjay_iid_t iid) {
+    AVS_LIST(server_instance_t) *it;
+    AVS_LIST_FOREACH_PTR(it, list) {
+        if ((*it)->iid >= iid) {
+            break;
+        }
+    }
+    return it;
+}
+
+static AVS_LIST(anjay_iid_t) *find_iid_ptr(AVS_LIST(anjay_iid_t) *list,
+                                           anjay_iid_t iid) {
+    AVS_LIST(anjay_iid_t) *it;
+    AVS_LIST_FOREACH_PTR(it, list) {
+        if (**it >= iid) {
+            break;
+        }
+    }
+    return it;
+}
+
+static bool pre_transaction_state_known(server_repr_t *repr,
+                                        anjay_iid_t iid) {
+    AVS_LIST(anjay_iid_t) *created_ptr = find_iid_ptr(&repr->created_iids, iid);
+    AVS_LIST(server_instance_t) *saved_ptr =
+            find_instance_ptr(&repr->saved_instances, iid);
+    return (*created_ptr && **created_ptr == iid)
+           || (*saved_ptr && (*saved_ptr)->iid == iid);
+}
+
+int _anjay_serv_transaction_save_instance(server_repr_t *repr,
+                                          const server_instance_t *inst) {
+    if (!repr->in_transaction || pre_transaction_state_known(repr, inst->iid)) {
+        return 0;
+    }
+    AVS_LIST(server_instance_t) copy = AVS_LIST_NEW_ELEMENT(server_instance_t);
+    if (!copy) {
+        _anjay_log_oom();
+        return ANJAY_ERR_INTERNAL;
+    }
+    *copy = *inst;
+    AVS_LIST_INSERT(find_instance_ptr(&repr->saved_instances, inst->iid),
+                    copy);
+    return 0;
+}
+
+int _anjay_serv_transaction_save_created(server_repr_t *repr, anjay_iid_t iid) {
+    if (!repr->in_transaction || pre_transaction_state_known(repr, iid)) {
+        return 0;
+    }
+    AVS_LIST(anjay_iid_t) *insert_ptr = find_iid_ptr(&repr->created_iids, iid);
+    if (!AVS_LIST_INSERT_NEW(anjay_iid_t, insert_ptr)) {
+        _anjay_log_oom();
+        return ANJAY_ERR_INTERNAL;
+    }
+    **insert_ptr = iid;
+    return 0;
+}
+
+void _anjay_serv_transaction_save_removed(
+        server_repr_t *repr, AVS_LIST(server_instance_t) *removed_ptr) {
+    assert(*removed_ptr && !AVS_LIST_NEXT(*removed_ptr));
+    if (!repr->in_transaction
+            || pre_transaction_state_known(repr, (*removed_ptr)->iid)) {
+        AVS_LIST_CLEAR(removed_ptr);
+        return;
+    }
+    AVS_LIST_INSERT(find_instance_ptr(&repr->saved_instances,
+                                      (*removed_ptr)->iid),
+                    *removed_ptr);
+    *removed_ptr = NULL;
+}
+
+static AVS_LIST(server_instance_t) build_saved_instances_view(
+        server_repr_t *repr) {
+    AVS_LIST(server_instance_t) view = NULL;
+    AVS_LIST(server_instance_t) *tail = &view;
+    AVS_LIST(server_instance_t) current = repr->instances;
+    AVS_LIST(server_instance_t) saved = repr->saved_instances;
+    AVS_LIST(anjay_iid_t) created = repr->created_iids;
+    while (current || saved) {
+        const server_instance_t *source;
+        if (saved && (!current || saved->iid <= current->iid)) {
+            if (current && current->iid == saved->iid) {
+                current = AVS_LIST_NEXT(current);
+            }
+            source = saved;
+            saved = AVS_LIST_NEXT(saved);
+        } else {
+            source = current;
+            current = AVS_LIST_NEXT(current);
+            while (created && *created < source->iid) {
+                created = AVS_LIST_NEXT(created);
+            }
+            if (created && *created == source->iid) {
+                continue;
+            }
+        }
+        if (!(*tail = AVS_LIST_NEW_ELEMENT(server_instance_t))) {
+            _anjay_log_oom();
+            AVS_LIST_CLEAR(&view);
+            return NULL;
+        }
+        **tail = *source;
+        AVS_LIST_ADVANCE_PTR(&tail);
+    }
+    return view;
+}
+
+AVS_LIST(server_instance_t) *_anjay_serv_saved_instances(server_repr_t *repr) {
+    if (!repr->in_transaction
+            || (!repr->saved_instances && !repr->created_iids)) {
+        return &repr->instances;
+    }
+    if (!repr->saved_instances_view
+            && !(repr->saved_instances_view =
+                         build_saved_instances_view(repr))) {
+        return NULL;
+    }
+    return &repr->saved_instances_view;
+}
+
+void _anjay_serv_transaction_cleanup(server_repr_t *repr) {
+    _anjay_serv_destroy_instances(&repr->saved_instances);
+    _anjay_serv_destroy_instances(&repr->saved_instances_view);
+    AVS_LIST_CLEAR(&repr->created_iids);
+}
+
 int _anjay_serv_transaction_begin_impl(server_repr_t *repr) {
     assert(!repr->saved_instances);
+    assert(!repr->created_iids);
     assert(!repr->in_transaction);
-    repr->saved_instances = _anjay_serv_clone_instances(repr);
-    if (!repr->saved_instances && repr->instances) {
-        return ANJAY_ERR_INTERNAL;
-    }
     repr->saved_modified_since_persist = repr->modified_since_persist;
     repr->in_transaction = true;
     return 0;
@@ -174,7 +300,7 @@ int _anjay_serv_transaction_begin_impl(server_repr_t *repr) {
 
 int _anjay_serv_transaction_commit_impl(server_repr_t *repr) {
     assert(repr->in_transaction);
-    _anjay_serv_destroy_instances(&repr->saved_instances);
+    _anjay_serv_transaction_cleanup(repr);
     repr->in_transaction = false;
     return 0;
 }
@@ -186,10 +312,25 @@ int _anjay_serv_transaction_validate_impl(server_repr_t *repr) {
 
 int _anjay_serv_transaction_rollback_impl(server_repr_t *repr) {
     assert(repr->in_transaction);
-    _anjay_serv_destroy_instances(&repr->instances);
+    AVS_LIST_CLEAR(&repr->created_iids) {
+        AVS_LIST(server_instance_t) *instance_ptr =
+                find_instance_ptr(&repr->instances, *repr->created_iids);
+        if (*instance_ptr && (*instance_ptr)->iid == *repr->created_iids) {
+            AVS_LIST_DELETE(instance_ptr);
+        }
+    }
+    while (repr->saved_instances) {
+        AVS_LIST(server_instance_t) saved =
+                AVS_LIST_DETACH(&repr->saved_instances);
+        AVS_LIST(server_instance_t) *instance_ptr =
+                find_instance_ptr(&repr->instances, saved->iid);
+        if (*instance_ptr && (*instance_ptr)->iid == saved->iid) {
+            AVS_LIST_DELETE(instance_ptr);
+        }
+        AVS_LIST_INSERT(instance_ptr, saved);
+    }
+    _anjay_serv_transaction_cleanup(repr);
     repr->modified_since_persist = repr->saved_modified_since_persist;
-    repr->instances = repr->saved_instances;
-    repr->saved_instances = NULL;
     repr->in_transaction = false;
     return 0;
 }
@@ -28,8 +28,6 @@ int _anjay_serv_fetch_validated_i32(anjay_unlocked_input_ctx_t *ctx,
 int _anjay_serv_fetch_binding(anjay_unlocked_input_ctx_t *ctx,
                               anjay_binding_mode_t *out_binding);
 
-AVS_LIST(server_instance_t)
-_anjay_serv_clone_instances(const server_repr_t *repr);
 void _anjay_serv_destroy_instances(AVS_LIST(server_instance_t) *instances);
 void _anjay_serv_reset_instance(server_instance_t *serv);
 
@@ -12,12 +12,14 @@
 #ifdef ANJAY_WITH_MODULE_SW_MGMT
 
 #    include <inttypes.h>
+#    include <string.h>
 
 #    include <anjay/sw_mgmt.h>
 
 #    include <anjay_modules/anjay_dm_utils.h>
 #    include <anjay_modules/anjay_io_utils.h>
 #    include <anjay_modules/anjay_sched.h>
+#    include <anjay_modules/anjay_sha256.h>
 #    include <anjay_modules/anjay_utils_core.h>
 #    include <anjay_modules/dm/anjay_modules.h>
 
@@ -83,6 +85,12 @@ typedef enum {
     SW_MGMT_UPDATE_STATE_INSTALLED = 4
 } sw_mgmt_update_state_t;
 
+typedef enum {
+    SW_MGMT_DIGEST_STATE_NONE,
+    SW_MGMT_DIGEST_STATE_COMPUTING,
+    SW_MGMT_DIGEST_STATE_DONE
+} sw_mgmt_digest_state_t;
+
 typedef struct sw_mgmt_instance_struct {
     anjay_iid_t iid;
     void *inst_ctx;
@@ -94,6 +102,10 @@ typedef struct sw_mgmt_instance_struct {
 
     bool cannot_delete;
 
+    sw_mgmt_digest_state_t digest_state;
+    anjay_sha256_t digest_ctx;
+    uint8_t digest[ANJAY_SW_MGMT_PACKAGE_DIGEST_SIZE];
+
 #    ifdef ANJAY_WITH_DOWNLOADER
     anjay_download_handle_t pull_download_handle;
     bool pull_download_stream_opened;
@@ -109,6 +121,8 @@ typedef struct sw_mgmt_object_struct {
 
     AVS_LIST(sw_mgmt_instance_t) instances;
 
+    bool compute_package_digest;
+
 #    if defined(ANJAY_WITH_DOWNLOADER)
     bool prefer_same_socket_downloads;
     bool downloads_suspended;
@@ -296,6 +310,12 @@ static inline int call_stream_open(anjay_unlocked_t *anjay,
     result =
             obj->handlers->stream_open(obj->obj_ctx, inst->iid, inst->inst_ctx);
     LOCK_AFTER_SW_MGMT_CALLBACK(anjay_locked, inst);
+    if (!result && obj->compute_package_digest) {
+        _anjay_sha256_init(&inst->digest_ctx);
+        inst->digest_state = SW_MGMT_DIGEST_STATE_COMPUTING;
+    } else {
+        inst->digest_state = SW_MGMT_DIGEST_STATE_NONE;
+    }
     return result;
 }
 
@@ -309,6 +329,13 @@ static inline int call_stream_write(anjay_unlocked_t *anjay,
     result = obj->handlers->stream_write(obj->obj_ctx, inst->iid,
                                          inst->inst_ctx, data, length);
     LOCK_AFTER_SW_MGMT_CALLBACK(anjay_locked, inst);
+    if (inst->digest_state == SW_MGMT_DIGEST_STATE_COMPUTING) {
+        if (result) {
+            inst->digest_state = SW_MGMT_DIGEST_STATE_NONE;
+        } else {
+            _anjay_sha256_update(&inst->digest_ctx, data, length);
+        }
+    }
     return result;
 }
 
@@ -316,16 +343,26 @@ static inline int call_stream_finish(anjay_unlocked_t *anjay,
                                      sw_mgmt_object_t *obj,
                                      sw_mgmt_instance_t *inst) {
     int result = -1;
+    // digest is finalized beforehand, so that it can already be verified
+    // within the stream_finish handler
+    if (inst->digest_state == SW_MGMT_DIGEST_STATE_COMPUTING) {
+        _anjay_sha256_finish(&inst->digest_ctx, inst->digest);
+        inst->digest_state = SW_MGMT_DIGEST_STATE_DONE;
+    }
     UNLOCK_FOR_SW_MGMT_CALLBACK(anjay_locked, anjay, inst);
     result = obj->handlers->stream_finish(obj->obj_ctx, inst->iid,
                                           inst->inst_ctx);
     LOCK_AFTER_SW_MGMT_CALLBACK(anjay_locked, inst);
+    if (result) {
+        inst->digest_state = SW_MGMT_DIGEST_STATE_NONE;
+    }
     return result;
 }
 
 static inline void call_reset(anjay_unlocked_t *anjay,
                               sw_mgmt_object_t *obj,
                               sw_mgmt_instance_t *inst) {
+    inst->digest_state = SW_MGMT_DIGEST_STATE_NONE;
     UNLOCK_FOR_SW_MGMT_CALLBACK(anjay_locked, anjay, inst);
     obj->handlers->reset(obj->obj_ctx, inst->iid, inst->inst_ctx);
     LOCK_AFTER_SW_MGMT_CALLBACK(anjay_locked, inst);
@@ -780,7 +817,9 @@ static int schedule_package_pull_download(anjay_unlocked_t *anjay,
         .on_next_block = pull_download_on_next_block,
         .on_download_finished = pull_download_on_download_finished,
         .user_data = inst,
-        .prefer_same_socket_downloads = obj->prefer_same_socket_downloads
+        .prefer_same_socket_downloads = obj->prefer_same_socket_downloads,
+        // security_config is then read from the data model
+        .resume_server_dtls_session = !obj->handlers->get_security_config
     };
 
     if (transport_security_from_uri(package_uri) == ANJAY_TRANSPORT_ENCRYPTED) {
@@ -1435,6 +1474,7 @@ int anjay_sw_mgmt_install(anjay_t *anjay_locked,
         _anjay_dm_installed_object_init_unlocked(&obj->def_ptr, &obj->def);
         obj->handlers = settings->handlers;
         obj->obj_ctx = settings->obj_ctx;
+        obj->compute_package_digest = settings->compute_package_digest;
 #    if defined(ANJAY_WITH_DOWNLOADER)
         obj->prefer_same_socket_downloads =
                 settings->prefer_same_socket_downloads;
@@ -1491,6 +1531,66 @@ int anjay_sw_mgmt_get_activation_state(anjay_t *anjay_locked,
     return result;
 }
 
+int anjay_sw_mgmt_get_package_digest(
+        anjay_t *anjay_locked,
+        anjay_iid_t iid,
+        uint8_t out_digest[ANJAY_SW_MGMT_PACKAGE_DIGEST_SIZE]) {
+    assert(anjay_locked);
+    assert(out_digest);
+    int result = -1;
+
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+
+    sw_mgmt_object_t *obj =
+            (sw_mgmt_object_t *) _anjay_dm_module_get_arg(anjay,
+                                                          sw_mgmt_delete);
+    if (!obj) {
+        sw_mgmt_log(WARNING, _("Software Management object not installed"));
+    } else {
+        sw_mgmt_instance_t *inst = find_instance(obj, iid);
+        if (!inst) {
+            sw_mgmt_log_inst(ERROR, iid, _("instance not found"));
+        } else if (inst->digest_state == SW_MGMT_DIGEST_STATE_DONE) {
+            memcpy(out_digest, inst->digest, sizeof(inst->digest));
+            result = 0;
+        }
+    }
+
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+#    ifdef ANJAY_WITH_DOWNLOADER
+int anjay_sw_mgmt_get_download_stats(anjay_t *anjay_locked,
+                                     anjay_iid_t iid,
+                                     anjay_download_stats_t *out_stats) {
+    assert(anjay_locked);
+    assert(out_stats);
+    int result = -1;
+
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+
+    sw_mgmt_object_t *obj =
+            (sw_mgmt_object_t *) _anjay_dm_module_get_arg(anjay,
+                                                          sw_mgmt_delete);
+    if (!obj) {
+        sw_mgmt_log(WARNING, _("Software Management object not installed"));
+    } else {
+        sw_mgmt_instance_t *inst = find_instance(obj, iid);
+        if (!inst) {
+            sw_mgmt_log_inst(ERROR, iid, _("instance not found"));
+        } else if (inst->pull_download_handle
+                   && avs_is_ok(_anjay_download_get_stats_unlocked(
+                              anjay, inst->pull_download_handle, out_stats))) {
+            result = 0;
+        }
+    }
+
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+#    endif // ANJAY_WITH_DOWNLOADER
+
 int anjay_sw_mgmt_finish_pkg_install(
         anjay_t *anjay_locked,
         anjay_iid_t iid,
@@ -0,0 +1,445 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+/**
+ * Replays the fuzz test corpora from tests/fuzz/test_cases through the code
+ * they are meant to exercise, and reports the time spent per input byte for
+ * each corpus entry. Inputs that are processed slowly (e.g. due to quadratic
+ * parsing or excessive allocations) stand out as having a high ns/B value.
+ *
+ * Corpora are replayed as follows:
+ * - cbor_decoder - all values are read using the CBOR decoder, in the same way
+ *   as in the tests/fuzz/cbor/decoder.c fuzz target,
+ * - coap_stream - the entry is received as a single datagram by anjay_serve(),
+ *   any responses are discarded,
+ * - factory_prov - the entry is passed to anjay_factory_provision().
+ *
+ * Results of processing the entries are ignored, as most of them are supposed
+ * to be invalid.
+ *
+ * Parameters are set using environment variables:
+ * - ANJAY_BENCHMARK_CORPUS_DIR - directory containing the corpora, defaults to
+ *   tests/fuzz/test_cases in the source tree,
+ * - ANJAY_BENCHMARK_REPEATS - number of times each entry is replayed.
+ *
+ * Allocations per replay are only reported if the library is built with
+ * WITH_MEMORY_ACCOUNTING.
+ */
+
+#include <anjay_init.h>
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define AVS_UNIT_ENABLE_SHORT_ASSERTS
+#include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_socket_v_table.h>
+#include <avsystem/commons/avs_stream_inbuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+#include <avsystem/commons/avs_utils.h>
+
+#include <anjay/factory_provisioning.h>
+#include <anjay/security.h>
+#include <anjay/server.h>
+#include <anjay/stats.h>
+
+#include "src/core/io/cbor/anjay_json_like_cbor_decoder.h"
+#include "tests/benchmarks/utils.h"
+#include "tests/utils/dm.h"
+
+#define BENCH_DEFAULT_REPEATS 1000
+#define BENCH_MAX_REPEATS 1000000
+
+// Same limit as the AFL fuzz targets use for their input
+#define BENCH_MAX_ENTRY_SIZE 65536
+
+typedef struct {
+    char *name;
+    uint8_t *data;
+    size_t size;
+} corpus_entry_t;
+
+/**
+ * Processes a single corpus entry. Called repeatedly, within the measured
+ * section.
+ */
+typedef void bench_replay_t(void *arg, const uint8_t *data, size_t size);
+
+static const char *corpus_dir(void) {
+    const char *dir = getenv("ANJAY_BENCHMARK_CORPUS_DIR");
+    return dir && *dir ? dir : ANJAY_BENCHMARK_CORPUS_DIR;
+}
+
+static int compare_entries(const void *a, const void *b, size_t size) {
+    (void) size;
+    return strcmp(((const corpus_entry_t *) a)->name,
+                  ((const corpus_entry_t *) b)->name);
+}
+
+static void load_entry(AVS_LIST(corpus_entry_t) *entries,
+                       const char *dir,
+                       const char *name) {
+    char path[1024];
+    AVS_UNIT_ASSERT_TRUE(
+            avs_simple_snprintf(path, sizeof(path), "%s/%s", dir, name) >= 0);
+    FILE *f = fopen(path, "rb");
+    AVS_UNIT_ASSERT_NOT_NULL(f);
+    uint8_t *data = (uint8_t *) avs_malloc(BENCH_MAX_ENTRY_SIZE);
+    AVS_UNIT_ASSERT_NOT_NULL(data);
+    const size_t size = fread(data, 1, BENCH_MAX_ENTRY_SIZE, f);
+    AVS_UNIT_ASSERT_SUCCESS(ferror(f));
+    fclose(f);
+
+    AVS_LIST(corpus_entry_t) entry = AVS_LIST_NEW_ELEMENT(corpus_entry_t);
+    AVS_UNIT_ASSERT_NOT_NULL(entry);
+    entry->name = avs_strdup(name);
+    AVS_UNIT_ASSERT_NOT_NULL(entry->name);
+    entry->data = data;
+    entry->size = size;
+    AVS_LIST_INSERT(entries, entry);
+}
+
+/**
+ * Loads all regular files from a given corpus, sorted by name. Returns NULL if
+ * the corpus does not exist or is empty.
+ */
+static AVS_LIST(corpus_entry_t) load_corpus(const char *corpus) {
+    char dir_path[1024];
+    AVS_UNIT_ASSERT_TRUE(avs_simple_snprintf(dir_path, sizeof(dir_path),
+                                             "%s/%s", corpus_dir(), corpus)
+                         >= 0);
+    AVS_LIST(corpus_entry_t) entries = NULL;
+    DIR *dir = opendir(dir_path);
+    if (!dir) {
+        return NULL;
+    }
+    struct dirent *dirent;
+    while ((dirent = readdir(dir))) {
+        if (dirent->d_name[0] != '.') {
+            load_entry(&entries, dir_path, dirent->d_name);
+        }
+    }
+    closedir(dir);
+    AVS_LIST_SORT(&entries, compare_entries);
+    return entries;
+}
+
+static void free_corpus(AVS_LIST(corpus_entry_t) *entries) {
+    AVS_LIST_CLEAR(entries) {
+        avs_free((*entries)->name);
+        avs_free((*entries)->data);
+    }
+}
+
+static void bench_replay_corpus(const char *corpus,
+                                bench_replay_t *replay,
+                                void *arg) {
+    AVS_LIST(corpus_entry_t) entries = load_corpus(corpus);
+    if (!entries) {
+        printf("%-14s no entries in %s/%s\n", corpus, corpus_dir(), corpus);
+        return;
+    }
+    const size_t repeats =
+            _anjay_bench_env_size("ANJAY_BENCHMARK_REPEATS",
+                                  BENCH_DEFAULT_REPEATS, BENCH_MAX_REPEATS);
+    size_t allocations = 0;
+    const bool allocations_available =
+            _anjay_bench_total_allocations(&allocations);
+    anjay_reset_allocation_sites();
+
+    size_t total_bytes = 0;
+    int64_t total_ns = 0;
+    double worst_ns_per_byte = 0.0;
+    const char *worst_entry = NULL;
+    AVS_LIST(corpus_entry_t) entry;
+    AVS_LIST_FOREACH(entry, entries) {
+        size_t allocations_before;
+        size_t allocations_after;
+        (void) _anjay_bench_total_allocations(&allocations_before);
+        avs_time_monotonic_t start = avs_time_monotonic_now();
+        for (size_t i = 0; i < repeats; ++i) {
+            replay(arg, entry->data, entry->size);
+        }
+        const int64_t entry_ns = _anjay_bench_elapsed_ns(start);
+        (void) _anjay_bench_total_allocations(&allocations_after);
+
+        // empty entries are counted as a single byte
+        const double ns_per_byte =
+                (double) entry_ns
+                / ((double) repeats * (double) AVS_MAX(entry->size, 1));
+        if (!worst_entry || ns_per_byte > worst_ns_per_byte) {
+            worst_ns_per_byte = ns_per_byte;
+            worst_entry = entry->name;
+        }
+        total_bytes += entry->size * repeats;
+        total_ns += entry_ns;
+
+        printf("%-14s %-24s %6u B: %9.1f ns/B, ", corpus, entry->name,
+               (unsigned) entry->size, ns_per_byte);
+        if (allocations_available) {
+            printf("%6.1f allocs/replay\n",
+                   (double) (allocations_after - allocations_before)
+                           / (double) repeats);
+        } else {
+            printf("   n/a allocs/replay\n");
+        }
+    }
+    printf("%-14s %u entries: %9.1f ns/B on average, worst: %s\n", corpus,
+           (unsigned) AVS_LIST_SIZE(entries),
+           total_bytes > 0 ? (double) total_ns / (double) total_bytes : 0.0,
+           worst_entry);
+    _anjay_bench_print_allocation_sites(AVS_LIST_SIZE(entries) * repeats,
+                                        "replay");
+    free_corpus(&entries);
+}
+
+#ifdef ANJAY_WITH_CBOR
+static int decode_value(anjay_json_like_decoder_t *decoder);
+
+static int decode_string(anjay_json_like_decoder_t *decoder) {
+    anjay_io_cbor_bytes_ctx_t bytes = { 0 };
+    if (_anjay_io_cbor_get_bytes_ctx(decoder, &bytes)) {
+        return -1;
+    }
+    uint8_t buffer[1024];
+    bool finished = false;
+    while (!finished) {
+        size_t bytes_read;
+        if (_anjay_io_cbor_get_some_bytes(decoder, &bytes, buffer,
+                                          sizeof(buffer), &bytes_read,
+                                          &finished)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int decode_compound(anjay_json_like_decoder_t *decoder, bool is_map) {
+    size_t outer_level = _anjay_json_like_decoder_nesting_level(decoder);
+    if (is_map ? _anjay_json_like_decoder_enter_map(decoder)
+               : _anjay_json_like_decoder_enter_array(decoder)) {
+        return -1;
+    }
+    while (_anjay_json_like_decoder_nesting_level(decoder) > outer_level) {
+        if (decode_value(decoder)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int decode_value(anjay_json_like_decoder_t *decoder) {
+    anjay_json_like_value_type_t type;
+    if (_anjay_json_like_decoder_current_value_type(decoder, &type)) {
+        return -1;
+    }
+    switch (type) {
+    case ANJAY_JSON_LIKE_VALUE_BOOL: {
+        bool value;
+        return _anjay_json_like_decoder_bool(decoder, &value);
+    }
+    case ANJAY_JSON_LIKE_VALUE_DOUBLE:
+    case ANJAY_JSON_LIKE_VALUE_FLOAT:
+    case ANJAY_JSON_LIKE_VALUE_NEGATIVE_INT:
+    case ANJAY_JSON_LIKE_VALUE_UINT: {
+        anjay_json_like_number_t number;
+        return _anjay_json_like_decoder_number(decoder, &number);
+    }
+    case ANJAY_JSON_LIKE_VALUE_BYTE_STRING:
+    case ANJAY_JSON_LIKE_VALUE_TEXT_STRING:
+        return decode_string(decoder);
+    case ANJAY_JSON_LIKE_VALUE_MAP:
+        return decode_compound(decoder, true);
+    case ANJAY_JSON_LIKE_VALUE_ARRAY:
+        return decode_compound(decoder, false);
+    default:
+        // null cannot be consumed using the decoder API
+        return -1;
+    }
+}
+
+static void replay_cbor_decoder(void *arg, const uint8_t *data, size_t size) {
+    (void) arg;
+    avs_stream_inbuf_t stream = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&stream, data, size);
+    anjay_json_like_decoder_t *decoder =
+            _anjay_cbor_decoder_new((avs_stream_t *) &stream,
+                                    MAX_LWM2M_CBOR_NEST_STACK_SIZE);
+    AVS_UNIT_ASSERT_NOT_NULL(decoder);
+    while (!decode_value(decoder)) {
+    }
+    _anjay_json_like_decoder_delete(&decoder);
+}
+
+AVS_UNIT_TEST(corpus_benchmark, cbor_decoder) {
+    bench_replay_corpus("cbor_decoder", replay_cbor_decoder, NULL);
+}
+#endif // ANJAY_WITH_CBOR
+
+/**
+ * Datagram socket that receives the current corpus entry once, and then times
+ * out. Everything that is sent is discarded.
+ */
+typedef struct {
+    const avs_net_socket_v_table_t *operations;
+    const uint8_t *data;
+    size_t size;
+    bool pending;
+    avs_time_duration_t recv_timeout;
+} replay_socket_t;
+
+static avs_error_t replay_socket_send(avs_net_socket_t *socket,
+                                      const void *buffer,
+                                      size_t buffer_length) {
+    (void) socket;
+    (void) buffer;
+    (void) buffer_length;
+    return AVS_OK;
+}
+
+static avs_error_t replay_socket_receive(avs_net_socket_t *socket_,
+                                         size_t *out_bytes_received,
+                                         void *buffer,
+                                         size_t buffer_length) {
+    replay_socket_t *socket = (replay_socket_t *) socket_;
+    if (!socket->pending) {
+        return avs_errno(AVS_ETIMEDOUT);
+    }
+    socket->pending = false;
+    *out_bytes_received = AVS_MIN(socket->size, buffer_length);
+    memcpy(buffer, socket->data, *out_bytes_received);
+    if (socket->size > buffer_length) {
+        return avs_errno(AVS_EMSGSIZE);
+    }
+    return AVS_OK;
+}
+
+static avs_error_t replay_socket_noop(avs_net_socket_t *socket) {
+    (void) socket;
+    return AVS_OK;
+}
+
+static avs_error_t replay_socket_cleanup(avs_net_socket_t **socket) {
+    // the socket is owned by the benchmark
+    *socket = NULL;
+    return AVS_OK;
+}
+
+static const void *replay_socket_system_socket(avs_net_socket_t *socket) {
+    return socket;
+}
+
+static avs_error_t replay_socket_get_opt(avs_net_socket_t *socket_,
+                                         avs_net_socket_opt_key_t option_key,
+                                         avs_net_socket_opt_value_t *out) {
+    replay_socket_t *socket = (replay_socket_t *) socket_;
+    switch (option_key) {
+    case AVS_NET_SOCKET_OPT_RECV_TIMEOUT:
+        out->recv_timeout = socket->recv_timeout;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_STATE:
+        out->state = AVS_NET_SOCKET_STATE_CONNECTED;
+        return AVS_OK;
+    case AVS_NET_SOCKET_OPT_INNER_MTU:
+        out->mtu = 1252;
+        return AVS_OK;
+    case AVS_NET_SOCKET_HAS_BUFFERED_DATA:
+        out->flag = false;
+        return AVS_OK;
+    default:
+        return avs_errno(AVS_ENOTSUP);
+    }
+}
+
+static avs_error_t replay_socket_set_opt(avs_net_socket_t *socket_,
+                                         avs_net_socket_opt_key_t option_key,
+                                         avs_net_socket_opt_value_t value) {
+    replay_socket_t *socket = (replay_socket_t *) socket_;
+    if (option_key == AVS_NET_SOCKET_OPT_RECV_TIMEOUT) {
+        socket->recv_timeout = value.recv_timeout;
+        return AVS_OK;
+    }
+    return avs_errno(AVS_ENOTSUP);
+}
+
+static const avs_net_socket_v_table_t REPLAY_SOCKET_VTABLE = {
+    .send = replay_socket_send,
+    .receive = replay_socket_receive,
+    .shutdown = replay_socket_noop,
+    .close = replay_socket_noop,
+    .cleanup = replay_socket_cleanup,
+    .get_system_socket = replay_socket_system_socket,
+    .get_opt = replay_socket_get_opt,
+    .set_opt = replay_socket_set_opt
+};
+
+typedef struct {
+    anjay_t *anjay;
+    replay_socket_t socket;
+} coap_replay_t;
+
+static void replay_coap_stream(void *arg, const uint8_t *data, size_t size) {
+    coap_replay_t *replay = (coap_replay_t *) arg;
+    replay->socket.data = data;
+    replay->socket.size = size;
+    replay->socket.pending = true;
+    (void) anjay_serve(replay->anjay, (avs_net_socket_t *) &replay->socket);
+    _anjay_test_dm_unsched_notify_clb(replay->anjay);
+}
+
+AVS_UNIT_TEST(corpus_benchmark, coap_stream) {
+    coap_replay_t replay = {
+        .socket = {
+            .operations = &REPLAY_SOCKET_VTABLE,
+            .recv_timeout = AVS_TIME_DURATION_ZERO
+        }
+    };
+    const anjay_dm_object_def_t *const *obj_defs[] = { &FAKE_SECURITY };
+    DM_TEST_INIT_OBJECTS__(obj_defs, DM_TEST_CONFIGURATION());
+    replay.anjay = anjay;
+    _anjay_test_dm_attach_socket(anjay, 1,
+                                 (avs_net_socket_t *) &replay.socket);
+    DM_TEST_POST_INIT__;
+    // the mock clock would freeze the measured time
+    _anjay_mock_clock_finish();
+
+    bench_replay_corpus("coap_stream", replay_coap_stream, &replay);
+
+    anjay_delete(anjay);
+    _anjay_mock_dm_expect_clean();
+}
+
+#if defined(ANJAY_WITH_MODULE_FACTORY_PROVISIONING) \
+        && defined(ANJAY_WITH_MODULE_SECURITY)      \
+        && defined(ANJAY_WITH_MODULE_SERVER)
+static void replay_factory_prov(void *arg, const uint8_t *data, size_t size) {
+    anjay_t *anjay = (anjay_t *) arg;
+    avs_stream_inbuf_t stream = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&stream, data, size);
+    (void) anjay_factory_provision(anjay, (avs_stream_t *) &stream);
+    _anjay_test_dm_unsched_reload_sockets(anjay);
+    _anjay_test_dm_unsched_notify_clb(anjay);
+}
+
+AVS_UNIT_TEST(corpus_benchmark, factory_prov) {
+    anjay_t *anjay = _anjay_test_dm_init(DM_TEST_CONFIGURATION());
+    AVS_UNIT_ASSERT_SUCCESS(anjay_security_object_install(anjay));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_install(anjay));
+    _anjay_mock_clock_finish();
+
+    bench_replay_corpus("factory_prov", replay_factory_prov, anjay);
+
+    anjay_delete(anjay);
+}
+#endif // defined(ANJAY_WITH_MODULE_FACTORY_PROVISIONING) &&
+       // defined(ANJAY_WITH_MODULE_SECURITY) &&
+       // defined(ANJAY_WITH_MODULE_SERVER)
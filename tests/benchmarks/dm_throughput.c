@@ -0,0 +1,414 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+/**
+ * Throughput benchmarks of the request path: each case feeds a stream of
+ * requests of a single kind through a mock socket and measures the time spent
+ * in anjay_serve() for each of them.
+ *
+ * The synthetic object can be resized using environment variables:
+ * - ANJAY_BENCHMARK_ITERATIONS - number of requests per case,
+ * - ANJAY_BENCHMARK_INSTANCES - number of Object Instances,
+ * - ANJAY_BENCHMARK_RESOURCES - number of integer Resources per Instance.
+ *
+ * Allocations per request are only reported if the library is built with
+ * WITH_MEMORY_ACCOUNTING.
+ */
+
+#include <anjay_init.h>
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#define AVS_UNIT_ENABLE_SHORT_ASSERTS
+#include <avsystem/commons/avs_unit_mocksock.h>
+#include <avsystem/commons/avs_unit_test.h>
+#include <avsystem/commons/avs_utils.h>
+
+#include <anjay/stats.h>
+
+#include "tests/benchmarks/utils.h"
+#include "tests/core/coap/utils.h"
+#include "tests/utils/dm.h"
+
+#define BENCH_OID 4242
+
+#define BENCH_DEFAULT_ITERATIONS 5000
+#define BENCH_DEFAULT_INSTANCES 16
+#define BENCH_DEFAULT_RESOURCES 16
+
+// Message IDs must not repeat within a case
+#define BENCH_MAX_ITERATIONS UINT16_MAX
+#define BENCH_MAX_INSTANCES 1000
+// Keeps all responses within a single datagram
+#define BENCH_MAX_RESOURCES 50
+// Number of paths requested in a single Read-Composite
+#define BENCH_MAX_COMPOSITE_PATHS 16
+
+static struct {
+    size_t iterations;
+    anjay_iid_t instances;
+    anjay_rid_t resources;
+    int32_t *values;
+} BENCH;
+
+static anjay_rid_t bench_execute_rid(void) {
+    return BENCH.resources;
+}
+
+static int32_t *bench_value(anjay_iid_t iid, anjay_rid_t rid) {
+    return &BENCH.values[(size_t) iid * BENCH.resources + rid];
+}
+
+static int bench_list_instances(anjay_t *anjay,
+                                const anjay_dm_object_def_t *const *obj_ptr,
+                                anjay_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    for (anjay_iid_t iid = 0; iid < BENCH.instances; ++iid) {
+        anjay_dm_emit(ctx, iid);
+    }
+    return 0;
+}
+
+static int bench_list_resources(anjay_t *anjay,
+                                const anjay_dm_object_def_t *const *obj_ptr,
+                                anjay_iid_t iid,
+                                anjay_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+    for (anjay_rid_t rid = 0; rid < BENCH.resources; ++rid) {
+        anjay_dm_emit_res(ctx, rid, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT);
+    }
+    anjay_dm_emit_res(ctx, bench_execute_rid(), ANJAY_DM_RES_E,
+                      ANJAY_DM_RES_PRESENT);
+    return 0;
+}
+
+static int bench_resource_read(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               anjay_riid_t riid,
+                               anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) riid;
+    return anjay_ret_i32(ctx, *bench_value(iid, rid));
+}
+
+static int bench_resource_write(anjay_t *anjay,
+                                const anjay_dm_object_def_t *const *obj_ptr,
+                                anjay_iid_t iid,
+                                anjay_rid_t rid,
+                                anjay_riid_t riid,
+                                anjay_input_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) riid;
+    return anjay_get_i32(ctx, bench_value(iid, rid));
+}
+
+static int bench_resource_execute(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  anjay_execute_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+    (void) rid;
+    (void) ctx;
+    return 0;
+}
+
+static const anjay_dm_object_def_t *const BENCH_OBJ =
+        &(const anjay_dm_object_def_t) {
+            .oid = BENCH_OID,
+            .handlers = {
+                .list_instances = bench_list_instances,
+                .list_resources = bench_list_resources,
+                .resource_read = bench_resource_read,
+                .resource_write = bench_resource_write,
+                .resource_execute = bench_resource_execute,
+                .transaction_begin = anjay_dm_transaction_NOOP,
+                .transaction_validate = anjay_dm_transaction_NOOP,
+                .transaction_commit = anjay_dm_transaction_NOOP,
+                .transaction_rollback = anjay_dm_transaction_NOOP
+            }
+        };
+
+static void bench_setup(void) {
+    BENCH.iterations = _anjay_bench_env_size("ANJAY_BENCHMARK_ITERATIONS",
+                                             BENCH_DEFAULT_ITERATIONS,
+                                             BENCH_MAX_ITERATIONS);
+    BENCH.instances = (anjay_iid_t) _anjay_bench_env_size(
+            "ANJAY_BENCHMARK_INSTANCES", BENCH_DEFAULT_INSTANCES,
+            BENCH_MAX_INSTANCES);
+    BENCH.resources = (anjay_rid_t) _anjay_bench_env_size(
+            "ANJAY_BENCHMARK_RESOURCES", BENCH_DEFAULT_RESOURCES,
+            BENCH_MAX_RESOURCES);
+    BENCH.values = (int32_t *) avs_calloc((size_t) BENCH.instances
+                                                  * BENCH.resources,
+                                          sizeof(int32_t));
+    AVS_UNIT_ASSERT_NOT_NULL(BENCH.values);
+    for (anjay_iid_t iid = 0; iid < BENCH.instances; ++iid) {
+        for (anjay_rid_t rid = 0; rid < BENCH.resources; ++rid) {
+            // small enough to be encoded in a single byte in TLV
+            *bench_value(iid, rid) = (int32_t) ((iid + rid) % 100);
+        }
+    }
+}
+
+static void bench_teardown(void) {
+    avs_free(BENCH.values);
+    BENCH.values = NULL;
+}
+
+/**
+ * Enqueues the request with a given message ID on the mock socket, together
+ * with the expected response. Called outside of the measured section.
+ */
+typedef void bench_prepare_t(avs_net_socket_t *mocksock,
+                             uint16_t msg_id,
+                             size_t iteration);
+
+static void bench_run(const char *name,
+                      anjay_t *anjay,
+                      avs_net_socket_t *mocksock,
+                      bench_prepare_t *prepare) {
+    int64_t *latencies_ns =
+            (int64_t *) avs_calloc(BENCH.iterations, sizeof(int64_t));
+    AVS_UNIT_ASSERT_NOT_NULL(latencies_ns);
+
+    // the mock clock would freeze the measured time
+    _anjay_mock_clock_finish();
+
+    size_t allocations = 0;
+    const bool allocations_available =
+            _anjay_bench_total_allocations(&allocations);
+    allocations = 0;
+    anjay_reset_allocation_sites();
+    int64_t total_ns = 0;
+    for (size_t i = 0; i < BENCH.iterations; ++i) {
+        prepare(mocksock, (uint16_t) i, i);
+        expect_has_buffered_data_check(mocksock, false);
+
+        size_t allocations_before;
+        size_t allocations_after;
+        (void) _anjay_bench_total_allocations(&allocations_before);
+        avs_time_monotonic_t start = avs_time_monotonic_now();
+        AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksock));
+        latencies_ns[i] = _anjay_bench_elapsed_ns(start);
+        (void) _anjay_bench_total_allocations(&allocations_after);
+        allocations += allocations_after - allocations_before;
+        total_ns += latencies_ns[i];
+        // notifications are not the subject of this benchmark
+        _anjay_test_dm_unsched_notify_clb(anjay);
+    }
+
+    _anjay_mock_clock_start(avs_time_monotonic_now());
+
+    printf("%-14s %6u inst %3u res: %9.0f req/s, ", name,
+           (unsigned) BENCH.instances, (unsigned) BENCH.resources,
+           total_ns > 0 ? (double) BENCH.iterations * 1e9 / (double) total_ns
+                        : 0.0);
+    if (allocations_available) {
+        printf("%6.1f allocs/req, ",
+               (double) allocations / (double) BENCH.iterations);
+    } else {
+        printf("   n/a allocs/req, ");
+    }
+    printf("p50 %8.1f us, ",
+           _anjay_bench_percentile_us(latencies_ns, BENCH.iterations, 50));
+    printf("p99 %8.1f us\n",
+           _anjay_bench_percentile_us(latencies_ns, BENCH.iterations, 99));
+    _anjay_bench_print_allocation_sites(BENCH.iterations, "req");
+    avs_free(latencies_ns);
+}
+
+#define BENCH_INIT                                                            \
+    bench_setup();                                                            \
+    DM_TEST_INIT_WITH_OBJECTS(&BENCH_OBJ, &FAKE_SECURITY, &FAKE_SERVER)
+
+#define BENCH_FINISH \
+    DM_TEST_FINISH;  \
+    bench_teardown()
+
+static char *path_segment(char (*buf)[8], unsigned id) {
+    AVS_UNIT_ASSERT_TRUE(avs_simple_snprintf(*buf, sizeof(*buf), "%u", id)
+                         >= 0);
+    return *buf;
+}
+
+static void
+appendf(char *buf, size_t size, size_t *inout_length, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int result = vsnprintf(buf + *inout_length, size - *inout_length, fmt, ap);
+    va_end(ap);
+    AVS_UNIT_ASSERT_TRUE(result >= 0
+                         && (size_t) result < size - *inout_length);
+    *inout_length += (size_t) result;
+}
+
+#ifndef ANJAY_WITHOUT_TLV
+static void prepare_read(avs_net_socket_t *mocksock,
+                         uint16_t msg_id,
+                         size_t iteration) {
+    anjay_iid_t iid = (anjay_iid_t) (iteration % BENCH.instances);
+    char oid_str[8];
+    char iid_str[8];
+    DM_TEST_REQUEST(mocksock, CON, GET, ID(msg_id),
+                    PATH(path_segment(&oid_str, BENCH_OID),
+                         path_segment(&iid_str, iid)),
+                    ACCEPT(AVS_COAP_FORMAT_OMA_LWM2M_TLV), NO_PAYLOAD);
+
+    uint8_t payload[3 * BENCH_MAX_RESOURCES];
+    size_t payload_size = 0;
+    for (anjay_rid_t rid = 0; rid < BENCH.resources; ++rid) {
+        // type: Resource with 8-bit ID and 1 byte of value
+        payload[payload_size++] = 0xC1;
+        payload[payload_size++] = (uint8_t) rid;
+        payload[payload_size++] = (uint8_t) *bench_value(iid, rid);
+    }
+    DM_TEST_EXPECT_RESPONSE(mocksock, ACK, CONTENT, ID(msg_id),
+                            CONTENT_FORMAT(OMA_LWM2M_TLV),
+                            PAYLOAD_EXTERNAL(payload, payload_size));
+}
+
+AVS_UNIT_TEST(dm_benchmark, read_instance) {
+    BENCH_INIT;
+    bench_run("read", anjay, mocksocks[0], prepare_read);
+    BENCH_FINISH;
+}
+#endif // ANJAY_WITHOUT_TLV
+
+static void prepare_write(avs_net_socket_t *mocksock,
+                          uint16_t msg_id,
+                          size_t iteration) {
+    anjay_iid_t iid = (anjay_iid_t) (iteration % BENCH.instances);
+    anjay_rid_t rid = (anjay_rid_t) (iteration % BENCH.resources);
+    char oid_str[8];
+    char iid_str[8];
+    char rid_str[8];
+    char payload[16];
+    size_t payload_size = 0;
+    appendf(payload, sizeof(payload), &payload_size, "%" PRId32,
+            *bench_value(iid, rid));
+    DM_TEST_REQUEST(mocksock, CON, PUT, ID(msg_id),
+                    PATH(path_segment(&oid_str, BENCH_OID),
+                         path_segment(&iid_str, iid),
+                         path_segment(&rid_str, rid)),
+                    CONTENT_FORMAT(PLAINTEXT),
+                    PAYLOAD_EXTERNAL(payload, payload_size));
+    DM_TEST_EXPECT_RESPONSE(mocksock, ACK, CHANGED, ID(msg_id), NO_PAYLOAD);
+}
+
+AVS_UNIT_TEST(dm_benchmark, write_resource) {
+    BENCH_INIT;
+    bench_run("write", anjay, mocksocks[0], prepare_write);
+    BENCH_FINISH;
+}
+
+#if defined(ANJAY_WITH_LWM2M11) && defined(ANJAY_WITH_SENML_JSON) \
+        && !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+static void prepare_read_composite(avs_net_socket_t *mocksock,
+                                   uint16_t msg_id,
+                                   size_t iteration) {
+    (void) iteration;
+    // Resource 0 of each of the first Instances; names are short enough that
+    // no basename is used in the response
+    size_t path_count = AVS_MIN(BENCH.instances, BENCH_MAX_COMPOSITE_PATHS);
+    char request[32 * BENCH_MAX_COMPOSITE_PATHS];
+    char response[48 * BENCH_MAX_COMPOSITE_PATHS];
+    size_t request_size = 0;
+    size_t response_size = 0;
+    for (size_t i = 0; i < path_count; ++i) {
+        const char *separator = i ? "," : "[";
+        appendf(request, sizeof(request), &request_size,
+                "%s{\"n\":\"/%u/%u/0\"}", separator, (unsigned) BENCH_OID,
+                (unsigned) i);
+        appendf(response, sizeof(response), &response_size,
+                "%s{\"n\":\"/%u/%u/0\",\"v\":%" PRId32 "}", separator,
+                (unsigned) BENCH_OID, (unsigned) i,
+                *bench_value((anjay_iid_t) i, 0));
+    }
+    appendf(request, sizeof(request), &request_size, "]");
+    appendf(response, sizeof(response), &response_size, "]");
+    DM_TEST_REQUEST(mocksock, CON, FETCH, ID(msg_id),
+                    CONTENT_FORMAT(SENML_JSON),
+                    ACCEPT(AVS_COAP_FORMAT_SENML_JSON),
+                    PAYLOAD_EXTERNAL(request, request_size));
+    DM_TEST_EXPECT_RESPONSE(mocksock, ACK, CONTENT, ID(msg_id),
+                            CONTENT_FORMAT(SENML_JSON),
+                            PAYLOAD_EXTERNAL(response, response_size));
+}
+
+AVS_UNIT_TEST(dm_benchmark, read_composite) {
+    BENCH_INIT;
+    bench_run("read-composite", anjay, mocksocks[0], prepare_read_composite);
+    BENCH_FINISH;
+}
+#endif // defined(ANJAY_WITH_LWM2M11) && defined(ANJAY_WITH_SENML_JSON) &&
+       // !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+
+#ifdef ANJAY_WITH_DISCOVER
+static void prepare_discover(avs_net_socket_t *mocksock,
+                             uint16_t msg_id,
+                             size_t iteration) {
+    anjay_iid_t iid = (anjay_iid_t) (iteration % BENCH.instances);
+    char oid_str[8];
+    char iid_str[8];
+    DM_TEST_REQUEST(mocksock, CON, GET, ID(msg_id),
+                    PATH(path_segment(&oid_str, BENCH_OID),
+                         path_segment(&iid_str, iid)),
+                    ACCEPT(0x28), NO_PAYLOAD);
+
+    char payload[24 * (BENCH_MAX_RESOURCES + 2)];
+    size_t payload_size = 0;
+    appendf(payload, sizeof(payload), &payload_size, "</%u/%u>",
+            (unsigned) BENCH_OID, (unsigned) iid);
+    for (anjay_rid_t rid = 0; rid <= bench_execute_rid(); ++rid) {
+        appendf(payload, sizeof(payload), &payload_size, ",</%u/%u/%u>",
+                (unsigned) BENCH_OID, (unsigned) iid, (unsigned) rid);
+    }
+    DM_TEST_EXPECT_RESPONSE(mocksock, ACK, CONTENT, ID(msg_id),
+                            CONTENT_FORMAT(LINK_FORMAT),
+                            PAYLOAD_EXTERNAL(payload, payload_size));
+}
+
+AVS_UNIT_TEST(dm_benchmark, discover_instance) {
+    BENCH_INIT;
+    bench_run("discover", anjay, mocksocks[0], prepare_discover);
+    BENCH_FINISH;
+}
+#endif // ANJAY_WITH_DISCOVER
+
+static void prepare_execute(avs_net_socket_t *mocksock,
+                            uint16_t msg_id,
+                            size_t iteration) {
+    anjay_iid_t iid = (anjay_iid_t) (iteration % BENCH.instances);
+    char oid_str[8];
+    char iid_str[8];
+    char rid_str[8];
+    DM_TEST_REQUEST(mocksock, CON, POST, ID(msg_id),
+                    PATH(path_segment(&oid_str, BENCH_OID),
+                         path_segment(&iid_str, iid),
+                         path_segment(&rid_str, bench_execute_rid())));
+    DM_TEST_EXPECT_RESPONSE(mocksock, ACK, CHANGED, ID(msg_id), NO_PAYLOAD);
+}
+
+AVS_UNIT_TEST(dm_benchmark, execute) {
+    BENCH_INIT;
+    bench_run("execute", anjay, mocksocks[0], prepare_execute);
+    BENCH_FINISH;
+}
@@ -0,0 +1,342 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+/**
+ * Micro-benchmarks of the payload encoders and decoders: each case serializes
+ * a payload of a given shape using the output context for a given
+ * Content-Format, parses the result back using the matching input context,
+ * and reports the throughput of both directions in bytes of encoded payload
+ * per second.
+ *
+ * The following payload shapes are used:
+ * - single_int - a single integer Resource, as in a Read on a Resource,
+ * - single_bytes - a single 256-byte opaque Resource,
+ * - large_instance - an Object Instance with 256 Resources, alternately
+ *   integers and strings, as in a Read on an Object Instance,
+ * - composite - 1000 Resources spread over 100 Object Instances, as in a
+ *   Read-Composite (encoding) or Write-Composite (decoding) on all of them.
+ *
+ * Combinations not supported by a given format (e.g. multiple values in plain
+ * text) are skipped. Formats for which Anjay has no input context (e.g. LwM2M
+ * CBOR) are only benchmarked for encoding.
+ *
+ * The number of iterations per case can be set using the
+ * ANJAY_BENCHMARK_ITERATIONS environment variable.
+ *
+ * Allocations per operation are only reported if the library is built with
+ * WITH_MEMORY_ACCOUNTING.
+ */
+
+#include <anjay_init.h>
+
+#include <stdio.h>
+
+#define AVS_UNIT_ENABLE_SHORT_ASSERTS
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_stream_inbuf.h>
+#include <avsystem/commons/avs_stream_outbuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+#include <avsystem/commons/avs_utils.h>
+
+#include "src/core/anjay_io_core.h"
+#include "tests/benchmarks/utils.h"
+
+#define BENCH_OID 4242
+
+#define BENCH_DEFAULT_ITERATIONS 2000
+#define BENCH_MAX_ITERATIONS 1000000
+
+// Enough for the largest payload, i.e. the composite one in SenML JSON
+#define BENCH_MAX_PAYLOAD_SIZE (128 * 1024)
+
+#define BENCH_STRING_VALUE "0123456789abcdef"
+#define BENCH_BYTES_SIZE 256
+
+typedef enum {
+    BENCH_VALUE_INT,
+    BENCH_VALUE_STRING,
+    BENCH_VALUE_BYTES
+} bench_value_kind_t;
+
+typedef struct {
+    const char *name;
+    anjay_uri_path_t uri;
+    anjay_request_action_t encode_action;
+    anjay_request_action_t decode_action;
+    // Paths of the entries are /BENCH_OID/iid/rid for each iid < instances
+    // and rid < resources
+    anjay_iid_t instances;
+    anjay_rid_t resources;
+    // If false, even Resources are integers and odd ones are strings
+    bool bytes;
+} bench_payload_t;
+
+typedef struct {
+    const char *name;
+    uint16_t format;
+} bench_format_t;
+
+static const bench_format_t BENCH_FORMATS[] = {
+    { "opaque", AVS_COAP_FORMAT_OCTET_STREAM },
+    { "text", AVS_COAP_FORMAT_PLAINTEXT },
+    { "cbor", AVS_COAP_FORMAT_CBOR },
+    { "tlv", AVS_COAP_FORMAT_OMA_LWM2M_TLV },
+    { "senml_json", AVS_COAP_FORMAT_SENML_JSON },
+    { "senml_cbor", AVS_COAP_FORMAT_SENML_CBOR },
+    { "lwm2m_cbor", AVS_COAP_FORMAT_OMA_LWM2M_CBOR }
+};
+
+static uint8_t BENCH_BYTES[BENCH_BYTES_SIZE];
+
+static bench_value_kind_t value_kind(const bench_payload_t *payload,
+                                     anjay_rid_t rid) {
+    if (payload->bytes) {
+        return BENCH_VALUE_BYTES;
+    }
+    return rid % 2 ? BENCH_VALUE_STRING : BENCH_VALUE_INT;
+}
+
+static size_t entry_count(const bench_payload_t *payload) {
+    return (size_t) payload->instances * payload->resources;
+}
+
+static int ret_value(anjay_unlocked_output_ctx_t *out,
+                     const bench_payload_t *payload,
+                     anjay_iid_t iid,
+                     anjay_rid_t rid) {
+    switch (value_kind(payload, rid)) {
+    case BENCH_VALUE_INT:
+        return _anjay_ret_i64_unlocked(out, (int64_t) iid * 1000 + rid);
+    case BENCH_VALUE_STRING:
+        return _anjay_ret_string_unlocked(out, BENCH_STRING_VALUE);
+    case BENCH_VALUE_BYTES:
+        return _anjay_ret_bytes_unlocked(out, BENCH_BYTES, sizeof(BENCH_BYTES));
+    }
+    AVS_UNREACHABLE("invalid value kind");
+    return -1;
+}
+
+static int encode_payload(const bench_payload_t *payload,
+                          uint16_t format,
+                          avs_stream_t *stream) {
+    const size_t items_count = entry_count(payload);
+    anjay_unlocked_output_ctx_t *out = NULL;
+    int result = _anjay_output_dynamic_construct(&out, stream, &payload->uri,
+                                                 format, &items_count,
+                                                 payload->encode_action);
+    if (result) {
+        return result;
+    }
+    for (anjay_iid_t iid = 0; !result && iid < payload->instances; ++iid) {
+        for (anjay_rid_t rid = 0; !result && rid < payload->resources; ++rid) {
+            (void) ((result = _anjay_output_set_path(
+                             out, &MAKE_RESOURCE_PATH(BENCH_OID, iid, rid)))
+                    || (result = ret_value(out, payload, iid, rid)));
+        }
+    }
+    return _anjay_output_ctx_destroy_and_process_result(&out, result);
+}
+
+static int get_value(anjay_unlocked_input_ctx_t *in,
+                     const bench_payload_t *payload,
+                     anjay_rid_t rid) {
+    switch (value_kind(payload, rid)) {
+    case BENCH_VALUE_INT: {
+        int64_t value;
+        return _anjay_get_i64_unlocked(in, &value);
+    }
+    case BENCH_VALUE_STRING: {
+        char value[sizeof(BENCH_STRING_VALUE)];
+        return _anjay_get_string_unlocked(in, value, sizeof(value));
+    }
+    case BENCH_VALUE_BYTES: {
+        uint8_t value[BENCH_BYTES_SIZE];
+        bool message_finished = false;
+        int result = 0;
+        while (!result && !message_finished) {
+            size_t bytes_read;
+            result = _anjay_get_bytes_unlocked(in, &bytes_read,
+                                               &message_finished, value,
+                                               sizeof(value));
+        }
+        return result;
+    }
+    }
+    AVS_UNREACHABLE("invalid value kind");
+    return -1;
+}
+
+static int decode_payload(const bench_payload_t *payload,
+                          uint16_t format,
+                          avs_stream_t *stream) {
+    anjay_unlocked_input_ctx_t *in = NULL;
+    int result = _anjay_input_dynamic_construct_raw(&in, stream, format,
+                                                    payload->decode_action,
+                                                    &payload->uri);
+    if (result || !in) {
+        return result ? result : -1;
+    }
+    size_t entries = 0;
+    anjay_uri_path_t path;
+    while (!(result = _anjay_input_get_path(in, &path, NULL))) {
+        if ((result = get_value(in, payload, path.ids[ANJAY_ID_RID]))
+                || (result = _anjay_input_next_entry(in))) {
+            break;
+        }
+        ++entries;
+    }
+    if (result == ANJAY_GET_PATH_END) {
+        result = (entries == entry_count(payload)) ? 0 : -1;
+    }
+    int destroy_result = _anjay_input_ctx_destroy(&in);
+    return result ? result : destroy_result;
+}
+
+typedef struct {
+    int64_t total_ns;
+    size_t allocations;
+} bench_result_t;
+
+static void print_result(const char *direction,
+                         const bench_result_t *result,
+                         size_t iterations,
+                         size_t payload_size,
+                         bool allocations_available) {
+    printf("%s %8.1f MB/s, ", direction,
+           result->total_ns > 0 ? (double) payload_size * (double) iterations
+                                          * 1e3 / (double) result->total_ns
+                                : 0.0);
+    if (allocations_available) {
+        printf("%6.1f allocs/op", (double) result->allocations
+                                          / (double) iterations);
+    } else {
+        printf("   n/a allocs/op");
+    }
+}
+
+static void bench_run(const bench_payload_t *payload) {
+    const size_t iterations =
+            _anjay_bench_env_size("ANJAY_BENCHMARK_ITERATIONS",
+                                  BENCH_DEFAULT_ITERATIONS,
+                                  BENCH_MAX_ITERATIONS);
+    for (size_t i = 0; i < sizeof(BENCH_BYTES); ++i) {
+        BENCH_BYTES[i] = (uint8_t) i;
+    }
+    char *buffer = (char *) avs_malloc(BENCH_MAX_PAYLOAD_SIZE);
+    AVS_UNIT_ASSERT_NOT_NULL(buffer);
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(BENCH_FORMATS); ++i) {
+        const bench_format_t *format = &BENCH_FORMATS[i];
+        avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;
+        avs_stream_outbuf_set_buffer(&outbuf, buffer, BENCH_MAX_PAYLOAD_SIZE);
+        avs_stream_inbuf_t inbuf = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+
+        // unmeasured run, to check if the combination is supported at all
+        if (encode_payload(payload, format->format,
+                           (avs_stream_t *) &outbuf)) {
+            continue;
+        }
+        const size_t payload_size = avs_stream_outbuf_offset(&outbuf);
+        avs_stream_inbuf_set_buffer(&inbuf, buffer, payload_size);
+        const bool decode_supported =
+                !decode_payload(payload, format->format,
+                                (avs_stream_t *) &inbuf);
+
+        size_t allocations;
+        const bool allocations_available =
+                _anjay_bench_total_allocations(&allocations);
+        bench_result_t encode = { 0 };
+        bench_result_t decode = { 0 };
+        for (size_t iteration = 0; iteration < iterations; ++iteration) {
+            avs_stream_outbuf_set_buffer(&outbuf, buffer,
+                                         BENCH_MAX_PAYLOAD_SIZE);
+            size_t allocations_before;
+            size_t allocations_after;
+            (void) _anjay_bench_total_allocations(&allocations_before);
+            avs_time_monotonic_t start = avs_time_monotonic_now();
+            AVS_UNIT_ASSERT_SUCCESS(encode_payload(payload, format->format,
+                                                   (avs_stream_t *) &outbuf));
+            encode.total_ns += _anjay_bench_elapsed_ns(start);
+            (void) _anjay_bench_total_allocations(&allocations_after);
+            encode.allocations += allocations_after - allocations_before;
+
+            if (decode_supported) {
+                avs_stream_inbuf_set_buffer(&inbuf, buffer, payload_size);
+                (void) _anjay_bench_total_allocations(&allocations_before);
+                start = avs_time_monotonic_now();
+                AVS_UNIT_ASSERT_SUCCESS(decode_payload(
+                        payload, format->format, (avs_stream_t *) &inbuf));
+                decode.total_ns += _anjay_bench_elapsed_ns(start);
+                (void) _anjay_bench_total_allocations(&allocations_after);
+                decode.allocations += allocations_after - allocations_before;
+            }
+        }
+
+        printf("%-14s %-10s %6u B: ", payload->name, format->name,
+               (unsigned) payload_size);
+        print_result("encode", &encode, iterations, payload_size,
+                     allocations_available);
+        if (decode_supported) {
+            print_result("; decode", &decode, iterations, payload_size,
+                         allocations_available);
+        } else {
+            printf("; decode      n/a");
+        }
+        printf("\n");
+    }
+    avs_free(buffer);
+}
+
+AVS_UNIT_TEST(io_benchmark, single_int) {
+    bench_run(&(const bench_payload_t) {
+        .name = "single_int",
+        .uri = MAKE_RESOURCE_PATH(BENCH_OID, 0, 0),
+        .encode_action = ANJAY_ACTION_READ,
+        .decode_action = ANJAY_ACTION_WRITE,
+        .instances = 1,
+        .resources = 1
+    });
+}
+
+AVS_UNIT_TEST(io_benchmark, single_bytes) {
+    bench_run(&(const bench_payload_t) {
+        .name = "single_bytes",
+        .uri = MAKE_RESOURCE_PATH(BENCH_OID, 0, 0),
+        .encode_action = ANJAY_ACTION_READ,
+        .decode_action = ANJAY_ACTION_WRITE,
+        .instances = 1,
+        .resources = 1,
+        .bytes = true
+    });
+}
+
+AVS_UNIT_TEST(io_benchmark, large_instance) {
+    bench_run(&(const bench_payload_t) {
+        .name = "large_instance",
+        .uri = MAKE_INSTANCE_PATH(BENCH_OID, 0),
+        .encode_action = ANJAY_ACTION_READ,
+        .decode_action = ANJAY_ACTION_WRITE,
+        .instances = 1,
+        .resources = 256
+    });
+}
+
+#if defined(ANJAY_WITH_LWM2M11) && !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+AVS_UNIT_TEST(io_benchmark, composite) {
+    bench_run(&(const bench_payload_t) {
+        .name = "composite",
+        .uri = MAKE_ROOT_PATH(),
+        .encode_action = ANJAY_ACTION_READ_COMPOSITE,
+        .decode_action = ANJAY_ACTION_WRITE_COMPOSITE,
+        .instances = 100,
+        .resources = 10
+    });
+}
+#endif // defined(ANJAY_WITH_LWM2M11) &&
+       // !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
@@ -0,0 +1,359 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+/**
+ * Scalability benchmark of the observe subsystem: N observations are spread
+ * among M servers, which all observe the same set of Resources, and then
+ * bursts of anjay_notify_changed() calls are processed.
+ *
+ * Parameters are set using environment variables:
+ * - ANJAY_BENCHMARK_OBSERVATIONS - total number of observations (N),
+ * - ANJAY_BENCHMARK_SERVERS - number of servers (M),
+ * - ANJAY_BENCHMARK_BURSTS - number of notification bursts,
+ * - ANJAY_BENCHMARK_BURST_SIZE - number of Resources changed in each burst.
+ *
+ * Notifications are stored instead of being sent, as if the servers were
+ * waiting for an Update - this makes the benchmark independent from the
+ * encoding of outgoing messages. Queued notifications are merged, so the
+ * queue never exceeds one value per observation.
+ *
+ * Memory usage is only reported if the library is built with
+ * WITH_MEMORY_ACCOUNTING, and time spent in observe scheduler jobs only with
+ * WITH_SCHED_STATS. Sizes of the per-observation records are always reported,
+ * as a lower bound of the memory usage that does not include allocator
+ * overhead.
+ */
+
+#include <anjay_init.h>
+
+#include <inttypes.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#define AVS_UNIT_ENABLE_SHORT_ASSERTS
+#include <avsystem/commons/avs_unit_mocksock.h>
+#include <avsystem/commons/avs_unit_test.h>
+#include <avsystem/commons/avs_utils.h>
+
+#include <anjay/stats.h>
+
+#include "src/core/anjay_core.h"
+#include "src/core/observe/anjay_observe_internal.h"
+#include "src/core/servers/anjay_servers_internal.h"
+#include "tests/benchmarks/utils.h"
+#include "tests/core/coap/utils.h"
+#include "tests/utils/dm.h"
+#include "tests/utils/mock_clock.h"
+
+#ifdef ANJAY_WITH_OBSERVE
+
+#    define BENCH_OID 4242
+#    define BENCH_RESOURCES_PER_INSTANCE 10
+
+#    define BENCH_DEFAULT_OBSERVATIONS 1000
+#    define BENCH_DEFAULT_SERVERS 4
+#    define BENCH_DEFAULT_BURSTS 100
+#    define BENCH_DEFAULT_BURST_SIZE 50
+
+// Message IDs of requests from a single server must not repeat
+#    define BENCH_MAX_OBSERVATIONS_PER_SERVER UINT16_MAX
+#    define BENCH_MAX_SERVERS 64
+#    define BENCH_MAX_BURSTS 100000
+
+static struct {
+    size_t observations;
+    size_t servers;
+    size_t bursts;
+    size_t burst_size;
+    // number of distinct observed paths, each observed by all servers
+    size_t paths;
+} BENCH;
+
+static anjay_iid_t path_iid(size_t path_index) {
+    return (anjay_iid_t) (path_index / BENCH_RESOURCES_PER_INSTANCE);
+}
+
+static anjay_rid_t path_rid(size_t path_index) {
+    return (anjay_rid_t) (path_index % BENCH_RESOURCES_PER_INSTANCE);
+}
+
+static int32_t path_value(size_t path_index) {
+    return (int32_t) (path_index % 1000);
+}
+
+static int bench_list_instances(anjay_t *anjay,
+                                const anjay_dm_object_def_t *const *obj_ptr,
+                                anjay_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    size_t instances = (BENCH.paths + BENCH_RESOURCES_PER_INSTANCE - 1)
+                       / BENCH_RESOURCES_PER_INSTANCE;
+    for (size_t iid = 0; iid < instances; ++iid) {
+        anjay_dm_emit(ctx, (anjay_iid_t) iid);
+    }
+    return 0;
+}
+
+static int bench_list_resources(anjay_t *anjay,
+                                const anjay_dm_object_def_t *const *obj_ptr,
+                                anjay_iid_t iid,
+                                anjay_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+    for (anjay_rid_t rid = 0; rid < BENCH_RESOURCES_PER_INSTANCE; ++rid) {
+        anjay_dm_emit_res(ctx, rid, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT);
+    }
+    return 0;
+}
+
+static int bench_resource_read(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid,
+                               anjay_riid_t riid,
+                               anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) riid;
+    return anjay_ret_i32(
+            ctx,
+            path_value((size_t) iid * BENCH_RESOURCES_PER_INSTANCE + rid));
+}
+
+static const anjay_dm_object_def_t *const BENCH_OBJ =
+        &(const anjay_dm_object_def_t) {
+            .oid = BENCH_OID,
+            .handlers = {
+                .list_instances = bench_list_instances,
+                .list_resources = bench_list_resources,
+                .resource_read = bench_resource_read
+            }
+        };
+
+static void bench_setup(void) {
+    BENCH.servers = _anjay_bench_env_size("ANJAY_BENCHMARK_SERVERS",
+                                          BENCH_DEFAULT_SERVERS,
+                                          BENCH_MAX_SERVERS);
+    BENCH.observations = _anjay_bench_env_size(
+            "ANJAY_BENCHMARK_OBSERVATIONS", BENCH_DEFAULT_OBSERVATIONS,
+            BENCH.servers * BENCH_MAX_OBSERVATIONS_PER_SERVER);
+    BENCH.bursts = _anjay_bench_env_size(
+            "ANJAY_BENCHMARK_BURSTS", BENCH_DEFAULT_BURSTS, BENCH_MAX_BURSTS);
+    BENCH.paths = (BENCH.observations + BENCH.servers - 1) / BENCH.servers;
+    BENCH.burst_size = _anjay_bench_env_size(
+            "ANJAY_BENCHMARK_BURST_SIZE",
+            AVS_MIN(BENCH_DEFAULT_BURST_SIZE, BENCH.paths), BENCH.paths);
+}
+
+static avs_coap_token_t observation_token(size_t path_index) {
+    avs_coap_token_t token = {
+        .size = sizeof(uint64_t)
+    };
+    uint64_t value = avs_convert_be64((uint64_t) path_index);
+    memcpy(token.bytes, &value, sizeof(value));
+    return token;
+}
+
+static void observe_path(anjay_t *anjay,
+                         avs_net_socket_t *mocksock,
+                         size_t path_index) {
+    char iid_str[8];
+    char rid_str[8];
+    char value_str[16];
+    AVS_UNIT_ASSERT_TRUE(avs_simple_snprintf(iid_str, sizeof(iid_str), "%u",
+                                             (unsigned) path_iid(path_index))
+                         >= 0);
+    AVS_UNIT_ASSERT_TRUE(avs_simple_snprintf(rid_str, sizeof(rid_str), "%u",
+                                             (unsigned) path_rid(path_index))
+                         >= 0);
+    int value_size =
+            avs_simple_snprintf(value_str, sizeof(value_str), "%" PRId32,
+                                path_value(path_index));
+    AVS_UNIT_ASSERT_TRUE(value_size > 0);
+
+    const avs_coap_token_t token = observation_token(path_index);
+    DM_TEST_REQUEST(mocksock, CON, GET,
+                    ID_TOKEN_RAW((uint16_t) path_index, token), OBSERVE(0),
+                    PATH(AVS_QUOTE_MACRO(BENCH_OID), iid_str, rid_str));
+    DM_TEST_EXPECT_RESPONSE(mocksock, ACK, CONTENT,
+                            ID_TOKEN_RAW((uint16_t) path_index, token),
+                            OBSERVE(0), CONTENT_FORMAT(PLAINTEXT),
+                            PAYLOAD_EXTERNAL(value_str, (size_t) value_size));
+    expect_has_buffered_data_check(mocksock, false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksock));
+}
+
+static size_t observe_memory_bytes(bool *out_available) {
+    anjay_memory_stats_t stats = { 0 };
+    *out_available =
+            !anjay_get_memory_stats(ANJAY_MEMORY_TAG_OBSERVE, &stats);
+    return stats.current_bytes;
+}
+
+static void hold_notifications(anjay_t *anjay_locked) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_server_info_t) server;
+    AVS_LIST_FOREACH(server, anjay->servers) {
+        server->registration_info.update_forced = true;
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+static void run_scheduler_until_idle(anjay_t *anjay) {
+    // triggers scheduled while handling the notify job are due immediately
+    for (int i = 0; i < 16; ++i) {
+        anjay_sched_run(anjay);
+        if (anjay_sched_calculate_wait_time_ms(anjay, INT_MAX) > 0) {
+            return;
+        }
+    }
+    AVS_UNIT_ASSERT_TRUE(false);
+}
+
+AVS_UNIT_TEST(observe_benchmark, notify_bursts) {
+    bench_setup();
+    const anjay_dm_object_def_t *const *obj_defs[] = { &BENCH_OBJ,
+                                                       &FAKE_SECURITY };
+    DM_TEST_INIT_OBJECTS__(obj_defs, DM_TEST_CONFIGURATION(
+                                             .merge_queued_notifications =
+                                                     true));
+    // the mock clock would freeze the measured time
+    _anjay_mock_clock_finish();
+
+    avs_net_socket_t **mocksocks = (avs_net_socket_t **) avs_calloc(
+            BENCH.servers, sizeof(avs_net_socket_t *));
+    AVS_UNIT_ASSERT_NOT_NULL(mocksocks);
+    // installed in reverse order, the same way DM_TEST_INIT_GENERIC() does
+    for (size_t i = BENCH.servers; i-- > 0;) {
+        mocksocks[i] = _anjay_test_dm_install_socket(anjay,
+                                                     (anjay_ssid_t) (i + 1));
+    }
+    DM_TEST_POST_INIT__;
+
+    bool memory_available;
+    const size_t memory_before = observe_memory_bytes(&memory_available);
+    const avs_time_monotonic_t setup_start = avs_time_monotonic_now();
+    size_t observations = 0;
+    for (size_t path_index = 0; path_index < BENCH.paths; ++path_index) {
+        for (size_t i = 0; i < BENCH.servers; ++i) {
+            if (observations++ < BENCH.observations) {
+                observe_path(anjay, mocksocks[i], path_index);
+            }
+        }
+    }
+    const int64_t setup_ns = _anjay_bench_elapsed_ns(setup_start);
+    const size_t memory_observations = observe_memory_bytes(&memory_available);
+    const size_t idle_jobs = anjay_get_pending_sched_jobs(anjay, NULL, 0);
+
+    hold_notifications(anjay);
+    anjay_reset_sched_job_stats(anjay);
+    anjay_reset_allocation_sites();
+
+    int64_t *latencies_ns =
+            (int64_t *) avs_calloc(BENCH.bursts, sizeof(int64_t));
+    AVS_UNIT_ASSERT_NOT_NULL(latencies_ns);
+    int64_t notify_changed_ns = 0;
+    size_t peak_jobs = 0;
+    size_t next_path = 0;
+    for (size_t burst = 0; burst < BENCH.bursts; ++burst) {
+        const avs_time_monotonic_t start = avs_time_monotonic_now();
+        for (size_t i = 0; i < BENCH.burst_size; ++i) {
+            AVS_UNIT_ASSERT_SUCCESS(
+                    anjay_notify_changed(anjay, BENCH_OID, path_iid(next_path),
+                                         path_rid(next_path)));
+            next_path = (next_path + 1) % BENCH.paths;
+        }
+        notify_changed_ns += _anjay_bench_elapsed_ns(start);
+        run_scheduler_until_idle(anjay);
+        latencies_ns[burst] = _anjay_bench_elapsed_ns(start);
+        peak_jobs = AVS_MAX(peak_jobs,
+                            anjay_get_pending_sched_jobs(anjay, NULL, 0));
+    }
+    const size_t memory_queued = observe_memory_bytes(&memory_available);
+    size_t queued_count;
+    size_t queued_bytes;
+    anjay_get_notification_queue_usage(anjay, &queued_count, &queued_bytes);
+
+    int64_t total_ns = 0;
+    for (size_t i = 0; i < BENCH.bursts; ++i) {
+        total_ns += latencies_ns[i];
+    }
+    const double triggers_per_burst =
+            (double) BENCH.burst_size
+            * (double) BENCH.observations / (double) BENCH.paths;
+
+    printf("observe: %u observations, %u servers, %u bursts of %u changes\n",
+           (unsigned) BENCH.observations, (unsigned) BENCH.servers,
+           (unsigned) BENCH.bursts, (unsigned) BENCH.burst_size);
+    printf("  setup:            %9.1f us/observation\n",
+           (double) setup_ns / 1000.0 / (double) BENCH.observations);
+    if (memory_available) {
+        printf("  memory:           %9.1f B/observation, %u B queued "
+               "(%u values, %u B estimated)\n",
+               (double) (memory_observations - memory_before)
+                       / (double) BENCH.observations,
+               (unsigned) (memory_queued - memory_observations),
+               (unsigned) queued_count, (unsigned) queued_bytes);
+    } else {
+        printf("  memory:                 n/a, %u values queued "
+               "(%u B estimated)\n",
+               (unsigned) queued_count, (unsigned) queued_bytes);
+    }
+    // each observation of a single Resource has one inline path, a last_sent
+    // value and an entry in the refs list of the observed path
+    printf("  records:          %u B/observation (%u B record, %u B value, "
+           "%u B path ref), %u B/observed path\n",
+           (unsigned) (offsetof(anjay_observation_t, inline_paths)
+                       + sizeof(anjay_uri_path_t)
+                       + sizeof(anjay_observation_value_t)
+                       + sizeof(anjay_batch_t *)
+                       + sizeof(AVS_SORTED_SET_ELEM(anjay_observation_t))),
+           (unsigned) (offsetof(anjay_observation_t, inline_paths)
+                       + sizeof(anjay_uri_path_t)),
+           (unsigned) (sizeof(anjay_observation_value_t)
+                       + sizeof(anjay_batch_t *)),
+           (unsigned) sizeof(AVS_SORTED_SET_ELEM(anjay_observation_t)),
+           (unsigned) sizeof(anjay_observe_path_entry_t));
+    printf("  sched jobs:       %u idle, %u peak after a burst\n",
+           (unsigned) idle_jobs, (unsigned) peak_jobs);
+    printf("  notify_changed(): %9.1f us/call\n",
+           (double) notify_changed_ns / 1000.0
+                   / (double) (BENCH.bursts * BENCH.burst_size));
+    printf("  burst latency:    p50 %9.1f us, p99 %9.1f us, "
+           "%9.2f us/notification\n",
+           _anjay_bench_percentile_us(latencies_ns, BENCH.bursts, 50),
+           _anjay_bench_percentile_us(latencies_ns, BENCH.bursts, 99),
+           (double) total_ns / 1000.0
+                   / ((double) BENCH.bursts * triggers_per_burst));
+    _anjay_bench_print_allocation_sites(BENCH.bursts, "burst");
+
+    anjay_sched_job_stats_t trigger_stats;
+    if (!anjay_get_sched_job_stats(anjay, ANJAY_SCHED_JOB_OBSERVE_TRIGGER,
+                                   &trigger_stats)) {
+        // the remaining time is mostly spent in the notify job, which calls
+        // _anjay_observe_notify()
+        double trigger_us = (double) trigger_stats.total_runtime_us;
+        printf("  trigger_observe:  %9.1f us total in %u jobs, "
+               "%9.1f us outside of them\n",
+               trigger_us, (unsigned) trigger_stats.executions,
+               (double) (total_ns - notify_changed_ns) / 1000.0 - trigger_us);
+    } else {
+        printf("  trigger_observe:        n/a\n");
+    }
+
+    avs_free(latencies_ns);
+    _anjay_mock_clock_start(avs_time_monotonic_now());
+    _anjay_test_dm_finish(anjay);
+    avs_free(mocksocks);
+}
+
+#endif // ANJAY_WITH_OBSERVE
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include <anjay/stats.h>
+
+#include "tests/benchmarks/utils.h"
+
+size_t _anjay_bench_env_size(const char *name,
+                             size_t default_value,
+                             size_t max) {
+    const char *str = getenv(name);
+    if (!str || !*str) {
+        return default_value;
+    }
+    char *endptr = NULL;
+    unsigned long long value = strtoull(str, &endptr, 10);
+    AVS_UNIT_ASSERT_TRUE(!*endptr && value > 0 && value <= max);
+    return (size_t) value;
+}
+
+bool _anjay_bench_total_allocations(size_t *out_allocations) {
+    *out_allocations = 0;
+    for (int tag = 0; tag < (int) ANJAY_MEMORY_TAG_LIMIT_; ++tag) {
+        anjay_memory_stats_t stats;
+        if (anjay_get_memory_stats((anjay_memory_tag_t) tag, &stats)) {
+            return false;
+        }
+        *out_allocations += stats.total_allocations;
+    }
+    return true;
+}
+
+void _anjay_bench_print_allocation_sites(size_t units, const char *unit) {
+    anjay_allocation_site_stats_t sites[5];
+    const size_t count =
+            anjay_get_allocation_sites(sites, AVS_ARRAY_SIZE(sites));
+    for (size_t i = 0; i < AVS_MIN(count, AVS_ARRAY_SIZE(sites)); ++i) {
+        if (!sites[i].allocations && !sites[i].reallocations) {
+            break;
+        }
+        printf("    %-36s %8.1f allocs/%s, %10.1f B/%s\n",
+               sites[i].site ? sites[i].site : "(unattributed)",
+               (double) (sites[i].allocations + sites[i].reallocations)
+                       / (double) units,
+               unit, (double) sites[i].total_bytes / (double) units, unit);
+    }
+}
+
+int64_t _anjay_bench_elapsed_ns(avs_time_monotonic_t start) {
+    int64_t result;
+    AVS_UNIT_ASSERT_SUCCESS(avs_time_duration_to_scalar(
+            &result, AVS_TIME_NS,
+            avs_time_monotonic_diff(avs_time_monotonic_now(), start)));
+    return result;
+}
+
+static int compare_i64(const void *a, const void *b) {
+    int64_t left = *(const int64_t *) a;
+    int64_t right = *(const int64_t *) b;
+    return (left > right) - (left < right);
+}
+
+double _anjay_bench_percentile_us(int64_t *latencies_ns,
+                                  size_t count,
+                                  unsigned percent) {
+    AVS_UNIT_ASSERT_TRUE(count > 0);
+    qsort(latencies_ns, count, sizeof(int64_t), compare_i64);
+    size_t index = (count * percent + 99) / 100;
+    return (double) latencies_ns[index > 0 ? index - 1 : 0] / 1000.0;
+}
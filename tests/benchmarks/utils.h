@@ -0,0 +1,54 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_TEST_BENCHMARKS_UTILS_H
+#define ANJAY_TEST_BENCHMARKS_UTILS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <avsystem/commons/avs_time.h>
+
+/**
+ * Returns the value of a positive integer environment variable, or
+ * @p default_value if it is not set. Fails the test if the value is not
+ * within [1, @p max].
+ */
+size_t _anjay_bench_env_size(const char *name,
+                             size_t default_value,
+                             size_t max);
+
+/**
+ * Retrieves the number of allocations made so far by all subsystems.
+ *
+ * @returns false if the library is compiled without memory accounting.
+ */
+bool _anjay_bench_total_allocations(size_t *out_allocations);
+
+/**
+ * Prints the call sites that allocated the most since the last call to
+ * anjay_reset_allocation_sites(), as allocations and bytes per @p unit, with
+ * @p units being the number of operations performed in that time.
+ *
+ * Does nothing if the library is compiled without allocation profiling.
+ */
+void _anjay_bench_print_allocation_sites(size_t units, const char *unit);
+
+int64_t _anjay_bench_elapsed_ns(avs_time_monotonic_t start);
+
+/**
+ * Sorts @p latencies_ns in place and returns its @p percent -th percentile,
+ * in microseconds.
+ */
+double _anjay_bench_percentile_us(int64_t *latencies_ns,
+                                  size_t count,
+                                  unsigned percent);
+
+#endif /* ANJAY_TEST_BENCHMARKS_UTILS_H */
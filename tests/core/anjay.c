@@ -17,11 +17,18 @@
 #include <stdarg.h>
 #include <stdio.h>
 
+#ifdef ANJAY_WITH_THREAD_SAFETY
+#    include <pthread.h>
+#    include <stdatomic.h>
+#    include <time.h>
+#endif // ANJAY_WITH_THREAD_SAFETY
+
 #include <avsystem/coap/ctx.h>
 
 #include "src/core/anjay_servers_inactive.h"
 #include "src/core/anjay_servers_reload.h"
 #include "src/core/servers/anjay_server_connections.h"
+#include "src/core/servers/anjay_servers_internal.h"
 #include "tests/core/coap/utils.h"
 #include "tests/core/socket_mock.h"
 #include "tests/utils/dm.h"
@@ -869,8 +876,41 @@ typedef struct {
     expect_refresh_server_reconnect_mode_t with_reconnect;
     anjay_ssid_t ssid;
     size_t server_count;
+    // Instances of OBJ listed while querying the data model, if registered
+    const anjay_iid_t *obj_instances;
 } expect_refresh_server_additional_args_t;
 
+static void expect_query_update_parameters(anjay_t *anjay,
+                                           anjay_ssid_t ssid,
+                                           const anjay_iid_t *server_instances,
+                                           const anjay_iid_t *obj_instances) {
+    // Query the data model
+    _anjay_mock_dm_expect_list_instances(anjay, &FAKE_SERVER, 0,
+                                         server_instances);
+    if (obj_instances) {
+        _anjay_mock_dm_expect_list_instances(anjay, &OBJ, 0, obj_instances);
+    }
+    // attempt to read Bootstrap
+    _anjay_mock_dm_expect_list_instances(anjay, &FAKE_SERVER, 0,
+                                         server_instances);
+    // Read SSID
+    for (anjay_ssid_t i = 1; i <= ssid; ++i) {
+        _anjay_mock_dm_expect_list_resources(anjay, &FAKE_SERVER, i, 0,
+                                             FAKE_SERVER_RESOURCES);
+        _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, i,
+                                            ANJAY_DM_RID_SERVER_SSID,
+                                            ANJAY_ID_INVALID, 0,
+                                            ANJAY_MOCK_DM_INT(0, i));
+    }
+    // Read Lifetime
+    _anjay_mock_dm_expect_list_resources(anjay, &FAKE_SERVER, ssid, 0,
+                                         FAKE_SERVER_RESOURCES);
+    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, ssid,
+                                        ANJAY_DM_RID_SERVER_LIFETIME,
+                                        ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 86400));
+}
+
 static void
 expect_refresh_server__(anjay_t *anjay,
                         const expect_refresh_server_additional_args_t *args) {
@@ -937,28 +977,8 @@ expect_refresh_server__(anjay_t *anjay,
                 ANJAY_ID_INVALID, 0,
                 ANJAY_MOCK_DM_INT(0, ANJAY_SECURITY_NOSEC));
     }
-    // Query the data model
-    _anjay_mock_dm_expect_list_instances(anjay, &FAKE_SERVER, 0,
-                                         fake_server_instances);
-    // attempt to read Bootstrap
-    _anjay_mock_dm_expect_list_instances(anjay, &FAKE_SERVER, 0,
-                                         fake_server_instances);
-    // Read SSID
-    for (anjay_ssid_t i = 1; i <= ssid; ++i) {
-        _anjay_mock_dm_expect_list_resources(anjay, &FAKE_SERVER, i, 0,
-                                             FAKE_SERVER_RESOURCES);
-        _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, i,
-                                            ANJAY_DM_RID_SERVER_SSID,
-                                            ANJAY_ID_INVALID, 0,
-                                            ANJAY_MOCK_DM_INT(0, i));
-    }
-    // Read Lifetime
-    _anjay_mock_dm_expect_list_resources(anjay, &FAKE_SERVER, ssid, 0,
-                                         FAKE_SERVER_RESOURCES);
-    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, ssid,
-                                        ANJAY_DM_RID_SERVER_LIFETIME,
-                                        ANJAY_ID_INVALID, 0,
-                                        ANJAY_MOCK_DM_INT(0, 86400));
+    expect_query_update_parameters(anjay, ssid, fake_server_instances,
+                                   args->obj_instances);
 }
 
 #define expect_refresh_server(...)                                             \
@@ -1194,6 +1214,27 @@ AVS_UNIT_TEST(reconnect_server, resumed_session) {
     DM_TEST_FINISH;
 }
 
+AVS_UNIT_TEST(rebind, falls_back_to_reconnect_without_dtls) {
+    DM_REGISTER_TEST_INIT_WITH_SSIDS(1);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_transport_schedule_rebind(anjay, ANJAY_TRANSPORT_SET_ALL));
+    // plain CoAP connection cannot be rebound, so it is suspended...
+    avs_unit_mocksock_expect_shutdown(mocksocks[0]);
+    // ...and reconnected by a refresh, without reloading the servers
+    expect_refresh_server(anjay);
+    avs_unit_mocksock_expect_connect(mocksocks[0], "", "");
+    avs_unit_mocksock_expect_local_port(mocksocks[0], "5683");
+    avs_unit_mocksock_expect_get_opt(mocksocks[0],
+                                     AVS_NET_SOCKET_OPT_SESSION_RESUMED,
+                                     (avs_net_socket_opt_value_t) {
+                                         .flag = true
+                                     });
+    anjay_sched_run(anjay);
+    AVS_UNIT_ASSERT_TRUE(anjay_sched_calculate_wait_time_ms(anjay, INT_MAX)
+                         >= 1000);
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(schedule_register, nonexistent) {
     DM_REGISTER_TEST_INIT_WITH_SSIDS(1);
     AVS_UNIT_ASSERT_FAILED(anjay_schedule_register(anjay, 42));
@@ -1390,3 +1431,381 @@ AVS_UNIT_TEST(schedule_register, all_servers) {
                          >= 1000);
     DM_TEST_FINISH;
 }
+
+#ifdef ANJAY_WITH_STARTUP_TIMESTAMP_API
+AVS_UNIT_TEST(startup_timestamps, objects_installed) {
+    DM_TEST_INIT;
+    anjay_startup_timestamps_t timestamps;
+    ASSERT_OK(anjay_get_startup_timestamps(anjay, &timestamps));
+    ASSERT_TRUE(avs_time_monotonic_valid(timestamps.created));
+    ASSERT_TRUE(avs_time_monotonic_valid(timestamps.last_object_installed));
+    ASSERT_FALSE(avs_time_monotonic_before(timestamps.last_object_installed,
+                                           timestamps.created));
+    ASSERT_FALSE(avs_time_monotonic_valid(timestamps.last_state_restored));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(startup_timestamps, first_register_sent) {
+    DM_REGISTER_TEST_INIT_WITH_SSIDS(1);
+    anjay_server_startup_timestamps_t timestamps;
+    ASSERT_FAIL(anjay_get_server_startup_timestamps(anjay, ANJAY_SSID_ANY,
+                                                    &timestamps));
+    ASSERT_FAIL(anjay_get_server_startup_timestamps(anjay, 42, &timestamps));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_unlocked->servers->startup_timestamps.register_sent =
+            AVS_TIME_MONOTONIC_INVALID;
+    ANJAY_MUTEX_UNLOCK(anjay);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    const avs_time_monotonic_t register_time = avs_time_monotonic_now();
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_schedule_register(anjay, 1));
+    expect_refresh_server(anjay);
+    const coap_test_msg_t *register_request =
+            COAP_MSG(CON, POST, ID_TOKEN_RAW(0x0001, nth_token(1)),
+                     CONTENT_FORMAT(LINK_FORMAT), PATH("rd"),
+                     QUERY("lwm2m=1.0", "ep=urn:dev:os:anjay-test", "lt=86400"),
+                     PAYLOAD("</1/1>"));
+    avs_unit_mocksock_expect_output(mocksocks[0], register_request->content,
+                                    register_request->length);
+    anjay_sched_run(anjay);
+
+    ASSERT_OK(anjay_get_server_startup_timestamps(anjay, 1, &timestamps));
+    ASSERT_TRUE(avs_time_duration_equal(
+            avs_time_monotonic_diff(timestamps.register_sent, register_time),
+            AVS_TIME_DURATION_ZERO));
+
+    // only the first occurrence is recorded
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    _anjay_startup_timestamp_mark_first(
+            &anjay_unlocked->servers->startup_timestamps.register_sent);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    ASSERT_OK(anjay_get_server_startup_timestamps(anjay, 1, &timestamps));
+    ASSERT_TRUE(avs_time_duration_equal(
+            avs_time_monotonic_diff(timestamps.register_sent, register_time),
+            AVS_TIME_DURATION_ZERO));
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_STARTUP_TIMESTAMP_API
+
+#define LAZY_REGISTER_OBJ_INSTANCES 200
+
+static void lazy_register_payload_init(anjay_iid_t *out_instances,
+                                       anjay_iid_t first_iid,
+                                       void **out_payload,
+                                       size_t *out_payload_size) {
+    avs_stream_t *payload_memstream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(payload_memstream);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_f(payload_memstream, "</1/1>"));
+    for (anjay_iid_t i = first_iid; i < LAZY_REGISTER_OBJ_INSTANCES; ++i) {
+        out_instances[i - first_iid] = i;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_f(payload_memstream,
+                                                   ",</42/%" PRIu16 ">", i));
+    }
+    out_instances[LAZY_REGISTER_OBJ_INSTANCES - first_iid] = ANJAY_ID_INVALID;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_membuf_take_ownership(
+            payload_memstream, out_payload, out_payload_size));
+    avs_stream_cleanup(&payload_memstream);
+    // too long to be kept in memory for the duration of the exchange
+    AVS_UNIT_ASSERT_TRUE(*out_payload_size > 1024);
+    AVS_UNIT_ASSERT_TRUE(*out_payload_size <= 2048);
+}
+
+#define EXPECT_LAZY_REGISTER_REQUEST(Mocksock, MsgId, Token, SeqNum, Payload, \
+                                     PayloadSize)                            \
+    do {                                                                     \
+        const coap_test_msg_t *request = COAP_MSG(                           \
+                CON, POST, ID_TOKEN_RAW((MsgId), (Token)),                   \
+                CONTENT_FORMAT(LINK_FORMAT), PATH("rd"),                     \
+                QUERY("lwm2m=1.0", "ep=urn:dev:os:anjay-test", "lt=86400"),  \
+                BLOCK1_EXTERNAL((SeqNum), 1024, (Payload), (PayloadSize)));  \
+        avs_unit_mocksock_expect_output((Mocksock), request->content,        \
+                                        request->length);                    \
+    } while (0)
+
+AVS_UNIT_TEST(lazy_register_payload, resumed_for_each_block) {
+    const anjay_dm_object_def_t *const *obj_defs[] = { &FAKE_SECURITY2,
+                                                       &FAKE_SERVER, &OBJ };
+    anjay_ssid_t ssids[] = { 1 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids, DM_REGISTER_TEST_CONFIGURATION);
+    const anjay_iid_t server_instances[] = { 1, ANJAY_ID_INVALID };
+    anjay_iid_t obj_instances[LAZY_REGISTER_OBJ_INSTANCES + 1];
+    void *payload = NULL;
+    size_t payload_size = 0;
+    lazy_register_payload_init(obj_instances, 0, &payload, &payload_size);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_schedule_register(anjay, 1));
+    expect_refresh_server(anjay, .obj_instances = obj_instances);
+    // first block is generated from the beginning of the data model
+    _anjay_mock_dm_expect_list_instances(anjay, &FAKE_SERVER, 0,
+                                         server_instances);
+    _anjay_mock_dm_expect_list_instances(anjay, &OBJ, 0, obj_instances);
+    EXPECT_LAZY_REGISTER_REQUEST(
+            mocksocks[0], 0x0000, nth_token(0), 0, payload, payload_size);
+    anjay_sched_run(anjay);
+
+    // second one is resumed in the middle of /42, so /1 is not queried again
+    DM_TEST_REQUEST(mocksocks[0], ACK, CONTINUE,
+                    ID_TOKEN_RAW(0x0000, nth_token(0)),
+                    BLOCK1_ACK(0, 1024, true));
+    _anjay_mock_dm_expect_list_instances(anjay, &OBJ, 0, obj_instances);
+    EXPECT_LAZY_REGISTER_REQUEST(
+            mocksocks[0], 0x0001, nth_token(1), 1, payload, payload_size);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    avs_free(payload);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(lazy_register_payload, restarted_on_dm_change) {
+    const anjay_dm_object_def_t *const *obj_defs[] = { &FAKE_SECURITY2,
+                                                       &FAKE_SERVER, &OBJ };
+    anjay_ssid_t ssids[] = { 1 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids, DM_REGISTER_TEST_CONFIGURATION);
+    const anjay_iid_t server_instances[] = { 1, ANJAY_ID_INVALID };
+    anjay_iid_t obj_instances[LAZY_REGISTER_OBJ_INSTANCES + 1];
+    void *payload = NULL;
+    size_t payload_size = 0;
+    lazy_register_payload_init(obj_instances, 0, &payload, &payload_size);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_schedule_register(anjay, 1));
+    expect_refresh_server(anjay, .obj_instances = obj_instances);
+    _anjay_mock_dm_expect_list_instances(anjay, &FAKE_SERVER, 0,
+                                         server_instances);
+    _anjay_mock_dm_expect_list_instances(anjay, &OBJ, 0, obj_instances);
+    EXPECT_LAZY_REGISTER_REQUEST(
+            mocksocks[0], 0x0000, nth_token(0), 0, payload, payload_size);
+    anjay_sched_run(anjay);
+    avs_free(payload);
+
+    // /42/0 is removed before the second block is requested
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    _anjay_dm_cache_invalidate_object_links(anjay_unlocked);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    lazy_register_payload_init(obj_instances, 1, &payload, &payload_size);
+
+    // the remaining blocks would not match the one already sent, so Register
+    // is started from scratch instead
+    DM_TEST_REQUEST(mocksocks[0], ACK, CONTINUE,
+                    ID_TOKEN_RAW(0x0000, nth_token(0)),
+                    BLOCK1_ACK(0, 1024, true));
+    expect_query_update_parameters(anjay, 1, server_instances, obj_instances);
+    _anjay_mock_dm_expect_list_instances(anjay, &FAKE_SERVER, 0,
+                                         server_instances);
+    _anjay_mock_dm_expect_list_instances(anjay, &OBJ, 0, obj_instances);
+    EXPECT_LAZY_REGISTER_REQUEST(
+            mocksocks[0], 0x0001, nth_token(2), 0, payload, payload_size);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    avs_free(payload);
+    DM_TEST_FINISH;
+}
+
+#ifdef ANJAY_WITH_THREAD_SAFETY
+static anjay_t *lock_test_anjay_new(void) {
+    const anjay_configuration_t config = {
+        .endpoint_name = "test"
+    };
+    anjay_t *anjay = anjay_new(&config);
+    ASSERT_NOT_NULL(anjay);
+    return anjay;
+}
+
+/**
+ * There is no way to observe that a thread is blocked on a lock, so the tests
+ * below give it some time to get there instead.
+ */
+static void lock_test_let_threads_run(void) {
+    nanosleep(&(const struct timespec) { .tv_nsec = 100 * 1000 * 1000 }, NULL);
+}
+
+typedef struct {
+    anjay_t *anjay;
+    atomic_int *sequence;
+    int result;
+    atomic_int acquired_at;
+} lock_test_thread_t;
+
+#    define LOCK_TEST_THREAD_INIT(Anjay, Sequence) \
+        {                                          \
+            .anjay = (Anjay),                      \
+            .sequence = (Sequence),                \
+            .acquired_at = 0                       \
+        }
+
+static void *lock_shared_thread(void *thread_) {
+    lock_test_thread_t *thread = (lock_test_thread_t *) thread_;
+    if (!(thread->result = _anjay_lock_shared(thread->anjay))) {
+        atomic_store(&thread->acquired_at,
+                     atomic_fetch_add(thread->sequence, 1) + 1);
+        _anjay_unlock_shared(thread->anjay);
+    }
+    return NULL;
+}
+
+static void *lock_exclusive_thread(void *thread_) {
+    lock_test_thread_t *thread = (lock_test_thread_t *) thread_;
+    if (!(thread->result = _anjay_lock_exclusive(thread->anjay))) {
+        atomic_store(&thread->acquired_at,
+                     atomic_fetch_add(thread->sequence, 1) + 1);
+        // give blocked shared sections a chance to run ahead, if they could
+        lock_test_let_threads_run();
+        avs_mutex_unlock(thread->anjay->mutex);
+    }
+    return NULL;
+}
+
+AVS_UNIT_TEST(anjay_lock, shared_sections_run_concurrently) {
+    anjay_t *anjay = lock_test_anjay_new();
+    atomic_int sequence = 0;
+    ASSERT_OK(_anjay_lock_shared(anjay));
+    lock_test_thread_t reader = LOCK_TEST_THREAD_INIT(anjay, &sequence);
+    pthread_t thread;
+    ASSERT_OK(pthread_create(&thread, NULL, lock_shared_thread, &reader));
+    // would never return if the second shared section had to wait
+    ASSERT_OK(pthread_join(thread, NULL));
+    ASSERT_OK(reader.result);
+    ASSERT_EQ(atomic_load(&reader.acquired_at), 1);
+    ASSERT_EQ(anjay->shared_lock_holders, 1);
+    _anjay_unlock_shared(anjay);
+    ASSERT_EQ(anjay->shared_lock_holders, 0);
+    anjay_delete(anjay);
+}
+
+AVS_UNIT_TEST(anjay_lock, exclusive_waits_for_shared_holders) {
+    anjay_t *anjay = lock_test_anjay_new();
+    atomic_int sequence = 0;
+    ASSERT_OK(_anjay_lock_shared(anjay));
+    lock_test_thread_t writer = LOCK_TEST_THREAD_INIT(anjay, &sequence);
+    pthread_t thread;
+    ASSERT_OK(pthread_create(&thread, NULL, lock_exclusive_thread, &writer));
+    lock_test_let_threads_run();
+    ASSERT_EQ(atomic_load(&writer.acquired_at), 0);
+
+    _anjay_unlock_shared(anjay);
+    ASSERT_OK(pthread_join(thread, NULL));
+    ASSERT_OK(writer.result);
+    ASSERT_EQ(atomic_load(&writer.acquired_at), 1);
+    anjay_delete(anjay);
+}
+
+AVS_UNIT_TEST(anjay_lock, no_writer_starvation) {
+    anjay_t *anjay = lock_test_anjay_new();
+    atomic_int sequence = 0;
+    ASSERT_OK(_anjay_lock_shared(anjay));
+    lock_test_thread_t writer = LOCK_TEST_THREAD_INIT(anjay, &sequence);
+    pthread_t writer_thread;
+    ASSERT_OK(pthread_create(&writer_thread, NULL, lock_exclusive_thread,
+                             &writer));
+    lock_test_let_threads_run();
+
+    // a shared section requested while the writer is waiting shall not be
+    // able to begin, even though another one is still running
+    lock_test_thread_t reader = LOCK_TEST_THREAD_INIT(anjay, &sequence);
+    pthread_t reader_thread;
+    ASSERT_OK(pthread_create(&reader_thread, NULL, lock_shared_thread,
+                             &reader));
+    lock_test_let_threads_run();
+    ASSERT_EQ(atomic_load(&writer.acquired_at), 0);
+    ASSERT_EQ(atomic_load(&reader.acquired_at), 0);
+
+    _anjay_unlock_shared(anjay);
+    ASSERT_OK(pthread_join(writer_thread, NULL));
+    ASSERT_OK(pthread_join(reader_thread, NULL));
+    ASSERT_OK(writer.result);
+    ASSERT_OK(reader.result);
+    ASSERT_EQ(atomic_load(&writer.acquired_at), 1);
+    ASSERT_EQ(atomic_load(&reader.acquired_at), 2);
+    anjay_delete(anjay);
+}
+
+AVS_UNIT_TEST(anjay_lock, shared_section_leaves_servers_index_untouched) {
+    DM_TEST_INIT_WITH_SSIDS(1, 2);
+    anjay_unlocked_t *anjay_unlocked =
+            (anjay_unlocked_t *) &anjay->anjay_unlocked_placeholder;
+    ASSERT_OK(_anjay_lock_exclusive(anjay));
+    // force the index to be rebuilt on next use
+    ++anjay_unlocked->servers_version;
+    avs_mutex_unlock(anjay->mutex);
+
+    ASSERT_OK(_anjay_lock_shared(anjay));
+    ASSERT_TRUE(anjay_unlocked->shared_lock_held);
+    anjay_server_info_t *server = _anjay_servers_find(anjay_unlocked, 2);
+    ASSERT_NOT_NULL(server);
+    ASSERT_EQ(_anjay_server_ssid(server), 2);
+    ASSERT_NE(anjay_unlocked->servers_index.servers_version,
+              anjay_unlocked->servers_version);
+    _anjay_unlock_shared(anjay);
+    ASSERT_FALSE(anjay_unlocked->shared_lock_held);
+
+    ASSERT_OK(_anjay_lock_exclusive(anjay));
+    ASSERT_TRUE(_anjay_servers_find(anjay_unlocked, 2) == server);
+    ASSERT_TRUE(anjay_unlocked->servers_index.valid);
+    ASSERT_EQ(anjay_unlocked->servers_index.servers_version,
+              anjay_unlocked->servers_version);
+    avs_mutex_unlock(anjay->mutex);
+    DM_TEST_FINISH;
+}
+
+static void coap_sched_test_job(avs_sched_t *sched, const void *arg) {
+    (void) sched;
+    (void) arg;
+}
+
+static avs_time_monotonic_t coap_sched_test_time(int64_t ms) {
+    return avs_time_monotonic_from_scalar(1000000 + ms, AVS_TIME_MS);
+}
+
+AVS_UNIT_TEST(coap_sched_job, coalesced_within_slack) {
+    _anjay_mock_clock_start(coap_sched_test_time(0));
+    const anjay_configuration_t config = {
+        .endpoint_name = "test",
+        .coap_sched_slack = avs_time_duration_from_scalar(100, AVS_TIME_MS)
+    };
+    anjay_t *anjay = anjay_new(&config);
+    ASSERT_NOT_NULL(anjay);
+    anjay_sched_run(anjay);
+    avs_sched_handle_t main_job = NULL;
+    avs_sched_handle_t coap_job = NULL;
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    ASSERT_FALSE(avs_time_monotonic_valid(
+            avs_sched_time_of_next(anjay_unlocked->sched)));
+    ASSERT_OK(AVS_SCHED_AT(anjay_unlocked->sched, &main_job,
+                           coap_sched_test_time(1050), coap_sched_test_job,
+                           NULL, 0));
+
+    // main scheduler job due within the slack - both run in one wakeup
+    ASSERT_OK(AVS_SCHED_AT(anjay_unlocked->coap_sched, &coap_job,
+                           coap_sched_test_time(1000), coap_sched_test_job,
+                           NULL, 0));
+    _anjay_reschedule_coap_sched_job(anjay_unlocked);
+    ASSERT_NOT_NULL(anjay_unlocked->coap_sched_job_handle);
+    ASSERT_TRUE(avs_time_monotonic_equal(anjay_unlocked->coap_sched_job_time,
+                                         coap_sched_test_time(1050)));
+
+    // proxy job already planned within the slack - left where it is
+    ASSERT_OK(AVS_RESCHED_AT(&coap_job, coap_sched_test_time(980)));
+    _anjay_reschedule_coap_sched_job(anjay_unlocked);
+    ASSERT_TRUE(avs_time_monotonic_equal(anjay_unlocked->coap_sched_job_time,
+                                         coap_sched_test_time(1050)));
+
+    // deadline outside of the slack is honored exactly
+    ASSERT_OK(AVS_RESCHED_AT(&coap_job, coap_sched_test_time(900)));
+    _anjay_reschedule_coap_sched_job(anjay_unlocked);
+    ASSERT_TRUE(avs_time_monotonic_equal(anjay_unlocked->coap_sched_job_time,
+                                         coap_sched_test_time(900)));
+    ASSERT_TRUE(avs_time_monotonic_equal(
+            avs_sched_time_of_next(anjay_unlocked->sched),
+            coap_sched_test_time(900)));
+
+    avs_sched_del(&coap_job);
+    avs_sched_del(&main_job);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    anjay_delete(anjay);
+    _anjay_mock_clock_finish();
+}
+#endif // ANJAY_WITH_THREAD_SAFETY
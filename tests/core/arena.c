@@ -0,0 +1,151 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+AVS_UNIT_TEST(arena, lifo_free_reclaims_space) {
+    anjay_arena_t arena;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_arena_init(&arena, 256));
+    char *first = (char *) _anjay_arena_alloc(&arena, 16);
+    char *second = (char *) _anjay_arena_alloc(&arena, 16);
+    AVS_UNIT_ASSERT_TRUE(in_arena(&arena, first));
+    AVS_UNIT_ASSERT_TRUE(in_arena(&arena, second));
+    AVS_UNIT_ASSERT_TRUE(second > first);
+    _anjay_arena_free(&arena, second);
+    _anjay_arena_free(&arena, first);
+    AVS_UNIT_ASSERT_EQUAL(arena.used, 0);
+    AVS_UNIT_ASSERT_EQUAL(arena.top, SIZE_MAX);
+    _anjay_arena_cleanup(&arena);
+}
+
+AVS_UNIT_TEST(arena, out_of_order_free_reclaims_space) {
+    anjay_arena_t arena;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_arena_init(&arena, 256));
+    void *first = _anjay_arena_alloc(&arena, 16);
+    void *second = _anjay_arena_alloc(&arena, 16);
+    void *third = _anjay_arena_alloc(&arena, 16);
+    AVS_UNIT_ASSERT_TRUE(in_arena(&arena, third));
+
+    _anjay_arena_free(&arena, first);
+    AVS_UNIT_ASSERT_TRUE(is_top(&arena, third));
+    _anjay_arena_free(&arena, third);
+    AVS_UNIT_ASSERT_TRUE(is_top(&arena, second));
+    // first is reclaimed along with second
+    _anjay_arena_free(&arena, second);
+    AVS_UNIT_ASSERT_EQUAL(arena.used, 0);
+    AVS_UNIT_ASSERT_EQUAL(arena.top, SIZE_MAX);
+
+    // the same space is used again, without any release
+    void *reused = _anjay_arena_alloc(&arena, 16);
+    AVS_UNIT_ASSERT_TRUE(reused == first);
+    _anjay_arena_free(&arena, reused);
+    AVS_UNIT_ASSERT_EQUAL(arena.used, 0);
+    _anjay_arena_cleanup(&arena);
+}
+
+AVS_UNIT_TEST(arena, release_to_mark) {
+    anjay_arena_t arena;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_arena_init(&arena, 256));
+    void *outer = _anjay_arena_alloc(&arena, 8);
+    size_t mark = _anjay_arena_mark(&arena);
+    void *first = _anjay_arena_alloc(&arena, 8);
+    (void) _anjay_arena_alloc(&arena, 8);
+    // not the most recent one, so space is not reclaimed yet
+    _anjay_arena_free(&arena, first);
+    AVS_UNIT_ASSERT_NOT_EQUAL(arena.used, mark);
+    _anjay_arena_release(&arena, mark);
+    AVS_UNIT_ASSERT_EQUAL(arena.used, mark);
+    _anjay_arena_free(&arena, outer);
+    AVS_UNIT_ASSERT_EQUAL(arena.used, 0);
+    _anjay_arena_cleanup(&arena);
+}
+
+AVS_UNIT_TEST(arena, realloc_grows_in_place_and_falls_back_to_heap) {
+    anjay_arena_t arena;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_arena_init(&arena, 256));
+    char *data = (char *) _anjay_arena_realloc(&arena, NULL, 4);
+    memcpy(data, "abc", 4);
+    char *grown = (char *) _anjay_arena_realloc(&arena, data, 64);
+    AVS_UNIT_ASSERT_TRUE(grown == data);
+    char *heap = (char *) _anjay_arena_realloc(&arena, grown, 1024);
+    AVS_UNIT_ASSERT_NOT_NULL(heap);
+    AVS_UNIT_ASSERT_FALSE(in_arena(&arena, heap));
+    AVS_UNIT_ASSERT_EQUAL_STRING(heap, "abc");
+    AVS_UNIT_ASSERT_EQUAL(arena.used, 0);
+    _anjay_arena_free(&arena, heap);
+    _anjay_arena_cleanup(&arena);
+}
+
+AVS_UNIT_TEST(arena, zero_size_uses_heap) {
+    anjay_arena_t arena;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_arena_init(&arena, 0));
+    void *ptr = _anjay_arena_alloc(&arena, 16);
+    AVS_UNIT_ASSERT_NOT_NULL(ptr);
+    AVS_UNIT_ASSERT_FALSE(in_arena(&arena, ptr));
+    _anjay_arena_free(&arena, ptr);
+    _anjay_arena_cleanup(&arena);
+}
+
+AVS_UNIT_TEST(growable_arena, chunks_grow_geometrically) {
+    anjay_growable_arena_t arena;
+    _anjay_growable_arena_init(&arena, 64, 256);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_growable_arena_memory_size(&arena), 0);
+
+    char *first = (char *) _anjay_growable_arena_alloc(&arena, 1);
+    char *second = (char *) _anjay_growable_arena_alloc(&arena, 1);
+    // sizes are rounded up, so that all allocations are aligned
+    AVS_UNIT_ASSERT_EQUAL(second - first, ARENA_ALIGNMENT);
+    AVS_UNIT_ASSERT_EQUAL(arena.chunks->size, 64);
+    AVS_UNIT_ASSERT_NULL(arena.chunks->prev);
+
+    AVS_UNIT_ASSERT_NOT_NULL(_anjay_growable_arena_alloc(&arena, 64));
+    AVS_UNIT_ASSERT_EQUAL(arena.chunks->size, 128);
+    AVS_UNIT_ASSERT_NOT_NULL(_anjay_growable_arena_alloc(&arena, 128));
+    AVS_UNIT_ASSERT_EQUAL(arena.chunks->size, 256);
+    AVS_UNIT_ASSERT_NOT_NULL(_anjay_growable_arena_alloc(&arena, 256));
+    AVS_UNIT_ASSERT_EQUAL(arena.chunks->size, 256);
+    // oversized allocations get a chunk of their own
+    AVS_UNIT_ASSERT_NOT_NULL(_anjay_growable_arena_alloc(&arena, 1000));
+    AVS_UNIT_ASSERT_EQUAL(arena.chunks->size, ARENA_ALIGN(1000));
+
+    AVS_UNIT_ASSERT_EQUAL(_anjay_growable_arena_memory_size(&arena),
+                          5 * sizeof(anjay_arena_chunk_t) + 64 + 128 + 256
+                                  + 256 + ARENA_ALIGN(1000));
+    _anjay_growable_arena_cleanup(&arena);
+    AVS_UNIT_ASSERT_NULL(arena.chunks);
+}
+
+AVS_UNIT_TEST(growable_arena, release_to_mark) {
+    anjay_growable_arena_t arena;
+    _anjay_growable_arena_init(&arena, 64, 64);
+    const anjay_growable_arena_mark_t empty_mark =
+            _anjay_growable_arena_mark(&arena);
+    char *first = (char *) _anjay_growable_arena_alloc(&arena, 16);
+    const anjay_growable_arena_mark_t mark = _anjay_growable_arena_mark(&arena);
+    const anjay_arena_chunk_t *chunk = arena.chunks;
+
+    for (size_t i = 0; i < 10; ++i) {
+        AVS_UNIT_ASSERT_NOT_NULL(_anjay_growable_arena_alloc(&arena, 32));
+    }
+    AVS_UNIT_ASSERT_TRUE(arena.chunks != chunk);
+
+    _anjay_growable_arena_release(&arena, &mark);
+    AVS_UNIT_ASSERT_TRUE(arena.chunks == chunk);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_growable_arena_memory_size(&arena),
+                          sizeof(anjay_arena_chunk_t) + 64);
+    // released space is reused
+    char *second = (char *) _anjay_growable_arena_alloc(&arena, 16);
+    AVS_UNIT_ASSERT_EQUAL(second - first, ARENA_ALIGN(16));
+
+    _anjay_growable_arena_release(&arena, &empty_mark);
+    AVS_UNIT_ASSERT_NULL(arena.chunks);
+    _anjay_growable_arena_cleanup(&arena);
+}
@@ -550,33 +550,23 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_2) {
                                         ANJAY_ID_INVALID, 0,
                                         ANJAY_MOCK_DM_INT(0, -5));
     AVS_UNIT_ASSERT_FALSE(anjay_unlocked->attr_storage.modified_since_persist);
-    _anjay_mock_dm_expect_list_instances(
-            anjay, &OBJ, 0,
-            (const anjay_iid_t[]) { 2, 4, 7, 21, 42, ANJAY_ID_INVALID });
-    _anjay_mock_dm_expect_list_resources(
-            anjay, &OBJ, 4, 0,
-            (const anjay_mock_dm_res_entry_t[]) {
-                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
-                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
-                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
-                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    ANJAY_MOCK_DM_RES_END });
+    // only the changed Resources that have attributes are checked
+    for (int i = 0; i < 2; ++i) {
+        _anjay_mock_dm_expect_list_resources(
+                anjay, &OBJ, 4, 0,
+                (const anjay_mock_dm_res_entry_t[]) {
+                        { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                        { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                        { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                        ANJAY_MOCK_DM_RES_END });
+    }
     _anjay_mock_dm_expect_list_resources(
             anjay, &OBJ, 7, 0,
             (const anjay_mock_dm_res_entry_t[]) {
                     { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
-                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 11, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
                     ANJAY_MOCK_DM_RES_END });
     _anjay_mock_dm_expect_list_resources(anjay, &OBJ, 21, -11, NULL);
-    _anjay_mock_dm_expect_list_resources(anjay, &OBJ, 42, -514, NULL);
     AVS_UNIT_ASSERT_FAILED(_anjay_attr_storage_notify(anjay_unlocked, queue));
     _anjay_notify_clear_queue(&queue);
 
@@ -613,6 +603,13 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_2) {
                                             ANJAY_ATTRIB_INTEGER_NONE, 3.0, 4.0,
                                             5.0, ANJAY_DM_CON_ATTR_NONE),
                                     NULL),
+                            test_resource_entry(
+                                    3,
+                                    test_resource_attrs(
+                                            2, 1, 2, ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE, 3.0, 4.0,
+                                            5.0, ANJAY_DM_CON_ATTR_NONE),
+                                    NULL),
                             test_resource_entry(
                                     6,
                                     test_resource_attrs(
@@ -621,6 +618,17 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_2) {
                                             5.0, ANJAY_DM_CON_ATTR_NONE),
                                     NULL),
                             NULL),
+                    test_instance_entry(
+                            7,
+                            NULL,
+                            test_resource_entry(
+                                    42,
+                                    test_resource_attrs(
+                                            2, 1, 2, ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE, 3.0, 4.0,
+                                            5.0, ANJAY_DM_CON_ATTR_NONE),
+                                    NULL),
+                            NULL),
                     test_instance_entry(
                             21,
                             NULL,
@@ -662,6 +670,86 @@ AVS_UNIT_TEST(attr_storage, as_notify_callback_2) {
     DM_ATTR_STORAGE_TEST_FINISH;
 }
 
+AVS_UNIT_TEST(attr_storage, as_notify_known_instance_changes) {
+    DM_ATTR_STORAGE_TEST_INIT;
+
+    AVS_LIST_APPEND(
+            &anjay_unlocked->attr_storage.objects,
+            test_object_entry(
+                    42,
+                    NULL,
+                    test_instance_entry(
+                            1,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            2, 3, 4, ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_DM_CON_ATTR_NONE),
+                                    NULL),
+                            NULL),
+                    test_instance_entry(
+                            2,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            2, 3, 4, ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_DM_CON_ATTR_NONE),
+                                    NULL),
+                            NULL),
+                    test_instance_entry(
+                            4,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            2, 3, 4, ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_DM_CON_ATTR_NONE),
+                                    NULL),
+                            NULL),
+                    NULL));
+
+    // all changes are known, so the data model is not queried
+    anjay_notify_queue_t queue = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_notify_queue_instance_removed(&queue, 42, 2));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_notify_queue_instance_removed(&queue, 42, 3));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_notify_queue_instance_created(&queue, 42, 5));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_queue_instance_created(
+            &queue, ANJAY_DM_OID_SERVER, 3));
+    AVS_UNIT_ASSERT_FALSE(queue->instance_set_changes.unknown_change);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_attr_storage_notify(anjay_unlocked, queue));
+    _anjay_notify_clear_queue(&queue);
+
+    AVS_UNIT_ASSERT_TRUE(anjay_unlocked->attr_storage.modified_since_persist);
+    assert_object_equal(
+            anjay_unlocked->attr_storage.objects,
+            test_object_entry(
+                    42,
+                    NULL,
+                    test_instance_entry(
+                            1,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            2, 3, 4, ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_DM_CON_ATTR_NONE),
+                                    NULL),
+                            NULL),
+                    test_instance_entry(
+                            4,
+                            test_default_attrlist(
+                                    test_default_attrs(
+                                            2, 3, 4, ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_ATTRIB_INTEGER_NONE,
+                                            ANJAY_DM_CON_ATTR_NONE),
+                                    NULL),
+                            NULL),
+                    NULL));
+
+    DM_ATTR_STORAGE_TEST_FINISH;
+}
+
 //// ATTRIBUTE HANDLERS ////////////////////////////////////////////////////////
 
 AVS_UNIT_TEST(attr_storage, read_object_default_attrs_proxy) {
@@ -1429,6 +1517,50 @@ AVS_UNIT_TEST(attr_storage, read_resource_attrs) {
     DM_ATTR_STORAGE_TEST_FINISH;
 }
 
+AVS_UNIT_TEST(attr_storage, read_resource_attrs_after_write) {
+    DM_ATTR_STORAGE_TEST_INIT;
+
+    const anjay_dm_r_attributes_t written = {
+        .common = {
+            .min_period = 1,
+            .max_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+#ifdef ANJAY_WITH_CON_ATTR
+            ,
+            .con = ANJAY_DM_CON_ATTR_NONE
+#endif // ANJAY_WITH_CON_ATTR
+        },
+        .greater_than = 34.0,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+    anjay_dm_r_attributes_t attrs;
+    // lookup index is built here, while the storage is still empty
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_call_resource_read_attrs(
+            anjay_unlocked, WRAP_OBJ_PTR(&OBJ2), 2, 3, 1, &attrs));
+    assert_res_attrs_equal(&attrs, &ANJAY_DM_R_ATTRIBUTES_EMPTY);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_call_resource_write_attrs(
+            anjay_unlocked, WRAP_OBJ_PTR(&OBJ2), 2, 3, 1, &written));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_call_resource_read_attrs(
+            anjay_unlocked, WRAP_OBJ_PTR(&OBJ2), 2, 3, 1, &attrs));
+    assert_res_attrs_equal(&attrs, &written);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_call_resource_read_attrs(
+            anjay_unlocked, WRAP_OBJ_PTR(&OBJ2), 2, 4, 1, &attrs));
+    assert_res_attrs_equal(&attrs, &ANJAY_DM_R_ATTRIBUTES_EMPTY);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_call_resource_write_attrs(
+            anjay_unlocked, WRAP_OBJ_PTR(&OBJ2), 2, 3, 1,
+            &ANJAY_DM_R_ATTRIBUTES_EMPTY));
+    AVS_UNIT_ASSERT_NULL(anjay_unlocked->attr_storage.objects);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_dm_call_resource_read_attrs(
+            anjay_unlocked, WRAP_OBJ_PTR(&OBJ2), 2, 3, 1, &attrs));
+    assert_res_attrs_equal(&attrs, &ANJAY_DM_R_ATTRIBUTES_EMPTY);
+
+    DM_ATTR_STORAGE_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(attr_storage, write_resource_attrs) {
     DM_ATTR_STORAGE_TEST_INIT;
     AVS_UNIT_ASSERT_FALSE(anjay_unlocked->attr_storage.modified_since_persist);
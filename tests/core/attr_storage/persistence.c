@@ -1012,4 +1012,75 @@ AVS_UNIT_TEST(attr_storage_persistence, restore_duplicate_oid) {
     PERSISTENCE_TEST_FINISH;
 }
 
+AVS_UNIT_TEST(attr_storage_persistence, journal_roundtrip) {
+    PERSIST_TEST_INIT(512);
+    INSTALL_FAKE_OBJECT(4);
+
+    // nothing to write for an empty storage
+    AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_persist_journal(
+            anjay, (avs_stream_t *) &outbuf));
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf), 0);
+
+    const anjay_dm_oi_attributes_t attrs = {
+        .min_period = 7,
+        .max_period = 8,
+        .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+        .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+#ifdef ANJAY_WITH_CON_ATTR
+        .con = ANJAY_DM_CON_ATTR_NONE,
+#endif // ANJAY_WITH_CON_ATTR
+    };
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    write_inst_attrs(anjay_unlocked, 4, 5, 6, &attrs);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_TRUE(anjay_attr_storage_is_modified(anjay));
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_persist_journal(
+            anjay, (avs_stream_t *) &outbuf));
+    AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
+    AVS_UNIT_ASSERT_EQUAL(anjay_attr_storage_journal_records(anjay), 1);
+    size_t journal_size = avs_stream_outbuf_offset(&outbuf);
+    AVS_UNIT_ASSERT_TRUE(journal_size > 0);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "FAJ", 3);
+
+    // no changes since the last call, so nothing is appended
+    AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_persist_journal(
+            anjay, (avs_stream_t *) &outbuf));
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf), journal_size);
+
+    anjay_attr_storage_purge(anjay);
+
+    avs_stream_inbuf_t inbuf = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&inbuf, buf, journal_size);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ4, 0, (const anjay_iid_t[]) { 5, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(anjay, &OBJ4, 5, 0,
+                                         (const anjay_mock_dm_res_entry_t[]) {
+                                                 ANJAY_MOCK_DM_RES_END });
+    AVS_UNIT_ASSERT_SUCCESS(anjay_attr_storage_restore_journal(
+            anjay, (avs_stream_t *) &inbuf));
+    AVS_UNIT_ASSERT_FALSE(anjay_attr_storage_is_modified(anjay));
+    AVS_UNIT_ASSERT_EQUAL(anjay_attr_storage_journal_records(anjay), 2);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->attr_storage.objects),
+                          1);
+    assert_object_equal(
+            anjay_unlocked->attr_storage.objects,
+            test_object_entry(
+                    4, NULL,
+                    test_instance_entry(
+                            5,
+                            test_default_attrs(6,
+                                               7,
+                                               8,
+                                               ANJAY_ATTRIB_INTEGER_NONE,
+                                               ANJAY_ATTRIB_INTEGER_NONE,
+                                               ANJAY_DM_CON_ATTR_NONE),
+                            NULL),
+                    NULL));
+    ANJAY_MUTEX_UNLOCK(anjay);
+    PERSISTENCE_TEST_FINISH;
+}
+
 // TODO: Actually test removing nonexistent IIDs and RIDs
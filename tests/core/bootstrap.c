@@ -901,6 +901,60 @@ AVS_UNIT_TEST(bootstrap_delete, bs) {
     DM_TEST_FINISH;
 }
 
+#ifdef ANJAY_WITH_DISCOVER
+AVS_UNIT_TEST(bootstrap_discover, cached_within_session) {
+    DM_TEST_INIT_WITH_SSIDS(ANJAY_SSID_BOOTSTRAP);
+    // Bootstrap-Delete starts the Bootstrap session
+    DM_TEST_REQUEST(mocksocks[0], CON, DELETE, ID(0xFA3E), PATH("42", "34"));
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 14, 34, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_instance_remove(anjay, &OBJ, 34, 0);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, DELETED, ID(0xFA3E), NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    // the first Bootstrap-Discover reads the data model
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3F), PATH("42"),
+                    ACCEPT(0x28), NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 14, ANJAY_ID_INVALID });
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3F),
+                            CONTENT_FORMAT(LINK_FORMAT),
+                            PAYLOAD("lwm2m=\"1.0\",</42>,</42/14>"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    // the repeated one is served from the cache
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA40), PATH("42"),
+                    ACCEPT(0x28), NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA40),
+                            CONTENT_FORMAT(LINK_FORMAT),
+                            PAYLOAD("lwm2m=\"1.0\",</42>,</42/14>"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    // Bootstrap-Delete invalidates the cache
+    DM_TEST_REQUEST(mocksocks[0], CON, DELETE, ID(0xFA41), PATH("42", "14"));
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 14, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_instance_remove(anjay, &OBJ, 14, 0);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, DELETED, ID(0xFA41), NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA42), PATH("42"),
+                    ACCEPT(0x28), NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { ANJAY_ID_INVALID });
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA42),
+                            CONTENT_FORMAT(LINK_FORMAT),
+                            PAYLOAD("lwm2m=\"1.0\",</42>"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_DISCOVER
+
 static int fail_notify_perform(anjay_unlocked_t *anjay,
                                anjay_ssid_t origin_ssid,
                                anjay_notify_queue_t *queue_ptr) {
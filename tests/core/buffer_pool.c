@@ -0,0 +1,82 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+AVS_UNIT_TEST(buffer_pool, idle_entries_are_reused) {
+    anjay_buffer_pool_t pool;
+    _anjay_buffer_pool_init(&pool, 64, 128, 1);
+    AVS_UNIT_ASSERT_TRUE(_anjay_buffer_pool_enabled(&pool));
+
+    anjay_buffer_pool_entry_t *first = _anjay_buffer_pool_lease(&pool);
+    AVS_UNIT_ASSERT_NOT_NULL(first);
+    AVS_UNIT_ASSERT_EQUAL(first->in_buffer->capacity, 64);
+    AVS_UNIT_ASSERT_EQUAL(first->out_buffer->capacity, 128);
+    avs_shared_buffer_t *first_in_buffer = first->in_buffer;
+
+    // concurrently leased entries use distinct buffers
+    anjay_buffer_pool_entry_t *second = _anjay_buffer_pool_lease(&pool);
+    AVS_UNIT_ASSERT_NOT_NULL(second);
+    AVS_UNIT_ASSERT_TRUE(second->in_buffer != first->in_buffer);
+    AVS_UNIT_ASSERT_TRUE(second->out_buffer != first->out_buffer);
+
+    avs_coap_ctx_t *fake_ctx = (avs_coap_ctx_t *) &pool;
+    first->owner = fake_ctx;
+    AVS_UNIT_ASSERT_TRUE(_anjay_buffer_pool_find(&pool, fake_ctx) == first);
+    AVS_UNIT_ASSERT_NULL(_anjay_buffer_pool_find(&pool, NULL));
+
+    _anjay_buffer_pool_return(&pool, first);
+    AVS_UNIT_ASSERT_EQUAL(pool.idle_entries, 1);
+    AVS_UNIT_ASSERT_NULL(_anjay_buffer_pool_find(&pool, fake_ctx));
+
+    // only one idle entry is kept, so this one is freed
+    _anjay_buffer_pool_return(&pool, second);
+    AVS_UNIT_ASSERT_EQUAL(pool.idle_entries, 1);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(pool.entries), 1);
+
+    anjay_buffer_pool_entry_t *third = _anjay_buffer_pool_lease(&pool);
+    AVS_UNIT_ASSERT_NOT_NULL(third);
+    AVS_UNIT_ASSERT_TRUE(third->in_buffer == first_in_buffer);
+    AVS_UNIT_ASSERT_EQUAL(pool.idle_entries, 0);
+    _anjay_buffer_pool_return(&pool, third);
+
+    _anjay_buffer_pool_cleanup(&pool);
+    AVS_UNIT_ASSERT_NULL(pool.entries);
+}
+
+AVS_UNIT_TEST(buffer_pool, disabled_by_default) {
+    anjay_buffer_pool_t pool;
+    _anjay_buffer_pool_init(&pool, 64, 128, 0);
+    AVS_UNIT_ASSERT_FALSE(_anjay_buffer_pool_enabled(&pool));
+    _anjay_buffer_pool_cleanup(&pool);
+}
+
+AVS_UNIT_TEST(growable_buffers, grown_size) {
+    // no demand above current size
+    AVS_UNIT_ASSERT_EQUAL(grown_size(256, 0, 1024), 256);
+    AVS_UNIT_ASSERT_EQUAL(grown_size(256, 256, 1024), 256);
+    // grows at least twice
+    AVS_UNIT_ASSERT_EQUAL(grown_size(256, 300, 1024), 512);
+    AVS_UNIT_ASSERT_EQUAL(grown_size(256, 700, 1024), 700);
+    // never beyond the maximum
+    AVS_UNIT_ASSERT_EQUAL(grown_size(256, 4096, 1024), 1024);
+}
+
+AVS_UNIT_TEST(growable_buffers, disabled_if_sizes_equal) {
+    anjay_growable_buffers_t buffers;
+    _anjay_growable_buffers_init(&buffers, 1024, 1024, 2048, 2048);
+    AVS_UNIT_ASSERT_FALSE(_anjay_growable_buffers_enabled(&buffers));
+    // minimum sizes larger than maximum ones are clamped
+    _anjay_growable_buffers_init(&buffers, 4096, 1024, 256, 2048);
+    AVS_UNIT_ASSERT_EQUAL(buffers.in_min_size, 1024);
+    AVS_UNIT_ASSERT_TRUE(_anjay_growable_buffers_enabled(&buffers));
+    _anjay_growable_buffers_cleanup(&buffers);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+// Skeletons of X.509 certificates, containing only what is necessary to
+// extract the issuer and subject Names
+
+// issuer: R, subject: R
+static const char ROOT_CERT[] =
+        "\x30\x23\x30\x19\xa0\x03\x02\x01\x02\x02\x01\x01\x30\x03\x06\x01"
+        "\x2a\x30\x03\x0c\x01\x52\x30\x00\x30\x03\x0c\x01\x52\x30\x03\x06"
+        "\x01\x2a\x03\x01\x00";
+// issuer: R, subject: I
+static const char INTERMEDIATE_CERT[] =
+        "\x30\x23\x30\x19\xa0\x03\x02\x01\x02\x02\x01\x02\x30\x03\x06\x01"
+        "\x2a\x30\x03\x0c\x01\x52\x30\x00\x30\x03\x0c\x01\x49\x30\x03\x06"
+        "\x01\x2a\x03\x01\x00";
+// issuer: I, subject: L
+static const char LEAF_CERT[] =
+        "\x30\x23\x30\x19\xa0\x03\x02\x01\x02\x02\x01\x03\x30\x03\x06\x01"
+        "\x2a\x30\x03\x0c\x01\x49\x30\x00\x30\x03\x0c\x01\x4c\x30\x03\x06"
+        "\x01\x2a\x03\x01\x00";
+
+static void add_trusted_cert(anjay_trust_store_t *trust_store,
+                             const char *cert,
+                             size_t cert_size) {
+    AVS_LIST(avs_crypto_certificate_chain_info_t) elem =
+            AVS_LIST_NEW_ELEMENT(avs_crypto_certificate_chain_info_t);
+    AVS_UNIT_ASSERT_NOT_NULL(elem);
+    *elem = avs_crypto_certificate_chain_info_from_buffer(cert, cert_size);
+    AVS_LIST_APPEND(&trust_store->certs, elem);
+}
+
+static void complete_leaf_chain(anjay_unlocked_t *anjay,
+                                const anjay_trust_store_t *trust_store,
+                                anjay_security_config_cache_t *cache,
+                                avs_net_certificate_info_t *cert_info) {
+    avs_free(cache->client_cert_array);
+    AVS_UNIT_ASSERT_NOT_NULL(
+            (cache->client_cert_array =
+                     (avs_crypto_certificate_chain_info_t *) avs_malloc(
+                             sizeof(*cache->client_cert_array))));
+    *cache->client_cert_array = avs_crypto_certificate_chain_info_from_buffer(
+            LEAF_CERT, sizeof(LEAF_CERT) - 1);
+    memset(cert_info, 0, sizeof(*cert_info));
+    cert_info->client_cert = *cache->client_cert_array;
+    cert_info->rebuild_client_cert_chain = true;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_client_cert_chain_complete(
+            anjay, 1, trust_store, cache, 1, cert_info));
+}
+
+AVS_UNIT_TEST(cert_chain, chain_is_built_and_cached) {
+    anjay_unlocked_t anjay;
+    memset(&anjay, 0, sizeof(anjay));
+    anjay_trust_store_t trust_store = { 0 };
+    add_trusted_cert(&trust_store, ROOT_CERT, sizeof(ROOT_CERT) - 1);
+    add_trusted_cert(&trust_store, INTERMEDIATE_CERT,
+                     sizeof(INTERMEDIATE_CERT) - 1);
+    anjay_security_config_cache_t cache = { 0 };
+    avs_net_certificate_info_t cert_info;
+
+    complete_leaf_chain(&anjay, &trust_store, &cache, &cert_info);
+    AVS_UNIT_ASSERT_FALSE(cert_info.rebuild_client_cert_chain);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay.client_cert_chains), 1);
+    AVS_UNIT_ASSERT_EQUAL(anjay.client_cert_chains->chain_length, 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            cache.client_cert_array[1].desc.info.buffer.buffer,
+            INTERMEDIATE_CERT, sizeof(INTERMEDIATE_CERT) - 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            cache.client_cert_array[2].desc.info.buffer.buffer, ROOT_CERT,
+            sizeof(ROOT_CERT) - 1);
+    const avs_crypto_certificate_chain_info_t *cached_chain =
+            anjay.client_cert_chains->chain;
+
+    // the same chain is reused
+    complete_leaf_chain(&anjay, &trust_store, &cache, &cert_info);
+    AVS_UNIT_ASSERT_FALSE(cert_info.rebuild_client_cert_chain);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay.client_cert_chains), 1);
+    AVS_UNIT_ASSERT_TRUE(anjay.client_cert_chains->chain == cached_chain);
+
+    // the chain is rebuilt after the trust store changes
+    AVS_LIST_DELETE(&trust_store.certs);
+    ++trust_store.generation;
+    complete_leaf_chain(&anjay, &trust_store, &cache, &cert_info);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay.client_cert_chains), 1);
+    AVS_UNIT_ASSERT_EQUAL(anjay.client_cert_chains->chain_length, 2);
+
+    avs_free(cache.client_cert_array);
+    _anjay_client_cert_chains_cleanup(&anjay);
+    _anjay_trust_store_cleanup(&trust_store);
+}
+
+AVS_UNIT_TEST(cert_chain, system_trust_store_is_left_to_backend) {
+    anjay_unlocked_t anjay;
+    memset(&anjay, 0, sizeof(anjay));
+    anjay_trust_store_t trust_store = {
+        .use_system_wide = true
+    };
+    anjay_security_config_cache_t cache = { 0 };
+    avs_net_certificate_info_t cert_info;
+
+    complete_leaf_chain(&anjay, &trust_store, &cache, &cert_info);
+    AVS_UNIT_ASSERT_TRUE(cert_info.rebuild_client_cert_chain);
+    AVS_UNIT_ASSERT_NULL(anjay.client_cert_chains);
+
+    avs_free(cache.client_cert_array);
+}
@@ -205,6 +205,7 @@ struct coap_msg_args {
     const uint16_t *content_format;
     const uint16_t *accept;
     const uint32_t *observe;
+    const uint32_t *size2;
 
     const avs_coap_etag_t etag;
     const bool has_etag;
@@ -316,6 +317,10 @@ coap_msg__(aligned_buffer_t *buf,
         AVS_UNIT_ASSERT_SUCCESS(avs_coap_options_add_u32(
                 &options, AVS_COAP_OPTION_OBSERVE, *args->observe));
     }
+    if (args->size2) {
+        AVS_UNIT_ASSERT_SUCCESS(avs_coap_options_add_u32(
+                &options, AVS_COAP_OPTION_SIZE2, *args->size2));
+    }
 
     append_data(msg, buf_size, options.begin, options.size);
 
@@ -431,6 +436,12 @@ coap_msg__(aligned_buffer_t *buf,
         (Value)                      \
     }
 
+/* Used in COAP_MSG() to specify the Size2 option. */
+#define SIZE2(Value)               \
+    .size2 = (const uint32_t[1]) { \
+        (Value)                    \
+    }
+
 /* Used in COAP_MSG() to define a message with no payload or BLOCK options. */
 #define NO_PAYLOAD   \
     .block1 = { 0 }, \
@@ -477,6 +488,41 @@ coap_msg__(aligned_buffer_t *buf,
                                : (sizeof("" __VA_ARGS__) - 1               \
                                   - (Seq) * (Size)))
 
+/**
+ * Used in COAP_MSG to define BLOCK1 option of a request, along with the block
+ * payload.
+ * @p Seq         - the block sequence number.
+ * @p Size        - block size.
+ * @p Payload     - FULL PAYLOAD OF WHOLE BLOCK-WISE TRANSFER (!), from which
+ *                  the macro will extract the portion based on Seq and Size.
+ * @p PayloadSize - size of @p Payload.
+ */
+#define BLOCK1_EXTERNAL(Seq, Size, Payload, PayloadSize)                 \
+    .block1 = {                                                          \
+        .type = AVS_COAP_BLOCK1,                                         \
+        .seq_num = (assert((Seq) < (1 << 23)), (uint32_t) (Seq)),        \
+        .size = (assert((Size) < (1 << 15)), (uint16_t) (Size)),         \
+        .has_more = (((Seq) + 1) * (Size) < (PayloadSize))               \
+    },                                                                   \
+    .has_block1 = true, .block2 = { 0 },                                 \
+    .payload = ((const uint8_t *) (Payload)) + (Seq) * (Size),           \
+    .payload_size = (((Seq) + 1) * (Size) < (PayloadSize))               \
+                            ? (Size)                                     \
+                            : ((PayloadSize) - (Seq) * (Size))
+
+/**
+ * Used in COAP_MSG to define BLOCK1 option of a response acknowledging
+ * a request block, without any payload.
+ */
+#define BLOCK1_ACK(Seq, Size, HasMore)                            \
+    .block1 = {                                                   \
+        .type = AVS_COAP_BLOCK1,                                  \
+        .seq_num = (assert((Seq) < (1 << 23)), (uint32_t) (Seq)), \
+        .size = (assert((Size) < (1 << 15)), (uint16_t) (Size)),  \
+        .has_more = (HasMore)                                     \
+    },                                                            \
+    .has_block1 = true, .block2 = { 0 }, .payload = NULL, .payload_size = 0
+
 static inline void expect_has_buffered_data_check(avs_net_socket_t *mocksock,
                                                   bool has_buffered_data) {
     avs_unit_mocksock_expect_get_opt(mocksock, AVS_NET_SOCKET_HAS_BUFFERED_DATA,
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+AVS_UNIT_TEST(deferred_log, record_layout) {
+    anjay_deferred_log_t dlog;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_deferred_log_init(&dlog, 64));
+    _anjay_deferred_log_write(&dlog, (uint8_t) AVS_LOG_DEBUG, 0x0201, 2,
+                              (const uint32_t[]) { 0x04030201, 7 });
+
+    uint8_t buf[64];
+    AVS_UNIT_ASSERT_EQUAL(_anjay_deferred_log_read(&dlog, buf, sizeof(buf)),
+                          16);
+    AVS_UNIT_ASSERT_EQUAL(buf[0], 0x01);
+    AVS_UNIT_ASSERT_EQUAL(buf[1], 0x02);
+    AVS_UNIT_ASSERT_EQUAL(buf[2], (uint8_t) AVS_LOG_DEBUG);
+    AVS_UNIT_ASSERT_EQUAL(buf[3], 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            &buf[8], "\x01\x02\x03\x04\x07\x00\x00\x00", 8);
+    // records are removed once read
+    AVS_UNIT_ASSERT_EQUAL(_anjay_deferred_log_read(&dlog, buf, sizeof(buf)),
+                          0);
+    _anjay_deferred_log_cleanup(&dlog);
+}
+
+AVS_UNIT_TEST(deferred_log, oldest_records_are_dropped) {
+    anjay_deferred_log_t dlog;
+    // space for two 12-byte records and a part of the third one
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_deferred_log_init(&dlog, 30));
+    for (uint32_t i = 1; i <= 3; ++i) {
+        _anjay_deferred_log_write(&dlog, (uint8_t) AVS_LOG_DEBUG, 1, 1,
+                                  (const uint32_t[]) { i });
+    }
+
+    uint8_t buf[64];
+    // only whole records are copied
+    AVS_UNIT_ASSERT_EQUAL(_anjay_deferred_log_read(&dlog, buf, 20), 12);
+    AVS_UNIT_ASSERT_EQUAL(buf[8], 2);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_deferred_log_read(&dlog, buf, sizeof(buf)),
+                          12);
+    AVS_UNIT_ASSERT_EQUAL(buf[8], 3);
+    _anjay_deferred_log_cleanup(&dlog);
+}
+
+AVS_UNIT_TEST(deferred_log, record_larger_than_buffer_is_ignored) {
+    anjay_deferred_log_t dlog;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_deferred_log_init(&dlog, 16));
+    _anjay_deferred_log_write(&dlog, (uint8_t) AVS_LOG_DEBUG, 1, 3,
+                              (const uint32_t[]) { 1, 2, 3 });
+    uint8_t buf[64];
+    AVS_UNIT_ASSERT_EQUAL(_anjay_deferred_log_read(&dlog, buf, sizeof(buf)),
+                          0);
+    _anjay_deferred_log_cleanup(&dlog);
+}
@@ -15,6 +15,8 @@
 #include <avsystem/commons/avs_unit_mocksock.h>
 #include <avsystem/commons/avs_unit_test.h>
 
+#include <anjay/dm_table.h>
+
 #include "src/core/anjay_core.h"
 #include "src/core/io/anjay_vtable.h"
 #include "src/core/servers/anjay_servers_internal.h"
@@ -108,6 +110,29 @@ AVS_UNIT_TEST(dm_read, resource_instance_read_err_generic) {
     DM_TEST_FINISH;
 }
 
+AVS_UNIT_TEST(dm_read, resource_instance_read_busy) {
+    DM_TEST_INIT;
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E),
+                    PATH("42", "53", "64", "75"), NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 53, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 53, 0,
+            (const anjay_mock_dm_res_entry_t[]) { { 64, ANJAY_DM_RES_RM,
+                                                    ANJAY_DM_RES_PRESENT },
+                                                  ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_list_resource_instances(
+            anjay, &OBJ, 53, 64, 0,
+            (const anjay_riid_t[]) { 75, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 53, 64, 75,
+                                        ANJAY_ERR_BUSY, ANJAY_MOCK_DM_NONE);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, SERVICE_UNAVAILABLE,
+                            ID(0xFA3E), NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(dm_read, resource_instance_not_found_because_not_present) {
     DM_TEST_INIT;
     DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E),
@@ -158,6 +183,36 @@ AVS_UNIT_TEST(dm_read, resource) {
     DM_TEST_FINISH;
 }
 
+#ifdef ANJAY_WITH_OPERATION_STATS
+AVS_UNIT_TEST(dm_read, content_format_payload_counted) {
+    DM_TEST_INIT;
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "69", "4"),
+                    NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 514));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    uint64_t payloads;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_content_format_payloads(
+            anjay, 1, AVS_COAP_FORMAT_PLAINTEXT, &payloads));
+    AVS_UNIT_ASSERT_EQUAL(payloads, 1);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_content_format_payloads(
+            anjay, 1, AVS_COAP_FORMAT_SENML_CBOR, &payloads));
+    AVS_UNIT_ASSERT_EQUAL(payloads, 0);
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_OPERATION_STATS
+
 AVS_UNIT_TEST(dm_read, resource_read_err_concrete) {
     DM_TEST_INIT;
     DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "69", "4"),
@@ -293,6 +348,259 @@ AVS_UNIT_TEST(dm_read, instance_some) {
     DM_TEST_FINISH;
 }
 
+static anjay_rid_t READ_MANY_RIDS[8];
+static size_t READ_MANY_RID_COUNT;
+
+static int read_many_record(anjay_t *anjay,
+                            const anjay_dm_object_def_t *const *obj_ptr,
+                            anjay_iid_t iid,
+                            const anjay_rid_t *rids,
+                            size_t rid_count) {
+    (void) anjay;
+    (void) obj_ptr;
+    AVS_UNIT_ASSERT_EQUAL(iid, 13);
+    AVS_UNIT_ASSERT_TRUE(rid_count <= AVS_ARRAY_SIZE(READ_MANY_RIDS));
+    memcpy(READ_MANY_RIDS, rids, rid_count * sizeof(*rids));
+    READ_MANY_RID_COUNT = rid_count;
+    return 0;
+}
+
+static const anjay_dm_object_def_t *const OBJ_WITH_READ_MANY =
+        &(const anjay_dm_object_def_t) {
+            .oid = 42,
+            .handlers = { ANJAY_MOCK_DM_HANDLERS,
+                          .resource_read_many = read_many_record }
+        };
+
+AVS_UNIT_TEST(dm_read, instance_read_many) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ_WITH_READ_MANY, &FAKE_SECURITY,
+                              &FAKE_SERVER);
+    READ_MANY_RID_COUNT = 0;
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "13"),
+                    NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ_WITH_READ_MANY, 0,
+            (const anjay_iid_t[]) { 13, 14, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ_WITH_READ_MANY, 13, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 2, ANJAY_DM_RES_E, ANJAY_DM_RES_PRESENT },
+                    { 6, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ_WITH_READ_MANY, 13, 0,
+                                        ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 69));
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ_WITH_READ_MANY, 13, 6,
+                                        ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_STRING(0, "Hello"));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(OMA_LWM2M_TLV),
+                            PAYLOAD("\xc1\x00\x45"
+                                    "\xc5\x06"
+                                    "Hello"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    AVS_UNIT_ASSERT_EQUAL(READ_MANY_RID_COUNT, 2);
+    AVS_UNIT_ASSERT_EQUAL(READ_MANY_RIDS[0], 0);
+    AVS_UNIT_ASSERT_EQUAL(READ_MANY_RIDS[1], 6);
+    DM_TEST_FINISH;
+}
+
+static int read_instances_samples(anjay_t *anjay,
+                                  const anjay_dm_object_def_t *const *obj_ptr,
+                                  anjay_iid_t iid,
+                                  anjay_rid_t rid,
+                                  anjay_dm_res_instances_t *out) {
+    (void) anjay;
+    (void) obj_ptr;
+    static const anjay_riid_t RIIDS[] = { 1, 5 };
+    static const int64_t VALUES[] = { 7, 300 };
+    AVS_UNIT_ASSERT_EQUAL(iid, 69);
+    if (rid != 4) {
+        return ANJAY_ERR_NOT_IMPLEMENTED;
+    }
+    out->type = ANJAY_DM_RES_INSTANCES_INT;
+    out->count = AVS_ARRAY_SIZE(RIIDS);
+    out->riids = RIIDS;
+    out->values.as_int = VALUES;
+    return 0;
+}
+
+static const anjay_dm_object_def_t *const OBJ_WITH_READ_INSTANCES =
+        &(const anjay_dm_object_def_t) {
+            .oid = 42,
+            .handlers = { ANJAY_MOCK_DM_HANDLERS,
+                          .resource_read_instances = read_instances_samples }
+        };
+
+AVS_UNIT_TEST(dm_read, multiple_resource_read_instances) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ_WITH_READ_INSTANCES, &FAKE_SECURITY,
+                              &FAKE_SERVER);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "69", "4"),
+                    NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ_WITH_READ_INSTANCES, 0,
+            (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ_WITH_READ_INSTANCES, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 4, ANJAY_DM_RES_RM, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    // no list_resource_instances nor resource_read calls expected
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(OMA_LWM2M_TLV),
+                            PAYLOAD("\x87\x04"
+                                    "\x41\x01\x07"
+                                    "\x42\x05\x01\x2c"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+typedef struct {
+    int32_t value;
+    char name[8];
+} table_instance_t;
+
+static table_instance_t TABLE_INSTANCES[2];
+
+static const anjay_dm_table_resource_def_t TABLE_RESOURCES[] = {
+    ANJAY_DM_TABLE_RESOURCE(0, ANJAY_DM_RES_RW, I32, table_instance_t, value),
+    ANJAY_DM_TABLE_RESOURCE(1, ANJAY_DM_RES_R, STRING, table_instance_t, name)
+};
+
+static anjay_dm_table_object_t TABLE_OBJ = {
+    .def = &(const anjay_dm_object_def_t) {
+        .oid = 42,
+        .handlers = { ANJAY_DM_TABLE_HANDLERS }
+    },
+    .resources = TABLE_RESOURCES,
+    .resource_count = AVS_ARRAY_SIZE(TABLE_RESOURCES),
+    .instances = TABLE_INSTANCES,
+    .instance_size = sizeof(TABLE_INSTANCES[0]),
+    .instance_count = AVS_ARRAY_SIZE(TABLE_INSTANCES)
+};
+
+AVS_UNIT_TEST(dm_read, table_object) {
+    DM_TEST_INIT_WITH_OBJECTS(&TABLE_OBJ.def, &FAKE_SECURITY, &FAKE_SERVER);
+    TABLE_INSTANCES[1].value = 69;
+    strcpy(TABLE_INSTANCES[1].name, "Hi");
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "1"),
+                    NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(OMA_LWM2M_TLV),
+                            PAYLOAD("\xc1\x00\x45"
+                                    "\xc2\x01"
+                                    "Hi"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3F), PATH("42", "2"),
+                    NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, NOT_FOUND, ID(0xFA3F),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+static table_instance_t DYNAMIC_TABLE_INSTANCES[40];
+static uint32_t DYNAMIC_TABLE_PRESENCE[ANJAY_DM_TABLE_BITMAP_SIZE(
+        AVS_ARRAY_SIZE(DYNAMIC_TABLE_INSTANCES))];
+
+static anjay_dm_table_object_t DYNAMIC_TABLE_OBJ = {
+    .def = &(const anjay_dm_object_def_t) {
+        .oid = 42,
+        .handlers = { ANJAY_DM_TABLE_DYNAMIC_HANDLERS }
+    },
+    .resources = TABLE_RESOURCES,
+    .resource_count = AVS_ARRAY_SIZE(TABLE_RESOURCES),
+    .instances = DYNAMIC_TABLE_INSTANCES,
+    .instance_size = sizeof(DYNAMIC_TABLE_INSTANCES[0]),
+    .instance_count = AVS_ARRAY_SIZE(DYNAMIC_TABLE_INSTANCES),
+    .present_instances = DYNAMIC_TABLE_PRESENCE
+};
+
+AVS_UNIT_TEST(dm_read, dynamic_table_object) {
+    DM_TEST_INIT_WITH_OBJECTS(&DYNAMIC_TABLE_OBJ.def, &FAKE_SECURITY,
+                              &FAKE_SERVER);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_dm_table_instance_set_present(&DYNAMIC_TABLE_OBJ, 33, true));
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_dm_table_instance_set_present(&DYNAMIC_TABLE_OBJ, 40, true));
+    DYNAMIC_TABLE_INSTANCES[33].value = 69;
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "33", "0"),
+                    NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("69"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3F), PATH("42", "1"),
+                    NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, NOT_FOUND, ID(0xFA3F),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_REQUEST(mocksocks[0], CON, DELETE, ID(0xFA40), PATH("42", "33"));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, DELETED, ID(0xFA40),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    AVS_UNIT_ASSERT_FALSE(
+            anjay_dm_table_instance_present(&DYNAMIC_TABLE_OBJ, 33));
+    DM_TEST_FINISH;
+}
+
+static size_t INSTANCE_PRESENT_CALLS;
+
+static int instance_present_13(anjay_t *anjay,
+                               const anjay_dm_object_def_t *const *obj_ptr,
+                               anjay_iid_t iid) {
+    (void) anjay;
+    (void) obj_ptr;
+    ++INSTANCE_PRESENT_CALLS;
+    return iid == 13;
+}
+
+static const anjay_dm_object_def_t *const OBJ_WITH_INSTANCE_PRESENT =
+        &(const anjay_dm_object_def_t) {
+            .oid = 42,
+            .handlers = { ANJAY_MOCK_DM_HANDLERS,
+                          .instance_present = instance_present_13 }
+        };
+
+AVS_UNIT_TEST(dm_read, instance_present_handler) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ_WITH_INSTANCE_PRESENT, &FAKE_SECURITY,
+                              &FAKE_SERVER);
+    INSTANCE_PRESENT_CALLS = 0;
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "13"),
+                    NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ_WITH_INSTANCE_PRESENT, 13, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 0, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ_WITH_INSTANCE_PRESENT, 13,
+                                        0, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 69));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(OMA_LWM2M_TLV),
+                            PAYLOAD("\xc1\x00\x45"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    AVS_UNIT_ASSERT_EQUAL(INSTANCE_PRESENT_CALLS, 1);
+
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3F), PATH("42", "14"),
+                    NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, NOT_FOUND, ID(0xFA3F),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    AVS_UNIT_ASSERT_EQUAL(INSTANCE_PRESENT_CALLS, 2);
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(dm_read, instance_resource_not_found) {
     DM_TEST_INIT;
     DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "13"),
@@ -1358,6 +1666,55 @@ AVS_UNIT_TEST(dm_write_composite, write_to_resource_of_nonexistent_instance) {
     AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
     DM_TEST_FINISH;
 }
+
+AVS_UNIT_TEST(dm_write_composite, instance_verified_once_per_group) {
+    DM_TEST_INIT;
+    static const char PAYLOAD[] = "\x83\xa2\x00\x67"
+                                  "/42/1/2"
+                                  "\x02\x18\x2a"
+                                  "\xa2\x00\x67"
+                                  "/42/1/3"
+                                  "\x02\x18\x2b"
+                                  "\xa2\x00\x67"
+                                  "/42/4/2"
+                                  "\x02\x18\x2c";
+    DM_TEST_REQUEST(mocksocks[0], CON, IPATCH, ID(0xFA3E),
+                    CONTENT_FORMAT(SENML_CBOR),
+                    PAYLOAD_EXTERNAL(PAYLOAD, sizeof(PAYLOAD) - 1));
+    // /42/1 is only checked for presence before the first of its resources
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 1, 4, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 1, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_write(anjay, &OBJ, 1, 2, ANJAY_ID_INVALID,
+                                         ANJAY_MOCK_DM_INT(0, 42), 0);
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 1, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_write(anjay, &OBJ, 1, 3, ANJAY_ID_INVALID,
+                                         ANJAY_MOCK_DM_INT(0, 43), 0);
+    // a different Instance is verified again
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 1, 4, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 4, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_write(anjay, &OBJ, 4, 2, ANJAY_ID_INVALID,
+                                         ANJAY_MOCK_DM_INT(0, 44), 0);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CHANGED, ID(0xFA3E), NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
 #endif // ANJAY_WITH_LWM2M11
 
 AVS_UNIT_TEST(dm_execute, success) {
@@ -1736,6 +2093,81 @@ AVS_UNIT_TEST(dm_execute, valid_values_partial_read) {
     DM_TEST_FINISH;
 }
 
+static int
+valid_values_view_execute(anjay_t *anjay,
+                          const anjay_dm_object_def_t *const *obj_ptr,
+                          anjay_iid_t iid,
+                          anjay_rid_t rid,
+                          anjay_execute_ctx_t *ctx) {
+    (void) iid;
+    (void) rid;
+    (void) anjay;
+    (void) obj_ptr;
+    int arg;
+    bool has_value;
+    const char *value;
+    size_t value_size;
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_execute_get_next_arg(ctx, &arg, &has_value));
+    AVS_UNIT_ASSERT_EQUAL(arg, 0);
+    AVS_UNIT_ASSERT_EQUAL(has_value, false);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_execute_get_arg_value_view(ctx, &value, &value_size));
+    AVS_UNIT_ASSERT_EQUAL(value_size, 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_execute_get_next_arg(ctx, &arg, &has_value));
+    AVS_UNIT_ASSERT_EQUAL(arg, 1);
+    AVS_UNIT_ASSERT_EQUAL(has_value, true);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_execute_get_arg_value_view(ctx, &value, &value_size));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(value, "value", value_size);
+    AVS_UNIT_ASSERT_EQUAL(value_size, strlen("value"));
+
+    /* Mixing with copying reads. */
+    AVS_UNIT_ASSERT_SUCCESS(anjay_execute_get_next_arg(ctx, &arg, &has_value));
+    AVS_UNIT_ASSERT_EQUAL(arg, 2);
+    AVS_UNIT_ASSERT_EQUAL(has_value, true);
+    char buf[4];
+    AVS_UNIT_ASSERT_EQUAL(anjay_execute_get_arg_value(ctx, NULL, buf, 4),
+                          ANJAY_BUFFER_TOO_SHORT);
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, "lon");
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_execute_get_arg_value_view(ctx, &value, &value_size));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(value, "ger", value_size);
+    AVS_UNIT_ASSERT_EQUAL(value_size, strlen("ger"));
+
+    AVS_UNIT_ASSERT_EQUAL(anjay_execute_get_next_arg(ctx, &arg, &has_value),
+                          ANJAY_EXECUTE_GET_ARG_END);
+    return 0;
+}
+
+AVS_UNIT_TEST(dm_execute, valid_values_view) {
+    DM_TEST_INIT;
+    EXECUTE_OBJ->handlers.resource_execute = valid_values_view_execute;
+    DM_TEST_REQUEST(mocksocks[0], CON, POST, ID(0xFA3E),
+                    PATH("128", "514", "1"), PAYLOAD("0,1='value',2='longer'"));
+
+    _anjay_mock_dm_expect_list_instances(
+            anjay, (const anjay_dm_object_def_t *const *) &EXECUTE_OBJ, 0,
+            (const anjay_iid_t[]) { 14, 42, 69, 514, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, (const anjay_dm_object_def_t *const *) &EXECUTE_OBJ, 514, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 0, ANJAY_DM_RES_E, ANJAY_DM_RES_ABSENT },
+                    { 1, ANJAY_DM_RES_E, ANJAY_DM_RES_PRESENT },
+                    { 2, ANJAY_DM_RES_E, ANJAY_DM_RES_ABSENT },
+                    { 3, ANJAY_DM_RES_E, ANJAY_DM_RES_ABSENT },
+                    { 4, ANJAY_DM_RES_E, ANJAY_DM_RES_ABSENT },
+                    { 5, ANJAY_DM_RES_E, ANJAY_DM_RES_ABSENT },
+                    { 6, ANJAY_DM_RES_E, ANJAY_DM_RES_ABSENT },
+                    ANJAY_MOCK_DM_RES_END });
+
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CHANGED, ID(0xFA3E), NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
 static int
 valid_values_skipping_execute(anjay_t *anjay,
                               const anjay_dm_object_def_t *const *obj_ptr,
@@ -3235,6 +3667,117 @@ AVS_UNIT_TEST(dm_effective_attrs, fallback_to_server) {
     DM_TEST_FINISH;
 }
 
+static void expect_server_period_reads(anjay_t *anjay,
+                                       int32_t pmin,
+                                       int32_t pmax) {
+    static const anjay_mock_dm_res_entry_t RESOURCES[] = {
+        { ANJAY_DM_RID_SERVER_SSID, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT },
+        { ANJAY_DM_RID_SERVER_LIFETIME, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+        { ANJAY_DM_RID_SERVER_DEFAULT_PMIN, ANJAY_DM_RES_RW,
+          ANJAY_DM_RES_PRESENT },
+        { ANJAY_DM_RID_SERVER_DEFAULT_PMAX, ANJAY_DM_RES_RW,
+          ANJAY_DM_RES_PRESENT },
+        { ANJAY_DM_RID_SERVER_NOTIFICATION_STORING, ANJAY_DM_RES_RW,
+          ANJAY_DM_RES_ABSENT },
+        { ANJAY_DM_RID_SERVER_BINDING, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+        ANJAY_MOCK_DM_RES_END
+    };
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &FAKE_SERVER, 0,
+            (const anjay_iid_t[]) { 1, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(anjay, &FAKE_SERVER, 1, 0, RESOURCES);
+    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, 1,
+                                        ANJAY_DM_RID_SERVER_SSID,
+                                        ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 1));
+    _anjay_mock_dm_expect_list_resources(anjay, &FAKE_SERVER, 1, 0, RESOURCES);
+    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, 1,
+                                        ANJAY_DM_RID_SERVER_DEFAULT_PMIN,
+                                        ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, pmin));
+    _anjay_mock_dm_expect_list_resources(anjay, &FAKE_SERVER, 1, 0, RESOURCES);
+    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, 1,
+                                        ANJAY_DM_RID_SERVER_DEFAULT_PMAX,
+                                        ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, pmax));
+}
+
+static void assert_combined_server_periods(anjay_unlocked_t *anjay,
+                                           int32_t pmin,
+                                           int32_t pmax) {
+    anjay_dm_oi_attributes_t attrs = ANJAY_DM_OI_ATTRIBUTES_EMPTY;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_dm_read_combined_server_attrs(anjay, 1, &attrs));
+    AVS_UNIT_ASSERT_EQUAL(attrs.min_period, pmin);
+    AVS_UNIT_ASSERT_EQUAL(attrs.max_period, pmax);
+}
+
+AVS_UNIT_TEST(dm_effective_attrs, cached_server_params) {
+    DM_TEST_INIT_WITH_CONFIG(.cache_server_params = true);
+    (void) mocksocks;
+    expect_server_period_reads(anjay, 5, 42);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    assert_combined_server_periods(anjay_unlocked, 5, 42);
+    // no data model calls expected this time
+    assert_combined_server_periods(anjay_unlocked, 5, 42);
+
+    // a change to the Server Object drops the cached values
+    _anjay_dm_cache_invalidate_instances(anjay_unlocked, ANJAY_DM_OID_SERVER);
+    expect_server_period_reads(anjay, 7, 99);
+    assert_combined_server_periods(anjay_unlocked, 7, 99);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    DM_TEST_FINISH;
+}
+
+static void expect_server_ssid_reads(anjay_t *anjay,
+                                     const anjay_iid_t *iids,
+                                     const anjay_ssid_t *ssids) {
+    static const anjay_mock_dm_res_entry_t RESOURCES[] = {
+        { ANJAY_DM_RID_SERVER_SSID, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT },
+        ANJAY_MOCK_DM_RES_END
+    };
+    _anjay_mock_dm_expect_list_instances(anjay, &FAKE_SERVER, 0, iids);
+    for (size_t i = 0; iids[i] != ANJAY_ID_INVALID; ++i) {
+        _anjay_mock_dm_expect_list_resources(anjay, &FAKE_SERVER, iids[i], 0,
+                                             RESOURCES);
+        _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, iids[i],
+                                            ANJAY_DM_RID_SERVER_SSID,
+                                            ANJAY_ID_INVALID, 0,
+                                            ANJAY_MOCK_DM_INT(0, ssids[i]));
+    }
+}
+
+AVS_UNIT_TEST(dm_query, cached_server_ids) {
+    DM_TEST_INIT_WITH_CONFIG(.cache_server_params = true);
+    (void) mocksocks;
+    expect_server_ssid_reads(anjay,
+                             (const anjay_iid_t[]) { 1, 2, ANJAY_ID_INVALID },
+                             (const anjay_ssid_t[]) { 14, 15 });
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_iid_t iid = ANJAY_ID_INVALID;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_find_server_iid(anjay_unlocked, 15, &iid));
+    AVS_UNIT_ASSERT_EQUAL(iid, 2);
+    // no data model calls expected this time
+    anjay_ssid_t ssid = 0;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ssid_from_server_iid(anjay_unlocked, 1,
+                                                        &ssid));
+    AVS_UNIT_ASSERT_EQUAL(ssid, 14);
+    AVS_UNIT_ASSERT_FAILED(_anjay_find_server_iid(anjay_unlocked, 16, &iid));
+    AVS_UNIT_ASSERT_FAILED(_anjay_ssid_from_server_iid(anjay_unlocked, 3,
+                                                       &ssid));
+
+    // a change to the Server Object drops the cached identifiers
+    _anjay_dm_cache_invalidate_instances(anjay_unlocked, ANJAY_DM_OID_SERVER);
+    expect_server_ssid_reads(anjay,
+                             (const anjay_iid_t[]) { 3, ANJAY_ID_INVALID },
+                             (const anjay_ssid_t[]) { 16 });
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_find_server_iid(anjay_unlocked, 16, &iid));
+    AVS_UNIT_ASSERT_EQUAL(iid, 3);
+    AVS_UNIT_ASSERT_FAILED(_anjay_find_server_iid(anjay_unlocked, 15, &iid));
+    ANJAY_MUTEX_UNLOCK(anjay);
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(dm_effective_attrs, resource_fail) {
     DM_TEST_INIT;
     (void) mocksocks;
@@ -4069,3 +4612,545 @@ AVS_UNIT_TEST(dm_res_read, u64_array_multiple_elements) {
     DM_TEST_FINISH;
 }
 #endif // ANJAY_WITH_LWM2M11
+
+AVS_UNIT_TEST(dm_object_index, find_object_by_oid) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->dm.objects_index_size,
+                          AVS_LIST_SIZE(anjay_unlocked->dm.objects));
+    AVS_LIST(anjay_dm_installed_object_t) obj;
+    AVS_LIST_FOREACH(obj, anjay_unlocked->dm.objects) {
+        AVS_UNIT_ASSERT_TRUE(
+                _anjay_dm_find_object_by_oid(
+                        anjay_unlocked, _anjay_dm_installed_object_oid(obj))
+                == obj);
+    }
+    AVS_UNIT_ASSERT_NULL(_anjay_dm_find_object_by_oid(anjay_unlocked, 2));
+    AVS_UNIT_ASSERT_NULL(_anjay_dm_find_object_by_oid(anjay_unlocked, 100));
+    AVS_UNIT_ASSERT_NULL(_anjay_dm_find_object_by_oid(anjay_unlocked, 65534));
+    ANJAY_MUTEX_UNLOCK(anjay);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_instance_cache, list_reused_until_invalidated) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+    ASSERT_OK(anjay_set_instance_list_caching(anjay, OBJ->oid, true));
+    ASSERT_FAIL(anjay_set_instance_list_caching(anjay, 2, true));
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 3, 7, ANJAY_ID_INVALID });
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(anjay_unlocked, OBJ->oid);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_dm_instance_present(anjay_unlocked, obj, 7),
+                          1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_dm_instance_present(anjay_unlocked, obj, 3),
+                          1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_dm_instance_present(anjay_unlocked, obj, 5),
+                          0);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    _anjay_mock_dm_expect_clean();
+
+    ASSERT_OK(anjay_notify_instances_changed(anjay, OBJ->oid));
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 5, ANJAY_ID_INVALID });
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_dm_instance_present(anjay_unlocked, obj, 5),
+                          1);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    _anjay_mock_dm_expect_clean();
+
+    ASSERT_OK(anjay_set_instance_list_caching(anjay, OBJ->oid, false));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_instance_cache, first_free_iid) {
+    anjay_iid_t instances[] = { 0, 1, 2, 4, 5 };
+    anjay_dm_object_cache_t cache = {
+        .instance_count = AVS_ARRAY_SIZE(instances),
+        .instances = instances
+    };
+    AVS_UNIT_ASSERT_EQUAL(_anjay_dm_cache_first_free_iid(&cache), 3);
+    cache.instance_count = 3;
+    AVS_UNIT_ASSERT_EQUAL(_anjay_dm_cache_first_free_iid(&cache), 3);
+    cache.instance_count = 0;
+    AVS_UNIT_ASSERT_EQUAL(_anjay_dm_cache_first_free_iid(&cache), 0);
+    cache.instances = &instances[3];
+    cache.instance_count = 2;
+    AVS_UNIT_ASSERT_EQUAL(_anjay_dm_cache_first_free_iid(&cache), 0);
+}
+
+AVS_UNIT_TEST(dm_instance_cache, create_instances) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+    ASSERT_OK(anjay_set_instance_list_caching(anjay, OBJ->oid, true));
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0,
+            (const anjay_iid_t[]) { 0, 1, 3, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_instance_create(anjay, &OBJ, 2, 0);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0,
+            (const anjay_iid_t[]) { 0, 1, 2, 3, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_instance_create(anjay, &OBJ, 4, 0);
+    anjay_iid_t iids[2];
+    ASSERT_OK(anjay_create_instances(anjay, OBJ->oid, 2, iids));
+    AVS_UNIT_ASSERT_EQUAL(iids[0], 2);
+    AVS_UNIT_ASSERT_EQUAL(iids[1], 4);
+    _anjay_mock_dm_expect_clean();
+
+    ASSERT_FAIL(anjay_create_instances(anjay, 2, 1, iids));
+    ASSERT_OK(anjay_set_instance_list_caching(anjay, OBJ->oid, false));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_resource_cache, list_reused_for_same_instance) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+    ASSERT_OK(anjay_set_resource_list_caching(anjay, OBJ->oid, true));
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 3, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 1, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT },
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 6, ANJAY_DM_RES_RM, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(anjay_unlocked, OBJ->oid);
+    anjay_dm_resource_kind_t kind;
+    anjay_dm_resource_presence_t presence;
+    ASSERT_OK(_anjay_dm_resource_kind_and_presence(anjay_unlocked, obj, 3, 6,
+                                                   &kind, &presence));
+    AVS_UNIT_ASSERT_EQUAL(kind, ANJAY_DM_RES_RM);
+    AVS_UNIT_ASSERT_EQUAL(presence, ANJAY_DM_RES_PRESENT);
+    ASSERT_OK(_anjay_dm_resource_kind_and_presence(anjay_unlocked, obj, 3, 4,
+                                                   &kind, &presence));
+    AVS_UNIT_ASSERT_EQUAL(kind, ANJAY_DM_RES_RW);
+    AVS_UNIT_ASSERT_EQUAL(presence, ANJAY_DM_RES_ABSENT);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_dm_resource_kind_and_presence(
+                                  anjay_unlocked, obj, 3, 5, NULL, NULL),
+                          ANJAY_ERR_NOT_FOUND);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    _anjay_mock_dm_expect_clean();
+
+    ASSERT_OK(anjay_notify_changed(anjay, OBJ->oid, 3, 4));
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 3, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 1, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT },
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    ASSERT_OK(_anjay_dm_resource_kind_and_presence(anjay_unlocked, obj, 3, 4,
+                                                   NULL, &presence));
+    AVS_UNIT_ASSERT_EQUAL(presence, ANJAY_DM_RES_PRESENT);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    _anjay_mock_dm_expect_clean();
+
+    ASSERT_OK(anjay_set_resource_list_caching(anjay, OBJ->oid, false));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_transaction, participants_tracked) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ, &OBJ_WITH_TRANSACTION, &FAKE_SECURITY,
+                              &FAKE_SERVER);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    const anjay_dm_installed_object_t *obj =
+            _anjay_dm_find_object_by_oid(anjay_unlocked, OBJ->oid);
+    const anjay_dm_installed_object_t *obj_with_transaction =
+            _anjay_dm_find_object_by_oid(anjay_unlocked,
+                                         OBJ_WITH_TRANSACTION->oid);
+    AVS_UNIT_ASSERT_TRUE(
+            avs_is_ok(_anjay_dm_transaction_begin(anjay_unlocked)));
+    AVS_UNIT_ASSERT_FALSE(_anjay_dm_transaction_object_included(
+            anjay_unlocked, obj_with_transaction));
+
+    _anjay_mock_dm_expect_transaction_begin(anjay, &OBJ_WITH_TRANSACTION, 0);
+    ASSERT_OK(_anjay_dm_transaction_include_object(anjay_unlocked,
+                                                   obj_with_transaction));
+    // including the same Object again does not begin another transaction
+    ASSERT_OK(_anjay_dm_transaction_include_object(anjay_unlocked,
+                                                   obj_with_transaction));
+    ASSERT_OK(_anjay_dm_transaction_include_object(anjay_unlocked, obj));
+    AVS_UNIT_ASSERT_TRUE(_anjay_dm_transaction_object_included(
+            anjay_unlocked, obj_with_transaction));
+    AVS_UNIT_ASSERT_TRUE(
+            _anjay_dm_transaction_object_included(anjay_unlocked, obj));
+    AVS_UNIT_ASSERT_EQUAL(
+            anjay_unlocked->transaction_state.objs_in_transaction_count, 2);
+
+    _anjay_mock_dm_expect_transaction_validate(anjay, &OBJ_WITH_TRANSACTION,
+                                               0);
+    _anjay_mock_dm_expect_transaction_commit(anjay, &OBJ_WITH_TRANSACTION, 0);
+    ASSERT_OK(_anjay_dm_transaction_finish(anjay_unlocked, 0));
+    AVS_UNIT_ASSERT_EQUAL(
+            anjay_unlocked->transaction_state.objs_in_transaction_count, 0);
+    AVS_UNIT_ASSERT_FALSE(
+            _anjay_dm_find_object_index_entry(anjay_unlocked, OBJ->oid)
+                    ->in_transaction);
+    AVS_UNIT_ASSERT_FALSE(_anjay_dm_find_object_index_entry(
+                                  anjay_unlocked, OBJ_WITH_TRANSACTION->oid)
+                                  ->in_transaction);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    _anjay_mock_dm_expect_clean();
+    DM_TEST_FINISH;
+}
+
+#ifdef ANJAY_WITH_THREAD_SAFETY
+static void sequential_executor(void *calls_count_,
+                                size_t count,
+                                anjay_parallel_job_t *job,
+                                void *job_arg) {
+    ++*(size_t *) calls_count_;
+    // run in reverse order to make sure the result does not depend on it
+    for (size_t i = count; i-- > 0;) {
+        job(job_arg, i);
+    }
+}
+
+AVS_UNIT_TEST(dm_transaction, parallel_validation) {
+    size_t executor_calls = 0;
+    const anjay_dm_object_def_t *const *obj_defs[] = {
+        &OBJ, &OBJ_WITH_TRANSACTION, &FAKE_SECURITY, &FAKE_SERVER
+    };
+    anjay_ssid_t ssids[] = { 1 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids,
+                         DM_TEST_CONFIGURATION(
+                                 .transaction_validate_executor =
+                                         sequential_executor,
+                                 .transaction_validate_executor_arg =
+                                         &executor_calls));
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_TRUE(
+            avs_is_ok(_anjay_dm_transaction_begin(anjay_unlocked)));
+    _anjay_mock_dm_expect_transaction_begin(anjay, &OBJ_WITH_TRANSACTION, 0);
+    const anjay_dm_installed_object_t *obj_with_transaction =
+            _anjay_dm_find_object_by_oid(anjay_unlocked,
+                                         OBJ_WITH_TRANSACTION->oid);
+    const anjay_dm_installed_object_t *security_obj =
+            _anjay_dm_find_object_by_oid(anjay_unlocked, FAKE_SECURITY->oid);
+    ASSERT_OK(_anjay_dm_transaction_include_object(anjay_unlocked,
+                                                   obj_with_transaction));
+    ASSERT_OK(_anjay_dm_transaction_include_object(anjay_unlocked,
+                                                   security_obj));
+
+    _anjay_mock_dm_expect_transaction_validate(anjay, &OBJ_WITH_TRANSACTION,
+                                               ANJAY_ERR_BAD_REQUEST);
+    _anjay_mock_dm_expect_transaction_rollback(anjay, &OBJ_WITH_TRANSACTION,
+                                               0);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_dm_transaction_finish(anjay_unlocked, 0),
+                          ANJAY_ERR_BAD_REQUEST);
+    AVS_UNIT_ASSERT_EQUAL(executor_calls, 1);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    _anjay_mock_dm_expect_clean();
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_THREAD_SAFETY
+
+AVS_UNIT_TEST(notify, queue_resource_changes_merged) {
+    anjay_notify_queue_t queue = NULL;
+    ASSERT_OK(_anjay_notify_queue_resource_change(&queue, 42, 1, 5));
+    ASSERT_OK(_anjay_notify_queue_resource_change(&queue, 42, 3, 0));
+    ASSERT_OK(_anjay_notify_queue_resource_changes(
+            &queue, 42,
+            (const anjay_notify_queue_resource_entry_t[]) {
+                    { 0, 7 }, { 1, 5 }, { 1, 6 }, { 1, 6 }, { 4, 1 } },
+            5));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(queue), 1);
+    static const anjay_notify_queue_resource_entry_t expected[] = {
+        { 0, 7 }, { 1, 5 }, { 1, 6 }, { 3, 0 }, { 4, 1 }
+    };
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(queue->resources_changed),
+                          AVS_ARRAY_SIZE(expected));
+    size_t i = 0;
+    AVS_LIST(anjay_notify_queue_resource_entry_t) it;
+    AVS_LIST_FOREACH(it, queue->resources_changed) {
+        AVS_UNIT_ASSERT_EQUAL(it->iid, expected[i].iid);
+        AVS_UNIT_ASSERT_EQUAL(it->rid, expected[i].rid);
+        ++i;
+    }
+    _anjay_notify_clear_queue(&queue);
+}
+
+AVS_UNIT_TEST(notify, queue_instances_created_merged) {
+    anjay_notify_queue_t queue = NULL;
+    ASSERT_OK(_anjay_notify_queue_instance_created(&queue, 42, 2));
+    ASSERT_OK(_anjay_notify_queue_instance_created(&queue, 42, 9));
+    ASSERT_OK(_anjay_notify_queue_instances_created(
+            &queue, 42, (const anjay_iid_t[]) { 1, 2, 5, 5, 10 }, 5));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(queue), 1);
+    AVS_UNIT_ASSERT_TRUE(queue->instance_set_changes.instance_set_changed);
+    static const anjay_iid_t expected[] = { 1, 2, 5, 9, 10 };
+    AVS_UNIT_ASSERT_EQUAL(
+            AVS_LIST_SIZE(queue->instance_set_changes.known_added_iids),
+            AVS_ARRAY_SIZE(expected));
+    size_t i = 0;
+    AVS_LIST(anjay_iid_t) it;
+    AVS_LIST_FOREACH(it, queue->instance_set_changes.known_added_iids) {
+        AVS_UNIT_ASSERT_EQUAL(*it, expected[i]);
+        ++i;
+    }
+    _anjay_notify_clear_queue(&queue);
+}
+
+AVS_UNIT_TEST(dm_object_links_cache, invalidated_on_instance_set_change) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+    uint32_t generation;
+    uint32_t new_generation;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NULL(_anjay_dm_cache_get_object_links(
+            anjay_unlocked, ANJAY_DM_OBJECT_LINKS_LWM2M10, &generation));
+    _anjay_dm_cache_store_object_links(anjay_unlocked,
+                                       ANJAY_DM_OBJECT_LINKS_LWM2M10,
+                                       generation, avs_strdup("</42/0>"));
+    AVS_UNIT_ASSERT_EQUAL_STRING(
+            _anjay_dm_cache_get_object_links(anjay_unlocked,
+                                             ANJAY_DM_OBJECT_LINKS_LWM2M10,
+                                             &new_generation),
+            "</42/0>");
+    AVS_UNIT_ASSERT_EQUAL(new_generation, generation);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    ASSERT_OK(anjay_notify_instances_changed(anjay, OBJ->oid));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NULL(_anjay_dm_cache_get_object_links(
+            anjay_unlocked, ANJAY_DM_OBJECT_LINKS_LWM2M10, &new_generation));
+    AVS_UNIT_ASSERT_NOT_EQUAL(new_generation, generation);
+    // payloads generated based on outdated state are discarded
+    _anjay_dm_cache_store_object_links(anjay_unlocked,
+                                       ANJAY_DM_OBJECT_LINKS_LWM2M10,
+                                       generation, avs_strdup("</42/0>"));
+    AVS_UNIT_ASSERT_NULL(_anjay_dm_cache_get_object_links(
+            anjay_unlocked, ANJAY_DM_OBJECT_LINKS_LWM2M10, &new_generation));
+    ANJAY_MUTEX_UNLOCK(anjay);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_discover_cache, response_reused_until_changed) {
+    DM_TEST_INIT_WITH_SSIDS(7);
+    ASSERT_OK(anjay_set_discover_caching(anjay, 42, true));
+    const anjay_dm_oi_attributes_t empty_oi_attrs = {
+        .min_period = ANJAY_ATTRIB_INTEGER_NONE,
+        .max_period = ANJAY_ATTRIB_INTEGER_NONE,
+        .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+        .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+#ifdef ANJAY_WITH_CON_ATTR
+        ,
+        .con = ANJAY_DM_CON_ATTR_NONE
+#endif // ANJAY_WITH_CON_ATTR
+    };
+    const anjay_dm_r_attributes_t r_attrs = {
+        .common = {
+            .min_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_period = 514,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+#ifdef ANJAY_WITH_CON_ATTR
+            ,
+            .con = ANJAY_DM_CON_ATTR_NONE
+#endif // ANJAY_WITH_CON_ATTR
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "69", "4"),
+                    ACCEPT(0x28), NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read_attrs(anjay, &OBJ, 69, 4, 7, 0,
+                                              &r_attrs);
+    _anjay_mock_dm_expect_instance_read_default_attrs(anjay, &OBJ, 69, 7, 0,
+                                                      &empty_oi_attrs);
+    _anjay_mock_dm_expect_object_read_default_attrs(anjay, &OBJ, 7, 0,
+                                                    &empty_oi_attrs);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(LINK_FORMAT),
+                            PAYLOAD("</42/69/4>;pmax=514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    // only the Instance presence is checked again
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3F), PATH("42", "69", "4"),
+                    ACCEPT(0x28), NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3F),
+                            CONTENT_FORMAT(LINK_FORMAT),
+                            PAYLOAD("</42/69/4>;pmax=514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_dm_discover_cache_t *cache =
+            _anjay_dm_discover_cache_find(anjay_unlocked, 42);
+    AVS_UNIT_ASSERT_NOT_NULL(cache);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(cache->entries), 1);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    ASSERT_OK(anjay_notify_changed(anjay, 42, 69, 4));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    cache = _anjay_dm_discover_cache_find(anjay_unlocked, 42);
+    AVS_UNIT_ASSERT_NOT_NULL(cache);
+    AVS_UNIT_ASSERT_NULL(cache->entries);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dm_read_cache, response_reused_until_changed) {
+    DM_TEST_INIT;
+    ASSERT_OK(anjay_set_read_response_caching(anjay, 42,
+                                              avs_time_duration_from_scalar(
+                                                      1, AVS_TIME_HOUR)));
+    const anjay_mock_dm_res_entry_t resources[] = {
+        { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+        ANJAY_MOCK_DM_RES_END
+    };
+
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "69", "4"),
+                    NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(anjay, &OBJ, 69, 0, resources);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 514));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    // only the presence of the path is checked again
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3F), PATH("42", "69", "4"),
+                    NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(anjay, &OBJ, 69, 0, resources);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3F),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    ASSERT_OK(anjay_notify_changed(anjay, 42, 69, 4));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_dm_read_cache_t *cache =
+            _anjay_dm_read_cache_find(anjay_unlocked, 42);
+    AVS_UNIT_ASSERT_NOT_NULL(cache);
+    AVS_UNIT_ASSERT_NULL(cache->entries);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA40), PATH("42", "69", "4"),
+                    NO_PAYLOAD);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(anjay, &OBJ, 69, 0, resources);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 42));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA40),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("42"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    ASSERT_OK(anjay_set_read_response_caching(anjay, 42,
+                                              AVS_TIME_DURATION_ZERO));
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NULL(_anjay_dm_read_cache_find(anjay_unlocked, 42));
+    ANJAY_MUTEX_UNLOCK(anjay);
+    DM_TEST_FINISH;
+}
+
+static int64_t notify_flush_delay_ms(anjay_t *anjay) {
+    int64_t result;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay_unlocked->scheduled_notify.handle);
+    AVS_UNIT_ASSERT_SUCCESS(avs_time_duration_to_scalar(
+            &result, AVS_TIME_MS,
+            avs_time_monotonic_diff(
+                    avs_sched_time(&anjay_unlocked->scheduled_notify.handle),
+                    avs_time_monotonic_now())));
+    ANJAY_MUTEX_UNLOCK(anjay);
+    return result;
+}
+
+AVS_UNIT_TEST(dm_notify, debounce_window) {
+    DM_TEST_INIT;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_unlocked->scheduled_notify.debounce_window =
+            avs_time_duration_from_scalar(2, AVS_TIME_S);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    ASSERT_OK(anjay_set_notify_debounce(anjay, 42, 69, 5,
+                                        AVS_TIME_DURATION_ZERO));
+    ASSERT_FAIL(anjay_set_notify_debounce(anjay, 42, ANJAY_ID_INVALID, 5,
+                                          AVS_TIME_DURATION_ZERO));
+
+    ASSERT_OK(anjay_notify_changed(anjay, 42, 69, 4));
+    AVS_UNIT_ASSERT_EQUAL(notify_flush_delay_ms(anjay), 2000);
+
+    // further changes do not postpone the flush
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+    ASSERT_OK(anjay_notify_changed(anjay, 42, 69, 3));
+    AVS_UNIT_ASSERT_EQUAL(notify_flush_delay_ms(anjay), 1000);
+
+    // a change of a Resource with an override brings it forward
+    ASSERT_OK(anjay_notify_changed(anjay, 42, 69, 5));
+    AVS_UNIT_ASSERT_EQUAL(notify_flush_delay_ms(anjay), 0);
+    DM_TEST_FINISH;
+}
+
+#if defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
+#    define EXPECT_RESOURCE_4_PRESENT()                                  \
+        do {                                                             \
+            _anjay_mock_dm_expect_list_instances(                        \
+                    anjay, &OBJ, 0,                                      \
+                    (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });     \
+            _anjay_mock_dm_expect_list_resources(                        \
+                    anjay, &OBJ, 69, 0,                                  \
+                    (const anjay_mock_dm_res_entry_t[]) {                \
+                            { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT }, \
+                            ANJAY_MOCK_DM_RES_END });                    \
+        } while (false)
+
+AVS_UNIT_TEST(dm_value_cache, value_reused_until_changed) {
+    DM_TEST_INIT;
+    ASSERT_OK(anjay_set_resource_value_caching(anjay, 42, 4, true));
+
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("42", "69", "4"),
+                    NO_PAYLOAD);
+    EXPECT_RESOURCE_4_PRESENT();
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 514));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    // the resource_read handler is not called again
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3F), PATH("42", "69", "4"),
+                    NO_PAYLOAD);
+    EXPECT_RESOURCE_4_PRESENT();
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3F),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    ASSERT_OK(anjay_notify_changed(anjay, 42, 69, 4));
+
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA40), PATH("42", "69", "4"),
+                    NO_PAYLOAD);
+    EXPECT_RESOURCE_4_PRESENT();
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 42));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA40),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("42"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+#    undef EXPECT_RESOURCE_4_PRESENT
+#endif // defined(ANJAY_WITH_OBSERVE) || defined(ANJAY_WITH_SEND)
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+AVS_UNIT_TEST(dns_cache, server_name) {
+    AVS_UNIT_ASSERT_EQUAL_STRING(
+            _anjay_dns_cache_server_name(NULL, "example.com"), "example.com");
+    AVS_UNIT_ASSERT_EQUAL_STRING(
+            _anjay_dns_cache_server_name("sni.example", "example.com"),
+            "sni.example");
+    AVS_UNIT_ASSERT_NULL(_anjay_dns_cache_server_name(NULL, "192.0.2.1"));
+    AVS_UNIT_ASSERT_NULL(_anjay_dns_cache_server_name(NULL, "2001:db8::1"));
+    AVS_UNIT_ASSERT_NULL(_anjay_dns_cache_server_name(NULL, NULL));
+}
+
+AVS_UNIT_TEST(dns_cache, put_and_expire) {
+    anjay_unlocked_t anjay;
+    memset(&anjay, 0, sizeof(anjay));
+
+    AVS_UNIT_ASSERT_SUCCESS(put(&anjay, "example.com", "192.0.2.1",
+                                avs_time_duration_from_scalar(1, AVS_TIME_S)));
+    AVS_UNIT_ASSERT_SUCCESS(put(&anjay, "example.org", "2001:db8::1",
+                                avs_time_duration_from_scalar(1, AVS_TIME_S)));
+    AVS_UNIT_ASSERT_EQUAL_STRING((*find_entry_ptr(&anjay, "example.com"))
+                                         ->address,
+                                 "192.0.2.1");
+
+    // updating an entry does not duplicate it
+    AVS_UNIT_ASSERT_SUCCESS(put(&anjay, "example.com", "192.0.2.2",
+                                avs_time_duration_from_scalar(1, AVS_TIME_S)));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay.dns_cache), 2);
+    AVS_UNIT_ASSERT_EQUAL_STRING((*find_entry_ptr(&anjay, "example.com"))
+                                         ->address,
+                                 "192.0.2.2");
+
+    AVS_UNIT_ASSERT_FAILED(put(&anjay, "example.net", "not an address at all",
+                               avs_time_duration_from_scalar(1, AVS_TIME_S)));
+
+    forget(&anjay, "example.org");
+    AVS_UNIT_ASSERT_NULL(*find_entry_ptr(&anjay, "example.org"));
+
+    // expired entries are not returned, and are removed on lookup
+    anjay.dns_cache->expires_at = avs_time_monotonic_now();
+    AVS_UNIT_ASSERT_NULL(*find_entry_ptr(&anjay, "example.com"));
+    AVS_UNIT_ASSERT_NULL(anjay.dns_cache);
+
+    _anjay_dns_cache_cleanup(&anjay);
+}
@@ -386,6 +386,85 @@ AVS_UNIT_TEST(downloader, coap_download_single_block) {
     teardown_simple();
 }
 
+typedef struct {
+    uint8_t buffer[48];
+    size_t buffer_size;
+    size_t acquires;
+    size_t releases;
+} test_block_buffers_t;
+
+static uint8_t *test_block_buffer_acquire(void *buffers_, size_t *out_size) {
+    test_block_buffers_t *buffers = (test_block_buffers_t *) buffers_;
+    // only one buffer is in use at a time
+    AVS_UNIT_ASSERT_EQUAL(buffers->acquires, buffers->releases);
+    ++buffers->acquires;
+    *out_size = buffers->buffer_size;
+    return buffers->buffer;
+}
+
+static void test_block_buffer_release(void *buffers_, uint8_t *buffer) {
+    test_block_buffers_t *buffers = (test_block_buffers_t *) buffers_;
+    AVS_UNIT_ASSERT_TRUE(buffer == buffers->buffer);
+    ++buffers->releases;
+}
+
+AVS_UNIT_TEST(downloader, coap_download_into_block_buffers) {
+    setup_simple("coap://127.0.0.1:5683");
+    test_block_buffers_t buffers = {
+        .buffer_size = sizeof(buffers.buffer)
+    };
+    const anjay_download_block_buffer_provider_t provider = {
+        .acquire = test_block_buffer_acquire,
+        .release = test_block_buffer_release,
+        .arg = &buffers
+    };
+    SIMPLE_ENV.cfg.block_buffer_provider = &provider;
+
+    avs_unit_mocksock_expect_shutdown(SIMPLE_ENV.mocksock);
+    avs_unit_mocksock_expect_mid_close(SIMPLE_ENV.mocksock);
+    avs_unit_mocksock_expect_connect(SIMPLE_ENV.mocksock, "127.0.0.1", "5683",
+                                     .and_then = expect_download_single_block);
+
+    // the block is split into chunks no larger than the provided buffers
+    size_t num_chunks = DIV_CEIL(sizeof(DESPAIR) - 1, buffers.buffer_size);
+    for (size_t i = 0; i < num_chunks; ++i) {
+        size_t offset = i * buffers.buffer_size;
+        on_next_block_args_t args = {
+            .data_size = AVS_MIN(buffers.buffer_size,
+                                 sizeof(DESPAIR) - 1 - offset),
+            .result = AVS_OK
+        };
+        memcpy(args.data, &DESPAIR[offset], args.data_size);
+        expect_next_block(&SIMPLE_ENV.data, args);
+    }
+    expect_download_finished(&SIMPLE_ENV.data,
+                             _anjay_download_status_success());
+
+    perform_simple_download();
+    AVS_UNIT_ASSERT_EQUAL(buffers.acquires, num_chunks);
+    AVS_UNIT_ASSERT_EQUAL(buffers.releases, num_chunks);
+
+    teardown_simple();
+}
+
+AVS_UNIT_TEST(downloader, incomplete_block_buffer_provider) {
+    setup_simple("coap://127.0.0.1:5683");
+    test_block_buffers_t buffers = {
+        .buffer_size = sizeof(buffers.buffer)
+    };
+    const anjay_download_block_buffer_provider_t provider = {
+        .acquire = test_block_buffer_acquire,
+        .arg = &buffers
+    };
+    SIMPLE_ENV.cfg.block_buffer_provider = &provider;
+
+    assert_download_not_possible(&SIMPLE_ENV.base->anjay->downloader,
+                                 &SIMPLE_ENV.cfg);
+    AVS_UNIT_ASSERT_EQUAL(buffers.acquires, 0);
+
+    teardown_simple();
+}
+
 static void expect_download_multiple_blocks(avs_net_socket_t *socket,
                                             void *dummy) {
     assert(socket == SIMPLE_ENV.mocksock);
@@ -443,6 +522,53 @@ AVS_UNIT_TEST(downloader, coap_download_multiple_blocks) {
     teardown_simple();
 }
 
+static void run_ready_jobs(void) {
+    ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, SIMPLE_ENV.base->anjay);
+    while (avs_time_duration_equal(
+            avs_sched_time_to_next(SIMPLE_ENV.base->anjay->sched),
+            AVS_TIME_DURATION_ZERO)) {
+        avs_sched_run(SIMPLE_ENV.base->anjay->sched);
+    }
+    ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
+}
+
+AVS_UNIT_TEST(downloader, sockets_changed_only_on_socket_set_change) {
+    setup_simple("coap://127.0.0.1:5683");
+    anjay_downloader_t *dl = &SIMPLE_ENV.base->anjay->downloader;
+    AVS_UNIT_ASSERT_FALSE(_anjay_downloader_sockets_changed(dl));
+
+    avs_unit_mocksock_expect_shutdown(SIMPLE_ENV.mocksock);
+    avs_unit_mocksock_expect_mid_close(SIMPLE_ENV.mocksock);
+    avs_unit_mocksock_expect_connect(SIMPLE_ENV.mocksock, "127.0.0.1", "5683",
+                                     .and_then =
+                                             expect_download_multiple_blocks);
+
+    anjay_download_handle_t handle = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_download(dl, &handle,
+                                                       &SIMPLE_ENV.cfg, NULL,
+                                                       NULL));
+    AVS_UNIT_ASSERT_NOT_NULL(handle);
+    run_ready_jobs();
+
+    // the socket has been connected
+    AVS_UNIT_ASSERT_TRUE(_anjay_downloader_sockets_changed(dl));
+    AVS_UNIT_ASSERT_FALSE(_anjay_downloader_sockets_changed(dl));
+
+    // exchanging blocks over the same socket does not change anything
+    while (dl->downloads) {
+        AVS_UNIT_ASSERT_FALSE(_anjay_downloader_sockets_changed(dl));
+        AVS_UNIT_ASSERT_SUCCESS(handle_packet());
+        run_ready_jobs();
+    }
+
+    // the transfer has finished, so its socket is not there anymore
+    AVS_UNIT_ASSERT_TRUE(_anjay_downloader_sockets_changed(dl));
+    AVS_UNIT_ASSERT_FALSE(_anjay_downloader_sockets_changed(dl));
+    avs_unit_mocksock_assert_expects_met(SIMPLE_ENV.mocksock);
+
+    teardown_simple();
+}
+
 AVS_UNIT_TEST(downloader, download_abort_on_cleanup) {
     setup_simple("coap://127.0.0.1:5683");
 
@@ -1402,3 +1528,392 @@ AVS_UNIT_TEST(downloader, resumption_with_etag_and_block_estimation) {
     avs_free(etag);
 #undef DL_ETAG
 }
+
+#define WINDOW_BLOCK_SIZE 16
+#define WINDOW_NUM_BLOCKS DIV_CEIL(sizeof(DESPAIR) - 1, WINDOW_BLOCK_SIZE)
+
+static void
+expect_window_request(size_t i, size_t seq_num, bool main_exchange) {
+    const coap_test_msg_t *req;
+    if (!seq_num) {
+        req = COAP_MSG(CON, GET, ID_TOKEN_RAW(i, nth_token(i)), NO_PAYLOAD,
+                       SIZE2(0));
+    } else if (main_exchange) {
+        req = COAP_MSG(CON, GET, ID_TOKEN_RAW(i, nth_token(i)),
+                       BLOCK2(seq_num, WINDOW_BLOCK_SIZE, ""), SIZE2(0));
+    } else {
+        req = COAP_MSG(CON, GET, ID_TOKEN_RAW(i, nth_token(i)),
+                       BLOCK2(seq_num, WINDOW_BLOCK_SIZE, ""));
+    }
+    avs_unit_mocksock_expect_output(SIMPLE_ENV.mocksock, &req->content,
+                                    req->length);
+}
+
+static void window_input_block(size_t i, size_t seq_num) {
+    // only the first response carries the Size2 option
+    const coap_test_msg_t *res =
+            seq_num ? COAP_MSG(ACK, CONTENT, ID_TOKEN_RAW(i, nth_token(i)),
+                               BLOCK2(seq_num, WINDOW_BLOCK_SIZE, DESPAIR))
+                    : COAP_MSG(ACK, CONTENT, ID_TOKEN_RAW(i, nth_token(i)),
+                               BLOCK2(0, WINDOW_BLOCK_SIZE, DESPAIR),
+                               SIZE2(sizeof(DESPAIR) - 1));
+    avs_unit_mocksock_input(SIMPLE_ENV.mocksock, &res->content, res->length);
+}
+
+static void expect_window_block(size_t seq_num) {
+    const size_t offset = seq_num * WINDOW_BLOCK_SIZE;
+    on_next_block_args_t args = {
+        .data_size = AVS_MIN(sizeof(DESPAIR) - 1 - offset, WINDOW_BLOCK_SIZE),
+        .result = AVS_OK
+    };
+    memcpy(args.data, &DESPAIR[offset], args.data_size);
+    expect_next_block(&SIMPLE_ENV.data, args);
+}
+
+static void window_handle_packet(void) {
+    expect_has_buffered_data_check(SIMPLE_ENV.mocksock, false);
+    AVS_UNIT_ASSERT_SUCCESS(handle_packet());
+    run_ready_jobs();
+    avs_unit_mocksock_assert_expects_met(SIMPLE_ENV.mocksock);
+}
+
+/**
+ * Starts a download with a window of 2 and feeds the first response to it.
+ * After this, block 1 is requested over the main exchange (with message ID and
+ * token 1) and block 2 over the extra one (with message ID and token 2).
+ */
+static anjay_download_handle_t start_window_download(void) {
+    SIMPLE_ENV.cfg.coap_block_window = 2;
+    avs_unit_mocksock_expect_shutdown(SIMPLE_ENV.mocksock);
+    avs_unit_mocksock_expect_mid_close(SIMPLE_ENV.mocksock);
+    avs_unit_mocksock_expect_connect(SIMPLE_ENV.mocksock, "127.0.0.1", "5683");
+    expect_window_request(0, 0, true);
+
+    anjay_download_handle_t handle = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_downloader_download(&SIMPLE_ENV.base->anjay->downloader,
+                                       &handle, &SIMPLE_ENV.cfg, NULL, NULL));
+    AVS_UNIT_ASSERT_NOT_NULL(handle);
+    run_ready_jobs();
+    avs_unit_mocksock_assert_expects_met(SIMPLE_ENV.mocksock);
+
+    window_input_block(0, 0);
+    expect_window_block(0);
+    // the main exchange continues right away...
+    expect_window_request(1, 1, true);
+    // ...and the extra exchange is started by the scheduler, asking for its
+    // first block explicitly
+    expect_window_request(2, 2, false);
+    window_handle_packet();
+    return handle;
+}
+
+AVS_UNIT_TEST(downloader, coap_window_out_of_order_blocks) {
+    setup_simple("coap://127.0.0.1:5683");
+    AVS_UNIT_ASSERT_EQUAL(WINDOW_NUM_BLOCKS, 8);
+    start_window_download();
+
+    // block 2 arrives before block 1 and is buffered
+    window_input_block(2, 2);
+    expect_window_request(3, 4, false);
+    window_handle_packet();
+
+    // block 1 releases the buffered block 2
+    window_input_block(1, 1);
+    expect_window_block(1);
+    expect_window_block(2);
+    expect_window_request(4, 3, true);
+    window_handle_packet();
+
+    window_input_block(3, 4);
+    expect_window_request(5, 6, false);
+    window_handle_packet();
+
+    window_input_block(4, 3);
+    expect_window_block(3);
+    expect_window_block(4);
+    expect_window_request(6, 5, true);
+    window_handle_packet();
+
+    window_input_block(6, 5);
+    expect_window_block(5);
+    expect_window_request(7, 7, true);
+    window_handle_packet();
+
+    // nothing is left for the extra exchange after block 6, so it is retired
+    // without sending anything
+    window_input_block(5, 6);
+    expect_window_block(6);
+    window_handle_packet();
+
+    window_input_block(7, 7);
+    expect_window_block(7);
+    expect_download_finished(&SIMPLE_ENV.data,
+                             _anjay_download_status_success());
+    window_handle_packet();
+
+    AVS_UNIT_ASSERT_NULL(SIMPLE_ENV.data.on_next_block_calls);
+    AVS_UNIT_ASSERT_FALSE(SIMPLE_ENV.data.finish_call_expected);
+    AVS_UNIT_ASSERT_EQUAL(0, num_downloads_in_progress());
+
+    teardown_simple();
+}
+
+AVS_UNIT_TEST(downloader, coap_window_etag_change) {
+    setup_simple("coap://127.0.0.1:5683");
+    SIMPLE_ENV.cfg.coap_block_window = 2;
+    avs_unit_mocksock_expect_shutdown(SIMPLE_ENV.mocksock);
+    avs_unit_mocksock_expect_mid_close(SIMPLE_ENV.mocksock);
+    avs_unit_mocksock_expect_connect(SIMPLE_ENV.mocksock, "127.0.0.1", "5683");
+    expect_window_request(0, 0, true);
+
+    anjay_download_handle_t handle = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_downloader_download(&SIMPLE_ENV.base->anjay->downloader,
+                                       &handle, &SIMPLE_ENV.cfg, NULL, NULL));
+    AVS_UNIT_ASSERT_NOT_NULL(handle);
+    run_ready_jobs();
+
+    const coap_test_msg_t *res =
+            COAP_MSG(ACK, CONTENT, ID_TOKEN_RAW(0, nth_token(0)),
+                     BLOCK2(0, WINDOW_BLOCK_SIZE, DESPAIR),
+                     SIZE2(sizeof(DESPAIR) - 1), ETAG("tag"));
+    avs_unit_mocksock_input(SIMPLE_ENV.mocksock, &res->content, res->length);
+    static const avs_coap_etag_t etag = {
+        .size = 3,
+        .bytes = "tag"
+    };
+    expect_next_block(&SIMPLE_ENV.data,
+                      (on_next_block_args_t) {
+                          .data = DESPAIR,
+                          .data_size = WINDOW_BLOCK_SIZE,
+                          .etag = (const anjay_etag_t *) &etag,
+                          .result = AVS_OK
+                      });
+    expect_window_request(1, 1, true);
+    expect_window_request(2, 2, false);
+    window_handle_packet();
+
+    // the resource changes while the window is open: the extra exchange has
+    // not seen any ETag before, so it is the downloader that notices
+    res = COAP_MSG(ACK, CONTENT, ID_TOKEN_RAW(2, nth_token(2)),
+                   BLOCK2(2, WINDOW_BLOCK_SIZE, DESPAIR), ETAG("nje"));
+    avs_unit_mocksock_input(SIMPLE_ENV.mocksock, &res->content, res->length);
+    expect_download_finished(&SIMPLE_ENV.data,
+                             _anjay_download_status_expired());
+    window_handle_packet();
+
+    AVS_UNIT_ASSERT_FALSE(SIMPLE_ENV.data.finish_call_expected);
+    AVS_UNIT_ASSERT_EQUAL(0, num_downloads_in_progress());
+
+    teardown_simple();
+}
+
+AVS_UNIT_TEST(downloader, coap_window_failure_restarts_sequentially) {
+    setup_simple("coap://127.0.0.1:5683");
+    start_window_download();
+
+    // the extra exchange fails, so both exchanges are cancelled and the
+    // transfer continues from block 1 without a window (and without Size2)
+    const coap_test_msg_t *res = COAP_MSG(RST, EMPTY, ID(2), NO_PAYLOAD);
+    avs_unit_mocksock_input(SIMPLE_ENV.mocksock, &res->content, res->length);
+    const coap_test_msg_t *req =
+            COAP_MSG(CON, GET, ID_TOKEN_RAW(3, nth_token(3)), NO_PAYLOAD);
+    avs_unit_mocksock_expect_output(SIMPLE_ENV.mocksock, &req->content,
+                                    req->length);
+    window_handle_packet();
+
+    anjay_coap_download_ctx_t *ctx =
+            (anjay_coap_download_ctx_t *) SIMPLE_ENV.base->anjay->downloader
+                    .downloads;
+    AVS_UNIT_ASSERT_NOT_NULL(ctx);
+    AVS_UNIT_ASSERT_TRUE(ctx->window_disabled);
+    AVS_UNIT_ASSERT_EQUAL(ctx->extra_exchange_count, 0);
+    AVS_UNIT_ASSERT_EQUAL(ctx->common.stats.blocks_retried, 1);
+
+    // the server picks a larger block size; only the part that has not been
+    // delivered yet is passed to the handler
+    static const size_t BLOCK_SIZE = 32;
+    for (size_t seq_num = 0; seq_num * BLOCK_SIZE < sizeof(DESPAIR) - 1;
+         ++seq_num) {
+        const size_t id = 3 + seq_num;
+        res = COAP_MSG(ACK, CONTENT, ID_TOKEN_RAW(id, nth_token(id)),
+                       BLOCK2(seq_num, BLOCK_SIZE, DESPAIR));
+        avs_unit_mocksock_input(SIMPLE_ENV.mocksock, &res->content,
+                                res->length);
+
+        const size_t offset = AVS_MAX(seq_num * BLOCK_SIZE, WINDOW_BLOCK_SIZE);
+        const size_t end =
+                AVS_MIN((seq_num + 1) * BLOCK_SIZE, sizeof(DESPAIR) - 1);
+        on_next_block_args_t args = {
+            .data_size = end - offset,
+            .result = AVS_OK
+        };
+        memcpy(args.data, &DESPAIR[offset], args.data_size);
+        expect_next_block(&SIMPLE_ENV.data, args);
+
+        if (end < sizeof(DESPAIR) - 1) {
+            req = COAP_MSG(CON, GET, ID_TOKEN_RAW(id + 1, nth_token(id + 1)),
+                           BLOCK2(seq_num + 1, BLOCK_SIZE, ""));
+            avs_unit_mocksock_expect_output(SIMPLE_ENV.mocksock, &req->content,
+                                            req->length);
+        } else {
+            expect_download_finished(&SIMPLE_ENV.data,
+                                     _anjay_download_status_success());
+        }
+        window_handle_packet();
+    }
+
+    AVS_UNIT_ASSERT_NULL(SIMPLE_ENV.data.on_next_block_calls);
+    AVS_UNIT_ASSERT_FALSE(SIMPLE_ENV.data.finish_call_expected);
+    AVS_UNIT_ASSERT_EQUAL(0, num_downloads_in_progress());
+
+    teardown_simple();
+}
+
+AVS_UNIT_TEST(downloader, coap_window_abort) {
+    setup_simple("coap://127.0.0.1:5683");
+    anjay_download_handle_t handle = start_window_download();
+
+    // cancelling the exchanges while aborting must not report the transfer
+    // as finished more than once
+    expect_download_finished(&SIMPLE_ENV.data,
+                             _anjay_download_status_aborted());
+    _anjay_downloader_abort(&SIMPLE_ENV.base->anjay->downloader, handle);
+    AVS_UNIT_ASSERT_FALSE(SIMPLE_ENV.data.finish_call_expected);
+
+    run_ready_jobs();
+    AVS_UNIT_ASSERT_EQUAL(0, num_downloads_in_progress());
+    avs_unit_mocksock_assert_expects_met(SIMPLE_ENV.mocksock);
+
+    teardown_simple();
+}
+
+#undef WINDOW_NUM_BLOCKS
+#undef WINDOW_BLOCK_SIZE
+
+static void assert_throttle_delay_ms(anjay_download_ctx_common_t *ctx,
+                                     size_t bytes_received,
+                                     int64_t expected_ms) {
+    int64_t delay_ms;
+    AVS_UNIT_ASSERT_SUCCESS(avs_time_duration_to_scalar(
+            &delay_ms, AVS_TIME_MS,
+            _anjay_downloader_throttle_delay(ctx, bytes_received)));
+    AVS_UNIT_ASSERT_EQUAL(delay_ms, expected_ms);
+}
+
+AVS_UNIT_TEST(downloader, throttle_delay) {
+    setup();
+    anjay_download_ctx_common_t ctx = {
+        .dl = &ENV.anjay->downloader,
+        .rate_limit_start = AVS_TIME_MONOTONIC_INVALID
+    };
+
+    // no rate limit
+    assert_throttle_delay_ms(&ctx, 100000, 0);
+
+    ctx.max_bytes_per_second = 1000;
+    assert_throttle_delay_ms(&ctx, 500, 500);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(200, AVS_TIME_MS));
+    assert_throttle_delay_ms(&ctx, 500, 800);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(800, AVS_TIME_MS));
+    assert_throttle_delay_ms(&ctx, 0, 0);
+
+    // an idle period does not allow a burst afterwards
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    assert_throttle_delay_ms(&ctx, 100, 0);
+    assert_throttle_delay_ms(&ctx, 2000, 2000);
+
+    // no confirmable notifications are being delivered
+    ctx.max_bytes_per_second = 0;
+    ctx.pause_during_confirmable_notifications = true;
+    assert_throttle_delay_ms(&ctx, 100, 0);
+
+    teardown();
+}
+
+AVS_UNIT_TEST(downloader, set_rate_limit_of_unknown_download) {
+    setup();
+
+    avs_error_t err = _anjay_downloader_set_rate_limit(
+            &ENV.anjay->downloader, (anjay_download_handle_t) (uintptr_t) 42,
+            1000);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_ENOENT);
+
+    teardown();
+}
+
+static int64_t duration_ms(avs_time_duration_t duration) {
+    int64_t result;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_time_duration_to_scalar(&result, AVS_TIME_MS, duration));
+    return result;
+}
+
+static void deliver_test_block(anjay_download_ctx_common_t *ctx,
+                               const char *data) {
+    on_next_block_args_t args = {
+        .data_size = strlen(data),
+        .result = AVS_OK
+    };
+    memcpy(args.data, data, args.data_size);
+    expect_next_block(&SIMPLE_ENV.data, args);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_call_on_next_block(
+            ctx, (const uint8_t *) data, args.data_size, NULL));
+}
+
+AVS_UNIT_TEST(downloader, download_stats) {
+    setup_simple("coap://127.0.0.1:5683");
+    anjay_downloader_t *dl = &SIMPLE_ENV.base->anjay->downloader;
+
+    anjay_download_handle_t handle = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_downloader_download(dl, &handle, &SIMPLE_ENV.cfg, NULL,
+                                       NULL));
+    AVS_UNIT_ASSERT_NOT_NULL(handle);
+    AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
+            _anjay_downloader_find_ctx_ptr_by_id(dl, (uintptr_t) handle);
+    AVS_UNIT_ASSERT_NOT_NULL(ctx_ptr);
+    anjay_download_ctx_common_t *common = &(*ctx_ptr)->common;
+
+    anjay_download_stats_t stats;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_get_stats(dl, handle, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.bytes_received, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.reconnects, 0);
+    AVS_UNIT_ASSERT_FALSE(avs_time_duration_valid(stats.rtt));
+    AVS_UNIT_ASSERT_EQUAL(duration_ms(stats.time_suspended), 0);
+
+    _anjay_downloader_stats_request_sent(common);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(50, AVS_TIME_MS));
+    _anjay_downloader_stats_response_received(common);
+    deliver_test_block(common, "abcd");
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_get_stats(dl, handle, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.bytes_received, 4);
+    AVS_UNIT_ASSERT_EQUAL(duration_ms(stats.rtt), 50);
+    // not measured over a full window yet
+    AVS_UNIT_ASSERT_EQUAL(stats.current_throughput, 0);
+
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+    deliver_test_block(common, "efgh");
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_get_stats(dl, handle, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.bytes_received, 8);
+    AVS_UNIT_ASSERT_EQUAL(stats.current_throughput, 8);
+    // 8 B in 1050 ms
+    AVS_UNIT_ASSERT_EQUAL(stats.average_throughput, 7);
+
+    // the last measurement is outdated if nothing is received for a while
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(2, AVS_TIME_S));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_get_stats(dl, handle, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.current_throughput, 0);
+
+    expect_download_finished(&SIMPLE_ENV.data,
+                             _anjay_download_status_aborted());
+    _anjay_downloader_abort(dl, handle);
+
+    avs_error_t err = _anjay_downloader_get_stats(dl, handle, &stats);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_ENOENT);
+
+    teardown_simple();
+}
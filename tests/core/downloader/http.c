@@ -0,0 +1,638 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <stdio.h>
+
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_stream_v_table.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "tests/utils/mock_clock.h"
+
+/*
+ * The HTTP client creates its sockets internally, so the HTTP streams are
+ * mocked instead. Each stream is answered by a simulated server that serves
+ * HTTP_RESOURCE_SIZE bytes of HTTP_PATTERN(), and honors the Range header if
+ * configured to do so.
+ */
+#define HTTP_RESOURCE_SIZE (3 * HTTP_PARALLEL_MIN_RANGE_SIZE)
+#define HTTP_PATTERN(Offset) ((uint8_t) ((Offset) % 251))
+#define HTTP_READ_CHUNK 1000
+#define HTTP_MAX_STREAMS 4
+
+typedef struct {
+    // the stream does not report readiness until it is unpaused by the test
+    bool paused;
+    // if nonzero, the stream stops reporting readiness after that many bytes
+    size_t ready_bytes;
+    // reading from the stream fails
+    bool fail;
+} http_stream_cfg_t;
+
+typedef struct {
+    const avs_stream_v_table_t *vtable;
+    size_t index;
+    http_stream_cfg_t cfg;
+    char range[64];
+    char if_match[64];
+    AVS_LIST(const avs_http_header_t) *header_storage;
+    AVS_LIST(avs_http_header_t) headers;
+    char content_range[64];
+    char content_length[32];
+    size_t offset;
+    size_t body_end;
+    size_t bytes_read;
+} http_mock_stream_t;
+
+typedef struct {
+    bool accept_ranges;
+    // if false, Range requests are answered with 200 and the whole resource
+    bool honor_ranges;
+    // number of bytes missing at the end of each 206 response
+    size_t short_by;
+} http_mock_server_t;
+
+typedef struct {
+    anjay_unlocked_t *anjay;
+    http_mock_server_t server;
+    http_stream_cfg_t stream_cfg[HTTP_MAX_STREAMS];
+    http_mock_stream_t *streams[HTTP_MAX_STREAMS];
+    size_t num_streams;
+    size_t open_streams;
+
+    anjay_download_config_t cfg;
+    uint8_t received[HTTP_RESOURCE_SIZE];
+    size_t bytes_received;
+    size_t first_offset;
+    bool finished;
+    anjay_download_status_t status;
+} http_test_env_t;
+
+static http_test_env_t HTTP_ENV;
+
+static bool mock_stream_read_ready(avs_stream_t *stream_) {
+    http_mock_stream_t *stream = (http_mock_stream_t *) stream_;
+    return !stream->cfg.paused && stream->offset < stream->body_end
+           && (!stream->cfg.ready_bytes
+               || stream->bytes_read < stream->cfg.ready_bytes);
+}
+
+static avs_error_t mock_stream_read(avs_stream_t *stream_,
+                                    size_t *out_bytes_read,
+                                    bool *out_message_finished,
+                                    void *buffer,
+                                    size_t buffer_length) {
+    http_mock_stream_t *stream = (http_mock_stream_t *) stream_;
+    if (stream->cfg.fail) {
+        return avs_errno(AVS_ECONNRESET);
+    }
+    size_t bytes = AVS_MIN(AVS_MIN(buffer_length, (size_t) HTTP_READ_CHUNK),
+                           stream->body_end - stream->offset);
+    for (size_t i = 0; i < bytes; ++i) {
+        ((uint8_t *) buffer)[i] = HTTP_PATTERN(stream->offset + i);
+    }
+    stream->offset += bytes;
+    stream->bytes_read += bytes;
+    *out_bytes_read = bytes;
+    *out_message_finished = (stream->offset == stream->body_end);
+    return AVS_OK;
+}
+
+static void add_response_header(http_mock_stream_t *stream,
+                                const char *key,
+                                const char *value) {
+    AVS_LIST(avs_http_header_t) header =
+            AVS_LIST_NEW_ELEMENT(avs_http_header_t);
+    AVS_UNIT_ASSERT_NOT_NULL(header);
+    header->key = key;
+    header->value = value;
+    AVS_LIST_APPEND(&stream->headers, header);
+}
+
+static avs_error_t mock_stream_finish_message(avs_stream_t *stream_) {
+    http_mock_stream_t *stream = (http_mock_stream_t *) stream_;
+    const http_mock_server_t *server = &HTTP_ENV.server;
+    unsigned long start = 0;
+    unsigned long last = HTTP_RESOURCE_SIZE - 1;
+    bool partial = false;
+    if (stream->range[0] && server->honor_ranges) {
+        AVS_UNIT_ASSERT_EQUAL(sscanf(stream->range, "bytes=%lu-%lu", &start,
+                                     &last),
+                              2);
+        AVS_UNIT_ASSERT_EQUAL_STRING(stream->if_match, "\"tag\"");
+        partial = true;
+        AVS_UNIT_ASSERT_TRUE(
+                avs_simple_snprintf(stream->content_range,
+                                    sizeof(stream->content_range),
+                                    "bytes %lu-%lu/%lu", start, last,
+                                    (unsigned long) HTTP_RESOURCE_SIZE)
+                >= 0);
+        add_response_header(stream, "Content-Range", stream->content_range);
+    }
+    stream->offset = partial ? start : 0;
+    stream->body_end = partial ? last + 1 - server->short_by
+                               : HTTP_RESOURCE_SIZE;
+    AVS_UNIT_ASSERT_TRUE(avs_simple_snprintf(stream->content_length,
+                                             sizeof(stream->content_length),
+                                             "%lu",
+                                             (unsigned long) (last + 1 - start))
+                         >= 0);
+    add_response_header(stream, "Content-Length", stream->content_length);
+    if (server->accept_ranges) {
+        add_response_header(stream, "Accept-Ranges", "bytes");
+    }
+    add_response_header(stream, "ETag", "\"tag\"");
+    if (stream->header_storage) {
+        *stream->header_storage = stream->headers;
+    }
+    return AVS_OK;
+}
+
+static avs_error_t mock_stream_close(avs_stream_t *stream_) {
+    http_mock_stream_t *stream = (http_mock_stream_t *) stream_;
+    AVS_LIST_CLEAR(&stream->headers);
+    HTTP_ENV.streams[stream->index] = NULL;
+    --HTTP_ENV.open_streams;
+    return AVS_OK;
+}
+
+static const avs_stream_v_table_extension_nonblock_t MOCK_STREAM_NONBLOCK = {
+    .read_ready = mock_stream_read_ready
+};
+
+static const avs_stream_v_table_extension_t MOCK_STREAM_EXTENSIONS[] = {
+    { AVS_STREAM_V_TABLE_EXTENSION_NONBLOCK, &MOCK_STREAM_NONBLOCK },
+    AVS_STREAM_V_TABLE_EXTENSION_NULL
+};
+
+static const avs_stream_v_table_t MOCK_STREAM_VTABLE = {
+    .finish_message = mock_stream_finish_message,
+    .read = mock_stream_read,
+    .close = mock_stream_close,
+    .extension_list = MOCK_STREAM_EXTENSIONS
+};
+
+static avs_error_t mock_open_stream(avs_stream_t **out,
+                                    avs_http_t *http,
+                                    avs_http_method_t method,
+                                    avs_http_content_encoding_t encoding,
+                                    const avs_url_t *url,
+                                    const char *auth_username,
+                                    const char *auth_password) {
+    (void) http;
+    (void) url;
+    (void) auth_username;
+    (void) auth_password;
+    AVS_UNIT_ASSERT_EQUAL(method, AVS_HTTP_GET);
+    AVS_UNIT_ASSERT_EQUAL(encoding, AVS_HTTP_CONTENT_IDENTITY);
+    AVS_UNIT_ASSERT_TRUE(HTTP_ENV.num_streams < HTTP_MAX_STREAMS);
+
+    http_mock_stream_t *stream =
+            (http_mock_stream_t *) avs_calloc(1, sizeof(http_mock_stream_t));
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    stream->vtable = &MOCK_STREAM_VTABLE;
+    stream->index = HTTP_ENV.num_streams;
+    stream->cfg = HTTP_ENV.stream_cfg[stream->index];
+    HTTP_ENV.streams[HTTP_ENV.num_streams++] = stream;
+    ++HTTP_ENV.open_streams;
+    *out = (avs_stream_t *) stream;
+    return AVS_OK;
+}
+
+static int
+mock_add_header(avs_stream_t *stream_, const char *key, const char *value) {
+    http_mock_stream_t *stream = (http_mock_stream_t *) stream_;
+    if (!strcmp(key, "Range")) {
+        AVS_UNIT_ASSERT_TRUE(strlen(value) < sizeof(stream->range));
+        strcpy(stream->range, value);
+    } else if (!strcmp(key, "If-Match")) {
+        AVS_UNIT_ASSERT_TRUE(strlen(value) < sizeof(stream->if_match));
+        strcpy(stream->if_match, value);
+    }
+    return 0;
+}
+
+static void
+mock_set_header_storage(avs_stream_t *stream,
+                        AVS_LIST(const avs_http_header_t) *header_storage) {
+    ((http_mock_stream_t *) stream)->header_storage = header_storage;
+}
+
+static avs_error_t http_on_next_block(anjay_t *anjay,
+                                      const uint8_t *data,
+                                      size_t data_size,
+                                      const anjay_etag_t *etag,
+                                      void *user_data) {
+    (void) anjay;
+    (void) user_data;
+    AVS_UNIT_ASSERT_NOT_NULL(etag);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(etag->value, "tag", etag->size);
+    AVS_UNIT_ASSERT_TRUE(HTTP_ENV.bytes_received + data_size
+                         <= HTTP_RESOURCE_SIZE);
+    memcpy(&HTTP_ENV.received[HTTP_ENV.bytes_received], data, data_size);
+    HTTP_ENV.bytes_received += data_size;
+    return AVS_OK;
+}
+
+static avs_error_t http_on_block_at_offset(anjay_t *anjay,
+                                           size_t offset,
+                                           const uint8_t *data,
+                                           size_t data_size,
+                                           const anjay_etag_t *etag,
+                                           void *user_data) {
+    (void) anjay;
+    (void) etag;
+    (void) user_data;
+    AVS_UNIT_ASSERT_TRUE(offset + data_size <= HTTP_RESOURCE_SIZE);
+    if (!HTTP_ENV.bytes_received) {
+        HTTP_ENV.first_offset = offset;
+    }
+    memcpy(&HTTP_ENV.received[offset], data, data_size);
+    HTTP_ENV.bytes_received += data_size;
+    return AVS_OK;
+}
+
+static void http_on_download_finished(anjay_t *anjay,
+                                      anjay_download_status_t status,
+                                      void *user_data) {
+    (void) anjay;
+    (void) user_data;
+    AVS_UNIT_ASSERT_FALSE(HTTP_ENV.finished);
+    HTTP_ENV.finished = true;
+    HTTP_ENV.status = status;
+}
+
+static void http_setup(void) {
+    memset(&HTTP_ENV, 0, sizeof(HTTP_ENV));
+    HTTP_ENV.server = (http_mock_server_t) {
+        .accept_ranges = true,
+        .honor_ranges = true
+    };
+    HTTP_ENV.cfg = (anjay_download_config_t) {
+        .url = "http://127.0.0.1/file",
+        .on_next_block = http_on_next_block,
+        .on_download_finished = http_on_download_finished,
+        .http_parallel_connections = 3
+    };
+
+    AVS_UNIT_MOCK(avs_http_open_stream) = mock_open_stream;
+    AVS_UNIT_MOCK(avs_http_add_header) = mock_add_header;
+    AVS_UNIT_MOCK(avs_http_set_header_storage) = mock_set_header_storage;
+
+    anjay_t *anjay_locked =
+            avs_calloc(1,
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+                       offsetof(anjay_t, anjay_unlocked_placeholder) +
+#    endif // ANJAY_WITH_THREAD_SAFETY
+                               sizeof(anjay_unlocked_t));
+    AVS_UNIT_ASSERT_NOT_NULL(anjay_locked);
+    HTTP_ENV.anjay =
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+            (anjay_unlocked_t *) &anjay_locked->anjay_unlocked_placeholder
+#    else  // ANJAY_WITH_THREAD_SAFETY
+            anjay_locked
+#    endif // ANJAY_WITH_THREAD_SAFETY
+            ;
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    AVS_UNIT_ASSERT_SUCCESS(avs_mutex_create(&anjay_locked->mutex));
+    AVS_UNIT_ASSERT_SUCCESS(avs_mutex_lock(anjay_locked->mutex));
+#    endif // ANJAY_WITH_THREAD_SAFETY
+    HTTP_ENV.anjay->online_transports = ANJAY_TRANSPORT_SET_ALL;
+    HTTP_ENV.anjay->sched = avs_sched_new("Anjay-test", anjay_locked);
+    AVS_UNIT_ASSERT_NOT_NULL(HTTP_ENV.anjay->sched);
+    _anjay_downloader_init(&HTTP_ENV.anjay->downloader, HTTP_ENV.anjay);
+    _anjay_mock_clock_start(avs_time_monotonic_from_scalar(1000, AVS_TIME_S));
+
+    enum { ARBITRARY_SIZE = 4096 };
+    HTTP_ENV.anjay->in_shared_buffer = avs_shared_buffer_new(ARBITRARY_SIZE);
+    AVS_UNIT_ASSERT_NOT_NULL(HTTP_ENV.anjay->in_shared_buffer);
+}
+
+static void http_run_ready_jobs(void) {
+    ANJAY_MUTEX_UNLOCK_FOR_CALLBACK(anjay_locked, HTTP_ENV.anjay);
+    while (avs_time_duration_equal(avs_sched_time_to_next(
+                                           HTTP_ENV.anjay->sched),
+                                   AVS_TIME_DURATION_ZERO)) {
+        avs_sched_run(HTTP_ENV.anjay->sched);
+    }
+    ANJAY_MUTEX_LOCK_AFTER_CALLBACK(anjay_locked);
+}
+
+static void http_teardown(void) {
+    // deferred cleanup of the streams
+    http_run_ready_jobs();
+    _anjay_downloader_cleanup(&HTTP_ENV.anjay->downloader);
+    http_run_ready_jobs();
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.open_streams, 0);
+
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    anjay_t *anjay_locked = AVS_CONTAINER_OF(HTTP_ENV.anjay, anjay_t,
+                                             anjay_unlocked_placeholder);
+    avs_mutex_unlock(anjay_locked->mutex);
+#    endif // ANJAY_WITH_THREAD_SAFETY
+    avs_sched_cleanup(&HTTP_ENV.anjay->sched);
+    avs_free(HTTP_ENV.anjay->in_shared_buffer);
+#    ifdef ANJAY_WITH_THREAD_SAFETY
+    avs_mutex_cleanup(&anjay_locked->mutex);
+    avs_free(anjay_locked);
+#    else  // ANJAY_WITH_THREAD_SAFETY
+    avs_free(HTTP_ENV.anjay);
+#    endif // ANJAY_WITH_THREAD_SAFETY
+    _anjay_mock_clock_finish();
+}
+
+static anjay_download_handle_t http_start_download(void) {
+    anjay_download_handle_t handle = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_downloader_download(
+            &HTTP_ENV.anjay->downloader, &handle, &HTTP_ENV.cfg, NULL, NULL));
+    AVS_UNIT_ASSERT_NOT_NULL(handle);
+    // send_request and, if the download has been split, ranges_job
+    http_run_ready_jobs();
+    return handle;
+}
+
+static AVS_LIST(anjay_download_ctx_t) *
+http_ctx_ptr(anjay_download_handle_t handle) {
+    AVS_LIST(anjay_download_ctx_t) *ctx_ptr =
+            _anjay_downloader_find_ctx_ptr_by_id(&HTTP_ENV.anjay->downloader,
+                                                 (uintptr_t) handle);
+    AVS_UNIT_ASSERT_NOT_NULL(ctx_ptr);
+    return ctx_ptr;
+}
+
+static void assert_range_requested(size_t stream_index,
+                                   const char *expected_range) {
+    AVS_UNIT_ASSERT_TRUE(stream_index < HTTP_ENV.num_streams);
+    AVS_UNIT_ASSERT_NOT_NULL(HTTP_ENV.streams[stream_index]);
+    AVS_UNIT_ASSERT_EQUAL_STRING(HTTP_ENV.streams[stream_index]->range,
+                                 expected_range);
+}
+
+static void assert_received_data(size_t offset, size_t size) {
+    for (size_t i = offset; i < offset + size; ++i) {
+        AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.received[i], HTTP_PATTERN(i));
+    }
+}
+
+static void assert_finished_with(anjay_download_result_t result,
+                                 avs_error_t error) {
+    AVS_UNIT_ASSERT_TRUE(HTTP_ENV.finished);
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.status.result, result);
+    if (result == ANJAY_DOWNLOAD_ERR_FAILED) {
+        AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.status.details.error.category,
+                              error.category);
+        AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.status.details.error.code,
+                              error.code);
+    }
+}
+
+AVS_UNIT_TEST(http_ranges, partial_content_in_several_ranges) {
+    http_setup();
+    http_start_download();
+
+    // the primary stream has been read up to the first range, and the ranges
+    // have then been opened and read in order
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.num_streams, 3);
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.open_streams, 0);
+    assert_finished_with(ANJAY_DOWNLOAD_FINISHED, AVS_OK);
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received, HTTP_RESOURCE_SIZE);
+    assert_received_data(0, HTTP_RESOURCE_SIZE);
+
+    http_teardown();
+}
+
+AVS_UNIT_TEST(http_ranges, range_headers) {
+    http_setup();
+    HTTP_ENV.stream_cfg[0].paused = true;
+    HTTP_ENV.stream_cfg[1].paused = true;
+    HTTP_ENV.stream_cfg[2].paused = true;
+    anjay_download_handle_t handle = http_start_download();
+
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.num_streams, 3);
+    assert_range_requested(0, "");
+    assert_range_requested(1, "bytes=65536-131071");
+    assert_range_requested(2, "bytes=131072-196607");
+    AVS_UNIT_ASSERT_EQUAL_STRING(HTTP_ENV.streams[1]->if_match, "\"tag\"");
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received, 0);
+
+    _anjay_downloader_abort(&HTTP_ENV.anjay->downloader, handle);
+    assert_finished_with(ANJAY_DOWNLOAD_ERR_ABORTED, AVS_OK);
+
+    http_teardown();
+}
+
+AVS_UNIT_TEST(http_ranges, out_of_order_completion) {
+    http_setup();
+    HTTP_ENV.stream_cfg[0].paused = true;
+    HTTP_ENV.stream_cfg[1].paused = true;
+    anjay_download_handle_t handle = http_start_download();
+
+    // the last range has been received completely and buffered, but nothing
+    // has been passed to the user yet
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.num_streams, 3);
+    http_run_ready_jobs();
+    AVS_UNIT_ASSERT_NULL(HTTP_ENV.streams[2]);
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received, 0);
+
+    HTTP_ENV.streams[0]->cfg.paused = false;
+    handle_http_packet(http_ctx_ptr(handle));
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received,
+                          HTTP_PARALLEL_MIN_RANGE_SIZE);
+    AVS_UNIT_ASSERT_FALSE(HTTP_ENV.finished);
+
+    // the front range is passed directly, then the buffered one follows
+    HTTP_ENV.streams[1]->cfg.paused = false;
+    AVS_UNIT_ASSERT_FAILED(handle_range_packet(http_ctx_ptr(handle), 0));
+    assert_finished_with(ANJAY_DOWNLOAD_FINISHED, AVS_OK);
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received, HTTP_RESOURCE_SIZE);
+    assert_received_data(0, HTTP_RESOURCE_SIZE);
+
+    http_teardown();
+}
+
+AVS_UNIT_TEST(http_ranges, out_of_order_delivery_at_offset) {
+    http_setup();
+    HTTP_ENV.cfg.on_next_block = NULL;
+    HTTP_ENV.cfg.on_block_at_offset = http_on_block_at_offset;
+    HTTP_ENV.stream_cfg[0].paused = true;
+    anjay_download_handle_t handle = http_start_download();
+
+    // both ranges have been passed to the user as soon as they were received
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.first_offset, HTTP_PARALLEL_MIN_RANGE_SIZE);
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received,
+                          HTTP_RESOURCE_SIZE - HTTP_PARALLEL_MIN_RANGE_SIZE);
+    AVS_UNIT_ASSERT_FALSE(HTTP_ENV.finished);
+
+    HTTP_ENV.streams[0]->cfg.paused = false;
+    handle_http_packet(http_ctx_ptr(handle));
+    assert_finished_with(ANJAY_DOWNLOAD_FINISHED, AVS_OK);
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received, HTTP_RESOURCE_SIZE);
+    assert_received_data(0, HTTP_RESOURCE_SIZE);
+
+    http_teardown();
+}
+
+AVS_UNIT_TEST(http_ranges, no_accept_ranges) {
+    http_setup();
+    HTTP_ENV.server.accept_ranges = false;
+    http_start_download();
+
+    // the download has not been split
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.num_streams, 1);
+    assert_finished_with(ANJAY_DOWNLOAD_FINISHED, AVS_OK);
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received, HTTP_RESOURCE_SIZE);
+    assert_received_data(0, HTTP_RESOURCE_SIZE);
+
+    http_teardown();
+}
+
+AVS_UNIT_TEST(http_ranges, server_ignores_range) {
+    http_setup();
+    HTTP_ENV.server.honor_ranges = false;
+    HTTP_ENV.stream_cfg[0].paused = true;
+    anjay_download_handle_t handle = http_start_download();
+
+    // 200 responses to the range requests are rejected, but that is not
+    // fatal until the ranges are needed
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.num_streams, 3);
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.open_streams, 1);
+    AVS_UNIT_ASSERT_FALSE(HTTP_ENV.finished);
+
+    HTTP_ENV.streams[0]->cfg.paused = false;
+    handle_http_packet(http_ctx_ptr(handle));
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received,
+                          HTTP_PARALLEL_MIN_RANGE_SIZE);
+    assert_received_data(0, HTTP_PARALLEL_MIN_RANGE_SIZE);
+    AVS_UNIT_ASSERT_FALSE(HTTP_ENV.finished);
+
+    // the front range is retried once, and its failure is fatal
+    http_run_ready_jobs();
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.num_streams, 4);
+    assert_finished_with(ANJAY_DOWNLOAD_ERR_FAILED, avs_errno(AVS_EPROTO));
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received,
+                          HTTP_PARALLEL_MIN_RANGE_SIZE);
+
+    http_teardown();
+}
+
+AVS_UNIT_TEST(http_ranges, short_range) {
+    http_setup();
+    HTTP_ENV.server.short_by = 100;
+    http_start_download();
+
+    assert_finished_with(ANJAY_DOWNLOAD_ERR_FAILED, avs_errno(AVS_EPROTO));
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received,
+                          2 * HTTP_PARALLEL_MIN_RANGE_SIZE - 100);
+    assert_received_data(0, HTTP_ENV.bytes_received);
+
+    http_teardown();
+}
+
+AVS_UNIT_TEST(http_ranges, failed_range) {
+    http_setup();
+    HTTP_ENV.stream_cfg[2].fail = true;
+    http_start_download();
+
+    assert_finished_with(ANJAY_DOWNLOAD_ERR_FAILED,
+                         avs_errno(AVS_ECONNRESET));
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received,
+                          2 * HTTP_PARALLEL_MIN_RANGE_SIZE);
+    assert_received_data(0, HTTP_ENV.bytes_received);
+
+    http_teardown();
+}
+
+AVS_UNIT_TEST(http_ranges, abort_during_range) {
+    http_setup();
+    HTTP_ENV.stream_cfg[0].paused = true;
+    HTTP_ENV.stream_cfg[1].ready_bytes = 10000;
+    HTTP_ENV.stream_cfg[2].paused = true;
+    anjay_download_handle_t handle = http_start_download();
+
+    // the first range is being buffered
+    AVS_UNIT_ASSERT_NOT_NULL(HTTP_ENV.streams[1]);
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.streams[1]->bytes_read, 10000);
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.open_streams, 3);
+
+    _anjay_downloader_abort(&HTTP_ENV.anjay->downloader, handle);
+    assert_finished_with(ANJAY_DOWNLOAD_ERR_ABORTED, AVS_OK);
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.bytes_received, 0);
+
+    // all the streams are closed through the scheduler
+    http_run_ready_jobs();
+    AVS_UNIT_ASSERT_EQUAL(HTTP_ENV.open_streams, 0);
+    AVS_UNIT_ASSERT_NULL(HTTP_ENV.anjay->downloader.downloads);
+
+    http_teardown();
+}
+
+static anjay_http_download_ctx_t *http_tls_test_start(const char *url) {
+    HTTP_ENV.cfg.url = url;
+    HTTP_ENV.stream_cfg[HTTP_ENV.num_streams].paused = true;
+    anjay_http_download_ctx_t *ctx =
+            (anjay_http_download_ctx_t *) *http_ctx_ptr(http_start_download());
+    AVS_UNIT_ASSERT_TRUE(ctx->ssl_configuration.session_resumption_buffer
+                         == ctx->tls_session_buffer);
+    return ctx;
+}
+
+static void assert_no_tls_session(anjay_http_download_ctx_t *ctx) {
+    AVS_UNIT_ASSERT_FALSE(session_data_present(
+            ctx->tls_session_buffer, sizeof(ctx->tls_session_buffer)));
+}
+
+static void http_tls_test_abort(anjay_http_download_ctx_t *ctx) {
+    _anjay_downloader_abort(&HTTP_ENV.anjay->downloader,
+                            (anjay_download_handle_t) ctx->common.id);
+    assert_finished_with(ANJAY_DOWNLOAD_ERR_ABORTED, AVS_OK);
+    HTTP_ENV.finished = false;
+    http_run_ready_jobs();
+}
+
+AVS_UNIT_TEST(http_tls_sessions, reused_for_same_host) {
+    static const char SESSION[] = "session data";
+    http_setup();
+    HTTP_ENV.cfg.http_parallel_connections = 0;
+    HTTP_ENV.cfg.http_tls_session_reuse_time =
+            avs_time_duration_from_scalar(60, AVS_TIME_S);
+
+    // the TLS layer stores the established session in the buffer
+    anjay_http_download_ctx_t *ctx =
+            http_tls_test_start("https://example.com/file");
+    assert_no_tls_session(ctx);
+    memcpy(ctx->tls_session_buffer, SESSION, sizeof(SESSION));
+    http_tls_test_abort(ctx);
+    AVS_UNIT_ASSERT_EQUAL(
+            AVS_LIST_SIZE(HTTP_ENV.anjay->downloader.http_tls_sessions), 1);
+    AVS_UNIT_ASSERT_EQUAL_STRING(
+            HTTP_ENV.anjay->downloader.http_tls_sessions->host, "example.com");
+    AVS_UNIT_ASSERT_EQUAL_STRING(
+            HTTP_ENV.anjay->downloader.http_tls_sessions->port, "443");
+
+    ctx = http_tls_test_start("https://example.com/other");
+    AVS_UNIT_ASSERT_EQUAL_BYTES(ctx->tls_session_buffer, SESSION);
+    http_tls_test_abort(ctx);
+
+    // different port - separate pool entry
+    ctx = http_tls_test_start("https://example.com:8443/file");
+    assert_no_tls_session(ctx);
+    http_tls_test_abort(ctx);
+    // no session has been established, so there is nothing to keep
+    AVS_UNIT_ASSERT_EQUAL(
+            AVS_LIST_SIZE(HTTP_ENV.anjay->downloader.http_tls_sessions), 1);
+
+    // expired sessions are not used
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(61, AVS_TIME_S));
+    ctx = http_tls_test_start("https://example.com/file");
+    assert_no_tls_session(ctx);
+    AVS_UNIT_ASSERT_NULL(HTTP_ENV.anjay->downloader.http_tls_sessions);
+    http_tls_test_abort(ctx);
+
+    http_teardown();
+}
@@ -0,0 +1,28 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_TEST_DOWNLOADER_HTTP_MOCK_H
+#define ANJAY_TEST_DOWNLOADER_HTTP_MOCK_H
+
+#include <avsystem/commons/avs_http.h>
+#include <avsystem/commons/avs_unit_mock_helpers.h>
+
+AVS_UNIT_MOCK_CREATE(avs_http_open_stream)
+#define avs_http_open_stream(...) \
+    AVS_UNIT_MOCK_WRAPPER(avs_http_open_stream)(__VA_ARGS__)
+
+AVS_UNIT_MOCK_CREATE(avs_http_add_header)
+#define avs_http_add_header(...) \
+    AVS_UNIT_MOCK_WRAPPER(avs_http_add_header)(__VA_ARGS__)
+
+AVS_UNIT_MOCK_CREATE(avs_http_set_header_storage)
+#define avs_http_set_header_storage(...) \
+    AVS_UNIT_MOCK_WRAPPER(avs_http_set_header_storage)(__VA_ARGS__)
+
+#endif /* ANJAY_TEST_DOWNLOADER_HTTP_MOCK_H */
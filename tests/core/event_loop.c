@@ -0,0 +1,432 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#ifdef ANJAY_WITH_THREAD_SAFETY
+#    include <pthread.h>
+#    include <time.h>
+#endif // ANJAY_WITH_THREAD_SAFETY
+
+#ifdef EVENT_LOOP_USE_POLL
+#    include <sys/socket.h>
+#    include <unistd.h>
+#endif // EVENT_LOOP_USE_POLL
+
+#include <avsystem/commons/avs_sched.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+// The event loop group tests do not use any sockets, so they behave the same
+// regardless of whether the poll(), select() or kernel event queue backend is
+// compiled in. The backends themselves are tested on local socket pairs below.
+
+typedef struct {
+    anjay_event_loop_group_t *group;
+    volatile atomic_int jobs_run;
+    int interrupt_after;
+} group_test_env_t;
+
+static anjay_t *group_test_anjay_new(void) {
+    const anjay_configuration_t config = {
+        .endpoint_name = "test"
+    };
+    anjay_t *anjay = anjay_new(&config);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    return anjay;
+}
+
+static void group_test_job(avs_sched_t *sched, const void *env_ptr) {
+    (void) sched;
+    group_test_env_t *env = *(group_test_env_t *const *) env_ptr;
+    if (atomic_fetch_add(&env->jobs_run, 1) + 1 == env->interrupt_after) {
+        anjay_event_loop_group_interrupt(env->group);
+    }
+}
+
+static void group_test_schedule_job(anjay_t *anjay,
+                                    group_test_env_t *env,
+                                    avs_time_duration_t delay) {
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_DELAYED(anjay_get_scheduler(anjay), NULL,
+                                              delay, group_test_job, &env,
+                                              sizeof(env)));
+}
+
+AVS_UNIT_TEST(event_loop_group, serves_all_members) {
+    group_test_env_t env = {
+        .group = anjay_event_loop_group_new(),
+        .interrupt_after = 2
+    };
+    AVS_UNIT_ASSERT_NOT_NULL(env.group);
+    anjay_t *anjay1 = group_test_anjay_new();
+    anjay_t *anjay2 = group_test_anjay_new();
+    group_test_schedule_job(anjay1, &env, AVS_TIME_DURATION_ZERO);
+    group_test_schedule_job(anjay2, &env, AVS_TIME_DURATION_ZERO);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(env.group, anjay1));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(env.group, anjay2));
+    AVS_UNIT_ASSERT_EQUAL(anjay_event_loop_group_size(env.group), 2);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_run(
+            env.group, avs_time_duration_from_scalar(1, AVS_TIME_S)));
+    AVS_UNIT_ASSERT_EQUAL(atomic_load(&env.jobs_run), 2);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_remove(env.group, anjay1));
+    AVS_UNIT_ASSERT_FAILED(anjay_event_loop_group_remove(env.group, anjay1));
+    AVS_UNIT_ASSERT_EQUAL(anjay_event_loop_group_size(env.group), 1);
+    anjay_event_loop_group_delete(env.group);
+    anjay_delete(anjay1);
+    anjay_delete(anjay2);
+}
+
+AVS_UNIT_TEST(event_loop_group, member_of_one_group_only) {
+    anjay_event_loop_group_t *group1 = anjay_event_loop_group_new();
+    anjay_event_loop_group_t *group2 = anjay_event_loop_group_new();
+    AVS_UNIT_ASSERT_NOT_NULL(group1);
+    AVS_UNIT_ASSERT_NOT_NULL(group2);
+    anjay_t *anjay = group_test_anjay_new();
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(group1, anjay));
+    AVS_UNIT_ASSERT_FAILED(anjay_event_loop_group_add(group1, anjay));
+    AVS_UNIT_ASSERT_FAILED(anjay_event_loop_group_add(group2, anjay));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_remove(group1, anjay));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(group2, anjay));
+    // deleting the group releases its members
+    anjay_event_loop_group_delete(group2);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(group1, anjay));
+    anjay_event_loop_group_delete(group1);
+    anjay_delete(anjay);
+}
+
+#ifdef ANJAY_WITH_THREAD_SAFETY
+static void group_test_sleep_ms(long ms) {
+    nanosleep(&(const struct timespec) {
+                  .tv_sec = ms / 1000,
+                  .tv_nsec = (ms % 1000) * 1000 * 1000
+              },
+              NULL);
+}
+
+static bool group_test_wait_for_jobs(group_test_env_t *env, int count) {
+    for (int i = 0; i < 500 && atomic_load(&env->jobs_run) < count; ++i) {
+        group_test_sleep_ms(10);
+    }
+    return atomic_load(&env->jobs_run) >= count;
+}
+
+static void *group_test_run(void *group) {
+    if (anjay_event_loop_group_run((anjay_event_loop_group_t *) group,
+                                   avs_time_duration_from_scalar(
+                                           100, AVS_TIME_MS))) {
+        return group;
+    }
+    return NULL;
+}
+
+AVS_UNIT_TEST(event_loop_group, members_changed_while_waiting) {
+    group_test_env_t env = {
+        .group = anjay_event_loop_group_new()
+    };
+    AVS_UNIT_ASSERT_NOT_NULL(env.group);
+    anjay_t *anjay1 = group_test_anjay_new();
+    anjay_t *anjay2 = group_test_anjay_new();
+    anjay_t *anjay3 = group_test_anjay_new();
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(env.group, anjay1));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(env.group, anjay2));
+    pthread_t thread;
+    AVS_UNIT_ASSERT_SUCCESS(
+            pthread_create(&thread, NULL, group_test_run, env.group));
+
+    // changing the members shall not prevent the remaining ones from being
+    // served in the iteration that was waiting at that time
+    group_test_schedule_job(anjay1, &env,
+                            avs_time_duration_from_scalar(50, AVS_TIME_MS));
+    group_test_sleep_ms(20);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_remove(env.group, anjay2));
+    anjay_delete(anjay2);
+    group_test_schedule_job(anjay3, &env, AVS_TIME_DURATION_ZERO);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(env.group, anjay3));
+    AVS_UNIT_ASSERT_TRUE(group_test_wait_for_jobs(&env, 2));
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_interrupt(env.group));
+    void *thread_result;
+    AVS_UNIT_ASSERT_SUCCESS(pthread_join(thread, &thread_result));
+    AVS_UNIT_ASSERT_NULL(thread_result);
+    anjay_event_loop_group_delete(env.group);
+    anjay_delete(anjay1);
+    anjay_delete(anjay3);
+}
+
+typedef struct {
+    volatile atomic_int started;
+    volatile atomic_int finished;
+} group_test_slow_job_env_t;
+
+static void group_test_slow_job(avs_sched_t *sched, const void *env_ptr) {
+    (void) sched;
+    group_test_slow_job_env_t *env =
+            *(group_test_slow_job_env_t *const *) env_ptr;
+    atomic_store(&env->started, 1);
+    group_test_sleep_ms(200);
+    atomic_store(&env->finished, 1);
+}
+
+AVS_UNIT_TEST(event_loop_group, remove_waits_for_member_being_served) {
+    anjay_event_loop_group_t *group = anjay_event_loop_group_new();
+    AVS_UNIT_ASSERT_NOT_NULL(group);
+    anjay_t *anjay = group_test_anjay_new();
+    group_test_slow_job_env_t job_env = { 0 };
+    group_test_slow_job_env_t *job_env_ptr = &job_env;
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(anjay_get_scheduler(anjay), NULL,
+                                          group_test_slow_job, &job_env_ptr,
+                                          sizeof(job_env_ptr)));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_add(group, anjay));
+    pthread_t thread;
+    AVS_UNIT_ASSERT_SUCCESS(
+            pthread_create(&thread, NULL, group_test_run, group));
+    for (int i = 0; i < 500 && !atomic_load(&job_env.started); ++i) {
+        group_test_sleep_ms(10);
+    }
+    AVS_UNIT_ASSERT_TRUE(atomic_load(&job_env.started));
+
+    // the group is not locked while the job runs...
+    AVS_UNIT_ASSERT_EQUAL(anjay_event_loop_group_size(group), 1);
+    // ...but the instance is not released before it finishes
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_remove(group, anjay));
+    AVS_UNIT_ASSERT_TRUE(atomic_load(&job_env.finished));
+    AVS_UNIT_ASSERT_EQUAL(anjay_event_loop_group_size(group), 0);
+    anjay_delete(anjay);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_loop_group_interrupt(group));
+    void *thread_result;
+    AVS_UNIT_ASSERT_SUCCESS(pthread_join(thread, &thread_result));
+    AVS_UNIT_ASSERT_NULL(thread_result);
+    anjay_event_loop_group_delete(group);
+}
+#endif // ANJAY_WITH_THREAD_SAFETY
+
+AVS_UNIT_TEST(event_loop, socket_set_version_stable_without_changes) {
+    anjay_t *anjay = group_test_anjay_new();
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    const size_t version = _anjay_socket_set_version(anjay_unlocked);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_socket_set_version(anjay_unlocked), version);
+    _anjay_socket_set_changed(anjay_unlocked);
+    AVS_UNIT_ASSERT_NOT_EQUAL(_anjay_socket_set_version(anjay_unlocked),
+                              version);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    anjay_delete(anjay);
+}
+
+AVS_UNIT_TEST(event_loop, socket_set_reused_until_version_changes) {
+    anjay_t *anjay = group_test_anjay_new();
+    event_loop_state_t state = {
+        .max_wait_time = AVS_TIME_DURATION_ZERO
+    };
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(update_socket_set(&state, anjay_unlocked),
+                          HANDLE_SOCKETS_CONTINUE);
+    AVS_UNIT_ASSERT_TRUE(state.entries_valid);
+    AVS_UNIT_ASSERT_NULL(state.entries);
+
+    // an entry that would never be collected is only kept if the list is not
+    // collected anew
+    AVS_LIST(anjay_socket_entry_t) marker =
+            AVS_LIST_NEW_ELEMENT(anjay_socket_entry_t);
+    AVS_UNIT_ASSERT_NOT_NULL(marker);
+    state.entries = marker;
+    AVS_UNIT_ASSERT_EQUAL(update_socket_set(&state, anjay_unlocked),
+                          HANDLE_SOCKETS_CONTINUE);
+    AVS_UNIT_ASSERT_TRUE(state.entries == marker);
+
+    _anjay_socket_set_changed(anjay_unlocked);
+    AVS_UNIT_ASSERT_EQUAL(update_socket_set(&state, anjay_unlocked),
+                          HANDLE_SOCKETS_CONTINUE);
+    AVS_UNIT_ASSERT_TRUE(state.entries_valid);
+    AVS_UNIT_ASSERT_NULL(state.entries);
+    AVS_UNIT_ASSERT_EQUAL(state.entries_version,
+                          _anjay_socket_set_version(anjay_unlocked));
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    event_loop_state_cleanup(&state);
+    AVS_UNIT_ASSERT_FALSE(state.entries_valid);
+    anjay_delete(anjay);
+}
+
+static void serve_any_test_job(avs_sched_t *sched, const void *jobs_run) {
+    (void) sched;
+    ++**(int *const *) jobs_run;
+}
+
+AVS_UNIT_TEST(event_loop, serve_any_batched_runs_due_jobs) {
+    anjay_t *anjay = group_test_anjay_new();
+    int jobs_run = 0;
+    int *jobs_run_ptr = &jobs_run;
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(anjay_get_scheduler(anjay), NULL,
+                                          serve_any_test_job, &jobs_run_ptr,
+                                          sizeof(jobs_run_ptr)));
+
+    AVS_UNIT_ASSERT_FAILED(anjay_serve_any_batched(
+            anjay, AVS_TIME_DURATION_ZERO,
+            avs_time_duration_from_scalar(-1, AVS_TIME_S)));
+    AVS_UNIT_ASSERT_FAILED(anjay_serve_any_batched(
+            anjay, AVS_TIME_DURATION_INVALID, AVS_TIME_DURATION_ZERO));
+    AVS_UNIT_ASSERT_EQUAL(jobs_run, 0);
+
+    // there are no sockets to serve, but the due jobs are run nevertheless
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve_any_batched(
+            anjay, AVS_TIME_DURATION_ZERO, AVS_TIME_DURATION_ZERO));
+    AVS_UNIT_ASSERT_EQUAL(jobs_run, 1);
+    anjay_delete(anjay);
+}
+
+#ifdef EVENT_LOOP_USE_POLL
+typedef struct {
+    int local;
+    int remote;
+} socket_pair_t;
+
+static socket_pair_t socket_pair_new(void) {
+    int fds[2];
+    AVS_UNIT_ASSERT_SUCCESS(socketpair(AF_UNIX, SOCK_DGRAM, 0, fds));
+    return (socket_pair_t) {
+        .local = fds[0],
+        .remote = fds[1]
+    };
+}
+
+static void socket_pair_send(const socket_pair_t *pair) {
+    AVS_UNIT_ASSERT_EQUAL(send(pair->remote, "x", 1, 0), 1);
+}
+
+static void socket_pair_drain(const socket_pair_t *pair) {
+    char byte;
+    AVS_UNIT_ASSERT_EQUAL(recv(pair->local, &byte, 1, 0), 1);
+}
+
+static void socket_pair_close(const socket_pair_t *pair) {
+    close(pair->local);
+    close(pair->remote);
+}
+
+AVS_UNIT_TEST(event_loop, one_shot_state_uses_poll) {
+    socket_pair_t pairs[2] = { socket_pair_new(), socket_pair_new() };
+    struct pollfd pollfds[2] = {
+        { .fd = pairs[0].local, .events = POLLIN },
+        { .fd = pairs[1].local, .events = POLLIN }
+    };
+    // state as set up by anjay_serve_any()
+    event_loop_state_t state = {
+        .max_wait_time = AVS_TIME_DURATION_ZERO
+    };
+    state.pollfds = pollfds;
+    state.pollfds_size = state.pollfds_count = AVS_ARRAY_SIZE(pollfds);
+
+    AVS_UNIT_ASSERT_FALSE(wait_for_sockets(&state, AVS_TIME_DURATION_ZERO));
+    socket_pair_send(&pairs[1]);
+    AVS_UNIT_ASSERT_TRUE(wait_for_sockets(&state, AVS_TIME_DURATION_ZERO));
+    AVS_UNIT_ASSERT_FALSE(pollfds[0].revents);
+    AVS_UNIT_ASSERT_TRUE(pollfds[1].revents & POLLIN);
+#    ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+    // no event queue is set up for a single wait
+    AVS_UNIT_ASSERT_FALSE(state.queue_open);
+#    endif // EVENT_LOOP_USE_KERNEL_QUEUE
+
+    socket_pair_drain(&pairs[1]);
+    AVS_UNIT_ASSERT_FALSE(wait_for_sockets(&state, AVS_TIME_DURATION_ZERO));
+    socket_pair_close(&pairs[0]);
+    socket_pair_close(&pairs[1]);
+}
+#endif // EVENT_LOOP_USE_POLL
+
+#ifdef EVENT_LOOP_USE_KERNEL_QUEUE
+static void replace_registrations(event_loop_state_t *state,
+                                  const event_loop_registration_t *regs,
+                                  size_t count,
+                                  bool *out_failed) {
+    event_loop_registration_t *copy = (event_loop_registration_t *) avs_malloc(
+            count * sizeof(*copy));
+    AVS_UNIT_ASSERT_NOT_NULL(copy);
+    memcpy(copy, regs, count * sizeof(*copy));
+    queue_replace_registrations(state, copy, count, out_failed);
+}
+
+static int wait_ready(event_loop_state_t *state,
+                      size_t ready[EVENT_LOOP_MAX_EVENTS]) {
+    return queue_wait(state, ready, AVS_TIME_DURATION_ZERO);
+}
+
+AVS_UNIT_TEST(event_loop, kernel_queue_follows_socket_set) {
+    // the sockets are only used as identifiers, they are never dereferenced
+    char dummy[3];
+    avs_net_socket_t *const sock_a = (avs_net_socket_t *) &dummy[0];
+    avs_net_socket_t *const sock_b = (avs_net_socket_t *) &dummy[1];
+    avs_net_socket_t *const sock_c = (avs_net_socket_t *) &dummy[2];
+    socket_pair_t a = socket_pair_new();
+    socket_pair_t b = socket_pair_new();
+    event_loop_state_t state = {
+        .max_wait_time = AVS_TIME_DURATION_ZERO,
+        .use_queue = true
+    };
+    AVS_UNIT_ASSERT_TRUE((state.queue_fd = queue_create()) >= 0);
+    state.queue_open = true;
+
+    bool failed[2];
+    replace_registrations(&state,
+                          (const event_loop_registration_t[]) {
+                              { a.local, sock_a },
+                              { b.local, sock_b }
+                          },
+                          2, failed);
+    AVS_UNIT_ASSERT_FALSE(failed[0]);
+    AVS_UNIT_ASSERT_FALSE(failed[1]);
+    AVS_UNIT_ASSERT_EQUAL(state.registrations_count, 2);
+
+    size_t ready[EVENT_LOOP_MAX_EVENTS];
+    AVS_UNIT_ASSERT_EQUAL(wait_ready(&state, ready), 0);
+    socket_pair_send(&b);
+    AVS_UNIT_ASSERT_EQUAL(wait_ready(&state, ready), 1);
+    AVS_UNIT_ASSERT_TRUE(state.registrations[ready[0]].socket == sock_b);
+    // sockets are level-triggered, so the event is reported until handled
+    AVS_UNIT_ASSERT_EQUAL(wait_ready(&state, ready), 1);
+    socket_pair_drain(&b);
+    AVS_UNIT_ASSERT_EQUAL(wait_ready(&state, ready), 0);
+
+    // a is not registered anymore, and b is registered at another index
+    replace_registrations(&state,
+                          (const event_loop_registration_t[]) {
+                              { b.local, sock_b }
+                          },
+                          1, failed);
+    AVS_UNIT_ASSERT_EQUAL(state.registrations_count, 1);
+    socket_pair_send(&a);
+    AVS_UNIT_ASSERT_EQUAL(wait_ready(&state, ready), 0);
+    socket_pair_send(&b);
+    AVS_UNIT_ASSERT_EQUAL(wait_ready(&state, ready), 1);
+    AVS_UNIT_ASSERT_EQUAL(ready[0], 0);
+    AVS_UNIT_ASSERT_TRUE(state.registrations[0].socket == sock_b);
+    socket_pair_drain(&b);
+
+    // descriptors that cannot be registered are skipped
+    replace_registrations(&state,
+                          (const event_loop_registration_t[]) {
+                              { INVALID_SOCKET, sock_c },
+                              { b.local, sock_b }
+                          },
+                          2, failed);
+    AVS_UNIT_ASSERT_TRUE(failed[0]);
+    AVS_UNIT_ASSERT_FALSE(failed[1]);
+    AVS_UNIT_ASSERT_EQUAL(state.registrations_count, 1);
+    AVS_UNIT_ASSERT_TRUE(state.registrations[0].socket == sock_b);
+    socket_pair_send(&b);
+    AVS_UNIT_ASSERT_EQUAL(wait_ready(&state, ready), 1);
+    AVS_UNIT_ASSERT_EQUAL(ready[0], 0);
+
+    event_loop_state_cleanup(&state);
+    AVS_UNIT_ASSERT_FALSE(state.queue_open);
+    socket_pair_close(&a);
+    socket_pair_close(&b);
+}
+#endif // EVENT_LOOP_USE_KERNEL_QUEUE
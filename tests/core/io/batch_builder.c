@@ -35,6 +35,11 @@ static void builder_teardown(anjay_batch_builder_t *builder) {
     AVS_UNIT_ASSERT_NULL(builder);
 }
 
+static anjay_batch_entry_t *last_entry(anjay_batch_builder_t *builder) {
+    AVS_UNIT_ASSERT_NOT_NULL(builder->list);
+    return AVS_CONTAINER_OF(builder->append_ptr, anjay_batch_entry_t, next);
+}
+
 static anjay_batch_builder_t *builder_setup(void) {
     anjay_batch_builder_t *builder = _anjay_batch_builder_new();
     AVS_UNIT_ASSERT_NOT_NULL(builder);
@@ -52,7 +57,7 @@ AVS_UNIT_TEST(batch_builder, single_int_entry) {
     AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
             builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
             AVS_TIME_REAL_INVALID, 0));
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
 
     builder_teardown(builder);
 }
@@ -66,7 +71,39 @@ AVS_UNIT_TEST(batch_builder, two_entries) {
     AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
             builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
             AVS_TIME_REAL_INVALID, 0));
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 2);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 2);
+
+    builder_teardown(builder);
+}
+
+AVS_UNIT_TEST(batch_builder, rollback) {
+    anjay_batch_builder_t *builder = builder_setup();
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
+            builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
+            AVS_TIME_REAL_INVALID, 42));
+    const anjay_batch_builder_mark_t mark = _anjay_batch_builder_mark(builder);
+
+    // enough entries to require allocating more chunks
+    for (anjay_riid_t riid = 1; riid <= 100; ++riid) {
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_string(
+                builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, riid),
+                AVS_TIME_REAL_INVALID, "raz dwa trzy"));
+    }
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 101);
+    AVS_UNIT_ASSERT_TRUE(builder->arena.chunks != mark.arena.chunk);
+
+    _anjay_batch_builder_rollback(builder, &mark);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
+    AVS_UNIT_ASSERT_TRUE(builder->arena.chunks == mark.arena.chunk);
+    AVS_UNIT_ASSERT_EQUAL(builder->list->data.value.int_value, 42);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_string(
+            builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 1),
+            AVS_TIME_REAL_INVALID, "cztery"));
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 2);
+    AVS_UNIT_ASSERT_EQUAL_STRING(last_entry(builder)->data.value.string,
+                                 "cztery");
 
     builder_teardown(builder);
 }
@@ -83,17 +120,21 @@ AVS_UNIT_TEST(batch_builder, string_copy) {
     AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_string(
             builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
             AVS_TIME_REAL_INVALID, str));
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
 
     // Passed string shouldn't be required anymore.
     avs_free(str);
 
-    AVS_LIST(anjay_batch_entry_t) entry = AVS_LIST_TAIL(builder->list);
+    anjay_batch_entry_t *entry = last_entry(builder);
     AVS_UNIT_ASSERT_EQUAL_STRING(entry->data.value.string, test_string.data);
 
     builder_teardown(builder);
 }
 
+static void count_release(void *counter) {
+    ++*(int *) counter;
+}
+
 #ifdef ANJAY_WITH_LWM2M11
 AVS_UNIT_TEST(batch_builder, bytes_copy) {
     anjay_batch_builder_t *builder = builder_setup();
@@ -106,12 +147,12 @@ AVS_UNIT_TEST(batch_builder, bytes_copy) {
 
     _anjay_batch_add_bytes(builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
                            AVS_TIME_REAL_INVALID, bytes, test_bytes.size);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
 
     // Passed bytes shouldn't be required anymore.
     avs_free(bytes);
 
-    AVS_LIST(anjay_batch_entry_t) entry = AVS_LIST_TAIL(builder->list);
+    anjay_batch_entry_t *entry = last_entry(builder);
     AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(entry->data.value.bytes.data,
                                       test_bytes.data, test_bytes.size);
 
@@ -123,30 +164,231 @@ AVS_UNIT_TEST(batch_builder, empty_bytes) {
 
     _anjay_batch_add_bytes(builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
                            AVS_TIME_REAL_INVALID, NULL, 0);
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
 
-    AVS_LIST(anjay_batch_entry_t) entry = AVS_LIST_TAIL(builder->list);
+    anjay_batch_entry_t *entry = last_entry(builder);
     AVS_UNIT_ASSERT_NULL(entry->data.value.bytes.data);
     AVS_UNIT_ASSERT_EQUAL(entry->data.value.bytes.length, 0);
 
     builder_teardown(builder);
 }
+
+AVS_UNIT_TEST(batch_builder, bytes_external) {
+    anjay_batch_builder_t *builder = builder_setup();
+
+    static const char DATA[] = "\x01\x02\x03\x04\x05";
+    int kept_released = 0;
+    int rolled_back_released = 0;
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_bytes_external(
+            builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
+            AVS_TIME_REAL_INVALID, DATA, sizeof(DATA) - 1, count_release,
+            &kept_released));
+    // data is referenced, not copied
+    AVS_UNIT_ASSERT_TRUE(last_entry(builder)->data.value.bytes.data == DATA);
+
+    const anjay_batch_builder_mark_t mark = _anjay_batch_builder_mark(builder);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_bytes_external(
+            builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 1),
+            AVS_TIME_REAL_INVALID, DATA, sizeof(DATA) - 1, count_release,
+            &rolled_back_released));
+    _anjay_batch_builder_rollback(builder, &mark);
+    AVS_UNIT_ASSERT_EQUAL(rolled_back_released, 1);
+    AVS_UNIT_ASSERT_EQUAL(kept_released, 0);
+
+    // failure does not call the release function
+    AVS_UNIT_ASSERT_FAILED(_anjay_batch_add_bytes_external(
+            builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 1),
+            AVS_TIME_REAL_INVALID, NULL, 1, count_release,
+            &rolled_back_released));
+    AVS_UNIT_ASSERT_EQUAL(rolled_back_released, 1);
+
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+    anjay_batch_t *another_ref = _anjay_batch_acquire(batch);
+    _anjay_batch_release(&batch);
+    AVS_UNIT_ASSERT_EQUAL(kept_released, 0);
+    _anjay_batch_release(&another_ref);
+    AVS_UNIT_ASSERT_EQUAL(kept_released, 1);
+}
 #endif // ANJAY_WITH_LWM2M11
 
+AVS_UNIT_TEST(batch_builder, ret_bytes_borrowed) {
+    anjay_batch_builder_t *builder = builder_setup();
+
+    static const char DATA[] = "\x01\x02\x03";
+    int released = 0;
+    const avs_time_real_t timestamp = AVS_TIME_REAL_INVALID;
+    builder_out_ctx_t ctx =
+            builder_out_ctx_new(builder, &MAKE_ROOT_PATH(), &timestamp);
+    anjay_unlocked_output_ctx_t *out = (anjay_unlocked_output_ctx_t *) &ctx;
+
+    // no path set: the value is rejected, but still released
+    AVS_UNIT_ASSERT_FAILED(_anjay_ret_bytes_borrowed_unlocked(
+            out, DATA, sizeof(DATA) - 1, count_release, &released));
+    AVS_UNIT_ASSERT_EQUAL(released, 1);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_path(
+            out, &MAKE_RESOURCE_PATH(0, 0, 0)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_bytes_borrowed_unlocked(
+            out, DATA, sizeof(DATA) - 1, count_release, &released));
+    AVS_UNIT_ASSERT_SUCCESS(output_close(out));
+    // data is referenced, not copied
+    AVS_UNIT_ASSERT_TRUE(last_entry(builder)->data.value.bytes.data == DATA);
+    AVS_UNIT_ASSERT_EQUAL(released, 1);
+
+    builder_teardown(builder);
+    AVS_UNIT_ASSERT_EQUAL(released, 2);
+}
+
 AVS_UNIT_TEST(batch_builder, compile) {
     anjay_batch_builder_t *builder = builder_setup();
 
     AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
             builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
             AVS_TIME_REAL_INVALID, 0));
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
 
     anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
     AVS_UNIT_ASSERT_NULL(builder);
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(batch->list), 1);
-    AVS_UNIT_ASSERT_EQUAL(batch->ref_count, 1);
+    AVS_UNIT_ASSERT_NOT_NULL(batch->list);
+    AVS_UNIT_ASSERT_NULL(batch->list->next);
+    AVS_UNIT_ASSERT_EQUAL((size_t) batch->ref_count, 1);
+
+    _anjay_batch_release(&batch);
+    AVS_UNIT_ASSERT_NULL(batch);
+}
+
+AVS_UNIT_TEST(batch_builder, acquire_release) {
+    anjay_batch_builder_t *builder = builder_setup();
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_string(
+            builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 0),
+            AVS_TIME_REAL_INVALID, "raz dwa trzy"));
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+
+    anjay_batch_t *second_ref = _anjay_batch_acquire(batch);
+    AVS_UNIT_ASSERT_TRUE(second_ref == batch);
+    AVS_UNIT_ASSERT_EQUAL((size_t) batch->ref_count, 2);
 
     _anjay_batch_release(&batch);
     AVS_UNIT_ASSERT_NULL(batch);
+    AVS_UNIT_ASSERT_EQUAL((size_t) second_ref->ref_count, 1);
+    AVS_UNIT_ASSERT_EQUAL_STRING(second_ref->list->data.value.string,
+                                 "raz dwa trzy");
+
+    _anjay_batch_release(&second_ref);
+    AVS_UNIT_ASSERT_NULL(second_ref);
+}
+
+AVS_UNIT_TEST(batch_builder, numeric_array) {
+    anjay_batch_builder_t *builder = builder_setup();
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
+            builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 1),
+            AVS_TIME_REAL_INVALID, 42));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_double(
+            builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 3),
+            AVS_TIME_REAL_INVALID, 2.5));
+
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+    // only computed when first needed
+    AVS_UNIT_ASSERT_FALSE(batch->numeric_array_filled);
+    AVS_UNIT_ASSERT_NULL(batch->numeric_array);
+
+    size_t count = 0;
+    const double *values = _anjay_batch_data_numeric_array(batch, &count);
+    AVS_UNIT_ASSERT_TRUE(batch->numeric_array_filled);
+    AVS_UNIT_ASSERT_NOT_NULL(values);
+    AVS_UNIT_ASSERT_TRUE(_anjay_batch_data_numeric_array(batch, &count)
+                         == values);
+    AVS_UNIT_ASSERT_EQUAL(count, 2);
+    AVS_UNIT_ASSERT_EQUAL(values[0], 42.0);
+    AVS_UNIT_ASSERT_EQUAL(values[1], 2.5);
+
+    _anjay_batch_release(&batch);
+}
+
+AVS_UNIT_TEST(batch_builder, numeric_array_mixed_types) {
+    anjay_batch_builder_t *builder = builder_setup();
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
+            builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 1),
+            AVS_TIME_REAL_INVALID, 42));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_bool(
+            builder, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 3),
+            AVS_TIME_REAL_INVALID, true));
+
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+
+    size_t count = 0;
+    AVS_UNIT_ASSERT_NULL(_anjay_batch_data_numeric_array(batch, &count));
+    AVS_UNIT_ASSERT_EQUAL(count, 0);
+
+    _anjay_batch_release(&batch);
+}
+
+static avs_time_real_t test_time(int64_t seconds) {
+    return (avs_time_real_t) {
+        .since_real_epoch = avs_time_duration_from_scalar(seconds, AVS_TIME_S)
+    };
+}
+
+AVS_UNIT_TEST(batch_builder, series_without_begin) {
+    anjay_batch_builder_t *builder = builder_setup();
+
+    AVS_UNIT_ASSERT_FAILED(_anjay_batch_series_add_double(
+            builder, test_time(1700000000), 1.0));
+    AVS_UNIT_ASSERT_FAILED(_anjay_batch_series_begin(
+            builder, &MAKE_INSTANCE_PATH(0, 0)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_series_begin(
+            builder, &MAKE_RESOURCE_PATH(0, 0, 0)));
+    AVS_UNIT_ASSERT_FAILED(_anjay_batch_series_add_double(
+            builder, AVS_TIME_REAL_INVALID, 1.0));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
+            builder, &MAKE_RESOURCE_PATH(0, 0, 1), AVS_TIME_REAL_INVALID, 42));
+    // adding other data finishes the series
+    AVS_UNIT_ASSERT_FAILED(_anjay_batch_series_add_double(
+            builder, test_time(1700000000), 1.0));
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
+
+    builder_teardown(builder);
+}
+
+AVS_UNIT_TEST(batch_builder, series_segments) {
+    anjay_batch_builder_t *builder = builder_setup();
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_series_begin(
+            builder, &MAKE_RESOURCE_PATH(3303, 0, 5700)));
+    for (int64_t i = 0; i < 100; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_series_add_double(
+                builder, test_time(1700000000 + i), (double) i));
+    }
+    // segments of 8, 16, 32 and 44 (of 64) samples
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 4);
+    const anjay_batch_entry_t *entry = last_entry(builder);
+    AVS_UNIT_ASSERT_EQUAL(entry->data.type, ANJAY_BATCH_DATA_DOUBLE_SERIES);
+    AVS_UNIT_ASSERT_EQUAL(entry->data.value.series.capacity,
+                          BATCH_SERIES_SEGMENT_MAX_SIZE);
+    AVS_UNIT_ASSERT_EQUAL(entry->data.value.series.count, 44);
+    AVS_UNIT_ASSERT_EQUAL(entry->timestamp.since_real_epoch.seconds,
+                          1700000056);
+    AVS_UNIT_ASSERT_EQUAL(entry->data.value.series.samples[43].time_offset,
+                          43.0);
+    AVS_UNIT_ASSERT_EQUAL(entry->data.value.series.samples[43].value, 99.0);
+
+    // relative timestamps can't share a segment with absolute ones
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_batch_series_add_double(builder, test_time(10), 100.0));
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 5);
+
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+    AVS_UNIT_ASSERT_TRUE(_anjay_batch_data_requires_hierarchical_format(batch));
+    size_t count = 0;
+    AVS_UNIT_ASSERT_NULL(_anjay_batch_data_numeric_array(batch, &count));
+    _anjay_batch_release(&batch);
 }
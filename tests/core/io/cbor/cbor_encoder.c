@@ -229,13 +229,24 @@ static void test_float(float value, test_data_t *expected) {
 #define TEST_FLOAT(Num, Data) \
     TEST_FLOAT_IMPL(AVS_CONCAT(float, __LINE__), float, Num, Data)
 
-// TODO: Make those tests work as defined in RFC7049 Appendix C, it requires
-// half floats support.
-// TEST_FLOAT(0.0, "\xF9\x00\x00")
-// TEST_FLOAT(-0.0, "\xF9\x80\x00")
-// TEST_FLOAT(1.0, "\xF9\x3C\x00")
+#ifdef ANJAY_WITH_CBOR_COMPACT_NUMBERS
+// RFC 7049 Appendix C, except that integral values are encoded as integers
+TEST_FLOAT(0.0, "\x00")
+TEST_FLOAT(-0.0, "\xF9\x80\x00")
+TEST_FLOAT(1.0, "\x01")
+TEST_FLOAT(1.5, "\xF9\x3E\x00")
+TEST_FLOAT(65504.5, "\xFA\x47\x7F\xE0\x80")
+TEST_FLOAT(5.960464477539063e-8f, "\xF9\x00\x01")
+TEST_FLOAT(0.00006103515625, "\xF9\x04\x00")
+TEST_FLOAT(-4.0, "\x23")
+TEST_FLOAT(100000.0, "\x1A\x00\x01\x86\xA0")
+TEST_FLOAT(INFINITY, "\xF9\x7C\x00")
+TEST_FLOAT(-INFINITY, "\xF9\xFC\x00")
+TEST_FLOAT(NAN, "\xF9\x7E\x00")
+#else  // ANJAY_WITH_CBOR_COMPACT_NUMBERS
 TEST_FLOAT(-0.0, "\xFA\x80\x00\x00\x00")
 TEST_FLOAT(100000.0, "\xFA\x47\xC3\x50\x00")
+#endif // ANJAY_WITH_CBOR_COMPACT_NUMBERS
 
 static void test_double(double value, test_data_t *expected) {
     cbor_test_env_t env;
@@ -260,9 +271,17 @@ static void test_double(double value, test_data_t *expected) {
     TEST_DOUBLE_IMPL(AVS_CONCAT(double, __LINE__), double, Num, Data)
 
 TEST_DOUBLE(1.1, "\xFB\x3F\xF1\x99\x99\x99\x99\x99\x9A")
-TEST_DOUBLE(100000.0, "\xFA\x47\xC3\x50\x00")
 TEST_DOUBLE(1.0e+300, "\xFB\x7E\x37\xE4\x3C\x88\x00\x75\x9C")
 TEST_DOUBLE(-4.1, "\xFB\xC0\x10\x66\x66\x66\x66\x66\x66")
+#ifdef ANJAY_WITH_CBOR_COMPACT_NUMBERS
+TEST_DOUBLE(100000.0, "\x1A\x00\x01\x86\xA0")
+TEST_DOUBLE(21.0, "\x15")
+TEST_DOUBLE(21.5, "\xF9\x4D\x60")
+TEST_DOUBLE(-9223372036854775808.0, "\x3B\x7F\xFF\xFF\xFF\xFF\xFF\xFF\xFF")
+TEST_DOUBLE(9223372036854775808.0, "\xFA\x5F\x00\x00\x00")
+#else  // ANJAY_WITH_CBOR_COMPACT_NUMBERS
+TEST_DOUBLE(100000.0, "\xFA\x47\xC3\x50\x00")
+#endif // ANJAY_WITH_CBOR_COMPACT_NUMBERS
 
 static void test_bytes(test_data_t *input, test_data_t *expected) {
     cbor_test_env_t env;
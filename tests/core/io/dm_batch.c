@@ -259,8 +259,8 @@ AVS_UNIT_TEST(dm_batch, single_bytes) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, BYTES_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         BYTES_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -278,8 +278,8 @@ AVS_UNIT_TEST(dm_batch, single_string) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, STRING_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         STRING_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -296,8 +296,8 @@ AVS_UNIT_TEST(dm_batch, single_int) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, INT_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         INT_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -314,8 +314,8 @@ AVS_UNIT_TEST(dm_batch, single_uint) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, UINT_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         UINT_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -332,8 +332,8 @@ AVS_UNIT_TEST(dm_batch, single_double) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, DOUBLE_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         DOUBLE_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -350,8 +350,8 @@ AVS_UNIT_TEST(dm_batch, single_bool) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, BOOL_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         BOOL_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -368,8 +368,8 @@ AVS_UNIT_TEST(dm_batch, single_objlnk) {
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, OBJLNK_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 1);
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 1);
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         OBJLNK_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -386,7 +386,7 @@ AVS_UNIT_TEST(dm_batch, two_resources) {
     TEST_SETUP(MOCK_CLOCK_START_RELATIVE);
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, INT_RID));
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         INT_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -397,7 +397,7 @@ AVS_UNIT_TEST(dm_batch, two_resources) {
                                         }));
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, DOUBLE_RID));
-    AVS_UNIT_ASSERT_TRUE(is_entry_valid(AVS_LIST_TAIL(builder->list),
+    AVS_UNIT_ASSERT_TRUE(is_entry_valid(last_entry(builder),
                                         DOUBLE_RID,
                                         ANJAY_ID_INVALID,
                                         (anjay_batch_data_t) {
@@ -407,7 +407,7 @@ AVS_UNIT_TEST(dm_batch, two_resources) {
                                             }
                                         }));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 2);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 2);
 
     TEST_TEARDOWN();
 }
@@ -416,7 +416,8 @@ AVS_UNIT_TEST(dm_batch, multiple_instance_resource) {
     TEST_SETUP(MOCK_CLOCK_START_RELATIVE);
 
     AVS_UNIT_ASSERT_SUCCESS(add_current(builder, anjay, INT_ARRAY_RID));
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), int_array_size + 1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder),
+                          int_array_size + 1);
 
     AVS_UNIT_ASSERT_TRUE(
             is_entry_valid(builder->list, INT_ARRAY_RID, ANJAY_ID_INVALID,
@@ -426,7 +427,7 @@ AVS_UNIT_TEST(dm_batch, multiple_instance_resource) {
 
     anjay_batch_entry_t *entry;
     uint16_t riid = 0;
-    AVS_LIST_FOREACH(entry, AVS_LIST_NEXT(builder->list)) {
+    for (entry = builder->list->next; entry; entry = entry->next) {
         AVS_UNIT_ASSERT_TRUE(is_entry_valid(entry,
                                             INT_ARRAY_RID,
                                             riid,
@@ -445,11 +446,11 @@ AVS_UNIT_TEST(dm_batch, multiple_instance_resource) {
 AVS_UNIT_TEST(dm_batch, illegal_op) {
     TEST_SETUP(MOCK_CLOCK_START_RELATIVE);
 
-    AVS_LIST(anjay_batch_entry_t) *initial_append_ptr = builder->append_ptr;
+    anjay_batch_entry_t **initial_append_ptr = builder->append_ptr;
 
     AVS_UNIT_ASSERT_FAILED(add_current(builder, anjay, ILLEGAL_IMPL_RID));
 
-    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(builder->list), 0);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(builder), 0);
     AVS_UNIT_ASSERT_TRUE(builder->append_ptr == initial_append_ptr);
     AVS_UNIT_ASSERT_NULL(*builder->append_ptr);
 
@@ -573,6 +574,70 @@ AVS_UNIT_TEST(dm_batch, serialize_one_resource) {
     TEST_TEARDOWN();
 }
 
+AVS_UNIT_TEST(dm_batch, smallest_format_one_resource) {
+    TEST_SETUP(MOCK_CLOCK_START_RELATIVE);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
+            builder, &MAKE_RESOURCE_PATH(TEST_OID, 0, INT_RID),
+            AVS_TIME_REAL_INVALID, INT_VALUE));
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+
+    const anjay_batch_t *const values[] = { batch };
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    // TLV: 2 bytes of header and 4 bytes of value; Plain Text: 9 digits
+    AVS_UNIT_ASSERT_EQUAL(
+            _anjay_batch_smallest_format(
+                    anjay_unlocked, ANJAY_LWM2M_VERSION_1_0,
+                    &MAKE_RESOURCE_PATH(TEST_OID, 0, INT_RID),
+                    ANJAY_ACTION_READ, 1, values, AVS_COAP_FORMAT_NONE),
+            AVS_COAP_FORMAT_OMA_LWM2M_TLV);
+#ifdef ANJAY_WITH_CBOR
+    // CBOR: 1 byte of header and 4 bytes of value
+    AVS_UNIT_ASSERT_EQUAL(
+            _anjay_batch_smallest_format(
+                    anjay_unlocked, ANJAY_LWM2M_VERSION_1_1,
+                    &MAKE_RESOURCE_PATH(TEST_OID, 0, INT_RID),
+                    ANJAY_ACTION_READ, 1, values, AVS_COAP_FORMAT_NONE),
+            AVS_COAP_FORMAT_CBOR);
+#endif // ANJAY_WITH_CBOR
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    _anjay_batch_release(&batch);
+
+    TEST_TEARDOWN();
+}
+
+#ifdef ANJAY_WITH_LWM2M_CBOR
+AVS_UNIT_TEST(dm_batch, smallest_format_never_lwm2m_cbor) {
+    TEST_SETUP(MOCK_CLOCK_START_RELATIVE);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
+            builder, &MAKE_RESOURCE_PATH(TEST_OID, 0, INT_RID),
+            AVS_TIME_REAL_INVALID, INT_VALUE));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_bool(
+            builder, &MAKE_RESOURCE_PATH(TEST_OID, 0, BOOL_RID),
+            AVS_TIME_REAL_INVALID, true));
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+
+    const anjay_batch_t *const values[] = { batch };
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    // LwM2M CBOR would be the most compact here, but requires LwM2M 1.2
+    AVS_UNIT_ASSERT_NOT_EQUAL(
+            _anjay_batch_smallest_format(
+                    anjay_unlocked, ANJAY_LWM2M_VERSION_1_1,
+                    &MAKE_INSTANCE_PATH(TEST_OID, 0), ANJAY_ACTION_READ, 1,
+                    values, AVS_COAP_FORMAT_NONE),
+            AVS_COAP_FORMAT_OMA_LWM2M_CBOR);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    _anjay_batch_release(&batch);
+
+    TEST_TEARDOWN();
+}
+#endif // ANJAY_WITH_LWM2M_CBOR
+
 AVS_UNIT_TEST(dm_batch, serialize_one_resource_with_absolute_timestamp) {
     TEST_SETUP(MOCK_CLOCK_START_ABSOLUTE);
 
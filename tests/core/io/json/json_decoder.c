@@ -225,6 +225,35 @@ AVS_UNIT_TEST(json_decoder, string_space_unicode_escape) {
               ANJAY_JSON_LIKE_DECODER_STATE_ERROR);
 }
 
+AVS_UNIT_TEST(json_decoder, string_spanning_input_chunks) {
+    // whitespace, plain characters and an escape sequence that cross the
+    // boundaries of the decoder's look-ahead buffer
+    char data[256];
+    char expected[128];
+    size_t length = 0;
+    memset(data, ' ', 70);
+    length += 70;
+    data[length++] = '"';
+    memset(data + length, 'a', 60);
+    length += 60;
+    memcpy(data + length, "\\u0041", 6);
+    length += 6;
+    memset(data + length, 'b', 30);
+    length += 30;
+    memcpy(data + length, "\\n\"", 3);
+    length += 3;
+
+    memset(expected, 'a', 60);
+    expected[60] = 'A';
+    memset(expected + 61, 'b', 30);
+    strcpy(expected + 91, "\n");
+
+    SCOPED_TEST_ENV(data, length);
+    ASSERT_EQ_STR(read_short_string(DECODER), expected);
+    ASSERT_EQ(_anjay_json_like_decoder_state(DECODER),
+              ANJAY_JSON_LIKE_DECODER_STATE_FINISHED);
+}
+
 AVS_UNIT_TEST(json_decoder, boolean_true) {
     static const char data[] = "true";
     SCOPED_TEST_ENV(data, strlen(data));
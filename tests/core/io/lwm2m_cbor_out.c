@@ -0,0 +1,94 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_stream_outbuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#define TEST_ENV(Size, Uri)                                                \
+    char buf[Size];                                                        \
+    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;     \
+    avs_stream_outbuf_set_buffer(&outbuf, buf, sizeof(buf));               \
+    anjay_unlocked_output_ctx_t *out =                                     \
+            _anjay_output_lwm2m_cbor_create((avs_stream_t *) &outbuf, Uri); \
+    AVS_UNIT_ASSERT_NOT_NULL(out)
+
+#define VERIFY_BYTES(Data)                                       \
+    do {                                                         \
+        AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf), \
+                              sizeof(Data) - 1);                 \
+        AVS_UNIT_ASSERT_EQUAL_BYTES(buf, Data);                  \
+    } while (0)
+
+static void write_int(anjay_unlocked_output_ctx_t *out,
+                      const anjay_uri_path_t *path,
+                      int64_t value) {
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_path(out, path));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_i64_unlocked(out, value));
+}
+
+AVS_UNIT_TEST(lwm2m_cbor_out, empty) {
+    TEST_ENV(8, &MAKE_OBJECT_PATH(3));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    VERIFY_BYTES("\xBF\xFF");
+}
+
+AVS_UNIT_TEST(lwm2m_cbor_out, single_resource) {
+    TEST_ENV(16, &MAKE_RESOURCE_PATH(3, 0, 1));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_output_set_path(out, &MAKE_RESOURCE_PATH(3, 0, 1)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_string_unlocked(out, "x"));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    // {[3, 0, 1]: "x"}
+    VERIFY_BYTES("\xBF\x83\x03\x00\x01\x61x\xFF");
+}
+
+AVS_UNIT_TEST(lwm2m_cbor_out, object) {
+    TEST_ENV(32, &MAKE_OBJECT_PATH(3));
+    write_int(out, &MAKE_RESOURCE_PATH(3, 0, 0), 1);
+    write_int(out, &MAKE_RESOURCE_PATH(3, 0, 1), 2);
+    write_int(out, &MAKE_RESOURCE_PATH(3, 1, 0), 3);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    // {3: {0: {0: 1, 1: 2}, 1: {0: 3}}}
+    VERIFY_BYTES("\xBF\x03\xBF\x00\xBF\x00\x01\x01\x02\xFF"
+                 "\x01\xBF\x00\x03\xFF\xFF\xFF");
+}
+
+AVS_UNIT_TEST(lwm2m_cbor_out, multiple_instance_resource) {
+    TEST_ENV(32, &MAKE_INSTANCE_PATH(3, 0));
+    write_int(out, &MAKE_RESOURCE_INSTANCE_PATH(3, 0, 7, 0), 5);
+    write_int(out, &MAKE_RESOURCE_INSTANCE_PATH(3, 0, 7, 1), 6);
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_output_set_path(out, &MAKE_RESOURCE_PATH(3, 0, 8)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_start_aggregate(out));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    // {[3, 0]: {7: {0: 5, 1: 6}, 8: {}}}
+    VERIFY_BYTES("\xBF\x82\x03\x00\xBF\x07\xBF\x00\x05\x01\x06\xFF"
+                 "\x08\xA0\xFF\xFF");
+}
+
+AVS_UNIT_TEST(lwm2m_cbor_out, unordered) {
+    TEST_ENV(32, &MAKE_ROOT_PATH());
+    write_int(out, &MAKE_RESOURCE_PATH(3, 0, 1), 1);
+    write_int(out, &MAKE_RESOURCE_PATH(1, 0, 0), 2);
+    write_int(out, &MAKE_RESOURCE_PATH(3, 0, 2), 3);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    // {3: {0: {1: 1}}, [1, 0, 0]: 2, [3, 0, 2]: 3}
+    VERIFY_BYTES("\xBF\x03\xBF\x00\xBF\x01\x01\xFF\xFF"
+                 "\x83\x01\x00\x00\x02\x83\x03\x00\x02\x03\xFF");
+}
+
+AVS_UNIT_TEST(lwm2m_cbor_out, timestamps_ignored) {
+    TEST_ENV(16, &MAKE_RESOURCE_PATH(3, 0, 1));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_time(out, 1234.5));
+    write_int(out, &MAKE_RESOURCE_PATH(3, 0, 1), 1);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    VERIFY_BYTES("\xBF\x83\x03\x00\x01\x01\xFF");
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_stream_outbuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#define TEST_ENV(Size, Uri)                                                \
+    char buf[Size];                                                        \
+    avs_stream_outbuf_t outbuf = AVS_STREAM_OUTBUF_STATIC_INITIALIZER;     \
+    avs_stream_outbuf_set_buffer(&outbuf, buf, sizeof(buf));               \
+    anjay_unlocked_output_ctx_t *out = _anjay_output_senml_like_create(    \
+            (avs_stream_t *) &outbuf, (Uri), AVS_COAP_FORMAT_SENML_JSON,   \
+            NULL);                                                         \
+    AVS_UNIT_ASSERT_NOT_NULL(out)
+
+#define VERIFY_BYTES(Data)                                       \
+    do {                                                         \
+        AVS_UNIT_ASSERT_EQUAL(avs_stream_outbuf_offset(&outbuf), \
+                              sizeof(Data) - 1);                 \
+        AVS_UNIT_ASSERT_EQUAL_BYTES(buf, Data);                  \
+    } while (0)
+
+static void
+write_resources(anjay_unlocked_output_ctx_t *out, anjay_iid_t iid, int count) {
+    for (int i = 0; i < count; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_path(
+                out, &MAKE_RESOURCE_PATH(3, iid, (anjay_rid_t) i)));
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_i64_unlocked(out, i));
+    }
+}
+
+AVS_UNIT_TEST(senml_like_out, basename_is_base_path) {
+    TEST_ENV(256, &MAKE_OBJECT_PATH(3));
+    write_resources(out, 0, 2);
+    write_resources(out, 12345, 1);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_path(
+            out, &MAKE_RESOURCE_INSTANCE_PATH(3, 12345, 7, 65534)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_i64_unlocked(out, 42));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    VERIFY_BYTES("[{\"bn\":\"/3\",\"n\":\"/0/0\",\"v\":0},"
+                 "{\"n\":\"/0/1\",\"v\":1},"
+                 "{\"n\":\"/12345/0\",\"v\":0},"
+                 "{\"n\":\"/12345/7/65534\",\"v\":42}]");
+}
+
+AVS_UNIT_TEST(senml_like_out, no_name_for_base_path) {
+    TEST_ENV(64, &MAKE_RESOURCE_PATH(3, 0, 1));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_output_set_path(out, &MAKE_RESOURCE_PATH(3, 0, 1)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_i64_unlocked(out, 1));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    VERIFY_BYTES("[{\"bn\":\"/3/0/1\",\"v\":1}]");
+}
+
+AVS_UNIT_TEST(senml_like_out, basename_changed_for_large_instances) {
+    TEST_ENV(512, &MAKE_OBJECT_PATH(3));
+    // size of the first instance is not known in advance, so the basename
+    // stays the same
+    write_resources(out, 0, 7);
+    // the following ones are expected to have the same size, so changing the
+    // basename pays off
+    write_resources(out, 1, 7);
+    write_resources(out, 2, 1);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    VERIFY_BYTES("[{\"bn\":\"/3\",\"n\":\"/0/0\",\"v\":0},"
+                 "{\"n\":\"/0/1\",\"v\":1},"
+                 "{\"n\":\"/0/2\",\"v\":2},"
+                 "{\"n\":\"/0/3\",\"v\":3},"
+                 "{\"n\":\"/0/4\",\"v\":4},"
+                 "{\"n\":\"/0/5\",\"v\":5},"
+                 "{\"n\":\"/0/6\",\"v\":6},"
+                 "{\"bn\":\"/3/1\",\"n\":\"/0\",\"v\":0},"
+                 "{\"n\":\"/1\",\"v\":1},"
+                 "{\"n\":\"/2\",\"v\":2},"
+                 "{\"n\":\"/3\",\"v\":3},"
+                 "{\"n\":\"/4\",\"v\":4},"
+                 "{\"n\":\"/5\",\"v\":5},"
+                 "{\"n\":\"/6\",\"v\":6},"
+                 "{\"bn\":\"/3/2\",\"n\":\"/0\",\"v\":0}]");
+}
+
+AVS_UNIT_TEST(senml_like_out, relative_time) {
+    TEST_ENV(256, &MAKE_RESOURCE_PATH(3303, 0, 5700));
+    static const double OFFSETS[] = { 0.0, 0.5, 1.0 };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(OFFSETS); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_path(
+                out, &MAKE_RESOURCE_PATH(3303, 0, 5700)));
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_output_set_relative_time(out, 1000.0, OFFSETS[i]));
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_double_unlocked(out, 20.0 + i));
+    }
+    // Time label is not inherited, so the next element needs Base Time only
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_output_set_path(out, &MAKE_RESOURCE_PATH(3303, 0, 5700)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_time(out, 1002.0));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_double_unlocked(out, 23.0));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+    VERIFY_BYTES("[{\"bn\":\"/3303/0/5700\",\"bt\":1000,\"v\":20},"
+                 "{\"t\":0.5,\"v\":21},"
+                 "{\"t\":1,\"v\":22},"
+                 "{\"bt\":1002,\"v\":23}]");
+}
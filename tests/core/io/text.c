@@ -114,13 +114,14 @@ AVS_UNIT_TEST(text_out, f64) {
     TEST_DOUBLE(1);
     TEST_DOUBLE(1.2);
     TEST_DOUBLE(1.3125);
-#ifdef AVS_COMMONS_WITHOUT_FLOAT_FORMAT_SPECIFIERS
-    // NOTE: This variant of AVS_DOUBLE_AS_STRING() is slightly inaccurate in
-    // order to keep the implementation simpler. This level of inaccuracy is
-    // unlikely to cause problems in real-world applications.
-    TEST_DOUBLE_IMPL(4.2229999965160742e+37, "4.2229999965160736e+37");
-#else  // AVS_COMMONS_WITHOUT_FLOAT_FORMAT_SPECIFIERS
-    TEST_DOUBLE(4.2229999965160742e+37);
+    TEST_DOUBLE(0.1);
+    TEST_DOUBLE(-273.15);
+#ifndef AVS_COMMONS_WITHOUT_FLOAT_FORMAT_SPECIFIERS
+    // NOTE: The AVS_COMMONS_WITHOUT_FLOAT_FORMAT_SPECIFIERS variant of
+    // AVS_DOUBLE_AS_STRING() is slightly inaccurate in order to keep the
+    // implementation simpler, so the number of digits necessary for a round
+    // trip may differ there.
+    TEST_DOUBLE(4.222999996516074e+37);
 #endif // AVS_COMMONS_WITHOUT_FLOAT_FORMAT_SPECIFIERS
     TEST_DOUBLE(10000.5);
     TEST_DOUBLE(10000000000000.5);
@@ -177,6 +178,34 @@ AVS_UNIT_TEST(text_out, unimplemented) {
                                    &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 0, 1)));
 }
 
+static void fill_test_bytes(uint8_t *data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = (uint8_t) (i * 7);
+    }
+}
+
+AVS_UNIT_TEST(text_out, bytes_in_odd_chunks) {
+    TEST_ENV(1024);
+    uint8_t data[500];
+    fill_test_bytes(data, sizeof(data));
+    char expected[sizeof(buf)];
+    AVS_UNIT_ASSERT_SUCCESS(avs_base64_encode(expected, sizeof(expected),
+                                              data, sizeof(data)));
+
+    anjay_unlocked_ret_bytes_ctx_t *bytes = _anjay_ret_bytes_begin_unlocked(
+            (anjay_unlocked_output_ctx_t *) &out, sizeof(data));
+    AVS_UNIT_ASSERT_NOT_NULL(bytes);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_bytes_append_unlocked(bytes, data, 1));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_ret_bytes_append_unlocked(bytes, data + 1, 250));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_ret_bytes_append_unlocked(bytes, data + 251, 249));
+    AVS_UNIT_ASSERT_SUCCESS(
+            text_ret_close((anjay_unlocked_output_ctx_t *) &out));
+    stringify_buf(&outbuf);
+    AVS_UNIT_ASSERT_EQUAL_STRING(buf, expected);
+}
+
 #undef TEST_ENV
 
 /////////////////////////////////////////////////////////////////////// DECODING
@@ -345,6 +374,39 @@ AVS_UNIT_TEST(text_in, objlnk) {
     TEST_OBJLNK_FAIL("wat:0");
 }
 
+AVS_UNIT_TEST(text_in, bytes) {
+    uint8_t data[500];
+    fill_test_bytes(data, sizeof(data));
+    char encoded[1024];
+    AVS_UNIT_ASSERT_SUCCESS(avs_base64_encode(encoded, sizeof(encoded), data,
+                                              sizeof(data)));
+
+    // output buffers shorter than a single group, ones that cannot hold a
+    // whole number of groups, and ones longer than a single decoded chunk
+    static const size_t READ_SIZES[] = { 1, 2, 4, 200, 293 };
+    avs_stream_inbuf_t stream = AVS_STREAM_INBUF_STATIC_INITIALIZER;
+    avs_stream_inbuf_set_buffer(&stream, encoded, strlen(encoded));
+    anjay_unlocked_input_ctx_t *in;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_input_text_create(&in, (avs_stream_t *) &stream, NULL));
+
+    uint8_t decoded[2 * sizeof(data)];
+    size_t decoded_size = 0;
+    bool message_finished = false;
+    for (size_t i = 0; !message_finished; ++i) {
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_TRUE(decoded_size <= sizeof(data));
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_get_bytes_unlocked(
+                in, &bytes_read, &message_finished, decoded + decoded_size,
+                READ_SIZES[i % AVS_ARRAY_SIZE(READ_SIZES)]));
+        decoded_size += bytes_read;
+    }
+    AVS_UNIT_ASSERT_EQUAL(decoded_size, sizeof(data));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(decoded, data, sizeof(data));
+
+    TEST_TEARDOWN;
+}
+
 #undef TEST_OBJLNK_FAIL
 #undef TEST_OBJLNK
 #undef TEST_OBJLNK_COMMON
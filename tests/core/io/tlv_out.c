@@ -319,6 +319,40 @@ AVS_UNIT_TEST(tlv_out_array, array_index) {
     AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
 }
 
+AVS_UNIT_TEST(tlv_out_array, multiple_instances) {
+    TEST_ENV(512, &MAKE_OBJECT_PATH(0));
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_path(
+            out, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 1, 0)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_i64_unlocked(out, 5));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_path(
+            out, &MAKE_RESOURCE_INSTANCE_PATH(0, 0, 1, 1)));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_i64_unlocked(out, 6));
+
+    // buffers of finished aggregates are reused
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_set_path(
+            out, &MAKE_RESOURCE_INSTANCE_PATH(0, 1, 1, 2)));
+    AVS_UNIT_ASSERT_EQUAL(
+            ((tlv_out_t *) out)->levels[TLV_OUT_LEVEL_RID].buffer_size, 0);
+    AVS_UNIT_ASSERT_EQUAL(
+            ((tlv_out_t *) out)->levels[TLV_OUT_LEVEL_RIID].buffer_size, 0);
+    AVS_UNIT_ASSERT_TRUE(
+            ((tlv_out_t *) out)->levels[TLV_OUT_LEVEL_RIID].buffer_capacity
+            > 0);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_ret_i64_unlocked(out, 7));
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_output_ctx_destroy(&out));
+
+    VERIFY_BYTES("\x08\x00\x08" // instance 0
+                 "\x86\x01"     // array
+                 "\x41\x00\x05" // first entry
+                 "\x41\x01\x06" // second entry
+                 "\x05\x01"     // instance 1
+                 "\x83\x01"     // array
+                 "\x41\x02\x07" // entry
+    );
+}
+
 AVS_UNIT_TEST(tlv_out, object_with_empty_bytes) {
     TEST_ENV(512, &MAKE_OBJECT_PATH(0));
 
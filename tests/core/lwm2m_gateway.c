@@ -0,0 +1,245 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <anjay/lwm2m_gateway.h>
+#ifdef ANJAY_WITH_MODULE_ACCESS_CONTROL
+#    include <anjay/access_control.h>
+#endif // ANJAY_WITH_MODULE_ACCESS_CONTROL
+
+#include <avsystem/commons/avs_unit_mocksock.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/anjay_core.h"
+#include "src/core/servers/anjay_servers_internal.h"
+#include "tests/core/coap/utils.h"
+#include "tests/utils/dm.h"
+
+/**
+ * Object of the End Device, with the same OID as the root data model OBJ, so
+ * that requests misrouted to the latter fail on unexpected mock calls.
+ */
+static const anjay_dm_object_def_t *const END_DEVICE_OBJ =
+        &(const anjay_dm_object_def_t) {
+            .oid = 42,
+            .handlers = { ANJAY_MOCK_DM_HANDLERS }
+        };
+
+static const anjay_mock_dm_res_entry_t END_DEVICE_RESOURCES[] = {
+    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+    { 2, ANJAY_DM_RES_E, ANJAY_DM_RES_PRESENT },
+    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+    ANJAY_MOCK_DM_RES_END
+};
+
+static void gateway_test_setup(anjay_t *anjay_locked) {
+    AVS_UNIT_ASSERT_SUCCESS(anjay_lwm2m_gateway_install(anjay_locked));
+    anjay_iid_t iid = 0;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_lwm2m_gateway_register_device(
+            anjay_locked, "urn:dev:os:end-device", &iid));
+    AVS_UNIT_ASSERT_EQUAL(iid, 0);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_lwm2m_gateway_register_object(
+            anjay_locked, iid, &END_DEVICE_OBJ));
+
+    // prevent sending Update, as that will fail in the test environment
+    _anjay_test_dm_unsched_notify_clb(anjay_locked);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_server_info_t) server;
+    AVS_LIST_FOREACH(server, anjay->servers) {
+        avs_sched_del(&server->next_action_handle);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    anjay_sched_run(anjay_locked);
+}
+
+#define GATEWAY_TEST_INIT \
+    DM_TEST_INIT;         \
+    gateway_test_setup(anjay)
+
+static void expect_end_device_instance(anjay_t *anjay, anjay_iid_t iid) {
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &END_DEVICE_OBJ, 0,
+            (const anjay_iid_t[]) { iid, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(anjay, &END_DEVICE_OBJ, iid, 0,
+                                         END_DEVICE_RESOURCES);
+}
+
+AVS_UNIT_TEST(lwm2m_gateway, read) {
+    GATEWAY_TEST_INIT;
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E),
+                    PATH("dev0", "42", "69", "4"), NO_PAYLOAD);
+    expect_end_device_instance(anjay, 69);
+    _anjay_mock_dm_expect_resource_read(anjay, &END_DEVICE_OBJ, 69, 4,
+                                        ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 514));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(lwm2m_gateway, write) {
+    GATEWAY_TEST_INIT;
+    DM_TEST_REQUEST(mocksocks[0], CON, PUT, ID(0xFA3E),
+                    PATH("dev0", "42", "514", "4"), CONTENT_FORMAT(PLAINTEXT),
+                    PAYLOAD("Hello"));
+    expect_end_device_instance(anjay, 514);
+    _anjay_mock_dm_expect_resource_write(anjay, &END_DEVICE_OBJ, 514, 4,
+                                         ANJAY_ID_INVALID,
+                                         ANJAY_MOCK_DM_STRING(0, "Hello"), 0);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CHANGED, ID(0xFA3E), NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(lwm2m_gateway, execute) {
+    GATEWAY_TEST_INIT;
+    DM_TEST_REQUEST(mocksocks[0], CON, POST, ID(0xFA3E),
+                    PATH("dev0", "42", "514", "2"));
+    expect_end_device_instance(anjay, 514);
+    _anjay_mock_dm_expect_resource_execute(anjay, &END_DEVICE_OBJ, 514, 2,
+                                           NULL, 0);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CHANGED, ID(0xFA3E), NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(lwm2m_gateway, unsupported_operations) {
+    GATEWAY_TEST_INIT;
+    // Delete
+    DM_TEST_REQUEST(mocksocks[0], CON, DELETE, ID(0xFA3E),
+                    PATH("dev0", "42", "514"), NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, METHOD_NOT_ALLOWED, ID(0xFA3E),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    // Create
+    DM_TEST_REQUEST(mocksocks[0], CON, POST, ID(0xFA3F), PATH("dev0", "42"),
+                    NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, METHOD_NOT_ALLOWED, ID(0xFA3F),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    // Observe
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0xFA40, "Obs"),
+                    OBSERVE(0), PATH("dev0", "42", "69", "4"), NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, METHOD_NOT_ALLOWED,
+                            ID_TOKEN(0xFA40, "Obs"), NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(lwm2m_gateway, unknown_prefix) {
+    GATEWAY_TEST_INIT;
+    // no such End Device
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E),
+                    PATH("dev7", "42", "69", "4"), NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, NOT_FOUND, ID(0xFA3E),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    // not a prefix that the LwM2M Gateway assigns
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3F),
+                    PATH("foo", "42", "69", "4"), NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, NOT_FOUND, ID(0xFA3F),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    // Object not registered for the End Device, even though it is registered
+    // in the root data model
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA40),
+                    PATH("dev0", "25", "0"), NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, NOT_FOUND, ID(0xFA40),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(lwm2m_gateway, prefix_without_oid) {
+    GATEWAY_TEST_INIT;
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E), PATH("dev0"),
+                    NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, METHOD_NOT_ALLOWED, ID(0xFA3E),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(lwm2m_gateway, bootstrap_rejected) {
+    DM_TEST_INIT_WITH_SSIDS(ANJAY_SSID_BOOTSTRAP);
+    gateway_test_setup(anjay);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E),
+                    PATH("dev0", "42", "69", "4"), NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, NOT_FOUND, ID(0xFA3E),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    DM_TEST_FINISH;
+}
+
+#if defined(ANJAY_WITH_ACCESS_CONTROL) \
+        && defined(ANJAY_WITH_MODULE_ACCESS_CONTROL)
+AVS_UNIT_TEST(lwm2m_gateway, access_checked_against_gateway_instance) {
+    const anjay_dm_object_def_t *const *obj_defs[] = { &FAKE_SECURITY,
+                                                       &FAKE_SERVER, &OBJ };
+    anjay_ssid_t ssids[] = { 1, 2 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids, DM_TEST_CONFIGURATION());
+    AVS_UNIT_ASSERT_SUCCESS(anjay_access_control_install(anjay));
+    gateway_test_setup(anjay);
+
+    // /25/0 is owned by SSID 2, so SSID 1 has no access to the End Device
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &FAKE_SERVER, 0,
+            (const anjay_iid_t[]) { 0, 1, ANJAY_ID_INVALID });
+    for (anjay_iid_t iid = 0; iid < 2; ++iid) {
+        _anjay_mock_dm_expect_list_resources(
+                anjay, &FAKE_SERVER, iid, 0,
+                (const anjay_mock_dm_res_entry_t[]) {
+                        { ANJAY_DM_RID_SERVER_SSID, ANJAY_DM_RES_R,
+                          ANJAY_DM_RES_PRESENT },
+                        ANJAY_MOCK_DM_RES_END });
+        _anjay_mock_dm_expect_resource_read(
+                anjay, &FAKE_SERVER, iid, ANJAY_DM_RID_SERVER_SSID,
+                ANJAY_ID_INVALID, 0, ANJAY_MOCK_DM_INT(0, iid + 1));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(anjay_access_control_set_owner(
+            anjay, ANJAY_DM_OID_LWM2M_GATEWAY, 0, 2, NULL));
+
+    // the End Device Object itself is not accessed at all
+    DM_TEST_REQUEST(mocksocks[0], CON, PUT, ID(0xFA3E),
+                    PATH("dev0", "42", "514", "4"), CONTENT_FORMAT(PLAINTEXT),
+                    PAYLOAD("Hello"));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, UNAUTHORIZED, ID(0xFA3E),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    DM_TEST_REQUEST(mocksocks[1], CON, PUT, ID(0xFA3F),
+                    PATH("dev0", "42", "514", "4"), CONTENT_FORMAT(PLAINTEXT),
+                    PAYLOAD("Hello"));
+    expect_end_device_instance(anjay, 514);
+    _anjay_mock_dm_expect_resource_write(anjay, &END_DEVICE_OBJ, 514, 4,
+                                         ANJAY_ID_INVALID,
+                                         ANJAY_MOCK_DM_STRING(0, "Hello"), 0);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[1], ACK, CHANGED, ID(0xFA3F), NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[1], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[1]));
+    DM_TEST_FINISH;
+}
+#endif // defined(ANJAY_WITH_ACCESS_CONTROL) &&
+       // defined(ANJAY_WITH_MODULE_ACCESS_CONTROL)
@@ -18,6 +18,7 @@
 #include <avsystem/coap/async.h>
 
 #include <inttypes.h>
+#include <string.h>
 
 #include "src/core/anjay_core.h"
 #include "src/core/coap/anjay_content_format.h"
@@ -514,6 +515,286 @@ AVS_UNIT_TEST(anjay_send, continue) {
     DM_TEST_FINISH;
 }
 
+AVS_UNIT_TEST(anjay_send, coalescing) {
+    DM_TEST_INIT_WITH_CONFIG(.send_coalescing_window =
+                                     avs_time_duration_from_scalar(
+                                             5, AVS_TIME_S));
+    static const uint16_t OTHER_VALUE = 0xBEEF;
+
+    anjay_send_batch_t *batch = get_new_batch_with_int_value(URI_PATH, VALUE);
+    anjay_send_batch_t *other_batch =
+            get_new_batch_with_int_value(URI_PATH, OTHER_VALUE);
+    // nothing is sent until the coalescing window expires
+    test_call_anjay_send(anjay, SSID, batch,
+                         send_finished_handler_result_validator,
+                         (void *) (intptr_t) ANJAY_SEND_SUCCESS);
+    test_call_anjay_send(anjay, SSID, other_batch,
+                         send_finished_handler_result_validator,
+                         (void *) (intptr_t) ANJAY_SEND_SUCCESS);
+    anjay_send_batch_release(&batch);
+    anjay_send_batch_release(&other_batch);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(HANDLER_WRAPPER_ARGS), 2);
+
+    // both values are sent in one message; the second record reuses the
+    // basename of the first one
+    expected_payload_t expected_payload =
+            get_expected_payload_for_batch_with_int_value(URI_PATH, VALUE, NAN);
+    expected_payload.payload[0] = '\x82';
+    uint16_t converted_value = avs_convert_be16(OTHER_VALUE);
+    char *record = &expected_payload.payload[expected_payload.payload_size];
+    record[0] = '\xA1';
+    record[1] = SENML_LABEL_VALUE;
+    record[2] = CBOR_EXT_LENGTH_2BYTE;
+    memcpy(&record[3], &converted_value, sizeof(converted_value));
+    expected_payload.payload_size += 3 + sizeof(converted_value);
+
+    assert_there_is_server_with_ssid(SSID, anjay);
+    assert_mute_send_resource_equals(false, anjay, SSID);
+    test_expect_scheduled_lwm2m_send_request(mocksocks[0], MSG_ID, nth_token(0),
+                                             expected_payload);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    anjay_sched_run(anjay);
+
+    // finished handlers are called for each of the batches
+    const coap_test_msg_t *response =
+            COAP_MSG(ACK, CHANGED, ID_TOKEN_RAW(MSG_ID, nth_token(0)),
+                     NO_PAYLOAD);
+    avs_unit_mocksock_input(mocksocks[0], response->content, response->length);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    avs_coap_async_handle_incoming_packet(
+            _anjay_connection_get(&anjay_unlocked->servers->connections,
+                                  ANJAY_CONNECTION_PRIMARY)
+                    ->coap_ctx,
+            NULL, NULL);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_NULL(HANDLER_WRAPPER_ARGS);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(anjay_send, coalescing_payload_size_limit) {
+    DM_TEST_INIT_WITH_CONFIG(.send_coalescing_window =
+                                     avs_time_duration_from_scalar(
+                                             5, AVS_TIME_S),
+                             .send_coalescing_max_payload_size = 1);
+
+    // the batch alone exceeds the limit, so it is sent without waiting for
+    // the coalescing window to expire
+    anjay_send_batch_t *batch = get_new_batch_with_int_value(URI_PATH, VALUE);
+    assert_there_is_server_with_ssid(SSID, anjay);
+    assert_mute_send_resource_equals(false, anjay, SSID);
+    test_expect_scheduled_lwm2m_send_request(
+            mocksocks[0], MSG_ID, nth_token(0),
+            get_expected_payload_for_batch_with_int_value(URI_PATH, VALUE,
+                                                          NAN));
+    test_call_anjay_send(anjay, SSID, batch,
+                         send_finished_handler_result_validator,
+                         (void *) (intptr_t) ANJAY_SEND_SUCCESS);
+    anjay_send_batch_release(&batch);
+    test_handle_lwm2m_send_response(anjay, mocksocks[0],
+                                    COAP_MSG(ACK, CHANGED,
+                                             ID_TOKEN_RAW(MSG_ID, nth_token(0)),
+                                             NO_PAYLOAD));
+
+    DM_TEST_FINISH;
+}
+
+static void test_watermark_handler(anjay_t *anjay,
+                                   size_t queued_count,
+                                   void *call_count_) {
+    (void) anjay;
+    AVS_UNIT_ASSERT_EQUAL(queued_count, 0);
+    ++*(int *) call_count_;
+}
+
+AVS_UNIT_TEST(anjay_send, queue_stats) {
+    DM_TEST_INIT_WITH_CONFIG(.send_coalescing_window =
+                                     avs_time_duration_from_scalar(
+                                             5, AVS_TIME_S));
+    int watermark_calls = 0;
+    AVS_UNIT_ASSERT_FAILED(anjay_send_queue_set_low_watermark(
+            anjay, 0, test_watermark_handler, &watermark_calls));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_queue_set_low_watermark(
+            anjay, 2, test_watermark_handler, &watermark_calls));
+
+    anjay_send_batch_t *batch = get_new_batch_with_int_value(URI_PATH, VALUE);
+    test_call_anjay_send(anjay, SSID, batch,
+                         send_finished_handler_result_validator,
+                         (void *) (intptr_t) ANJAY_SEND_SUCCESS);
+    test_call_anjay_send(anjay, SSID, batch,
+                         send_finished_handler_result_validator,
+                         (void *) (intptr_t) ANJAY_SEND_SUCCESS);
+    anjay_send_batch_release(&batch);
+
+    anjay_send_queue_stats_t stats;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_queue_stats(anjay, ANJAY_SSID_ANY,
+                                                   &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.in_flight_count, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.deferred_count, 2);
+    AVS_UNIT_ASSERT_TRUE(stats.estimated_payload_size > 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.server_state, ANJAY_SEND_ERR_SSID);
+
+    // both requests are sent in one message
+    expected_payload_t expected_payload =
+            get_expected_payload_for_batch_with_int_value(URI_PATH, VALUE, NAN);
+    expected_payload.payload[0] = '\x82';
+    uint16_t converted_value = avs_convert_be16(VALUE);
+    char *record = &expected_payload.payload[expected_payload.payload_size];
+    record[0] = '\xA1';
+    record[1] = SENML_LABEL_VALUE;
+    record[2] = CBOR_EXT_LENGTH_2BYTE;
+    memcpy(&record[3], &converted_value, sizeof(converted_value));
+    expected_payload.payload_size += 3 + sizeof(converted_value);
+    assert_there_is_server_with_ssid(SSID, anjay);
+    assert_mute_send_resource_equals(false, anjay, SSID);
+    test_expect_scheduled_lwm2m_send_request(mocksocks[0], MSG_ID, nth_token(0),
+                                             expected_payload);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    anjay_sched_run(anjay);
+
+    assert_there_is_server_with_ssid(SSID, anjay);
+    assert_mute_send_resource_equals(false, anjay, SSID);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_queue_stats(anjay, SSID, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.in_flight_count, 2);
+    AVS_UNIT_ASSERT_EQUAL(stats.deferred_count, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.server_state, ANJAY_SEND_OK);
+
+    // the watermark handler is called once the queue is drained
+    const coap_test_msg_t *response =
+            COAP_MSG(ACK, CHANGED, ID_TOKEN_RAW(MSG_ID, nth_token(0)),
+                     NO_PAYLOAD);
+    avs_unit_mocksock_input(mocksocks[0], response->content, response->length);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    avs_coap_async_handle_incoming_packet(
+            _anjay_connection_get(&anjay_unlocked->servers->connections,
+                                  ANJAY_CONNECTION_PRIMARY)
+                    ->coap_ctx,
+            NULL, NULL);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_NULL(HANDLER_WRAPPER_ARGS);
+    AVS_UNIT_ASSERT_EQUAL(watermark_calls, 0);
+    anjay_sched_run(anjay);
+    AVS_UNIT_ASSERT_EQUAL(watermark_calls, 1);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(anjay_send, priorities_and_rate_limit) {
+    // the burst size is smaller than any message, so after sending one, the
+    // next non-urgent one needs to wait
+    DM_TEST_INIT_WITH_CONFIG(.send_rate_limit = 1000,
+                             .send_rate_limit_burst = 1);
+    const expected_payload_t expected_payload =
+            get_expected_payload_for_batch_with_int_value(URI_PATH, VALUE, NAN);
+    anjay_send_batch_t *batch = get_new_batch_with_int_value(URI_PATH, VALUE);
+
+    // the bucket is full, so the first request is sent right away
+    assert_there_is_server_with_ssid(SSID, anjay);
+    assert_mute_send_resource_equals(false, anjay, SSID);
+    test_expect_scheduled_lwm2m_send_request(mocksocks[0], MSG_ID, nth_token(0),
+                                             expected_payload);
+    test_call_anjay_send(anjay, SSID, batch,
+                         send_finished_handler_result_validator,
+                         (void *) (intptr_t) ANJAY_SEND_SUCCESS);
+    test_handle_lwm2m_send_response(anjay, mocksocks[0],
+                                    COAP_MSG(ACK, CHANGED,
+                                             ID_TOKEN_RAW(MSG_ID, nth_token(0)),
+                                             NO_PAYLOAD));
+
+    // the second one is held back by the rate limiter
+    assert_there_is_server_with_ssid(SSID, anjay);
+    assert_mute_send_resource_equals(false, anjay, SSID);
+    test_call_anjay_send(anjay, SSID, batch,
+                         send_finished_handler_result_validator,
+                         (void *) (intptr_t) ANJAY_SEND_SUCCESS);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->sender.entries), 1);
+    AVS_UNIT_ASSERT_NULL(
+            anjay_unlocked->sender.entries->exchange_status.memstream);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    // urgent request is not held back
+    assert_there_is_server_with_ssid(SSID, anjay);
+    assert_mute_send_resource_equals(false, anjay, SSID);
+    test_expect_scheduled_lwm2m_send_request(mocksocks[0],
+                                             (uint16_t) (MSG_ID + 1),
+                                             nth_token(1), expected_payload);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_with_priority(
+            anjay, SSID, batch, ANJAY_SEND_PRIORITY_URGENT, false, NULL,
+            NULL));
+    const coap_test_msg_t *response =
+            COAP_MSG(ACK, CHANGED, ID_TOKEN_RAW(MSG_ID + 1, nth_token(1)),
+                     NO_PAYLOAD);
+    avs_unit_mocksock_input(mocksocks[0], response->content, response->length);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    avs_coap_async_handle_incoming_packet(
+            _anjay_connection_get(&anjay_unlocked->servers->connections,
+                                  ANJAY_CONNECTION_PRIMARY)
+                    ->coap_ctx,
+            NULL, NULL);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    // the held request is sent once enough tokens are accumulated
+    assert_there_is_server_with_ssid(SSID, anjay);
+    assert_mute_send_resource_equals(false, anjay, SSID);
+    test_expect_scheduled_lwm2m_send_request(mocksocks[0],
+                                             (uint16_t) (MSG_ID + 2),
+                                             nth_token(2), expected_payload);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+    anjay_sched_run(anjay);
+    test_handle_lwm2m_send_response(
+            anjay, mocksocks[0],
+            COAP_MSG(ACK, CHANGED, ID_TOKEN_RAW(MSG_ID + 2, nth_token(2)),
+                     NO_PAYLOAD));
+    AVS_UNIT_ASSERT_NULL(HANDLER_WRAPPER_ARGS);
+
+    anjay_send_batch_release(&batch);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(anjay_send, to_servers) {
+    DM_TEST_INIT;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_unlocked->servers->registration_info.lwm2m_version =
+            ANJAY_LWM2M_VERSION_1_1;
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    AVS_LIST(test_finished_handler_arg_t) wrapper_arg =
+            AVS_LIST_NEW_ELEMENT(test_finished_handler_arg_t);
+    AVS_UNIT_ASSERT_NOT_NULL(wrapper_arg);
+    wrapper_arg->real_handler = send_finished_handler_result_validator;
+    wrapper_arg->real_handler_data = (void *) (intptr_t) ANJAY_SEND_SUCCESS;
+    AVS_LIST_INSERT(&HANDLER_WRAPPER_ARGS, wrapper_arg);
+
+    // payload serialized in advance is the same as the one streamed
+    anjay_send_batch_t *batch = get_new_batch_with_int_value(URI_PATH, VALUE);
+    test_expect_scheduled_lwm2m_send_request(
+            mocksocks[0], MSG_ID, nth_token(0),
+            get_expected_payload_for_batch_with_int_value(URI_PATH, VALUE,
+                                                          NAN));
+    assert_there_is_server_with_ssid(SSID, anjay);
+    assert_mute_send_resource_equals(false, anjay, SSID);
+    assert_there_is_not_any_server(anjay);
+    // failure for one server does not prevent sending to the other one
+    AVS_UNIT_ASSERT_EQUAL(
+            anjay_send_to_servers(anjay, (const anjay_ssid_t[]) { SSID, 1234 },
+                                  2, batch, false,
+                                  test_finished_handler_wrapper, wrapper_arg),
+            ANJAY_SEND_ERR_SSID);
+    anjay_send_batch_release(&batch);
+    anjay_sched_run(anjay);
+
+    test_handle_lwm2m_send_response(anjay, mocksocks[0],
+                                    COAP_MSG(ACK, CHANGED,
+                                             ID_TOKEN_RAW(MSG_ID, nth_token(0)),
+                                             NO_PAYLOAD));
+
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(anjay_send, resource_from_dm) {
     DM_TEST_INIT;
 
@@ -581,6 +862,83 @@ AVS_UNIT_TEST(anjay_send, offline_mode) {
     DM_TEST_FINISH;
 }
 
+#ifdef ANJAY_WITH_SEND_PERSISTENCE
+typedef struct {
+    char data[512];
+    size_t size;
+} test_send_log_t;
+
+static int test_send_log_append(void *arg, const void *data, size_t length) {
+    test_send_log_t *log = (test_send_log_t *) arg;
+    AVS_UNIT_ASSERT_TRUE(length <= sizeof(log->data) - log->size);
+    memcpy(log->data + log->size, data, length);
+    log->size += length;
+    return 0;
+}
+
+static int test_send_log_read(void *arg,
+                              size_t offset,
+                              void *buf,
+                              size_t length,
+                              size_t *out_bytes_read) {
+    test_send_log_t *log = (test_send_log_t *) arg;
+    *out_bytes_read = offset < log->size ? AVS_MIN(length, log->size - offset)
+                                         : 0;
+    memcpy(buf, log->data + offset, *out_bytes_read);
+    return 0;
+}
+
+static int test_send_log_discard(void *arg, size_t length) {
+    test_send_log_t *log = (test_send_log_t *) arg;
+    memmove(log->data, log->data + length, log->size - length);
+    log->size -= length;
+    return 0;
+}
+
+static const anjay_send_log_handlers_t TEST_SEND_LOG_HANDLERS = {
+    .append = test_send_log_append,
+    .read = test_send_log_read,
+    .discard = test_send_log_discard
+};
+
+AVS_UNIT_TEST(anjay_send, persistent_queue) {
+    DM_TEST_INIT;
+    test_send_log_t log = { 0 };
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_persistent_queue_install(
+            anjay, &TEST_SEND_LOG_HANDLERS, &log, 0));
+    AVS_UNIT_ASSERT_FAILED(anjay_send_persistent_queue_install(
+            anjay, &TEST_SEND_LOG_HANDLERS, &log, 0));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_unlocked->servers->registration_info.lwm2m_version =
+            ANJAY_LWM2M_VERSION_1_1;
+    avs_unit_mocksock_expect_shutdown(mocksocks[0]);
+    avs_net_socket_shutdown(mocksocks[0]);
+    avs_net_socket_close(mocksocks[0]);
+    anjay_unlocked->online_transports.udp = false;
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    anjay_send_batch_t *batch = get_new_batch_with_int_value(URI_PATH, VALUE);
+    assert_there_is_server_with_ssid(SSID, anjay);
+    assert_mute_send_resource_equals(false, anjay, SSID);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_send_deferrable(anjay, SSID, batch, NULL, NULL));
+    anjay_send_batch_release(&batch);
+
+    // the batch is stored in the log only, as no RAM is allowed for it
+    AVS_UNIT_ASSERT_TRUE(log.size > 0);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->sender.ram_size, 0);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->sender.entries), 1);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    const size_t log_size = log.size;
+    DM_TEST_FINISH;
+    // deferred request is kept for the next run
+    AVS_UNIT_ASSERT_EQUAL(log.size, log_size);
+}
+#endif // ANJAY_WITH_SEND_PERSISTENCE
+
 AVS_UNIT_TEST(anjay_send, ssid_any) {
     DM_TEST_INIT;
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
@@ -707,8 +1065,49 @@ AVS_UNIT_TEST(anjay_send, add_multiple_successful) {
 
     AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_data_add_current_multiple(
             builder, anjay, paths, AVS_ARRAY_SIZE(paths)));
-    AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 2);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(
+                                  (anjay_batch_builder_t *) builder),
+                          2);
+    anjay_send_batch_builder_cleanup(&builder);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(anjay_send, add_current_range) {
+    DM_TEST_INIT;
+    anjay_send_batch_builder_t *builder = anjay_send_batch_builder_new();
+    AVS_UNIT_ASSERT_NOT_NULL(builder);
+
+    const anjay_mock_dm_res_entry_t resources_2[] = {
+        { 1, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT },
+        { 2, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT },
+        ANJAY_MOCK_DM_RES_END
+    };
+    const anjay_mock_dm_res_entry_t resources_3[] = {
+        { 1, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT },
+        { 2, ANJAY_DM_RES_R, ANJAY_DM_RES_ABSENT },
+        ANJAY_MOCK_DM_RES_END
+    };
+    // Instances are listed only once for the whole range
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0,
+            (const anjay_iid_t[]) { 1, 2, 3, 4, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(anjay, &OBJ, 2, 0, resources_2);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 2, 1, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 23));
+    _anjay_mock_dm_expect_list_resources(anjay, &OBJ, 2, 0, resources_2);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 2, 2, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 45));
+    _anjay_mock_dm_expect_list_resources(anjay, &OBJ, 3, 0, resources_3);
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 3, 1, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 67));
+    // absent Resource is skipped
+    _anjay_mock_dm_expect_list_resources(anjay, &OBJ, 3, 0, resources_3);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_data_add_current_range(
+            builder, anjay, 42, 2, 3, (const anjay_rid_t[]) { 1, 2 }, 2));
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(
+                                  (anjay_batch_builder_t *) builder),
+                          3);
     anjay_send_batch_builder_cleanup(&builder);
     DM_TEST_FINISH;
 }
@@ -718,7 +1117,7 @@ AVS_UNIT_TEST(anjay_send, add_multiple_single_resource_fail) {
     anjay_send_batch_builder_t *builder = anjay_send_batch_builder_new();
     AVS_UNIT_ASSERT_NOT_NULL(builder);
 
-    AVS_LIST(anjay_batch_entry_t) *initial_append_ptr =
+    anjay_batch_entry_t **initial_append_ptr =
             ((anjay_batch_builder_t *) builder)->append_ptr;
 
     _anjay_mock_dm_expect_list_instances(
@@ -736,8 +1135,9 @@ AVS_UNIT_TEST(anjay_send, add_multiple_single_resource_fail) {
 
     AVS_UNIT_ASSERT_FAILED(anjay_send_batch_data_add_current_multiple(
             builder, anjay, paths, AVS_ARRAY_SIZE(paths)));
-    AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 0);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(
+                                  (anjay_batch_builder_t *) builder),
+                          0);
     AVS_UNIT_ASSERT_TRUE(initial_append_ptr
                          == ((anjay_batch_builder_t *) builder)->append_ptr);
     AVS_UNIT_ASSERT_NULL(*((anjay_batch_builder_t *) builder)->append_ptr);
@@ -799,13 +1199,14 @@ AVS_UNIT_TEST(anjay_send, add_multiple_twice_with_fail) {
     AVS_UNIT_ASSERT_SUCCESS(anjay_send_batch_data_add_current_multiple(
             builder, anjay, paths, AVS_ARRAY_SIZE(paths)));
 
-    AVS_LIST(anjay_batch_entry_t) *pre_fail_append_ptr =
+    anjay_batch_entry_t **pre_fail_append_ptr =
             ((anjay_batch_builder_t *) builder)->append_ptr;
 
     AVS_UNIT_ASSERT_FAILED(anjay_send_batch_data_add_current_multiple(
             builder, anjay, paths, AVS_ARRAY_SIZE(paths)));
-    AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 2);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(
+                                  (anjay_batch_builder_t *) builder),
+                          2);
     AVS_UNIT_ASSERT_TRUE(pre_fail_append_ptr
                          == ((anjay_batch_builder_t *) builder)->append_ptr);
     AVS_UNIT_ASSERT_NULL(*((anjay_batch_builder_t *) builder)->append_ptr);
@@ -857,8 +1258,9 @@ AVS_UNIT_TEST(anjay_send, add_multiple_ignore_not_found) {
     AVS_UNIT_ASSERT_SUCCESS(
             anjay_send_batch_data_add_current_multiple_ignore_not_found(
                     builder, anjay, paths, AVS_ARRAY_SIZE(paths)));
-    AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(
+                                  (anjay_batch_builder_t *) builder),
+                          1);
 
     _anjay_mock_dm_expect_list_instances(
             anjay, &OBJ, 0, (const anjay_iid_t[]) { 1, ANJAY_ID_INVALID });
@@ -873,8 +1275,9 @@ AVS_UNIT_TEST(anjay_send, add_multiple_ignore_not_found) {
     AVS_UNIT_ASSERT_FAILED(
             anjay_send_batch_data_add_current_multiple_ignore_not_found(
                     builder, anjay, paths, 1));
-    AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(
+                                  (anjay_batch_builder_t *) builder),
+                          1);
 
     // This should not be ignored.
     _anjay_mock_dm_expect_list_instances(
@@ -889,8 +1292,9 @@ AVS_UNIT_TEST(anjay_send, add_multiple_ignore_not_found) {
     AVS_UNIT_ASSERT_FAILED(
             anjay_send_batch_data_add_current_multiple_ignore_not_found(
                     builder, anjay, paths, 1));
-    AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 1);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(
+                                  (anjay_batch_builder_t *) builder),
+                          1);
 
     _anjay_mock_dm_expect_list_instances(
             anjay, &OBJ, 0, (const anjay_iid_t[]) { 1, ANJAY_ID_INVALID });
@@ -903,8 +1307,9 @@ AVS_UNIT_TEST(anjay_send, add_multiple_ignore_not_found) {
                                         ANJAY_MOCK_DM_INT(0, 45));
     AVS_UNIT_ASSERT_SUCCESS(
             anjay_send_batch_data_add_current(builder, anjay, 42, 1, 1));
-    AVS_UNIT_ASSERT_EQUAL(
-            AVS_LIST_SIZE(((anjay_batch_builder_t *) builder)->list), 2);
+    AVS_UNIT_ASSERT_EQUAL(_anjay_batch_builder_entry_count(
+                                  (anjay_batch_builder_t *) builder),
+                          2);
 
     anjay_send_batch_builder_cleanup(&builder);
     DM_TEST_FINISH;
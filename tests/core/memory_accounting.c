@@ -0,0 +1,121 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+static anjay_memory_stats_t get_stats(anjay_memory_tag_t tag) {
+    anjay_memory_stats_t stats;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_memory_stats(tag, &stats));
+    return stats;
+}
+
+AVS_UNIT_TEST(memory_accounting, allocations_follow_scope_tag) {
+    const anjay_memory_stats_t initial = get_stats(ANJAY_MEMORY_TAG_SEND);
+
+    ANJAY_MEMORY_TAG_ENTER(prev_memory_tag, ANJAY_MEMORY_TAG_SEND);
+    void *block = avs_malloc(100);
+    ANJAY_MEMORY_TAG_LEAVE(prev_memory_tag);
+    AVS_UNIT_ASSERT_NOT_NULL(block);
+    AVS_UNIT_ASSERT_TRUE(CURRENT_TAG == ANJAY_MEMORY_TAG_OTHER);
+
+    anjay_memory_stats_t stats = get_stats(ANJAY_MEMORY_TAG_SEND);
+    AVS_UNIT_ASSERT_EQUAL(stats.current_bytes, initial.current_bytes + 100);
+    AVS_UNIT_ASSERT_EQUAL(stats.current_allocations,
+                          initial.current_allocations + 1);
+
+    // reallocation outside of the scope keeps the original tag
+    block = avs_realloc(block, 300);
+    AVS_UNIT_ASSERT_NOT_NULL(block);
+    stats = get_stats(ANJAY_MEMORY_TAG_SEND);
+    AVS_UNIT_ASSERT_EQUAL(stats.current_bytes, initial.current_bytes + 300);
+    AVS_UNIT_ASSERT_TRUE(stats.peak_bytes >= initial.current_bytes + 300);
+
+    avs_free(block);
+    stats = get_stats(ANJAY_MEMORY_TAG_SEND);
+    AVS_UNIT_ASSERT_EQUAL(stats.current_bytes, initial.current_bytes);
+    AVS_UNIT_ASSERT_EQUAL(stats.current_allocations,
+                          initial.current_allocations);
+    AVS_UNIT_ASSERT_EQUAL(stats.total_allocations,
+                          initial.total_allocations + 1);
+
+    anjay_reset_memory_peaks();
+    stats = get_stats(ANJAY_MEMORY_TAG_SEND);
+    AVS_UNIT_ASSERT_EQUAL(stats.peak_bytes, stats.current_bytes);
+}
+
+AVS_UNIT_TEST(memory_accounting, calloc_zeroes_memory) {
+    unsigned char *block = (unsigned char *) avs_calloc(16, 4);
+    AVS_UNIT_ASSERT_NOT_NULL(block);
+    for (size_t i = 0; i < 64; ++i) {
+        AVS_UNIT_ASSERT_EQUAL(block[i], 0);
+    }
+    avs_free(block);
+    AVS_UNIT_ASSERT_NULL(avs_calloc(SIZE_MAX / 2, 4));
+}
+
+AVS_UNIT_TEST(memory_accounting, invalid_tag) {
+    anjay_memory_stats_t stats;
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_get_memory_stats(ANJAY_MEMORY_TAG_LIMIT_, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.current_bytes, 0);
+}
+
+#ifdef ANJAY_WITH_ALLOCATION_PROFILING
+static const anjay_allocation_site_stats_t *
+find_site(const anjay_allocation_site_stats_t *sites,
+          size_t count,
+          const char *name) {
+    for (size_t i = 0; i < count; ++i) {
+        if (sites[i].site && strcmp(sites[i].site, name) == 0) {
+            return &sites[i];
+        }
+    }
+    return NULL;
+}
+
+AVS_UNIT_TEST(memory_accounting, allocations_follow_call_site) {
+    anjay_reset_allocation_sites();
+
+    ANJAY_ALLOCATION_SITE_ENTER(prev_site);
+    void *block = avs_malloc(100);
+    ANJAY_ALLOCATION_SITE_LEAVE(prev_site);
+    AVS_UNIT_ASSERT_NOT_NULL(block);
+    AVS_UNIT_ASSERT_EQUAL(CURRENT_SITE, prev_site);
+
+    // reallocation outside of the scope keeps the original site
+    block = avs_realloc(block, 300);
+    AVS_UNIT_ASSERT_NOT_NULL(block);
+
+    anjay_allocation_site_stats_t sites[MAX_ALLOCATION_SITES];
+    size_t count = anjay_get_allocation_sites(sites, AVS_ARRAY_SIZE(sites));
+    AVS_UNIT_ASSERT_TRUE(count <= AVS_ARRAY_SIZE(sites));
+    const anjay_allocation_site_stats_t *site =
+            find_site(sites, count, __func__);
+    AVS_UNIT_ASSERT_NOT_NULL(site);
+    AVS_UNIT_ASSERT_EQUAL(site->allocations, 1);
+    AVS_UNIT_ASSERT_EQUAL(site->reallocations, 1);
+    AVS_UNIT_ASSERT_EQUAL(site->total_bytes, 300);
+    AVS_UNIT_ASSERT_EQUAL(site->current_bytes, 300);
+
+    avs_free(block);
+    count = anjay_get_allocation_sites(sites, AVS_ARRAY_SIZE(sites));
+    site = find_site(sites, count, __func__);
+    AVS_UNIT_ASSERT_NOT_NULL(site);
+    AVS_UNIT_ASSERT_EQUAL(site->current_bytes, 0);
+
+    anjay_reset_allocation_sites();
+    count = anjay_get_allocation_sites(sites, AVS_ARRAY_SIZE(sites));
+    site = find_site(sites, count, __func__);
+    AVS_UNIT_ASSERT_NOT_NULL(site);
+    AVS_UNIT_ASSERT_EQUAL(site->allocations, 0);
+    AVS_UNIT_ASSERT_EQUAL(site->total_bytes, 0);
+}
+#endif // ANJAY_WITH_ALLOCATION_PROFILING
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <pthread.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+static anjay_t *change_queue_test_anjay_new(size_t queue_size) {
+    const anjay_configuration_t config = {
+        .endpoint_name = "test",
+        .notify_change_queue_size = queue_size
+    };
+    anjay_t *anjay = anjay_new(&config);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    return anjay;
+}
+
+static void change_queue_test_drain(anjay_t *anjay_locked) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    _anjay_notify_change_queue_drain(anjay);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+/**
+ * Counts the changes of Resources of Object @p oid in the regular notify queue
+ * and clears it, so that subsequent laps of the test can check it again.
+ */
+static size_t change_queue_test_take_changes(anjay_t *anjay_locked,
+                                             anjay_oid_t oid,
+                                             bool *out_instances_changed) {
+    size_t count = 0;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_notify_queue_object_entry_t) it;
+    AVS_LIST_FOREACH(it, anjay->scheduled_notify.queue) {
+        if (it->oid == oid) {
+            count = AVS_LIST_SIZE(it->resources_changed);
+            if (out_instances_changed) {
+                *out_instances_changed =
+                        it->instance_set_changes.unknown_change;
+            }
+        }
+    }
+    _anjay_notify_clear_queue(&anjay->scheduled_notify.queue);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return count;
+}
+
+AVS_UNIT_TEST(notify_change_queue, capacity_rounded_up) {
+    anjay_t *anjay = change_queue_test_anjay_new(5);
+    AVS_UNIT_ASSERT_EQUAL(anjay->atomic_fields.notify_change_queue.mask, 7);
+    anjay_delete(anjay);
+}
+
+AVS_UNIT_TEST(notify_change_queue, wraparound) {
+    anjay_t *anjay = change_queue_test_anjay_new(4);
+    anjay_notify_change_queue_t *queue =
+            &anjay->atomic_fields.notify_change_queue;
+    for (anjay_rid_t lap = 0; lap < 3; ++lap) {
+        for (anjay_iid_t iid = 0; iid < 4; ++iid) {
+            AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, iid, lap));
+        }
+        AVS_UNIT_ASSERT_TRUE(_anjay_notify_change_queue_pending(anjay));
+        // all changes have been put into the lock-free queue
+        AVS_UNIT_ASSERT_EQUAL(change_queue_test_take_changes(anjay, 42, NULL),
+                              0);
+        AVS_UNIT_ASSERT_EQUAL(atomic_load(&queue->enqueue_pos), 4 * lap + 4);
+
+        change_queue_test_drain(anjay);
+        AVS_UNIT_ASSERT_FALSE(_anjay_notify_change_queue_pending(anjay));
+        AVS_UNIT_ASSERT_EQUAL(atomic_load(&queue->dequeue_pos), 4 * lap + 4);
+        AVS_UNIT_ASSERT_EQUAL(change_queue_test_take_changes(anjay, 42, NULL),
+                              4);
+    }
+    anjay_delete(anjay);
+}
+
+AVS_UNIT_TEST(notify_change_queue, full_queue_falls_back_to_locking) {
+    anjay_t *anjay = change_queue_test_anjay_new(2);
+    anjay_notify_change_queue_t *queue =
+            &anjay->atomic_fields.notify_change_queue;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 0, 0));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 0, 1));
+    // the queue is full, so this one is queued directly
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 43, 0, 2));
+    AVS_UNIT_ASSERT_EQUAL(atomic_load(&queue->enqueue_pos), 2);
+    AVS_UNIT_ASSERT_EQUAL(change_queue_test_take_changes(anjay, 43, NULL), 1);
+    AVS_UNIT_ASSERT_TRUE(_anjay_notify_change_queue_pending(anjay));
+
+    change_queue_test_drain(anjay);
+    AVS_UNIT_ASSERT_EQUAL(change_queue_test_take_changes(anjay, 42, NULL), 2);
+
+    // drained entries are reusable
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 0, 3));
+    AVS_UNIT_ASSERT_EQUAL(atomic_load(&queue->enqueue_pos), 3);
+    anjay_delete(anjay);
+}
+
+AVS_UNIT_TEST(notify_change_queue, instances_changed) {
+    anjay_t *anjay = change_queue_test_anjay_new(4);
+    anjay_notify_change_queue_t *queue =
+            &anjay->atomic_fields.notify_change_queue;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_instances_changed(anjay, 42));
+    AVS_UNIT_ASSERT_EQUAL(atomic_load(&queue->enqueue_pos), 1);
+    // ANJAY_ID_INVALID IID is reserved for instances-changed entries, so such
+    // a change is queued directly
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_notify_changed(anjay, 43, ANJAY_ID_INVALID, 1));
+    AVS_UNIT_ASSERT_EQUAL(atomic_load(&queue->enqueue_pos), 1);
+    AVS_UNIT_ASSERT_EQUAL(change_queue_test_take_changes(anjay, 43, NULL), 1);
+
+    change_queue_test_drain(anjay);
+    bool instances_changed = false;
+    AVS_UNIT_ASSERT_EQUAL(
+            change_queue_test_take_changes(anjay, 42, &instances_changed), 0);
+    AVS_UNIT_ASSERT_TRUE(instances_changed);
+    anjay_delete(anjay);
+}
+
+static int fail_notify_changed(anjay_unlocked_t *anjay,
+                               anjay_oid_t oid,
+                               anjay_iid_t iid,
+                               anjay_rid_t rid) {
+    (void) anjay;
+    (void) oid;
+    (void) iid;
+    (void) rid;
+    AVS_UNIT_MOCK(_anjay_notify_changed_unlocked) = NULL;
+    return -1;
+}
+
+AVS_UNIT_TEST(notify_change_queue, failed_change_is_retried) {
+    anjay_t *anjay = change_queue_test_anjay_new(4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 0, 0));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 0, 1));
+
+    AVS_UNIT_MOCK(_anjay_notify_changed_unlocked) = fail_notify_changed;
+    change_queue_test_drain(anjay);
+    // nothing is drained past the failed entry
+    AVS_UNIT_ASSERT_TRUE(_anjay_notify_change_queue_pending(anjay));
+    AVS_UNIT_ASSERT_EQUAL(change_queue_test_take_changes(anjay, 42, NULL), 0);
+
+    change_queue_test_drain(anjay);
+    AVS_UNIT_ASSERT_FALSE(_anjay_notify_change_queue_pending(anjay));
+    AVS_UNIT_ASSERT_EQUAL(change_queue_test_take_changes(anjay, 42, NULL), 2);
+    anjay_delete(anjay);
+}
+
+#ifdef ANJAY_WITH_THREAD_SAFETY
+#    define STRESS_PRODUCERS 4
+#    define STRESS_CHANGES_PER_PRODUCER 1000
+
+typedef struct {
+    anjay_t *anjay;
+    anjay_iid_t iid;
+    atomic_int *producers_left;
+    int result;
+} stress_producer_t;
+
+static void *stress_producer(void *producer_) {
+    stress_producer_t *producer = (stress_producer_t *) producer_;
+    for (anjay_rid_t rid = 0; rid < STRESS_CHANGES_PER_PRODUCER; ++rid) {
+        if (anjay_notify_changed(producer->anjay, 42, producer->iid, rid)) {
+            producer->result = -1;
+        }
+    }
+    atomic_fetch_sub(producer->producers_left, 1);
+    return NULL;
+}
+
+AVS_UNIT_TEST(notify_change_queue, concurrent_producers) {
+    // small enough for the producers to hit the full queue fallback as well
+    anjay_t *anjay = change_queue_test_anjay_new(16);
+    atomic_int producers_left;
+    atomic_init(&producers_left, STRESS_PRODUCERS);
+    stress_producer_t producers[STRESS_PRODUCERS];
+    pthread_t threads[STRESS_PRODUCERS];
+    for (size_t i = 0; i < STRESS_PRODUCERS; ++i) {
+        producers[i] = (stress_producer_t) {
+            .anjay = anjay,
+            .iid = (anjay_iid_t) i,
+            .producers_left = &producers_left
+        };
+        AVS_UNIT_ASSERT_SUCCESS(pthread_create(&threads[i], NULL,
+                                               stress_producer, &producers[i]));
+    }
+    while (atomic_load(&producers_left)
+           || _anjay_notify_change_queue_pending(anjay)) {
+        change_queue_test_drain(anjay);
+    }
+    for (size_t i = 0; i < STRESS_PRODUCERS; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(pthread_join(threads[i], NULL));
+        AVS_UNIT_ASSERT_SUCCESS(producers[i].result);
+    }
+    // every change is reported exactly once, no matter which path it took
+    AVS_UNIT_ASSERT_EQUAL(change_queue_test_take_changes(anjay, 42, NULL),
+                          STRESS_PRODUCERS * STRESS_CHANGES_PER_PRODUCER);
+    anjay_delete(anjay);
+}
+#endif // ANJAY_WITH_THREAD_SAFETY
+
+static void assert_reload_scheduled_after_perform(anjay_t *anjay_locked,
+                                                  anjay_oid_t oid,
+                                                  bool server_notify,
+                                                  bool expect_reload) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    avs_sched_del(&anjay->reload_servers_sched_job_handle);
+    anjay_notify_queue_t queue = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_notify_queue_instance_created(&queue, oid, 1));
+    if (server_notify) {
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_notify_perform(anjay, ANJAY_SSID_BOOTSTRAP, &queue));
+    } else {
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_notify_perform_without_servers(
+                anjay, ANJAY_SSID_BOOTSTRAP, &queue));
+    }
+    AVS_UNIT_ASSERT_EQUAL(!!anjay->reload_servers_sched_job_handle,
+                          expect_reload);
+    _anjay_notify_clear_queue(&queue);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+AVS_UNIT_TEST(notify, perform_without_servers_does_not_reload) {
+    anjay_t *anjay = anjay_new(&(const anjay_configuration_t) {
+        .endpoint_name = "test"
+    });
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    assert_reload_scheduled_after_perform(anjay, ANJAY_DM_OID_SECURITY, true,
+                                          true);
+    assert_reload_scheduled_after_perform(anjay, ANJAY_DM_OID_SECURITY, false,
+                                          false);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_unlocked->update_immediately_on_dm_change = true;
+    ANJAY_MUTEX_UNLOCK(anjay);
+    assert_reload_scheduled_after_perform(anjay, 42, true, true);
+    assert_reload_scheduled_after_perform(anjay, 42, false, false);
+    anjay_delete(anjay);
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef NOTIFY_MOCK_H
+#define NOTIFY_MOCK_H
+
+#include <avsystem/commons/avs_unit_mock_helpers.h>
+
+AVS_UNIT_MOCK_CREATE(_anjay_notify_changed_unlocked)
+#define _anjay_notify_changed_unlocked(...) \
+    AVS_UNIT_MOCK_WRAPPER(_anjay_notify_changed_unlocked)(__VA_ARGS__)
+
+#endif /* NOTIFY_MOCK_H */
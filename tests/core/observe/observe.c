@@ -9,11 +9,14 @@
 
 #include <anjay_init.h>
 
+#include <limits.h>
 #include <math.h>
 #include <stdarg.h>
 
 #include <avsystem/commons/avs_unit_test.h>
 
+#include <avsystem/coap/udp.h>
+
 #include "src/core/anjay_core.h"
 #include "src/core/servers/anjay_server_connections.h"
 #include "src/core/servers/anjay_servers_internal.h"
@@ -57,6 +60,68 @@ static void assert_observe_consistency(anjay_t *anjay_locked) {
         }
         AVS_UNIT_ASSERT_EQUAL(path_refs_in_observations, path_refs);
     }
+
+    // the global index shall be the union of all observed_paths sets
+    size_t connection_paths = 0;
+    AVS_LIST_FOREACH(conn, anjay->observe.connection_entries) {
+        connection_paths += AVS_SORTED_SET_SIZE(conn->observed_paths);
+    }
+    size_t indexed_paths = 0;
+    if (anjay->observe.observed_paths_index) {
+        AVS_SORTED_SET_ELEM(anjay_observe_path_index_entry_t) index_entry;
+        AVS_SORTED_SET_FOREACH(index_entry,
+                               anjay->observe.observed_paths_index) {
+            size_t connection_count = 0;
+            AVS_LIST_FOREACH(conn, anjay->observe.connection_entries) {
+                if (AVS_SORTED_SET_FIND(conn->observed_paths,
+                                        path_entry_query(&index_entry->path))) {
+                    ++connection_count;
+                    AVS_UNIT_ASSERT_NOT_NULL(AVS_LIST_FIND_BY_VALUE_PTR(
+                            &index_entry->connections, &conn, memcmp));
+                }
+            }
+            AVS_UNIT_ASSERT_NOT_NULL(index_entry->connections);
+            AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(index_entry->connections),
+                                  connection_count);
+            indexed_paths += connection_count;
+        }
+    }
+    AVS_UNIT_ASSERT_EQUAL(indexed_paths, connection_paths);
+
+    // the aggregates used by anjay_observe_planning.c shall be up to date
+    size_t unsent_count = 0;
+    avs_time_real_t earliest_trigger = AVS_TIME_REAL_INVALID;
+    avs_time_real_t earliest_pmax_trigger = AVS_TIME_REAL_INVALID;
+    AVS_LIST_FOREACH(conn, anjay->observe.connection_entries) {
+        unsent_count += AVS_LIST_SIZE(conn->unsent);
+        if (avs_time_real_valid(conn->next_trigger)
+                && !avs_time_real_before(earliest_trigger,
+                                         conn->next_trigger)) {
+            earliest_trigger = conn->next_trigger;
+        }
+        if (avs_time_real_valid(conn->next_pmax_trigger)
+                && !avs_time_real_before(earliest_pmax_trigger,
+                                         conn->next_pmax_trigger)) {
+            earliest_pmax_trigger = conn->next_pmax_trigger;
+        }
+    }
+    AVS_UNIT_ASSERT_EQUAL(anjay->observe.unsent_count, unsent_count);
+    if (avs_time_real_valid(earliest_trigger)) {
+        AVS_UNIT_ASSERT_NOT_NULL(anjay->observe.earliest_trigger_conn);
+        AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+                anjay->observe.earliest_trigger_conn->next_trigger,
+                earliest_trigger));
+    } else {
+        AVS_UNIT_ASSERT_NULL(anjay->observe.earliest_trigger_conn);
+    }
+    if (avs_time_real_valid(earliest_pmax_trigger)) {
+        AVS_UNIT_ASSERT_NOT_NULL(anjay->observe.earliest_pmax_trigger_conn);
+        AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+                anjay->observe.earliest_pmax_trigger_conn->next_pmax_trigger,
+                earliest_pmax_trigger));
+    } else {
+        AVS_UNIT_ASSERT_NULL(anjay->observe.earliest_pmax_trigger_conn);
+    }
     ANJAY_MUTEX_UNLOCK(anjay_locked);
 }
 
@@ -243,6 +308,40 @@ AVS_UNIT_TEST(observe, simple) {
     DM_TEST_FINISH;
 }
 
+static uint8_t first_observation_priority(anjay_t *anjay_locked) {
+    uint8_t result;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay->observe.connection_entries);
+    result = AVS_SORTED_SET_FIRST(anjay->observe.connection_entries
+                                          ->observations)
+                     ->priority;
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+AVS_UNIT_TEST(observe, notification_priority) {
+    SUCCESS_TEST(14);
+    AVS_UNIT_ASSERT_EQUAL(first_observation_priority(anjay), 0);
+    // Instance containing the observed Resource
+    AVS_UNIT_ASSERT_SUCCESS(anjay_set_notification_priority(
+            anjay, 42, 69, ANJAY_ID_INVALID, 3));
+    AVS_UNIT_ASSERT_EQUAL(first_observation_priority(anjay), 3);
+    // unrelated Resource
+    AVS_UNIT_ASSERT_SUCCESS(anjay_set_notification_priority(anjay, 42, 69, 5,
+                                                            7));
+    AVS_UNIT_ASSERT_EQUAL(first_observation_priority(anjay), 3);
+    // the highest of overlapping priorities is used
+    AVS_UNIT_ASSERT_SUCCESS(anjay_set_notification_priority(
+            anjay, 42, ANJAY_ID_INVALID, ANJAY_ID_INVALID, 1));
+    AVS_UNIT_ASSERT_EQUAL(first_observation_priority(anjay), 3);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_set_notification_priority(
+            anjay, 42, 69, ANJAY_ID_INVALID, 0));
+    AVS_UNIT_ASSERT_EQUAL(first_observation_priority(anjay), 1);
+    AVS_UNIT_ASSERT_FAILED(anjay_set_notification_priority(
+            anjay, 42, ANJAY_ID_INVALID, 4, 1));
+    DM_TEST_FINISH;
+}
+
 AVS_UNIT_TEST(observe, read_attrs_failed) {
     DM_TEST_INIT_WITH_SSIDS(4);
     DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0xFA3E, "Res4"),
@@ -337,6 +436,131 @@ AVS_UNIT_TEST(observe, multiple_equivalent_observations) {
     DM_TEST_FINISH;
 }
 
+AVS_UNIT_TEST(observe, shared_samples) {
+    const anjay_dm_object_def_t *const *obj_defs[] = {
+        DM_TEST_DEFAULT_OBJECTS
+    };
+    anjay_ssid_t ssids[] = { 14 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids,
+                         DM_TEST_CONFIGURATION(.share_observation_samples =
+                                                       true));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0xFA3E, "SuccsTkn"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 514));
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0xFA3E, "SuccsTkn"), OBSERVE(0),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    // values sampled while handling a request do not outlive anjay_serve(),
+    // as the next request may be a Write that changes them
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NULL(anjay_unlocked->observe.samples);
+    AVS_UNIT_ASSERT_NULL(anjay_unlocked->observe.samples_cleanup_handle);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0xFA3F, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 515));
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0xFA3F, "Res4"), OBSERVE(0),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("515"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 2);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NULL(anjay_unlocked->observe.samples);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    anjay_sched_run(anjay);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    DM_TEST_FINISH;
+}
+
+#if defined(ANJAY_WITH_LWM2M11) && !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+static AVS_SORTED_SET_ELEM(anjay_observation_t)
+create_test_observation(anjay_observe_state_t *observe,
+                        const char *token,
+                        anjay_request_action_t action,
+                        const anjay_uri_path_t *paths,
+                        size_t paths_count) {
+    avs_coap_token_t coap_token = {
+        .size = (uint8_t) strlen(token)
+    };
+    memcpy(coap_token.bytes, token, coap_token.size);
+    AVS_SORTED_SET_ELEM(anjay_observation_t) observation =
+            create_detached_observation(observe, &coap_token, action,
+                                        &(const paths_arg_t) {
+                                            .type = PATHS_POINTER_ARRAY,
+                                            .paths = paths,
+                                            .count = paths_count
+                                        });
+    AVS_UNIT_ASSERT_NOT_NULL(observation);
+    return observation;
+}
+
+AVS_UNIT_TEST(observe, composite_path_sets_shared) {
+    anjay_observe_state_t observe;
+    memset(&observe, 0, sizeof(observe));
+    const anjay_uri_path_t paths[] = { MAKE_RESOURCE_PATH(42, 69, 4),
+                                       MAKE_INSTANCE_PATH(42, 14) };
+
+    AVS_SORTED_SET_ELEM(anjay_observation_t) first = create_test_observation(
+            &observe, "First", ANJAY_ACTION_READ_COMPOSITE, paths, 2);
+    AVS_SORTED_SET_ELEM(anjay_observation_t) second = create_test_observation(
+            &observe, "Second", ANJAY_ACTION_READ_COMPOSITE, paths, 2);
+    AVS_SORTED_SET_ELEM(anjay_observation_t) subset = create_test_observation(
+            &observe, "Subset", ANJAY_ACTION_READ_COMPOSITE, paths, 1);
+    AVS_SORTED_SET_ELEM(anjay_observation_t) plain = create_test_observation(
+            &observe, "Plain", ANJAY_ACTION_READ, paths, 1);
+
+    AVS_UNIT_ASSERT_NOT_NULL(first->path_set);
+    AVS_UNIT_ASSERT_TRUE(first->path_set == second->path_set);
+    AVS_UNIT_ASSERT_EQUAL(first->path_set->refcount, 2);
+    AVS_UNIT_ASSERT_TRUE(first->paths == first->path_set->paths);
+    AVS_UNIT_ASSERT_TRUE(_anjay_uri_path_equal(&second->paths[1], &paths[1]));
+    AVS_UNIT_ASSERT_NOT_NULL(subset->path_set);
+    AVS_UNIT_ASSERT_TRUE(subset->path_set != first->path_set);
+    AVS_UNIT_ASSERT_NULL(plain->path_set);
+    AVS_UNIT_ASSERT_TRUE(plain->paths == plain->inline_paths);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(observe.path_sets), 2);
+
+    AVS_SORTED_SET_ELEM(anjay_observation_t) *observations[] = {
+        &first, &second, &subset, &plain
+    };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(observations); ++i) {
+        release_observation_paths(&observe, *observations[i]);
+        AVS_SORTED_SET_ELEM_DELETE_DETACHED(observations[i]);
+    }
+    AVS_UNIT_ASSERT_NULL(observe.path_sets);
+}
+#endif // defined(ANJAY_WITH_LWM2M11) &&
+       // !defined(ANJAY_WITHOUT_COMPOSITE_OPERATIONS)
+
 AVS_UNIT_TEST(observe, overwrite) {
     SUCCESS_TEST(14);
     DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0xFA3E, "SuccsTkn"),
@@ -606,15 +830,15 @@ static inline void remove_server(AVS_LIST(anjay_server_info_t) *server_ptr) {
     anjay_unlocked_t *anjay = (*server_ptr)->anjay;
     _anjay_mocksock_expect_stats_zero(connection->conn_socket_);
     _anjay_connection_internal_clean_socket(anjay, connection);
+    _anjay_observe_server_removed(*server_ptr);
     AVS_LIST_DELETE(server_ptr);
 }
 
-AVS_UNIT_TEST(observe, gc) {
+AVS_UNIT_TEST(observe, server_removed) {
     SUCCESS_TEST(14, 69, 514, 666, 777);
 
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
     remove_server(&anjay_unlocked->servers);
-    _anjay_observe_gc(anjay_unlocked);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     assert_observe_consistency(anjay);
@@ -626,7 +850,6 @@ AVS_UNIT_TEST(observe, gc) {
 
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
     remove_server(AVS_LIST_NTH_PTR(&anjay_unlocked->servers, 3));
-    _anjay_observe_gc(anjay_unlocked);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     assert_observe_consistency(anjay);
@@ -637,7 +860,6 @@ AVS_UNIT_TEST(observe, gc) {
 
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
     remove_server(AVS_LIST_NTH_PTR(&anjay_unlocked->servers, 1));
-    _anjay_observe_gc(anjay_unlocked);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     assert_observe_consistency(anjay);
@@ -648,6 +870,82 @@ AVS_UNIT_TEST(observe, gc) {
     DM_TEST_FINISH;
 }
 
+static int count_path_entries(anjay_observe_connection_entry_t *connection,
+                              anjay_observe_path_entry_t *path_entry,
+                              void *count) {
+    (void) connection;
+    (void) path_entry;
+    ++*(size_t *) count;
+    return 0;
+}
+
+static size_t count_matching(anjay_unlocked_t *anjay,
+                             const anjay_uri_path_t *path,
+                             anjay_ssid_t ssid,
+                             bool invert_server_match) {
+    size_t count = 0;
+    observe_for_each_matching_connection(&anjay->observe, path, ssid,
+                                         invert_server_match,
+                                         count_path_entries, &count);
+    return count;
+}
+
+AVS_UNIT_TEST(observe, index_lookup) {
+    SUCCESS_TEST(14, 69, 514);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(count_matching(anjay_unlocked,
+                                         &MAKE_RESOURCE_PATH(42, 69, 4),
+                                         ANJAY_SSID_ANY, true),
+                          3);
+    AVS_UNIT_ASSERT_EQUAL(count_matching(anjay_unlocked,
+                                         &MAKE_RESOURCE_PATH(42, 69, 4), 14,
+                                         true),
+                          2);
+    AVS_UNIT_ASSERT_EQUAL(count_matching(anjay_unlocked,
+                                         &MAKE_RESOURCE_PATH(42, 69, 4), 14,
+                                         false),
+                          1);
+    AVS_UNIT_ASSERT_EQUAL(count_matching(anjay_unlocked, &MAKE_OBJECT_PATH(42),
+                                         ANJAY_SSID_ANY, true),
+                          3);
+    AVS_UNIT_ASSERT_EQUAL(count_matching(anjay_unlocked, &MAKE_ROOT_PATH(),
+                                         ANJAY_SSID_ANY, true),
+                          3);
+    AVS_UNIT_ASSERT_EQUAL(count_matching(anjay_unlocked,
+                                         &MAKE_RESOURCE_PATH(42, 70, 4),
+                                         ANJAY_SSID_ANY, true),
+                          0);
+    AVS_UNIT_ASSERT_EQUAL(count_matching(anjay_unlocked, &MAKE_OBJECT_PATH(43),
+                                         ANJAY_SSID_ANY, true),
+                          0);
+
+    // a connection observing several matching paths is visited only once
+    anjay_observe_connection_entry_t *conn =
+            anjay_unlocked->observe.connection_entries;
+    AVS_SORTED_SET_ELEM(anjay_observe_path_entry_t) instance_entry =
+            find_or_create_observe_path_entry(conn,
+                                              &MAKE_INSTANCE_PATH(42, 69));
+    AVS_UNIT_ASSERT_NOT_NULL(instance_entry);
+    AVS_UNIT_ASSERT_EQUAL(count_matching(anjay_unlocked,
+                                         &MAKE_RESOURCE_PATH(42, 69, 4),
+                                         ANJAY_SSID_ANY, true),
+                          4);
+
+    // also right after the visit counter wraps around
+    anjay_unlocked->observe.index_visit = UINT_MAX;
+    AVS_UNIT_ASSERT_EQUAL(count_matching(anjay_unlocked,
+                                         &MAKE_RESOURCE_PATH(42, 69, 4),
+                                         ANJAY_SSID_ANY, true),
+                          4);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->observe.index_visit, 1);
+    delete_observe_path_entry(conn, &instance_entry);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    assert_observe_consistency(anjay);
+    DM_TEST_FINISH;
+}
+
 static void expect_read_res_attrs(anjay_t *anjay,
                                   const anjay_dm_object_def_t *const *obj_ptr,
                                   anjay_ssid_t ssid,
@@ -685,10 +983,12 @@ static void expect_read_res_attrs(anjay_t *anjay,
     }
 }
 
-static void expect_read_res(anjay_t *anjay,
+static void
+expect_read_res_with_result(anjay_t *anjay,
                             const anjay_dm_object_def_t *const *obj_ptr,
                             anjay_iid_t iid,
                             anjay_rid_t rid,
+                            int result,
                             const anjay_mock_dm_data_t *data) {
     _anjay_mock_dm_expect_list_instances(
             anjay, obj_ptr, 0, (const anjay_iid_t[]) { iid, ANJAY_ID_INVALID });
@@ -712,7 +1012,15 @@ static void expect_read_res(anjay_t *anjay,
     AVS_UNIT_ASSERT_TRUE(i < AVS_ARRAY_SIZE(resources));
     _anjay_mock_dm_expect_list_resources(anjay, obj_ptr, iid, 0, resources);
     _anjay_mock_dm_expect_resource_read(anjay, obj_ptr, iid, rid,
-                                        ANJAY_ID_INVALID, 0, data);
+                                        ANJAY_ID_INVALID, result, data);
+}
+
+static void expect_read_res(anjay_t *anjay,
+                            const anjay_dm_object_def_t *const *obj_ptr,
+                            anjay_iid_t iid,
+                            anjay_rid_t rid,
+                            const anjay_mock_dm_data_t *data) {
+    expect_read_res_with_result(anjay, obj_ptr, iid, rid, 0, data);
 }
 
 static const avs_coap_observe_id_t RES4_IDENTITY = {
@@ -1090,194 +1398,870 @@ AVS_UNIT_TEST(notify, confirmable) {
     DM_TEST_FINISH;
 }
 
-AVS_UNIT_TEST(notify, extremes) {
+AVS_UNIT_TEST(notify, coalesced_triggers) {
     static const anjay_dm_r_attributes_t ATTRS = {
         .common = {
             .min_period = 0,
-            .max_period = 365 * 24 * 60 * 60 /* a year */,
+            .max_period = 10,
             .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
             .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
         },
-        .greater_than = 777.0,
-        .less_than = 69.0,
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
         .step = ANJAY_ATTRIB_DOUBLE_NONE
     };
 
     ////// INITIALIZATION //////
-    DM_TEST_INIT_WITH_SSIDS(14);
+    const anjay_dm_object_def_t *const *obj_defs[] = {
+        DM_TEST_DEFAULT_OBJECTS
+    };
+    anjay_ssid_t ssids[] = { 14 };
+    DM_TEST_INIT_GENERIC(
+            obj_defs, ssids,
+            DM_TEST_CONFIGURATION(.coalesce_observation_triggers = true,
+                                  .observation_trigger_slack =
+                                          avs_time_duration_from_scalar(
+                                                  2, AVS_TIME_S)));
     DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
                     OBSERVE(0), PATH("42", "69", "4"));
-    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 514.0));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 514));
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
                             ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
                             OBSERVE(0), PAYLOAD("514"));
     expect_has_buffered_data_check(mocksocks[0], false);
-    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
-
-    assert_observe_size(anjay, 1);
-
-    ////// LESS //////
-    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
-    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 42.43));
-    const coap_test_msg_t *notify_response =
-            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
-                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("42.43"));
-    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
-                                    notify_response->length);
-    anjay_sched_run(anjay);
-    assert_observe_consistency(anjay);
-    assert_observe_size(anjay, 1);
-    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
-    AVS_UNIT_ASSERT_NOT_NULL(
-            AVS_SORTED_SET_FIRST(
-                    anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
-    ANJAY_MUTEX_UNLOCK(anjay);
-
-    ////// EVEN LESS //////
-    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
-    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 14.7));
-    anjay_sched_run(anjay);
-    assert_observe_consistency(anjay);
-    assert_observe_size(anjay, 1);
-    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
-    AVS_UNIT_ASSERT_NOT_NULL(
-            AVS_SORTED_SET_FIRST(
-                    anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
-    ANJAY_MUTEX_UNLOCK(anjay);
-
-    ////// IN BETWEEN //////
-    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 695));
-    const coap_test_msg_t *notify_response2 =
-            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 1, "Res4"),
-                     OBSERVE(2), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("695"));
-    avs_unit_mocksock_expect_output(mocksocks[0], notify_response2->content,
-                                    notify_response2->length);
-    anjay_sched_run(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
     assert_observe_consistency(anjay);
     assert_observe_size(anjay, 1);
-    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
-    AVS_UNIT_ASSERT_NOT_NULL(
-            AVS_SORTED_SET_FIRST(
-                    anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
-    ANJAY_MUTEX_UNLOCK(anjay);
 
-    ////// EQUAL - STILL NOT CROSSING //////
-    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
-    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 69));
-    anjay_sched_run(anjay);
-    assert_observe_consistency(anjay);
-    assert_observe_size(anjay, 1);
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
-    AVS_UNIT_ASSERT_NOT_NULL(
-            AVS_SORTED_SET_FIRST(
-                    anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+    anjay_observe_connection_entry_t *conn =
+            anjay_unlocked->observe.connection_entries;
+    anjay_observation_t *observation = AVS_SORTED_SET_FIRST(conn->observations);
+    AVS_UNIT_ASSERT_NULL(observation->notify_task);
+    AVS_UNIT_ASSERT_TRUE(
+            avs_time_monotonic_valid(observation->trigger_deadline));
+    AVS_UNIT_ASSERT_TRUE(avs_time_monotonic_equal(
+            avs_sched_time(&conn->trigger_task),
+            avs_time_monotonic_add(observation->trigger_deadline,
+                                   avs_time_duration_from_scalar(
+                                           2, AVS_TIME_S))));
     ANJAY_MUTEX_UNLOCK(anjay);
 
-    ////// GREATER //////
+    ////// TRIGGER DELAYED BY SLACK //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
-    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 1024));
-    const coap_test_msg_t *notify_response3 =
-            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 2, "Res4"),
-                     OBSERVE(3), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("1024"));
-    avs_unit_mocksock_expect_output(mocksocks[0], notify_response3->content,
-                                    notify_response3->length);
     anjay_sched_run(anjay);
     assert_observe_consistency(anjay);
-    assert_observe_size(anjay, 1);
-    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
-    AVS_UNIT_ASSERT_NOT_NULL(
-            AVS_SORTED_SET_FIRST(
-                    anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
-    ANJAY_MUTEX_UNLOCK(anjay);
 
-    ////// STILL GREATER //////
-    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(2, AVS_TIME_S));
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 999));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 42));
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("42"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
     anjay_sched_run(anjay);
     assert_observe_consistency(anjay);
     assert_observe_size(anjay, 1);
-    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
-    AVS_UNIT_ASSERT_NOT_NULL(
-            AVS_SORTED_SET_FIRST(
-                    anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
-    ANJAY_MUTEX_UNLOCK(anjay);
 
-    ////// LESS AGAIN //////
-    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
-    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, -69.75));
-    const coap_test_msg_t *notify_response4 =
-            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 3, "Res4"),
-                     OBSERVE(4), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("-69.75"));
-    avs_unit_mocksock_expect_output(mocksocks[0], notify_response4->content,
-                                    notify_response4->length);
-    anjay_sched_run(anjay);
-    assert_observe_consistency(anjay);
-    assert_observe_size(anjay, 1);
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_observation_t *observation = AVS_SORTED_SET_FIRST(
+            anjay_unlocked->observe.connection_entries->observations);
+    AVS_UNIT_ASSERT_NULL(observation->notify_task);
+    AVS_UNIT_ASSERT_TRUE(
+            avs_time_monotonic_valid(observation->trigger_deadline));
     AVS_UNIT_ASSERT_NOT_NULL(
-            AVS_SORTED_SET_FIRST(
-                    anjay_unlocked->observe.connection_entries->observations)
-                    ->notify_task);
+            anjay_unlocked->observe.connection_entries->trigger_task);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     DM_TEST_FINISH;
 }
 
-AVS_UNIT_TEST(notify, greater_only) {
+AVS_UNIT_TEST(notify, cached_payload) {
     static const anjay_dm_r_attributes_t ATTRS = {
         .common = {
             .min_period = 0,
-            .max_period = 365 * 24 * 60 * 60 /* a year */,
+            .max_period = 10,
             .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
             .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
         },
-        .greater_than = 69.0,
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
         .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
         .step = ANJAY_ATTRIB_DOUBLE_NONE
     };
 
-    ////// INITIALIZATION (GREATER) //////
-    DM_TEST_INIT_WITH_SSIDS(14);
+    ////// INITIALIZATION //////
+    const anjay_dm_object_def_t *const *obj_defs[] = {
+        DM_TEST_DEFAULT_OBJECTS
+    };
+    anjay_ssid_t ssids[] = { 14 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids,
+                         DM_TEST_CONFIGURATION(.cache_notification_payload =
+                                                       true));
     DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
                     OBSERVE(0), PATH("42", "69", "4"));
-    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 514.0));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 514));
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
                             ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
                             OBSERVE(0), PAYLOAD("514"));
     expect_has_buffered_data_check(mocksocks[0], false);
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
-
     assert_observe_size(anjay, 1);
 
-    ////// STILL GREATER //////
+    ////// NOTIFICATION //////
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
     expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
-    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 9001));
-    anjay_sched_run(anjay);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 42));
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("42"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    const anjay_observation_serialization_state_t *state =
+            &anjay_unlocked->observe.connection_entries->serialization_state;
+    AVS_UNIT_ASSERT_NULL(state->membuf_stream);
+    AVS_UNIT_ASSERT_NULL(state->payload);
+    AVS_UNIT_ASSERT_FALSE(state->payload_cached);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_FINISH;
+}
+
+#define NOTIFY_BLOCK_SIZE 1024
+#define TIMES_4(Str) Str Str Str Str
+#define NOTIFY_BLOCK_OF(Char) TIMES_4(TIMES_4(TIMES_4(TIMES_4(TIMES_4(Char)))))
+#define NOTIFY_BLOCK_A NOTIFY_BLOCK_OF("a")
+#define NOTIFY_BLOCK_B NOTIFY_BLOCK_OF("b")
+#define NOTIFY_BLOCK_C "ccc"
+#define NOTIFY_PAYLOAD NOTIFY_BLOCK_A NOTIFY_BLOCK_B NOTIFY_BLOCK_C
+
+static void expect_notify_block_request(anjay_t *anjay,
+                                        avs_net_socket_t *mocksock,
+                                        uint16_t msg_id,
+                                        uint32_t seq_num) {
+    DM_TEST_REQUEST(mocksock, CON, GET, ID_TOKEN(msg_id, "Blk"),
+                    PATH("42", "69", "4"),
+                    BLOCK2(seq_num, NOTIFY_BLOCK_SIZE));
+    DM_TEST_EXPECT_RESPONSE(mocksock, ACK, CONTENT, ID_TOKEN(msg_id, "Blk"),
+                            CONTENT_FORMAT(PLAINTEXT),
+                            BLOCK2(seq_num, NOTIFY_BLOCK_SIZE, NOTIFY_PAYLOAD));
+    expect_has_buffered_data_check(mocksock, false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksock));
+}
+
+static void assert_cached_notify_block(anjay_t *anjay_locked,
+                                       size_t offset,
+                                       const char *expected_data,
+                                       size_t expected_size) {
+    char buf[NOTIFY_BLOCK_SIZE];
+    size_t chunk_size = 0;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    anjay_observe_connection_entry_t *conn = anjay->observe.connection_entries;
+    AVS_UNIT_ASSERT_NOT_NULL(conn);
+    AVS_UNIT_ASSERT_SUCCESS(write_notify_payload(offset, buf, sizeof(buf),
+                                                 &chunk_size, conn));
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    AVS_UNIT_ASSERT_EQUAL(chunk_size, expected_size);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, expected_data, expected_size);
+}
+
+AVS_UNIT_TEST(notify, cached_payload_block) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 0,
+            .max_period = 10,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION //////
+    const anjay_dm_object_def_t *const *obj_defs[] = {
+        DM_TEST_DEFAULT_OBJECTS
+    };
+    anjay_ssid_t ssids[] = { 14 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids,
+                         DM_TEST_CONFIGURATION(.cache_notification_payload =
+                                                       true));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 514));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    assert_observe_size(anjay, 1);
+
+    ////// FIRST BLOCK OF THE NOTIFICATION //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4,
+                    ANJAY_MOCK_DM_STRING(0, NOTIFY_PAYLOAD));
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT),
+                     BLOCK2(0, NOTIFY_BLOCK_SIZE, NOTIFY_PAYLOAD));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+
+    // the whole payload has been serialized up front
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    const anjay_observation_serialization_state_t *state =
+            &anjay_unlocked->observe.connection_entries->serialization_state;
+    AVS_UNIT_ASSERT_TRUE(state->payload_cached);
+    AVS_UNIT_ASSERT_NULL(state->out_ctx);
+    AVS_UNIT_ASSERT_EQUAL(state->payload_size, sizeof(NOTIFY_PAYLOAD) - 1);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    ////// FURTHER BLOCKS //////
+    expect_notify_block_request(anjay, mocksocks[0], 0x69EE, 1);
+    // a block that has already been sent is served from the cache again, as
+    // is the one before it
+    assert_cached_notify_block(anjay, NOTIFY_BLOCK_SIZE, NOTIFY_BLOCK_B,
+                               NOTIFY_BLOCK_SIZE);
+    assert_cached_notify_block(anjay, 0, NOTIFY_BLOCK_A, NOTIFY_BLOCK_SIZE);
+    expect_notify_block_request(anjay, mocksocks[0], 0x69EF, 2);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+
+    // the cache is released after the last block
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    state = &anjay_unlocked->observe.connection_entries->serialization_state;
+    AVS_UNIT_ASSERT_NULL(state->membuf_stream);
+    AVS_UNIT_ASSERT_NULL(state->payload);
+    AVS_UNIT_ASSERT_FALSE(state->payload_cached);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_FINISH;
+}
+
+#undef NOTIFY_PAYLOAD
+#undef NOTIFY_BLOCK_C
+#undef NOTIFY_BLOCK_B
+#undef NOTIFY_BLOCK_A
+#undef NOTIFY_BLOCK_OF
+#undef TIMES_4
+#undef NOTIFY_BLOCK_SIZE
+
+AVS_UNIT_TEST(notify, cached_attrs) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 0,
+            .max_period = 10,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION //////
+    const anjay_dm_object_def_t *const *obj_defs[] = {
+        DM_TEST_DEFAULT_OBJECTS
+    };
+    anjay_ssid_t ssids[] = { 14 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids,
+                         DM_TEST_CONFIGURATION(.cache_observation_attrs =
+                                                       true));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 514));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    assert_observe_size(anjay, 1);
+
+    ////// NOTIFICATION //////
+    // attributes are re-read once after the change, and the memoized values
+    // are used when evaluating the notification
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 42));
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("42"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(notify, notify_driven) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 0,
+            .max_period = 5,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_WITH_SSIDS(14);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_set_notify_driven(anjay, 42, true));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 514));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    ////// FIRST PMAX NOTIFICATION //////
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 514));
+    const coap_test_msg_t *notify_response1 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response1->content,
+                                    notify_response1->length);
+    anjay_sched_run(anjay);
+
+    ////// SECOND PMAX NOTIFICATION //////
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    // no change has been reported, so the value is not read again
+    const coap_test_msg_t *notify_response2 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 1, "Res4"),
+                     OBSERVE(2), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response2->content,
+                                    notify_response2->length);
+    anjay_sched_run(anjay);
+
+    ////// CHANGE REPORTED //////
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 42));
+    const coap_test_msg_t *notify_response3 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 2, "Res4"),
+                     OBSERVE(3), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("42"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response3->content,
+                                    notify_response3->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(notify, busy_value_held_back) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 0,
+            .max_period = 10,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_WITH_SSIDS(14);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 514));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    assert_observe_size(anjay, 1);
+
+    ////// CHANGE REPORTED WHILE THE RESOURCE IS BUSY //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res_with_result(anjay, &OBJ, 69, 4, ANJAY_ERR_BUSY,
+                                ANJAY_MOCK_DM_NONE);
+    // nothing is sent, and the observation is not cancelled
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+
+    ////// VALUE BECOMES AVAILABLE //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 42));
+    // the held back notification is the next one in sequence
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("42"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+
+    DM_TEST_FINISH;
+}
+
+#ifdef ANJAY_WITH_OBSERVE_PERSISTENCE
+AVS_UNIT_TEST(notify, persist_restore) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 0,
+            .max_period = 10,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_WITH_SSIDS(14);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 514));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    assert_observe_size(anjay, 1);
+
+    ////// PERSIST AND RESTORE //////
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(membuf);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_observe_persist(anjay, membuf));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_observe_restore(anjay, membuf));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    const anjay_observe_restored_t *restored = anjay_unlocked->observe.restored;
+    AVS_UNIT_ASSERT_NOT_NULL(restored);
+    AVS_UNIT_ASSERT_NULL(AVS_LIST_NEXT(restored));
+    AVS_UNIT_ASSERT_EQUAL(restored->ssid, 14);
+    AVS_UNIT_ASSERT_EQUAL(restored->conn_type, ANJAY_CONNECTION_PRIMARY);
+    AVS_UNIT_ASSERT_EQUAL(restored->token.size, 4);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(restored->token.bytes, "Res4", 4);
+    AVS_UNIT_ASSERT_EQUAL(restored->paths_count, 1);
+    AVS_UNIT_ASSERT_TRUE(_anjay_uri_path_equal(
+            &restored->paths[0], &MAKE_RESOURCE_PATH(42, 69, 4)));
+    AVS_UNIT_ASSERT_TRUE(restored->coap_state_size > 0);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    // malformed snapshot is rejected, leaving the restored state intact
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(membuf, "XYZ", 4));
+    AVS_UNIT_ASSERT_FAILED(anjay_observe_restore(anjay, membuf));
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay_unlocked->observe.restored);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    avs_stream_cleanup(&membuf);
+
+    DM_TEST_FINISH;
+}
+
+/**
+ * Simulates bringing the primary connection of the only server back online:
+ * the CoAP context is replaced with a fresh one, into which the restored
+ * observations are applied before the socket is assigned.
+ */
+static void reconnect_with_restored_observations(anjay_t *anjay_locked,
+                                                 avs_net_socket_t *socket) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    const anjay_connection_ref_t ref = {
+        .server = anjay->servers,
+        .conn_type = ANJAY_CONNECTION_PRIMARY
+    };
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    AVS_UNIT_ASSERT_NOT_NULL(connection);
+    avs_coap_ctx_cleanup(&connection->coap_ctx);
+    connection->coap_ctx = avs_coap_udp_ctx_create(
+            _anjay_get_coap_sched(anjay), &AVS_COAP_DEFAULT_UDP_TX_PARAMS,
+            anjay->in_shared_buffer, anjay->out_shared_buffer,
+            anjay->udp_response_cache, anjay->prng_ctx.ctx);
+    AVS_UNIT_ASSERT_NOT_NULL(connection->coap_ctx);
+    _anjay_observe_apply_restored(ref, true);
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_coap_ctx_set_socket(connection->coap_ctx, socket));
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+AVS_UNIT_TEST(notify, restore_into_connection) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 1,
+            .max_period = 10,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_WITH_SSIDS(14);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 514));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    assert_observe_size(anjay, 1);
+
+    ////// NOTIFICATION BEFORE PERSISTING //////
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(10, AVS_TIME_S));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 515));
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("515"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+
+    ////// PERSIST AND RECONNECT //////
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(membuf);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_observe_persist(anjay, membuf));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_observe_restore(anjay, membuf));
+    avs_stream_cleanup(&membuf);
+
+    // the baseline is re-read from the data model, and pmax is rescheduled
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 515));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    reconnect_with_restored_observations(anjay, mocksocks[0]);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NULL(anjay_unlocked->observe.restored);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    ////// NOTIFICATION AFTER RESTORING //////
+    // the fresh CoAP context starts with the same message ID, but the token
+    // and the Observe option sequence are carried over from the snapshot
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(10, AVS_TIME_S));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 516));
+    notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(2),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("516"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_OBSERVE_PERSISTENCE
+
+#ifdef ANJAY_WITH_OBSERVATION_STATUS
+AVS_UNIT_TEST(notify, counters) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 0,
+            .max_period = 10,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_WITH_SSIDS(14);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 514));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    assert_observe_size(anjay, 1);
+
+    anjay_server_observation_stats_t stats =
+            anjay_server_observation_stats(anjay, 14);
+    AVS_UNIT_ASSERT_EQUAL(stats.observation_count, 1);
+    AVS_UNIT_ASSERT_EQUAL(stats.counters.notifications_sent, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.queue_depth, 0);
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_valid(stats.next_trigger));
+
+    ////// CHANGED VALUE //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 42));
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("42"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+
+    ////// UNCHANGED VALUE //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 42));
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+
+    stats = anjay_server_observation_stats(anjay, 14);
+    AVS_UNIT_ASSERT_EQUAL(stats.observation_count, 1);
+    AVS_UNIT_ASSERT_EQUAL(stats.counters.notifications_sent, 1);
+    AVS_UNIT_ASSERT_EQUAL(stats.counters.criteria_suppressed, 1);
+    AVS_UNIT_ASSERT_EQUAL(stats.counters.pmin_postponed, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.counters.queue_dropped, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.counters.retransmissions, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.queue_depth, 0);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    const anjay_observation_t *observation = AVS_SORTED_SET_FIRST(
+            anjay_unlocked->observe.connection_entries->observations);
+    AVS_UNIT_ASSERT_EQUAL(observation->counters.notifications_sent, 1);
+    AVS_UNIT_ASSERT_EQUAL(observation->counters.criteria_suppressed, 1);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    stats = anjay_server_observation_stats(anjay, 15);
+    AVS_UNIT_ASSERT_EQUAL(stats.observation_count, 0);
+    AVS_UNIT_ASSERT_FALSE(avs_time_real_valid(stats.next_trigger));
+
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_OBSERVATION_STATUS
+
+AVS_UNIT_TEST(notify, extremes) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 0,
+            .max_period = 365 * 24 * 60 * 60 /* a year */,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = 777.0,
+        .less_than = 69.0,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION //////
+    DM_TEST_INIT_WITH_SSIDS(14);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 514.0));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    assert_observe_size(anjay, 1);
+
+    ////// LESS //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 42.43));
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "Res4"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("42.43"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(
+            AVS_SORTED_SET_FIRST(
+                    anjay_unlocked->observe.connection_entries->observations)
+                    ->notify_task);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    ////// EVEN LESS //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 14.7));
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(
+            AVS_SORTED_SET_FIRST(
+                    anjay_unlocked->observe.connection_entries->observations)
+                    ->notify_task);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    ////// IN BETWEEN //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 695));
+    const coap_test_msg_t *notify_response2 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 1, "Res4"),
+                     OBSERVE(2), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("695"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response2->content,
+                                    notify_response2->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(
+            AVS_SORTED_SET_FIRST(
+                    anjay_unlocked->observe.connection_entries->observations)
+                    ->notify_task);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    ////// EQUAL - STILL NOT CROSSING //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 69));
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(
+            AVS_SORTED_SET_FIRST(
+                    anjay_unlocked->observe.connection_entries->observations)
+                    ->notify_task);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    ////// GREATER //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 1024));
+    const coap_test_msg_t *notify_response3 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 2, "Res4"),
+                     OBSERVE(3), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("1024"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response3->content,
+                                    notify_response3->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(
+            AVS_SORTED_SET_FIRST(
+                    anjay_unlocked->observe.connection_entries->observations)
+                    ->notify_task);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    ////// STILL GREATER //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 999));
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(
+            AVS_SORTED_SET_FIRST(
+                    anjay_unlocked->observe.connection_entries->observations)
+                    ->notify_task);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    ////// LESS AGAIN //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, -69.75));
+    const coap_test_msg_t *notify_response4 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 3, "Res4"),
+                     OBSERVE(4), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("-69.75"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response4->content,
+                                    notify_response4->length);
+    anjay_sched_run(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 1);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(
+            AVS_SORTED_SET_FIRST(
+                    anjay_unlocked->observe.connection_entries->observations)
+                    ->notify_task);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(notify, greater_only) {
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 0,
+            .max_period = 365 * 24 * 60 * 60 /* a year */,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = 69.0,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+
+    ////// INITIALIZATION (GREATER) //////
+    DM_TEST_INIT_WITH_SSIDS(14);
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 514.0));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    assert_observe_size(anjay, 1);
+
+    ////// STILL GREATER //////
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_INT(0, 9001));
+    anjay_sched_run(anjay);
     assert_observe_consistency(anjay);
     assert_observe_size(anjay, 1);
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
@@ -1634,6 +2618,93 @@ AVS_UNIT_TEST(notify, step) {
     DM_TEST_FINISH;
 }
 
+static anjay_batch_t *make_multiple_instance_batch(const anjay_riid_t *riids,
+                                                  const double *values,
+                                                  size_t count) {
+    anjay_batch_builder_t *builder = _anjay_batch_builder_new();
+    AVS_UNIT_ASSERT_NOT_NULL(builder);
+    for (size_t i = 0; i < count; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_double(
+                builder, &MAKE_RESOURCE_INSTANCE_PATH(42, 69, 4, riids[i]),
+                AVS_TIME_REAL_INVALID, values[i]));
+    }
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+    return batch;
+}
+
+static bool should_update_mi(const anjay_dm_r_attributes_t *attrs,
+                             const anjay_riid_t *previous_riids,
+                             const double *previous_values,
+                             const anjay_riid_t *new_riids,
+                             const double *new_values,
+                             size_t count) {
+    anjay_batch_t *previous = make_multiple_instance_batch(
+            previous_riids, previous_values, count);
+    anjay_batch_t *new_value =
+            make_multiple_instance_batch(new_riids, new_values, count);
+    bool result = should_update(&MAKE_RESOURCE_PATH(42, 69, 4), attrs,
+                                previous, new_value);
+    _anjay_batch_release(&previous);
+    _anjay_batch_release(&new_value);
+    return result;
+}
+
+AVS_UNIT_TEST(notify, should_update_multiple_instance) {
+    static const anjay_dm_r_attributes_t STEP_ATTRS = {
+        .common = {
+            .min_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = 10.0
+    };
+    static const anjay_dm_r_attributes_t LT_ATTRS = {
+        .common = {
+            .min_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = 10.0,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+    static const anjay_riid_t RIIDS[] = { 1, 3 };
+    static const anjay_riid_t OTHER_RIIDS[] = { 1, 4 };
+
+    // none of the Resource Instances changed by stp
+    AVS_UNIT_ASSERT_FALSE(should_update_mi(
+            &STEP_ATTRS, RIIDS, (const double[]) { 1.0, 2.0 }, RIIDS,
+            (const double[]) { 5.0, 3.0 }, 2));
+    // one of them did
+    AVS_UNIT_ASSERT_TRUE(should_update_mi(
+            &STEP_ATTRS, RIIDS, (const double[]) { 1.0, 2.0 }, RIIDS,
+            (const double[]) { 5.0, 12.0 }, 2));
+    // one of them crossed lt
+    AVS_UNIT_ASSERT_TRUE(should_update_mi(
+            &LT_ATTRS, RIIDS, (const double[]) { 5.0, 5.0 }, RIIDS,
+            (const double[]) { 5.0, 15.0 }, 2));
+    AVS_UNIT_ASSERT_FALSE(should_update_mi(
+            &LT_ATTRS, RIIDS, (const double[]) { 5.0, 5.0 }, RIIDS,
+            (const double[]) { 6.0, 7.0 }, 2));
+    // different set of Resource Instances - notifying each change
+    AVS_UNIT_ASSERT_TRUE(should_update_mi(
+            &STEP_ATTRS, RIIDS, (const double[]) { 1.0, 2.0 }, OTHER_RIIDS,
+            (const double[]) { 1.0, 3.0 }, 2));
+
+    // a single Resource Instance is compared like a Single-Instance Resource
+    AVS_UNIT_ASSERT_FALSE(should_update_mi(
+            &STEP_ATTRS, RIIDS, (const double[]) { 20.0 }, RIIDS,
+            (const double[]) { 25.0 }, 1));
+    AVS_UNIT_ASSERT_TRUE(should_update_mi(
+            &STEP_ATTRS, RIIDS, (const double[]) { 20.0 }, RIIDS,
+            (const double[]) { 40.0 }, 1));
+}
+
 AVS_UNIT_TEST(notify, multiple_formats) {
     static const anjay_dm_r_attributes_t ATTRS = {
         .common = {
@@ -1767,15 +2838,268 @@ AVS_UNIT_TEST(notify, storing_when_inactive) {
     // deactivate the first server
     socket14 = connection->conn_socket_;
     connection->conn_socket_ = NULL;
-    _anjay_observe_gc(anjay_unlocked);
     ANJAY_MUTEX_UNLOCK(anjay);
 
-    assert_observe_consistency(anjay);
-    assert_observe_size(anjay, 2);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 2);
+
+    // first notification
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+
+    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_STRING(0, "Rin"));
+
+    DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_STRING(0, "Len"));
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "SuccsTkn"),
+                     OBSERVE(1), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Len"));
+    avs_unit_mocksock_expect_output(mocksocks[1], notify_response->content,
+
+                                    notify_response->length);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
+    anjay_sched_run(anjay);
+
+    // second notification
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+
+    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_STRING(0, "Miku"));
+
+    DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_STRING(0, "Luka"));
+    const coap_test_msg_t *notify_response2 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 1, "SuccsTkn"),
+                     OBSERVE(2), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Luka"));
+    avs_unit_mocksock_expect_output(mocksocks[1], notify_response2->content,
+                                    notify_response2->length);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
+    anjay_sched_run(anjay);
+
+    // reactivate the server
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    connection->conn_socket_ = socket14;
+    ANJAY_MUTEX_UNLOCK(anjay);
+    assert_observe_consistency(anjay);
+    assert_observe_size(anjay, 2);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    _anjay_observe_sched_flush((anjay_connection_ref_t) {
+        .server = anjay_unlocked->servers,
+        .conn_type = ANJAY_CONNECTION_PRIMARY
+    });
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    const coap_test_msg_t *notify_response3 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(0x0000, "SuccsTkn"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Rin"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response3->content,
+                                    notify_response3->length);
+
+    const coap_test_msg_t *notify_response4 =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(0x0001, "SuccsTkn"), OBSERVE(2),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Miku"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response4->content,
+                                    notify_response4->length);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    anjay_sched_run(anjay);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(notify, merge_queued_when_inactive) {
+    const anjay_dm_object_def_t *const *obj_defs[] = {
+        DM_TEST_DEFAULT_OBJECTS
+    };
+    anjay_ssid_t ssids[] = { 14 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids,
+                         DM_TEST_CONFIGURATION(.merge_queued_notifications =
+                                                       true));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0xFA3E, "SuccsTkn"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 514));
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0xFA3E, "SuccsTkn"), OBSERVE(0),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    assert_observe_size(anjay, 1);
+    anjay_sched_run(anjay);
+
+    anjay_server_connection_t *connection;
+    avs_net_socket_t *socket14;
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    connection = _anjay_get_server_connection((const anjay_connection_ref_t) {
+        .server = anjay_unlocked->servers,
+        .conn_type = ANJAY_CONNECTION_PRIMARY
+    });
+    AVS_UNIT_ASSERT_NOT_NULL(connection);
+
+    // deactivate the server
+    socket14 = connection->conn_socket_;
+    connection->conn_socket_ = NULL;
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    // first notification
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+
+    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_STRING(0, "Rin"));
+    anjay_sched_run(anjay);
+
+    // second notification replaces the first one
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+
+    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_STRING(0, "Miku"));
+    anjay_sched_run(anjay);
+
+    assert_observe_consistency(anjay);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(
+            AVS_LIST_SIZE(anjay_unlocked->observe.connection_entries->unsent),
+            1);
+
+    // reactivate the server
+    connection->conn_socket_ = socket14;
+    _anjay_observe_sched_flush((anjay_connection_ref_t) {
+        .server = anjay_unlocked->servers,
+        .conn_type = ANJAY_CONNECTION_PRIMARY
+    });
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(0x0000, "SuccsTkn"), OBSERVE(1),
+                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Miku"));
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    anjay_sched_run(anjay);
+
+    DM_TEST_FINISH;
+}
 
-    // first notification
+static void queue_notification_when_inactive(anjay_t *anjay,
+                                             const char *value) {
     DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
-    DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
 
     _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
@@ -1796,9 +3120,31 @@ AVS_UNIT_TEST(notify, storing_when_inactive) {
                     { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
                     ANJAY_MOCK_DM_RES_END });
     _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
-                                        ANJAY_MOCK_DM_STRING(0, "Rin"));
+                                        ANJAY_MOCK_DM_STRING(0, value));
+    anjay_sched_run(anjay);
+}
 
-    DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
+static void expect_queued_notification(avs_net_socket_t *socket,
+                                       uint16_t msg_id,
+                                       uint32_t observe,
+                                       const char *value) {
+    const coap_test_msg_t *notify_response =
+            COAP_MSG(NON, CONTENT, ID_TOKEN(msg_id, "SuccsTkn"),
+                     OBSERVE(observe), CONTENT_FORMAT(PLAINTEXT),
+                     PAYLOAD_EXTERNAL(value, strlen(value)));
+    avs_unit_mocksock_expect_output(socket, notify_response->content,
+                                    notify_response->length);
+}
+
+AVS_UNIT_TEST(notify, flush_burst) {
+    const anjay_dm_object_def_t *const *obj_defs[] = {
+        DM_TEST_DEFAULT_OBJECTS
+    };
+    anjay_ssid_t ssids[] = { 14 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids,
+                         DM_TEST_CONFIGURATION(.notification_flush_burst = 2));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0xFA3E, "SuccsTkn"),
+                    OBSERVE(0), PATH("42", "69", "4"));
     _anjay_mock_dm_expect_list_instances(
             anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
     _anjay_mock_dm_expect_list_resources(
@@ -1813,19 +3159,122 @@ AVS_UNIT_TEST(notify, storing_when_inactive) {
                     { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
                     ANJAY_MOCK_DM_RES_END });
     _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
-                                        ANJAY_MOCK_DM_STRING(0, "Len"));
-    const coap_test_msg_t *notify_response =
-            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE, "SuccsTkn"),
-                     OBSERVE(1), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Len"));
-    avs_unit_mocksock_expect_output(mocksocks[1], notify_response->content,
+                                        ANJAY_MOCK_DM_INT(0, 514));
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0xFA3E, "SuccsTkn"), OBSERVE(0),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    assert_observe_size(anjay, 1);
+    anjay_sched_run(anjay);
 
-                                    notify_response->length);
-    DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
+    anjay_server_connection_t *connection;
+    avs_net_socket_t *socket14;
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    connection = _anjay_get_server_connection((const anjay_connection_ref_t) {
+        .server = anjay_unlocked->servers,
+        .conn_type = ANJAY_CONNECTION_PRIMARY
+    });
+    AVS_UNIT_ASSERT_NOT_NULL(connection);
+
+    // deactivate the server
+    socket14 = connection->conn_socket_;
+    connection->conn_socket_ = NULL;
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    queue_notification_when_inactive(anjay, "Rin");
+    queue_notification_when_inactive(anjay, "Miku");
+    queue_notification_when_inactive(anjay, "Luka");
+
+    assert_observe_consistency(anjay);
+    avs_sched_t *sched;
+    anjay_observe_connection_entry_t *conn;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    sched = anjay_unlocked->sched;
+    conn = anjay_unlocked->observe.connection_entries;
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(conn->unsent), 3);
+
+    // reactivate the server
+    connection->conn_socket_ = socket14;
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    // a single run of the flush job sends at most notification_flush_burst
+    // notifications, and reschedules itself for the rest
+    expect_queued_notification(mocksocks[0], 0x0000, 1, "Rin");
+    expect_queued_notification(mocksocks[0], 0x0001, 2, "Miku");
+    flush_send_queue_job(sched, &conn);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(conn->unsent), 1);
+    AVS_UNIT_ASSERT_NOT_NULL(conn->flush_task);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    expect_queued_notification(mocksocks[0], 0x0002, 3, "Luka");
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
     anjay_sched_run(anjay);
 
-    // second notification
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NULL(conn->unsent);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(notify, memory_limit_when_inactive) {
+    const anjay_dm_object_def_t *const *obj_defs[] = {
+        DM_TEST_DEFAULT_OBJECTS
+    };
+    anjay_ssid_t ssids[] = { 14 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids,
+                         DM_TEST_CONFIGURATION(
+                                 .stored_notification_memory_limit = 1));
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0xFA3E, "SuccsTkn"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &OBJ, 69, 0,
+            (const anjay_mock_dm_res_entry_t[]) {
+                    { 0, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 1, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 2, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 3, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 4, ANJAY_DM_RES_RW, ANJAY_DM_RES_PRESENT },
+                    { 5, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
+                    ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 514));
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0xFA3E, "SuccsTkn"), OBSERVE(0),
+                            CONTENT_FORMAT(PLAINTEXT), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    assert_observe_size(anjay, 1);
+    anjay_sched_run(anjay);
+
+    anjay_server_connection_t *connection;
+    avs_net_socket_t *socket14;
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    connection = _anjay_get_server_connection((const anjay_connection_ref_t) {
+        .server = anjay_unlocked->servers,
+        .conn_type = ANJAY_CONNECTION_PRIMARY
+    });
+    AVS_UNIT_ASSERT_NOT_NULL(connection);
+
+    // deactivate the server
+    socket14 = connection->conn_socket_;
+    connection->conn_socket_ = NULL;
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    // first notification
     DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
-    DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
     AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
 
     _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
@@ -1846,9 +3295,17 @@ AVS_UNIT_TEST(notify, storing_when_inactive) {
                     { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
                     ANJAY_MOCK_DM_RES_END });
     _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
-                                        ANJAY_MOCK_DM_STRING(0, "Miku"));
+                                        ANJAY_MOCK_DM_STRING(0, "Rin"));
+    anjay_sched_run(anjay);
 
-    DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
+    // second notification does not fit along with the first one
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_notify_changed(anjay, 42, 69, 4));
+
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+
+    expect_read_notif_storing(anjay, &FAKE_SERVER, 14, true);
+    DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
     _anjay_mock_dm_expect_list_instances(
             anjay, &OBJ, 0, (const anjay_iid_t[]) { 69, ANJAY_ID_INVALID });
     _anjay_mock_dm_expect_list_resources(
@@ -1863,43 +3320,37 @@ AVS_UNIT_TEST(notify, storing_when_inactive) {
                     { 6, ANJAY_DM_RES_RW, ANJAY_DM_RES_ABSENT },
                     ANJAY_MOCK_DM_RES_END });
     _anjay_mock_dm_expect_resource_read(anjay, &OBJ, 69, 4, ANJAY_ID_INVALID, 0,
-                                        ANJAY_MOCK_DM_STRING(0, "Luka"));
-    const coap_test_msg_t *notify_response2 =
-            COAP_MSG(NON, CONTENT, ID_TOKEN(MSG_ID_BASE + 1, "SuccsTkn"),
-                     OBSERVE(2), CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Luka"));
-    avs_unit_mocksock_expect_output(mocksocks[1], notify_response2->content,
-                                    notify_response2->length);
-    DM_TEST_EXPECT_READ_NULL_ATTRS(34, 69, 4);
+                                        ANJAY_MOCK_DM_STRING(0, "Miku"));
     anjay_sched_run(anjay);
 
+    assert_observe_consistency(anjay);
+    size_t count;
+    size_t bytes;
+    anjay_get_notification_queue_usage(anjay, &count, &bytes);
+    AVS_UNIT_ASSERT_EQUAL(count, 1);
+    AVS_UNIT_ASSERT_TRUE(bytes > 0);
+
     // reactivate the server
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
     connection->conn_socket_ = socket14;
-    _anjay_observe_gc(anjay_unlocked);
-    ANJAY_MUTEX_UNLOCK(anjay);
-    assert_observe_consistency(anjay);
-    assert_observe_size(anjay, 2);
-    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
     _anjay_observe_sched_flush((anjay_connection_ref_t) {
         .server = anjay_unlocked->servers,
         .conn_type = ANJAY_CONNECTION_PRIMARY
     });
     ANJAY_MUTEX_UNLOCK(anjay);
 
-    const coap_test_msg_t *notify_response3 =
+    const coap_test_msg_t *notify_response =
             COAP_MSG(NON, CONTENT, ID_TOKEN(0x0000, "SuccsTkn"), OBSERVE(1),
-                     CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Rin"));
-    avs_unit_mocksock_expect_output(mocksocks[0], notify_response3->content,
-                                    notify_response3->length);
-
-    const coap_test_msg_t *notify_response4 =
-            COAP_MSG(NON, CONTENT, ID_TOKEN(0x0001, "SuccsTkn"), OBSERVE(2),
                      CONTENT_FORMAT(PLAINTEXT), PAYLOAD("Miku"));
-    avs_unit_mocksock_expect_output(mocksocks[0], notify_response4->content,
-                                    notify_response4->length);
+    avs_unit_mocksock_expect_output(mocksocks[0], notify_response->content,
+                                    notify_response->length);
     DM_TEST_EXPECT_READ_NULL_ATTRS(14, 69, 4);
     anjay_sched_run(anjay);
 
+    anjay_get_notification_queue_usage(anjay, &count, &bytes);
+    AVS_UNIT_ASSERT_EQUAL(count, 0);
+    AVS_UNIT_ASSERT_EQUAL(bytes, 0);
+
     DM_TEST_FINISH;
 }
 
@@ -1918,7 +3369,6 @@ AVS_UNIT_TEST(notify, no_storing_when_disabled) {
     // deactivate the first server
     socket14 = connection->conn_socket_;
     connection->conn_socket_ = NULL;
-    _anjay_observe_gc(anjay_unlocked);
     ANJAY_MUTEX_UNLOCK(anjay);
 
     assert_observe_consistency(anjay);
@@ -1991,7 +3441,6 @@ AVS_UNIT_TEST(notify, no_storing_when_disabled) {
     // reactivate the server
     ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
     connection->conn_socket_ = socket14;
-    _anjay_observe_gc(anjay_unlocked);
     ANJAY_MUTEX_UNLOCK(anjay);
     assert_observe_consistency(anjay);
     assert_observe_size(anjay, 2);
@@ -2283,3 +3732,257 @@ AVS_UNIT_TEST(notify, send_error) {
 
     DM_TEST_FINISH;
 }
+
+/**
+ * Makes server @p ssid operate in queue mode with a registration valid for a
+ * day, and returns the time of its next Update.
+ */
+static avs_time_real_t setup_wake_window(anjay_t *anjay_locked,
+                                         anjay_ssid_t ssid,
+                                         avs_time_duration_t wake_window) {
+    avs_time_real_t result = AVS_TIME_REAL_INVALID;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    anjay->queue_mode_wake_window = wake_window;
+    anjay_server_info_t *server = _anjay_servers_find(anjay, ssid);
+    AVS_UNIT_ASSERT_NOT_NULL(server);
+    server->registration_info.queue_mode = true;
+    server->registration_info.last_update_params.lifetime_s = 86400;
+    server->registration_info.expire_time =
+            avs_time_real_add(avs_time_real_now(),
+                              avs_time_duration_from_scalar(1, AVS_TIME_DAY));
+    result = _anjay_server_next_update_time(server);
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_before(avs_time_real_now(), result));
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+static avs_time_real_t time_after(avs_time_real_t time, int64_t seconds) {
+    return avs_time_real_add(
+            time, avs_time_duration_from_scalar(seconds, AVS_TIME_S));
+}
+
+AVS_UNIT_TEST(wake_window, pmax_trigger_aligned_with_update) {
+    DM_TEST_INIT_WITH_SSIDS(14);
+    const avs_time_real_t update_time = setup_wake_window(
+            anjay, 14, avs_time_duration_from_scalar(60, AVS_TIME_S));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_observe_connection_entry_t conn_state = {
+        .conn_ref = {
+            .server = _anjay_servers_find(anjay_unlocked, 14),
+            .conn_type = ANJAY_CONNECTION_PRIMARY
+        }
+    };
+    const avs_time_real_t now = avs_time_real_now();
+
+    // triggers due within the window after the Update are moved to it
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+            align_pmax_trigger_with_update(&conn_state,
+                                           time_after(update_time, 30), now),
+            update_time));
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+            align_pmax_trigger_with_update(&conn_state,
+                                           time_after(update_time, 60), now),
+            update_time));
+
+    // ...but not those due later, or before the Update
+    static const int64_t UNALIGNED_OFFSETS[] = { 61, 3600, 0, -1, -30 };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(UNALIGNED_OFFSETS); ++i) {
+        const avs_time_real_t trigger =
+                time_after(update_time, UNALIGNED_OFFSETS[i]);
+        AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+                align_pmax_trigger_with_update(&conn_state, trigger, now),
+                trigger));
+    }
+
+    // the alignment is only done for servers in queue mode
+    conn_state.conn_ref.server->registration_info.queue_mode = false;
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+            align_pmax_trigger_with_update(&conn_state,
+                                           time_after(update_time, 30), now),
+            time_after(update_time, 30)));
+    conn_state.conn_ref.server->registration_info.queue_mode = true;
+
+    // zero window disables the alignment
+    anjay_unlocked->queue_mode_wake_window = AVS_TIME_DURATION_ZERO;
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+            align_pmax_trigger_with_update(&conn_state,
+                                           time_after(update_time, 30), now),
+            time_after(update_time, 30)));
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(wake_window, pmax_expired_within_window) {
+    const anjay_dm_oi_attributes_t attrs = {
+        .min_period = 1,
+        .max_period = 60,
+        .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+        .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+    };
+    _anjay_mock_clock_start(avs_time_monotonic_from_scalar(1000, AVS_TIME_S));
+    anjay_observation_value_t value = {
+        .timestamp = time_after(avs_time_real_now(), -50)
+    };
+
+    AVS_UNIT_ASSERT_FALSE(
+            has_pmax_expired(&value, &attrs, AVS_TIME_DURATION_ZERO));
+    AVS_UNIT_ASSERT_FALSE(has_pmax_expired(
+            &value, &attrs, avs_time_duration_from_scalar(9, AVS_TIME_S)));
+    // the trigger might have been moved up to 10 seconds earlier
+    AVS_UNIT_ASSERT_TRUE(has_pmax_expired(
+            &value, &attrs, avs_time_duration_from_scalar(10, AVS_TIME_S)));
+
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(10, AVS_TIME_S));
+    AVS_UNIT_ASSERT_TRUE(
+            has_pmax_expired(&value, &attrs, AVS_TIME_DURATION_ZERO));
+
+    // no pmax, nothing to expire regardless of the window
+    const anjay_dm_oi_attributes_t no_pmax = {
+        .min_period = ANJAY_ATTRIB_INTEGER_NONE,
+        .max_period = ANJAY_ATTRIB_INTEGER_NONE,
+        .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+        .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+    };
+    AVS_UNIT_ASSERT_FALSE(has_pmax_expired(
+            &value, &no_pmax, avs_time_duration_from_scalar(1, AVS_TIME_DAY)));
+    _anjay_mock_clock_finish();
+}
+
+/**
+ * Establishes an observation of /42/69/4 with pmax due @p pmax_after_update
+ * seconds after the next Update, and checks whether its pmax trigger has been
+ * moved to the Update.
+ */
+static void wake_window_observe_test(avs_time_duration_t wake_window,
+                                     int64_t pmax_after_update,
+                                     bool expect_aligned) {
+    DM_TEST_INIT_WITH_SSIDS(14);
+    const avs_time_real_t update_time =
+            setup_wake_window(anjay, 14, wake_window);
+    const avs_time_real_t now = avs_time_real_now();
+
+    const anjay_dm_r_attributes_t attrs = {
+        .common = {
+            .min_period = 1,
+            .max_period = (int32_t) (avs_time_real_diff(update_time, now)
+                                             .seconds
+                                     + pmax_after_update),
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 514.0));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &attrs);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    assert_observe_size(anjay, 1);
+    assert_observe_consistency(anjay);
+
+    const avs_time_real_t expected_trigger =
+            expect_aligned ? update_time
+                           : time_after(now, attrs.common.max_period);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+            AVS_SORTED_SET_FIRST(
+                    anjay_unlocked->observe.connection_entries->observations)
+                    ->next_pmax_trigger,
+            expected_trigger));
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+            anjay_next_planned_pmax_notify_trigger(anjay, 14),
+            expected_trigger));
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(wake_window, observe_pmax_moved_to_update) {
+    const avs_time_duration_t window =
+            avs_time_duration_from_scalar(60, AVS_TIME_S);
+    wake_window_observe_test(window, 30, true);
+    wake_window_observe_test(window, 90, false);
+    wake_window_observe_test(AVS_TIME_DURATION_ZERO, 30, false);
+}
+
+#ifdef ANJAY_WITH_SEND
+static void wake_window_dummy_job(avs_sched_t *sched, const void *arg) {
+    (void) sched;
+    (void) arg;
+}
+#endif // ANJAY_WITH_SEND
+
+AVS_UNIT_TEST(wake_window, next_planned_wake_time) {
+    DM_TEST_INIT_WITH_SSIDS(14);
+    const avs_time_real_t update_time = setup_wake_window(
+            anjay, 14, avs_time_duration_from_scalar(60, AVS_TIME_S));
+
+    // only the Update is planned
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+            anjay_next_planned_wake_time(anjay, 14), update_time));
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+            anjay_next_planned_wake_time(anjay, ANJAY_SSID_ANY), update_time));
+
+    // a notification due earlier than the Update
+    static const anjay_dm_r_attributes_t ATTRS = {
+        .common = {
+            .min_period = 1,
+            .max_period = 3600,
+            .min_eval_period = ANJAY_ATTRIB_INTEGER_NONE,
+            .max_eval_period = ANJAY_ATTRIB_INTEGER_NONE
+        },
+        .greater_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .less_than = ANJAY_ATTRIB_DOUBLE_NONE,
+        .step = ANJAY_ATTRIB_DOUBLE_NONE
+    };
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID_TOKEN(0x69ED, "Res4"),
+                    OBSERVE(0), PATH("42", "69", "4"));
+    expect_read_res(anjay, &OBJ, 69, 4, ANJAY_MOCK_DM_FLOAT(0, 514.0));
+    expect_read_res_attrs(anjay, &OBJ, 14, 69, 4, &ATTRS);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT,
+                            ID_TOKEN(0x69ED, "Res4"), CONTENT_FORMAT(PLAINTEXT),
+                            OBSERVE(0), PAYLOAD("514"));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+
+    const avs_time_real_t notify_time =
+            anjay_next_planned_notify_trigger(anjay, 14);
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_before(notify_time, update_time));
+    AVS_UNIT_ASSERT_TRUE(avs_time_real_equal(
+            anjay_next_planned_wake_time(anjay, 14), notify_time));
+
+#ifdef ANJAY_WITH_SEND
+    // Send requests held back for coalescing are flushed even earlier
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_DELAYED(
+            anjay_unlocked->sched,
+            &anjay_unlocked->sender.coalescing_flush_handle,
+            avs_time_duration_diff(avs_time_real_diff(notify_time,
+                                                      avs_time_real_now()),
+                                   avs_time_duration_from_scalar(1,
+                                                                 AVS_TIME_S)),
+            wake_window_dummy_job, NULL, 0));
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_TRUE(
+            avs_time_real_equal(anjay_next_planned_wake_time(anjay, 14),
+                                time_after(notify_time, -1)));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    avs_sched_del(&anjay_unlocked->sender.coalescing_flush_handle);
+    ANJAY_MUTEX_UNLOCK(anjay);
+#endif // ANJAY_WITH_SEND
+
+    // the Bootstrap Server only cares about lifecycle operations
+    AVS_UNIT_ASSERT_FALSE(avs_time_real_valid(
+            anjay_next_planned_wake_time(anjay, ANJAY_SSID_BOOTSTRAP)));
+
+    DM_TEST_FINISH;
+}
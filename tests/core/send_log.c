@@ -0,0 +1,216 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+typedef struct {
+    char data[1024];
+    size_t size;
+    size_t discarded;
+} memory_log_t;
+
+static int memory_log_append(void *arg, const void *data, size_t length) {
+    memory_log_t *log = (memory_log_t *) arg;
+    if (length > sizeof(log->data) - log->size) {
+        return -1;
+    }
+    memcpy(log->data + log->size, data, length);
+    log->size += length;
+    return 0;
+}
+
+static int memory_log_read(void *arg,
+                           size_t offset,
+                           void *buf,
+                           size_t length,
+                           size_t *out_bytes_read) {
+    memory_log_t *log = (memory_log_t *) arg;
+    *out_bytes_read = 0;
+    if (offset < log->size) {
+        *out_bytes_read = AVS_MIN(length, log->size - offset);
+        memcpy(buf, log->data + offset, *out_bytes_read);
+    }
+    return 0;
+}
+
+static int memory_log_discard(void *arg, size_t length) {
+    memory_log_t *log = (memory_log_t *) arg;
+    AVS_UNIT_ASSERT_TRUE(length <= log->size);
+    memmove(log->data, log->data + length, log->size - length);
+    log->size -= length;
+    log->discarded += length;
+    return 0;
+}
+
+static const anjay_send_log_handlers_t MEMORY_LOG_HANDLERS = {
+    .append = memory_log_append,
+    .read = memory_log_read,
+    .discard = memory_log_discard
+};
+
+typedef struct {
+    anjay_ssid_t ssids[8];
+    anjay_send_log_record_t records[8];
+    size_t record_count;
+    uint32_t discarded_ids[8];
+    size_t discarded_count;
+} scan_result_t;
+
+static int restore_clb(void *arg,
+                       anjay_ssid_t ssid,
+                       const anjay_send_log_record_t *record) {
+    scan_result_t *result = (scan_result_t *) arg;
+    AVS_UNIT_ASSERT_TRUE(result->record_count
+                         < AVS_ARRAY_SIZE(result->records));
+    result->ssids[result->record_count] = ssid;
+    result->records[result->record_count++] = *record;
+    return 0;
+}
+
+static void discard_clb(void *arg, uint32_t id) {
+    scan_result_t *result = (scan_result_t *) arg;
+    AVS_UNIT_ASSERT_TRUE(result->discarded_count
+                         < AVS_ARRAY_SIZE(result->discarded_ids));
+    result->discarded_ids[result->discarded_count++] = id;
+}
+
+static anjay_batch_t *make_batch(int64_t value) {
+    anjay_batch_builder_t *builder = _anjay_batch_builder_new();
+    AVS_UNIT_ASSERT_NOT_NULL(builder);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_int(
+            builder, &MAKE_RESOURCE_PATH(3, 0, 9),
+            avs_time_real_from_scalar(1234, AVS_TIME_S), value));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_batch_add_string(
+            builder, &MAKE_RESOURCE_PATH(3, 0, 0), AVS_TIME_REAL_INVALID,
+            "manufacturer"));
+    anjay_batch_t *batch = _anjay_batch_builder_compile(&builder);
+    AVS_UNIT_ASSERT_NOT_NULL(batch);
+    return batch;
+}
+
+AVS_UNIT_TEST(send_log, append_and_reopen) {
+    memory_log_t storage = { 0 };
+    anjay_send_log_t log;
+    scan_result_t scan = { 0 };
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_send_log_open(&log, &MEMORY_LOG_HANDLERS, &storage,
+                                 restore_clb, discard_clb, &scan));
+    AVS_UNIT_ASSERT_EQUAL(scan.record_count, 0);
+
+    anjay_batch_t *first = make_batch(42);
+    anjay_batch_t *second = make_batch(514);
+    anjay_send_log_record_t first_record;
+    anjay_send_log_record_t second_record;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_send_log_append(&log, 1, first, &first_record));
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_send_log_append(&log, 2, second, &second_record));
+    AVS_UNIT_ASSERT_NOT_EQUAL(first_record.id, second_record.id);
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_send_log_mark_discarded(&log, &first_record));
+
+    anjay_send_log_t reopened;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_send_log_open(&reopened, &MEMORY_LOG_HANDLERS, &storage,
+                                 restore_clb, discard_clb, &scan));
+    AVS_UNIT_ASSERT_EQUAL(scan.record_count, 2);
+    AVS_UNIT_ASSERT_EQUAL(scan.ssids[0], 1);
+    AVS_UNIT_ASSERT_EQUAL(scan.ssids[1], 2);
+    AVS_UNIT_ASSERT_EQUAL(scan.records[1].id, second_record.id);
+    AVS_UNIT_ASSERT_EQUAL(scan.records[1].offset, second_record.offset);
+    AVS_UNIT_ASSERT_EQUAL(scan.discarded_count, 1);
+    AVS_UNIT_ASSERT_EQUAL(scan.discarded_ids[0], first_record.id);
+    AVS_UNIT_ASSERT_EQUAL(reopened.next_id, log.next_id);
+    AVS_UNIT_ASSERT_EQUAL(reopened.end_offset, storage.size);
+
+    anjay_batch_t *restored = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_send_log_read(&reopened, &scan.records[1], &restored));
+    AVS_UNIT_ASSERT_TRUE(_anjay_batch_values_equal(restored, second));
+    AVS_UNIT_ASSERT_TRUE(_anjay_batch_paths_equal(restored, second));
+
+    // wrong ID at a valid offset
+    anjay_send_log_record_t bogus_record = scan.records[1];
+    ++bogus_record.id;
+    anjay_batch_t *bogus = NULL;
+    AVS_UNIT_ASSERT_FAILED(
+            _anjay_send_log_read(&reopened, &bogus_record, &bogus));
+    AVS_UNIT_ASSERT_NULL(bogus);
+
+    _anjay_batch_release(&restored);
+    _anjay_batch_release(&first);
+    _anjay_batch_release(&second);
+}
+
+AVS_UNIT_TEST(send_log, compact) {
+    memory_log_t storage = { 0 };
+    anjay_send_log_t log;
+    scan_result_t scan = { 0 };
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_send_log_open(&log, &MEMORY_LOG_HANDLERS, &storage,
+                                 restore_clb, discard_clb, &scan));
+
+    anjay_batch_t *batch = make_batch(42);
+    anjay_send_log_record_t records[3];
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(records); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_send_log_append(&log, 1, batch, &records[i]));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_send_log_mark_discarded(&log, &records[0]));
+
+    // dead prefix is smaller than the rest of the log, so it is kept
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_send_log_compact(&log, &records[1].offset));
+    AVS_UNIT_ASSERT_EQUAL(storage.discarded, 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_send_log_mark_discarded(&log, &records[1]));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_send_log_compact(&log, &records[2].offset));
+    AVS_UNIT_ASSERT_EQUAL(storage.discarded, records[2].offset);
+
+    // offsets of the remaining records are still valid
+    anjay_batch_t *restored = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_send_log_read(&log, &records[2], &restored));
+    AVS_UNIT_ASSERT_TRUE(_anjay_batch_values_equal(restored, batch));
+    _anjay_batch_release(&restored);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_send_log_mark_discarded(&log, &records[2]));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_send_log_compact(&log, NULL));
+    AVS_UNIT_ASSERT_EQUAL(storage.size, 0);
+
+    // log is reopened as empty, but IDs are not reused within the run
+    anjay_send_log_record_t next_record;
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_send_log_append(&log, 1, batch, &next_record));
+    AVS_UNIT_ASSERT_EQUAL(next_record.id, records[2].id + 1);
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_send_log_read(&log, &next_record, &restored));
+    _anjay_batch_release(&restored);
+    _anjay_batch_release(&batch);
+}
+
+AVS_UNIT_TEST(send_log, truncated_log) {
+    memory_log_t storage = { 0 };
+    anjay_send_log_t log;
+    scan_result_t scan = { 0 };
+    AVS_UNIT_ASSERT_SUCCESS(
+            _anjay_send_log_open(&log, &MEMORY_LOG_HANDLERS, &storage,
+                                 restore_clb, discard_clb, &scan));
+    anjay_batch_t *batch = make_batch(42);
+    anjay_send_log_record_t record;
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_send_log_append(&log, 1, batch, &record));
+    _anjay_batch_release(&batch);
+
+    --storage.size;
+    anjay_send_log_t reopened = { 0 };
+    AVS_UNIT_ASSERT_FAILED(
+            _anjay_send_log_open(&reopened, &MEMORY_LOG_HANDLERS, &storage,
+                                 restore_clb, discard_clb, &scan));
+    AVS_UNIT_ASSERT_FALSE(_anjay_send_log_enabled(&reopened));
+}
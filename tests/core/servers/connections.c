@@ -0,0 +1,155 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "tests/utils/dm.h"
+
+static anjay_server_connection_t *
+primary_connection(anjay_unlocked_t *anjay) {
+    // the tests below only use a single server
+    AVS_UNIT_ASSERT_NOT_NULL(anjay->servers);
+    anjay_server_connection_t *connection =
+            _anjay_get_server_connection((const anjay_connection_ref_t) {
+                .server = anjay->servers,
+                .conn_type = ANJAY_CONNECTION_PRIMARY
+            });
+    AVS_UNIT_ASSERT_NOT_NULL(connection);
+    return connection;
+}
+
+static void fill_security_cache(anjay_unlocked_t *anjay,
+                                anjay_server_connection_t *connection,
+                                const anjay_connection_info_t *info) {
+    connection->security_cache.valid = true;
+    connection->security_cache.generation = anjay->security_generation;
+    connection->security_cache.security_iid = info->security_iid;
+    connection->security_cache.transport_info = info->transport_info;
+    connection->security_cache.is_encrypted = true;
+}
+
+AVS_UNIT_TEST(security_cache, reused_until_security_changes) {
+    DM_TEST_INIT_WITH_SSIDS(14);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_server_connection_t *connection = primary_connection(anjay_unlocked);
+    anjay_connection_info_t info = {
+        .ssid = 14,
+        .security_iid = 14
+    };
+
+    // FAKE_SECURITY does not provide the Security Mode resource, so reading
+    // the configuration from the data model always fails - the calls below
+    // only succeed if they do not need to do that
+    fill_security_cache(anjay_unlocked, connection, &info);
+    AVS_UNIT_ASSERT_SUCCESS(
+            ensure_security_config(anjay_unlocked, connection, &info));
+    AVS_UNIT_ASSERT_TRUE(info.is_encrypted);
+    AVS_UNIT_ASSERT_SUCCESS(
+            ensure_security_config(anjay_unlocked, connection, &info));
+    AVS_UNIT_ASSERT_TRUE(connection->security_cache.valid);
+
+    // Security object changed, as processed by the notify machinery
+    ++anjay_unlocked->security_generation;
+    AVS_UNIT_ASSERT_FAILED(
+            ensure_security_config(anjay_unlocked, connection, &info));
+    AVS_UNIT_ASSERT_FALSE(connection->security_cache.valid);
+
+    // different Security instance
+    fill_security_cache(anjay_unlocked, connection, &info);
+    info.security_iid = 15;
+    AVS_UNIT_ASSERT_FAILED(
+            ensure_security_config(anjay_unlocked, connection, &info));
+    AVS_UNIT_ASSERT_FALSE(connection->security_cache.valid);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_FINISH;
+}
+
+#ifdef ANJAY_WITH_DTLS_SESSION_PERSISTENCE
+#    define SESSION_DATA "\x01\x02\x00\x03"
+
+static void set_session(anjay_server_connection_t *connection,
+                        const char *data,
+                        size_t size) {
+    _anjay_connection_internal_invalidate_session(connection);
+    memcpy(connection->nontransient_state.dtls_session_buffer, data, size);
+}
+
+AVS_UNIT_TEST(dtls_sessions, persist_restore) {
+    DM_TEST_INIT_WITH_SSIDS(14);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_server_connection_t *connection = primary_connection(anjay_unlocked);
+    set_session(connection, SESSION_DATA, sizeof(SESSION_DATA) - 1);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(membuf);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_dtls_sessions_persist(anjay, membuf));
+
+    // simulate a reboot, after which nothing is cached in RAM
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    _anjay_connection_internal_invalidate_session(connection);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_dtls_sessions_restore(anjay, membuf));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    const anjay_dtls_session_restored_t *restored =
+            anjay_unlocked->dtls_sessions_restored;
+    AVS_UNIT_ASSERT_NOT_NULL(restored);
+    AVS_UNIT_ASSERT_NULL(AVS_LIST_NEXT(restored));
+    AVS_UNIT_ASSERT_EQUAL(restored->ssid, 14);
+    AVS_UNIT_ASSERT_EQUAL(restored->conn_type, ANJAY_CONNECTION_PRIMARY);
+    AVS_UNIT_ASSERT_EQUAL(restored->session_size, sizeof(SESSION_DATA) - 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(restored->session, SESSION_DATA,
+                                      sizeof(SESSION_DATA) - 1);
+
+    // the session is moved into the connection when its socket is recreated
+    apply_restored_dtls_session(anjay_unlocked, 14, ANJAY_CONNECTION_PRIMARY,
+                                connection);
+    AVS_UNIT_ASSERT_NULL(anjay_unlocked->dtls_sessions_restored);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            connection->nontransient_state.dtls_session_buffer, SESSION_DATA,
+            sizeof(SESSION_DATA) - 1);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    // malformed snapshot is rejected
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(membuf, "XYZ", 4));
+    AVS_UNIT_ASSERT_FAILED(anjay_dtls_sessions_restore(anjay, membuf));
+    avs_stream_cleanup(&membuf);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(dtls_sessions, session_in_ram_takes_precedence) {
+    DM_TEST_INIT_WITH_SSIDS(14);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_server_connection_t *connection = primary_connection(anjay_unlocked);
+    set_session(connection, SESSION_DATA, sizeof(SESSION_DATA) - 1);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    avs_stream_t *membuf = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(membuf);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_dtls_sessions_persist(anjay, membuf));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_dtls_sessions_restore(anjay, membuf));
+    avs_stream_cleanup(&membuf);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay_unlocked->dtls_sessions_restored);
+    set_session(connection, "newer", 5);
+    apply_restored_dtls_session(anjay_unlocked, 14, ANJAY_CONNECTION_PRIMARY,
+                                connection);
+    // the restored entry is discarded without being used
+    AVS_UNIT_ASSERT_NULL(anjay_unlocked->dtls_sessions_restored);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(
+            connection->nontransient_state.dtls_session_buffer, "newer", 5);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_DTLS_SESSION_PERSISTENCE
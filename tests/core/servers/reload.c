@@ -0,0 +1,74 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+static anjay_server_info_t *
+reload_test_add_server(anjay_unlocked_t *anjay,
+                       AVS_LIST(anjay_server_info_t) *servers,
+                       anjay_ssid_t ssid,
+                       bool session_cached) {
+    AVS_LIST(anjay_server_info_t) server =
+            AVS_LIST_NEW_ELEMENT(anjay_server_info_t);
+    AVS_UNIT_ASSERT_NOT_NULL(server);
+    server->anjay = anjay;
+    server->ssid = ssid;
+    server->reactivate_time = avs_time_real_now();
+    if (session_cached) {
+        anjay_server_connection_t *connection =
+                _anjay_connection_get(&server->connections,
+                                      ANJAY_CONNECTION_PRIMARY);
+        connection->nontransient_state.dtls_session_buffer[0] = 1;
+    }
+    AVS_LIST_APPEND(servers, server);
+    return server;
+}
+
+static void reload_test_cleanup(AVS_LIST(anjay_server_info_t) *servers) {
+    AVS_LIST_CLEAR(servers) {
+        avs_sched_del(&(*servers)->next_action_handle);
+    }
+}
+
+AVS_UNIT_TEST(reload, servers_with_cached_session_activated_first) {
+    const anjay_configuration_t config = {
+        .endpoint_name = "test"
+    };
+    anjay_t *anjay = anjay_new(&config);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_LIST(anjay_server_info_t) servers = NULL;
+    anjay_server_info_t *full_handshake =
+            reload_test_add_server(anjay_unlocked, &servers, 1, false);
+    anjay_server_info_t *resumed =
+            reload_test_add_server(anjay_unlocked, &servers, 2, true);
+    AVS_UNIT_ASSERT_FALSE(
+            _anjay_connections_has_cached_session(full_handshake));
+    AVS_UNIT_ASSERT_TRUE(_anjay_connections_has_cached_session(resumed));
+
+    reload_servers_state_t state = {
+        .deferred_activations = NULL
+    };
+    AVS_UNIT_ASSERT_SUCCESS(sched_activate(&state, full_handshake));
+    AVS_UNIT_ASSERT_SUCCESS(sched_activate(&state, resumed));
+    AVS_UNIT_ASSERT_NULL(full_handshake->next_action_handle);
+    AVS_UNIT_ASSERT_NOT_NULL(resumed->next_action_handle);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(state.deferred_activations), 1);
+    AVS_UNIT_ASSERT_TRUE(*state.deferred_activations == full_handshake);
+
+    AVS_UNIT_ASSERT_SUCCESS(sched_deferred_activations(&state));
+    AVS_UNIT_ASSERT_NULL(state.deferred_activations);
+    AVS_UNIT_ASSERT_NOT_NULL(full_handshake->next_action_handle);
+    AVS_UNIT_ASSERT_EQUAL(full_handshake->next_action,
+                          ANJAY_SERVER_NEXT_ACTION_REFRESH);
+
+    reload_test_cleanup(&servers);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    anjay_delete(anjay);
+}
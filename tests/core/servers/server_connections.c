@@ -0,0 +1,228 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "tests/utils/dm.h"
+
+static anjay_connection_ref_t primary_connection_ref(anjay_unlocked_t *anjay) {
+    // the tests below only use a single server
+    AVS_UNIT_ASSERT_NOT_NULL(anjay->servers);
+    anjay_connection_ref_t ref = {
+        .server = anjay->servers,
+        .conn_type = ANJAY_CONNECTION_PRIMARY
+    };
+    AVS_UNIT_ASSERT_NOT_NULL(_anjay_get_server_connection(ref));
+    return ref;
+}
+
+#ifndef ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
+static void assert_duration_equal(avs_time_duration_t actual,
+                                  avs_time_duration_t expected) {
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_equal(actual, expected));
+}
+
+AVS_UNIT_TEST(queue_mode_adaptive_close, learns_request_delay) {
+    DM_TEST_INIT_WITH_SSIDS(14);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_connection_ref_t ref = primary_connection_ref(anjay_unlocked);
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    anjay_server_connection_nontransient_state_t *state =
+            &connection->nontransient_state;
+    ref.server->registration_info.queue_mode = true;
+
+    // without the option enabled, nothing is learned
+    _anjay_connection_schedule_queue_mode_close(ref);
+    AVS_UNIT_ASSERT_NOT_NULL(connection->queue_mode_close_socket_clb);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(3, AVS_TIME_S));
+    _anjay_connection_queue_mode_request_received(ref);
+    assert_duration_equal(state->queue_mode_request_delay,
+                          AVS_TIME_DURATION_ZERO);
+
+    // the delay is measured since the end of the last interaction
+    anjay_unlocked->queue_mode_adaptive_close = true;
+    _anjay_connection_schedule_queue_mode_close(ref);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    _anjay_connection_queue_mode_request_received(ref);
+    assert_duration_equal(state->queue_mode_request_delay,
+                          avs_time_duration_from_scalar(5, AVS_TIME_S));
+
+    // only the longest delay is kept
+    _anjay_connection_schedule_queue_mode_close(ref);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+    _anjay_connection_queue_mode_request_received(ref);
+    assert_duration_equal(state->queue_mode_request_delay,
+                          avs_time_duration_from_scalar(5, AVS_TIME_S));
+
+    // requests outside of a queue mode window are not measured
+    avs_sched_del(&connection->queue_mode_close_socket_clb);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(60, AVS_TIME_S));
+    _anjay_connection_queue_mode_request_received(ref);
+    assert_duration_equal(state->queue_mode_request_delay,
+                          avs_time_duration_from_scalar(5, AVS_TIME_S));
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(queue_mode_adaptive_close, close_delay) {
+    DM_TEST_INIT_WITH_SSIDS(14);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_server_connection_t *connection = _anjay_get_server_connection(
+            primary_connection_ref(anjay_unlocked));
+    anjay_server_connection_nontransient_state_t *state =
+            &connection->nontransient_state;
+    const avs_time_duration_t max_delay =
+            _anjay_max_transmit_wait_for_transport(anjay_unlocked,
+                                                   connection->transport);
+    anjay_unlocked->queue_mode_adaptive_close = true;
+    state->queue_mode_request_delay =
+            avs_time_duration_from_scalar(8, AVS_TIME_S);
+
+    // learning windows
+    for (unsigned i = 0; i < QUEUE_MODE_LEARNING_WINDOWS; ++i) {
+        assert_duration_equal(queue_mode_close_delay(anjay_unlocked,
+                                                     connection),
+                              max_delay);
+        queue_mode_window_finished(connection);
+    }
+    AVS_UNIT_ASSERT_EQUAL(state->queue_mode_windows,
+                          QUEUE_MODE_LEARNING_WINDOWS);
+    // the estimate decays by 1/8 with each window
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_less(
+            state->queue_mode_request_delay,
+            avs_time_duration_from_scalar(8, AVS_TIME_S)));
+
+    state->queue_mode_request_delay =
+            avs_time_duration_from_scalar(8, AVS_TIME_S);
+    assert_duration_equal(queue_mode_close_delay(anjay_unlocked, connection),
+                          avs_time_duration_from_scalar(16, AVS_TIME_S));
+
+    // lower bound
+    state->queue_mode_request_delay =
+            avs_time_duration_from_scalar(100, AVS_TIME_MS);
+    assert_duration_equal(queue_mode_close_delay(anjay_unlocked, connection),
+                          avs_time_duration_from_scalar(
+                                  QUEUE_MODE_MIN_CLOSE_DELAY_S, AVS_TIME_S));
+
+    // upper bound
+    state->queue_mode_request_delay = max_delay;
+    assert_duration_equal(queue_mode_close_delay(anjay_unlocked, connection),
+                          max_delay);
+
+    // probing windows
+    state->queue_mode_request_delay =
+            avs_time_duration_from_scalar(8, AVS_TIME_S);
+    state->queue_mode_windows = QUEUE_MODE_PROBING_PERIOD;
+    assert_duration_equal(queue_mode_close_delay(anjay_unlocked, connection),
+                          max_delay);
+    queue_mode_window_finished(connection);
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_less(
+            queue_mode_close_delay(anjay_unlocked, connection), max_delay));
+
+    // the option disabled
+    anjay_unlocked->queue_mode_adaptive_close = false;
+    assert_duration_equal(queue_mode_close_delay(anjay_unlocked, connection),
+                          max_delay);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITHOUT_QUEUE_MODE_AUTOCLOSE
+
+#ifdef WITH_AVS_COAP_UDP
+static const avs_error_t NAT_TEST_TIMEOUT = {
+    .category = AVS_COAP_ERR_CATEGORY,
+    .code = AVS_COAP_ERR_TIMEOUT
+};
+
+static void assert_nat_lifetime(anjay_server_connection_t *connection,
+                                int64_t expected_s) {
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_equal(
+            connection->nontransient_state.udp_nat_binding_lifetime,
+            avs_time_duration_from_scalar(expected_s, AVS_TIME_S)));
+}
+
+static void advance_seconds(int64_t seconds) {
+    _anjay_mock_clock_advance(
+            avs_time_duration_from_scalar(seconds, AVS_TIME_S));
+}
+
+AVS_UNIT_TEST(udp_nat_keepalive, binding_lifetime_estimate) {
+    DM_TEST_INIT_WITH_SSIDS(14);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_connection_ref_t ref = primary_connection_ref(anjay_unlocked);
+    anjay_server_connection_t *connection = _anjay_get_server_connection(ref);
+    anjay_unlocked->udp_nat_keepalive = true;
+    ref.server->registration_info.last_update_params.lifetime_s = 86400;
+    // state of a freshly created socket
+    connection->udp_nat.last_activity = AVS_TIME_MONOTONIC_INVALID;
+    connection->udp_nat.request_idle_time = AVS_TIME_DURATION_INVALID;
+
+    // nothing known yet
+    AVS_UNIT_ASSERT_FALSE(avs_time_monotonic_valid(
+            _anjay_connection_udp_nat_keepalive_deadline(ref)));
+    udp_nat_exchange_succeeded(ref, connection);
+    const avs_time_monotonic_t exchange_time = avs_time_monotonic_now();
+
+    // a request timing out after 120 s of inactivity lowers the estimate to
+    // 3/4 of that
+    advance_seconds(120);
+    _anjay_connection_udp_nat_request_sent(ref);
+    _anjay_connection_udp_nat_request_failed(ref, NAT_TEST_TIMEOUT);
+    assert_nat_lifetime(connection, 90);
+    AVS_UNIT_ASSERT_TRUE(avs_time_monotonic_equal(
+            _anjay_connection_udp_nat_keepalive_deadline(ref),
+            avs_time_monotonic_add(
+                    exchange_time,
+                    avs_time_duration_from_scalar(90, AVS_TIME_S))));
+
+    // errors other than timeouts do not say anything about the NAT
+    _anjay_connection_udp_nat_request_sent(ref);
+    _anjay_connection_udp_nat_request_failed(ref, avs_errno(AVS_ECONNRESET));
+    assert_nat_lifetime(connection, 90);
+
+    // a request from the server after 100 s of inactivity raises it
+    udp_nat_exchange_succeeded(ref, connection);
+    advance_seconds(100);
+    _anjay_connection_udp_nat_request_received(ref);
+    assert_nat_lifetime(connection, 100);
+
+    // it also grows by 1/4 after a series of successful exchanges
+    for (unsigned i = 1; i < UDP_NAT_EXCHANGES_BEFORE_PROBING; ++i) {
+        udp_nat_exchange_succeeded(ref, connection);
+    }
+    assert_nat_lifetime(connection, 100);
+    udp_nat_exchange_succeeded(ref, connection);
+    assert_nat_lifetime(connection, 125);
+
+    // lower bound
+    advance_seconds(10);
+    _anjay_connection_udp_nat_request_sent(ref);
+    _anjay_connection_udp_nat_request_failed(ref, NAT_TEST_TIMEOUT);
+    assert_nat_lifetime(connection, UDP_NAT_MIN_BINDING_LIFETIME_S);
+
+    // not measured in queue mode
+    ref.server->registration_info.queue_mode = true;
+    AVS_UNIT_ASSERT_FALSE(avs_time_monotonic_valid(
+            _anjay_connection_udp_nat_keepalive_deadline(ref)));
+    ref.server->registration_info.queue_mode = false;
+
+    // dropped once the Lifetime is shorter anyway
+    ref.server->registration_info.last_update_params.lifetime_s = 60;
+    advance_seconds(100);
+    _anjay_connection_udp_nat_request_received(ref);
+    assert_nat_lifetime(connection, 0);
+    AVS_UNIT_ASSERT_FALSE(avs_time_monotonic_valid(
+            _anjay_connection_udp_nat_keepalive_deadline(ref)));
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    DM_TEST_FINISH;
+}
+#endif // WITH_AVS_COAP_UDP
@@ -0,0 +1,290 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_mocksock.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "tests/utils/coap/socket.h"
+
+static anjay_unlocked_t *index_test_anjay(void) {
+    anjay_unlocked_t *anjay =
+            (anjay_unlocked_t *) avs_calloc(1, sizeof(anjay_unlocked_t));
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    return anjay;
+}
+
+static anjay_server_connection_t *
+index_test_primary_connection(anjay_server_info_t *server) {
+    anjay_server_connection_t *connection =
+            _anjay_get_server_connection((const anjay_connection_ref_t) {
+                .server = server,
+                .conn_type = ANJAY_CONNECTION_PRIMARY
+            });
+    AVS_UNIT_ASSERT_NOT_NULL(connection);
+    return connection;
+}
+
+static avs_net_socket_t *index_test_socket(bool connected) {
+    avs_net_socket_t *socket = NULL;
+    _anjay_mocksock_create(&socket, 1252, 1252);
+    if (connected) {
+        avs_unit_mocksock_expect_connect(socket, "", "");
+        AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_connect(socket, "", ""));
+    }
+    avs_unit_mocksock_enable_state_getopt(socket);
+    return socket;
+}
+
+/**
+ * Adds a server with an online primary socket, keeping anjay->servers sorted
+ * by SSID, as the rest of the code does.
+ */
+static anjay_server_info_t *index_test_add_server(anjay_unlocked_t *anjay,
+                                                  anjay_ssid_t ssid,
+                                                  anjay_iid_t security_iid) {
+    AVS_LIST(anjay_server_info_t) *insert_ptr =
+            _anjay_servers_find_insert_ptr(&anjay->servers, ssid);
+    AVS_UNIT_ASSERT_NOT_NULL(AVS_LIST_INSERT_NEW(anjay_server_info_t,
+                                                 insert_ptr));
+    anjay_server_info_t *server = *insert_ptr;
+    server->anjay = anjay;
+    server->ssid = ssid;
+    server->last_used_security_iid = security_iid;
+    index_test_primary_connection(server)->conn_socket_ =
+            index_test_socket(true);
+    _anjay_servers_changed(anjay);
+    return server;
+}
+
+static void index_test_replace_socket(anjay_server_info_t *server,
+                                      avs_net_socket_t *socket) {
+    anjay_server_connection_t *connection =
+            index_test_primary_connection(server);
+    avs_net_socket_cleanup(&connection->conn_socket_);
+    connection->conn_socket_ = socket;
+}
+
+static void index_test_remove_server(anjay_unlocked_t *anjay,
+                                     anjay_ssid_t ssid) {
+    AVS_LIST(anjay_server_info_t) *server_ptr =
+            _anjay_servers_find_ptr(&anjay->servers, ssid);
+    AVS_UNIT_ASSERT_NOT_NULL(server_ptr);
+    index_test_replace_socket(*server_ptr, NULL);
+    AVS_LIST_DELETE(server_ptr);
+    _anjay_servers_changed(anjay);
+}
+
+static void index_test_finish(anjay_unlocked_t *anjay) {
+    while (anjay->servers) {
+        index_test_remove_server(anjay, anjay->servers->ssid);
+    }
+    servers_index_cleanup(&anjay->servers_index);
+    avs_free(anjay);
+}
+
+static avs_net_socket_t *index_test_socket_of(anjay_server_info_t *server) {
+    return index_test_primary_connection(server)->conn_socket_;
+}
+
+AVS_UNIT_TEST(servers_index, find_by_ssid) {
+    anjay_unlocked_t *anjay = index_test_anjay();
+    AVS_UNIT_ASSERT_NULL(_anjay_servers_find(anjay, 1));
+
+    anjay_server_info_t *server5 = index_test_add_server(anjay, 5, 1);
+    anjay_server_info_t *server1 = index_test_add_server(anjay, 1, 2);
+    anjay_server_info_t *server9 = index_test_add_server(anjay, 9, 3);
+
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find(anjay, 1) == server1);
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find(anjay, 5) == server5);
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find(anjay, 9) == server9);
+    AVS_UNIT_ASSERT_NULL(_anjay_servers_find(anjay, 0));
+    AVS_UNIT_ASSERT_NULL(_anjay_servers_find(anjay, 3));
+    AVS_UNIT_ASSERT_NULL(_anjay_servers_find(anjay, 10));
+    AVS_UNIT_ASSERT_TRUE(anjay->servers_index.valid);
+    AVS_UNIT_ASSERT_EQUAL(anjay->servers_index.servers_count, 3);
+
+    // the index is rebuilt after the server list changes
+    anjay_server_info_t *server3 = index_test_add_server(anjay, 3, 4);
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find(anjay, 3) == server3);
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find(anjay, 9) == server9);
+    index_test_remove_server(anjay, 5);
+    AVS_UNIT_ASSERT_NULL(_anjay_servers_find(anjay, 5));
+    AVS_UNIT_ASSERT_EQUAL(anjay->servers_index.servers_count, 3);
+
+    // inactive servers are still found, but not by *_find_active()
+    index_test_replace_socket(server1, NULL);
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find(anjay, 1) == server1);
+    AVS_UNIT_ASSERT_NULL(_anjay_servers_find_active(anjay, 1));
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find_active(anjay, 3) == server3);
+
+    index_test_finish(anjay);
+}
+
+AVS_UNIT_TEST(servers_index, find_by_security_iid) {
+    anjay_unlocked_t *anjay = index_test_anjay();
+    anjay_server_info_t *server1 = index_test_add_server(anjay, 1, 7);
+    anjay_server_info_t *server2 = index_test_add_server(anjay, 2, 4);
+    anjay_server_info_t *server3 = index_test_add_server(anjay, 3, 7);
+
+    AVS_UNIT_ASSERT_TRUE(
+            _anjay_servers_find_active_by_security_iid(anjay, 4) == server2);
+    AVS_UNIT_ASSERT_NULL(_anjay_servers_find_active_by_security_iid(anjay, 5));
+    AVS_UNIT_ASSERT_NULL(_anjay_servers_find_active_by_security_iid(
+            anjay, ANJAY_ID_INVALID));
+
+    // two servers share the Security IID: the one with the lower SSID wins
+    AVS_UNIT_ASSERT_TRUE(
+            _anjay_servers_find_active_by_security_iid(anjay, 7) == server1);
+
+    // server 1 is being deactivated, so the other one is found even though
+    // the index is not rebuilt
+    const size_t servers_version = anjay->servers_version;
+    index_test_replace_socket(server1, NULL);
+    AVS_UNIT_ASSERT_TRUE(
+            _anjay_servers_find_active_by_security_iid(anjay, 7) == server3);
+    AVS_UNIT_ASSERT_EQUAL(anjay->servers_version, servers_version);
+
+    index_test_replace_socket(server3, NULL);
+    AVS_UNIT_ASSERT_NULL(_anjay_servers_find_active_by_security_iid(anjay, 7));
+
+    // Security IID of a server changes when it connects using another instance
+    server2->last_used_security_iid = 7;
+    _anjay_servers_changed(anjay);
+    AVS_UNIT_ASSERT_TRUE(
+            _anjay_servers_find_active_by_security_iid(anjay, 7) == server2);
+    AVS_UNIT_ASSERT_NULL(_anjay_servers_find_active_by_security_iid(anjay, 4));
+
+    index_test_finish(anjay);
+}
+
+AVS_UNIT_TEST(servers_index, find_by_primary_socket) {
+    anjay_unlocked_t *anjay = index_test_anjay();
+    anjay_server_info_t *server1 = index_test_add_server(anjay, 1, 1);
+    anjay_server_info_t *server2 = index_test_add_server(anjay, 2, 2);
+    avs_net_socket_t *socket1 = index_test_socket_of(server1);
+    avs_net_socket_t *socket2 = index_test_socket_of(server2);
+
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find_by_primary_socket(anjay, socket1)
+                         == server1);
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find_by_primary_socket(anjay, socket2)
+                         == server2);
+    avs_net_socket_t *unrelated = index_test_socket(true);
+    AVS_UNIT_ASSERT_NULL(
+            _anjay_servers_find_by_primary_socket(anjay, unrelated));
+
+    // the socket is recreated, e.g. during reconnection
+    avs_net_socket_t *recreated = index_test_socket(true);
+    index_test_replace_socket(server2, recreated);
+    _anjay_socket_set_changed(anjay);
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find_by_primary_socket(anjay, recreated)
+                         == server2);
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find_by_primary_socket(anjay, socket1)
+                         == server1);
+
+    // a socket that is not online is not associated with the server
+    avs_net_socket_t *offline = index_test_socket(false);
+    index_test_replace_socket(server1, offline);
+    _anjay_socket_set_changed(anjay);
+    AVS_UNIT_ASSERT_NULL(_anjay_servers_find_by_primary_socket(anjay, offline));
+
+    // reload: server 2 is replaced with a new instance using the same socket
+    index_test_primary_connection(server2)->conn_socket_ = NULL;
+    index_test_remove_server(anjay, 2);
+    anjay_server_info_t *reloaded = index_test_add_server(anjay, 2, 2);
+    index_test_replace_socket(reloaded, recreated);
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find_by_primary_socket(anjay, recreated)
+                         == reloaded);
+    AVS_UNIT_ASSERT_TRUE(_anjay_servers_find(anjay, 2) == reloaded);
+
+    avs_net_socket_cleanup(&unrelated);
+    index_test_finish(anjay);
+}
+
+static size_t INDEX_TEST_REALLOC_CALLS;
+static size_t INDEX_TEST_REALLOC_FAIL_AT;
+
+static void *index_test_failing_realloc(void *ptr, size_t size) {
+    if (++INDEX_TEST_REALLOC_CALLS >= INDEX_TEST_REALLOC_FAIL_AT) {
+        return NULL;
+    }
+    AVS_UNIT_MOCK(avs_realloc) = NULL;
+    void *result = avs_realloc(ptr, size);
+    AVS_UNIT_MOCK(avs_realloc) = index_test_failing_realloc;
+    return result;
+}
+
+AVS_UNIT_TEST(servers_index, out_of_memory_fallback) {
+    // each of the three index arrays fails to grow in turn, and so does every
+    // allocation after that
+    for (INDEX_TEST_REALLOC_FAIL_AT = 1; INDEX_TEST_REALLOC_FAIL_AT <= 3;
+         ++INDEX_TEST_REALLOC_FAIL_AT) {
+        anjay_unlocked_t *anjay = index_test_anjay();
+        anjay_server_info_t *server1 = index_test_add_server(anjay, 1, 7);
+        anjay_server_info_t *server2 = index_test_add_server(anjay, 2, 7);
+        avs_net_socket_t *socket2 = index_test_socket_of(server2);
+        index_test_replace_socket(server1, NULL);
+
+        INDEX_TEST_REALLOC_CALLS = 0;
+        AVS_UNIT_MOCK(avs_realloc) = index_test_failing_realloc;
+        // the first lookup fails to build the index, so the list is walked
+        AVS_UNIT_ASSERT_TRUE(_anjay_servers_find(anjay, 1) == server1);
+        AVS_UNIT_ASSERT_FALSE(anjay->servers_index.valid);
+        AVS_UNIT_MOCK(avs_realloc) = NULL;
+
+        // the index is built on the next lookup
+        AVS_UNIT_ASSERT_TRUE(_anjay_servers_find(anjay, 2) == server2);
+        AVS_UNIT_ASSERT_TRUE(anjay->servers_index.valid);
+
+        // all lookups give the same results when falling back to the list
+        AVS_UNIT_MOCK(avs_realloc) = index_test_failing_realloc;
+        INDEX_TEST_REALLOC_CALLS = 0;
+        index_test_add_server(anjay, 3, 8);
+        AVS_UNIT_ASSERT_NULL(_anjay_servers_find(anjay, 4));
+        AVS_UNIT_ASSERT_FALSE(anjay->servers_index.valid);
+        AVS_UNIT_ASSERT_NULL(_anjay_servers_find_active(anjay, 1));
+        AVS_UNIT_ASSERT_TRUE(_anjay_servers_find_active_by_security_iid(
+                                     anjay, 7)
+                             == server2);
+        AVS_UNIT_ASSERT_TRUE(
+                _anjay_servers_find_by_primary_socket(anjay, socket2)
+                == server2);
+        AVS_UNIT_ASSERT_TRUE(_anjay_servers_find(anjay, 3)->ssid == 3);
+        AVS_UNIT_MOCK(avs_realloc) = NULL;
+
+        index_test_finish(anjay);
+    }
+}
+
+AVS_UNIT_TEST(connection, get_dtls_session) {
+    anjay_unlocked_t *anjay = index_test_anjay();
+    anjay_server_info_t *server = index_test_add_server(anjay, 1, 1);
+    const anjay_connection_ref_t ref = {
+        .server = server,
+        .conn_type = ANJAY_CONNECTION_PRIMARY
+    };
+    char *session = index_test_primary_connection(server)
+                            ->nontransient_state.dtls_session_buffer;
+    char buffer[ANJAY_DTLS_SESSION_BUFFER_SIZE];
+
+    // an all-zero buffer means that there is no session
+    AVS_UNIT_ASSERT_FALSE(
+            _anjay_connection_get_dtls_session(ref, buffer, sizeof(buffer)));
+
+    session[ANJAY_DTLS_SESSION_BUFFER_SIZE - 1] = 0x42;
+    memset(buffer, 0, sizeof(buffer));
+    AVS_UNIT_ASSERT_TRUE(
+            _anjay_connection_get_dtls_session(ref, buffer, sizeof(buffer)));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, session, sizeof(buffer));
+
+    // the buffer is not truncated
+    AVS_UNIT_ASSERT_FALSE(_anjay_connection_get_dtls_session(
+            ref, buffer, sizeof(buffer) - 1));
+
+    index_test_finish(anjay);
+}
@@ -0,0 +1,19 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#ifndef ANJAY_TEST_SERVERS_MOCK_H
+#define ANJAY_TEST_SERVERS_MOCK_H
+
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_unit_mock_helpers.h>
+
+AVS_UNIT_MOCK_CREATE(avs_realloc)
+#define avs_realloc(...) AVS_UNIT_MOCK_WRAPPER(avs_realloc)(__VA_ARGS__)
+
+#endif /* ANJAY_TEST_SERVERS_MOCK_H */
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <stdio.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+static void assert_digest_equal(const uint8_t *digest, const char *hex) {
+    char actual[2 * ANJAY_SHA256_DIGEST_SIZE + 1];
+    for (size_t i = 0; i < ANJAY_SHA256_DIGEST_SIZE; ++i) {
+        snprintf(&actual[2 * i], 3, "%02x", digest[i]);
+    }
+    AVS_UNIT_ASSERT_EQUAL_STRING(actual, hex);
+}
+
+AVS_UNIT_TEST(sha256, empty) {
+    anjay_sha256_t ctx;
+    uint8_t digest[ANJAY_SHA256_DIGEST_SIZE];
+    _anjay_sha256_init(&ctx);
+    _anjay_sha256_finish(&ctx, digest);
+    assert_digest_equal(digest, "e3b0c44298fc1c149afbf4c8996fb924"
+                                "27ae41e4649b934ca495991b7852b855");
+}
+
+AVS_UNIT_TEST(sha256, two_blocks) {
+    static const char DATA[] =
+            "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    anjay_sha256_t ctx;
+    uint8_t digest[ANJAY_SHA256_DIGEST_SIZE];
+    _anjay_sha256_init(&ctx);
+    _anjay_sha256_update(&ctx, DATA, sizeof(DATA) - 1);
+    _anjay_sha256_finish(&ctx, digest);
+    assert_digest_equal(digest, "248d6a61d20638b8e5c026930c3e6039"
+                                "a33ce45964ff2167f6ecedd419db06c1");
+}
+
+AVS_UNIT_TEST(sha256, chunked_update) {
+    // one million 'a' characters, fed in uneven chunks
+    char chunk[997];
+    memset(chunk, 'a', sizeof(chunk));
+    anjay_sha256_t ctx;
+    uint8_t digest[ANJAY_SHA256_DIGEST_SIZE];
+    _anjay_sha256_init(&ctx);
+    size_t left = 1000000;
+    for (size_t i = 1; left > 0; i = (i * 7) % sizeof(chunk) + 1) {
+        size_t size = i < left ? i : left;
+        _anjay_sha256_update(&ctx, chunk, size);
+        left -= size;
+    }
+    _anjay_sha256_finish(&ctx, digest);
+    assert_digest_equal(digest, "cdc76e5c9914fb9281a1c7e284d73e67"
+                                "f1809a48a497200e046d39ccc7112cd0");
+}
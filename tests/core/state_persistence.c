@@ -0,0 +1,144 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <string.h>
+
+#include <avsystem/commons/avs_stream_membuf.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/anjay_utils_private.h"
+#include "src/core/servers/anjay_register.h"
+#include "src/core/servers/anjay_servers_internal.h"
+
+static const int64_t TEST_EXPIRE_TIME_MS = INT64_C(1700000000000);
+
+static void add_restored_registration(anjay_t *anjay_locked,
+                                      anjay_ssid_t ssid) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_registration_restored_t) entry =
+            AVS_LIST_NEW_ELEMENT(anjay_registration_restored_t);
+    AVS_UNIT_ASSERT_NOT_NULL(entry);
+    entry->ssid = ssid;
+    entry->info.lwm2m_version = ANJAY_LWM2M_VERSION_1_0;
+    entry->info.queue_mode = true;
+    entry->info.expire_time =
+            avs_time_real_from_scalar(TEST_EXPIRE_TIME_MS, AVS_TIME_MS);
+    entry->info.last_update_params.lifetime_s = 86400;
+    strcpy(entry->info.last_update_params.binding_mode.data, "UQ");
+    entry->info.endpoint_path = ANJAY_MAKE_STRING_LIST("rd", "5a3f");
+    AVS_UNIT_ASSERT_NOT_NULL(entry->info.endpoint_path);
+    AVS_LIST_APPEND(&anjay->registrations_restored, entry);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+static void
+assert_restored_registration(const anjay_registration_info_t *info) {
+    int64_t expire_time_ms;
+    AVS_UNIT_ASSERT_EQUAL(info->lwm2m_version, ANJAY_LWM2M_VERSION_1_0);
+    AVS_UNIT_ASSERT_TRUE(info->queue_mode);
+    AVS_UNIT_ASSERT_SUCCESS(avs_time_real_to_scalar(
+            &expire_time_ms, AVS_TIME_MS, info->expire_time));
+    AVS_UNIT_ASSERT_EQUAL(expire_time_ms, TEST_EXPIRE_TIME_MS);
+    AVS_UNIT_ASSERT_EQUAL(info->last_update_params.lifetime_s, 86400);
+    AVS_UNIT_ASSERT_EQUAL_STRING(info->last_update_params.binding_mode.data,
+                                 "UQ");
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(info->endpoint_path), 2);
+    AVS_UNIT_ASSERT_EQUAL_STRING(info->endpoint_path->c_str, "rd");
+    AVS_UNIT_ASSERT_EQUAL_STRING(AVS_LIST_NEXT(info->endpoint_path)->c_str,
+                                 "5a3f");
+}
+
+static void clear_restored_registrations(anjay_t *anjay_locked) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    _anjay_registrations_restored_cleanup(&anjay->registrations_restored);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+AVS_UNIT_TEST(state_persistence, registrations_round_trip) {
+    anjay_t *anjay = anjay_new(&(const anjay_configuration_t) {
+        .endpoint_name = "test"
+    });
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+
+    add_restored_registration(anjay, 42);
+    // objects that are not installed are skipped
+    AVS_UNIT_ASSERT_SUCCESS(anjay_state_persist(anjay, stream));
+    clear_restored_registrations(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_state_restore(anjay, stream));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->registrations_restored),
+                          1);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->registrations_restored->ssid, 42);
+    assert_restored_registration(
+            &anjay_unlocked->registrations_restored->info);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    avs_stream_cleanup(&stream);
+    anjay_delete(anjay);
+}
+
+AVS_UNIT_TEST(state_persistence, invalid_registration_rejected) {
+    anjay_t *anjay = anjay_new(&(const anjay_configuration_t) {
+        .endpoint_name = "test"
+    });
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+
+    add_restored_registration(anjay, ANJAY_SSID_BOOTSTRAP);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_state_persist(anjay, stream));
+    clear_restored_registrations(anjay);
+    add_restored_registration(anjay, 7);
+    AVS_UNIT_ASSERT_FAILED(anjay_state_restore(anjay, stream));
+
+    // entries restored earlier are not replaced by a broken section
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->registrations_restored),
+                          1);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->registrations_restored->ssid, 7);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    avs_stream_cleanup(&stream);
+    anjay_delete(anjay);
+}
+
+AVS_UNIT_TEST(state_persistence, restored_registration_applied) {
+    anjay_t *anjay = anjay_new(&(const anjay_configuration_t) {
+        .endpoint_name = "test"
+    });
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    add_restored_registration(anjay, 1);
+    add_restored_registration(anjay, 2);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    anjay_server_info_t server = {
+        .anjay = anjay_unlocked,
+        .ssid = 2
+    };
+    _anjay_server_apply_restored_registration(&server);
+    assert_restored_registration(&server.registration_info);
+    AVS_UNIT_ASSERT_TRUE(server.registration_info.update_forced);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->registrations_restored),
+                          1);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->registrations_restored->ssid, 1);
+
+    // no entry for this SSID - registration info is left untouched
+    server.ssid = 3;
+    _anjay_server_apply_restored_registration(&server);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->registrations_restored),
+                          1);
+    assert_restored_registration(&server.registration_info);
+    _anjay_registration_info_cleanup(&server.registration_info);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    anjay_delete(anjay);
+}
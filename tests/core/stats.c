@@ -0,0 +1,391 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <anjay_init.h>
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/servers/anjay_servers_internal.h"
+#include "tests/utils/dm.h"
+
+#ifdef ANJAY_WITH_LOCK_STATS
+static anjay_t *stats_test_anjay_new(void) {
+    const anjay_configuration_t config = {
+        .endpoint_name = "test"
+    };
+    anjay_t *anjay = anjay_new(&config);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    return anjay;
+}
+
+static const char LOCK_STATS_TEST_FUNCTION[] = "lock_stats_test_function";
+
+static void hold_lock(anjay_t *anjay,
+                      const char *function,
+                      avs_time_duration_t hold_time) {
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_lock_exclusive_with_stats(anjay, function));
+    _anjay_mock_clock_advance(hold_time);
+    _anjay_unlock_exclusive_with_stats(anjay);
+}
+
+static const anjay_lock_stats_entry_t *
+find_lock_stats(const anjay_lock_stats_entry_t *entries,
+                size_t count,
+                const char *function) {
+    for (size_t i = 0; i < count; ++i) {
+        if (entries[i].function == function) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+AVS_UNIT_TEST(lock_stats, hold_time_attributed_to_function) {
+    anjay_t *anjay = stats_test_anjay_new();
+    _anjay_mock_clock_start(avs_time_monotonic_from_scalar(1000, AVS_TIME_S));
+    anjay_reset_lock_stats(anjay);
+
+    hold_lock(anjay, LOCK_STATS_TEST_FUNCTION,
+              avs_time_duration_from_scalar(5, AVS_TIME_MS));
+    hold_lock(anjay, LOCK_STATS_TEST_FUNCTION,
+              avs_time_duration_from_scalar(100, AVS_TIME_MS));
+
+    anjay_lock_stats_entry_t entries[8];
+    size_t count =
+            anjay_get_lock_stats(anjay, entries, AVS_ARRAY_SIZE(entries));
+    AVS_UNIT_ASSERT_TRUE(count <= AVS_ARRAY_SIZE(entries));
+    const anjay_lock_stats_entry_t *entry =
+            find_lock_stats(entries, count, LOCK_STATS_TEST_FUNCTION);
+    AVS_UNIT_ASSERT_NOT_NULL(entry);
+    AVS_UNIT_ASSERT_EQUAL(entry->lock_count, 2);
+    AVS_UNIT_ASSERT_EQUAL(entry->total_hold_us, 105000);
+    AVS_UNIT_ASSERT_EQUAL(entry->max_hold_us, 100000);
+    // the clock does not move while waiting
+    AVS_UNIT_ASSERT_EQUAL(entry->total_wait_us, 0);
+    AVS_UNIT_ASSERT_EQUAL(entry->wait_histogram[0], 2);
+    // 4096 <= 5000 < 8192 and 65536 <= 100000 < 131072
+    AVS_UNIT_ASSERT_EQUAL(entry->hold_histogram[12], 1);
+    AVS_UNIT_ASSERT_EQUAL(entry->hold_histogram[16], 1);
+
+    anjay_reset_lock_stats(anjay);
+    count = anjay_get_lock_stats(anjay, entries, AVS_ARRAY_SIZE(entries));
+    AVS_UNIT_ASSERT_NULL(
+            find_lock_stats(entries, count, LOCK_STATS_TEST_FUNCTION));
+
+    _anjay_mock_clock_finish();
+    anjay_delete(anjay);
+}
+
+AVS_UNIT_TEST(lock_stats, table_overflow) {
+    struct anjay_lock_stats_struct *stats = _anjay_lock_stats_new();
+    AVS_UNIT_ASSERT_NOT_NULL(stats);
+    // only the addresses are used as keys
+    static const char functions[LOCK_STATS_TABLE_SIZE] = "";
+    const size_t capacity = LOCK_STATS_TABLE_SIZE * 3 / 4;
+    for (size_t i = 0; i < capacity; ++i) {
+        anjay_lock_stats_entry_t *entry =
+                find_lock_stats_entry(stats, &functions[i]);
+        AVS_UNIT_ASSERT_TRUE(entry != &stats->overflow);
+        AVS_UNIT_ASSERT_TRUE(entry->function == &functions[i]);
+        // looking up the same function again yields the same entry
+        AVS_UNIT_ASSERT_TRUE(find_lock_stats_entry(stats, &functions[i])
+                             == entry);
+    }
+    AVS_UNIT_ASSERT_TRUE(find_lock_stats_entry(stats, &functions[capacity])
+                         == &stats->overflow);
+    AVS_UNIT_ASSERT_EQUAL(stats->entries_count, capacity);
+    _anjay_lock_stats_delete(&stats);
+    AVS_UNIT_ASSERT_NULL(stats);
+}
+#endif // ANJAY_WITH_LOCK_STATS
+
+#ifdef ANJAY_WITH_SCHED_STATS
+static void sched_stats_test_job(avs_sched_t *sched, const void *arg) {
+    (void) sched;
+    (void) arg;
+}
+
+AVS_UNIT_TEST(sched_stats, pending_jobs) {
+    DM_TEST_INIT_WITH_SSIDS(1, 2);
+    avs_time_monotonic_t deadline = avs_time_monotonic_add(
+            avs_time_monotonic_now(),
+            avs_time_duration_from_scalar(10, AVS_TIME_S));
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_LIST(anjay_server_info_t) *server_ptr =
+            _anjay_servers_find_ptr(&anjay_unlocked->servers, 2);
+    AVS_UNIT_ASSERT_NOT_NULL(server_ptr);
+    avs_sched_del(&(*server_ptr)->next_action_handle);
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_AT(anjay_unlocked->sched,
+                                         &(*server_ptr)->next_action_handle,
+                                         deadline, sched_stats_test_job, NULL,
+                                         0));
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    anjay_sched_job_info_t jobs[8];
+    size_t count =
+            anjay_get_pending_sched_jobs(anjay, jobs, AVS_ARRAY_SIZE(jobs));
+    AVS_UNIT_ASSERT_TRUE(count <= AVS_ARRAY_SIZE(jobs));
+    // the total is reported even if nothing is stored
+    AVS_UNIT_ASSERT_EQUAL(anjay_get_pending_sched_jobs(anjay, NULL, 0), count);
+    const anjay_sched_job_info_t *job = NULL;
+    for (size_t i = 0; i < count; ++i) {
+        if (jobs[i].kind == ANJAY_SCHED_JOB_SERVER_ACTION
+                && jobs[i].ssid == 2) {
+            AVS_UNIT_ASSERT_NULL(job);
+            job = &jobs[i];
+        }
+    }
+    AVS_UNIT_ASSERT_NOT_NULL(job);
+    AVS_UNIT_ASSERT_TRUE(avs_time_monotonic_equal(job->deadline, deadline));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    server_ptr = _anjay_servers_find_ptr(&anjay_unlocked->servers, 2);
+    avs_sched_del(&(*server_ptr)->next_action_handle);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    AVS_UNIT_ASSERT_EQUAL(anjay_get_pending_sched_jobs(anjay, NULL, 0),
+                          count - 1);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(sched_stats, job_runtime) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+    anjay_reset_sched_job_stats(anjay);
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    for (int ms = 1; ms <= 3; ++ms) {
+        ANJAY_SCHED_JOB_STATS_BEGIN(job_start_time);
+        _anjay_mock_clock_advance(
+                avs_time_duration_from_scalar(ms, AVS_TIME_MS));
+        ANJAY_SCHED_JOB_STATS_END(anjay_unlocked, ANJAY_SCHED_JOB_COAP,
+                                  job_start_time);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    anjay_sched_job_stats_t stats;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_get_sched_job_stats(anjay, ANJAY_SCHED_JOB_COAP, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.executions, 3);
+    AVS_UNIT_ASSERT_EQUAL(stats.total_runtime_us, 6000);
+    AVS_UNIT_ASSERT_EQUAL(stats.max_runtime_us, 3000);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_sched_job_stats(
+            anjay, ANJAY_SCHED_JOB_OBSERVE_TRIGGER, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.executions, 0);
+    AVS_UNIT_ASSERT_FAILED(anjay_get_sched_job_stats(
+            anjay, ANJAY_SCHED_JOB_KIND_LIMIT_, &stats));
+
+    anjay_reset_sched_job_stats(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_get_sched_job_stats(anjay, ANJAY_SCHED_JOB_COAP, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.executions, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.total_runtime_us, 0);
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_SCHED_STATS
+
+#ifdef ANJAY_WITH_OPERATION_STATS
+static void record_test_operation(anjay_t *anjay_locked,
+                                  anjay_ssid_t ssid,
+                                  anjay_operation_kind_t kind,
+                                  int64_t handler_us,
+                                  int64_t total_us,
+                                  bool failed) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    _anjay_operation_stats_record(
+            anjay, ssid, kind,
+            avs_time_duration_from_scalar(handler_us, AVS_TIME_US),
+            avs_time_duration_from_scalar(total_us, AVS_TIME_US), failed);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+AVS_UNIT_TEST(operation_stats, per_server_and_summed) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+    record_test_operation(anjay, 2, ANJAY_OPERATION_READ, 10, 100, false);
+    record_test_operation(anjay, 1, ANJAY_OPERATION_READ, 16, 40, true);
+    record_test_operation(anjay, 2, ANJAY_OPERATION_EXECUTE, 5, 5, false);
+
+    anjay_operation_stats_t stats;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_get_operation_stats(anjay, 2, ANJAY_OPERATION_READ, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.count, 1);
+    AVS_UNIT_ASSERT_EQUAL(stats.errors, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.total_handler_us, 10);
+    AVS_UNIT_ASSERT_EQUAL(stats.handler_histogram[0], 1);
+    AVS_UNIT_ASSERT_EQUAL(stats.total_time_us, 100);
+    // 64 <= 100 < 128
+    AVS_UNIT_ASSERT_EQUAL(stats.time_histogram[3], 1);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_operation_stats(
+            anjay, ANJAY_SSID_ANY, ANJAY_OPERATION_READ, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.count, 2);
+    AVS_UNIT_ASSERT_EQUAL(stats.errors, 1);
+    AVS_UNIT_ASSERT_EQUAL(stats.total_handler_us, 26);
+    AVS_UNIT_ASSERT_EQUAL(stats.max_handler_us, 16);
+    AVS_UNIT_ASSERT_EQUAL(stats.handler_histogram[0], 1);
+    AVS_UNIT_ASSERT_EQUAL(stats.handler_histogram[1], 1);
+    AVS_UNIT_ASSERT_EQUAL(stats.total_time_us, 140);
+    AVS_UNIT_ASSERT_EQUAL(stats.max_time_us, 100);
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_operation_stats(
+            anjay, 1, ANJAY_OPERATION_EXECUTE, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.count, 0);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_operation_stats(
+            anjay, 3, ANJAY_OPERATION_READ, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.count, 0);
+    AVS_UNIT_ASSERT_FAILED(anjay_get_operation_stats(
+            anjay, 2, ANJAY_OPERATION_KIND_LIMIT_, &stats));
+
+    // entries are kept sorted by SSID
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(anjay_unlocked->operation_stats), 2);
+    AVS_UNIT_ASSERT_EQUAL(anjay_unlocked->operation_stats->ssid, 1);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    anjay_reset_operation_stats(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_operation_stats(
+            anjay, ANJAY_SSID_ANY, ANJAY_OPERATION_READ, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.count, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.total_time_us, 0);
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_OPERATION_STATS
+
+#ifdef ANJAY_WITH_TRAFFIC_STATS
+static void expect_socket_bytes(avs_net_socket_t *socket,
+                                uint64_t bytes_sent,
+                                uint64_t bytes_received) {
+    avs_unit_mocksock_expect_get_opt(socket, AVS_NET_SOCKET_OPT_BYTES_SENT,
+                                     (avs_net_socket_opt_value_t) {
+                                         .bytes_sent = bytes_sent
+                                     });
+    avs_unit_mocksock_expect_get_opt(socket, AVS_NET_SOCKET_OPT_BYTES_RECEIVED,
+                                     (avs_net_socket_opt_value_t) {
+                                         .bytes_received = bytes_received
+                                     });
+}
+
+static void assert_traffic(const anjay_traffic_stats_t *stats,
+                           uint64_t tx_bytes,
+                           uint64_t rx_bytes) {
+    AVS_UNIT_ASSERT_EQUAL(stats->tx_bytes, tx_bytes);
+    AVS_UNIT_ASSERT_EQUAL(stats->rx_bytes, rx_bytes);
+}
+
+AVS_UNIT_TEST(traffic_stats, attributed_to_exchange) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+    avs_net_socket_t *socket = _anjay_test_dm_create_socket(true);
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    // client-initiated exchange
+    expect_socket_bytes(socket, 100, 40);
+    ANJAY_TRAFFIC_STATS_BEGIN(outgoing, socket);
+    expect_socket_bytes(socket, 130, 50);
+    ANJAY_TRAFFIC_STATS_END(anjay_unlocked, outgoing, socket,
+                            ANJAY_OPERATION_READ, AVS_COAP_FORMAT_SENML_CBOR,
+                            3303);
+    // the socket has been replaced in the meantime
+    ANJAY_TRAFFIC_STATS_END(anjay_unlocked, outgoing, NULL,
+                            ANJAY_OPERATION_READ, AVS_COAP_FORMAT_SENML_CBOR,
+                            3303);
+
+    // incoming packet not attributed to any exchange
+    expect_socket_bytes(socket, 130, 50);
+    ANJAY_TRAFFIC_STATS_INCOMING_BEGIN(anjay_unlocked, unattributed, socket);
+    ANJAY_TRAFFIC_STATS_INCOMING_END(anjay_unlocked, unattributed, socket);
+
+    // incoming request
+    expect_socket_bytes(socket, 130, 50);
+    ANJAY_TRAFFIC_STATS_INCOMING_BEGIN(anjay_unlocked, incoming, socket);
+    ANJAY_TRAFFIC_STATS_SET_INCOMING(anjay_unlocked, ANJAY_OPERATION_WRITE,
+                                     AVS_COAP_FORMAT_NONE, ANJAY_ID_INVALID);
+    expect_socket_bytes(socket, 140, 80);
+    ANJAY_TRAFFIC_STATS_INCOMING_END(anjay_unlocked, incoming, socket);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    anjay_traffic_stats_t stats;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_operation_traffic_stats(
+            anjay, ANJAY_OPERATION_READ, &stats));
+    assert_traffic(&stats, 30, 10);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_operation_traffic_stats(
+            anjay, ANJAY_OPERATION_WRITE, &stats));
+    assert_traffic(&stats, 10, 30);
+    AVS_UNIT_ASSERT_EQUAL(
+            anjay_get_operation_tx_bytes(anjay, ANJAY_OPERATION_WRITE), 10);
+    AVS_UNIT_ASSERT_EQUAL(
+            anjay_get_operation_rx_bytes(anjay, ANJAY_OPERATION_WRITE), 30);
+    AVS_UNIT_ASSERT_FAILED(anjay_get_operation_traffic_stats(
+            anjay, ANJAY_OPERATION_KIND_LIMIT_, &stats));
+
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_content_format_traffic_stats(
+            anjay, AVS_COAP_FORMAT_SENML_CBOR, &stats));
+    assert_traffic(&stats, 30, 10);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_content_format_traffic_stats(
+            anjay, AVS_COAP_FORMAT_NONE, &stats));
+    assert_traffic(&stats, 10, 30);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_content_format_traffic_stats(
+            anjay, AVS_COAP_FORMAT_PLAINTEXT, &stats));
+    assert_traffic(&stats, 0, 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_get_object_traffic_stats(anjay, 3303, &stats));
+    assert_traffic(&stats, 30, 10);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_get_object_traffic_stats(anjay, ANJAY_ID_INVALID, &stats));
+    assert_traffic(&stats, 10, 30);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_get_object_traffic_stats(anjay, 3304, &stats));
+    assert_traffic(&stats, 0, 0);
+
+    anjay_reset_traffic_stats(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_operation_traffic_stats(
+            anjay, ANJAY_OPERATION_READ, &stats));
+    assert_traffic(&stats, 0, 0);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_get_object_traffic_stats(anjay, 3303, &stats));
+    assert_traffic(&stats, 0, 0);
+
+    avs_net_socket_cleanup(&socket);
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_TRAFFIC_STATS
+
+#ifdef ANJAY_WITH_OPERATION_STATS
+AVS_UNIT_TEST(operation_stats, content_format_payloads) {
+    DM_TEST_INIT_WITHOUT_SERVER;
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    _anjay_operation_stats_record_format(anjay_unlocked, 2,
+                                         AVS_COAP_FORMAT_SENML_CBOR);
+    _anjay_operation_stats_record_format(anjay_unlocked, 2,
+                                         AVS_COAP_FORMAT_PLAINTEXT);
+    _anjay_operation_stats_record_format(anjay_unlocked, 2,
+                                         AVS_COAP_FORMAT_SENML_CBOR);
+    _anjay_operation_stats_record_format(anjay_unlocked, 1,
+                                         AVS_COAP_FORMAT_SENML_CBOR);
+    ANJAY_MUTEX_UNLOCK(anjay);
+
+    uint64_t payloads;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_content_format_payloads(
+            anjay, 2, AVS_COAP_FORMAT_SENML_CBOR, &payloads));
+    AVS_UNIT_ASSERT_EQUAL(payloads, 2);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_content_format_payloads(
+            anjay, 2, AVS_COAP_FORMAT_PLAINTEXT, &payloads));
+    AVS_UNIT_ASSERT_EQUAL(payloads, 1);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_content_format_payloads(
+            anjay, 1, AVS_COAP_FORMAT_PLAINTEXT, &payloads));
+    AVS_UNIT_ASSERT_EQUAL(payloads, 0);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_content_format_payloads(
+            anjay, ANJAY_SSID_ANY, AVS_COAP_FORMAT_SENML_CBOR, &payloads));
+    AVS_UNIT_ASSERT_EQUAL(payloads, 3);
+
+    // payload counters share the per-server entries with operation stats
+    anjay_reset_operation_stats(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_get_content_format_payloads(
+            anjay, ANJAY_SSID_ANY, AVS_COAP_FORMAT_SENML_CBOR, &payloads));
+    AVS_UNIT_ASSERT_EQUAL(payloads, 0);
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_OPERATION_STATS
@@ -20,6 +20,7 @@
 #include <avsystem/commons/avs_unit_test.h>
 #include <avsystem/commons/avs_utils.h>
 
+#include "src/core/anjay_tracepoints.h"
 #include "tests/utils/utils.h"
 
 #define ANJAY_URL_EMPTY   \
@@ -336,3 +337,57 @@ AVS_UNIT_TEST(snprintf, no_space_for_terminating_nullbyte) {
 AVS_UNIT_TEST(binding_mode_valid, unsupported_binding_mode) {
     AVS_UNIT_ASSERT_FALSE(anjay_binding_mode_valid("☃"));
 }
+
+AVS_UNIT_TEST(double_as_shortest_string, integers) {
+    AVS_UNIT_ASSERT_EQUAL_STRING(ANJAY_DOUBLE_AS_SHORTEST_STRING(0.0), "0");
+    AVS_UNIT_ASSERT_EQUAL_STRING(ANJAY_DOUBLE_AS_SHORTEST_STRING(42.0), "42");
+    AVS_UNIT_ASSERT_EQUAL_STRING(ANJAY_DOUBLE_AS_SHORTEST_STRING(-1e14),
+                                 "-100000000000000");
+}
+
+#ifndef AVS_COMMONS_WITHOUT_FLOAT_FORMAT_SPECIFIERS
+AVS_UNIT_TEST(double_as_shortest_string, round_trip) {
+    static const double VALUES[] = {
+        0.1, 1.0 / 3.0, 2.5e-300, -17.625, 1e15, 1.7976931348623157e308, 5e-324
+    };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(VALUES); ++i) {
+        const char *str = ANJAY_DOUBLE_AS_SHORTEST_STRING(VALUES[i]);
+        double parsed;
+        AVS_UNIT_ASSERT_SUCCESS(_anjay_safe_strtod(str, &parsed));
+        AVS_UNIT_ASSERT_TRUE(parsed == VALUES[i]);
+    }
+    AVS_UNIT_ASSERT_EQUAL_STRING(ANJAY_DOUBLE_AS_SHORTEST_STRING(1.0 / 3.0),
+                                 "0.3333333333333333");
+}
+#endif // AVS_COMMONS_WITHOUT_FLOAT_FORMAT_SPECIFIERS
+
+AVS_UNIT_TEST(random_duration, within_range) {
+    anjay_unlocked_t anjay;
+    memset(&anjay, 0, sizeof(anjay));
+    AVS_UNIT_ASSERT_NOT_NULL((anjay.prng_ctx.ctx =
+                                      avs_crypto_prng_new(NULL, NULL)));
+    const avs_time_duration_t min =
+            avs_time_duration_from_scalar(5, AVS_TIME_S);
+    const avs_time_duration_t max =
+            avs_time_duration_from_scalar(10, AVS_TIME_S);
+    for (int i = 0; i < 100; ++i) {
+        avs_time_duration_t result = _anjay_random_duration(&anjay, min, max);
+        AVS_UNIT_ASSERT_FALSE(avs_time_duration_less(result, min));
+        AVS_UNIT_ASSERT_FALSE(avs_time_duration_less(max, result));
+    }
+    // empty range
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_equal(
+            _anjay_random_duration(&anjay, max, min), max));
+    avs_crypto_prng_free(&anjay.prng_ctx.ctx);
+}
+
+AVS_UNIT_TEST(tracepoints, arguments_evaluated_only_when_enabled) {
+    int evaluated = 0;
+    ANJAY_TRACEPOINT(unit_test, ++evaluated);
+#ifdef ANJAY_WITH_TRACEPOINTS
+    AVS_UNIT_ASSERT_EQUAL(evaluated, 1);
+#else  // ANJAY_WITH_TRACEPOINTS
+    // the tracepoint compiles out completely, including its arguments
+    AVS_UNIT_ASSERT_EQUAL(evaluated, 0);
+#endif // ANJAY_WITH_TRACEPOINTS
+}
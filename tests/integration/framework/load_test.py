@@ -0,0 +1,340 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay LwM2M SDK
+# All rights reserved.
+#
+# Licensed under the AVSystem-5-clause License.
+# See the attached LICENSE file for details.
+
+"""
+Load-generation harness: spawns many demo clients, each registered to its own
+Lwm2mServer, and drives a weighted mix of operations against all of them
+concurrently, collecting throughput and latency figures.
+
+The scale of the test can be overridden using environment variables, so that
+the same test can run as a quick smoke test and as a full load test:
+
+- ANJAY_LOAD_CLIENTS - number of demo clients,
+- ANJAY_LOAD_OPERATIONS - number of operations performed on each client,
+- ANJAY_LOAD_MIX - comma-separated list of operation=weight pairs, e.g.
+  "observe_storm=1,read_composite=5" (operations not listed are not run),
+- ANJAY_LOAD_SEED - seed of the generator used to pick operations.
+"""
+
+import concurrent.futures
+import contextlib
+import logging
+import os
+import random
+import threading
+import time
+
+from .coap_file_server import CoapFileServerThread
+from .firmware_package import make_firmware_package
+from .lwm2m_test import *
+from .test_suite import CleanupList, Lwm2mDmOperations, Lwm2mTest
+
+FIRMWARE_PATH = '/firmware'
+
+
+def _env_int(name, default):
+    return int(os.environ.get(name, default))
+
+
+def _parse_mix(mix):
+    result = {}
+    for entry in mix.split(','):
+        name, weight = entry.split('=')
+        result[name.strip()] = float(weight)
+    return result
+
+
+class LoadStats:
+    """
+    Thread-safe collection of per-operation latencies.
+    """
+
+    def __init__(self):
+        self._mutex = threading.Lock()
+        self._latencies = {}
+        self._errors = {}
+        self.wall_time_s = None
+
+    def record(self, operation, latency_s):
+        with self._mutex:
+            self._latencies.setdefault(operation, []).append(latency_s)
+
+    def record_error(self, operation, exception):
+        with self._mutex:
+            self._errors.setdefault(operation, []).append(exception)
+
+    @property
+    def errors(self):
+        with self._mutex:
+            return [exc for excs in self._errors.values() for exc in excs]
+
+    @staticmethod
+    def _percentile(sorted_latencies, percent):
+        index = (len(sorted_latencies) * percent + 99) // 100 - 1
+        return sorted_latencies[max(index, 0)]
+
+    def summary(self):
+        """
+        Returns a dict mapping each operation name to a dict with its count,
+        error count, throughput (operations per second of wall time) and
+        p50/p95/p99/max latencies in seconds.
+        """
+        with self._mutex:
+            result = {}
+            for operation in sorted(set(self._latencies) | set(self._errors)):
+                latencies = sorted(self._latencies.get(operation, []))
+                entry = {
+                    'count': len(latencies),
+                    'errors': len(self._errors.get(operation, [])),
+                }
+                if self.wall_time_s:
+                    entry['throughput'] = len(latencies) / self.wall_time_s
+                if latencies:
+                    entry.update({
+                        'p50': self._percentile(latencies, 50),
+                        'p95': self._percentile(latencies, 95),
+                        'p99': self._percentile(latencies, 99),
+                        'max': latencies[-1],
+                    })
+                result[operation] = entry
+            return result
+
+    def report(self):
+        lines = ['%-16s %8s %6s %10s %10s %10s %10s %10s'
+                 % ('operation', 'count', 'errors', 'ops/s', 'p50 ms', 'p95 ms', 'p99 ms',
+                    'max ms')]
+        for operation, entry in self.summary().items():
+            def ms(key):
+                return '%10.2f' % (entry[key] * 1000.0) if key in entry else '%10s' % 'n/a'
+
+            lines.append('%-16s %8d %6d %10s %s %s %s %s'
+                         % (operation, entry['count'], entry['errors'],
+                            '%10.2f' % entry['throughput'] if 'throughput' in entry else 'n/a',
+                            ms('p50'), ms('p95'), ms('p99'), ms('max')))
+        return '\n'.join(lines)
+
+
+class LoadClient:
+    def __init__(self, index, endpoint_name, server, file_server_thread):
+        self.index = index
+        self.endpoint_name = endpoint_name
+        self.server = server
+        self.file_server_thread = file_server_thread
+        self.demo_process = None
+        self.rng = None
+
+
+class Lwm2mLoadTest(Lwm2mTest, Lwm2mDmOperations):
+    """
+    Base class for load tests. Each client gets its own demo process, its own
+    LwM2M server and its own CoAP file server for firmware downloads.
+
+    Subclasses are expected to call self.run_load() in runTest() and assert on
+    the returned LoadStats.
+
+    Available operations (keys of OPERATION_MIX):
+
+    - observe_storm - establishes OBSERVATIONS_PER_STORM observations on the
+      Test object Counter, triggers a change and measures the time until all
+      notifications arrive,
+    - read_composite - Read-Composite of COMPOSITE_PATHS,
+    - firmware_pull - writes a CoAP Package URI to the Firmware Update object
+      and measures the time until the State becomes Downloaded; the State is
+      polled, so the latency has a granularity of FIRMWARE_POLL_INTERVAL_S.
+    """
+
+    NUM_CLIENTS = 4
+    OPERATIONS_PER_CLIENT = 10
+    OPERATION_MIX = {
+        'observe_storm': 1,
+        'read_composite': 1,
+        'firmware_pull': 1,
+    }
+    OBSERVATIONS_PER_STORM = 8
+    COMPOSITE_PATHS = [ResPath.Device.Manufacturer,
+                       ResPath.Device.ModelNumber,
+                       ResPath.Device.SerialNumber,
+                       ResPath.Device.FirmwareVersion,
+                       ResPath.Server[1].Lifetime,
+                       ResPath.Test[0].Counter]
+    FIRMWARE_SIZE = 16 * 1024
+    FIRMWARE_POLL_INTERVAL_S = 0.1
+    FIRMWARE_TIMEOUT_S = 30
+
+    def __init__(self, test_method_name):
+        super().__init__(test_method_name)
+        self.clients = []
+        self._current_client = None
+
+    def log_filename(self, extension='.log'):
+        if self._current_client is None:
+            return super().log_filename(extension)
+        return os.path.join(self.suite_name(), '%s.client%d%s' % (
+            self.test_name(), self._current_client.index, extension))
+
+    @contextlib.contextmanager
+    def _client_context(self, client):
+        """
+        Lwm2mTest methods operate on self.demo_process - this temporarily
+        points it at the demo process of CLIENT.
+        """
+        prev_client, prev_demo = self._current_client, self.demo_process
+        self._current_client, self.demo_process = client, client.demo_process
+        try:
+            yield
+        finally:
+            client.demo_process = self.demo_process
+            self._current_client, self.demo_process = prev_client, prev_demo
+
+    def setUp(self, num_clients=None, extra_cmdline_args=[], minimum_version='1.0',
+              maximum_version='1.1'):
+        num_clients = _env_int('ANJAY_LOAD_CLIENTS', num_clients or self.NUM_CLIENTS)
+        self.operations_per_client = _env_int('ANJAY_LOAD_OPERATIONS',
+                                              self.OPERATIONS_PER_CLIENT)
+        self.operation_mix = (_parse_mix(os.environ['ANJAY_LOAD_MIX'])
+                              if os.environ.get('ANJAY_LOAD_MIX') else dict(self.OPERATION_MIX))
+        for operation in self.operation_mix:
+            if not hasattr(self, 'op_' + operation):
+                raise ValueError('unknown load operation: %s' % (operation,))
+        seed = _env_int('ANJAY_LOAD_SEED', 0)
+
+        self.demo_process = None
+        self.dumpcap_process = None
+        self.bootstrap_server = None
+        self.servers = []
+        self.firmware = make_firmware_package(os.urandom(self.FIRMWARE_SIZE))
+
+        try:
+            for index in range(num_clients):
+                client = LoadClient(index, 'urn:dev:os:anjay-load-%d' % (index,),
+                                    Lwm2mServer(), CoapFileServerThread())
+                client.rng = random.Random(seed + index)
+                self.clients.append(client)
+                self.servers.append(client.server)
+
+                client.file_server_thread.start()
+                with client.file_server_thread.file_server as file_server:
+                    file_server.set_resource(FIRMWARE_PATH, self.firmware)
+
+                demo_args = self.make_demo_args(
+                    client.endpoint_name, [client.server], minimum_version, maximum_version,
+                    generate_temp_filename(dir='/tmp', prefix='anjay-fw-updated-'),
+                    sw_mgmt_persistence_file=generate_temp_filename(
+                        dir='/tmp', prefix='anjay-sw-mgmt-'))
+                with self._client_context(client):
+                    self._start_demo(demo_args + extra_cmdline_args)
+                self.assertDemoRegisters(client.server, version=maximum_version,
+                                         endpoint=client.endpoint_name)
+                self.create_instance(client.server, oid=OID.Test, iid=0)
+        except Exception:
+            try:
+                self.tearDown(auto_deregister=False)
+            finally:
+                raise
+
+    def tearDown(self, auto_deregister=True, shutdown_timeout_s=5.0, force_kill=False):
+        with CleanupList() as cleanup_funcs:
+            for client in self.clients:
+                def shutdown(client=client):
+                    with self._client_context(client):
+                        if not force_kill:
+                            self.request_demo_shutdown(
+                                deregister_servers=[client.server] if auto_deregister else [])
+                        self._terminate_demo(timeout_s=shutdown_timeout_s,
+                                             force_kill=force_kill)
+
+                cleanup_funcs.append(shutdown)
+                cleanup_funcs.append(client.server.close)
+                cleanup_funcs.append(client.file_server_thread.join)
+        self.clients = []
+        self.servers = []
+
+    def op_observe_storm(self, client):
+        path = ResPath.Test[0].Counter
+        observations = [Lwm2mObserve(path) for _ in range(self.OBSERVATIONS_PER_STORM)]
+        for req in observations:
+            self._perform_action(client.server, req,
+                                 self._make_expected_res(req, Lwm2mContent, None))
+
+        start = time.time()
+        self.execute_resource(client.server, oid=OID.Test, iid=0,
+                              rid=RID.Test.IncrementCounter)
+        tokens = set(bytes(req.token) for req in observations)
+        while tokens:
+            pkt = client.server.recv(filter=lambda pkt: isinstance(pkt, Lwm2mNotify))
+            tokens.discard(bytes(pkt.token))
+        latency_s = time.time() - start
+
+        for req in observations:
+            cancel = Lwm2mObserve(path, observe=1, token=req.token)
+            self._perform_action(client.server, cancel,
+                                 self._make_expected_res(cancel, Lwm2mContent, None))
+        return latency_s
+
+    def op_read_composite(self, client):
+        start = time.time()
+        self.read_composite(client.server, self.COMPOSITE_PATHS)
+        return time.time() - start
+
+    def _read_firmware_state(self, client):
+        res = self.read_path(client.server, ResPath.FirmwareUpdate.State)
+        return int(res.content)
+
+    def op_firmware_pull(self, client):
+        with client.file_server_thread.file_server as file_server:
+            # allow requests from the new port of the downloader
+            file_server._server.reset()
+            uri = file_server.get_resource_uri(FIRMWARE_PATH)
+
+        start = time.time()
+        self.write_resource(client.server, oid=OID.FirmwareUpdate, iid=0,
+                            rid=RID.FirmwareUpdate.PackageURI, content=uri.encode())
+        deadline = start + self.FIRMWARE_TIMEOUT_S
+        # 2 = Downloaded
+        while self._read_firmware_state(client) != 2:
+            if time.time() > deadline:
+                self.fail('firmware still not downloaded')
+            time.sleep(self.FIRMWARE_POLL_INTERVAL_S)
+        latency_s = time.time() - start
+
+        # reset the state machine
+        self.write_resource(client.server, oid=OID.FirmwareUpdate, iid=0,
+                            rid=RID.FirmwareUpdate.PackageURI, content=b'')
+        return latency_s
+
+    def _run_client(self, client, stats):
+        operations = list(self.operation_mix)
+        weights = [self.operation_mix[op] for op in operations]
+        for operation in client.rng.choices(operations, weights,
+                                            k=self.operations_per_client):
+            try:
+                stats.record(operation, getattr(self, 'op_' + operation)(client))
+            except Exception as e:
+                logging.error('%s on client %d failed: %r', operation, client.index, e)
+                stats.record_error(operation, e)
+                # the state of this client's connection is unknown now
+                return
+
+    def run_load(self):
+        """
+        Performs OPERATIONS_PER_CLIENT operations on each client, all clients
+        in parallel. Returns LoadStats; the report is also logged.
+        """
+        stats = LoadStats()
+        start = time.time()
+        with concurrent.futures.ThreadPoolExecutor(max_workers=len(self.clients)) as executor:
+            for future in [executor.submit(self._run_client, client, stats)
+                           for client in self.clients]:
+                future.result()
+        stats.wall_time_s = time.time() - start
+
+        logging.info('load test: %d clients, %d operations each, %.2f s\n%s',
+                     len(self.clients), self.operations_per_client, stats.wall_time_s,
+                     stats.report())
+        return stats
@@ -0,0 +1,31 @@
+# -*- coding: utf-8 -*-
+#
+# Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay LwM2M SDK
+# All rights reserved.
+#
+# Licensed under the AVSystem-5-clause License.
+# See the attached LICENSE file for details.
+
+from framework.load_test import Lwm2mLoadTest
+from framework.lwm2m_test import *
+
+
+# Defaults keep these quick enough for the regular test run; see
+# framework/load_test.py for environment variables that scale them up.
+class MixedOperationsLoad(Lwm2mLoadTest):
+    def runTest(self):
+        stats = self.run_load()
+        self.assertEqual([], stats.errors)
+        summary = stats.summary()
+        self.assertEqual(len(self.clients) * self.operations_per_client,
+                         sum(entry['count'] for entry in summary.values()))
+
+
+class ObserveStormLoad(Lwm2mLoadTest):
+    OPERATION_MIX = {'observe_storm': 1}
+    OBSERVATIONS_PER_STORM = 32
+
+    def runTest(self):
+        stats = self.run_load()
+        self.assertEqual([], stats.errors)
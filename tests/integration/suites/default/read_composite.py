@@ -77,6 +77,28 @@ class ReadCompositeExecutableResource(Test.ReadComposite):
             CBOR.parse(res.content))
 
 
+class ReadCompositeOverlappingPaths(Test.ReadComposite):
+    def runTest(self):
+        # /3/0/0 is contained in /3/0, so its value is returned only once; all
+        # values are returned in path order, regardless of the request order
+        res = self.read_composite(self.serv,
+                                  [ResPath.Device.Manufacturer,
+                                   '/%d/0' % (OID.Device,),
+                                   ResPath.Server[1].Lifetime,
+                                   ResPath.Device.Manufacturer])
+        names = []
+        basename = ''
+        for entry in CBOR.parse(res.content):
+            basename = entry.get(SenmlLabel.BASE_NAME, basename)
+            names.append(basename + entry.get(SenmlLabel.NAME, ''))
+
+        self.assertEqual(len(set(names)), len(names))
+        self.assertEqual(ResPath.Server[1].Lifetime, names[0])
+        self.assertIn(ResPath.Device.Manufacturer, names)
+        ids = [tuple(int(id) for id in name.split('/')[1:]) for name in names]
+        self.assertEqual(sorted(ids), ids)
+
+
 BIG_LIST_OF_REQUESTED_PATHS = [
     ResPath.Test[0].Timestamp,
     ResPath.Test[0].ResInt,
@@ -16,6 +16,7 @@
 
 #include <anjay_modules/dm/anjay_execute.h>
 
+#include "src/core/anjay_access_utils_private.h"
 #include "src/core/anjay_core.h"
 #include "src/core/servers/anjay_servers_internal.h"
 #include "src/modules/access_control/anjay_mod_access_control.h"
@@ -316,3 +317,180 @@ AVS_UNIT_TEST(access_control, set_owner) {
 
     DM_TEST_FINISH;
 }
+
+static bool action_allowed(anjay_t *anjay_locked,
+                           anjay_iid_t iid,
+                           anjay_ssid_t ssid,
+                           anjay_request_action_t action) {
+    bool result;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    const anjay_action_info_t info = {
+        .oid = TEST_OID,
+        .iid = iid,
+        .ssid = ssid,
+        .action = action
+    };
+    result = _anjay_instance_action_allowed_by_acl(anjay, &info);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+static bool acl_cache_valid(anjay_t *anjay_locked) {
+    bool result;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    result = anjay->dm.acl.valid;
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+AVS_UNIT_TEST(access_control, cached_permissions) {
+    const anjay_dm_object_def_t *const *obj_defs[] = { &FAKE_SECURITY,
+                                                       &FAKE_SERVER, &TEST };
+    anjay_ssid_t ssids[] = { 1, 2 };
+    DM_TEST_INIT_GENERIC(obj_defs, ssids, DM_TEST_CONFIGURATION());
+    AVS_UNIT_ASSERT_SUCCESS(anjay_access_control_install(anjay));
+    ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+    avs_sched_del(&anjay_unlocked->servers->next_action_handle);
+    ANJAY_MUTEX_UNLOCK(anjay);
+    anjay_sched_run(anjay);
+
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &TEST, 0, (anjay_iid_t[]){ 1, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &FAKE_SERVER, 0,
+            (const anjay_iid_t[]) { 0, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &FAKE_SERVER, 0, 0,
+            (const anjay_mock_dm_res_entry_t[]) { { ANJAY_DM_RID_SERVER_SSID,
+                                                    ANJAY_DM_RES_R,
+                                                    ANJAY_DM_RES_PRESENT },
+                                                  ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, 0,
+                                        ANJAY_DM_RID_SERVER_SSID,
+                                        ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, 1));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_access_control_set_owner(anjay, TEST->oid, 1, 1, NULL));
+    AVS_UNIT_ASSERT_FALSE(acl_cache_valid(anjay));
+
+    // empty ACL: only the owner has access
+    AVS_UNIT_ASSERT_TRUE(action_allowed(anjay, 1, 1, ANJAY_ACTION_WRITE));
+    AVS_UNIT_ASSERT_TRUE(acl_cache_valid(anjay));
+    AVS_UNIT_ASSERT_FALSE(action_allowed(anjay, 1, 2, ANJAY_ACTION_READ));
+    AVS_UNIT_ASSERT_FALSE(action_allowed(anjay, 2, 1, ANJAY_ACTION_READ));
+
+    // changing the ACL invalidates the cache
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &FAKE_SERVER, 0,
+            (const anjay_iid_t[]) { 0, 1, ANJAY_ID_INVALID });
+    for (anjay_iid_t iid = 0; iid < 2; ++iid) {
+        _anjay_mock_dm_expect_list_resources(
+                anjay, &FAKE_SERVER, iid, 0,
+                (const anjay_mock_dm_res_entry_t[]) {
+                        { ANJAY_DM_RID_SERVER_SSID, ANJAY_DM_RES_R,
+                          ANJAY_DM_RES_PRESENT },
+                        ANJAY_MOCK_DM_RES_END });
+        _anjay_mock_dm_expect_resource_read(
+                anjay, &FAKE_SERVER, iid, ANJAY_DM_RID_SERVER_SSID,
+                ANJAY_ID_INVALID, 0, ANJAY_MOCK_DM_INT(0, iid + 1));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(anjay_access_control_set_acl(
+            anjay, TEST->oid, 1, 2, ANJAY_ACCESS_MASK_READ));
+    AVS_UNIT_ASSERT_FALSE(acl_cache_valid(anjay));
+    AVS_UNIT_ASSERT_TRUE(action_allowed(anjay, 1, 2, ANJAY_ACTION_READ));
+    AVS_UNIT_ASSERT_FALSE(action_allowed(anjay, 1, 2, ANJAY_ACTION_WRITE));
+    AVS_UNIT_ASSERT_FALSE(action_allowed(anjay, 1, 1, ANJAY_ACTION_WRITE));
+
+    // default ACL entry applies to Servers without a dedicated one
+    AVS_UNIT_ASSERT_SUCCESS(anjay_access_control_set_acl(
+            anjay, TEST->oid, 1, ANJAY_SSID_ANY, ANJAY_ACCESS_MASK_WRITE));
+    AVS_UNIT_ASSERT_TRUE(action_allowed(anjay, 1, 1, ANJAY_ACTION_WRITE));
+    AVS_UNIT_ASSERT_FALSE(action_allowed(anjay, 1, 2, ANJAY_ACTION_WRITE));
+    AVS_UNIT_ASSERT_TRUE(acl_cache_valid(anjay));
+
+    DM_TEST_FINISH;
+}
+
+static void expect_ssid_validation(anjay_t *anjay, anjay_ssid_t ssid) {
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &FAKE_SERVER, 0,
+            (const anjay_iid_t[]) { 0, ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_resources(
+            anjay, &FAKE_SERVER, 0, 0,
+            (const anjay_mock_dm_res_entry_t[]) { { ANJAY_DM_RID_SERVER_SSID,
+                                                    ANJAY_DM_RES_R,
+                                                    ANJAY_DM_RES_PRESENT },
+                                                  ANJAY_MOCK_DM_RES_END });
+    _anjay_mock_dm_expect_resource_read(anjay, &FAKE_SERVER, 0,
+                                        ANJAY_DM_RID_SERVER_SSID,
+                                        ANJAY_ID_INVALID, 0,
+                                        ANJAY_MOCK_DM_INT(0, ssid));
+}
+
+static void assert_ac_targets(anjay_t *anjay_locked,
+                              const anjay_iid_t *target_iids,
+                              size_t target_iids_count) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    access_control_t *ac = _anjay_access_control_get(anjay);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(ac->current.instances),
+                          target_iids_count);
+    for (size_t i = 0; i < target_iids_count; ++i) {
+        bool found = false;
+        AVS_LIST(access_control_instance_t) inst;
+        AVS_LIST_FOREACH(inst, ac->current.instances) {
+            if (inst->target.oid == TEST_OID
+                    && inst->target.iid == target_iids[i]) {
+                found = true;
+            }
+        }
+        AVS_UNIT_ASSERT_TRUE(found);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+AVS_UNIT_TEST(access_control, sync_adds_and_removes_instances) {
+    ACCESS_CONTROL_TEST_INIT;
+
+    const anjay_ssid_t ssid = 1;
+    {
+        ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+        anjay_notify_queue_t queue = NULL;
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_notify_queue_instance_created(&queue, TEST->oid, 1));
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_notify_queue_instance_created(&queue, TEST->oid, 2));
+
+        // transaction validation
+        _anjay_mock_dm_expect_list_instances(
+                anjay, &TEST, 0, (anjay_iid_t[]){ 1, 2, ANJAY_ID_INVALID });
+        expect_ssid_validation(anjay, ssid);
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_notify_flush(anjay_unlocked, ssid, &queue));
+        ANJAY_MUTEX_UNLOCK(anjay);
+    }
+    assert_ac_targets(anjay, (const anjay_iid_t[]) { 1, 2 }, 2);
+
+    {
+        ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+        anjay_notify_queue_t queue = NULL;
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_notify_queue_instance_removed(&queue, TEST->oid, 1));
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_notify_queue_instance_created(&queue, TEST->oid, 3));
+
+        // instance list of the target Object is retrieved once for all the
+        // Access Control instances referring to it
+        _anjay_mock_dm_expect_list_instances(
+                anjay, &TEST, 0, (anjay_iid_t[]){ 2, 3, ANJAY_ID_INVALID });
+        // transaction validation
+        _anjay_mock_dm_expect_list_instances(
+                anjay, &TEST, 0, (anjay_iid_t[]){ 2, 3, ANJAY_ID_INVALID });
+        expect_ssid_validation(anjay, ssid);
+        AVS_UNIT_ASSERT_SUCCESS(
+                _anjay_notify_flush(anjay_unlocked, ssid, &queue));
+        ANJAY_MUTEX_UNLOCK(anjay);
+    }
+    assert_ac_targets(anjay, (const anjay_iid_t[]) { 2, 3 }, 2);
+
+    DM_TEST_FINISH;
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/anjay_core.h"
+#include "tests/utils/dm.h"
+
+#ifdef ANJAY_WITH_DOWNLOADER
+static void enqueue_test_download(anjay_t *anjay_locked,
+                                  advanced_fw_repr_t *fw,
+                                  advanced_fw_instance_t *inst) {
+    anjay_download_config_t cfg = {
+        .url = "coap://127.0.0.1/fw",
+        .user_data = inst
+    };
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_UNIT_ASSERT_SUCCESS(enqueue_download(anjay, fw, inst, &cfg));
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    AVS_UNIT_ASSERT_EQUAL(inst->state,
+                          ANJAY_ADVANCED_FW_UPDATE_STATE_DOWNLOADING);
+}
+
+AVS_UNIT_TEST(advanced_fw_update, download_queue_ordered_by_severity) {
+    DM_TEST_INIT;
+    advanced_fw_repr_t fw = { 0 };
+    advanced_fw_instance_t instances[] = {
+        { .iid = 0, .severity = ANJAY_ADVANCED_FW_UPDATE_SEVERITY_OPTIONAL },
+        { .iid = 1, .severity = ANJAY_ADVANCED_FW_UPDATE_SEVERITY_MANDATORY },
+        { .iid = 2, .severity = ANJAY_ADVANCED_FW_UPDATE_SEVERITY_CRITICAL },
+        { .iid = 3, .severity = ANJAY_ADVANCED_FW_UPDATE_SEVERITY_MANDATORY },
+        { .iid = 4, .severity = ANJAY_ADVANCED_FW_UPDATE_SEVERITY_CRITICAL }
+    };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(instances); ++i) {
+        enqueue_test_download(anjay, &fw, &instances[i]);
+    }
+
+    // Critical first, FIFO within the same severity
+    static const anjay_iid_t EXPECTED_ORDER[] = { 2, 4, 1, 3, 0 };
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(fw.download_queue),
+                          AVS_ARRAY_SIZE(EXPECTED_ORDER));
+    size_t i = 0;
+    AVS_LIST(anjay_download_config_t) cfg;
+    AVS_LIST_FOREACH(cfg, fw.download_queue) {
+        AVS_UNIT_ASSERT_EQUAL(
+                ((advanced_fw_instance_t *) cfg->user_data)->iid,
+                EXPECTED_ORDER[i++]);
+    }
+
+    AVS_LIST_CLEAR(&fw.download_queue) {
+        download_queue_entry_cleanup(fw.download_queue);
+    }
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(advanced_fw_update, max_concurrent_downloads) {
+    advanced_fw_repr_t fw = { 0 };
+
+    // zero is equivalent to one download at a time
+    AVS_UNIT_ASSERT_TRUE(can_start_download_now(&fw));
+    AVS_UNIT_ASSERT_NOT_NULL(AVS_LIST_APPEND_NEW(current_download_t,
+                                                 &fw.current_downloads));
+    AVS_UNIT_ASSERT_FALSE(can_start_download_now(&fw));
+
+    fw.max_concurrent_downloads = 3;
+    AVS_UNIT_ASSERT_TRUE(can_start_download_now(&fw));
+    AVS_LIST(current_download_t) second =
+            AVS_LIST_APPEND_NEW(current_download_t, &fw.current_downloads);
+    AVS_UNIT_ASSERT_NOT_NULL(second);
+    second->iid = 1;
+    AVS_UNIT_ASSERT_TRUE(can_start_download_now(&fw));
+    AVS_UNIT_ASSERT_NOT_NULL(AVS_LIST_APPEND_NEW(current_download_t,
+                                                 &fw.current_downloads));
+    AVS_UNIT_ASSERT_FALSE(can_start_download_now(&fw));
+
+    AVS_UNIT_ASSERT_TRUE(find_current_download_ptr(&fw, 1)
+                         == AVS_LIST_NEXT_PTR(&fw.current_downloads));
+    AVS_UNIT_ASSERT_NULL(find_current_download_ptr(&fw, 2));
+
+    AVS_LIST_CLEAR(&fw.current_downloads);
+}
+#endif // ANJAY_WITH_DOWNLOADER
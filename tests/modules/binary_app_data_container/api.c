@@ -0,0 +1,269 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_mocksock.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/anjay_core.h"
+#include "src/core/servers/anjay_servers_internal.h"
+#include "tests/core/coap/utils.h"
+#include "tests/utils/dm.h"
+
+#define TEST_DATA_SIZE 600
+
+/**
+ * Storage of a single Data Resource Instance, /19/1/0/0.
+ */
+typedef struct {
+    uint8_t data[TEST_DATA_SIZE];
+    size_t reads;
+    size_t writes;
+    size_t last_write_offset;
+    size_t removals;
+    /** Writes at this offset or beyond fail, if nonzero. */
+    size_t fail_write_offset;
+} test_storage_t;
+
+static int test_storage_read(void *storage_,
+                             anjay_iid_t iid,
+                             anjay_riid_t riid,
+                             size_t offset,
+                             void *buf,
+                             size_t size) {
+    test_storage_t *storage = (test_storage_t *) storage_;
+    AVS_UNIT_ASSERT_EQUAL(iid, 1);
+    AVS_UNIT_ASSERT_EQUAL(riid, 0);
+    AVS_UNIT_ASSERT_TRUE(offset + size <= sizeof(storage->data));
+    AVS_UNIT_ASSERT_TRUE(size <= TRANSFER_CHUNK_SIZE);
+    ++storage->reads;
+    memcpy(buf, &storage->data[offset], size);
+    return 0;
+}
+
+static int test_storage_write(void *storage_,
+                              anjay_iid_t iid,
+                              anjay_riid_t riid,
+                              size_t offset,
+                              const void *data,
+                              size_t size) {
+    test_storage_t *storage = (test_storage_t *) storage_;
+    AVS_UNIT_ASSERT_EQUAL(iid, 1);
+    AVS_UNIT_ASSERT_EQUAL(riid, 0);
+    AVS_UNIT_ASSERT_TRUE(offset + size <= sizeof(storage->data));
+    AVS_UNIT_ASSERT_TRUE(size <= TRANSFER_CHUNK_SIZE);
+    if (storage->fail_write_offset && offset >= storage->fail_write_offset) {
+        return -1;
+    }
+    // data is passed to the storage in order, as it arrives
+    AVS_UNIT_ASSERT_TRUE(!storage->writes
+                         || offset > storage->last_write_offset);
+    ++storage->writes;
+    storage->last_write_offset = offset;
+    memcpy(&storage->data[offset], data, size);
+    return 0;
+}
+
+static void
+test_storage_remove(void *storage_, anjay_iid_t iid, anjay_riid_t riid) {
+    test_storage_t *storage = (test_storage_t *) storage_;
+    AVS_UNIT_ASSERT_EQUAL(iid, 1);
+    AVS_UNIT_ASSERT_EQUAL(riid, 0);
+    ++storage->removals;
+}
+
+static const anjay_badc_storage_handlers_t TEST_STORAGE_HANDLERS = {
+    .read = test_storage_read,
+    .write = test_storage_write,
+    .remove = test_storage_remove
+};
+
+static badc_object_t *badc_test_setup(anjay_t *anjay_locked,
+                                      test_storage_t *storage,
+                                      size_t max_data_size) {
+    AVS_UNIT_ASSERT_SUCCESS(anjay_badc_install(
+            anjay_locked, &(const anjay_badc_config_t) {
+                              .storage_handlers = &TEST_STORAGE_HANDLERS,
+                              .storage_user_ptr = storage,
+                              .max_data_size = max_data_size
+                          }));
+
+    // prevent sending Update, as that will fail in the test environment
+    _anjay_test_dm_unsched_notify_clb(anjay_locked);
+    badc_object_t *obj;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_server_info_t) server;
+    AVS_LIST_FOREACH(server, anjay->servers) {
+        avs_sched_del(&server->next_action_handle);
+    }
+    obj = (badc_object_t *) _anjay_dm_module_get_arg(anjay, badc_delete);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    AVS_UNIT_ASSERT_NOT_NULL(obj);
+    anjay_sched_run(anjay_locked);
+    return obj;
+}
+
+#define BADC_TEST_INIT(Storage, MaxDataSize)                 \
+    DM_TEST_INIT_WITH_OBJECTS(&FAKE_SECURITY, &FAKE_SERVER); \
+    badc_object_t *obj = badc_test_setup(anjay, (Storage), (MaxDataSize))
+
+static const badc_data_t *get_data(badc_object_t *obj,
+                                   anjay_iid_t iid,
+                                   anjay_riid_t riid) {
+    badc_instance_t *inst = find_instance(obj, iid);
+    if (!inst) {
+        return NULL;
+    }
+    AVS_LIST(badc_data_t) *data_ptr = find_data_ptr(inst, riid);
+    return (*data_ptr && (*data_ptr)->riid == riid) ? *data_ptr : NULL;
+}
+
+static void fill_pattern(uint8_t *buf, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        buf[i] = (uint8_t) ('a' + i % 26);
+    }
+}
+
+AVS_UNIT_TEST(badc, data_add) {
+    test_storage_t storage = { 0 };
+    BADC_TEST_INIT(&storage, 100);
+    AVS_UNIT_ASSERT_NULL(obj->instances);
+
+    // contents restored from the storage create the Instance if necessary
+    AVS_UNIT_ASSERT_SUCCESS(anjay_badc_data_add(anjay, 1, 3, 10));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_badc_data_add(anjay, 1, 0, 20));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(obj->instances), 1);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(obj->instances->data), 2);
+    // Resource Instances are kept sorted
+    AVS_UNIT_ASSERT_EQUAL(obj->instances->data->riid, 0);
+    AVS_UNIT_ASSERT_EQUAL(get_data(obj, 1, 0)->size, 20);
+    AVS_UNIT_ASSERT_EQUAL(get_data(obj, 1, 3)->size, 10);
+
+    // adding an existing Resource Instance updates its size
+    AVS_UNIT_ASSERT_SUCCESS(anjay_badc_data_add(anjay, 1, 3, 100));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(obj->instances->data), 2);
+    AVS_UNIT_ASSERT_EQUAL(get_data(obj, 1, 3)->size, 100);
+
+    AVS_UNIT_ASSERT_FAILED(anjay_badc_data_add(anjay, 1, 3, 101));
+    AVS_UNIT_ASSERT_EQUAL(get_data(obj, 1, 3)->size, 100);
+    AVS_UNIT_ASSERT_FAILED(anjay_badc_data_add(anjay, ANJAY_ID_INVALID, 0, 1));
+    AVS_UNIT_ASSERT_FAILED(anjay_badc_data_add(anjay, 2, ANJAY_ID_INVALID, 1));
+    AVS_UNIT_ASSERT_NULL(find_instance(obj, 2));
+    AVS_UNIT_ASSERT_NULL(find_instance(obj, ANJAY_ID_INVALID));
+    anjay_sched_run(anjay);
+
+    // nothing has been accessed in the storage
+    AVS_UNIT_ASSERT_EQUAL(storage.reads, 0);
+    AVS_UNIT_ASSERT_EQUAL(storage.writes, 0);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(badc, data_add_not_installed) {
+    DM_TEST_INIT_WITH_OBJECTS(&FAKE_SECURITY, &FAKE_SERVER);
+    AVS_UNIT_ASSERT_FAILED(anjay_badc_data_add(anjay, 1, 0, 1));
+    DM_TEST_FINISH;
+}
+
+#ifdef ANJAY_WITH_LWM2M11
+AVS_UNIT_TEST(badc, chunked_read) {
+    test_storage_t storage = { 0 };
+    fill_pattern(storage.data, sizeof(storage.data));
+    BADC_TEST_INIT(&storage, 0);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_badc_data_add(anjay, 1, 0, sizeof(storage.data)));
+    anjay_sched_run(anjay);
+
+    DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(0xFA3E),
+                    PATH("19", "1", "0", "0"), ACCEPT(0x2a), NO_PAYLOAD);
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(0xFA3E),
+                            CONTENT_FORMAT(OCTET_STREAM),
+                            PAYLOAD_EXTERNAL(storage.data,
+                                             sizeof(storage.data)));
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    // the contents are passed from the storage in TRANSFER_CHUNK_SIZE chunks
+    AVS_UNIT_ASSERT_EQUAL(storage.reads, 3);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(badc, incremental_write) {
+    test_storage_t storage = { 0 };
+    BADC_TEST_INIT(&storage, 0);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_badc_data_add(anjay, 1, 0, 0));
+    anjay_sched_run(anjay);
+
+    uint8_t payload[TEST_DATA_SIZE];
+    fill_pattern(payload, sizeof(payload));
+    DM_TEST_REQUEST(mocksocks[0], CON, PUT, ID(0xFA3E),
+                    PATH("19", "1", "0", "0"), CONTENT_FORMAT(OCTET_STREAM),
+                    PAYLOAD_EXTERNAL(payload, sizeof(payload)));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CHANGED, ID(0xFA3E), NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    anjay_sched_run(anjay);
+
+    AVS_UNIT_ASSERT_EQUAL(storage.writes, 3);
+    AVS_UNIT_ASSERT_EQUAL(storage.last_write_offset, 2 * TRANSFER_CHUNK_SIZE);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(storage.data, payload, sizeof(payload));
+    AVS_UNIT_ASSERT_EQUAL(get_data(obj, 1, 0)->size, sizeof(payload));
+    AVS_UNIT_ASSERT_EQUAL(storage.removals, 0);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(badc, failed_write_cleanup) {
+    test_storage_t storage = {
+        .fail_write_offset = TRANSFER_CHUNK_SIZE
+    };
+    BADC_TEST_INIT(&storage, 0);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_badc_data_add(anjay, 1, 0, 10));
+    anjay_sched_run(anjay);
+
+    uint8_t payload[TEST_DATA_SIZE];
+    fill_pattern(payload, sizeof(payload));
+    DM_TEST_REQUEST(mocksocks[0], CON, PUT, ID(0xFA3E),
+                    PATH("19", "1", "0", "0"), CONTENT_FORMAT(OCTET_STREAM),
+                    PAYLOAD_EXTERNAL(payload, sizeof(payload)));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, INTERNAL_SERVER_ERROR,
+                            ID(0xFA3E), NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    anjay_sched_run(anjay);
+
+    // incomplete contents are removed from the storage, and the Resource
+    // Instance is left empty
+    AVS_UNIT_ASSERT_EQUAL(storage.writes, 1);
+    AVS_UNIT_ASSERT_EQUAL(storage.removals, 1);
+    AVS_UNIT_ASSERT_NOT_NULL(get_data(obj, 1, 0));
+    AVS_UNIT_ASSERT_EQUAL(get_data(obj, 1, 0)->size, 0);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(badc, write_too_large) {
+    test_storage_t storage = { 0 };
+    BADC_TEST_INIT(&storage, TRANSFER_CHUNK_SIZE + 1);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_badc_data_add(anjay, 1, 0, 10));
+    anjay_sched_run(anjay);
+
+    uint8_t payload[TEST_DATA_SIZE];
+    fill_pattern(payload, sizeof(payload));
+    DM_TEST_REQUEST(mocksocks[0], CON, PUT, ID(0xFA3E),
+                    PATH("19", "1", "0", "0"), CONTENT_FORMAT(OCTET_STREAM),
+                    PAYLOAD_EXTERNAL(payload, sizeof(payload)));
+    DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, BAD_REQUEST, ID(0xFA3E),
+                            NO_PAYLOAD);
+    expect_has_buffered_data_check(mocksocks[0], false);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));
+    anjay_sched_run(anjay);
+
+    // the size limit is checked before each chunk is written
+    AVS_UNIT_ASSERT_EQUAL(storage.writes, 1);
+    AVS_UNIT_ASSERT_EQUAL(storage.removals, 1);
+    AVS_UNIT_ASSERT_EQUAL(get_data(obj, 1, 0)->size, 0);
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_LWM2M11
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_mocksock.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/anjay_core.h"
+#include "src/core/servers/anjay_servers_internal.h"
+#include "tests/core/coap/utils.h"
+#include "tests/utils/dm.h"
+#include "tests/utils/mock_clock.h"
+
+#define TEST_STORAGE_SIZE 256
+
+typedef struct {
+    uint8_t data[TEST_STORAGE_SIZE];
+    size_t reads;
+    size_t max_read_size;
+    bool fail_writes;
+} test_storage_t;
+
+static int
+test_storage_read(void *storage_, size_t offset, void *buf, size_t size) {
+    test_storage_t *storage = (test_storage_t *) storage_;
+    AVS_UNIT_ASSERT_TRUE(offset + size <= sizeof(storage->data));
+    ++storage->reads;
+    storage->max_read_size = AVS_MAX(storage->max_read_size, size);
+    memcpy(buf, &storage->data[offset], size);
+    return 0;
+}
+
+static int test_storage_write(void *storage_,
+                              size_t offset,
+                              const void *data,
+                              size_t size) {
+    test_storage_t *storage = (test_storage_t *) storage_;
+    AVS_UNIT_ASSERT_TRUE(offset + size <= sizeof(storage->data));
+    if (storage->fail_writes) {
+        return -1;
+    }
+    memcpy(&storage->data[offset], data, size);
+    return 0;
+}
+
+static const anjay_event_log_storage_handlers_t TEST_STORAGE_HANDLERS = {
+    .read = test_storage_read,
+    .write = test_storage_write
+};
+
+static anjay_event_log_t *event_log_test_setup(anjay_t *anjay_locked,
+                                               test_storage_t *storage,
+                                               size_t capacity,
+                                               bool start_collecting) {
+    AVS_UNIT_ASSERT_TRUE(!storage || capacity <= sizeof(storage->data));
+    anjay_event_log_t *log = anjay_event_log_install(
+            anjay_locked,
+            &(const anjay_event_log_config_t) {
+                .capacity = capacity,
+                .storage_handlers = storage ? &TEST_STORAGE_HANDLERS : NULL,
+                .storage_user_ptr = storage,
+                .start_collecting = start_collecting
+            });
+    AVS_UNIT_ASSERT_NOT_NULL(log);
+
+    // prevent sending Update, as that will fail in the test environment
+    _anjay_test_dm_unsched_notify_clb(anjay_locked);
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_server_info_t) server;
+    AVS_LIST_FOREACH(server, anjay->servers) {
+        avs_sched_del(&server->next_action_handle);
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    anjay_sched_run(anjay_locked);
+    return log;
+}
+
+#define EVENT_LOG_TEST_INIT(Storage, Capacity, StartCollecting) \
+    DM_TEST_INIT_WITH_OBJECTS(&FAKE_SECURITY, &FAKE_SERVER);    \
+    anjay_event_log_t *log =                                    \
+            event_log_test_setup(anjay, (Storage), (Capacity),  \
+                                 (StartCollecting))
+
+static void append_str(anjay_event_log_t *log, const char *str) {
+    AVS_UNIT_ASSERT_SUCCESS(anjay_event_log_append(log, str, strlen(str)));
+}
+
+#define EXPECT_LOG_DATA(Id, Payload)                                        \
+    do {                                                                    \
+        DM_TEST_REQUEST(mocksocks[0], CON, GET, ID(Id),                     \
+                        PATH("20", "0", "4014"), ACCEPT(0x2a), NO_PAYLOAD); \
+        DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CONTENT, ID(Id),         \
+                                CONTENT_FORMAT(OCTET_STREAM), Payload);     \
+        expect_has_buffered_data_check(mocksocks[0], false);                \
+        AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));          \
+    } while (0)
+
+#define EXECUTE(Id, Rid, ... /* Payload */)                         \
+    do {                                                            \
+        DM_TEST_REQUEST(mocksocks[0], CON, POST, ID(Id),            \
+                        PATH("20", "0", Rid), __VA_ARGS__);         \
+        DM_TEST_EXPECT_RESPONSE(mocksocks[0], ACK, CHANGED, ID(Id), \
+                                NO_PAYLOAD);                        \
+        expect_has_buffered_data_check(mocksocks[0], false);        \
+        AVS_UNIT_ASSERT_SUCCESS(anjay_serve(anjay, mocksocks[0]));  \
+        anjay_sched_run(anjay);                                     \
+    } while (0)
+
+AVS_UNIT_TEST(event_log, wraparound_eviction) {
+    // each entry takes 6 bytes including its header
+    EVENT_LOG_TEST_INIT(NULL, 16, true);
+    append_str(log, "aaaa");
+    append_str(log, "bbbb");
+    AVS_UNIT_ASSERT_EQUAL(log->start, 0);
+    AVS_UNIT_ASSERT_EQUAL(log->end, 12);
+
+    // the oldest entry is evicted, and the new one wraps around the storage
+    append_str(log, "cccc");
+    AVS_UNIT_ASSERT_EQUAL(log->start, 6);
+    AVS_UNIT_ASSERT_EQUAL(log->end, 18);
+    AVS_UNIT_ASSERT_EQUAL(log->data_size, 8);
+    anjay_sched_run(anjay);
+    EXPECT_LOG_DATA(0xFA3E, PAYLOAD("bbbbcccc"));
+
+    // a larger entry evicts as many entries as necessary
+    append_str(log, "0123456789");
+    AVS_UNIT_ASSERT_EQUAL(log->start, 18);
+    AVS_UNIT_ASSERT_EQUAL(log->end, 30);
+    AVS_UNIT_ASSERT_EQUAL(log->data_size, 10);
+    anjay_sched_run(anjay);
+    EXPECT_LOG_DATA(0xFA3F, PAYLOAD("0123456789"));
+
+    // entries that can never fit are rejected
+    AVS_UNIT_ASSERT_FAILED(anjay_event_log_append(log, "012345678901234", 15));
+    AVS_UNIT_ASSERT_EQUAL(log->data_size, 10);
+
+    DM_TEST_FINISH;
+}
+
+#define TIMES_10(Str) Str Str Str Str Str Str Str Str Str Str
+#define ENTRY_A TIMES_10("aaaaaaaaaa")
+#define ENTRY_B TIMES_10("bbbbbbbbbb")
+#define ENTRY_C "cc"
+
+AVS_UNIT_TEST(event_log, log_data_streamed_in_chunks) {
+    test_storage_t storage = { 0 };
+    EVENT_LOG_TEST_INIT(&storage, TEST_STORAGE_SIZE, true);
+    append_str(log, ENTRY_A);
+    append_str(log, ENTRY_B);
+    append_str(log, ENTRY_C);
+    anjay_sched_run(anjay);
+
+    storage.reads = 0;
+    EXPECT_LOG_DATA(0xFA3E, PAYLOAD(ENTRY_A ENTRY_B ENTRY_C));
+    // entry headers are not part of LogData, and the contents are never read
+    // into memory as a whole: each entry takes a header read and as many
+    // READ_CHUNK_SIZE reads as necessary
+    AVS_UNIT_ASSERT_EQUAL(storage.max_read_size, READ_CHUNK_SIZE);
+    AVS_UNIT_ASSERT_EQUAL(storage.reads, 3 + 3 + 2);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(event_log, log_start_stop) {
+    EVENT_LOG_TEST_INIT(NULL, 64, false);
+
+    // nothing is collected when stopped
+    append_str(log, "ignored");
+    AVS_UNIT_ASSERT_EQUAL(get_log_status(log), LOG_STATUS_STOPPED);
+    AVS_UNIT_ASSERT_NULL(log->notify_job);
+
+    EXECUTE(0xFA3E, "4011", NO_PAYLOAD);
+    AVS_UNIT_ASSERT_EQUAL(get_log_status(log), 0);
+    append_str(log, "abc");
+    AVS_UNIT_ASSERT_EQUAL(get_log_status(log), LOG_STATUS_DATA_VALID);
+
+    // LogStart with argument 0 set to 1 keeps the data
+    EXECUTE(0xFA3F, "4011", PAYLOAD("0='1'"));
+    AVS_UNIT_ASSERT_EQUAL(get_log_status(log), LOG_STATUS_DATA_VALID);
+    // and without it, the data is cleared
+    EXECUTE(0xFA40, "4011", NO_PAYLOAD);
+    AVS_UNIT_ASSERT_EQUAL(get_log_status(log), 0);
+
+    // LogStop keeps the data, unless argument 0 is set to 1
+    append_str(log, "abc");
+    EXECUTE(0xFA41, "4012", NO_PAYLOAD);
+    AVS_UNIT_ASSERT_EQUAL(get_log_status(log),
+                          LOG_STATUS_STOPPED | LOG_STATUS_DATA_VALID);
+    EXECUTE(0xFA42, "4012", PAYLOAD("0='1'"));
+    AVS_UNIT_ASSERT_EQUAL(get_log_status(log), LOG_STATUS_STOPPED);
+
+    // LogStart with argument 1 stops the collection after a delay
+    EXECUTE(0xFA43, "4011", PAYLOAD("1='5'"));
+    AVS_UNIT_ASSERT_EQUAL(get_log_status(log), 0);
+    AVS_UNIT_ASSERT_NOT_NULL(log->stop_job);
+    _anjay_mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_S));
+    anjay_sched_run(anjay);
+    AVS_UNIT_ASSERT_EQUAL(get_log_status(log), LOG_STATUS_STOPPED);
+    AVS_UNIT_ASSERT_NULL(log->stop_job);
+
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(event_log, failed_append_does_not_notify) {
+    test_storage_t storage = {
+        .fail_writes = true
+    };
+    EVENT_LOG_TEST_INIT(&storage, 64, true);
+    AVS_UNIT_ASSERT_FAILED(anjay_event_log_append(log, "abc", 3));
+    AVS_UNIT_ASSERT_FALSE(log->notify_pending);
+    AVS_UNIT_ASSERT_NULL(log->notify_job);
+    AVS_UNIT_ASSERT_EQUAL(get_log_status(log), LOG_STATUS_ERROR);
+
+    storage.fail_writes = false;
+    append_str(log, "abc");
+    AVS_UNIT_ASSERT_TRUE(log->notify_pending);
+    AVS_UNIT_ASSERT_NOT_NULL(log->notify_job);
+    anjay_sched_run(anjay);
+    AVS_UNIT_ASSERT_FALSE(log->notify_pending);
+    AVS_UNIT_ASSERT_EQUAL(get_log_status(log),
+                          LOG_STATUS_DATA_VALID | LOG_STATUS_ERROR);
+
+    DM_TEST_FINISH;
+}
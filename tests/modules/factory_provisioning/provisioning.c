@@ -64,3 +64,47 @@ AVS_UNIT_TEST(factory_provisioning, fail_rollback) {
     avs_stream_cleanup(&stream);
     DM_TEST_FINISH;
 }
+
+AVS_UNIT_TEST(factory_provisioning, bulk_fail_rollback) {
+    DM_TEST_INIT_WITH_OBJECTS(&OBJ_WITH_TRANSACTION, &FAKE_SECURITY,
+                              &FAKE_SERVER);
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    static const char PROVISIONING_DATA[] = "\x82" // array(2)
+                                            "\xa2" // map(2)
+                                            "\x00\x69"
+                                            "/69/420/2" // name: "/69/420/2"
+                                            "\x02\x01"  // value: 1
+                                            "\xa2"      // map(2)
+                                            "\x00\x69"
+                                            "/69/420/3" // name: "/69/420/3"
+                                            "\x02\x07"; // value: 7
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, PROVISIONING_DATA,
+                                             sizeof(PROVISIONING_DATA) - 1));
+    avs_unit_mocksock_expect_shutdown(mocksocks[0]);
+    // Implicit DELETE /
+    _anjay_mock_dm_expect_list_instances(
+            anjay, &FAKE_SERVER, 0, (const anjay_iid_t[]) { ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_list_instances(anjay, &OBJ_WITH_TRANSACTION, 0,
+                                         (const anjay_iid_t[]) {
+                                                 ANJAY_ID_INVALID });
+    // actual write; presence of /69/420 is checked only once
+    _anjay_mock_dm_expect_list_instances(anjay, &OBJ_WITH_TRANSACTION, 0,
+                                         (const anjay_iid_t[]) {
+                                                 ANJAY_ID_INVALID });
+    _anjay_mock_dm_expect_transaction_begin(anjay, &OBJ_WITH_TRANSACTION, 0);
+    _anjay_mock_dm_expect_instance_create(anjay, &OBJ_WITH_TRANSACTION, 420, 0);
+    _anjay_mock_dm_expect_resource_write(anjay, &OBJ_WITH_TRANSACTION, 420, 2,
+                                         ANJAY_ID_INVALID,
+                                         ANJAY_MOCK_DM_INT(0, 1), 0);
+    _anjay_mock_dm_expect_resource_write(anjay, &OBJ_WITH_TRANSACTION, 420, 3,
+                                         ANJAY_ID_INVALID,
+                                         ANJAY_MOCK_DM_INT(0, 7), 0);
+    // fail transaction validation
+    _anjay_mock_dm_expect_transaction_validate(anjay, &OBJ_WITH_TRANSACTION,
+                                               -1);
+    _anjay_mock_dm_expect_transaction_rollback(anjay, &OBJ_WITH_TRANSACTION, 0);
+    AVS_UNIT_ASSERT_FAILED(anjay_factory_provision_bulk(anjay, stream));
+    avs_stream_cleanup(&stream);
+    DM_TEST_FINISH;
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/anjay_core.h"
+#include "tests/utils/dm.h"
+
+#ifdef ANJAY_WITH_DOWNLOADER
+typedef struct {
+    size_t written;
+    size_t resets;
+
+    size_t persists;
+    size_t persisted_offset;
+    size_t discards;
+} checkpoint_env_t;
+
+static int checkpoint_stream_open(void *env_,
+                                  const char *package_uri,
+                                  const struct anjay_etag *package_etag) {
+    (void) env_;
+    (void) package_uri;
+    (void) package_etag;
+    return 0;
+}
+
+static int
+checkpoint_stream_write(void *env_, const void *data, size_t length) {
+    (void) data;
+    ((checkpoint_env_t *) env_)->written += length;
+    return 0;
+}
+
+static void checkpoint_reset(void *env_) {
+    ++((checkpoint_env_t *) env_)->resets;
+}
+
+static int
+checkpoint_persist_download_state(void *env_,
+                                  const char *package_uri,
+                                  const struct anjay_etag *package_etag,
+                                  size_t offset) {
+    checkpoint_env_t *env = (checkpoint_env_t *) env_;
+    if (!package_uri) {
+        AVS_UNIT_ASSERT_NULL(package_etag);
+        ++env->discards;
+        return 0;
+    }
+    AVS_UNIT_ASSERT_NOT_NULL(package_etag);
+    // state is only persisted after the data has been written
+    AVS_UNIT_ASSERT_EQUAL(offset, env->written);
+    ++env->persists;
+    env->persisted_offset = offset;
+    return 0;
+}
+
+static const anjay_fw_update_handlers_t CHECKPOINT_HANDLERS = {
+    .stream_open = checkpoint_stream_open,
+    .stream_write = checkpoint_stream_write,
+    .reset = checkpoint_reset,
+    .persist_download_state = checkpoint_persist_download_state
+};
+
+static anjay_etag_t *checkpoint_etag(void) {
+    anjay_etag_t *etag = anjay_etag_new(1);
+    AVS_UNIT_ASSERT_NOT_NULL(etag);
+    etag->value[0] = 0x42;
+    return etag;
+}
+
+static void checkpoint_write(anjay_t *anjay,
+                             fw_repr_t *fw,
+                             const anjay_etag_t *etag,
+                             size_t length) {
+    static const uint8_t DATA[256];
+    while (length > 0) {
+        size_t chunk = AVS_MIN(length, sizeof(DATA));
+        AVS_UNIT_ASSERT_SUCCESS(
+                download_write_block(anjay, DATA, chunk, etag, fw));
+        length -= chunk;
+    }
+}
+
+static void checkpoint_download_aborted(anjay_t *anjay, fw_repr_t *fw) {
+    download_finished(anjay,
+                      (anjay_download_status_t) {
+                          .result = ANJAY_DOWNLOAD_ERR_ABORTED
+                      },
+                      fw);
+}
+
+AVS_UNIT_TEST(fw_update_checkpoint, interval) {
+    DM_TEST_INIT;
+    checkpoint_env_t env = { 0 };
+    fw_repr_t fw = {
+        .user_state = {
+            .handlers = &CHECKPOINT_HANDLERS,
+            .arg = &env
+        },
+        .package_uri = "coap://127.0.0.1/fw",
+        .download_checkpoint_interval = 4
+    };
+    anjay_etag_t *etag = checkpoint_etag();
+
+    checkpoint_write(anjay, &fw, etag, 2);
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 0);
+    checkpoint_write(anjay, &fw, etag, 2);
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 1);
+    AVS_UNIT_ASSERT_EQUAL(env.persisted_offset, 4);
+    // a single large block results in a single checkpoint
+    checkpoint_write(anjay, &fw, etag, 10);
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 2);
+    AVS_UNIT_ASSERT_EQUAL(env.persisted_offset, 14);
+    checkpoint_write(anjay, &fw, etag, 3);
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 2);
+
+    // the checkpoint is discarded when the download ends
+    checkpoint_download_aborted(anjay, &fw);
+    AVS_UNIT_ASSERT_EQUAL(env.discards, 1);
+    AVS_UNIT_ASSERT_EQUAL(env.resets, 1);
+    AVS_UNIT_ASSERT_FALSE(fw.download_checkpointed);
+
+    avs_free(etag);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(fw_update_checkpoint, default_interval) {
+    DM_TEST_INIT;
+    checkpoint_env_t env = { 0 };
+    fw_repr_t fw = {
+        .user_state = {
+            .handlers = &CHECKPOINT_HANDLERS,
+            .arg = &env
+        },
+        .package_uri = "coap://127.0.0.1/fw"
+    };
+    anjay_etag_t *etag = checkpoint_etag();
+
+    checkpoint_write(anjay, &fw, etag,
+                     DEFAULT_DOWNLOAD_CHECKPOINT_INTERVAL - 1);
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 0);
+    checkpoint_write(anjay, &fw, etag, 1);
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 1);
+    AVS_UNIT_ASSERT_EQUAL(env.persisted_offset,
+                          DEFAULT_DOWNLOAD_CHECKPOINT_INTERVAL);
+
+    checkpoint_download_aborted(anjay, &fw);
+    AVS_UNIT_ASSERT_EQUAL(env.discards, 1);
+
+    avs_free(etag);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(fw_update_checkpoint, no_checkpoint_without_etag) {
+    DM_TEST_INIT;
+    checkpoint_env_t env = { 0 };
+    fw_repr_t fw = {
+        .user_state = {
+            .handlers = &CHECKPOINT_HANDLERS,
+            .arg = &env
+        },
+        .package_uri = "coap://127.0.0.1/fw",
+        .download_checkpoint_interval = 1
+    };
+
+    checkpoint_write(anjay, &fw, NULL, 8);
+    AVS_UNIT_ASSERT_EQUAL(env.written, 8);
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 0);
+
+    // nothing to discard
+    checkpoint_download_aborted(anjay, &fw);
+    AVS_UNIT_ASSERT_EQUAL(env.discards, 0);
+    AVS_UNIT_ASSERT_EQUAL(env.resets, 1);
+
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_DOWNLOADER
@@ -0,0 +1,334 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_mocksock.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/anjay_core.h"
+#include "tests/core/coap/utils.h"
+#include "tests/utils/dm.h"
+
+#define TEST_MAGIC "PTCH"
+#define TEST_MAGIC_SIZE (sizeof(TEST_MAGIC) - 1)
+
+/**
+ * Test patch format: TEST_MAGIC, followed by bytes to be XOR-ed with the
+ * currently installed image at the same offset.
+ */
+typedef struct {
+    uint8_t current_image[16];
+    uint8_t out[64];
+    size_t out_size;
+
+    size_t stream_opens;
+    size_t patch_consumed;
+    size_t patch_opens;
+    size_t patch_finishes;
+    size_t patch_closes;
+
+    size_t persists;
+    size_t persisted_offset;
+} delta_env_t;
+
+static int test_stream_open(void *env_,
+                            const char *package_uri,
+                            const struct anjay_etag *package_etag) {
+    (void) package_uri;
+    (void) package_etag;
+    ++((delta_env_t *) env_)->stream_opens;
+    return 0;
+}
+
+static int test_stream_write(void *env_, const void *data, size_t length) {
+    delta_env_t *env = (delta_env_t *) env_;
+    AVS_UNIT_ASSERT_TRUE(env->out_size + length <= sizeof(env->out));
+    memcpy(env->out + env->out_size, data, length);
+    env->out_size += length;
+    return 0;
+}
+
+static int test_read_current_image(void *env_,
+                                   size_t offset,
+                                   void *buffer,
+                                   size_t length) {
+    delta_env_t *env = (delta_env_t *) env_;
+    AVS_UNIT_ASSERT_TRUE(offset + length <= sizeof(env->current_image));
+    memcpy(buffer, env->current_image + offset, length);
+    return 0;
+}
+
+static int test_persist_download_state(void *env_,
+                                       const char *package_uri,
+                                       const struct anjay_etag *package_etag,
+                                       size_t offset) {
+    delta_env_t *env = (delta_env_t *) env_;
+    AVS_UNIT_ASSERT_NOT_NULL(package_uri);
+    AVS_UNIT_ASSERT_NOT_NULL(package_etag);
+    ++env->persists;
+    env->persisted_offset = offset;
+    return 0;
+}
+
+static int test_patch_open(void *env_, void **out_patch_ctx) {
+    delta_env_t *env = (delta_env_t *) env_;
+    ++env->patch_opens;
+    *out_patch_ctx = env;
+    return 0;
+}
+
+static int test_patch_write(void *env_,
+                            const void *data,
+                            size_t length,
+                            const anjay_fw_update_delta_io_t *io) {
+    delta_env_t *env = (delta_env_t *) env_;
+    const uint8_t *bytes = (const uint8_t *) data;
+    for (size_t i = 0; i < length; ++i, ++env->patch_consumed) {
+        if (env->patch_consumed < TEST_MAGIC_SIZE) {
+            AVS_UNIT_ASSERT_EQUAL(bytes[i],
+                                  (uint8_t) TEST_MAGIC[env->patch_consumed]);
+            continue;
+        }
+        uint8_t byte;
+        AVS_UNIT_ASSERT_SUCCESS(io->read_current_image(
+                io, env->patch_consumed - TEST_MAGIC_SIZE, &byte, 1));
+        byte ^= bytes[i];
+        AVS_UNIT_ASSERT_SUCCESS(io->write_image(io, &byte, 1));
+    }
+    return 0;
+}
+
+static int test_patch_finish(void *env_, const anjay_fw_update_delta_io_t *io) {
+    (void) io;
+    ++((delta_env_t *) env_)->patch_finishes;
+    return 0;
+}
+
+static void test_patch_close(void *env_) {
+    ++((delta_env_t *) env_)->patch_closes;
+}
+
+static const anjay_fw_update_delta_patcher_t TEST_PATCHER = {
+    .magic = TEST_MAGIC,
+    .magic_size = TEST_MAGIC_SIZE,
+    .open = test_patch_open,
+    .write = test_patch_write,
+    .finish = test_patch_finish,
+    .close = test_patch_close
+};
+
+static const anjay_fw_update_handlers_t TEST_HANDLERS = {
+    .stream_open = test_stream_open,
+    .stream_write = test_stream_write,
+    .persist_download_state = test_persist_download_state,
+    .delta_patcher = &TEST_PATCHER,
+    .read_current_image = test_read_current_image
+};
+
+static void write_str(fw_user_state_t *user, const char *str) {
+    AVS_UNIT_ASSERT_SUCCESS(
+            delta_stream_write(user, (const uint8_t *) str, strlen(str)));
+}
+
+AVS_UNIT_TEST(fw_update_delta, full_image) {
+    delta_env_t env = { 0 };
+    fw_user_state_t user = {
+        .handlers = &TEST_HANDLERS,
+        .arg = &env
+    };
+
+    // prefix of the magic is held until it can be decided
+    write_str(&user, "PT");
+    AVS_UNIT_ASSERT_EQUAL(user.delta_mode, DELTA_MODE_UNDECIDED);
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, 0);
+
+    write_str(&user, "Xyz");
+    AVS_UNIT_ASSERT_EQUAL(user.delta_mode, DELTA_MODE_FULL_IMAGE);
+    write_str(&user, "PTCH");
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.out, "PTXyzPTCH", env.out_size);
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, strlen("PTXyzPTCH"));
+
+    AVS_UNIT_ASSERT_SUCCESS(delta_stream_finish(&user));
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, strlen("PTXyzPTCH"));
+    AVS_UNIT_ASSERT_EQUAL(env.patch_opens, 0);
+    AVS_UNIT_ASSERT_EQUAL(env.patch_closes, 0);
+    AVS_UNIT_ASSERT_EQUAL(user.delta_mode, DELTA_MODE_UNDECIDED);
+}
+
+AVS_UNIT_TEST(fw_update_delta, patch_image) {
+    delta_env_t env = {
+        .current_image = { 0x10, 0x20, 0x30 }
+    };
+    fw_user_state_t user = {
+        .handlers = &TEST_HANDLERS,
+        .arg = &env
+    };
+
+    write_str(&user, "PTC");
+    AVS_UNIT_ASSERT_EQUAL(user.delta_mode, DELTA_MODE_UNDECIDED);
+    AVS_UNIT_ASSERT_EQUAL(env.patch_opens, 0);
+
+    // rest of the magic and the patch body in a single chunk
+    write_str(&user, "H\x11\x22\x33");
+    AVS_UNIT_ASSERT_EQUAL(user.delta_mode, DELTA_MODE_PATCH);
+    AVS_UNIT_ASSERT_EQUAL(env.patch_opens, 1);
+    AVS_UNIT_ASSERT_EQUAL(env.patch_consumed, TEST_MAGIC_SIZE + 3);
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.out, "\x01\x02\x03", 3);
+
+    AVS_UNIT_ASSERT_SUCCESS(delta_stream_finish(&user));
+    AVS_UNIT_ASSERT_EQUAL(env.patch_finishes, 1);
+    AVS_UNIT_ASSERT_EQUAL(env.patch_closes, 1);
+    AVS_UNIT_ASSERT_NULL(user.delta_ctx);
+    AVS_UNIT_ASSERT_EQUAL(user.delta_mode, DELTA_MODE_UNDECIDED);
+}
+
+AVS_UNIT_TEST(fw_update_delta, short_header) {
+    delta_env_t env = { 0 };
+    fw_user_state_t user = {
+        .handlers = &TEST_HANDLERS,
+        .arg = &env
+    };
+
+    // whole package is a prefix of the magic
+    write_str(&user, "PT");
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(delta_stream_finish(&user));
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.out, "PT", 2);
+    AVS_UNIT_ASSERT_EQUAL(env.patch_opens, 0);
+    AVS_UNIT_ASSERT_EQUAL(user.delta_magic_size, 0);
+}
+
+AVS_UNIT_TEST(fw_update_delta, abort_closes_patch) {
+    delta_env_t env = { 0 };
+    fw_user_state_t user = {
+        .handlers = &TEST_HANDLERS,
+        .arg = &env
+    };
+
+    write_str(&user, "PTCH");
+    AVS_UNIT_ASSERT_EQUAL(user.delta_mode, DELTA_MODE_PATCH);
+    delta_reset(&user);
+    AVS_UNIT_ASSERT_EQUAL(env.patch_finishes, 0);
+    AVS_UNIT_ASSERT_EQUAL(env.patch_closes, 1);
+    AVS_UNIT_ASSERT_NULL(user.delta_ctx);
+    AVS_UNIT_ASSERT_EQUAL(user.delta_mode, DELTA_MODE_UNDECIDED);
+}
+
+#ifdef ANJAY_WITH_DOWNLOADER
+static anjay_etag_t *test_etag(void) {
+    anjay_etag_t *etag = anjay_etag_new(1);
+    AVS_UNIT_ASSERT_NOT_NULL(etag);
+    etag->value[0] = 0x42;
+    return etag;
+}
+
+static void write_block(anjay_t *anjay,
+                        fw_repr_t *fw,
+                        const anjay_etag_t *etag,
+                        const char *str) {
+    AVS_UNIT_ASSERT_SUCCESS(download_write_block(
+            anjay, (const uint8_t *) str, strlen(str), etag, fw));
+}
+
+AVS_UNIT_TEST(fw_update_delta, no_checkpoint_while_magic_held) {
+    DM_TEST_INIT;
+    delta_env_t env = { 0 };
+    fw_repr_t fw = {
+        .user_state = {
+            .handlers = &TEST_HANDLERS,
+            .arg = &env
+        },
+        .package_uri = "coap://127.0.0.1/fw",
+        .download_checkpoint_interval = 1
+    };
+    anjay_etag_t *etag = test_etag();
+
+    write_block(anjay, &fw, etag, "PT");
+    AVS_UNIT_ASSERT_EQUAL(env.stream_opens, 1);
+    AVS_UNIT_ASSERT_EQUAL(fw.download_offset, 2);
+    // the two bytes have not reached stream_write yet, so resuming at offset
+    // 2 would lose them
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, 0);
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 0);
+
+    write_block(anjay, &fw, etag, "Xy");
+    AVS_UNIT_ASSERT_EQUAL(fw.user_state.delta_mode, DELTA_MODE_FULL_IMAGE);
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, 4);
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 1);
+    AVS_UNIT_ASSERT_EQUAL(env.persisted_offset, 4);
+
+    delta_reset(&fw.user_state);
+    avs_free(etag);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(fw_update_delta, no_checkpoint_for_patch) {
+    DM_TEST_INIT;
+    delta_env_t env = { 0 };
+    fw_repr_t fw = {
+        .user_state = {
+            .handlers = &TEST_HANDLERS,
+            .arg = &env
+        },
+        .package_uri = "coap://127.0.0.1/fw",
+        .download_checkpoint_interval = 1
+    };
+    anjay_etag_t *etag = test_etag();
+
+    write_block(anjay, &fw, etag, "PTCH");
+    write_block(anjay, &fw, etag, "\x01\x02");
+    AVS_UNIT_ASSERT_EQUAL(fw.user_state.delta_mode, DELTA_MODE_PATCH);
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, 2);
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 0);
+
+    delta_reset(&fw.user_state);
+    AVS_UNIT_ASSERT_EQUAL(env.patch_closes, 1);
+    avs_free(etag);
+    DM_TEST_FINISH;
+}
+
+AVS_UNIT_TEST(fw_update_delta, resume_after_interruption) {
+    DM_TEST_INIT;
+    delta_env_t env = { 0 };
+    // state as set up by initialize_fw_repr() when resuming at offset 4
+    fw_repr_t fw = {
+        .user_state = {
+            .handlers = &TEST_HANDLERS,
+            .arg = &env,
+            .state = UPDATE_STATE_DOWNLOADING,
+            .delta_mode = DELTA_MODE_FULL_IMAGE
+        },
+        .package_uri = "coap://127.0.0.1/fw",
+        .download_checkpoint_interval = 4,
+        .download_offset = 4,
+        .last_checkpoint_offset = 4
+    };
+    anjay_etag_t *etag = test_etag();
+
+    // data in the middle of a full image is never taken for a patch header
+    write_block(anjay, &fw, etag, "PTCH");
+    AVS_UNIT_ASSERT_EQUAL(env.stream_opens, 0);
+    AVS_UNIT_ASSERT_EQUAL(env.patch_opens, 0);
+    AVS_UNIT_ASSERT_EQUAL(env.out_size, 4);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(env.out, "PTCH", 4);
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 1);
+    AVS_UNIT_ASSERT_EQUAL(env.persisted_offset, 8);
+
+    write_block(anjay, &fw, etag, "ab");
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 1);
+    write_block(anjay, &fw, etag, "cd");
+    AVS_UNIT_ASSERT_EQUAL(env.persists, 2);
+    AVS_UNIT_ASSERT_EQUAL(env.persisted_offset, 12);
+
+    avs_free(etag);
+    DM_TEST_FINISH;
+}
+#endif // ANJAY_WITH_DOWNLOADER
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/anjay_core.h"
+
+#define TEST_OID 3313
+
+static const anjay_ipso_v2_3d_sensor_meta_t TEST_META = {
+    .unit = "m/s2",
+    .y_axis_present = true,
+    .z_axis_present = true,
+    .min_max_measured_value_present = true,
+    .min_range_value = NAN,
+    .max_range_value = NAN
+};
+
+static anjay_t *sensor_test_anjay_new(void) {
+    const anjay_configuration_t config = {
+        .endpoint_name = "test"
+    };
+    anjay_t *anjay = anjay_new(&config);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_ipso_v2_3d_sensor_install(anjay, TEST_OID, NULL, 1));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_3d_sensor_instance_add(
+            anjay, TEST_OID, 0,
+            &(const anjay_ipso_v2_3d_sensor_value_t) { 0.0, 0.0, 0.0 },
+            &TEST_META));
+    return anjay;
+}
+
+static void assert_value_equal(const sensor_value_t *actual,
+                               double x,
+                               double y,
+                               double z) {
+    AVS_UNIT_ASSERT_EQUAL(actual->x, x);
+    AVS_UNIT_ASSERT_EQUAL(actual->y, y);
+    AVS_UNIT_ASSERT_EQUAL(actual->z, z);
+}
+
+static instance_t *sensor_test_instance(anjay_t *anjay_locked) {
+    instance_t *inst = NULL;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    object_t *obj = obj_from_oid(anjay, TEST_OID);
+    AVS_UNIT_ASSERT_NOT_NULL(obj);
+    inst = &obj->instances[0];
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return inst;
+}
+
+AVS_UNIT_TEST(ipso_v2_3d_sensor, samples_update) {
+    anjay_t *anjay = sensor_test_anjay_new();
+
+    const sensor_value_t samples[] = {
+        { 1.0, 2.0, 2.0 },
+        { -3.0, 0.0, 4.0 },
+        { 0.5, -1.0, 0.0 }
+    };
+    double max_magnitude = 0.0;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_3d_sensor_samples_update(
+            anjay, TEST_OID, 0, samples, AVS_ARRAY_SIZE(samples),
+            &max_magnitude));
+    AVS_UNIT_ASSERT_EQUAL(max_magnitude, 5.0);
+
+    const instance_t *inst = sensor_test_instance(anjay);
+    // the last sample is the current value
+    assert_value_equal(&inst->curr_value, 0.5, -1.0, 0.0);
+    // extremes of the whole batch
+    assert_value_equal(&inst->min_value, -3.0, -1.0, 0.0);
+    assert_value_equal(&inst->max_value, 1.0, 2.0, 4.0);
+
+    // extremes outside of the previous range only are applied
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_3d_sensor_samples_update(
+            anjay, TEST_OID, 0,
+            (const sensor_value_t[]) { { 2.0, 0.0, 0.0 } }, 1, NULL));
+    assert_value_equal(&inst->curr_value, 2.0, 0.0, 0.0);
+    assert_value_equal(&inst->min_value, -3.0, -1.0, 0.0);
+    assert_value_equal(&inst->max_value, 2.0, 2.0, 4.0);
+
+    anjay_delete(anjay);
+}
+
+AVS_UNIT_TEST(ipso_v2_3d_sensor, samples_update_invalid) {
+    anjay_t *anjay = sensor_test_anjay_new();
+
+    // a single invalid sample rejects the whole batch
+    const sensor_value_t samples[] = {
+        { 1.0, 1.0, 1.0 },
+        { 2.0, NAN, 2.0 },
+        { 3.0, 3.0, 3.0 }
+    };
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_3d_sensor_samples_update(
+            anjay, TEST_OID, 0, samples, AVS_ARRAY_SIZE(samples), NULL));
+    const instance_t *inst = sensor_test_instance(anjay);
+    assert_value_equal(&inst->curr_value, 0.0, 0.0, 0.0);
+    assert_value_equal(&inst->max_value, 0.0, 0.0, 0.0);
+
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_3d_sensor_samples_update(
+            anjay, TEST_OID, 0, samples, 0, NULL));
+    // the object has a single instance
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_3d_sensor_samples_update(
+            anjay, TEST_OID, 1, samples, 1, NULL));
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_3d_sensor_samples_update(
+            anjay, TEST_OID + 1, 0, samples, 1, NULL));
+
+    anjay_delete(anjay);
+}
@@ -0,0 +1,308 @@
+/*
+ * Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+ * AVSystem Anjay LwM2M SDK
+ * All rights reserved.
+ *
+ * Licensed under the AVSystem-5-clause License.
+ * See the attached LICENSE file for details.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "src/core/anjay_core.h"
+
+#define TEST_OID 3303
+
+static const anjay_ipso_v2_basic_sensor_meta_t TEST_META = {
+    .unit = "Cel",
+    .min_max_measured_value_present = true,
+    .min_range_value = NAN,
+    .max_range_value = NAN
+};
+
+static anjay_t *sensor_test_anjay_new(size_t instance_count) {
+    const anjay_configuration_t config = {
+        .endpoint_name = "test"
+    };
+    anjay_t *anjay = anjay_new(&config);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_install(
+            anjay, TEST_OID, NULL, instance_count));
+    return anjay;
+}
+
+static instance_t *sensor_test_instance(anjay_t *anjay_locked,
+                                        anjay_iid_t iid) {
+    instance_t *inst = NULL;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    object_t *obj = obj_from_oid(anjay, TEST_OID);
+    AVS_UNIT_ASSERT_NOT_NULL(obj);
+    AVS_UNIT_ASSERT_TRUE(iid < obj->instance_count);
+    inst = &obj->instances[iid];
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return inst;
+}
+
+/**
+ * Returns the number of Resources of TEST_OID queued for notification, and
+ * checks that a single notify job is scheduled to handle all of them.
+ */
+static size_t notified_resources_count(anjay_t *anjay_locked) {
+    size_t result = 0;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_notify_queue_object_entry_t) entry;
+    AVS_LIST_FOREACH(entry, anjay->scheduled_notify.queue) {
+        if (entry->oid == TEST_OID) {
+            result = AVS_LIST_SIZE(entry->resources_changed);
+        }
+    }
+    AVS_UNIT_ASSERT_TRUE(!result || anjay->scheduled_notify.handle);
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    return result;
+}
+
+AVS_UNIT_TEST(ipso_v2_basic_sensor, values_update) {
+    anjay_t *anjay = sensor_test_anjay_new(3);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_OID, 0, 20.0, &TEST_META));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_OID, 1, 20.0, &TEST_META));
+    // process the instance set changes
+    anjay_sched_run(anjay);
+    AVS_UNIT_ASSERT_EQUAL(notified_resources_count(anjay), 0);
+
+    const anjay_ipso_v2_basic_sensor_value_entry_t entries[] = {
+        { 0, 25.0 },
+        { 1, 15.0 }
+    };
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_values_update(
+            anjay, TEST_OID, entries, AVS_ARRAY_SIZE(entries)));
+    const instance_t *inst0 = sensor_test_instance(anjay, 0);
+    const instance_t *inst1 = sensor_test_instance(anjay, 1);
+    AVS_UNIT_ASSERT_EQUAL(inst0->curr_value, 25.0);
+    AVS_UNIT_ASSERT_EQUAL(inst0->max_value, 25.0);
+    AVS_UNIT_ASSERT_EQUAL(inst0->min_value, 20.0);
+    AVS_UNIT_ASSERT_EQUAL(inst1->curr_value, 15.0);
+    AVS_UNIT_ASSERT_EQUAL(inst1->min_value, 15.0);
+    AVS_UNIT_ASSERT_EQUAL(inst1->max_value, 20.0);
+    // Sensor Value and Max or Min Measured Value of each instance, all
+    // handled by the same notify job
+    AVS_UNIT_ASSERT_EQUAL(notified_resources_count(anjay), 4);
+
+    anjay_delete(anjay);
+}
+
+AVS_UNIT_TEST(ipso_v2_basic_sensor, values_update_invalid_entries) {
+    anjay_t *anjay = sensor_test_anjay_new(2);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_OID, 0, 20.0, &TEST_META));
+
+    // instance 1 is not initialized, and 2 is out of range - the valid entries
+    // are applied nevertheless
+    const anjay_ipso_v2_basic_sensor_value_entry_t entries[] = {
+        { 1, 30.0 },
+        { 2, 30.0 },
+        { 0, 30.0 },
+        { 0, NAN }
+    };
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_basic_sensor_values_update(
+            anjay, TEST_OID, entries, AVS_ARRAY_SIZE(entries)));
+    AVS_UNIT_ASSERT_EQUAL(sensor_test_instance(anjay, 0)->curr_value, 30.0);
+    AVS_UNIT_ASSERT_FALSE(sensor_test_instance(anjay, 1)->initialized);
+
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_basic_sensor_values_update(
+            anjay, TEST_OID + 1, entries, AVS_ARRAY_SIZE(entries)));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_ipso_v2_basic_sensor_values_update(anjay, TEST_OID, NULL, 0));
+
+    anjay_delete(anjay);
+}
+
+static void assert_history(anjay_t *anjay_locked,
+                           anjay_iid_t iid,
+                           const double *values,
+                           size_t values_count) {
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    object_t *obj = obj_from_oid(anjay, TEST_OID);
+    AVS_UNIT_ASSERT_NOT_NULL(obj);
+    const instance_t *inst = &obj->instances[iid];
+    AVS_UNIT_ASSERT_EQUAL(inst->history_count, values_count);
+    for (size_t i = 0; i < values_count; ++i) {
+        const sample_t *sample =
+                &inst->history[(inst->history_start + i)
+                               % obj->history_capacity];
+        AVS_UNIT_ASSERT_EQUAL(sample->value, values[i]);
+        AVS_UNIT_ASSERT_TRUE(avs_time_real_valid(sample->timestamp));
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+}
+
+AVS_UNIT_TEST(ipso_v2_basic_sensor, history) {
+    const anjay_configuration_t config = {
+        .endpoint_name = "test"
+    };
+    anjay_t *anjay = anjay_new(&config);
+    AVS_UNIT_ASSERT_NOT_NULL(anjay);
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_basic_sensor_install_with_history(
+            anjay, TEST_OID, NULL, 2, SIZE_MAX / 2));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_install_with_history(
+            anjay, TEST_OID, NULL, 2, 3));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_OID, 0, 20.0, &TEST_META));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_OID, 1, 20.0, &TEST_META));
+    assert_history(anjay, 0, NULL, 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_ipso_v2_basic_sensor_value_update(anjay, TEST_OID, 0, 1.0));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_ipso_v2_basic_sensor_value_update(anjay, TEST_OID, 0, 2.0));
+    assert_history(anjay, 0, (const double[]) { 1.0, 2.0 }, 2);
+    // repeated values are recorded as well
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_ipso_v2_basic_sensor_value_update(anjay, TEST_OID, 0, 2.0));
+    // the oldest sample is overwritten
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_ipso_v2_basic_sensor_value_update(anjay, TEST_OID, 0, 4.0));
+    assert_history(anjay, 0, (const double[]) { 2.0, 2.0, 4.0 }, 3);
+    // each instance has its own history
+    assert_history(anjay, 1, NULL, 0);
+
+    // re-adding the instance discards its history
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_ipso_v2_basic_sensor_instance_remove(anjay, TEST_OID, 0));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_OID, 0, 20.0, &TEST_META));
+    assert_history(anjay, 0, NULL, 0);
+
+#ifdef ANJAY_WITH_SEND
+    // nothing to send
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_history_send(
+            anjay, TEST_OID, ANJAY_ID_INVALID, 1));
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_ipso_v2_basic_sensor_history_send(anjay, TEST_OID, 2, 1));
+#endif // ANJAY_WITH_SEND
+
+    anjay_delete(anjay);
+}
+
+#define ASSERT_ALMOST_EQ(a, b) AVS_UNIT_ASSERT_TRUE(fabs((a) - (b)) < 1e-9)
+
+AVS_UNIT_TEST(ipso_v2_basic_sensor, aggregates) {
+    anjay_t *anjay = sensor_test_anjay_new(1);
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_OID, 0, 20.0, &TEST_META));
+
+    anjay_ipso_v2_basic_sensor_aggregates_t aggregates;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_aggregates_get(
+            anjay, TEST_OID, 0, &aggregates));
+    AVS_UNIT_ASSERT_EQUAL(aggregates.count, 0);
+    AVS_UNIT_ASSERT_TRUE(isnan(aggregates.mean));
+    AVS_UNIT_ASSERT_TRUE(isnan(aggregates.variance));
+
+    static const double VALUES[] = { 2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0 };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(VALUES); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_value_update(
+                anjay, TEST_OID, 0, VALUES[i]));
+    }
+    // rejected values are not taken into account
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_ipso_v2_basic_sensor_value_update(anjay, TEST_OID, 0, NAN));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_aggregates_get(
+            anjay, TEST_OID, 0, &aggregates));
+    AVS_UNIT_ASSERT_EQUAL(aggregates.count, AVS_ARRAY_SIZE(VALUES));
+    ASSERT_ALMOST_EQ(aggregates.mean, 5.0);
+    ASSERT_ALMOST_EQ(aggregates.variance, 4.0);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_ipso_v2_basic_sensor_aggregates_reset(anjay, TEST_OID, 0));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_ipso_v2_basic_sensor_value_update(anjay, TEST_OID, 0, 1.0));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_aggregates_get(
+            anjay, TEST_OID, 0, &aggregates));
+    AVS_UNIT_ASSERT_EQUAL(aggregates.count, 1);
+    ASSERT_ALMOST_EQ(aggregates.mean, 1.0);
+    ASSERT_ALMOST_EQ(aggregates.variance, 0.0);
+
+    // executing Reset Min and Max Measured Values resets the aggregates too
+    {
+        ANJAY_MUTEX_LOCK(anjay_unlocked, anjay);
+        object_t *obj = obj_from_oid(anjay_unlocked, TEST_OID);
+        AVS_UNIT_ASSERT_NOT_NULL(obj);
+        AVS_UNIT_ASSERT_SUCCESS(
+                resource_execute(anjay_unlocked, obj->installed_obj, 0,
+                                 RID_RESET_MIN_AND_MAX_MEASURED_VALUES, NULL));
+        ANJAY_MUTEX_UNLOCK(anjay);
+    }
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_aggregates_get(
+            anjay, TEST_OID, 0, &aggregates));
+    AVS_UNIT_ASSERT_EQUAL(aggregates.count, 0);
+
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_basic_sensor_aggregates_get(
+            anjay, TEST_OID, 1, &aggregates));
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_ipso_v2_basic_sensor_aggregates_reset(anjay, TEST_OID, 1));
+
+    anjay_delete(anjay);
+}
+
+#undef ASSERT_ALMOST_EQ
+
+/**
+ * Checks whether a change of the Sensor Value of instance @p iid has been
+ * queued for notification, and flushes the queue.
+ */
+static bool sensor_value_notified(anjay_t *anjay_locked, anjay_iid_t iid) {
+    bool result = false;
+    ANJAY_MUTEX_LOCK(anjay, anjay_locked);
+    AVS_LIST(anjay_notify_queue_object_entry_t) entry;
+    AVS_LIST_FOREACH(entry, anjay->scheduled_notify.queue) {
+        if (entry->oid != TEST_OID) {
+            continue;
+        }
+        AVS_LIST(anjay_notify_queue_resource_entry_t) res;
+        AVS_LIST_FOREACH(res, entry->resources_changed) {
+            if (res->iid == iid && res->rid == RID_SENSOR_VALUE) {
+                result = true;
+            }
+        }
+    }
+    ANJAY_MUTEX_UNLOCK(anjay_locked);
+    anjay_sched_run(anjay_locked);
+    return result;
+}
+
+static void sensor_test_update(anjay_t *anjay, double value) {
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_ipso_v2_basic_sensor_value_update(anjay, TEST_OID, 0, value));
+    AVS_UNIT_ASSERT_EQUAL(sensor_test_instance(anjay, 0)->curr_value, value);
+}
+
+AVS_UNIT_TEST(ipso_v2_basic_sensor, notify_deadband) {
+    anjay_t *anjay = sensor_test_anjay_new(1);
+    anjay_ipso_v2_basic_sensor_meta_t meta = {
+        .unit = "Cel",
+        .min_range_value = NAN,
+        .max_range_value = NAN,
+        .notify_deadband = -1.0
+    };
+    AVS_UNIT_ASSERT_FAILED(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_OID, 0, 20.0, &meta));
+    meta.notify_deadband = 1.0;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_ipso_v2_basic_sensor_instance_add(
+            anjay, TEST_OID, 0, 20.0, &meta));
+    anjay_sched_run(anjay);
+
+    // the deadband is relative to the last notified value, so slow drift is
+    // reported eventually
+    sensor_test_update(anjay, 20.5);
+    AVS_UNIT_ASSERT_FALSE(sensor_value_notified(anjay, 0));
+    sensor_test_update(anjay, 21.0);
+    AVS_UNIT_ASSERT_TRUE(sensor_value_notified(anjay, 0));
+    sensor_test_update(anjay, 20.2);
+    AVS_UNIT_ASSERT_FALSE(sensor_value_notified(anjay, 0));
+    sensor_test_update(anjay, 19.9);
+    AVS_UNIT_ASSERT_TRUE(sensor_value_notified(anjay, 0));
+
+    anjay_delete(anjay);
+}
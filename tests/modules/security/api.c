@@ -93,3 +93,43 @@ AVS_UNIT_TEST(security_object_api, add_instance_with_null_uri) {
     AVS_UNIT_ASSERT_FAILED(
             anjay_security_object_add_instance(env->anjay, &instance, &iid));
 }
+
+AVS_UNIT_TEST(security_object_api, add_instance_with_referenced_keys) {
+    SCOPED_SERVER_TEST_ENV(env);
+    static const uint8_t identity[] = "identity";
+    static const uint8_t key[] = "key";
+    anjay_security_instance_t instance = instance2;
+    instance.security_mode = ANJAY_SECURITY_PSK;
+    instance.server_uri = "coaps://1.2.3.4";
+    instance.public_cert_or_psk_identity = identity;
+    instance.public_cert_or_psk_identity_size = sizeof(identity) - 1;
+    instance.private_cert_or_psk_key = key;
+    instance.private_cert_or_psk_key_size = sizeof(key) - 1;
+    instance.key_material_by_reference = true;
+
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_security_object_add_instance(env->anjay, &instance, &iid));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, env->anjay);
+    sec_repr_t *repr = _anjay_sec_get(*_anjay_dm_find_object_by_oid(
+            anjay_unlocked, ANJAY_DM_OID_SECURITY));
+    sec_instance_t *inst = find_instance(repr, iid);
+    AVS_UNIT_ASSERT_NOT_NULL(inst);
+    AVS_UNIT_ASSERT_EQUAL(inst->public_cert_or_psk_identity.type,
+                          SEC_KEY_AS_DATA_REFERENCE);
+    AVS_UNIT_ASSERT_TRUE(inst->public_cert_or_psk_identity.value.data.data
+                         == identity);
+    AVS_UNIT_ASSERT_TRUE(inst->private_cert_or_psk_key.value.data.data == key);
+
+    // the transaction snapshot shares the reference
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sec_transaction_begin_impl(repr));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sec_transaction_save_instance(repr, inst));
+    AVS_UNIT_ASSERT_TRUE(
+            repr->saved_instances->private_cert_or_psk_key.value.data.data
+            == key);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_sec_transaction_rollback_impl(repr));
+    inst = find_instance(repr, iid);
+    AVS_UNIT_ASSERT_TRUE(inst->private_cert_or_psk_key.value.data.data == key);
+    ANJAY_MUTEX_UNLOCK(env->anjay);
+}
@@ -106,3 +106,48 @@ AVS_UNIT_TEST(server_object_api, add_instances_with_inifinite_lifetime) {
     AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_add_instance(
             env->anjay, &instance_lifetime_zero, &iid));
 }
+
+AVS_UNIT_TEST(server_object_api, transaction_rollback_restores_touched_only) {
+    SCOPED_SERVER_TEST_ENV(env);
+    anjay_iid_t iid1 = 1;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_add_instance(env->anjay, &instance1, &iid1));
+    anjay_iid_t iid2 = 2;
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_add_instance(env->anjay, &instance2, &iid2));
+
+    ANJAY_MUTEX_LOCK(anjay_unlocked, env->anjay);
+    server_repr_t *repr = _anjay_serv_get(
+            *_anjay_dm_find_object_by_oid(anjay_unlocked, ANJAY_DM_OID_SERVER));
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_serv_transaction_begin_impl(repr));
+    AVS_UNIT_ASSERT_TRUE(_anjay_serv_saved_instances(repr) == &repr->instances);
+
+    server_instance_t *inst = find_instance(repr, iid1);
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_serv_transaction_save_instance(repr, inst));
+    inst->lifetime = 1234;
+    AVS_UNIT_ASSERT_SUCCESS(del_instance(repr, iid2));
+    AVS_UNIT_ASSERT_SUCCESS(serv_instance_create(anjay_unlocked,
+                                                 repr->def_ptr, 3));
+    // only the modified and removed Instances are copied
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->saved_instances), 2);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->created_iids), 1);
+
+    AVS_LIST(server_instance_t) *saved = _anjay_serv_saved_instances(repr);
+    AVS_UNIT_ASSERT_NOT_NULL(saved);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(*saved), 2);
+    AVS_UNIT_ASSERT_EQUAL((*saved)->iid, iid1);
+    AVS_UNIT_ASSERT_EQUAL((*saved)->lifetime, instance1.lifetime);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_NEXT(*saved)->iid, iid2);
+
+    AVS_UNIT_ASSERT_SUCCESS(_anjay_serv_transaction_rollback_impl(repr));
+    AVS_UNIT_ASSERT_NULL(repr->saved_instances);
+    AVS_UNIT_ASSERT_NULL(repr->created_iids);
+    AVS_UNIT_ASSERT_NULL(repr->saved_instances_view);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(repr->instances), 2);
+    AVS_UNIT_ASSERT_EQUAL(repr->instances->iid, iid1);
+    AVS_UNIT_ASSERT_EQUAL(repr->instances->lifetime, instance1.lifetime);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_NEXT(repr->instances)->iid, iid2);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_NEXT(repr->instances)->lifetime,
+                          instance2.lifetime);
+    ANJAY_MUTEX_UNLOCK(env->anjay);
+}
@@ -244,6 +244,110 @@ AVS_UNIT_TEST(server_persistence, nonempty_store_restore) {
                            env->restored_repr->instances);
 }
 
+AVS_UNIT_TEST(server_persistence, snapshot_store_restore) {
+    SCOPED_SERVER_PERSISTENCE_TEST_ENV(env);
+    const anjay_server_instance_t instance = {
+        .ssid = 42,
+        .lifetime = 9001,
+        .default_min_period = -1,
+        .default_max_period = -1,
+        .disable_timeout = -1,
+        .binding = "UQ",
+        .notification_storing = true
+    };
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_add_instance(
+            env->anjay_stored, &instance, &iid));
+    iid = 7;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_add_instance(
+            env->anjay_stored,
+            &(const anjay_server_instance_t) {
+                .ssid = 43,
+                .lifetime = 60,
+                .default_min_period = 5,
+                .default_max_period = -1,
+                .disable_timeout = -1,
+                .binding = "U"
+            },
+            &iid));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_persist_snapshot(
+            env->anjay_stored, env->stream));
+    AVS_UNIT_ASSERT_FALSE(anjay_server_object_is_modified(env->anjay_stored));
+    AVS_UNIT_ASSERT_SUCCESS(
+            anjay_server_object_restore(env->anjay_restored, env->stream));
+    AVS_UNIT_ASSERT_EQUAL(2, AVS_LIST_SIZE(env->restored_repr->instances));
+    assert_instances_equal(env->stored_repr->instances,
+                           env->restored_repr->instances);
+    assert_instances_equal(AVS_LIST_NEXT(env->stored_repr->instances),
+                           AVS_LIST_NEXT(env->restored_repr->instances));
+}
+
+AVS_UNIT_TEST(server_persistence, snapshot_corrupted) {
+    SCOPED_SERVER_PERSISTENCE_TEST_ENV(env);
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_add_instance(
+            env->anjay_stored,
+            &(const anjay_server_instance_t) {
+                .ssid = 42,
+                .lifetime = 9001,
+                .default_min_period = -1,
+                .default_max_period = -1,
+                .disable_timeout = -1,
+                .binding = "U"
+            },
+            &iid));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_persist_snapshot(
+            env->anjay_stored, env->stream));
+
+    char buf[4096];
+    size_t size;
+    bool finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(env->stream, &size, &finished, buf,
+                                            sizeof(buf)));
+    AVS_UNIT_ASSERT_TRUE(size > sizeof(magic_t) + sizeof(snapshot_header_t));
+    buf[size - 1] ^= 0x55;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(env->stream, buf, size));
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_server_object_restore(env->anjay_restored, env->stream));
+    AVS_UNIT_ASSERT_EQUAL(0, AVS_LIST_SIZE(env->restored_repr->instances));
+}
+
+AVS_UNIT_TEST(server_persistence, snapshot_incompatible_layout) {
+    SCOPED_SERVER_PERSISTENCE_TEST_ENV(env);
+    anjay_iid_t iid = 1;
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_add_instance(
+            env->anjay_stored,
+            &(const anjay_server_instance_t) {
+                .ssid = 42,
+                .lifetime = 9001,
+                .default_min_period = -1,
+                .default_max_period = -1,
+                .disable_timeout = -1,
+                .binding = "U"
+            },
+            &iid));
+    AVS_UNIT_ASSERT_SUCCESS(anjay_server_object_persist_snapshot(
+            env->anjay_stored, env->stream));
+
+    char buf[4096];
+    size_t size;
+    bool finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(env->stream, &size, &finished, buf,
+                                            sizeof(buf)));
+    AVS_UNIT_ASSERT_TRUE(size > sizeof(magic_t) + sizeof(snapshot_header_t));
+    // same instance size and checksum, but made by a build in which the
+    // fields are laid out differently
+    snapshot_header_t header;
+    memcpy(&header, &buf[sizeof(magic_t)], sizeof(header));
+    AVS_UNIT_ASSERT_EQUAL(header.layout, snapshot_layout());
+    header.layout ^= 1;
+    memcpy(&buf[sizeof(magic_t)], &header, sizeof(header));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(env->stream, buf, size));
+    AVS_UNIT_ASSERT_FAILED(
+            anjay_server_object_restore(env->anjay_restored, env->stream));
+    AVS_UNIT_ASSERT_EQUAL(0, AVS_LIST_SIZE(env->restored_repr->instances));
+}
+
 AVS_UNIT_TEST(server_persistence, modification_flag_add_instance) {
     SCOPED_SERVER_PERSISTENCE_TEST_ENV(env);
     /* At the beginning server object is not modified */
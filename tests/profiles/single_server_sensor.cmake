@@ -0,0 +1,45 @@
+# Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay LwM2M SDK
+# All rights reserved.
+#
+# Licensed under the AVSystem-5-clause License.
+# See the attached LICENSE file for details.
+
+# Run with: cmake -P tests/profiles/single_server_sensor.cmake
+
+set(PROFILES_CMAKE "${CMAKE_CURRENT_LIST_DIR}/../../cmake/profiles.cmake")
+
+function(expect_value NAME VALUE)
+    if(NOT DEFINED ${NAME})
+        message(FATAL_ERROR "${NAME} is not defined, expected ${VALUE}")
+    elseif(NOT "${${NAME}}" STREQUAL "${VALUE}")
+        message(FATAL_ERROR "${NAME} is ${${NAME}}, expected ${VALUE}")
+    endif()
+endfunction()
+
+function(expect_undefined NAME)
+    if(DEFINED ${NAME})
+        message(FATAL_ERROR "${NAME} is ${${NAME}}, expected it to be unset")
+    endif()
+endfunction()
+
+# no profile selected - defaults are left to the options themselves
+set(WITH_PROFILE_SINGLE_SERVER_SENSOR OFF)
+include(${PROFILES_CMAKE})
+expect_undefined(WITH_BOOTSTRAP)
+expect_undefined(WITH_DOWNLOADER)
+
+# options passed explicitly take precedence over the profile
+set(WITH_PROFILE_SINGLE_SERVER_SENSOR ON)
+set(WITH_DOWNLOADER ON)
+set(WITH_SENML_JSON ON)
+include(${PROFILES_CMAKE})
+expect_value(WITH_BOOTSTRAP OFF)
+expect_value(WITH_ACCESS_CONTROL OFF)
+expect_value(WITHOUT_TLV ON)
+expect_value(WITHOUT_PLAINTEXT ON)
+expect_value(WITH_LWM2M_CBOR OFF)
+expect_value(WITH_AVS_COAP_TCP OFF)
+expect_value(WITH_DEMO OFF)
+expect_value(WITH_DOWNLOADER ON)
+expect_value(WITH_SENML_JSON ON)
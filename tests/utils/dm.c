@@ -65,6 +65,13 @@ avs_net_socket_t *_anjay_test_dm_create_socket(bool connected) {
 avs_net_socket_t *_anjay_test_dm_install_socket(anjay_t *anjay_locked,
                                                 anjay_ssid_t ssid) {
     avs_net_socket_t *socket = _anjay_test_dm_create_socket(true);
+    _anjay_test_dm_attach_socket(anjay_locked, ssid, socket);
+    return socket;
+}
+
+void _anjay_test_dm_attach_socket(anjay_t *anjay_locked,
+                                  anjay_ssid_t ssid,
+                                  avs_net_socket_t *socket) {
     ANJAY_MUTEX_LOCK(anjay, anjay_locked);
     AVS_UNIT_ASSERT_NOT_NULL(
             AVS_LIST_INSERT_NEW(anjay_server_info_t, &anjay->servers));
@@ -86,7 +93,6 @@ avs_net_socket_t *_anjay_test_dm_install_socket(anjay_t *anjay_locked,
     AVS_UNIT_ASSERT_SUCCESS(
             avs_coap_ctx_set_socket(connection->coap_ctx, socket));
     ANJAY_MUTEX_UNLOCK(anjay_locked);
-    return socket;
 }
 
 void _anjay_test_dm_finish(anjay_t *anjay_locked) {
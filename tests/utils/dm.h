@@ -29,6 +29,15 @@ avs_net_socket_t *_anjay_test_dm_create_socket(bool connected);
 
 avs_net_socket_t *_anjay_test_dm_install_socket(anjay_t *anjay,
                                                 anjay_ssid_t ssid);
+
+/**
+ * Adds a server with a given SSID that uses an already connected @p socket.
+ * If it is not a mocksock, the Anjay object shall be cleaned up using
+ * anjay_delete() instead of _anjay_test_dm_finish().
+ */
+void _anjay_test_dm_attach_socket(anjay_t *anjay,
+                                  anjay_ssid_t ssid,
+                                  avs_net_socket_t *socket);
 void _anjay_test_dm_finish(anjay_t *anjay);
 
 int _anjay_test_dm_fake_security_list_instances(
@@ -728,6 +728,103 @@ void {{ obj_name_snake }}_object_release(const anjay_dm_object_def_t **def) {
 }
 """
 
+C_TABLE_TEMPLATE = """\
+/**
+ * Generated by anjay_codegen.py on {{ date_time }}
+ *
+ * LwM2M Object: {{ obj.name }}
+ * ID: {{ obj.oid }}, URN: {{ obj.urn }}, {{ obj.mandatory_str }}, {{ obj.multiple_str }}
+ *
+ * {{ obj.description }}
+ */
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <anjay/anjay.h>
+#include <anjay/dm_table.h>
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_memory.h>
+
+{% for res in obj.resources %}
+/**
+ * {{ res.name }}: {{ res.operations }}, {{ res.multiple_str }}, {{ res.mandatory_str }}
+ * type: {{ res.type }}, range: {{ res.range_enumeration }}, unit: {{ res.units }}
+{% if res.description %}
+ * {{ res.description }}
+{% endif %}
+ */
+#define {{ res.name_upper }} {{ res.rid }}
+
+{% endfor %}
+{% if skipped_resources %}
+// NOTE: The following Resources cannot be represented as plain values and are
+// not handled by the generated table:
+{% for res in skipped_resources %}
+// - {{ res.name_upper }}
+{% endfor %}
+// TODO: implement them in custom handlers if necessary
+
+{% endif %}
+typedef struct {{ obj_inst_tag }} {
+{% for res in table_resources %}
+    {{ res.table_field_decl }};
+{% else %}
+    char unused; // TODO: instance state
+{% endfor %}
+} {{ obj_inst_type }};
+
+typedef struct {{ obj_repr_tag }} {
+    anjay_dm_table_object_t table;
+    {{ obj_inst_type }} instances[{{ instances_number }}];
+} {{ obj_repr_type }};
+
+{% if table_resources %}
+static const anjay_dm_table_resource_def_t RESOURCES[] = {
+{% for res in table_resources %}
+    ANJAY_DM_TABLE_RESOURCE({{ res.name_upper }}, {{ res.kind_enum }}, {{ res.table_type[1] }},
+                            {{ obj_inst_type }}, {{ res.field_name }}){{ "" if loop.last else "," }}
+{% endfor %}
+};
+
+{% endif %}
+static const anjay_dm_object_def_t OBJ_DEF = {
+    .oid = {{ obj.oid }},
+{% if obj.version not in ['', '1.0'] %}
+    .version = "{{ obj.version }}",
+{% endif %}
+    .handlers = {
+        ANJAY_DM_TABLE_HANDLERS
+    }
+};
+
+const anjay_dm_object_def_t **{{ obj_name_snake }}_object_create(void) {
+    {{ obj_repr_type }} *obj = ({{ obj_repr_type }} *) avs_calloc(1, sizeof({{ obj_repr_type }}));
+    if (!obj) {
+        return NULL;
+    }
+    obj->table.def = &OBJ_DEF;
+{% if table_resources %}
+    obj->table.resources = RESOURCES;
+    obj->table.resource_count = AVS_ARRAY_SIZE(RESOURCES);
+{% endif %}
+    obj->table.instances = obj->instances;
+    obj->table.instance_size = sizeof(obj->instances[0]);
+    obj->table.instance_count = (anjay_iid_t) AVS_ARRAY_SIZE(obj->instances);
+
+    // TODO: initial Resource values
+
+    return &obj->table.def;
+}
+
+void {{ obj_name_snake }}_object_release(const anjay_dm_object_def_t **def) {
+    if (def) {
+        {{ obj_repr_type }} *obj = AVS_CONTAINER_OF(def, {{ obj_repr_type }}, table.def);
+        avs_free(obj);
+    }
+}
+"""
+
 CXX_DYNAMIC_INST_TEMPLATE = """\
 /**
  * Generated by anjay_codegen.py on {{ date_time }}
@@ -1548,6 +1645,40 @@ class ResourceDef(collections.namedtuple('ResourceDef', ['rid', 'name', 'operati
                         return %s; // TODO
                     }""") % (local_def, get_func)
 
+    @property
+    def field_name(self) -> str:
+        return _sanitize_identifier(self.name.lower())
+
+    @property
+    def table_type(self) -> Optional[Tuple[str, str]]:
+        """
+        Returns a (C declaration format, ANJAY_DM_TABLE_* suffix) pair, or None
+        if the Resource cannot be handled by the table-driven handlers.
+        """
+        if self.multiple or 'E' in self.operations:
+            return None
+
+        types = [
+            (('boolean', 'bool'), ('bool %s',      'BOOL')),
+            (('integer', 'int'),  ('int32_t %s',   'I32')),
+            (('float',),          ('double %s',    'DOUBLE')),
+            (('corelnk', # TODO T2033
+              'string', 'str'),   ('char %s[256]', 'STRING')),
+            (('time',),           ('int64_t %s',   'I64')),
+            (('unsigned integer',
+              'unsigned int',
+              'unsigned'),        ('uint32_t %s',  'U32'))
+        ]
+
+        for match_types, result in types:
+            if self.type in match_types:
+                return result
+        return None
+
+    @property
+    def table_field_decl(self) -> str:
+        return self.table_type[0] % (self.field_name,)
+
     @classmethod
     def from_etree(cls, res: Element) -> 'ResourceDef':
         return cls(rid=int(res.get('ID')),
@@ -1625,6 +1756,27 @@ class ObjectDef(collections.namedtuple('ObjectDef',
                    resources=resources)
 
 
+def generate_table_object(obj_tree: ElementTree, instances_number: int, resources_subset: set = None):
+    obj = ObjectDef.from_etree(obj_tree, resources_subset)
+
+    jinja_env = Environment(trim_blocks=True)
+
+    if not obj.multiple or not instances_number:
+        instances_number = 1
+
+    return (jinja_env.from_string(C_TABLE_TEMPLATE)
+            .render(obj=obj,
+                    table_resources=[r for r in obj.resources if r.table_type is not None],
+                    skipped_resources=[r for r in obj.resources if r.table_type is None],
+                    instances_number=instances_number,
+                    date_time=datetime.datetime.now().strftime('%Y-%m-%d %H:%M:%S'),
+                    obj_name_snake=obj.name_snake,
+                    obj_repr_tag=obj.name_snake + '_object_struct',
+                    obj_repr_type=obj.name_snake + '_object_t',
+                    obj_inst_tag=obj.name_snake + '_instance_struct',
+                    obj_inst_type=obj.name_snake + '_instance_t'))
+
+
 def generate_object_boilerplate(obj_tree: ElementTree, cxx: bool, instances_number: int, resources_subset: set = None):
     obj = ObjectDef.from_etree(obj_tree, resources_subset)
 
@@ -1694,6 +1846,10 @@ if __name__ == '__main__':
     parser.add_argument('-n', '--instances-number', metavar='{1,2,...,65534}', dest='instances_number', type=int,
                         help='Number of instances of the generated object. It forces using the template with statically allocated instances. '
                         'If the object is single instance it is silently ignored.')
+    parser.add_argument('-t', '--table', action='store_true',
+                        help='Generate a table-driven object using the generic handlers from anjay/dm_table.h. '
+                        'Only Single, non-executable Resources of plain value types are handled; the number of '
+                        'instances is fixed (see -n, default: 1). Not supported together with --c++.')
 
     args = parser.parse_args()
     if args.input == '-':
@@ -1701,7 +1857,8 @@ if __name__ == '__main__':
     if args.output == '-':
         args.output = '/dev/stdout'
 
-    if args.input is None or (args.instances_number is not None and args.instances_number not in range(1, 65535)):
+    if args.input is None or (args.instances_number is not None and args.instances_number not in range(1, 65535)) \
+            or (args.table and args.cxx):
         parser.print_usage()
         sys.exit(1)
 
@@ -1713,7 +1870,10 @@ if __name__ == '__main__':
                 print(r.rid, r.name, '(mandatory)' if r.mandatory else '')
             sys.exit(0)
 
-        boilerplate = generate_object_boilerplate(obj, args.cxx, args.instances_number, args.resources)
+        if args.table:
+            boilerplate = generate_table_object(obj, args.instances_number, args.resources)
+        else:
+            boilerplate = generate_object_boilerplate(obj, args.cxx, args.instances_number, args.resources)
 
     with open(args.output, 'w') as f:
         print(boilerplate, file=f)
@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+#
+# Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay LwM2M SDK
+# All rights reserved.
+#
+# Licensed under the AVSystem-5-clause License.
+# See the attached LICENSE file for details.
+"""
+Decodes binary log records retrieved with anjay_deferred_log_read().
+
+Format strings are read from src/core/anjay_deferred_log.h, so this script
+shall be used from the source tree of the Anjay version that produced the
+records.
+"""
+import argparse
+import os
+import re
+import struct
+import sys
+
+PROJECT_ROOT = os.path.dirname(os.path.dirname(os.path.realpath(__file__)))
+
+DEFAULT_FORMATS_HEADER = os.path.join(PROJECT_ROOT, 'src', 'core', 'anjay_deferred_log.h')
+
+# values of avs_log_level_t
+LEVELS = ['TRACE', 'DEBUG', 'INFO', 'WARNING', 'ERROR', 'QUIET']
+
+RECORD_HEADER = struct.Struct('<HBBI')
+
+DEFINE_RE = re.compile(r'^#define ANJAY_DEFERRED_LOG_(ID|FMT)_(\w+) (.*)$')
+CONVERSION_RE = re.compile(r'%([-+ #0]*[0-9]*)([dixXu%])')
+
+
+def read_formats(header_path):
+    ids = {}
+    formats = {}
+    with open(header_path) as f:
+        for line in f:
+            match = DEFINE_RE.match(line.strip())
+            if not match:
+                continue
+            kind, name, value = match.groups()
+            if kind == 'ID':
+                ids[name] = int(value, 0)
+            else:
+                formats[name] = value.encode().decode('unicode_escape')[1:-1]
+    result = {}
+    for name, format_id in ids.items():
+        if format_id in result:
+            raise ValueError('duplicate deferred log ID: %d' % (format_id,))
+        result[format_id] = formats[name]
+    return result
+
+
+def format_message(fmt, args):
+    args = iter(args)
+
+    def convert(match):
+        flags, conversion = match.groups()
+        if conversion == '%':
+            return '%'
+        value = next(args)
+        if conversion in 'di' and value >= 0x80000000:
+            value -= 0x100000000
+        return ('%' + flags + conversion) % (value,)
+
+    return CONVERSION_RE.sub(convert, fmt)
+
+
+def decode(data, formats):
+    offset = 0
+    while offset + RECORD_HEADER.size <= len(data):
+        format_id, level, argc, timestamp_ms = RECORD_HEADER.unpack_from(data, offset)
+        offset += RECORD_HEADER.size
+        if offset + 4 * argc > len(data):
+            raise ValueError('truncated record at offset %d' % (offset - RECORD_HEADER.size,))
+        args = struct.unpack_from('<%dI' % (argc,), data, offset)
+        offset += 4 * argc
+
+        level_name = LEVELS[level] if level < len(LEVELS) else str(level)
+        if format_id in formats:
+            message = format_message(formats[format_id], args)
+        else:
+            message = 'unknown message ID %d, arguments: %s' % (format_id, list(args))
+        yield '%10u.%03u %s [anjay] %s' % (timestamp_ms // 1000, timestamp_ms % 1000,
+                                           level_name, message)
+    if offset != len(data):
+        raise ValueError('trailing %d bytes' % (len(data) - offset,))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('input', nargs='?', help='file with the records; stdin if not given')
+    parser.add_argument('--formats', default=DEFAULT_FORMATS_HEADER,
+                        help='header file with the format strings (default: %(default)s)')
+    args = parser.parse_args()
+
+    formats = read_formats(args.formats)
+    if args.input:
+        with open(args.input, 'rb') as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    for line in decode(data, formats):
+        print(line)
+
+
+if __name__ == '__main__':
+    main()
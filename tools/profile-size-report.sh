@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+#
+# Copyright 2017-2024 AVSystem <avsystem@avsystem.com>
+# AVSystem Anjay LwM2M SDK
+# All rights reserved.
+#
+# Licensed under the AVSystem-5-clause License.
+# See the attached LICENSE file for details.
+
+# Compares code size of the library built with the default configuration and
+# with each of the configuration profiles. Additional arguments are passed to
+# CMake when configuring every build, e.g. a toolchain file:
+#
+#   tools/profile-size-report.sh -DCMAKE_TOOLCHAIN_FILE=cortex-m3.cmake
+
+set -e
+
+. "$(dirname "$0")/utils.sh"
+
+PROFILES=(
+    ""
+    "WITH_PROFILE_SINGLE_SERVER_SENSOR"
+)
+
+SIZE="${SIZE:-size}"
+ANJAY_ROOT="$(cd "$(dirname "$(dirname "$0")")" && pwd)"
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+for PROFILE in "${PROFILES[@]}"; do
+    BUILD_DIR="$WORK_DIR/${PROFILE:-default}"
+    PROFILE_ARGS=()
+    if [ -n "$PROFILE" ]; then
+        PROFILE_ARGS=("-D$PROFILE=ON")
+    fi
+    log "building ${PROFILE:-default configuration}"
+    cmake -S "$ANJAY_ROOT" -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=MinSizeRel \
+          -DWITH_LIBRARY_SHARED=OFF -DWITH_DEMO=OFF -DWITH_EXAMPLES=OFF \
+          "${PROFILE_ARGS[@]}" "$@" >/dev/null
+    cmake --build "$BUILD_DIR" --target anjay -- -j"$(nproc)" >/dev/null
+    LIBRARY="$(find "$BUILD_DIR" -name 'libanjay.a' | head -n 1)"
+    [ -n "$LIBRARY" ] || die "libanjay.a not found in $BUILD_DIR"
+    echo "${PROFILE:-default}: $("$SIZE" -t "$LIBRARY" | tail -n 1)"
+done